@@ -175,7 +175,8 @@ Ax88179MulticastSet (
   Start the link negotiation
 
   This routine calls ::Ax88179PhyWrite to start the PHY's link
-  negotiation.
+  negotiation. It doesn't wait for the negotiation, GetStatus ()
+  polls ::Ax88179NegotiateLinkComplete until the link is up.
 
   @param [in] NicDevice       Pointer to the NIC_DEVICE structure
 
@@ -214,8 +215,6 @@ Ax88179NegotiateLinkStart (
     Control |= BMCR_FULL_DUPLEX;
   }
   Status = Ax88179PhyWrite (NicDevice, PHY_BMCR, Control);
-  if (!EFI_ERROR(Status))
-    gBS->Stall(3000000);
   //
   // Return the operation status
   //
@@ -424,6 +423,8 @@ Ax88179Reset (
   EFI_STATUS Status;
   UINT16     Val;
   UINT8      Val8;
+  UINT16     PhyData;
+  UINTN      Index;
 
   Status = Ax88179SetIInInterval(NicDevice, 0xff);
 
@@ -462,7 +463,17 @@ Ax88179Reset (
     goto err;
   }
 
-  gBS->Stall (200000);
+  //
+  //  Poll the PHY out of reset rather than always waiting the worst case.
+  //
+  for (Index = 0; Index < AX88179_PHY_RESET_TIMEOUT; Index++) {
+    gBS->Stall (1000);
+    PhyData = 0;
+    Status = Ax88179PhyRead (NicDevice, PHY_BMSR, &PhyData);
+    if (!EFI_ERROR (Status) && (PhyData != 0) && (PhyData != 0xFFFF)) {
+      break;
+    }
+  }
 
   Val = CLKSELECT_BCS | CLKSELECT_ACS;
   Status = Ax88179MacWrite (CLKSELECT,
@@ -515,7 +526,7 @@ Ax88179Reset (
 
   if (EFI_ERROR(Status)) goto err;
 
-  Val = 12; //AX88179_BULKIN_SIZE_INK - 1;
+  Val = AX88179_RX_AGGR_SIZE_INK;
   Status =  Ax88179MacWrite (RXBINQSIZE,
                               0x01,
                               NicDevice,
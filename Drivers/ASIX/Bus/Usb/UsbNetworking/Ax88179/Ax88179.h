@@ -69,7 +69,13 @@
 #define USB_NETWORK_CLASS   0x09    ///<  USB Network class code
 #define USB_BUS_TIMEOUT     1000    ///<  USB timeout in milliseconds
 
-#define AX88179_BULKIN_SIZE_INK     2
+//
+//  RX aggregation: the device gathers frames into bulk-in transfers of up to
+//  AX88179_RX_AGGR_SIZE_INK KB, the host buffer keeps 2 KB of headroom so a
+//  full aggregate always fits in one read.
+//
+#define AX88179_RX_AGGR_SIZE_INK    12
+#define AX88179_BULKIN_SIZE_INK     (AX88179_RX_AGGR_SIZE_INK + 2)
 #define AX88179_MAX_BULKIN_SIZE    (1024 * AX88179_BULKIN_SIZE_INK)
 #define AX88179_MAX_PKT_SIZE  2048
 
@@ -78,6 +84,7 @@
 #define BULKIN_TIMEOUT  3 //5000
 #define TX_RETRY        0
 #define AUTONEG_DELAY   1000000
+#define AX88179_PHY_RESET_TIMEOUT   200   ///<  PHY reset release timeout in milliseconds
 
 /**
   Verify new TPL value
@@ -607,6 +607,16 @@ SN_Receive (
           NicDevice->CurPktHdrOff += 4;
           NicDevice->CurPktOff += (CurrentPktLen + 2 + 7) & 0xfff8;
           Status = EFI_SUCCESS;
+        } else if (!Valid && (CurrentPktLen <= AX88179_MAX_PKT_SIZE) &&
+                   (*((UINT16*)NicDevice->CurPktOff)) == 0xEEEE) {
+          //
+          //  Only skip the frame the device flagged, the rest of the
+          //  aggregate is still good.
+          //
+          NicDevice->PktCnt--;
+          NicDevice->CurPktHdrOff += 4;
+          NicDevice->CurPktOff += (CurrentPktLen + 2 + 7) & 0xfff8;
+          Status = EFI_NOT_READY;
         } else {
           NicDevice->PktCnt = 0;
           Status = EFI_NOT_READY;
@@ -209,7 +209,8 @@ Ax88772MulticastSet (
   Start the link negotiation
 
   This routine calls ::Ax88772PhyWrite to start the PHY's link
-  negotiation.
+  negotiation. It doesn't wait for the negotiation, GetStatus ()
+  polls ::Ax88772NegotiateLinkComplete until the link is up.
 
   @param [in] NicDevice       Pointer to the NIC_DEVICE structure
 
@@ -246,9 +247,6 @@ Ax88772NegotiateLinkStart (
       Control |= BMCR_FULL_DUPLEX;
     }
     Status = Ax88772PhyWrite (NicDevice, PHY_BMCR, Control);
-
-    if (!EFI_ERROR(Status))
-        gBS->Stall(3000000);
   }
   return Status;
 }
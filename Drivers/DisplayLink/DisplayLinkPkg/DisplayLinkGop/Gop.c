@@ -69,6 +69,37 @@ CheckBounds (
   return EFI_SUCCESS;
 }
 
+/**
+ * Add an area of the screen to the one that has to be sent in the next screen update.
+ * @param UsbDisplayLinkDev
+ * @param X
+ * @param Y
+ * @param Width
+ * @param Height
+ */
+STATIC VOID
+MarkDirty (
+  IN  USB_DISPLAYLINK_DEV                     *UsbDisplayLinkDev,
+  IN  UINTN                                   X,
+  IN  UINTN                                   Y,
+  IN  UINTN                                   Width,
+  IN  UINTN                                   Height
+)
+{
+  if (UsbDisplayLinkDev->LastY2 < UsbDisplayLinkDev->LastY1) {
+    UsbDisplayLinkDev->LastX1 = X;
+    UsbDisplayLinkDev->LastY1 = Y;
+    UsbDisplayLinkDev->LastX2 = X + Width;
+    UsbDisplayLinkDev->LastY2 = Y + Height;
+    return;
+  }
+
+  UsbDisplayLinkDev->LastX1 = MIN (UsbDisplayLinkDev->LastX1, X);
+  UsbDisplayLinkDev->LastY1 = MIN (UsbDisplayLinkDev->LastY1, Y);
+  UsbDisplayLinkDev->LastX2 = MAX (UsbDisplayLinkDev->LastX2, X + Width);
+  UsbDisplayLinkDev->LastY2 = MAX (UsbDisplayLinkDev->LastY2, Y + Height);
+}
+
 /**
  * Update the local copy of the Frame Buffer. This local copy is periodically transmitted to the
  * DisplayLink device (via DlGopSendScreenUpdate)
@@ -122,12 +153,7 @@ BuildBackBuffer (
   case EfiBltBufferToVideo:
   {
     // Update the store of the area of the screen that is "dirty" - that we need to send in the next screen update.
-    if (DestinationY < UsbDisplayLinkDev->LastY1) {
-      UsbDisplayLinkDev->LastY1 = DestinationY;
-    }
-    if ((DestinationY + Height) > UsbDisplayLinkDev->LastY2) {
-      UsbDisplayLinkDev->LastY2 = DestinationY + Height;
-    }
+    MarkDirty (UsbDisplayLinkDev, DestinationX, DestinationY, Width, Height);
 
     EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Blt;
     EFI_GRAPHICS_OUTPUT_BLT_PIXEL* DstB;
@@ -146,6 +172,8 @@ BuildBackBuffer (
 
   case EfiBltVideoToVideo:
   {
+    MarkDirty (UsbDisplayLinkDev, DestinationX, DestinationY, Width, Height);
+
     EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcB;
     EFI_GRAPHICS_OUTPUT_BLT_PIXEL* DstB;
     SrcB = UsbDisplayLinkDev->Screen + SourceY * PixelsPerScanLine + SourceX;
@@ -163,6 +191,8 @@ BuildBackBuffer (
 
   case EfiBltVideoFill:
   {
+    MarkDirty (UsbDisplayLinkDev, DestinationX, DestinationY, Width, Height);
+
     EFI_GRAPHICS_OUTPUT_BLT_PIXEL* DstB;
     DstB = UsbDisplayLinkDev->Screen + DestinationY * PixelsPerScanLine + DestinationX;
     for (H = 0; H < Height; H++) {
@@ -251,6 +281,83 @@ DlGopSendTestPattern (
 }
 
 
+/**
+ * Swap a Blt pixel (Blue in the low byte) round to the Red, Green, Blue byte order of the device
+ */
+#define SWAP_BGRX_TO_RGB(Pixel)  ((((Pixel) >> 16) & 0xFF) | ((Pixel) & 0xFF00) | (((Pixel) & 0xFF) << 16))
+
+/**
+ * Convert an area of the local copy of the Frame Buffer to the 24 bits per pixel format
+ * of the device, into the copy of the frame that was last sent.
+ * @param UsbDisplayLinkDev
+ * @return TRUE if any of the pixels differ from the ones that were last sent
+ */
+STATIC BOOLEAN
+ConvertDirtyArea (
+    IN USB_DISPLAYLINK_DEV* UsbDisplayLinkDev
+    )
+{
+  CONST EFI_GRAPHICS_OUTPUT_MODE_INFORMATION* ScreenMode;
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcPtr;
+  UINT8* DstPtr;
+  BOOLEAN Changed;
+  UINTN H;
+  UINTN W;
+  UINT32 Pixel0;
+  UINT32 Pixel1;
+  UINT32 Pixel2;
+  UINT32 Pixel3;
+  UINT32 Word;
+
+  ScreenMode = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info;
+  Changed = FALSE;
+
+  for (H = UsbDisplayLinkDev->LastY1; H < UsbDisplayLinkDev->LastY2; H++) {
+    SrcPtr = UsbDisplayLinkDev->Screen + H * ScreenMode->PixelsPerScanLine + UsbDisplayLinkDev->LastX1;
+    DstPtr = UsbDisplayLinkDev->TransferBuffer + (H * ScreenMode->HorizontalResolution + UsbDisplayLinkDev->LastX1) * 3;
+
+    // Four pixels at a time pack into three 32 bit words: R0G0B0R1 G1B1R2G2 B2R3G3B3
+    for (W = UsbDisplayLinkDev->LastX1; W + 4 <= UsbDisplayLinkDev->LastX2; W += 4) {
+      Pixel0 = SWAP_BGRX_TO_RGB (((UINT32*)SrcPtr)[0]);
+      Pixel1 = SWAP_BGRX_TO_RGB (((UINT32*)SrcPtr)[1]);
+      Pixel2 = SWAP_BGRX_TO_RGB (((UINT32*)SrcPtr)[2]);
+      Pixel3 = SWAP_BGRX_TO_RGB (((UINT32*)SrcPtr)[3]);
+
+      Word = Pixel0 | (Pixel1 << 24);
+      if (ReadUnaligned32 ((UINT32*)DstPtr) != Word) {
+        WriteUnaligned32 ((UINT32*)DstPtr, Word);
+        Changed = TRUE;
+      }
+      Word = (Pixel1 >> 8) | (Pixel2 << 16);
+      if (ReadUnaligned32 ((UINT32*)(DstPtr + 4)) != Word) {
+        WriteUnaligned32 ((UINT32*)(DstPtr + 4), Word);
+        Changed = TRUE;
+      }
+      Word = (Pixel2 >> 16) | (Pixel3 << 8);
+      if (ReadUnaligned32 ((UINT32*)(DstPtr + 8)) != Word) {
+        WriteUnaligned32 ((UINT32*)(DstPtr + 8), Word);
+        Changed = TRUE;
+      }
+      SrcPtr += 4;
+      DstPtr += 12;
+    }
+
+    for (; W < UsbDisplayLinkDev->LastX2; W++) {
+      // Need to swap round the RGB values
+      if (DstPtr[0] != SrcPtr->Red || DstPtr[1] != SrcPtr->Green || DstPtr[2] != SrcPtr->Blue) {
+        DstPtr[0] = SrcPtr->Red;
+        DstPtr[1] = SrcPtr->Green;
+        DstPtr[2] = SrcPtr->Blue;
+        Changed = TRUE;
+      }
+      SrcPtr++;
+      DstPtr += 3;
+    }
+  }
+
+  return Changed;
+}
+
 /**
  * Transfer the latest copy of the Blt buffer over USB to the DisplayLink device
  * @param UsbDisplayLinkDev
@@ -265,52 +372,52 @@ DlGopSendScreenUpdate (
   UINT32 USBStatus;
   Status = EFI_SUCCESS;
 
+  CONST EFI_GRAPHICS_OUTPUT_MODE_INFORMATION* ScreenMode = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info;
+
   // If it has been a while since we sent an update, send a full screen.
   // This allows us to update a hot-plugged monitor quickly.
   if (UsbDisplayLinkDev->TimeSinceLastScreenUpdate > DISPLAYLINK_FULL_SCREEN_UPDATE_PERIOD) {
-    UsbDisplayLinkDev->LastY1 = 0;
-    UsbDisplayLinkDev->LastY2 = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution - 1;
+    MarkDirty (UsbDisplayLinkDev, 0, 0, ScreenMode->HorizontalResolution, ScreenMode->VerticalResolution);
+    UsbDisplayLinkDev->ForceScreenUpdate = TRUE;
   }
 
   // If there has been no BLT since the last update/poll, drop out quietly.
   if (UsbDisplayLinkDev->LastY2 < UsbDisplayLinkDev->LastY1) {
-    UsbDisplayLinkDev->TimeSinceLastScreenUpdate += (DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD / 1000);  // Convert us to ms
+    UsbDisplayLinkDev->TimeSinceLastScreenUpdate += (UsbDisplayLinkDev->ScreenUpdatePeriod / 1000);  // Convert us to ms
     return EFI_SUCCESS;
   }
 
-  UsbDisplayLinkDev->TimeSinceLastScreenUpdate = 0;
-
+  // Only the conversion of the dirty area needs to be atomic with respect to Blt, which runs at
+  // TPL_NOTIFY. The transfer itself is done from the converted copy at the caller's TPL.
   EFI_TPL OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
 
-  UINTN DataLen;
-  UINTN Width;
-  UINTN Height;
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcPtr;
-  UINT8* DstPtr;
-  UINT8 DstBuffer[1920 * 3]; // Get rid of the magic numbers at some point
-                             // Could also use a buffer allocated at runtime to store the line, stored in the USB_DISPLAYLINK_DEV structure.
-  UINTN H;
+  BOOLEAN Changed = ConvertDirtyArea (UsbDisplayLinkDev);
+  UsbDisplayLinkDev->LastY2 = 0;
+  UsbDisplayLinkDev->LastY1 = (UINTN)-1;
 
-  DataLen = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution * 3; // Send 1 line @ 24 bits per pixel
-  Width = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->HorizontalResolution;
-  Height = UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info->VerticalResolution;
-  SrcPtr = UsbDisplayLinkDev->Screen;
-  DstPtr = DstBuffer;
+  gBS->RestoreTPL (OriginalTPL);
 
-  for (H = 0; H < Height; H++) {
-    DstPtr = DstBuffer;
+  // Redrawing the screen with the same contents (e.g. a cursor that did not move) needs no update.
+  if (!Changed && !UsbDisplayLinkDev->ForceScreenUpdate) {
+    UsbDisplayLinkDev->TimeSinceLastScreenUpdate += (UsbDisplayLinkDev->ScreenUpdatePeriod / 1000);  // Convert us to ms
+    return EFI_SUCCESS;
+  }
 
-    UINTN W;
-    for (W = 0; W < Width; W++) {
-      // Need to swap round the RGB values
-      DstPtr[0] = ((UINT8 *)SrcPtr)[2];
-      DstPtr[1] = ((UINT8 *)SrcPtr)[1];
-      DstPtr[2] = ((UINT8 *)SrcPtr)[0];
-      SrcPtr++;
-      DstPtr += 3;
-    }
+  UsbDisplayLinkDev->TimeSinceLastScreenUpdate = 0;
+  UsbDisplayLinkDev->ForceScreenUpdate = FALSE;
+
+  UINTN DataLen;
+  UINT8* SrcPtr;
+  UINTN H;
+  UINT64 StartTime;
+  UINT64 SendTime;
 
-    Status = DlUsbBulkWrite (UsbDisplayLinkDev, DstBuffer, DataLen, &USBStatus);
+  DataLen = ScreenMode->HorizontalResolution * 3; // Send 1 line @ 24 bits per pixel
+  SrcPtr = UsbDisplayLinkDev->TransferBuffer;
+  StartTime = GetPerformanceCounter ();
+
+  for (H = 0; H < ScreenMode->VerticalResolution; H++, SrcPtr += DataLen) {
+    Status = DlUsbBulkWrite (UsbDisplayLinkDev, SrcPtr, DataLen, &USBStatus);
 
     // USBStatus values defined in usbio.h, e.g. EFI_USB_ERR_TIMEOUT 0x40
     if (EFI_ERROR (Status)) {
@@ -320,7 +427,7 @@ DlGopSendScreenUpdate (
     // Need an extra DlUsbBulkWrite if the data length is divisible by USB MaxPacketSize. This spare data will just get written into the (invisible) stride area.
     // Note that the API doesn't let us do a bulk write of 0.
     if ((DataLen & (UsbDisplayLinkDev->BulkOutEndpointDescriptor.MaxPacketSize - 1)) == 0) {
-      Status = DlUsbBulkWrite (UsbDisplayLinkDev, DstBuffer, 2, &USBStatus);
+      Status = DlUsbBulkWrite (UsbDisplayLinkDev, SrcPtr, 2, &USBStatus);
       if (EFI_ERROR (Status)) {
         DEBUG ((DEBUG_ERROR, "Screen update - USB bulk transfer of pixel data failed. Line %d len %d, failure code %r USB status x%x\n", H, DataLen, Status, USBStatus));
         break;
@@ -328,18 +435,21 @@ DlGopSendScreenUpdate (
     }
   }
 
-  if (!EFI_ERROR (Status)) {
-    // If we've successfully transmitted the frame, reset the values that store which area of the screen has been BLTted to.
-    // If we haven't succeeded, this will mean we'll try to resend it after the next poll period.
-    UsbDisplayLinkDev->LastY2 = 0;
-    UsbDisplayLinkDev->LastY1 = (UINTN)-1;
+  if (EFI_ERROR (Status)) {
+    // If we haven't succeeded, resend the frame after the next poll period.
+    UsbDisplayLinkDev->ForceScreenUpdate = TRUE;
+    MarkDirty (UsbDisplayLinkDev, 0, 0, ScreenMode->HorizontalResolution, ScreenMode->VerticalResolution);
   }
 
   // Payload with length of 1 to terminate the frame
   // We need to do this even if we had an error, to indicate to the DL device that it should now expect a new frame.
-  DlUsbBulkWrite (UsbDisplayLinkDev, DstBuffer, 1, &USBStatus);
+  DlUsbBulkWrite (UsbDisplayLinkDev, UsbDisplayLinkDev->TransferBuffer, 1, &USBStatus);
 
-  gBS->RestoreTPL (OriginalTPL);
+  // The timer is restarted once we return, so waiting as long as the frame took to send leaves at least
+  // half of the time for the rest of the system. A fast link gets polled more often, up to the minimum period.
+  SendTime = DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime), 100);
+  UsbDisplayLinkDev->ScreenUpdatePeriod = (UINTN)MAX (MIN (SendTime, DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD),
+                                                      DISPLAYLINK_SCREEN_UPDATE_MIN_TIMER_PERIOD);
 
   return Status;
 }
@@ -486,6 +596,23 @@ DisplayLinkSetMode (
     return EFI_OUT_OF_RESOURCES;
   }
 
+  //
+  // Allocate the copy of the frame sent to the device, sized for the mode so that any resolution works
+  //
+  if (UsbDisplayLinkDev->TransferBuffer != NULL) {
+    FreePool (UsbDisplayLinkDev->TransferBuffer);
+  }
+
+  UsbDisplayLinkDev->TransferBuffer = (UINT8*)AllocateZeroPool (
+    Gop->Mode->Info->HorizontalResolution *
+    Gop->Mode->Info->VerticalResolution * 3);
+
+  if (UsbDisplayLinkDev->TransferBuffer == NULL) {
+    FreePool (UsbDisplayLinkDev->Screen);
+    UsbDisplayLinkDev->Screen = NULL;
+    return EFI_OUT_OF_RESOURCES;
+  }
+
   DEBUG ((DEBUG_INFO, "Video mode %d selected by BIOS - %d x %d.\n", ModeNumber, VideoMode->HActive, VideoMode->VActive));
   // Wait until we are sure that we can set the video mode before we tell the firmware
   Status = DlUsbSendControlWriteMessage (UsbDisplayLinkDev, SET_VIDEO_MODE, 0, VideoMode, sizeof (struct VideoMode));
@@ -496,7 +623,11 @@ DisplayLinkSetMode (
     Gop->Mode->Mode = GRAPHICS_OUTPUT_INVALID_MODE_NUMBER;
     FreePool (UsbDisplayLinkDev->Screen);
     UsbDisplayLinkDev->Screen = NULL;
+    FreePool (UsbDisplayLinkDev->TransferBuffer);
+    UsbDisplayLinkDev->TransferBuffer = NULL;
   } else {
+    // The device has not been sent anything in this mode yet
+    UsbDisplayLinkDev->ForceScreenUpdate = TRUE;
     BuildBackBuffer (
       UsbDisplayLinkDev,
       UsbDisplayLinkDev->Screen,
@@ -161,6 +161,7 @@ InitializeUsbDisplayLinkDevice (
   // Prevent DlGopSendScreenUpdate from running until we are sure that the video mode is set
   UsbDisplayLinkDev->LastY2 = 0;
   UsbDisplayLinkDev->LastY1 = (UINTN)-1;
+  UsbDisplayLinkDev->ScreenUpdatePeriod = DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD;
 
   return EFI_SUCCESS;
 }
@@ -553,7 +554,7 @@ DisplayLinkPeriodicTimer (
   DlGopSendScreenUpdate (UsbDisplayLinkDev);
 
   // Restart the timer now we've finished
-  Status = gBS->SetTimer (UsbDisplayLinkDev->TimerEvent, TimerRelative, DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD);
+  Status = gBS->SetTimer (UsbDisplayLinkDev->TimerEvent, TimerRelative, UsbDisplayLinkDev->ScreenUpdatePeriod);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Failed to create timer.\n"));
   }
@@ -1065,6 +1066,11 @@ UsbDisplayLinkDriverBindingStop (
     UsbDisplayLinkDev->Screen = NULL;
   }
 
+  if (UsbDisplayLinkDev->TransferBuffer != NULL) {
+    FreePool (UsbDisplayLinkDev->TransferBuffer);
+    UsbDisplayLinkDev->TransferBuffer = NULL;
+  }
+
   if (UsbDisplayLinkDev->GraphicsOutputProtocol.Mode) {
     if (UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info) {
       FreePool (UsbDisplayLinkDev->GraphicsOutputProtocol.Mode->Info);
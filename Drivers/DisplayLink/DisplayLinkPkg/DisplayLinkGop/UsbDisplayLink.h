@@ -20,10 +20,12 @@
 #include <Protocol/GraphicsOutput.h>
 #include <Protocol/UsbIo.h>
 
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/ReportStatusCodeLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 
@@ -40,6 +42,7 @@
 #define DISPLAYLINK_USB_BULK_TIMEOUT  (1)
 
 #define DISPLAYLINK_SCREEN_UPDATE_TIMER_PERIOD  ((UINTN)1000000) // 0.1s in us
+#define DISPLAYLINK_SCREEN_UPDATE_MIN_TIMER_PERIOD  ((UINTN)166666) // 1/60s in us
 #define DISPLAYLINK_FULL_SCREEN_UPDATE_PERIOD   ((UINTN)30000) // 3s in ticks
 
 #define DISPLAYLINK_FIXED_VERTICAL_REFRESH_RATE ((UINT16)60)
@@ -85,10 +88,15 @@ typedef struct {
   EFI_EVENT                     DriverExitBootServicesEvent;
   BOOLEAN                       ShowBandwidth;                 /** Debugging - show the bandwidth on the screen */
   BOOLEAN                       ShowTestPattern;               /** Show a colourbar pattern instead of the BLTd contents of the framebuffer */
-  UINTN                         LastY1;                        /** Used to track if we can do a partial screen update */
+  UINTN                         LastX1;                        /** Area BLTted to since the last screen update, empty if LastY2 < LastY1 */
+  UINTN                         LastY1;
+  UINTN                         LastX2;
   UINTN                         LastY2;
+  UINT8                         *TransferBuffer;               /** Frame last sent to the device, 24 bits per pixel */
+  BOOLEAN                       ForceScreenUpdate;             /** Send the next frame even if it matches the last one */
   UINTN                         LastWidth;
   UINTN                         TimeSinceLastScreenUpdate;     /** Do a full screen update every (x) seconds */
+  UINTN                         ScreenUpdatePeriod;            /** Time between screen updates, follows how long the last one took to send */
 } USB_DISPLAYLINK_DEV;
 
 #define USB_DISPLAYLINK_DEV_SIGNATURE SIGNATURE_32 ('d', 'l', 'i', 'n')
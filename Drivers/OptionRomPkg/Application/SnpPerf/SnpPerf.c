@@ -0,0 +1,509 @@
+/** @file
+  Throughput and latency benchmark of the Simple Network Protocol drivers.
+
+  SnpPerf drives an EFI_SIMPLE_NETWORK_PROTOCOL instance directly:
+
+    SnpPerf -l
+    SnpPerf [-i Index] [-m tx|rx|pingpong|echo] [-c Count] [-s Size]
+            [-b Burst] [-t Seconds] [-d Mac]
+
+  tx floods Count frames of Size bytes to Mac (broadcast by default), with
+  up to Burst frames queued in the driver. rx counts the frames of a remote
+  SnpPerf in tx mode. pingpong sends one frame at a time and waits for it
+  to come back, either from a loopback plug or from a remote SnpPerf in
+  echo mode. rx and echo stop after Count frames or when no frame arrived
+  for Seconds, 0 waits forever.
+
+  The report gives the frames per second, the throughput, the CPU cycles
+  per frame where a cycle counter is available, and the latency histogram
+  of each SNP service.
+
+  The test runs at TPL_CALLBACK, so that the MNP poll timer doesn't steal
+  the frames of the benchmark.
+
+  Copyright (c) 2020, ARM Limited. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SnpPerf.h"
+
+STATIC BOOLEAN  mCounterCountsUp;
+
+STATIC CONST SNP_PERF_RUN mSnpPerfRun[] = {
+  SnpPerfRunTx,
+  SnpPerfRunRx,
+  SnpPerfRunPingPong,
+  SnpPerfRunEcho
+};
+
+STATIC CONST CHAR16 *mSnpPerfModeName[] = {
+  L"tx",
+  L"rx",
+  L"pingpong",
+  L"echo"
+};
+
+UINT64
+SnpPerfTimestamp (
+  VOID
+  )
+{
+  return GetPerformanceCounter ();
+}
+
+/**
+  Convert the distance between two timestamps to nanoseconds.
+
+  @param  Start   The earlier timestamp.
+  @param  End     The later timestamp.
+
+  @return The time between Start and End in nanoseconds.
+
+**/
+UINT64
+SnpPerfElapsedNs (
+  IN  UINT64    Start,
+  IN  UINT64    End
+  )
+{
+  return GetTimeInNanoSecond (mCounterCountsUp ? End - Start : Start - End);
+}
+
+/**
+  Read the CPU cycle counter.
+
+  @return The cycle count, 0 on the architectures where no cycle counter
+          is readable from UEFI.
+
+**/
+UINT64
+SnpPerfReadCycles (
+  VOID
+  )
+{
+#if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  return AsmReadTsc ();
+#else
+  return 0;
+#endif
+}
+
+VOID
+SnpPerfHistogramAdd (
+  IN OUT  SNP_PERF_HISTOGRAM    *Histogram,
+  IN      UINT64                Ns
+  )
+{
+  UINTN     Bucket;
+
+  Bucket = (Ns == 0) ? 0 : (UINTN)HighBitSet64 (Ns);
+  if (Bucket >= SNP_PERF_HISTOGRAM_BUCKETS) {
+    Bucket = SNP_PERF_HISTOGRAM_BUCKETS - 1;
+  }
+
+  if (Histogram->Calls == 0 || Ns < Histogram->MinNs) {
+    Histogram->MinNs = Ns;
+  }
+  if (Ns > Histogram->MaxNs) {
+    Histogram->MaxNs = Ns;
+  }
+  Histogram->Calls++;
+  Histogram->TotalNs += Ns;
+  Histogram->Bucket[Bucket]++;
+}
+
+STATIC
+VOID
+SnpPerfPrintHistogram (
+  IN      CONST SNP_PERF_HISTOGRAM    *Histogram
+  )
+{
+  UINTN     Index;
+
+  if (Histogram->Calls == 0) {
+    return;
+  }
+
+  Print (L"%s: %Ld calls, min %Ld ns, avg %Ld ns, max %Ld ns\n",
+    Histogram->Name,
+    Histogram->Calls,
+    Histogram->MinNs,
+    DivU64x64Remainder (Histogram->TotalNs, Histogram->Calls, NULL),
+    Histogram->MaxNs);
+  for (Index = 0; Index < SNP_PERF_HISTOGRAM_BUCKETS; Index++) {
+    if (Histogram->Bucket[Index] != 0) {
+      Print (L"  %10Ld - %10Ld ns: %Ld\n",
+        LShiftU64 (1, Index) & ~1ULL,
+        LShiftU64 (1, Index + 1) - 1,
+        Histogram->Bucket[Index]);
+    }
+  }
+}
+
+STATIC
+VOID
+SnpPerfReport (
+  IN      CONST SNP_PERF_CONTEXT      *Context
+  )
+{
+  Print (L"%Ld frames, %Ld bytes, %Ld lost in %Ld us\n",
+    Context->Frames,
+    Context->Bytes,
+    Context->Lost,
+    DivU64x32 (Context->ElapsedNs, 1000));
+
+  if (Context->Frames != 0 && Context->ElapsedNs != 0) {
+    Print (L"%Ld frames/s, %Ld Mb/s\n",
+      DivU64x64Remainder (MultU64x32 (Context->Frames, 1000000000), Context->ElapsedNs, NULL),
+      DivU64x64Remainder (MultU64x32 (Context->Bytes, 8000), Context->ElapsedNs, NULL));
+  }
+  if (Context->Frames != 0 && Context->Cycles != 0) {
+    Print (L"%Ld CPU cycles per frame\n",
+      DivU64x64Remainder (Context->Cycles, Context->Frames, NULL));
+  }
+
+  SnpPerfPrintHistogram (&Context->TransmitHist);
+  SnpPerfPrintHistogram (&Context->GetStatusHist);
+  SnpPerfPrintHistogram (&Context->ReceiveHist);
+  SnpPerfPrintHistogram (&Context->RoundTripHist);
+}
+
+/**
+  Parse a MAC address of the form xx:xx:xx:xx:xx:xx.
+
+  @param  String    The string to parse.
+  @param  Mac       The parsed address.
+
+  @retval EFI_SUCCESS             The address was parsed.
+  @retval EFI_INVALID_PARAMETER   String isn't a MAC address.
+
+**/
+STATIC
+EFI_STATUS
+SnpPerfParseMac (
+  IN      CONST CHAR16        *String,
+  OUT     EFI_MAC_ADDRESS     *Mac
+  )
+{
+  UINTN     Index;
+  UINTN     Digit;
+  CHAR16    Char;
+
+  ZeroMem (Mac, sizeof (*Mac));
+  for (Index = 0; Index < SNP_PERF_ETHER_ADDR_SIZE * 2; Index++) {
+    Char = *String++;
+    if (Char >= L'0' && Char <= L'9') {
+      Digit = Char - L'0';
+    } else if (Char >= L'a' && Char <= L'f') {
+      Digit = Char - L'a' + 10;
+    } else if (Char >= L'A' && Char <= L'F') {
+      Digit = Char - L'A' + 10;
+    } else {
+      return EFI_INVALID_PARAMETER;
+    }
+    Mac->Addr[Index / 2] = (UINT8)((Mac->Addr[Index / 2] << 4) | Digit);
+
+    if ((Index & 1) != 0 && Index != SNP_PERF_ETHER_ADDR_SIZE * 2 - 1) {
+      if (*String != L':' && *String != L'-') {
+        return EFI_INVALID_PARAMETER;
+      }
+      String++;
+    }
+  }
+
+  return (*String == L'\0') ? EFI_SUCCESS : EFI_INVALID_PARAMETER;
+}
+
+STATIC
+VOID
+SnpPerfUsage (
+  VOID
+  )
+{
+  Print (L"SnpPerf -l\n");
+  Print (L"SnpPerf [-i Index] [-m tx|rx|pingpong|echo] [-c Count] [-s Size]\n");
+  Print (L"        [-b Burst] [-t Seconds] [-d Mac]\n");
+}
+
+/**
+  Parse the command line.
+
+  @param  Argc      The number of arguments.
+  @param  Argv      The arguments.
+  @param  Context   Receives the parameters of the test.
+  @param  List      Set if the SNP instances must be listed.
+  @param  Nic       The index of the SNP instance to test.
+
+  @retval EFI_SUCCESS             The command line was parsed.
+  @retval EFI_INVALID_PARAMETER   The command line is invalid.
+
+**/
+STATIC
+EFI_STATUS
+SnpPerfParseArgs (
+  IN      UINTN               Argc,
+  IN      CHAR16              **Argv,
+  OUT     SNP_PERF_CONTEXT    *Context,
+  OUT     BOOLEAN             *List,
+  OUT     UINTN               *Nic
+  )
+{
+  UINTN     Index;
+  UINTN     Mode;
+  CHAR16    *Value;
+
+  *List = FALSE;
+  *Nic = 0;
+  Context->Mode = SnpPerfModeTx;
+  Context->Count = SNP_PERF_DEFAULT_COUNT;
+  Context->FrameSize = SNP_PERF_ETHER_HEADER_SIZE + 1500;
+  Context->Burst = SNP_PERF_DEFAULT_BURST;
+  Context->Timeout = SNP_PERF_DEFAULT_TIMEOUT;
+  SetMem (&Context->Destination, SNP_PERF_ETHER_ADDR_SIZE, 0xFF);
+
+  for (Index = 1; Index < Argc; Index++) {
+    if (StrCmp (Argv[Index], L"-l") == 0) {
+      *List = TRUE;
+      continue;
+    }
+
+    if (Index + 1 == Argc) {
+      return EFI_INVALID_PARAMETER;
+    }
+    Value = Argv[++Index];
+
+    if (StrCmp (Argv[Index - 1], L"-i") == 0) {
+      *Nic = StrDecimalToUintn (Value);
+    } else if (StrCmp (Argv[Index - 1], L"-m") == 0) {
+      for (Mode = 0; Mode < ARRAY_SIZE (mSnpPerfModeName); Mode++) {
+        if (StrCmp (Value, mSnpPerfModeName[Mode]) == 0) {
+          break;
+        }
+      }
+      if (Mode == ARRAY_SIZE (mSnpPerfModeName)) {
+        return EFI_INVALID_PARAMETER;
+      }
+      Context->Mode = (SNP_PERF_MODE)Mode;
+    } else if (StrCmp (Argv[Index - 1], L"-c") == 0) {
+      Context->Count = StrDecimalToUintn (Value);
+    } else if (StrCmp (Argv[Index - 1], L"-s") == 0) {
+      Context->FrameSize = StrDecimalToUintn (Value);
+    } else if (StrCmp (Argv[Index - 1], L"-b") == 0) {
+      Context->Burst = StrDecimalToUintn (Value);
+    } else if (StrCmp (Argv[Index - 1], L"-t") == 0) {
+      Context->Timeout = StrDecimalToUintn (Value);
+    } else if (StrCmp (Argv[Index - 1], L"-d") == 0) {
+      if (EFI_ERROR (SnpPerfParseMac (Value, &Context->Destination))) {
+        return EFI_INVALID_PARAMETER;
+      }
+    } else {
+      return EFI_INVALID_PARAMETER;
+    }
+  }
+
+  if (Context->Count == 0 ||
+      Context->Count > MAX_UINT32 ||
+      Context->Burst == 0 ||
+      Context->Burst > SNP_PERF_MAX_BURST ||
+      Context->FrameSize < SNP_PERF_MIN_FRAME_SIZE) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Bring an SNP instance to the initialized state and let the frames of the
+  benchmark through.
+
+  @param  Snp           The SNP instance.
+  @param  Started       Set if the instance was stopped and got started.
+  @param  Initialized   Set if the instance got initialized.
+
+  @retval EFI_SUCCESS   The instance is ready.
+  @retval Others        The instance couldn't be started or initialized.
+
+**/
+STATIC
+EFI_STATUS
+SnpPerfOpen (
+  IN      EFI_SIMPLE_NETWORK_PROTOCOL   *Snp,
+  OUT     BOOLEAN                       *Started,
+  OUT     BOOLEAN                       *Initialized
+  )
+{
+  EFI_STATUS    Status;
+  UINT32        Enable;
+
+  *Started = FALSE;
+  *Initialized = FALSE;
+
+  if (Snp->Mode->State == EfiSimpleNetworkStopped) {
+    Status = Snp->Start (Snp);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    *Started = TRUE;
+  }
+  if (Snp->Mode->State == EfiSimpleNetworkStarted) {
+    Status = Snp->Initialize (Snp, 0, 0);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    *Initialized = TRUE;
+  }
+
+  Enable = (EFI_SIMPLE_NETWORK_RECEIVE_UNICAST | EFI_SIMPLE_NETWORK_RECEIVE_BROADCAST) &
+           Snp->Mode->ReceiveFilterMask;
+  if ((Snp->Mode->ReceiveFilterSetting & Enable) != Enable) {
+    Status = Snp->ReceiveFilters (Snp, Enable, 0, FALSE, 0, NULL);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+SnpPerfList (
+  IN      EFI_HANDLE    *Handles,
+  IN      UINTN         HandleCount
+  )
+{
+  EFI_SIMPLE_NETWORK_PROTOCOL   *Snp;
+  UINTN                         Index;
+
+  for (Index = 0; Index < HandleCount; Index++) {
+    if (EFI_ERROR (gBS->HandleProtocol (Handles[Index], &gEfiSimpleNetworkProtocolGuid, (VOID **)&Snp))) {
+      continue;
+    }
+    Print (L"%d: %02x:%02x:%02x:%02x:%02x:%02x state %d media %s max %d\n",
+      Index,
+      Snp->Mode->CurrentAddress.Addr[0], Snp->Mode->CurrentAddress.Addr[1],
+      Snp->Mode->CurrentAddress.Addr[2], Snp->Mode->CurrentAddress.Addr[3],
+      Snp->Mode->CurrentAddress.Addr[4], Snp->Mode->CurrentAddress.Addr[5],
+      Snp->Mode->State,
+      Snp->Mode->MediaPresent ? L"up" : L"down",
+      Snp->Mode->MaxPacketSize);
+  }
+}
+
+/**
+  Entry point of the SnpPerf application.
+
+  @param  ImageHandle   The image handle of the application.
+  @param  SystemTable   The EFI system table.
+
+  @retval EFI_SUCCESS   The benchmark completed.
+  @retval Others        The command line is invalid or the test failed.
+
+**/
+EFI_STATUS
+EFIAPI
+SnpPerfMain (
+  IN      EFI_HANDLE          ImageHandle,
+  IN      EFI_SYSTEM_TABLE    *SystemTable
+  )
+{
+  EFI_STATUS                      Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL   *ShellParameters;
+  EFI_SIMPLE_NETWORK_PROTOCOL     *Snp;
+  SNP_PERF_CONTEXT                *Context;
+  EFI_HANDLE                      *Handles;
+  UINTN                           HandleCount;
+  UINTN                           Nic;
+  BOOLEAN                         List;
+  BOOLEAN                         Started;
+  BOOLEAN                         Initialized;
+  EFI_TPL                         OldTpl;
+  UINT64                          CounterStart;
+  UINT64                          CounterEnd;
+
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **)&ShellParameters);
+  if (EFI_ERROR (Status)) {
+    Print (L"SnpPerf must be started from the shell\n");
+    return Status;
+  }
+
+  Context = AllocateZeroPool (sizeof (*Context));
+  if (Context == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Context->TransmitHist.Name = L"Transmit";
+  Context->GetStatusHist.Name = L"GetStatus";
+  Context->ReceiveHist.Name = L"Receive";
+  Context->RoundTripHist.Name = L"Round trip";
+
+  Status = SnpPerfParseArgs (ShellParameters->Argc, ShellParameters->Argv, Context, &List, &Nic);
+  if (EFI_ERROR (Status)) {
+    SnpPerfUsage ();
+    goto FreeContext;
+  }
+
+  Status = gBS->LocateHandleBuffer (ByProtocol, &gEfiSimpleNetworkProtocolGuid, NULL, &HandleCount, &Handles);
+  if (EFI_ERROR (Status)) {
+    Print (L"No network interface\n");
+    goto FreeContext;
+  }
+  if (List) {
+    SnpPerfList (Handles, HandleCount);
+    goto FreeHandles;
+  }
+  if (Nic >= HandleCount) {
+    Print (L"No network interface %d\n", Nic);
+    Status = EFI_NOT_FOUND;
+    goto FreeHandles;
+  }
+  Status = gBS->HandleProtocol (Handles[Nic], &gEfiSimpleNetworkProtocolGuid, (VOID **)&Snp);
+  if (EFI_ERROR (Status)) {
+    goto FreeHandles;
+  }
+  Context->Snp = Snp;
+
+  Status = SnpPerfOpen (Snp, &Started, &Initialized);
+  if (EFI_ERROR (Status)) {
+    Print (L"Failed to open network interface %d: %r\n", Nic, Status);
+    goto Close;
+  }
+  if (Snp->Mode->MediaHeaderSize != SNP_PERF_ETHER_HEADER_SIZE ||
+      Context->FrameSize > Snp->Mode->MediaHeaderSize + Snp->Mode->MaxPacketSize) {
+    Print (L"Frame size %d not supported by network interface %d\n", Context->FrameSize, Nic);
+    Status = EFI_UNSUPPORTED;
+    goto Close;
+  }
+
+  GetPerformanceCounterProperties (&CounterStart, &CounterEnd);
+  mCounterCountsUp = (CounterEnd > CounterStart);
+
+  Print (L"%s on network interface %d, %d frames of %d bytes\n",
+    mSnpPerfModeName[Context->Mode], Nic, Context->Count, Context->FrameSize);
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  Status = mSnpPerfRun[Context->Mode] (Context);
+  gBS->RestoreTPL (OldTpl);
+
+  if (EFI_ERROR (Status)) {
+    Print (L"Test failed: %r\n", Status);
+  }
+  SnpPerfReport (Context);
+
+Close:
+  if (Initialized) {
+    Snp->Shutdown (Snp);
+  }
+  if (Started) {
+    Snp->Stop (Snp);
+  }
+
+FreeHandles:
+  FreePool (Handles);
+
+FreeContext:
+  FreePool (Context);
+
+  return Status;
+}
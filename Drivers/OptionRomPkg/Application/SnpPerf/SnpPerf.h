@@ -0,0 +1,149 @@
+/** @file
+  Definitions of the SnpPerf application.
+
+  Copyright (c) 2020, ARM Limited. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef SNP_PERF_H_
+#define SNP_PERF_H_
+
+#include <Uefi.h>
+#include <Protocol/ShellParameters.h>
+#include <Protocol/SimpleNetwork.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+
+//
+// IEEE 802 local experimental ethertype, the frames of the benchmark carry
+// it so that they can be told apart from the rest of the traffic.
+//
+#define SNP_PERF_ETHER_TYPE         0x88B5
+#define SNP_PERF_MAGIC              SIGNATURE_32 ('S', 'N', 'P', 'P')
+
+#define SNP_PERF_ETHER_ADDR_SIZE    6
+#define SNP_PERF_ETHER_HEADER_SIZE  14
+#define SNP_PERF_MIN_FRAME_SIZE     60
+
+#define SNP_PERF_DEFAULT_COUNT      100000
+#define SNP_PERF_DEFAULT_BURST      32
+#define SNP_PERF_MAX_BURST          256
+#define SNP_PERF_DEFAULT_TIMEOUT    5             // seconds
+#define SNP_PERF_PING_TIMEOUT       1000000000ULL // nanoseconds
+
+//
+// Power of 2 buckets of the latency histograms, bucket N counts the calls
+// which took [2^N, 2^(N+1)) ns.
+//
+#define SNP_PERF_HISTOGRAM_BUCKETS  32
+
+typedef enum {
+  SnpPerfModeTx,
+  SnpPerfModeRx,
+  SnpPerfModePingPong,
+  SnpPerfModeEcho
+} SNP_PERF_MODE;
+
+#pragma pack(1)
+typedef struct {
+  UINT8                   Destination[SNP_PERF_ETHER_ADDR_SIZE];
+  UINT8                   Source[SNP_PERF_ETHER_ADDR_SIZE];
+  UINT16                  EtherType;        // big endian
+  UINT32                  Magic;
+  UINT32                  Sequence;
+} SNP_PERF_FRAME_HEADER;
+#pragma pack()
+
+typedef struct {
+  CHAR16    *Name;
+  UINT64    Calls;
+  UINT64    TotalNs;
+  UINT64    MinNs;
+  UINT64    MaxNs;
+  UINT64    Bucket[SNP_PERF_HISTOGRAM_BUCKETS];
+} SNP_PERF_HISTOGRAM;
+
+typedef struct {
+  EFI_SIMPLE_NETWORK_PROTOCOL   *Snp;
+  SNP_PERF_MODE                 Mode;
+  UINTN                         Count;
+  UINTN                         FrameSize;
+  UINTN                         Burst;
+  UINTN                         Timeout;
+  EFI_MAC_ADDRESS               Destination;
+
+  //
+  // Results.
+  //
+  UINT64                        Frames;
+  UINT64                        Bytes;
+  UINT64                        Lost;
+  UINT64                        ElapsedNs;
+  UINT64                        Cycles;
+  SNP_PERF_HISTOGRAM            TransmitHist;
+  SNP_PERF_HISTOGRAM            ReceiveHist;
+  SNP_PERF_HISTOGRAM            GetStatusHist;
+  SNP_PERF_HISTOGRAM            RoundTripHist;
+} SNP_PERF_CONTEXT;
+
+typedef
+EFI_STATUS
+(*SNP_PERF_RUN) (
+  IN OUT  SNP_PERF_CONTEXT      *Context
+  );
+
+//
+// Timing helpers, SnpPerf.c.
+//
+UINT64
+SnpPerfTimestamp (
+  VOID
+  );
+
+UINT64
+SnpPerfElapsedNs (
+  IN  UINT64    Start,
+  IN  UINT64    End
+  );
+
+UINT64
+SnpPerfReadCycles (
+  VOID
+  );
+
+VOID
+SnpPerfHistogramAdd (
+  IN OUT  SNP_PERF_HISTOGRAM    *Histogram,
+  IN      UINT64                Ns
+  );
+
+//
+// Test loops, SnpPerfRun.c.
+//
+EFI_STATUS
+SnpPerfRunTx (
+  IN OUT  SNP_PERF_CONTEXT      *Context
+  );
+
+EFI_STATUS
+SnpPerfRunRx (
+  IN OUT  SNP_PERF_CONTEXT      *Context
+  );
+
+EFI_STATUS
+SnpPerfRunPingPong (
+  IN OUT  SNP_PERF_CONTEXT      *Context
+  );
+
+EFI_STATUS
+SnpPerfRunEcho (
+  IN OUT  SNP_PERF_CONTEXT      *Context
+  );
+
+#endif // SNP_PERF_H_
@@ -0,0 +1,632 @@
+/** @file
+  Test loops of the SnpPerf application.
+
+  Every SNP call of a loop is timed and accounted in the histogram of the
+  service. Receive () only accounts the calls which returned a frame, the
+  empty polls would otherwise drown the cost of moving a frame.
+
+  Copyright (c) 2020, ARM Limited. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "SnpPerf.h"
+
+/**
+  Fill a frame of the benchmark.
+
+  The payload past the header is a byte pattern so that corrupted frames
+  are easy to spot in a capture.
+
+  @param  Context   The test context.
+  @param  Frame     The buffer of the frame, Context->FrameSize bytes.
+
+**/
+STATIC
+VOID
+SnpPerfBuildFrame (
+  IN      SNP_PERF_CONTEXT    *Context,
+  OUT     UINT8               *Frame
+  )
+{
+  SNP_PERF_FRAME_HEADER   *Header;
+  UINTN                   Index;
+
+  Header = (SNP_PERF_FRAME_HEADER *)Frame;
+  CopyMem (&Header->Destination, &Context->Destination, SNP_PERF_ETHER_ADDR_SIZE);
+  CopyMem (&Header->Source, &Context->Snp->Mode->CurrentAddress, SNP_PERF_ETHER_ADDR_SIZE);
+  Header->EtherType = SwapBytes16 (SNP_PERF_ETHER_TYPE);
+  Header->Magic = SNP_PERF_MAGIC;
+  Header->Sequence = 0;
+
+  for (Index = sizeof (*Header); Index < Context->FrameSize; Index++) {
+    Frame[Index] = (UINT8)Index;
+  }
+}
+
+/**
+  Check if a received frame belongs to the benchmark.
+
+  @param  Frame     The received frame.
+  @param  Length    The length of the frame.
+
+  @retval TRUE      The frame was sent by SnpPerf.
+  @retval FALSE     The frame is some other traffic.
+
+**/
+STATIC
+BOOLEAN
+SnpPerfIsTestFrame (
+  IN      CONST UINT8         *Frame,
+  IN      UINTN               Length
+  )
+{
+  CONST SNP_PERF_FRAME_HEADER   *Header;
+
+  Header = (CONST SNP_PERF_FRAME_HEADER *)Frame;
+  return (Length >= sizeof (*Header) &&
+          Header->EtherType == SwapBytes16 (SNP_PERF_ETHER_TYPE) &&
+          Header->Magic == SNP_PERF_MAGIC);
+}
+
+/**
+  Check if the idle timeout of the test expired.
+
+  @param  Context   The test context.
+  @param  Since     The timestamp of the last progress.
+
+  @retval TRUE      More than Context->Timeout seconds passed.
+  @retval FALSE     The timeout didn't expire or is disabled.
+
+**/
+STATIC
+BOOLEAN
+SnpPerfTimedOut (
+  IN      SNP_PERF_CONTEXT    *Context,
+  IN      UINT64              Since
+  )
+{
+  if (Context->Timeout == 0) {
+    return FALSE;
+  }
+  return (SnpPerfElapsedNs (Since, SnpPerfTimestamp ()) >
+          MultU64x32 (1000000000ULL, (UINT32)Context->Timeout));
+}
+
+STATIC
+EFI_STATUS
+SnpPerfTransmit (
+  IN OUT  SNP_PERF_CONTEXT    *Context,
+  IN      VOID                *Frame,
+  IN      UINTN               Length
+  )
+{
+  EFI_STATUS    Status;
+  UINT64        Start;
+
+  Start = SnpPerfTimestamp ();
+  Status = Context->Snp->Transmit (Context->Snp, 0, Length, Frame, NULL, NULL, NULL);
+  SnpPerfHistogramAdd (&Context->TransmitHist, SnpPerfElapsedNs (Start, SnpPerfTimestamp ()));
+
+  return Status;
+}
+
+/**
+  Collect one transmitted buffer from the driver.
+
+  @param  Context   The test context.
+
+  @return The recycled buffer, NULL if the driver has none to give back.
+
+**/
+STATIC
+VOID *
+SnpPerfReclaim (
+  IN OUT  SNP_PERF_CONTEXT    *Context
+  )
+{
+  EFI_STATUS    Status;
+  UINT64        Start;
+  VOID          *TxBuf;
+
+  TxBuf = NULL;
+  Start = SnpPerfTimestamp ();
+  Status = Context->Snp->GetStatus (Context->Snp, NULL, &TxBuf);
+  SnpPerfHistogramAdd (&Context->GetStatusHist, SnpPerfElapsedNs (Start, SnpPerfTimestamp ()));
+
+  return EFI_ERROR (Status) ? NULL : TxBuf;
+}
+
+STATIC
+EFI_STATUS
+SnpPerfReceive (
+  IN OUT  SNP_PERF_CONTEXT    *Context,
+  OUT     VOID                *Frame,
+  IN OUT  UINTN               *Length
+  )
+{
+  EFI_STATUS    Status;
+  UINT64        Start;
+
+  Start = SnpPerfTimestamp ();
+  Status = Context->Snp->Receive (Context->Snp, NULL, Length, Frame, NULL, NULL, NULL);
+  if (!EFI_ERROR (Status)) {
+    SnpPerfHistogramAdd (&Context->ReceiveHist, SnpPerfElapsedNs (Start, SnpPerfTimestamp ()));
+  }
+
+  return Status;
+}
+
+/**
+  Transmit a frame, waiting for the driver to have room for it.
+
+  @param  Context   The test context.
+  @param  Frame     The frame to transmit.
+  @param  Length    The length of the frame.
+
+  @retval EFI_SUCCESS   The frame was queued.
+  @retval EFI_TIMEOUT   The transmit ring stayed full.
+  @retval Others        Transmit () failed.
+
+**/
+STATIC
+EFI_STATUS
+SnpPerfTransmitWait (
+  IN OUT  SNP_PERF_CONTEXT    *Context,
+  IN      VOID                *Frame,
+  IN      UINTN               Length
+  )
+{
+  EFI_STATUS    Status;
+  UINT64        Start;
+
+  Start = SnpPerfTimestamp ();
+  while ((Status = SnpPerfTransmit (Context, Frame, Length)) == EFI_NOT_READY) {
+    SnpPerfReclaim (Context);
+    if (SnpPerfElapsedNs (Start, SnpPerfTimestamp ()) > SNP_PERF_PING_TIMEOUT) {
+      return EFI_TIMEOUT;
+    }
+  }
+
+  return Status;
+}
+
+/**
+  Wait until the driver gave back a given transmit buffer.
+
+  @param  Context   The test context.
+  @param  Frame     The buffer to wait for.
+
+  @retval EFI_SUCCESS   The buffer was recycled.
+  @retval EFI_TIMEOUT   The driver didn't recycle it within the timeout.
+
+**/
+STATIC
+EFI_STATUS
+SnpPerfWaitRecycled (
+  IN OUT  SNP_PERF_CONTEXT    *Context,
+  IN      VOID                *Frame
+  )
+{
+  UINT64    Start;
+
+  Start = SnpPerfTimestamp ();
+  while (SnpPerfReclaim (Context) != Frame) {
+    if (SnpPerfElapsedNs (Start, SnpPerfTimestamp ()) > SNP_PERF_PING_TIMEOUT) {
+      return EFI_TIMEOUT;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Send Context->Count frames as fast as the driver accepts them.
+
+  Up to Context->Burst frames are handed to the driver before their buffers
+  have to be recycled, which measures how well the driver overlaps the
+  transmissions.
+
+  @param  Context   The test context.
+
+  @retval EFI_SUCCESS           All frames were sent.
+  @retval EFI_TIMEOUT           The driver stopped recycling the buffers.
+  @retval EFI_OUT_OF_RESOURCES  The frame buffers couldn't be allocated.
+  @retval Others                Transmit () failed.
+
+**/
+EFI_STATUS
+SnpPerfRunTx (
+  IN OUT  SNP_PERF_CONTEXT    *Context
+  )
+{
+  EFI_STATUS    Status;
+  UINT8         *Buffers;
+  BOOLEAN       *Busy;
+  UINTN         Outstanding;
+  UINTN         Sent;
+  UINTN         Index;
+  VOID          *TxBuf;
+  UINT64        Start;
+  UINT64        Progress;
+  UINT64        Cycles;
+
+  Buffers = AllocatePool (Context->Burst * Context->FrameSize);
+  Busy = AllocateZeroPool (Context->Burst * sizeof (BOOLEAN));
+  if (Buffers == NULL || Busy == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+  for (Index = 0; Index < Context->Burst; Index++) {
+    SnpPerfBuildFrame (Context, Buffers + Index * Context->FrameSize);
+  }
+
+  Status = EFI_SUCCESS;
+  Outstanding = 0;
+  Sent = 0;
+  Cycles = SnpPerfReadCycles ();
+  Start = SnpPerfTimestamp ();
+  Progress = Start;
+
+  while (Sent < Context->Count || Outstanding > 0) {
+    //
+    // Queue a burst on the free buffers.
+    //
+    for (Index = 0; Index < Context->Burst && Sent < Context->Count; Index++) {
+      if (Busy[Index]) {
+        continue;
+      }
+      TxBuf = Buffers + Index * Context->FrameSize;
+      ((SNP_PERF_FRAME_HEADER *)TxBuf)->Sequence = (UINT32)Sent;
+      Status = SnpPerfTransmit (Context, TxBuf, Context->FrameSize);
+      if (Status == EFI_NOT_READY) {
+        break;
+      }
+      if (EFI_ERROR (Status)) {
+        goto Done;
+      }
+      Busy[Index] = TRUE;
+      Outstanding++;
+      Sent++;
+      Progress = SnpPerfTimestamp ();
+    }
+
+    //
+    // Take back everything the driver is done with.
+    //
+    while ((TxBuf = SnpPerfReclaim (Context)) != NULL) {
+      Index = ((UINT8 *)TxBuf - Buffers) / Context->FrameSize;
+      if (Index < Context->Burst && Busy[Index]) {
+        Busy[Index] = FALSE;
+        Outstanding--;
+        Progress = SnpPerfTimestamp ();
+      }
+    }
+
+    if (SnpPerfElapsedNs (Progress, SnpPerfTimestamp ()) > SNP_PERF_PING_TIMEOUT) {
+      Status = EFI_TIMEOUT;
+      goto Done;
+    }
+  }
+  Status = EFI_SUCCESS;
+
+Done:
+  Context->ElapsedNs = SnpPerfElapsedNs (Start, Progress);
+  Context->Cycles = SnpPerfReadCycles () - Cycles;
+  Context->Frames = Sent - Outstanding;
+  Context->Bytes = MultU64x32 (Context->Frames, (UINT32)Context->FrameSize);
+  Context->Lost = Outstanding;
+
+  if (Outstanding > 0) {
+    //
+    // The driver still owns some buffers, leak them rather than letting it
+    // DMA from freed memory.
+    //
+    Buffers = NULL;
+  }
+
+Exit:
+  if (Buffers != NULL) {
+    FreePool (Buffers);
+  }
+  if (Busy != NULL) {
+    FreePool (Busy);
+  }
+
+  return Status;
+}
+
+/**
+  Receive up to Context->Count frames of a remote SnpPerf in tx mode.
+
+  The measure starts with the first frame of the benchmark and ends when
+  Context->Count frames arrived or no frame arrived for Context->Timeout
+  seconds. The gaps in the sequence numbers are reported as lost frames.
+
+  @param  Context   The test context.
+
+  @retval EFI_SUCCESS           Frames were received.
+  @retval EFI_TIMEOUT           No frame of the benchmark arrived.
+  @retval EFI_OUT_OF_RESOURCES  The frame buffer couldn't be allocated.
+  @retval Others                Receive () failed.
+
+**/
+EFI_STATUS
+SnpPerfRunRx (
+  IN OUT  SNP_PERF_CONTEXT    *Context
+  )
+{
+  EFI_STATUS              Status;
+  UINT8                   *Frame;
+  UINTN                   BufferSize;
+  UINTN                   Length;
+  UINT32                  Sequence;
+  UINT32                  Expected;
+  UINT64                  Start;
+  UINT64                  Last;
+  UINT64                  Cycles;
+
+  BufferSize = Context->Snp->Mode->MediaHeaderSize + Context->Snp->Mode->MaxPacketSize;
+  Frame = AllocatePool (BufferSize);
+  if (Frame == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Expected = 0;
+  Cycles = 0;
+  Start = 0;
+  Last = SnpPerfTimestamp ();
+
+  while (Context->Frames < Context->Count) {
+    Length = BufferSize;
+    Status = SnpPerfReceive (Context, Frame, &Length);
+    if (Status == EFI_NOT_READY) {
+      if (SnpPerfTimedOut (Context, Last)) {
+        break;
+      }
+      continue;
+    }
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+    if (!SnpPerfIsTestFrame (Frame, Length)) {
+      continue;
+    }
+
+    Last = SnpPerfTimestamp ();
+    Sequence = ((SNP_PERF_FRAME_HEADER *)Frame)->Sequence;
+    if (Context->Frames == 0) {
+      Start = Last;
+      Cycles = SnpPerfReadCycles ();
+    } else if (Sequence > Expected) {
+      Context->Lost += Sequence - Expected;
+    }
+    Expected = Sequence + 1;
+    Context->Frames++;
+    Context->Bytes += Length;
+  }
+
+  if (Context->Frames == 0) {
+    Status = EFI_TIMEOUT;
+    goto Exit;
+  }
+
+  Context->ElapsedNs = SnpPerfElapsedNs (Start, Last);
+  Context->Cycles = SnpPerfReadCycles () - Cycles;
+  Status = EFI_SUCCESS;
+
+Exit:
+  FreePool (Frame);
+  return Status;
+}
+
+/**
+  Measure the round trip of Context->Count frames.
+
+  One frame is in flight at a time, it has to come back from a loopback
+  plug or a remote SnpPerf in echo mode within a second, otherwise it is
+  counted as lost.
+
+  @param  Context   The test context.
+
+  @retval EFI_SUCCESS           The frames were sent.
+  @retval EFI_TIMEOUT           The driver didn't recycle a transmit buffer.
+  @retval EFI_OUT_OF_RESOURCES  The frame buffers couldn't be allocated.
+  @retval Others                Transmit () or Receive () failed.
+
+**/
+EFI_STATUS
+SnpPerfRunPingPong (
+  IN OUT  SNP_PERF_CONTEXT    *Context
+  )
+{
+  EFI_STATUS    Status;
+  UINT8         *TxFrame;
+  UINT8         *RxFrame;
+  UINTN         BufferSize;
+  UINTN         Length;
+  UINTN         Sent;
+  BOOLEAN       Recycled;
+  UINT64        Start;
+  UINT64        SentTime;
+  UINT64        Now;
+  UINT64        Cycles;
+
+  BufferSize = Context->Snp->Mode->MediaHeaderSize + Context->Snp->Mode->MaxPacketSize;
+  TxFrame = AllocatePool (Context->FrameSize);
+  RxFrame = AllocatePool (BufferSize);
+  if (TxFrame == NULL || RxFrame == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+  SnpPerfBuildFrame (Context, TxFrame);
+
+  Status = EFI_SUCCESS;
+  Cycles = SnpPerfReadCycles ();
+  Start = SnpPerfTimestamp ();
+
+  for (Sent = 0; Sent < Context->Count; Sent++) {
+    ((SNP_PERF_FRAME_HEADER *)TxFrame)->Sequence = (UINT32)Sent;
+    SentTime = SnpPerfTimestamp ();
+    Status = SnpPerfTransmitWait (Context, TxFrame, Context->FrameSize);
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+
+    Recycled = FALSE;
+    for (;;) {
+      if (!Recycled) {
+        Recycled = (SnpPerfReclaim (Context) == TxFrame);
+      }
+
+      Length = BufferSize;
+      Status = SnpPerfReceive (Context, RxFrame, &Length);
+      Now = SnpPerfTimestamp ();
+      if (!EFI_ERROR (Status) &&
+          SnpPerfIsTestFrame (RxFrame, Length) &&
+          ((SNP_PERF_FRAME_HEADER *)RxFrame)->Sequence == (UINT32)Sent) {
+        SnpPerfHistogramAdd (&Context->RoundTripHist, SnpPerfElapsedNs (SentTime, Now));
+        Context->Frames++;
+        Context->Bytes += Length;
+        break;
+      }
+      if (EFI_ERROR (Status) && Status != EFI_NOT_READY) {
+        goto Exit;
+      }
+      if (SnpPerfElapsedNs (SentTime, Now) > SNP_PERF_PING_TIMEOUT) {
+        Context->Lost++;
+        break;
+      }
+    }
+
+    //
+    // The frame is rewritten by the next round, the driver must be done
+    // with it.
+    //
+    if (!Recycled) {
+      Status = SnpPerfWaitRecycled (Context, TxFrame);
+      if (EFI_ERROR (Status)) {
+        TxFrame = NULL;
+        goto Exit;
+      }
+    }
+  }
+
+  Context->ElapsedNs = SnpPerfElapsedNs (Start, SnpPerfTimestamp ());
+  Context->Cycles = SnpPerfReadCycles () - Cycles;
+  Status = EFI_SUCCESS;
+
+Exit:
+  if (TxFrame != NULL) {
+    FreePool (TxFrame);
+  }
+  if (RxFrame != NULL) {
+    FreePool (RxFrame);
+  }
+
+  return Status;
+}
+
+/**
+  Send the frames of the benchmark back to their source.
+
+  This is the peer of a remote SnpPerf in pingpong mode. It stops after
+  Context->Count frames or when no frame arrived for Context->Timeout
+  seconds.
+
+  @param  Context   The test context.
+
+  @retval EFI_SUCCESS           Frames were sent back.
+  @retval EFI_TIMEOUT           No frame of the benchmark arrived.
+  @retval EFI_OUT_OF_RESOURCES  The frame buffers couldn't be allocated.
+  @retval Others                Transmit () or Receive () failed.
+
+**/
+EFI_STATUS
+SnpPerfRunEcho (
+  IN OUT  SNP_PERF_CONTEXT    *Context
+  )
+{
+  EFI_STATUS              Status;
+  UINT8                   *TxFrame;
+  UINT8                   *RxFrame;
+  SNP_PERF_FRAME_HEADER   *Header;
+  UINTN                   BufferSize;
+  UINTN                   Length;
+  UINT64                  Start;
+  UINT64                  Last;
+  UINT64                  Cycles;
+
+  BufferSize = Context->Snp->Mode->MediaHeaderSize + Context->Snp->Mode->MaxPacketSize;
+  TxFrame = AllocatePool (BufferSize);
+  RxFrame = AllocatePool (BufferSize);
+  if (TxFrame == NULL || RxFrame == NULL) {
+    Status = EFI_OUT_OF_RESOURCES;
+    goto Exit;
+  }
+
+  Cycles = 0;
+  Start = 0;
+  Last = SnpPerfTimestamp ();
+
+  while (Context->Frames < Context->Count) {
+    Length = BufferSize;
+    Status = SnpPerfReceive (Context, RxFrame, &Length);
+    if (Status == EFI_NOT_READY) {
+      if (SnpPerfTimedOut (Context, Last)) {
+        break;
+      }
+      continue;
+    }
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+    if (!SnpPerfIsTestFrame (RxFrame, Length)) {
+      continue;
+    }
+
+    Last = SnpPerfTimestamp ();
+    if (Context->Frames == 0) {
+      Start = Last;
+      Cycles = SnpPerfReadCycles ();
+    }
+
+    CopyMem (TxFrame, RxFrame, Length);
+    Header = (SNP_PERF_FRAME_HEADER *)TxFrame;
+    CopyMem (&Header->Destination, &((SNP_PERF_FRAME_HEADER *)RxFrame)->Source, SNP_PERF_ETHER_ADDR_SIZE);
+    CopyMem (&Header->Source, &Context->Snp->Mode->CurrentAddress, SNP_PERF_ETHER_ADDR_SIZE);
+
+    Status = SnpPerfTransmitWait (Context, TxFrame, Length);
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+    Status = SnpPerfWaitRecycled (Context, TxFrame);
+    if (EFI_ERROR (Status)) {
+      TxFrame = NULL;
+      goto Exit;
+    }
+
+    Context->Frames++;
+    Context->Bytes += Length;
+  }
+
+  if (Context->Frames == 0) {
+    Status = EFI_TIMEOUT;
+    goto Exit;
+  }
+
+  Context->ElapsedNs = SnpPerfElapsedNs (Start, Last);
+  Context->Cycles = SnpPerfReadCycles () - Cycles;
+  Status = EFI_SUCCESS;
+
+Exit:
+  if (TxFrame != NULL) {
+    FreePool (TxFrame);
+  }
+  if (RxFrame != NULL) {
+    FreePool (RxFrame);
+  }
+
+  return Status;
+}
@@ -68,7 +68,8 @@ GLOBAL_REMOVE_IF_UNREFERENCED EFI_SCSI_PASS_THRU_PROTOCOL gScsiPassThruProtocolT
 
 GLOBAL_REMOVE_IF_UNREFERENCED EFI_EXT_SCSI_PASS_THRU_MODE gExtScsiPassThruMode = {
   4,
-  EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_PHYSICAL | EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_LOGICAL,
+  EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_PHYSICAL | EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_LOGICAL |
+  EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_NONBLOCKIO,
   0
 };
 
@@ -239,6 +240,7 @@ Returns:
                     );
   if (!EFI_ERROR (Status)) {
     Supports &= (EFI_PCI_DEVICE_ENABLE               |
+                 EFI_PCI_IO_ATTRIBUTE_BUS_MASTER     |
                  EFI_PCI_IO_ATTRIBUTE_IDE_PRIMARY_IO |
                  EFI_PCI_IO_ATTRIBUTE_IDE_SECONDARY_IO);
     Status = PciIo->Attributes (
@@ -369,6 +371,13 @@ Returns:
     return Status;
   }
 
+  //
+  // Stop polling the non-blocking requests and fail the outstanding ones.
+  //
+  gBS->CloseEvent (AtapiScsiPrivate->TimerEvent);
+  AtapiAbortAsyncRequests (AtapiScsiPrivate);
+  AtapiFreePrdTables (AtapiScsiPrivate);
+
   //
   // Restore original PCI attributes
   //
@@ -416,6 +425,7 @@ Returns:
   EFI_STATUS                Status;
   ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate;
   IDE_REGISTERS_BASE_ADDR   IdeRegsBaseAddr[ATAPI_MAX_CHANNEL];
+  UINT8                     Channel;
 
   AtapiScsiPrivate = AllocateZeroPool (sizeof (ATAPI_SCSI_PASS_THRU_DEV));
   if (AtapiScsiPrivate == NULL) {
@@ -448,7 +458,44 @@ Returns:
   AtapiScsiPrivate->LatestTargetId  = MAX_TARGET_ID;
   AtapiScsiPrivate->LatestLun       = 0;
 
+  //
+  // DMA and the non-blocking requests. Without a bus master the driver
+  // falls back to PIO.
+  //
+  AtapiAllocatePrdTables (AtapiScsiPrivate);
+
+  for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+    InitializeListHead (&AtapiScsiPrivate->AsyncQueue[Channel]);
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  AtapiAsyncTimerCallback,
+                  AtapiScsiPrivate,
+                  &AtapiScsiPrivate->TimerEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    AtapiFreePrdTables (AtapiScsiPrivate);
+    return Status;
+  }
+
+  Status = gBS->SetTimer (
+                  AtapiScsiPrivate->TimerEvent,
+                  TimerPeriodic,
+                  ATAPI_ASYNC_TIMER_PERIOD
+                  );
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (AtapiScsiPrivate->TimerEvent);
+    AtapiFreePrdTables (AtapiScsiPrivate);
+    return Status;
+  }
+
   Status = InstallScsiPassThruProtocols (&Controller, AtapiScsiPrivate);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (AtapiScsiPrivate->TimerEvent);
+    AtapiFreePrdTables (AtapiScsiPrivate);
+  }
 
   return Status;
 }
@@ -494,6 +541,7 @@ Returns:
 {
   ATAPI_SCSI_PASS_THRU_DEV               *AtapiScsiPrivate;
   EFI_STATUS                             Status;
+  UINT8                                  Channel;
 
   AtapiScsiPrivate = ATAPI_SCSI_PASS_THRU_DEV_FROM_THIS (This);
 
@@ -526,13 +574,10 @@ Returns:
   // (Target Id in [0,1] area, using AtapiIoPortRegisters[0],
   //  Target Id in [2,3] area, using AtapiIoPortRegisters[1]
   //
-  if ((Target / 2) == 0) {
-    Target = Target % 2;
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[0];
-  } else {
-    Target = Target % 2;
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[1];
-  }
+  Channel = (UINT8) (Target / 2);
+  Target  = Target % 2;
+  AtapiAcquireChannel (AtapiScsiPrivate, Channel);
+  AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[Channel];
 
   //
   // the ATAPI SCSI interface does not support non-blocking I/O
@@ -541,6 +586,8 @@ Returns:
   // Performs blocking I/O.
   //
   Status = SubmitBlockingIoCommand (AtapiScsiPrivate, Target, Packet);
+
+  AtapiReleaseChannel (AtapiScsiPrivate, Channel);
   return Status;
 }
 
@@ -803,6 +850,8 @@ Returns:
   // so, the IoPort pointer must point to the right I/O Register group
   //
   for (Index = 0; Index < 2; Index++) {
+    AtapiAcquireChannel (AtapiScsiPrivate, Index);
+
     //
     // Reset
     //
@@ -842,6 +891,8 @@ Returns:
     if (StatusWaitForBSYClear (AtapiScsiPrivate, 31000000) != EFI_TIMEOUT) {
       ResetFlag = TRUE;
     }
+
+    AtapiReleaseChannel (AtapiScsiPrivate, Index);
   }
 
   if (ResetFlag) {
@@ -887,6 +938,7 @@ Returns:
   ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate;
   UINT8                     Command;
   UINT8                     DeviceSelect;
+  UINT8                     Channel;
 
   AtapiScsiPrivate = ATAPI_SCSI_PASS_THRU_DEV_FROM_THIS (This);
 
@@ -905,11 +957,9 @@ Returns:
   // (Target Id in [0,1] area, using AtapiIoPortRegisters[0],
   //  Target Id in [2,3] area, using AtapiIoPortRegisters[1]
   //
-  if ((Target / 2) == 0) {
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[0];
-  } else {
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[1];
-  }
+  Channel = (UINT8) (Target / 2);
+  AtapiAcquireChannel (AtapiScsiPrivate, Channel);
+  AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[Channel];
 
   //
   // for ATAPI device, no need to wait DRDY ready after device selecting.
@@ -928,6 +978,7 @@ Returns:
   // slave device needs at most 31s to clear BSY
   //
   if (EFI_ERROR (StatusWaitForBSYClear (AtapiScsiPrivate, 31000000))) {
+    AtapiReleaseChannel (AtapiScsiPrivate, Channel);
     return EFI_TIMEOUT;
   }
 
@@ -936,6 +987,7 @@ Returns:
   //
   gBS->Stall (5000000);
 
+  AtapiReleaseChannel (AtapiScsiPrivate, Channel);
   return EFI_SUCCESS;
 }
 
@@ -981,6 +1033,7 @@ Returns:
   EFI_STATUS                          Status;
   ATAPI_SCSI_PASS_THRU_DEV            *AtapiScsiPrivate;
   UINT8                                TargetId;
+  UINT8                                Channel;
 
   AtapiScsiPrivate = ATAPI_EXT_SCSI_PASS_THRU_DEV_FROM_THIS (This);
 
@@ -1018,21 +1071,26 @@ Returns:
   // (Target Id in [0,1] area, using AtapiIoPortRegisters[0],
   //  Target Id in [2,3] area, using AtapiIoPortRegisters[1]
   //
-  if ((TargetId / 2) == 0) {
-    TargetId = (UINT8) (TargetId % 2);
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[0];
-  } else {
-    TargetId = (UINT8) (TargetId % 2);
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[1];
-  }
+  Channel  = (UINT8) (TargetId / 2);
+  TargetId = (UINT8) (TargetId % 2);
 
   //
-  // the ATAPI SCSI interface does not support non-blocking I/O
-  // ignore the Event parameter
+  // Non-blocking requests are queued on the channel and started from the
+  // timer, Event is signaled when they complete.
+  //
+  if (Event != NULL) {
+    return AtapiQueueAsyncRequest (AtapiScsiPrivate, Channel, TargetId, Packet, Event);
+  }
+
   //
   // Performs blocking I/O.
   //
+  AtapiAcquireChannel (AtapiScsiPrivate, Channel);
+  AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[Channel];
+
   Status = SubmitExtBlockingIoCommand (AtapiScsiPrivate, TargetId, Packet);
+
+  AtapiReleaseChannel (AtapiScsiPrivate, Channel);
   return Status;
 }
 
@@ -1110,16 +1168,28 @@ Returns:
     return EFI_INVALID_PARAMETER;
   }
 
-  if (TargetId == MAX_TARGET_ID) {
-    return EFI_NOT_FOUND;
-  }
-
+  //
+  // A new enumeration probes the devices, the ones which are known to be
+  // absent are skipped.
+  //
   if (CompareMem(*Target, ScsiId, TARGET_MAX_BYTES) == 0) {
-    SetMem (*Target, TARGET_MAX_BYTES,0);
+    AtapiScanTargets (AtapiScsiPrivate);
+    TargetId = 0;
   } else {
-    (*Target)[0] = (UINT8) (AtapiScsiPrivate->LatestTargetId + 1);
+    TargetId = (UINT8) (AtapiScsiPrivate->LatestTargetId + 1);
+  }
+
+  while ((TargetId < MAX_TARGET_ID) && !AtapiScsiPrivate->TargetPresent[TargetId]) {
+    TargetId++;
+  }
+
+  if (TargetId >= MAX_TARGET_ID) {
+    return EFI_NOT_FOUND;
   }
 
+  SetMem (*Target, TARGET_MAX_BYTES, 0);
+  (*Target)[0] = TargetId;
+
   *Lun = 0;
 
   //
@@ -1317,6 +1387,8 @@ Returns:
   // And if there is a channel reset successfully, return EFI_SUCCESS.
   //
   for (Index = 0; Index < 2; Index++) {
+    AtapiAcquireChannel (AtapiScsiPrivate, Index);
+
     //
     // Reset
     //
@@ -1356,6 +1428,8 @@ Returns:
     if (StatusWaitForBSYClear (AtapiScsiPrivate, 31000000) != EFI_TIMEOUT) {
       ResetFlag = TRUE;
     }
+
+    AtapiReleaseChannel (AtapiScsiPrivate, Index);
   }
 
   if (ResetFlag) {
@@ -1401,6 +1475,7 @@ Returns:
   UINT8                         Command;
   UINT8                         DeviceSelect;
   UINT8                         TargetId;
+  UINT8                         Channel;
   ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate;
 
   AtapiScsiPrivate = ATAPI_EXT_SCSI_PASS_THRU_DEV_FROM_THIS (This);
@@ -1421,11 +1496,9 @@ Returns:
   // (Target Id in [0,1] area, using AtapiIoPortRegisters[0],
   //  Target Id in [2,3] area, using AtapiIoPortRegisters[1]
   //
-  if ((TargetId / 2) == 0) {
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[0];
-  } else {
-    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[1];
-  }
+  Channel = (UINT8) (TargetId / 2);
+  AtapiAcquireChannel (AtapiScsiPrivate, Channel);
+  AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[Channel];
 
   //
   // for ATAPI device, no need to wait DRDY ready after device selecting.
@@ -1444,6 +1517,7 @@ Returns:
   // slave device needs at most 31s to clear BSY
   //
   if (EFI_ERROR (StatusWaitForBSYClear (AtapiScsiPrivate, 31000000))) {
+    AtapiReleaseChannel (AtapiScsiPrivate, Channel);
     return EFI_TIMEOUT;
   }
 
@@ -1452,6 +1526,7 @@ Returns:
   //
   gBS->Stall (5000000);
 
+  AtapiReleaseChannel (AtapiScsiPrivate, Channel);
   return EFI_SUCCESS;
 }
 
@@ -1617,6 +1692,22 @@ Returns:
     (UINT16) ((PciData.Device.Bar[3] & 0x0000fffc) + 2);
   }
 
+  //
+  // The bus master registers of both channels are in BAR4, which must be
+  // of IO type as well. Without them the transfers are done by PIO.
+  //
+  if ((PciData.Hdr.ClassCode[0] & IDE_BUS_MASTER_SUPPORTED) != 0 &&
+      (PciData.Device.Bar[4] & BIT0) != 0 &&
+      (PciData.Device.Bar[4] & 0x0000fff0) != 0) {
+    IdeRegsBaseAddr[IdePrimary].BusMasterBaseAddr   =
+    (UINT16) (PciData.Device.Bar[4] & 0x0000fff0);
+    IdeRegsBaseAddr[IdeSecondary].BusMasterBaseAddr =
+    (UINT16) ((PciData.Device.Bar[4] & 0x0000fff0) + BUS_MASTER_CHANNEL_STRIDE);
+  } else {
+    IdeRegsBaseAddr[IdePrimary].BusMasterBaseAddr   = 0;
+    IdeRegsBaseAddr[IdeSecondary].BusMasterBaseAddr = 0;
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -1646,6 +1737,7 @@ Returns:
   UINT8               IdeChannel;
   UINT16              CommandBlockBaseAddr;
   UINT16              ControlBlockBaseAddr;
+  UINT16              BusMasterBaseAddr;
   IDE_BASE_REGISTERS  *RegisterPointer;
 
 
@@ -1671,6 +1763,17 @@ Returns:
 
     (*(UINT16 *) &RegisterPointer->Alt) = ControlBlockBaseAddr;
     RegisterPointer->DriveAddress = (UINT16) (ControlBlockBaseAddr + 0x01);
+
+    BusMasterBaseAddr = IdeRegsBaseAddr[IdeChannel].BusMasterBaseAddr;
+    if (BusMasterBaseAddr != 0) {
+      RegisterPointer->BusMasterCommand  = BusMasterBaseAddr;
+      RegisterPointer->BusMasterStatus   = (UINT16) (BusMasterBaseAddr + 0x02);
+      RegisterPointer->BusMasterPrdTable = (UINT16) (BusMasterBaseAddr + 0x04);
+    } else {
+      RegisterPointer->BusMasterCommand  = 0;
+      RegisterPointer->BusMasterStatus   = 0;
+      RegisterPointer->BusMasterPrdTable = 0;
+    }
   }
 
 }
@@ -2048,11 +2151,69 @@ Arguments:
 
   Returns:            EFI_STATUS
 
+--*/
+{
+  EFI_STATUS  PacketCommandStatus;
+  UINT32      *ByteCount;
+
+  //
+  // Block reads and writes go through the bus master when the device
+  // supports it, everything else is transferred by PIO.
+  //
+  PacketCommandStatus = AtapiExtStartDma (AtapiScsiPrivate, Target, Packet);
+  if (PacketCommandStatus == EFI_UNSUPPORTED) {
+    PacketCommandStatus = AtapiExtPioCommand (AtapiScsiPrivate, Target, Packet);
+  } else if (!EFI_ERROR (PacketCommandStatus)) {
+    if (Packet->DataDirection == DataIn) {
+      ByteCount = &Packet->InTransferLength;
+    } else {
+      ByteCount = &Packet->OutTransferLength;
+    }
+
+    //
+    // Timeout is 100ns unit, convert it to 1000ns (1us) unit.
+    //
+    PacketCommandStatus = AtapiDmaWait (
+                            AtapiScsiPrivate,
+                            DivU64x32 (Packet->Timeout, (UINT32) 10)
+                            );
+    PacketCommandStatus = AtapiDmaFinish (
+                            AtapiScsiPrivate,
+                            Target,
+                            PacketCommandStatus,
+                            ByteCount
+                            );
+  }
+
+  return AtapiExtFinishCommand (AtapiScsiPrivate, Target, Packet, PacketCommandStatus);
+}
+
+EFI_STATUS
+AtapiExtPioCommand (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet
+  )
+/*++
+
+Routine Description:
+
+  Submits the packet command of Packet with PIO data transfers.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             Device 0 or 1 on the channel.
+  Packet:             The SCSI Request Packet to send.
+
+Returns:
+
+  EFI_STATUS
+
 --*/
 {
   UINT8       PacketCommand[12];
   UINT64      TimeoutInMicroSeconds;
-  EFI_STATUS  PacketCommandStatus;
 
   //
   // Fill ATAPI Command Packet according to CDB
@@ -2069,26 +2230,68 @@ Arguments:
   // Submit ATAPI Command Packet
   //
   if (Packet->DataDirection == DataIn) {
-    PacketCommandStatus = AtapiPacketCommand (
-                              AtapiScsiPrivate,
-                              Target,
-                              PacketCommand,
-                              Packet->InDataBuffer,
-                              &(Packet->InTransferLength),
-                              DataIn,
-                              TimeoutInMicroSeconds
-                              );
-  } else {
+    return AtapiPacketCommand (
+             AtapiScsiPrivate,
+             Target,
+             PacketCommand,
+             Packet->InDataBuffer,
+             &(Packet->InTransferLength),
+             DataIn,
+             TimeoutInMicroSeconds
+             );
+  }
 
-    PacketCommandStatus = AtapiPacketCommand (
-                            AtapiScsiPrivate,
-                            Target,
-                            PacketCommand,
-                            Packet->OutDataBuffer,
-                            &(Packet->OutTransferLength),
-                            DataOut,
-                            TimeoutInMicroSeconds
-                            );
+  return AtapiPacketCommand (
+           AtapiScsiPrivate,
+           Target,
+           PacketCommand,
+           Packet->OutDataBuffer,
+           &(Packet->OutTransferLength),
+           DataOut,
+           TimeoutInMicroSeconds
+           );
+}
+
+EFI_STATUS
+AtapiExtFinishCommand (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet,
+  EFI_STATUS                                    PacketCommandStatus
+  )
+/*++
+
+Routine Description:
+
+  Retrieves the sense data of a failed command and fills in the status
+  fields of Packet.
+
+Arguments:
+
+  AtapiScsiPrivate:     Private data structure for the specified channel.
+  Target:               Device 0 or 1 on the channel.
+  Packet:               The SCSI Request Packet which was sent.
+  PacketCommandStatus:  The status of the command.
+
+Returns:
+
+  PacketCommandStatus
+
+--*/
+{
+  //
+  // The status fields are all a non-blocking caller gets back.
+  //
+  Packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_OK;
+  Packet->TargetStatus      = EFI_EXT_SCSI_STATUS_TARGET_GOOD;
+  if (PacketCommandStatus == EFI_TIMEOUT) {
+    Packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_TIMEOUT_COMMAND;
+  } else if (PacketCommandStatus == EFI_BAD_BUFFER_SIZE) {
+    Packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_DATA_OVERRUN_UNDERRUN;
+  } else if (PacketCommandStatus == EFI_DEVICE_ERROR) {
+    Packet->TargetStatus      = EFI_EXT_SCSI_STATUS_TARGET_CHECK_CONDITION;
+  } else if (EFI_ERROR (PacketCommandStatus)) {
+    Packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_OTHER;
   }
 
   if (!EFI_ERROR (PacketCommandStatus) || (Packet->SenseData == NULL)) {
@@ -2107,7 +2310,7 @@ Arguments:
     //
     // avoid submit request sense command continuously.
     //
-    if (PacketCommand[0] == OP_REQUEST_SENSE) {
+    if (((UINT8 *) Packet->Cdb)[0] == OP_REQUEST_SENSE) {
       Packet->SenseDataLength = 0;
       return PacketCommandStatus;
     }
@@ -2119,136 +2322,1177 @@ Arguments:
       Packet->SenseData,
       &Packet->SenseDataLength
       );
+  } else {
+    Packet->SenseDataLength = 0;
   }
 
   return PacketCommandStatus;
 }
 
-
 EFI_STATUS
-AtapiPacketCommand (
-  ATAPI_SCSI_PASS_THRU_DEV    *AtapiScsiPrivate,
-  UINT32                      Target,
-  UINT8                       *PacketCommand,
-  VOID                        *Buffer,
-  UINT32                      *ByteCount,
-  DATA_DIRECTION              Direction,
-  UINT64                      TimeoutInMicroSeconds
+AtapiExtStartDma (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet
   )
 /*++
 
 Routine Description:
 
-  Submits ATAPI command packet to the specified ATAPI device.
+  Starts the packet command of Packet with a bus master DMA transfer.
 
 Arguments:
 
   AtapiScsiPrivate:   Private data structure for the specified channel.
-  Target:             The Target ID of the ATAPI device to send the SCSI
-                      Request Packet. To ATAPI devices attached on an IDE
-                      Channel, Target ID 0 indicates Master device;Target
-                      ID 1 indicates Slave device.
-  PacketCommand:      Points to the ATAPI command packet.
-  Buffer:             Points to the transferred data.
-  ByteCount:          When input,indicates the buffer size; when output,
-                      indicates the actually transferred data size.
-  Direction:          Indicates the data transfer direction.
-  TimeoutInMicroSeconds:
-                      The timeout, in micro second units, to use for the
-                      execution of this ATAPI command.
-                      A TimeoutInMicroSeconds value of 0 means that
-                      this function will wait indefinitely for the ATAPI
-                      command to execute.
-                      If TimeoutInMicroSeconds is greater than zero, then
-                      this function will return EFI_TIMEOUT if the time
-                      required to execute the ATAPI command is greater
-                      than TimeoutInMicroSeconds.
+  Target:             Device 0 or 1 on the channel.
+  Packet:             The SCSI Request Packet to send.
 
 Returns:
 
-  EFI_STATUS
+  EFI_SUCCESS         - The transfer is in flight.
+  EFI_UNSUPPORTED     - DMA can't be used, nothing was sent to the device.
+  Others              - The command failed.
 
 --*/
 {
-
-  UINT16      *CommandIndex;
-  UINT8       Count;
-  EFI_STATUS  Status;
+  EFI_STATUS                      Status;
+  EFI_PCI_IO_PROTOCOL             *PciIo;
+  IDE_BASE_REGISTERS              *IoPort;
+  UINT8                           Channel;
+  UINT8                           PacketCommand[12];
+  UINT16                          *CommandIndex;
+  UINT8                           Count;
+  UINT64                          TimeoutInMicroSeconds;
+  VOID                            *Buffer;
+  UINT32                          ByteCount;
+  EFI_PCI_IO_PROTOCOL_OPERATION   Operation;
+  UINTN                           MapLength;
+  EFI_PHYSICAL_ADDRESS            DeviceAddress;
+  VOID                            *Mapping;
+  ATAPI_PRD                       *Prd;
+  UINTN                           PrdIndex;
+  UINT32                          Address;
+  UINT32                          Remaining;
+  UINT32                          RegionSize;
+  UINT8                           BusMasterCommand;
+  UINT8                           BusMasterStatus;
+
+  PciIo   = AtapiScsiPrivate->PciIo;
+  IoPort  = AtapiScsiPrivate->IoPort;
+  Channel = ATAPI_CURRENT_CHANNEL (AtapiScsiPrivate);
+
+  if ((AtapiScsiPrivate->PrdTable[Channel] == NULL) ||
+      !AtapiScsiPrivate->TargetDma[Channel * 2 + Target]) {
+    return EFI_UNSUPPORTED;
+  }
 
   //
-  // Set all the command parameters by fill related registers.
-  // Before write to all the following registers, BSY must be 0.
+  // Only the block reads and writes, their data phase is a single
+  // transfer of a known length.
   //
-  Status = StatusWaitForBSYClear (AtapiScsiPrivate, TimeoutInMicroSeconds);
-  if (EFI_ERROR (Status)) {
-    return EFI_DEVICE_ERROR;
+  switch (((UINT8 *) Packet->Cdb)[0]) {
+  case OP_READ_10:
+  case OP_READ_12:
+  case OP_WRITE_10:
+  case OP_WRITE_12:
+    break;
+  default:
+    return EFI_UNSUPPORTED;
   }
 
+  if (Packet->DataDirection == DataIn) {
+    Buffer    = Packet->InDataBuffer;
+    ByteCount = Packet->InTransferLength;
+    Operation = EfiPciIoOperationBusMasterWrite;
+  } else {
+    Buffer    = Packet->OutDataBuffer;
+    ByteCount = Packet->OutTransferLength;
+    Operation = EfiPciIoOperationBusMasterRead;
+  }
+
+  if ((Buffer == NULL) || (ByteCount == 0) || ((ByteCount & BIT0) != 0)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  MapLength = ByteCount;
+  Status = PciIo->Map (PciIo, Operation, Buffer, &MapLength, &DeviceAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    return EFI_UNSUPPORTED;
+  }
 
   //
-  // Select device via Device/Head Register.
-  // "Target = 0" indicates device 0; "Target = 1" indicates device 1
+  // The bus master takes 32-bit word aligned regions.
   //
-  WritePortB (
-    AtapiScsiPrivate->PciIo,
-    AtapiScsiPrivate->IoPort->Head,
-    (UINT8) ((Target << 4) | DEFAULT_CMD) // DEFAULT_CMD: 0xa0 (1010,0000)
-    );
+  if ((MapLength != ByteCount) ||
+      ((DeviceAddress & BIT0) != 0) ||
+      ((DeviceAddress + ByteCount) > BASE_4GB)) {
+    PciIo->Unmap (PciIo, Mapping);
+    return EFI_UNSUPPORTED;
+  }
+
+  Prd       = AtapiScsiPrivate->PrdTable[Channel];
+  Address   = (UINT32) DeviceAddress;
+  Remaining = ByteCount;
+  for (PrdIndex = 0; Remaining > 0; PrdIndex++) {
+    if (PrdIndex == ATAPI_MAX_PRD_ENTRIES) {
+      PciIo->Unmap (PciIo, Mapping);
+      return EFI_UNSUPPORTED;
+    }
+
+    RegionSize = PRD_MAX_REGION_SIZE - (Address & (PRD_MAX_REGION_SIZE - 1));
+    if (RegionSize > Remaining) {
+      RegionSize = Remaining;
+    }
+
+    Prd[PrdIndex].RegionBaseAddr = Address;
+    Prd[PrdIndex].ByteCount      = (UINT16) RegionSize;
+    Prd[PrdIndex].EndOfTable     = 0;
+
+    Address   += RegionSize;
+    Remaining -= RegionSize;
+  }
+  Prd[PrdIndex - 1].EndOfTable = PRD_END_OF_TABLE;
+
+  ZeroMem (&PacketCommand, 12);
+  CopyMem (&PacketCommand, Packet->Cdb, Packet->CdbLength);
 
   //
-  // Set all the command parameters by fill related registers.
-  // Before write to all the following registers, BSY DRQ must be 0.
+  // Timeout is 100ns unit, convert it to 1000ns (1us) unit.
   //
-  Status =  StatusDRQClear(AtapiScsiPrivate,  TimeoutInMicroSeconds);
+  TimeoutInMicroSeconds = DivU64x32 (Packet->Timeout, (UINT32) 10);
+
+  Status = StatusWaitForBSYClear (AtapiScsiPrivate, TimeoutInMicroSeconds);
+  if (EFI_ERROR (Status)) {
+    Status = EFI_DEVICE_ERROR;
+    goto Unmap;
+  }
+
+  WritePortB (PciIo, IoPort->Head, (UINT8) ((Target << 4) | DEFAULT_CMD));
 
+  Status = StatusDRQClear (AtapiScsiPrivate, TimeoutInMicroSeconds);
   if (EFI_ERROR (Status)) {
     if (Status == EFI_ABORTED) {
       Status = EFI_DEVICE_ERROR;
     }
-    *ByteCount = 0;
-    return Status;
+    goto Unmap;
   }
 
   //
-  // No OVL; No DMA (by setting feature register)
+  // No OVL; DMA
   //
-  WritePortB (
-    AtapiScsiPrivate->PciIo,
-    AtapiScsiPrivate->IoPort->Reg1.Feature,
-    0x00
-    );
+  WritePortB (PciIo, IoPort->Reg1.Feature, DMA);
+  WritePortB (PciIo, IoPort->CylinderLsb, (UINT8) (MAX_ATAPI_BYTE_COUNT & 0x00ff));
+  WritePortB (PciIo, IoPort->CylinderMsb, (UINT8) (MAX_ATAPI_BYTE_COUNT >> 8));
 
   //
-  // set the transfersize to MAX_ATAPI_BYTE_COUNT to let the device
-  // determine how much data should be transfered.
+  // Stop the bus master, clear its error and interrupt bits and load the
+  // descriptor table. The direction is set before the engine is started.
   //
-  WritePortB (
-    AtapiScsiPrivate->PciIo,
-    AtapiScsiPrivate->IoPort->CylinderLsb,
-    (UINT8) (MAX_ATAPI_BYTE_COUNT & 0x00ff)
-    );
-  WritePortB (
-    AtapiScsiPrivate->PciIo,
-    AtapiScsiPrivate->IoPort->CylinderMsb,
-    (UINT8) (MAX_ATAPI_BYTE_COUNT >> 8)
-    );
+  WritePortB (PciIo, IoPort->BusMasterCommand, 0);
+  BusMasterStatus = ReadPortB (PciIo, IoPort->BusMasterStatus);
+  WritePortB (PciIo, IoPort->BusMasterStatus, (UINT8) (BusMasterStatus | BMIS_ERROR | BMIS_INTERRUPT));
+  WritePortDW (PciIo, IoPort->BusMasterPrdTable, AtapiScsiPrivate->PrdTablePhysAddr[Channel]);
+
+  BusMasterCommand = (UINT8) ((Packet->DataDirection == DataIn) ? BMIC_WRITE_TO_MEMORY : 0);
+  WritePortB (PciIo, IoPort->BusMasterCommand, BusMasterCommand);
 
   //
-  //  DEFAULT_CTL:0x0a (0000,1010)
-  //  Disable interrupt
+  // The bus master interrupt bit follows INTRQ, which nIEN masks.
   //
-  WritePortB (
-    AtapiScsiPrivate->PciIo,
-    AtapiScsiPrivate->IoPort->Alt.DeviceControl,
-    DEFAULT_CTL
-    );
+  WritePortB (PciIo, IoPort->Alt.DeviceControl, DMA_CTL);
+
+  WritePortB (PciIo, IoPort->Reg.Command, PACKET_CMD);
+
+  Status = StatusDRQReady (AtapiScsiPrivate, TimeoutInMicroSeconds);
+  if (EFI_ERROR (Status)) {
+    if (Status == EFI_ABORTED) {
+      Status = EFI_DEVICE_ERROR;
+    }
+    goto Unmap;
+  }
 
   //
-  // Send Packet command to inform device
-  // that the following data bytes are command packet.
+  // Send out command packet, the device starts the data phase on its own.
   //
-  WritePortB (
-    AtapiScsiPrivate->PciIo,
+  CommandIndex = (UINT16 *) PacketCommand;
+  for (Count = 0; Count < 6; Count++, CommandIndex++) {
+    WritePortW (PciIo, IoPort->Data, *CommandIndex);
+  }
+
+  WritePortB (PciIo, IoPort->BusMasterCommand, (UINT8) (BusMasterCommand | BMIC_START));
+
+  AtapiScsiPrivate->DataMapping[Channel] = Mapping;
+  return EFI_SUCCESS;
+
+Unmap:
+  WritePortB (PciIo, IoPort->Alt.DeviceControl, DEFAULT_CTL);
+  PciIo->Unmap (PciIo, Mapping);
+
+  if (Packet->DataDirection == DataIn) {
+    Packet->InTransferLength = 0;
+  } else {
+    Packet->OutTransferLength = 0;
+  }
+
+  return Status;
+}
+
+EFI_STATUS
+AtapiDmaPoll (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Checks whether the DMA transfer of the current channel has completed.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  EFI_SUCCESS       - The device raised its interrupt.
+  EFI_NOT_READY     - The transfer is still in progress.
+  EFI_DEVICE_ERROR  - The bus master reported an error.
+
+--*/
+{
+  UINT8 BusMasterStatus;
+
+  BusMasterStatus = ReadPortB (
+                      AtapiScsiPrivate->PciIo,
+                      AtapiScsiPrivate->IoPort->BusMasterStatus
+                      );
+  if ((BusMasterStatus & BMIS_ERROR) != 0) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  //
+  // The device interrupts at the end of the command, also when it
+  // transferred less than the descriptors describe.
+  //
+  if ((BusMasterStatus & BMIS_INTERRUPT) != 0) {
+    return EFI_SUCCESS;
+  }
+
+  return EFI_NOT_READY;
+}
+
+EFI_STATUS
+AtapiDmaWait (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT64                        TimeoutInMicroSeconds
+  )
+/*++
+
+Routine Description:
+
+  Waits for the DMA transfer of the current channel, 0 waits forever.
+
+Arguments:
+
+  AtapiScsiPrivate      - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  TimeoutInMicroSeconds - The time to wait for
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+{
+  UINT64      Delay;
+  EFI_STATUS  Status;
+
+  Delay = DivU64x32 (TimeoutInMicroSeconds, ATAPI_DMA_POLL_INTERVAL) + 1;
+
+  do {
+    Status = AtapiDmaPoll (AtapiScsiPrivate);
+    if (Status != EFI_NOT_READY) {
+      return Status;
+    }
+
+    gBS->Stall (ATAPI_DMA_POLL_INTERVAL);
+
+    //
+    // Loop infinitely if not meeting expected condition
+    //
+    if (TimeoutInMicroSeconds != 0) {
+      Delay--;
+    }
+  } while (Delay > 0);
+
+  return EFI_TIMEOUT;
+}
+
+EFI_STATUS
+AtapiDmaFinish (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Target,
+  EFI_STATUS                    DmaStatus,
+  UINT32                        *ByteCount
+  )
+/*++
+
+Routine Description:
+
+  Stops the bus master of the current channel and collects the status of
+  the command. The device is reset if the transfer timed out.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Target            - Device 0 or 1 on the channel
+  DmaStatus         - The result of AtapiDmaPoll () or AtapiDmaWait ()
+  ByteCount         - The transfer length, zeroed on error
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+{
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+  IDE_BASE_REGISTERS    *IoPort;
+  UINT8                 Channel;
+  UINT8                 BusMasterCommand;
+  UINT8                 BusMasterStatus;
+  EFI_STATUS            Status;
+
+  PciIo   = AtapiScsiPrivate->PciIo;
+  IoPort  = AtapiScsiPrivate->IoPort;
+  Channel = ATAPI_CURRENT_CHANNEL (AtapiScsiPrivate);
+
+  BusMasterCommand = ReadPortB (PciIo, IoPort->BusMasterCommand);
+  WritePortB (PciIo, IoPort->BusMasterCommand, (UINT8) (BusMasterCommand & ~BMIC_START));
+  BusMasterStatus = ReadPortB (PciIo, IoPort->BusMasterStatus);
+  WritePortB (PciIo, IoPort->BusMasterStatus, (UINT8) (BusMasterStatus | BMIS_ERROR | BMIS_INTERRUPT));
+
+  Status = DmaStatus;
+  if ((Status == EFI_TIMEOUT) || (Status == EFI_ABORTED)) {
+    //
+    // The device is still in the command, reset it.
+    //
+    WritePortB (PciIo, IoPort->Head, (UINT8) ((BIT7 | BIT5) | (Target << 4)));
+    WritePortB (PciIo, IoPort->Reg.Command, ATAPI_SOFT_RESET_CMD);
+    StatusWaitForBSYClear (AtapiScsiPrivate, 31000000);
+  } else if (!EFI_ERROR (Status)) {
+    //
+    // Reading the status register also deasserts INTRQ.
+    //
+    if (EFI_ERROR (StatusWaitForBSYClear (AtapiScsiPrivate, 1000000))) {
+      Status = EFI_DEVICE_ERROR;
+    } else {
+      Status = AtapiPassThruCheckErrorStatus (AtapiScsiPrivate);
+    }
+  } else {
+    //
+    // The bus master failed, the device won't get another DMA transfer.
+    //
+    DEBUG ((EFI_D_ERROR, "AtapiDmaFinish()-- bus master error %02x, falling back to PIO\n", BusMasterStatus));
+    AtapiScsiPrivate->TargetDma[Channel * 2 + Target] = FALSE;
+    ReadPortB (PciIo, IoPort->Reg.Status);
+  }
+
+  WritePortB (PciIo, IoPort->Alt.DeviceControl, DEFAULT_CTL);
+
+  PciIo->Unmap (PciIo, AtapiScsiPrivate->DataMapping[Channel]);
+  AtapiScsiPrivate->DataMapping[Channel] = NULL;
+
+  if (EFI_ERROR (Status)) {
+    *ByteCount = 0;
+  }
+
+  return Status;
+}
+
+VOID
+AtapiAcquireChannel (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Channel
+  )
+/*++
+
+Routine Description:
+
+  Waits until no request owns Channel and takes it for a blocking request.
+  Must be called below TPL_NOTIFY.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_TPL OldTpl;
+
+  for (;;) {
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    if (!AtapiScsiPrivate->ChannelBusy[Channel]) {
+      //
+      // Push the DMA transfer in flight along rather than wait for the
+      // next timer tick.
+      //
+      if (AtapiScsiPrivate->ActiveRequest[Channel] != NULL) {
+        AtapiServiceChannel (AtapiScsiPrivate, Channel);
+      }
+
+      if (AtapiScsiPrivate->ActiveRequest[Channel] == NULL) {
+        AtapiScsiPrivate->ChannelBusy[Channel] = TRUE;
+        gBS->RestoreTPL (OldTpl);
+        return;
+      }
+    }
+    gBS->RestoreTPL (OldTpl);
+
+    gBS->Stall (ATAPI_DMA_POLL_INTERVAL);
+  }
+}
+
+VOID
+AtapiReleaseChannel (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Channel
+  )
+/*++
+
+Routine Description:
+
+  Releases a channel taken by AtapiAcquireChannel ().
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_TPL OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  AtapiScsiPrivate->ChannelBusy[Channel] = FALSE;
+  gBS->RestoreTPL (OldTpl);
+}
+
+EFI_STATUS
+AtapiQueueAsyncRequest (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Channel,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet,
+  EFI_EVENT                                     Event
+  )
+/*++
+
+Routine Description:
+
+  Queues a non-blocking request, Event is signaled when it completes.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+  Target            - Device 0 or 1 on the channel
+  Packet            - The SCSI Request Packet to send
+  Event             - The event to signal
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+{
+  EFI_STATUS          Status;
+  ATAPI_ASYNC_REQUEST *Request;
+  EFI_TPL             OldTpl;
+
+  Request = AllocateZeroPool (sizeof (ATAPI_ASYNC_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request->Signature = ATAPI_ASYNC_REQUEST_SIGNATURE;
+  Request->Target    = Target;
+  Request->Packet    = Packet;
+  Request->Event     = Event;
+
+  //
+  // The timeout runs from the submission, a timer event measures it.
+  //
+  if (Packet->Timeout != 0) {
+    Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &Request->TimeoutEvent);
+    if (!EFI_ERROR (Status)) {
+      Status = gBS->SetTimer (Request->TimeoutEvent, TimerRelative, Packet->Timeout);
+      if (EFI_ERROR (Status)) {
+        gBS->CloseEvent (Request->TimeoutEvent);
+      }
+    }
+
+    if (EFI_ERROR (Status)) {
+      FreePool (Request);
+      return Status;
+    }
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  InsertTailList (&AtapiScsiPrivate->AsyncQueue[Channel], &Request->Link);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+VOID
+AtapiCompleteAsyncRequest (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  ATAPI_ASYNC_REQUEST           *Request,
+  EFI_STATUS                    Status
+  )
+/*++
+
+Routine Description:
+
+  Fills in the result of a non-blocking request, signals its event and
+  frees it. The request must not be on a queue anymore.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Request           - The request
+  Status            - The status of the command
+
+Returns:
+
+  None
+
+--*/
+{
+  AtapiExtFinishCommand (AtapiScsiPrivate, Request->Target, Request->Packet, Status);
+
+  if (Request->TimeoutEvent != NULL) {
+    gBS->CloseEvent (Request->TimeoutEvent);
+  }
+
+  gBS->SignalEvent (Request->Event);
+  FreePool (Request);
+}
+
+VOID
+AtapiServiceChannel (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Channel
+  )
+/*++
+
+Routine Description:
+
+  Completes the DMA transfer in flight on Channel if it is done, then
+  starts the queued requests. Runs at TPL_NOTIFY.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+
+Returns:
+
+  None
+
+--*/
+{
+  IDE_BASE_REGISTERS                          *SavedIoPort;
+  ATAPI_ASYNC_REQUEST                         *Request;
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET  *Packet;
+  EFI_STATUS                                  Status;
+
+  //
+  // A blocking request of the other channel may have been interrupted,
+  // its IoPort is put back on the way out.
+  //
+  SavedIoPort = AtapiScsiPrivate->IoPort;
+  AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[Channel];
+
+  Request = AtapiScsiPrivate->ActiveRequest[Channel];
+  if (Request != NULL) {
+    Status = AtapiDmaPoll (AtapiScsiPrivate);
+    if (Status == EFI_NOT_READY) {
+      if ((Request->TimeoutEvent == NULL) ||
+          (gBS->CheckEvent (Request->TimeoutEvent) != EFI_SUCCESS)) {
+        goto Done;
+      }
+      Status = EFI_TIMEOUT;
+    }
+
+    Packet = Request->Packet;
+    Status = AtapiDmaFinish (
+               AtapiScsiPrivate,
+               Request->Target,
+               Status,
+               (Packet->DataDirection == DataIn) ? &Packet->InTransferLength : &Packet->OutTransferLength
+               );
+
+    AtapiScsiPrivate->ActiveRequest[Channel] = NULL;
+    AtapiCompleteAsyncRequest (AtapiScsiPrivate, Request, Status);
+  }
+
+  //
+  // Requests which can't use DMA are run to completion right here.
+  //
+  while (!IsListEmpty (&AtapiScsiPrivate->AsyncQueue[Channel])) {
+    Request = ATAPI_ASYNC_REQUEST_FROM_LINK (GetFirstNode (&AtapiScsiPrivate->AsyncQueue[Channel]));
+    RemoveEntryList (&Request->Link);
+
+    Status = AtapiExtStartDma (AtapiScsiPrivate, Request->Target, Request->Packet);
+    if (Status == EFI_SUCCESS) {
+      AtapiScsiPrivate->ActiveRequest[Channel] = Request;
+      break;
+    }
+
+    if (Status == EFI_UNSUPPORTED) {
+      Status = AtapiExtPioCommand (AtapiScsiPrivate, Request->Target, Request->Packet);
+    }
+
+    AtapiCompleteAsyncRequest (AtapiScsiPrivate, Request, Status);
+  }
+
+Done:
+  AtapiScsiPrivate->IoPort = SavedIoPort;
+}
+
+VOID
+EFIAPI
+AtapiAsyncTimerCallback (
+  IN EFI_EVENT                  Event,
+  IN VOID                       *Context
+  )
+/*++
+
+Routine Description:
+
+  Services the non-blocking requests of the channels no blocking request
+  owns.
+
+Arguments:
+
+  Event             - The timer event
+  Context           - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+{
+  ATAPI_SCSI_PASS_THRU_DEV  *AtapiScsiPrivate;
+  UINT8                     Channel;
+
+  AtapiScsiPrivate = (ATAPI_SCSI_PASS_THRU_DEV *) Context;
+
+  for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+    if (!AtapiScsiPrivate->ChannelBusy[Channel]) {
+      AtapiServiceChannel (AtapiScsiPrivate, Channel);
+    }
+  }
+}
+
+VOID
+AtapiAbortAsyncRequests (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Aborts all the non-blocking requests and signals their events.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+{
+  UINT8                                       Channel;
+  ATAPI_ASYNC_REQUEST                         *Request;
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET  *Packet;
+  EFI_TPL                                     OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+
+  for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+    AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[Channel];
+
+    Request = AtapiScsiPrivate->ActiveRequest[Channel];
+    if (Request != NULL) {
+      Packet = Request->Packet;
+      AtapiDmaFinish (
+        AtapiScsiPrivate,
+        Request->Target,
+        EFI_ABORTED,
+        (Packet->DataDirection == DataIn) ? &Packet->InTransferLength : &Packet->OutTransferLength
+        );
+      AtapiScsiPrivate->ActiveRequest[Channel] = NULL;
+      AtapiCompleteAsyncRequest (AtapiScsiPrivate, Request, EFI_ABORTED);
+    }
+
+    while (!IsListEmpty (&AtapiScsiPrivate->AsyncQueue[Channel])) {
+      Request = ATAPI_ASYNC_REQUEST_FROM_LINK (GetFirstNode (&AtapiScsiPrivate->AsyncQueue[Channel]));
+      RemoveEntryList (&Request->Link);
+      AtapiCompleteAsyncRequest (AtapiScsiPrivate, Request, EFI_ABORTED);
+    }
+  }
+
+  gBS->RestoreTPL (OldTpl);
+}
+
+VOID
+AtapiAllocatePrdTables (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Allocates the descriptor tables of the bus master. DMA is left disabled
+  if the controller has no bus master or the allocation fails.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_STATUS            Status;
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+  UINTN                 Bytes;
+  EFI_PHYSICAL_ADDRESS  DeviceAddress;
+  UINT8                 Channel;
+
+  if (AtapiScsiPrivate->AtapiIoPortRegisters[IdePrimary].BusMasterCommand == 0) {
+    return;
+  }
+
+  PciIo = AtapiScsiPrivate->PciIo;
+
+  //
+  // A page per channel, page aligned tables never cross a 64KB boundary.
+  //
+  Status = PciIo->AllocateBuffer (
+                    PciIo,
+                    AllocateAnyPages,
+                    EfiBootServicesData,
+                    ATAPI_MAX_CHANNEL,
+                    &AtapiScsiPrivate->PrdTableBuffer,
+                    0
+                    );
+  if (EFI_ERROR (Status)) {
+    AtapiScsiPrivate->PrdTableBuffer = NULL;
+    return;
+  }
+
+  Bytes = EFI_PAGES_TO_SIZE (ATAPI_MAX_CHANNEL);
+  Status = PciIo->Map (
+                    PciIo,
+                    EfiPciIoOperationBusMasterCommonBuffer,
+                    AtapiScsiPrivate->PrdTableBuffer,
+                    &Bytes,
+                    &DeviceAddress,
+                    &AtapiScsiPrivate->PrdTableMapping
+                    );
+  if (!EFI_ERROR (Status) &&
+      ((Bytes != EFI_PAGES_TO_SIZE (ATAPI_MAX_CHANNEL)) ||
+       ((DeviceAddress + Bytes) > BASE_4GB))) {
+    PciIo->Unmap (PciIo, AtapiScsiPrivate->PrdTableMapping);
+    Status = EFI_UNSUPPORTED;
+  }
+
+  if (EFI_ERROR (Status)) {
+    PciIo->FreeBuffer (PciIo, ATAPI_MAX_CHANNEL, AtapiScsiPrivate->PrdTableBuffer);
+    AtapiScsiPrivate->PrdTableBuffer  = NULL;
+    AtapiScsiPrivate->PrdTableMapping = NULL;
+    return;
+  }
+
+  for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+    AtapiScsiPrivate->PrdTable[Channel] = (ATAPI_PRD *) ((UINT8 *) AtapiScsiPrivate->PrdTableBuffer +
+                                                         EFI_PAGES_TO_SIZE (Channel));
+    AtapiScsiPrivate->PrdTablePhysAddr[Channel] = (UINT32) (DeviceAddress + EFI_PAGES_TO_SIZE (Channel));
+  }
+}
+
+VOID
+AtapiFreePrdTables (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Frees the descriptor tables of the bus master.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+{
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+  UINT8                 Channel;
+
+  if (AtapiScsiPrivate->PrdTableBuffer == NULL) {
+    return;
+  }
+
+  PciIo = AtapiScsiPrivate->PciIo;
+  PciIo->Unmap (PciIo, AtapiScsiPrivate->PrdTableMapping);
+  PciIo->FreeBuffer (PciIo, ATAPI_MAX_CHANNEL, AtapiScsiPrivate->PrdTableBuffer);
+
+  AtapiScsiPrivate->PrdTableBuffer  = NULL;
+  AtapiScsiPrivate->PrdTableMapping = NULL;
+  for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+    AtapiScsiPrivate->PrdTable[Channel] = NULL;
+  }
+}
+
+ATAPI_SCAN_STATE
+AtapiIdentifyPoll (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Target,
+  ATAPI_SCAN_STATE              State,
+  UINT16                        *IdentifyData
+  )
+/*++
+
+Routine Description:
+
+  Advances the IDENTIFY PACKET DEVICE probe of one device of the current
+  channel without waiting.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Target            - Device 0 or 1 on the channel
+  State             - The current state of the probe
+  IdentifyData      - 256 words, receives the identify data
+
+Returns:
+
+  The new state of the probe
+
+--*/
+{
+  EFI_PCI_IO_PROTOCOL   *PciIo;
+  IDE_BASE_REGISTERS    *IoPort;
+  UINT8                 StatusRegister;
+  UINTN                 Index;
+
+  PciIo  = AtapiScsiPrivate->PciIo;
+  IoPort = AtapiScsiPrivate->IoPort;
+
+  if ((State == AtapiScanSelect) || (State == AtapiScanBusy)) {
+    WritePortB (PciIo, IoPort->Head, (UINT8) ((Target << 4) | DEFAULT_CMD));
+
+    //
+    // The status is valid 400ns after the device selection.
+    //
+    gBS->Stall (1);
+
+    //
+    // A floating bus reads back as 0xFF or 0x7F, there's no device.
+    //
+    StatusRegister = ReadPortB (PciIo, IoPort->Reg.Status);
+    if ((StatusRegister == 0xFF) || (StatusRegister == 0x7F)) {
+      return AtapiScanAbsent;
+    }
+
+    if ((StatusRegister & (BSY | DRQ)) != 0) {
+      return AtapiScanBusy;
+    }
+
+    WritePortB (PciIo, IoPort->Alt.DeviceControl, DEFAULT_CTL);
+    WritePortB (PciIo, IoPort->Reg.Command, ATAPI_IDENTIFY_PACKET_CMD);
+    return AtapiScanIdentify;
+  }
+
+  StatusRegister = ReadPortB (PciIo, IoPort->Reg.Status);
+  if ((StatusRegister & BSY) != 0) {
+    return AtapiScanIdentify;
+  }
+
+  //
+  // ATA devices abort the command, they can't take packet commands.
+  //
+  if ((StatusRegister & ERR) != 0) {
+    return AtapiScanAbsent;
+  }
+
+  if ((StatusRegister & DRQ) != 0) {
+    for (Index = 0; Index < 256; Index++) {
+      IdentifyData[Index] = ReadPortW (PciIo, IoPort->Data);
+    }
+    return AtapiScanPresent;
+  }
+
+  //
+  // Device 0 answers for an absent device 1 with a clear status. Give the
+  // device one more poll to raise BSY before deciding.
+  //
+  if (State == AtapiScanNoResponse) {
+    return AtapiScanAbsent;
+  }
+
+  return AtapiScanNoResponse;
+}
+
+VOID
+AtapiScanTargets (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Probes the four devices of the controller, both channels in parallel,
+  and records which are present and which can use DMA.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+{
+  ATAPI_SCAN_STATE  State[ATAPI_MAX_CHANNEL];
+  UINT16            IdentifyData[ATAPI_MAX_CHANNEL][256];
+  UINT8             Channel;
+  UINT8             Device;
+  UINT8             TargetId;
+  UINT32            Elapsed;
+  BOOLEAN           Pending;
+  UINT8             BusMasterStatus;
+  UINT16            *Identify;
+
+  for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+    AtapiAcquireChannel (AtapiScsiPrivate, Channel);
+  }
+
+  for (Device = 0; Device < 2; Device++) {
+    for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+      State[Channel] = AtapiScanSelect;
+    }
+
+    for (Elapsed = 0; ; Elapsed += ATAPI_SCAN_POLL_INTERVAL) {
+      Pending = FALSE;
+      for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+        if ((State[Channel] == AtapiScanPresent) || (State[Channel] == AtapiScanAbsent)) {
+          continue;
+        }
+
+        AtapiScsiPrivate->IoPort = &AtapiScsiPrivate->AtapiIoPortRegisters[Channel];
+        State[Channel] = AtapiIdentifyPoll (AtapiScsiPrivate, Device, State[Channel], IdentifyData[Channel]);
+        if ((State[Channel] != AtapiScanPresent) && (State[Channel] != AtapiScanAbsent)) {
+          Pending = TRUE;
+        }
+      }
+
+      if (!Pending || (Elapsed >= ATAPI_SCAN_TIMEOUT)) {
+        break;
+      }
+
+      gBS->Stall (ATAPI_SCAN_POLL_INTERVAL);
+    }
+
+    for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+      TargetId = (UINT8) (Channel * 2 + Device);
+      AtapiScsiPrivate->TargetDma[TargetId] = FALSE;
+
+      //
+      // A device still busy at the deadline is kept, the commands sent to
+      // it will time out on their own if it never comes back.
+      //
+      if (State[Channel] == AtapiScanAbsent) {
+        AtapiScsiPrivate->TargetPresent[TargetId] = FALSE;
+        continue;
+      }
+
+      AtapiScsiPrivate->TargetPresent[TargetId] = TRUE;
+      if ((State[Channel] != AtapiScanPresent) ||
+          (AtapiScsiPrivate->PrdTable[Channel] == NULL)) {
+        continue;
+      }
+
+      //
+      // DMA is used when the device supports it, a multiword or Ultra DMA
+      // mode is selected and the firmware marked the drive DMA capable in
+      // the bus master status. The timings are left as configured.
+      //
+      Identify = IdentifyData[Channel];
+      BusMasterStatus = ReadPortB (
+                          AtapiScsiPrivate->PciIo,
+                          AtapiScsiPrivate->AtapiIoPortRegisters[Channel].BusMasterStatus
+                          );
+      if (((Identify[49] & BIT8) != 0) &&
+          (((Identify[63] & 0x0700) != 0) ||
+           (((Identify[53] & BIT2) != 0) && ((Identify[88] & 0x7f00) != 0))) &&
+          ((BusMasterStatus & ((Device == 0) ? BMIS_DRV0_DMA_CAPABLE : BMIS_DRV1_DMA_CAPABLE)) != 0)) {
+        AtapiScsiPrivate->TargetDma[TargetId] = TRUE;
+      }
+    }
+  }
+
+  for (Channel = 0; Channel < ATAPI_MAX_CHANNEL; Channel++) {
+    AtapiReleaseChannel (AtapiScsiPrivate, Channel);
+  }
+}
+
+
+EFI_STATUS
+AtapiPacketCommand (
+  ATAPI_SCSI_PASS_THRU_DEV    *AtapiScsiPrivate,
+  UINT32                      Target,
+  UINT8                       *PacketCommand,
+  VOID                        *Buffer,
+  UINT32                      *ByteCount,
+  DATA_DIRECTION              Direction,
+  UINT64                      TimeoutInMicroSeconds
+  )
+/*++
+
+Routine Description:
+
+  Submits ATAPI command packet to the specified ATAPI device.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             The Target ID of the ATAPI device to send the SCSI
+                      Request Packet. To ATAPI devices attached on an IDE
+                      Channel, Target ID 0 indicates Master device;Target
+                      ID 1 indicates Slave device.
+  PacketCommand:      Points to the ATAPI command packet.
+  Buffer:             Points to the transferred data.
+  ByteCount:          When input,indicates the buffer size; when output,
+                      indicates the actually transferred data size.
+  Direction:          Indicates the data transfer direction.
+  TimeoutInMicroSeconds:
+                      The timeout, in micro second units, to use for the
+                      execution of this ATAPI command.
+                      A TimeoutInMicroSeconds value of 0 means that
+                      this function will wait indefinitely for the ATAPI
+                      command to execute.
+                      If TimeoutInMicroSeconds is greater than zero, then
+                      this function will return EFI_TIMEOUT if the time
+                      required to execute the ATAPI command is greater
+                      than TimeoutInMicroSeconds.
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+{
+
+  UINT16      *CommandIndex;
+  UINT8       Count;
+  EFI_STATUS  Status;
+
+  //
+  // Set all the command parameters by fill related registers.
+  // Before write to all the following registers, BSY must be 0.
+  //
+  Status = StatusWaitForBSYClear (AtapiScsiPrivate, TimeoutInMicroSeconds);
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+
+  //
+  // Select device via Device/Head Register.
+  // "Target = 0" indicates device 0; "Target = 1" indicates device 1
+  //
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->Head,
+    (UINT8) ((Target << 4) | DEFAULT_CMD) // DEFAULT_CMD: 0xa0 (1010,0000)
+    );
+
+  //
+  // Set all the command parameters by fill related registers.
+  // Before write to all the following registers, BSY DRQ must be 0.
+  //
+  Status =  StatusDRQClear(AtapiScsiPrivate,  TimeoutInMicroSeconds);
+
+  if (EFI_ERROR (Status)) {
+    if (Status == EFI_ABORTED) {
+      Status = EFI_DEVICE_ERROR;
+    }
+    *ByteCount = 0;
+    return Status;
+  }
+
+  //
+  // No OVL; No DMA (by setting feature register)
+  //
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->Reg1.Feature,
+    0x00
+    );
+
+  //
+  // set the transfersize to MAX_ATAPI_BYTE_COUNT to let the device
+  // determine how much data should be transfered.
+  //
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->CylinderLsb,
+    (UINT8) (MAX_ATAPI_BYTE_COUNT & 0x00ff)
+    );
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->CylinderMsb,
+    (UINT8) (MAX_ATAPI_BYTE_COUNT >> 8)
+    );
+
+  //
+  //  DEFAULT_CTL:0x0a (0000,1010)
+  //  Disable interrupt
+  //
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
+    AtapiScsiPrivate->IoPort->Alt.DeviceControl,
+    DEFAULT_CTL
+    );
+
+  //
+  // Send Packet command to inform device
+  // that the following data bytes are command packet.
+  //
+  WritePortB (
+    AtapiScsiPrivate->PciIo,
     AtapiScsiPrivate->IoPort->Reg.Command,
     PACKET_CMD
     );
@@ -2558,6 +3802,41 @@ Returns:
               );
 }
 
+
+VOID
+WritePortDW (
+  IN  EFI_PCI_IO_PROTOCOL   *PciIo,
+  IN  UINT16                Port,
+  IN  UINT32                Data
+  )
+/*++
+
+Routine Description:
+
+  Write one double word to a specified I/O port.
+
+Arguments:
+
+  PciIo      - The pointer of EFI_PCI_IO_PROTOCOL
+  Port       - IO port
+  Data       - The data to write
+
+Returns:
+
+   NONE
+
+--*/
+{
+  PciIo->Io.Write (
+              PciIo,
+              EfiPciIoWidthUint32,
+              EFI_PCI_IO_PASS_THROUGH_BAR,
+              (UINT64) Port,
+              1,
+              &Data
+              );
+}
+
 EFI_STATUS
 StatusDRQClear (
   ATAPI_SCSI_PASS_THRU_DEV        *AtapiScsiPrivate,
@@ -68,6 +68,7 @@ typedef enum {
 #define IDE_PRIMARY_PROGRAMMABLE_INDICATOR    BIT1
 #define IDE_SECONDARY_OPERATING_MODE          BIT2
 #define IDE_SECONDARY_PROGRAMMABLE_INDICATOR  BIT3
+#define IDE_BUS_MASTER_SUPPORTED              BIT7
 
 
 #define ATAPI_MAX_CHANNEL 2
@@ -86,8 +87,92 @@ typedef struct {
   IDE_CMD_OR_STATUS               Reg;
   IDE_AltStatus_OR_DeviceControl  Alt;
   UINT16                          DriveAddress;
+  //
+  // Bus master IDE registers (SFF-8038i), zero if the controller has none.
+  //
+  UINT16                          BusMasterCommand;
+  UINT16                          BusMasterStatus;
+  UINT16                          BusMasterPrdTable;
 } IDE_BASE_REGISTERS;
 
+//
+// Bus master IDE register bits
+//
+#define BMIC_START              BIT0
+#define BMIC_WRITE_TO_MEMORY    BIT3  ///< The device reads, the controller writes memory
+#define BMIS_ACTIVE             BIT0
+#define BMIS_ERROR              BIT1
+#define BMIS_INTERRUPT          BIT2
+#define BMIS_DRV0_DMA_CAPABLE   BIT5
+#define BMIS_DRV1_DMA_CAPABLE   BIT6
+
+#define BUS_MASTER_CHANNEL_STRIDE 8
+
+///
+/// Physical Region Descriptor, no region may cross a 64KB boundary
+///
+#pragma pack(1)
+typedef struct {
+  UINT32  RegionBaseAddr;
+  UINT16  ByteCount;      ///< 0 means 64KB
+  UINT16  EndOfTable;
+} ATAPI_PRD;
+#pragma pack()
+
+#define PRD_END_OF_TABLE        BIT15
+#define PRD_MAX_REGION_SIZE     SIZE_64KB
+
+//
+// One page of descriptors per channel
+//
+#define ATAPI_MAX_PRD_ENTRIES   (EFI_PAGE_SIZE / sizeof (ATAPI_PRD))
+
+///
+/// A non-blocking ExtScsiPassThru request, queued on its channel
+///
+#define ATAPI_ASYNC_REQUEST_SIGNATURE SIGNATURE_32 ('a', 'p', 'a', 'r')
+
+typedef struct {
+  UINTN                                       Signature;
+  LIST_ENTRY                                  Link;
+  UINT8                                       Target;   ///< Device 0 or 1 on the channel
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET  *Packet;
+  EFI_EVENT                                   Event;
+  EFI_EVENT                                   TimeoutEvent;
+} ATAPI_ASYNC_REQUEST;
+
+#define ATAPI_ASYNC_REQUEST_FROM_LINK(a) \
+  CR (a, ATAPI_ASYNC_REQUEST, Link, ATAPI_ASYNC_REQUEST_SIGNATURE)
+
+//
+// The queues are polled from a timer, this is its period.
+//
+#define ATAPI_ASYNC_TIMER_PERIOD  EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+//
+// Polling interval of a blocking DMA transfer, in microseconds.
+//
+#define ATAPI_DMA_POLL_INTERVAL   10
+
+///
+/// Progress of the IDENTIFY PACKET DEVICE probe of one device
+///
+typedef enum {
+  AtapiScanSelect,
+  AtapiScanBusy,        ///< BSY set when selected, the device may still be resetting
+  AtapiScanIdentify,    ///< Command issued, BSY set
+  AtapiScanNoResponse,  ///< Command issued, neither BSY, DRQ nor ERR
+  AtapiScanPresent,
+  AtapiScanAbsent
+} ATAPI_SCAN_STATE;
+
+//
+// Both channels are probed at the same time, the masters first and then
+// the slaves. Each of the two rounds gives up after ATAPI_SCAN_TIMEOUT.
+//
+#define ATAPI_SCAN_TIMEOUT        1000000
+#define ATAPI_SCAN_POLL_INTERVAL  100
+
 #define ATAPI_SCSI_PASS_THRU_DEV_SIGNATURE  SIGNATURE_32 ('a', 's', 'p', 't')
 
 typedef struct {
@@ -104,14 +189,42 @@ typedef struct {
   IDE_BASE_REGISTERS               AtapiIoPortRegisters[2];
   UINT32                           LatestTargetId;
   UINT64                           LatestLun;
+  //
+  // Filled in by the probe of AtapiExtScsiPassThruGetNextTargetLun ()
+  //
+  BOOLEAN                          TargetPresent[MAX_TARGET_ID];
+  BOOLEAN                          TargetDma[MAX_TARGET_ID];
+  //
+  // Bus master DMA, PrdTable is NULL if it isn't available.
+  //
+  VOID                             *PrdTableBuffer;
+  VOID                             *PrdTableMapping;
+  ATAPI_PRD                        *PrdTable[ATAPI_MAX_CHANNEL];
+  UINT32                           PrdTablePhysAddr[ATAPI_MAX_CHANNEL];
+  VOID                             *DataMapping[ATAPI_MAX_CHANNEL];
+  //
+  // Non-blocking requests. ChannelBusy is owned by a blocking request,
+  // ActiveRequest is the DMA transfer in flight.
+  //
+  EFI_EVENT                        TimerEvent;
+  LIST_ENTRY                       AsyncQueue[ATAPI_MAX_CHANNEL];
+  ATAPI_ASYNC_REQUEST              *ActiveRequest[ATAPI_MAX_CHANNEL];
+  BOOLEAN                          ChannelBusy[ATAPI_MAX_CHANNEL];
 } ATAPI_SCSI_PASS_THRU_DEV;
 
+//
+// The channel the IoPort of a private data structure points to
+//
+#define ATAPI_CURRENT_CHANNEL(a) \
+  ((UINT8) ((a)->IoPort - (a)->AtapiIoPortRegisters))
+
 //
 // IDE registers' base addresses
 //
 typedef struct {
   UINT16  CommandBlockBaseAddr;
   UINT16  ControlBlockBaseAddr;
+  UINT16  BusMasterBaseAddr;
 } IDE_REGISTERS_BASE_ADDR;
 
 #define ATAPI_SCSI_PASS_THRU_DEV_FROM_THIS(a) \
@@ -176,7 +289,8 @@ extern EFI_DRIVER_SUPPORTED_EFI_VERSION_PROTOCOL  gAtapiScsiPassThruDriverSuppor
 //
 // ATA Command
 //
-#define ATAPI_SOFT_RESET_CMD  0x08
+#define ATAPI_SOFT_RESET_CMD      0x08
+#define ATAPI_IDENTIFY_PACKET_CMD 0xA1
 
 typedef enum {
   DataIn  = 0,
@@ -270,6 +384,11 @@ typedef struct {
 // default content of device control register, disable INT
 //
 #define DEFAULT_CTL           (0x0a)
+//
+// device control register with INTRQ enabled, the bus master interrupt
+// status bit follows INTRQ
+//
+#define DMA_CTL               (0x08)
 #define MAX_ATAPI_BYTE_COUNT  (0xfffe)
 
 //
@@ -1101,6 +1220,425 @@ Arguments:
 --*/
 ;
 
+EFI_STATUS
+AtapiExtPioCommand (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet
+  )
+/*++
+
+Routine Description:
+
+  Submits the packet command of Packet with PIO data transfers.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             Device 0 or 1 on the channel.
+  Packet:             The SCSI Request Packet to send.
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+;
+
+EFI_STATUS
+AtapiExtFinishCommand (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet,
+  EFI_STATUS                                    PacketCommandStatus
+  )
+/*++
+
+Routine Description:
+
+  Retrieves the sense data of a failed command and fills in the status
+  fields of Packet.
+
+Arguments:
+
+  AtapiScsiPrivate:     Private data structure for the specified channel.
+  Target:               Device 0 or 1 on the channel.
+  Packet:               The SCSI Request Packet which was sent.
+  PacketCommandStatus:  The status of the command.
+
+Returns:
+
+  PacketCommandStatus
+
+--*/
+;
+
+EFI_STATUS
+AtapiExtStartDma (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet
+  )
+/*++
+
+Routine Description:
+
+  Starts the packet command of Packet with a bus master DMA transfer.
+
+Arguments:
+
+  AtapiScsiPrivate:   Private data structure for the specified channel.
+  Target:             Device 0 or 1 on the channel.
+  Packet:             The SCSI Request Packet to send.
+
+Returns:
+
+  EFI_SUCCESS         - The transfer is in flight.
+  EFI_UNSUPPORTED     - DMA can't be used, nothing was sent to the device.
+  Others              - The command failed.
+
+--*/
+;
+
+EFI_STATUS
+AtapiDmaPoll (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Checks whether the DMA transfer of the current channel has completed.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  EFI_SUCCESS       - The device raised its interrupt.
+  EFI_NOT_READY     - The transfer is still in progress.
+  EFI_DEVICE_ERROR  - The bus master reported an error.
+
+--*/
+;
+
+EFI_STATUS
+AtapiDmaWait (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT64                        TimeoutInMicroSeconds
+  )
+/*++
+
+Routine Description:
+
+  Waits for the DMA transfer of the current channel, 0 waits forever.
+
+Arguments:
+
+  AtapiScsiPrivate      - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  TimeoutInMicroSeconds - The time to wait for
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+;
+
+EFI_STATUS
+AtapiDmaFinish (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Target,
+  EFI_STATUS                    DmaStatus,
+  UINT32                        *ByteCount
+  )
+/*++
+
+Routine Description:
+
+  Stops the bus master of the current channel and collects the status of
+  the command. The device is reset if the transfer timed out.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Target            - Device 0 or 1 on the channel
+  DmaStatus         - The result of AtapiDmaPoll () or AtapiDmaWait ()
+  ByteCount         - The transfer length, zeroed on error
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+;
+
+VOID
+AtapiAcquireChannel (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Channel
+  )
+/*++
+
+Routine Description:
+
+  Waits until no request owns Channel and takes it for a blocking request.
+  Must be called below TPL_NOTIFY.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+AtapiReleaseChannel (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Channel
+  )
+/*++
+
+Routine Description:
+
+  Releases a channel taken by AtapiAcquireChannel ().
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+
+Returns:
+
+  None
+
+--*/
+;
+
+EFI_STATUS
+AtapiQueueAsyncRequest (
+  ATAPI_SCSI_PASS_THRU_DEV                      *AtapiScsiPrivate,
+  UINT8                                         Channel,
+  UINT8                                         Target,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet,
+  EFI_EVENT                                     Event
+  )
+/*++
+
+Routine Description:
+
+  Queues a non-blocking request, Event is signaled when it completes.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+  Target            - Device 0 or 1 on the channel
+  Packet            - The SCSI Request Packet to send
+  Event             - The event to signal
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+;
+
+VOID
+AtapiCompleteAsyncRequest (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  ATAPI_ASYNC_REQUEST           *Request,
+  EFI_STATUS                    Status
+  )
+/*++
+
+Routine Description:
+
+  Fills in the result of a non-blocking request, signals its event and
+  frees it. The request must not be on a queue anymore.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Request           - The request
+  Status            - The status of the command
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+AtapiServiceChannel (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Channel
+  )
+/*++
+
+Routine Description:
+
+  Completes the DMA transfer in flight on Channel if it is done, then
+  starts the queued requests. Runs at TPL_NOTIFY.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Channel           - The IDE channel
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+EFIAPI
+AtapiAsyncTimerCallback (
+  IN EFI_EVENT                  Event,
+  IN VOID                       *Context
+  )
+/*++
+
+Routine Description:
+
+  Services the non-blocking requests of the channels no blocking request
+  owns.
+
+Arguments:
+
+  Event             - The timer event
+  Context           - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+AtapiAbortAsyncRequests (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Aborts all the non-blocking requests and signals their events.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+AtapiAllocatePrdTables (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Allocates the descriptor tables of the bus master. DMA is left disabled
+  if the controller has no bus master or the allocation fails.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+;
+
+VOID
+AtapiFreePrdTables (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Frees the descriptor tables of the bus master.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+;
+
+ATAPI_SCAN_STATE
+AtapiIdentifyPoll (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate,
+  UINT8                         Target,
+  ATAPI_SCAN_STATE              State,
+  UINT16                        *IdentifyData
+  )
+/*++
+
+Routine Description:
+
+  Advances the IDENTIFY PACKET DEVICE probe of one device of the current
+  channel without waiting.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+  Target            - Device 0 or 1 on the channel
+  State             - The current state of the probe
+  IdentifyData      - 256 words, receives the identify data
+
+Returns:
+
+  The new state of the probe
+
+--*/
+;
+
+VOID
+AtapiScanTargets (
+  ATAPI_SCSI_PASS_THRU_DEV      *AtapiScsiPrivate
+  )
+/*++
+
+Routine Description:
+
+  Probes the four devices of the controller, both channels in parallel,
+  and records which are present and which can use DMA.
+
+Arguments:
+
+  AtapiScsiPrivate  - The pointer of ATAPI_SCSI_PASS_THRU_DEV
+
+Returns:
+
+  None
+
+--*/
+;
+
 EFI_STATUS
 RequestSenseCommand (
   ATAPI_SCSI_PASS_THRU_DEV    *AtapiScsiPrivate,
@@ -1276,6 +1814,31 @@ Returns:
 --*/
 ;
 
+VOID
+WritePortDW (
+  IN  EFI_PCI_IO_PROTOCOL   *PciIo,
+  IN  UINT16                Port,
+  IN  UINT32                Data
+  )
+/*++
+
+Routine Description:
+
+  Write one double word to a specified I/O port.
+
+Arguments:
+
+  PciIo      - The pointer of EFI_PCI_IO_PROTOCOL
+  Port       - IO port
+  Data       - The data to write
+
+Returns:
+
+  NONE
+
+--*/
+;
+
 EFI_STATUS
 StatusDRQClear (
   ATAPI_SCSI_PASS_THRU_DEV        *AtapiScsiPrivate,
@@ -231,59 +231,66 @@ ReadDataFromUsb (
   UINTN       ReadBufferSize;
   UINT8       *ReadBuffer;
   UINTN       Index;
+  UINTN       Offset;
+  UINTN       PacketSize;
+  UINTN       Length;
+  UINTN       Free;
   EFI_TPL     Tpl;
-  UINT8       StatusBuffer[2]; // buffer to store the status bytes
 
-  ReadBufferSize = 512;
   ReadBuffer     = &(UsbSerialDevice->ReadBuffer[0]);
 
   if (UsbSerialDevice->Shutdown) {
     return EFI_DEVICE_ERROR;
   }
 
-  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
-
-  Status = UsbSerialDataTransfer (
-             UsbSerialDevice,
-             EfiUsbDataIn,
-             ReadBuffer,
-             &ReadBufferSize,
-             FTDI_TIMEOUT*2  //Padded because timers won't be exactly aligned
-             );
-  if (EFI_ERROR (Status)) {
-    gBS->RestoreTPL (Tpl);
-    if (Status == EFI_TIMEOUT) {
-      return EFI_TIMEOUT;
-    } else {
-      return EFI_DEVICE_ERROR;
-    }
+  PacketSize = UsbSerialDevice->InEndpointDescriptor.MaxPacketSize;
+  if (PacketSize <= FTDI_STATUS_HEADER_LENGTH ||
+      PacketSize > sizeof (UsbSerialDevice->ReadBuffer)) {
+    PacketSize = FTDI_DEFAULT_PACKET_SIZE;
   }
 
+  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+
   //
-  // Store the status bytes in the status buffer
-  //
-  for (Index = 0; Index < 2; Index++) {//only the first 2 bytes are status bytes
-    StatusBuffer[Index] = ReadBuffer[Index];
-  }
-  //
-  // update the statusvalue field of the usbserialdevice
+  // Only ask for as many packets as the software FIFO can take, what is left
+  // stays in the device until the next read.
   //
-  Status = SetStatusInternal (UsbSerialDevice, StatusBuffer);
-  if (Status != EFI_SUCCESS) {
+  Free = (UsbSerialDevice->DataBufferHead + SW_FIFO_DEPTH -
+          UsbSerialDevice->DataBufferTail - 1) % SW_FIFO_DEPTH;
+  ReadBufferSize = (Free / (PacketSize - FTDI_STATUS_HEADER_LENGTH)) * PacketSize;
+  ReadBufferSize = MIN (ReadBufferSize,
+                     (sizeof (UsbSerialDevice->ReadBuffer) / PacketSize) * PacketSize);
+
+  if (ReadBufferSize != 0) {
+    Status = UsbSerialDataTransfer (
+               UsbSerialDevice,
+               EfiUsbDataIn,
+               ReadBuffer,
+               &ReadBufferSize,
+               UsbSerialDevice->ReadTimeout
+               );
+    if (EFI_ERROR (Status)) {
+      gBS->RestoreTPL (Tpl);
+      if (Status == EFI_TIMEOUT) {
+        return EFI_TIMEOUT;
+      } else {
+        return EFI_DEVICE_ERROR;
+      }
+    }
   }
 
   //
-  // Store the read data in the read buffer, start at 2 to ignore status bytes
+  // Each packet starts with the modem status bytes, update the status values
+  // from them and store the rest in the software FIFO.
   //
-  for (Index = 2; Index < ReadBufferSize; Index++) {
-    if (((UsbSerialDevice->DataBufferTail + 1) % SW_FIFO_DEPTH) == UsbSerialDevice->DataBufferHead) {
+  for (Offset = 0; Offset < ReadBufferSize; Offset += PacketSize) {
+    Length = MIN (PacketSize, ReadBufferSize - Offset);
+    if (Length < FTDI_STATUS_HEADER_LENGTH) {
       break;
     }
-    if (ReadBuffer[Index] == 0x00) {
-      //
-      // This is null, do not add
-      //
-    } else {
+    SetStatusInternal (UsbSerialDevice, &ReadBuffer[Offset]);
+
+    for (Index = Offset + FTDI_STATUS_HEADER_LENGTH; Index < Offset + Length; Index++) {
       UsbSerialDevice->DataBuffer[UsbSerialDevice->DataBufferTail] = ReadBuffer[Index];
       UsbSerialDevice->DataBufferTail = (UsbSerialDevice->DataBufferTail + 1) % SW_FIFO_DEPTH;
     }
@@ -378,34 +385,48 @@ UsbSerialDriverCheckInput (
 {
   UINTN        BufferSize;
   USB_SER_DEV  *UsbSerialDevice;
+  UINT32       Tail;
+  UINTN        Period;
 
   UsbSerialDevice = (USB_SER_DEV*)Context;
 
+  //
+  // Keep filling the software FIFO in the background, so that reads are
+  // served from it instead of waiting on the device.
+  //
+  Tail = UsbSerialDevice->DataBufferTail;
+  BufferSize = 0;
+  ReadDataFromUsb (UsbSerialDevice, &BufferSize, NULL);
+
   if (UsbSerialDevice->DataBufferHead == UsbSerialDevice->DataBufferTail) {
     //
-    // Data buffer is empty, try to read from device
+    // Data buffer still has no data, set the EFI_SERIAL_INPUT_BUFFER_EMPTY
+    // flag
     //
-    BufferSize = 0;
-    ReadDataFromUsb (UsbSerialDevice, &BufferSize, NULL);
-    if (UsbSerialDevice->DataBufferHead == UsbSerialDevice->DataBufferTail) {
-      //
-      // Data buffer still has no data, set the EFI_SERIAL_INPUT_BUFFER_EMPTY
-      // flag
-      //
-      UsbSerialDevice->ControlBits |= EFI_SERIAL_INPUT_BUFFER_EMPTY;
-    } else {
-      //
-      // Read has returned some data, clear the EFI_SERIAL_INPUT_BUFFER_EMPTY
-      // flag
-      //
-      UsbSerialDevice->ControlBits &= ~(EFI_SERIAL_INPUT_BUFFER_EMPTY);
-    }
+    UsbSerialDevice->ControlBits |= EFI_SERIAL_INPUT_BUFFER_EMPTY;
   } else {
     //
-    // Data buffer has data, no read attempt required
+    // Data buffer has data, clear the EFI_SERIAL_INPUT_BUFFER_EMPTY flag
     //
     UsbSerialDevice->ControlBits &= ~(EFI_SERIAL_INPUT_BUFFER_EMPTY);
   }
+
+  //
+  // Poll quickly while data is arriving, and back off when the line is idle.
+  //
+  if (UsbSerialDevice->DataBufferTail != Tail) {
+    Period = FTDI_POLL_PERIOD_ACTIVE;
+  } else {
+    Period = FTDI_POLL_PERIOD_IDLE;
+  }
+  if (Period != UsbSerialDevice->PollingPeriod) {
+    UsbSerialDevice->PollingPeriod = Period;
+    gBS->SetTimer (
+           UsbSerialDevice->PollingLoop,
+           TimerPeriodic,
+           EFI_TIMER_PERIOD_MILLISECONDS (Period)
+           );
+  }
 }
 
 /**
@@ -1424,6 +1445,50 @@ ResetInternal (
   return Status;
 }
 
+/**
+  Internal function that sets the latency timer of the Usb Serial Device, the
+  time after which the device returns the data it has received so far.
+
+  @param  UsbIo[in]                  Usb Io Protocol instance pointer
+  @param  Latency[in]                The latency timer value, in ms
+
+  @retval EFI_SUCCESS                The latency timer was set
+  @retval EFI_DEVICE_ERROR           The device is not functioning correctly
+
+**/
+EFI_STATUS
+EFIAPI
+SetLatencyTimerInternal (
+  IN EFI_USB_IO_PROTOCOL  *UsbIo,
+  IN UINT8                Latency
+  )
+{
+  EFI_STATUS              Status;
+  EFI_USB_DEVICE_REQUEST  DevReq;
+  UINT32                  ReturnValue;
+  UINT8                   ConfigurationValue;
+
+  DevReq.Request     = FTDI_COMMAND_SET_LATENCY_TIMER;
+  DevReq.RequestType = USB_REQ_TYPE_VENDOR;
+  DevReq.Value       = Latency;
+  DevReq.Index       = FTDI_PORT_IDENTIFIER;
+  DevReq.Length      = 0; // indicates that there is no data phase in this request
+
+  Status = UsbIo->UsbControlTransfer (
+                    UsbIo,
+                    &DevReq,
+                    EfiUsbDataOut,
+                    WDR_SHORT_TIMEOUT,
+                    &ConfigurationValue,
+                    1,
+                    &ReturnValue
+                    );
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+  return Status;
+}
+
 /**
   Entrypoint of USB Serial Driver.
 
@@ -1704,6 +1769,7 @@ UsbSerialDriverBindingStart (
   EFI_SERIAL_IO_PROTOCOL              *SerialIo;
   UART_DEVICE_PATH                    *Uart;
   UART_FLOW_CONTROL_DEVICE_PATH       *FlowControl;
+  UINT8                               Latency;
   UINT32                              Control;
   EFI_DEVICE_PATH_PROTOCOL            *TempDevicePath;
 
@@ -1936,6 +2002,22 @@ UsbSerialDriverBindingStart (
 
   ASSERT_EFI_ERROR (Status);
 
+  //
+  // A read completes when the latency timer expires, with or without data.
+  // Wait for twice that as timers won't be exactly aligned.
+  //
+  Latency = PcdGet8 (PcdFtdiUsbSerialLatencyTimer);
+  if (Latency == 0) {
+    Latency = FTDI_TIMEOUT;
+  }
+  UsbSerialDevice->ReadTimeout = FTDI_TIMEOUT * 2;
+  Status = SetLatencyTimerInternal (UsbSerialDevice->UsbIo, Latency);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "FtdiUsbSerial: Failed to set the latency timer - %r\n", Status));
+  } else {
+    UsbSerialDevice->ReadTimeout = MAX (Latency * 2, 2);
+  }
+
   //
   // Publish Serial GUID and protocol
   //
@@ -2006,13 +2088,13 @@ UsbSerialDriverBindingStart (
          &(UsbSerialDevice->PollingLoop)
          );
   //
-  // add code to set trigger time based on baud rate
-  // setting to 0.5s for now
+  // The loop speeds up by itself once data arrives
   //
+  UsbSerialDevice->PollingPeriod = FTDI_POLL_PERIOD_IDLE;
   gBS->SetTimer (
          UsbSerialDevice->PollingLoop,
          TimerPeriodic,
-         EFI_TIMER_PERIOD_MILLISECONDS (500)
+         EFI_TIMER_PERIOD_MILLISECONDS (UsbSerialDevice->PollingPeriod)
          );
 
   //
@@ -2494,11 +2576,10 @@ ReadSerialIo (
   }
 
   //
-  // If we haven't filled the caller's buffer using data that we already had on
-  // hand We need to generate an additional USB request to try and fill the
-  // caller's buffer
+  // Only go to the device when there was nothing on hand, the polling loop
+  // keeps the internal buffer filled
   //
-  if (Index != *BufferSize) {
+  if (Index == 0) {
     RemainingCallerBufferSize = *BufferSize - Index;
     Status = ReadDataFromUsb (
                UsbSerialDevice,
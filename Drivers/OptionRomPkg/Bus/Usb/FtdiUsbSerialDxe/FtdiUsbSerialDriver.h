@@ -16,6 +16,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/PcdLib.h>
 
 #include <Protocol/DevicePath.h>
 #include <Protocol/UsbIo.h>
@@ -156,6 +157,19 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 #define FTDI_TIMEOUT       16
 
+//
+// Periods of the input polling loop in ms, while data is arriving and while
+// the line is idle
+//
+#define FTDI_POLL_PERIOD_ACTIVE    10
+#define FTDI_POLL_PERIOD_IDLE      100
+
+//
+// Every packet read from the device starts with the two modem status bytes
+//
+#define FTDI_STATUS_HEADER_LENGTH  2
+#define FTDI_DEFAULT_PACKET_SIZE   64
+
 //
 // FTDI FIFO depth
 //
@@ -240,6 +254,8 @@ typedef struct {
   EFI_SERIAL_IO_PROTOCOL        SerialIo;
   BOOLEAN                       Shutdown;
   EFI_EVENT                     PollingLoop;
+  UINTN                         PollingPeriod;
+  UINT32                        ReadTimeout;
   UINT32                        ControlBits;
   PREVIOUS_ATTRIBUTES           LastSettings;
   CONTROL_BITS                  ControlValues;
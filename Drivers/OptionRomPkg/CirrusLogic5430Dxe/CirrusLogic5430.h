@@ -24,6 +24,8 @@
 #include <Protocol/EdidActive.h>
 #include <Protocol/DevicePath.h>
 
+#include <Guid/EventGroup.h>
+
 #include <Library/DebugLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 #include <Library/UefiLib.h>
@@ -97,8 +99,22 @@ typedef struct {
   CIRRUS_LOGIC_5430_MODE_DATA           ModeData[CIRRUS_LOGIC_5430_MODE_COUNT];
   UINT8                                 *LineBuffer;
   BOOLEAN                               HardwareNeedsStarting;
+  //
+  // GOP shadow frame buffer, one byte per pixel as in video memory. The lines
+  // [DirtyStart, DirtyEnd) have not been written to the device yet.
+  //
+  UINT8                                 *ShadowBuffer;
+  UINTN                                 DirtyStart;
+  UINTN                                 DirtyEnd;
+  EFI_EVENT                             FlushEvent;
+  EFI_EVENT                             ExitBootServicesEvent;
 } CIRRUS_LOGIC_5430_PRIVATE_DATA;
 
+//
+// Period of the shadow frame buffer flush, in 100ns units
+//
+#define CIRRUS_LOGIC_5430_FLUSH_PERIOD  (20 * 1000 * 10)
+
 ///
 /// Video Mode structure
 ///
@@ -60,6 +60,177 @@ CirrusLogic5430CompleteModeData (
 }
 
 
+/**
+  Write the dirty lines of the shadow frame buffer to video memory.
+
+  Whole lines are contiguous in video memory, so the dirty area goes out in
+  one PCI I/O transfer.
+
+  @param  Private             The CirrusLogic5430 private data.
+
+**/
+STATIC
+VOID
+CirrusLogic5430FlushShadow (
+  IN  CIRRUS_LOGIC_5430_PRIVATE_DATA  *Private
+  )
+{
+  UINTN  ScreenWidth;
+  UINTN  Offset;
+  UINTN  Length;
+
+  if (Private->ShadowBuffer == NULL || Private->DirtyEnd <= Private->DirtyStart) {
+    return;
+  }
+
+  ScreenWidth = Private->ModeData[Private->GraphicsOutput.Mode->Mode].HorizontalResolution;
+  Offset      = Private->DirtyStart * ScreenWidth;
+  Length      = (Private->DirtyEnd - Private->DirtyStart) * ScreenWidth;
+
+  if (((Offset & 0x03) == 0) && ((Length & 0x03) == 0)) {
+    Private->PciIo->Mem.Write (
+                          Private->PciIo,
+                          EfiPciIoWidthUint32,
+                          0,
+                          Offset,
+                          Length >> 2,
+                          Private->ShadowBuffer + Offset
+                          );
+  } else {
+    Private->PciIo->Mem.Write (
+                          Private->PciIo,
+                          EfiPciIoWidthUint8,
+                          0,
+                          Offset,
+                          Length,
+                          Private->ShadowBuffer + Offset
+                          );
+  }
+
+  Private->DirtyStart = 0;
+  Private->DirtyEnd   = 0;
+}
+
+/**
+  Periodic timer and ExitBootServices handler, writes the pending lines of
+  the shadow frame buffer to the device.
+
+  @param  Event               The event.
+  @param  Context             The CirrusLogic5430 private data.
+
+**/
+STATIC
+VOID
+EFIAPI
+CirrusLogic5430FlushShadowEvent (
+  IN  EFI_EVENT                       Event,
+  IN  VOID                            *Context
+  )
+{
+  EFI_TPL                             OriginalTPL;
+
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  CirrusLogic5430FlushShadow ((CIRRUS_LOGIC_5430_PRIVATE_DATA *) Context);
+  gBS->RestoreTPL (OriginalTPL);
+}
+
+/**
+  Perform a Blt operation on the shadow frame buffer.
+
+  The parameters are those of CirrusLogic5430GraphicsOutputBlt (), already
+  validated, with Delta computed.
+
+**/
+STATIC
+VOID
+CirrusLogic5430ShadowBlt (
+  IN  CIRRUS_LOGIC_5430_PRIVATE_DATA        *Private,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_PIXEL         *BltBuffer,
+  IN  EFI_GRAPHICS_OUTPUT_BLT_OPERATION     BltOperation,
+  IN  UINTN                                 SourceX,
+  IN  UINTN                                 SourceY,
+  IN  UINTN                                 DestinationX,
+  IN  UINTN                                 DestinationY,
+  IN  UINTN                                 Width,
+  IN  UINTN                                 Height,
+  IN  UINTN                                 Delta
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL   *Blt;
+  UINTN                           ScreenWidth;
+  UINTN                           Index;
+  UINTN                           Line;
+  UINTN                           X;
+  UINT8                           *Shadow;
+
+  ScreenWidth = Private->ModeData[Private->GraphicsOutput.Mode->Mode].HorizontalResolution;
+
+  switch (BltOperation) {
+  case EfiBltVideoToBltBuffer:
+    for (Index = 0; Index < Height; Index++) {
+      Shadow = Private->ShadowBuffer + (SourceY + Index) * ScreenWidth + SourceX;
+      Blt    = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) ((UINT8 *) BltBuffer + (DestinationY + Index) * Delta) + DestinationX;
+      for (X = 0; X < Width; X++, Blt++) {
+        Blt->Red    = PIXEL_TO_RED_BYTE (Shadow[X]);
+        Blt->Green  = PIXEL_TO_GREEN_BYTE (Shadow[X]);
+        Blt->Blue   = PIXEL_TO_BLUE_BYTE (Shadow[X]);
+      }
+    }
+    //
+    // Nothing to write back to the device
+    //
+    return;
+
+  case EfiBltVideoToVideo:
+    //
+    // Go from the bottom up when moving down, so that the overlapping lines
+    // are read before they are overwritten.
+    //
+    for (Index = 0; Index < Height; Index++) {
+      Line = (DestinationY > SourceY) ? Height - 1 - Index : Index;
+      CopyMem (
+        Private->ShadowBuffer + (DestinationY + Line) * ScreenWidth + DestinationX,
+        Private->ShadowBuffer + (SourceY + Line) * ScreenWidth + SourceX,
+        Width
+        );
+    }
+    break;
+
+  case EfiBltVideoFill:
+    Blt = BltBuffer;
+    for (Index = 0; Index < Height; Index++) {
+      SetMem (
+        Private->ShadowBuffer + (DestinationY + Index) * ScreenWidth + DestinationX,
+        Width,
+        RGB_BYTES_TO_PIXEL (Blt->Red, Blt->Green, Blt->Blue)
+        );
+    }
+    break;
+
+  case EfiBltBufferToVideo:
+    for (Index = 0; Index < Height; Index++) {
+      Shadow = Private->ShadowBuffer + (DestinationY + Index) * ScreenWidth + DestinationX;
+      Blt    = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *) ((UINT8 *) BltBuffer + (SourceY + Index) * Delta) + SourceX;
+      for (X = 0; X < Width; X++, Blt++) {
+        Shadow[X] = RGB_BYTES_TO_PIXEL (Blt->Red, Blt->Green, Blt->Blue);
+      }
+    }
+    break;
+
+  default:
+    ASSERT (FALSE);
+    return;
+  }
+
+  if (Private->DirtyEnd <= Private->DirtyStart) {
+    Private->DirtyStart = DestinationY;
+    Private->DirtyEnd   = DestinationY + Height;
+  } else {
+    Private->DirtyStart = MIN (Private->DirtyStart, DestinationY);
+    Private->DirtyEnd   = MAX (Private->DirtyEnd, DestinationY + Height);
+  }
+}
+
 //
 // Graphics Output Protocol Member Functions
 //
@@ -162,8 +333,23 @@ Routine Description:
     return EFI_OUT_OF_RESOURCES;
   }
 
+  if (Private->ShadowBuffer != NULL) {
+    FreePool (Private->ShadowBuffer);
+    Private->ShadowBuffer = NULL;
+  }
+
   InitializeGraphicsMode (Private, &CirrusLogic5430VideoModes[ModeData->ModeNumber]);
 
+  //
+  // The video memory has just been cleared, so has the shadow. Without one
+  // Blt falls back to accessing video memory directly.
+  //
+  if (FeaturePcdGet (PcdCirrusLogic5430ShadowFrameBuffer)) {
+    Private->ShadowBuffer = AllocateZeroPool (ModeData->HorizontalResolution * ModeData->VerticalResolution);
+    Private->DirtyStart   = 0;
+    Private->DirtyEnd     = 0;
+  }
+
   This->Mode->Mode = ModeNumber;
   This->Mode->Info->HorizontalResolution = ModeData->HorizontalResolution;
   This->Mode->Info->VerticalResolution = ModeData->VerticalResolution;
@@ -292,6 +478,23 @@ Returns:
   //
   OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
 
+  if (Private->ShadowBuffer != NULL) {
+    CirrusLogic5430ShadowBlt (
+      Private,
+      BltBuffer,
+      BltOperation,
+      SourceX,
+      SourceY,
+      DestinationX,
+      DestinationY,
+      Width,
+      Height,
+      Delta
+      );
+    gBS->RestoreTPL (OriginalTPL);
+    return EFI_SUCCESS;
+  }
+
   switch (BltOperation) {
   case EfiBltVideoToBltBuffer:
     //
@@ -512,6 +715,42 @@ CirrusLogic5430GraphicsOutputConstructor (
   Private->GraphicsOutput.Mode->Mode    = GRAPHICS_OUTPUT_INVALIDE_MODE_NUMBER;
   Private->HardwareNeedsStarting        = TRUE;
   Private->LineBuffer                   = NULL;
+  Private->ShadowBuffer                 = NULL;
+  Private->FlushEvent                   = NULL;
+  Private->ExitBootServicesEvent        = NULL;
+
+  if (FeaturePcdGet (PcdCirrusLogic5430ShadowFrameBuffer)) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    CirrusLogic5430FlushShadowEvent,
+                    Private,
+                    &Private->FlushEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Status = gBS->SetTimer (Private->FlushEvent, TimerPeriodic, CIRRUS_LOGIC_5430_FLUSH_PERIOD);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    //
+    // The OS takes over the frame buffer directly, give it the latest picture
+    //
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_NOTIFY,
+                    CirrusLogic5430FlushShadowEvent,
+                    Private,
+                    &gEfiEventExitBootServicesGuid,
+                    &Private->ExitBootServicesEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
 
   //
   // Initialize the hardware
@@ -543,6 +782,22 @@ Returns:
 
 --*/
 {
+  if (Private->FlushEvent != NULL) {
+    gBS->CloseEvent (Private->FlushEvent);
+    Private->FlushEvent = NULL;
+  }
+
+  if (Private->ExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (Private->ExitBootServicesEvent);
+    Private->ExitBootServicesEvent = NULL;
+  }
+
+  if (Private->ShadowBuffer != NULL) {
+    CirrusLogic5430FlushShadow (Private);
+    FreePool (Private->ShadowBuffer);
+    Private->ShadowBuffer = NULL;
+  }
+
   if (Private->GraphicsOutput.Mode != NULL) {
     if (Private->GraphicsOutput.Mode->Info != NULL) {
       gBS->FreePool (Private->GraphicsOutput.Mode->Info);
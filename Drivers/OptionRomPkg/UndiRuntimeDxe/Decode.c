@@ -36,6 +36,25 @@ UNDI_CALL_TABLE api_table[PXE_OPCODE_LAST_VALID+1] = { \
 // end of global variables
 //
 
+/**
+  Read the time stamp used for the per opcode tick counters.
+
+  @return The TSC, 0 where there is none.
+
+**/
+STATIC
+UINT64
+UndiTimestamp (
+  VOID
+  )
+{
+#if defined (MDE_CPU_IA32) || defined (MDE_CPU_X64)
+  return AsmReadTsc ();
+#else
+  return 0;
+#endif
+}
+
 
 /**
   This routine determines the operational state of the UNDI.  It updates the state flags in the
@@ -811,6 +830,8 @@ UNDI_StnAddr (
   CdbPtr->DBaddr.Data[C]   T  Undersize Frames (Frames below minimum length for media <64 for ethernet)
   CdbPtr->DBaddr.Data[E]   T  Dropped Frames (Frames that were dropped because of collisions)
   CdbPtr->DBaddr.Data[14]  T  Total Collision Frames (Total collisions on this subnet)
+  A DB larger than PXE_DB_STATISTICS also gets the E100B_DRIVER_STATISTICS
+  counters of the driver, the reset clears them too.
 
   @param  CdbPtr               Pointer to the command descriptor block.
   @param  AdapterInfo          Pointer to the NIC data structure information which
@@ -1322,9 +1343,31 @@ UNDI_APIEntry_Common (
   PXE_CDB           *CdbPtr;
   NIC_DATA_INSTANCE *AdapterInfo;
   UNDI_CALL_TABLE   *tab_ptr;
+  UINT64            Start;
 
   CdbPtr = (PXE_CDB *) (UINTN) cdb;
 
+  //
+  // Transmit and Receive are issued for every frame. Once the interface is
+  // initialized only check what their handlers dereference, anything else
+  // takes the full validation below so it fails with the usual status.
+  // The entry points already checked IFnum.
+  //
+  if (CdbPtr->OpCode == PXE_OPCODE_TRANSMIT || CdbPtr->OpCode == PXE_OPCODE_RECEIVE) {
+    AdapterInfo = &(UNDI32DeviceList[CdbPtr->IFnum]->NicInfo);
+    if ((AdapterInfo->State == PXE_STATFLAGS_GET_STATE_INITIALIZED) &&
+        (CdbPtr->CPBaddr != PXE_CPBADDR_NOT_USED) &&
+        ((CdbPtr->OpCode == PXE_OPCODE_TRANSMIT) ?
+         (CdbPtr->CPBsize != PXE_CPBSIZE_NOT_USED) :
+         ((CdbPtr->CPBsize == sizeof (PXE_CPB_RECEIVE)) &&
+          (CdbPtr->DBsize == sizeof (PXE_DB_RECEIVE)) &&
+          (CdbPtr->DBaddr != PXE_DBADDR_NOT_USED)))) {
+      AdapterInfo->DriverStats.FastPathCalls++;
+      tab_ptr = &api_table[CdbPtr->OpCode];
+      goto dispatch;
+    }
+  }
+
   //
   // check the OPCODE range
   //
@@ -1396,13 +1439,21 @@ UNDI_APIEntry_Common (
       }
     }
   }
+dispatch:
   //
   // set the return variable for success case here
   //
   CdbPtr->StatFlags = PXE_STATFLAGS_COMMAND_COMPLETE;
   CdbPtr->StatCode  = PXE_STATCODE_SUCCESS;
 
+  //
+  // SNP serializes the UNDI calls at TPL_CALLBACK, the counters need no
+  // further locking.
+  //
+  Start = UndiTimestamp ();
   tab_ptr->api_ptr (CdbPtr, AdapterInfo);
+  AdapterInfo->DriverStats.Ticks[CdbPtr->OpCode] += UndiTimestamp () - Start;
+  AdapterInfo->DriverStats.Calls[CdbPtr->OpCode]++;
   return ;
   //
   // %% AVL - check for command linking
@@ -261,6 +261,7 @@ MapIt (
   UINT64  *PhyAddr;
 
   PhyAddr = (UINT64 *) (UINTN) MappedAddr;
+  AdapterInfo->DriverStats.MapCalls++;
   //
   // mapping is different for theold and new NII protocols
   //
@@ -272,6 +273,7 @@ MapIt (
     }
 
     if (*PhyAddr > FOUR_GIGABYTE) {
+      AdapterInfo->DriverStats.MapFailures++;
       return PXE_STATCODE_INVALID_PARAMETER;
     }
   } else {
@@ -280,6 +282,7 @@ MapIt (
       // this UNDI cannot handle addresses beyond 4 GB without a map routine
       //
       if (MemAddr > FOUR_GIGABYTE) {
+        AdapterInfo->DriverStats.MapFailures++;
         return PXE_STATCODE_INVALID_PARAMETER;
       } else {
         *PhyAddr = MemAddr;
@@ -320,6 +323,7 @@ UnMapIt (
   IN UINT64            MappedAddr
   )
 {
+  AdapterInfo->DriverStats.UnMapCalls++;
   if (AdapterInfo->VersionFlag > 0x30) {
     //
     // no mapping service
@@ -2148,12 +2152,15 @@ E100bStatistics (
   UINT16            DBsize
   )
 {
-  PXE_DB_STATISTICS db;
+  PXE_DB_STATISTICS       db;
+  E100B_DRIVER_STATISTICS *DriverStats;
+  UINT16                  Index;
   //
   // wait upto one second (each wait is 100 micro s)
   //
   UINT32            Wait;
   Wait = 10000;
+  DriverStats = &AdapterInfo->DriverStats;
   wait_for_cmd_done (AdapterInfo->ioaddr + SCBCmd);
 
   //
@@ -2209,6 +2216,7 @@ E100bStatistics (
   // If this is a reset, we are out of here!
   //
   if (DBsize == 0) {
+    ZeroMem (DriverStats, sizeof (*DriverStats));
     return PXE_STATCODE_SUCCESS;
   }
 
@@ -2255,11 +2263,38 @@ E100bStatistics (
                   db.Data[0x0E] +
                   AdapterInfo->statistics->tx_lost_carrier;
 
-  if (DBsize > sizeof db) {
-    DBsize = (UINT16) sizeof (db);
+  if (DBsize <= sizeof db) {
+    CopyMem ((VOID *) (UINTN) DBaddr, (VOID *) &db, (UINTN) DBsize);
+    return PXE_STATCODE_SUCCESS;
+  }
+
+  CopyMem ((VOID *) (UINTN) DBaddr, (VOID *) &db, sizeof db);
+
+  //
+  // The caller asked for the driver counters as well, sample the rings.
+  // Receive frames are pending from cur_rx_ind up to the first RFD the
+  // NIC hasn't completed.
+  //
+  DriverStats->TxRingSize   = AdapterInfo->TxBufCnt;
+  DriverStats->TxRingInUse  = (UINT64) (AdapterInfo->TxBufCnt - AdapterInfo->FreeCBCount);
+  DriverStats->RxRingSize   = AdapterInfo->RxBufCnt;
+  DriverStats->RxRingInUse  = 0;
+
+  Index = AdapterInfo->cur_rx_ind;
+  while (DriverStats->RxRingInUse < AdapterInfo->RxBufCnt &&
+         (AdapterInfo->rx_ring[Index].cb_header.status & RX_COMPLETE) != 0) {
+    DriverStats->RxRingInUse++;
+    if (++Index == AdapterInfo->RxBufCnt) {
+      Index = 0;
+    }
+  }
+
+  DBsize = (UINT16) (DBsize - sizeof db);
+  if (DBsize > sizeof (*DriverStats)) {
+    DBsize = (UINT16) sizeof (*DriverStats);
   }
 
-  CopyMem ((VOID *) (UINTN) DBaddr, (VOID *) &db, (UINTN) DBsize);
+  CopyMem ((VOID *) (UINTN) (DBaddr + sizeof db), (VOID *) DriverStats, (UINTN) DBsize);
 
   return PXE_STATCODE_SUCCESS;
 }
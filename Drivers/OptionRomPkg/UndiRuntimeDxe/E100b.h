@@ -552,6 +552,29 @@ struct Krn_Mem{
 #define HALF_DUPLEX 1
 #define FULL_DUPLEX 2
 
+//
+// Counters kept by the driver itself. The Statistics command returns them
+// right after the PXE_DB_STATISTICS when the DB is large enough, see
+// E100B_DB_STATISTICS. Ticks are TSC cycles and stay 0 on EBC.
+//
+typedef struct {
+  UINT64 Calls[PXE_OPCODE_LAST_VALID + 1];  // per CDB opcode
+  UINT64 Ticks[PXE_OPCODE_LAST_VALID + 1];
+  UINT64 FastPathCalls;   // Transmit/Receive CDBs which skipped the full checks
+  UINT64 MapCalls;
+  UINT64 MapFailures;
+  UINT64 UnMapCalls;
+  UINT64 TxRingSize;      // ring sizes and occupancy, sampled by Statistics
+  UINT64 TxRingInUse;
+  UINT64 RxRingSize;
+  UINT64 RxRingInUse;
+} E100B_DRIVER_STATISTICS;
+
+typedef struct {
+  PXE_DB_STATISTICS       Nic;
+  E100B_DRIVER_STATISTICS Driver;
+} E100B_DB_STATISTICS;
+
 typedef struct s_data_instance {
 
   UINT16 State;  // stopped, started or initialized
@@ -586,6 +609,7 @@ typedef struct s_data_instance {
   UINT16 RxBufSize;
   UINT32 RxTotals;
   UINT32 TxTotals;
+  E100B_DRIVER_STATISTICS DriverStats;
 
   UINT16 int_mask;
   UINT16 Int_Status;
@@ -311,44 +311,19 @@ InitializeAcpiDebugDxe (
 }
 
 /**
-  Software SMI callback for ACPI Debug which is called from ACPI method.
+  Print the oldest pending entry of the ACPI Debug buffer.
 
-  @param[in]      DispatchHandle    The unique handle assigned to this handler by SmiHandlerRegister().
-  @param[in]      Context           Points to an optional handler context which was specified when the
-                                    handler was registered.
-  @param[in, out] CommBuffer        A pointer to a collection of data in memory that will
-                                    be conveyed from a non-SMM environment into an SMM environment.
-  @param[in, out] CommBufferSize    The size of the CommBuffer.
-
-  @retval EFI_SUCCESS               The interrupt was handled successfully.
+  @retval TRUE      Head was advanced, there may be more entries to print.
+  @retval FALSE     The buffer is drained.
 
 **/
-EFI_STATUS
-EFIAPI
-AcpiDebugSmmCallback (
-  IN EFI_HANDLE     DispatchHandle,
-  IN CONST VOID     *Context,
-  IN OUT VOID       *CommBuffer,
-  IN OUT UINTN      *CommBufferSize
+BOOLEAN
+AcpiDebugPrintEntry (
+  VOID
   )
 {
   UINT8             Buffer[MAX_BUFFER_SIZE];
 
-  //
-  // Validate the fields in mAcpiDebug to ensure there is no harm to SMI handler.
-  // mAcpiDebug is below 4GB and the start address of whole buffer.
-  //
-  if ((mAcpiDebug->BufferSize != (mBufferEnd - (UINT32) (UINTN) mAcpiDebug)) ||
-      (mAcpiDebug->Head < (UINT32) ((UINTN) mAcpiDebug + AD_SIZE)) ||
-      (mAcpiDebug->Head > mBufferEnd) ||
-      (mAcpiDebug->Tail < (UINT32) ((UINTN) mAcpiDebug + AD_SIZE)) ||
-      (mAcpiDebug->Tail > mBufferEnd)) {
-    //
-    // If some fields in mAcpiDebug are invaid, return directly.
-    //
-    return EFI_SUCCESS;
-  }
-
   if (!(BOOLEAN)mAcpiDebug->Wrap && ((mAcpiDebug->Head >= (UINT32) ((UINTN) mAcpiDebug + AD_SIZE))
     && (mAcpiDebug->Head < mAcpiDebug->Tail))){
     //
@@ -379,6 +354,7 @@ AcpiDebugSmmCallback (
         //
         mAcpiDebug->Head = mAcpiDebug->Tail;
       }
+      return TRUE;
     }
   } else if ((BOOLEAN) mAcpiDebug->Wrap && ((mAcpiDebug->Head > mAcpiDebug->Tail)
     && (mAcpiDebug->Head < (UINT32) ((UINTN) mAcpiDebug + mAcpiDebug->BufferSize)))){
@@ -398,14 +374,70 @@ AcpiDebugSmmCallback (
       AsciiStrnCpyS ((CHAR8 *) Buffer, MAX_BUFFER_SIZE, (CHAR8 *) (UINTN) mAcpiDebug->Head, MAX_BUFFER_SIZE - 1);
       DEBUG ((DEBUG_INFO | DEBUG_ERROR, "%a%a\n", Buffer, (BOOLEAN) mAcpiDebug->Truncate ? "..." : ""));
       mAcpiDebug->Head += MAX_BUFFER_SIZE;
+    }
 
-      if (mAcpiDebug->Head >= (UINT32) ((UINTN) mAcpiDebug + mAcpiDebug->BufferSize)) {
-        //
-        // We met end of buffer.
-        //
-        mAcpiDebug->Wrap = 0;
-        mAcpiDebug->Head = (UINT32) ((UINTN) mAcpiDebug + AD_SIZE);
-      }
+    if (mAcpiDebug->Head >= (UINT32) ((UINTN) mAcpiDebug + mAcpiDebug->BufferSize)) {
+      //
+      // We met end of buffer.
+      //
+      mAcpiDebug->Wrap = 0;
+      mAcpiDebug->Head = (UINT32) ((UINTN) mAcpiDebug + AD_SIZE);
+    }
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+/**
+  Software SMI callback for ACPI Debug which is called from ACPI method.
+
+  All pending entries are printed, so the SMI can be raised once to flush
+  the buffer when ASL does not trigger it on every write.
+
+  @param[in]      DispatchHandle    The unique handle assigned to this handler by SmiHandlerRegister().
+  @param[in]      Context           Points to an optional handler context which was specified when the
+                                    handler was registered.
+  @param[in, out] CommBuffer        A pointer to a collection of data in memory that will
+                                    be conveyed from a non-SMM environment into an SMM environment.
+  @param[in, out] CommBufferSize    The size of the CommBuffer.
+
+  @retval EFI_SUCCESS               The interrupt was handled successfully.
+
+**/
+EFI_STATUS
+EFIAPI
+AcpiDebugSmmCallback (
+  IN EFI_HANDLE     DispatchHandle,
+  IN CONST VOID     *Context,
+  IN OUT VOID       *CommBuffer,
+  IN OUT UINTN      *CommBufferSize
+  )
+{
+  UINT32            Count;
+
+  //
+  // Validate the fields in mAcpiDebug to ensure there is no harm to SMI handler.
+  // mAcpiDebug is below 4GB and the start address of whole buffer.
+  //
+  if ((mAcpiDebug->BufferSize != (mBufferEnd - (UINT32) (UINTN) mAcpiDebug)) ||
+      (mAcpiDebug->Head < (UINT32) ((UINTN) mAcpiDebug + AD_SIZE)) ||
+      (mAcpiDebug->Head > mBufferEnd) ||
+      (mAcpiDebug->Tail < (UINT32) ((UINTN) mAcpiDebug + AD_SIZE)) ||
+      (mAcpiDebug->Tail > mBufferEnd)) {
+    //
+    // If some fields in mAcpiDebug are invaid, return directly.
+    //
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Each call consumes at least one entry, bound the loop by the entry count
+  // of the whole buffer plus the wrap.
+  //
+  for (Count = 0; Count <= mAcpiDebug->BufferSize / MAX_BUFFER_SIZE + 1; Count++) {
+    if (!AcpiDebugPrintEntry ()) {
+      break;
     }
   }
 
@@ -456,7 +488,13 @@ AcpiDebugSmmEndOfDxeNotification (
     }
 
     mAcpiDebug->SmiTrigger = (UINT8) SwContext.SwSmiInputValue;
-    mAcpiDebug->SmmVersion = 1;
+    //
+    // Without SmmVersion set, ASL only writes the buffer and the SMI is left
+    // to software that wants to flush it.
+    //
+    if (PcdGetBool (PcdAcpiDebugSmiPerWrite)) {
+      mAcpiDebug->SmmVersion = 1;
+    }
   }
 
   return EFI_SUCCESS;
@@ -11,60 +11,62 @@
 
 #include "PlatformStatusCodesInternal.h"
 
+//
+// The maps are sorted by Value for the binary search of FindBeepData (),
+// keep them sorted when adding entries.
+//
 STATUS_CODE_TO_DATA_MAP mBeepProgressMap[] = {
-  //
-  // PEI
-  //
-  // Recovery
+  // EFI_SOFTWARE_PEI_MODULE
   { PEI_RECOVERY_STARTED, 2 },
-
-  //
-  // DXE
-  //
-
   {0,0}
 };
 
 STATUS_CODE_TO_DATA_MAP mBeepErrorMap[] = {
-  //
-  // PEI
-  //
-  // Regular boot
+  // EFI_COMPUTING_UNIT_MEMORY
+  { DXE_FLASH_UPDATE_FAILED, 6 },
   { PEI_MEMORY_NOT_DETECTED, 1 },
-  { PEI_MEMORY_INSTALLED_TWICE, 1 },
-  { PEI_DXEIPL_NOT_FOUND, 3 },
+
+  // EFI_PERIPHERAL_KEYBOARD
+  { DXE_NO_CON_IN, 5 },
+
+  // EFI_PERIPHERAL_LOCAL_CONSOLE
+  { DXE_NO_CON_OUT, 5 },
+
+  // EFI_SOFTWARE_PEI_CORE
   { PEI_DXE_CORE_NOT_FOUND, 3 },
   { PEI_RESET_NOT_AVAILABLE, 7 },
-  // Recovery
+  { PEI_DXEIPL_NOT_FOUND, 3 },
   { PEI_RECOVERY_FAILED, 4 },
-  // S3 Resume
+
+  // EFI_SOFTWARE_PEI_MODULE
   { PEI_S3_RESUME_FAILED, 4 },
 
-  //
-  // DXE
-  //
+  // EFI_SOFTWARE_DXE_CORE
   { DXE_ARCH_PROTOCOL_NOT_AVAILABLE, 4 },
-  { DXE_NO_CON_OUT, 5 },
-  { DXE_NO_CON_IN, 5 },
+
+  // EFI_SOFTWARE_DXE_BS_DRIVER
   { DXE_INVALID_PASSWORD, 1 },
-  { DXE_FLASH_UPDATE_FAILED, 6 },
-  { DXE_RESET_NOT_AVAILABLE, 7 },
 
+  // EFI_SOFTWARE_PEI_SERVICE
+  { PEI_MEMORY_INSTALLED_TWICE, 1 },
+
+  // EFI_SOFTWARE_EFI_RUNTIME_SERVICE
+  { DXE_RESET_NOT_AVAILABLE, 7 },
   {0,0}
 };
 
-STATUS_CODE_TO_DATA_MAP *mBeepStatusCodesMap[] = {
+STATUS_CODE_MAP_TABLE mBeepStatusCodesMap[] = {
   //#define EFI_PROGRESS_CODE 0x00000001
-  mBeepProgressMap,
+  { mBeepProgressMap, ARRAY_SIZE (mBeepProgressMap) - 1 },
   //#define EFI_ERROR_CODE 0x00000002
-  mBeepErrorMap
+  { mBeepErrorMap, ARRAY_SIZE (mBeepErrorMap) - 1 }
   //#define EFI_DEBUG_CODE 0x00000003
 };
 
 /**
   Find the beep data from status code value.
 
-  @param  Map              The map used to find in.
+  @param  Table            The map used to find in.
   @param  Value            The status code value.
 
   @return BeepValue        0 for not found.
@@ -72,15 +74,44 @@ STATUS_CODE_TO_DATA_MAP *mBeepStatusCodesMap[] = {
 **/
 UINT32
 FindBeepData (
-  IN STATUS_CODE_TO_DATA_MAP *Map,
+  IN STATUS_CODE_MAP_TABLE   *Table,
   IN EFI_STATUS_CODE_VALUE   Value
   )
 {
-  while (Map->Value != 0) {
-    if (Map->Value == Value) {
-      return Map->Data;
+  STATUS_CODE_TO_DATA_MAP    *Map;
+  UINTN                      Low;
+  UINTN                      High;
+  UINTN                      Middle;
+
+  Map = Table->Map;
+
+  //
+  // Most of the reported codes have no mapping, reject the ones outside
+  // of the map first.
+  //
+  if ((Table->Count == 0) ||
+      (Value < Map[0].Value) ||
+      (Value > Map[Table->Count - 1].Value)) {
+    return 0;
+  }
+
+  //
+  // Find the first entry not below Value, so that an entry listed twice
+  // resolves to the first one as with a linear search.
+  //
+  Low  = 0;
+  High = Table->Count - 1;
+  while (Low < High) {
+    Middle = Low + (High - Low) / 2;
+    if (Map[Middle].Value < Value) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
     }
-    Map++;
+  }
+
+  if (Map[Low].Value == Value) {
+    return Map[Low].Data;
   }
   return 0;
 }
@@ -112,5 +143,5 @@ GetBeepValueFromStatusCode (
     return 0;
   }
 
-  return FindBeepData (mBeepStatusCodesMap[CodeTypeIndex], Value);
+  return FindBeepData (&mBeepStatusCodesMap[CodeTypeIndex], Value);
 }
@@ -16,6 +16,14 @@ typedef struct{
   UINT32                Data;
 } STATUS_CODE_TO_DATA_MAP;
 
+//
+// A map sorted by Value, Count doesn't include the {0,0} terminator.
+//
+typedef struct {
+  STATUS_CODE_TO_DATA_MAP *Map;
+  UINTN                   Count;
+} STATUS_CODE_MAP_TABLE;
+
 //
 // Enable PEI/DXE status code
 //
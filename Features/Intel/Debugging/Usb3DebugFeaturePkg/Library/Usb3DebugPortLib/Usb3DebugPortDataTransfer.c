@@ -279,6 +279,8 @@ XhcCheckUrbResult (
     //
     if (IsTransferRingTrb (TRBPtr, Urb)) {
       CheckedUrb = Urb;
+    } else if (Xhc->OutPending && (Urb != &Xhc->UrbOut) && IsTransferRingTrb (TRBPtr, &Xhc->UrbOut)) {
+      CheckedUrb = &Xhc->UrbOut;
     } else {
       continue;
     }
@@ -575,7 +577,11 @@ XhcCreateUrb (
   URB                           *Urb;
   EFI_PHYSICAL_ADDRESS          DataAddress;
 
-  Urb = &Xhc->Urb;
+  if (Direction == EfiUsbDataOut) {
+    Urb = &Xhc->UrbOut;
+  } else {
+    Urb = &Xhc->Urb;
+  }
   ASSERT (Urb->Data != 0);
   DataAddress = Urb->Data;
   ZeroMem (Urb, sizeof (URB));
@@ -638,6 +644,16 @@ XhcDataTransfer (
   *TransferResult = EFI_USB_ERR_SYSTEM;
   Status          = EFI_DEVICE_ERROR;
 
+  //
+  // The OUT URB is reused, let the queued transfer finish first.
+  //
+  if ((Direction == EfiUsbDataOut) && Xhc->OutPending) {
+    XhcCheckOutTransfer (Xhc, DATA_TRANSFER_OUT_TIME_OUT);
+    if (Xhc->OutPending) {
+      return EFI_TIMEOUT;
+    }
+  }
+
   //
   // Create a new URB, insert it into the asynchronous
   // schedule list, then poll the execution status.
@@ -663,6 +679,158 @@ ON_EXIT:
   return Status;
 }
 
+/**
+  Poll the queued OUT transfer for up to Timeout.
+
+  An OUT transfer which doesn't complete in time is left outstanding, the
+  controller may still be working on its TRB so it is not taken back.
+
+  @param  Xhc               The XHCI Instance.
+  @param  Timeout           The time to wait, in millisecond. 0 means the
+                            transfer is checked once.
+
+**/
+VOID
+XhcCheckOutTransfer (
+  IN  USB3_DEBUG_PORT_INSTANCE *Xhc,
+  IN  UINTN                    Timeout
+  )
+{
+  URB                     *Urb;
+  UINTN                   Index;
+  UINTN                   Loop;
+
+  if (!Xhc->OutPending) {
+    return;
+  }
+
+  //
+  // The instance may have been copied since the transfer was queued, e.g.
+  // from the HOB in DXE, point the URB at the ring of this copy.
+  //
+  Urb       = &Xhc->UrbOut;
+  Urb->Ring = (EFI_PHYSICAL_ADDRESS)(UINTN) &Xhc->TransferRingOut;
+  Loop      = (Timeout * XHC_1_MILLISECOND / XHC_POLL_DELAY) + 1;
+  for (Index = 0; Index < Loop; Index++) {
+    XhcCheckUrbResult (Xhc, Urb);
+    if (Urb->Finished) {
+      break;
+    }
+    if (Index + 1 < Loop) {
+      MicroSecondDelay (XHC_POLL_DELAY);
+    }
+  }
+
+  if (!Urb->Finished) {
+    Xhc->OutStalled = TRUE;
+    return;
+  }
+
+  if (Urb->Result != EFI_USB_NOERROR) {
+    Xhc->DroppedBytes += Urb->DataLen - Urb->Completed;
+  }
+  Xhc->OutPending = FALSE;
+  Xhc->OutStalled = FALSE;
+}
+
+/**
+  Start the OUT transfer of the head of the transmit ring if the previous
+  one has completed. The transfer completes in the background.
+
+  @param  Xhc               The XHCI Instance.
+
+**/
+VOID
+XhcStartOutTransfer (
+  IN  USB3_DEBUG_PORT_INSTANCE *Xhc
+  )
+{
+  URB                     *Urb;
+  UINT32                  Length;
+
+  if (Xhc->OutPending || (Xhc->OutLength == 0)) {
+    return;
+  }
+
+  //
+  // Only the contiguous part of the ring goes in one transfer.
+  //
+  Length = MIN (Xhc->OutLength, XHC_DEBUG_PORT_OUT_DATA_LENGTH);
+  Length = MIN (Length, XHC_DEBUG_PORT_OUT_BUFFER_SIZE - Xhc->OutHead);
+
+  Urb = XhcCreateUrb (
+          Xhc,
+          EfiUsbDataOut,
+          (UINT8 *)(UINTN)Xhc->OutBuffer + Xhc->OutHead,
+          Length
+          );
+  XhcRingDoorBell (Xhc, Urb);
+
+  Xhc->OutHead    = (Xhc->OutHead + Length) % XHC_DEBUG_PORT_OUT_BUFFER_SIZE;
+  Xhc->OutLength -= Length;
+  Xhc->OutPending = TRUE;
+}
+
+/**
+  Queue the data in the transmit ring and start the OUT transfer of it
+  without waiting for the transfer to complete.
+
+  @param  Xhc                   The instance of debug device.
+  @param  Data                  The data to send.
+  @param  DataLength            On input the length of the data, on output
+                                the count of bytes dropped because the
+                                transmit ring was full.
+
+**/
+VOID
+XhcQueueOutData (
+  IN     USB3_DEBUG_PORT_INSTANCE            *Xhc,
+  IN     UINT8                               *Data,
+  IN OUT UINTN                               *DataLength
+  )
+{
+  UINT8                   *Buffer;
+  UINT32                  Tail;
+  UINT32                  Length;
+  UINT32                  Free;
+
+  Buffer = (UINT8 *)(UINTN)Xhc->OutBuffer;
+
+  //
+  // Reap the previous transfer, it has usually completed by now.
+  //
+  XhcCheckOutTransfer (Xhc, 0);
+
+  //
+  // Copy the data into the ring, in two parts if it wraps. The data which
+  // doesn't fit is dropped rather than waiting for the debug host.
+  //
+  Free = XHC_DEBUG_PORT_OUT_BUFFER_SIZE - Xhc->OutLength;
+  if (*DataLength < Free) {
+    Free = (UINT32)*DataLength;
+  }
+  Xhc->DroppedBytes += (UINT32)(*DataLength - Free);
+  *DataLength       -= Free;
+
+  Tail   = (Xhc->OutHead + Xhc->OutLength) % XHC_DEBUG_PORT_OUT_BUFFER_SIZE;
+  Length = MIN (Free, XHC_DEBUG_PORT_OUT_BUFFER_SIZE - Tail);
+  CopyMem (Buffer + Tail, Data, Length);
+  CopyMem (Buffer, Data + Length, Free - Length);
+  Xhc->OutLength += Free;
+
+  //
+  // Send the ring out. Only the transfers before the last one are waited
+  // for, and not at all once the debug host has stopped reading.
+  //
+  while (Xhc->OutLength > 0) {
+    XhcCheckOutTransfer (Xhc, Xhc->OutStalled ? 0 : DATA_TRANSFER_OUT_TIME_OUT);
+    if (Xhc->OutPending) {
+      break;
+    }
+    XhcStartOutTransfer (Xhc);
+  }
+}
+
 /**
   Check whether the MMIO Bar is within any of the SMRAM ranges.
 
@@ -832,6 +1000,11 @@ Usb3DebugPortDataTransfer (
     }
   }
 
+  if (Direction == EfiUsbDataOut) {
+    XhcQueueOutData (Instance, Data, Length);
+    goto Done;
+  }
+
   BytesToSend = 0;
   while (*Length > 0) {
     BytesToSend = ((*Length) > XHC_DEBUG_PORT_DATA_LENGTH) ? XHC_DEBUG_PORT_DATA_LENGTH : *Length;
@@ -592,6 +592,12 @@ InitializeUsb3DebugPort (
   // Init data buffer used to transfer
   //
   Instance->Urb.Data = (EFI_PHYSICAL_ADDRESS) (UINTN) AllocateAlignBuffer (XHC_DEBUG_PORT_DATA_LENGTH);
+  Instance->UrbOut.Data = (EFI_PHYSICAL_ADDRESS) (UINTN) AllocateAlignBuffer (XHC_DEBUG_PORT_OUT_DATA_LENGTH);
+  Instance->OutBuffer   = (EFI_PHYSICAL_ADDRESS) (UINTN) AllocateAlignBuffer (XHC_DEBUG_PORT_OUT_BUFFER_SIZE);
+  Instance->OutPending  = FALSE;
+  Instance->OutStalled  = FALSE;
+  Instance->OutHead     = 0;
+  Instance->OutLength   = 0;
 
   //
   // Init DCDDI1 and DCDDI2
@@ -146,6 +146,12 @@ Usb3MapDmaBuffers (
     XHC_DEBUG_PORT_DATA_LENGTH
     );
 
+  Usb3MapOneDmaBuffer (
+    PciIo,
+    Instance->UrbOut.Data,
+    XHC_DEBUG_PORT_OUT_DATA_LENGTH
+    );
+
   Usb3MapOneDmaBuffer (
     PciIo,
     Instance->TransferRingIn.RingSeg0,
@@ -61,11 +61,24 @@
 //
 #define XHC_DEBUG_PORT_DATA_LENGTH   8
 
+//
+// The OUT data is queued in a transmit ring and sent in transfers of up to
+// one SuperSpeed bulk packet.
+//
+#define XHC_DEBUG_PORT_OUT_DATA_LENGTH  1024
+#define XHC_DEBUG_PORT_OUT_BUFFER_SIZE  SIZE_4KB
+
 //
 // Indicate the timeout when data is transferred. 0 means infinite timeout.
 //
 #define DATA_TRANSFER_TIME_OUT       0
 
+//
+// The time, in millisecond, to wait for the previous OUT transfer before
+// leaving the queued data in the transmit ring.
+//
+#define DATA_TRANSFER_OUT_TIME_OUT   10
+
 //
 // USB debug device string descritpor (header size + unicode string length)
 //
@@ -509,6 +522,30 @@ typedef struct _USB3_DEBUG_PORT_INSTANCE {
   // URB
   //
   URB                                     Urb;
+
+  //
+  // URB of the OUT transfer, it completes in the background
+  //
+  URB                                     UrbOut;
+  BOOLEAN                                 OutPending;
+
+  //
+  // The flag indicates the last OUT transfer didn't complete in time, the
+  // debug host isn't reading so don't wait for it any more
+  //
+  BOOLEAN                                 OutStalled;
+
+  //
+  // Transmit ring of XHC_DEBUG_PORT_OUT_BUFFER_SIZE bytes
+  //
+  EFI_PHYSICAL_ADDRESS                    OutBuffer;
+  UINT32                                  OutHead;
+  UINT32                                  OutLength;
+
+  //
+  // The count of bytes dropped because the transmit ring was full
+  //
+  UINT32                                  DroppedBytes;
 } USB3_DEBUG_PORT_INSTANCE;
 
 #pragma pack()
@@ -884,4 +921,36 @@ XhcDataTransfer (
   OUT    UINT32                              *TransferResult
   );
 
+/**
+  Poll the queued OUT transfer for up to Timeout.
+
+  @param  Xhc               The XHCI Instance.
+  @param  Timeout           The time to wait, in millisecond. 0 means the
+                            transfer is checked once.
+
+**/
+VOID
+XhcCheckOutTransfer (
+  IN  USB3_DEBUG_PORT_INSTANCE *Xhc,
+  IN  UINTN                    Timeout
+  );
+
+/**
+  Queue the data in the transmit ring and start the OUT transfer of it
+  without waiting for the transfer to complete.
+
+  @param  Xhc                   The instance of debug device.
+  @param  Data                  The data to send.
+  @param  DataLength            On input the length of the data, on output
+                                the count of bytes dropped because the
+                                transmit ring was full.
+
+**/
+VOID
+XhcQueueOutData (
+  IN     USB3_DEBUG_PORT_INSTANCE            *Xhc,
+  IN     UINT8                               *Data,
+  IN OUT UINTN                               *DataLength
+  );
+
 #endif //__SERIAL_PORT_LIB_USB__
@@ -6,14 +6,59 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
-#include <Uefi.h>
+#include <PiDxe.h>
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Library/IpmiLib.h>
 #include <Library/IpmiCommandLib.h>
+#include <Library/PcdLib.h>
+#include <Protocol/IpmiBmcReady.h>
+#include <Protocol/ReportStatusCodeHandler.h>
+
+//
+// The error codes are queued by the status code handler and sent to the
+// SEL in batches from a timer, a code already in the ring isn't queued
+// again. The ring keeps the last BMC_ELOG_RING_SIZE codes, sent or not.
+//
+#define BMC_ELOG_RING_SIZE              64
+#define BMC_ELOG_FLUSH_BATCH            8
+#define BMC_ELOG_FLUSH_PERIOD           EFI_TIMER_PERIOD_MILLISECONDS (100)
+
+#define BMC_ELOG_ERASE_POLL_PERIOD      EFI_TIMER_PERIOD_MILLISECONDS (10)
+#define BMC_ELOG_ERASE_POLL_COUNT       0x200
+
+#define IPMI_CC_SEL_ERASE_IN_PROGRESS   0x81
+
+//
+// OEM timestamped SEL record, bytes 10 to 15 hold the status code.
+//
+#define BMC_ELOG_SEL_RECORD_SIZE        16
+#define BMC_ELOG_SEL_RECORD_TYPE        0xC0
+#define BMC_ELOG_MANUFACTURER_ID        0x000157
+
+typedef struct {
+  EFI_STATUS_CODE_TYPE     CodeType;
+  EFI_STATUS_CODE_VALUE    Value;
+  UINT32                   Instance;
+} BMC_ELOG_ENTRY;
+
+EFI_RSC_HANDLER_PROTOCOL   *mRscHandler;
+BMC_ELOG_ENTRY             mElogRing[BMC_ELOG_RING_SIZE];
+UINT32                     mElogTail;
+UINT32                     mElogSent;
+UINT32                     mElogSuppressed;
+UINT32                     mElogDropped;
+EFI_EVENT                  mElogFlushEvent;
+
+EFI_EVENT                  mSelEraseEvent;
+BOOLEAN                    mSelErasing;
+UINT8                      mSelReservationId[2];
+UINTN                      mSelErasePolls;
 
 EFI_STATUS
 EFIAPI
@@ -21,70 +66,302 @@ CheckIfSelIsFull (
   VOID
   );
 
-/*++
+/**
+  Send a Clear SEL command.
 
-  Routine Description:
-    This function verifies the BMC SEL is full and When it is reports the error to the Error Manager.
+  @param[in]  Erase       0xAA to start the erasure, 0 to get its status.
+  @param[out] Progress    The erasure progress, 1 once it has completed.
 
-  Arguments:
-    None
-
-  Returns:
-    EFI_SUCCESS
-    EFI_DEVICE_ERROR
+  @return The status of IpmiClearSel ().
 
---*/
+**/
 EFI_STATUS
+SendClearSel (
+  IN  UINT8                             Erase,
+  OUT UINT8                             *Progress
+  )
+{
+  EFI_STATUS               Status;
+  IPMI_CLEAR_SEL_REQUEST   ClearSel;
+  IPMI_CLEAR_SEL_RESPONSE  ClearSelResponse;
+
+  ZeroMem (&ClearSel, sizeof(ClearSel));
+  ZeroMem (&ClearSelResponse, sizeof(ClearSelResponse));
+  ClearSel.Reserve[0]  = mSelReservationId[0];
+  ClearSel.Reserve[1]  = mSelReservationId[1];
+  ClearSel.AscC        = 0x43;
+  ClearSel.AscL        = 0x4C;
+  ClearSel.AscR        = 0x52;
+  ClearSel.Erase       = Erase;
+
+  Status = IpmiClearSel (
+             &ClearSel,
+             &ClearSelResponse
+             );
+  *Progress = ClearSelResponse.ErasureProgress & 0xf;
+  return Status;
+}
+
+/**
+  Poll the SEL erasure, the queued log entries are sent again once it
+  has completed.
+
+  @param[in] Event    The periodic timer event.
+  @param[in] Context  Not used.
+
+**/
+VOID
+EFIAPI
 WaitTillErased (
-  UINT8                                 *ResvId
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
   )
-/*++
+{
+  UINT8        Progress;
 
-Routine Description:
+  SendClearSel (0x00, &Progress);
+  if (Progress != 1) {
+    //
+    //  If there is not a response from the BMC controller we need to give up and not hang.
+    //
+    if (--mSelErasePolls != 0) {
+      return;
+    }
+    DEBUG ((DEBUG_ERROR, "[IPMI] SEL erasure did not complete\n"));
+  }
 
-Arguments:
+  gBS->SetTimer (mSelEraseEvent, TimerCancel, 0);
+  mSelErasing = FALSE;
+}
 
-  BmcElogPrivateData  - Bmc event log instance
-  ResvId              - Reserved ID
+/**
+  Start erasing the SEL, the completion is polled from a timer.
 
-Returns:
+  @retval EFI_SUCCESS     The erasure has started.
+  @return Others          The BMC refused the reservation or the erasure.
 
-  EFI_SUCCESS
-  EFI_NO_RESPONSE
+**/
+EFI_STATUS
+StartSelErase (
+  VOID
+  )
+{
+  EFI_STATUS   Status;
+  UINT8        Response[3];
+  UINT32       ResponseSize;
+  UINT8        Progress;
 
---*/
+  if (mSelErasing) {
+    return EFI_SUCCESS;
+  }
+
+  ResponseSize = sizeof (Response);
+  Status = IpmiSubmitCommand (
+             IPMI_NETFN_STORAGE,
+             IPMI_STORAGE_RESERVE_SEL,
+             NULL,
+             0,
+             Response,
+             &ResponseSize
+             );
+  if (EFI_ERROR (Status) || (ResponseSize < sizeof (Response)) || (Response[0] != IPMI_COMP_CODE_NORMAL)) {
+    return EFI_DEVICE_ERROR;
+  }
+  mSelReservationId[0] = Response[1];
+  mSelReservationId[1] = Response[2];
+
+  Status = SendClearSel (0xAA, &Progress);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (mSelEraseEvent == NULL) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    TPL_CALLBACK,
+                    WaitTillErased,
+                    NULL,
+                    &mSelEraseEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  mSelErasing    = TRUE;
+  mSelErasePolls = BMC_ELOG_ERASE_POLL_COUNT;
+  return gBS->SetTimer (mSelEraseEvent, TimerPeriodic, BMC_ELOG_ERASE_POLL_PERIOD);
+}
+
+/**
+  Queue an error code for the SEL.
+
+  The handler runs at the TPL of the caller, it only touches the ring.
+
+  @param[in] CodeType     The type of status code.
+  @param[in] Value        The status code value.
+  @param[in] Instance     The status code instance.
+  @param[in] CallerId     Not used.
+  @param[in] Data         Not used.
+
+  @retval EFI_SUCCESS     Always.
+
+**/
+EFI_STATUS
+EFIAPI
+BmcElogStatusCodeCallback (
+  IN EFI_STATUS_CODE_TYPE               CodeType,
+  IN EFI_STATUS_CODE_VALUE              Value,
+  IN UINT32                             Instance,
+  IN EFI_GUID                           *CallerId,
+  IN EFI_STATUS_CODE_DATA               *Data
+  )
 {
-  INTN                     Counter;
-  IPMI_CLEAR_SEL_REQUEST   ClearSel;
-  IPMI_CLEAR_SEL_RESPONSE  ClearSelResponse;
+  EFI_TPL          OldTpl;
+  UINT32           Index;
+  BMC_ELOG_ENTRY   *Entry;
 
-  Counter   = 0x200;
-  ZeroMem (&ClearSelResponse, sizeof(ClearSelResponse));
+  if ((CodeType & EFI_STATUS_CODE_TYPE_MASK) != EFI_ERROR_CODE) {
+    return EFI_SUCCESS;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
 
-  while (TRUE) {
-    ZeroMem (&ClearSel, sizeof(ClearSel));
-    ClearSel.Reserve[0]  = ResvId[0];
-    ClearSel.Reserve[1]  = ResvId[1];
-    ClearSel.AscC        = 0x43;
-    ClearSel.AscL        = 0x4C;
-    ClearSel.AscR        = 0x52;
-    ClearSel.Erase       = 0x00;
-
-    IpmiClearSel (
-      &ClearSel,
-      &ClearSelResponse
-      );
-
-    if ((ClearSelResponse.ErasureProgress & 0xf) == 1) {
+  for (Index = 0; (Index < mElogTail) && (Index < BMC_ELOG_RING_SIZE); Index++) {
+    Entry = &mElogRing[(mElogTail - 1 - Index) % BMC_ELOG_RING_SIZE];
+    if ((Entry->CodeType == CodeType) && (Entry->Value == Value) && (Entry->Instance == Instance)) {
+      mElogSuppressed++;
+      gBS->RestoreTPL (OldTpl);
       return EFI_SUCCESS;
     }
+  }
+
+  if (mElogTail - mElogSent == BMC_ELOG_RING_SIZE) {
+    mElogDropped++;
+  } else {
+    Entry = &mElogRing[mElogTail % BMC_ELOG_RING_SIZE];
+    Entry->CodeType = CodeType;
+    Entry->Value    = Value;
+    Entry->Instance = Instance;
+    mElogTail++;
+  }
+
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+/**
+  Send one batch of the queued error codes to the SEL.
+
+  @retval TRUE    More codes are queued.
+  @retval FALSE   The queue is empty, or the BMC can't take more for now.
+
+**/
+BOOLEAN
+BmcElogFlushBatch (
+  VOID
+  )
+{
+  IPMI_COMMAND_SEQUENCE_ENTRY  Commands[BMC_ELOG_FLUSH_BATCH];
+  UINT8                        Record[BMC_ELOG_FLUSH_BATCH][BMC_ELOG_SEL_RECORD_SIZE];
+  UINT8                        Response[BMC_ELOG_FLUSH_BATCH][3];
+  EFI_TPL                      OldTpl;
+  UINT32                       Count;
+  UINT32                       Index;
+  BMC_ELOG_ENTRY               *Entry;
+
+  if (mSelErasing) {
+    return FALSE;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  Count  = MIN (mElogTail - mElogSent, BMC_ELOG_FLUSH_BATCH);
+  ZeroMem (Record, sizeof (Record));
+  for (Index = 0; Index < Count; Index++) {
+    Entry = &mElogRing[(mElogSent + Index) % BMC_ELOG_RING_SIZE];
+    Record[Index][2]  = BMC_ELOG_SEL_RECORD_TYPE;
+    Record[Index][7]  = (UINT8)BMC_ELOG_MANUFACTURER_ID;
+    Record[Index][8]  = (UINT8)(BMC_ELOG_MANUFACTURER_ID >> 8);
+    Record[Index][9]  = (UINT8)(BMC_ELOG_MANUFACTURER_ID >> 16);
+    WriteUnaligned32 ((UINT32 *)&Record[Index][10], Entry->Value);
+    Record[Index][14] = (UINT8)Entry->Instance;
+    Record[Index][15] = (UINT8)(Entry->CodeType >> 24);
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  if (Count == 0) {
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    Commands[Index].NetFunction      = IPMI_NETFN_STORAGE;
+    Commands[Index].Command          = IPMI_STORAGE_ADD_SEL_ENTRY;
+    Commands[Index].RequestData      = Record[Index];
+    Commands[Index].RequestDataSize  = BMC_ELOG_SEL_RECORD_SIZE;
+    Commands[Index].ResponseData     = Response[Index];
+    Commands[Index].ResponseDataSize = sizeof (Response[Index]);
+  }
+  IpmiSubmitCommandSequence (Commands, Count, TRUE);
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_INFO);
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_ENTRY);
+
+  for (Index = 0; Index < Count; Index++) {
     //
-    //  If there is not a response from the BMC controller we need to return and not hang.
+    // Keep the code for the next batch if the BMC didn't answer or is
+    // erasing the SEL, drop it if the BMC refused it.
     //
-    --Counter;
-    if (Counter == 0x0) {
-      return EFI_NO_RESPONSE;
+    if (EFI_ERROR (Commands[Index].Status) ||
+        (Response[Index][0] == IPMI_CC_SEL_ERASE_IN_PROGRESS)) {
+      return FALSE;
     }
+    if (Response[Index][0] != IPMI_COMP_CODE_NORMAL) {
+      DEBUG ((DEBUG_ERROR, "[IPMI] Add SEL Entry failed: 0x%x\n", Response[Index][0]));
+    }
+    mElogSent++;
+  }
+
+  return (BOOLEAN)(mElogSent != mElogTail);
+}
+
+/**
+  Send the queued error codes.
+
+  @param[in] Event    The periodic timer event.
+  @param[in] Context  Not used.
+
+**/
+VOID
+EFIAPI
+BmcElogFlushTimer (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  BmcElogFlushBatch ();
+}
+
+/**
+  Send what is left in the queue and stop logging the error codes.
+
+  @param[in] Event    The exit boot services event.
+  @param[in] Context  Not used.
+
+**/
+VOID
+EFIAPI
+BmcElogExitBootServices (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  mRscHandler->Unregister (BmcElogStatusCodeCallback);
+  gBS->SetTimer (mElogFlushEvent, TimerCancel, 0);
+
+  while (BmcElogFlushBatch ()) {
+  }
+
+  if ((mElogSuppressed != 0) || (mElogDropped != 0)) {
+    DEBUG ((DEBUG_INFO, "[IPMI] SEL error codes: %d duplicates suppressed, %d dropped\n", mElogSuppressed, mElogDropped));
   }
 }
 
@@ -170,6 +447,63 @@ Returns:
   return EFI_SUCCESS;
 }
 
+/**
+  Run the BMC event log setup once DxeIpmiInit has
+  finished probing the BMC.
+
+  @param[in] Event    The protocol notify event.
+  @param[in] Context  Not used.
+
+**/
+VOID
+EFIAPI
+BmcElogBmcReady (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  EFI_STATUS                Status;
+  IPMI_BMC_READY_PROTOCOL   *BmcReady;
+
+  Status = gBS->LocateProtocol (&gIpmiBmcReadyProtocolGuid, NULL, (VOID **)&BmcReady);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+  gBS->CloseEvent (Event);
+
+  if (!BmcReady->Responding) {
+    DEBUG ((DEBUG_ERROR, "[IPMI] BMC does not respond, skip the BMC event log setup\n"));
+    mRscHandler->Unregister (BmcElogStatusCodeCallback);
+    return;
+  }
+
+  SetElogRedirInstall ();
+
+  CheckIfSelIsFull ();
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  BmcElogFlushTimer,
+                  NULL,
+                  &mElogFlushEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    mRscHandler->Unregister (BmcElogStatusCodeCallback);
+    return;
+  }
+  gBS->SetTimer (mElogFlushEvent, TimerPeriodic, BMC_ELOG_FLUSH_PERIOD);
+
+  gBS->CreateEventEx (
+         EVT_NOTIFY_SIGNAL,
+         TPL_CALLBACK,
+         BmcElogExitBootServices,
+         NULL,
+         &gEfiEventExitBootServicesGuid,
+         &Event
+         );
+}
+
 EFI_STATUS
 EFIAPI
 InitializeBmcElogLayer (
@@ -191,10 +525,28 @@ Returns:
 
 --*/
 {
-  SetElogRedirInstall ();
+  EFI_STATUS  Status;
+  VOID        *Registration;
 
-  CheckIfSelIsFull ();
+  //
+  // Queue the error codes from now on, they are sent once the BMC is ready.
+  //
+  Status = gBS->LocateProtocol (&gEfiRscHandlerProtocolGuid, NULL, (VOID **)&mRscHandler);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  Status = mRscHandler->Register (BmcElogStatusCodeCallback, TPL_HIGH_LEVEL);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
+  EfiCreateProtocolNotifyEvent (
+    &gIpmiBmcReadyProtocolGuid,
+    TPL_CALLBACK,
+    BmcElogBmcReady,
+    NULL,
+    &Registration
+    );
   return EFI_SUCCESS;
 }
 
@@ -232,5 +584,10 @@ CheckIfSelIsFull (
   SelIsFull = (SelInfo.OperationSupport & 0x80);
   DEBUG ((DEBUG_INFO, "SelIsFull - 0x%x\n", SelIsFull));
 
+  if ((SelIsFull != 0) && FixedPcdGetBool (PcdBmcElogClearFullSel)) {
+    Status = StartSelErase ();
+    DEBUG ((DEBUG_INFO, "Clear the full SEL - %r\n", Status));
+  }
+
   return EFI_SUCCESS;
 }
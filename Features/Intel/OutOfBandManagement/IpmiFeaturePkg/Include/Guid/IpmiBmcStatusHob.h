@@ -0,0 +1,28 @@
+/** @file
+  GUID HOB carrying the result of the BMC probe in PEI.
+
+Copyright (c) 2018 - 2019, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _IPMI_BMC_STATUS_HOB_H_
+#define _IPMI_BMC_STATUS_HOB_H_
+
+#define IPMI_BMC_STATUS_HOB_GUID \
+  { 0x4ddcb439, 0xc6c8, 0x417b, { 0x80, 0x43, 0xc6, 0xe4, 0x04, 0x0f, 0x89, 0x12 } }
+
+typedef struct {
+  //
+  // The BMC answered the Get Device ID command.
+  //
+  BOOLEAN   Responding;
+  //
+  // The BMC is in firmware update mode, only valid if Responding.
+  //
+  BOOLEAN   UpdateMode;
+} IPMI_BMC_STATUS;
+
+extern EFI_GUID gIpmiBmcStatusHobGuid;
+
+#endif
@@ -232,4 +232,95 @@ IpmiGetSdr (
   IN OUT UINT32                     *GetSdrResponseSize
   );
 
+//
+// Response cache and command sequences
+//
+
+///
+/// One command of IpmiSubmitCommandSequence ().
+///
+typedef struct {
+  UINT8         NetFunction;
+  UINT8         Command;
+  UINT8         *RequestData;
+  UINT32        RequestDataSize;
+  UINT8         *ResponseData;
+  UINT32        ResponseDataSize;     ///< In: buffer size, out: response size.
+  EFI_STATUS    Status;               ///< EFI_NOT_STARTED if it wasn't sent.
+} IPMI_COMMAND_SEQUENCE_ENTRY;
+
+/**
+  Submit an idempotent command, answering it from the cache if it has
+  been sent before with the same request data.
+
+  The cache lives in the module globals, don't use it from code which runs
+  from flash.
+
+  @param  NetFunction       The net function of the command.
+  @param  Command           The command.
+  @param  RequestData       The request data of the command.
+  @param  RequestDataSize   The size of RequestData.
+  @param  ResponseData      The buffer for the response.
+  @param  ResponseDataSize  On input the size of ResponseData, on output the
+                            size of the response.
+
+  @return The status of IpmiSubmitCommand (), EFI_SUCCESS for a cached
+          response.
+
+**/
+EFI_STATUS
+EFIAPI
+IpmiSubmitCommandCached (
+  IN     UINT8     NetFunction,
+  IN     UINT8     Command,
+  IN     UINT8     *RequestData,
+  IN     UINT32    RequestDataSize,
+  OUT    UINT8     *ResponseData,
+  IN OUT UINT32    *ResponseDataSize
+  );
+
+/**
+  Drop the cached responses of a command, whatever their request data.
+
+  @param  NetFunction       The net function of the command.
+  @param  Command           The command.
+
+**/
+VOID
+EFIAPI
+IpmiInvalidateCachedResponse (
+  IN UINT8     NetFunction,
+  IN UINT8     Command
+  );
+
+/**
+  Drop all the cached responses, e.g. after the BMC has been reset.
+
+**/
+VOID
+EFIAPI
+IpmiInvalidateAllCachedResponses (
+  VOID
+  );
+
+/**
+  Submit a sequence of commands in one call.
+
+  @param  Commands          The commands to send.
+  @param  Count             The number of entries in Commands.
+  @param  StopOnError       Don't send the rest of the sequence once a
+                            command has failed.
+
+  @retval EFI_SUCCESS       All the commands were sent successfully.
+  @return The status of the first command which failed.
+
+**/
+EFI_STATUS
+EFIAPI
+IpmiSubmitCommandSequence (
+  IN OUT IPMI_COMMAND_SEQUENCE_ENTRY *Commands,
+  IN     UINTN                       Count,
+  IN     BOOLEAN                     StopOnError
+  );
+
 #endif
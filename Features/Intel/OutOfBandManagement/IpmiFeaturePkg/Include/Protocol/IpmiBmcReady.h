@@ -0,0 +1,23 @@
+/** @file
+  The IPMI BMC ready protocol is installed once the BMC probe has finished,
+  whether the BMC answered or not. The drivers talking to the BMC wait for
+  it instead of each retrying the BMC while it boots.
+
+Copyright (c) 2018 - 2019, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _IPMI_BMC_READY_PROTOCOL_H_
+#define _IPMI_BMC_READY_PROTOCOL_H_
+
+#include <Guid/IpmiBmcStatusHob.h>
+
+#define IPMI_BMC_READY_PROTOCOL_GUID \
+  { 0xe1733f1f, 0xbcdf, 0x4e94, { 0xbc, 0xc0, 0x1d, 0x36, 0xef, 0x2c, 0x09, 0x5e } }
+
+typedef IPMI_BMC_STATUS IPMI_BMC_READY_PROTOCOL;
+
+extern EFI_GUID gIpmiBmcReadyProtocolGuid;
+
+#endif
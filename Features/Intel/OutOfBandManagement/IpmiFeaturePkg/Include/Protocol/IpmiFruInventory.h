@@ -0,0 +1,49 @@
+/** @file
+  The IPMI FRU inventory protocol holds the chassis, board and product info
+  areas of the BMC FRU device 0, decoded once by IpmiFru. The SMBIOS type
+  1, 2 and 3 producers read it instead of the BMC.
+
+  The strings are NULL terminated ASCII, empty when the field is absent or
+  uses a type this decoder doesn't know.
+
+Copyright (c) 2018 - 2019, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _IPMI_FRU_INVENTORY_PROTOCOL_H_
+#define _IPMI_FRU_INVENTORY_PROTOCOL_H_
+
+#define IPMI_FRU_INVENTORY_PROTOCOL_GUID \
+  { 0x8a4c3de1, 0x58b6, 0x4c4f, { 0x9e, 0x1d, 0x7b, 0x52, 0x0c, 0xa3, 0x46, 0xf9 } }
+
+//
+// A type/length byte encodes at most 63 bytes.
+//
+#define IPMI_FRU_STRING_SIZE  64
+
+typedef struct {
+  BOOLEAN   ChassisAreaPresent;
+  UINT8     ChassisType;
+  CHAR8     ChassisPartNumber[IPMI_FRU_STRING_SIZE];
+  CHAR8     ChassisSerialNumber[IPMI_FRU_STRING_SIZE];
+
+  BOOLEAN   BoardAreaPresent;
+  UINT32    BoardMfgDateTime;       ///< Minutes since 1996-01-01 00:00.
+  CHAR8     BoardManufacturer[IPMI_FRU_STRING_SIZE];
+  CHAR8     BoardProductName[IPMI_FRU_STRING_SIZE];
+  CHAR8     BoardSerialNumber[IPMI_FRU_STRING_SIZE];
+  CHAR8     BoardPartNumber[IPMI_FRU_STRING_SIZE];
+
+  BOOLEAN   ProductAreaPresent;
+  CHAR8     ProductManufacturer[IPMI_FRU_STRING_SIZE];
+  CHAR8     ProductName[IPMI_FRU_STRING_SIZE];
+  CHAR8     ProductPartNumber[IPMI_FRU_STRING_SIZE];
+  CHAR8     ProductVersion[IPMI_FRU_STRING_SIZE];
+  CHAR8     ProductSerialNumber[IPMI_FRU_STRING_SIZE];
+  CHAR8     ProductAssetTag[IPMI_FRU_STRING_SIZE];
+} IPMI_FRU_INVENTORY_PROTOCOL;
+
+extern EFI_GUID gIpmiFruInventoryProtocolGuid;
+
+#endif
@@ -11,25 +11,454 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/UefiLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <Library/IpmiCommandLib.h>
 #include <IndustryStandard/Ipmi.h>
+#include <Protocol/IpmiBmcReady.h>
+#include <Protocol/IpmiFruInventory.h>
 
+//
+// Read FRU Data is tried with the largest chunk first, the BMC rejects a
+// count its buffers can't hold with one of these completion codes.
+//
+#define IPMI_FRU_MAX_CHUNK_SIZE           128
+#define IPMI_FRU_MIN_CHUNK_SIZE           16
+#define IPMI_FRU_MAX_SEQUENCE             16
+
+#define IPMI_CC_REQUEST_LENGTH_INVALID    0xC7
+#define IPMI_CC_REQUEST_LENGTH_EXCEEDED   0xC8
+#define IPMI_CC_CANNOT_RETURN_DATA        0xCA
+
+#define IPMI_FRU_AREA_CHASSIS             0
+#define IPMI_FRU_AREA_BOARD               1
+#define IPMI_FRU_AREA_PRODUCT             2
+#define IPMI_FRU_AREA_COUNT               3
+
+#define IPMI_FRU_AREA_HEADER_SIZE         8
+#define IPMI_FRU_END_OF_FIELDS            0xC1
+
+#define IPMI_FRU_CACHE_SIGNATURE          SIGNATURE_32 ('I', 'F', 'R', 'U')
+#define IPMI_FRU_CACHE_VARIABLE_NAME      L"IpmiFruCache"
+
+//
+// The FRU format has no last modified time stamp, the cache is keyed on
+// the common header and on the first 8 bytes and the checksum of each
+// area. The board area header holds the manufacturing date.
+//
+typedef struct {
+  UINT32                        Signature;
+  UINT16                        InventoryAreaSize;
+  UINT8                         CommonHeader[8];
+  UINT8                         AreaHeader[IPMI_FRU_AREA_COUNT][IPMI_FRU_AREA_HEADER_SIZE];
+  UINT8                         AreaChecksum[IPMI_FRU_AREA_COUNT];
+} IPMI_FRU_CACHE_KEY;
+
+typedef struct {
+  IPMI_FRU_CACHE_KEY            Key;
+  IPMI_FRU_INVENTORY_PROTOCOL   Inventory;
+} IPMI_FRU_CACHE;
+
+IPMI_FRU_INVENTORY_PROTOCOL     mFruInventory;
+UINTN                           mFruChunkSize = IPMI_FRU_MAX_CHUNK_SIZE;
+
+/**
+  Read a range of the FRU device 0.
+
+  The range is read with a sequence of Read FRU Data commands of the
+  largest chunk size the BMC accepts, the size found is kept for the
+  following reads.
+
+  @param[in]  Offset    The offset in the FRU device.
+  @param[in]  Size      The number of bytes to read.
+  @param[out] Buffer    The buffer for the data.
+
+  @retval EFI_SUCCESS       The range was read.
+  @retval EFI_DEVICE_ERROR  The BMC failed a command.
+
+**/
 EFI_STATUS
-EFIAPI
-InitializeFru (
-  IN EFI_HANDLE             ImageHandle,
-  IN EFI_SYSTEM_TABLE       *SystemTable
+IpmiFruRead (
+  IN  UINTN    Offset,
+  IN  UINTN    Size,
+  OUT UINT8    *Buffer
+  )
+{
+  IPMI_COMMAND_SEQUENCE_ENTRY  Commands[IPMI_FRU_MAX_SEQUENCE];
+  UINT8                        Request[IPMI_FRU_MAX_SEQUENCE][4];
+  UINT8                        Response[IPMI_FRU_MAX_SEQUENCE][IPMI_FRU_MAX_CHUNK_SIZE + 2];
+  UINTN                        Count;
+  UINTN                        Index;
+  UINTN                        Length;
+  UINTN                        Returned;
+
+  while (Size > 0) {
+    for (Count = 0, Length = 0; (Count < IPMI_FRU_MAX_SEQUENCE) && (Length < Size); Count++) {
+      Request[Count][0] = 0;
+      Request[Count][1] = (UINT8)(Offset + Length);
+      Request[Count][2] = (UINT8)((Offset + Length) >> 8);
+      Request[Count][3] = (UINT8)MIN (mFruChunkSize, Size - Length);
+
+      Commands[Count].NetFunction      = IPMI_NETFN_STORAGE;
+      Commands[Count].Command          = IPMI_STORAGE_READ_FRU_DATA;
+      Commands[Count].RequestData      = Request[Count];
+      Commands[Count].RequestDataSize  = sizeof (Request[Count]);
+      Commands[Count].ResponseData     = Response[Count];
+      Commands[Count].ResponseDataSize = sizeof (Response[Count]);
+      Length += Request[Count][3];
+    }
+
+    IpmiSubmitCommandSequence (Commands, Count, TRUE);
+
+    for (Index = 0; Index < Count; Index++) {
+      if (EFI_ERROR (Commands[Index].Status) ||
+          (Commands[Index].ResponseDataSize < 2) ||
+          (Response[Index][0] != IPMI_COMP_CODE_NORMAL)) {
+        //
+        // Retry the rest with smaller chunks if the BMC may have refused
+        // the size.
+        //
+        if ((mFruChunkSize > IPMI_FRU_MIN_CHUNK_SIZE) &&
+            (EFI_ERROR (Commands[Index].Status) ||
+             (Response[Index][0] == IPMI_CC_REQUEST_LENGTH_INVALID) ||
+             (Response[Index][0] == IPMI_CC_REQUEST_LENGTH_EXCEEDED) ||
+             (Response[Index][0] == IPMI_CC_CANNOT_RETURN_DATA))) {
+          mFruChunkSize /= 2;
+          break;
+        }
+        DEBUG ((DEBUG_ERROR, "[IPMI] Read FRU Data at 0x%x failed: %r, 0x%x\n", (UINT32)Offset, Commands[Index].Status, Response[Index][0]));
+        return EFI_DEVICE_ERROR;
+      }
+
+      Returned = MIN (Response[Index][1], Commands[Index].ResponseDataSize - 2);
+      Returned = MIN (Returned, Size);
+      if (Returned == 0) {
+        return EFI_DEVICE_ERROR;
+      }
+      CopyMem (Buffer, &Response[Index][2], Returned);
+      Buffer += Returned;
+      Offset += Returned;
+      Size   -= Returned;
+
+      //
+      // The offsets of the following commands are off after a short read.
+      //
+      if (Returned < Request[Index][3]) {
+        break;
+      }
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Check the zero checksum of a FRU header or area.
+
+  @param[in] Data    The data, the checksum byte included.
+  @param[in] Size    The size of Data.
+
+  @retval TRUE       The checksum is correct.
+
+**/
+BOOLEAN
+IpmiFruChecksumValid (
+  IN UINT8    *Data,
+  IN UINTN    Size
+  )
+{
+  UINT8    Sum;
+
+  for (Sum = 0; Size > 0; Size--) {
+    Sum = (UINT8)(Sum + *Data++);
+  }
+  return (BOOLEAN)(Sum == 0);
+}
+
+/**
+  Decode the type/length field at the Offset of an area as an ASCII string.
+
+  @param[in]      Area      The area.
+  @param[in]      AreaSize  The size of the area.
+  @param[in, out] Offset    The offset of the field, on output the offset
+                            of the next field.
+  @param[out]     String    The IPMI_FRU_STRING_SIZE bytes buffer for the
+                            string.
+
+  @retval TRUE    The field was decoded, String is empty for a binary one.
+  @retval FALSE   The end of the fields or of the area was reached.
+
+**/
+BOOLEAN
+IpmiFruGetField (
+  IN     UINT8    *Area,
+  IN     UINTN    AreaSize,
+  IN OUT UINTN    *Offset,
+  OUT    CHAR8    *String
+  )
+{
+  UINT8     TypeLength;
+  UINT8     *Data;
+  UINTN     Length;
+  UINTN     Index;
+  UINTN     Out;
+  UINTN     Shift;
+  UINT32    Bits;
+
+  String[0] = '\0';
+  if (*Offset >= AreaSize) {
+    return FALSE;
+  }
+  TypeLength = Area[*Offset];
+  Length     = TypeLength & 0x3F;
+  if ((TypeLength == IPMI_FRU_END_OF_FIELDS) || (*Offset + 1 + Length > AreaSize)) {
+    return FALSE;
+  }
+  Data     = &Area[*Offset + 1];
+  *Offset += 1 + Length;
+
+  Out = 0;
+  switch (TypeLength >> 6) {
+  case 1:
+    //
+    // BCD plus, two characters per byte.
+    //
+    for (Index = 0; (Index < Length * 2) && (Out < IPMI_FRU_STRING_SIZE - 1); Index++) {
+      Bits = (Index & 1) ? (Data[Index / 2] & 0xF) : (Data[Index / 2] >> 4);
+      String[Out++] = "0123456789 -.???"[Bits];
+    }
+    break;
+
+  case 2:
+    //
+    // 6-bit packed ASCII, four characters per three bytes.
+    //
+    for (Index = 0; Index < Length; Index += 3) {
+      Bits = Data[Index];
+      if (Index + 1 < Length) {
+        Bits |= Data[Index + 1] << 8;
+      }
+      if (Index + 2 < Length) {
+        Bits |= Data[Index + 2] << 16;
+      }
+      for (Shift = 0; (Shift < 24) && ((Index * 8) + Shift + 6 <= Length * 8); Shift += 6) {
+        if (Out < IPMI_FRU_STRING_SIZE - 1) {
+          String[Out++] = (CHAR8)(((Bits >> Shift) & 0x3F) + 0x20);
+        }
+      }
+    }
+    break;
+
+  case 3:
+    CopyMem (String, Data, Length);
+    Out = Length;
+    break;
+
+  default:
+    break;
+  }
+  String[Out] = '\0';
+
+  return TRUE;
+}
+
+/**
+  Decode one info area into mFruInventory.
+
+  @param[in] AreaType    IPMI_FRU_AREA_CHASSIS, _BOARD or _PRODUCT.
+  @param[in] Area        The area, at least IPMI_FRU_AREA_HEADER_SIZE bytes.
+  @param[in] AreaSize    The size of the area.
+
+**/
+VOID
+IpmiFruParseArea (
+  IN UINTN    AreaType,
+  IN UINT8    *Area,
+  IN UINTN    AreaSize
+  )
+{
+  CHAR8    *Fields[6];
+  UINTN    FieldCount;
+  UINTN    Index;
+  UINTN    Offset;
+
+  if (!IpmiFruChecksumValid (Area, AreaSize)) {
+    DEBUG ((DEBUG_ERROR, "[IPMI] FRU area %d checksum error\n", (UINT32)AreaType));
+    return;
+  }
+
+  switch (AreaType) {
+  case IPMI_FRU_AREA_CHASSIS:
+    mFruInventory.ChassisAreaPresent = TRUE;
+    mFruInventory.ChassisType        = Area[2];
+    Offset     = 3;
+    Fields[0]  = mFruInventory.ChassisPartNumber;
+    Fields[1]  = mFruInventory.ChassisSerialNumber;
+    FieldCount = 2;
+    break;
+
+  case IPMI_FRU_AREA_BOARD:
+    mFruInventory.BoardAreaPresent = TRUE;
+    mFruInventory.BoardMfgDateTime = Area[3] | (Area[4] << 8) | (Area[5] << 16);
+    Offset     = 6;
+    Fields[0]  = mFruInventory.BoardManufacturer;
+    Fields[1]  = mFruInventory.BoardProductName;
+    Fields[2]  = mFruInventory.BoardSerialNumber;
+    Fields[3]  = mFruInventory.BoardPartNumber;
+    FieldCount = 4;
+    break;
+
+  default:
+    mFruInventory.ProductAreaPresent = TRUE;
+    Offset     = 3;
+    Fields[0]  = mFruInventory.ProductManufacturer;
+    Fields[1]  = mFruInventory.ProductName;
+    Fields[2]  = mFruInventory.ProductPartNumber;
+    Fields[3]  = mFruInventory.ProductVersion;
+    Fields[4]  = mFruInventory.ProductSerialNumber;
+    Fields[5]  = mFruInventory.ProductAssetTag;
+    FieldCount = 6;
+    break;
+  }
+
+  for (Index = 0; Index < FieldCount; Index++) {
+    if (!IpmiFruGetField (Area, AreaSize, &Offset, Fields[Index])) {
+      break;
+    }
+  }
+}
+
+/**
+  Read the FRU info areas, from the cache of the previous boot when their
+  headers and checksums didn't change, and install the FRU inventory
+  protocol.
+
+  @param[in] InventoryAreaSize    The size of the FRU device 0.
+
+  @retval EFI_SUCCESS             The protocol was installed.
+  @return Others                  The FRU device couldn't be read.
+
+**/
+EFI_STATUS
+IpmiFruLoadInventory (
+  IN UINTN    InventoryAreaSize
+  )
+{
+  EFI_STATUS        Status;
+  IPMI_FRU_CACHE    Cache;
+  IPMI_FRU_CACHE    *Previous;
+  UINTN             Size;
+  UINTN             AreaType;
+  UINTN             AreaOffset[IPMI_FRU_AREA_COUNT];
+  UINTN             AreaSize[IPMI_FRU_AREA_COUNT];
+  UINT8             *Area;
+  EFI_HANDLE        Handle;
+
+  ZeroMem (&Cache, sizeof (Cache));
+  Cache.Key.Signature         = IPMI_FRU_CACHE_SIGNATURE;
+  Cache.Key.InventoryAreaSize = (UINT16)InventoryAreaSize;
+
+  Status = IpmiFruRead (0, sizeof (Cache.Key.CommonHeader), Cache.Key.CommonHeader);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  if (!IpmiFruChecksumValid (Cache.Key.CommonHeader, sizeof (Cache.Key.CommonHeader))) {
+    DEBUG ((DEBUG_ERROR, "[IPMI] FRU common header checksum error\n"));
+    return EFI_VOLUME_CORRUPTED;
+  }
+
+  //
+  // The chassis, board and product area offsets follow the internal use
+  // one, in multiples of 8 bytes.
+  //
+  for (AreaType = 0; AreaType < IPMI_FRU_AREA_COUNT; AreaType++) {
+    AreaOffset[AreaType] = Cache.Key.CommonHeader[2 + AreaType] * 8;
+    AreaSize[AreaType]   = 0;
+    if ((AreaOffset[AreaType] == 0) ||
+        (AreaOffset[AreaType] + IPMI_FRU_AREA_HEADER_SIZE > InventoryAreaSize)) {
+      continue;
+    }
+    Status = IpmiFruRead (AreaOffset[AreaType], IPMI_FRU_AREA_HEADER_SIZE, Cache.Key.AreaHeader[AreaType]);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    AreaSize[AreaType] = Cache.Key.AreaHeader[AreaType][1] * 8;
+    if ((AreaSize[AreaType] < IPMI_FRU_AREA_HEADER_SIZE) ||
+        (AreaOffset[AreaType] + AreaSize[AreaType] > InventoryAreaSize)) {
+      AreaSize[AreaType] = 0;
+      continue;
+    }
+    Status = IpmiFruRead (AreaOffset[AreaType] + AreaSize[AreaType] - 1, 1, &Cache.Key.AreaChecksum[AreaType]);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Status = GetVariable2 (IPMI_FRU_CACHE_VARIABLE_NAME, &gIpmiFruInventoryProtocolGuid, (VOID **)&Previous, &Size);
+  if (!EFI_ERROR (Status)) {
+    if ((Size == sizeof (Cache)) && (CompareMem (&Previous->Key, &Cache.Key, sizeof (Cache.Key)) == 0)) {
+      CopyMem (&Cache.Inventory, &Previous->Inventory, sizeof (Cache.Inventory));
+    } else {
+      Status = EFI_NOT_FOUND;
+    }
+    FreePool (Previous);
+  }
+
+  if (!EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "[IPMI] FRU areas unchanged, use the cached inventory\n"));
+    CopyMem (&mFruInventory, &Cache.Inventory, sizeof (mFruInventory));
+  } else {
+    for (AreaType = 0; AreaType < IPMI_FRU_AREA_COUNT; AreaType++) {
+      if (AreaSize[AreaType] == 0) {
+        continue;
+      }
+      Area = AllocatePool (AreaSize[AreaType]);
+      if (Area == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+      }
+      Status = IpmiFruRead (AreaOffset[AreaType], AreaSize[AreaType], Area);
+      if (!EFI_ERROR (Status)) {
+        IpmiFruParseArea (AreaType, Area, AreaSize[AreaType]);
+      }
+      FreePool (Area);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    CopyMem (&Cache.Inventory, &mFruInventory, sizeof (Cache.Inventory));
+    Status = gRT->SetVariable (
+                    IPMI_FRU_CACHE_VARIABLE_NAME,
+                    &gIpmiFruInventoryProtocolGuid,
+                    EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                    sizeof (Cache),
+                    &Cache
+                    );
+    DEBUG ((DEBUG_INFO, "[IPMI] FRU inventory cache update: %r\n", Status));
+  }
+
+  Handle = NULL;
+  return gBS->InstallMultipleProtocolInterfaces (
+                &Handle,
+                &gIpmiFruInventoryProtocolGuid,
+                &mFruInventory,
+                NULL
+                );
+}
+
+EFI_STATUS
+GetFruInventory (
+  VOID
   )
 /*++
 
 Routine Description:
 
-  Initialize SM Redirection Fru Layer
+  Read the FRU inventory information from the BMC
 
 Arguments:
 
-  ImageHandle - ImageHandle of the loaded driver
-  SystemTable - Pointer to the System Table
+  None
 
 Returns:
 
@@ -61,7 +490,80 @@ Returns:
       return Status;
     }
     DEBUG((DEBUG_ERROR, "!!! IpmiFru  InventoryAreaSize=%x\n", GetFruInventoryAreaInfoResponse.InventoryAreaSize));
+
+    Status = IpmiFruLoadInventory (GetFruInventoryAreaInfoResponse.InventoryAreaSize);
+    if (EFI_ERROR (Status)) {
+      DEBUG((DEBUG_ERROR, "!!! IpmiFru  IpmiFruLoadInventory Status=%r\n", Status));
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Run the FRU inventory read once DxeIpmiInit has
+  finished probing the BMC.
+
+  @param[in] Event    The protocol notify event.
+  @param[in] Context  Not used.
+
+**/
+VOID
+EFIAPI
+FruBmcReady (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  EFI_STATUS                Status;
+  IPMI_BMC_READY_PROTOCOL   *BmcReady;
+
+  Status = gBS->LocateProtocol (&gIpmiBmcReadyProtocolGuid, NULL, (VOID **)&BmcReady);
+  if (EFI_ERROR (Status)) {
+    return;
   }
+  gBS->CloseEvent (Event);
+
+  if (!BmcReady->Responding) {
+    DEBUG ((DEBUG_ERROR, "[IPMI] BMC does not respond, skip the FRU inventory read\n"));
+    return;
+  }
+
+  GetFruInventory ();
+}
+
+EFI_STATUS
+EFIAPI
+InitializeFru (
+  IN EFI_HANDLE             ImageHandle,
+  IN EFI_SYSTEM_TABLE       *SystemTable
+  )
+/*++
+
+Routine Description:
+
+  Initialize SM Redirection Fru Layer
+
+Arguments:
+
+  ImageHandle - ImageHandle of the loaded driver
+  SystemTable - Pointer to the System Table
+
+Returns:
+
+  EFI_STATUS
+
+--*/
+{
+  VOID        *Registration;
 
+  EfiCreateProtocolNotifyEvent (
+    &gIpmiBmcReadyProtocolGuid,
+    TPL_CALLBACK,
+    FruBmcReady,
+    NULL,
+    &Registration
+    );
   return EFI_SUCCESS;
 }
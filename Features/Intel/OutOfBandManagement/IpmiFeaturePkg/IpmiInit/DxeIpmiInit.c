@@ -10,10 +10,17 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/TimerLib.h>
+#include <Library/HobLib.h>
+#include <Library/UefiBootServicesTableLib.h>
 #include <Library/IpmiCommandLib.h>
+#include <Protocol/IpmiBmcReady.h>
 
 #define BMC_TIMEOUT          30  // [s] How long shall BIOS wait for BMC
-#define BMC_KCS_TIMEOUT      5   // [s] Single KSC request timeout
+#define BMC_PROBE_PERIOD     EFI_TIMER_PERIOD_MILLISECONDS (50)
+
+EFI_EVENT                 mBmcProbeEvent;
+UINT64                    mBmcProbeStart;
+IPMI_BMC_READY_PROTOCOL   mBmcReady;
 
 EFI_STATUS
 GetSelfTest (
@@ -75,28 +82,14 @@ Returns:
 {
   EFI_STATUS                   Status;
   IPMI_GET_DEVICE_ID_RESPONSE  BmcInfo;
-  UINT32                       Retries;
 
-  //
-  // Set up a loop to retry for up to 30 seconds. Calculate retries not timeout
-  // so that in case KCS is not enabled and EfiIpmiSendCommand() returns
-  // immediately we will not wait all the 30 seconds.
-  //
-  Retries = BMC_TIMEOUT / BMC_KCS_TIMEOUT + 1;
   //
   // Get the device ID information for the BMC.
   //
-  do {
-    Status = IpmiGetDeviceId (&BmcInfo);
-    if (!EFI_ERROR(Status)) {
-      break;
-    }
-    DEBUG ((DEBUG_ERROR, "[IPMI] BMC does not respond (status: %r), %d retries left\n", Status, Retries));
-    MicroSecondDelay(50 * 1000);
-    if (Retries-- == 0) {
-      return Status;
-    }
-  } while (TRUE);
+  Status = IpmiGetDeviceId (&BmcInfo);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
 
   DEBUG((
     DEBUG_INFO,
@@ -109,6 +102,78 @@ Returns:
   return Status;
 }
 
+/**
+  Finish the BMC probe and let the drivers waiting for the BMC run.
+
+  @param[in] Status      The status of the Get Device ID command.
+  @param[in] UpdateMode  The BMC is in firmware update mode.
+
+**/
+VOID
+BmcProbeDone (
+  IN EFI_STATUS   Status,
+  IN BOOLEAN      UpdateMode
+  )
+{
+  EFI_HANDLE   Handle;
+
+  mBmcReady.Responding = (BOOLEAN)!EFI_ERROR (Status);
+  mBmcReady.UpdateMode = UpdateMode;
+
+  //
+  // Do not continue initialization if the BMC is in Force Update Mode.
+  //
+  if (mBmcReady.Responding && !UpdateMode) {
+    //
+    // Get the SELF TEST Results.
+    //
+    GetSelfTest ();
+  }
+
+  Handle = NULL;
+  Status = gBS->InstallProtocolInterface (
+                  &Handle,
+                  &gIpmiBmcReadyProtocolGuid,
+                  EFI_NATIVE_INTERFACE,
+                  &mBmcReady
+                  );
+  ASSERT_EFI_ERROR (Status);
+}
+
+/**
+  Retry the BMC which didn't answer yet, this runs from a timer event so
+  the rest of DXE keeps dispatching while the BMC boots.
+
+  @param[in] Event    The timer event.
+  @param[in] Context  Not used.
+
+**/
+VOID
+EFIAPI
+BmcProbeTimer (
+  IN EFI_EVENT    Event,
+  IN VOID         *Context
+  )
+{
+  BOOLEAN      UpdateMode;
+  EFI_STATUS   Status;
+  UINT64       Elapsed;
+
+  UpdateMode = FALSE;
+  Status = GetDeviceId (&UpdateMode);
+  if (EFI_ERROR (Status)) {
+    Elapsed = DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - mBmcProbeStart), 1000000);
+    if (Elapsed < BMC_TIMEOUT * 1000) {
+      DEBUG ((DEBUG_ERROR, "[IPMI] BMC does not respond (status: %r), %ld ms left\n", Status, BMC_TIMEOUT * 1000 - Elapsed));
+      return;
+    }
+    DEBUG ((DEBUG_ERROR, "\n[IPMI] BMC does not respond (status: %r), giving up\n\n", Status));
+  }
+
+  gBS->CloseEvent (Event);
+  BmcProbeDone (Status, UpdateMode);
+}
+
 /**
   The entry point of the Ipmi DXE.
 
@@ -125,25 +190,52 @@ IpmiInterfaceInit (
   IN EFI_SYSTEM_TABLE       *SystemTable
   )
 {
-  BOOLEAN      UpdateMode;
-  EFI_STATUS   Status;
+  BOOLEAN             UpdateMode;
+  EFI_STATUS          Status;
+  EFI_HOB_GUID_TYPE   *GuidHob;
+  IPMI_BMC_STATUS     *BmcStatus;
 
   DEBUG((DEBUG_ERROR,"IPMI Dxe:Get BMC Device Id\n"));
 
   //
-  // Get the Device ID and check if the system is in Force Update mode.
+  // Nothing left to wait for if the BMC already answered in PEI.
   //
-  Status = GetDeviceId (&UpdateMode);
+  GuidHob = GetFirstGuidHob (&gIpmiBmcStatusHobGuid);
+  if (GuidHob != NULL) {
+    BmcStatus = (IPMI_BMC_STATUS *)GET_GUID_HOB_DATA (GuidHob);
+    if (BmcStatus->Responding) {
+      BmcProbeDone (EFI_SUCCESS, BmcStatus->UpdateMode);
+      return EFI_SUCCESS;
+    }
+  }
+
   //
-  // Do not continue initialization if the BMC is in Force Update Mode.
+  // Keep probing the BMC from a timer event until it answers or
+  // BMC_TIMEOUT expires.
   //
-  if (!EFI_ERROR(Status) && !UpdateMode) {
-    //
-    // Get the SELF TEST Results.
-    //
-    GetSelfTest ();
+  mBmcProbeStart = GetPerformanceCounter ();
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  BmcProbeTimer,
+                  NULL,
+                  &mBmcProbeEvent
+                  );
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->SetTimer (mBmcProbeEvent, TimerPeriodic, BMC_PROBE_PERIOD);
+    if (!EFI_ERROR (Status)) {
+      return EFI_SUCCESS;
+    }
+    gBS->CloseEvent (mBmcProbeEvent);
   }
 
+  //
+  // Get the Device ID and check if the system is in Force Update mode.
+  //
+  UpdateMode = FALSE;
+  Status = GetDeviceId (&UpdateMode);
+  BmcProbeDone (Status, UpdateMode);
+
   return EFI_SUCCESS;
 }
 
@@ -9,11 +9,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <PiPei.h>
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
-#include <Library/TimerLib.h>
+#include <Library/HobLib.h>
 #include <Library/IpmiCommandLib.h>
-
-#define BMC_TIMEOUT_PEI      50  // [s] How long shall BIOS wait for BMC
-#define BMC_KCS_TIMEOUT      5   // [s] Single KSC request timeout
+#include <Guid/IpmiBmcStatusHob.h>
 
 EFI_STATUS
 GetDeviceId (
@@ -25,6 +23,9 @@ Routine Description:
   Execute the Get Device ID command to determine whether or not the BMC is in Force Update
   Mode.  If it is, then report it to the error manager.
 
+  The command is sent once, a BMC which is still booting is retried by
+  DxeIpmiInit in the background instead of holding up PEI.
+
 Arguments:
 
 Returns:
@@ -34,27 +35,15 @@ Returns:
 {
   EFI_STATUS                   Status;
   IPMI_GET_DEVICE_ID_RESPONSE  BmcInfo;
-  UINT32                       Retries;
 
-  //
-  // Set up a loop to retry for up to 30 seconds. Calculate retries not timeout
-  // so that in case KCS is not enabled and EfiIpmiSendCommand() returns
-  // immediately we will not wait all the 30 seconds.
-  //
-  Retries = BMC_TIMEOUT_PEI/ BMC_KCS_TIMEOUT + 1;
   //
   // Get the device ID information for the BMC.
   //
-  do {
-    Status = IpmiGetDeviceId (&BmcInfo);
-    if (!EFI_ERROR(Status)) {
-      break;
-    }
-    DEBUG ((DEBUG_ERROR, "[IPMI] BMC does not respond (status: %r), %d retries left\n", Status, Retries));
-    if (Retries-- == 0) {
-      return Status;
-    }
-  } while (TRUE);
+  Status = IpmiGetDeviceId (&BmcInfo);
+  if (EFI_ERROR(Status)) {
+    DEBUG ((DEBUG_ERROR, "[IPMI] BMC does not respond (status: %r), left to DXE\n", Status));
+    return Status;
+  }
 
   DEBUG((
     DEBUG_INFO,
@@ -83,14 +72,25 @@ PeimIpmiInterfaceInit (
   IN CONST EFI_PEI_SERVICES     **PeiServices
   )
 {
-  BOOLEAN      UpdateMode;
-  EFI_STATUS   Status;
+  BOOLEAN          UpdateMode;
+  EFI_STATUS       Status;
+  IPMI_BMC_STATUS  BmcStatus;
 
   DEBUG ((DEBUG_INFO, "IPMI Peim:Get BMC Device Id\n"));
 
   //
   // Get the Device ID and check if the system is in Force Update mode.
   //
+  UpdateMode = FALSE;
   Status = GetDeviceId (&UpdateMode);
+
+  //
+  // Hand the result to DxeIpmiInit, which only keeps probing if the BMC
+  // didn't answer here.
+  //
+  BmcStatus.Responding = (BOOLEAN)!EFI_ERROR (Status);
+  BmcStatus.UpdateMode = UpdateMode;
+  BuildGuidDataHob (&gIpmiBmcStatusHobGuid, &BmcStatus, sizeof (BmcStatus));
+
   return Status;
 }
@@ -0,0 +1,241 @@
+/** @file
+  IPMI Command - response cache and command sequences.
+
+  The cache is kept in the globals of the module linking this library, it
+  is only filled by IpmiSubmitCommandCached () so modules running from
+  flash can keep using the other commands.
+
+Copyright (c) 2018 - 2019, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiPei.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/IpmiLib.h>
+#include <Library/IpmiCommandLib.h>
+
+#include <IndustryStandard/Ipmi.h>
+
+#define IPMI_CACHE_ENTRY_COUNT        8
+#define IPMI_CACHE_MAX_REQUEST_SIZE   8
+#define IPMI_CACHE_MAX_RESPONSE_SIZE  64
+
+typedef struct {
+  BOOLEAN   Valid;
+  UINT8     NetFunction;
+  UINT8     Command;
+  UINT8     RequestDataSize;
+  UINT8     RequestData[IPMI_CACHE_MAX_REQUEST_SIZE];
+  UINT32    ResponseDataSize;
+  UINT8     ResponseData[IPMI_CACHE_MAX_RESPONSE_SIZE];
+} IPMI_CACHED_RESPONSE;
+
+IPMI_CACHED_RESPONSE  mIpmiResponseCache[IPMI_CACHE_ENTRY_COUNT];
+UINTN                 mIpmiResponseCacheNext;
+
+/**
+  Find the cached response of a command.
+
+  @param  NetFunction       The net function of the command.
+  @param  Command           The command.
+  @param  RequestData       The request data of the command.
+  @param  RequestDataSize   The size of RequestData.
+
+  @return The cache entry, NULL if the response isn't cached.
+
+**/
+IPMI_CACHED_RESPONSE *
+IpmiFindCachedResponse (
+  IN UINT8     NetFunction,
+  IN UINT8     Command,
+  IN UINT8     *RequestData,
+  IN UINT32    RequestDataSize
+  )
+{
+  UINTN                 Index;
+  IPMI_CACHED_RESPONSE  *Entry;
+
+  for (Index = 0; Index < IPMI_CACHE_ENTRY_COUNT; Index++) {
+    Entry = &mIpmiResponseCache[Index];
+    if (Entry->Valid &&
+        (Entry->NetFunction == NetFunction) &&
+        (Entry->Command == Command) &&
+        (Entry->RequestDataSize == RequestDataSize) &&
+        (CompareMem (Entry->RequestData, RequestData, RequestDataSize) == 0)) {
+      return Entry;
+    }
+  }
+  return NULL;
+}
+
+/**
+  Submit an idempotent command, answering it from the cache if it has
+  been sent before with the same request data.
+
+  Only successful responses with a normal completion code are cached. The
+  cached response stays valid for the rest of the boot, unless it is
+  invalidated by IpmiInvalidateCachedResponse () or by a command of this
+  library which changes it.
+
+  @param  NetFunction       The net function of the command.
+  @param  Command           The command.
+  @param  RequestData       The request data of the command.
+  @param  RequestDataSize   The size of RequestData.
+  @param  ResponseData      The buffer for the response.
+  @param  ResponseDataSize  On input the size of ResponseData, on output the
+                            size of the response.
+
+  @return The status of IpmiSubmitCommand (), EFI_SUCCESS for a cached
+          response.
+
+**/
+EFI_STATUS
+EFIAPI
+IpmiSubmitCommandCached (
+  IN     UINT8     NetFunction,
+  IN     UINT8     Command,
+  IN     UINT8     *RequestData,
+  IN     UINT32    RequestDataSize,
+  OUT    UINT8     *ResponseData,
+  IN OUT UINT32    *ResponseDataSize
+  )
+{
+  EFI_STATUS            Status;
+  IPMI_CACHED_RESPONSE  *Entry;
+
+  if (RequestDataSize > IPMI_CACHE_MAX_REQUEST_SIZE) {
+    return IpmiSubmitCommand (NetFunction, Command, RequestData, RequestDataSize, ResponseData, ResponseDataSize);
+  }
+
+  Entry = IpmiFindCachedResponse (NetFunction, Command, RequestData, RequestDataSize);
+  if ((Entry != NULL) && (Entry->ResponseDataSize <= *ResponseDataSize)) {
+    CopyMem (ResponseData, Entry->ResponseData, Entry->ResponseDataSize);
+    *ResponseDataSize = Entry->ResponseDataSize;
+    return EFI_SUCCESS;
+  }
+
+  Status = IpmiSubmitCommand (NetFunction, Command, RequestData, RequestDataSize, ResponseData, ResponseDataSize);
+  if (EFI_ERROR (Status) ||
+      (*ResponseDataSize == 0) ||
+      (*ResponseDataSize > IPMI_CACHE_MAX_RESPONSE_SIZE) ||
+      (ResponseData[0] != IPMI_COMP_CODE_NORMAL)) {
+    return Status;
+  }
+
+  if (Entry == NULL) {
+    Entry = &mIpmiResponseCache[mIpmiResponseCacheNext];
+    mIpmiResponseCacheNext = (mIpmiResponseCacheNext + 1) % IPMI_CACHE_ENTRY_COUNT;
+  }
+  Entry->Valid            = TRUE;
+  Entry->NetFunction      = NetFunction;
+  Entry->Command          = Command;
+  Entry->RequestDataSize  = (UINT8)RequestDataSize;
+  CopyMem (Entry->RequestData, RequestData, RequestDataSize);
+  Entry->ResponseDataSize = *ResponseDataSize;
+  CopyMem (Entry->ResponseData, ResponseData, *ResponseDataSize);
+
+  return Status;
+}
+
+/**
+  Drop the cached responses of a command, whatever their request data.
+
+  @param  NetFunction       The net function of the command.
+  @param  Command           The command.
+
+**/
+VOID
+EFIAPI
+IpmiInvalidateCachedResponse (
+  IN UINT8     NetFunction,
+  IN UINT8     Command
+  )
+{
+  UINTN                 Index;
+
+  for (Index = 0; Index < IPMI_CACHE_ENTRY_COUNT; Index++) {
+    if (mIpmiResponseCache[Index].Valid &&
+        (mIpmiResponseCache[Index].NetFunction == NetFunction) &&
+        (mIpmiResponseCache[Index].Command == Command)) {
+      mIpmiResponseCache[Index].Valid = FALSE;
+    }
+  }
+}
+
+/**
+  Drop all the cached responses, e.g. after the BMC has been reset.
+
+**/
+VOID
+EFIAPI
+IpmiInvalidateAllCachedResponses (
+  VOID
+  )
+{
+  UINTN                 Index;
+
+  for (Index = 0; Index < IPMI_CACHE_ENTRY_COUNT; Index++) {
+    mIpmiResponseCache[Index].Valid = FALSE;
+  }
+}
+
+/**
+  Submit a sequence of commands, e.g. the Read FRU Data commands of a
+  multi-record read, in one call.
+
+  The system interface handles one command at a time so the commands are
+  sent back to back in order. The status and response size of each one
+  are returned in its entry.
+
+  @param  Commands          The commands to send.
+  @param  Count             The number of entries in Commands.
+  @param  StopOnError       Don't send the rest of the sequence once a
+                            command has failed.
+
+  @retval EFI_SUCCESS       All the commands were sent successfully.
+  @return The status of the first command which failed.
+
+**/
+EFI_STATUS
+EFIAPI
+IpmiSubmitCommandSequence (
+  IN OUT IPMI_COMMAND_SEQUENCE_ENTRY *Commands,
+  IN     UINTN                       Count,
+  IN     BOOLEAN                     StopOnError
+  )
+{
+  EFI_STATUS   Status;
+  UINTN        Index;
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < Count; Index++) {
+    Commands[Index].Status = IpmiSubmitCommand (
+                               Commands[Index].NetFunction,
+                               Commands[Index].Command,
+                               Commands[Index].RequestData,
+                               Commands[Index].RequestDataSize,
+                               Commands[Index].ResponseData,
+                               &Commands[Index].ResponseDataSize
+                               );
+    if (!EFI_ERROR (Commands[Index].Status)) {
+      continue;
+    }
+    if (!EFI_ERROR (Status)) {
+      Status = Commands[Index].Status;
+    }
+    if (StopOnError) {
+      break;
+    }
+  }
+
+  //
+  // Mark the commands which weren't sent.
+  //
+  for (Index++; Index < Count; Index++) {
+    Commands[Index].Status = EFI_NOT_STARTED;
+  }
+
+  return Status;
+}
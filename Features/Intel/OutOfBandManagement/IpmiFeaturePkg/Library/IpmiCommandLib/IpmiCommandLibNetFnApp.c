@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/IpmiLib.h>
+#include <Library/IpmiCommandLib.h>
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -95,6 +96,7 @@ IpmiSetWatchdogTimer (
              (VOID *)CompletionCode,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_APP, IPMI_APP_GET_WATCHDOG_TIMER);
   return Status;
 }
 
@@ -138,6 +140,7 @@ IpmiSetBmcGlobalEnables (
              (VOID *)CompletionCode,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_APP, IPMI_APP_GET_BMC_GLOBAL_ENABLES);
   return Status;
 }
 
@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/IpmiLib.h>
+#include <Library/IpmiCommandLib.h>
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -97,5 +98,6 @@ IpmiSetPowerRestorePolicy (
              (VOID *)ChassisControlResponse,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_CHASSIS, IPMI_CHASSIS_GET_STATUS);
   return Status;
 }
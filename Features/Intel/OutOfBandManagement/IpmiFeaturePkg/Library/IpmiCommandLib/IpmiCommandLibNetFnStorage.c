@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/IpmiLib.h>
+#include <Library/IpmiCommandLib.h>
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -77,6 +78,8 @@ IpmiWriteFruData (
              (VOID *)WriteFruDataResponse,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_FRU_INVENTORY_AREAINFO);
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_READ_FRU_DATA);
   return Status;
 }
 
@@ -141,6 +144,8 @@ IpmiAddSelEntry (
              (VOID *)AddSelEntryResponse,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_INFO);
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_ENTRY);
   return Status;
 }
 
@@ -164,6 +169,8 @@ IpmiPartialAddSelEntry (
              (VOID *)PartialAddSelEntryResponse,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_INFO);
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_ENTRY);
   return Status;
 }
 
@@ -186,6 +193,8 @@ IpmiClearSel (
              (VOID *)ClearSelResponse,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_INFO);
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_ENTRY);
   return Status;
 }
 
@@ -229,6 +238,7 @@ IpmiSetSelTime (
              (VOID *)CompletionCode,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_STORAGE, IPMI_STORAGE_GET_SEL_TIME);
   return Status;
 }
 
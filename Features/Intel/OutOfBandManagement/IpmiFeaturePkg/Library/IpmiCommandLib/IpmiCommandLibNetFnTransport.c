@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/IpmiLib.h>
+#include <Library/IpmiCommandLib.h>
 
 #include <IndustryStandard/Ipmi.h>
 
@@ -56,6 +57,7 @@ IpmiSetSolConfigurationParameters (
              (VOID *)CompletionCode,
              &DataSize
              );
+  IpmiInvalidateCachedResponse (IPMI_NETFN_TRANSPORT, IPMI_TRANSPORT_GET_SOL_CONFIG_PARAM);
   return Status;
 }
 
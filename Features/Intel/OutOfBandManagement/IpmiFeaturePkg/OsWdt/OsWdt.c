@@ -12,6 +12,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/IpmiCommandLib.h>
 #include <IndustryStandard/Ipmi.h>
+#include <Protocol/IpmiBmcReady.h>
 
 BOOLEAN mOsWdtFlag = FALSE;
 
@@ -42,6 +43,7 @@ Returns:
   IPMI_SET_WATCHDOG_TIMER_REQUEST  SetWatchdogTimer;
   UINT8                            CompletionCode;
   IPMI_GET_WATCHDOG_TIMER_RESPONSE GetWatchdogTimer;
+  IPMI_BMC_READY_PROTOCOL          *BmcReady;
   static BOOLEAN                   OsWdtEventHandled = FALSE;
 
   DEBUG((DEBUG_ERROR, "!!! EnableEfiOsBootWdtHandler()!!!\n"));
@@ -55,6 +57,14 @@ Returns:
 
   OsWdtEventHandled = TRUE;
 
+  //
+  // Don't pay the command timeouts if the BMC never answered.
+  //
+  Status = gBS->LocateProtocol (&gIpmiBmcReadyProtocolGuid, NULL, (VOID **)&BmcReady);
+  if (EFI_ERROR (Status) || !BmcReady->Responding) {
+    return ;
+  }
+
   Status = IpmiGetWatchdogTimer (&GetWatchdogTimer);
   if (EFI_ERROR (Status)) {
     return ;
@@ -13,8 +13,10 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
+#include <Library/UefiLib.h>
 #include <Library/IpmiCommandLib.h>
 #include <IndustryStandard/Ipmi.h>
+#include <Protocol/IpmiBmcReady.h>
 
 #define SOL_CMD_RETRY_COUNT           10
 
@@ -126,24 +128,20 @@ SetSOLParams (
 }
 
 EFI_STATUS
-EFIAPI
-SolStatusEntryPoint (
-  IN EFI_HANDLE         ImageHandle,
-  IN EFI_SYSTEM_TABLE   *SystemTable
+ReportSolStatus (
+  VOID
   )
 /*++
 
   Routine Description:
-    This is the standard EFI driver point. This function initializes
-    the private data required for creating SOL Status Driver.
+    Read the SOL enabling status of every LAN channel from the BMC.
 
   Arguments:
-    ImageHandle     - Handle for the image of this driver
-    SystemTable     - Pointer to the EFI System Table
+    None
 
   Returns:
-    EFI_SUCCESS     - Protocol successfully installed
-    EFI_UNSUPPORTED - Protocol can't be installed.
+    EFI_SUCCESS     - The status of the last channel was read.
+    Others          - The status of the last channel could not be read.
 
 --*/
 {
@@ -162,3 +160,69 @@ SolStatusEntryPoint (
 
   return Status;
 }
+
+/**
+  Run the SOL status read once DxeIpmiInit has
+  finished probing the BMC.
+
+  @param[in] Event    The protocol notify event.
+  @param[in] Context  Not used.
+
+**/
+VOID
+EFIAPI
+SolStatusBmcReady (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  EFI_STATUS                Status;
+  IPMI_BMC_READY_PROTOCOL   *BmcReady;
+
+  Status = gBS->LocateProtocol (&gIpmiBmcReadyProtocolGuid, NULL, (VOID **)&BmcReady);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+  gBS->CloseEvent (Event);
+
+  if (!BmcReady->Responding) {
+    DEBUG ((DEBUG_ERROR, "[IPMI] BMC does not respond, skip the SOL status read\n"));
+    return;
+  }
+
+  ReportSolStatus ();
+}
+
+EFI_STATUS
+EFIAPI
+SolStatusEntryPoint (
+  IN EFI_HANDLE         ImageHandle,
+  IN EFI_SYSTEM_TABLE   *SystemTable
+  )
+/*++
+
+  Routine Description:
+    This is the standard EFI driver point. This function initializes
+    the private data required for creating SOL Status Driver.
+
+  Arguments:
+    ImageHandle     - Handle for the image of this driver
+    SystemTable     - Pointer to the EFI System Table
+
+  Returns:
+    EFI_SUCCESS     - Protocol successfully installed
+    EFI_UNSUPPORTED - Protocol can't be installed.
+
+--*/
+{
+  VOID        *Registration;
+
+  EfiCreateProtocolNotifyEvent (
+    &gIpmiBmcReadyProtocolGuid,
+    TPL_CALLBACK,
+    SolStatusBmcReady,
+    NULL,
+    &Registration
+    );
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,19 @@
+/** @file
+  GUID of the variable caching the SPCR table between boots.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _SPCR_CACHE_GUID_H_
+#define _SPCR_CACHE_GUID_H_
+
+#define SPCR_CACHE_VARIABLE_GUID \
+  { 0x378e41b7, 0x1ede, 0x4de6, { 0xb2, 0xb0, 0x7f, 0xc7, 0xb2, 0x0d, 0x87, 0xd8 } }
+
+#define SPCR_CACHE_VARIABLE_NAME  L"SpcrCache"
+
+extern EFI_GUID gSpcrCacheVariableGuid;
+
+#endif // _SPCR_CACHE_GUID_H_
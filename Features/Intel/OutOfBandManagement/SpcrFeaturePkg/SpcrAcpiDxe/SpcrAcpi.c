@@ -340,25 +340,126 @@ Done:
 }
 
 /**
-  Installs the Smbios Table to the System Table. This function gets called
-  when the EFI_EVENT_SIGNAL_READY_TO_BOOT gets signaled
+  Compute the key of the SPCR cache.
 
-  @param  Event                The event to signal
-  @param  Context              Event contex
+  The SPCR table only depends on the serial port, which is selected from the
+  console variables. The key is the CRC32 of ConOut, ConIn and the SPCR device
+  path.
+
+  @param DevicePath     The SPCR device path.
+
+  @return The key.
+
+**/
+UINT32
+GetSpcrCacheKey (
+  IN EFI_DEVICE_PATH_PROTOCOL *DevicePath
+  )
+{
+  CHAR16                   *VariableName[2];
+  UINT32                   Crc[3];
+  VOID                     *Data;
+  UINTN                    DataSize;
+  UINTN                    Index;
+  UINT32                   Key;
+
+  VariableName[0] = EFI_CON_OUT_VARIABLE_NAME;
+  VariableName[1] = EFI_CON_IN_VARIABLE_NAME;
+  ZeroMem (Crc, sizeof (Crc));
+  for (Index = 0; Index < ARRAY_SIZE (VariableName); Index++) {
+    GetEfiGlobalVariable2 (VariableName[Index], &Data, &DataSize);
+    if (Data != NULL) {
+      gBS->CalculateCrc32 (Data, DataSize, &Crc[Index]);
+      FreePool (Data);
+    }
+  }
+  gBS->CalculateCrc32 (DevicePath, GetDevicePathSize (DevicePath), &Crc[2]);
+
+  Key = 0;
+  gBS->CalculateCrc32 (Crc, sizeof (Crc), &Key);
+  return Key;
+}
+
+/**
+  Get the SPCR table from the cache.
+
+  @param Key            The key of the cache.
+
+  @retval TRUE          gSpcrInfo is filled from the cache.
+  @retval FALSE         The cache is missing or stale.
+
+**/
+BOOLEAN
+GetSpcrFromCache (
+  IN UINT32                   Key
+  )
+{
+  EFI_STATUS               Status;
+  SPCR_CACHE               Cache;
+  UINTN                    DataSize;
+
+  DataSize = sizeof (Cache);
+  Status = gRT->GetVariable (
+                  SPCR_CACHE_VARIABLE_NAME,
+                  &gSpcrCacheVariableGuid,
+                  NULL,
+                  &DataSize,
+                  &Cache
+                  );
+  if (EFI_ERROR (Status) || (DataSize != sizeof (Cache)) || (Cache.Key != Key) ||
+      (Cache.Spcr.Header.Signature != gSpcrInfo.Header.Signature) ||
+      (Cache.Spcr.Header.Length != gSpcrInfo.Header.Length) ||
+      (Cache.Spcr.Header.Revision != gSpcrInfo.Header.Revision)) {
+    return FALSE;
+  }
+
+  CopyMem (&gSpcrInfo, &Cache.Spcr, sizeof (gSpcrInfo));
+  return TRUE;
+}
+
+/**
+  Save the SPCR table to the cache.
+
+  @param Key            The key of the cache.
 
 **/
 VOID
-EFIAPI
-OutOfBandACPITableConstruction (
-  IN EFI_EVENT        Event,
-  IN VOID             *Context
+SaveSpcrToCache (
+  IN UINT32                   Key
+  )
+{
+  EFI_STATUS               Status;
+  SPCR_CACHE               Cache;
+
+  Cache.Key = Key;
+  CopyMem (&Cache.Spcr, &gSpcrInfo, sizeof (Cache.Spcr));
+  Status = gRT->SetVariable (
+                  SPCR_CACHE_VARIABLE_NAME,
+                  &gSpcrCacheVariableGuid,
+                  EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                  sizeof (Cache),
+                  &Cache
+                  );
+  DEBUG ((DEBUG_INFO, "SPCR cache saved - %r\n", Status));
+}
+
+/**
+  Fill gSpcrInfo from the serial port device.
+
+  @param SavedDevicePath   The SPCR device path, the terminal type node is
+                           removed from it.
+
+  @retval EFI_SUCCESS      gSpcrInfo is filled.
+  @retval Others           The serial port can't be found.
+
+**/
+EFI_STATUS
+BuildSpcrTable (
+  IN EFI_DEVICE_PATH_PROTOCOL *SavedDevicePath
   )
 {
-  EFI_DEVICE_PATH_PROTOCOL *SavedDevicePath;
   EFI_DEVICE_PATH_PROTOCOL *TmpDevicePath;
   EFI_DEVICE_PATH_PROTOCOL *Tmp2DevicePath;
-  EFI_ACPI_TABLE_PROTOCOL  *AcpiTablProtocol;
-  UINTN                    TurnKey;
   EFI_STATUS               Status;
   EFI_HANDLE               Handle;
   EFI_SERIAL_IO_PROTOCOL   *SerialIo;
@@ -368,11 +469,6 @@ OutOfBandACPITableConstruction (
 
   Handle          = NULL;
 
-  SavedDevicePath = GetSpcrDevice();
-  if (SavedDevicePath == NULL) {
-    return;
-
-  }
   //
   // Get TerminalType info from the last device path node.
   //
@@ -400,7 +496,7 @@ OutOfBandACPITableConstruction (
                   &Handle
                   );
   if (EFI_ERROR(Status)) {
-    goto out;
+    return Status;
   }
 
   Status = gBS->HandleProtocol (
@@ -409,7 +505,7 @@ OutOfBandACPITableConstruction (
                   (VOID **) &SerialIo
                   );
   if (EFI_ERROR(Status)) {
-    goto out;
+    return Status;
   }
 
   switch (SerialIo->Mode->BaudRate) {
@@ -439,6 +535,50 @@ OutOfBandACPITableConstruction (
   } else {
     GetPciTypeInfo (SavedDevicePath);
   }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Installs the Smbios Table to the System Table. This function gets called
+  when the EFI_EVENT_SIGNAL_READY_TO_BOOT gets signaled
+
+  @param  Event                The event to signal
+  @param  Context              Event contex
+
+**/
+VOID
+EFIAPI
+OutOfBandACPITableConstruction (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  EFI_DEVICE_PATH_PROTOCOL *SavedDevicePath;
+  EFI_ACPI_TABLE_PROTOCOL  *AcpiTablProtocol;
+  UINTN                    TurnKey;
+  EFI_STATUS               Status;
+  UINT32                   CacheKey;
+
+  SavedDevicePath = GetSpcrDevice();
+  if (SavedDevicePath == NULL) {
+    return;
+
+  }
+
+  //
+  // The serial port is the same as on the previous boot if the console
+  // variables didn't change, take the table built then.
+  //
+  CacheKey = GetSpcrCacheKey (SavedDevicePath);
+  if (!GetSpcrFromCache (CacheKey)) {
+    Status = BuildSpcrTable (SavedDevicePath);
+    if (EFI_ERROR (Status)) {
+      goto out;
+    }
+    SaveSpcrToCache (CacheKey);
+  }
+
   //
   // Not create before, create new Spcr ACPI table.
   //
@@ -13,7 +13,8 @@
 
 #include <IndustryStandard/Acpi30.h>
 #include <IndustryStandard/SerialPortConsoleRedirectionTable.h>
-//#include <Guid/GlobalVariable.h>
+#include <Guid/GlobalVariable.h>
+#include <Guid/SpcrCache.h>
 
 #include <Library/UefiLib.h>
 #include <Library/UefiBootServicesTableLib.h>
@@ -41,6 +42,16 @@ typedef struct {
 } HII_VENDOR_DEVICE_PATH;
 
 #pragma pack()
+
+///
+/// SPCR table built on a previous boot, keyed on the console variables and
+/// the SPCR device path it was built from.
+///
+typedef struct {
+  UINT32                                          Key;
+  EFI_ACPI_SERIAL_PORT_CONSOLE_REDIRECTION_TABLE  Spcr;
+} SPCR_CACHE;
+
 //
 // Prototypes
 //
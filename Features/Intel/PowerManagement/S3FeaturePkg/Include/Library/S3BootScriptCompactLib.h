@@ -0,0 +1,114 @@
+/** @file
+  Records PCI configuration and MMIO writes into the S3 boot script in a
+  compacted form.
+
+  The writes and polls are kept in a pending list and saved to the boot script
+  on S3BootScriptCompactFlush() or at EndOfDxe at the latest. While pending:
+    - consecutive writes to adjacent registers are coalesced into one boot
+      script entry,
+    - a write of the value a register already got is dropped,
+    - consecutive polls of the same register are merged into one.
+
+  The entries keep their order. A caller mixing this library with direct
+  S3BootScriptLib calls must flush before saving anything directly.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _S3_BOOT_SCRIPT_COMPACT_LIB_H_
+#define _S3_BOOT_SCRIPT_COMPACT_LIB_H_
+
+#include <Library/S3BootScriptLib.h>
+
+/**
+  Record memory write operations.
+
+  @param[in] Width      The width of the memory operations.
+  @param[in] Address    The base address of the memory operations.
+  @param[in] Count      The number of memory operations to perform.
+  @param[in] Buffer     The source buffer from which to write the data.
+
+  @retval RETURN_SUCCESS            The operation was recorded.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactMemWrite (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN UINT64                    Address,
+  IN UINTN                     Count,
+  IN VOID                      *Buffer
+  );
+
+/**
+  Record PCI configuration space write operations.
+
+  @param[in] Width      The width of the PCI operations.
+  @param[in] Segment    The PCI segment number.
+  @param[in] Address    The address within the PCI segment, in the
+                        S3_BOOT_SCRIPT_LIB_PCI_ADDRESS format.
+  @param[in] Count      The number of PCI operations to perform.
+  @param[in] Buffer     The source buffer from which to write the data.
+
+  @retval RETURN_SUCCESS            The operation was recorded.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactPciCfg2Write (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN UINT16                    Segment,
+  IN UINT64                    Address,
+  IN UINTN                     Count,
+  IN VOID                      *Buffer
+  );
+
+/**
+  Record a memory poll operation.
+
+  @param[in] Width      The width of the memory operation.
+  @param[in] Address    The address of the memory operation.
+  @param[in] BitMask    A pointer to the bit mask to be AND-ed with the data
+                        read from the register.
+  @param[in] BitValue   A pointer to the data value after the bit mask was
+                        applied.
+  @param[in] Duration   The delay in microseconds between two reads.
+  @param[in] LoopTimes  The maximum number of reads.
+
+  @retval RETURN_SUCCESS            The operation was recorded.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactMemPoll (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN UINT64                    Address,
+  IN VOID                      *BitMask,
+  IN VOID                      *BitValue,
+  IN UINTN                     Duration,
+  IN UINT64                    LoopTimes
+  );
+
+/**
+  Save the pending operations to the boot script.
+
+  @retval RETURN_SUCCESS            The operations were saved.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactFlush (
+  VOID
+  );
+
+#endif
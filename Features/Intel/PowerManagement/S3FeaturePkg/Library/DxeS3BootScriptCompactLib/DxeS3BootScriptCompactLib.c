@@ -0,0 +1,589 @@
+/** @file
+  Records PCI configuration and MMIO writes into the S3 boot script in a
+  compacted form.
+
+  Every boot script entry costs the resume path an opcode decode and, for the
+  PCI configuration writes, a slow configuration cycle. The operations are kept
+  as single register accesses in a pending list, and saved as few entries as
+  possible when the list is flushed.
+
+  Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Guid/EventGroup.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/S3BootScriptLib.h>
+#include <Library/S3BootScriptCompactLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+
+//
+// Number of pending writes searched back for an identical write.
+//
+#define S3_COMPACT_DEDUP_WINDOW     64
+#define S3_COMPACT_ENTRY_INCREMENT  256
+
+typedef enum {
+  S3CompactMemWrite,
+  S3CompactPciCfg2Write,
+  S3CompactMemPoll
+} S3_COMPACT_OPERATION;
+
+typedef struct {
+  UINT8                     Operation;
+  UINT8                     Width;
+  UINT16                    Segment;
+  UINT64                    Address;
+  UINT64                    Value;
+  UINT64                    BitMask;
+  UINT64                    LoopTimes;
+  UINTN                     Duration;
+} S3_COMPACT_ENTRY;
+
+S3_COMPACT_ENTRY            *mS3CompactEntry    = NULL;
+UINTN                       mS3CompactCount     = 0;
+UINTN                       mS3CompactMaxCount  = 0;
+UINTN                       mS3CompactDropped   = 0;
+EFI_EVENT                   mS3CompactEndOfDxeEvent = NULL;
+
+/**
+  Check if the width is a single register access of 1, 2, 4 or 8 bytes.
+
+  @param[in] Width      The width of the operation.
+
+  @retval TRUE          The width can be recorded in the pending list.
+
+**/
+BOOLEAN
+S3CompactIsRegisterWidth (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width
+  )
+{
+  return (BOOLEAN)(Width <= S3BootScriptWidthUint64);
+}
+
+/**
+  Read one element of a write buffer.
+
+  @param[in] Width      The width of the element.
+  @param[in] Buffer     The buffer.
+  @param[in] Index      The index of the element.
+
+  @return The element.
+
+**/
+UINT64
+S3CompactReadElement (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN VOID                      *Buffer,
+  IN UINTN                     Index
+  )
+{
+  switch (Width) {
+  case S3BootScriptWidthUint8:
+    return ((UINT8 *)Buffer)[Index];
+  case S3BootScriptWidthUint16:
+    return ReadUnaligned16 ((UINT16 *)Buffer + Index);
+  case S3BootScriptWidthUint32:
+    return ReadUnaligned32 ((UINT32 *)Buffer + Index);
+  default:
+    return ReadUnaligned64 ((UINT64 *)Buffer + Index);
+  }
+}
+
+/**
+  Check if an entry continues the run of writes ending with another one.
+
+  The PCI address keeps the register in its low 8 bits, a run can't cross
+  into the extended configuration space of the next 256 bytes.
+
+  @param[in] Previous   The last entry of the run.
+  @param[in] Entry      The entry to check.
+
+  @retval TRUE          The entry can be saved with the run.
+
+**/
+BOOLEAN
+S3CompactIsAdjacent (
+  IN S3_COMPACT_ENTRY  *Previous,
+  IN S3_COMPACT_ENTRY  *Entry
+  )
+{
+  UINT64  Next;
+
+  if ((Entry->Operation != Previous->Operation) ||
+      (Entry->Operation == S3CompactMemPoll) ||
+      (Entry->Width != Previous->Width) ||
+      (Entry->Segment != Previous->Segment)) {
+    return FALSE;
+  }
+
+  Next = Previous->Address + (UINT64)(1 << Previous->Width);
+  if (Entry->Address != Next) {
+    return FALSE;
+  }
+
+  if ((Entry->Operation == S3CompactPciCfg2Write) &&
+      ((Next & ~(UINT64)0xFF) != (Previous->Address & ~(UINT64)0xFF))) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/**
+  Append an entry to the pending list.
+
+  @param[in] Entry      The entry.
+
+  @retval RETURN_SUCCESS            The entry was appended.
+  @retval RETURN_OUT_OF_RESOURCES   The list couldn't be grown.
+
+**/
+RETURN_STATUS
+S3CompactAppend (
+  IN S3_COMPACT_ENTRY  *Entry
+  )
+{
+  S3_COMPACT_ENTRY  *NewEntry;
+
+  if (mS3CompactCount == mS3CompactMaxCount) {
+    NewEntry = ReallocatePool (
+                 mS3CompactMaxCount * sizeof (S3_COMPACT_ENTRY),
+                 (mS3CompactMaxCount + S3_COMPACT_ENTRY_INCREMENT) * sizeof (S3_COMPACT_ENTRY),
+                 mS3CompactEntry
+                 );
+    if (NewEntry == NULL) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+    mS3CompactEntry     = NewEntry;
+    mS3CompactMaxCount += S3_COMPACT_ENTRY_INCREMENT;
+  }
+
+  CopyMem (&mS3CompactEntry[mS3CompactCount++], Entry, sizeof (S3_COMPACT_ENTRY));
+  return RETURN_SUCCESS;
+}
+
+/**
+  Record a single register write.
+
+  The pending writes of the same kind are searched back for the last one
+  touching the register. The write is dropped if that one wrote the same
+  value to the same register. A poll or a write of another kind ends the
+  search, it may have changed what the register holds.
+
+  @param[in] Entry      The write.
+
+  @retval RETURN_SUCCESS            The write was recorded or dropped.
+  @retval RETURN_OUT_OF_RESOURCES   The list couldn't be grown.
+
+**/
+RETURN_STATUS
+S3CompactRecordWrite (
+  IN S3_COMPACT_ENTRY  *Entry
+  )
+{
+  UINTN             Index;
+  UINTN             Limit;
+  UINT64            Size;
+  S3_COMPACT_ENTRY  *Pending;
+
+  Size  = (UINT64)(1 << Entry->Width);
+  Limit = MIN (mS3CompactCount, S3_COMPACT_DEDUP_WINDOW);
+  for (Index = 0; Index < Limit; Index++) {
+    Pending = &mS3CompactEntry[mS3CompactCount - 1 - Index];
+    if ((Pending->Operation != Entry->Operation) ||
+        (Pending->Segment != Entry->Segment)) {
+      break;
+    }
+
+    if ((Pending->Address < Entry->Address + Size) &&
+        (Entry->Address < Pending->Address + (UINT64)(1 << Pending->Width))) {
+      if ((Pending->Address == Entry->Address) &&
+          (Pending->Width == Entry->Width) &&
+          (Pending->Value == Entry->Value)) {
+        mS3CompactDropped++;
+        return RETURN_SUCCESS;
+      }
+      break;
+    }
+  }
+
+  return S3CompactAppend (Entry);
+}
+
+/**
+  Record write operations, one entry per register.
+
+  @param[in] Operation  S3CompactMemWrite or S3CompactPciCfg2Write.
+  @param[in] Width      The width of the operations.
+  @param[in] Segment    The PCI segment number.
+  @param[in] Address    The base address of the operations.
+  @param[in] Count      The number of operations to perform.
+  @param[in] Buffer     The source buffer from which to write the data.
+
+  @retval RETURN_SUCCESS            The operations were recorded.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+S3CompactRecordWrites (
+  IN S3_COMPACT_OPERATION      Operation,
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN UINT16                    Segment,
+  IN UINT64                    Address,
+  IN UINTN                     Count,
+  IN VOID                      *Buffer
+  )
+{
+  RETURN_STATUS     Status;
+  S3_COMPACT_ENTRY  Entry;
+  UINTN             Index;
+
+  ZeroMem (&Entry, sizeof (Entry));
+  Entry.Operation = (UINT8)Operation;
+  Entry.Width     = (UINT8)Width;
+  Entry.Segment   = Segment;
+
+  for (Index = 0; Index < Count; Index++) {
+    Entry.Address = Address + MultU64x32 (Index, (UINT32)(1 << Width));
+    Entry.Value   = S3CompactReadElement (Width, Buffer, Index);
+    Status = S3CompactRecordWrite (&Entry);
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return RETURN_SUCCESS;
+}
+
+/**
+  Save the pending operations to the boot script.
+
+  @retval RETURN_SUCCESS            The operations were saved.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactFlush (
+  VOID
+  )
+{
+  RETURN_STATUS     Status;
+  UINTN             Index;
+  UINTN             Run;
+  UINTN             Saved;
+  UINTN             Element;
+  S3_COMPACT_ENTRY  *Entry;
+  UINT8             *Buffer;
+  UINTN             Size;
+
+  if (mS3CompactCount == 0) {
+    return RETURN_SUCCESS;
+  }
+
+  Buffer = AllocatePool (mS3CompactCount * sizeof (UINT64));
+  if (Buffer == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
+  }
+
+  Status = RETURN_SUCCESS;
+  Saved  = 0;
+  for (Index = 0; (Index < mS3CompactCount) && !RETURN_ERROR (Status); Index += Run, Saved++) {
+    Entry = &mS3CompactEntry[Index];
+    if (Entry->Operation == S3CompactMemPoll) {
+      Run    = 1;
+      Status = S3BootScriptSaveMemPoll (
+                 (S3_BOOT_SCRIPT_LIB_WIDTH)Entry->Width,
+                 Entry->Address,
+                 &Entry->BitMask,
+                 &Entry->Value,
+                 Entry->Duration,
+                 Entry->LoopTimes
+                 );
+      continue;
+    }
+
+    for (Run = 1; Index + Run < mS3CompactCount; Run++) {
+      if (!S3CompactIsAdjacent (&mS3CompactEntry[Index + Run - 1], &mS3CompactEntry[Index + Run])) {
+        break;
+      }
+    }
+
+    Size = (UINTN)1 << Entry->Width;
+    for (Element = 0; Element < Run; Element++) {
+      CopyMem (&Buffer[Element * Size], &mS3CompactEntry[Index + Element].Value, Size);
+    }
+
+    if (Entry->Operation == S3CompactMemWrite) {
+      Status = S3BootScriptSaveMemWrite (
+                 (S3_BOOT_SCRIPT_LIB_WIDTH)Entry->Width,
+                 Entry->Address,
+                 Run,
+                 Buffer
+                 );
+    } else {
+      Status = S3BootScriptSavePciCfg2Write (
+                 (S3_BOOT_SCRIPT_LIB_WIDTH)Entry->Width,
+                 Entry->Segment,
+                 Entry->Address,
+                 Run,
+                 Buffer
+                 );
+    }
+  }
+
+  DEBUG ((
+    DEBUG_INFO,
+    "S3BootScriptCompact: %d operations saved as %d entries, %d dropped - %r\n",
+    mS3CompactCount,
+    Saved,
+    mS3CompactDropped,
+    Status
+    ));
+
+  FreePool (Buffer);
+  mS3CompactCount   = 0;
+  mS3CompactDropped = 0;
+
+  return Status;
+}
+
+/**
+  Record memory write operations.
+
+  @param[in] Width      The width of the memory operations.
+  @param[in] Address    The base address of the memory operations.
+  @param[in] Count      The number of memory operations to perform.
+  @param[in] Buffer     The source buffer from which to write the data.
+
+  @retval RETURN_SUCCESS            The operation was recorded.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactMemWrite (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN UINT64                    Address,
+  IN UINTN                     Count,
+  IN VOID                      *Buffer
+  )
+{
+  RETURN_STATUS  Status;
+
+  if (FeaturePcdGet (PcdS3BootScriptCompactEnable) && S3CompactIsRegisterWidth (Width)) {
+    return S3CompactRecordWrites (S3CompactMemWrite, Width, 0, Address, Count, Buffer);
+  }
+
+  Status = S3BootScriptCompactFlush ();
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  return S3BootScriptSaveMemWrite (Width, Address, Count, Buffer);
+}
+
+/**
+  Record PCI configuration space write operations.
+
+  @param[in] Width      The width of the PCI operations.
+  @param[in] Segment    The PCI segment number.
+  @param[in] Address    The address within the PCI segment, in the
+                        S3_BOOT_SCRIPT_LIB_PCI_ADDRESS format.
+  @param[in] Count      The number of PCI operations to perform.
+  @param[in] Buffer     The source buffer from which to write the data.
+
+  @retval RETURN_SUCCESS            The operation was recorded.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactPciCfg2Write (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN UINT16                    Segment,
+  IN UINT64                    Address,
+  IN UINTN                     Count,
+  IN VOID                      *Buffer
+  )
+{
+  RETURN_STATUS  Status;
+
+  if (FeaturePcdGet (PcdS3BootScriptCompactEnable) && S3CompactIsRegisterWidth (Width)) {
+    return S3CompactRecordWrites (S3CompactPciCfg2Write, Width, Segment, Address, Count, Buffer);
+  }
+
+  Status = S3BootScriptCompactFlush ();
+  if (RETURN_ERROR (Status)) {
+    return Status;
+  }
+
+  return S3BootScriptSavePciCfg2Write (Width, Segment, Address, Count, Buffer);
+}
+
+/**
+  Record a memory poll operation.
+
+  A poll following a poll of the same register is merged into it when both
+  conditions can hold at once, the merged poll waits for both.
+
+  @param[in] Width      The width of the memory operation.
+  @param[in] Address    The address of the memory operation.
+  @param[in] BitMask    A pointer to the bit mask to be AND-ed with the data
+                        read from the register.
+  @param[in] BitValue   A pointer to the data value after the bit mask was
+                        applied.
+  @param[in] Duration   The delay in microseconds between two reads.
+  @param[in] LoopTimes  The maximum number of reads.
+
+  @retval RETURN_SUCCESS            The operation was recorded.
+  @retval RETURN_OUT_OF_RESOURCES   Not enough memory for the table to perform
+                                    the operation.
+
+**/
+RETURN_STATUS
+EFIAPI
+S3BootScriptCompactMemPoll (
+  IN S3_BOOT_SCRIPT_LIB_WIDTH  Width,
+  IN UINT64                    Address,
+  IN VOID                      *BitMask,
+  IN VOID                      *BitValue,
+  IN UINTN                     Duration,
+  IN UINT64                    LoopTimes
+  )
+{
+  RETURN_STATUS     Status;
+  S3_COMPACT_ENTRY  Entry;
+  S3_COMPACT_ENTRY  *Last;
+
+  if (!FeaturePcdGet (PcdS3BootScriptCompactEnable) || !S3CompactIsRegisterWidth (Width)) {
+    Status = S3BootScriptCompactFlush ();
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+    return S3BootScriptSaveMemPoll (Width, Address, BitMask, BitValue, Duration, LoopTimes);
+  }
+
+  ZeroMem (&Entry, sizeof (Entry));
+  Entry.Operation = S3CompactMemPoll;
+  Entry.Width     = (UINT8)Width;
+  Entry.Address   = Address;
+  Entry.BitMask   = S3CompactReadElement (Width, BitMask, 0);
+  Entry.Value     = S3CompactReadElement (Width, BitValue, 0) & Entry.BitMask;
+  Entry.Duration  = Duration;
+  Entry.LoopTimes = LoopTimes;
+
+  if (mS3CompactCount != 0) {
+    Last = &mS3CompactEntry[mS3CompactCount - 1];
+    if ((Last->Operation == S3CompactMemPoll) &&
+        (Last->Width == Entry.Width) &&
+        (Last->Address == Entry.Address) &&
+        ((Last->Value & Entry.BitMask) == (Entry.Value & Last->BitMask))) {
+      Last->BitMask  |= Entry.BitMask;
+      Last->Value    |= Entry.Value;
+      Last->Duration  = MAX (Last->Duration, Entry.Duration);
+      Last->LoopTimes = MAX (Last->LoopTimes, Entry.LoopTimes);
+      mS3CompactDropped++;
+      return RETURN_SUCCESS;
+    }
+  }
+
+  return S3CompactAppend (&Entry);
+}
+
+/**
+  Save the pending operations before the boot script is closed.
+
+  @param[in] Event      Event whose notification function is being invoked.
+  @param[in] Context    Pointer to the notification function's context.
+
+**/
+VOID
+EFIAPI
+S3CompactEndOfDxeNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  S3BootScriptCompactFlush ();
+}
+
+/**
+  The constructor function registers the EndOfDxe flush.
+
+  @param[in] ImageHandle  The firmware allocated handle for the EFI image.
+  @param[in] SystemTable  A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS     The constructor always returns EFI_SUCCESS.
+
+**/
+EFI_STATUS
+EFIAPI
+DxeS3BootScriptCompactLibConstructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+
+  if (!FeaturePcdGet (PcdS3BootScriptCompactEnable)) {
+    return EFI_SUCCESS;
+  }
+
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  S3CompactEndOfDxeNotify,
+                  NULL,
+                  &gEfiEndOfDxeEventGroupGuid,
+                  &mS3CompactEndOfDxeEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  The destructor function saves what is still pending and closes the
+  EndOfDxe event.
+
+  @param[in] ImageHandle  The firmware allocated handle for the EFI image.
+  @param[in] SystemTable  A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS     The destructor always returns EFI_SUCCESS.
+
+**/
+EFI_STATUS
+EFIAPI
+DxeS3BootScriptCompactLibDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  S3BootScriptCompactFlush ();
+
+  if (mS3CompactEndOfDxeEvent != NULL) {
+    gBS->CloseEvent (mS3CompactEndOfDxeEvent);
+    mS3CompactEndOfDxeEvent = NULL;
+  }
+
+  if (mS3CompactEntry != NULL) {
+    FreePool (mS3CompactEntry);
+    mS3CompactEntry    = NULL;
+    mS3CompactMaxCount = 0;
+  }
+
+  return EFI_SUCCESS;
+}
@@ -6,8 +6,106 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
+#include <PiPei.h>
+#include <Ppi/ReportStatusCodeHandler.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
 #include <Library/PeiServicesLib.h>
 #include <Library/SmmAccessLib.h>
+#include <Library/TimerLib.h>
+
+UINT64  mS3BootScriptStartNs = 0;
+
+/**
+  Check the S3 resume time against the budget.
+
+  The time is taken the way the FPDT S3 resume record takes it, from reset to
+  the OS waking vector progress code.
+
+  @param  PeiServices      An indirect pointer to the EFI_PEI_SERVICES table published by the PEI Foundation.
+  @param  CodeType         Indicates the type of status code being reported.
+  @param  Value            Describes the current status of a hardware or software entity.
+  @param  Instance         The enumeration of a hardware or software entity within the system.
+  @param  CallerId         This optional parameter may be used to identify the caller.
+  @param  Data             This optional parameter may be used to pass additional data.
+
+  @retval EFI_SUCCESS      The status code was handled.
+
+**/
+EFI_STATUS
+EFIAPI
+S3ResumeTimeStatusCodeListener (
+  IN CONST  EFI_PEI_SERVICES        **PeiServices,
+  IN EFI_STATUS_CODE_TYPE           CodeType,
+  IN EFI_STATUS_CODE_VALUE          Value,
+  IN UINT32                         Instance,
+  IN CONST EFI_GUID                 *CallerId,
+  IN CONST EFI_STATUS_CODE_DATA     *Data OPTIONAL
+  )
+{
+  UINT64  ResumeNs;
+
+  if ((CodeType & EFI_STATUS_CODE_TYPE_MASK) != EFI_PROGRESS_CODE) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Value == (EFI_SOFTWARE_PEI_MODULE | EFI_SW_PEI_PC_S3_BOOT_SCRIPT)) {
+    mS3BootScriptStartNs = GetTimeInNanoSecond (GetPerformanceCounter ());
+    return EFI_SUCCESS;
+  }
+
+  if (Value != (EFI_SOFTWARE_PEI_MODULE | EFI_SW_PEI_PC_OS_WAKE)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  ResumeNs = GetTimeInNanoSecond (GetPerformanceCounter ());
+  DEBUG ((
+    DEBUG_INFO,
+    "S3 resume: %Ld ms, boot script started at %Ld ms\n",
+    DivU64x32 (ResumeNs, 1000000),
+    DivU64x32 (mS3BootScriptStartNs, 1000000)
+    ));
+  if (ResumeNs > MultU64x32 (PcdGet32 (PcdS3ResumeTimeBudget), 1000000)) {
+    DEBUG ((
+      DEBUG_WARN,
+      "S3 resume: %Ld ms exceeds the %d ms budget\n",
+      DivU64x32 (ResumeNs, 1000000),
+      PcdGet32 (PcdS3ResumeTimeBudget)
+      ));
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Register the resume time listener once the status code router is there.
+
+  @param  PeiServices      An indirect pointer to the EFI_PEI_SERVICES table published by the PEI Foundation.
+  @param  NotifyDescriptor Address of the notification descriptor data structure.
+  @param  Ppi              Address of the PPI that was installed.
+
+  @retval EFI_SUCCESS      The listener was registered.
+
+**/
+EFI_STATUS
+EFIAPI
+S3RscHandlerPpiNotify (
+  IN EFI_PEI_SERVICES          **PeiServices,
+  IN EFI_PEI_NOTIFY_DESCRIPTOR *NotifyDescriptor,
+  IN VOID                      *Ppi
+  )
+{
+  EFI_PEI_RSC_HANDLER_PPI  *RscHandlerPpi;
+
+  RscHandlerPpi = (EFI_PEI_RSC_HANDLER_PPI *)Ppi;
+  return RscHandlerPpi->Register (S3ResumeTimeStatusCodeListener);
+}
+
+EFI_PEI_NOTIFY_DESCRIPTOR mS3RscHandlerPpiNotifyList = {
+  (EFI_PEI_PPI_DESCRIPTOR_NOTIFY_CALLBACK | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST),
+  &gEfiPeiRscHandlerPpiGuid,
+  S3RscHandlerPpiNotify
+};
 
 /**
   S3 PEI module entry point
@@ -25,12 +123,25 @@ S3PeiEntryPoint (
   IN CONST EFI_PEI_SERVICES     **PeiServices
   )
 {
-  EFI_STATUS Status;
+  EFI_STATUS    Status;
+  EFI_BOOT_MODE BootMode;
 
   //
   // Install EFI_PEI_MM_ACCESS_PPI for S3 resume case
   //
   Status = PeiInstallSmmAccessPpi ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  //
+  // Watch the resume time on S3 resume
+  //
+  if ((PcdGet32 (PcdS3ResumeTimeBudget) != 0) &&
+      !EFI_ERROR (PeiServicesGetBootMode (&BootMode)) &&
+      (BootMode == BOOT_ON_S3_RESUME)) {
+    PeiServicesNotifyPpi (&mS3RscHandlerPpiNotifyList);
+  }
 
   return Status;
 }
@@ -21,6 +21,34 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/PcdLib.h>
 #include <Library/UefiLib.h>
 
+#define SMBIOS_BASIC_MAX_STRINGS  6
+
+/**
+  Patch a record once it has been laid out.
+
+  @param  Record                The record, its formatted area and strings.
+
+**/
+typedef
+VOID
+(EFIAPI *SMBIOS_BASIC_RECORD_FIXUP) (
+  IN OUT EFI_SMBIOS_TABLE_HEADER  *Record
+  );
+
+///
+/// Describes one record of the driver, the entry point lays out all the
+/// records in one buffer and adds them in a single pass.
+///
+typedef struct {
+  SMBIOS_TYPE                 Type;
+  VOID                        *Template;      ///< The PCD with the formatted area.
+  UINTN                       TemplateSize;
+  UINTN                       Length;         ///< Length of the formatted area.
+  UINTN                       StringCount;
+  CHAR8                       *String[SMBIOS_BASIC_MAX_STRINGS];
+  SMBIOS_BASIC_RECORD_FIXUP   Fixup;          ///< Optional.
+} SMBIOS_BASIC_RECORD;
+
 /**
   Add an SMBIOS record.
 
@@ -8,40 +8,40 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "SmbiosBasic.h"
 
-EFI_STATUS
+VOID
 EFIAPI
 BiosVendorFunction(
-  IN  EFI_SMBIOS_PROTOCOL   *Smbios
+  OUT SMBIOS_BASIC_RECORD   *Record
   );
 
-EFI_STATUS
+VOID
 EFIAPI
 SystemManufacturerFunction(
-  IN  EFI_SMBIOS_PROTOCOL   *Smbios
+  OUT SMBIOS_BASIC_RECORD   *Record
   );
 
-EFI_STATUS
+VOID
 EFIAPI
 BaseBoardManufacturerFunction(
-  IN  EFI_SMBIOS_PROTOCOL   *Smbios
+  OUT SMBIOS_BASIC_RECORD   *Record
   );
 
-EFI_STATUS
+VOID
 EFIAPI
 ChassisManufacturerFunction(
-  IN  EFI_SMBIOS_PROTOCOL   *Smbios
+  OUT SMBIOS_BASIC_RECORD   *Record
   );
 
-EFI_STATUS
+VOID
 EFIAPI
 BootInfoStatusFunction(
-  IN  EFI_SMBIOS_PROTOCOL   *Smbios
+  OUT SMBIOS_BASIC_RECORD   *Record
   );
 
 typedef
-EFI_STATUS
+VOID
 (EFIAPI EFI_BASIC_SMBIOS_DATA_FUNCTION) (
-  IN  EFI_SMBIOS_PROTOCOL  *Smbios
+  OUT SMBIOS_BASIC_RECORD  *Record
   );
 
 typedef struct {
@@ -56,9 +56,60 @@ EFI_BASIC_SMBIOS_DATA mSmbiosBasicDataFuncTable[] = {
   {&BootInfoStatusFunction},
 };
 
+#define SMBIOS_BASIC_RECORD_COUNT  (sizeof(mSmbiosBasicDataFuncTable)/sizeof(mSmbiosBasicDataFuncTable[0]))
+
 /**
-  Standard EFI driver point.  This driver parses the mSmbiosMiscDataTable
-  structure and reports any generated data using SMBIOS protocol.
+  Lay out a record, its formatted area followed by its strings.
+
+  @param  Record        The description of the record.
+  @param  Buffer        The buffer for the record, NULL to get its size.
+
+  @return The size of the record.
+
+**/
+UINTN
+LayoutSmbiosRecord (
+  IN  SMBIOS_BASIC_RECORD   *Record,
+  OUT UINT8                 *Buffer   OPTIONAL
+  )
+{
+  EFI_SMBIOS_TABLE_HEADER   *Header;
+  UINTN                     Index;
+  UINTN                     StrLen;
+  UINTN                     Offset;
+
+  Offset = Record->Length;
+  if (Buffer != NULL) {
+    CopyMem (Buffer, Record->Template, MIN (Record->TemplateSize, Record->Length));
+    Header         = (EFI_SMBIOS_TABLE_HEADER *)Buffer;
+    Header->Type   = Record->Type;
+    Header->Length = (UINT8)Record->Length;
+    Header->Handle = 0;
+  }
+
+  for (Index = 0; Index < Record->StringCount; Index++) {
+    StrLen = AsciiStrLen (Record->String[Index]);
+    ASSERT (StrLen <= SMBIOS_STRING_MAX_LENGTH);
+    if (Buffer != NULL) {
+      CopyMem (Buffer + Offset, Record->String[Index], StrLen);
+    }
+    Offset += StrLen + 1;
+  }
+
+  if ((Buffer != NULL) && (Record->Fixup != NULL)) {
+    Record->Fixup ((EFI_SMBIOS_TABLE_HEADER *)Buffer);
+  }
+
+  //
+  // Two zeros following the last string.
+  //
+  return Offset + ((Record->StringCount == 0) ? 2 : 1);
+}
+
+/**
+  Standard EFI driver point.  This driver describes the records of
+  mSmbiosBasicDataFuncTable, lays them out in one buffer and reports them
+  using SMBIOS protocol.
 
   @param  ImageHandle     Handle for the image of this driver
   @param  SystemTable     Pointer to the EFI System Table
@@ -76,6 +127,12 @@ SmbiosBasicEntryPoint(
   UINTN                Index;
   EFI_STATUS           EfiStatus;
   EFI_SMBIOS_PROTOCOL  *Smbios;
+  EFI_SMBIOS_HANDLE    SmbiosHandle;
+  SMBIOS_BASIC_RECORD  Records[SMBIOS_BASIC_RECORD_COUNT];
+  UINTN                Size[SMBIOS_BASIC_RECORD_COUNT];
+  UINTN                TotalSize;
+  UINT8                *Buffer;
+  UINT8                *Record;
 
   EfiStatus = gBS->LocateProtocol(&gEfiSmbiosProtocolGuid, NULL, (VOID**)&Smbios);
   if (EFI_ERROR(EfiStatus)) {
@@ -83,14 +140,36 @@ SmbiosBasicEntryPoint(
     return EfiStatus;
   }
 
-  for (Index = 0; Index < sizeof(mSmbiosBasicDataFuncTable)/sizeof(mSmbiosBasicDataFuncTable[0]); ++Index) {
-    EfiStatus = (*mSmbiosBasicDataFuncTable[Index].Function) (Smbios);
+  //
+  // Resolve all the templates and strings first, then lay out the records
+  // in a single allocation.
+  //
+  ZeroMem (Records, sizeof(Records));
+  TotalSize = 0;
+  for (Index = 0; Index < SMBIOS_BASIC_RECORD_COUNT; ++Index) {
+    (*mSmbiosBasicDataFuncTable[Index].Function) (&Records[Index]);
+    Size[Index] = LayoutSmbiosRecord (&Records[Index], NULL);
+    TotalSize  += Size[Index];
+  }
+
+  Buffer = AllocateZeroPool (TotalSize);
+  if (Buffer == NULL) {
+    ASSERT_EFI_ERROR (EFI_OUT_OF_RESOURCES);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Record = Buffer;
+  for (Index = 0; Index < SMBIOS_BASIC_RECORD_COUNT; ++Index) {
+    LayoutSmbiosRecord (&Records[Index], Record);
+    EfiStatus = AddSmbiosRecord (Smbios, &SmbiosHandle, (EFI_SMBIOS_TABLE_HEADER *)Record);
     if (EFI_ERROR(EfiStatus)) {
       DEBUG((DEBUG_ERROR, "Basic smbios store error.  Index=%d, ReturnStatus=%r\n", Index, EfiStatus));
-      return EfiStatus;
+      break;
     }
+    Record += Size[Index];
   }
 
+  FreePool (Buffer);
   return EfiStatus;
 }
 
@@ -10,47 +10,20 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 
 /**
-  This function makes boot time changes to the contents of the
-  BootInformation (Type 32).
+  This function describes the BootInformation (Type 32) record.
 
-  @retval EFI_SUCCESS                All parameters were valid.
-  @retval EFI_UNSUPPORTED            Unexpected RecordType value.
-  @retval EFI_INVALID_PARAMETER      Invalid parameter was found.
+  @param  Record                 The description of the record.
 
 **/
-EFI_STATUS
+VOID
 EFIAPI
 BootInfoStatusFunction(
-  IN  EFI_SMBIOS_PROTOCOL   *Smbios
+  OUT SMBIOS_BASIC_RECORD   *Record
   )
 {
-  EFI_STATUS                         Status;
-  EFI_SMBIOS_HANDLE                  SmbiosHandle;
-  SMBIOS_TABLE_TYPE32                *PcdSmbiosRecord;
-  SMBIOS_TABLE_TYPE32                *SmbiosRecord;
-
-  PcdSmbiosRecord = PcdGetPtr (PcdSmbiosType32SystemBootInformation);
-
-  //
-  // Two zeros following the last string.
-  //
-  SmbiosRecord = AllocateZeroPool(sizeof (SMBIOS_TABLE_TYPE32) + 1 + 1);
-  if (SmbiosRecord == NULL) {
-    ASSERT_EFI_ERROR (EFI_OUT_OF_RESOURCES);
-    return EFI_OUT_OF_RESOURCES;
-  }
-
-  CopyMem (SmbiosRecord, PcdSmbiosRecord, sizeof(SMBIOS_TABLE_TYPE32));
-
-  SmbiosRecord->Hdr.Type = EFI_SMBIOS_TYPE_SYSTEM_BOOT_INFORMATION;
-  SmbiosRecord->Hdr.Length = sizeof (SMBIOS_TABLE_TYPE32);
-  SmbiosRecord->Hdr.Handle = 0;
-
-  //
-  // Now we have got the full smbios record, call smbios protocol to add this record.
-  //
-  Status = AddSmbiosRecord (Smbios, &SmbiosHandle, (EFI_SMBIOS_TABLE_HEADER *) SmbiosRecord);
-
-  FreePool(SmbiosRecord);
-  return Status;
+  Record->Type         = EFI_SMBIOS_TYPE_SYSTEM_BOOT_INFORMATION;
+  Record->Template     = PcdGetPtr (PcdSmbiosType32SystemBootInformation);
+  Record->TemplateSize = sizeof (SMBIOS_TABLE_TYPE32);
+  Record->Length       = sizeof (SMBIOS_TABLE_TYPE32);
+  Record->StringCount  = 0;
 }
@@ -14,8 +14,20 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/DebugLib.h>
 
+//
+// IMG_LOGO_DECODED is the logo converted to pixels at build time, the IDF
+// compiler stores a BMP as a 24-bit HII image which needs no decoder. The
+// image decoder only runs for IMG_LOGO when the decoded image is absent.
+//
+#ifdef IMG_LOGO_DECODED
+#define LOGO_DECODED_IMAGE_ID  IMAGE_TOKEN (IMG_LOGO_DECODED)
+#else
+#define LOGO_DECODED_IMAGE_ID  0
+#endif
+
 typedef struct {
   EFI_IMAGE_ID                          ImageId;
+  EFI_IMAGE_ID                          DecodedImageId;
   EDKII_PLATFORM_LOGO_DISPLAY_ATTRIBUTE Attribute;
   INTN                                  OffsetX;
   INTN                                  OffsetY;
@@ -26,6 +38,7 @@ EFI_HII_HANDLE            mHiiHandle;
 LOGO_ENTRY                mLogos[] = {
   {
     IMAGE_TOKEN (IMG_LOGO),
+    LOGO_DECODED_IMAGE_ID,
     EdkiiPlatformLogoDisplayAttributeCenter,
     0,
     0
@@ -56,7 +69,9 @@ GetImage (
      OUT INTN                                  *OffsetY
   )
 {
-  UINT32 Current;
+  EFI_STATUS Status;
+  UINT32     Current;
+
   if (Instance == NULL || Image == NULL ||
       Attribute == NULL || OffsetX == NULL || OffsetY == NULL) {
     return EFI_INVALID_PARAMETER;
@@ -71,6 +86,13 @@ GetImage (
   *Attribute = mLogos[Current].Attribute;
   *OffsetX   = mLogos[Current].OffsetX;
   *OffsetY   = mLogos[Current].OffsetY;
+
+  if (mLogos[Current].DecodedImageId != 0) {
+    Status = mHiiImageEx->GetImageEx (mHiiImageEx, mHiiHandle, mLogos[Current].DecodedImageId, Image);
+    if (!EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
   return mHiiImageEx->GetImageEx (mHiiImageEx, mHiiHandle, mLogos[Current].ImageId, Image);
 }
 
@@ -7,9 +7,12 @@
 **/
 
 #include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/BaseCryptLib.h>
+#include <Library/TimerLib.h>
 #include "KeyService.h"
 
 /**
@@ -111,6 +114,8 @@ KeyLibGeneratePBKDF2Hash (
   )
 {
   BOOLEAN  Result;
+  UINT64   StartTime;
+  UINT64   ElapsedNs;
 
   if (HashType != HASH_TYPE_SHA256) {
     return FALSE;
@@ -119,6 +124,7 @@ KeyLibGeneratePBKDF2Hash (
     return FALSE;
   }
 
+  StartTime = GetPerformanceCounter ();
   Result = Pkcs5HashPassword (
              KeySize,
              Key,
@@ -129,5 +135,67 @@ KeyLibGeneratePBKDF2Hash (
              KeyHashSize,
              KeyHash
              );
+
+  //
+  // Report the derivation time to tune the iteration count against.
+  //
+  ElapsedNs = GetTimeInNanoSecond (GetPerformanceCounter () - StartTime);
+  DEBUG ((
+    DEBUG_INFO,
+    "KeyLibGeneratePBKDF2Hash: %d iterations in %Ld us\n",
+    DEFAULT_PBKDF2_ITERATION_COUNT,
+    DivU64x32 (ElapsedNs, 1000)
+    ));
+
+  return Result;
+}
+
+/**
+  Hash the password with a secret key, for comparing it again with one
+  which was already verified.
+
+  The digest is fast to compute, it must never leave SMRAM.
+
+  @param[in]   SessionKey       Points to the secret key buffer
+  @param[in]   SessionKeySize   Size of the secret key buffer
+  @param[in]   Key              Points to the key buffer
+  @param[in]   KeySize          Key buffer size
+  @param[in]   SaltValue        Points to the salt buffer
+  @param[in]   SaltSize         Size of the salt buffer
+  @param[out]  Digest           Points to the SHA256_DIGEST_SIZE result
+
+  @retval      TRUE           Hash the data successfully.
+  @retval      FALSE          Failed to hash the data.
+
+**/
+BOOLEAN
+EFIAPI
+KeyLibGenerateSessionDigest (
+  IN   UINT8               *SessionKey,
+  IN   UINTN               SessionKeySize,
+  IN   VOID                *Key,
+  IN   UINTN               KeySize,
+  IN   UINT8               *SaltValue,
+  IN   UINTN               SaltSize,
+  OUT  UINT8               *Digest
+  )
+{
+  VOID     *HashContext;
+  BOOLEAN  Result;
+
+  HashContext = AllocatePool (Sha256GetContextSize ());
+  if (HashContext == NULL) {
+    return FALSE;
+  }
+
+  Result = Sha256Init (HashContext) &&
+           Sha256Update (HashContext, SessionKey, SessionKeySize) &&
+           Sha256Update (HashContext, SaltValue, SaltSize) &&
+           Sha256Update (HashContext, Key, KeySize) &&
+           Sha256Update (HashContext, SessionKey, SessionKeySize) &&
+           Sha256Final (HashContext, Digest);
+
+  ZeroMem (HashContext, Sha256GetContextSize ());
+  FreePool (HashContext);
   return Result;
 }
@@ -84,5 +84,35 @@ KeyLibGeneratePBKDF2Hash (
   IN   UINTN               KeyHashSize
   );
 
+/**
+  Hash the password with a secret key, for comparing it again with one
+  which was already verified.
+
+  The digest is fast to compute, it must never leave SMRAM.
+
+  @param[in]   SessionKey       Points to the secret key buffer
+  @param[in]   SessionKeySize   Size of the secret key buffer
+  @param[in]   Key              Points to the key buffer
+  @param[in]   KeySize          Key buffer size
+  @param[in]   SaltValue        Points to the salt buffer
+  @param[in]   SaltSize         Size of the salt buffer
+  @param[out]  Digest           Points to the SHA256_DIGEST_SIZE result
+
+  @retval      TRUE           Hash the data successfully.
+  @retval      FALSE          Failed to hash the data.
+
+**/
+BOOLEAN
+EFIAPI
+KeyLibGenerateSessionDigest (
+  IN   UINT8               *SessionKey,
+  IN   UINTN               SessionKeySize,
+  IN   VOID                *Key,
+  IN   UINTN               KeySize,
+  IN   UINT8               *SaltValue,
+  IN   UINTN               SaltSize,
+  OUT  UINT8               *Digest
+  );
+
 #endif
 
@@ -14,6 +14,114 @@ UINTN                           mAdminPasswordTryCount = 0;
 BOOLEAN                         mNeedReVerify = TRUE;
 BOOLEAN                         mPasswordVerified = FALSE;
 
+USER_PASSWORD_SESSION           mPasswordSession;
+
+/**
+  End the password session.
+**/
+VOID
+EndPasswordSession (
+  VOID
+  )
+{
+  ZeroMem (&mPasswordSession, sizeof (mPasswordSession));
+}
+
+/**
+  Start a password session after the password was verified against the
+  stored hash.
+
+  @param[in]  Password               The verified password.
+  @param[in]  PasswordSize           The size of Password in byte.
+  @param[in]  UserPasswordVarStruct  The storage of password in variable.
+**/
+VOID
+StartPasswordSession (
+  IN CHAR8                          *Password,
+  IN UINTN                          PasswordSize,
+  IN USER_PASSWORD_VAR_STRUCT       *UserPasswordVarStruct
+  )
+{
+  EndPasswordSession ();
+  if (PcdGet32 (PcdPasswordSessionTimeout) == 0) {
+    return;
+  }
+
+  //
+  // A new key each session, the digest can't be reused once it ended.
+  //
+  if (!KeyLibGenerateSalt (mPasswordSession.Key, sizeof (mPasswordSession.Key)) ||
+      !KeyLibGenerateSessionDigest (
+         mPasswordSession.Key,
+         sizeof (mPasswordSession.Key),
+         Password,
+         PasswordSize,
+         UserPasswordVarStruct->PasswordSalt,
+         sizeof (UserPasswordVarStruct->PasswordSalt),
+         mPasswordSession.Digest
+         )) {
+    EndPasswordSession ();
+    return;
+  }
+
+  CopyMem (mPasswordSession.PasswordHash, UserPasswordVarStruct->PasswordHash, PASSWORD_HASH_SIZE);
+  mPasswordSession.StartTime = GetPerformanceCounter ();
+  mPasswordSession.Valid     = TRUE;
+}
+
+/**
+  Check the password against the password session.
+
+  @param[in]  Password               The user input password.
+  @param[in]  PasswordSize           The size of Password in byte.
+  @param[in]  UserPasswordVarStruct  The storage of password in variable.
+
+  @retval TRUE    The password was verified in this session.
+  @retval FALSE   The password must be verified against the stored hash.
+**/
+BOOLEAN
+IsPasswordInSession (
+  IN CHAR8                          *Password,
+  IN UINTN                          PasswordSize,
+  IN USER_PASSWORD_VAR_STRUCT       *UserPasswordVarStruct
+  )
+{
+  UINT8    Digest[SHA256_DIGEST_SIZE];
+  BOOLEAN  Match;
+
+  if (!mPasswordSession.Valid) {
+    return FALSE;
+  }
+
+  if (GetTimeInNanoSecond (GetPerformanceCounter () - mPasswordSession.StartTime) >
+      MultU64x32 (PcdGet32 (PcdPasswordSessionTimeout), 1000000000)) {
+    DEBUG ((DEBUG_INFO, "Password session expired\n"));
+    EndPasswordSession ();
+    return FALSE;
+  }
+
+  if (KeyLibSlowCompareMem (mPasswordSession.PasswordHash, UserPasswordVarStruct->PasswordHash, PASSWORD_HASH_SIZE) != 0) {
+    EndPasswordSession ();
+    return FALSE;
+  }
+
+  if (!KeyLibGenerateSessionDigest (
+         mPasswordSession.Key,
+         sizeof (mPasswordSession.Key),
+         Password,
+         PasswordSize,
+         UserPasswordVarStruct->PasswordSalt,
+         sizeof (UserPasswordVarStruct->PasswordSalt),
+         Digest
+         )) {
+    return FALSE;
+  }
+
+  Match = (BOOLEAN)(KeyLibSlowCompareMem (mPasswordSession.Digest, Digest, sizeof (Digest)) == 0);
+  ZeroMem (Digest, sizeof (Digest));
+  return Match;
+}
+
 /**
   Verify if the password is correct.
 
@@ -285,14 +393,20 @@ IsPasswordVerified (
   //
   // Old password exists
   //
+  if (IsPasswordInSession (Password, PasswordSize, &UserPasswordVarStruct)) {
+    return TRUE;
+  }
+
   Status = VerifyPassword (Password, PasswordSize, &UserPasswordVarStruct);
   if (EFI_ERROR(Status)) {
     if (Password[0] != 0) {
       *PasswordTryCount = *PasswordTryCount + 1;
     }
+    EndPasswordSession ();
     return FALSE;
   }
 
+  StartPasswordSession (Password, PasswordSize, &UserPasswordVarStruct);
   return TRUE;
 }
 
@@ -524,6 +638,7 @@ SmmPasswordHandler (
       goto EXIT;
     }
 
+    EndPasswordSession ();
     if (PasswordLen == 0) {
       Status = SavePasswordToVariable (UserGuid, NULL, 0);
     } else {
@@ -612,6 +727,27 @@ EXIT:
   return EFI_SUCCESS;
 }
 
+/**
+  End the password session before any boot option runs.
+
+  @param[in] Protocol   Points to the protocol's unique identifier.
+  @param[in] Interface  Points to the interface instance.
+  @param[in] Handle     The handle on which the interface was installed.
+
+  @retval EFI_SUCCESS   Notification runs successfully.
+**/
+EFI_STATUS
+EFIAPI
+PasswordSmmReadyToBootNotify (
+  IN CONST EFI_GUID  *Protocol,
+  IN VOID            *Interface,
+  IN EFI_HANDLE      Handle
+  )
+{
+  EndPasswordSession ();
+  return EFI_SUCCESS;
+}
+
 /**
   Main entry for this driver.
 
@@ -633,6 +769,7 @@ PasswordSmmInit (
   EDKII_VARIABLE_LOCK_PROTOCOL          *VariableLock;
   CHAR16                                PasswordHistoryName[sizeof(USER_AUTHENTICATION_VAR_NAME)/sizeof(CHAR16) + 5];
   UINTN                                 Index;
+  VOID                                  *Registration;
 
   ASSERT (PASSWORD_HASH_SIZE == SHA256_DIGEST_SIZE);
   ASSERT (PASSWORD_HISTORY_CHECK_COUNT < 0xFFFF);
@@ -664,6 +801,13 @@ PasswordSmmInit (
     return Status;
   }
 
+  Status = gSmst->SmmRegisterProtocolNotify (
+                    &gEdkiiSmmReadyToBootProtocolGuid,
+                    PasswordSmmReadyToBootNotify,
+                    &Registration
+                    );
+  ASSERT_EFI_ERROR (Status);
+
   if (IsPasswordCleared()) {
     DEBUG ((DEBUG_INFO, "IsPasswordCleared\n"));
     SavePasswordToVariable (&gUserAuthenticationGuid, NULL, 0);
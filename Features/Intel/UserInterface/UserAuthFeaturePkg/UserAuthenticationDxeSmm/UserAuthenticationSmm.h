@@ -26,6 +26,8 @@
 #include <Library/SmmServicesTableLib.h>
 #include <Library/BaseCryptLib.h>
 #include <Library/PlatformPasswordLib.h>
+#include <Library/PcdLib.h>
+#include <Library/TimerLib.h>
 
 #include "KeyService.h"
 
@@ -35,6 +37,8 @@
 #define PASSWORD_MAX_TRY_COUNT  3
 #define PASSWORD_HISTORY_CHECK_COUNT  5
 
+#define PASSWORD_SESSION_KEY_SIZE  32
+
 //
 // Name of the variable
 //
@@ -49,4 +53,16 @@ typedef struct {
   UINT8        PasswordSalt[PASSWORD_SALT_SIZE];
 } USER_PASSWORD_VAR_STRUCT;
 
+//
+// The password verified last, kept in SMRAM only. A password matching the
+// digest is accepted without the PBKDF2 derivation until the session expires.
+//
+typedef struct {
+  BOOLEAN      Valid;
+  UINT8        Key[PASSWORD_SESSION_KEY_SIZE];
+  UINT8        PasswordHash[PASSWORD_HASH_SIZE];
+  UINT8        Digest[SHA256_DIGEST_SIZE];
+  UINT64       StartTime;
+} USER_PASSWORD_SESSION;
+
 #endif
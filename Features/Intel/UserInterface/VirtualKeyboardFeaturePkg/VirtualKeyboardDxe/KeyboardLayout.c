@@ -180,6 +180,7 @@ VK_STRUCT mSimpleKeyboardBody[] = {
   Modify the color of key if Shift or CapsLock is pressed.
 
   @param[in]       VkContext   Address of an VK_CONTEXT structure.
+  @param[in]       IsPressed   TRUE to color the keys as pressed.
   @param[in, out]  BltBuffer   Address of a blt buffer.
 
   @retval EFI_SUCCESS          Success for the function.
@@ -188,18 +189,15 @@ VK_STRUCT mSimpleKeyboardBody[] = {
 EFI_STATUS
 ModifyShiftKeyColor (
   IN     VK_CONTEXT                    *VkContext,
+  IN     BOOLEAN                       IsPressed,
   IN OUT EFI_GRAPHICS_OUTPUT_BLT_PIXEL **BltBuffer
   )
 {
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL *TempBltBuffer;
   UINTN                         BltSize;
-  BOOLEAN                       IsPressed;
 
   TempBltBuffer = *BltBuffer;
   BltSize       = VkContext->VkBodyBltHeight * VkContext->VkBodyBltWidth;
-  IsPressed     = VkContext->PageNumber <= VkPage1 ?
-                  VkContext->IsCapsLockFlag :
-                  VkContext->IsShiftKeyFlag;
 
   while (BltSize-- != 0) {
     //
@@ -223,6 +221,24 @@ ModifyShiftKeyColor (
   return EFI_SUCCESS;
 }
 
+/**
+  Check if the Shift or CapsLock key of the current page is pressed.
+
+  @param[in] VkContext      Address of an VK_CONTEXT structure.
+
+  @retval TRUE              The key is pressed.
+
+**/
+BOOLEAN
+IsShiftKeyPressed (
+  IN VK_CONTEXT *VkContext
+  )
+{
+  return VkContext->PageNumber <= VkPage1 ?
+         VkContext->IsCapsLockFlag :
+         VkContext->IsShiftKeyFlag;
+}
+
 /**
   Make the keyboard transparent.
 
@@ -275,6 +291,96 @@ MakeKeyboardTransparent (
   return EFI_SUCCESS;
 }
 
+/**
+  Free the keyboard surfaces.
+
+  @param[in] VkContext           Address of an VK_CONTEXT structure.
+
+**/
+VOID
+FreeVkBodySurfaces (
+  IN VK_CONTEXT *VkContext
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (VkContext->VkBodySurface); Index++) {
+    if (VkContext->VkBodySurface[Index] != NULL) {
+      FreePool (VkContext->VkBodySurface[Index]);
+      VkContext->VkBodySurface[Index] = NULL;
+    }
+  }
+  VkContext->VkBodySurfaceImage = NULL;
+}
+
+/**
+  Blend the keyboard with the saved background once per Shift state, and
+  find the rectangle of the pixels which depend on it.
+
+  @param[in] VkContext           Address of an VK_CONTEXT structure.
+  @param[in] VkImage             Image of the keyboard.
+  @param[in] BltIn               Scratch buffer of the keyboard size.
+
+  @retval EFI_SUCCESS            Success for the function.
+  @retval EFI_OUT_OF_RESOURCES   Allocate memory failed.
+
+**/
+EFI_STATUS
+BuildVkBodySurfaces (
+  IN VK_CONTEXT                    *VkContext,
+  IN EFI_IMAGE_INPUT               *VkImage,
+  IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltIn
+  )
+{
+  EFI_STATUS                    Status;
+  UINTN                         Index;
+  UINTN                         X;
+  UINTN                         Y;
+  UINTN                         MinX;
+  UINTN                         MinY;
+  UINTN                         MaxX;
+  UINTN                         MaxY;
+  UINT32                        *Released;
+  UINT32                        *Pressed;
+
+  FreeVkBodySurfaces (VkContext);
+
+  for (Index = 0; Index < ARRAY_SIZE (VkContext->VkBodySurface); Index++) {
+    CopyMem (BltIn, VkImage->Bitmap, VkImage->Width * VkImage->Height * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    ModifyShiftKeyColor (VkContext, (BOOLEAN)(Index != 0), &BltIn);
+    Status = MakeKeyboardTransparent (VkContext, TRUE, BltIn, &VkContext->VkBodySurface[Index]);
+    if (EFI_ERROR (Status)) {
+      FreeVkBodySurfaces (VkContext);
+      return Status;
+    }
+  }
+
+  MinX     = VkContext->VkBodyBltWidth;
+  MinY     = VkContext->VkBodyBltHeight;
+  MaxX     = 0;
+  MaxY     = 0;
+  Released = (UINT32 *)VkContext->VkBodySurface[0];
+  Pressed  = (UINT32 *)VkContext->VkBodySurface[1];
+  for (Y = 0; Y < VkContext->VkBodyBltHeight; Y++) {
+    for (X = 0; X < VkContext->VkBodyBltWidth; X++, Released++, Pressed++) {
+      if (*Released != *Pressed) {
+        MinX = MIN (MinX, X);
+        MaxX = MAX (MaxX, X + 1);
+        MinY = MIN (MinY, Y);
+        MaxY = Y + 1;
+      }
+    }
+  }
+
+  VkContext->VkBodyDirtyX      = MinX;
+  VkContext->VkBodyDirtyY      = MinY;
+  VkContext->VkBodyDirtyWidth  = (MaxX > MinX) ? MaxX - MinX : 0;
+  VkContext->VkBodyDirtyHeight = (MaxY > MinY) ? MaxY - MinY : 0;
+  VkContext->VkBodySurfaceImage = VkImage;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Save the background blt buffer.
 
@@ -440,6 +546,7 @@ RestoreVkBodyBackgroundBltBuffer (
 
   FreePool (VkContext->VkBodyBackgroundBltBuffer);
   VkContext->VkBodyBackgroundBltBuffer = NULL;
+  FreeVkBodySurfaces (VkContext);
 
   return Status;
 }
@@ -874,8 +981,18 @@ DrawVkBody (
       FreePool (VkContext->VkBodyCompoundBltBuffer);
     }
     VkContext->VkBodyCompoundBltBuffer = NULL;
-    ModifyShiftKeyColor (VkContext, &BltIn);
-    MakeKeyboardTransparent (VkContext, TRUE, BltIn, &(VkContext->VkBodyCompoundBltBuffer));
+    Status = BuildVkBodySurfaces (VkContext, VkImage, BltIn);
+    if (EFI_ERROR (Status)) {
+      goto DVKBODY_Exit;
+    }
+    VkContext->VkBodyCompoundBltBuffer = AllocateCopyPool (
+                                           VkContext->VkBodyBltSize,
+                                           VkContext->VkBodySurface[IsShiftKeyPressed (VkContext) ? 1 : 0]
+                                           );
+    if (VkContext->VkBodyCompoundBltBuffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto DVKBODY_Exit;
+    }
 
     //
     // Draw keyboard body
@@ -994,6 +1111,97 @@ HideVkIcon (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the keyboard body image of the display attribute and current page.
+
+  @param[in] VkContext          Code context.
+  @param[in] Attribute          Attribute of keyboard to display on the screen.
+
+  @return The image, NULL for VkDisplayAttributeNone.
+
+**/
+EFI_IMAGE_INPUT *
+GetVkBodyImage (
+  IN VK_CONTEXT           *VkContext,
+  IN VK_DISPLAY_ATTRIBUTE Attribute
+  )
+{
+  switch (Attribute) {
+  case VkDisplayAttributeSimpleTop:
+  case VkDisplayAttributeSimpleBottom:
+    return VkContext->SimKeyBody;
+
+  case VkDisplayAttributeFullTop:
+  case VkDisplayAttributeFullBottom:
+    if (VkContext->PageNumber <= VkPage1) {
+      return VkContext->CapLeKeyBody;
+    }
+    return VkContext->DigKeyBody;
+
+  default:
+    return NULL;
+  }
+}
+
+/**
+  Redraw the keyboard after a Shift or CapsLock change, only the keys
+  which changed are sent to the screen.
+
+  @param[in] VkContext          Code context.
+
+  @retval EFI_SUCCESS           The keyboard was updated.
+  @retval EFI_NOT_READY         The keyboard needs a full redraw.
+
+**/
+EFI_STATUS
+UpdateVkBodyShiftState (
+  IN VK_CONTEXT *VkContext
+  )
+{
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL *Surface;
+  UINTN                         Offset;
+  UINTN                         Row;
+
+  if ((VkContext->CurrentKeyboardDisplay == VkDisplayAttributeNone) ||
+      (VkContext->CurrentKeyboardDisplay != VkContext->TargetKeyboardDisplay) ||
+      (VkContext->VkBodyCompoundBltBuffer == NULL) ||
+      (VkContext->VkBodySurfaceImage == NULL) ||
+      (VkContext->VkBodySurfaceImage != GetVkBodyImage (VkContext, VkContext->CurrentKeyboardDisplay))) {
+    return EFI_NOT_READY;
+  }
+
+  if (VkContext->VkBodyDirtyWidth == 0) {
+    return EFI_SUCCESS;
+  }
+
+  //
+  // Keep the compound buffer what is on the screen, it is compared with
+  // the screen to find background changes.
+  //
+  Surface = VkContext->VkBodySurface[IsShiftKeyPressed (VkContext) ? 1 : 0];
+  for (Row = 0; Row < VkContext->VkBodyDirtyHeight; Row++) {
+    Offset = (VkContext->VkBodyDirtyY + Row) * VkContext->VkBodyBltWidth + VkContext->VkBodyDirtyX;
+    CopyMem (
+      &VkContext->VkBodyCompoundBltBuffer[Offset],
+      &Surface[Offset],
+      VkContext->VkBodyDirtyWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+      );
+  }
+
+  return VkContext->GraphicsOutput->Blt (
+                                      VkContext->GraphicsOutput,
+                                      VkContext->VkBodyCompoundBltBuffer,
+                                      EfiBltBufferToVideo,
+                                      VkContext->VkBodyDirtyX,
+                                      VkContext->VkBodyDirtyY,
+                                      VkContext->VkBodyBltStartX + VkContext->VkBodyDirtyX,
+                                      VkContext->VkBodyBltStartY + VkContext->VkBodyDirtyY,
+                                      VkContext->VkBodyDirtyWidth,
+                                      VkContext->VkBodyDirtyHeight,
+                                      VkContext->VkBodyBltWidth * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+                                      );
+}
+
 /**
   Draw key board on the display
 
@@ -1024,27 +1232,9 @@ DrawKeyboardLayout (
     VkContext->IsIconShowed = TRUE;
   }
 
-  if (VkContext->TargetKeyboardDisplay != VkContext->CurrentKeyboardDisplay) {
-    switch (VkContext->TargetKeyboardDisplay) {
-    case VkDisplayAttributeSimpleTop:
-    case VkDisplayAttributeSimpleBottom:
-      DrawVkBody (VkContext, VkContext->SimKeyBody, VkContext->TargetKeyboardDisplay);
-      break;
-
-    case VkDisplayAttributeFullTop:
-    case VkDisplayAttributeFullBottom:
-      if (VkContext->PageNumber <= VkPage1) {
-        DrawVkBody (VkContext, VkContext->CapLeKeyBody, VkContext->TargetKeyboardDisplay);
-      } else {
-        DrawVkBody (VkContext, VkContext->DigKeyBody, VkContext->TargetKeyboardDisplay);
-      }
-
-    case VkDisplayAttributeNone:
-      break;
-
-    default:
-      break;
-    }
+  if ((VkContext->TargetKeyboardDisplay != VkContext->CurrentKeyboardDisplay) &&
+      (GetVkBodyImage (VkContext, VkContext->TargetKeyboardDisplay) != NULL)) {
+    DrawVkBody (VkContext, GetVkBodyImage (VkContext, VkContext->TargetKeyboardDisplay), VkContext->TargetKeyboardDisplay);
   }
 
   return EFI_SUCCESS;
@@ -1343,6 +1533,7 @@ CheckScreenCleared (
       FreePool (VkContext->VkBodyCompoundBltBuffer);
       VkContext->VkBodyCompoundBltBuffer = NULL;
     }
+    FreeVkBodySurfaces (VkContext);
 
     if (VkContext->IconBltBuffer != NULL) {
       FreePool (VkContext->IconBltBuffer);
@@ -272,6 +272,18 @@ struct _VK_CONTEXT {
   UINTN                             VkBodyBltWidth;
   BOOLEAN                           IsBackgroundChanged;
 
+  ///
+  /// Keyboard body blended with the background, with the Shift/CapsLock
+  /// keys released and pressed. The dirty rectangle covers the pixels
+  /// which differ between the two.
+  ///
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL     *VkBodySurface[2];
+  EFI_IMAGE_INPUT                   *VkBodySurfaceImage;
+  UINTN                             VkBodyDirtyX;
+  UINTN                             VkBodyDirtyY;
+  UINTN                             VkBodyDirtyWidth;
+  UINTN                             VkBodyDirtyHeight;
+
   ///
   /// Icon buffer information
   ///
@@ -588,6 +600,21 @@ DrawKeyboardLayout (
   IN VK_CONTEXT *VkContext
   );
 
+/**
+  Redraw the keyboard after a Shift or CapsLock change, only the keys
+  which changed are sent to the screen.
+
+  @param[in] VkContext          Code context.
+
+  @retval EFI_SUCCESS           The keyboard was updated.
+  @retval EFI_NOT_READY         The keyboard needs a full redraw.
+
+**/
+EFI_STATUS
+UpdateVkBodyShiftState (
+  IN VK_CONTEXT *VkContext
+  );
+
 /**
   Clear the keyboard body
 
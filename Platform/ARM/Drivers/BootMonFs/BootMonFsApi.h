@@ -44,6 +44,11 @@ BootMonFsGetPhysicalSize (
   IN BOOTMON_FS_FILE* File
   );
 
+VOID
+BootMonFsFreeReadCache (
+  IN BOOTMON_FS_FILE *File
+  );
+
 EFI_STATUS
 BootMonFsCreateFile (
   IN  BOOTMON_FS_INSTANCE *Instance,
@@ -29,6 +29,10 @@
 
 #define BOOTMON_FS_VOLUME_LABEL   L"NOR Flash"
 
+// Reads smaller than this are served from an aligned read-ahead window of
+// this size, larger ones go straight to the caller's buffer
+#define BOOTMON_FS_READ_AHEAD_SIZE  SIZE_256KB
+
 typedef struct _BOOTMON_FS_INSTANCE BOOTMON_FS_INSTANCE;
 
 typedef struct {
@@ -58,6 +62,10 @@ typedef struct {
   // buffer that creates this file
   LIST_ENTRY            RegionToFlushLink;
   UINT64                OpenMode;
+  // Read-ahead window of the file data read from the media
+  VOID                  *ReadCache;
+  UINT64                ReadCacheOffset; // Offset from the start of the file
+  UINTN                 ReadCacheSize;   // Number of valid bytes, 0 if empty
 } BOOTMON_FS_FILE;
 
 #define BOOTMON_FS_FILE_SIGNATURE              SIGNATURE_32('b', 'o', 't', 'f')
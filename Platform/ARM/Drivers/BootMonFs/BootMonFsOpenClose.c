@@ -455,6 +455,7 @@ BootMonFsCloseFile (
   // In the case of a file and not the root directory
   if (This != &File->Instance->RootFile->File) {
     This->Flush (This);
+    BootMonFsFreeReadCache (File);
     FreePool (File->Info);
     File->Info = NULL;
   }
@@ -782,6 +783,7 @@ BootMonFsDelete (
 
   // Remove the entry from the list
   RemoveEntryList (&File->Link);
+  BootMonFsFreeReadCache (File);
   FreePool (File->Info);
   FreePool (File);
 
@@ -14,6 +14,80 @@
 
 #include "BootMonFsInternal.h"
 
+/**
+  Release the read-ahead window of a file.
+
+  @param[in]  File  The file whose window is released.
+
+**/
+VOID
+BootMonFsFreeReadCache (
+  IN BOOTMON_FS_FILE *File
+  )
+{
+  if (File->ReadCache != NULL) {
+    FreePool (File->ReadCache);
+    File->ReadCache = NULL;
+  }
+  File->ReadCacheSize = 0;
+}
+
+/**
+  Fill the read-ahead window with the aligned part of the file that holds
+  Position.
+
+  @param[in]  File       The open file to read from.
+  @param[in]  FileStart  Offset of the file data on the media.
+  @param[in]  Position   The file position the window must hold.
+
+  @retval  EFI_SUCCESS           The window holds Position.
+  @retval  EFI_OUT_OF_RESOURCES  The window could not be allocated.
+  @retval  Others                The media reported an error.
+
+**/
+STATIC
+EFI_STATUS
+BootMonFsReadAhead (
+  IN BOOTMON_FS_FILE  *File,
+  IN UINT64           FileStart,
+  IN UINT64           Position
+  )
+{
+  EFI_DISK_IO_PROTOCOL  *DiskIo;
+  EFI_STATUS            Status;
+  UINT64                WindowStart;
+  UINTN                 WindowSize;
+
+  if (File->ReadCache == NULL) {
+    File->ReadCache = AllocatePool (BOOTMON_FS_READ_AHEAD_SIZE);
+    if (File->ReadCache == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  }
+
+  DiskIo      = File->Instance->DiskIo;
+  WindowStart = Position & ~((UINT64)BOOTMON_FS_READ_AHEAD_SIZE - 1);
+  WindowSize  = (UINTN)MIN (BOOTMON_FS_READ_AHEAD_SIZE,
+                            File->Info->FileSize - WindowStart);
+
+  File->ReadCacheSize = 0;
+  Status = DiskIo->ReadDisk (
+                    DiskIo,
+                    File->Instance->Media->MediaId,
+                    FileStart + WindowStart,
+                    WindowSize,
+                    File->ReadCache
+                    );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  File->ReadCacheOffset = WindowStart;
+  File->ReadCacheSize   = WindowSize;
+
+  return EFI_SUCCESS;
+}
+
 /**
   Read data from an open file.
 
@@ -47,6 +121,10 @@ BootMonFsReadFile (
   UINT64                FileStart;
   EFI_STATUS            Status;
   UINTN                 RemainingFileSize;
+  UINT8                 *Ptr;
+  UINT64                Position;
+  UINTN                 Remaining;
+  UINTN                 Count;
 
   if ((This == NULL)       ||
       (BufferSize == NULL) ||
@@ -86,13 +164,49 @@ BootMonFsReadFile (
     *BufferSize = RemainingFileSize;
   }
 
-  Status = DiskIo->ReadDisk (
-                    DiskIo,
-                    Media->MediaId,
-                    FileStart + File->Position,
-                    *BufferSize,
-                    Buffer
-                    );
+  Status    = EFI_SUCCESS;
+  Ptr       = Buffer;
+  Position  = File->Position;
+  Remaining = *BufferSize;
+
+  while (Remaining > 0) {
+    if ((File->ReadCacheSize > 0)              &&
+        (Position >= File->ReadCacheOffset)    &&
+        (Position < File->ReadCacheOffset + File->ReadCacheSize)) {
+      Count = (UINTN)MIN (Remaining,
+                          File->ReadCacheOffset + File->ReadCacheSize - Position);
+      CopyMem (Ptr, (UINT8*)File->ReadCache + (Position - File->ReadCacheOffset), Count);
+    } else {
+      if (Remaining < BOOTMON_FS_READ_AHEAD_SIZE) {
+        Status = BootMonFsReadAhead (File, FileStart, Position);
+        if (!EFI_ERROR (Status)) {
+          continue;
+        }
+        if (Status != EFI_OUT_OF_RESOURCES) {
+          break;
+        }
+      }
+
+      // Large reads, or small ones without a window, go straight to the
+      // caller's buffer
+      Count = Remaining;
+      Status = DiskIo->ReadDisk (
+                        DiskIo,
+                        Media->MediaId,
+                        FileStart + Position,
+                        Count,
+                        Ptr
+                        );
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    Ptr       += Count;
+    Position  += Count;
+    Remaining -= Count;
+  }
+
   if (EFI_ERROR (Status)) {
     *BufferSize = 0;
   }
@@ -145,6 +259,9 @@ BootMonFsWriteFile (
     return EFI_ACCESS_DENIED;
   }
 
+  // The data read ahead may be overwritten
+  File->ReadCacheSize = 0;
+
   // Allocate and initialize the memory region
   Region = (BOOTMON_FS_FILE_REGION*)AllocateZeroPool (sizeof (BOOTMON_FS_FILE_REGION));
   if (Region == NULL) {
@@ -54,6 +54,7 @@ SataSiI3132PortConstructor (
   Port->RegBase  = Index * 0x2000;
   Port->Instance = SataSiI3132Instance;
   InitializeListHead (&(Port->Devices));
+  InitializeListHead (&(Port->NonBlockingTaskList));
 
   NumberOfBytes = sizeof (SATA_SI3132_PRB);
   Status = SataSiI3132Instance->PciIo->AllocateBuffer (
@@ -90,6 +91,7 @@ SataSiI3132Constructor (
 {
   SATA_SI3132_INSTANCE    *Instance;
   EFI_ATA_PASS_THRU_MODE  *AtaPassThruMode;
+  EFI_STATUS              Status;
 
   if (!SataSiI3132Instance) {
     return EFI_INVALID_PARAMETER;
@@ -104,13 +106,25 @@ SataSiI3132Constructor (
   Instance->PciIo               = PciIo;
 
   AtaPassThruMode = (EFI_ATA_PASS_THRU_MODE*)AllocatePool (sizeof (EFI_ATA_PASS_THRU_MODE));
-  AtaPassThruMode->Attributes = EFI_ATA_PASS_THRU_ATTRIBUTES_PHYSICAL | EFI_ATA_PASS_THRU_ATTRIBUTES_LOGICAL;
+  AtaPassThruMode->Attributes = EFI_ATA_PASS_THRU_ATTRIBUTES_PHYSICAL | EFI_ATA_PASS_THRU_ATTRIBUTES_LOGICAL |
+                                EFI_ATA_PASS_THRU_ATTRIBUTES_NONBLOCKIO;
   AtaPassThruMode->IoAlign = 0x1000;
 
   // Initialize SiI3132 ports
   SataSiI3132PortConstructor (Instance, 0);
   SataSiI3132PortConstructor (Instance, 1);
 
+  // Timer running the non-blocking commands
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_NOTIFY,
+                  SiI3132NonBlockingTimer, Instance, &Instance->NonBlockingTimer);
+  if (!EFI_ERROR (Status)) {
+    Status = gBS->SetTimer (Instance->NonBlockingTimer, TimerPeriodic,
+                    SII3132_NONBLOCKING_TIMER_PERIOD);
+  }
+  if (EFI_ERROR (Status)) {
+    AtaPassThruMode->Attributes &= ~EFI_ATA_PASS_THRU_ATTRIBUTES_NONBLOCKIO;
+  }
+
   // Set ATA Pass Thru Protocol
   Instance->AtaPassThruProtocol.Mode            = AtaPassThruMode;
   Instance->AtaPassThruProtocol.PassThru        = SiI3132AtaPassThru;
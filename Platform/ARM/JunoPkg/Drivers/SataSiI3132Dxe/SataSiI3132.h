@@ -69,6 +69,7 @@
 #define SII3132_PORT_INT_CMDCOMPL               (1 << 0)
 #define SII3132_PORT_INT_CMDERR                 (1 << 1)
 #define SII3132_PORT_INT_PORTRDY                (1 << 2)
+#define SII3132_PORT_INT_CMD_MASK               ((SII3132_PORT_INT_CMDCOMPL | SII3132_PORT_INT_CMDERR) << 16)
 
 #define SATA_SII3132_MAXPORT    2
 
@@ -135,8 +136,28 @@ typedef struct _SATA_SI3132_PORT {
     SATA_SI3132_PRB*                HostPRB;
     EFI_PHYSICAL_ADDRESS            PhysAddrHostPRB;
     VOID*                           PciAllocMappingPRB;
+
+    // Non-blocking commands waiting for the PRB, SATA_SI3132_TASK entries
+    LIST_ENTRY                      NonBlockingTaskList;
 } SATA_SI3132_PORT;
 
+// Period of the timer running the non-blocking commands, in 100ns units
+#define SII3132_NONBLOCKING_TIMER_PERIOD    10000
+
+typedef struct _SATA_SI3132_TASK {
+    UINTN                             Signature;
+    LIST_ENTRY                        Link;
+    UINT16                            PortMultiplierPort;
+    EFI_ATA_PASS_THRU_COMMAND_PACKET  *Packet;
+    EFI_EVENT                         Event;
+    BOOLEAN                           IsStarted;
+    UINT64                            RetryTimes;
+    VOID*                             PciAllocMapping;
+} SATA_SI3132_TASK;
+
+#define SATA_SI3132_TASK_SIGNATURE          SIGNATURE_32('s', 'i', 't', 'k')
+#define SATA_SI3132_TASK_FROM_LINK(a)       CR(a, SATA_SI3132_TASK, Link, SATA_SI3132_TASK_SIGNATURE)
+
 typedef struct _SATA_SI3132_INSTANCE {
     UINTN                       Signature;
 
@@ -145,6 +166,8 @@ typedef struct _SATA_SI3132_INSTANCE {
     EFI_ATA_PASS_THRU_PROTOCOL  AtaPassThruProtocol;
 
     EFI_PCI_IO_PROTOCOL         *PciIo;
+
+    EFI_EVENT                   NonBlockingTimer;
 } SATA_SI3132_INSTANCE;
 
 #define SATA_SII3132_SIGNATURE              SIGNATURE_32('s', 'i', '3', '2')
@@ -222,6 +245,13 @@ SiI3132AtaPassThruCommand (
   IN     EFI_EVENT                        Event OPTIONAL
   );
 
+VOID
+EFIAPI
+SiI3132NonBlockingTimer (
+  IN  EFI_EVENT                 Event,
+  IN  VOID                      *Context
+  );
+
 /**
  * EFI ATA Pass Thru Protocol
  */
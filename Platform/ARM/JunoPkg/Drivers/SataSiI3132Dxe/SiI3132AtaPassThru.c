@@ -16,7 +16,9 @@
 #include "SataSiI3132.h"
 
 #include <IndustryStandard/Atapi.h>
+#include <Library/BaseLib.h>
 #include <Library/DevicePathLib.h>
+#include <Library/MemoryAllocationLib.h>
 
 SATA_SI3132_DEVICE*
 GetSataDevice (
@@ -45,14 +47,26 @@ GetSataDevice (
   return NULL;
 }
 
+/**
+  Build the PRB of an ATA command and issue it on the port.
+
+  @param[in]     SataSiI3132Instance The SiI3132 instance
+  @param[in]     SataPort            The port to issue the command on
+  @param[in]     PortMultiplierPort  The port multiplier port of the device
+  @param[in,out] Packet              The ATA command to send
+  @param[out]    PciAllocMapping     The mapping of the data buffer, to unmap
+                                     once the command completed
+
+  @retval EFI_SUCCESS                The command was issued
+**/
+STATIC
 EFI_STATUS
-EFIAPI
-SiI3132AtaPassThruCommand (
+SiI3132AtaPassThruIssue (
   IN     SATA_SI3132_INSTANCE             *SataSiI3132Instance,
   IN     SATA_SI3132_PORT                 *SataPort,
   IN     UINT16                           PortMultiplierPort,
   IN OUT EFI_ATA_PASS_THRU_COMMAND_PACKET *Packet,
-  IN     EFI_EVENT                        Event OPTIONAL
+  OUT    VOID                             **PciAllocMapping
   )
 {
   SATA_SI3132_DEVICE      *SataDevice;
@@ -63,13 +77,11 @@ SiI3132AtaPassThruCommand (
   CONST UINTN             EmptySlot = 0;
   UINTN                   Control = PRB_CTRL_ATA;
   UINTN                   Protocol = 0;
-  UINT32                  Value32, Error, Timeout = 0;
-  CONST UINT32            IrqMask = (SII3132_PORT_INT_CMDCOMPL | SII3132_PORT_INT_CMDERR) << 16;
   EFI_STATUS              Status;
-  VOID*                   PciAllocMapping = NULL;
   EFI_PCI_IO_PROTOCOL     *PciIo;
 
   PciIo = SataSiI3132Instance->PciIo;
+  *PciAllocMapping = NULL;
   ZeroMem (SataPort->HostPRB, sizeof (SATA_SI3132_PRB));
 
   // Construct Si3132 PRB
@@ -107,7 +119,7 @@ SiI3132AtaPassThruCommand (
 
     Status = PciIo->Map (
                PciIo, EfiPciIoOperationBusMasterWrite,
-               Packet->InDataBuffer, &InDataBufferLength, &PhysInDataBuffer, &PciAllocMapping
+               Packet->InDataBuffer, &InDataBufferLength, &PhysInDataBuffer, PciAllocMapping
                );
     if (EFI_ERROR (Status)) {
       return Status;
@@ -142,7 +154,7 @@ SiI3132AtaPassThruCommand (
 
     Status = PciIo->Map (
                PciIo, EfiPciIoOperationBusMasterRead,
-               Packet->OutDataBuffer, &OutDataBufferLength, &PhysOutDataBuffer, &PciAllocMapping
+               Packet->OutDataBuffer, &OutDataBufferLength, &PhysOutDataBuffer, PciAllocMapping
                );
     if (EFI_ERROR (Status)) {
       return Status;
@@ -191,7 +203,7 @@ SiI3132AtaPassThruCommand (
   SataPort->HostPRB->ProtocolOverride = Protocol;
 
   // Clear IRQ
-  SATA_PORT_WRITE32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, IrqMask);
+  SATA_PORT_WRITE32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, SII3132_PORT_INT_CMD_MASK);
 
   if (!FeaturePcdGet (PcdSataSiI3132FeatureDirectCommandIssuing)) {
     // Indirect Command Issuance
@@ -214,31 +226,40 @@ SiI3132AtaPassThruCommand (
     SATA_PORT_WRITE32 (SataPort->RegBase + SII3132_PORT_CMDEXECFIFO_REG, EmptySlot);
   }
 
-#if 0
-  // Could need to be implemented if we run multiple command in parallel to know which slot has been completed
-  SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_SLOTSTATUS_REG, &Value32);
-  Timeout = Packet->Timeout;
-  while (!Timeout && !Value32) {
-    gBS->Stall (1);
-    SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_SLOTSTATUS_REG, &Value32);
-    Timeout--;
-  }
-#else
-  SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, &Value32);
-  if (!Packet->Timeout) {
-    while (!(Value32 & IrqMask)) {
-      gBS->Stall (1);
-      SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, &Value32);
-    }
-  } else {
-    Timeout = Packet->Timeout;
-    while (Timeout && !(Value32 & IrqMask)) {
-      gBS->Stall (1);
-      SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, &Value32);
-      Timeout--;
-    }
-  }
-#endif
+  return EFI_SUCCESS;
+}
+
+/**
+  Finish an ATA command once the port reported its completion or its error.
+
+  @param[in]     SataSiI3132Instance The SiI3132 instance
+  @param[in]     SataPort            The port the command was issued on
+  @param[in]     PortMultiplierPort  The port multiplier port of the device
+  @param[in,out] Packet              The ATA command, its status block is filled
+  @param[in]     IrqStatus           The interrupt status of the port
+  @param[in]     PciAllocMapping     The mapping of the data buffer
+
+  @retval EFI_SUCCESS                The command completed
+  @retval EFI_DEVICE_ERROR           The command failed
+**/
+STATIC
+EFI_STATUS
+SiI3132AtaPassThruComplete (
+  IN     SATA_SI3132_INSTANCE             *SataSiI3132Instance,
+  IN     SATA_SI3132_PORT                 *SataPort,
+  IN     UINT16                           PortMultiplierPort,
+  IN OUT EFI_ATA_PASS_THRU_COMMAND_PACKET *Packet,
+  IN     UINT32                           IrqStatus,
+  IN     VOID                             *PciAllocMapping
+  )
+{
+  SATA_SI3132_DEVICE      *SataDevice;
+  UINT32                  Error;
+  EFI_STATUS              Status;
+  EFI_PCI_IO_PROTOCOL     *PciIo;
+
+  PciIo = SataSiI3132Instance->PciIo;
+
   // Fill Packet Ata Status Block
   Status = PciIo->Mem.Read (PciIo, EfiPciIoWidthUint32, 1, // Bar 1
       SataPort->RegBase + 0x08,
@@ -246,25 +267,20 @@ SiI3132AtaPassThruCommand (
       Packet->Asb);
   ASSERT_EFI_ERROR (Status);
 
+  if (PciAllocMapping) {
+    Status = PciIo->Unmap (PciIo, PciAllocMapping);
+    ASSERT (!EFI_ERROR (Status));
+  }
 
-  if ((Packet->Timeout != 0) && (Timeout == 0)) {
-    DEBUG ((EFI_D_ERROR, "SiI3132AtaPassThru() Err:Timeout\n"));
-    //ASSERT (0);
-    return EFI_TIMEOUT;
-  } else if (Value32 & (SII3132_PORT_INT_CMDERR << 16)) {
+  if (IrqStatus & (SII3132_PORT_INT_CMDERR << 16)) {
     SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_CMDERROR_REG, &Error);
-    DEBUG ((EFI_D_ERROR, "SiI3132AtaPassThru() CmdErr:0x%X (SiI3132 Err:0x%X)\n", Value32, Error));
+    DEBUG ((EFI_D_ERROR, "SiI3132AtaPassThru() CmdErr:0x%X (SiI3132 Err:0x%X)\n", IrqStatus, Error));
     ASSERT (0);
     return EFI_DEVICE_ERROR;
-  } else if (Value32 & (SII3132_PORT_INT_CMDCOMPL << 16)) {
+  } else if (IrqStatus & (SII3132_PORT_INT_CMDCOMPL << 16)) {
     // Clear Command Complete
     SATA_PORT_WRITE32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, SII3132_PORT_INT_CMDCOMPL << 16);
 
-    if (PciAllocMapping) {
-      Status = PciIo->Unmap (PciIo, PciAllocMapping);
-      ASSERT (!EFI_ERROR (Status));
-    }
-
     // If the command was ATA_CMD_IDENTIFY_DRIVE then we need to update the BlockSize
     if (Packet->Acb->AtaCommand == ATA_CMD_IDENTIFY_DRIVE) {
       ATA_IDENTIFY_DATA *IdentifyData = (ATA_IDENTIFY_DATA*)Packet->InDataBuffer;
@@ -288,6 +304,146 @@ SiI3132AtaPassThruCommand (
   }
 }
 
+EFI_STATUS
+EFIAPI
+SiI3132AtaPassThruCommand (
+  IN     SATA_SI3132_INSTANCE             *SataSiI3132Instance,
+  IN     SATA_SI3132_PORT                 *SataPort,
+  IN     UINT16                           PortMultiplierPort,
+  IN OUT EFI_ATA_PASS_THRU_COMMAND_PACKET *Packet,
+  IN     EFI_EVENT                        Event OPTIONAL
+  )
+{
+  UINT32                  Value32, Timeout = 0;
+  EFI_STATUS              Status;
+  VOID*                   PciAllocMapping;
+  EFI_PCI_IO_PROTOCOL     *PciIo;
+
+  PciIo = SataSiI3132Instance->PciIo;
+
+  Status = SiI3132AtaPassThruIssue (SataSiI3132Instance, SataPort, PortMultiplierPort,
+             Packet, &PciAllocMapping);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, &Value32);
+  if (!Packet->Timeout) {
+    while (!(Value32 & SII3132_PORT_INT_CMD_MASK)) {
+      gBS->Stall (1);
+      SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, &Value32);
+    }
+  } else {
+    Timeout = Packet->Timeout;
+    while (Timeout && !(Value32 & SII3132_PORT_INT_CMD_MASK)) {
+      gBS->Stall (1);
+      SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, &Value32);
+      Timeout--;
+    }
+  }
+
+  if ((Packet->Timeout != 0) && (Timeout == 0)) {
+    DEBUG ((EFI_D_ERROR, "SiI3132AtaPassThru() Err:Timeout\n"));
+    //ASSERT (0);
+    if (PciAllocMapping) {
+      PciIo->Unmap (PciIo, PciAllocMapping);
+    }
+    return EFI_TIMEOUT;
+  }
+
+  return SiI3132AtaPassThruComplete (SataSiI3132Instance, SataPort, PortMultiplierPort,
+           Packet, Value32, PciAllocMapping);
+}
+
+/**
+  Run the non-blocking commands queued on a port.
+
+  The PRB of the port holds one command, so the commands of a port run one
+  after the other in queue order while the two ports run in parallel. Every
+  call checks whether the command at the head of the queue is done, signals
+  its event if it is, and issues the next one.
+
+  @param[in]  SataPort           The port whose queue is run
+**/
+STATIC
+VOID
+SiI3132ProcessPortTasks (
+  IN  SATA_SI3132_PORT          *SataPort
+  )
+{
+  SATA_SI3132_INSTANCE          *SataSiI3132Instance;
+  SATA_SI3132_TASK              *Task;
+  EFI_PCI_IO_PROTOCOL           *PciIo;
+  EFI_STATUS                    Status;
+  UINT32                        Value32;
+
+  if (IsListEmpty (&SataPort->NonBlockingTaskList)) {
+    return;
+  }
+
+  SataSiI3132Instance = SataPort->Instance;
+  PciIo = SataSiI3132Instance->PciIo;
+  Task = SATA_SI3132_TASK_FROM_LINK (GetFirstNode (&SataPort->NonBlockingTaskList));
+
+  if (!Task->IsStarted) {
+    Status = SiI3132AtaPassThruIssue (SataSiI3132Instance, SataPort, Task->PortMultiplierPort,
+               Task->Packet, &Task->PciAllocMapping);
+    if (!EFI_ERROR (Status)) {
+      Task->IsStarted = TRUE;
+      return;
+    }
+  } else {
+    SATA_PORT_READ32 (SataPort->RegBase + SII3132_PORT_INTSTATUS_REG, &Value32);
+    if (Value32 & SII3132_PORT_INT_CMD_MASK) {
+      Status = SiI3132AtaPassThruComplete (SataSiI3132Instance, SataPort, Task->PortMultiplierPort,
+                 Task->Packet, Value32, Task->PciAllocMapping);
+    } else if ((Task->Packet->Timeout == 0) || (Task->RetryTimes-- > 0)) {
+      return;
+    } else {
+      DEBUG ((EFI_D_ERROR, "SiI3132AtaPassThru() Err:Timeout\n"));
+      if (Task->PciAllocMapping) {
+        PciIo->Unmap (PciIo, Task->PciAllocMapping);
+      }
+      Status = EFI_TIMEOUT;
+    }
+  }
+
+  // The caller only gets the status block, flag the failure in it
+  if (EFI_ERROR (Status)) {
+    Task->Packet->Asb->AtaStatus |= BIT0;
+  }
+
+  RemoveEntryList (&Task->Link);
+  gBS->SignalEvent (Task->Event);
+  FreePool (Task);
+
+  // Keep the port busy with the next command
+  SiI3132ProcessPortTasks (SataPort);
+}
+
+/**
+  Timer handler running the non-blocking commands of all the ports.
+
+  @param[in]  Event             The timer event
+  @param[in]  Context           The SiI3132 instance
+**/
+VOID
+EFIAPI
+SiI3132NonBlockingTimer (
+  IN  EFI_EVENT                 Event,
+  IN  VOID                      *Context
+  )
+{
+  SATA_SI3132_INSTANCE          *SataSiI3132Instance;
+  UINTN                         Index;
+
+  SataSiI3132Instance = (SATA_SI3132_INSTANCE*)Context;
+
+  for (Index = 0; Index < SATA_SII3132_MAXPORT; Index++) {
+    SiI3132ProcessPortTasks (&SataSiI3132Instance->Ports[Index]);
+  }
+}
+
 /**
   Sends an ATA command to an ATA device that is attached to the ATA controller. This function
   supports both blocking I/O and non-blocking I/O. The blocking I/O functionality is required,
@@ -330,6 +486,9 @@ SiI3132AtaPassThru (
   SATA_SI3132_INSTANCE    *SataSiI3132Instance;
   SATA_SI3132_DEVICE      *SataDevice;
   SATA_SI3132_PORT        *SataPort;
+  SATA_SI3132_TASK        *Task;
+  EFI_STATUS              Status;
+  EFI_TPL                 OldTpl;
 
   SataSiI3132Instance = INSTANCE_FROM_ATAPASSTHRU_THIS (This);
   if (!SataSiI3132Instance) {
@@ -345,7 +504,34 @@ SiI3132AtaPassThru (
   DEBUG ((EFI_D_INFO, "SiI3132AtaPassThru(%d,%d) : AtaCmd:0x%X Prot:%d\n", Port, PortMultiplierPort,
          Packet->Acb->AtaCommand, Packet->Protocol));
 
-  return SiI3132AtaPassThruCommand (SataSiI3132Instance, SataPort, PortMultiplierPort, Packet, Event);
+  if (Event != NULL) {
+    // Queue the command, the timer issues it once the port is free
+    Task = AllocateZeroPool (sizeof (SATA_SI3132_TASK));
+    if (Task == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Task->Signature          = SATA_SI3132_TASK_SIGNATURE;
+    Task->PortMultiplierPort = PortMultiplierPort;
+    Task->Packet             = Packet;
+    Task->Event              = Event;
+    Task->RetryTimes         = DivU64x32 (Packet->Timeout, SII3132_NONBLOCKING_TIMER_PERIOD) + 1;
+
+    OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+    InsertTailList (&SataPort->NonBlockingTaskList, &Task->Link);
+    gBS->RestoreTPL (OldTpl);
+    return EFI_SUCCESS;
+  }
+
+  // A blocking command runs once the queued ones are done, they share the PRB
+  OldTpl = gBS->RaiseTPL (TPL_NOTIFY);
+  while (!IsListEmpty (&SataPort->NonBlockingTaskList)) {
+    SiI3132ProcessPortTasks (SataPort);
+    gBS->Stall (SII3132_NONBLOCKING_TIMER_PERIOD / 10);
+  }
+  Status = SiI3132AtaPassThruCommand (SataSiI3132Instance, SataPort, PortMultiplierPort, Packet, NULL);
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
 }
 
 /**
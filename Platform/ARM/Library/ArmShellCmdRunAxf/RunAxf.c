@@ -18,6 +18,7 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/DebugLib.h>
+#include <Library/TimerLib.h>
 
 #include <Library/ArmLib.h>
 
@@ -27,6 +28,12 @@
 #include "ElfLoader.h"
 #include "BootMonFsLoader.h"
 
+// Size of each read of the file, the progress is shown after each one
+#define RUNAXF_READ_CHUNK_SIZE    SIZE_1MB
+
+// Load ranges closer than this are cache maintained as a single range
+#define RUNAXF_CACHE_MERGE_GAP    SIZE_64KB
+
 // Provide arguments to AXF?
 typedef VOID (*ELF_ENTRYPOINT)(UINTN arg0, UINTN arg1,
                                UINTN arg2, UINTN arg3);
@@ -88,6 +95,111 @@ ShutdownUefiBootServices (
   return Status;
 }
 
+/**
+  Read the whole file into memory with large sequential reads, showing the
+  progress and the throughput.
+**/
+STATIC
+EFI_STATUS
+ReadAxfFile (
+  IN  SHELL_FILE_HANDLE  FileHandle,
+  IN  UINTN              FileSize,
+  OUT VOID              *FileData
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Offset;
+  UINTN       ReadSize;
+  UINT64      StartTime;
+  UINT64      ElapsedMs;
+  UINT64      Throughput;
+
+  StartTime = GetTimeInNanoSecond (GetPerformanceCounter ());
+
+  for (Offset = 0; Offset < FileSize; Offset += ReadSize) {
+    ReadSize = MIN (FileSize - Offset, RUNAXF_READ_CHUNK_SIZE);
+    Status = ShellReadFile (FileHandle, &ReadSize, (UINT8 *)FileData + Offset);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    if (ReadSize == 0) {
+      // The file is shorter than its size said
+      return EFI_END_OF_FILE;
+    }
+    ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_RUNAXF_READ_PROGRESS),
+                     gRunAxfHiiHandle, (UINT64)(Offset + ReadSize) / SIZE_1KB,
+                     (UINT64)FileSize / SIZE_1KB);
+  }
+
+  ElapsedMs = DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter ()) -
+                         StartTime, 1000000);
+  Throughput = 0;
+  if (ElapsedMs != 0) {
+    Throughput = DivU64x64Remainder (MultU64x32 (FileSize, 1000),
+                                     MultU64x32 (ElapsedMs, SIZE_1KB), NULL);
+  }
+  ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_RUNAXF_READ_DONE),
+                   gRunAxfHiiHandle, (UINT64)FileSize / SIZE_1KB, ElapsedMs,
+                   Throughput);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Copy the load list to memory, then clean and invalidate the caches once
+  for each group of neighbouring load ranges rather than once per segment.
+
+  Called after ExitBootServices(), so it must not use any UEFI service.
+**/
+STATIC
+VOID
+CopyLoadList (
+  IN  LIST_ENTRY  *LoadList
+  )
+{
+  LIST_ENTRY        *Node;
+  RUNAXF_LOAD_LIST  *LoadNode;
+  UINTN             RangeStart;
+  UINTN             RangeEnd;
+
+  RangeStart = 0;
+  RangeEnd   = 0;
+
+  Node = GetFirstNode (LoadList);
+  while (!IsNull (LoadList, Node)) {
+    LoadNode = (RUNAXF_LOAD_LIST *)Node;
+    // Do we have data to copy or do we need to set Zeroes (.bss)?
+    if (LoadNode->Zeroes) {
+      ZeroMem ((VOID*)LoadNode->MemOffset, LoadNode->Length);
+    } else {
+      CopyMem ((VOID *)LoadNode->MemOffset, (VOID *)LoadNode->FileOffset,
+               LoadNode->Length);
+    }
+
+    if ((RangeEnd != RangeStart) &&
+        (LoadNode->MemOffset >= RangeStart) &&
+        (LoadNode->MemOffset <= RangeEnd + RUNAXF_CACHE_MERGE_GAP)) {
+      RangeEnd = MAX (RangeEnd, LoadNode->MemOffset + LoadNode->Length);
+    } else {
+      if (RangeEnd != RangeStart) {
+        WriteBackInvalidateDataCacheRange ((VOID *)RangeStart,
+                                           RangeEnd - RangeStart);
+        InvalidateInstructionCacheRange ((VOID *)RangeStart,
+                                         RangeEnd - RangeStart);
+      }
+      RangeStart = LoadNode->MemOffset;
+      RangeEnd   = LoadNode->MemOffset + LoadNode->Length;
+    }
+    Node = GetNextNode (LoadList, Node);
+  }
+
+  if (RangeEnd != RangeStart) {
+    WriteBackInvalidateDataCacheRange ((VOID *)RangeStart,
+                                       RangeEnd - RangeStart);
+    InvalidateInstructionCacheRange ((VOID *)RangeStart, RangeEnd - RangeStart);
+  }
+}
+
 // Process arguments to pass to AXF?
 STATIC CONST SHELL_PARAM_ITEM ParamList[] = {
   {NULL, TypeMax}
@@ -139,7 +251,6 @@ ShellDynCmdRunAxfHandler (
   LIST_ENTRY                  LoadList;
   LIST_ENTRY                  *Node;
   LIST_ENTRY                  *NextNode;
-  RUNAXF_LOAD_LIST            *LoadNode;
   CHAR16                      *TmpFileName;
   CHAR16                      *TmpChar16;
   EFI_LOADED_IMAGE_PROTOCOL   *LoadedImage;
@@ -222,7 +333,7 @@ ShellDynCmdRunAxfHandler (
         // Allocate buffer to read file. 'Runtime' so we can access it after
         // ExitBootServices().
         //
-        FileData = AllocateRuntimeZeroPool (FileSize);
+        FileData = AllocateRuntimePool (FileSize);
         if (FileData == NULL) {
           ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_RUNAXF_NO_MEM), gRunAxfHiiHandle);
           ShellStatus = SHELL_OUT_OF_RESOURCES;
@@ -230,7 +341,7 @@ ShellDynCmdRunAxfHandler (
           //
           // Read file into Buffer
           //
-          Status = ShellReadFile (FileHandle, &FileSize, FileData);
+          Status = ReadAxfFile (FileHandle, FileSize, FileData);
           if (EFI_ERROR (Status)) {
             ShellPrintHiiEx (-1, -1, NULL, STRING_TOKEN (STR_RUNAXF_READ_FAIL), gRunAxfHiiHandle);
             SHELL_FREE_NON_NULL (FileData);
@@ -278,9 +389,6 @@ ShellDynCmdRunAxfHandler (
     }
   }
 
-  WriteBackDataCacheRange (FileData, FileSize);
-  InvalidateInstructionCacheRange (FileData, FileSize);
-
   // Program load list created.
   // Shutdown UEFI, copy and jump to code.
   if (!IsListEmpty (&LoadList) && !EFI_ERROR (Status)) {
@@ -292,18 +400,7 @@ ShellDynCmdRunAxfHandler (
               Status));
     } else {
       // Process linked list. Copy data to Memory.
-      Node = GetFirstNode (&LoadList);
-      while (!IsNull (&LoadList, Node)) {
-        LoadNode = (RUNAXF_LOAD_LIST *)Node;
-        // Do we have data to copy or do we need to set Zeroes (.bss)?
-        if (LoadNode->Zeroes) {
-          ZeroMem ((VOID*)LoadNode->MemOffset, LoadNode->Length);
-        } else {
-          CopyMem ((VOID *)LoadNode->MemOffset, (VOID *)LoadNode->FileOffset,
-                   LoadNode->Length);
-        }
-        Node = GetNextNode (&LoadList, Node);
-      }
+      CopyLoadList (&LoadList);
 
       Status = gBS->HandleProtocol (gImageHandle, &gEfiLoadedImageProtocolGuid,
                       (VOID **)&LoadedImage);
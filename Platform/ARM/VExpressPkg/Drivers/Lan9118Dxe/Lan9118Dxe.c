@@ -36,6 +36,253 @@ LAN9118_DEVICE_PATH Lan9118PathTemplate =  {
   }
 };
 
+/*
+ *  Pop the frame at the head of the RX FIFO into Buffer.
+ *
+ *  The frame is read out of the RX data port in one burst of DWORDs, the
+ *  read-after-read delay of the port only applies before the next access to
+ *  another register. A frame received with an error is still read out, so
+ *  that the FIFO stays aligned on the next frame.
+ *
+ *  Buffer must be DWORD aligned, *BuffSize is updated with the length of the
+ *  frame. When Recover is FALSE a receiver error doesn't restart the
+ *  controller, the frame is dropped and EFI_NOT_READY is returned so that the
+ *  next SnpReceive () takes care of it.
+ */
+STATIC
+EFI_STATUS
+Lan9118ReadRxFifo (
+  IN      EFI_SIMPLE_NETWORK_PROTOCOL   *Snp,
+  OUT     UINT32                        *Buffer,
+  IN OUT  UINTN                         *BuffSize,
+  IN      BOOLEAN                       Recover
+  )
+{
+  LAN9118_DRIVER  *LanDriver;
+  UINT32          IntSts;
+  UINT32          RxFifoStatus;
+  UINT32          NumPackets;
+  UINT32          RxCfgValue;
+  UINT32          PLength; // Packet length
+  UINT32          ReadLimit;
+  UINT32          Count;
+  UINTN           DroppedFrames;
+  EFI_STATUS      Status;
+
+  LanDriver = INSTANCE_FROM_SNP_THIS (Snp);
+
+  //
+  // If the receiver raised the RXE error bit, check if the receiver status
+  // FIFO is full and if not just acknowledge the error. The two other
+  // conditions to get a RXE error are :
+  // . the RX data FIFO is read whereas being empty.
+  // . the RX status FIFO is read whereas being empty.
+  // The RX data and status FIFO are read by this driver only in the following
+  // code of this function. After the readings, the RXE error bit is checked
+  // and if raised, the controller is reset. Thus, at this point, we consider
+  // that the only valid reason to get an RXE error is the receiver status
+  // FIFO being full. And if this is not the case, we consider that this is
+  // a spurious error and we just get rid of it. We experienced such 'spurious'
+  // errors when running the driver on an A57 on Juno. No valid reason to
+  // explain those errors has been found so far and everything seems to
+  // work perfectly when they are just ignored.
+  //
+  IntSts = Lan9118MmioRead32 (LAN9118_INT_STS);
+  if ((IntSts & INSTS_RXE) && (!(IntSts & INSTS_RSFF))) {
+    Lan9118MmioWrite32 (LAN9118_INT_STS, INSTS_RXE);
+  }
+
+  // Count dropped frames
+  DroppedFrames = Lan9118MmioRead32 (LAN9118_RX_DROP);
+  LanDriver->Stats.RxDroppedFrames += DroppedFrames;
+
+  NumPackets = RxStatusUsedSpace (0, Snp) / 4;
+  if (!NumPackets) {
+    return EFI_NOT_READY;
+  }
+
+  // Check the buffer size before popping the status, the frame stays in the
+  // FIFO when it doesn't fit.
+  RxFifoStatus = Lan9118MmioRead32 (LAN9118_RX_STATUS_PEEK);
+  PLength = GET_RXSTATUS_PACKET_LENGTH (RxFifoStatus);
+  ReadLimit = (PLength + 3) / 4;
+  if (*BuffSize < ReadLimit * 4) {
+    *BuffSize = ReadLimit * 4;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+
+  // Pop the Rx Status
+  RxFifoStatus = Lan9118MmioRead32 (LAN9118_RX_STATUS);
+  LanDriver->Stats.RxTotalFrames += 1;
+
+  Status = EFI_SUCCESS;
+  if ((RxFifoStatus & RXSTATUS_MII_ERROR) ||
+      (RxFifoStatus & RXSTATUS_RXW_TO) ||
+      (RxFifoStatus & RXSTATUS_FTL) ||
+      (RxFifoStatus & RXSTATUS_LCOLL) ||
+      (RxFifoStatus & RXSTATUS_LE) ||
+      (RxFifoStatus & RXSTATUS_DB))
+  {
+    DEBUG ((EFI_D_WARN, "Warning: There was an error on frame reception.\n"));
+    LanDriver->Stats.RxDroppedFrames += 1;
+    Status = EFI_DEVICE_ERROR;
+  } else if (RxFifoStatus & RXSTATUS_CRC_ERROR) {
+    DEBUG ((EFI_D_WARN, "Warning: Crc Error\n"));
+    LanDriver->Stats.RxCrcErrorFrames += 1;
+    LanDriver->Stats.RxDroppedFrames += 1;
+    Status = EFI_DEVICE_ERROR;
+  } else if (RxFifoStatus & RXSTATUS_RUNT) {
+    DEBUG ((EFI_D_WARN, "Warning: Runt Frame\n"));
+    LanDriver->Stats.RxUndersizeFrames += 1;
+    LanDriver->Stats.RxDroppedFrames += 1;
+    Status = EFI_DEVICE_ERROR;
+  } else {
+    if (RxFifoStatus & RXSTATUS_FILT_FAIL) {
+      DEBUG ((EFI_D_WARN, "Warning: Frame Failed Filtering\n"));
+    }
+
+    if (RxFifoStatus & RXSTATUS_BCF) {
+      LanDriver->Stats.RxBroadcastFrames += 1;
+    } else if (RxFifoStatus & RXSTATUS_MCF) {
+      LanDriver->Stats.RxMulticastFrames += 1;
+    } else {
+      LanDriver->Stats.RxUnicastFrames += 1;
+    }
+    LanDriver->Stats.RxTotalBytes += (PLength - 4);
+  }
+
+  // Set the amount of data to be transferred out of FIFO for THIS packet
+  // This can be used to trigger an interrupt, and status can be checked
+  RxCfgValue = Lan9118MmioRead32 (LAN9118_RX_CFG);
+  RxCfgValue &= ~(RXCFG_RX_DMA_CNT_MASK);
+  RxCfgValue |= RXCFG_RX_DMA_CNT (ReadLimit);
+
+  // Set end alignment to 4-bytes
+  RxCfgValue &= ~(RXCFG_RX_END_ALIGN_MASK);
+  Lan9118MmioWrite32 (LAN9118_RX_CFG, RxCfgValue);
+
+  // Read the Rx Packet, only the last read needs the delay
+  for (Count = 0; Count + 1 < ReadLimit; Count++) {
+    Buffer[Count] = Lan9118RawMmioRead32 (LAN9118_RX_DATA, 0);
+  }
+  if (ReadLimit > 0) {
+    Buffer[Count] = Lan9118MmioRead32 (LAN9118_RX_DATA);
+  }
+
+  // Check for Rx errors (worst possible error)
+  if (Lan9118MmioRead32 (LAN9118_INT_STS) & INSTS_RXE) {
+    if (!Recover) {
+      return EFI_NOT_READY;
+    }
+
+    DEBUG ((EFI_D_WARN, "Warning: Receiver Error. Restarting...\n"));
+
+    // Software reset, the RXE interrupt is cleared by the reset.
+    Status = SoftReset (0, Snp);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((EFI_D_ERROR, "Error: Soft Reset Failed: Hardware Error.\n"));
+      return EFI_DEVICE_ERROR;
+    }
+
+    // Reactivate the LEDs
+    Status = ConfigureHardware (HW_CONF_USE_LEDS, Snp);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    //
+    // Restart the receiver and the transmitter without resetting the FIFOs
+    // as it has been done by SoftReset().
+    //
+    StartRx (0, Snp);
+    StartTx (START_TX_MAC | START_TX_CFG, Snp);
+
+    // Say that command could not be sent
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  // Update buffer size
+  *BuffSize = PLength; // -4 bytes may be needed: Received in buffer as
+                       // 4 bytes longer than packet actually is, unless
+                       // packet is < 64 bytes
+
+  LanDriver->Stats.RxGoodFrames += 1;
+
+  return EFI_SUCCESS;
+}
+
+/*
+ *  Drain the RX FIFO into the RX ring of the driver.
+ *
+ *  Runs periodically at LAN9118_TPL while the driver is initialized, so that
+ *  the FIFO doesn't overflow between two calls to SnpReceive () and so that
+ *  most of them only copy a frame from memory. The SNP services of the data
+ *  path raise to LAN9118_TPL, and Reset (), Shutdown () and Stop () cancel
+ *  the timer before touching the controller.
+ */
+STATIC
+VOID
+EFIAPI
+Lan9118RxPollNotify (
+  IN  EFI_EVENT   Event,
+  IN  VOID        *Context
+  )
+{
+  LAN9118_DRIVER  *LanDriver;
+  UINTN           Slot;
+  UINTN           Length;
+  EFI_STATUS      Status;
+
+  LanDriver = Context;
+  if (LanDriver->SnpMode.State != EfiSimpleNetworkInitialized) {
+    return;
+  }
+
+  while (LanDriver->RxRingCount < LAN9118_RX_RING_NUM_ENTRIES) {
+    Slot = (LanDriver->RxRingHead + LanDriver->RxRingCount) % LAN9118_RX_RING_NUM_ENTRIES;
+    Length = sizeof (LanDriver->RxRing[Slot]);
+    Status = Lan9118ReadRxFifo (&LanDriver->Snp, LanDriver->RxRing[Slot], &Length, FALSE);
+    if ((Status == EFI_NOT_READY) || (Status == EFI_BUFFER_TOO_SMALL)) {
+      break;
+    }
+    if (!EFI_ERROR (Status)) {
+      LanDriver->RxRingLength[Slot] = Length;
+      LanDriver->RxRingCount++;
+    }
+  }
+}
+
+/*
+ *  Arm or cancel the RX poll timer, canceling it drops the drained frames.
+ */
+STATIC
+VOID
+Lan9118SetRxPoll (
+  IN  LAN9118_DRIVER  *LanDriver,
+  IN  BOOLEAN         Enable
+  )
+{
+  if (LanDriver->RxPollEvent == NULL) {
+    return;
+  }
+
+  if (Enable) {
+    gBS->SetTimer (
+           LanDriver->RxPollEvent,
+           TimerPeriodic,
+           EFI_TIMER_PERIOD_MICROSECONDS (PcdGet32 (PcdLan9118RxPollInterval))
+           );
+  } else {
+    gBS->SetTimer (LanDriver->RxPollEvent, TimerCancel, 0);
+    LanDriver->RxRingHead = 0;
+    LanDriver->RxRingCount = 0;
+  }
+}
+
 /*
 **  Entry point for the LAN9118 driver
 **
@@ -148,6 +395,21 @@ Lan9118DxeEntry (
     return EFI_DEVICE_ERROR;
   }
 
+  // The RX poll timer is armed while the driver is initialized
+  if (PcdGet32 (PcdLan9118RxPollInterval) != 0) {
+    Status = gBS->CreateEvent (
+                    EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                    LAN9118_TPL,
+                    Lan9118RxPollNotify,
+                    LanDriver,
+                    &LanDriver->RxPollEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((EFI_D_WARN, "LAN9118: No RX poll timer: %r\n", Status));
+      LanDriver->RxPollEvent = NULL;
+    }
+  }
+
   // Assign fields for device path
   CopyMem (&Lan9118Path->Lan9118.MacAddress, &Snp->Mode->CurrentAddress, NET_ETHER_ADDR_LEN);
   Lan9118Path->Lan9118.IfType = Snp->Mode->IfType;
@@ -224,6 +486,8 @@ SnpStop (
     return EFI_NOT_STARTED;
   }
 
+  Lan9118SetRxPoll (INSTANCE_FROM_SNP_THIS (Snp), FALSE);
+
   // Stop the Tx and Rx
   StopTx (STOP_TX_CFG | STOP_TX_MAC, Snp);
   StopRx (0, Snp);
@@ -361,9 +625,13 @@ SnpInitialize (
   // Now acknowledge all interrupts
   Lan9118MmioWrite32 (LAN9118_INT_STS, ~0);
 
+  INSTANCE_FROM_SNP_THIS (Snp)->TxPending = 0;
+
   // Declare the driver as initialized
   Snp->Mode->State = EfiSimpleNetworkInitialized;
 
+  Lan9118SetRxPoll (INSTANCE_FROM_SNP_THIS (Snp), TRUE);
+
   return Status;
 }
 
@@ -401,6 +669,8 @@ SnpReset (
     return EFI_NOT_STARTED;
   }
 
+  Lan9118SetRxPoll (INSTANCE_FROM_SNP_THIS (Snp), FALSE);
+
   // Initiate a PHY reset
   Status = PhySoftReset (PHY_RESET_PMT, Snp);
   if (EFI_ERROR (Status)) {
@@ -454,6 +724,9 @@ SnpReset (
   // Now acknowledge all interrupts
   Lan9118MmioWrite32 (LAN9118_INT_STS, ~0);
 
+  INSTANCE_FROM_SNP_THIS (Snp)->TxPending = 0;
+  Lan9118SetRxPoll (INSTANCE_FROM_SNP_THIS (Snp), TRUE);
+
   return EFI_SUCCESS;
 }
 
@@ -483,6 +756,8 @@ SnpShutdown (
     return EFI_NOT_STARTED;
   }
 
+  Lan9118SetRxPoll (INSTANCE_FROM_SNP_THIS (Snp), FALSE);
+
   // Initiate a PHY reset
   Status = PhySoftReset (PHY_RESET_PMT, Snp);
   if (EFI_ERROR (Status)) {
@@ -954,12 +1229,12 @@ SnpNvData (
 
 
 /*
- *  UEFI GetStatus () function
+ *  GetStatus () at LAN9118_TPL
  *
  */
+STATIC
 EFI_STATUS
-EFIAPI
-SnpGetStatus (
+Lan9118GetStatus (
   IN   EFI_SIMPLE_NETWORK_PROTOCOL  *Snp,
   OUT  UINT32                       *IrqStat  OPTIONAL,
   OUT  VOID                         **TxBuff  OPTIONAL
@@ -1027,11 +1302,17 @@ SnpGetStatus (
   // Check Status of transmitted packets
   // (We ignore TXSTATUS_NO_CA has it might happen in Full Duplex)
 
+  // The status is only popped when the buffer can be handed back, otherwise
+  // the caller would never get it.
   NumTxStatusEntries = Lan9118MmioRead32(LAN9118_TX_FIFO_INF) & TXFIFOINF_TXSUSED_MASK;
-  if (NumTxStatusEntries > 0) {
+  if ((NumTxStatusEntries > 0) && (TxBuff != NULL)) {
     TxStatus = Lan9118MmioRead32 (LAN9118_TX_STATUS);
     PacketTag = TxStatus >> 16;
     TxStatus = TxStatus & 0xFFFF;
+    *TxBuff = LanDriver->TxRing[PacketTag % LAN9118_TX_RING_NUM_ENTRIES];
+    if (LanDriver->TxPending > 0) {
+      LanDriver->TxPending--;
+    }
     if ((TxStatus & TXSTATUS_ES) && (TxStatus != (TXSTATUS_ES | TXSTATUS_NO_CA))) {
       DEBUG ((EFI_D_ERROR, "LAN9118: There was an error transmitting. TxStatus=0x%08x:", TxStatus));
       if (TxStatus & TXSTATUS_NO_CA) {
@@ -1052,10 +1333,10 @@ SnpGetStatus (
       if (TxStatus & TXSTATUS_LOST_CA) {
         DEBUG ((EFI_D_ERROR, "- Lost carrier during Tx\n"));
       }
-      return EFI_DEVICE_ERROR;
-    } else if (TxBuff != NULL) {
+      // The frame is lost but its buffer is still recycled
+      LanDriver->Stats.TxDroppedFrames += 1;
+    } else {
       LanDriver->Stats.TxTotalFrames += 1;
-      *TxBuff = LanDriver->TxRing[PacketTag % LAN9118_TX_RING_NUM_ENTRIES];
     }
   } else if (TxBuff != NULL) {
     *TxBuff = NULL;
@@ -1073,6 +1354,9 @@ SnpGetStatus (
       return EFI_DEVICE_ERROR;
     }
 
+    // The reset flushed the TX FIFOs, with the status of the pending frames
+    LanDriver->TxPending = 0;
+
     // Reactivate the LEDs
     Status = ConfigureHardware (HW_CONF_USE_LEDS, Snp);
     if (EFI_ERROR (Status)) {
@@ -1101,14 +1385,36 @@ SnpGetStatus (
   return EFI_SUCCESS;
 }
 
-
 /*
- *  UEFI Transmit() function
+ *  UEFI GetStatus () function
  *
  */
 EFI_STATUS
 EFIAPI
-SnpTransmit (
+SnpGetStatus (
+  IN   EFI_SIMPLE_NETWORK_PROTOCOL  *Snp,
+  OUT  UINT32                       *IrqStat  OPTIONAL,
+  OUT  VOID                         **TxBuff  OPTIONAL
+  )
+{
+  EFI_TPL     SavedTpl;
+  EFI_STATUS  Status;
+
+  SavedTpl = gBS->RaiseTPL (LAN9118_TPL);
+  Status = Lan9118GetStatus (Snp, IrqStat, TxBuff);
+  gBS->RestoreTPL (SavedTpl);
+
+  return Status;
+}
+
+
+/*
+ *  Transmit() at LAN9118_TPL
+ *
+ */
+STATIC
+EFI_STATUS
+Lan9118Transmit (
   IN  EFI_SIMPLE_NETWORK_PROTOCOL  *Snp,
   IN  UINTN                        HdrSize,
   IN  UINTN                        BuffSize,
@@ -1188,6 +1494,11 @@ SnpTransmit (
     return EFI_NOT_READY;
   }
 
+  // The buffers not recycled by GetStatus yet must keep their TxRing slot
+  if (LanDriver->TxPending >= LAN9118_TX_RING_NUM_ENTRIES) {
+    return EFI_NOT_READY;
+  }
+
   // If DstAddr is not provided, get it from Buffer (we trust that the caller
   // has provided a well-formed frame).
   if (DstAddr == NULL) {
@@ -1281,6 +1592,7 @@ SnpTransmit (
   // it has been sent in GetStatus. When the packet tag appears in the Tx Status
   // Fifo, we will return Buffer in the TxBuff parameter of GetStatus.
   LanDriver->TxRing[PacketTag % LAN9118_TX_RING_NUM_ENTRIES] = Data;
+  LanDriver->TxPending++;
 
 #if defined(EVAL_PERFORMANCE)
   EndClock = GetPerformanceCounter ();
@@ -1292,6 +1604,32 @@ SnpTransmit (
   return EFI_SUCCESS;
 }
 
+/*
+ *  UEFI Transmit() function
+ *
+ */
+EFI_STATUS
+EFIAPI
+SnpTransmit (
+  IN  EFI_SIMPLE_NETWORK_PROTOCOL  *Snp,
+  IN  UINTN                        HdrSize,
+  IN  UINTN                        BuffSize,
+  IN  VOID*                        Data,
+  IN  EFI_MAC_ADDRESS              *SrcAddr  OPTIONAL,
+  IN  EFI_MAC_ADDRESS              *DstAddr  OPTIONAL,
+  IN  UINT16                       *Protocol OPTIONAL
+  )
+{
+  EFI_TPL     SavedTpl;
+  EFI_STATUS  Status;
+
+  SavedTpl = gBS->RaiseTPL (LAN9118_TPL);
+  Status = Lan9118Transmit (Snp, HdrSize, BuffSize, Data, SrcAddr, DstAddr, Protocol);
+  gBS->RestoreTPL (SavedTpl);
+
+  return Status;
+}
+
 
 /*
  *  UEFI Receive() function
@@ -1310,18 +1648,12 @@ SnpReceive (
   )
 {
   LAN9118_DRIVER  *LanDriver;
-  UINT32          IntSts;
-  UINT32          RxFifoStatus;
-  UINT32          NumPackets;
-  UINT32          RxCfgValue;
-  UINT32          PLength; // Packet length
-  UINT32          ReadLimit;
-  UINT32          Count;
-  UINT32          Padding;
+  UINTN           Slot;
+  UINTN           PLength; // Packet length
   UINT32          *RawData;
   EFI_MAC_ADDRESS Dst;
   EFI_MAC_ADDRESS Src;
-  UINTN           DroppedFrames;
+  EFI_TPL         SavedTpl;
   EFI_STATUS      Status;
 
   LanDriver = INSTANCE_FROM_SNP_THIS (Snp);
@@ -1345,134 +1677,37 @@ SnpReceive (
     return EFI_NOT_STARTED;
   }
 
+  SavedTpl = gBS->RaiseTPL (LAN9118_TPL);
+
   //
-  // If the receiver raised the RXE error bit, check if the receiver status
-  // FIFO is full and if not just acknowledge the error. The two other
-  // conditions to get a RXE error are :
-  // . the RX data FIFO is read whereas being empty.
-  // . the RX status FIFO is read whereas being empty.
-  // The RX data and status FIFO are read by this driver only in the following
-  // code of this function. After the readings, the RXE error bit is checked
-  // and if raised, the controller is reset. Thus, at this point, we consider
-  // that the only valid reason to get an RXE error is the receiver status
-  // FIFO being full. And if this is not the case, we consider that this is
-  // a spurious error and we just get rid of it. We experienced such 'spurious'
-  // errors when running the driver on an A57 on Juno. No valid reason to
-  // explain those errors has been found so far and everything seems to
-  // work perfectly when they are just ignored.
+  // The frames already drained by the poll timer come first, the FIFO is
+  // only read directly when there are none left.
   //
-  IntSts = Lan9118MmioRead32 (LAN9118_INT_STS);
-  if ((IntSts & INSTS_RXE) && (!(IntSts & INSTS_RSFF))) {
-    Lan9118MmioWrite32 (LAN9118_INT_STS, INSTS_RXE);
-  }
-
-  // Count dropped frames
-  DroppedFrames = Lan9118MmioRead32 (LAN9118_RX_DROP);
-  LanDriver->Stats.RxDroppedFrames += DroppedFrames;
-
-  NumPackets = RxStatusUsedSpace (0, Snp) / 4;
-  if (!NumPackets) {
-    return EFI_NOT_READY;
-  }
-
-  // Read Rx Status (only if not empty)
-  RxFifoStatus = Lan9118MmioRead32 (LAN9118_RX_STATUS);
-  LanDriver->Stats.RxTotalFrames += 1;
-
-  // First check for errors
-  if ((RxFifoStatus & RXSTATUS_MII_ERROR) ||
-      (RxFifoStatus & RXSTATUS_RXW_TO) ||
-      (RxFifoStatus & RXSTATUS_FTL) ||
-      (RxFifoStatus & RXSTATUS_LCOLL) ||
-      (RxFifoStatus & RXSTATUS_LE) ||
-      (RxFifoStatus & RXSTATUS_DB))
-  {
-    DEBUG ((EFI_D_WARN, "Warning: There was an error on frame reception.\n"));
-    return EFI_DEVICE_ERROR;
-  }
-
-  // Check if we got a CRC error
-  if (RxFifoStatus & RXSTATUS_CRC_ERROR) {
-    DEBUG ((EFI_D_WARN, "Warning: Crc Error\n"));
-    LanDriver->Stats.RxCrcErrorFrames += 1;
-    LanDriver->Stats.RxDroppedFrames += 1;
-    return EFI_DEVICE_ERROR;
-  }
-
-  // Check if we got a runt frame
-  if (RxFifoStatus & RXSTATUS_RUNT) {
-    DEBUG ((EFI_D_WARN, "Warning: Runt Frame\n"));
-    LanDriver->Stats.RxUndersizeFrames += 1;
-    LanDriver->Stats.RxDroppedFrames += 1;
-    return EFI_DEVICE_ERROR;
-  }
-
-  // Check filtering status for this packet
-  if (RxFifoStatus & RXSTATUS_FILT_FAIL) {
-    DEBUG ((EFI_D_WARN, "Warning: Frame Failed Filtering\n"));
-    // fast forward?
-  }
-
-  // Check if we got a broadcast frame
-  if (RxFifoStatus & RXSTATUS_BCF) {
-    LanDriver->Stats.RxBroadcastFrames += 1;
-  }
-
-  // Check if we got a multicast frame
-  if (RxFifoStatus & RXSTATUS_MCF) {
-    LanDriver->Stats.RxMulticastFrames += 1;
-  }
-
-  // Check if we got a unicast frame
-  if ((RxFifoStatus & RXSTATUS_BCF) && ((RxFifoStatus & RXSTATUS_MCF) == 0)) {
-    LanDriver->Stats.RxUnicastFrames += 1;
-  }
-
-  // Get the received packet length
-  PLength = GET_RXSTATUS_PACKET_LENGTH(RxFifoStatus);
-  LanDriver->Stats.RxTotalBytes += (PLength - 4);
-
-  // If padding is applied, read more DWORDs
-  if (PLength % 4) {
-    Padding = 4 - (PLength % 4);
-    ReadLimit = (PLength + Padding)/4;
+  if (LanDriver->RxRingCount > 0) {
+    Slot = LanDriver->RxRingHead;
+    PLength = LanDriver->RxRingLength[Slot];
+    if (*BuffSize < PLength) {
+      *BuffSize = PLength;
+      Status = EFI_BUFFER_TOO_SMALL;
+      goto ExitUnlock;
+    }
+    CopyMem (Data, LanDriver->RxRing[Slot], PLength);
+    *BuffSize = PLength;
+    LanDriver->RxRingHead = (Slot + 1) % LAN9118_RX_RING_NUM_ENTRIES;
+    LanDriver->RxRingCount--;
   } else {
-    ReadLimit = PLength/4;
-    Padding = 0;
-  }
-
-  // Check buffer size
-  if (*BuffSize < (PLength + Padding)) {
-    *BuffSize = PLength + Padding;
-    return EFI_BUFFER_TOO_SMALL;
+    Status = Lan9118ReadRxFifo (Snp, Data, BuffSize, TRUE);
+    if (EFI_ERROR (Status)) {
+      goto ExitUnlock;
+    }
   }
 
-  // Set the amount of data to be transferred out of FIFO for THIS packet
-  // This can be used to trigger an interrupt, and status can be checked
-  RxCfgValue = Lan9118MmioRead32 (LAN9118_RX_CFG);
-  RxCfgValue &= ~(RXCFG_RX_DMA_CNT_MASK);
-  RxCfgValue |= RXCFG_RX_DMA_CNT (ReadLimit);
-
-  // Set end alignment to 4-bytes
-  RxCfgValue &= ~(RXCFG_RX_END_ALIGN_MASK);
-  Lan9118MmioWrite32 (LAN9118_RX_CFG, RxCfgValue);
-
-  // Update buffer size
-  *BuffSize = PLength; // -4 bytes may be needed: Received in buffer as
-                       // 4 bytes longer than packet actually is, unless
-                       // packet is < 64 bytes
-
   if (HdrSize != NULL)
     *HdrSize = Snp->Mode->MediaHeaderSize;
 
   // Format the pointer
   RawData = (UINT32*)Data;
 
-  // Read Rx Packet
-  for (Count = 0; Count < ReadLimit; Count++) {
-    RawData[Count] = Lan9118MmioRead32 (LAN9118_RX_DATA);
-  }
-
   // Get the destination address
   if (DstAddr != NULL) {
     Dst.Addr[0] = (RawData[0] & 0xFF);
@@ -1500,40 +1735,14 @@ SnpReceive (
     *Protocol = NTOHS (RawData[3] & 0xFFFF);
   }
 
-  // Check for Rx errors (worst possible error)
-  if (Lan9118MmioRead32 (LAN9118_INT_STS) & INSTS_RXE) {
-    DEBUG ((EFI_D_WARN, "Warning: Receiver Error. Restarting...\n"));
-
-    // Software reset, the RXE interrupt is cleared by the reset.
-    Status = SoftReset (0, Snp);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((EFI_D_ERROR, "Error: Soft Reset Failed: Hardware Error.\n"));
-      return EFI_DEVICE_ERROR;
-    }
-
-    // Reactivate the LEDs
-    Status = ConfigureHardware (HW_CONF_USE_LEDS, Snp);
-    if (EFI_ERROR (Status)) {
-      return Status;
-    }
-
-    //
-    // Restart the receiver and the transmitter without resetting the FIFOs
-    // as it has been done by SoftReset().
-    //
-    StartRx (0, Snp);
-    StartTx (START_TX_MAC | START_TX_CFG, Snp);
-
-    // Say that command could not be sent
-    return EFI_DEVICE_ERROR;
-  }
-
 #if defined(EVAL_PERFORMANCE)
   UINT64 EndClock = GetPerformanceCounter ();
   DEBUG ((EFI_D_ERROR, "Receive Time processing: %d counts @ %d Hz\n", StartClock - EndClock,Perf));
 #endif
 
-  LanDriver->Stats.RxGoodFrames += 1;
+  Status = EFI_SUCCESS;
 
-  return EFI_SUCCESS;
+ExitUnlock:
+  gBS->RestoreTPL (SavedTpl);
+  return Status;
 }
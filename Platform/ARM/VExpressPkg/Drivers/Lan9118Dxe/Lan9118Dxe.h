@@ -51,6 +51,14 @@
 
 #define LAN9118_TX_RING_NUM_ENTRIES 32
 
+// Frames drained from the RX FIFO by the poll timer. A slot holds the largest
+// frame with its CRC, rounded up to a DWORD.
+#define LAN9118_RX_RING_NUM_ENTRIES 8
+#define LAN9118_RX_FRAME_SIZE       1536
+
+// Synchronization TPL of the data path with the RX poll timer
+#define LAN9118_TPL                 TPL_CALLBACK
+
 /*------------------------------------------------------------------------------
   LAN9118 Information Structure
 ------------------------------------------------------------------------------*/
@@ -69,7 +77,15 @@ typedef struct {
 
   // Saved transmitted buffers so we can notify consumers when packets have been sent.
   UINT16  NextPacketTag;
+  UINTN   TxPending;
   VOID    *TxRing[LAN9118_TX_RING_NUM_ENTRIES];
+
+  // Frames pre-drained from the RX FIFO, SnpReceive returns them first.
+  EFI_EVENT RxPollEvent;
+  UINTN     RxRingHead;
+  UINTN     RxRingCount;
+  UINTN     RxRingLength[LAN9118_RX_RING_NUM_ENTRIES];
+  UINT32    RxRing[LAN9118_RX_RING_NUM_ENTRIES][LAN9118_RX_FRAME_SIZE / 4];
 } LAN9118_DRIVER;
 
 #define LAN9118_SIGNATURE                       SIGNATURE_32('l', 'a', 'n', '9')
@@ -53,6 +53,8 @@
   LAN91x Information Structure
 
 ---------------------------------------------------------------------------------------------------------------------*/
+#define LAN91X_TX_RING_NUM_ENTRIES  32
+
 typedef struct _LAN91X_DRIVER {
   // Driver signature
   UINT32            Signature;
@@ -65,9 +67,11 @@ typedef struct _LAN91X_DRIVER {
   // EFI Snp statistics instance
   EFI_NETWORK_STATISTICS Stats;
 
-  // Transmit Buffer recycle queue
-
-  LIST_ENTRY TransmitQueueHead;
+  // Transmit Buffer recycle ring. The frames are copied to the chip memory,
+  // the buffers only wait here for GetStatus() to hand them back.
+  VOID              *TxRing[LAN91X_TX_RING_NUM_ENTRIES];
+  UINTN             TxRingHead;
+  UINTN             TxRingCount;
 
   // Register access variables
   UINTN             IoBase;             // I/O Base Address
@@ -136,21 +140,6 @@ STATIC CHAR16 CONST * CONST ChipIds[ 16 ] =  {
   NULL, NULL, NULL
 };
 
-/* ------------------ TxBuffer Queue structures ------------------- */
-
-typedef struct {
-  VOID            *Buf;
-  UINTN           Length;
-} MSK_SYSTEM_BUF;
-
-typedef struct {
-  UINTN           Signature;
-  LIST_ENTRY      Link;
-  MSK_SYSTEM_BUF  SystemBuf;
-} MSK_LINKED_SYSTEM_BUF;
-
-#define TX_MBUF_SIGNATURE  SIGNATURE_32 ('t','x','m','b')
-
 /* ------------------ MAC Address Hash Calculations ------------------- */
 
 /*
@@ -767,11 +756,20 @@ ReadIoData (
   )
 {
   UINT8     *Ptr;
+  UINTN     DataReg;
+
+  // Move 16-bit words straight through the DATA register, the bank doesn't
+  // change during the transfer.
+  SelectIoBank (LanDriver, LAN91X_DATA0);
+  DataReg = LanDriver->IoBase + RegisterToOffset (LAN91X_DATA0);
 
   Ptr = Buffer;
-  for (; BufLen > 0; --BufLen) {
-    *Ptr = ReadIoReg8 (LanDriver, LAN91X_DATA0);
-    ++Ptr;
+  for (; BufLen > 1; BufLen -= 2) {
+    WriteUnaligned16 ((UINT16 *)Ptr, MmioRead16 (DataReg));
+    Ptr += 2;
+  }
+  if (BufLen > 0) {
+    *Ptr = MmioRead8 (DataReg);
   }
 
   return EFI_SUCCESS;
@@ -787,11 +785,20 @@ WriteIoData (
   )
 {
   UINT8     *Ptr;
+  UINTN     DataReg;
+
+  // Move 16-bit words straight through the DATA register, the bank doesn't
+  // change during the transfer.
+  SelectIoBank (LanDriver, LAN91X_DATA0);
+  DataReg = LanDriver->IoBase + RegisterToOffset (LAN91X_DATA0);
 
   Ptr = Buffer;
-  for (; BufLen > 0; --BufLen) {
-    WriteIoReg8 (LanDriver, LAN91X_DATA0, *Ptr);
-    ++Ptr;
+  for (; BufLen > 1; BufLen -= 2) {
+    MmioWrite16 (DataReg, ReadUnaligned16 ((UINT16 *)Ptr));
+    Ptr += 2;
+  }
+  if (BufLen > 0) {
+    MmioWrite8 (DataReg, *Ptr);
   }
 
   return EFI_SUCCESS;
@@ -1620,7 +1627,6 @@ SnpGetStatus (
   EFI_STATUS            Status;
   BOOLEAN               MediaPresent;
   UINT8                 IstReg;
-  MSK_LINKED_SYSTEM_BUF *LinkedTXRecycleBuff;
 
   // Check preliminaries
   if (Snp == NULL) {
@@ -1664,15 +1670,11 @@ SnpGetStatus (
   // Pass back the completed buffer address
   // The transmit buffer status is not read when TxBuf is NULL
   if (TxBuff != NULL) {
-    *((UINT8 **) TxBuff) = (UINT8 *) 0;
-    if( !IsListEmpty (&LanDriver->TransmitQueueHead))
-    {
-      LinkedTXRecycleBuff = CR (GetFirstNode (&LanDriver->TransmitQueueHead), MSK_LINKED_SYSTEM_BUF, Link, TX_MBUF_SIGNATURE);
-      if(LinkedTXRecycleBuff != NULL) {
-        *TxBuff = LinkedTXRecycleBuff->SystemBuf.Buf;
-        RemoveEntryList (&LinkedTXRecycleBuff->Link);
-        FreePool (LinkedTXRecycleBuff);
-      }
+    *TxBuff = NULL;
+    if (LanDriver->TxRingCount > 0) {
+      *TxBuff = LanDriver->TxRing[LanDriver->TxRingHead];
+      LanDriver->TxRingHead = (LanDriver->TxRingHead + 1) % LAN91X_TX_RING_NUM_ENTRIES;
+      LanDriver->TxRingCount--;
     }
   }
 
@@ -1716,8 +1718,6 @@ SnpTransmit (
   UINTN            Retries;
   UINT16           Proto;
   UINT8            PktNum;
-  MSK_LINKED_SYSTEM_BUF   *LinkedTXRecycleBuff;
-
 
   // Check preliminaries
   if ((Snp == NULL) || (BufAddr == NULL)) {
@@ -1768,6 +1768,11 @@ SnpTransmit (
     ReturnUnlock (EFI_NOT_READY);
   }
 
+  // The buffer must fit in the recycle ring, GetStatus() empties it
+  if (LanDriver->TxRingCount == LAN91X_TX_RING_NUM_ENTRIES) {
+    ReturnUnlock (EFI_NOT_READY);
+  }
+
   // Calculate the request size in 256-byte "pages" minus 1
   // The 91C111 ignores this, but some older devices need it.
   MmuPages = ((BufSize & ~1) + LAN91X_PKT_OVERHEAD - 1) >> 8;
@@ -1872,18 +1877,9 @@ SnpTransmit (
   LanDriver->Stats.TxTotalBytes += BufSize;
   LanDriver->Stats.TxGoodFrames += 1;
 
-  // Update the Tx Buffer cache
-  LinkedTXRecycleBuff = AllocateZeroPool (sizeof (MSK_LINKED_SYSTEM_BUF));
-  if (LinkedTXRecycleBuff == NULL) {
-    return EFI_OUT_OF_RESOURCES;
-  }
-  LinkedTXRecycleBuff->Signature = TX_MBUF_SIGNATURE;
-  //
-  // Add the passed Buffer to the transmit queue. Don't copy.
-  //
-  LinkedTXRecycleBuff->SystemBuf.Buf = BufAddr;
-  LinkedTXRecycleBuff->SystemBuf.Length = BufSize;
-  InsertTailList (&LanDriver->TransmitQueueHead, &LinkedTXRecycleBuff->Link);
+  // Queue the passed Buffer for recycling. Don't copy.
+  LanDriver->TxRing[(LanDriver->TxRingHead + LanDriver->TxRingCount) % LAN91X_TX_RING_NUM_ENTRIES] = BufAddr;
+  LanDriver->TxRingCount++;
 
   Status = EFI_SUCCESS;
 
@@ -2044,8 +2040,9 @@ SnpReceive (
     DEBUG ((DEBUG_WARN, "LAN91x: Receive buffer too small for packet (%d < %d)\n",
         *BuffSize, PktLength));
     *BuffSize = PktLength;
-    Status = EFI_BUFFER_TOO_SMALL;
-    goto exit_release;
+
+    // Keep the frame in the FIFO for the retry with a larger buffer
+    ReturnUnlock (EFI_BUFFER_TOO_SMALL);
   }
 
   // Transfer the data bytes
@@ -2155,9 +2152,6 @@ Lan91xDxeEntry (
   PrintPhyRegisters (LanDriver);
 #endif
 
-  // Initialize transmit queue
-  InitializeListHead (&LanDriver->TransmitQueueHead);
-
   // Assign fields and func pointers
   Snp->Revision = EFI_SIMPLE_NETWORK_PROTOCOL_REVISION;
   Snp->WaitForPacket = NULL;
@@ -13,7 +13,8 @@
 #define CHUNK_TYPE_DONT_CARE      0xCAC3
 #define CHUNK_TYPE_CRC32          0xCAC4
 
-#define PARTITION_NAME_MAX_LENGTH     72/2
+// Largest request issued to the block device at once
+#define PARTITION_IO_CHUNK_SIZE       SIZE_4MB
 
 #define FLASH_DEVICE_PATH_SIZE(DevPath) ( GetDevicePathSize (DevPath) - \
     sizeof (EFI_DEVICE_PATH_PROTOCOL))
@@ -23,7 +24,7 @@
 
 typedef struct _DISKIO_PARTITION_LIST {
   LIST_ENTRY  Link;
-  CHAR16      PartitionName[PARTITION_NAME_MAX_LENGTH];
+  CHAR16      *PartitionName;   // Text of the device path of the handle
   EFI_HANDLE  PartitionHandle;
 } DISKIO_PARTITION_LIST;
 
@@ -46,8 +47,44 @@ typedef struct _CHUNK_HEADER {
   UINT32    TotalSize;
 } CHUNK_HEADER;
 
-STATIC LIST_ENTRY       mPartitionListHead;
-STATIC EFI_SIMPLE_TEXT_OUTPUT_PROTOCOL  *mTextOut;
+typedef struct _PARTITION {
+  EFI_BLOCK_IO_PROTOCOL     *BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL    *BlockIo2;  // NULL when not installed
+  UINT32                    MediaId;
+  UINT32                    BlockSize;
+  UINT32                    IoAlign;
+  UINT64                    Size;
+  UINT8                     *Block;     // One block, for unaligned head and tail
+  UINT8                     *Bounce;    // One chunk, for misaligned buffers
+} PARTITION;
+
+typedef enum {
+  PartitionStreamMagic,       // Collecting the start of the image
+  PartitionStreamRaw,         // Plain image, written as it arrives
+  PartitionStreamSkip,        // Skipping header padding or chunk data
+  PartitionStreamChunkHeader, // Collecting a sparse chunk header
+  PartitionStreamChunkData,   // Writing the data of a raw sparse chunk
+  PartitionStreamDone         // All sparse chunks written
+} PARTITION_STREAM_STATE;
+
+struct _PARTITION_STREAM {
+  PARTITION                 Partition;
+  PARTITION_STREAM_STATE    State;
+  UINT64                    Offset;       // Partition offset of the next write
+  UINT64                    Remaining;    // Bytes left to skip or write
+  UINT32                    Chunk;
+  UINTN                     ChunkPrintDensity;
+  UINTN                     HeaderLength; // Bytes collected of the current header
+  SPARSE_HEADER             SparseHeader;
+  CHUNK_HEADER              ChunkHeader;
+  UINT8                     *Buffer;      // Data not yet written to the partition
+  UINT64                    BufferOffset; // Partition offset of Buffer
+  UINTN                     BufferLength;
+};
+
+// Every Block IO handle by device path, built once and kept for the boot
+STATIC LIST_ENTRY       mPartitionListHead = \
+  INITIALIZE_LIST_HEAD_VARIABLE (mPartitionListHead);
 
 /*
  * Helper to free the partition list
@@ -67,6 +104,7 @@ FreePartitionList (
       &mPartitionListHead, &Entry->Link);
 
     RemoveEntryList (&Entry->Link);
+    FreePool (Entry->PartitionName);
     FreePool (Entry);
 
     Entry = NextEntry;
@@ -74,12 +112,12 @@ FreePartitionList (
 }
 
 /*
- * lists the available Block Io and adds handle of given dev path
+ * lists the available Block Io and adds the handle of each dev path
  */
 STATIC
 EFI_STATUS
 ListBlockIos (
-  IN CHAR16       *PartitionName
+  VOID
   )
 {
   EFI_STATUS                        Status;
@@ -90,16 +128,15 @@ ListBlockIos (
   UINTN                             NumHandles;
   UINT16                            *DeviceFullPath;
   DISKIO_PARTITION_LIST             *Entry;
-  RETURN_STATUS                     RetStatus;
-
-  InitializeListHead (&mPartitionListHead);
 
   Status = gBS->LocateProtocol (
     &gEfiDevicePathToTextProtocolGuid,
     NULL,
     (VOID **) &DevPathToText
     );
-  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
   // Get every Block IO protocol instance installed in the system
   Status = gBS->LocateHandleBuffer (
@@ -109,10 +146,11 @@ ListBlockIos (
     &NumHandles,
     &AllHandles
     );
-  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
   DEBUG ((DEBUG_INFO, "Block IO: %d handles \n", NumHandles));
 
-  // Get HTTP driver handle from AllHandles
   for (LoopIndex = 0; LoopIndex < NumHandles; LoopIndex++) {
     // Get the device path for the handle
     Status = gBS->OpenProtocol (
@@ -123,81 +161,149 @@ ListBlockIos (
       NULL,
       EFI_OPEN_PROTOCOL_GET_PROTOCOL
       );
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
 
     DeviceFullPath = DevPathToText->ConvertDevicePathToText (
       DevicePath,
       FALSE,
       TRUE
       );
+    if (DeviceFullPath == NULL) {
+      continue;
+    }
 
     DEBUG((DEBUG_INFO,"Handle[%d] is %p, fullpath %s\n", \
       LoopIndex, AllHandles[LoopIndex], DeviceFullPath));
 
-    if (StrCmp (PartitionName, DeviceFullPath) == 0) {
-      DEBUG((DEBUG_INFO, "rootfs partition path matched\n"));
-      //
-      // Add the partition handle to the list
-      //
-      // Create entry
-      Entry = AllocatePool (sizeof (DISKIO_PARTITION_LIST));
-      if (Entry == NULL) {
-        Status = EFI_OUT_OF_RESOURCES;
-        goto Exit;
-      }
-
-      // Copy handle and partition name
-      Entry->PartitionHandle = AllHandles[LoopIndex];
-      RetStatus = StrnCpyS (
-        Entry->PartitionName,
-        PARTITION_NAME_MAX_LENGTH,
-        PartitionName,
-        PARTITION_NAME_MAX_LENGTH - 1
-      );
-      ASSERT_RETURN_ERROR (RetStatus);
-      InsertTailList (&mPartitionListHead, &Entry->Link);
+    // Create entry, it keeps the device path text
+    Entry = AllocatePool (sizeof (DISKIO_PARTITION_LIST));
+    if (Entry == NULL) {
+      FreePool (DeviceFullPath);
+      Status = EFI_OUT_OF_RESOURCES;
       break;
     }
+
+    Entry->PartitionHandle = AllHandles[LoopIndex];
+    Entry->PartitionName   = DeviceFullPath;
+    InsertTailList (&mPartitionListHead, &Entry->Link);
   }
   FreePool (AllHandles);
-  ASSERT (LoopIndex < NumHandles);
-Exit:
-  return Status;
+
+  if (EFI_ERROR (Status)) {
+    FreePartitionList ();
+    return Status;
+  }
+  return EFI_SUCCESS;
+}
+
+/*
+ * Finds the Block IO handle of a partition in the list of Block IOs
+ */
+STATIC
+EFI_HANDLE
+FindPartition (
+  IN CHAR16       *PartitionName
+  )
+{
+  DISKIO_PARTITION_LIST   *Entry;
+
+  for (Entry = (DISKIO_PARTITION_LIST *)GetFirstNode (&mPartitionListHead);
+       !IsNull (&mPartitionListHead, &Entry->Link);
+       Entry = (DISKIO_PARTITION_LIST *)GetNextNode (&mPartitionListHead, &Entry->Link)) {
+    if (StrCmp (PartitionName, Entry->PartitionName) == 0) {
+      DEBUG((DEBUG_INFO, "rootfs partition path matched\n"));
+      return Entry->PartitionHandle;
+    }
+  }
+
+  return NULL;
+}
+
+/*
+ * Looks a partition up, listing the Block IOs on first use. The list is
+ * only built again when the partition is not in it, e.g. because its
+ * device was connected after the list was made.
+ */
+STATIC
+EFI_STATUS
+LookupPartition (
+  IN  CHAR16      *PartitionName,
+  OUT EFI_HANDLE  *Handle
+  )
+{
+  EFI_STATUS      Status;
+
+  if (!IsListEmpty (&mPartitionListHead)) {
+    *Handle = FindPartition (PartitionName);
+    if (*Handle != NULL) {
+      return EFI_SUCCESS;
+    }
+    FreePartitionList ();
+  }
+
+  Status = ListBlockIos ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  *Handle = FindPartition (PartitionName);
+  if (*Handle == NULL) {
+    DEBUG ((DEBUG_ERROR, "Partition %s not found\n", PartitionName));
+    return EFI_NOT_FOUND;
+  }
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+ClosePartition (
+  IN PARTITION    *Partition
+  )
+{
+  if (Partition->Block != NULL) {
+    FreeAlignedPages (Partition->Block, EFI_SIZE_TO_PAGES (Partition->BlockSize));
+    Partition->Block = NULL;
+  }
+  if (Partition->Bounce != NULL) {
+    FreeAlignedPages (Partition->Bounce, EFI_SIZE_TO_PAGES (PARTITION_IO_CHUNK_SIZE));
+    Partition->Bounce = NULL;
+  }
 }
 
 STATIC
 EFI_STATUS
 OpenPartition (
   IN  CHAR8       *PartitionName,
-  IN  VOID        *Image,
-  IN  UINTN       Size,
-  OUT EFI_BLOCK_IO_PROTOCOL     **BlockIo,
-  OUT EFI_DISK_IO_PROTOCOL      **DiskIo
+  IN  UINT64      Size,
+  OUT PARTITION   *Partition
   )
 {
   EFI_STATUS               Status;
-  UINTN                    PartitionSize;
-  DISKIO_PARTITION_LIST    *Entry;
-  SPARSE_HEADER            *SparseHeader;
+  EFI_HANDLE               Handle;
+  EFI_BLOCK_IO_MEDIA       *Media;
   UINT16                   UnicodePartitionName[100];
   RETURN_STATUS            RetStatus;
 
+  ZeroMem (Partition, sizeof (PARTITION));
+
   RetStatus = AsciiStrToUnicodeStrS (PartitionName, UnicodePartitionName,
-                sizeof (UnicodePartitionName));
+                ARRAY_SIZE (UnicodePartitionName));
   if (RETURN_ERROR (RetStatus)) {
     return EFI_OUT_OF_RESOURCES;
   }
   DEBUG((DEBUG_INFO, "Unicode partition name %s\n", UnicodePartitionName));
 
-  Status = ListBlockIos (UnicodePartitionName);
-  ASSERT_EFI_ERROR (Status);
-
-  Entry = (DISKIO_PARTITION_LIST *)GetFirstNode (&(mPartitionListHead));
-  ASSERT (Entry != NULL);
+  Status = LookupPartition (UnicodePartitionName, &Handle);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
   Status = gBS->OpenProtocol (
-    Entry->PartitionHandle,
+    Handle,
     &gEfiBlockIoProtocolGuid,
-    (VOID **) BlockIo,
+    (VOID **) &Partition->BlockIo,
     gImageHandle,
     NULL,
     EFI_OPEN_PROTOCOL_GET_PROTOCOL
@@ -205,54 +311,212 @@ OpenPartition (
 
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Unable to open Block IO protocol: %r\n", Status));
-    Status = EFI_NOT_FOUND;
-    goto Exit;
-  }
-
-  SparseHeader = (SPARSE_HEADER *)Image;
-
-  if (SparseHeader->Magic == SPARSE_HEADER_MAGIC) {
-    DEBUG ((DEBUG_INFO, \
-      "Sparse Magic: 0x%x Major: %d Minor: %d fhs: %d chs: %d bs: %d tbs: %d tcs: %d checksum: %d \n", \
-      SparseHeader->Magic, SparseHeader->MajorVersion, \
-      SparseHeader->MinorVersion,  SparseHeader->FileHeaderSize, \
-      SparseHeader->ChunkHeaderSize, SparseHeader->BlockSize, \
-      SparseHeader->TotalBlocks, \
-      SparseHeader->TotalChunks, SparseHeader->ImageChecksum));
-
-    if (SparseHeader->MajorVersion != 1) {
-      DEBUG ((DEBUG_ERROR, "Sparse image version %d.%d not supported.\n",
-            SparseHeader->MajorVersion, SparseHeader->MinorVersion));
-      Status = EFI_INVALID_PARAMETER;
-      goto Exit;
-    }
+    return EFI_NOT_FOUND;
+  }
 
-    Size = SparseHeader->BlockSize * SparseHeader->TotalBlocks;
+  // Block IO 2 is optional, requests go through Block IO without it
+  Status = gBS->OpenProtocol (
+    Handle,
+    &gEfiBlockIo2ProtocolGuid,
+    (VOID **) &Partition->BlockIo2,
+    gImageHandle,
+    NULL,
+    EFI_OPEN_PROTOCOL_GET_PROTOCOL
+    );
+  if (EFI_ERROR (Status)) {
+    Partition->BlockIo2 = NULL;
   }
 
+  Media = Partition->BlockIo->Media;
+  Partition->MediaId   = Media->MediaId;
+  Partition->BlockSize = Media->BlockSize;
+  Partition->IoAlign   = MAX (Media->IoAlign, EFI_PAGE_SIZE);
+  Partition->Size      = MultU64x32 (Media->LastBlock + 1, Media->BlockSize);
+
   // Check image will fit on device
-  PartitionSize = (BlockIo[0]->Media->LastBlock + 1) * BlockIo[0]->Media->BlockSize;
-  if (PartitionSize < Size) {
+  if (Partition->Size < Size) {
     DEBUG ((DEBUG_ERROR, "Partition not big enough.\n"));
     DEBUG ((DEBUG_ERROR, \
-      "Partition Size:\t%ld\nImage Size:\t%ld\n", PartitionSize, Size));
-
-    Status = EFI_VOLUME_FULL;
-    goto Exit;
+      "Partition Size:\t%ld\nImage Size:\t%ld\n", Partition->Size, Size));
+    return EFI_VOLUME_FULL;
   }
 
-  Status = gBS->OpenProtocol (
-    Entry->PartitionHandle,
-    &gEfiDiskIoProtocolGuid,
-    (VOID **) DiskIo,
-    gImageHandle,
-    NULL,
-    EFI_OPEN_PROTOCOL_GET_PROTOCOL
+  Partition->Block = AllocateAlignedPages (
+    EFI_SIZE_TO_PAGES (Partition->BlockSize),
+    Partition->IoAlign
     );
+  if (Partition->Block == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
 
-Exit:
-  FreePartitionList ();
-  return Status;
+  return EFI_SUCCESS;
+}
+
+/*
+ * Reads or writes whole blocks. Buffer must meet the IoAlign of the media.
+ */
+STATIC
+EFI_STATUS
+PartitionBlocks (
+  IN     PARTITION  *Partition,
+  IN     BOOLEAN    Write,
+  IN     EFI_LBA    Lba,
+  IN     UINTN      Size,
+  IN OUT VOID       *Buffer
+  )
+{
+  EFI_BLOCK_IO2_TOKEN   Token;
+
+  if (Partition->BlockIo2 != NULL) {
+    // A token without an event makes the request blocking
+    ZeroMem (&Token, sizeof (Token));
+    if (Write) {
+      return Partition->BlockIo2->WriteBlocksEx (Partition->BlockIo2, \
+        Partition->MediaId, Lba, &Token, Size, Buffer);
+    }
+    return Partition->BlockIo2->ReadBlocksEx (Partition->BlockIo2, \
+      Partition->MediaId, Lba, &Token, Size, Buffer);
+  }
+
+  if (Write) {
+    return Partition->BlockIo->WriteBlocks (Partition->BlockIo, \
+      Partition->MediaId, Lba, Size, Buffer);
+  }
+  return Partition->BlockIo->ReadBlocks (Partition->BlockIo, \
+    Partition->MediaId, Lba, Size, Buffer);
+}
+
+/*
+ * Reads or writes the part of a block at BlockOffset, which is read first
+ * so that a write keeps the rest of the block.
+ */
+STATIC
+EFI_STATUS
+PartitionPartialBlock (
+  IN     PARTITION  *Partition,
+  IN     BOOLEAN    Write,
+  IN     EFI_LBA    Lba,
+  IN     UINTN      BlockOffset,
+  IN     UINTN      Size,
+  IN OUT UINT8      *Buffer
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = PartitionBlocks (Partition, FALSE, Lba, Partition->BlockSize, \
+    Partition->Block);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (!Write) {
+    CopyMem (Buffer, Partition->Block + BlockOffset, Size);
+    return EFI_SUCCESS;
+  }
+
+  CopyMem (Partition->Block + BlockOffset, Buffer, Size);
+  return PartitionBlocks (Partition, TRUE, Lba, Partition->BlockSize, \
+    Partition->Block);
+}
+
+/*
+ * Reads or writes Size bytes at any partition offset. Whole blocks go to
+ * the device in chunks of up to PARTITION_IO_CHUNK_SIZE, only the unaligned
+ * head and tail blocks are read-modify-written.
+ */
+STATIC
+EFI_STATUS
+PartitionTransfer (
+  IN     PARTITION  *Partition,
+  IN     BOOLEAN    Write,
+  IN     UINT64     Offset,
+  IN     UINTN      Size,
+  IN OUT VOID       *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Ptr;
+  EFI_LBA     Lba;
+  UINT32      BlockOffset;
+  UINTN       Count;
+
+  if (Offset > Partition->Size || Size > Partition->Size - Offset) {
+    DEBUG ((DEBUG_ERROR, "Partition access beyond its end at %ld\n", Offset));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Ptr = Buffer;
+  Lba = DivU64x32Remainder (Offset, Partition->BlockSize, &BlockOffset);
+
+  // Unaligned head, or a transfer within a single block
+  if (BlockOffset != 0 || (Size > 0 && Size < Partition->BlockSize)) {
+    Count = MIN (Partition->BlockSize - BlockOffset, Size);
+    Status = PartitionPartialBlock (Partition, Write, Lba, BlockOffset, \
+      Count, Ptr);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    Lba++;
+    Ptr  += Count;
+    Size -= Count;
+  }
+
+  // Whole blocks
+  while (Size >= Partition->BlockSize) {
+    Count = MIN (Size, PARTITION_IO_CHUNK_SIZE);
+    Count -= Count % Partition->BlockSize;
+
+    if (((UINTN)Ptr & (Partition->IoAlign - 1)) == 0) {
+      Status = PartitionBlocks (Partition, Write, Lba, Count, Ptr);
+    } else {
+      // Misaligned caller buffer, go through the bounce buffer
+      if (Partition->Bounce == NULL) {
+        Partition->Bounce = AllocateAlignedPages (
+          EFI_SIZE_TO_PAGES (PARTITION_IO_CHUNK_SIZE),
+          Partition->IoAlign
+          );
+        if (Partition->Bounce == NULL) {
+          return EFI_OUT_OF_RESOURCES;
+        }
+      }
+      if (Write) {
+        CopyMem (Partition->Bounce, Ptr, Count);
+      }
+      Status = PartitionBlocks (Partition, Write, Lba, Count, Partition->Bounce);
+      if (!Write && !EFI_ERROR (Status)) {
+        CopyMem (Ptr, Partition->Bounce, Count);
+      }
+    }
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Lba  += Count / Partition->BlockSize;
+    Ptr  += Count;
+    Size -= Count;
+  }
+
+  // Unaligned tail
+  if (Size > 0) {
+    return PartitionPartialBlock (Partition, Write, Lba, 0, Size, Ptr);
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+PartitionFlush (
+  IN PARTITION    *Partition
+  )
+{
+  EFI_BLOCK_IO2_TOKEN   Token;
+
+  if (Partition->BlockIo2 != NULL) {
+    ZeroMem (&Token, sizeof (Token));
+    return Partition->BlockIo2->FlushBlocksEx (Partition->BlockIo2, &Token);
+  }
+  return Partition->BlockIo->FlushBlocks (Partition->BlockIo);
 }
 
 EFI_STATUS
@@ -263,116 +527,446 @@ PartitionRead (
   )
 {
   EFI_STATUS               Status;
-  EFI_BLOCK_IO_PROTOCOL    *BlockIo;
-  EFI_DISK_IO_PROTOCOL     *DiskIo;
-  UINT32                   MediaId;
+  PARTITION                Partition;
 
-  Status = OpenPartition (PartitionName, Image, Size, &BlockIo, &DiskIo);
-  if (EFI_ERROR (Status)) {
-    goto Exit;
+  Status = OpenPartition (PartitionName, Size, &Partition);
+  if (!EFI_ERROR (Status)) {
+    Status = PartitionTransfer (&Partition, FALSE, 0, Size, Image);
   }
 
-  MediaId = BlockIo->Media->MediaId;
+  ClosePartition (&Partition);
+  return Status;
+}
 
-  Status = DiskIo->ReadDisk (DiskIo, MediaId, 0, Size, Image);
-  if (EFI_ERROR (Status)) {
-    goto Exit;
+/*
+ * Collects the bytes of a header that may be split across writes.
+ * Returns TRUE once HeaderSize bytes are in Header.
+ */
+STATIC
+BOOLEAN
+PartitionStreamCollect (
+  IN OUT  PARTITION_STREAM  *Stream,
+  OUT     VOID              *Header,
+  IN      UINTN             HeaderSize,
+  IN OUT  UINT8             **Data,
+  IN OUT  UINTN             *Length
+  )
+{
+  UINTN   Count;
+
+  Count = MIN (HeaderSize - Stream->HeaderLength, *Length);
+  CopyMem ((UINT8 *)Header + Stream->HeaderLength, *Data, Count);
+  Stream->HeaderLength += Count;
+  *Data   += Count;
+  *Length -= Count;
+
+  if (Stream->HeaderLength < HeaderSize) {
+    return FALSE;
   }
 
-  BlockIo->FlushBlocks(BlockIo);
+  Stream->HeaderLength = 0;
+  return TRUE;
+}
+
+STATIC
+VOID
+PartitionStreamEndChunk (
+  IN OUT  PARTITION_STREAM  *Stream
+  )
+{
+  CHAR16  OutputString[64];
+
+  if (Stream->Chunk < Stream->SparseHeader.TotalChunks) {
+    Stream->State = PartitionStreamChunkHeader;
+    return;
+  }
+
+  UnicodeSPrint (OutputString, sizeof (OutputString),
+      L"\r%5d / %5d chunks written (100%%)\r\n",
+      Stream->SparseHeader.TotalChunks, Stream->SparseHeader.TotalChunks);
+  gST->ConOut->OutputString (gST->ConOut, OutputString);
+
+  Stream->State = PartitionStreamDone;
+}
+
+STATIC
+VOID
+PartitionStreamSkip (
+  IN OUT  PARTITION_STREAM  *Stream,
+  IN      UINT64            Count
+  )
+{
+  if (Count == 0) {
+    PartitionStreamEndChunk (Stream);
+    return;
+  }
 
-Exit:
+  Stream->Remaining = Count;
+  Stream->State     = PartitionStreamSkip;
+}
+
+/*
+ * Writes the buffered data out to the partition.
+ */
+STATIC
+EFI_STATUS
+PartitionStreamFlush (
+  IN OUT  PARTITION_STREAM  *Stream
+  )
+{
+  EFI_STATUS  Status;
+
+  if (Stream->BufferLength == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Status = PartitionTransfer (&Stream->Partition, TRUE, Stream->BufferOffset, \
+    Stream->BufferLength, Stream->Buffer);
+  Stream->BufferOffset += Stream->BufferLength;
+  Stream->BufferLength  = 0;
   return Status;
 }
 
+/*
+ * Writes Length bytes at the stream offset. The data is gathered in the
+ * stream buffer so that the partition sees large block-aligned writes.
+ */
+STATIC
 EFI_STATUS
-PartitionWrite (
-  IN CHAR8  *PartitionName,
-  IN VOID   *Image,
-  IN UINTN  Size
+PartitionStreamPut (
+  IN OUT  PARTITION_STREAM  *Stream,
+  IN      UINT8             *Data,
+  IN      UINTN             Length
   )
 {
-  EFI_STATUS               Status;
-  EFI_BLOCK_IO_PROTOCOL    *BlockIo;
-  EFI_DISK_IO_PROTOCOL     *DiskIo;
-  UINT32                   MediaId;
-  SPARSE_HEADER            *SparseHeader;
-  CHUNK_HEADER             *ChunkHeader;
-  UINT32                   Chunk;
-  UINTN                    Offset;
-
-  Status = OpenPartition (PartitionName, Image, Size, &BlockIo, &DiskIo);
-  if (EFI_ERROR (Status)) {
-    goto Exit;
-  }
-
-  Offset = 0;
-  MediaId = BlockIo->Media->MediaId;
-  SparseHeader = (SPARSE_HEADER *)Image;
-
-  if (SparseHeader->Magic == SPARSE_HEADER_MAGIC) {
-    CHAR16 OutputString[64];
-    UINTN ChunkPrintDensity =
-      SparseHeader->TotalChunks > 1600 ? SparseHeader->TotalChunks / 200 : 32;
-
-    Image += SparseHeader->FileHeaderSize;
-    for (Chunk = 0; Chunk < SparseHeader->TotalChunks; Chunk++) {
-      UINTN WriteSize;
-      ChunkHeader = (CHUNK_HEADER *)Image;
-
-      // Show progress. Don't do it for every packet as outputting text
-      // might be time consuming. ChunkPrintDensity is calculated to
-      // provide an update every half percent change for large
-      // downloads.
-      if (Chunk % ChunkPrintDensity == 0) {
-        UnicodeSPrint(OutputString, sizeof(OutputString),
-          L"\r%5d / %5d chunks written (%d%%)", Chunk,
-          SparseHeader->TotalChunks,
-          (Chunk * 100) / SparseHeader->TotalChunks);
-        mTextOut->OutputString(mTextOut, OutputString);
-      }
+  EFI_STATUS  Status;
+  UINTN       Capacity;
+  UINTN       Count;
 
-      DEBUG ((DEBUG_INFO, "Chunk #%d - Type: 0x%x Size: %d TotalSize: %d Offset %d\n",
-        (Chunk+1), ChunkHeader->ChunkType, ChunkHeader->ChunkSize,
-        ChunkHeader->TotalSize, Offset));
-      Image += sizeof(CHUNK_HEADER);
-      WriteSize = (SparseHeader->BlockSize) * ChunkHeader->ChunkSize;
-      switch (ChunkHeader->ChunkType) {
-        case CHUNK_TYPE_RAW:
-          DEBUG ((DEBUG_INFO, "Writing %d at Offset %d\n", WriteSize, Offset));
-          Status = DiskIo->WriteDisk (DiskIo, MediaId, Offset, WriteSize, Image);
-          if (EFI_ERROR (Status)) {
-            goto Exit;
-          }
-          Image += WriteSize;
-          break;
-        case CHUNK_TYPE_DONT_CARE:
-          break;
-        case CHUNK_TYPE_CRC32:
-          break;
-        default:
-          DEBUG ((DEBUG_ERROR, "Unknown Chunk Type: 0x%x", ChunkHeader->ChunkType));
-          Status = EFI_PROTOCOL_ERROR;
-          goto Exit;
+  // A skipped DONT_CARE chunk leaves a gap after the buffered data
+  if (Stream->Offset != Stream->BufferOffset + Stream->BufferLength) {
+    Status = PartitionStreamFlush (Stream);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    Stream->BufferOffset = Stream->Offset;
+  }
+
+  while (Length > 0) {
+    // End the buffer on a block boundary even when it starts off one
+    Capacity = PARTITION_IO_CHUNK_SIZE - \
+      ModU64x32 (Stream->BufferOffset, Stream->Partition.BlockSize);
+    Count = MIN (Capacity - Stream->BufferLength, Length);
+
+    CopyMem (Stream->Buffer + Stream->BufferLength, Data, Count);
+    Stream->BufferLength += Count;
+    Stream->Offset       += Count;
+    Data   += Count;
+    Length -= Count;
+
+    if (Stream->BufferLength == Capacity) {
+      Status = PartitionStreamFlush (Stream);
+      if (EFI_ERROR (Status)) {
+        return Status;
       }
-      Offset += WriteSize;
     }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/*
+ * Handles the start of the image, once sizeof (SPARSE_HEADER) bytes are in.
+ */
+STATIC
+EFI_STATUS
+PartitionStreamStart (
+  IN OUT  PARTITION_STREAM  *Stream
+  )
+{
+  SPARSE_HEADER   *SparseHeader;
+  UINT64          Size;
 
+  SparseHeader = &Stream->SparseHeader;
+
+  if (SparseHeader->Magic != SPARSE_HEADER_MAGIC) {
+    // Plain image, the collected bytes are its beginning
+    Stream->State = PartitionStreamRaw;
+    return PartitionStreamPut (Stream, (UINT8 *)SparseHeader, \
+      sizeof (SPARSE_HEADER));
+  }
+
+  DEBUG ((DEBUG_INFO, \
+    "Sparse Magic: 0x%x Major: %d Minor: %d fhs: %d chs: %d bs: %d tbs: %d tcs: %d checksum: %d \n", \
+    SparseHeader->Magic, SparseHeader->MajorVersion, \
+    SparseHeader->MinorVersion,  SparseHeader->FileHeaderSize, \
+    SparseHeader->ChunkHeaderSize, SparseHeader->BlockSize, \
+    SparseHeader->TotalBlocks, \
+    SparseHeader->TotalChunks, SparseHeader->ImageChecksum));
+
+  if (SparseHeader->MajorVersion != 1) {
+    DEBUG ((DEBUG_ERROR, "Sparse image version %d.%d not supported.\n",
+          SparseHeader->MajorVersion, SparseHeader->MinorVersion));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (SparseHeader->FileHeaderSize < sizeof (SPARSE_HEADER) ||
+      SparseHeader->ChunkHeaderSize != sizeof (CHUNK_HEADER)) {
+    DEBUG ((DEBUG_ERROR, "Sparse image header sizes not supported.\n"));
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // Check image will fit on device
+  Size = MultU64x32 (SparseHeader->BlockSize, SparseHeader->TotalBlocks);
+  if (Stream->Partition.Size < Size) {
+    DEBUG ((DEBUG_ERROR, "Partition not big enough.\n"));
+    DEBUG ((DEBUG_ERROR, \
+      "Partition Size:\t%ld\nImage Size:\t%ld\n", Stream->Partition.Size, Size));
+    return EFI_VOLUME_FULL;
+  }
+
+  Stream->ChunkPrintDensity =
+    SparseHeader->TotalChunks > 1600 ? SparseHeader->TotalChunks / 200 : 32;
+
+  PartitionStreamSkip (Stream, SparseHeader->FileHeaderSize - sizeof (SPARSE_HEADER));
+  return EFI_SUCCESS;
+}
+
+/*
+ * Handles a sparse chunk, once its header is in.
+ */
+STATIC
+EFI_STATUS
+PartitionStreamStartChunk (
+  IN OUT  PARTITION_STREAM  *Stream
+  )
+{
+  CHUNK_HEADER    *ChunkHeader;
+  CHAR16          OutputString[64];
+  UINT64          WriteSize;
+  UINT64          DataSize;
+
+  ChunkHeader = &Stream->ChunkHeader;
+
+  // Show progress. Don't do it for every packet as outputting text
+  // might be time consuming. ChunkPrintDensity is calculated to
+  // provide an update every half percent change for large
+  // downloads.
+  if (Stream->Chunk % Stream->ChunkPrintDensity == 0) {
     UnicodeSPrint (OutputString, sizeof (OutputString),
-        L"\r%5d / %5d chunks written (100%%)\r\n",
-        SparseHeader->TotalChunks, SparseHeader->TotalChunks);
-    mTextOut->OutputString(mTextOut, OutputString);
+      L"\r%5d / %5d chunks written (%d%%)", Stream->Chunk,
+      Stream->SparseHeader.TotalChunks,
+      (Stream->Chunk * 100) / Stream->SparseHeader.TotalChunks);
+    gST->ConOut->OutputString (gST->ConOut, OutputString);
+  }
 
-  } else {
+  DEBUG ((DEBUG_INFO, "Chunk #%d - Type: 0x%x Size: %d TotalSize: %d Offset %ld\n",
+    (Stream->Chunk + 1), ChunkHeader->ChunkType, ChunkHeader->ChunkSize,
+    ChunkHeader->TotalSize, Stream->Offset));
 
-    Status = DiskIo->WriteDisk (DiskIo, MediaId, 0, Size, Image);
-    if (EFI_ERROR (Status)) {
-      goto Exit;
+  Stream->Chunk++;
+
+  if (ChunkHeader->TotalSize < sizeof (CHUNK_HEADER)) {
+    return EFI_PROTOCOL_ERROR;
+  }
+
+  WriteSize = MultU64x32 (Stream->SparseHeader.BlockSize, ChunkHeader->ChunkSize);
+  DataSize  = ChunkHeader->TotalSize - sizeof (CHUNK_HEADER);
+
+  switch (ChunkHeader->ChunkType) {
+    case CHUNK_TYPE_RAW:
+      if (DataSize != WriteSize) {
+        return EFI_PROTOCOL_ERROR;
+      }
+      if (WriteSize == 0) {
+        PartitionStreamEndChunk (Stream);
+      } else {
+        Stream->Remaining = WriteSize;
+        Stream->State     = PartitionStreamChunkData;
+      }
+      break;
+    case CHUNK_TYPE_DONT_CARE:
+    case CHUNK_TYPE_CRC32:
+      Stream->Offset += WriteSize;
+      PartitionStreamSkip (Stream, DataSize);
+      break;
+    default:
+      DEBUG ((DEBUG_ERROR, "Unknown Chunk Type: 0x%x", ChunkHeader->ChunkType));
+      return EFI_PROTOCOL_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/*
+ * Opens a partition for an image that is written in pieces as it arrives,
+ * e.g. from the network. Size is the size of the image file.
+ */
+EFI_STATUS
+PartitionOpenStream (
+  IN  CHAR8             *PartitionName,
+  IN  UINTN             Size,
+  OUT PARTITION_STREAM  **Stream
+  )
+{
+  EFI_STATUS            Status;
+  PARTITION_STREAM      *NewStream;
+
+  NewStream = AllocateZeroPool (sizeof (PARTITION_STREAM));
+  if (NewStream == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  // Sparse images are checked against the partition size once their
+  // header has arrived
+  Status = OpenPartition (PartitionName, Size, &NewStream->Partition);
+  if (!EFI_ERROR (Status)) {
+    NewStream->Buffer = AllocateAlignedPages (
+      EFI_SIZE_TO_PAGES (PARTITION_IO_CHUNK_SIZE),
+      NewStream->Partition.IoAlign
+      );
+    if (NewStream->Buffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
     }
   }
+  if (EFI_ERROR (Status)) {
+    ClosePartition (&NewStream->Partition);
+    FreePool (NewStream);
+    return Status;
+  }
+
+  NewStream->State = PartitionStreamMagic;
 
-  BlockIo->FlushBlocks (BlockIo);
+  *Stream = NewStream;
+  return EFI_SUCCESS;
+}
+
+/*
+ * Writes the next Length bytes of the image. Sparse images are expanded
+ * on the fly, so the data may be split at any byte.
+ */
+EFI_STATUS
+PartitionStreamWrite (
+  IN PARTITION_STREAM   *Stream,
+  IN VOID               *Data,
+  IN UINTN              Length
+  )
+{
+  EFI_STATUS  Status;
+  UINT8       *Ptr;
+  UINTN       Count;
+
+  Status = EFI_SUCCESS;
+  Ptr    = Data;
+
+  while (Length > 0 && !EFI_ERROR (Status)) {
+    switch (Stream->State) {
+      case PartitionStreamMagic:
+        if (PartitionStreamCollect (Stream, &Stream->SparseHeader, \
+              sizeof (SPARSE_HEADER), &Ptr, &Length)) {
+          Status = PartitionStreamStart (Stream);
+        }
+        break;
+      case PartitionStreamSkip:
+        Count = (UINTN)MIN (Stream->Remaining, Length);
+        Stream->Remaining -= Count;
+        Ptr    += Count;
+        Length -= Count;
+        if (Stream->Remaining == 0) {
+          PartitionStreamEndChunk (Stream);
+        }
+        break;
+      case PartitionStreamChunkHeader:
+        if (PartitionStreamCollect (Stream, &Stream->ChunkHeader, \
+              sizeof (CHUNK_HEADER), &Ptr, &Length)) {
+          Status = PartitionStreamStartChunk (Stream);
+        }
+        break;
+      case PartitionStreamRaw:
+      case PartitionStreamChunkData:
+        Count = Length;
+        if (Stream->State == PartitionStreamChunkData) {
+          Count = (UINTN)MIN (Stream->Remaining, Length);
+        }
+        Status = PartitionStreamPut (Stream, Ptr, Count);
+        Ptr    += Count;
+        Length -= Count;
+        if (Stream->State == PartitionStreamChunkData) {
+          Stream->Remaining -= Count;
+          if (Stream->Remaining == 0) {
+            PartitionStreamEndChunk (Stream);
+          }
+        }
+        break;
+      default:
+        // Trailing data after the last chunk is ignored
+        Length = 0;
+        break;
+    }
+  }
+
+  return Status;
+}
+
+/*
+ * Finishes the image, flushes the partition and frees the stream.
+ */
+EFI_STATUS
+PartitionCloseStream (
+  IN PARTITION_STREAM   *Stream
+  )
+{
+  EFI_STATUS  Status;
+  EFI_STATUS  FlushStatus;
+
+  Status = EFI_SUCCESS;
+
+  if (Stream->State == PartitionStreamMagic) {
+    // Plain image shorter than a sparse header
+    if (Stream->HeaderLength > 0) {
+      Status = PartitionStreamPut (Stream, (UINT8 *)&Stream->SparseHeader, \
+        Stream->HeaderLength);
+    }
+  } else if (Stream->State != PartitionStreamRaw &&
+             Stream->State != PartitionStreamDone) {
+    DEBUG ((DEBUG_ERROR, "Sparse image truncated at chunk %d\n", Stream->Chunk));
+    Status = EFI_PROTOCOL_ERROR;
+  }
+
+  FlushStatus = PartitionStreamFlush (Stream);
+  if (!EFI_ERROR (Status)) {
+    Status = FlushStatus;
+  }
+
+  PartitionFlush (&Stream->Partition);
+  ClosePartition (&Stream->Partition);
+  FreeAlignedPages (Stream->Buffer, EFI_SIZE_TO_PAGES (PARTITION_IO_CHUNK_SIZE));
+  FreePool (Stream);
+
+  return Status;
+}
+
+EFI_STATUS
+PartitionWrite (
+  IN CHAR8  *PartitionName,
+  IN VOID   *Image,
+  IN UINTN  Size
+  )
+{
+  EFI_STATUS               Status;
+  EFI_STATUS               CloseStatus;
+  PARTITION_STREAM         *Stream;
+
+  Status = PartitionOpenStream (PartitionName, Size, &Stream);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status      = PartitionStreamWrite (Stream, Image, Size);
+  CloseStatus = PartitionCloseStream (Stream);
+  if (!EFI_ERROR (Status)) {
+    Status = CloseStatus;
+  }
 
-Exit:
   return Status;
 }
@@ -8,6 +8,51 @@
 
 #define FILE_HDR_SIZE 16
 
+//
+// The image is received into a ring of buffers: one is being filled by the
+// HTTP driver while the previous one is written to storage.
+//
+#define HTTP_STREAM_BUFFER_SIZE   SIZE_64KB
+#define HTTP_STREAM_BUFFER_COUNT  2
+#define HTTP_STREAM_TIMEOUT       5000    // ms without data before retrying
+#define HTTP_STREAM_MAX_RETRIES   5       // Retries without progress
+
+#define HTTP_STREAM_USER_AGENT    "RdkHttpBoot/1.0"
+#define HTTP_STREAM_RANGE         "Range"
+
+typedef struct {
+  EFI_HTTP_TOKEN      Token;
+  EFI_HTTP_MESSAGE    Message;
+  BOOLEAN             Done;
+  UINT8               *Buffer;
+} HTTP_STREAM_BUFFER;
+
+typedef struct {
+  EFI_HANDLE                ChildHandle;
+  EFI_HTTP_PROTOCOL         *Http;
+  EFI_HTTPv4_ACCESS_POINT   Ipv4Node;
+  CHAR16                    *Uri;
+  CHAR8                     Host[URI_STR_MAX_SIZE];
+  UINT64                    FileSize;
+  UINT64                    Received;     // Bytes passed to the writer
+  HTTP_STREAM_BUFFER        Buffers[HTTP_STREAM_BUFFER_COUNT];
+} HTTP_STREAM;
+
+//
+// Splits the received file into its images: the system partition, the
+// kernel image and optionally the DTB, each preceded by a FILE_HDR_SIZE
+// decimal size.
+//
+typedef struct {
+  UINTN               Index;                  // Image being written
+  UINTN               Count;
+  UINT8               Header[FILE_HDR_SIZE];
+  UINTN               HeaderLength;
+  UINTN               Remaining;              // Bytes left of the image
+  PARTITION_STREAM    *Partition;
+  EFI_FILE_HANDLE     File;
+} RDK_IMAGE_WRITER;
+
 STATIC EFI_LOAD_FILE_PROTOCOL  *LoadFile = NULL;
 STATIC HTTP_BOOT_PRIVATE_DATA  *Private  = NULL;
 
@@ -188,16 +233,14 @@ Exit:
 
 STATIC
 EFI_STATUS
-HttpGetImage (
+HttpGetImageSize (
   IN   CHAR16  *Uri,
-  OUT  UINT8   **FileBuffer,
   OUT  UINTN   *FileSize
   )
 {
   EFI_DEVICE_PATH_PROTOCOL  *NewDevicePath;
   EFI_STATUS                Status;
 
-  *FileBuffer   = NULL;
   NewDevicePath = NULL;
   *FileSize     = 0;
 
@@ -214,25 +257,15 @@ HttpGetImage (
     goto Exit;
   }
 
-  // Get the HTTP image from server
-  Status = LoadFile->LoadFile (LoadFile, NewDevicePath, \
-    TRUE, FileSize, *FileBuffer);
-  if((Status != EFI_WARN_FILE_SYSTEM) && \
-    (Status != EFI_BUFFER_TOO_SMALL)) {
-    goto Exit;
-  }
-
-  *FileBuffer = AllocatePool (*FileSize);
-  if (*FileBuffer == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto Exit;
-  }
-
+  // Let the HTTP boot driver configure the network and get the
+  // size of the image from the server
   Status = LoadFile->LoadFile (LoadFile, NewDevicePath, \
-    TRUE, FileSize, *FileBuffer);
-  if (EFI_ERROR (Status)) {
-    FreePool (FileBuffer);
-    goto Exit;
+    TRUE, FileSize, NULL);
+  if((Status == EFI_WARN_FILE_SYSTEM) || \
+    (Status == EFI_BUFFER_TOO_SMALL)) {
+    Status = EFI_SUCCESS;
+  } else if (!EFI_ERROR (Status)) {
+    Status = EFI_NOT_FOUND;
   }
 
 Exit:
@@ -260,21 +293,478 @@ ParseHeader (
   return Size;
 }
 
+STATIC
+EFI_STATUS
+RdkImageWriterEnd (
+  IN OUT  RDK_IMAGE_WRITER  *Writer
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = EFI_SUCCESS;
+  if (Writer->Partition != NULL) {
+    Status = PartitionCloseStream (Writer->Partition);
+    Writer->Partition = NULL;
+  }
+  if (Writer->File != NULL) {
+    Status = FileHandleClose (Writer->File);
+    Writer->File = NULL;
+  }
+
+  Writer->Index++;
+  Writer->HeaderLength = 0;
+
+  return Status;
+}
+
+STATIC
+EFI_STATUS
+RdkImageWriterStart (
+  IN OUT  RDK_IMAGE_WRITER  *Writer
+  )
+{
+  EFI_STATUS    Status;
+  CONST CHAR16  *Path;
+
+  Writer->Remaining = ParseHeader (Writer->Header);
+
+  if (Writer->Index == 0) {
+    return PartitionOpenStream ((CHAR8 *)FixedPcdGetPtr (\
+      PcdRdkSystemPartitionName), Writer->Remaining, &Writer->Partition);
+  }
+
+  Status = GetRdkVariable ((Writer->Index == 1) ? L"IMAGE" : L"DTB", &Path);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = GetFileHandler (&Writer->File, Path, \
+    EFI_FILE_MODE_READ|EFI_FILE_MODE_WRITE|EFI_FILE_MODE_CREATE);
+  if (EFI_ERROR (Status)) {
+    Writer->File = NULL;
+    return Status;
+  }
+
+  // Drop the tail of a previous, longer image
+  return FileHandleSetSize (Writer->File, 0);
+}
+
+/*
+ * Writes the next Length bytes of the received file to the image they
+ * belong to.
+ */
+STATIC
+EFI_STATUS
+RdkImageWriterWrite (
+  IN OUT  RDK_IMAGE_WRITER  *Writer,
+  IN      UINT8             *Data,
+  IN      UINTN             Length
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Count;
+
+  Status = EFI_SUCCESS;
+
+  while (Length > 0 && Writer->Index < Writer->Count) {
+    if (Writer->HeaderLength < FILE_HDR_SIZE) {
+      Count = MIN (FILE_HDR_SIZE - Writer->HeaderLength, Length);
+      CopyMem (Writer->Header + Writer->HeaderLength, Data, Count);
+      Writer->HeaderLength += Count;
+      Data   += Count;
+      Length -= Count;
+
+      if (Writer->HeaderLength == FILE_HDR_SIZE) {
+        Status = RdkImageWriterStart (Writer);
+        if (!EFI_ERROR (Status) && Writer->Remaining == 0) {
+          Status = RdkImageWriterEnd (Writer);
+        }
+      }
+    } else {
+      Count = MIN (Writer->Remaining, Length);
+      if (Writer->Partition != NULL) {
+        Status = PartitionStreamWrite (Writer->Partition, Data, Count);
+      } else {
+        Status = FileHandleWrite (Writer->File, &Count, Data);
+      }
+      Data              += Count;
+      Length            -= Count;
+      Writer->Remaining -= Count;
+
+      if (!EFI_ERROR (Status) && Writer->Remaining == 0) {
+        Status = RdkImageWriterEnd (Writer);
+      }
+    }
+
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+EFIAPI
+HttpStreamNotify (
+  IN  EFI_EVENT  Event,
+  IN  VOID       *Context
+  )
+{
+  *((BOOLEAN *) Context) = TRUE;
+}
+
+STATIC
+VOID
+HttpStreamClose (
+  IN OUT  HTTP_STREAM  *Stream
+  )
+{
+  if (Stream->ChildHandle != NULL) {
+    NetLibDestroyServiceChild (Private->Controller, gImageHandle, \
+      &gEfiHttpServiceBindingProtocolGuid, Stream->ChildHandle);
+    Stream->ChildHandle = NULL;
+    Stream->Http        = NULL;
+  }
+}
+
+/*
+ * Creates an HTTP instance on the NIC, using the address the HTTP boot
+ * driver got from DHCP.
+ */
+STATIC
+EFI_STATUS
+HttpStreamOpen (
+  IN OUT  HTTP_STREAM  *Stream
+  )
+{
+  EFI_STATUS            Status;
+  EFI_HTTP_CONFIG_DATA  ConfigData;
+
+  Status = NetLibCreateServiceChild (Private->Controller, gImageHandle, \
+    &gEfiHttpServiceBindingProtocolGuid, &Stream->ChildHandle);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->OpenProtocol (
+    Stream->ChildHandle,
+    &gEfiHttpProtocolGuid,
+    (VOID **) &Stream->Http,
+    gImageHandle,
+    NULL,
+    EFI_OPEN_PROTOCOL_GET_PROTOCOL
+    );
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  ZeroMem (&Stream->Ipv4Node, sizeof (Stream->Ipv4Node));
+  CopyMem (&Stream->Ipv4Node.LocalAddress, &Private->StationIp.v4, \
+    sizeof (EFI_IPv4_ADDRESS));
+  CopyMem (&Stream->Ipv4Node.LocalSubnet, &Private->SubnetMask.v4, \
+    sizeof (EFI_IPv4_ADDRESS));
+
+  ZeroMem (&ConfigData, sizeof (ConfigData));
+  ConfigData.HttpVersion          = HttpVersion11;
+  ConfigData.TimeOutMillisec      = HTTP_STREAM_TIMEOUT;
+  ConfigData.LocalAddressIsIPv6   = FALSE;
+  ConfigData.AccessPoint.IPv4Node = &Stream->Ipv4Node;
+
+  Status = Stream->Http->Configure (Stream->Http, &ConfigData);
+
+Exit:
+  if (EFI_ERROR (Status)) {
+    HttpStreamClose (Stream);
+  }
+
+  return Status;
+}
+
+/*
+ * Waits until the token of Buffer completes, or times out.
+ */
+STATIC
+EFI_STATUS
+HttpStreamWait (
+  IN  HTTP_STREAM         *Stream,
+  IN  HTTP_STREAM_BUFFER  *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   TimeoutEvent;
+
+  Status = gBS->CreateEvent (EVT_TIMER, TPL_CALLBACK, NULL, NULL, &TimeoutEvent);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->SetTimer (TimeoutEvent, TimerRelative, \
+    HTTP_STREAM_TIMEOUT * 10000);
+  if (!EFI_ERROR (Status)) {
+    while (!Buffer->Done && EFI_ERROR (gBS->CheckEvent (TimeoutEvent))) {
+      Stream->Http->Poll (Stream->Http);
+    }
+    Status = Buffer->Done ? Buffer->Token.Status : EFI_TIMEOUT;
+  }
+
+  gBS->CloseEvent (TimeoutEvent);
+  return Status;
+}
+
+/*
+ * Queues Buffer to receive the next part of the response. Headers are only
+ * requested with the first part.
+ */
+STATIC
+EFI_STATUS
+HttpStreamReceive (
+  IN  HTTP_STREAM             *Stream,
+  IN  HTTP_STREAM_BUFFER      *Buffer,
+  IN  EFI_HTTP_RESPONSE_DATA  *ResponseData  OPTIONAL
+  )
+{
+  ZeroMem (&Buffer->Message, sizeof (Buffer->Message));
+  Buffer->Message.Data.Response = ResponseData;
+  Buffer->Message.BodyLength    = HTTP_STREAM_BUFFER_SIZE;
+  Buffer->Message.Body          = Buffer->Buffer;
+  Buffer->Token.Message         = &Buffer->Message;
+  Buffer->Token.Status          = EFI_NOT_READY;
+  Buffer->Done                  = FALSE;
+
+  return Stream->Http->Response (Stream->Http, &Buffer->Token);
+}
+
+/*
+ * Requests the image from Stream->Received on and passes the body to the
+ * writer as it arrives. WriteError is set if the writer failed, as opposed
+ * to the network.
+ */
+STATIC
+EFI_STATUS
+HttpStreamGet (
+  IN   HTTP_STREAM       *Stream,
+  IN   RDK_IMAGE_WRITER  *Writer,
+  OUT  BOOLEAN           *WriteError
+  )
+{
+  EFI_STATUS              Status;
+  EFI_HTTP_REQUEST_DATA   RequestData;
+  EFI_HTTP_RESPONSE_DATA  ResponseData;
+  EFI_HTTP_HEADER         RequestHeaders[4];
+  HTTP_STREAM_BUFFER      *Buffer;
+  UINTN                   Index;
+  UINT64                  Position;
+  UINTN                   Skip;
+  UINTN                   Length;
+  CHAR8                   Range[32];
+
+  *WriteError = FALSE;
+  Buffer      = &Stream->Buffers[0];
+
+  RequestData.Method = HttpMethodGet;
+  RequestData.Url    = Stream->Uri;
+
+  RequestHeaders[0].FieldName  = HTTP_HEADER_HOST;
+  RequestHeaders[0].FieldValue = Stream->Host;
+  RequestHeaders[1].FieldName  = HTTP_HEADER_ACCEPT;
+  RequestHeaders[1].FieldValue = "*/*";
+  RequestHeaders[2].FieldName  = HTTP_HEADER_USER_AGENT;
+  RequestHeaders[2].FieldValue = HTTP_STREAM_USER_AGENT;
+  RequestHeaders[3].FieldName  = HTTP_STREAM_RANGE;
+  RequestHeaders[3].FieldValue = Range;
+  AsciiSPrint (Range, sizeof (Range), "bytes=%ld-", Stream->Received);
+
+  ZeroMem (&Buffer->Message, sizeof (Buffer->Message));
+  Buffer->Message.Data.Request = &RequestData;
+  // Resume where the previous connection stopped
+  Buffer->Message.HeaderCount  = (Stream->Received > 0) ? 4 : 3;
+  Buffer->Message.Headers      = RequestHeaders;
+  Buffer->Token.Message        = &Buffer->Message;
+  Buffer->Token.Status         = EFI_NOT_READY;
+  Buffer->Done                 = FALSE;
+
+  Status = Stream->Http->Request (Stream->Http, &Buffer->Token);
+  if (!EFI_ERROR (Status)) {
+    Status = HttpStreamWait (Stream, Buffer);
+  }
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  ZeroMem (&ResponseData, sizeof (ResponseData));
+  Status = HttpStreamReceive (Stream, Buffer, &ResponseData);
+  if (!EFI_ERROR (Status)) {
+    Status = HttpStreamWait (Stream, Buffer);
+  }
+  if (Buffer->Message.Headers != NULL) {
+    FreePool (Buffer->Message.Headers);
+    Buffer->Message.Headers = NULL;
+  }
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (ResponseData.StatusCode == HTTP_STATUS_206_PARTIAL_CONTENT) {
+    Position = Stream->Received;
+  } else if (ResponseData.StatusCode == HTTP_STATUS_200_OK) {
+    // The server ignored the range, skip what was already written
+    Position = 0;
+  } else {
+    DEBUG ((DEBUG_ERROR, "HttpBoot: Unexpected HTTP status %d\n", \
+      ResponseData.StatusCode));
+    return EFI_PROTOCOL_ERROR;
+  }
+
+  for (Index = 0; ; Index = (Index + 1) % HTTP_STREAM_BUFFER_COUNT) {
+    Buffer    = &Stream->Buffers[Index];
+    Length    = Buffer->Message.BodyLength;
+    Position += Length;
+
+    // Let the next buffer fill while this one is written. The HTTP driver
+    // reads another response if asked for more than the body.
+    if (Position < Stream->FileSize) {
+      Status = HttpStreamReceive (Stream, \
+        &Stream->Buffers[(Index + 1) % HTTP_STREAM_BUFFER_COUNT], NULL);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    if (Position > Stream->Received) {
+      // Skip the part of the buffer that was written before
+      Skip = 0;
+      if (Stream->Received > Position - Length) {
+        Skip = (UINTN)(Stream->Received - (Position - Length));
+      }
+      Status = RdkImageWriterWrite (Writer, Buffer->Buffer + Skip, Length - Skip);
+      if (EFI_ERROR (Status)) {
+        *WriteError = TRUE;
+        return Status;
+      }
+      Stream->Received = Position;
+    }
+
+    if (Position >= Stream->FileSize) {
+      return EFI_SUCCESS;
+    }
+
+    Status = HttpStreamWait (Stream, \
+      &Stream->Buffers[(Index + 1) % HTTP_STREAM_BUFFER_COUNT]);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+}
+
+/*
+ * Downloads the image at Uri and writes it out while it is received. A
+ * dropped connection is resumed with a range request.
+ */
+STATIC
+EFI_STATUS
+HttpStreamImage (
+  IN  CHAR16            *Uri,
+  IN  UINTN             FileSize,
+  IN  RDK_IMAGE_WRITER  *Writer
+  )
+{
+  EFI_STATUS    Status;
+  HTTP_STREAM   *Stream;
+  UINTN         Index;
+  UINTN         Retries;
+  UINT64        Received;
+  BOOLEAN       WriteError;
+  CHAR16        *Host;
+
+  Stream = AllocateZeroPool (sizeof (HTTP_STREAM));
+  if (Stream == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Stream->Uri      = Uri;
+  Stream->FileSize = FileSize;
+
+  // The Host header is the authority of the URI
+  Host = StrStr (Uri, L"://");
+  if (Host == NULL) {
+    FreePool (Stream);
+    return EFI_INVALID_PARAMETER;
+  }
+  Host += 3;
+  for (Index = 0; Index < sizeof (Stream->Host) - 1 && Host[Index] != L'\0' && \
+    Host[Index] != L'/'; Index++) {
+    Stream->Host[Index] = (CHAR8)Host[Index];
+  }
+
+  Status = EFI_SUCCESS;
+  for (Index = 0; Index < HTTP_STREAM_BUFFER_COUNT; Index++) {
+    Stream->Buffers[Index].Buffer = AllocatePool (HTTP_STREAM_BUFFER_SIZE);
+    if (Stream->Buffers[Index].Buffer == NULL) {
+      Status = EFI_OUT_OF_RESOURCES;
+      goto Exit;
+    }
+    Status = gBS->CreateEvent (EVT_NOTIFY_SIGNAL, TPL_CALLBACK, \
+      HttpStreamNotify, &Stream->Buffers[Index].Done, \
+      &Stream->Buffers[Index].Token.Event);
+    if (EFI_ERROR (Status)) {
+      goto Exit;
+    }
+  }
+
+  Retries = 0;
+  for (;;) {
+    Received = Stream->Received;
+
+    Status = HttpStreamOpen (Stream);
+    if (!EFI_ERROR (Status)) {
+      Status = HttpStreamGet (Stream, Writer, &WriteError);
+      // Reset the instance, this also aborts the pending tokens
+      HttpStreamClose (Stream);
+      if (!EFI_ERROR (Status) || WriteError) {
+        break;
+      }
+    }
+
+    DEBUG ((DEBUG_WARN, "HttpBoot: Download stopped at %ld / %ld: %r\n", \
+      Stream->Received, Stream->FileSize, Status));
+
+    // Only give up if the retries make no progress
+    if (Stream->Received > Received) {
+      Retries = 0;
+    } else if (++Retries > HTTP_STREAM_MAX_RETRIES) {
+      break;
+    }
+    gBS->Stall (1000 * 1000);
+  }
+
+Exit:
+  for (Index = 0; Index < HTTP_STREAM_BUFFER_COUNT; Index++) {
+    if (Stream->Buffers[Index].Token.Event != NULL) {
+      gBS->CloseEvent (Stream->Buffers[Index].Token.Event);
+    }
+    if (Stream->Buffers[Index].Buffer != NULL) {
+      FreePool (Stream->Buffers[Index].Buffer);
+    }
+  }
+  FreePool (Stream);
+
+  return Status;
+}
+
 EFI_STATUS
 RdkHttpBoot (
   VOID
   )
 {
   EFI_STATUS  	Status;
-  VOID        	*FilePtr;
   UINT8       	*FileBuffer;
   UINT16      	*Uri;
   UINTN       	FileSize;
   UINTN       	LoopIndex;
-  UINTN       	Size;
-  CONST CHAR16  *DtbPath;
-  CONST CHAR16	*ImagePath;
   CONST CHAR16  *ServerUrlPath;
+  RDK_IMAGE_WRITER  Writer;
 
   Status = GetRdkVariable (L"URL", &ServerUrlPath);
   ASSERT_EFI_ERROR (Status);
@@ -307,37 +797,23 @@ RdkHttpBoot (
       "HttpBoot: Couldn't disable watchdog timer: %r\n", Status));
   }
 
-  // Get the File from server using it's URI
-  Status = HttpGetImage (Uri, &FileBuffer, &FileSize);
-  ASSERT_EFI_ERROR (Status);
-
-  // Write the received image to flash
-  FilePtr   = FileBuffer;
-  Size      = ParseHeader (FilePtr);
-  FilePtr  += FILE_HDR_SIZE;
-  Status    = PartitionWrite ((CHAR8 *)FixedPcdGetPtr (\
-    PcdRdkSystemPartitionName), FilePtr, Size);
-  ASSERT_EFI_ERROR (Status);
-
-  FilePtr  += Size;
-  Size      = ParseHeader (FilePtr);
-  FilePtr  += FILE_HDR_SIZE;
-  Status    = GetRdkVariable (L"IMAGE", &ImagePath);
-  ASSERT_EFI_ERROR (Status);
-  Status    = RdkWriteFile (ImagePath, &FilePtr, &Size);
+  // Get the size of the file from the server using it's URI
+  Status = HttpGetImageSize (Uri, &FileSize);
   ASSERT_EFI_ERROR (Status);
 
-  if ( FixedPcdGetBool (PcdDtbAvailable) ) {
-  FilePtr  += Size;
-  Size      = ParseHeader (FilePtr);
-  FilePtr  += FILE_HDR_SIZE;
-  Status    = GetRdkVariable (L"DTB", &DtbPath);
-  ASSERT_EFI_ERROR (Status);
-  Status    = RdkWriteFile (DtbPath, &FilePtr, &Size);
-  ASSERT_EFI_ERROR (Status);
+  // Write the received images to flash while the file downloads
+  ZeroMem (&Writer, sizeof (Writer));
+  Writer.Count = FixedPcdGetBool (PcdDtbAvailable) ? 3 : 2;
+  Status = HttpStreamImage (Uri, FileSize, &Writer);
+  if (Writer.Partition != NULL || Writer.File != NULL) {
+    RdkImageWriterEnd (&Writer);
+  }
+  if (!EFI_ERROR (Status) && Writer.Index < Writer.Count) {
+    DEBUG ((DEBUG_ERROR, "HttpBoot: Image file truncated\n"));
+    Status = EFI_END_OF_FILE;
   }
+  ASSERT_EFI_ERROR (Status);
 
-  FreePool (FileBuffer);
   FreePool (Uri);
 
   return Status;
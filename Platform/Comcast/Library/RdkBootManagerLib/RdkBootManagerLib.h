@@ -17,8 +17,9 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeServicesTableLib.h>
-#include <Protocol/DiskIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/BlockIo.h>
+#include <Protocol/Http.h>
 #include <Protocol/LoadFile.h>
 #include <Protocol/SimpleTextOut.h>
 #include <Protocol/DevicePathFromText.h>
@@ -29,6 +30,8 @@
 #include <HttpBootDxe/HttpBootDxe.h>
 #include <Include/Guid/AuthenticatedVariableFormat.h>
 
+typedef struct _PARTITION_STREAM PARTITION_STREAM;
+
 extern
 EFI_STATUS
 PartitionRead (
@@ -45,6 +48,28 @@ PartitionWrite (
   IN UINTN  Size
   );
 
+extern
+EFI_STATUS
+PartitionOpenStream (
+  IN  CHAR8             *PartitionName,
+  IN  UINTN             Size,
+  OUT PARTITION_STREAM  **Stream
+  );
+
+extern
+EFI_STATUS
+PartitionStreamWrite (
+  IN PARTITION_STREAM   *Stream,
+  IN VOID               *Data,
+  IN UINTN              Length
+  );
+
+extern
+EFI_STATUS
+PartitionCloseStream (
+  IN PARTITION_STREAM   *Stream
+  );
+
 extern
 EFI_STATUS
 GetRdkVariable (
@@ -284,31 +284,28 @@ VOID OemFeedbackXGeStatus(BOOLEAN IsLinkup, BOOLEAN IsActOK, UINT32 port)
         return;
     }
 
+    // Update both LED bits with a single CPLD read-modify-write
+    CpldValue = ReadCpldReg(RegOffset);
+
     if (IsLinkup)
     {
-        CpldValue = ReadCpldReg(RegOffset);
         CpldValue |= BIT2;
-        WriteCpldReg(RegOffset, CpldValue);
     }
     else
     {
-        CpldValue = ReadCpldReg(RegOffset);
         CpldValue &= ~((UINT8)BIT2);
-        WriteCpldReg(RegOffset, CpldValue);
     }
 
     if (IsActOK)
     {
-        CpldValue = ReadCpldReg(RegOffset);
         CpldValue |= BIT4;
-        WriteCpldReg(RegOffset, CpldValue);
     }
     else
     {
-        CpldValue = ReadCpldReg(RegOffset);
         CpldValue &= ~((UINT8)BIT4);
-        WriteCpldReg(RegOffset, CpldValue);
     }
+
+    WriteCpldReg(RegOffset, CpldValue);
 }
 
 HISI_BOARD_XGE_STATUS_PROTOCOL mHisiBoardXgeStatusProtocol2p = {
@@ -411,9 +411,6 @@ EFI_STATUS EFIFdtUpdate(UINTN FdtFileAddr)
 {
     INTN                Error;
     VOID*               Fdt;
-    UINT32              Size;
-    UINTN               NewFdtBlobSize;
-    UINTN               NewFdtBlobBase;
     EFI_STATUS          Status = EFI_SUCCESS;
     EFI_STATUS          UpdateNumaStatus = EFI_SUCCESS;
 
@@ -425,25 +422,8 @@ EFI_STATUS EFIFdtUpdate(UINTN FdtFileAddr)
         return EFI_INVALID_PARAMETER;
     }
 
-    Size = (UINTN)fdt_totalsize ((VOID*)(UINTN)(FdtFileAddr));
-    NewFdtBlobSize = Size + ADD_FILE_LENGTH;
+    // The caller opened the FDT with free space, patch it in place
     Fdt = (VOID*)(UINTN)FdtFileAddr;
-
-    Status = gBS->AllocatePages (AllocateAnyPages, EfiBootServicesData, EFI_SIZE_TO_PAGES(NewFdtBlobSize), &NewFdtBlobBase);
-    if (EFI_ERROR (Status))
-    {
-        return EFI_OUT_OF_RESOURCES;
-    }
-
-
-    Error = fdt_open_into(Fdt,(VOID*)(UINTN)(NewFdtBlobBase), (NewFdtBlobSize));
-    if (Error) {
-        DEBUG ((EFI_D_ERROR, "ERROR:fdt_open_into(): %a\n", fdt_strerror (Error)));
-        Status = EFI_INVALID_PARAMETER;
-        goto EXIT;
-    }
-
-    Fdt = (VOID*)(UINTN)NewFdtBlobBase;
     Status = DelPhyhandleUpdateMacAddress(Fdt);
     if (EFI_ERROR (Status))
     {
@@ -460,7 +440,7 @@ EFI_STATUS EFIFdtUpdate(UINTN FdtFileAddr)
     if (EFI_ERROR (Status))
     {
         DEBUG ((EFI_D_ERROR, "UpdateMemoryNode Error\n"));
-        goto EXIT;
+        return Status;
     }
 
     UpdateNumaStatus = UpdateNumaNode(Fdt);
@@ -469,11 +449,6 @@ EFI_STATUS EFIFdtUpdate(UINTN FdtFileAddr)
         DEBUG ((EFI_D_ERROR, "Update NumaNode fail\n"));
     }
 
-    gBS->CopyMem(((VOID*)(UINTN)(FdtFileAddr)),((VOID*)(UINTN)(NewFdtBlobBase)),NewFdtBlobSize);
-
-EXIT:
-    gBS->FreePages(NewFdtBlobBase,EFI_SIZE_TO_PAGES(NewFdtBlobSize));
-
     return Status;
 
 
@@ -341,6 +341,27 @@ OemIsInitEth (
   return TRUE;
 }
 
+//
+// The 100G card of the 2nd socket cannot be plugged while the firmware runs,
+// so its CPLD presence bit is only read once.
+//
+STATIC
+BOOLEAN
+Is100GCardPresent (
+  VOID
+  )
+{
+  STATIC BOOLEAN  CardPresent;
+  STATIC BOOLEAN  CardPresentValid;
+
+  if (!CardPresentValid) {
+    CardPresent = (ReadCpldReg (CPU2_SFP2_100G_CARD_OFFSET) & CARD_PRESENT_100G) != 0;
+    CardPresentValid = TRUE;
+  }
+
+  return CardPresent;
+}
+
 EFI_STATUS
 ConfigCDR (
   UINT32 Socket
@@ -364,7 +385,7 @@ OemGetNclConfOffset (
   }
 
   // For 2nd Socket
-  if ((ReadCpldReg (CPU2_SFP2_100G_CARD_OFFSET) & CARD_PRESENT_100G) != 0) {
+  if (Is100GCardPresent ()) {
     ConfigurationOffset = SIZE_128KB;
   } else {
     ConfigurationOffset = SIZE_64KB;
@@ -382,7 +403,7 @@ OemGetNetPortNum (
     return SOCKET0_NET_PORT_NUM;
   }
 
-  if ((ReadCpldReg (CPU2_SFP2_100G_CARD_OFFSET) & CARD_PRESENT_100G) != 0) {
+  if (Is100GCardPresent ()) {
     return SOCKET1_NET_PORT_100G;
   } else {
     return SOCKET1_NET_PORT_NUM;
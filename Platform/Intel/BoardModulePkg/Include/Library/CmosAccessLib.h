@@ -87,6 +87,41 @@ CmosWrite32 (
   IN UINT32 Data
   );
 
+/**
+  Read a number of bytes from consecutive CMOS addresses.
+
+  The bytes of inaccessible addresses read as 0xFF.
+
+  @param [in]  Address  Location to read from CMOS.
+  @param [in]  Length   The number of bytes to read.
+  @param [out] Buffer   The buffer to receive the bytes read.
+**/
+VOID
+EFIAPI
+CmosReadBuffer (
+  IN  UINT8  Address,
+  IN  UINTN  Length,
+  OUT UINT8  *Buffer
+  );
+
+/**
+  Write a number of bytes to consecutive CMOS addresses.
+
+  Inaccessible addresses and bytes that hold the value already are not
+  written. The checksum is updated once for all the bytes written.
+
+  @param [in] Address  Location to write to CMOS.
+  @param [in] Length   The number of bytes to write.
+  @param [in] Buffer   The bytes to write.
+**/
+VOID
+EFIAPI
+CmosWriteBuffer (
+  IN UINT8        Address,
+  IN UINTN        Length,
+  IN CONST UINT8  *Buffer
+  );
+
 /**
   Initialize the CMOS.
 
@@ -229,11 +229,16 @@ SioDriverSupported (
                   );
 
   if (!EFI_ERROR (Status)) {
+    //
+    // Supported() is called for every PCI controller on each connect, and only
+    // the IDs, the command register and the class code are checked. Read just
+    // those instead of the whole configuration header.
+    //
     Status = PciIo->Pci.Read (
                           PciIo,
                           EfiPciIoWidthUint32,
                           0,
-                          sizeof (Pci) / sizeof (UINT32),
+                          OFFSET_OF (PCI_DEVICE_INDEPENDENT_REGION, CacheLineSize) / sizeof (UINT32),
                           &Pci
                           );
     ASSERT_EFI_ERROR (Status);
@@ -170,6 +170,14 @@ ConnectSequence (
   IN EFI_BOOT_MODE                      BootMode
   );
 
+/**
+  Connects Root Bridge
+ **/
+VOID
+ConnectRootBridge (
+  BOOLEAN Recursive
+  );
+
 
 /**
    Compares boot priorities of two boot options
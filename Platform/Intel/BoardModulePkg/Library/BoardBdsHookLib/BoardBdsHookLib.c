@@ -989,6 +989,11 @@ ConnectSequence (
   IN EFI_BOOT_MODE         BootMode
   )
 {
+  //
+  // Connect each PCI root bridge on its own first, so the time spent in
+  // every PCI subtree is recorded separately, then connect what is left.
+  //
+  ConnectRootBridge (TRUE);
   EfiBootManagerConnectAll ();
 }
 
@@ -1036,6 +1041,7 @@ ConnectRootBridge (
   UINTN                            RootBridgeIndex;
 
   RootBridgeHandleCount = 0;
+  RootBridgeHandleBuffer = NULL;
   gBS->LocateHandleBuffer (
          ByProtocol,
          &gEfiPciRootBridgeIoProtocolGuid,
@@ -1044,7 +1050,13 @@ ConnectRootBridge (
          &RootBridgeHandleBuffer
          );
   for (RootBridgeIndex = 0; RootBridgeIndex < RootBridgeHandleCount; RootBridgeIndex++) {
+    PERF_START_EX (RootBridgeHandleBuffer[RootBridgeIndex], "ConnectRb", NULL, AsmReadTsc (), 0x7060);
     gBS->ConnectController (RootBridgeHandleBuffer[RootBridgeIndex], NULL, NULL, Recursive);
+    PERF_END_EX (RootBridgeHandleBuffer[RootBridgeIndex], "ConnectRb", NULL, AsmReadTsc (), 0x7061);
+  }
+
+  if (RootBridgeHandleBuffer != NULL) {
+    FreePool (RootBridgeHandleBuffer);
   }
 }
 
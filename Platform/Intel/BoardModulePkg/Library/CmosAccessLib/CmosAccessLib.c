@@ -165,6 +165,32 @@ CmosAccessLibGetChecksumLocation (
   ASSERT (Location->Length <= 2);
 }
 
+/**
+  Read a byte value from a CMOS address.
+
+  It's an internal function that doesn't check whether the address is accessible.
+
+  @param [in] Address   Location to read from CMOS
+
+  @return The byte value read from the CMOS address.
+**/
+UINT8
+CmosAccessLibICmosRead8 (
+  IN  UINT8 Address
+  )
+{
+  if (Address <= CMOS_BANK0_LIMIT) {
+    if (PlatformCmosGetNmiState ()) {
+      Address |= BIT7;
+    }
+    IoWrite8 (PORT_70, Address);
+    return IoRead8 (PORT_71);
+  } else {
+    IoWrite8 (PORT_72, Address);
+    return IoRead8 (PORT_73);
+  }
+}
+
 /**
   Calculate the sum of CMOS values who need checksum calculation.
 
@@ -190,7 +216,14 @@ CmosAccessLibCalculateSum (
   Entries = PlatformCmosGetEntry (&Count);
   for (Index = 0; Index < Count; Index++) {
     if (CmosAccessLibNeedChecksum (Entries[Index].Address, &Entries[Index])) {
-      Sum += CmosRead8 (Entries[Index].Address);
+      //
+      // Same value as CmosRead8 () returns, without looking up the entry again.
+      //
+      if (CmosAccessLibIsAccessible (Entries[Index].Address, &Entries[Index])) {
+        Sum += CmosAccessLibICmosRead8 (Entries[Index].Address);
+      } else {
+        Sum += 0xFF;
+      }
     }
   }
 
@@ -278,16 +311,7 @@ CmosRead8 (
     return 0xFF;
   }
 
-  if (Address <= CMOS_BANK0_LIMIT) {
-    if (PlatformCmosGetNmiState ()) {
-      Address |= BIT7;
-    }
-    IoWrite8 (PORT_70, Address);
-    return IoRead8 (PORT_71);
-  } else {
-    IoWrite8 (PORT_72, Address);
-    return IoRead8 (PORT_73);
-  }
+  return CmosAccessLibICmosRead8 (Address);
 }
 
 /**
@@ -329,32 +353,7 @@ CmosWrite8 (
   IN UINT8 Data
   )
 {
-  UINT8                       OriginalData;
-  CMOS_ENTRY                  *Entry;
-  CMOS_CHECKSUM_LOCATION_INFO ChecksumLocation;
-
-  Entry = CmosAccessLibLocateEntry (Address);
-
-  if (!CmosAccessLibIsAccessible (Address, Entry)) {
-    return;
-  }
-
-  OriginalData = CmosRead8 (Address);
-
-  CmosAccessLibICmosWrite8 (Address, Data);
-
-  if (CmosAccessLibNeedChecksum (Address, Entry)) {
-    //
-    // Sum of Data + Checksum = New Sum of Data + New Checksum = 0
-    // New Sum of Data - Sum of Data = Checksum - New Checksum
-    // New Checksum = Checksum - (New Sum of Data - Sum of Data)
-    //
-    CmosAccessLibGetChecksumLocation (&ChecksumLocation);
-    CmosAccessLibWriteChecksum (
-      &ChecksumLocation,
-      CmosAccessLibReadChecksum (&ChecksumLocation) - (Data - OriginalData)
-      );
-  }
+  CmosWriteBuffer (Address, sizeof (Data), &Data);
 }
 
 /**
@@ -386,8 +385,7 @@ CmosWrite16 (
   IN UINT16 Data
   )
 {
-  CmosWrite8 (Address, (UINT8) Data);
-  CmosWrite8 (Address + 1, (UINT8) (Data >> 8));
+  CmosWriteBuffer (Address, sizeof (Data), (UINT8 *) &Data);
 }
 
 /**
@@ -419,10 +417,101 @@ CmosWrite32 (
   IN UINT32 Data
   )
 {
-  CmosWrite16 (Address, (UINT16) Data);
-  CmosWrite16 (Address + 2, (UINT16) (Data >> 16));
+  CmosWriteBuffer (Address, sizeof (Data), (UINT8 *) &Data);
+}
+
+/**
+  Read a number of bytes from consecutive CMOS addresses.
+
+  The bytes of inaccessible addresses read as 0xFF.
+
+  @param [in]  Address  Location to read from CMOS.
+  @param [in]  Length   The number of bytes to read.
+  @param [out] Buffer   The buffer to receive the bytes read.
+**/
+VOID
+EFIAPI
+CmosReadBuffer (
+  IN  UINT8  Address,
+  IN  UINTN  Length,
+  OUT UINT8  *Buffer
+  )
+{
+  UINTN                       Index;
+
+  ASSERT (Address + Length <= CMOS_BANK1_LIMIT + 1);
+  ASSERT (Buffer != NULL || Length == 0);
+
+  for (Index = 0; Index < Length; Index++) {
+    Buffer[Index] = CmosRead8 ((UINT8) (Address + Index));
+  }
 }
 
+/**
+  Write a number of bytes to consecutive CMOS addresses.
+
+  Inaccessible addresses and bytes that hold the value already are not
+  written. The checksum is updated once for all the bytes written.
+
+  @param [in] Address  Location to write to CMOS.
+  @param [in] Length   The number of bytes to write.
+  @param [in] Buffer   The bytes to write.
+**/
+VOID
+EFIAPI
+CmosWriteBuffer (
+  IN UINT8        Address,
+  IN UINTN        Length,
+  IN CONST UINT8  *Buffer
+  )
+{
+  UINTN                       Index;
+  UINT8                       CurrentAddress;
+  UINT8                       OriginalData;
+  UINT16                      SumDelta;
+  BOOLEAN                     ChecksumChanged;
+  CMOS_ENTRY                  *Entry;
+  CMOS_CHECKSUM_LOCATION_INFO ChecksumLocation;
+
+  ASSERT (Address + Length <= CMOS_BANK1_LIMIT + 1);
+  ASSERT (Buffer != NULL || Length == 0);
+
+  SumDelta        = 0;
+  ChecksumChanged = FALSE;
+  for (Index = 0; Index < Length; Index++) {
+    CurrentAddress = (UINT8) (Address + Index);
+    Entry = CmosAccessLibLocateEntry (CurrentAddress);
+
+    if (!CmosAccessLibIsAccessible (CurrentAddress, Entry)) {
+      continue;
+    }
+
+    OriginalData = CmosAccessLibICmosRead8 (CurrentAddress);
+    if (OriginalData == Buffer[Index]) {
+      continue;
+    }
+
+    CmosAccessLibICmosWrite8 (CurrentAddress, Buffer[Index]);
+
+    if (CmosAccessLibNeedChecksum (CurrentAddress, Entry)) {
+      SumDelta        += (UINT16) (Buffer[Index] - OriginalData);
+      ChecksumChanged  = TRUE;
+    }
+  }
+
+  if (ChecksumChanged) {
+    //
+    // Sum of Data + Checksum = New Sum of Data + New Checksum = 0
+    // New Sum of Data - Sum of Data = Checksum - New Checksum
+    // New Checksum = Checksum - (New Sum of Data - Sum of Data)
+    //
+    CmosAccessLibGetChecksumLocation (&ChecksumLocation);
+    CmosAccessLibWriteChecksum (
+      &ChecksumLocation,
+      CmosAccessLibReadChecksum (&ChecksumLocation) - SumDelta
+      );
+  }
+}
 
 /**
   Initialize the CMOS.
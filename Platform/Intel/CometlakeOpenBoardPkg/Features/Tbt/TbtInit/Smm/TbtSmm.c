@@ -1747,6 +1747,10 @@ ConfigureTbtAspm (
       return;
     }
     GetDTbtRpDevFun(DTBT_CONTROLLER, gCurrentDiscreteTbtRootPort - 1, &RpDevice, &RpFunction);
+    //
+    // The power management settings change, ThunderboltCallback () must not skip them
+    //
+    TbtInvalidateHostRouterCache ();
 
     ConfigureTbtPm (RpSegment, RpBus, RpDevice, RpFunction, 1);
     if (!mTbtNvsAreaPtr->TbtAspm) { //Aspm disable case
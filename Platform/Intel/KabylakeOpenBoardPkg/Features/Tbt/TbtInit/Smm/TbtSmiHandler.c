@@ -22,6 +22,7 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINTN                 gDeviceBaseAddress;
 //US(X:0:0), DS(X+1:3:0),DS(X+1:4:0),DS(X+1:5:0),DS(X+1:6:0)
 //
 GLOBAL_REMOVE_IF_UNREFERENCED BRDG_CONFIG           HrConfigs[MAX_CFG_PORTS];
+STATIC HR_CONFIG_CACHE                              mHrConfigCache;
 
 extern UINT8                      gCurrentDiscreteTbtRootPort;
 extern UINT8                      gCurrentDiscreteTbtRootPortType;
@@ -795,10 +796,59 @@ InitHRResConfigs (
   }
 } // InitHRResConfigs
 
+/**
+  Check whether the host router is still programmed as by the last
+  InitializeHostRouter () for the same root port resources.
+
+  @param[in]  Hr_Config     Host router found behind the root port
+  @param[in]  RpDevice      Root port device
+  @param[in]  RpFunction    Root port function
+  @param[in]  HrResConf     Resources of the root port
+  @param[in]  BusNumLimit   Subordinate bus of the root port
+
+  @retval TRUE              The cached configuration can be reused
+  @retval FALSE             The host router needs to be programmed
+**/
+STATIC
+BOOLEAN
+IsHostRouterConfigCached (
+  IN   HR_CONFIG        *Hr_Config,
+  IN   UINTN            RpDevice,
+  IN   UINTN            RpFunction,
+  IN   BRDG_RES_CONFIG  *HrResConf,
+  IN   UINT8            BusNumLimit
+  )
+{
+  UINT8  i;
+
+  if (!mHrConfigCache.Valid ||
+      (mHrConfigCache.RpDevice != RpDevice) ||
+      (mHrConfigCache.RpFunction != RpFunction) ||
+      (mHrConfigCache.BusNumLimit != BusNumLimit) ||
+      (mHrConfigCache.HrConfig.HRBus != Hr_Config->HRBus) ||
+      (mHrConfigCache.HrConfig.DeviceId != Hr_Config->DeviceId) ||
+      (CompareMem (&mHrConfigCache.RpResConf, HrResConf, sizeof (BRDG_RES_CONFIG)) != 0)) {
+    return FALSE;
+  }
+  //
+  // The bridges lose their bus numbers on a host router reset or Sx resume
+  //
+  for (i = 0; i < mHrConfigCache.HrConfig.BridgeLoops; ++i) {
+    gDeviceBaseAddress = PCI_SEGMENT_LIB_ADDRESS (TbtSegment, HrConfigs[i].DevId.Bus, HrConfigs[i].DevId.Dev, HrConfigs[i].DevId.Fun, 0);
+    if ((PciSegmentRead8 (gDeviceBaseAddress + PCI_BRIDGE_SECONDARY_BUS_REGISTER_OFFSET) != HrConfigs[i].SBus) ||
+        (PciSegmentRead8 (gDeviceBaseAddress + PCI_BRIDGE_SUBORDINATE_BUS_REGISTER_OFFSET) != HrConfigs[i].SubBus)) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+} // IsHostRouterConfigCached
+
 STATIC
 BOOLEAN
 InitializeHostRouter (
   OUT  HR_CONFIG  *Hr_Config,
+  OUT  BOOLEAN    *Cached,
   IN   UINTN      RpSegment,
   IN   UINTN      RpBus,
   IN   UINTN      RpDevice,
@@ -811,6 +861,7 @@ InitializeHostRouter (
   BOOLEAN         Ret;
 
   Ret = TRUE;
+  *Cached = FALSE;
 
   gDeviceBaseAddress   = PCI_SEGMENT_LIB_ADDRESS (RpSegment, RpBus, RpDevice, RpFunction, 0);
   Hr_Config->HRBus    = PciSegmentRead8 (gDeviceBaseAddress + PCI_BRIDGE_SECONDARY_BUS_REGISTER_OFFSET);
@@ -834,6 +885,12 @@ InitializeHostRouter (
   HrResConf.PMemLimit64 |= (UINT64)(PciSegmentRead32 (gDeviceBaseAddress + OFFSET_OF (PCI_TYPE01, Bridge.PrefetchableLimitUpper32))) << 16;
   BusNumLimit = PciSegmentRead8 (gDeviceBaseAddress + PCI_BRIDGE_SUBORDINATE_BUS_REGISTER_OFFSET);
 
+  if (IsHostRouterConfigCached (Hr_Config, RpDevice, RpFunction, &HrResConf, BusNumLimit)) {
+    CopyMem (Hr_Config, &mHrConfigCache.HrConfig, sizeof (HR_CONFIG));
+    *Cached = TRUE;
+    return mHrConfigCache.Ret;
+  }
+
   Ret         = InitHRResConfigs (Hr_Config, BusNumLimit, &HrResConf);
 
   for (i = 0; i < Hr_Config->BridgeLoops; ++i) {
@@ -873,6 +930,16 @@ InitializeHostRouter (
   PciSegmentWrite32 (gDeviceBaseAddress + PCI_BASE_ADDRESSREG_OFFSET + (PCI_BAR_IDX1 * 4), (HrConfigs[HR_DS_PORT0].Res.MemLimit + 0x4) << 16);
   PciSegmentWrite8 (gDeviceBaseAddress + PCI_CACHELINE_SIZE_OFFSET, DEF_CACHE_LINE_SIZE);
   PciSegmentWrite8 (gDeviceBaseAddress + PCI_COMMAND_OFFSET, CMD_BM_MEM);
+
+  mHrConfigCache.Valid         = TRUE;
+  mHrConfigCache.Ret           = Ret;
+  mHrConfigCache.PmConfigured  = FALSE;
+  mHrConfigCache.AttachedPorts = 0;
+  mHrConfigCache.RpDevice      = RpDevice;
+  mHrConfigCache.RpFunction    = RpFunction;
+  mHrConfigCache.BusNumLimit   = BusNumLimit;
+  CopyMem (&mHrConfigCache.RpResConf, &HrResConf, sizeof (BRDG_RES_CONFIG));
+  CopyMem (&mHrConfigCache.HrConfig, Hr_Config, sizeof (HR_CONFIG));
   return Ret;
 } // InitializeHostRouter
 STATIC
@@ -1413,7 +1480,7 @@ GetPortResources (
 } // GetPortResources
 
 STATIC
-VOID
+BOOLEAN
 ConfigurePort (
   IN       UINT8      Bus,
   IN       UINT8      Dev,
@@ -1430,7 +1497,7 @@ ConfigurePort (
     //
     // Nothing to do if TBT device is not connected
     //
-    return ;
+    return FALSE;
   }
 
   GetPortResources(Bus, Dev, Fun, PortInfo);// Take reserved resources from DS port
@@ -1440,9 +1507,10 @@ ConfigurePort (
   for (i = 0; i < MAX_TBT_DEPTH; ++i) {
     PortInfo->ConfedEP++;
     if (!ConfigureEP (i, &USBusNum, PortInfo)) {
-      return ;
+      break;
     }
   }
+  return TRUE;
 } // ConfigurePort
 
 VOID
@@ -1457,6 +1525,8 @@ ThunderboltCallback (
   UINTN                         Bus = 0;
   UINTN                         Device;
   UINTN                         Function;
+  BOOLEAN                       Cached;
+  UINT8                         AttachedPorts;
 
   DEBUG((DEBUG_INFO, "ThunderboltCallback.Entry\n"));
 
@@ -1469,19 +1539,33 @@ ThunderboltCallback (
     }
     GetDTbtRpDevFun(gCurrentDiscreteTbtRootPortType, gCurrentDiscreteTbtRootPort - 1, &Device, &Function);
     DEBUG((DEBUG_INFO, "InitializeHostRouter. \n"));
-    if (!InitializeHostRouter (&HrConfig, Segment, Bus, Device, Function)) {
+    if (!InitializeHostRouter (&HrConfig, &Cached, Segment, Bus, Device, Function)) {
       return ;
     }
   //
   // Configure DS ports
   //
+  AttachedPorts = 0;
   for (i = HrConfig.MinDSNumber; i <= HrConfig.MaxDSNumber; ++i) {
     DEBUG((DEBUG_INFO, "ConfigurePort. \n"));
-    ConfigurePort (HrConfig.HRBus + 1, i,0, &PortInfoOrg);
+    if (ConfigurePort (HrConfig.HRBus + 1, i,0, &PortInfoOrg)) {
+      AttachedPorts |= (UINT8) (BIT0 << i);
+    }
   }
 
+  //
+  // Nothing attached now and at the last callback, with the host router as it
+  // was programmed: the hierarchy still has its power management settings.
+  //
+  if (Cached && mHrConfigCache.PmConfigured && (AttachedPorts == 0) && (mHrConfigCache.AttachedPorts == 0)) {
+    DEBUG((DEBUG_INFO, "No device attached, skip EndOfThunderboltCallback.\n"));
+    return;
+  }
+  mHrConfigCache.AttachedPorts = AttachedPorts;
+
   DEBUG((DEBUG_INFO, "EndOfThunderboltCallback.\n"));
   EndOfThunderboltCallback (Segment, Bus, Device, Function);
+  mHrConfigCache.PmConfigured = TRUE;
 
   }
   DEBUG((DEBUG_INFO, "ThunderboltCallback.Exit\n"));
@@ -1597,6 +1681,7 @@ TbtDisablePCIDevicesAndBridges (
       return;
     }
     TbtSegment = (UINT8)Segment;
+    TbtInvalidateHostRouterCache ();
     MinBus++;
     //
     // @todo : Move this out when we dont have Loop for ITBT
@@ -1606,4 +1691,16 @@ TbtDisablePCIDevicesAndBridges (
   }
 } // DisablePCIDevicesAndBridges
 
+/**
+  Drop the host router configuration of the last ThunderboltCallback (), so
+  that the next one programs the whole hierarchy again.
+**/
+VOID
+TbtInvalidateHostRouterCache (
+  VOID
+  )
+{
+  mHrConfigCache.Valid = FALSE;
+}
+
 
@@ -121,6 +121,23 @@ typedef struct _HR_CONFIG {
   UINT8   BridgeLoops;
 } HR_CONFIG;
 
+//
+// Host router configuration of the last ThunderboltCallback (). It is reused
+// while the root port resources are unchanged and the bridges still hold the
+// programmed bus numbers.
+//
+typedef struct _HR_CONFIG_CACHE {
+  BOOLEAN         Valid;
+  BOOLEAN         Ret;
+  BOOLEAN         PmConfigured;
+  UINT8           AttachedPorts;
+  UINTN           RpDevice;
+  UINTN           RpFunction;
+  UINT8           BusNumLimit;
+  BRDG_RES_CONFIG RpResConf;
+  HR_CONFIG       HrConfig;
+} HR_CONFIG_CACHE;
+
 STATIC const BRDG_RES_CONFIG  NOT_IN_USE_BRIDGE = {
   CMD_BUS_MASTER,
   0,
@@ -153,6 +170,11 @@ TbtDisablePCIDevicesAndBridges (
   IN UINT8 Type
   );
 
+VOID
+TbtInvalidateHostRouterCache (
+  VOID
+  );
+
 VOID
 EndOfThunderboltCallback(
   IN   UINTN      RpSegment,
@@ -372,34 +372,29 @@ SortCpuLocalApicInTable (
 
     }
 
-    //Make sure no holes between enabled threads
+    //Make sure no holes between enabled threads, move the enabled entries up in one pass
+    Index = 0;
     for(CurrProcessor = 0; CurrProcessor < MAX_CPU_NUM; CurrProcessor++) {
-
-      if(mCpuApicIdOrderTable[CurrProcessor].Flags == 0) {
-        //make sure disabled entry has ProcId set to FFs
-        mCpuApicIdOrderTable[CurrProcessor].ApicId = (UINT32)-1;
-        mCpuApicIdOrderTable[CurrProcessor].AcpiProcessorId = (UINT32)-1;
-        mCpuApicIdOrderTable[CurrProcessor].SwProcApicId = (UINT32)-1;
-
-        for(Index = CurrProcessor+1; Index < MAX_CPU_NUM; Index++) {
-          if(mCpuApicIdOrderTable[Index].Flags == 1) {
-            //move enabled entry up
-            mCpuApicIdOrderTable[CurrProcessor].Flags = 1;
-            mCpuApicIdOrderTable[CurrProcessor].ApicId = mCpuApicIdOrderTable[Index].ApicId;
-            mCpuApicIdOrderTable[CurrProcessor].AcpiProcessorId = mCpuApicIdOrderTable[Index].AcpiProcessorId;
-            mCpuApicIdOrderTable[CurrProcessor].SwProcApicId = mCpuApicIdOrderTable[Index].SwProcApicId;
-            mCpuApicIdOrderTable[CurrProcessor].SocketNum = mCpuApicIdOrderTable[Index].SocketNum;
-            //disable moved entry
-            mCpuApicIdOrderTable[Index].Flags = 0;
-            mCpuApicIdOrderTable[Index].ApicId = (UINT32)-1;
-            mCpuApicIdOrderTable[Index].AcpiProcessorId = (UINT32)-1;
-            mCpuApicIdOrderTable[Index].SwProcApicId = (UINT32)-1;
-            break;
-          }
+      if(mCpuApicIdOrderTable[CurrProcessor].Flags == 1) {
+        if (Index != CurrProcessor) {
+          mCpuApicIdOrderTable[Index].Flags = 1;
+          mCpuApicIdOrderTable[Index].ApicId = mCpuApicIdOrderTable[CurrProcessor].ApicId;
+          mCpuApicIdOrderTable[Index].AcpiProcessorId = mCpuApicIdOrderTable[CurrProcessor].AcpiProcessorId;
+          mCpuApicIdOrderTable[Index].SwProcApicId = mCpuApicIdOrderTable[CurrProcessor].SwProcApicId;
+          mCpuApicIdOrderTable[Index].SocketNum = mCpuApicIdOrderTable[CurrProcessor].SocketNum;
         }
+        Index++;
       }
     }
 
+    //make sure disabled entries have ProcId set to FFs
+    for(; Index < MAX_CPU_NUM; Index++) {
+      mCpuApicIdOrderTable[Index].Flags = 0;
+      mCpuApicIdOrderTable[Index].ApicId = (UINT32)-1;
+      mCpuApicIdOrderTable[Index].AcpiProcessorId = (UINT32)-1;
+      mCpuApicIdOrderTable[Index].SwProcApicId = (UINT32)-1;
+    }
+
     //keep for debug purpose
     DEBUG ((EFI_D_ERROR, "APIC ID Order Table ReOrdered\n"));
     DebugDisplayReOrderTable();
@@ -358,10 +358,14 @@ FvbWriteBlock (
 
 
 /**
-  Erases and initializes a firmware volume block.
+  Erases and initializes a range of firmware volume blocks.
+
+  The blocks of a FV are contiguous in flash, so the whole range is erased
+  with one request and the SPI library can use its largest erase commands.
 
   @param[in]    FvbInstance       The pointer to the EFI_FVB_INSTANCE
-  @param[in]    Lba               The logical block index to be erased
+  @param[in]    Lba               The first logical block index to be erased
+  @param[in]    NumOfLba          The number of logical blocks to be erased
 
   @retval   EFI_SUCCESS           The erase request was successfully completed
   @retval   EFI_ACCESS_DENIED     The firmware volume is in the WriteDisabled state
@@ -374,13 +378,16 @@ FvbWriteBlock (
 EFI_STATUS
 FvbEraseBlock (
   IN EFI_FVB_INSTANCE           *FvbInstance,
-  IN EFI_LBA                    Lba
+  IN EFI_LBA                    Lba,
+  IN UINTN                      NumOfLba
   )
 {
 
   EFI_FVB_ATTRIBUTES_2                    Attributes;
   UINTN                                   LbaAddress;
   UINTN                                   LbaLength;
+  UINTN                                   EraseLength;
+  UINTN                                   NumOfBlocks;
   EFI_STATUS                              Status;
 
   //
@@ -395,12 +402,27 @@ FvbEraseBlock (
   //
   // Get the starting address of the block for erase.
   //
-  Status = FvbGetLbaAddress (FvbInstance, Lba, &LbaAddress, &LbaLength, NULL);
+  Status = FvbGetLbaAddress (FvbInstance, Lba, &LbaAddress, NULL, NULL);
   if (EFI_ERROR(Status)) {
     return Status;
   }
 
-  Status = SpiFlashBlockErase (LbaAddress, &LbaLength);
+  //
+  // Sum up the block lengths, the range may span several block map entries.
+  //
+  EraseLength = 0;
+  while (NumOfLba > 0) {
+    Status = FvbGetLbaAddress (FvbInstance, Lba, NULL, &LbaLength, &NumOfBlocks);
+    if (EFI_ERROR(Status)) {
+      return Status;
+    }
+    NumOfBlocks  = MIN (NumOfBlocks, NumOfLba);
+    EraseLength += NumOfBlocks * LbaLength;
+    Lba         += NumOfBlocks;
+    NumOfLba    -= NumOfBlocks;
+  }
+
+  Status = SpiFlashBlockErase (LbaAddress, &EraseLength);
   if (EFI_ERROR (Status)) {
     return Status;
   }
@@ -410,7 +432,7 @@ FvbEraseBlock (
     return Status;
   }
 
-  WriteBackInvalidateDataCacheRange ((VOID *) LbaAddress, LbaLength);
+  WriteBackInvalidateDataCacheRange ((VOID *) LbaAddress, EraseLength);
 
   return Status;
 }
@@ -741,6 +763,8 @@ FvbProtocolEraseBlocks (
   VA_LIST                               Args;
   EFI_LBA                               StartingLba;
   UINTN                                 NumOfLba;
+  EFI_LBA                               PendingLba;
+  UINTN                                 PendingNumOfLba;
   EFI_STATUS                            Status;
 
   DEBUG((DEBUG_INFO, "FvbProtocolEraseBlocks: \n"));
@@ -768,12 +792,19 @@ FvbProtocolEraseBlocks (
     }
 
     if ( ( StartingLba + NumOfLba ) > NumOfBlocks ) {
+      VA_END (Args);
       return EFI_INVALID_PARAMETER;
     }
   } while ( 1 );
 
   VA_END (Args);
 
+  //
+  // Merge the ranges which follow each other in the list, each merged range
+  // is erased with one request.
+  //
+  PendingLba      = 0;
+  PendingNumOfLba = 0;
   VA_START (Args, This);
   do {
     StartingLba = VA_ARG (Args, EFI_LBA);
@@ -783,20 +814,29 @@ FvbProtocolEraseBlocks (
 
     NumOfLba = VA_ARG (Args, UINT32);
 
-    while ( NumOfLba > 0 ) {
-      Status = FvbEraseBlock (FvbInstance, StartingLba);
+    if ((PendingNumOfLba != 0) && (StartingLba == PendingLba + PendingNumOfLba)) {
+      PendingNumOfLba += NumOfLba;
+      continue;
+    }
+
+    if (PendingNumOfLba != 0) {
+      Status = FvbEraseBlock (FvbInstance, PendingLba, PendingNumOfLba);
       if ( EFI_ERROR(Status)) {
         VA_END (Args);
         return Status;
       }
-      StartingLba ++;
-      NumOfLba --;
     }
+    PendingLba      = StartingLba;
+    PendingNumOfLba = NumOfLba;
 
   } while ( 1 );
 
   VA_END (Args);
 
+  if (PendingNumOfLba != 0) {
+    return FvbEraseBlock (FvbInstance, PendingLba, PendingNumOfLba);
+  }
+
   return EFI_SUCCESS;
 }
 
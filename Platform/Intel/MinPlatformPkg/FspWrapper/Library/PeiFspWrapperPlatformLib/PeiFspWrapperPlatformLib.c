@@ -8,14 +8,99 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include <PiPei.h>
 #include <Library/PcdLib.h>
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
+#include <Library/HobLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/PeiServicesLib.h>
 #include <Library/FspWrapperApiLib.h>
 #include <Library/SiliconPolicyInitLib.h>
 #include <Library/SiliconPolicyUpdateLib.h>
+#include <Ppi/ReadOnlyVariable2.h>
+#include <Guid/FspNonVolatileStorageHob.h>
+#include <Guid/MemoryConfigInfo.h>
+#include <FspEas.h>
 
+/**
+  Check the saved memory configuration passed to FSP-M against the record
+  SaveMemoryConfig keeps with it, and report the boot path in a
+  gMemoryConfigInfoGuid HOB.
+
+  Data which doesn't match its record is dropped, FSP-M then does the full
+  memory training.
+
+  @param[in,out] FspmUpd        A pointer to the FSP-M UPD data region.
+
+**/
+VOID
+CheckMemoryConfig (
+  IN OUT FSPM_UPD_COMMON  *FspmUpd
+  )
+{
+  EFI_STATUS                        Status;
+  EFI_PEI_READ_ONLY_VARIABLE2_PPI   *VariableServices;
+  MEMORY_CONFIG_INFO                MemoryConfigInfo;
+  MEMORY_CONFIG_BOOT_PATH_HOB       BootPathHob;
+  UINTN                             DataSize;
+
+  BootPathHob.BootPath = MEMORY_CONFIG_BOOT_PATH_FULL_TRAINING;
+
+  if (FspmUpd->FspmArchUpd.NvsBufferPtr != NULL) {
+    BootPathHob.BootPath = MEMORY_CONFIG_BOOT_PATH_REJECTED;
+
+    Status = PeiServicesLocatePpi (
+               &gEfiPeiReadOnlyVariable2PpiGuid,
+               0,
+               NULL,
+               (VOID **) &VariableServices
+               );
+    if (!EFI_ERROR (Status)) {
+      DataSize = sizeof (MemoryConfigInfo);
+      Status = VariableServices->GetVariable (
+                                   VariableServices,
+                                   MEMORY_CONFIG_INFO_VARIABLE_NAME,
+                                   &gFspNonVolatileStorageHobGuid,
+                                   NULL,
+                                   &DataSize,
+                                   &MemoryConfigInfo
+                                   );
+      if (Status == EFI_NOT_FOUND) {
+        //
+        // Saved by a firmware without the record, keep the data.
+        //
+        BootPathHob.BootPath = MEMORY_CONFIG_BOOT_PATH_UNCHECKED;
+      } else if (!EFI_ERROR (Status)) {
+        //
+        // The board passes the L"MemoryConfig" variable, its size bounds the
+        // CRC calculation.
+        //
+        DataSize = 0;
+        Status = VariableServices->GetVariable (
+                                     VariableServices,
+                                     L"MemoryConfig",
+                                     &gFspNonVolatileStorageHobGuid,
+                                     NULL,
+                                     &DataSize,
+                                     NULL
+                                     );
+        if ((Status == EFI_BUFFER_TOO_SMALL) &&
+            (DataSize == MemoryConfigInfo.DataSize) &&
+            (CalculateCrc32 (FspmUpd->FspmArchUpd.NvsBufferPtr, DataSize) == MemoryConfigInfo.DataCrc32)) {
+          BootPathHob.BootPath = MEMORY_CONFIG_BOOT_PATH_FAST;
+        }
+      }
+    }
+
+    if (BootPathHob.BootPath == MEMORY_CONFIG_BOOT_PATH_REJECTED) {
+      DEBUG ((DEBUG_WARN, "Saved memory configuration doesn't match its record, do the full training\n"));
+      FspmUpd->FspmArchUpd.NvsBufferPtr = NULL;
+    }
+  }
+
+  DEBUG ((DEBUG_INFO, "Memory configuration boot path: %d\n", BootPathHob.BootPath));
+  BuildGuidDataHob (&gMemoryConfigInfoGuid, &BootPathHob, sizeof (BootPathHob));
+}
 
 /**
   This function overrides the default configurations in the FSP-M UPD data region.
@@ -34,6 +119,8 @@ UpdateFspmUpdData (
   SiliconPolicyInitPreMem (FspUpdRgnPtr);
   SiliconPolicyUpdatePreMem (FspUpdRgnPtr);
   SiliconPolicyDonePreMem (FspUpdRgnPtr);
+
+  CheckMemoryConfig ((FSPM_UPD_COMMON *) FspUpdRgnPtr);
 }
 
 /**
@@ -14,6 +14,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Ppi/TopOfTemporaryRam.h>
 #include <Ppi/PeiCoreFvLocation.h>
 #include <Guid/FirmwareFileSystem2.h>
+#include <Guid/TemporaryRamUsage.h>
 
 #include <Library/LocalApicLib.h>
 #include <Library/BaseMemoryLib.h>
@@ -92,6 +93,14 @@ EFI_PEI_PPI_DESCRIPTOR  mPeiSecPlatformPpi[] = {
   },
 };
 
+EFI_PEI_PPI_DESCRIPTOR  mTemporaryRamUsagePpiList[] = {
+  {
+    EFI_PEI_PPI_DESCRIPTOR_PPI | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST,
+    &gTemporaryRamUsageGuid,
+    NULL // To be patched later.
+  }
+};
+
 #define LEGACY_8259_MASK_REGISTER_MASTER                  0x21
 #define LEGACY_8259_MASK_REGISTER_SLAVE                   0xA1
 #define LEGACY_8259_EDGE_LEVEL_TRIGGERED_REGISTER_MASTER  0x4D0
@@ -118,6 +127,60 @@ Interrupt8259WriteMask (
   IoWrite8 (LEGACY_8259_EDGE_LEVEL_TRIGGERED_REGISTER_SLAVE, (UINT8) (EdgeLevel >> 8));
 }
 
+/**
+  Reserve the temporary RAM usage record below the PEI heap, and fill the
+  PEI heap and the unused part of the stack with TEMPORARY_RAM_USAGE_PATTERN.
+
+  The record is followed by ReservedSize bytes for the caller, which are not
+  part of the heap either.
+
+  @param[in,out] SecCoreData           The SEC to PEI handoff data, the PEI heap
+                                       is shrunk by the reserved part.
+  @param[in]     ReservedSize          Size to reserve after the record.
+
+  @return The temporary RAM usage record.
+**/
+TEMPORARY_RAM_USAGE *
+InitializeTemporaryRamUsage (
+  IN OUT EFI_SEC_PEI_HAND_OFF        *SecCoreData,
+  IN     UINTN                       ReservedSize
+  )
+{
+  TEMPORARY_RAM_USAGE         *TempRamUsage;
+  UINTN                       StackFillEnd;
+
+  TempRamUsage = (TEMPORARY_RAM_USAGE *) SecCoreData->PeiTemporaryRamBase;
+  ReservedSize = ALIGN_VALUE (sizeof (TEMPORARY_RAM_USAGE) + ReservedSize, 8);
+  SecCoreData->PeiTemporaryRamBase = (VOID *) ((UINTN) SecCoreData->PeiTemporaryRamBase + ReservedSize);
+  SecCoreData->PeiTemporaryRamSize -= ReservedSize;
+
+  ZeroMem (TempRamUsage, sizeof (TEMPORARY_RAM_USAGE));
+  TempRamUsage->HeapBase  = (UINTN) SecCoreData->PeiTemporaryRamBase;
+  TempRamUsage->HeapSize  = SecCoreData->PeiTemporaryRamSize & ~(sizeof (UINT32) - 1);
+  TempRamUsage->StackBase = (UINTN) SecCoreData->StackBase;
+  TempRamUsage->StackSize = SecCoreData->StackSize;
+
+  SetMem32 (
+    SecCoreData->PeiTemporaryRamBase,
+    (UINTN) TempRamUsage->HeapSize,
+    TEMPORARY_RAM_USAGE_PATTERN
+    );
+
+  //
+  // SEC runs on this stack, keep a page between the pattern and the current frame.
+  //
+  StackFillEnd = ((UINTN) &TempRamUsage & ~EFI_PAGE_MASK) - EFI_PAGE_SIZE;
+  if (StackFillEnd > (UINTN) SecCoreData->StackBase) {
+    SetMem32 (
+      SecCoreData->StackBase,
+      (StackFillEnd - (UINTN) SecCoreData->StackBase) & ~(sizeof (UINT32) - 1),
+      TEMPORARY_RAM_USAGE_PATTERN
+      );
+  }
+
+  return TempRamUsage;
+}
+
 /**
   A developer supplied function to perform platform specific operations.
 
@@ -144,6 +207,7 @@ SecPlatformMain (
   EFI_PEI_PPI_DESCRIPTOR      *PpiList;
   UINT8                       TopOfTemporaryRamPpiIndex;
   UINT8                       *CopyDestinationPointer;
+  TEMPORARY_RAM_USAGE         *TempRamUsage;
 
   DEBUG ((DEBUG_INFO, "FSP Wrapper BootFirmwareVolumeBase - 0x%x\n", SecCoreData->BootFirmwareVolumeBase));
   DEBUG ((DEBUG_INFO, "FSP Wrapper BootFirmwareVolumeSize - 0x%x\n", SecCoreData->BootFirmwareVolumeSize));
@@ -161,11 +225,24 @@ SecPlatformMain (
   //
   Interrupt8259WriteMask (0xFFFF, 0x0000);
 
-  //
-  // Use middle of Heap as temp buffer, it will be copied by caller.
-  // Do not use Stack, because it will cause wrong calculation on stack by PeiCore
-  //
-  PpiList = (VOID *)((UINTN) SecCoreData->PeiTemporaryRamBase + (UINTN) SecCoreData->PeiTemporaryRamSize/2);
+  if (FeaturePcdGet (PcdTemporaryRamUsageReportEnable)) {
+    //
+    // Keep the PPI list next to the usage record, below the heap, so that it
+    // does not count as heap usage.
+    //
+    TempRamUsage = InitializeTemporaryRamUsage (
+                     SecCoreData,
+                     sizeof (mPeiCoreFvLocationPpiList) + sizeof (mPeiSecPlatformPpi) + sizeof (mTemporaryRamUsagePpiList)
+                     );
+    PpiList = (EFI_PEI_PPI_DESCRIPTOR *) (TempRamUsage + 1);
+  } else {
+    TempRamUsage = NULL;
+    //
+    // Use middle of Heap as temp buffer, it will be copied by caller.
+    // Do not use Stack, because it will cause wrong calculation on stack by PeiCore
+    //
+    PpiList = (VOID *)((UINTN) SecCoreData->PeiTemporaryRamBase + (UINTN) SecCoreData->PeiTemporaryRamSize/2);
+  }
   CopyDestinationPointer = (UINT8 *) PpiList;
   TopOfTemporaryRamPpiIndex = 0;
   if ((PcdGet8 (PcdFspModeSelection) == 0) && PcdGetBool (PcdFspDispatchModeUseFspPeiMain)) {
@@ -181,6 +258,15 @@ SecPlatformMain (
   // Patch TopOfTemporaryRamPpi
   //
   PpiList[TopOfTemporaryRamPpiIndex].Ppi = (VOID *)((UINTN) SecCoreData->TemporaryRamBase + SecCoreData->TemporaryRamSize);
+  if (TempRamUsage != NULL) {
+    //
+    // Append TemporaryRamUsagePpi to the list
+    //
+    PpiList[TopOfTemporaryRamPpiIndex + 1].Flags &= ~EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST;
+    CopyDestinationPointer += sizeof (mPeiSecPlatformPpi);
+    CopyMem (CopyDestinationPointer, mTemporaryRamUsagePpiList, sizeof (mTemporaryRamUsagePpiList));
+    PpiList[TopOfTemporaryRamPpiIndex + 2].Ppi = TempRamUsage;
+  }
 
   return PpiList;
 }
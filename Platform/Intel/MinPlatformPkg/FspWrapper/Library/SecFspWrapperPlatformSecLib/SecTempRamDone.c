@@ -11,6 +11,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Ppi/TemporaryRamDone.h>
 #include <Ppi/TempRamExitPpi.h>
 #include <Ppi/PlatformInitTempRamExitPpi.h>
+#include <Guid/TemporaryRamUsage.h>
 
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
@@ -20,6 +21,74 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/FspWrapperApiLib.h>
 #include <Library/PeiServicesTablePointerLib.h>
 
+/**
+  Find the peak usage of the PEI heap and stack in temporary RAM, and publish
+  it in the gTemporaryRamUsageGuid HOB.
+
+  @param[in] PeiServices   An indirect pointer to the EFI_PEI_SERVICES table.
+**/
+VOID
+ReportTemporaryRamUsage (
+  IN CONST EFI_PEI_SERVICES         **PeiServices
+  )
+{
+  EFI_STATUS                        Status;
+  TEMPORARY_RAM_USAGE               *TempRamUsage;
+  EFI_HOB_GUID_TYPE                 *GuidHob;
+  UINT32                            *Pointer;
+  UINT32                            *End;
+  UINT64                            Unused;
+
+  Status = (*PeiServices)->LocatePpi (
+                            PeiServices,
+                            &gTemporaryRamUsageGuid,
+                            0,
+                            NULL,
+                            (VOID **) &TempRamUsage
+                            );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  //
+  // The heap is allocated from both ends, count the words still holding the pattern.
+  //
+  Unused = 0;
+  End = (UINT32 *) (UINTN) (TempRamUsage->HeapBase + TempRamUsage->HeapSize);
+  for (Pointer = (UINT32 *) (UINTN) TempRamUsage->HeapBase; Pointer < End; Pointer++) {
+    if (*Pointer == TEMPORARY_RAM_USAGE_PATTERN) {
+      Unused += sizeof (UINT32);
+    }
+  }
+  TempRamUsage->HeapUsed = TempRamUsage->HeapSize - Unused;
+
+  //
+  // The stack grows down, find the lowest word that was written.
+  //
+  End = (UINT32 *) (UINTN) (TempRamUsage->StackBase + TempRamUsage->StackSize);
+  for (Pointer = (UINT32 *) (UINTN) TempRamUsage->StackBase; Pointer < End; Pointer++) {
+    if (*Pointer != TEMPORARY_RAM_USAGE_PATTERN) {
+      break;
+    }
+  }
+  TempRamUsage->StackUsed = (UINTN) End - (UINTN) Pointer;
+
+  DEBUG ((DEBUG_INFO, "Temporary RAM heap  - 0x%lx of 0x%lx bytes used\n", TempRamUsage->HeapUsed, TempRamUsage->HeapSize));
+  DEBUG ((DEBUG_INFO, "Temporary RAM stack - 0x%lx of 0x%lx bytes used\n", TempRamUsage->StackUsed, TempRamUsage->StackSize));
+
+  Status = (*PeiServices)->CreateHob (
+                             PeiServices,
+                             EFI_HOB_TYPE_GUID_EXTENSION,
+                             (UINT16) (sizeof (EFI_HOB_GUID_TYPE) + sizeof (TEMPORARY_RAM_USAGE)),
+                             (VOID **) &GuidHob
+                             );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+  CopyGuid (&GuidHob->Name, &gTemporaryRamUsageGuid);
+  CopyMem (GuidHob + 1, TempRamUsage, sizeof (TEMPORARY_RAM_USAGE));
+}
+
 /**
 This interface disables temporary memory in SEC Phase.
 **/
@@ -57,6 +126,10 @@ SecPlatformDisableTemporaryMemory (
     return;
   }
 
+  if (FeaturePcdGet (PcdTemporaryRamUsageReportEnable)) {
+    ReportTemporaryRamUsage (PeiServices);
+  }
+
   Status = PlatformInitTempRamExitPpi->PlatformInitBeforeTempRamExit ();
   ASSERT_EFI_ERROR (Status);
 
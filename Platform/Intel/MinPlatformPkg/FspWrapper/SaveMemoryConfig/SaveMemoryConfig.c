@@ -17,6 +17,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/MemoryAllocationLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Protocol/VariableLock.h>
+#include <Guid/MemoryConfigInfo.h>
 
 /**
   This is the standard EFI driver point that detects whether there is a
@@ -41,6 +42,8 @@ SaveMemoryConfigEntryPoint (
   UINTN             DataSize;
   UINTN             BufferSize;
   EDKII_VARIABLE_LOCK_PROTOCOL        *VariableLock;
+  MEMORY_CONFIG_INFO                  MemoryConfigInfo;
+  MEMORY_CONFIG_INFO                  SavedMemoryConfigInfo;
 
   DataSize     = 0;
   VariableData = NULL;
@@ -101,6 +104,32 @@ SaveMemoryConfigEntryPoint (
         DEBUG((DEBUG_INFO, "Restored Size is 0x%x\n", DataSize));
       }
 
+      //
+      // Record the size and CRC of the data, PEI checks them before passing
+      // the data to FSP-M.
+      //
+      MemoryConfigInfo.DataSize  = (UINT32) DataSize;
+      MemoryConfigInfo.DataCrc32 = 0;
+      gBS->CalculateCrc32 (HobData, DataSize, &MemoryConfigInfo.DataCrc32);
+      BufferSize = sizeof (SavedMemoryConfigInfo);
+      Status = gRT->GetVariable (
+                      MEMORY_CONFIG_INFO_VARIABLE_NAME,
+                      &gFspNonVolatileStorageHobGuid,
+                      NULL,
+                      &BufferSize,
+                      &SavedMemoryConfigInfo
+                      );
+      if ((EFI_ERROR(Status)) || 0 != CompareMem (&SavedMemoryConfigInfo, &MemoryConfigInfo, sizeof (MemoryConfigInfo))) {
+        Status = gRT->SetVariable (
+                        MEMORY_CONFIG_INFO_VARIABLE_NAME,
+                        &gFspNonVolatileStorageHobGuid,
+                        (EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS),
+                        sizeof (MemoryConfigInfo),
+                        &MemoryConfigInfo
+                        );
+        ASSERT_EFI_ERROR (Status);
+      }
+
       //
       // Mark MemoryConfig to read-only if the Variable Lock protocol exists
       //
@@ -108,6 +137,8 @@ SaveMemoryConfigEntryPoint (
       if (!EFI_ERROR(Status)) {
         Status = VariableLock->RequestToLock(VariableLock, L"MemoryConfig", &gFspNonVolatileStorageHobGuid);
         ASSERT_EFI_ERROR(Status);
+        Status = VariableLock->RequestToLock(VariableLock, MEMORY_CONFIG_INFO_VARIABLE_NAME, &gFspNonVolatileStorageHobGuid);
+        ASSERT_EFI_ERROR(Status);
       }
 
       FreePool (VariableData);
@@ -214,7 +214,14 @@ OnReadyToBoot (
   )
 {
   UpdateData (PLATFORM_SECURITY_ROLE_PLATFORM_IBV);
+
+  //
+  // Reading the table back allocates a copy of it, only do so when the
+  // dump is going to be printed.
+  //
+  DEBUG_CODE_BEGIN ();
   DumpData (PLATFORM_SECURITY_ROLE_PLATFORM_IBV);
+  DEBUG_CODE_END ();
 
   if (Event != NULL) {
     gBS->CloseEvent (Event);
@@ -0,0 +1,44 @@
+/** @file
+  Definitions of the record that SaveMemoryConfig keeps next to the FSP
+  non-volatile memory data, and of the HOB reporting how the data was used.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _MEMORY_CONFIG_INFO_H_
+#define _MEMORY_CONFIG_INFO_H_
+
+#define MEMORY_CONFIG_INFO_GUID \
+  { \
+    0x68f05bd9, 0x7258, 0x4837, {0x9c, 0xa6, 0xba, 0xdb, 0x61, 0x72, 0xa8, 0xeb } \
+  }
+
+//
+// Name of the variable, under gFspNonVolatileStorageHobGuid, holding the
+// MEMORY_CONFIG_INFO of the L"MemoryConfig" variable.
+//
+#define MEMORY_CONFIG_INFO_VARIABLE_NAME  L"MemoryConfigInfo"
+
+typedef struct {
+  UINT32    DataSize;
+  UINT32    DataCrc32;
+} MEMORY_CONFIG_INFO;
+
+//
+// Data of the gMemoryConfigInfoGuid HOB, how the saved memory configuration
+// was handed to FSP-M.
+//
+#define MEMORY_CONFIG_BOOT_PATH_FULL_TRAINING  0  // No saved data
+#define MEMORY_CONFIG_BOOT_PATH_FAST           1  // Saved data passed to FSP-M
+#define MEMORY_CONFIG_BOOT_PATH_REJECTED       2  // Saved data failed the check
+#define MEMORY_CONFIG_BOOT_PATH_UNCHECKED      3  // Saved data passed without a record
+
+typedef struct {
+  UINT32    BootPath;
+} MEMORY_CONFIG_BOOT_PATH_HOB;
+
+extern EFI_GUID gMemoryConfigInfoGuid;
+
+#endif
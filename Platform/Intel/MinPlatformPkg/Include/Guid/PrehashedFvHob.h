@@ -0,0 +1,26 @@
+/** @file
+  Definitions of the prehashed FV HOB.
+
+  A verified-boot stage running before ReportFvPei may hand over the digests of
+  the firmware volumes it already verified, one gPrehashedFvHobGuid HOB per FV.
+  The data of the HOB is an EDKII_PEI_FIRMWARE_VOLUME_INFO_PREHASHED_FV_PPI
+  followed by its HASH_INFO entries. PeiReportFvLib installs it as the PPI
+  before reporting the FV, so that Tcg2Pei extends the given digests instead
+  of hashing the FV again.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _PREHASHED_FV_HOB_H_
+#define _PREHASHED_FV_HOB_H_
+
+#define PREHASHED_FV_HOB_GUID \
+  { \
+    0x35f82efa, 0xaac7, 0x4dfd, {0xa2, 0x49, 0xc0, 0xd9, 0xee, 0xda, 0x80, 0xf0 } \
+  }
+
+extern EFI_GUID gPrehashedFvHobGuid;
+
+#endif
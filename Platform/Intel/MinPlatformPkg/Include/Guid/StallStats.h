@@ -0,0 +1,48 @@
+/** @file
+  Definitions of the stall statistics.
+
+  StallServicePei and StallStatsDxe account every stall to the return address
+  of its caller. The PEI statistics are kept in a gStallStatsGuid HOB, the DXE
+  driver takes them over and publishes both phases as a gStallStatsGuid
+  configuration table, which is dumped by TestPointDumpApp.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _STALL_STATS_H_
+#define _STALL_STATS_H_
+
+#define STALL_STATS_GUID \
+  { \
+    0x86d21ad3, 0xa40a, 0x401e, {0x80, 0x1f, 0xa0, 0x17, 0xb5, 0xc2, 0x2c, 0x8b } \
+  }
+
+#define STALL_STATS_MAX_ENTRIES  64
+
+#define STALL_STATS_PHASE_PEI    0
+#define STALL_STATS_PHASE_DXE    1
+
+typedef struct {
+  UINT64    Caller;               // Return address of the Stall () call
+  UINT32    Phase;                // STALL_STATS_PHASE_*
+  UINT32    Count;
+  UINT64    TotalMicroseconds;
+  UINT64    MaxMicroseconds;
+} STALL_STATS_ENTRY;
+
+typedef struct {
+  UINT32               EntryCount;
+  UINT32               Reserved;
+  //
+  // Stalls that could not be accounted to their caller as the table was full
+  //
+  UINT64               DroppedCount;
+  UINT64               DroppedMicroseconds;
+  STALL_STATS_ENTRY    Entry[STALL_STATS_MAX_ENTRIES];
+} STALL_STATS;
+
+extern EFI_GUID gStallStatsGuid;
+
+#endif
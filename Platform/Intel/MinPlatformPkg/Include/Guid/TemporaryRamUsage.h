@@ -0,0 +1,36 @@
+/** @file
+  Definitions of the temporary RAM usage report.
+
+  SecFspWrapperPlatformSecLib fills the PEI heap and stack in temporary RAM
+  with TEMPORARY_RAM_USAGE_PATTERN and passes their layout to PEI as the
+  gTemporaryRamUsageGuid PPI. Before temporary RAM is disabled it finds the
+  high-water marks and publishes the result as a gTemporaryRamUsageGuid HOB,
+  which is checked by TestPointCheckLib.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef _TEMPORARY_RAM_USAGE_H_
+#define _TEMPORARY_RAM_USAGE_H_
+
+#define TEMPORARY_RAM_USAGE_GUID \
+  { \
+    0xa7769180, 0x5928, 0x4750, {0xae, 0xfd, 0x18, 0x37, 0xb4, 0x06, 0xf1, 0x53 } \
+  }
+
+#define TEMPORARY_RAM_USAGE_PATTERN  0x5AA55AA5
+
+typedef struct {
+  UINT64    HeapBase;
+  UINT64    HeapSize;
+  UINT64    HeapUsed;             // Peak, from HeapBase up
+  UINT64    StackBase;
+  UINT64    StackSize;
+  UINT64    StackUsed;            // Peak, from StackBase + StackSize down
+} TEMPORARY_RAM_USAGE;
+
+extern EFI_GUID gTemporaryRamUsageGuid;
+
+#endif
@@ -15,6 +15,7 @@
 #include <Library/MemoryAllocationLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
 #include <Uefi/UefiBaseType.h>
 
 #define SHELL_FREE_NON_NULL(Pointer)  \
@@ -43,6 +44,12 @@ typedef INT16             NODE;
 #define NIL               0
 #define MAX_HASH_VAL      (3 * WNDSIZ + (WNDSIZ / 512 + 1) * MAX_UINT8)
 #define HASH(LoopVar7, LoopVar5)        ((LoopVar7) + ((LoopVar5) << (WNDBIT - 9)) + WNDSIZ * 2)
+#define HASH_CHAIN_BIT    14
+#define HASH_CHAIN_SIZE   (1U << HASH_CHAIN_BIT)
+#define HASH_CHAIN_NIL    (-1)
+#define HASH_CHAIN_MAX    32
+#define HASH_CHAIN_GOOD   64
+#define HASH_CHAIN_KEY(Pos)  ((((UINT32) mText[Pos] << 10) ^ ((UINT32) mText[(Pos) + 1] << 5) ^ mText[(Pos) + 2]) & (HASH_CHAIN_SIZE - 1))
 #define CRCPOLY           0xA001
 #define UPDATE_CRC(LoopVar5)     mCrc = mCrcTable[(mCrc ^ (LoopVar5)) & 0xFF] ^ (mCrc >> UINT8_BIT)
 
@@ -125,6 +132,15 @@ STATIC NODE   *mPrev;
 STATIC NODE   *mNext = NULL;
 INT32         mHuffmanDepth = 0;
 
+//
+// Hash chain match finder, used instead of the String Info Log for inputs
+// of PcdCompressHashChainThreshold bytes or more.
+//
+STATIC BOOLEAN mHashChain;
+STATIC NODE    *mHashHead;
+STATIC NODE    *mHashPrev;
+STATIC BOOLEAN mHashInsertOnly;
+
 /**
   Make a CRC table.
 
@@ -196,12 +212,20 @@ AllocateMemory (
   )
 {
   mText       = AllocateZeroPool (WNDSIZ * 2 + MAXMATCH);
-  mLevel      = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mLevel));
-  mChildCount = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mChildCount));
-  mPosition   = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mPosition));
-  mParent     = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mParent));
-  mPrev       = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mPrev));
-  mNext       = AllocateZeroPool ((MAX_HASH_VAL + 1) * sizeof (*mNext));
+  if (mHashChain) {
+    mHashHead = AllocatePool (HASH_CHAIN_SIZE * sizeof (*mHashHead));
+    mHashPrev = AllocatePool (WNDSIZ * 2 * sizeof (*mHashPrev));
+    if (mText == NULL || mHashHead == NULL || mHashPrev == NULL) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+  } else {
+    mLevel      = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mLevel));
+    mChildCount = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mChildCount));
+    mPosition   = AllocateZeroPool ((WNDSIZ + MAX_UINT8 + 1) * sizeof (*mPosition));
+    mParent     = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mParent));
+    mPrev       = AllocateZeroPool (WNDSIZ * 2 * sizeof (*mPrev));
+    mNext       = AllocateZeroPool ((MAX_HASH_VAL + 1) * sizeof (*mNext));
+  }
 
   mBufSiz     = BLKSIZ;
   mBuf        = AllocateZeroPool (mBufSiz);
@@ -236,9 +260,99 @@ FreeMemory (
   SHELL_FREE_NON_NULL (mParent);
   SHELL_FREE_NON_NULL (mPrev);
   SHELL_FREE_NON_NULL (mNext);
+  SHELL_FREE_NON_NULL (mHashHead);
+  SHELL_FREE_NON_NULL (mHashPrev);
   SHELL_FREE_NON_NULL (mBuf);
 }
 
+/**
+  Initialize the hash chain data structures.
+**/
+VOID
+EFIAPI
+InitHashChain (
+  VOID
+  )
+{
+  SetMem (mHashHead, HASH_CHAIN_SIZE * sizeof (NODE), 0xFF);
+  SetMem (mHashPrev, WNDSIZ * 2 * sizeof (NODE), 0xFF);
+}
+
+/**
+  Move the hash chains along with the text when the window slides by WNDSIZ.
+**/
+VOID
+EFIAPI
+SlideHashChain (
+  VOID
+  )
+{
+  UINT32  LoopVar1;
+
+  for (LoopVar1 = 0; LoopVar1 < HASH_CHAIN_SIZE; LoopVar1++) {
+    mHashHead[LoopVar1] = (NODE) ((mHashHead[LoopVar1] >= (NODE) WNDSIZ) ? (mHashHead[LoopVar1] - WNDSIZ) : HASH_CHAIN_NIL);
+  }
+
+  for (LoopVar1 = 0; LoopVar1 < WNDSIZ; LoopVar1++) {
+    mHashPrev[LoopVar1] = (NODE) ((mHashPrev[LoopVar1 + WNDSIZ] >= (NODE) WNDSIZ) ? (mHashPrev[LoopVar1 + WNDSIZ] - WNDSIZ) : HASH_CHAIN_NIL);
+  }
+  SetMem (mHashPrev + WNDSIZ, WNDSIZ * sizeof (NODE), 0xFF);
+}
+
+/**
+  Find the longest match for current position among the last HASH_CHAIN_MAX
+  positions sharing its hash, then insert current position in the chain.
+
+  The search stops at the first match of HASH_CHAIN_GOOD bytes, and is
+  skipped when mHashInsertOnly is set.
+
+**/
+VOID
+EFIAPI
+InsertHashChain (
+  VOID
+  )
+{
+  UINT32  Key;
+  UINT32  ChainLength;
+  INT32   Length;
+  NODE    Candidate;
+  UINT8   *TempString3;
+  UINT8   *TempString2;
+
+  Key       = HASH_CHAIN_KEY (mPos);
+  Candidate = mHashInsertOnly ? HASH_CHAIN_NIL : mHashHead[Key];
+  mMatchLen = 0;
+  for (ChainLength = 0; Candidate != HASH_CHAIN_NIL && ChainLength < HASH_CHAIN_MAX; ChainLength++) {
+    //
+    // The older positions are out of the window.
+    //
+    if (mPos - Candidate >= (NODE) WNDSIZ) {
+      break;
+    }
+
+    TempString3 = &mText[mPos];
+    TempString2 = &mText[Candidate];
+    if (TempString3[mMatchLen] == TempString2[mMatchLen]) {
+      for (Length = 0; Length < MAXMATCH && TempString3[Length] == TempString2[Length]; Length++) {
+      }
+
+      if (Length > mMatchLen) {
+        mMatchLen = Length;
+        mMatchPos = Candidate;
+        if (mMatchLen >= HASH_CHAIN_GOOD) {
+          break;
+        }
+      }
+    }
+
+    Candidate = mHashPrev[Candidate];
+  }
+
+  mHashPrev[mPos] = mHashHead[Key];
+  mHashHead[Key]  = mPos;
+}
+
 /**
   Initialize String Info Log data structures.
 **/
@@ -639,10 +753,17 @@ GetNextMatch (
     LoopVar8 = FreadCrc (&mText[WNDSIZ + MAXMATCH], WNDSIZ);
     mRemainder += LoopVar8;
     mPos = WNDSIZ;
+    if (mHashChain) {
+      SlideHashChain ();
+    }
   }
 
-  DeleteNode ();
-  InsertNode ();
+  if (mHashChain) {
+    InsertHashChain ();
+  } else {
+    DeleteNode ();
+    InsertNode ();
+  }
 
   return (TRUE);
 }
@@ -1296,7 +1417,11 @@ Encode (
     return Status;
   }
 
-  InitSlide ();
+  if (mHashChain) {
+    InitHashChain ();
+  } else {
+    InitSlide ();
+  }
 
   HufEncodeStart ();
 
@@ -1304,7 +1429,11 @@ Encode (
 
   mMatchLen   = 0;
   mPos        = WNDSIZ;
-  InsertNode ();
+  if (mHashChain) {
+    InsertHashChain ();
+  } else {
+    InsertNode ();
+  }
   if (mMatchLen > mRemainder) {
     mMatchLen = mRemainder;
   }
@@ -1334,11 +1463,16 @@ Encode (
         (mPos - LastMatchPos - 2) & (WNDSIZ - 1));
       LastMatchLen--;
       while (LastMatchLen > 0) {
+        //
+        // Only the match of the last position of the pointer is used.
+        //
+        mHashInsertOnly = (BOOLEAN) (LastMatchLen > 1);
         if (!GetNextMatch ()) {
           Status = EFI_OUT_OF_RESOURCES;
         }
         LastMatchLen--;
       }
+      mHashInsertOnly = FALSE;
 
       if (mMatchLen > mRemainder) {
         mMatchLen = mRemainder;
@@ -1386,6 +1520,15 @@ Compress (
   mParent         = NULL;
   mPrev           = NULL;
   mNext           = NULL;
+  mHashHead       = NULL;
+  mHashPrev       = NULL;
+  mHashInsertOnly = FALSE;
+
+  //
+  // The hash chain match finder is faster on large inputs, at the cost of
+  // slightly longer output.
+  //
+  mHashChain      = (BOOLEAN) (SrcSize >= PcdGet32 (PcdCompressHashChainThreshold));
 
   mSrc            = SrcBuffer;
   mSrcUpperLimit  = mSrc + SrcSize;
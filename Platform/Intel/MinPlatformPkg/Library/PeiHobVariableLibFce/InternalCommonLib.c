@@ -8,6 +8,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Uefi.h>
 #include <PiPei.h>
 #include <Library/PeiServicesTablePointerLib.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/HobVariableLib.h>
@@ -406,6 +407,215 @@ EFI_PEI_NOTIFY_DESCRIPTOR mMemoryNotifyList = {
   BuildDefaultDataHobForRecoveryVariable 
 };
 
+//
+// Largest data a GUID HOB can hold.
+//
+#define VARIABLE_INDEX_MAX_SIZE  (0xFFF8 - sizeof (EFI_HOB_GUID_TYPE))
+
+/**
+  Hash a variable name and vendor GUID.
+
+  @param[in]  Name        Pointer to the variable name.
+  @param[in]  NameSize    Size of the variable name in bytes, including the
+                          null terminator.
+  @param[in]  VendorGuid  Pointer to the vendor GUID.
+
+  @return The 32-bit FNV-1a hash of the name and GUID.
+
+**/
+STATIC
+UINT32
+GetVariableHash (
+  IN CONST VOID                 *Name,
+  IN UINTN                      NameSize,
+  IN CONST EFI_GUID             *VendorGuid
+  )
+{
+  CONST UINT8                   *Ptr;
+  UINTN                         Index;
+  UINT32                        Hash;
+
+  Hash = 0x811C9DC5;
+  Ptr  = Name;
+  for (Index = 0; Index < NameSize; Index++) {
+    Hash = (Hash ^ Ptr[Index]) * 0x01000193;
+  }
+  Ptr = (CONST UINT8 *) VendorGuid;
+  for (Index = 0; Index < sizeof (EFI_GUID); Index++) {
+    Hash = (Hash ^ Ptr[Index]) * 0x01000193;
+  }
+
+  return Hash;
+}
+
+/**
+  Build the index of a default variable store in a gHobVariableIndexGuid HOB.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store.
+  @param[in]  AuthFlag             Authenticated variable flag.
+
+  @return Pointer to the index, NULL if it couldn't be built.
+
+**/
+STATIC
+VARIABLE_INDEX_HEADER *
+BuildVariableIndex (
+  IN VARIABLE_STORE_HEADER      *VariableStoreHeader,
+  IN BOOLEAN                    AuthFlag
+  )
+{
+  VARIABLE_INDEX_HEADER         *VariableIndex;
+  VARIABLE_INDEX_ENTRY          *Entry;
+  AUTHENTICATED_VARIABLE_HEADER *StartPtr;
+  AUTHENTICATED_VARIABLE_HEADER *EndPtr;
+  AUTHENTICATED_VARIABLE_HEADER *CurrPtr;
+  UINTN                         Count;
+  UINTN                         Index;
+  UINT32                        Hash;
+
+  StartPtr = GetStartPointer (VariableStoreHeader);
+  EndPtr   = GetEndPointer (VariableStoreHeader);
+
+  Count = 0;
+  for ( CurrPtr = StartPtr
+      ; (CurrPtr < EndPtr) && IsValidVariableHeader (CurrPtr)
+      ; CurrPtr = GetNextVariablePtr (CurrPtr, AuthFlag)
+      ) {
+    if (CurrPtr->State == VAR_ADDED && NameSizeOfVariable (CurrPtr, AuthFlag) != 0) {
+      Count++;
+    }
+  }
+
+  if (Count > (VARIABLE_INDEX_MAX_SIZE - sizeof (VARIABLE_INDEX_HEADER)) / sizeof (VARIABLE_INDEX_ENTRY)) {
+    return NULL;
+  }
+
+  VariableIndex = BuildGuidHob (&gHobVariableIndexGuid, sizeof (VARIABLE_INDEX_HEADER) + Count * sizeof (VARIABLE_INDEX_ENTRY));
+  if (VariableIndex == NULL) {
+    return NULL;
+  }
+  CopyGuid (&VariableIndex->StoreSignature, &VariableStoreHeader->Signature);
+  VariableIndex->StoreSize = VariableStoreHeader->Size;
+  VariableIndex->Count     = 0;
+
+  //
+  // Insert the variables in hash order. Variables with the same hash keep
+  // the store order, so the first match is the one a linear search finds.
+  //
+  Entry = (VARIABLE_INDEX_ENTRY *) (VariableIndex + 1);
+  for ( CurrPtr = StartPtr
+      ; (CurrPtr < EndPtr) && IsValidVariableHeader (CurrPtr)
+      ; CurrPtr = GetNextVariablePtr (CurrPtr, AuthFlag)
+      ) {
+    if (CurrPtr->State != VAR_ADDED || NameSizeOfVariable (CurrPtr, AuthFlag) == 0) {
+      continue;
+    }
+    Hash = GetVariableHash (
+             GetVariableNamePtr (CurrPtr, AuthFlag),
+             NameSizeOfVariable (CurrPtr, AuthFlag),
+             GetVendorGuidPtr (CurrPtr, AuthFlag)
+             );
+    for (Index = VariableIndex->Count; Index > 0 && Entry[Index - 1].Hash > Hash; Index--) {
+      Entry[Index] = Entry[Index - 1];
+    }
+    Entry[Index].Hash   = Hash;
+    Entry[Index].Offset = (UINT32) ((UINTN) CurrPtr - (UINTN) VariableStoreHeader);
+    VariableIndex->Count++;
+  }
+
+  return VariableIndex;
+}
+
+/**
+  Find variable from the index of the default variable store.
+
+  The index is built by the first call, and rebuilt when the variable store
+  is not the indexed one.
+
+  @param[in]  VariableStoreHeader  Pointer to the variable store.
+  @param[in]  VariableName         A Null-terminated string that is the name of the vendor's
+                                   variable.
+  @param[in]  VendorGuid           A unique identifier for the vendor.
+  @param[in]  AuthFlag             Authenticated variable flag.
+  @param[out] Variable             Pointer to variable header, NULL if not found.
+
+  @retval TRUE                     The index was searched.
+  @retval FALSE                    No index is available.
+
+**/
+STATIC
+BOOLEAN
+FindVariableFromIndex (
+  IN  VARIABLE_STORE_HEADER         *VariableStoreHeader,
+  IN  CHAR16                        *VariableName,
+  IN  EFI_GUID                      *VendorGuid,
+  IN  BOOLEAN                       AuthFlag,
+  OUT AUTHENTICATED_VARIABLE_HEADER **Variable
+  )
+{
+  EFI_HOB_GUID_TYPE             *GuidHob;
+  VARIABLE_INDEX_HEADER         *VariableIndex;
+  VARIABLE_INDEX_ENTRY          *Entry;
+  AUTHENTICATED_VARIABLE_HEADER *CurrPtr;
+  UINTN                         NameSize;
+  UINT32                        Hash;
+  UINTN                         Low;
+  UINTN                         High;
+  UINTN                         Middle;
+
+  *Variable     = NULL;
+  VariableIndex = NULL;
+
+  GuidHob = GetFirstGuidHob (&gHobVariableIndexGuid);
+  if (GuidHob != NULL) {
+    VariableIndex = (VARIABLE_INDEX_HEADER *) GET_GUID_HOB_DATA (GuidHob);
+    if (!CompareGuid (&VariableIndex->StoreSignature, &VariableStoreHeader->Signature) ||
+        VariableIndex->StoreSize != VariableStoreHeader->Size) {
+      //
+      // The index is stale, change its HOB type to be unused.
+      //
+      GuidHob->Header.HobType = EFI_HOB_TYPE_UNUSED;
+      VariableIndex = NULL;
+    }
+  }
+  if (VariableIndex == NULL) {
+    VariableIndex = BuildVariableIndex (VariableStoreHeader, AuthFlag);
+    if (VariableIndex == NULL) {
+      return FALSE;
+    }
+  }
+
+  NameSize = StrSize (VariableName);
+  Hash     = GetVariableHash (VariableName, NameSize, VendorGuid);
+
+  //
+  // Find the first entry with the hash.
+  //
+  Entry = (VARIABLE_INDEX_ENTRY *) (VariableIndex + 1);
+  Low   = 0;
+  High  = VariableIndex->Count;
+  while (Low < High) {
+    Middle = (Low + High) / 2;
+    if (Entry[Middle].Hash < Hash) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
+    }
+  }
+
+  for (; Low < VariableIndex->Count && Entry[Low].Hash == Hash; Low++) {
+    CurrPtr = (AUTHENTICATED_VARIABLE_HEADER *) ((UINT8 *) VariableStoreHeader + Entry[Low].Offset);
+    if (NameSizeOfVariable (CurrPtr, AuthFlag) == NameSize &&
+        CompareGuid (VendorGuid, GetVendorGuidPtr (CurrPtr, AuthFlag)) &&
+        CompareMem (VariableName, GetVariableNamePtr (CurrPtr, AuthFlag), NameSize) == 0) {
+      *Variable = CurrPtr;
+      break;
+    }
+  }
+
+  return TRUE;
+}
+
 /**
   Find variable from default variable HOB.
 
@@ -449,6 +659,10 @@ FindVariableFromHob (
     return NULL;
   }
 
+  if (FindVariableFromIndex (VariableStoreHeader, VariableName, VendorGuid, *AuthFlag, &CurrPtr)) {
+    return CurrPtr;
+  }
+
   StartPtr = GetStartPointer (VariableStoreHeader);
   EndPtr   = GetEndPointer (VariableStoreHeader);
   for ( CurrPtr = StartPtr
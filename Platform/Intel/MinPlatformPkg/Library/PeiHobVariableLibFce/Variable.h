@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 extern EFI_GUID gEfiVariableGuid;
 extern EFI_GUID gEfiAuthenticatedVariableGuid;
+extern EFI_GUID gHobVariableIndexGuid;
 
 ///
 /// Alignment of variable name and data, according to the architecture:
@@ -169,4 +170,31 @@ typedef struct {
 
 #pragma pack()
 
+///
+/// Index of the default variable HOB, kept in a gHobVariableIndexGuid HOB.
+/// The entries are sorted by Hash.
+///
+typedef struct {
+  ///
+  /// Hash of the variable name and vendor GUID.
+  ///
+  UINT32      Hash;
+  ///
+  /// Offset of the variable header from the variable store header.
+  ///
+  UINT32      Offset;
+} VARIABLE_INDEX_ENTRY;
+
+typedef struct {
+  ///
+  /// Signature and size of the indexed variable store.
+  ///
+  EFI_GUID    StoreSignature;
+  UINT32      StoreSize;
+  UINT32      Count;
+  //
+  // VARIABLE_INDEX_ENTRY  Entry[Count];
+  //
+} VARIABLE_INDEX_HEADER;
+
 #endif
@@ -19,6 +19,87 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/PeiServicesLib.h>
 #include <Guid/SmramMemoryReserve.h>
 
+//
+// The ranges of one MTRR layout are collected first, and solved together by
+// MtrrSetMemoryAttributesInMtrrSettings () into the fewest variable MTRRs.
+// The result is then written with a single MtrrSetAllMtrrs () call, so that
+// the caches are only disabled and flushed once.
+//
+#define MAX_MTRR_RANGES     16
+#define MTRR_SCRATCH_SIZE   SIZE_16KB
+
+/**
+  Add a range to the MTRR layout being collected.
+
+  @param[in, out] Ranges       The ranges collected so far.
+  @param[in, out] RangeCount   The number of ranges in Ranges.
+  @param[in]      BaseAddress  The base address of the range.
+  @param[in]      Length       The length of the range.
+  @param[in]      Type         The cache type of the range.
+**/
+STATIC
+VOID
+AddMtrrRange (
+  IN OUT MTRR_MEMORY_RANGE      *Ranges,
+  IN OUT UINTN                  *RangeCount,
+  IN     UINT64                 BaseAddress,
+  IN     UINT64                 Length,
+  IN     MTRR_MEMORY_CACHE_TYPE Type
+  )
+{
+  ASSERT (*RangeCount < MAX_MTRR_RANGES);
+  if (*RangeCount >= MAX_MTRR_RANGES) {
+    return;
+  }
+
+  Ranges[*RangeCount].BaseAddress = BaseAddress;
+  Ranges[*RangeCount].Length      = Length;
+  Ranges[*RangeCount].Type        = Type;
+  (*RangeCount)++;
+}
+
+/**
+  Solve the collected ranges into the MTRR settings, and program them.
+
+  Later ranges override the earlier ones where they overlap.
+
+  @param[in, out] MtrrSetting  The MTRR settings, including the default type.
+  @param[in]      Ranges       The ranges collected.
+  @param[in]      RangeCount   The number of ranges in Ranges.
+
+  @retval  EFI_SUCCESS  The MTRRs are programmed.
+  @retval  Others       The ranges do not fit in the MTRRs.
+**/
+STATIC
+EFI_STATUS
+ProgramMtrrRanges (
+  IN OUT MTRR_SETTINGS          *MtrrSetting,
+  IN     MTRR_MEMORY_RANGE      *Ranges,
+  IN     UINTN                  RangeCount
+  )
+{
+  EFI_STATUS                  Status;
+  UINT8                       Scratch[MTRR_SCRATCH_SIZE];
+  UINTN                       ScratchSize;
+
+  ScratchSize = sizeof (Scratch);
+  Status = MtrrSetMemoryAttributesInMtrrSettings (
+             MtrrSetting,
+             Scratch,
+             &ScratchSize,
+             Ranges,
+             RangeCount
+             );
+  ASSERT_EFI_ERROR (Status);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  MtrrSetAllMtrrs (MtrrSetting);
+
+  return EFI_SUCCESS;
+}
+
 /**
   Set Cache Mtrr.
 **/
@@ -38,27 +119,25 @@ SetCacheMtrr (
   EFI_BOOT_MODE               BootMode;
   EFI_RESOURCE_ATTRIBUTE_TYPE ResourceAttribute;
   UINT64                      CacheMemoryLength;
+  MTRR_MEMORY_RANGE           Ranges[MAX_MTRR_RANGES];
+  UINTN                       RangeCount;
 
   ///
   /// Reset all MTRR setting.
   ///
   ZeroMem(&MtrrSetting, sizeof(MTRR_SETTINGS));
+  RangeCount = 0;
 
   ///
   /// Cache the Flash area as WP to boost performance
   ///
-  Status = MtrrSetMemoryAttributeInMtrrSettings (
-                &MtrrSetting,
-                (UINTN) PcdGet32 (PcdFlashAreaBaseAddress),
-                (UINTN) PcdGet32 (PcdFlashAreaSize),
-                CacheWriteProtected
-                );
-  ASSERT_EFI_ERROR (Status);
-
-  ///
-  /// Update MTRR setting from MTRR buffer for Flash Region to be WP to boost performance
-  ///
-  MtrrSetAllMtrrs (&MtrrSetting);
+  AddMtrrRange (
+    Ranges,
+    &RangeCount,
+    (UINTN) PcdGet32 (PcdFlashAreaBaseAddress),
+    (UINTN) PcdGet32 (PcdFlashAreaSize),
+    CacheWriteProtected
+    );
 
   ///
   /// Set low to 1 MB. Since 1MB cacheability will always be set
@@ -116,66 +195,36 @@ SetCacheMtrr (
   ///
   if (MemoryLength > 0xDC000000) {
      CacheMemoryLength = 0xC0000000;
-     Status = MtrrSetMemoryAttributeInMtrrSettings (
-                &MtrrSetting,
-                MemoryBase,
-                CacheMemoryLength,
-                CacheWriteBack
-                );
-     ASSERT_EFI_ERROR (Status);
+     AddMtrrRange (Ranges, &RangeCount, MemoryBase, CacheMemoryLength, CacheWriteBack);
 
      MemoryBase = 0xC0000000;
      CacheMemoryLength = MemoryLength - 0xC0000000;
      if (MemoryLength > 0xE0000000) {
         CacheMemoryLength = 0x20000000;
-        Status = MtrrSetMemoryAttributeInMtrrSettings (
-                 &MtrrSetting,
-                 MemoryBase,
-                 CacheMemoryLength,
-                 CacheWriteBack
-                 );
-        ASSERT_EFI_ERROR (Status);
+        AddMtrrRange (Ranges, &RangeCount, MemoryBase, CacheMemoryLength, CacheWriteBack);
 
         MemoryBase = 0xE0000000;
         CacheMemoryLength = MemoryLength - 0xE0000000;
      }
   }
 
-  Status = MtrrSetMemoryAttributeInMtrrSettings (
-                &MtrrSetting,
-                MemoryBase,
-                CacheMemoryLength,
-                CacheWriteBack
-                );
-  ASSERT_EFI_ERROR (Status);
+  AddMtrrRange (Ranges, &RangeCount, MemoryBase, CacheMemoryLength, CacheWriteBack);
 
   if (LowMemoryLength != MemoryLength) {
      MemoryBase = LowMemoryLength;
      MemoryLength -= LowMemoryLength;
-     Status = MtrrSetMemoryAttributeInMtrrSettings (
-                   &MtrrSetting,
-                   MemoryBase,
-                   MemoryLength,
-                   CacheUncacheable
-                   );
-      ASSERT_EFI_ERROR (Status);
+     AddMtrrRange (Ranges, &RangeCount, MemoryBase, MemoryLength, CacheUncacheable);
   }
 
   ///
   /// VGA-MMIO - 0xA0000 to 0xC0000 to be UC
   ///
-  Status = MtrrSetMemoryAttributeInMtrrSettings (
-                &MtrrSetting,
-                0xA0000,
-                0x20000,
-                CacheUncacheable
-                );
-  ASSERT_EFI_ERROR (Status);
+  AddMtrrRange (Ranges, &RangeCount, 0xA0000, 0x20000, CacheUncacheable);
 
   ///
   /// Update MTRR setting from MTRR buffer
   ///
-  MtrrSetAllMtrrs (&MtrrSetting);
+  ProgramMtrrRanges (&MtrrSetting, Ranges, RangeCount);
 
   return ;
 }
@@ -199,12 +248,14 @@ SetCacheMtrrAfterEndOfPei (
   EFI_PEI_HOB_POINTERS                  Hob;
   UINT64                                MemoryBase;
   UINT64                                MemoryLength;
-  UINT64                                Power2Length;
   EFI_BOOT_MODE                         BootMode;
   UINTN                                 Index;
   UINT64                                SmramSize;
   UINT64                                SmramBase;
   EFI_SMRAM_HOB_DESCRIPTOR_BLOCK        *SmramHobDescriptorBlock;
+  MTRR_MEMORY_RANGE                     Ranges[MAX_MTRR_RANGES];
+  UINTN                                 RangeCount;
+
   Status = PeiServicesGetBootMode (&BootMode);
   ASSERT_EFI_ERROR (Status);
 
@@ -215,6 +266,7 @@ SetCacheMtrrAfterEndOfPei (
   // Clear the CAR Settings
   //
   ZeroMem(&MtrrSetting, sizeof(MTRR_SETTINGS));
+  RangeCount = 0;
 
   //
   // Default Cachable attribute will be set to WB to support large memory size/hot plug memory
@@ -225,29 +277,9 @@ SetCacheMtrrAfterEndOfPei (
   //
   // Set fixed cache for memory range below 1MB
   //
-  Status = MtrrSetMemoryAttributeInMtrrSettings (
-                         &MtrrSetting,
-                         0x0,
-                         0xA0000,
-                         CacheWriteBack
-                         );
-  ASSERT_EFI_ERROR (Status);
-
-  Status = MtrrSetMemoryAttributeInMtrrSettings (
-                         &MtrrSetting,
-                         0xA0000,
-                         0x20000,
-                         CacheUncacheable
-                         );
-  ASSERT_EFI_ERROR (Status);
-
-  Status = MtrrSetMemoryAttributeInMtrrSettings (
-                         &MtrrSetting,
-                         0xC0000,
-                         0x40000,
-                         CacheWriteProtected
-                         );
-  ASSERT_EFI_ERROR ( Status);
+  AddMtrrRange (Ranges, &RangeCount, 0x0, 0xA0000, CacheWriteBack);
+  AddMtrrRange (Ranges, &RangeCount, 0xA0000, 0x20000, CacheUncacheable);
+  AddMtrrRange (Ranges, &RangeCount, 0xC0000, 0x40000, CacheWriteProtected);
 
   //
   // PI SMM IPL can't set SMRAM to WB because at that time CPU ARCH protocol is not available.
@@ -280,50 +312,43 @@ SetCacheMtrrAfterEndOfPei (
   MemoryBase   = 0x100000000;
 
   //
-  // Add IED size to set whole SMRAM as WB to save MTRR count
+  // Add IED size to set whole SMRAM as WB to save MTRR count.
+  // The whole range is passed at once, MtrrLib splits it into the fewest
+  // variable MTRRs.
   //
   MemoryLength = MemoryBase - (SmramBase + SmramSize);
-  while (MemoryLength != 0) {
-    Power2Length = GetPowerOfTwo64 (MemoryLength);
-    MemoryBase -= Power2Length;
-    Status = MtrrSetMemoryAttributeInMtrrSettings (
-                &MtrrSetting,
-                MemoryBase,
-                Power2Length,
-                CacheUncacheable
-                );
-    ASSERT_EFI_ERROR (Status);
-    MemoryLength -= Power2Length;
+  if (MemoryLength != 0) {
+    AddMtrrRange (Ranges, &RangeCount, SmramBase + SmramSize, MemoryLength, CacheUncacheable);
   }
 
   DEBUG ((DEBUG_INFO, "PcdPciReservedMemAbove4GBLimit - 0x%lx\n", PcdGet64 (PcdPciReservedMemAbove4GBLimit)));
   DEBUG ((DEBUG_INFO, "PcdPciReservedMemAbove4GBBase - 0x%lx\n", PcdGet64 (PcdPciReservedMemAbove4GBBase)));
   if (PcdGet64 (PcdPciReservedMemAbove4GBLimit) > PcdGet64 (PcdPciReservedMemAbove4GBBase)) {
-    Status = MtrrSetMemoryAttributeInMtrrSettings (
-                           &MtrrSetting,
-                           PcdGet64 (PcdPciReservedMemAbove4GBBase),
-                           PcdGet64 (PcdPciReservedMemAbove4GBLimit) - PcdGet64 (PcdPciReservedMemAbove4GBBase) + 1,
-                           CacheUncacheable
-                           );
-    ASSERT_EFI_ERROR ( Status);
+    AddMtrrRange (
+      Ranges,
+      &RangeCount,
+      PcdGet64 (PcdPciReservedMemAbove4GBBase),
+      PcdGet64 (PcdPciReservedMemAbove4GBLimit) - PcdGet64 (PcdPciReservedMemAbove4GBBase) + 1,
+      CacheUncacheable
+      );
   }
 
   DEBUG ((DEBUG_INFO, "PcdPciReservedPMemAbove4GBLimit - 0x%lx\n", PcdGet64 (PcdPciReservedPMemAbove4GBLimit)));
   DEBUG ((DEBUG_INFO, "PcdPciReservedPMemAbove4GBBase - 0x%lx\n", PcdGet64 (PcdPciReservedPMemAbove4GBBase)));
   if (PcdGet64 (PcdPciReservedPMemAbove4GBLimit) > PcdGet64 (PcdPciReservedPMemAbove4GBBase)) {
-    Status = MtrrSetMemoryAttributeInMtrrSettings (
-                           &MtrrSetting,
-                           PcdGet64 (PcdPciReservedPMemAbove4GBBase),
-                           PcdGet64 (PcdPciReservedPMemAbove4GBLimit) - PcdGet64 (PcdPciReservedPMemAbove4GBBase) + 1,
-                           CacheUncacheable
-                           );
-    ASSERT_EFI_ERROR ( Status);
+    AddMtrrRange (
+      Ranges,
+      &RangeCount,
+      PcdGet64 (PcdPciReservedPMemAbove4GBBase),
+      PcdGet64 (PcdPciReservedPMemAbove4GBLimit) - PcdGet64 (PcdPciReservedPMemAbove4GBBase) + 1,
+      CacheUncacheable
+      );
   }
 
   //
   // Update MTRR setting from MTRR buffer
   //
-  MtrrSetAllMtrrs (&MtrrSetting);
+  Status = ProgramMtrrRanges (&MtrrSetting, Ranges, RangeCount);
 
   return Status;
 }
@@ -11,9 +11,38 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DebugLib.h>
 #include <Library/PeiServicesLib.h>
 
+/**
+  Check whether a board detection function has registered its pre-memory
+  board functions, that is whether the board has been detected.
+
+  @retval TRUE          The board has been detected.
+  @retval FALSE         The board has not been detected yet.
+**/
+STATIC
+BOOLEAN
+IsBoardDetected (
+  VOID
+  )
+{
+  BOARD_PRE_MEM_INIT_FUNC    *BoardPreMemInit;
+  EFI_STATUS                 Status;
+
+  Status = PeiServicesLocatePpi (
+             &gBoardPreMemInitGuid,
+             0,
+             NULL,
+             (VOID **)&BoardPreMemInit
+             );
+  return (BOOLEAN) !EFI_ERROR (Status);
+}
+
 /**
   This board service detects the board type.
 
+  The board detection functions are called in their registration order until
+  one of them has detected the board, the detection functions of the other
+  boards are not run then.
+
   @retval EFI_SUCCESS   The board was detected successfully.
   @retval EFI_NOT_FOUND The board could not be detected.
 **/
@@ -27,6 +56,10 @@ BoardDetect (
   UINTN                      Index;
   EFI_STATUS                 Status;
 
+  if (IsBoardDetected ()) {
+    return EFI_SUCCESS;
+  }
+
   for (Index = 0; ; Index++) {
     Status = PeiServicesLocatePpi(
                &gBoardDetectGuid,
@@ -39,6 +72,9 @@ BoardDetect (
     }
     if (BoardDetectFunc->BoardDetect != NULL) {
       BoardDetectFunc->BoardDetect ();
+      if (IsBoardDetected ()) {
+        break;
+      }
     }
   }
   return EFI_SUCCESS;
@@ -10,10 +10,85 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/PeiServicesLib.h>
 #include <Library/ReportFvLib.h>
 #include <Guid/FirmwareFileSystem2.h>
+#include <Guid/PrehashedFvHob.h>
 #include <Ppi/FirmwareVolumeInfo.h>
+#include <Ppi/FirmwareVolumeInfoPrehashedFV.h>
+
+/**
+  Install the prehashed FV PPI of a firmware volume if a gPrehashedFvHobGuid
+  HOB carries its digests.
+
+  The PPI must be installed before the FV is reported, Tcg2Pei looks it up when
+  it measures the FV.
+
+  @param[in]  FvBase            Base address of the firmware volume.
+  @param[in]  FvSize            Size of the firmware volume.
+**/
+STATIC
+VOID
+InstallPrehashedFvPpi (
+  IN UINT32                     FvBase,
+  IN UINT32                     FvSize
+  )
+{
+  EFI_STATUS                                       Status;
+  EFI_PEI_HOB_POINTERS                             Hob;
+  EDKII_PEI_FIRMWARE_VOLUME_INFO_PREHASHED_FV_PPI  *PrehashedFv;
+  EFI_PEI_PPI_DESCRIPTOR                           *PpiDescriptor;
+
+  for (Hob.Raw = GetFirstGuidHob (&gPrehashedFvHobGuid);
+       Hob.Raw != NULL;
+       Hob.Raw = GetNextGuidHob (&gPrehashedFvHobGuid, GET_NEXT_HOB (Hob))) {
+    if (GET_GUID_HOB_DATA_SIZE (Hob.Guid) < sizeof (EDKII_PEI_FIRMWARE_VOLUME_INFO_PREHASHED_FV_PPI)) {
+      continue;
+    }
+    PrehashedFv = GET_GUID_HOB_DATA (Hob.Guid);
+    if ((PrehashedFv->FvBase != FvBase) || (PrehashedFv->FvLength != FvSize)) {
+      continue;
+    }
+
+    PpiDescriptor = AllocatePool (sizeof (EFI_PEI_PPI_DESCRIPTOR));
+    if (PpiDescriptor == NULL) {
+      return;
+    }
+    PpiDescriptor->Flags = EFI_PEI_PPI_DESCRIPTOR_PPI | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST;
+    PpiDescriptor->Guid  = &gEdkiiPeiFirmwareVolumeInfoPrehashedFvPpiGuid;
+    PpiDescriptor->Ppi   = PrehashedFv;
+    Status = PeiServicesInstallPpi (PpiDescriptor);
+    ASSERT_EFI_ERROR (Status);
+    DEBUG ((DEBUG_INFO, "Install prehashed FV - 0x%x, 0x%x, %d digest(s)\n", FvBase, FvSize, PrehashedFv->Count));
+    return;
+  }
+}
+
+/**
+  Report a firmware volume of the flash to the PEI core.
+
+  @param[in]  FvBase            Base address of the firmware volume.
+  @param[in]  FvSize            Size of the firmware volume.
+**/
+STATIC
+VOID
+InstallFlashFvInfo (
+  IN UINT32                     FvBase,
+  IN UINT32                     FvSize
+  )
+{
+  InstallPrehashedFvPpi (FvBase, FvSize);
+
+  PeiServicesInstallFvInfo2Ppi (
+    &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) FvBase)->FileSystemGuid),
+    (VOID *) (UINTN) FvBase,
+    FvSize,
+    NULL,
+    NULL,
+    0
+    );
+}
 
 VOID
 ReportPreMemFv (
@@ -25,24 +100,10 @@ ReportPreMemFv (
   ///
   if (PcdGetBool(PcdFspWrapperBootMode)) {
     DEBUG ((DEBUG_INFO, "Install FlashFvFspT - 0x%x, 0x%x\n", PcdGet32 (PcdFlashFvFspTBase), PcdGet32 (PcdFlashFvFspTSize)));
-    PeiServicesInstallFvInfo2Ppi (
-      &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) PcdGet32 (PcdFlashFvFspTBase))->FileSystemGuid),
-      (VOID *) (UINTN) PcdGet32 (PcdFlashFvFspTBase),
-      PcdGet32 (PcdFlashFvFspTSize),
-      NULL,
-      NULL,
-      0
-      );
+    InstallFlashFvInfo (PcdGet32 (PcdFlashFvFspTBase), PcdGet32 (PcdFlashFvFspTSize));
   }
   DEBUG ((DEBUG_INFO, "Install FlashFvSecurity - 0x%x, 0x%x\n", PcdGet32 (PcdFlashFvSecurityBase), PcdGet32 (PcdFlashFvSecuritySize)));
-  PeiServicesInstallFvInfo2Ppi (
-    &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) PcdGet32 (PcdFlashFvSecurityBase))->FileSystemGuid),
-    (VOID *) (UINTN) PcdGet32 (PcdFlashFvSecurityBase),
-    PcdGet32 (PcdFlashFvSecuritySize),
-    NULL,
-    NULL,
-    0
-    );
+  InstallFlashFvInfo (PcdGet32 (PcdFlashFvSecurityBase), PcdGet32 (PcdFlashFvSecuritySize));
   if (PcdGet8 (PcdBootStage) >= 6) {
     DEBUG ((
       DEBUG_INFO,
@@ -50,14 +111,7 @@ ReportPreMemFv (
       PcdGet32 (PcdFlashFvAdvancedPreMemoryBase),
       PcdGet32 (PcdFlashFvAdvancedPreMemorySize)
       ));
-    PeiServicesInstallFvInfo2Ppi (
-      &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) PcdGet32 (PcdFlashFvAdvancedPreMemoryBase))->FileSystemGuid),
-      (VOID *) (UINTN) PcdGet32 (PcdFlashFvAdvancedPreMemoryBase),
-      PcdGet32 (PcdFlashFvAdvancedPreMemorySize),
-      NULL,
-      NULL,
-      0
-      );
+    InstallFlashFvInfo (PcdGet32 (PcdFlashFvAdvancedPreMemoryBase), PcdGet32 (PcdFlashFvAdvancedPreMemorySize));
   }
 }
 
@@ -85,42 +139,14 @@ ReportPostMemFv (
     ///
   } else {
     DEBUG ((DEBUG_INFO, "Install FlashFvPostMemory - 0x%x, 0x%x\n", PcdGet32 (PcdFlashFvPostMemoryBase), PcdGet32 (PcdFlashFvPostMemorySize)));
-    PeiServicesInstallFvInfo2Ppi (
-      &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) PcdGet32 (PcdFlashFvPostMemoryBase))->FileSystemGuid),
-      (VOID *) (UINTN) PcdGet32 (PcdFlashFvPostMemoryBase),
-      PcdGet32 (PcdFlashFvPostMemorySize),
-      NULL,
-      NULL,
-      0
-      );
+    InstallFlashFvInfo (PcdGet32 (PcdFlashFvPostMemoryBase), PcdGet32 (PcdFlashFvPostMemorySize));
     DEBUG ((DEBUG_INFO, "Install FlashFvUefiBoot - 0x%x, 0x%x\n", PcdGet32 (PcdFlashFvUefiBootBase), PcdGet32 (PcdFlashFvUefiBootSize)));
-    PeiServicesInstallFvInfo2Ppi (
-      &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) PcdGet32 (PcdFlashFvUefiBootBase))->FileSystemGuid),
-      (VOID *) (UINTN) PcdGet32 (PcdFlashFvUefiBootBase),
-      PcdGet32 (PcdFlashFvUefiBootSize),
-      NULL,
-      NULL,
-      0
-      );
+    InstallFlashFvInfo (PcdGet32 (PcdFlashFvUefiBootBase), PcdGet32 (PcdFlashFvUefiBootSize));
     DEBUG ((DEBUG_INFO, "Install FlashFvOsBoot - 0x%x, 0x%x\n", PcdGet32 (PcdFlashFvOsBootBase), PcdGet32 (PcdFlashFvOsBootSize)));
-    PeiServicesInstallFvInfo2Ppi (
-      &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) PcdGet32 (PcdFlashFvOsBootBase))->FileSystemGuid),
-      (VOID *) (UINTN) PcdGet32 (PcdFlashFvOsBootBase),
-      PcdGet32 (PcdFlashFvOsBootSize),
-      NULL,
-      NULL,
-      0
-      );
+    InstallFlashFvInfo (PcdGet32 (PcdFlashFvOsBootBase), PcdGet32 (PcdFlashFvOsBootSize));
     if (PcdGet8 (PcdBootStage) >= 6) {
       DEBUG ((DEBUG_INFO, "Install FlashFvAdvanced - 0x%x, 0x%x\n", PcdGet32 (PcdFlashFvAdvancedBase), PcdGet32 (PcdFlashFvAdvancedSize)));
-      PeiServicesInstallFvInfo2Ppi (
-        &(((EFI_FIRMWARE_VOLUME_HEADER *) (UINTN) PcdGet32 (PcdFlashFvAdvancedBase))->FileSystemGuid),
-        (VOID *) (UINTN) PcdGet32 (PcdFlashFvAdvancedBase),
-        PcdGet32 (PcdFlashFvAdvancedSize),
-        NULL,
-        NULL,
-        0
-        );
+      InstallFlashFvInfo (PcdGet32 (PcdFlashFvAdvancedBase), PcdGet32 (PcdFlashFvAdvancedSize));
     }
   }
 
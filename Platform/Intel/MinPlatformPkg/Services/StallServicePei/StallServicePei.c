@@ -5,9 +5,14 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 **/
 
+#include <PiPei.h>
 #include <Ppi/Stall.h>
+#include <Guid/StallStats.h>
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/PcdLib.h>
 #include <Library/PeimEntryPoint.h>
 #include <Library/TimerLib.h>
 #include <Library/PeiServicesLib.h>
@@ -45,6 +50,60 @@ EFI_PEI_PPI_DESCRIPTOR  mPeiInstallStallPpi = {
   &mStallPpi
 };
 
+/**
+  Account a stall to its caller in the gStallStatsGuid HOB.
+
+  @param  Caller         The return address of the Stall () call.
+  @param  Microseconds   The duration of the stall.
+
+**/
+VOID
+RecordStall (
+  IN UINT64                   Caller,
+  IN UINTN                    Microseconds
+  )
+{
+  EFI_HOB_GUID_TYPE   *GuidHob;
+  STALL_STATS         *Stats;
+  STALL_STATS_ENTRY   *Entry;
+  UINTN               Index;
+
+  GuidHob = GetFirstGuidHob (&gStallStatsGuid);
+  if (GuidHob != NULL) {
+    Stats = GET_GUID_HOB_DATA (GuidHob);
+  } else {
+    Stats = BuildGuidHob (&gStallStatsGuid, sizeof (STALL_STATS));
+    if (Stats == NULL) {
+      return;
+    }
+    ZeroMem (Stats, sizeof (STALL_STATS));
+  }
+
+  for (Index = 0; Index < Stats->EntryCount; Index++) {
+    if (Stats->Entry[Index].Caller == Caller) {
+      break;
+    }
+  }
+
+  if (Index == Stats->EntryCount) {
+    if (Index == STALL_STATS_MAX_ENTRIES) {
+      Stats->DroppedCount++;
+      Stats->DroppedMicroseconds += Microseconds;
+      return;
+    }
+    Stats->Entry[Index].Caller = Caller;
+    Stats->Entry[Index].Phase  = STALL_STATS_PHASE_PEI;
+    Stats->EntryCount++;
+  }
+
+  Entry = &Stats->Entry[Index];
+  Entry->Count++;
+  Entry->TotalMicroseconds += Microseconds;
+  if (Microseconds > Entry->MaxMicroseconds) {
+    Entry->MaxMicroseconds = Microseconds;
+  }
+}
+
 EFI_STATUS
 EFIAPI
 Stall (
@@ -55,6 +114,10 @@ Stall (
 {
   MicroSecondDelay (Microseconds);
 
+  if (FeaturePcdGet (PcdStallStatsEnable)) {
+    RecordStall ((UINT64)(UINTN)RETURN_ADDRESS (0), Microseconds);
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -17,7 +17,6 @@
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
-#include <Library/MemoryAllocationLib.h>
 #include <Library/Tpm2CommandLib.h>
 #include <Library/RngLib.h>
 #include <Library/UefiLib.h>
@@ -53,32 +52,35 @@ RdRandGenerateEntropy (
   UINT64      Seed[2];
   UINT8       *Ptr;
 
-  Status = EFI_NOT_READY;
-  BlockCount = Length / 64;
+  Status = EFI_SUCCESS;
+  BlockCount = Length / sizeof (Seed);
   Ptr = (UINT8 *)Entropy;
 
   //
-  // Generate high-quality seed for DRBG Entropy
+  // Generate high-quality seed for DRBG Entropy, one 128-bit random number
+  // per block.
   //
   while (BlockCount > 0) {
-    Status = GetRandomNumber128 (Seed);
+    Status = GetRandomNumber128 ((UINT64 *)Ptr);
     if (EFI_ERROR (Status)) {
       return Status;
     }
-    CopyMem (Ptr, Seed, 64);
 
     BlockCount--;
-    Ptr = Ptr + 64;
+    Ptr = Ptr + sizeof (Seed);
   }
 
   //
   // Populate the remained data as request.
   //
-  Status = GetRandomNumber128 (Seed);
-  if (EFI_ERROR (Status)) {
-    return Status;
+  if ((Length % sizeof (Seed)) != 0) {
+    Status = GetRandomNumber128 (Seed);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    CopyMem (Ptr, Seed, (Length % sizeof (Seed)));
+    ZeroMem (Seed, sizeof (Seed));
   }
-  CopyMem (Ptr, Seed, (Length % 64));
 
   return Status;
 }
@@ -164,8 +166,6 @@ RandomizePlatformAuth (
 {
   EFI_STATUS                        Status;
   UINT16                            AuthSize;
-  UINT8                             *Rand;
-  UINTN                             RandSize;
   TPM2B_AUTH                        NewPlatformAuth;
 
   //
@@ -178,15 +178,9 @@ RandomizePlatformAuth (
   NewPlatformAuth.size = AuthSize;
 
   //
-  // Allocate one buffer to store random data.
+  // Only generate the random bytes the auth value uses, straight into it.
   //
-  RandSize = MAX_NEW_AUTHORIZATION_SIZE;
-  Rand = AllocatePool (RandSize);
-
-  RdRandGenerateEntropy (RandSize, Rand);
-  CopyMem (NewPlatformAuth.buffer, Rand, AuthSize);
-
-  FreePool (Rand);
+  RdRandGenerateEntropy (AuthSize, NewPlatformAuth.buffer);
 
   //
   // Send Tpm2HierarchyChangeAuth command with the new Auth value
@@ -194,7 +188,6 @@ RandomizePlatformAuth (
   Status = Tpm2HierarchyChangeAuth (TPM_RH_PLATFORM, NULL, &NewPlatformAuth);
   DEBUG ((DEBUG_INFO, "Tpm2HierarchyChangeAuth Result: - %r\n", Status));
   ZeroMem (NewPlatformAuth.buffer, AuthSize);
-  ZeroMem (Rand, RandSize);
 }
 
 /**
@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/TestPointCheckLib.h>
 #include <Library/TestPointLib.h>
 #include <Library/DebugLib.h>
+#include <Library/PerformanceLib.h>
 #include <Library/UefiLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
@@ -190,6 +191,8 @@ TestPointPciEnumerationDonePciBusMasterDisabled (
 
   DEBUG ((DEBUG_INFO, "======== TestPointPciEnumerationDonePciBusMasterDisabled - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointPciEnumerationDonePciBusMasterDisabled");
+
   Result = TRUE;
   Status = TestPointCheckPciBusMaster ();
   if (EFI_ERROR(Status)) {
@@ -205,6 +208,8 @@ TestPointPciEnumerationDonePciBusMasterDisabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointPciEnumerationDonePciBusMasterDisabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointPciEnumerationDonePciBusMasterDisabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -235,6 +240,8 @@ TestPointPciEnumerationDonePciResourceAllocated (
 
   DEBUG ((DEBUG_INFO, "======== TestPointPciEnumerationDonePciResourceAllocated - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointPciEnumerationDonePciResourceAllocated");
+
   Result = TRUE;
   Status = TestPointCheckPciResource ();
   if (EFI_ERROR(Status)) {
@@ -250,6 +257,8 @@ TestPointPciEnumerationDonePciResourceAllocated (
       );
   }
 
+  PERF_INMODULE_END ("TestPointPciEnumerationDonePciResourceAllocated");
+
   DEBUG ((DEBUG_INFO, "======== TestPointPciEnumerationDonePciResourceAllocated - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -280,6 +289,8 @@ TestPointEndOfDxeDmaAcpiTableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfDxeDmaAcpiTableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointEndOfDxeDmaAcpiTableFunctional");
+
   Acpi = TestPointGetAcpi (EFI_ACPI_4_0_DMA_REMAPPING_TABLE_SIGNATURE);
   if (Acpi == NULL) {
     DEBUG ((DEBUG_ERROR, "No DMAR table\n"));
@@ -301,6 +312,8 @@ TestPointEndOfDxeDmaAcpiTableFunctional (
     Status = EFI_SUCCESS;
   }
 
+  PERF_INMODULE_END ("TestPointEndOfDxeDmaAcpiTableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfDxeDmaAcpiTableFunctional - Exit\n"));
   return Status;
 }
@@ -331,6 +344,8 @@ TestPointEndOfDxeDmaProtectionEnabled (
 
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfDxeDmaProtectionEnabled - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointEndOfDxeDmaProtectionEnabled");
+
   Result = TRUE;
   Status = TestPointVtdEngine ();
   if (EFI_ERROR(Status)) {
@@ -346,6 +361,8 @@ TestPointEndOfDxeDmaProtectionEnabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointEndOfDxeDmaProtectionEnabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfDxeDmaProtectionEnabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -376,6 +393,8 @@ TestPointEndOfDxeNoThirdPartyPciOptionRom (
 
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfDxeNoThirdPartyPciOptionRom - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointEndOfDxeNoThirdPartyPciOptionRom");
+
   Result = TRUE;
   Status = TestPointCheckLoadedImage ();
   if (EFI_ERROR(Status)) {
@@ -391,6 +410,8 @@ TestPointEndOfDxeNoThirdPartyPciOptionRom (
       );
   }
 
+  PERF_INMODULE_END ("TestPointEndOfDxeNoThirdPartyPciOptionRom");
+
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfDxeNoThirdPartyPciOptionRom - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -421,6 +442,8 @@ TestPointDxeSmmReadyToLockSmramAligned (
 
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToLockSmramAligned - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointDxeSmmReadyToLockSmramAligned");
+
   Result = TRUE;
   Status = TestPointCheckSmmInfo ();
   if (EFI_ERROR(Status)) {
@@ -436,6 +459,8 @@ TestPointDxeSmmReadyToLockSmramAligned (
       );
   }
 
+  PERF_INMODULE_END ("TestPointDxeSmmReadyToLockSmramAligned");
+
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToLockSmramAligned - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -467,6 +492,8 @@ TestPointDxeSmmReadyToLockWsmtTableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToLockWsmtTableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointDxeSmmReadyToLockWsmtTableFunctional");
+
   Acpi = TestPointGetAcpi (EFI_ACPI_WINDOWS_SMM_SECURITY_MITIGATION_TABLE_SIGNATURE);
   if (Acpi == NULL) {
     DEBUG ((DEBUG_ERROR, "No WSMT table\n"));
@@ -488,6 +515,8 @@ TestPointDxeSmmReadyToLockWsmtTableFunctional (
     Status = EFI_SUCCESS;
   }
 
+  PERF_INMODULE_END ("TestPointDxeSmmReadyToLockWsmtTableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToLockWsmtTableFunctional - Exit\n"));
   return Status;
 }
@@ -536,6 +565,8 @@ TestPointDxeSmmReadyToBootSmmPageProtection (
 
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToBootSmmPageProtection - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointDxeSmmReadyToBootSmmPageProtection");
+
   TestPointDumpUefiMemoryMap (&UefiMemoryMap, &UefiMemoryMapSize, &UefiDescriptorSize, FALSE);
   TestPointDumpGcd (&GcdMemoryMap, &GcdMemoryMapNumberOfDescriptors, &GcdIoMap, &GcdIoMapNumberOfDescriptors, FALSE);
 
@@ -549,6 +580,7 @@ TestPointDxeSmmReadyToBootSmmPageProtection (
   Status = gBS->LocateProtocol(&gEfiSmmCommunicationProtocolGuid, NULL, (VOID **)&SmmCommunication);
   if (EFI_ERROR(Status)) {
     DEBUG ((DEBUG_INFO, "TestPointDxeSmmReadyToBootSmmPageProtection: Locate SmmCommunication protocol - %r\n", Status));
+    PERF_INMODULE_END ("TestPointDxeSmmReadyToBootSmmPageProtection");
     return EFI_SUCCESS;
   }
 
@@ -565,6 +597,7 @@ TestPointDxeSmmReadyToBootSmmPageProtection (
              );
   if (EFI_ERROR(Status)) {
     DEBUG ((DEBUG_INFO, "TestPointDxeSmmReadyToBootSmmPageProtection: Get PiSmmCommunicationRegionTable - %r\n", Status));
+    PERF_INMODULE_END ("TestPointDxeSmmReadyToBootSmmPageProtection");
     return EFI_SUCCESS;
   }
   ASSERT(PiSmmCommunicationRegionTable != NULL);
@@ -624,9 +657,12 @@ TestPointDxeSmmReadyToBootSmmPageProtection (
   Status = SmmCommunication->Communicate(SmmCommunication, CommBuffer, &CommSize);
   if (EFI_ERROR(Status)) {
     DEBUG ((DEBUG_INFO, "TestPointDxeSmmReadyToBootSmmPageProtection: SmmCommunication - %r\n", Status));
+    PERF_INMODULE_END ("TestPointDxeSmmReadyToBootSmmPageProtection");
     return EFI_SUCCESS;
   }
 
+  PERF_INMODULE_END ("TestPointDxeSmmReadyToBootSmmPageProtection");
+
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToBootSmmPageProtection - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -657,6 +693,8 @@ TestPointDxeSmmReadyToBootSmiHandlerInstrument (
 
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToBootSmiHandlerInstrument - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointDxeSmmReadyToBootSmiHandlerInstrument");
+
   Result = TRUE;
   Status = TestPointCheckSmiHandlerInstrument ();
   if (EFI_ERROR(Status)) {
@@ -672,6 +710,8 @@ TestPointDxeSmmReadyToBootSmiHandlerInstrument (
       );
   }
 
+  PERF_INMODULE_END ("TestPointDxeSmmReadyToBootSmiHandlerInstrument");
+
   DEBUG ((DEBUG_INFO, "======== TestPointDxeSmmReadyToBootSmiHandlerInstrument - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -702,6 +742,8 @@ TestPointReadyToBootAcpiTableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootAcpiTableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootAcpiTableFunctional");
+
   Result = TRUE;
   Status = TestPointCheckAcpi ();
   if (EFI_ERROR(Status)) {
@@ -717,6 +759,8 @@ TestPointReadyToBootAcpiTableFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootAcpiTableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootAcpiTableFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -747,6 +791,8 @@ TestPointReadyToBootGcdResourceFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootGcdResourceFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootGcdResourceFunctional");
+
   Result = TRUE;
   Status = TestPointCheckAcpiGcdResource ();
   if (EFI_ERROR(Status)) {
@@ -762,6 +808,8 @@ TestPointReadyToBootGcdResourceFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootGcdResourceFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootGcdResourceFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -793,6 +841,8 @@ TestPointReadyToBootMemoryTypeInformationFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootMemoryTypeInformationFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootMemoryTypeInformationFunctional");
+
   Result = TRUE;
   Status = TestPointCheckMemoryTypeInformation ();
   if (EFI_ERROR(Status)) {
@@ -813,6 +863,8 @@ TestPointReadyToBootMemoryTypeInformationFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootMemoryTypeInformationFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootMemoryTypeInformationFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -844,6 +896,8 @@ TestPointReadyToBootUefiMemoryAttributeTableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiMemoryAttributeTableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootUefiMemoryAttributeTableFunctional");
+
   Result = TRUE;
   TestPointDumpUefiMemoryMap (NULL, NULL, NULL, TRUE);
   TestPointDumpGcd (NULL, NULL, NULL, NULL, TRUE);
@@ -861,6 +915,8 @@ TestPointReadyToBootUefiMemoryAttributeTableFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootUefiMemoryAttributeTableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiMemoryAttributeTableFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -891,6 +947,8 @@ TestPointReadyToBootUefiBootVariableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiBootVariableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootUefiBootVariableFunctional");
+
   Result = TRUE;
   TestPointDumpDevicePath ();
   TestPointDumpVariable ();
@@ -908,6 +966,8 @@ TestPointReadyToBootUefiBootVariableFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootUefiBootVariableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiBootVariableFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -938,6 +998,8 @@ TestPointReadyToBootUefiConsoleVariableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiConsoleVariableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootUefiConsoleVariableFunctional");
+
   Result = TRUE;
   TestPointDumpDevicePath ();
   TestPointDumpVariable ();
@@ -955,6 +1017,8 @@ TestPointReadyToBootUefiConsoleVariableFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootUefiConsoleVariableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiConsoleVariableFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -985,6 +1049,8 @@ TestPointReadyToBootHstiTableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootHstiTableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootHstiTableFunctional");
+
   Result = TRUE;
   Status = TestPointCheckHsti ();
   if (EFI_ERROR(Status)) {
@@ -1000,6 +1066,8 @@ TestPointReadyToBootHstiTableFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootHstiTableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootHstiTableFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -1030,6 +1098,8 @@ TestPointReadyToBootEsrtTableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootEsrtTableFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootEsrtTableFunctional");
+
   Result = TRUE;
   Status = TestPointCheckEsrt ();
   if (EFI_ERROR(Status)) {
@@ -1045,6 +1115,8 @@ TestPointReadyToBootEsrtTableFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootEsrtTableFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootEsrtTableFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -1075,6 +1147,8 @@ TestPointReadyToBootUefiSecureBootEnabled (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiSecureBootEnabled - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootUefiSecureBootEnabled");
+
   Result = TRUE;
   Status = TestPointCheckUefiSecureBoot ();
   if (EFI_ERROR(Status)) {
@@ -1090,6 +1164,8 @@ TestPointReadyToBootUefiSecureBootEnabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootUefiSecureBootEnabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootUefiSecureBootEnabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -1119,6 +1195,8 @@ TestPointReadyToBootPiSignedFvBootEnabled (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootPiSignedFvBootEnabled - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootPiSignedFvBootEnabled");
+
   Result = TRUE;
   Status = TestPointCheckPiSignedFvBoot ();
   if (EFI_ERROR(Status)) {
@@ -1134,6 +1212,8 @@ TestPointReadyToBootPiSignedFvBootEnabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootPiSignedFvBootEnabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootPiSignedFvBootEnabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -1164,6 +1244,8 @@ TestPointReadyToBootTcgTrustedBootEnabled (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootTcgTrustedBootEnabled - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootTcgTrustedBootEnabled");
+
   Result = TRUE;
   Status = TestPointCheckTcgTrustedBoot ();
   if (EFI_ERROR(Status)) {
@@ -1179,6 +1261,8 @@ TestPointReadyToBootTcgTrustedBootEnabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootTcgTrustedBootEnabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootTcgTrustedBootEnabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -1209,6 +1293,8 @@ TestPointReadyToBootTcgMorEnabled (
 
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootTcgMorEnabled - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointReadyToBootTcgMorEnabled");
+
   Result = TRUE;
   Status = TestPointCheckTcgMor ();
   if (EFI_ERROR(Status)) {
@@ -1224,6 +1310,8 @@ TestPointReadyToBootTcgMorEnabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointReadyToBootTcgMorEnabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointReadyToBootTcgMorEnabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -0,0 +1,75 @@
+/** @file
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <PiPei.h>
+#include <Library/BaseLib.h>
+#include <Library/TestPointCheckLib.h>
+#include <Library/TestPointLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Guid/TemporaryRamUsage.h>
+
+EFI_STATUS
+TestPointCheckTemporaryRamUsage (
+  VOID
+  )
+{
+  EFI_HOB_GUID_TYPE    *GuidHob;
+  TEMPORARY_RAM_USAGE  *TempRamUsage;
+  EFI_STATUS           Status;
+
+  GuidHob = GetFirstGuidHob (&gTemporaryRamUsageGuid);
+  if (GuidHob == NULL) {
+    //
+    // Temporary RAM usage report is not enabled.
+    //
+    return EFI_SUCCESS;
+  }
+  TempRamUsage = GET_GUID_HOB_DATA (GuidHob);
+
+  DEBUG ((DEBUG_INFO, "==== TestPointCheckTemporaryRamUsage - Enter\n"));
+  DEBUG ((DEBUG_INFO,
+    "  Heap  BA=%016lx L=%016lx  Used=%016lx (%d%%)\n",
+    TempRamUsage->HeapBase,
+    TempRamUsage->HeapSize,
+    TempRamUsage->HeapUsed,
+    (TempRamUsage->HeapSize == 0) ? 0 : (UINTN) DivU64x64Remainder (MultU64x32 (TempRamUsage->HeapUsed, 100), TempRamUsage->HeapSize, NULL)
+    ));
+  DEBUG ((DEBUG_INFO,
+    "  Stack BA=%016lx L=%016lx  Used=%016lx (%d%%)\n",
+    TempRamUsage->StackBase,
+    TempRamUsage->StackSize,
+    TempRamUsage->StackUsed,
+    (TempRamUsage->StackSize == 0) ? 0 : (UINTN) DivU64x64Remainder (MultU64x32 (TempRamUsage->StackUsed, 100), TempRamUsage->StackSize, NULL)
+    ));
+
+  Status = EFI_SUCCESS;
+  //
+  // No pattern left means the region was used up, and most likely overflowed.
+  //
+  if (TempRamUsage->HeapUsed >= TempRamUsage->HeapSize) {
+    DEBUG ((DEBUG_ERROR, "Temporary RAM heap is exhausted\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+  }
+  if (TempRamUsage->StackUsed >= TempRamUsage->StackSize) {
+    DEBUG ((DEBUG_ERROR, "Temporary RAM stack is exhausted\n"));
+    Status = EFI_OUT_OF_RESOURCES;
+  }
+  if (EFI_ERROR (Status)) {
+    TestPointLibAppendErrorString (
+      PLATFORM_TEST_POINT_ROLE_PLATFORM_IBV,
+      NULL,
+      TEST_POINT_BYTE2_END_OF_PEI_SYSTEM_RESOURCE_FUNCTIONAL_ERROR_CODE \
+        TEST_POINT_END_OF_PEI \
+        TEST_POINT_BYTE2_END_OF_PEI_SYSTEM_RESOURCE_FUNCTIONAL_ERROR_STRING
+      );
+  }
+
+  DEBUG ((DEBUG_INFO, "==== TestPointCheckTemporaryRamUsage - Exit\n"));
+  return Status;
+}
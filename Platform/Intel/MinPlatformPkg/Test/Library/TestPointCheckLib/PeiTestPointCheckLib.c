@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/TestPointCheckLib.h>
 #include <Library/TestPointLib.h>
 #include <Library/DebugLib.h>
+#include <Library/PerformanceLib.h>
 #include <Library/BaseMemoryLib.h>
 
 EFI_STATUS
@@ -52,6 +53,11 @@ TestPointVtdEngine (
   VOID
   );
 
+EFI_STATUS
+TestPointCheckTemporaryRamUsage (
+  VOID
+  );
+
 GLOBAL_REMOVE_IF_UNREFERENCED ADAPTER_INFO_PLATFORM_TEST_POINT_STRUCT  mTestPointStruct = {
   PLATFORM_TEST_POINT_VERSION,
   PLATFORM_TEST_POINT_ROLE_PLATFORM_IBV,
@@ -117,6 +123,8 @@ TestPointDebugInitDone (
   }
 
   DEBUG ((DEBUG_INFO, "======== TestPointDebugInitDone - Enter\n"));
+
+  PERF_INMODULE_BEGIN ("TestPointDebugInitDone");
   DEBUG ((DEBUG_INFO, "!!! DebugInitialized !!!\n"));
 
   TestPointLibSetFeaturesVerified (
@@ -125,6 +133,8 @@ TestPointDebugInitDone (
     0,
     TEST_POINT_BYTE0_DEBUG_INIT_DONE
     );
+  PERF_INMODULE_END ("TestPointDebugInitDone");
+
   DEBUG ((DEBUG_INFO, "======== TestPointDebugInitDone - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -160,6 +170,8 @@ TestPointMemoryDiscoveredMtrrFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredMtrrFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointMemoryDiscoveredMtrrFunctional");
+
   TestPointDumpHob (FALSE);
 
   Result = TRUE;
@@ -177,6 +189,8 @@ TestPointMemoryDiscoveredMtrrFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointMemoryDiscoveredMtrrFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredMtrrFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -209,6 +223,8 @@ TestPointMemoryDiscoveredMemoryResourceFunctional (
   }
 
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredMemoryResourceFunctional - Enter\n"));
+
+  PERF_INMODULE_BEGIN ("TestPointMemoryDiscoveredMemoryResourceFunctional");
   Result = TRUE;
 
   Status = TestPointCheckMemoryResource ();
@@ -225,6 +241,8 @@ TestPointMemoryDiscoveredMemoryResourceFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointMemoryDiscoveredMemoryResourceFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredMemoryResourceFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -257,6 +275,8 @@ TestPointMemoryDiscoveredFvInfoFunctional (
   }
 
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredFvInfoFunctional - Enter\n"));
+
+  PERF_INMODULE_BEGIN ("TestPointMemoryDiscoveredFvInfoFunctional");
   Result = TRUE;
   Status = TestPointCheckFvInfo ();
   if (EFI_ERROR(Status)) {
@@ -272,6 +292,8 @@ TestPointMemoryDiscoveredFvInfoFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointMemoryDiscoveredFvInfoFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredFvInfoFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -304,6 +326,8 @@ TestPointMemoryDiscoveredDmaProtectionEnabled (
 
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredDmaProtectionEnabled - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointMemoryDiscoveredDmaProtectionEnabled");
+
   Result = TRUE;
   Status = TestPointVtdEngine ();
   if (EFI_ERROR(Status)) {
@@ -319,6 +343,8 @@ TestPointMemoryDiscoveredDmaProtectionEnabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointMemoryDiscoveredDmaProtectionEnabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointMemoryDiscoveredDmaProtectionEnabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -352,6 +378,8 @@ TestPointEndOfPeiSystemResourceFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfPeiSystemResourceFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointEndOfPeiSystemResourceFunctional");
+
   TestPointDumpHob (FALSE);
 
   Result = TRUE;
@@ -359,6 +387,10 @@ TestPointEndOfPeiSystemResourceFunctional (
   if (EFI_ERROR(Status)) {
     Result = FALSE;
   }
+  Status = TestPointCheckTemporaryRamUsage ();
+  if (EFI_ERROR(Status)) {
+    Result = FALSE;
+  }
 
   if (Result) {
     TestPointLibSetFeaturesVerified (
@@ -369,6 +401,8 @@ TestPointEndOfPeiSystemResourceFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointEndOfPeiSystemResourceFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfPeiSystemResourceFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -403,6 +437,8 @@ TestPointEndOfPeiMtrrFunctional (
   }
 
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfPeiMtrrFunctional - Enter\n"));
+
+  PERF_INMODULE_BEGIN ("TestPointEndOfPeiMtrrFunctional");
   Result = TRUE;
   Status = TestPointCheckMtrr (TRUE);
   if (EFI_ERROR(Status)) {
@@ -418,6 +454,8 @@ TestPointEndOfPeiMtrrFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointEndOfPeiMtrrFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfPeiMtrrFunctional - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -450,6 +488,8 @@ TestPointEndOfPeiPciBusMasterDisabled (
   }
 
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfPeiPciBusMasterDisabled - Enter\n"));
+
+  PERF_INMODULE_BEGIN ("TestPointEndOfPeiPciBusMasterDisabled");
   Result = TRUE;
   Status = TestPointCheckPciBusMaster ();
   if (EFI_ERROR(Status)) {
@@ -465,6 +505,8 @@ TestPointEndOfPeiPciBusMasterDisabled (
       );
   }
 
+  PERF_INMODULE_END ("TestPointEndOfPeiPciBusMasterDisabled");
+
   DEBUG ((DEBUG_INFO, "======== TestPointEndOfPeiPciBusMasterDisabled - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -10,6 +10,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/TestPointLib.h>
 #include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
+#include <Library/PerformanceLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiLib.h>
@@ -115,6 +116,8 @@ TestPointSmmEndOfDxeSmrrFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointSmmEndOfDxeSmrrFunctional - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointSmmEndOfDxeSmrrFunctional");
+
   Result = TRUE;
   Status = TestPointCheckSmrr ();
   if (EFI_ERROR(Status)) {
@@ -130,6 +133,8 @@ TestPointSmmEndOfDxeSmrrFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointSmmEndOfDxeSmrrFunctional");
+
   DEBUG ((DEBUG_INFO, "======== TestPointSmmEndOfDxe - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -162,6 +167,8 @@ TestPointSmmReadyToLockSmmMemoryAttributeTableFunctional (
 
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToLock - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointSmmReadyToLock");
+
   Result = TRUE;
   TestPointDumpSmmLoadedImage ();
   Status = TestPointCheckSmmMemAttribute ();
@@ -178,6 +185,8 @@ TestPointSmmReadyToLockSmmMemoryAttributeTableFunctional (
       );
   }
 
+  PERF_INMODULE_END ("TestPointSmmReadyToLock");
+
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToLock - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -208,6 +217,8 @@ TestPointSmmReadyToLockSecureSmmCommunicationBuffer (
 
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToLockSecureSmmCommunicationBuffer - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointSmmReadyToLockSecureSmmCommunicationBuffer");
+
   //
   // Collect information here, because it is last chance to access outside SMRAM.
   //
@@ -224,6 +235,8 @@ TestPointSmmReadyToLockSecureSmmCommunicationBuffer (
   // Defer the validation to TestPointSmmReadyToBootSecureSmmCommunicationBuffer, because page table setup later.
   //
 
+  PERF_INMODULE_END ("TestPointSmmReadyToLockSecureSmmCommunicationBuffer");
+
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToLockSecureSmmCommunicationBuffer - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -254,6 +267,8 @@ TestPointSmmReadyToBootSmmPageProtection (
 
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToBootSmmPageProtection - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointSmmReadyToBootSmmPageProtection");
+
   Result = TRUE;
 
   Status = TestPointCheckSmmPaging ();
@@ -285,6 +300,8 @@ TestPointSmmReadyToBootSmmPageProtection (
         );
     }
   }
+  PERF_INMODULE_END ("TestPointSmmReadyToBootSmmPageProtection");
+
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToBootSmmPageProtection - Exit\n"));
   return EFI_SUCCESS;
 }
@@ -318,21 +335,26 @@ TestPointSmmReadyToBootSmmPageProtectionHandler (
 
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToBootSmmPageProtectionHandler - Enter\n"));
 
+  PERF_INMODULE_BEGIN ("TestPointSmmReadyToBootSmmPageProtectionHandler");
+
   TempCommBufferSize = *CommBufferSize;
 
   if (TempCommBufferSize < sizeof(TEST_POINT_SMM_COMMUNICATION_UEFI_GCD_MAP_INFO)) {
     DEBUG((DEBUG_ERROR, "TestPointSmmReadyToBootSmmPageProtectionHandler: SMM communication buffer size invalid!\n"));
+    PERF_INMODULE_END ("TestPointSmmReadyToBootSmmPageProtectionHandler");
     return EFI_SUCCESS;
   }
 
   if (!SmmIsBufferOutsideSmmValid((UINTN)CommBuffer, TempCommBufferSize)) {
     DEBUG((DEBUG_ERROR, "TestPointSmmReadyToBootSmmPageProtectionHandler: SMM communication buffer in SMRAM or overflow!\n"));
+    PERF_INMODULE_END ("TestPointSmmReadyToBootSmmPageProtectionHandler");
     return EFI_SUCCESS;
   }
   DEBUG ((DEBUG_INFO, "TempCommBufferSize - 0x%x\n", TempCommBufferSize));
   CommData = AllocateCopyPool (TempCommBufferSize, CommBuffer);
   if (CommData == NULL) {
     DEBUG((DEBUG_ERROR, "TestPointSmmReadyToBootSmmPageProtectionHandler: SMM communication buffer size too big!\n"));
+    PERF_INMODULE_END ("TestPointSmmReadyToBootSmmPageProtectionHandler");
     return EFI_SUCCESS;
   }
   if (CommData->UefiMemoryMapOffset != sizeof(TEST_POINT_SMM_COMMUNICATION_UEFI_GCD_MAP_INFO)) {
@@ -405,6 +427,8 @@ TestPointSmmReadyToBootSmmPageProtectionHandler (
 Done:
   FreePool (CommData);
 
+  PERF_INMODULE_END ("TestPointSmmReadyToBootSmmPageProtectionHandler");
+
   DEBUG ((DEBUG_INFO, "======== TestPointSmmReadyToBootSmmPageProtectionHandler - Exit\n"));
   return EFI_SUCCESS;
 }
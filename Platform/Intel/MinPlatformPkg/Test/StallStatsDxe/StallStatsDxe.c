@@ -0,0 +1,139 @@
+/** @file
+  Accounts the DXE stalls to their callers.
+
+  gBS->Stall () is replaced by a wrapper recording the return address and the
+  duration of every stall. The statistics are published, together with the PEI
+  ones left by StallServicePei, as the gStallStatsGuid configuration table.
+
+Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Guid/StallStats.h>
+
+STALL_STATS   *mStallStats;
+EFI_STALL     mOriginalStall;
+
+/**
+  Account a stall to its caller.
+
+  @param[in] Caller        The return address of the Stall () call.
+  @param[in] Microseconds  The duration of the stall.
+
+**/
+VOID
+RecordStall (
+  IN UINT64   Caller,
+  IN UINTN    Microseconds
+  )
+{
+  STALL_STATS_ENTRY   *Entry;
+  UINTN               Index;
+
+  for (Index = 0; Index < mStallStats->EntryCount; Index++) {
+    Entry = &mStallStats->Entry[Index];
+    if ((Entry->Caller == Caller) && (Entry->Phase == STALL_STATS_PHASE_DXE)) {
+      break;
+    }
+  }
+
+  if (Index == mStallStats->EntryCount) {
+    if (Index == STALL_STATS_MAX_ENTRIES) {
+      mStallStats->DroppedCount++;
+      mStallStats->DroppedMicroseconds += Microseconds;
+      return;
+    }
+    Entry = &mStallStats->Entry[Index];
+    Entry->Caller = Caller;
+    Entry->Phase  = STALL_STATS_PHASE_DXE;
+    mStallStats->EntryCount++;
+  }
+
+  Entry->Count++;
+  Entry->TotalMicroseconds += Microseconds;
+  if (Microseconds > Entry->MaxMicroseconds) {
+    Entry->MaxMicroseconds = Microseconds;
+  }
+}
+
+/**
+  Induces a fine-grained stall, and accounts it to the caller.
+
+  @param[in]  Microseconds      The number of microseconds to stall execution.
+
+  @retval EFI_SUCCESS           Execution was stalled for at least the
+                                requested amount of microseconds.
+
+**/
+EFI_STATUS
+EFIAPI
+StallStatsStall (
+  IN UINTN    Microseconds
+  )
+{
+  EFI_STATUS  Status;
+  EFI_TPL     OldTpl;
+
+  Status = mOriginalStall (Microseconds);
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  RecordStall ((UINT64)(UINTN)RETURN_ADDRESS (0), Microseconds);
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
+}
+
+/**
+  Take over the PEI stall statistics and hook gBS->Stall ().
+
+  @param[in] ImageHandle    The firmware allocated handle for the EFI image.
+  @param[in] SystemTable    A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS           The stalls are being recorded.
+  @retval EFI_OUT_OF_RESOURCES  There is not enough memory for the statistics.
+
+**/
+EFI_STATUS
+EFIAPI
+StallStatsDxeEntryPoint (
+  IN EFI_HANDLE           ImageHandle,
+  IN EFI_SYSTEM_TABLE     *SystemTable
+  )
+{
+  EFI_STATUS          Status;
+  EFI_HOB_GUID_TYPE   *GuidHob;
+  EFI_TPL             OldTpl;
+
+  mStallStats = AllocateZeroPool (sizeof (STALL_STATS));
+  if (mStallStats == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  GuidHob = GetFirstGuidHob (&gStallStatsGuid);
+  if ((GuidHob != NULL) && (GET_GUID_HOB_DATA_SIZE (GuidHob) >= sizeof (STALL_STATS))) {
+    CopyMem (mStallStats, GET_GUID_HOB_DATA (GuidHob), sizeof (STALL_STATS));
+  }
+
+  Status = gBS->InstallConfigurationTable (&gStallStatsGuid, mStallStats);
+  if (EFI_ERROR (Status)) {
+    FreePool (mStallStats);
+    return Status;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  mOriginalStall = gBS->Stall;
+  gBS->Stall     = StallStatsStall;
+  gBS->Hdr.CRC32 = 0;
+  gBS->CalculateCrc32 (gBS, gBS->Hdr.HeaderSize, &gBS->Hdr.CRC32);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
@@ -11,9 +11,143 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/MemoryAllocationLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/DebugLib.h>
+#include <Library/PrintLib.h>
 #include <Library/UefiLib.h>
 #include <Library/TestPointLib.h>
+#include <Library/PeCoffGetEntryPointLib.h>
 #include <Protocol/AdapterInformation.h>
+#include <Protocol/LoadedImage.h>
+#include <Protocol/ShellParameters.h>
+#include <Protocol/SimpleFileSystem.h>
+#include <Guid/StallStats.h>
+
+//
+// Size in CHAR16 of the buffer a single piece of the dump is formatted in.
+//
+#define DUMP_LINE_LENGTH          256
+
+//
+// Number of feature bytes dumped per line.
+//
+#define DUMP_FEATURES_PER_LINE    32
+
+//
+// The binary export (-b) is a sequence of records, each made of this header
+// followed by Size bytes of data. Type is gAdapterInfoPlatformTestPointGuid
+// for an ADAPTER_INFO_PLATFORM_TEST_POINT block as returned by the AIP, or
+// gStallStatsGuid for the STALL_STATS table.
+//
+#pragma pack(1)
+typedef struct {
+  EFI_GUID  Type;
+  UINT32    Size;
+} TEST_POINT_DUMP_RECORD_HEADER;
+#pragma pack()
+
+//
+// The file the dump goes to, or NULL to print it on the console.
+//
+EFI_FILE_PROTOCOL  *mDumpFile;
+BOOLEAN            mDumpBinary;
+
+/**
+  Write a formatted string to the dump output.
+
+  The output goes to the file given with -o, or to the console when there
+  is none. The string is formatted once and written in a single call, so
+  the dump does not pay the console or file system overhead per character.
+
+  @param[in] Format   A Null-terminated format string.
+  @param[in] ...      The variable argument list used by Format.
+**/
+VOID
+EFIAPI
+DumpPrint (
+  IN CONST CHAR16             *Format,
+  ...
+  )
+{
+  VA_LIST                     Marker;
+  CHAR16                      Buffer[DUMP_LINE_LENGTH];
+  UINTN                       Size;
+
+  VA_START (Marker, Format);
+  UnicodeVSPrint (Buffer, sizeof (Buffer), Format, Marker);
+  VA_END (Marker);
+
+  if (mDumpFile == NULL) {
+    Print (L"%s", Buffer);
+    return ;
+  }
+
+  Size = StrLen (Buffer) * sizeof (CHAR16);
+  mDumpFile->Write (mDumpFile, &Size, Buffer);
+}
+
+/**
+  Write a record of the binary export.
+
+  @param[in] Type     The type of the record.
+  @param[in] Data     The data of the record.
+  @param[in] Size     The size of the data in bytes.
+
+  @retval EFI_SUCCESS The record was written.
+  @retval Others      The file could not be written.
+**/
+EFI_STATUS
+DumpRecord (
+  IN EFI_GUID                 *Type,
+  IN VOID                     *Data,
+  IN UINTN                    Size
+  )
+{
+  EFI_STATUS                    Status;
+  TEST_POINT_DUMP_RECORD_HEADER Header;
+  UINTN                         WriteSize;
+
+  CopyGuid (&Header.Type, Type);
+  Header.Size = (UINT32)Size;
+
+  WriteSize = sizeof (Header);
+  Status = mDumpFile->Write (mDumpFile, &WriteSize, &Header);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  WriteSize = Size;
+  return mDumpFile->Write (mDumpFile, &WriteSize, Data);
+}
+
+/**
+  Dump a byte array as hex, several bytes per line.
+
+  @param[in] Name     The name of the array, printed in front of the first line.
+  @param[in] Data     The bytes to dump.
+  @param[in] Size     The number of bytes to dump.
+**/
+VOID
+DumpFeatures (
+  IN CHAR16                   *Name,
+  IN UINT8                    *Data,
+  IN UINTN                    Size
+  )
+{
+  CHAR16                      Line[DUMP_FEATURES_PER_LINE * 3 + 1];
+  UINTN                       Index;
+  UINTN                       Length;
+
+  DumpPrint (L"  %-20s- ", Name);
+  Line[0] = 0;
+  Length = 0;
+  for (Index = 0; Index < Size; Index++) {
+    if ((Index != 0) && ((Index % DUMP_FEATURES_PER_LINE) == 0)) {
+      DumpPrint (L"%s\n                        ", Line);
+      Length = 0;
+    }
+    Length += UnicodeSPrint (&Line[Length], sizeof (Line) - Length * sizeof (CHAR16), L"%02x ", Data[Index]);
+  }
+  DumpPrint (L"%s\n", Line);
+}
 
 VOID
 DumpTestPoint (
@@ -23,45 +157,51 @@ DumpTestPoint (
   ADAPTER_INFO_PLATFORM_TEST_POINT *TestPoint;
   UINT8                            *Features;
   CHAR16                           *ErrorString;
-  UINTN                            Index;
   CHAR16                           ErrorChar;
+  CHAR16                           Line[DUMP_LINE_LENGTH];
+  UINTN                            Length;
 
   TestPoint = TestPointData;
-  Print (L"TestPoint\n");
-  Print (L"  Version                     - 0x%08x\n", TestPoint->Version);
-  Print (L"  Role                        - 0x%08x\n", TestPoint->Role);
-  Print (L"  ImplementationID            - %S\n", TestPoint->ImplementationID);
-  Print (L"  FeaturesSize                - 0x%08x\n", TestPoint->FeaturesSize);
+  DumpPrint (L"TestPoint\n");
+  DumpPrint (L"  Version                     - 0x%08x\n", TestPoint->Version);
+  DumpPrint (L"  Role                        - 0x%08x\n", TestPoint->Role);
+  DumpPrint (L"  ImplementationID            - %S\n", TestPoint->ImplementationID);
+  DumpPrint (L"  FeaturesSize                - 0x%08x\n", TestPoint->FeaturesSize);
 
   Features = (UINT8 *)(TestPoint + 1);
-  Print (L"  FeaturesImplemented - ");
-  for (Index = 0; Index < TestPoint->FeaturesSize; Index++) {
-    Print (L"%02x ", Features[Index]);
-  }
-  Print (L"\n");
+  DumpFeatures (L"FeaturesImplemented", Features, TestPoint->FeaturesSize);
 
   Features = (UINT8 *)(Features + TestPoint->FeaturesSize);
-  Print (L"  FeaturesVerified    - ");
-  for (Index = 0; Index < TestPoint->FeaturesSize; Index++) {
-    Print (L"%02x ", Features[Index]);
-  }
-  Print (L"\n");
+  DumpFeatures (L"FeaturesVerified", Features, TestPoint->FeaturesSize);
 
+  //
+  // The error string follows the feature arrays unaligned, and is escaped
+  // into a line buffer which is written out whenever it fills up.
+  //
   ErrorString = (CHAR16 *)(Features + TestPoint->FeaturesSize);
-  Print (L"  ErrorString                 - \"");
+  DumpPrint (L"  ErrorString                 - \"");
+  Length = 0;
   CopyMem (&ErrorChar, ErrorString, sizeof(ErrorChar));
   for (; ErrorChar != 0;) {
+    if (Length + 3 > ARRAY_SIZE (Line)) {
+      Line[Length] = 0;
+      DumpPrint (L"%s", Line);
+      Length = 0;
+    }
     if (ErrorChar == L'\r') {
-      Print (L"\\r");
+      Line[Length++] = L'\\';
+      Line[Length++] = L'r';
     } else if (ErrorChar == L'\n') {
-      Print (L"\\n");
+      Line[Length++] = L'\\';
+      Line[Length++] = L'n';
     } else {
-      Print (L"%c", ErrorChar);
+      Line[Length++] = ErrorChar;
     }
     ErrorString++;
     CopyMem (&ErrorChar, ErrorString, sizeof(ErrorChar));
   }
-  Print (L"\"\n");
+  Line[Length] = 0;
+  DumpPrint (L"%s\"\n", Line);
 }
 
 VOID
@@ -149,16 +289,273 @@ DumpTestPointDataDxe (
 
     TestPoint = InformationBlock;
 
-    if ((Role == 0) ||
-        ((TestPoint->Role == Role) && 
-         ((ImplementationID == NULL) || (StrCmp (ImplementationID, TestPoint->ImplementationID) == 0)))) {
-      DumpTestPoint (TestPoint);
+    if (((Role == 0) || (TestPoint->Role == Role)) &&
+        ((ImplementationID == NULL) || (StrCmp (ImplementationID, TestPoint->ImplementationID) == 0))) {
+      if (mDumpBinary) {
+        DumpRecord (&gAdapterInfoPlatformTestPointGuid, TestPoint, InformationBlockSize);
+      } else {
+        DumpTestPoint (TestPoint);
+      }
     }
     FreePool (InformationBlock);
   }
   FreePool (Handles);
 }
 
+/**
+  Find the loaded image containing an address.
+
+  @param[in]  Address             The address to look up.
+  @param[out] ImageBase           On return, the base of the image.
+
+  @return The PDB name of the image, or NULL if the address is not in any
+          loaded image or the image has no debug information.
+**/
+CHAR8 *
+GetImageName (
+  IN  UINT64                  Address,
+  OUT UINT64                  *ImageBase
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_HANDLE                  *Handles;
+  UINTN                       NoHandles;
+  UINTN                       Index;
+  EFI_LOADED_IMAGE_PROTOCOL   *LoadedImage;
+  CHAR8                       *PdbPointer;
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiLoadedImageProtocolGuid,
+                  NULL,
+                  &NoHandles,
+                  &Handles
+                  );
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  PdbPointer = NULL;
+  for (Index = 0; Index < NoHandles; Index++) {
+    Status = gBS->HandleProtocol (
+                    Handles[Index],
+                    &gEfiLoadedImageProtocolGuid,
+                    (VOID **)&LoadedImage
+                    );
+    if (EFI_ERROR (Status)) {
+      continue;
+    }
+    if ((Address >= (UINTN)LoadedImage->ImageBase) &&
+        (Address < (UINTN)LoadedImage->ImageBase + LoadedImage->ImageSize)) {
+      *ImageBase = (UINTN)LoadedImage->ImageBase;
+      PdbPointer = PeCoffLoaderGetPdbPointer (LoadedImage->ImageBase);
+      break;
+    }
+  }
+  FreePool (Handles);
+
+  return PdbPointer;
+}
+
+/**
+  Dump the stall statistics, ordered by the total time stalled.
+**/
+VOID
+DumpStallStats (
+  VOID
+  )
+{
+  EFI_STATUS                  Status;
+  STALL_STATS                 *Stats;
+  STALL_STATS_ENTRY           *Entry;
+  BOOLEAN                     Dumped[STALL_STATS_MAX_ENTRIES];
+  UINTN                       Count;
+  UINTN                       Index;
+  UINTN                       Largest;
+  CHAR8                       *ImageName;
+  UINT64                      ImageBase;
+
+  Status = EfiGetSystemConfigurationTable (&gStallStatsGuid, (VOID **)&Stats);
+  if (EFI_ERROR (Status)) {
+    return ;
+  }
+
+  if (mDumpBinary) {
+    DumpRecord (&gStallStatsGuid, Stats, sizeof (*Stats));
+    return ;
+  }
+
+  DumpPrint (L"StallStats\n");
+  DumpPrint (L"  Phase Caller             Count      TotalUs          MaxUs            Module\n");
+
+  ZeroMem (Dumped, sizeof (Dumped));
+  for (Count = 0; Count < MIN (Stats->EntryCount, STALL_STATS_MAX_ENTRIES); Count++) {
+    Largest = STALL_STATS_MAX_ENTRIES;
+    for (Index = 0; Index < MIN (Stats->EntryCount, STALL_STATS_MAX_ENTRIES); Index++) {
+      if (!Dumped[Index] &&
+          ((Largest == STALL_STATS_MAX_ENTRIES) ||
+           (Stats->Entry[Index].TotalMicroseconds > Stats->Entry[Largest].TotalMicroseconds))) {
+        Largest = Index;
+      }
+    }
+    Dumped[Largest] = TRUE;
+
+    Entry = &Stats->Entry[Largest];
+    DumpPrint (
+      L"  %a   0x%016lx %-10d %-16ld %-16ld ",
+      (Entry->Phase == STALL_STATS_PHASE_PEI) ? "PEI" : "DXE",
+      Entry->Caller,
+      Entry->Count,
+      Entry->TotalMicroseconds,
+      Entry->MaxMicroseconds
+      );
+    //
+    // The PEI images are gone, their callers have to be looked up in the
+    // build map files.
+    //
+    ImageName = NULL;
+    if (Entry->Phase == STALL_STATS_PHASE_DXE) {
+      ImageName = GetImageName (Entry->Caller, &ImageBase);
+    }
+    if (ImageName != NULL) {
+      DumpPrint (L"%a+0x%lx\n", ImageName, Entry->Caller - ImageBase);
+    } else {
+      DumpPrint (L"-\n");
+    }
+  }
+
+  if (Stats->DroppedCount != 0) {
+    DumpPrint (L"  Not accounted: %ld stalls, %ld us\n", Stats->DroppedCount, Stats->DroppedMicroseconds);
+  }
+}
+
+/**
+  Create the dump file on a volume.
+
+  An existing file of the same name is replaced.
+
+  @param[in]  Device        The handle of the volume.
+  @param[in]  FileName      The path of the file on the volume.
+  @param[out] File          On return, the opened file.
+
+  @retval EFI_SUCCESS       The file has been created.
+  @retval Others            The file could not be created on this volume.
+**/
+EFI_STATUS
+CreateDumpFile (
+  IN  EFI_HANDLE                  Device,
+  IN  CHAR16                      *FileName,
+  OUT EFI_FILE_PROTOCOL           **File
+  )
+{
+  EFI_STATUS                      Status;
+  EFI_SIMPLE_FILE_SYSTEM_PROTOCOL *FileSystem;
+  EFI_FILE_PROTOCOL               *Root;
+  UINT64                          OpenMode;
+
+  Status = gBS->HandleProtocol (Device, &gEfiSimpleFileSystemProtocolGuid, (VOID **)&FileSystem);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = FileSystem->OpenVolume (FileSystem, &Root);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  OpenMode = EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE;
+  Status = Root->Open (Root, File, FileName, OpenMode, 0);
+  if (!EFI_ERROR (Status)) {
+    //
+    // Replace the previous dump instead of overwriting it in place.
+    //
+    (*File)->Delete (*File);
+    Status = Root->Open (Root, File, FileName, OpenMode, 0);
+  }
+  Root->Close (Root);
+
+  return Status;
+}
+
+/**
+  Create the file the dump is written to.
+
+  The file is created on the volume the application was loaded from, or on
+  the first other volume it can be created on when that one is read-only.
+
+  @param[in]  ImageHandle   The image handle of the application.
+  @param[in]  FileName      The path of the file on the volume.
+  @param[out] File          On return, the opened file.
+
+  @retval EFI_SUCCESS       The file has been created.
+  @retval Others            No volume accepted the file.
+**/
+EFI_STATUS
+OpenDumpFile (
+  IN  EFI_HANDLE                  ImageHandle,
+  IN  CHAR16                      *FileName,
+  OUT EFI_FILE_PROTOCOL           **File
+  )
+{
+  EFI_STATUS                      Status;
+  EFI_LOADED_IMAGE_PROTOCOL       *LoadedImage;
+  EFI_HANDLE                      *Handles;
+  UINTN                           NoHandles;
+  UINTN                           Index;
+  EFI_HANDLE                      Device;
+
+  Device = NULL;
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiLoadedImageProtocolGuid, (VOID **)&LoadedImage);
+  if (!EFI_ERROR (Status)) {
+    Device = LoadedImage->DeviceHandle;
+    Status = CreateDumpFile (Device, FileName, File);
+    if (!EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiSimpleFileSystemProtocolGuid,
+                  NULL,
+                  &NoHandles,
+                  &Handles
+                  );
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = EFI_NOT_FOUND;
+  for (Index = 0; Index < NoHandles; Index++) {
+    if (Handles[Index] == Device) {
+      continue;
+    }
+    Status = CreateDumpFile (Handles[Index], FileName, File);
+    if (!EFI_ERROR (Status)) {
+      break;
+    }
+  }
+  FreePool (Handles);
+
+  return Status;
+}
+
+/**
+  Print the usage of the application.
+**/
+VOID
+PrintUsage (
+  VOID
+  )
+{
+  Print (L"Usage: TestPointDumpApp [-r Role] [-i ImplementationID] [-o File [-b]]\n");
+  Print (L"  -r  Only dump the test points of this role.\n");
+  Print (L"  -i  Only dump the test points of this implementation ID.\n");
+  Print (L"  -o  Write the dump to File instead of the console.\n");
+  Print (L"  -b  Write the raw test point data, with a GUID and size header\n");
+  Print (L"      in front of every record, instead of text.\n");
+}
+
 EFI_STATUS
 EFIAPI
 TestPointDumpAppEntrypoint (
@@ -166,7 +563,67 @@ TestPointDumpAppEntrypoint (
   IN EFI_SYSTEM_TABLE     *SystemTable
   )
 {
-  DumpTestPointDataDxe (0, NULL);
+  EFI_STATUS                     Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL  *ShellParameters;
+  UINTN                          Index;
+  UINT32                         Role;
+  CHAR16                         *ImplementationID;
+  CHAR16                         *FileName;
+  UINTN                          Size;
+  CHAR16                         ByteOrderMark;
+
+  Role = 0;
+  ImplementationID = NULL;
+  FileName = NULL;
+  mDumpBinary = FALSE;
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **) &ShellParameters);
+  if (!EFI_ERROR (Status)) {
+    for (Index = 1; Index < ShellParameters->Argc; Index++) {
+      if ((StrCmp (ShellParameters->Argv[Index], L"-r") == 0) && (Index + 1 < ShellParameters->Argc)) {
+        Role = (UINT32)StrHexToUintn (ShellParameters->Argv[++Index]);
+      } else if ((StrCmp (ShellParameters->Argv[Index], L"-i") == 0) && (Index + 1 < ShellParameters->Argc)) {
+        ImplementationID = ShellParameters->Argv[++Index];
+      } else if ((StrCmp (ShellParameters->Argv[Index], L"-o") == 0) && (Index + 1 < ShellParameters->Argc)) {
+        FileName = ShellParameters->Argv[++Index];
+      } else if (StrCmp (ShellParameters->Argv[Index], L"-b") == 0) {
+        mDumpBinary = TRUE;
+      } else {
+        PrintUsage ();
+        return EFI_INVALID_PARAMETER;
+      }
+    }
+  }
+
+  if (mDumpBinary && (FileName == NULL)) {
+    PrintUsage ();
+    return EFI_INVALID_PARAMETER;
+  }
+
+  mDumpFile = NULL;
+  if (FileName != NULL) {
+    Status = OpenDumpFile (ImageHandle, FileName, &mDumpFile);
+    if (EFI_ERROR (Status)) {
+      Print (L"TestPointDumpApp: Create %s - %r\n", FileName, Status);
+      return Status;
+    }
+    if (!mDumpBinary) {
+      //
+      // The text dump is UCS-2, mark it so that editors and the shell
+      // commands recognize it.
+      //
+      ByteOrderMark = 0xFEFF;
+      Size = sizeof (ByteOrderMark);
+      mDumpFile->Write (mDumpFile, &Size, &ByteOrderMark);
+    }
+  }
+
+  DumpTestPointDataDxe (Role, ImplementationID);
+  DumpStallStats ();
+
+  if (mDumpFile != NULL) {
+    mDumpFile->Close (mDumpFile);
+    mDumpFile = NULL;
+  }
 
   return EFI_SUCCESS;
 }
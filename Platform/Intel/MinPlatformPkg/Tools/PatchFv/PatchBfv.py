@@ -13,6 +13,7 @@ import shutil
 import struct
 import binascii
 from   ctypes import *
+from   PcdReport import GetPcdIndex, GetPcdFromIndex
 
 class FileChecker:
     def __init__(self):
@@ -25,18 +26,14 @@ class FileChecker:
 
     def ProcessReport(self):
         try :
-            file = open(self.reportFile)
+            PcdIndex = GetPcdIndex (self.reportFile)
         except Exception:
             print "fail to open " + self.reportFile
             return
-        try:
-            file.seek(0)
-            print "checking - " + self.pcd[0]
-            ValuePair = self.GetPcdFromReport (file, self.pcd[0])
-            self.pcd[1] = ValuePair[0]
-            self.pcd[2] = ValuePair[1]
-        finally:
-            file.close()
+        print "checking - " + self.pcd[0]
+        ValuePair = GetPcdFromIndex (PcdIndex, self.pcd[0])
+        self.pcd[1] = ValuePair[0]
+        self.pcd[2] = ValuePair[1]
 
         self.PrintPcd()
 
@@ -65,41 +62,6 @@ class FileChecker:
         finally:
             file.close()
 
-    def GetPcdFromReport(self, file, pcd):
-        FoundPkg = False
-        pcdSplit = pcd.split(".")
-        TargetPkg = pcdSplit[0]
-        TargetPcd = pcdSplit[1]
-        while 1:
-            line = file.readline()
-            if not line:
-                break
-
-            newline = line[:-1]
-
-            if (cmp (newline, TargetPkg) == 0):
-                FoundPkg = True
-                continue
-
-            if (cmp (newline, "") == 0) or ((cmp (newline[0], " ") != 0) and (cmp (newline[0], "0") != 0)):
-                FoundPkg = False
-
-            if (FoundPkg == True) :
-                newline = newline.strip()
-                splitLine = newline.split(" ", 2)
-                if (cmp (splitLine[0], "*F") == 0) or (cmp (splitLine[0], "*P") == 0) :
-                    if (cmp (splitLine[1], TargetPcd) == 0):
-                        print "found - " + TargetPkg + "." + TargetPcd
-
-                        splitLine = splitLine[2].strip()[1:].strip().split(" ", 1)
-                        if (cmp (splitLine[0], "FIXED") == 0) or (cmp (splitLine[0], "PATCH") == 0):
-                            SplitLine = splitLine[1].strip()[1:].split(")", 1)
-                            Type = SplitLine[0]
-                            Value = SplitLine[1].strip()[1:].strip().split()[0]
-                            print "  Type - (" + Type + "), Value - (" + Value + ")"
-                            return [Value, Type]
-        return ["", ""]
-            
 def main():
     global FileChecker
 
@@ -0,0 +1,101 @@
+## @ PcdReport.py
+#
+# Index of the FIXED and PATCH PCD values of a build report, used by the
+# PatchFv scripts. The report is parsed once and the index is saved next to
+# it, so that the following scripts of the same build reuse it as long as the
+# report does not change.
+#
+# Copyright (c) 2020, Intel Corporation. All rights reserved.<BR>
+# SPDX-License-Identifier: BSD-2-Clause-Patent
+#
+##
+
+import os
+import pickle
+
+PCD_INDEX_VERSION = 1
+
+def ParsePcdReport(file):
+    PcdIndex = {}
+    CurrentPkg = None
+    for line in file:
+        newline = line.rstrip('\n').replace('\r','')
+
+        if newline == "":
+            CurrentPkg = None
+            continue
+
+        #
+        # A token space GUID starts a package, any other line not starting
+        # with a space or a value ends it.
+        #
+        if (newline[0] != " ") and (newline[0] != "0"):
+            CurrentPkg = newline
+            continue
+
+        if CurrentPkg == None:
+            continue
+
+        splitLine = newline.strip().split(" ", 2)
+        if (len(splitLine) < 3) or ((splitLine[0] != "*F") and (splitLine[0] != "*P")):
+            continue
+
+        #
+        # The first FIXED or PATCH value of a PCD wins
+        #
+        PcdName = CurrentPkg + "." + splitLine[1]
+        if PcdName in PcdIndex:
+            continue
+
+        try:
+            splitLine = splitLine[2].strip()[1:].strip().split(" ", 1)
+            if (splitLine[0] == "FIXED") or (splitLine[0] == "PATCH"):
+                SplitLine = splitLine[1].strip()[1:].split(")", 1)
+                Type = SplitLine[0]
+                Value = SplitLine[1].strip()[1:].strip().split()[0]
+                PcdIndex[PcdName] = [Value, Type]
+        except IndexError:
+            continue
+
+    return PcdIndex
+
+def GetPcdIndex(reportFile):
+    indexFile = reportFile + ".PcdIndex"
+    stat = os.stat(reportFile)
+    key = (PCD_INDEX_VERSION, stat.st_size, stat.st_mtime)
+
+    try:
+        file = open(indexFile, "rb")
+        try:
+            cached = pickle.load(file)
+        finally:
+            file.close()
+        if cached[0] == key:
+            return cached[1]
+    except Exception:
+        pass
+
+    file = open(reportFile)
+    try:
+        PcdIndex = ParsePcdReport(file)
+    finally:
+        file.close()
+
+    try:
+        file = open(indexFile, "wb")
+        try:
+            pickle.dump((key, PcdIndex), file, 2)
+        finally:
+            file.close()
+    except Exception:
+        pass
+
+    return PcdIndex
+
+def GetPcdFromIndex(PcdIndex, pcd):
+    if pcd in PcdIndex:
+        ValuePair = PcdIndex[pcd]
+        print("found - " + pcd)
+        print("  Type - (" + ValuePair[1] + "), Value - (" + ValuePair[0] + ")")
+        return [ValuePair[0], ValuePair[1]]
+    return ["", ""]
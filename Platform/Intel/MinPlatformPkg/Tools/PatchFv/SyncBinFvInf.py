@@ -11,6 +11,7 @@ import sys
 import time
 import shutil
 from   ctypes import *
+from   PcdReport import GetPcdIndex, GetPcdFromIndex
 
 class GUID(Structure):
     _fields_ = [
@@ -387,56 +388,17 @@ class FileChecker:
 
         self.ParseInfFiles (self.FfsInfList, self.PeOffsetList, os.path.join(self.destRoot,fvName+"\\"+self.target+"\\"+fvName+".inf"), RebasePcd)
 
-    def GetPcdFromReport(self, file, pcd):
-        FoundPkg = False
-        pcdSplit = pcd.split(".")
-        TargetPkg = pcdSplit[0]
-        TargetPcd = pcdSplit[1]
-        while 1:
-            line = file.readline()
-            if not line:
-                break
-
-            newline = line[:-1]
-
-            if (cmp (newline, TargetPkg) == 0):
-                FoundPkg = True
-                continue
-
-            if (cmp (newline, "") == 0) or ((cmp (newline[0], " ") != 0) and (cmp (newline[0], "0") != 0)):
-                FoundPkg = False
-
-            if (FoundPkg == True) :
-                newline = newline.strip()
-                splitLine = newline.split(" ", 2)
-                if (cmp (splitLine[0], "*F") == 0) or (cmp (splitLine[0], "*P") == 0):
-                    if (cmp (splitLine[1], TargetPcd) == 0):
-                        print "found - " + TargetPkg + "." + TargetPcd
-
-                        splitLine = splitLine[2].strip()[1:].strip().split(" ", 1)
-                        if (cmp (splitLine[0], "FIXED") == 0) or (cmp (splitLine[0], "PATCH") == 0):
-                            SplitLine = splitLine[1].strip()[1:].split(")", 1)
-                            Type = SplitLine[0]
-                            Value = SplitLine[1].strip()[1:].strip().split()[0]
-                            print "  Type - (" + Type + "), Value - (" + Value + ")"
-                            return [Value, Type]
-        return ["", ""]
-
     def GetRebaseAddressFromReport(self):
         try :
-            file = open(self.reportFile)
+            PcdIndex = GetPcdIndex (self.reportFile)
         except Exception:
             print "fail to open " + self.reportFile
             return
-        try:
-            file.seek(0)
-            if (cmp(self.RebasePcd[0], "") != 0):
-                print "checking - " + self.RebasePcd[0]
-                ValuePair = self.GetPcdFromReport (file, self.RebasePcd[0])
-                self.RebasePcd[1] = ValuePair[0]
-                self.RebasePcd[2] = ValuePair[1]
-        finally:
-            file.close()
+        if (cmp(self.RebasePcd[0], "") != 0):
+            print "checking - " + self.RebasePcd[0]
+            ValuePair = GetPcdFromIndex (PcdIndex, self.RebasePcd[0])
+            self.RebasePcd[1] = ValuePair[0]
+            self.RebasePcd[2] = ValuePair[1]
 
     def DumpFileList(self, dir):
         #print "DumpFileList - " + dir
@@ -17,6 +17,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define PCIE_OFF(Bus, Device, Function, Register) \
     ((UINT64) ((UINTN) (Bus << 20) + (UINTN) (Device << 15) + (UINTN) (Function << 12) + (UINTN) (Register)))
 
+//
+// Size of the bounce buffer RootBridgeIoCopyMem moves the data through
+//
+#define COPY_MEM_BUFFER_SIZE  256
+
 //
 // Pci Root Bridge Io Module Variables
 //
@@ -694,59 +699,90 @@ Returns:
                             resources.
 --*/
 {
-  EFI_STATUS  Status;
-  BOOLEAN     Direction;
-  UINTN       Stride;
-  UINTN       Index;
-  UINT64      Result;
+  EFI_STATUS                Status;
+  PCI_ROOT_BRIDGE_INSTANCE  *PrivateData;
+  BOOLEAN                   Direction;
+  UINTN                     Stride;
+  UINTN                     ChunkCount;
+  UINT64                    Length;
+  UINT64                    Limit;
+  UINT32                    Buffer[COPY_MEM_BUFFER_SIZE / sizeof (UINT32)];
 
-  if (Width < 0 || Width > EfiPciWidthUint64) {
+  //
+  // 64-bit memory accesses are not supported by RootBridgeIoMemRead/Write either
+  //
+  if (Width < 0 || Width >= EfiPciWidthUint64) {
     return EFI_INVALID_PARAMETER;
   }
 
-  if (DestAddress == SrcAddress) {
+  if ((DestAddress == SrcAddress) || (Count == 0)) {
     return EFI_SUCCESS;
   }
 
-  Stride    = (UINTN)1 << Width;
+  Stride = (UINTN)1 << Width;
+  Length = MultU64x32 ((UINT64) (Count - 1), (UINT32) Stride);
+
+  //
+  // Check memory access limit once for the whole range, instead of once per element
+  //
+  PrivateData = DRIVER_INSTANCE_FROM_PCI_ROOT_BRIDGE_IO_THIS (This);
+  if (PrivateData->Aperture.Mem64Limit > PrivateData->Aperture.Mem64Base) {
+    Limit = PrivateData->Aperture.Mem64Limit;
+  } else {
+    Limit = PrivateData->Aperture.Mem32Limit;
+  }
+  if ((SrcAddress > Limit) || (Length > Limit - SrcAddress) ||
+      (DestAddress > Limit) || (Length > Limit - DestAddress)) {
+    return EFI_INVALID_PARAMETER;
+  }
 
   Direction = TRUE;
-  if ((DestAddress > SrcAddress) && (DestAddress < (SrcAddress + Count * Stride))) {
+  if ((DestAddress > SrcAddress) && (DestAddress < (SrcAddress + Length + Stride))) {
     Direction   = FALSE;
-    SrcAddress  = SrcAddress + (Count - 1) * Stride;
-    DestAddress = DestAddress + (Count - 1) * Stride;
+    SrcAddress  = SrcAddress + Length + Stride;
+    DestAddress = DestAddress + Length + Stride;
   }
 
-  for (Index = 0; Index < Count; Index++) {
-    Status = RootBridgeIoMemRead (
-              This,
-              Width,
-              SrcAddress,
-              1,
-              &Result
-              );
+  //
+  // Move the data in chunks, so that CPU IO does the accesses of a whole chunk
+  // in one call. Each chunk is read completely before it is written, and the
+  // chunks are taken from the end if the destination overlaps the end of the
+  // source, so overlapping ranges are copied correctly.
+  //
+  while (Count > 0) {
+    ChunkCount = MIN (Count, sizeof (Buffer) / Stride);
+    if (!Direction) {
+      SrcAddress  -= ChunkCount * Stride;
+      DestAddress -= ChunkCount * Stride;
+    }
+
+    Status = mCpuIo->Mem.Read (
+                           mCpuIo,
+                           (EFI_CPU_IO_PROTOCOL_WIDTH) Width,
+                           SrcAddress,
+                           ChunkCount,
+                           Buffer
+                           );
     if (EFI_ERROR (Status)) {
       return Status;
     }
 
-    Status = RootBridgeIoMemWrite (
-              This,
-              Width,
-              DestAddress,
-              1,
-              &Result
-              );
+    Status = mCpuIo->Mem.Write (
+                           mCpuIo,
+                           (EFI_CPU_IO_PROTOCOL_WIDTH) Width,
+                           DestAddress,
+                           ChunkCount,
+                           Buffer
+                           );
     if (EFI_ERROR (Status)) {
       return Status;
     }
 
     if (Direction) {
-      SrcAddress += Stride;
-      DestAddress += Stride;
-    } else {
-      SrcAddress -= Stride;
-      DestAddress -= Stride;
+      SrcAddress  += ChunkCount * Stride;
+      DestAddress += ChunkCount * Stride;
     }
+    Count -= ChunkCount;
   }
 
   return EFI_SUCCESS;
@@ -362,6 +362,13 @@ MemoryInit (
         MrcData.boot_mode = bmCold;
         break;
       }
+    } else if ((MrcData.boot_mode == bmCold) && FixedPcdGetBool (PcdMrcRestoreSavedTimings)) {
+      //
+      // Try the saved timings first, MRC revalidates them and trains
+      // the memory again if they do not pass.
+      //
+      DEBUG ((DEBUG_INFO, "MemoryInit:Try saved timings before training\n"));
+      MrcData.boot_mode = bmFast;
     }
   }
 
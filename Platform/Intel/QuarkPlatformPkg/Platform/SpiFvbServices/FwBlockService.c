@@ -505,6 +505,37 @@ Returns:
   return Status;
 }
 
+BOOLEAN
+FlashFdIsErased (
+  IN UINTN                                Address,
+  IN UINTN                                Length
+  )
+/*++
+
+Routine Description:
+  Checks through the memory mapped BIOS window whether a flash range is erased
+
+Arguments:
+  Address               - The memory mapped address of the range, DWORD aligned
+  Length                - The length of the range, a multiple of DWORDs
+
+Returns:
+  TRUE                  - All the bytes of the range are 0xFF
+  FALSE                 - The range needs to be erased
+
+--*/
+{
+  UINTN   Offset;
+
+  for (Offset = 0; Offset < Length; Offset += sizeof (UINT32)) {
+    if (MmioRead32 (Address + Offset) != 0xFFFFFFFF) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
 EFI_STATUS
 FlashFdWrite (
   IN  UINTN                               WriteAddress,
@@ -666,6 +697,8 @@ Returns:
   EFI_FW_VOL_INSTANCE *FwhInstance;
   EFI_STATUS          Status;
   EFI_STATUS          ReturnStatus;
+  UINTN               Offset;
+  UINTN               Length;
 
   FwhInstance = NULL;
 
@@ -716,11 +749,29 @@ Returns:
     Status    = EFI_BAD_BUFFER_SIZE;
   }
 
+  //
+  // Only program the bytes that differ from the current flash contents. The
+  // leading and trailing bytes that already hold the data are skipped, and
+  // so is the whole SPI cycle if nothing changes.
+  //
+  Offset = 0;
+  Length = *NumBytes;
+  while ((Offset < Length) && (MmioRead8 (LbaAddress + BlockOffset + Offset) == Buffer[Offset])) {
+    Offset++;
+  }
+  while ((Length > Offset) && (MmioRead8 (LbaAddress + BlockOffset + Length - 1) == Buffer[Length - 1])) {
+    Length--;
+  }
+  if (Length == Offset) {
+    return Status;
+  }
+  Length -= Offset;
+
   ReturnStatus = FlashFdWrite (
-                  LbaWriteAddress + BlockOffset,
+                  LbaWriteAddress + BlockOffset + Offset,
                   LbaAddress,
-                  NumBytes,
-                  Buffer,
+                  &Length,
+                  Buffer + Offset,
                   LbaLength
                   );
   if (EFI_ERROR (ReturnStatus)) {
@@ -802,6 +853,12 @@ Returns:
 
   SectorNum = LbaLength / SPI_ERASE_SECTOR_SIZE;
   for (Index = 0; Index < SectorNum; Index++){
+    //
+    // Save the erase cycle, and the wear, of sectors that are already blank.
+    //
+    if (FlashFdIsErased (LbaAddress + Index * SPI_ERASE_SECTOR_SIZE, SPI_ERASE_SECTOR_SIZE)) {
+      continue;
+    }
     Status = FlashFdErase (
                LbaWriteAddress + Index * SPI_ERASE_SECTOR_SIZE,
                LbaAddress,
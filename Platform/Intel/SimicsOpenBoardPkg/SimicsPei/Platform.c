@@ -496,20 +496,25 @@ SimicsVersionCheck(
   UINTN           PciAddrPtr;
   UINT8           CapOffset;
   STATIC CHAR8    SimicsStr[0x100];
-  UINTN           i;
   UINT32          MajorVersion;
   UINT32          MinorVersion;
   UINT32          ModelNumber;
 
+  //
+  // The version is only printed. Every config access is a simulated device
+  // access, so skip them when the message would not be shown.
+  //
+  if (!DebugPrintLevelEnabled (DEBUG_INFO)) {
+    return;
+  }
+
   PciAddrPtr = PCI_LIB_ADDRESS(0, SIMICS_SIDEBANDPCI_DEV, SIMICS_SIDEBANDPCI_FUNC, 0);
   CapOffset = PciRead8(PciAddrPtr + PCI_CAPBILITY_POINTER_OFFSET);
   if (CapOffset != 0xFF) {
     ModelNumber = PciRead32(PciAddrPtr + CapOffset + 4);
     MajorVersion = PciRead32(PciAddrPtr + CapOffset + 8);
     MinorVersion = PciRead32(PciAddrPtr + CapOffset + 0xc);
-    for (i = 0; i < 0x80; i++) {
-      SimicsStr[i] = PciRead8(PciAddrPtr + CapOffset + 0x10 + i);
-    }
+    PciReadBuffer (PciAddrPtr + CapOffset + 0x10, 0x80, SimicsStr);
     DEBUG((EFI_D_INFO, "=============SIMICS Version info=============\n"));
     DEBUG((EFI_D_INFO, "Model number = %d\n", ModelNumber));
     DEBUG((EFI_D_INFO, "Major version = %d\n", MajorVersion));
@@ -526,6 +531,10 @@ DebugDumpCmos (
 {
   UINT8 Loop;
 
+  if (!DebugPrintLevelEnabled (DEBUG_INFO)) {
+    return;
+  }
+
   DEBUG ((EFI_D_INFO, "CMOS:\n"));
 
   for (Loop = 0; Loop < 0x80; Loop++) {
@@ -71,6 +71,101 @@ QemuVideoCompleteModeData (
   return EFI_SUCCESS;
 }
 
+/**
+  Create or update a FrameBufferBltLib configuration, growing its buffer if
+  needed.
+
+  @param[in]      FrameBuffer    The frame buffer the configuration is for.
+  @param[in]      Info           The mode information of the frame buffer.
+  @param[in, out] Configure      The configuration buffer, may be reallocated.
+  @param[in, out] ConfigureSize  The size of the configuration buffer.
+
+  @retval RETURN_SUCCESS          The configuration is created.
+  @retval RETURN_OUT_OF_RESOURCES The configuration buffer cannot be allocated.
+  @retval Others                  The mode is not supported by FrameBufferBltLib.
+**/
+STATIC
+RETURN_STATUS
+QemuVideoBltConfigure (
+  IN     VOID                                  *FrameBuffer,
+  IN     EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  *Info,
+  IN OUT FRAME_BUFFER_CONFIGURE                **Configure,
+  IN OUT UINTN                                 *ConfigureSize
+  )
+{
+  RETURN_STATUS                 Status;
+
+  Status = FrameBufferBltConfigure (FrameBuffer, Info, *Configure, ConfigureSize);
+  if (Status == RETURN_BUFFER_TOO_SMALL) {
+    //
+    // Frame buffer configure may be larger in new mode.
+    //
+    if (*Configure != NULL) {
+      FreePool (*Configure);
+    }
+    *Configure = AllocatePool (*ConfigureSize);
+    if (*Configure == NULL) {
+      *ConfigureSize = 0;
+      return RETURN_OUT_OF_RESOURCES;
+    }
+
+    Status = FrameBufferBltConfigure (FrameBuffer, Info, *Configure, ConfigureSize);
+  }
+
+  return Status;
+}
+
+/**
+  Set up the shadow frame buffer for the current mode, cleared to black.
+
+  The shadow always holds EFI_GRAPHICS_OUTPUT_BLT_PIXEL, whatever the pixel
+  format of the device. If it cannot be allocated, Blt works on the device
+  frame buffer directly.
+
+  @param[in, out] Private  The video device.
+  @param[in]      Info     The mode information of the current mode.
+**/
+STATIC
+VOID
+QemuVideoShadowConfigure (
+  IN OUT QEMU_VIDEO_PRIVATE_DATA               *Private,
+  IN     EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  *Info
+  )
+{
+  EFI_GRAPHICS_OUTPUT_MODE_INFORMATION  ShadowInfo;
+  RETURN_STATUS                         Status;
+  UINTN                                 Size;
+
+  Size = Info->HorizontalResolution * Info->VerticalResolution *
+         sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  if (Size != Private->ShadowFrameBufferSize) {
+    if (Private->ShadowFrameBuffer != NULL) {
+      FreePool (Private->ShadowFrameBuffer);
+    }
+    Private->ShadowFrameBuffer     = AllocatePool (Size);
+    Private->ShadowFrameBufferSize = (Private->ShadowFrameBuffer == NULL) ? 0 : Size;
+  }
+  if (Private->ShadowFrameBuffer == NULL) {
+    return;
+  }
+  ZeroMem (Private->ShadowFrameBuffer, Size);
+
+  CopyMem (&ShadowInfo, Info, sizeof (ShadowInfo));
+  ShadowInfo.PixelFormat       = PixelBlueGreenRedReserved8BitPerColor;
+  ShadowInfo.PixelsPerScanLine = Info->HorizontalResolution;
+  Status = QemuVideoBltConfigure (
+             Private->ShadowFrameBuffer,
+             &ShadowInfo,
+             &Private->ShadowBltConfigure,
+             &Private->ShadowBltConfigureSize
+             );
+  if (RETURN_ERROR (Status)) {
+    FreePool (Private->ShadowFrameBuffer);
+    Private->ShadowFrameBuffer     = NULL;
+    Private->ShadowFrameBufferSize = 0;
+  }
+}
+
 //
 // Graphics Output Protocol Member Functions
 //
@@ -187,35 +282,16 @@ Routine Description:
   //
   // Re-initialize the frame buffer configure when mode changes.
   //
-  Status = FrameBufferBltConfigure (
+  Status = QemuVideoBltConfigure (
              (VOID*) (UINTN) This->Mode->FrameBufferBase,
              This->Mode->Info,
-             Private->FrameBufferBltConfigure,
+             &Private->FrameBufferBltConfigure,
              &Private->FrameBufferBltConfigureSize
              );
-  if (Status == RETURN_BUFFER_TOO_SMALL) {
-    //
-    // Frame buffer configure may be larger in new mode.
-    //
-    if (Private->FrameBufferBltConfigure != NULL) {
-      FreePool (Private->FrameBufferBltConfigure);
-    }
-    Private->FrameBufferBltConfigure =
-      AllocatePool (Private->FrameBufferBltConfigureSize);
-    ASSERT (Private->FrameBufferBltConfigure != NULL);
-
-    //
-    // Create the configuration for FrameBufferBltLib
-    //
-    Status = FrameBufferBltConfigure (
-                (VOID*) (UINTN) This->Mode->FrameBufferBase,
-                This->Mode->Info,
-                Private->FrameBufferBltConfigure,
-                &Private->FrameBufferBltConfigureSize
-                );
-  }
   ASSERT (Status == RETURN_SUCCESS);
 
+  QemuVideoShadowConfigure (Private, This->Mode->Info);
+
   //
   // Per UEFI Spec, need to clear the visible portions of the output display to black.
   //
@@ -294,8 +370,29 @@ Returns:
   case EfiBltBufferToVideo:
   case EfiBltVideoFill:
   case EfiBltVideoToVideo:
+    if (Private->ShadowFrameBuffer == NULL) {
+      Status = FrameBufferBlt (
+        Private->FrameBufferBltConfigure,
+        BltBuffer,
+        BltOperation,
+        SourceX,
+        SourceY,
+        DestinationX,
+        DestinationY,
+        Width,
+        Height,
+        Delta
+        );
+      break;
+    }
+
+    //
+    // Every frame buffer access is expensive on the simulated device. Do the
+    // operation on the shadow, so that reads and scrolling stay in system
+    // memory, then write the destination rectangle to the device line by line.
+    //
     Status = FrameBufferBlt (
-      Private->FrameBufferBltConfigure,
+      Private->ShadowBltConfigure,
       BltBuffer,
       BltOperation,
       SourceX,
@@ -306,6 +403,20 @@ Returns:
       Height,
       Delta
       );
+    if (!EFI_ERROR (Status) && (BltOperation != EfiBltVideoToBltBuffer)) {
+      Status = FrameBufferBlt (
+        Private->FrameBufferBltConfigure,
+        Private->ShadowFrameBuffer,
+        EfiBltBufferToVideo,
+        DestinationX,
+        DestinationY,
+        DestinationX,
+        DestinationY,
+        Width,
+        Height,
+        This->Mode->Info->HorizontalResolution * sizeof (EFI_GRAPHICS_OUTPUT_BLT_PIXEL)
+        );
+    }
     break;
 
   default:
@@ -356,6 +467,10 @@ QemuVideoGraphicsOutputConstructor (
   Private->GraphicsOutput.Mode->Mode    = GRAPHICS_OUTPUT_INVALIDE_MODE_NUMBER;
   Private->FrameBufferBltConfigure      = NULL;
   Private->FrameBufferBltConfigureSize  = 0;
+  Private->ShadowFrameBuffer            = NULL;
+  Private->ShadowFrameBufferSize        = 0;
+  Private->ShadowBltConfigure           = NULL;
+  Private->ShadowBltConfigureSize       = 0;
 
   //
   // Initialize the hardware
@@ -403,6 +518,14 @@ Returns:
     FreePool (Private->FrameBufferBltConfigure);
   }
 
+  if (Private->ShadowBltConfigure != NULL) {
+    FreePool (Private->ShadowBltConfigure);
+  }
+
+  if (Private->ShadowFrameBuffer != NULL) {
+    FreePool (Private->ShadowFrameBuffer);
+  }
+
   if (Private->GraphicsOutput.Mode != NULL) {
     if (Private->GraphicsOutput.Mode->Info != NULL) {
       gBS->FreePool (Private->GraphicsOutput.Mode->Info);
@@ -116,6 +116,15 @@ typedef struct {
   QEMU_VIDEO_VARIANT                    Variant;
   FRAME_BUFFER_CONFIGURE                *FrameBufferBltConfigure;
   UINTN                                 FrameBufferBltConfigureSize;
+
+  //
+  // Copy of the visible frame buffer in system memory. Blt reads are served
+  // from it, and only the changed rectangle is written to the device.
+  //
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL         *ShadowFrameBuffer;
+  UINTN                                 ShadowFrameBufferSize;
+  FRAME_BUFFER_CONFIGURE                *ShadowBltConfigure;
+  UINTN                                 ShadowBltConfigureSize;
 } QEMU_VIDEO_PRIVATE_DATA;
 
 ///
@@ -150,7 +150,13 @@ SystemConfigExtractConfig (
   OUT EFI_STRING                             *Results
   )
 {
-  SetupInfo();
+  //
+  // The information strings are only shown by the setup forms. A NULL Request
+  // comes from ExportConfig, which does not need them, so skip the collection.
+  //
+  if (Request != NULL) {
+    SetupInfo();
+  }
   return EFI_UNSUPPORTED;
 }
 
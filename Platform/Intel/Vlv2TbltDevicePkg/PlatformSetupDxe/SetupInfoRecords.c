@@ -393,13 +393,11 @@ PrepareSetupInformation (
   )
 {
   EFI_STATUS                  Status;
-  CHAR16                      *NewString;
   STRING_REF                  TokenToUpdate;
   CHAR16                      Version[100];         //Assuming that strings are < 100 UCHAR
   CHAR16                      ReleaseDate[100];     //Assuming that strings are < 100 UCHAR
   CHAR16                      ReleaseTime[100];     //Assuming that strings are < 100 UCHAR
 
-  NewString = AllocateZeroPool (0x100);
   SetMem(Version, sizeof(Version), 0);
   SetMem(ReleaseDate, sizeof(ReleaseDate), 0);
   SetMem(ReleaseTime, sizeof(ReleaseTime), 0);
@@ -418,6 +416,9 @@ PrepareSetupInformation (
     Length = StrLen(ReleaseDate) + StrLen(ReleaseTime);
 
     BuildDateTime = AllocateZeroPool ((Length+2) * sizeof(CHAR16));
+    if (BuildDateTime == NULL) {
+      return;
+    }
     StrCpy (BuildDateTime, ReleaseDate);
     StrCat (BuildDateTime, L" ");
     StrCat (BuildDateTime, ReleaseTime);
@@ -429,9 +430,9 @@ PrepareSetupInformation (
     TokenToUpdate = (STRING_REF)STR_BIOS_BUILD_TIME_VALUE;
     DEBUG ((EFI_D_ERROR, "update STR_BIOS_BUILD_TIME_VALUE\n"));
     HiiSetString(mHiiHandle, TokenToUpdate, BuildDateTime, NULL);
-  }
 
-  gBS->FreePool(NewString);
+    FreePool (BuildDateTime);
+  }
 }
 
 /**
@@ -17,8 +17,11 @@ import os
 import re
 import sys
 import glob
+import json
+import time
 import signal
 import shutil
+import hashlib
 import argparse
 import traceback
 import subprocess
@@ -32,6 +35,10 @@ except ImportError:
     import configparser
 
 
+# Wall clock time of the build stages, for the timing report
+STAGE_TIMES = []
+
+
 def pre_build(build_config, build_type="DEBUG", silent=False, toolchain=None):
     """Sets the environment variables that shall be used for the build
 
@@ -332,6 +339,7 @@ def build(config):
     """
 
     if config["FSP_WRAPPER_BUILD"] == "TRUE":
+        start_time = time.time()
         pattern = "Fsp_Rebased.*\\.fd$"
         file_dir = os.path.join(config['WORKSPACE_FSP_BIN'],
                                 config['FSP_BIN_PKG'])
@@ -373,6 +381,7 @@ def build(config):
         if not os.path.isfile(os.path.join(file_dir, "Fsp_Rebased.fd")):
             print("!!! ERROR:failed to create fsp!!!")
             sys.exit(1)
+        record_stage_time("build.fsp_rebase", start_time)
 
     # Output the build variables the user has selected.
     print("==========================================")
@@ -420,12 +429,16 @@ def build(config):
     if os.name == "posix":
         shell = False
 
+    start_time = time.time()
     _, _, _, exit_code = execute_script(command, config, shell=shell)
+    record_stage_time("build.edk2", start_time)
     if exit_code != 0:
         build_failed(config)
 
     # Additional build scripts for this platform
+    start_time = time.time()
     result = build_ex(config)
+    record_stage_time("build.build_ex", start_time)
     if result is not None and isinstance(result, dict):
         config.update(result)
 
@@ -448,6 +461,7 @@ def post_build(config):
         # Generate the fit table
         print("Generating FIT ...")
         if os.path.isfile(final_fd):
+            start_time = time.time()
             temp_fd = os.path.join(config["BUILD_DIR_PATH"], "FV",
                                    "{}_.fd".format(board_fd))
             shell = True
@@ -458,7 +472,11 @@ def post_build(config):
             if os.name == "posix": # linux
                 shell = False
 
-            _, _, result, return_code = execute_script(command, config, shell=shell)
+            _, _, result, return_code = execute_cached_script(command, config,
+                                                              [final_fd],
+                                                              [temp_fd],
+                                                              shell=shell)
+            record_stage_time("post_build.fitgen", start_time)
             if return_code != 0:
                 print("Error while generating fit")
             else:
@@ -471,7 +489,9 @@ def post_build(config):
             # remove temp file
 
     # Additional build scripts for this platform
+    start_time = time.time()
     result = post_build_ex(config)
+    record_stage_time("post_build.post_build_ex", start_time)
     if result is not None and isinstance(result, dict):
         config.update(result)
 
@@ -503,6 +523,7 @@ def build_failed(config):
         :returns: nothing
     """
     print(" The EDKII BIOS Build has failed!")
+    write_timing_report(config)
     # clean up
     if config.get("DYNAMIC_BUILD_INIT_FILES") is not None:
         for item in config["DYNAMIC_BUILD_INIT_FILES"].split(","):
@@ -568,7 +589,9 @@ def build_ex(config):
             platform_function =\
                 import_platform_lib(config["ADDITIONAL_SCRIPTS"],
                                     "build_ex")
-            functions = {"execute_script": execute_script}
+            functions = {"execute_script": execute_script,
+                         "execute_cached_script": execute_cached_script,
+                         "record_stage_time": record_stage_time}
             return platform_function(config, functions)
         except ImportError as error:
             print("error", config["ADDITIONAL_SCRIPTS"], str(error))
@@ -591,7 +614,9 @@ def post_build_ex(config):
             platform_function =\
                 import_platform_lib(config["ADDITIONAL_SCRIPTS"],
                                     "post_build_ex")
-            functions = {"execute_script": execute_script}
+            functions = {"execute_script": execute_script,
+                         "execute_cached_script": execute_cached_script,
+                         "record_stage_time": record_stage_time}
             return platform_function(config, functions)
         except ImportError as error:
             print(config["ADDITIONAL_SCRIPTS"], str(error))
@@ -712,6 +737,86 @@ def execute_script(command, env_variables, collect_env=False,
     return (std_out, stderr, env, code)
 
 
+def execute_cached_script(command, env_variables, inputs, outputs,
+                          shell=True):
+    """launches a process like execute_script, unless the post build cache
+        has the outputs of the same command run on the same input files
+
+        :param command: The command/script with its commandline
+            arguments to be executed
+        :type command:  List:String
+        :param env_variables: Environment variables passed to the process
+        :type env_variables: String
+        :param inputs: The files read by the command
+        :type inputs: List:String
+        :param outputs: The files written by the command
+        :type outputs: List:String
+        :returns: a tuple of std_out, stderr , environment variables,
+            return code
+        :rtype: Tuple: (std_out, stderr , enVar, return_code)
+    """
+    if env_variables.get("POST_BUILD_CACHE", "FALSE") != "TRUE":
+        return execute_script(command, env_variables, shell=shell)
+
+    # the key is the command line and the content of the input files
+    command_line = command
+    if isinstance(command, list):
+        command_line = " ".join(command)
+    digest = hashlib.sha256()
+    digest.update(command_line.encode("utf-8"))
+    for item in inputs:
+        with open(item, 'rb') as input_file:
+            for chunk in iter(lambda: input_file.read(1024 * 1024), b''):
+                digest.update(chunk)
+
+    cache_dir = os.path.join(env_variables["BUILD_DIR_PATH"],
+                             "PostBuildCache", digest.hexdigest())
+    cached_outputs = [os.path.join(cache_dir, str(index))
+                      for index in range(len(outputs))]
+    if all(os.path.isfile(item) for item in cached_outputs):
+        print("Using cached outputs of " + command_line)
+        for cached, output in zip(cached_outputs, outputs):
+            shutil.copyfile(cached, output)
+        return ("", "", {}, 0)
+
+    result = execute_script(command, env_variables, shell=shell)
+    if result[3] == 0 and all(os.path.isfile(item) for item in outputs):
+        if not os.path.isdir(cache_dir):
+            os.makedirs(cache_dir)
+        for cached, output in zip(cached_outputs, outputs):
+            shutil.copyfile(output, cached)
+    return result
+
+
+def record_stage_time(stage, start_time):
+    """Records the wall clock time of a build stage for the timing report
+
+        :param stage: The name of the stage
+        :type stage: String
+        :param start_time: The time.time() value when the stage started
+        :type start_time: Float
+        :returns: nothing
+    """
+    STAGE_TIMES.append({"stage": stage,
+                        "seconds": round(time.time() - start_time, 3)})
+
+
+def write_timing_report(config):
+    """Writes the recorded stage times as JSON to the TIMING_REPORT file
+
+        :param config: The environment variables used in the build process
+        :type config: Dictionary
+        :returns: nothing
+    """
+    if not config.get("TIMING_REPORT"):
+        return
+    report = {"board": config.get("BOARD"),
+              "target": config.get("TARGET"),
+              "stages": STAGE_TIMES}
+    with open(config["TIMING_REPORT"], "w") as report_file:
+        json.dump(report, report_file, indent=2)
+
+
 def patch_config(config):
     """ An extension of the platform cleanning
 
@@ -943,6 +1048,12 @@ def get_cmd_config_arguments(arguments):
     else:
         result['BINARY_CACHE_CMD_LINE'] = ''
 
+    if arguments.PostBuildCache is True:
+        result["POST_BUILD_CACHE"] = "TRUE"
+
+    if arguments.TimingReport:
+        result["TIMING_REPORT"] = os.path.abspath(arguments.TimingReport)
+
     return result
 
 
@@ -1030,6 +1141,14 @@ def get_cmd_arguments(build_config):
                                 from the specified directory.",
                         action='store', dest="BinCacheSource")
 
+    parser.add_argument("--post-build-cache", help="Reuse the outputs of \
+                            post build tools run on unchanged inputs.",
+                        action='store_true', dest="PostBuildCache")
+
+    parser.add_argument("--timing-report", help="Write the time of each \
+                            build stage as JSON to the specified file.",
+                        action='store', dest="TimingReport")
+
     return parser.parse_args()
 
 
@@ -1079,16 +1198,24 @@ def main():
     config.update(cmd_config_args)
 
     # get pre_build configurations
+    start_time = time.time()
     config = pre_build(config,
                        build_type=arguments.target,
                        toolchain=arguments.toolchain,
                        silent=arguments.silent)
+    record_stage_time("pre_build", start_time)
 
     # build selected platform
+    start_time = time.time()
     config = build(config)
+    record_stage_time("build", start_time)
 
     # post build
+    start_time = time.time()
     post_build(config)
+    record_stage_time("post_build", start_time)
+
+    write_timing_report(config)
 
 
 if __name__ == "__main__":
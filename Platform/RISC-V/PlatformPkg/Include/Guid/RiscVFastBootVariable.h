@@ -0,0 +1,36 @@
+/** @file
+  Variable used by the RISC-V platform boot manager to boot fast.
+
+  On every boot which reaches ReadyToBoot, the platform boot manager records
+  the boot option it launches together with a fingerprint of the hardware.
+  When the fingerprint matches on the next boot, only the device path of
+  that boot option is connected instead of all the devices.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RISCV_FAST_BOOT_VARIABLE_H_
+#define RISCV_FAST_BOOT_VARIABLE_H_
+
+#define RISCV_FAST_BOOT_VARIABLE_GUID \
+  { \
+    0x4bac8e5a, 0x27d6, 0x4787, { 0xad, 0xa5, 0x50, 0x79, 0x52, 0xdf, 0xcd, 0x95 } \
+  }
+
+#define RISCV_FAST_BOOT_VARIABLE_NAME  L"RiscVFastBoot"
+
+typedef struct {
+  UINT32    Fingerprint;      ///< Hardware fingerprint of the boot which recorded the variable.
+  UINT16    BootOption;       ///< Number of the Boot#### option which was launched.
+  UINT16    Reserved;
+  ///
+  /// The device path of the boot option follows.
+  ///
+} RISCV_FAST_BOOT_VARIABLE;
+
+extern EFI_GUID gRiscVFastBootVariableGuid;
+
+#endif
@@ -0,0 +1,47 @@
+/** @file
+  Index of the FFS files of the boot firmware volume built by RISC-V SEC.
+
+  SEC scans the boot FV once and records the type, name and offset of every
+  file. The index is handed to PEI as a PPI with this GUID, and published by
+  the platform PEIM as a GUID HOB with the same GUID so later phases don't
+  need to rescan the volume.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RISCV_SEC_FFS_INDEX_H_
+#define RISCV_SEC_FFS_INDEX_H_
+
+#define RISCV_SEC_FFS_INDEX_GUID \
+  { \
+    0x6d775c35, 0xf5ae, 0x4610, { 0x95, 0x60, 0xda, 0xf8, 0x93, 0x63, 0xee, 0x4e } \
+  }
+
+#define RISCV_SEC_FFS_INDEX_MAX_ENTRIES  64
+
+typedef struct {
+  EFI_GUID                    Name;
+  UINT32                      FileOffset;      ///< Offset of the FFS file header from the FV base.
+  EFI_FV_FILETYPE             Type;
+  UINT8                       Reserved[3];
+} RISCV_SEC_FFS_INDEX_ENTRY;
+
+typedef struct {
+  EFI_PHYSICAL_ADDRESS        FvBase;
+  UINT64                      FvLength;
+  UINT32                      EntryCount;
+  ///
+  /// FALSE if the volume has more files than the index holds or the scan
+  /// stopped at a corrupted file. Lookups must rescan the volume then.
+  ///
+  BOOLEAN                     Complete;
+  UINT8                       Reserved[3];
+  RISCV_SEC_FFS_INDEX_ENTRY   Entries[RISCV_SEC_FFS_INDEX_MAX_ENTRIES];
+} RISCV_SEC_FFS_INDEX;
+
+extern EFI_GUID gRiscVSecFfsIndexGuid;
+
+#endif
@@ -0,0 +1,45 @@
+/** @file
+  Dense list of the harts enabled in the OpenSBI platform, built by RISC-V SEC.
+
+  SEC walks the harts of the OpenSBI platform once and records the hart ID
+  and the firmware context hart-specific data of every hart which has a
+  scratch space. The list is handed to PEI as a PPI with this GUID, and
+  published as a GUID HOB with the same GUID which only holds the used
+  entries.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RISCV_SEC_HART_LIST_H_
+#define RISCV_SEC_HART_LIST_H_
+
+#include <IndustryStandard/RiscVOpensbi.h>
+
+#define RISCV_SEC_HART_LIST_GUID \
+  { \
+    0xccf411f3, 0xea9c, 0x4b52, { 0x82, 0xf1, 0xdf, 0xbc, 0x3e, 0xd9, 0xbf, 0x5e } \
+  }
+
+typedef struct {
+  UINT64                                    HartId;
+  EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC  *HartSpecific;
+} RISCV_SEC_HART_LIST_ENTRY;
+
+typedef struct {
+  UINT32                      HartCount;
+  UINT32                      Reserved;
+  ///
+  /// Only the first HartCount entries are present in the HOB.
+  ///
+  RISCV_SEC_HART_LIST_ENTRY   Entries[RISC_V_MAX_HART_SUPPORTED];
+} RISCV_SEC_HART_LIST;
+
+#define RISCV_SEC_HART_LIST_SIZE(HartCount) \
+  (OFFSET_OF (RISCV_SEC_HART_LIST, Entries) + (HartCount) * sizeof (RISCV_SEC_HART_LIST_ENTRY))
+
+extern EFI_GUID gRiscVSecHartListGuid;
+
+#endif
@@ -0,0 +1,36 @@
+/** @file
+  Boot timestamps of the RISC-V SEC phase.
+
+  SEC records the performance counter when the boot hart enters SEC, around
+  the OpenSBI initialization of the boot hart and right before it jumps to
+  the PEI core. The timestamps are handed to PEI as a PPI with this GUID, the
+  platform PEIM turns them into performance records and the SEC performance
+  HOB consumed by the FPDT driver.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RISCV_SEC_PERFORMANCE_H_
+#define RISCV_SEC_PERFORMANCE_H_
+
+#define RISCV_SEC_PERFORMANCE_GUID \
+  { \
+    0x9ade456a, 0x619f, 0x43fe, { 0xb3, 0x57, 0xf2, 0x7f, 0xa8, 0xb0, 0x43, 0x5c } \
+  }
+
+///
+/// All values are GetPerformanceCounter () ticks, 0 if not recorded.
+///
+typedef struct {
+  UINT64    SecEntry;       ///< Boot hart entered SEC.
+  UINT64    SbiInitStart;   ///< Boot hart calls sbi_init.
+  UINT64    SbiInitEnd;     ///< OpenSBI returned to SEC in LaunchPeiCore.
+  UINT64    PeiCoreEntry;   ///< SEC jumps to the PEI core.
+} RISCV_SEC_PERFORMANCE;
+
+extern EFI_GUID gRiscVSecPerformanceGuid;
+
+#endif
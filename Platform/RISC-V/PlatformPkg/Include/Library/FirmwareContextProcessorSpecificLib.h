@@ -11,6 +11,7 @@
 
 #include <IndustryStandard/RiscVOpensbi.h>
 #include <PiPei.h>
+#include <Guid/RiscVSecHartList.h>
 #include <ProcessorSpecificHobData.h>
 
 /**
@@ -39,6 +40,47 @@ CommonFirmwareContextHartSpecificInfo (
   RISC_V_PROCESSOR_SPECIFIC_HOB_DATA *ProcessorSpecDataHob
   );
 
+/**
+  Get the list of harts SEC handed over to PEI.
+
+  The first call publishes the used part of the list as a GUID HOB, later
+  calls and later phases find the harts in that HOB.
+
+  @param  HartList     Pointer to receive the pointer to RISCV_SEC_HART_LIST.
+                       Only the first HartCount entries are valid.
+
+  @retval EFI_SUCCESS           The hart list is returned.
+  @retval EFI_INVALID_PARAMETER HartList is NULL.
+  @retval EFI_NOT_FOUND         SEC didn't hand over a hart list.
+  @retval EFI_OUT_OF_RESOURCES  The HOB couldn't be created.
+
+**/
+EFI_STATUS
+EFIAPI
+GetFirmwareContextHartList (
+  OUT RISCV_SEC_HART_LIST **HartList
+  );
+
+/**
+  Get the firmware context hart-specific data of a hart.
+
+  @param  HartId        Hart ID of the core.
+  @param  HartSpecific  Pointer to receive the pointer to
+                        EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC.
+
+  @retval EFI_SUCCESS           The hart-specific data is returned.
+  @retval EFI_INVALID_PARAMETER HartSpecific is NULL.
+  @retval EFI_UNSUPPORTED       The hart is not enabled in the platform.
+  @retval EFI_NOT_FOUND         The hart list is not available.
+
+**/
+EFI_STATUS
+EFIAPI
+GetFirmwareContextHartSpecific (
+  IN  UINTN                                    HartId,
+  OUT EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC **HartSpecific
+  );
+
 /**
   Print debug information of the processor specific data for a hart
 
@@ -15,9 +15,11 @@
 //
 // The Library classes this module consumes
 //
+#include <Guid/RiscVSecHartList.h>
 #include <IndustryStandard/RiscVOpensbi.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
+#include <Library/HobLib.h>
 #include <Library/PeiServicesLib.h>
 #include <ProcessorSpecificHobData.h>
 #include <RiscVImpl.h>
@@ -92,6 +94,98 @@ CommonFirmwareContextHartSpecificInfo (
   return EFI_SUCCESS;
 }
 
+/**
+  Get the list of harts SEC handed over to PEI.
+
+  The first call publishes the used part of the list as a GUID HOB, later
+  calls and later phases find the harts in that HOB.
+
+  @param  HartList     Pointer to receive the pointer to RISCV_SEC_HART_LIST.
+                       Only the first HartCount entries are valid.
+
+  @retval EFI_SUCCESS           The hart list is returned.
+  @retval EFI_INVALID_PARAMETER HartList is NULL.
+  @retval EFI_NOT_FOUND         SEC didn't hand over a hart list.
+  @retval EFI_OUT_OF_RESOURCES  The HOB couldn't be created.
+
+**/
+EFI_STATUS
+EFIAPI
+GetFirmwareContextHartList (
+  OUT RISCV_SEC_HART_LIST **HartList
+  )
+{
+  EFI_STATUS          Status;
+  EFI_HOB_GUID_TYPE   *GuidHob;
+  RISCV_SEC_HART_LIST *SecHartList;
+
+  if (HartList == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  GuidHob = GetFirstGuidHob (&gRiscVSecHartListGuid);
+  if (GuidHob != NULL) {
+    *HartList = (RISCV_SEC_HART_LIST *)GET_GUID_HOB_DATA (GuidHob);
+    return EFI_SUCCESS;
+  }
+
+  Status = PeiServicesLocatePpi (&gRiscVSecHartListGuid, 0, NULL, (VOID **) &SecHartList);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: SEC didn't hand over the hart list.\n", __FUNCTION__));
+    return EFI_NOT_FOUND;
+  }
+  *HartList = (RISCV_SEC_HART_LIST *)BuildGuidDataHob (
+                                       &gRiscVSecHartListGuid,
+                                       SecHartList,
+                                       RISCV_SEC_HART_LIST_SIZE (SecHartList->HartCount)
+                                       );
+  if (*HartList == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the firmware context hart-specific data of a hart.
+
+  @param  HartId        Hart ID of the core.
+  @param  HartSpecific  Pointer to receive the pointer to
+                        EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC.
+
+  @retval EFI_SUCCESS           The hart-specific data is returned.
+  @retval EFI_INVALID_PARAMETER HartSpecific is NULL.
+  @retval EFI_UNSUPPORTED       The hart is not enabled in the platform.
+  @retval EFI_NOT_FOUND         The hart list is not available.
+
+**/
+EFI_STATUS
+EFIAPI
+GetFirmwareContextHartSpecific (
+  IN  UINTN                                    HartId,
+  OUT EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC **HartSpecific
+  )
+{
+  EFI_STATUS          Status;
+  RISCV_SEC_HART_LIST *HartList;
+  UINT32              Index;
+
+  if (HartSpecific == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  Status = GetFirmwareContextHartList (&HartList);
+  if (EFI_ERROR (Status)) {
+    return EFI_NOT_FOUND;
+  }
+  for (Index = 0; Index < HartList->HartCount; Index++) {
+    if (HartList->Entries[Index].HartId == HartId) {
+      *HartSpecific = HartList->Entries[Index].HartSpecific;
+      return EFI_SUCCESS;
+    }
+  }
+  return EFI_UNSUPPORTED;
+}
+
 /**
   Print debug information of the processor specific data for a hart
 
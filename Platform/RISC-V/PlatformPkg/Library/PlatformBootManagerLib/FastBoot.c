@@ -0,0 +1,303 @@
+/** @file
+  Fast boot support of the platform boot manager.
+
+  The boot option launched by the last boot is recorded together with a
+  fingerprint of the hardware. As long as the fingerprint doesn't change, the
+  next boot only connects the device path of that boot option instead of all
+  the devices, and doesn't enumerate the boot options again.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "PlatformBootManager.h"
+
+STATIC BOOLEAN                   mFastBoot;
+STATIC UINT32                    mFingerprint;
+STATIC RISCV_FAST_BOOT_VARIABLE  *mFastBootVariable;
+STATIC UINTN                     mFastBootVariableSize;
+
+typedef struct {
+  UINT32    FirmwareRevision;
+  UINT32    FirmwareVendorCrc;
+  UINT32    DeviceTreeCrc;
+  UINT32    MemoryRangeCount;
+  UINT64    MemorySize;
+} FAST_BOOT_FINGERPRINT;
+
+/**
+  Return the CRC32 of a buffer, 0 if it can't be calculated.
+
+**/
+STATIC
+UINT32
+FastBootCrc32 (
+  IN  VOID   *Buffer,
+  IN  UINTN  Size
+  )
+{
+  UINT32  Crc;
+
+  if (EFI_ERROR (gBS->CalculateCrc32 (Buffer, Size, &Crc))) {
+    return 0;
+  }
+  return Crc;
+}
+
+/**
+  Calculate the fingerprint of the hardware and the firmware.
+
+  The fingerprint covers the firmware revision, the device tree passed by the
+  previous booting stage and the system memory ranges.
+
+  @return The fingerprint.
+
+**/
+STATIC
+UINT32
+FastBootFingerprint (
+  VOID
+  )
+{
+  FAST_BOOT_FINGERPRINT   Fingerprint;
+  EFI_PEI_HOB_POINTERS    Hob;
+  VOID                    *Fdt;
+
+  ZeroMem (&Fingerprint, sizeof (Fingerprint));
+  Fingerprint.FirmwareRevision = gST->FirmwareRevision;
+  if (gST->FirmwareVendor != NULL) {
+    Fingerprint.FirmwareVendorCrc = FastBootCrc32 (gST->FirmwareVendor, StrSize (gST->FirmwareVendor));
+  }
+
+  Hob.Raw = GetFirstGuidHob (&gFdtHobGuid);
+  if (Hob.Raw != NULL) {
+    Fdt = (VOID *)(UINTN)*(UINT64 *)GET_GUID_HOB_DATA (Hob.Guid);
+    if (fdt_check_header (Fdt) == 0) {
+      Fingerprint.DeviceTreeCrc = FastBootCrc32 (Fdt, fdt_totalsize (Fdt));
+    }
+  }
+
+  for (Hob.Raw = GetHobList ();
+       (Hob.Raw = GetNextHob (EFI_HOB_TYPE_RESOURCE_DESCRIPTOR, Hob.Raw)) != NULL;
+       Hob.Raw = GET_NEXT_HOB (Hob)) {
+    if (Hob.ResourceDescriptor->ResourceType == EFI_RESOURCE_SYSTEM_MEMORY) {
+      Fingerprint.MemoryRangeCount++;
+      Fingerprint.MemorySize += Hob.ResourceDescriptor->ResourceLength;
+    }
+  }
+
+  return FastBootCrc32 (&Fingerprint, sizeof (Fingerprint));
+}
+
+/**
+  Return the device path recorded in the fast boot variable.
+
+**/
+STATIC
+EFI_DEVICE_PATH_PROTOCOL *
+FastBootDevicePath (
+  VOID
+  )
+{
+  return (EFI_DEVICE_PATH_PROTOCOL *)(mFastBootVariable + 1);
+}
+
+/**
+  Record the boot option which is about to be launched.
+
+  The variable is only written when its content changes, so that booting the
+  same option over and over doesn't wear the flash.
+
+  @param[in] Event      The ReadyToBoot event.
+  @param[in] Context    Not used.
+
+**/
+STATIC
+VOID
+EFIAPI
+FastBootOnReadyToBoot (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_STATUS                    Status;
+  UINT16                        *BootCurrent;
+  CHAR16                        OptionName[sizeof ("Boot####")];
+  EFI_BOOT_MANAGER_LOAD_OPTION  Option;
+  RISCV_FAST_BOOT_VARIABLE      *Variable;
+  UINTN                         VariableSize;
+
+  Status = GetEfiGlobalVariable2 (EFI_BOOT_CURRENT_VARIABLE_NAME, (VOID **)&BootCurrent, NULL);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+  UnicodeSPrint (OptionName, sizeof (OptionName), L"Boot%04x", *BootCurrent);
+  FreePool (BootCurrent);
+  Status = EfiBootManagerVariableToLoadOption (OptionName, &Option);
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+
+  VariableSize = sizeof (*Variable) + GetDevicePathSize (Option.FilePath);
+  Variable = AllocatePool (VariableSize);
+  if (Variable != NULL) {
+    Variable->Fingerprint = mFingerprint;
+    Variable->BootOption  = (UINT16)Option.OptionNumber;
+    Variable->Reserved    = 0;
+    CopyMem (Variable + 1, Option.FilePath, VariableSize - sizeof (*Variable));
+
+    if (mFastBootVariable == NULL ||
+        mFastBootVariableSize != VariableSize ||
+        CompareMem (mFastBootVariable, Variable, VariableSize) != 0) {
+      Status = gRT->SetVariable (
+                      RISCV_FAST_BOOT_VARIABLE_NAME,
+                      &gRiscVFastBootVariableGuid,
+                      EFI_VARIABLE_NON_VOLATILE | EFI_VARIABLE_BOOTSERVICE_ACCESS,
+                      VariableSize,
+                      Variable
+                      );
+      DEBUG ((DEBUG_INFO, "%a: Record %s for fast boot: %r\n", __FUNCTION__, OptionName, Status));
+    }
+    FreePool (Variable);
+  }
+  EfiBootManagerFreeLoadOption (&Option);
+}
+
+/**
+  Decide whether this boot takes the fast boot path.
+
+  Fast boot is taken when the boot mode doesn't ask for a full configuration
+  and the fingerprint of the hardware matches the one recorded by the last
+  boot, together with a boot option which still exists. The ReadyToBoot
+  event which records the launched boot option is registered in any case.
+
+  @retval TRUE   Only the recorded boot option needs to be connected.
+  @retval FALSE  All the devices must be connected.
+
+**/
+BOOLEAN
+PlatformFastBootInitialize (
+  VOID
+  )
+{
+  EFI_STATUS                    Status;
+  EFI_EVENT                     Event;
+  EFI_BOOT_MODE                 BootMode;
+  CHAR16                        OptionName[sizeof ("Boot####")];
+  EFI_BOOT_MANAGER_LOAD_OPTION  Option;
+  EFI_DEVICE_PATH_PROTOCOL      *DevicePath;
+
+  if (!FeaturePcdGet (PcdRiscVFastBoot)) {
+    return FALSE;
+  }
+
+  mFingerprint = FastBootFingerprint ();
+  Status = EfiCreateEventReadyToBootEx (TPL_CALLBACK, FastBootOnReadyToBoot, NULL, &Event);
+  ASSERT_EFI_ERROR (Status);
+
+  BootMode = GetBootModeHob ();
+  if (BootMode == BOOT_WITH_DEFAULT_SETTINGS ||
+      BootMode == BOOT_WITH_FULL_CONFIGURATION_PLUS_DIAGNOSTICS ||
+      BootMode == BOOT_IN_RECOVERY_MODE) {
+    return FALSE;
+  }
+
+  Status = GetVariable2 (
+             RISCV_FAST_BOOT_VARIABLE_NAME,
+             &gRiscVFastBootVariableGuid,
+             (VOID **)&mFastBootVariable,
+             &mFastBootVariableSize
+             );
+  if (EFI_ERROR (Status)) {
+    mFastBootVariable = NULL;
+    return FALSE;
+  }
+  if (mFastBootVariableSize <= sizeof (*mFastBootVariable) ||
+      !IsDevicePathValid (FastBootDevicePath (), mFastBootVariableSize - sizeof (*mFastBootVariable))) {
+    DEBUG ((DEBUG_WARN, "%a: Invalid fast boot variable\n", __FUNCTION__));
+    PlatformFastBootInvalidate ();
+    return FALSE;
+  }
+  if (mFastBootVariable->Fingerprint != mFingerprint) {
+    DEBUG ((DEBUG_INFO, "%a: Hardware changed, full enumeration\n", __FUNCTION__));
+    return FALSE;
+  }
+
+  //
+  // The recorded boot option must still be there and point to the same
+  // device path, or the boot options were changed in the meantime.
+  //
+  DevicePath = FastBootDevicePath ();
+  UnicodeSPrint (OptionName, sizeof (OptionName), L"Boot%04x", mFastBootVariable->BootOption);
+  Status = EfiBootManagerVariableToLoadOption (OptionName, &Option);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+  mFastBoot = (GetDevicePathSize (Option.FilePath) == GetDevicePathSize (DevicePath)) &&
+              (CompareMem (Option.FilePath, DevicePath, GetDevicePathSize (DevicePath)) == 0);
+  EfiBootManagerFreeLoadOption (&Option);
+
+  DEBUG ((DEBUG_INFO, "%a: Fast boot %a with %s\n", __FUNCTION__, mFastBoot ? "enabled" : "disabled", OptionName));
+  return mFastBoot;
+}
+
+/**
+  Connect the device path of the boot option recorded by the last boot.
+
+  @retval TRUE   The device path was connected.
+  @retval FALSE  This is not a fast boot, or the device path couldn't be
+                 connected. All the devices must be connected then.
+
+**/
+BOOLEAN
+PlatformFastBootConnect (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  if (!mFastBoot) {
+    return FALSE;
+  }
+
+  Status = EfiBootManagerConnectDevicePath (FastBootDevicePath (), NULL);
+  if (EFI_ERROR (Status)) {
+    //
+    // Short-form device paths and removed devices end up here.
+    //
+    DEBUG ((DEBUG_INFO, "%a: Connect %s failed: %r\n", __FUNCTION__,
+      ConvertDevicePathToText (FastBootDevicePath (), FALSE, FALSE), Status));
+    mFastBoot = FALSE;
+  }
+  return mFastBoot;
+}
+
+/**
+  Forget the boot option recorded by the last boot, so that the next boot
+  connects all the devices.
+
+  @retval TRUE   This was a fast boot. The caller must connect all the
+                 devices and enumerate the boot options now.
+  @retval FALSE  All the devices have been connected already.
+
+**/
+BOOLEAN
+PlatformFastBootInvalidate (
+  VOID
+  )
+{
+  BOOLEAN  FastBoot;
+
+  if (mFastBootVariable != NULL) {
+    gRT->SetVariable (RISCV_FAST_BOOT_VARIABLE_NAME, &gRiscVFastBootVariableGuid, 0, 0, NULL);
+    FreePool (mFastBootVariable);
+    mFastBootVariable = NULL;
+    mFastBootVariableSize = 0;
+  }
+
+  FastBoot = mFastBoot;
+  mFastBoot = FALSE;
+  return FastBoot;
+}
@@ -154,6 +154,9 @@ PlatformBootManagerBeforeConsole (
   EFI_INPUT_KEY                Enter;
   EFI_INPUT_KEY                F2;
   EFI_BOOT_MANAGER_LOAD_OPTION BootOption;
+  BOOLEAN                      FastBoot;
+
+  FastBoot = PlatformFastBootInitialize ();
 
   //
   // Update the console variables.
@@ -190,9 +193,12 @@ PlatformBootManagerBeforeConsole (
   EfiBootManagerGetBootManagerMenu (&BootOption);
   EfiBootManagerAddKeyOptionVariable (NULL, (UINT16) BootOption.OptionNumber, 0, &F2, NULL);
   //
-  // Register UEFI Shell
+  // Register UEFI Shell, the boot options didn't change since the last boot
+  // on a fast boot.
   //
-  PlatformRegisterFvBootOption (&mUefiShellFileGuid, L"UEFI Shell", LOAD_OPTION_ACTIVE);
+  if (!FastBoot) {
+    PlatformRegisterFvBootOption (&mUefiShellFileGuid, L"UEFI Shell", LOAD_OPTION_ACTIVE);
+  }
 }
 
 /**
@@ -217,8 +223,14 @@ PlatformBootManagerAfterConsole (
   Black.Blue = Black.Green = Black.Red = Black.Reserved = 0;
   White.Blue = White.Green = White.Red = White.Reserved = 0xFF;
 
-  EfiBootManagerConnectAll ();
-  EfiBootManagerRefreshAllBootOption ();
+  //
+  // On a fast boot only the boot option launched by the last boot is
+  // connected, and the boot options are not enumerated again.
+  //
+  if (!PlatformFastBootConnect ()) {
+    EfiBootManagerConnectAll ();
+    EfiBootManagerRefreshAllBootOption ();
+  }
 
   PlatformBootManagerDiagnostics (QUICK, TRUE);
 
@@ -239,5 +251,12 @@ PlatformBootManagerUnableToBoot (
   VOID
   )
 {
-  return;
+  //
+  // The fast boot option failed to boot, enumerate all the devices for the
+  // boot manager menu and don't take the fast path next time.
+  //
+  if (PlatformFastBootInvalidate ()) {
+    EfiBootManagerConnectAll ();
+    EfiBootManagerRefreshAllBootOption ();
+  }
 }
@@ -18,6 +18,9 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Protocol/GraphicsOutput.h>
 #include <Protocol/BootLogo.h>
 #include <Protocol/DevicePath.h>
+#include <Guid/FdtHob.h>
+#include <Guid/GlobalVariable.h>
+#include <Guid/RiscVFastBootVariable.h>
 
 #include <Library/DebugLib.h>
 #include <Library/BaseMemoryLib.h>
@@ -31,6 +34,8 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DevicePathLib.h>
 #include <Library/HiiLib.h>
 #include <Library/PrintLib.h>
+#include <Library/HobLib.h>
+#include <libfdt.h>
 
 typedef struct {
   EFI_DEVICE_PATH_PROTOCOL  *DevicePath;
@@ -114,4 +119,41 @@ PlatformBootManagerShowProgress (
   IN UINTN                         PreviousValue
   );
 
+/**
+  Decide whether this boot takes the fast boot path.
+
+  @retval TRUE   Only the boot option launched by the last boot needs to be
+                 connected.
+  @retval FALSE  All the devices must be connected.
+
+**/
+BOOLEAN
+PlatformFastBootInitialize (
+  VOID
+  );
+
+/**
+  Connect the device path of the boot option launched by the last boot.
+
+  @retval TRUE   The device path was connected.
+  @retval FALSE  All the devices must be connected.
+
+**/
+BOOLEAN
+PlatformFastBootConnect (
+  VOID
+  );
+
+/**
+  Forget the boot option launched by the last boot.
+
+  @retval TRUE   This was a fast boot, all the devices must be connected now.
+  @retval FALSE  All the devices have been connected already.
+
+**/
+BOOLEAN
+PlatformFastBootInvalidate (
+  VOID
+  );
+
 #endif // _PLATFORM_BOOT_MANAGER_H
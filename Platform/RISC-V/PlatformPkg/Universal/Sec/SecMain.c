@@ -23,10 +23,15 @@
 #include <sbi/sbi_ecall.h>    // Reference to header file in opensbi
 
 //
-// Indicates the boot hart (PcdBootHartId) OpenSBI initialization is done.
+// Hart ID indexed mailboxes. A non-boot hart parks in WFI until the boot hart
+// (PcdBootHartId) finishes OpenSBI initialization, marks the mailbox ready
+// and sends an IPI. Non-boot harts then run sbi_init concurrently.
 //
-atomic_t BootHartDone = ATOMIC_INITIALIZER(0);
-atomic_t NonBootHartMessageLock = ATOMIC_INITIALIZER(0);
+SEC_HART_MAILBOX mHartMailbox[SBI_HARTMASK_MAX_BITS]
+  __attribute__((aligned (SEC_HART_MAILBOX_CACHE_LINE_SIZE))) = {{ ATOMIC_INITIALIZER (SEC_HART_MAILBOX_EMPTY) }};
+
+STATIC_ASSERT (sizeof (SEC_HART_MAILBOX) == SEC_HART_MAILBOX_CACHE_LINE_SIZE,
+  "SEC_HART_MAILBOX must occupy exactly one cache line");
 
 typedef struct sbi_scratch *(*hartid2scratch)(ulong hartid, ulong hartindex);
 
@@ -38,6 +43,23 @@ STATIC EFI_PEI_TEMPORARY_RAM_DONE_PPI mTemporaryRamDonePpi = {
   TemporaryRamDone
 };
 
+//
+// Index of the files in the boot FV, built in one pass the first time a
+// file is looked up and handed over to PEI.
+//
+STATIC RISCV_SEC_FFS_INDEX mFfsIndex;
+
+//
+// Harts enabled in the OpenSBI platform, built once by the boot hart before
+// the other harts are released and handed over to PEI.
+//
+STATIC RISCV_SEC_HART_LIST mHartList;
+
+//
+// Boot timestamps of the boot hart, turned into performance records in PEI.
+//
+STATIC RISCV_SEC_PERFORMANCE mSecPerformance;
+
 STATIC EFI_PEI_PPI_DESCRIPTOR mPrivateDispatchTable[] = {
   {
     EFI_PEI_PPI_DESCRIPTOR_PPI,
@@ -45,10 +67,25 @@ STATIC EFI_PEI_PPI_DESCRIPTOR mPrivateDispatchTable[] = {
     &mTemporaryRamSupportPpi
   },
   {
-    (EFI_PEI_PPI_DESCRIPTOR_PPI | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST),
+    EFI_PEI_PPI_DESCRIPTOR_PPI,
     &gEfiTemporaryRamDonePpiGuid,
     &mTemporaryRamDonePpi
   },
+  {
+    EFI_PEI_PPI_DESCRIPTOR_PPI,
+    &gRiscVSecFfsIndexGuid,
+    &mFfsIndex
+  },
+  {
+    EFI_PEI_PPI_DESCRIPTOR_PPI,
+    &gRiscVSecHartListGuid,
+    &mHartList
+  },
+  {
+    (EFI_PEI_PPI_DESCRIPTOR_PPI | EFI_PEI_PPI_DESCRIPTOR_TERMINATE_LIST),
+    &gRiscVSecPerformanceGuid,
+    &mSecPerformance
+  },
 };
 
 /**
@@ -157,6 +194,124 @@ FindFfsSectionInSections (
            );
 }
 
+/**
+  Build the index of the FFS files in a firmware volume.
+
+  The walk stops at the first free space or corrupted file header. The
+  index is marked complete only if all the files up to the free space or
+  the end of the volume fit in it.
+
+  @param[in]   Fv            The firmware volume to index
+
+**/
+VOID
+BuildFfsIndex (
+  IN  EFI_FIRMWARE_VOLUME_HEADER       *Fv
+  )
+{
+  EFI_PHYSICAL_ADDRESS        CurrentAddress;
+  EFI_PHYSICAL_ADDRESS        EndOfFirmwareVolume;
+  EFI_FFS_FILE_HEADER         *File;
+  UINT32                      Size;
+  EFI_PHYSICAL_ADDRESS        EndOfFile;
+  RISCV_SEC_FFS_INDEX_ENTRY   *Entry;
+
+  ZeroMem (&mFfsIndex, sizeof (mFfsIndex));
+  if (Fv->Signature != EFI_FVH_SIGNATURE) {
+    return;
+  }
+
+  mFfsIndex.FvBase = (EFI_PHYSICAL_ADDRESS)(UINTN) Fv;
+  mFfsIndex.FvLength = Fv->FvLength;
+  EndOfFirmwareVolume = mFfsIndex.FvBase + Fv->FvLength;
+
+  for (EndOfFile = mFfsIndex.FvBase + Fv->HeaderLength; ; ) {
+    CurrentAddress = (EndOfFile + 7) & ~(7ULL);
+    if (CurrentAddress + sizeof (*File) > EndOfFirmwareVolume) {
+      break;
+    }
+
+    File = (EFI_FFS_FILE_HEADER*)(UINTN) CurrentAddress;
+    Size = *(UINT32*) File->Size & 0xffffff;
+    if (Size == 0xffffff) {
+      //
+      // Free space, no more files.
+      //
+      break;
+    }
+    if (Size < (sizeof (*File) + sizeof (EFI_COMMON_SECTION_HEADER))) {
+      return;
+    }
+
+    EndOfFile = CurrentAddress + Size;
+    if (EndOfFile > EndOfFirmwareVolume) {
+      return;
+    }
+
+    if (File->Type == EFI_FV_FILETYPE_FFS_PAD) {
+      continue;
+    }
+
+    if (mFfsIndex.EntryCount == RISCV_SEC_FFS_INDEX_MAX_ENTRIES) {
+      return;
+    }
+    Entry = &mFfsIndex.Entries[mFfsIndex.EntryCount++];
+    CopyGuid (&Entry->Name, &File->Name);
+    Entry->FileOffset = (UINT32)(CurrentAddress - mFfsIndex.FvBase);
+    Entry->Type = File->Type;
+  }
+
+  mFfsIndex.Complete = TRUE;
+  DEBUG ((DEBUG_INFO, "%a: Indexed %d files in FV at %p\n", __FUNCTION__, mFfsIndex.EntryCount, Fv));
+}
+
+/**
+  Locates a FFS file with the specified file type and a section
+  within that file with the specified section type, using the
+  index of the firmware volume.
+
+  @param[in]   Fv            The firmware volume to search
+  @param[in]   FileType      The file type to locate
+  @param[in]   SectionType   The section type to locate
+  @param[out]  FoundSection  The FFS section if found
+
+  @retval EFI_SUCCESS           The file and section was found
+  @retval EFI_NOT_FOUND         The file and section was not found
+  @retval EFI_VOLUME_CORRUPTED  The firmware volume was corrupted
+
+**/
+EFI_STATUS
+FindFfsFileAndSectionInIndex (
+  IN  EFI_FIRMWARE_VOLUME_HEADER       *Fv,
+  IN  EFI_FV_FILETYPE                  FileType,
+  IN  EFI_SECTION_TYPE                 SectionType,
+  OUT EFI_COMMON_SECTION_HEADER        **FoundSection
+  )
+{
+  EFI_STATUS                  Status;
+  EFI_FFS_FILE_HEADER         *File;
+  UINTN                       Index;
+
+  for (Index = 0; Index < mFfsIndex.EntryCount; Index++) {
+    if (mFfsIndex.Entries[Index].Type != FileType) {
+      continue;
+    }
+
+    File = (EFI_FFS_FILE_HEADER*)(UINTN)(mFfsIndex.FvBase + mFfsIndex.Entries[Index].FileOffset);
+    Status = FindFfsSectionInSections (
+               (VOID*) (File + 1),
+               (*(UINT32*) File->Size & 0xffffff) - sizeof (*File),
+               SectionType,
+               FoundSection
+               );
+    if (!EFI_ERROR (Status) || (Status == EFI_VOLUME_CORRUPTED)) {
+      return Status;
+    }
+  }
+
+  return EFI_NOT_FOUND;
+}
+
 /**
   Locates a FFS file with the specified file type and a section
   within that file with the specified section type.
@@ -191,6 +346,10 @@ FindFfsFileAndSection (
     return EFI_VOLUME_CORRUPTED;
   }
 
+  if (mFfsIndex.Complete && (mFfsIndex.FvBase == (EFI_PHYSICAL_ADDRESS)(UINTN) Fv)) {
+    return FindFfsFileAndSectionInIndex (Fv, FileType, SectionType, FoundSection);
+  }
+
   CurrentAddress = (EFI_PHYSICAL_ADDRESS)(UINTN) Fv;
   EndOfFirmwareVolume = CurrentAddress + Fv->FvLength;
 
@@ -297,6 +456,7 @@ FindPeiCoreImageBase (
   *PeiCoreImageBase = 0;
 
   DEBUG ((DEBUG_INFO, "%a: Entry\n", __FUNCTION__));
+  BuildFfsIndex (*BootFv);
   FindPeiCoreImageBaseInFv (*BootFv, PeiCoreImageBase);
 }
 
@@ -340,13 +500,43 @@ DebutPrintFirmwareContext (
     )
 {
   DEBUG ((DEBUG_INFO, "%a: OpenSBI Firmware Context at 0x%x\n", __FUNCTION__, FirmwareContext));
-  DEBUG ((DEBUG_INFO, "%a:              PEI Service at 0x%x\n\n", __FUNCTION__, FirmwareContext->PeiServiceTable));
+  DEBUG ((DEBUG_INFO, "%a:              PEI Service at 0x%x\n", __FUNCTION__, FirmwareContext->PeiServiceTable));
+  DEBUG ((DEBUG_INFO, "%a:              Device tree at 0x%lx\n\n", __FUNCTION__, FirmwareContext->FlattenedDeviceTree));
 }
+/**
+  Copy a range of temporary RAM to permanent memory.
+
+  Nothing is copied when the range doesn't move, which happens when the
+  temporary RAM already is the permanent memory.
+
+  @param[in]  Start     First byte of the range.
+  @param[in]  End       End of the range.
+  @param[in]  Offset    Distance between the range and its copy.
+
+**/
+STATIC
+VOID
+MigrateRange (
+  IN UINTN    Start,
+  IN UINTN    End,
+  IN UINTN    Offset
+  )
+{
+  if (Offset == 0 || Start >= End) {
+    return;
+  }
+  CopyMem ((VOID *)(Start + Offset), (VOID *)Start, End - Start);
+}
+
 /** Temporary RAM migration function.
 
   This function migrates the data from temporary RAM to permanent
   memory.
 
+  The PEI core chooses where the heap and stack go, so only the parts in
+  use are copied: the HOBs and the pages allocated from the heap, and the
+  stack above the current stack pointer.
+
   @param[in]  PeiServices           PEI service
   @param[in]  TemporaryMemoryBase   Temporary memory base address
   @param[in]  PermanentMemoryBase   Permanent memory base address
@@ -366,6 +556,15 @@ TemporaryRamMigration (
   VOID      *NewHeap;
   VOID      *OldStack;
   VOID      *NewStack;
+  UINTN     HeapEnd;
+  UINTN     StackEnd;
+  UINTN     StackPointer;
+  UINTN     HeapOffset;
+  UINTN     StackOffset;
+  UINTN     HeapUsedEnd;
+  UINTN     HeapPagesStart;
+  UINTN     HeapPagesEnd;
+  EFI_HOB_HANDOFF_INFO_TABLE         *HandOff;
   EFI_RISCV_OPENSBI_FIRMWARE_CONTEXT *FirmwareContext;
 
   DEBUG ((DEBUG_INFO,
@@ -382,8 +581,59 @@ TemporaryRamMigration (
   OldStack = (VOID*)((UINTN)TemporaryMemoryBase + (CopySize >> 1));
   NewStack = (VOID*)(UINTN)PermanentMemoryBase;
 
-  CopyMem (NewHeap, OldHeap, CopySize >> 1);   // Migrate Heap
-  CopyMem (NewStack, OldStack, CopySize >> 1); // Migrate Stack
+  HeapEnd = (UINTN)OldHeap + (CopySize >> 1);
+  StackEnd = (UINTN)OldStack + (CopySize >> 1);
+  HeapOffset = (UINTN)NewHeap - (UINTN)OldHeap;
+  StackOffset = (UINTN)NewStack - (UINTN)OldStack;
+
+  //
+  // The HOBs grow up from the bottom of the heap and the pages are
+  // allocated down from its top.
+  //
+  HandOff = NULL;
+  (*PeiServices)->GetHobList (PeiServices, (VOID **)&HandOff);
+  if (HandOff != NULL &&
+      HandOff->EfiMemoryBottom == (UINTN)OldHeap &&
+      HandOff->EfiMemoryTop <= HeapEnd &&
+      HandOff->EfiFreeMemoryBottom <= HandOff->EfiFreeMemoryTop) {
+    HeapUsedEnd = (UINTN)HandOff->EfiFreeMemoryBottom;
+    HeapPagesStart = (UINTN)HandOff->EfiFreeMemoryTop;
+    HeapPagesEnd = (UINTN)HandOff->EfiMemoryTop;
+  } else {
+    HeapUsedEnd = HeapEnd;
+    HeapPagesStart = HeapEnd;
+    HeapPagesEnd = HeapEnd;
+  }
+
+  //
+  // The stack grows down, everything live is above the stack pointer of
+  // this function.
+  //
+  asm volatile ("mv %0, sp" : "=r" (StackPointer));
+  if (StackPointer < (UINTN)OldStack || StackPointer >= StackEnd) {
+    StackPointer = (UINTN)OldStack;
+  }
+
+  //
+  // When the temporary RAM is in the permanent memory, the new heap may
+  // overlap the old stack. Move the stack out of its way first then.
+  //
+  if ((UINTN)NewHeap < StackEnd && StackPointer < (UINTN)NewHeap + (CopySize >> 1)) {
+    ASSERT ((UINTN)NewStack + (CopySize >> 1) <= (UINTN)OldHeap || (UINTN)NewStack >= HeapEnd);
+    MigrateRange (StackPointer, StackEnd, StackOffset);               // Migrate Stack
+    MigrateRange ((UINTN)OldHeap, HeapUsedEnd, HeapOffset);           // Migrate Heap
+    MigrateRange (HeapPagesStart, HeapPagesEnd, HeapOffset);
+  } else {
+    MigrateRange ((UINTN)OldHeap, HeapUsedEnd, HeapOffset);           // Migrate Heap
+    MigrateRange (HeapPagesStart, HeapPagesEnd, HeapOffset);
+    MigrateRange (StackPointer, StackEnd, StackOffset);               // Migrate Stack
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: Migrated 0x%Lx bytes of heap and 0x%Lx bytes of stack\n",
+    __FUNCTION__,
+    (UINT64)((HeapUsedEnd - (UINTN)OldHeap) + (HeapPagesEnd - HeapPagesStart)),
+    (UINT64)(StackEnd - StackPointer)
+    ));
 
   //
   // Reset firmware context pointer
@@ -490,6 +740,104 @@ RegisterFirmwareSbiExtension (
 
   return EFI_SUCCESS;
 }
+/**
+  Build the list of harts enabled in the OpenSBI platform.
+
+  Only the harts of the platform are visited, through its hart index to hart
+  ID table, rather than every possible hart ID of the hartmask. A hart is
+  recorded with its firmware context hart-specific data, which sits right
+  below its OpenSBI scratch space.
+
+**/
+VOID
+SecBuildHartList (
+  VOID
+  )
+{
+  CONST struct sbi_platform *ThisSbiPlatform;
+  struct sbi_scratch        *ScratchSpace;
+  RISCV_SEC_HART_LIST_ENTRY *Entry;
+  UINT32                     HartIndex;
+  UINT32                     HartId;
+
+  ThisSbiPlatform = sbi_platform_thishart_ptr ();
+  ZeroMem (&mHartList, sizeof (mHartList));
+  for (HartIndex = 0;
+       HartIndex < ThisSbiPlatform->hart_count && mHartList.HartCount < RISC_V_MAX_HART_SUPPORTED;
+       HartIndex ++) {
+    HartId = (ThisSbiPlatform->hart_index2id != NULL) ?
+               ThisSbiPlatform->hart_index2id[HartIndex] : HartIndex;
+    if (HartId >= SBI_HARTMASK_MAX_BITS) {
+      continue;
+    }
+    ScratchSpace = sbi_hartid_to_scratch (HartId);
+    if (ScratchSpace == NULL) {
+      continue;
+    }
+    Entry = &mHartList.Entries[mHartList.HartCount++];
+    Entry->HartId = HartId;
+    Entry->HartSpecific =
+      (EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC *)((UINT8 *)ScratchSpace - FIRMWARE_CONTEXT_HART_SPECIFIC_SIZE);
+  }
+}
+
+/**
+  Release all non-boot harts parked in SecCoreStartUpWithStack.
+
+  The mailbox of each hart known to OpenSBI is marked ready and an IPI is
+  sent to wake the hart from WFI. A hart which has not reached its WFI loop
+  yet observes the ready state before sleeping, and a pending IPI makes a
+  subsequent WFI return immediately, so no wakeup is lost.
+
+  @param[in]  ThisHartId     Hardware thread ID of boot hart.
+
+**/
+VOID
+SecReleaseNonBootHarts (
+  IN  UINTN  ThisHartId
+  )
+{
+  CONST struct sbi_platform *ThisSbiPlatform;
+  UINT32                     Index;
+  UINT32                     HartId;
+
+  ThisSbiPlatform = sbi_platform_thishart_ptr ();
+  for (Index = 0; Index < mHartList.HartCount; Index ++) {
+    HartId = (UINT32)mHartList.Entries[Index].HartId;
+    if (HartId == ThisHartId) {
+      continue;
+    }
+    atomic_xchg (&mHartMailbox[HartId].State, SEC_HART_MAILBOX_READY);
+    sbi_platform_ipi_send (ThisSbiPlatform, HartId);
+  }
+}
+
+/**
+  Print the log messages posted by non-boot harts to their mailbox.
+
+  Non-boot harts never touch the console directly in SEC, the boot hart
+  prints their buffered messages instead. Harts which have not posted their
+  message yet are skipped.
+
+**/
+VOID
+SecFlushNonBootHartLogs (
+  VOID
+  )
+{
+  UINT32  Index;
+  UINT32  HartId;
+
+  for (Index = 0; Index < mHartList.HartCount; Index ++) {
+    HartId = (UINT32)mHartList.Entries[Index].HartId;
+    if (atomic_cmpxchg (&mHartMailbox[HartId].State,
+          SEC_HART_MAILBOX_LOGGED,
+          SEC_HART_MAILBOX_FLUSHED) == SEC_HART_MAILBOX_LOGGED) {
+      DEBUG ((DEBUG_INFO, "%a", mHartMailbox[HartId].Log));
+    }
+  }
+}
+
 /** Transion from SEC phase to PEI phase.
 
   This function transits to S-mode PEI phase from M-mode SEC phase.
@@ -509,7 +857,14 @@ VOID EFIAPI PeiCore (
   EFI_RISCV_OPENSBI_FIRMWARE_CONTEXT FirmwareContext;
   struct sbi_scratch         *ScratchSpace;
   struct sbi_platform        *ThisSbiPlatform;
-  UINT32 HartId;
+  UINT32 Index;
+
+  //
+  // tp still points to the M-mode scratch space of OpenSBI. Clear it, tp is
+  // the hart-local data pointer from here on and stays 0 until DXE sets up
+  // the hart-local data of the boot hart.
+  //
+  RiscVSetThreadPointer (0);
 
   FindAndReportEntryPoints (&BootFv, &PeiCoreEntryPoint);
 
@@ -523,17 +878,6 @@ VOID EFIAPI PeiCore (
   SecCoreData.StackBase              = (UINT8 *)SecCoreData.TemporaryRamBase + (SecCoreData.TemporaryRamSize >> 1);
   SecCoreData.StackSize              = SecCoreData.TemporaryRamSize >> 1;
 
-  //
-  // Print out scratch address of each hart
-  //
-  DEBUG ((DEBUG_INFO, "%a: OpenSBI scratch address for each hart:\n", __FUNCTION__));
-  for (HartId = 0; HartId < SBI_HARTMASK_MAX_BITS; HartId ++) {
-    SbiGetMscratchHartid (HartId, &ScratchSpace);
-    if(ScratchSpace != NULL) {
-      DEBUG((DEBUG_INFO, "          Hart %d: 0x%x\n", HartId, ScratchSpace));
-    }
-  }
-
   //
   // Set up OpepSBI firmware context pointer on boot hart OpenSbi scratch.
   // Firmware context residents in stack and will be switched to memory when
@@ -557,21 +901,23 @@ VOID EFIAPI PeiCore (
              &FirmwareContext
              ));
   ThisSbiPlatform->firmware_context = (unsigned long)&FirmwareContext;
+  FirmwareContext.FlattenedDeviceTree = (UINT64)fw_prev_arg1 ();
+  DEBUG ((DEBUG_INFO, "%a: Device tree from the previous booting stage at 0x%lx\n",
+          __FUNCTION__,
+          FirmwareContext.FlattenedDeviceTree
+          ));
   //
-  // Set firmware context Hart-specific pointer
-  //
-  for (HartId = 0; HartId < SBI_HARTMASK_MAX_BITS; HartId ++) {
-    SbiGetMscratchHartid (HartId, &ScratchSpace);
-    if (ScratchSpace != NULL) {
-      FirmwareContext.HartSpecific[HartId] =
-        (EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC *)((UINT8 *)ScratchSpace - FIRMWARE_CONTEXT_HART_SPECIFIC_SIZE);
-        DEBUG ((DEBUG_INFO, "%a: OpenSBI Hart %d Firmware Context Hart-specific at address: 0x%x\n",
-                __FUNCTION__,
-                 HartId,
-                 FirmwareContext.HartSpecific [HartId]
-                 ));
-    }
+  // Print out the harts SEC handed to PEI
+  //
+  for (Index = 0; Index < mHartList.HartCount; Index ++) {
+    DEBUG ((DEBUG_INFO, "%a: OpenSBI Hart %ld Firmware Context Hart-specific at address: 0x%x\n",
+            __FUNCTION__,
+            mHartList.Entries[Index].HartId,
+            mHartList.Entries[Index].HartSpecific
+            ));
   }
+  SecFlushNonBootHartLogs ();
+
   //
   // Set supervisor translation mode to Bare mode
   //
@@ -581,6 +927,7 @@ VOID EFIAPI PeiCore (
   //
   // Transfer the control to the PEI core
   //
+  mSecPerformance.PeiCoreEntry = GetPerformanceCounter ();
   (*PeiCoreEntryPoint) (&SecCoreData, (EFI_PEI_PPI_DESCRIPTOR *)&mPrivateDispatchTable);
 }
 
@@ -604,9 +951,20 @@ LaunchPeiCore (
 {
   UINT32 PeiCoreMode;
 
+  mSecPerformance.SbiInitEnd = GetPerformanceCounter ();
   DEBUG ((DEBUG_INFO, "%a: Set boot hart done.\n", __FUNCTION__));
-  atomic_write (&BootHartDone, (UINT64)TRUE);
+
+  //
+  // sbi_init leaves the vector unit off. Turn it on for the boot hart so
+  // that BaseMemoryLibOptRvv can use it in PEI and DXE, mstatus.VS is kept
+  // across the switch to S-mode.
+  //
+  if ((RiscVReadMachineIsa () & RISC_V_ISA_VECTOR_EXTENSION) != 0) {
+    csr_set (CSR_MSTATUS, SSTATUS_VS_INITIAL);
+  }
   RegisterFirmwareSbiExtension ();
+  SecBuildHartList ();
+  SecReleaseNonBootHarts (ThisHartId);
 
   PeiCoreMode = FixedPcdGet32 (PcdPeiCorePrivilegeMode);
   if (PeiCoreMode == PRV_S) {
@@ -682,9 +1040,11 @@ VOID EFIAPI SecCoreStartUpWithStack(
   IN  struct sbi_scratch *Scratch
   )
 {
-  UINT64 BootHartDoneSbiInit;
-  UINT64 NonBootHartMessageLockValue;
+  SEC_HART_MAILBOX *Mailbox;
   EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC *HartFirmwareContext;
+  UINT64 SecEntry;
+
+  SecEntry = GetPerformanceCounter ();
 
   //
   // Setup EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC for each hart.
@@ -702,33 +1062,39 @@ VOID EFIAPI SecCoreStartUpWithStack(
   if (HartId == FixedPcdGet32(PcdBootHartId)) {
     Scratch->next_addr = (UINTN)LaunchPeiCore;
     Scratch->next_mode = PRV_M;
+    mSecPerformance.SecEntry = SecEntry;
     DEBUG ((DEBUG_INFO, "%a: Initializing OpenSBI library for booting hart %d\n", __FUNCTION__, HartId));
+    mSecPerformance.SbiInitStart = GetPerformanceCounter ();
     sbi_init(Scratch);
   }
 
   //
-  // Initialize the non boot harts
+  // Park the non boot harts in WFI until the boot hart releases them. MSIE
+  // is enabled before checking the mailbox so that an IPI sent in between
+  // keeps MSIP pending and wakes the following WFI.
   //
-  do {
-    BootHartDoneSbiInit = atomic_read (&BootHartDone);
-    //
-    // Below leave some memory cycles to boot hart
-    // for updating BootHartDone.
-    //
-    CpuPause ();
-    CpuPause ();
-    CpuPause ();
-  } while (BootHartDoneSbiInit != (UINT64)TRUE);
-
-  NonBootHartMessageLockValue = atomic_xchg(&NonBootHartMessageLock, TRUE);
-  while (NonBootHartMessageLockValue == TRUE) {
-    CpuPause ();
-    CpuPause ();
-    CpuPause ();
-    NonBootHartMessageLockValue = atomic_xchg(&NonBootHartMessageLock, TRUE);
-  };
-  DEBUG((DEBUG_INFO, "%a: Non boot hart %d initialization.\n", __FUNCTION__, HartId));
-  NonBootHartMessageLockValue = atomic_xchg(&NonBootHartMessageLock, FALSE);
+  Mailbox = &mHartMailbox[HartId];
+  csr_set (CSR_MIE, MIP_MSIP);
+  atomic_cmpxchg (&Mailbox->State, SEC_HART_MAILBOX_EMPTY, SEC_HART_MAILBOX_PARKED);
+  while (atomic_read (&Mailbox->State) != SEC_HART_MAILBOX_READY) {
+    wfi ();
+  }
+  csr_clear (CSR_MIE, MIP_MSIP);
+  sbi_platform_ipi_clear (sbi_platform_ptr (Scratch), HartId);
+
+  //
+  // Post the message to this hart's own mailbox instead of serializing the
+  // console between harts; the boot hart prints it later.
+  //
+  AsciiSPrint (
+    Mailbox->Log,
+    sizeof (Mailbox->Log),
+    "%a: Non boot hart %d initialization.\n",
+    __FUNCTION__,
+    HartId
+    );
+  atomic_write (&Mailbox->State, SEC_HART_MAILBOX_LOGGED);
+
   //
   // Non boot hart wiil be halted waiting for SBI_HART_STARTING.
   // Use HSM ecall to start non boot hart (SBI_EXT_HSM_HART_START) later on,
@@ -11,6 +11,9 @@
 #define SECMAIN_H_
 
 #include <PiPei.h>
+#include <Guid/RiscVSecFfsIndex.h>
+#include <Guid/RiscVSecHartList.h>
+#include <Guid/RiscVSecPerformance.h>
 #include <Library/PeimEntryPoint.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
@@ -25,8 +28,45 @@
 #include <Library/PeCoffLib.h>
 #include <Library/PeiServicesLib.h>
 #include <Library/RiscVCpuLib.h>
+#include <Library/TimerLib.h>
 #include <Ppi/TemporaryRamDone.h>
 #include <Ppi/TemporaryRamSupport.h>
+#include <sbi/riscv_atomic.h>
+#include <sbi/sbi_hartmask.h>
+
+//
+// Non-boot hart mailbox states.
+//
+#define SEC_HART_MAILBOX_EMPTY    0 // Hart has not arrived yet.
+#define SEC_HART_MAILBOX_PARKED   1 // Hart is sleeping in WFI waiting for the boot hart.
+#define SEC_HART_MAILBOX_READY    2 // Boot hart released this hart.
+#define SEC_HART_MAILBOX_LOGGED   3 // Hart posted its log message and entered sbi_init.
+#define SEC_HART_MAILBOX_FLUSHED  4 // Boot hart printed the posted log message.
+
+#define SEC_HART_MAILBOX_CACHE_LINE_SIZE  64
+#define SEC_HART_MAILBOX_LOG_SIZE         (SEC_HART_MAILBOX_CACHE_LINE_SIZE - sizeof (atomic_t))
+
+//
+// Per-hart mailbox used to release non-boot harts from SEC. Each entry
+// occupies exactly one cache line so that a hart polling its own state
+// never contends with the other harts.
+//
+typedef struct {
+  atomic_t  State;
+  CHAR8     Log[SEC_HART_MAILBOX_LOG_SIZE];
+} SEC_HART_MAILBOX;
+
+/**
+  Return the argument the previous booting stage passed to SEC in a1, which
+  is the device tree on RISC-V.
+
+  @return The argument, 0 if there is none.
+
+**/
+UINTN
+fw_prev_arg1 (
+  VOID
+  );
 
 VOID
 SecMachineModeTrapHandler (
@@ -17,6 +17,18 @@ UINT32 LastExecutedCommand = (UINT32) -1;
 
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
 
+//
+// Block count set by CMD23 for the next command, and the blocks of the
+// data command in progress, 0 when it is open-ended and ends with CMD12.
+//
+STATIC UINT32 mPendingBlockCount;
+STATIC UINT32 mTransferBlockCount;
+
+STATIC UINTN                mDmaChannelBase;  // 0 when only PIO is used
+STATIC BCM2836_DMA_CB       *mDmaCb;
+STATIC EFI_PHYSICAL_ADDRESS mDmaCbBusAddress;
+STATIC VOID                 *mDmaCbMapping;
+
 /**
    These SD commands are optional, according to the SD Spec
 **/
@@ -240,6 +252,235 @@ CalculateClockFrequencyDivisor (
   return EFI_SUCCESS;
 }
 
+/**
+   Program the SD clock, it is stopped while the divisor changes
+**/
+STATIC
+EFI_STATUS
+SetClock (
+  IN UINTN TargetFrequency
+  )
+{
+  EFI_STATUS Status;
+  UINT32 Divisor;
+  UINTN ActualFrequency;
+
+  Status = CalculateClockFrequencyDivisor (TargetFrequency, &Divisor, &ActualFrequency);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "ArasanMMCHost: SetClock(): Fail to set SD clock to %u Hz\n",
+      TargetFrequency));
+    return Status;
+  }
+
+  // First turn off the clock
+  MmioAnd32 (MMCHS_SYSCTL, ~CEN);
+
+  // Setup new divisor
+  MmioAndThenOr32 (MMCHS_SYSCTL, (UINT32) ~CLKD_MASK, Divisor);
+
+  // Wait for the clock to stabilise
+  Status = PollRegisterWithMask (MMCHS_SYSCTL, ICS_MASK, ICS);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "ArasanMMCHost: SetClock(): Clock not stable\n"));
+    return Status;
+  }
+
+  MmioOr32 (MMCHS_SYSCTL, CEN);
+
+  DEBUG ((DEBUG_INFO, "ArasanMMCHost: SD clock %u Hz (%u Hz requested)\n",
+    ActualFrequency, TargetFrequency));
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+DmaReset (
+  VOID
+  )
+{
+  MmioWrite32 (mDmaChannelBase + BCM2836_DMA_CS, BCM2836_DMA_CS_RESET);
+  MmioWrite32 (mDmaChannelBase + BCM2836_DMA_DEBUG, BCM2836_DMA_DEBUG_ERRORS);
+}
+
+STATIC
+EFI_STATUS
+DmaInitialize (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Channel;
+  UINTN       Bytes;
+
+  Channel = FixedPcdGet32 (PcdArasanDmaChannel);
+  if (Channel >= BCM2836_DMA_CHANNEL_COUNT) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = DmaAllocateBuffer (EfiBootServicesData, 1, (VOID **)&mDmaCb);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Bytes = EFI_PAGES_TO_SIZE (1);
+  Status = DmaMap (MapOperationBusMasterCommonBuffer, mDmaCb, &Bytes,
+             &mDmaCbBusAddress, &mDmaCbMapping);
+  if (EFI_ERROR (Status)) {
+    DmaFreeBuffer (1, mDmaCb);
+    mDmaCb = NULL;
+    return Status;
+  }
+
+  ASSERT ((mDmaCbBusAddress % BCM2836_DMA_CB_ALIGNMENT) == 0);
+
+  mDmaChannelBase = BCM2836_DMA_CHANNEL_BASE_ADDRESS (Channel);
+  MmioOr32 (BCM2836_DMA_ENABLE, 1 << Channel);
+  DmaReset ();
+
+  DEBUG ((DEBUG_INFO, "ArasanMMCHost: Using DMA channel %u\n", Channel));
+  return EFI_SUCCESS;
+}
+
+/**
+   Wait for the end of a data command with a known length, the
+   open-ended ones only finish with CMD12
+**/
+STATIC
+EFI_STATUS
+WaitForTransferComplete (
+  VOID
+  )
+{
+  UINTN MmcStatus;
+  UINTN RetryCount;
+
+  if (mTransferBlockCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  for (RetryCount = 0; RetryCount < MAX_RETRY_COUNT; RetryCount++) {
+    MmcStatus = MmioRead32 (MMCHS_INT_STAT);
+    if ((MmcStatus & ERRI) != 0) {
+      DEBUG ((DEBUG_ERROR, "%a(%u): ERRI MmcStatus 0x%x\n",
+        __FUNCTION__, __LINE__, MmcStatus));
+      SoftReset (SRC | SRD);
+      return EFI_DEVICE_ERROR;
+    }
+
+    if ((MmcStatus & TC) != 0) {
+      MmioWrite32 (MMCHS_INT_STAT, TC);
+      return EFI_SUCCESS;
+    }
+
+    gBS->Stall (STALL_AFTER_RETRY_US);
+  }
+
+  DEBUG ((DEBUG_ERROR, "%a(%u): TIMEOUT PresState 0x%x MmcStatus 0x%x\n",
+    __FUNCTION__, __LINE__, MmioRead32 (MMCHS_PRES_STATE), MmcStatus));
+  return EFI_TIMEOUT;
+}
+
+/**
+   Move Length bytes between Buffer and the data port with the DMA engine,
+   the command of the transfer must have been sent.
+
+   The buffer is mapped in runs of up to DMA_MAX_RUN_LENGTH bytes, each run
+   is a chain of control blocks paced by the EMMC DREQ.
+**/
+STATIC
+EFI_STATUS
+DmaTransfer (
+  IN UINT8    *Buffer,
+  IN UINTN    Length,
+  IN BOOLEAN  IsRead
+  )
+{
+  EFI_STATUS            Status;
+  EFI_PHYSICAL_ADDRESS  BusAddress;
+  VOID                  *Mapping;
+  BCM2836_DMA_CB        *Cb;
+  UINTN                 RunLength;
+  UINTN                 MapLength;
+  UINTN                 Offset;
+  UINT32                PollCount;
+  UINT32                Cs;
+
+  Status = EFI_SUCCESS;
+  Cs = 0;
+
+  while (Length > 0) {
+    RunLength = MIN (Length, DMA_MAX_RUN_LENGTH);
+
+    MapLength = RunLength;
+    Status = DmaMap (IsRead ? MapOperationBusMasterWrite : MapOperationBusMasterRead,
+               Buffer, &MapLength, &BusAddress, &Mapping);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    ASSERT (MapLength == RunLength);
+
+    for (Offset = 0, Cb = mDmaCb; Offset < RunLength; Cb++) {
+      Cb->TransferLength = (UINT32)MIN (RunLength - Offset, DMA_SEGMENT_LENGTH);
+      if (IsRead) {
+        Cb->TransferInfo = BCM2836_DMA_TI_WAIT_RESP | BCM2836_DMA_TI_DEST_INC |
+                           BCM2836_DMA_TI_SRC_DREQ |
+                           BCM2836_DMA_TI_PERMAP (BCM2836_DMA_DREQ_EMMC);
+        Cb->SourceAddress = MMCHS_DATA_BUS_ADDRESS;
+        Cb->DestinationAddress = (UINT32)(BusAddress + Offset);
+      } else {
+        Cb->TransferInfo = BCM2836_DMA_TI_WAIT_RESP | BCM2836_DMA_TI_SRC_INC |
+                           BCM2836_DMA_TI_DEST_DREQ |
+                           BCM2836_DMA_TI_PERMAP (BCM2836_DMA_DREQ_EMMC);
+        Cb->SourceAddress = (UINT32)(BusAddress + Offset);
+        Cb->DestinationAddress = MMCHS_DATA_BUS_ADDRESS;
+      }
+      Cb->Stride = 0;
+      Offset += Cb->TransferLength;
+      Cb->NextControlBlock = (Offset < RunLength) ?
+                             (UINT32)(mDmaCbBusAddress + (Cb + 1 - mDmaCb) * sizeof (*Cb)) : 0;
+    }
+
+    MmioWrite32 (mDmaChannelBase + BCM2836_DMA_CONBLK_AD, (UINT32)mDmaCbBusAddress);
+    MmioWrite32 (mDmaChannelBase + BCM2836_DMA_CS,
+      BCM2836_DMA_CS_END | BCM2836_DMA_CS_WAIT_FOR_OUTSTANDING_WRITES |
+      BCM2836_DMA_CS_ACTIVE);
+
+    // The channel drops ACTIVE once it loaded the null next control block.
+    for (PollCount = 0; PollCount < DMA_MAX_POLL_US; PollCount++) {
+      Cs = MmioRead32 (mDmaChannelBase + BCM2836_DMA_CS);
+      if ((Cs & BCM2836_DMA_CS_ACTIVE) == 0 ||
+          (Cs & BCM2836_DMA_CS_ERROR) != 0 ||
+          (MmioRead32 (MMCHS_INT_STAT) & ERRI) != 0) {
+        break;
+      }
+      gBS->Stall (DMA_STALL_AFTER_POLL_US);
+    }
+
+    if ((Cs & (BCM2836_DMA_CS_ACTIVE | BCM2836_DMA_CS_ERROR)) != 0 ||
+        (Cs & BCM2836_DMA_CS_END) == 0) {
+      DEBUG ((DEBUG_ERROR,
+        "%a(%u): %a of 0x%x bytes failed, CS 0x%x DEBUG 0x%x MmcStatus 0x%x\n",
+        __FUNCTION__, __LINE__, IsRead ? "read" : "write", RunLength, Cs,
+        MmioRead32 (mDmaChannelBase + BCM2836_DMA_DEBUG),
+        MmioRead32 (MMCHS_INT_STAT)));
+      DmaReset ();
+      SoftReset (SRC | SRD);
+      Status = (PollCount == DMA_MAX_POLL_US) ? EFI_TIMEOUT : EFI_DEVICE_ERROR;
+    }
+
+    DmaUnmap (Mapping);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    Buffer += RunLength;
+    Length -= RunLength;
+  }
+
+  MmioWrite32 (MMCHS_INT_STAT, BRR | BWR);
+  return WaitForTransferComplete ();
+}
+
 BOOLEAN
 MMCIsReadOnly (
   IN EFI_MMC_HOST_PROTOCOL *This
@@ -282,6 +523,11 @@ MMCSendCommand (
   BOOLEAN IsAppCmd = (LastExecutedCommand == CMD55);
   BOOLEAN IsDATCmd = FALSE;
   BOOLEAN IsADTCCmd = FALSE;
+  UINT32 BlockCount;
+
+  // CMD23 only applies to the command right after it
+  BlockCount = mPendingBlockCount;
+  mPendingBlockCount = 0;
 
   DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSendCommand(MmcCmd: %08x, Argument: %08x)\n", MmcCmd, Argument));
 
@@ -330,10 +576,25 @@ MMCSendCommand (
     MmioWrite32 (MMCHS_BLK, 8);
   } else if (!IsAppCmd && MmcCmd == CMD6) {
     MmioWrite32 (MMCHS_BLK, 64);
+  } else if (IsADTCCmd && (MmcCmd & MSBS_MULTBLK) != 0 && BlockCount != 0) {
+    //
+    // Pre-defined by CMD23, let the controller stop the data phase
+    // on its own.
+    //
+    MmioWrite32 (MMCHS_BLK, BLEN_512BYTES | (BlockCount << BLOCK_COUNT_SHIFT));
+    MmcCmd |= BCE_ENABLE;
   } else if (IsADTCCmd) {
     MmioWrite32 (MMCHS_BLK, BLEN_512BYTES);
   }
 
+  if (IsADTCCmd) {
+    if ((MmcCmd & MSBS_MULTBLK) == 0) {
+      mTransferBlockCount = 1;
+    } else {
+      mTransferBlockCount = BlockCount;
+    }
+  }
+
   // Set Data timeout counter value to max value.
   MmioAndThenOr32 (MMCHS_SYSCTL, (UINT32) ~DTO_MASK, DTO_VAL);
 
@@ -395,6 +656,9 @@ Exit:
     LastExecutedCommand = (UINT32) -1;
   } else {
     LastExecutedCommand = MmcCmd;
+    if (MmcCmd == CMD_SET_BLOCK_COUNT) {
+      mPendingBlockCount = Argument & 0xFFFF;
+    }
   }
   return Status;
 }
@@ -407,7 +671,6 @@ MMCNotifyState (
 {
   EFI_STATUS Status;
   UINTN ClockFrequency;
-  UINT32 Divisor;
 
   DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCNotifyState(State: %d)\n", State));
 
@@ -450,24 +713,10 @@ MMCNotifyState (
   case MmcStandByState:
     ClockFrequency = 25000000;
 
-    // First turn off the clock
-    MmioAnd32 (MMCHS_SYSCTL, ~CEN);
-
-    Status = CalculateClockFrequencyDivisor (ClockFrequency, &Divisor, NULL);
+    Status = SetClock (ClockFrequency);
     if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "ArasanMMCHost: MmcStandByState(): Fail to initialize SD clock to %u Hz\n",
-        ClockFrequency));
       return Status;
     }
-
-    // Setup new divisor
-    MmioAndThenOr32 (MMCHS_SYSCTL, (UINT32) ~CLKD_MASK, Divisor);
-
-    // Wait for the clock to stabilise
-    while ((MmioRead32 (MMCHS_SYSCTL) & ICS_MASK) != ICS);
-
-    // Set Data Timeout Counter value, set clock frequency, enable internal clock
-    MmioOr32 (MMCHS_SYSCTL, CEN);
     break;
   case MmcTransferState:
     break;
@@ -609,6 +858,7 @@ MMCReadBlockData (
   IN UINT32*                  Buffer
   )
 {
+  EFI_STATUS Status;
   UINTN MmcStatus;
   UINTN RemLength;
   UINTN Count;
@@ -626,6 +876,14 @@ MMCReadBlockData (
     return EFI_INVALID_PARAMETER;
   }
 
+  mFwProtocol->SetLed (TRUE);
+
+  if (mDmaChannelBase != 0 && Length % BLEN_512BYTES == 0) {
+    Status = DmaTransfer ((UINT8 *)Buffer, Length, TRUE);
+    mFwProtocol->SetLed (FALSE);
+    return Status;
+  }
+
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -638,12 +896,9 @@ MMCReadBlockData (
         /*
          * Data is ready.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           *Buffer = MmioRead32 (MMCHS_DATA);
         }
-
-        mFwProtocol->SetLed (FALSE);
         break;
       }
 
@@ -654,6 +909,7 @@ MMCReadBlockData (
     if (RetryCount == MAX_RETRY_COUNT) {
       DEBUG ((DEBUG_ERROR, "%a(%u): %lu/%lu MMCHS_INT_STAT: %08x\n",
         __FUNCTION__, __LINE__, Length - RemLength, Length, MmcStatus));
+      mFwProtocol->SetLed (FALSE);
       return EFI_TIMEOUT;
     }
 
@@ -661,6 +917,7 @@ MMCReadBlockData (
     gBS->Stall (STALL_AFTER_READ_US);
   }
 
+  mFwProtocol->SetLed (FALSE);
   MmioWrite32 (MMCHS_INT_STAT, BRR);
   return EFI_SUCCESS;
 }
@@ -673,6 +930,7 @@ MMCWriteBlockData (
   IN UINT32*                  Buffer
   )
 {
+  EFI_STATUS Status;
   UINTN MmcStatus;
   UINTN RemLength;
   UINTN Count;
@@ -690,6 +948,19 @@ MMCWriteBlockData (
     return EFI_INVALID_PARAMETER;
   }
 
+  mFwProtocol->SetLed (TRUE);
+
+  //
+  // An open-ended write would be cut by the CMD12 which follows it
+  // while the FIFO drains, only the ones of known length use DMA.
+  //
+  if (mDmaChannelBase != 0 && Length % BLEN_512BYTES == 0 &&
+      mTransferBlockCount != 0) {
+    Status = DmaTransfer ((UINT8 *)Buffer, Length, FALSE);
+    mFwProtocol->SetLed (FALSE);
+    return Status;
+  }
+
   RemLength = Length;
   while (RemLength != 0) {
     UINTN RetryCount = 0;
@@ -702,12 +973,9 @@ MMCWriteBlockData (
         /*
          * Can write data.
          */
-        mFwProtocol->SetLed (TRUE);
         for (Count = 0; Count < BlockLen; Count += 4, Buffer++) {
           MmioWrite32 (MMCHS_DATA, *Buffer);
         }
-
-        mFwProtocol->SetLed (FALSE);
         break;
       }
 
@@ -718,6 +986,7 @@ MMCWriteBlockData (
     if (RetryCount == MAX_RETRY_COUNT) {
       DEBUG ((DEBUG_ERROR, "%a(%u): %lu/%lu MMCHS_INT_STAT: %08x\n",
         __FUNCTION__, __LINE__, Length - RemLength, Length, MmcStatus));
+      mFwProtocol->SetLed (FALSE);
       return EFI_TIMEOUT;
     }
 
@@ -725,10 +994,61 @@ MMCWriteBlockData (
     gBS->Stall (STALL_AFTER_WRITE_US);
   }
 
+  mFwProtocol->SetLed (FALSE);
   MmioWrite32 (MMCHS_INT_STAT, BWR);
   return EFI_SUCCESS;
 }
 
+/**
+   Set the bus width and clock picked by MmcDxe. The BCM283x Arasan has no
+   working high speed enable bit, the high speed modes are only a matter
+   of the clock. Its data bus is 4 bits wide and it can't do DDR.
+**/
+EFI_STATUS
+MMCSetIos (
+  IN EFI_MMC_HOST_PROTOCOL      *This,
+  IN  UINT32                    BusClockFreq,
+  IN  UINT32                    BusWidth,
+  IN  UINT32                    TimingMode
+  )
+{
+  EFI_STATUS Status;
+
+  DEBUG ((DEBUG_MMCHOST_SD, "ArasanMMCHost: MMCSetIos(Freq: %u, Width: %u, Timing: %x)\n",
+    BusClockFreq, BusWidth, TimingMode));
+
+  switch (TimingMode) {
+  case EMMCBACKWARD:
+  case EMMCHS26:
+  case EMMCHS52:
+    break;
+  default:
+    return EFI_UNSUPPORTED;
+  }
+
+  switch (BusWidth) {
+  case 0:
+    break;
+  case 1:
+    MmioAnd32 (MMCHS_HCTL, ~DTW_MASK);
+    break;
+  case 4:
+    MmioAndThenOr32 (MMCHS_HCTL, ~DTW_MASK, DTW_4_BIT);
+    break;
+  default:
+    return EFI_UNSUPPORTED;
+  }
+
+  if (BusClockFreq != 0) {
+    Status = SetClock (BusClockFreq);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
 BOOLEAN
 MMCIsMultiBlock (
   IN EFI_MMC_HOST_PROTOCOL *This
@@ -748,7 +1068,7 @@ EFI_MMC_HOST_PROTOCOL gMMCHost =
   MMCReceiveResponse,
   MMCReadBlockData,
   MMCWriteBlockData,
-  NULL,
+  MMCSetIos,
   MMCIsMultiBlock
 };
 
@@ -775,6 +1095,11 @@ MMCInitialize (
     return Status;
   }
 
+  Status = DmaInitialize ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_INFO, "ArasanMMCHost: DMA not used (%r), transfers use PIO\n", Status));
+  }
+
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &Handle,
                   &gRaspberryPiMmcHostProtocolGuid,
@@ -29,6 +29,7 @@
 
 #include <IndustryStandard/Bcm2836.h>
 #include <IndustryStandard/Bcm2836Sdio.h>
+#include <IndustryStandard/Bcm2836Dma.h>
 #include <IndustryStandard/RpiMbox.h>
 
 #define MAX_RETRY_COUNT (1000 * 20)
@@ -41,4 +42,14 @@
 
 #define MAX_DIVISOR_VALUE 1023
 
+// The controller raises the EMMC DREQ while its FIFO can be accessed, so
+// the DMA channel moves whole blocks without any PIO. Each control block
+// moves a segment small enough for the lite channels, a page of them is
+// chained per run.
+#define DMA_SEGMENT_LENGTH          0x8000
+#define DMA_CB_COUNT                (EFI_PAGE_SIZE / sizeof (BCM2836_DMA_CB))
+#define DMA_MAX_RUN_LENGTH          (DMA_CB_COUNT * DMA_SEGMENT_LENGTH)
+#define DMA_MAX_POLL_US             1000000 // 1s per run
+#define DMA_STALL_AFTER_POLL_US     1
+
 #endif
@@ -9,7 +9,9 @@
 #include "ConfigDxe.h"
 #include <IndustryStandard/Pci.h>
 #include <Protocol/PciIo.h>
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 
@@ -38,6 +40,7 @@ PciIoNotificationEvent (
   UINTN                          BusNumber;
   UINTN                          DeviceNumber;
   UINTN                          FunctionNumber;
+  UINT64                         StartTime;
   RASPBERRY_PI_FIRMWARE_PROTOCOL *FwProtocol = Context;
 
   Status = gBS->LocateProtocol (&gEfiPciIoProtocolGuid,
@@ -78,11 +81,17 @@ PciIoNotificationEvent (
           SegmentNumber, BusNumber, DeviceNumber, FunctionNumber));
 
   ASSERT (SegmentNumber == 0);
+  StartTime = GetPerformanceCounter ();
   Status = FwProtocol->NotifyXhciReset(BusNumber, DeviceNumber, FunctionNumber);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_WARN, "%a: couldn't signal xHCI firmware load: %r\n",
             __FUNCTION__, Status));
+    return;
   }
+
+  DEBUG ((DEBUG_INFO, "xHCI firmware load took %lu us\n",
+          DivU64x32 (GetTimeInNanoSecond (GetPerformanceCounter () - StartTime),
+            1000)));
 }
 
 VOID
@@ -24,6 +24,10 @@
                                 (posY) * This->Mode->Info->PixelsPerScanLine * \
                                 PI3_BYTES_PER_PIXEL +                   \
                                 (posX) * PI3_BYTES_PER_PIXEL))
+#define POS_TO_SHADOW(posX, posY) (mShadowFb +                          \
+                               (posY) * This->Mode->Info->PixelsPerScanLine * \
+                               PI3_BYTES_PER_PIXEL +                    \
+                               (posX) * PI3_BYTES_PER_PIXEL)
 
 STATIC
 EFI_STATUS
@@ -112,6 +116,13 @@ STATIC EFI_HANDLE mDevice;
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL *mFwProtocol;
 STATIC EFI_CPU_ARCH_PROTOCOL *mCpu;
 
+/*
+ * Cached copy of the frame buffer, reading back the write-combined
+ * VideoCore memory is very slow. NULL if not in use.
+ */
+STATIC UINT8 *mShadowFb;
+STATIC UINTN mShadowFbPages;
+
 STATIC UINTN mLastMode;
 STATIC GOP_MODE_DATA mGopModeTemplate[] = {
   { 800,  600  }, /* Legacy */
@@ -256,13 +267,15 @@ DisplaySetMode (
   }
 
   /*
-   * WT, because certain OS loaders access the frame buffer directly
-   * and we don't want to see corruption due to missing WB cache
-   * maintenance. Performance with WT is good.
+   * WC (Normal non-cacheable), because certain OS loaders access the
+   * frame buffer directly and we don't want to see corruption due to
+   * missing WB cache maintenance. Unlike WT, WC lets the stores be
+   * merged into bursts, but reads are slow: the Blt reads are served
+   * from the shadow copy when there is one.
    */
   Status = mCpu->SetMemoryAttributes (mCpu, FbBase,
                    ALIGN_VALUE (FbSize, EFI_PAGE_SIZE),
-                   EFI_MEMORY_WT);
+                   EFI_MEMORY_WC);
   if (Status != EFI_SUCCESS) {
     DEBUG ((DEBUG_ERROR, "Couldn't set framebuffer attributes: %r\n", Status));
     return Status;
@@ -282,6 +295,18 @@ DisplaySetMode (
   This->Mode->FrameBufferSize = Mode->Width * Mode->Height * PI3_BYTES_PER_PIXEL;
   DEBUG((DEBUG_INFO, "Reported Mode->FrameBufferSize is %u\n", This->Mode->FrameBufferSize));
 
+  if (FeaturePcdGet (PcdDisplayShadowFrameBuffer)) {
+    if (mShadowFb != NULL) {
+      FreePages (mShadowFb, mShadowFbPages);
+    }
+
+    mShadowFbPages = EFI_SIZE_TO_PAGES (This->Mode->FrameBufferSize);
+    mShadowFb = AllocatePages (mShadowFbPages);
+    if (mShadowFb == NULL) {
+      DEBUG ((DEBUG_WARN, "No shadow frame buffer, Blt reads will be slow\n"));
+    }
+  }
+
   ClearScreen (This);
   return EFI_SUCCESS;
 }
@@ -304,6 +329,9 @@ DisplayBlt (
 {
   UINT8 *VidBuf, *BltBuf, *VidBuf1;
   UINTN i;
+  UINTN Row;
+  UINTN Rows;
+  UINTN RowSize;
 
   if ((UINTN)BltOperation >= EfiGraphicsOutputBltOperationMax) {
     return EFI_INVALID_PARAMETER;
@@ -313,52 +341,86 @@ DisplayBlt (
     return EFI_INVALID_PARAMETER;
   }
 
+  if (Delta == 0) {
+    Delta = Width * PI3_BYTES_PER_PIXEL;
+  }
+
+  /*
+   * Whole lines are contiguous in video memory, so a full width
+   * rectangle is done as one large copy or fill.
+   */
+  Rows = Height;
+  RowSize = Width * PI3_BYTES_PER_PIXEL;
+  if (Width == This->Mode->Info->PixelsPerScanLine &&
+      Delta == RowSize &&
+      BltOperation != EfiBltVideoToVideo) {
+    Rows = 1;
+    RowSize *= Height;
+  }
+
   switch (BltOperation) {
   case EfiBltVideoFill:
     BltBuf = (UINT8*)BltBuffer;
 
-    for (i = 0; i < Height; i++) {
+    for (i = 0; i < Rows; i++) {
       VidBuf = POS_TO_FB (DestinationX, DestinationY + i);
 
-      SetMem32 (VidBuf, Width * PI3_BYTES_PER_PIXEL, *(UINT32*)BltBuf);
+      SetMem32 (VidBuf, RowSize, *(UINT32*)BltBuf);
+      if (mShadowFb != NULL) {
+        SetMem32 (POS_TO_SHADOW (DestinationX, DestinationY + i), RowSize,
+          *(UINT32*)BltBuf);
+      }
     }
     break;
 
   case EfiBltVideoToBltBuffer:
-    if (Delta == 0) {
-      Delta = Width * PI3_BYTES_PER_PIXEL;
-    }
-
-    for (i = 0; i < Height; i++) {
-      VidBuf = POS_TO_FB (SourceX, SourceY + i);
+    for (i = 0; i < Rows; i++) {
+      if (mShadowFb != NULL) {
+        VidBuf = POS_TO_SHADOW (SourceX, SourceY + i);
+      } else {
+        VidBuf = POS_TO_FB (SourceX, SourceY + i);
+      }
 
       BltBuf = (UINT8*)((UINTN)BltBuffer + (DestinationY + i) * Delta +
         DestinationX * PI3_BYTES_PER_PIXEL);
 
-      gBS->CopyMem ((VOID*)BltBuf, (VOID*)VidBuf, PI3_BYTES_PER_PIXEL * Width);
+      CopyMem ((VOID*)BltBuf, (VOID*)VidBuf, RowSize);
     }
     break;
 
   case EfiBltBufferToVideo:
-    if (Delta == 0) {
-      Delta = Width * PI3_BYTES_PER_PIXEL;
-    }
-
-    for (i = 0; i < Height; i++) {
+    for (i = 0; i < Rows; i++) {
       VidBuf = POS_TO_FB (DestinationX, DestinationY + i);
       BltBuf = (UINT8*)((UINTN)BltBuffer + (SourceY + i) * Delta +
         SourceX * PI3_BYTES_PER_PIXEL);
 
-      gBS->CopyMem ((VOID*)VidBuf, (VOID*)BltBuf, Width * PI3_BYTES_PER_PIXEL);
+      CopyMem ((VOID*)VidBuf, (VOID*)BltBuf, RowSize);
+      if (mShadowFb != NULL) {
+        CopyMem (POS_TO_SHADOW (DestinationX, DestinationY + i), BltBuf,
+          RowSize);
+      }
     }
     break;
 
   case EfiBltVideoToVideo:
+    /*
+     * Go from the bottom up when moving down, so that overlapping
+     * lines are read before they are overwritten. With a shadow the
+     * move is done there, and the frame buffer is only written to.
+     */
     for (i = 0; i < Height; i++) {
-      VidBuf = POS_TO_FB (SourceX, SourceY + i);
-      VidBuf1 = POS_TO_FB (DestinationX, DestinationY + i);
-
-      gBS->CopyMem ((VOID*)VidBuf1, (VOID*)VidBuf, Width * PI3_BYTES_PER_PIXEL);
+      Row = (DestinationY > SourceY) ? Height - 1 - i : i;
+
+      if (mShadowFb != NULL) {
+        VidBuf = POS_TO_SHADOW (SourceX, SourceY + Row);
+        VidBuf1 = POS_TO_SHADOW (DestinationX, DestinationY + Row);
+        CopyMem ((VOID*)VidBuf1, (VOID*)VidBuf, RowSize);
+        CopyMem (POS_TO_FB (DestinationX, DestinationY + Row), VidBuf1, RowSize);
+      } else {
+        VidBuf = POS_TO_FB (SourceX, SourceY + Row);
+        VidBuf1 = POS_TO_FB (DestinationX, DestinationY + Row);
+        CopyMem ((VOID*)VidBuf1, (VOID*)VidBuf, RowSize);
+      }
     }
     break;
 
@@ -644,6 +706,11 @@ DriverStop (
   FreePool (gDisplayProto.Mode);
   gDisplayProto.Mode = NULL;
 
+  if (mShadowFb != NULL) {
+    FreePages (mShadowFb, mShadowFbPages);
+    mShadowFb = NULL;
+  }
+
   gBS->CloseProtocol (
          Controller,
          &gEfiCallerIdGuid,
@@ -86,14 +86,14 @@ Wait4Chhltd (
   IN  UINT32          *Sub,
   IN  UINT32          *Toggle,
   IN  BOOLEAN         IgnoreAck,
-  IN  SPLIT_CONTROL   *Split
+  IN  SPLIT_CONTROL   *Split,
+  OUT BOOLEAN         *DoPing
   )
 {
   EFI_STATUS Status;
   UINT32  Hcint, Hctsiz;
   UINT32  HcintCompHltAck = DWC2_HCINT_XFERCOMP;
 
-  MicroSecondDelay (100);
   Status = Wait4Bit (Timeout, DwHc->DwUsbBase + HCINT (Channel),
                      DWC2_HCINT_CHHLTD, 1);
   if (EFI_ERROR (Status)) {
@@ -117,6 +117,17 @@ Wait4Chhltd (
     return XFER_ERROR;
   }
 
+  /*
+   * A high-speed OUT that completed with NYET: the data was taken, but
+   * the next one has to start with PING.
+   */
+  if (!Split->Splitting &&
+      ((Hcint & (DWC2_HCINT_NYET | DWC2_HCINT_XFERCOMP)) ==
+       (DWC2_HCINT_NYET | DWC2_HCINT_XFERCOMP))) {
+    Hcint &= ~DWC2_HCINT_NYET;
+    *DoPing = TRUE;
+  }
+
   if ((Hcint & DWC2_HCINT_NYET) != 0) {
     return XFER_CSPLIT;
   }
@@ -157,6 +168,31 @@ Wait4Chhltd (
   return XFER_DONE;
 }
 
+/*
+ * Wait for the next microframe to start, for at most two microframes
+ * in case the port is not running. The TT handles the split
+ * transactions on (micro)frame boundaries, so retrying a complete
+ * split, or a NAKed split, within the same microframe only gets
+ * another NYET or NAK and keeps the bus busy.
+ */
+STATIC
+VOID
+DwHcWaitNextMicroFrame (
+  IN  DWUSB_OTGHC_DEV *DwHc
+  )
+{
+  UINT32 Frame;
+  UINTN  Index;
+
+  Frame = MmioRead32 (DwHc->DwUsbBase + HFNUM) & DWC2_HFNUM_FRNUM_MASK;
+  for (Index = 0; Index < 250; Index++) {
+    if ((MmioRead32 (DwHc->DwUsbBase + HFNUM) & DWC2_HFNUM_FRNUM_MASK) != Frame) {
+      break;
+    }
+    MicroSecondDelay (1);
+  }
+}
+
 VOID
 DwOtgHcInit (
   IN  DWUSB_OTGHC_DEV    *DwHc,
@@ -248,8 +284,14 @@ DwHcTransfer (
   UINT32                          Sub;
   UINT32                          Ret = 0;
   UINT32                          StopTransfer = 0;
+  UINT32                          OddFrame;
   EFI_STATUS                      Status = EFI_SUCCESS;
+  EFI_STATUS                      MapStatus;
   SPLIT_CONTROL                   Split = { 0 };
+  BOOLEAN                         DoPing = FALSE;
+  VOID                            *Mapping = NULL;
+  EFI_PHYSICAL_ADDRESS            BusAddress = 0;
+  UINTN                           MapLength;
 
   EFI_TPL Tpl = gBS->RaiseTPL (TPL_NOTIFY);
 
@@ -266,11 +308,46 @@ DwHcTransfer (
 
     TxferLen = *DataLength - Done;
 
-    if (TxferLen > DWC2_MAX_TRANSFER_SIZE) {
-      TxferLen = DWC2_MAX_TRANSFER_SIZE - MaximumPacketLength + 1;
+    if (TxferLen > DwHc->MaxTransferSize) {
+      TxferLen = DwHc->MaxTransferSize - MaximumPacketLength + 1;
     }
 
-    if (TxferLen > DWC2_DATA_BUF_SIZE) {
+    if (!Split.Splitting &&
+        TxferLen > DwHc->MaxPacketCount * MaximumPacketLength) {
+      TxferLen = DwHc->MaxPacketCount * MaximumPacketLength;
+    }
+
+    if (!Split.Splitting && TxferLen < *DataLength - Done) {
+      TxferLen -= TxferLen % MaximumPacketLength;
+    }
+
+    /*
+     * Bulk data goes straight to or from the caller's buffer, so that
+     * a large transfer is one channel transfer with no copy. The core
+     * needs a word aligned address, and an IN must not be allowed to
+     * overrun the buffer with a packet larger than what is left.
+     */
+    if (EpType == DWC2_HCCHAR_EPTYPE_BULK &&
+        !Split.Splitting &&
+        TxferLen != 0 &&
+        (((UINTN)Data + Done) & 0x3) == 0 &&
+        (!TransferDirection || (TxferLen % MaximumPacketLength) == 0)) {
+      MapLength = TxferLen;
+      MapStatus = DmaMap (TransferDirection ? MapOperationBusMasterWrite :
+                            MapOperationBusMasterRead,
+                    Data + Done, &MapLength, &BusAddress, &Mapping);
+      if (!EFI_ERROR (MapStatus) &&
+          (MapLength != TxferLen || BusAddress > MAX_UINT32)) {
+        DmaUnmap (Mapping);
+        MapStatus = EFI_UNSUPPORTED;
+      }
+
+      if (EFI_ERROR (MapStatus)) {
+        Mapping = NULL;
+      }
+    }
+
+    if (Mapping == NULL && TxferLen > DWC2_DATA_BUF_SIZE) {
       TxferLen = DWC2_DATA_BUF_SIZE - MaximumPacketLength + 1;
     }
 
@@ -278,41 +355,63 @@ DwHcTransfer (
       NumPackets = 1;
     } else {
       NumPackets = (TxferLen + MaximumPacketLength - 1) / MaximumPacketLength;
-      if (NumPackets > DWC2_MAX_PACKET_COUNT) {
-        NumPackets = DWC2_MAX_PACKET_COUNT;
+      if (NumPackets > DwHc->MaxPacketCount) {
+        NumPackets = DwHc->MaxPacketCount;
         TxferLen = NumPackets * MaximumPacketLength;
       }
     }
 
     if (TransferDirection) { // in
       TxferLen = NumPackets * MaximumPacketLength;
-    } else {
+    } else if (Mapping == NULL) {
       CopyMem (DwHc->AlignedBuffer, Data + Done, TxferLen);
       ArmDataSynchronizationBarrier ();
     }
 
   RestartChannel:
     MmioWrite32 (DwHc->DwUsbBase + HCDMA (Channel),
-      (UINTN)DwHc->AlignedBufferBusAddress);
+      (Mapping != NULL) ? (UINT32)BusAddress :
+                          (UINT32)DwHc->AlignedBufferBusAddress);
 
     DwOtgHcInit (DwHc, Channel, Translator, DeviceSpeed,
       DeviceAddress, EpAddress,
       TransferDirection, EpType,
       MaximumPacketLength, &Split);
 
+    /*
+     * The core does the PING protocol itself, it only needs to be told
+     * to start with one.
+     */
     MmioWrite32 (DwHc->DwUsbBase + HCTSIZ (Channel),
       (TxferLen << DWC2_HCTSIZ_XFERSIZE_OFFSET) |
       (NumPackets << DWC2_HCTSIZ_PKTCNT_OFFSET) |
-      (*Pid << DWC2_HCTSIZ_PID_OFFSET));
+      (*Pid << DWC2_HCTSIZ_PID_OFFSET) |
+      ((DoPing && !TransferDirection) ? DWC2_HCTSIZ_DOPNG : 0));
+    DoPing = FALSE;
+
+    /*
+     * A periodic transaction only goes out in the (micro)frame whose
+     * parity matches ODDFRM, aim for the next one instead of waiting
+     * a whole frame or overrunning.
+     */
+    OddFrame = 0;
+    if (EpType == DWC2_HCCHAR_EPTYPE_INTR) {
+      if ((MmioRead32 (DwHc->DwUsbBase + HFNUM) & 1) == 0) {
+        OddFrame = DWC2_HCCHAR_ODDFRM;
+      }
+    }
 
     MmioAndThenOr32 (DwHc->DwUsbBase + HCCHAR (Channel),
       ~(DWC2_HCCHAR_MULTICNT_MASK |
+        DWC2_HCCHAR_ODDFRM |
         DWC2_HCCHAR_CHEN |
         DWC2_HCCHAR_CHDIS),
         ((1 << DWC2_HCCHAR_MULTICNT_OFFSET) |
+          OddFrame |
           DWC2_HCCHAR_CHEN));
 
-    Ret = Wait4Chhltd (DwHc, Timeout, Channel, &Sub, Pid, IgnoreAck, &Split);
+    Ret = Wait4Chhltd (DwHc, Timeout, Channel, &Sub, Pid, IgnoreAck, &Split,
+            &DoPing);
 
     if (Ret == XFER_NOT_HALTED) {
       *TransferResult = EFI_USB_ERR_TIMEOUT;
@@ -339,6 +438,7 @@ DwHcTransfer (
     } else if (Ret == XFER_CSPLIT) {
       ASSERT (Split.Splitting);
 
+      DwHcWaitNextMicroFrame (DwHc);
       if (Split.Tries++ < 3) {
         goto RestartChannel;
       }
@@ -357,6 +457,7 @@ DwHcTransfer (
     } else if (Ret == XFER_NAK) {
       if (Split.Splitting &&
           (EpType == DWC2_HCCHAR_EPTYPE_CONTROL)) {
+        DwHcWaitNextMicroFrame (DwHc);
         goto RestartXfer;
       }
 
@@ -365,7 +466,16 @@ DwHcTransfer (
       break;
     }
 
-    if (TransferDirection) { // in
+    if (Mapping != NULL) {
+      DmaUnmap (Mapping);
+      Mapping = NULL;
+      if (TransferDirection) { // in
+        TxferLen -= Sub;
+        if (Sub) {
+          StopTransfer = 1;
+        }
+      }
+    } else if (TransferDirection) { // in
       ArmDataSynchronizationBarrier ();
       TxferLen -= Sub;
       CopyMem (Data + Done, DwHc->AlignedBuffer, TxferLen);
@@ -377,6 +487,10 @@ DwHcTransfer (
     Done += TxferLen;
   } while (Done < *DataLength && !StopTransfer);
 
+  if (Mapping != NULL) {
+    DmaUnmap (Mapping);
+  }
+
   MmioWrite32 (DwHc->DwUsbBase + HCINTMSK (Channel), 0);
   MmioWrite32 (DwHc->DwUsbBase + HCINT (Channel), 0xFFFFFFFF);
 
@@ -1306,6 +1420,8 @@ DwHcInit (
   UINT32 NpTxFifoSz = 0;
   UINT32 pTxFifoSz = 0;
   UINT32 Hprt0 = 0;
+  UINT32 HwCfg3;
+  UINT32 Width;
   INT32  i, Status, NumChannels;
 
   MmioWrite32 (DwHc->DwUsbBase + PCGCCTL, 0);
@@ -1334,6 +1450,18 @@ DwHcInit (
   NumChannels += 1;
   DEBUG ((DEBUG_INFO, "Host has %u channels\n", NumChannels));
 
+  HwCfg3 = MmioRead32 (DwHc->DwUsbBase + GHWCFG3);
+  Width = (HwCfg3 & DWC2_HWCFG3_XFER_SIZE_CNTR_WIDTH_MASK) >>
+    DWC2_HWCFG3_XFER_SIZE_CNTR_WIDTH_OFFSET;
+  DwHc->MaxTransferSize = MIN ((1U << (Width + 11)) - 1,
+                              DWC2_HCTSIZ_XFERSIZE_MASK);
+  Width = (HwCfg3 & DWC2_HWCFG3_PACKET_SIZE_CNTR_WIDTH_MASK) >>
+    DWC2_HWCFG3_PACKET_SIZE_CNTR_WIDTH_OFFSET;
+  DwHc->MaxPacketCount = MIN ((1U << (Width + 4)) - 1,
+                             DWC2_HCTSIZ_PKTCNT_MASK >> DWC2_HCTSIZ_PKTCNT_OFFSET);
+  DEBUG ((DEBUG_INFO, "Host transfers are up to %u bytes, %u packets\n",
+    DwHc->MaxTransferSize, DwHc->MaxPacketCount));
+
   for (i = 0; i < NumChannels; i++)
     MmioAndThenOr32 (DwHc->DwUsbBase + HCCHAR (i),
       ~(DWC2_HCCHAR_CHEN | DWC2_HCCHAR_EPDIR),
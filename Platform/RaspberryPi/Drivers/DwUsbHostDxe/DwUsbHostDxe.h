@@ -111,6 +111,11 @@ typedef struct _DWUSB_OTGHC_DEV {
   UINT8                           *AlignedBuffer;
   VOID *                          AlignedBufferMapping;
   UINTN                           AlignedBufferBusAddress;
+  /*
+   * Channel transfer limits, from the counter widths in GHWCFG3.
+   */
+  UINT32                          MaxTransferSize;
+  UINT32                          MaxPacketCount;
   LIST_ENTRY                      DeferredList;
   /*
    * 1ms frames.
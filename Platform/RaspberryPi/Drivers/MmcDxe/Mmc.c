@@ -45,6 +45,8 @@ LIST_ENTRY  mMmcHostPool;
 
 EFI_EVENT gCheckCardsEvent;
 
+STATIC EFI_EVENT mExitBootServicesEvent;
+
 /**
   Initialize the MMC Host Pool to support multiple MMC devices
 **/
@@ -107,17 +109,35 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   MmcHostInstance->BlockIo.WriteBlocks = MmcWriteBlocks;
   MmcHostInstance->BlockIo.FlushBlocks = MmcFlushBlocks;
 
+  MmcHostInstance->BlockIo2.Media = MmcHostInstance->BlockIo.Media;
+  MmcHostInstance->BlockIo2.Reset = MmcReset2;
+  MmcHostInstance->BlockIo2.ReadBlocksEx = MmcReadBlocksEx;
+  MmcHostInstance->BlockIo2.WriteBlocksEx = MmcWriteBlocksEx;
+  MmcHostInstance->BlockIo2.FlushBlocksEx = MmcFlushBlocksEx;
+
+  InitializeListHead (&MmcHostInstance->AsyncQueue);
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  MmcAsyncNotify,
+                  MmcHostInstance,
+                  &MmcHostInstance->AsyncEvent
+                );
+  if (EFI_ERROR (Status)) {
+    goto FREE_MEDIA;
+  }
+
   MmcHostInstance->MmcHost = MmcHost;
 
   // Create DevicePath for the new MMC Host
   Status = MmcHost->BuildDevicePath (MmcHost, &NewDevicePathNode);
   if (EFI_ERROR (Status)) {
-    goto FREE_MEDIA;
+    goto CLOSE_EVENT;
   }
 
   DevicePath = (EFI_DEVICE_PATH_PROTOCOL*)AllocatePool (END_DEVICE_PATH_LENGTH);
   if (DevicePath == NULL) {
-    goto FREE_MEDIA;
+    goto CLOSE_EVENT;
   }
 
   SetDevicePathEndNode (DevicePath);
@@ -127,6 +147,7 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
   Status = gBS->InstallMultipleProtocolInterfaces (
                   &MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &MmcHostInstance->BlockIo,
+                  &gEfiBlockIo2ProtocolGuid, &MmcHostInstance->BlockIo2,
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
@@ -139,6 +160,9 @@ MMC_HOST_INSTANCE* CreateMmcHostInstance (
 FREE_DEVICE_PATH:
   FreePool (DevicePath);
 
+CLOSE_EVENT:
+  gBS->CloseEvent (MmcHostInstance->AsyncEvent);
+
 FREE_MEDIA:
   FreePool (MmcHostInstance->BlockIo.Media);
 
@@ -154,10 +178,15 @@ EFI_STATUS DestroyMmcHostInstance (
 {
   EFI_STATUS Status;
 
+  MmcAsyncAbort (MmcHostInstance, EFI_ABORTED);
+  gBS->CloseEvent (MmcHostInstance->AsyncEvent);
+  MmcCacheDestroy (MmcHostInstance);
+
   // Uninstall Protocol Interfaces
   Status = gBS->UninstallMultipleProtocolInterfaces (
                   MmcHostInstance->MmcHandle,
                   &gEfiBlockIoProtocolGuid, &(MmcHostInstance->BlockIo),
+                  &gEfiBlockIo2ProtocolGuid, &(MmcHostInstance->BlockIo2),
                   &gEfiDevicePathProtocolGuid, MmcHostInstance->DevicePath,
                   NULL
                 );
@@ -366,6 +395,7 @@ CheckCardsCallback (
       MmcHostInstance->State = MmcHwInitializationState;
       MmcHostInstance->BlockIo.Media->MediaPresent = !MmcHostInstance->Initialized;
       MmcHostInstance->Initialized = !MmcHostInstance->Initialized;
+      MmcCacheFlush (MmcHostInstance);
 
       if (MmcHostInstance->BlockIo.Media->MediaPresent) {
         Status = InitializeMmcDevice (MmcHostInstance);
@@ -373,6 +403,8 @@ CheckCardsCallback (
           MmcHostInstance->Initialized = !MmcHostInstance->Initialized;
           continue;
         }
+      } else {
+        MmcAsyncAbort (MmcHostInstance, EFI_NO_MEDIA);
       }
 
       Status = gBS->ReinstallProtocolInterface (
@@ -385,6 +417,17 @@ CheckCardsCallback (
       if (EFI_ERROR (Status)) {
         Print (L"MMC Card: Error reinstalling BlockIo interface\n");
       }
+
+      Status = gBS->ReinstallProtocolInterface (
+                      (MmcHostInstance->MmcHandle),
+                      &gEfiBlockIo2ProtocolGuid,
+                      &(MmcHostInstance->BlockIo2),
+                      &(MmcHostInstance->BlockIo2)
+                    );
+
+      if (EFI_ERROR (Status)) {
+        Print (L"MMC Card: Error reinstalling BlockIo2 interface\n");
+      }
     }
 
     CurrentLink = CurrentLink->ForwardLink;
@@ -401,6 +444,26 @@ EFI_DRIVER_BINDING_PROTOCOL gMmcDriverBinding = {
   NULL
 };
 
+/**
+  Drop the read caches, the OS owns the cards from now on.
+**/
+STATIC
+VOID
+EFIAPI
+MmcExitBootServicesNotify (
+  IN  EFI_EVENT   Event,
+  IN  VOID        *Context
+  )
+{
+  LIST_ENTRY          *CurrentLink;
+
+  for (CurrentLink = mMmcHostPool.ForwardLink;
+       CurrentLink != &mMmcHostPool;
+       CurrentLink = CurrentLink->ForwardLink) {
+    MmcCacheFlush (MMC_HOST_INSTANCE_FROM_LINK (CurrentLink));
+  }
+}
+
 /**
 
 **/
@@ -455,5 +518,14 @@ MmcDxeInitialize (
                   (UINT64)(10 * 1000 * 200)); // 200 ms
   ASSERT_EFI_ERROR (Status);
 
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_CALLBACK,
+                  MmcExitBootServicesNotify,
+                  NULL,
+                  &mExitBootServicesEvent
+                );
+  ASSERT_EFI_ERROR (Status);
+
   return Status;
 }
@@ -15,6 +15,7 @@
 
 #include <Protocol/DiskIo.h>
 #include <Protocol/BlockIo.h>
+#include <Protocol/BlockIo2.h>
 #include <Protocol/DevicePath.h>
 #include <Protocol/RpiMmcHost.h>
 
@@ -26,6 +27,18 @@
 
 #define MMC_IOBLOCKS_READ       0
 #define MMC_IOBLOCKS_WRITE      1
+#define MMC_IOBLOCKS_FLUSH      2
+
+//
+// Largest multi-block transfer, the block count of CMD23 is 16 bits wide.
+//
+#define MMC_MAX_BLOCK_COUNT     0xFFFF
+
+//
+// Blocks moved by the BlockIo2 queue per timer tick, so that the caller gets
+// the CPU back between the chunks of a large request.
+//
+#define MMC_ASYNC_CHUNK_BLOCKS  2048
 
 #define MMC_OCR_POWERUP             0x80000000
 
@@ -328,8 +341,45 @@ typedef struct {
   CID       CIDData;
   CSD       CSDData;
   ECSD      *ECSDData;                         // MMC V4 extended card specific
+  BOOLEAN   SetBlockCount;                     // CMD23 supported
 } CARD_INFO;
 
+//
+// Request queued on the BlockIo2 interface. Lba, BufferSize and Buffer move
+// along as the chunks complete.
+//
+typedef struct {
+  LIST_ENTRY                Link;
+  EFI_BLOCK_IO2_TOKEN       *Token;
+  UINTN                     Transfer;
+  UINT32                    MediaId;
+  EFI_LBA                   Lba;
+  UINTN                     BufferSize;
+  UINT8                     *Buffer;
+} MMC_ASYNC_REQUEST;
+
+#define MMC_ASYNC_REQUEST_FROM_LINK(a)              BASE_CR (a, MMC_ASYNC_REQUEST, Link)
+
+//
+// Read-ahead cache, the lines are aligned on their size.
+//
+typedef struct {
+  EFI_LBA                   Lba;              // First block of the line
+  UINTN                     Blocks;           // Valid blocks, 0 if unused
+  UINT32                    MediaId;
+  UINT64                    LastUse;
+  UINT8                     *Data;
+} MMC_CACHE_LINE;
+
+typedef struct {
+  MMC_CACHE_LINE            *Lines;
+  UINTN                     LineCount;
+  UINTN                     LineBlocks;
+  UINT32                    BlockSize;
+  UINT64                    Clock;
+  UINT8                     *Data;
+} MMC_READ_CACHE;
+
 typedef struct _MMC_HOST_INSTANCE {
   UINTN                     Signature;
   LIST_ENTRY                Link;
@@ -338,14 +388,21 @@ typedef struct _MMC_HOST_INSTANCE {
 
   MMC_STATE                 State;
   EFI_BLOCK_IO_PROTOCOL     BlockIo;
+  EFI_BLOCK_IO2_PROTOCOL    BlockIo2;
   CARD_INFO                 CardInfo;
   EFI_MMC_HOST_PROTOCOL     *MmcHost;
 
   BOOLEAN                   Initialized;
+
+  LIST_ENTRY                AsyncQueue;
+  EFI_EVENT                 AsyncEvent;
+
+  MMC_READ_CACHE            Cache;
 } MMC_HOST_INSTANCE;
 
 #define MMC_HOST_INSTANCE_SIGNATURE                 SIGNATURE_32('m', 'm', 'c', 'h')
 #define MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS(a)     CR (a, MMC_HOST_INSTANCE, BlockIo, MMC_HOST_INSTANCE_SIGNATURE)
+#define MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS(a)    CR (a, MMC_HOST_INSTANCE, BlockIo2, MMC_HOST_INSTANCE_SIGNATURE)
 #define MMC_HOST_INSTANCE_FROM_LINK(a)              CR (a, MMC_HOST_INSTANCE, Link, MMC_HOST_INSTANCE_SIGNATURE)
 
 
@@ -481,6 +538,192 @@ MmcFlushBlocks (
   IN EFI_BLOCK_IO_PROTOCOL  *This
   );
 
+/**
+  Reset the block device, the pending BlockIo2 requests are aborted.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.Reset().
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  ExtendedVerification   Indicates that the driver may perform a more exhaustive
+                                 verification operation of the device during reset.
+
+  @retval EFI_SUCCESS            The block device was reset.
+  @retval EFI_DEVICE_ERROR       The block device is not functioning correctly and could not be reset.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcReset2 (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN BOOLEAN                  ExtendedVerification
+  );
+
+/**
+  Reads the requested number of blocks from the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.ReadBlocksEx(). With a
+  token carrying an event the request is queued and the event is signaled
+  once it completes, otherwise it behaves like MmcReadBlocks().
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the read request is for.
+  @param  Lba                    The starting logical block address to read from on the device.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS            The read request was queued if Token->Event is not NULL,
+                                 or the data was read correctly from the device.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the read operation.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic block size of the device.
+  @retval EFI_INVALID_PARAMETER  The read request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  );
+
+/**
+  Writes a specified number of blocks to the device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.WriteBlocksEx(), see
+  MmcReadBlocksEx() for the handling of the token.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  MediaId                The media ID that the write request is for.
+  @param  Lba                    The starting logical block address to be written.
+  @param  Token                  A pointer to the token associated with the transaction.
+  @param  BufferSize             The size of the Buffer in bytes.
+                                 This must be a multiple of the intrinsic block size of the device.
+  @param  Buffer                 Pointer to the source buffer for the data.
+
+  @retval EFI_SUCCESS            The write request was queued if Token->Event is not NULL,
+                                 or the data were written correctly to the device.
+  @retval EFI_WRITE_PROTECTED    The device cannot be written to.
+  @retval EFI_NO_MEDIA           There is no media in the device.
+  @retval EFI_MEDIA_CHANGED      The MediaId is not for the current media.
+  @retval EFI_DEVICE_ERROR       The device reported an error while attempting to perform the write operation.
+  @retval EFI_BAD_BUFFER_SIZE    The BufferSize parameter is not a multiple of the intrinsic
+                                 block size of the device.
+  @retval EFI_INVALID_PARAMETER  The write request contains LBAs that are not valid,
+                                 or the buffer is not on proper alignment.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  );
+
+/**
+  Flushes all modified data to a physical block device.
+
+  This function implements EFI_BLOCK_IO2_PROTOCOL.FlushBlocksEx(). The
+  flush completes once the requests queued before it have completed.
+
+  @param  This                   Indicates a pointer to the calling context.
+  @param  Token                  A pointer to the token associated with the transaction.
+
+  @retval EFI_SUCCESS            The flush request was queued if Token->Event is not NULL,
+                                 or all outstanding data were written to the device.
+  @retval EFI_OUT_OF_RESOURCES   The request could not be queued.
+
+**/
+EFI_STATUS
+EFIAPI
+MmcFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  );
+
+/**
+  Complete all the pending BlockIo2 requests with the given status.
+
+  @param  MmcHostInstance        The instance whose queue is flushed.
+  @param  Status                 The TransactionStatus of the aborted requests.
+
+**/
+VOID
+MmcAsyncAbort (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_STATUS             Status
+  );
+
+VOID
+EFIAPI
+MmcAsyncNotify (
+  IN  EFI_EVENT   Event,
+  IN  VOID        *Context
+  );
+
+/**
+  Transfer blocks to or from the card, bypassing the read cache.
+
+  The request must have been validated and the caller must be running at
+  TPL_CALLBACK.
+
+  @param  MmcHostInstance        The instance to transfer with.
+  @param  Transfer               MMC_IOBLOCKS_READ or MMC_IOBLOCKS_WRITE.
+  @param  MediaId                The media ID that the request is for.
+  @param  Lba                    The starting logical block address.
+  @param  BufferSize             The size of the Buffer in bytes.
+  @param  Buffer                 The data buffer.
+
+**/
+EFI_STATUS
+MmcTransferBlocks (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN UINTN                  Transfer,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  );
+
+EFI_STATUS
+MmcCacheRead (
+  IN  MMC_HOST_INSTANCE     *MmcHostInstance,
+  IN  UINT32                MediaId,
+  IN  EFI_LBA               Lba,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  );
+
+VOID
+MmcCacheInvalidate (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_LBA                Lba,
+  IN UINTN                  Blocks
+  );
+
+VOID
+MmcCacheFlush (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  );
+
+VOID
+MmcCacheDestroy (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  );
+
 EFI_STATUS
 MmcNotifyState (
   IN MMC_HOST_INSTANCE      *MmcHostInstance,
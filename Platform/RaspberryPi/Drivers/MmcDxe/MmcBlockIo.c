@@ -7,6 +7,7 @@
  **/
 
 #include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
 
 #include "Mmc.h"
 
@@ -167,6 +168,8 @@ MmcReset (
     return EFI_SUCCESS;
   }
 
+  MmcCacheFlush (MmcHostInstance);
+
   // If a card is not present then clear all media settings
   if (!MmcHostInstance->MmcHost->IsCardPresent (MmcHostInstance->MmcHost)) {
     MmcHostInstance->BlockIo.Media->MediaPresent = FALSE;
@@ -213,6 +216,24 @@ MmcStopTransmission (
   return Status;
 }
 
+STATIC
+EFI_STATUS
+MmcSetBlockCount (
+  EFI_MMC_HOST_PROTOCOL *MmcHost,
+  UINTN                 BlockCount
+  )
+{
+  EFI_STATUS              Status;
+  UINT32                  Response[4];
+
+  // Command 23 - Set block count, the next CMD18/CMD25 stops on its own
+  Status = MmcHost->SendCommand (MmcHost, MMC_CMD23, (UINT32)BlockCount);
+  if (!EFI_ERROR (Status)) {
+    Status = MmcHost->ReceiveResponse (MmcHost, MMC_RESPONSE_TYPE_R1, Response);
+  }
+  return Status;
+}
+
 STATIC
 EFI_STATUS
 MmcTransferBlock (
@@ -223,6 +244,7 @@ MmcTransferBlock (
   IN EFI_LBA                  Lba,
   IN UINTN                    BufferSize,
   OUT VOID                    *Buffer,
+  IN BOOLEAN                  PreDefined,
   OUT UINTN                   *TransferredSize
   )
 {
@@ -262,10 +284,10 @@ MmcTransferBlock (
   }
 
   if (EFI_ERROR (Status) ||
-      BufferSize > This->Media->BlockSize) {
+      (BufferSize > This->Media->BlockSize && !PreDefined)) {
     /*
-     * CMD12 needs to be set for multiblock (to transition from
-     * RECV to PROG) or for errors.
+     * CMD12 needs to be set for open-ended multiblock (to transition
+     * from RECV to PROG) or for errors.
      */
     EFI_STATUS Status2 = MmcStopTransmission (MmcHost);
     if (EFI_ERROR (Status2)) {
@@ -314,55 +336,58 @@ MmcTransferBlock (
   return Status;
 }
 
+STATIC
+UINTN
+MmcMaxBlockCount (
+  IN MMC_HOST_INSTANCE        *MmcHostInstance
+  )
+{
+  EFI_MMC_HOST_PROTOCOL   *MmcHost;
+
+  MmcHost = MmcHostInstance->MmcHost;
+  if (PcdGet32 (PcdMmcDisableMulti) == 0 &&
+      MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
+      MmcHost->IsMultiBlock (MmcHost)) {
+    return MMC_MAX_BLOCK_COUNT;
+  }
+
+  return 1;
+}
+
+STATIC
 EFI_STATUS
-MmcIoBlocks (
-  IN EFI_BLOCK_IO_PROTOCOL    *This,
+MmcValidateIo (
+  IN MMC_HOST_INSTANCE        *MmcHostInstance,
   IN UINTN                    Transfer,
   IN UINT32                   MediaId,
   IN EFI_LBA                  Lba,
   IN UINTN                    BufferSize,
-  OUT VOID                    *Buffer
+  IN VOID                     *Buffer
   )
 {
-  EFI_STATUS              Status;
-  UINTN                   Cmd;
-  MMC_HOST_INSTANCE       *MmcHostInstance;
-  EFI_MMC_HOST_PROTOCOL   *MmcHost;
-  UINTN                   BytesRemainingToBeTransfered;
-  UINTN                   BlockCount;
-  UINTN                   ConsumeSize;
+  EFI_BLOCK_IO_MEDIA      *Media;
 
-  BlockCount = 1;
-  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
-  ASSERT (MmcHostInstance != NULL);
-  MmcHost = MmcHostInstance->MmcHost;
-  ASSERT (MmcHost);
+  Media = MmcHostInstance->BlockIo.Media;
 
-  if (This->Media->MediaId != MediaId) {
+  if (Media->MediaId != MediaId) {
     return EFI_MEDIA_CHANGED;
   }
 
-  if ((MmcHost == NULL) || (Buffer == NULL)) {
+  if ((MmcHostInstance->MmcHost == NULL) || (Buffer == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
 
   // Check if a Card is Present
-  if (!MmcHostInstance->BlockIo.Media->MediaPresent) {
+  if (!Media->MediaPresent) {
     return EFI_NO_MEDIA;
   }
 
-  if (PcdGet32 (PcdMmcDisableMulti) == 0 &&
-      MMC_HOST_HAS_ISMULTIBLOCK (MmcHost) &&
-      MmcHost->IsMultiBlock (MmcHost)) {
-    BlockCount = (BufferSize + This->Media->BlockSize - 1) / This->Media->BlockSize;
-  }
-
   // All blocks must be within the device
-  if ((Lba + (BufferSize / This->Media->BlockSize)) > (This->Media->LastBlock + 1)) {
+  if ((Lba + (BufferSize / Media->BlockSize)) > (Media->LastBlock + 1)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  if ((Transfer == MMC_IOBLOCKS_WRITE) && (This->Media->ReadOnly == TRUE)) {
+  if ((Transfer == MMC_IOBLOCKS_WRITE) && (Media->ReadOnly == TRUE)) {
     return EFI_WRITE_PROTECTED;
   }
 
@@ -372,60 +397,167 @@ MmcIoBlocks (
   }
 
   // The buffer size must be an exact multiple of the block size
-  if ((BufferSize % This->Media->BlockSize) != 0) {
+  if ((BufferSize % Media->BlockSize) != 0) {
     return EFI_BAD_BUFFER_SIZE;
   }
 
   // Check the alignment
-  if ((This->Media->IoAlign > 2) && (((UINTN)Buffer & (This->Media->IoAlign - 1)) != 0)) {
+  if ((Media->IoAlign > 2) && (((UINTN)Buffer & (Media->IoAlign - 1)) != 0)) {
     return EFI_INVALID_PARAMETER;
   }
 
-  BytesRemainingToBeTransfered = BufferSize;
-  while (BytesRemainingToBeTransfered > 0) {
-    Status = WaitUntilTran (MmcHostInstance);
-    if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
-      return Status;
-    }
+  return EFI_SUCCESS;
+}
 
-    if (Transfer == MMC_IOBLOCKS_READ) {
-      if (BlockCount == 1) {
-        // Read a single block
-        Cmd = MMC_CMD17;
-      } else {
-        // Read multiple blocks
-        Cmd = MMC_CMD18;
-      }
+/*
+ * Move up to MaxBlocks blocks with a single command, pre-defined
+ * with CMD23 when the card supports it so that no CMD12 is needed.
+ */
+STATIC
+EFI_STATUS
+MmcIoChunk (
+  IN MMC_HOST_INSTANCE        *MmcHostInstance,
+  IN UINTN                    Transfer,
+  IN UINT32                   MediaId,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    BufferSize,
+  IN VOID                     *Buffer,
+  IN UINTN                    MaxBlocks,
+  OUT UINTN                   *TransferredSize
+  )
+{
+  EFI_STATUS              Status;
+  EFI_BLOCK_IO_PROTOCOL   *This;
+  UINTN                   Cmd;
+  UINTN                   BlockCount;
+  BOOLEAN                 PreDefined;
+
+  This = &MmcHostInstance->BlockIo;
+  BlockCount = BufferSize / This->Media->BlockSize;
+  if (BlockCount > MaxBlocks) {
+    BlockCount = MaxBlocks;
+  }
+
+  Status = WaitUntilTran (MmcHostInstance);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "WaitUntilTran before IO failed"));
+    return Status;
+  }
+
+  if (Transfer == MMC_IOBLOCKS_READ) {
+    if (BlockCount == 1) {
+      // Read a single block
+      Cmd = MMC_CMD17;
     } else {
-      if (BlockCount == 1) {
-        // Write a single block
-        Cmd = MMC_CMD24;
-      } else {
-        // Write multiple blocks
-        Cmd = MMC_CMD25;
-      }
+      // Read multiple blocks
+      Cmd = MMC_CMD18;
     }
-
-    ConsumeSize = BlockCount * This->Media->BlockSize;
-    if (BytesRemainingToBeTransfered < ConsumeSize) {
-      ConsumeSize = BytesRemainingToBeTransfered;
+  } else {
+    if (BlockCount == 1) {
+      // Write a single block
+      Cmd = MMC_CMD24;
+    } else {
+      // Write multiple blocks
+      Cmd = MMC_CMD25;
     }
+  }
+
+  if (Transfer == MMC_IOBLOCKS_WRITE) {
+    MmcCacheInvalidate (MmcHostInstance, Lba, BlockCount);
+  }
 
-    Status = MmcTransferBlock (This, Cmd, Transfer, MediaId, Lba, ConsumeSize, Buffer, &ConsumeSize);
+  PreDefined = FALSE;
+  if (BlockCount > 1 && MmcHostInstance->CardInfo.SetBlockCount) {
+    Status = MmcSetBlockCount (MmcHostInstance->MmcHost, BlockCount);
     if (EFI_ERROR (Status)) {
-      DEBUG ((DEBUG_ERROR, "%a(): Failed to transfer block and Status:%r\n", __func__, Status));
-      return Status;
+      DEBUG ((DEBUG_WARN, "%a(): CMD23 failed (%r), using CMD12\n", __func__, Status));
+      MmcHostInstance->CardInfo.SetBlockCount = FALSE;
+    } else {
+      PreDefined = TRUE;
     }
+  }
+
+  Status = MmcTransferBlock (This, Cmd, Transfer, MediaId, Lba,
+             BlockCount * This->Media->BlockSize, Buffer, PreDefined,
+             TransferredSize);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a(): Failed to transfer block and Status:%r\n", __func__, Status));
+  }
+
+  return Status;
+}
+
+EFI_STATUS
+MmcTransferBlocks (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN UINTN                  Transfer,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  UINTN                   MaxBlocks;
+  UINTN                   ConsumeSize;
+
+  MaxBlocks = MmcMaxBlockCount (MmcHostInstance);
 
-    BytesRemainingToBeTransfered -= ConsumeSize;
-    if (BytesRemainingToBeTransfered > 0) {
-      Lba += BlockCount;
-      Buffer = (UINT8*)Buffer + ConsumeSize;
+  Status = EFI_SUCCESS;
+  while (BufferSize > 0) {
+    Status = MmcIoChunk (MmcHostInstance, Transfer, MediaId, Lba, BufferSize,
+               Buffer, MaxBlocks, &ConsumeSize);
+    if (EFI_ERROR (Status)) {
+      break;
     }
+
+    BufferSize -= ConsumeSize;
+    Lba += ConsumeSize / MmcHostInstance->BlockIo.Media->BlockSize;
+    Buffer = (UINT8*)Buffer + ConsumeSize;
   }
 
-  return EFI_SUCCESS;
+  return Status;
+}
+
+EFI_STATUS
+MmcIoBlocks (
+  IN EFI_BLOCK_IO_PROTOCOL    *This,
+  IN UINTN                    Transfer,
+  IN UINT32                   MediaId,
+  IN EFI_LBA                  Lba,
+  IN UINTN                    BufferSize,
+  OUT VOID                    *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+  EFI_TPL                 OldTpl;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO_THIS (This);
+  ASSERT (MmcHostInstance != NULL);
+  ASSERT (MmcHostInstance->MmcHost);
+
+  Status = MmcValidateIo (MmcHostInstance, Transfer, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status) || BufferSize == 0) {
+    return Status;
+  }
+
+  //
+  // Keep the card to ourselves, the BlockIo2 queue is serviced at
+  // TPL_CALLBACK.
+  //
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  Status = EFI_UNSUPPORTED;
+  if (Transfer == MMC_IOBLOCKS_READ) {
+    Status = MmcCacheRead (MmcHostInstance, MediaId, Lba, BufferSize, Buffer);
+  }
+  if (Status == EFI_UNSUPPORTED) {
+    Status = MmcTransferBlocks (MmcHostInstance, Transfer, MediaId, Lba,
+               BufferSize, Buffer);
+  }
+  gBS->RestoreTPL (OldTpl);
+
+  return Status;
 }
 
 EFI_STATUS
@@ -462,3 +594,269 @@ MmcFlushBlocks (
 {
   return EFI_SUCCESS;
 }
+
+STATIC
+VOID
+MmcAsyncComplete (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN MMC_ASYNC_REQUEST      *Request,
+  IN EFI_STATUS             Status
+  )
+{
+  RemoveEntryList (&Request->Link);
+  if (IsListEmpty (&MmcHostInstance->AsyncQueue)) {
+    gBS->SetTimer (MmcHostInstance->AsyncEvent, TimerCancel, 0);
+  }
+
+  Request->Token->TransactionStatus = Status;
+  gBS->SignalEvent (Request->Token->Event);
+  FreePool (Request);
+}
+
+/*
+ * Move the next chunk of the request at the head of the queue,
+ * must be called at TPL_CALLBACK.
+ */
+STATIC
+VOID
+MmcAsyncService (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  EFI_STATUS              Status;
+  MMC_ASYNC_REQUEST       *Request;
+  EFI_BLOCK_IO_MEDIA      *Media;
+  UINTN                   MaxBlocks;
+  UINTN                   ConsumeSize;
+
+  if (IsListEmpty (&MmcHostInstance->AsyncQueue)) {
+    return;
+  }
+
+  Request = MMC_ASYNC_REQUEST_FROM_LINK (GetFirstNode (&MmcHostInstance->AsyncQueue));
+  if (Request->Transfer == MMC_IOBLOCKS_FLUSH) {
+    MmcAsyncComplete (MmcHostInstance, Request, EFI_SUCCESS);
+    return;
+  }
+
+  // The card may have been pulled or swapped since the request was queued
+  Media = MmcHostInstance->BlockIo.Media;
+  if (!Media->MediaPresent) {
+    MmcAsyncComplete (MmcHostInstance, Request, EFI_NO_MEDIA);
+    return;
+  }
+
+  if (Media->MediaId != Request->MediaId) {
+    MmcAsyncComplete (MmcHostInstance, Request, EFI_MEDIA_CHANGED);
+    return;
+  }
+
+  MaxBlocks = MIN (MmcMaxBlockCount (MmcHostInstance), MMC_ASYNC_CHUNK_BLOCKS);
+  Status = MmcIoChunk (MmcHostInstance, Request->Transfer, Request->MediaId,
+             Request->Lba, Request->BufferSize, Request->Buffer, MaxBlocks,
+             &ConsumeSize);
+  if (EFI_ERROR (Status)) {
+    MmcAsyncComplete (MmcHostInstance, Request, Status);
+    return;
+  }
+
+  Request->BufferSize -= ConsumeSize;
+  Request->Lba += ConsumeSize / Media->BlockSize;
+  Request->Buffer += ConsumeSize;
+  if (Request->BufferSize == 0) {
+    MmcAsyncComplete (MmcHostInstance, Request, EFI_SUCCESS);
+  }
+}
+
+VOID
+EFIAPI
+MmcAsyncNotify (
+  IN  EFI_EVENT   Event,
+  IN  VOID        *Context
+  )
+{
+  MmcAsyncService ((MMC_HOST_INSTANCE *)Context);
+}
+
+/*
+ * Complete everything queued so far, so that a blocking request
+ * doesn't overtake the ones queued before it.
+ */
+STATIC
+VOID
+MmcAsyncDrain (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  EFI_TPL                 OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  while (!IsListEmpty (&MmcHostInstance->AsyncQueue)) {
+    MmcAsyncService (MmcHostInstance);
+  }
+  gBS->RestoreTPL (OldTpl);
+}
+
+VOID
+MmcAsyncAbort (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_STATUS             Status
+  )
+{
+  EFI_TPL                 OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  while (!IsListEmpty (&MmcHostInstance->AsyncQueue)) {
+    MmcAsyncComplete (MmcHostInstance,
+      MMC_ASYNC_REQUEST_FROM_LINK (GetFirstNode (&MmcHostInstance->AsyncQueue)),
+      Status);
+  }
+  gBS->RestoreTPL (OldTpl);
+}
+
+STATIC
+EFI_STATUS
+MmcAsyncQueue (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_BLOCK_IO2_TOKEN    *Token,
+  IN UINTN                  Transfer,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba,
+  IN UINTN                  BufferSize,
+  IN VOID                   *Buffer
+  )
+{
+  MMC_ASYNC_REQUEST       *Request;
+  EFI_TPL                 OldTpl;
+
+  Request = AllocatePool (sizeof (MMC_ASYNC_REQUEST));
+  if (Request == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Request->Token = Token;
+  Request->Transfer = Transfer;
+  Request->MediaId = MediaId;
+  Request->Lba = Lba;
+  Request->BufferSize = BufferSize;
+  Request->Buffer = Buffer;
+  Token->TransactionStatus = EFI_NOT_READY;
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  if (IsListEmpty (&MmcHostInstance->AsyncQueue)) {
+    // Service the queue on every timer tick until it drains
+    gBS->SetTimer (MmcHostInstance->AsyncEvent, TimerPeriodic, 0);
+  }
+  InsertTailList (&MmcHostInstance->AsyncQueue, &Request->Link);
+  gBS->RestoreTPL (OldTpl);
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+EFI_STATUS
+MmcIoBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINTN                  Transfer,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+
+  if (Token == NULL || Token->Event == NULL) {
+    MmcAsyncDrain (MmcHostInstance);
+    return MmcIoBlocks (&MmcHostInstance->BlockIo, Transfer, MediaId, Lba,
+             BufferSize, Buffer);
+  }
+
+  Status = MmcValidateIo (MmcHostInstance, Transfer, MediaId, Lba, BufferSize, Buffer);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (BufferSize == 0) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+    return EFI_SUCCESS;
+  }
+
+  return MmcAsyncQueue (MmcHostInstance, Token, Transfer, MediaId, Lba,
+           BufferSize, Buffer);
+}
+
+EFI_STATUS
+EFIAPI
+MmcReset2 (
+  IN EFI_BLOCK_IO2_PROTOCOL   *This,
+  IN BOOLEAN                  ExtendedVerification
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+  MmcAsyncAbort (MmcHostInstance, EFI_ABORTED);
+
+  return MmcReset (&MmcHostInstance->BlockIo, ExtendedVerification);
+}
+
+EFI_STATUS
+EFIAPI
+MmcReadBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  OUT    VOID                   *Buffer
+  )
+{
+  return MmcIoBlocksEx (This, MMC_IOBLOCKS_READ, MediaId, Lba, Token, BufferSize, Buffer);
+}
+
+EFI_STATUS
+EFIAPI
+MmcWriteBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN     UINT32                 MediaId,
+  IN     EFI_LBA                Lba,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token,
+  IN     UINTN                  BufferSize,
+  IN     VOID                   *Buffer
+  )
+{
+  return MmcIoBlocksEx (This, MMC_IOBLOCKS_WRITE, MediaId, Lba, Token, BufferSize, Buffer);
+}
+
+EFI_STATUS
+EFIAPI
+MmcFlushBlocksEx (
+  IN     EFI_BLOCK_IO2_PROTOCOL *This,
+  IN OUT EFI_BLOCK_IO2_TOKEN    *Token
+  )
+{
+  MMC_HOST_INSTANCE       *MmcHostInstance;
+
+  MmcHostInstance = MMC_HOST_INSTANCE_FROM_BLOCK_IO2_THIS (This);
+
+  if (Token == NULL || Token->Event == NULL) {
+    MmcAsyncDrain (MmcHostInstance);
+    return EFI_SUCCESS;
+  }
+
+  // The writes complete synchronously, only wait for the queued ones
+  if (IsListEmpty (&MmcHostInstance->AsyncQueue)) {
+    Token->TransactionStatus = EFI_SUCCESS;
+    gBS->SignalEvent (Token->Event);
+    return EFI_SUCCESS;
+  }
+
+  return MmcAsyncQueue (MmcHostInstance, Token, MMC_IOBLOCKS_FLUSH,
+           MmcHostInstance->BlockIo.Media->MediaId, 0, 0, NULL);
+}
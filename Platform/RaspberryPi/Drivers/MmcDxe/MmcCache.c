@@ -0,0 +1,276 @@
+/** @file
+ *
+ *  Read-ahead sector cache of the MMC block devices.
+ *
+ *  The small reads of a FAT walk are served from a few lines of
+ *  PcdMmcReadCacheBlocks blocks, each filled with one multi-block
+ *  transfer and recycled in LRU order. The cache only ever holds
+ *  clean data, writes drop the lines they overlap.
+ *
+ *  Copyright (c) 2020, ARM Limited. All rights reserved.
+ *
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include "Mmc.h"
+
+STATIC
+VOID
+MmcCacheFree (
+  IN MMC_READ_CACHE         *Cache
+  )
+{
+  if (Cache->Data != NULL) {
+    FreePages (Cache->Data,
+      EFI_SIZE_TO_PAGES (Cache->LineCount * Cache->LineBlocks * Cache->BlockSize));
+  }
+  if (Cache->Lines != NULL) {
+    FreePool (Cache->Lines);
+  }
+  ZeroMem (Cache, sizeof (MMC_READ_CACHE));
+}
+
+/*
+ * Allocate the lines for the block size of the current media,
+ * FALSE if the cache is disabled or can't be set up.
+ */
+STATIC
+BOOLEAN
+MmcCacheSetup (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  MMC_READ_CACHE          *Cache;
+  UINT32                  BlockSize;
+  UINTN                   Index;
+
+  Cache = &MmcHostInstance->Cache;
+  BlockSize = MmcHostInstance->BlockIo.Media->BlockSize;
+
+  if (Cache->Lines != NULL) {
+    if (Cache->BlockSize == BlockSize) {
+      return TRUE;
+    }
+    MmcCacheFree (Cache);
+  }
+
+  Cache->LineBlocks = MIN (PcdGet32 (PcdMmcReadCacheBlocks), MMC_MAX_BLOCK_COUNT);
+  Cache->LineCount = PcdGet32 (PcdMmcReadCacheLines);
+  if (Cache->LineBlocks == 0 || Cache->LineCount == 0) {
+    return FALSE;
+  }
+
+  Cache->BlockSize = BlockSize;
+  Cache->Lines = AllocateZeroPool (Cache->LineCount * sizeof (MMC_CACHE_LINE));
+  Cache->Data = AllocatePages (
+                  EFI_SIZE_TO_PAGES (Cache->LineCount * Cache->LineBlocks * BlockSize));
+  if (Cache->Lines == NULL || Cache->Data == NULL) {
+    DEBUG ((DEBUG_WARN, "%a(): No memory for the read cache\n", __func__));
+    MmcCacheFree (Cache);
+    return FALSE;
+  }
+
+  for (Index = 0; Index < Cache->LineCount; Index++) {
+    Cache->Lines[Index].Data = Cache->Data + Index * Cache->LineBlocks * BlockSize;
+  }
+
+  return TRUE;
+}
+
+STATIC
+MMC_CACHE_LINE *
+MmcCacheLookup (
+  IN MMC_READ_CACHE         *Cache,
+  IN UINT32                 MediaId,
+  IN EFI_LBA                Lba
+  )
+{
+  UINTN                   Index;
+  MMC_CACHE_LINE          *Line;
+
+  for (Index = 0; Index < Cache->LineCount; Index++) {
+    Line = &Cache->Lines[Index];
+    if (Line->Blocks != 0 && Line->Lba == Lba && Line->MediaId == MediaId) {
+      return Line;
+    }
+  }
+
+  return NULL;
+}
+
+STATIC
+EFI_STATUS
+MmcCacheFill (
+  IN  MMC_HOST_INSTANCE     *MmcHostInstance,
+  IN  UINT32                MediaId,
+  IN  EFI_LBA               Lba,
+  OUT MMC_CACHE_LINE        **Line
+  )
+{
+  EFI_STATUS              Status;
+  MMC_READ_CACHE          *Cache;
+  MMC_CACHE_LINE          *Victim;
+  UINTN                   Index;
+  UINTN                   Blocks;
+
+  Cache = &MmcHostInstance->Cache;
+
+  // The unused lines have never been touched, they go first
+  Victim = &Cache->Lines[0];
+  for (Index = 1; Index < Cache->LineCount; Index++) {
+    if (Cache->Lines[Index].LastUse < Victim->LastUse) {
+      Victim = &Cache->Lines[Index];
+    }
+  }
+
+  // The last line stops at the end of the device
+  Blocks = (UINTN)MIN ((UINT64)Cache->LineBlocks,
+                       MmcHostInstance->BlockIo.Media->LastBlock + 1 - Lba);
+
+  Victim->Blocks = 0;
+  Status = MmcTransferBlocks (MmcHostInstance, MMC_IOBLOCKS_READ, MediaId, Lba,
+             Blocks * Cache->BlockSize, Victim->Data);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Victim->Lba = Lba;
+  Victim->Blocks = Blocks;
+  Victim->MediaId = MediaId;
+  *Line = Victim;
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Read blocks through the read-ahead cache.
+
+  The request must have been validated and the caller must be running at
+  TPL_CALLBACK.
+
+  @param  MmcHostInstance        The instance to read from.
+  @param  MediaId                The media ID that the read request is for.
+  @param  Lba                    The starting logical block address to read from.
+  @param  BufferSize             The size of the Buffer in bytes.
+  @param  Buffer                 A pointer to the destination buffer for the data.
+
+  @retval EFI_SUCCESS            The data was read correctly.
+  @retval EFI_UNSUPPORTED        The cache is disabled or the request is too
+                                 large to benefit from it, read the card directly.
+  @retval Others                 Filling a cache line failed.
+
+**/
+EFI_STATUS
+MmcCacheRead (
+  IN  MMC_HOST_INSTANCE     *MmcHostInstance,
+  IN  UINT32                MediaId,
+  IN  EFI_LBA               Lba,
+  IN  UINTN                 BufferSize,
+  OUT VOID                  *Buffer
+  )
+{
+  EFI_STATUS              Status;
+  MMC_READ_CACHE          *Cache;
+  MMC_CACHE_LINE          *Line;
+  UINT32                  Offset;
+  UINTN                   Count;
+
+  Cache = &MmcHostInstance->Cache;
+  if (!MmcCacheSetup (MmcHostInstance) ||
+      BufferSize >= Cache->LineBlocks * Cache->BlockSize) {
+    return EFI_UNSUPPORTED;
+  }
+
+  while (BufferSize > 0) {
+    DivU64x32Remainder (Lba, (UINT32)Cache->LineBlocks, &Offset);
+
+    Line = MmcCacheLookup (Cache, MediaId, Lba - Offset);
+    if (Line == NULL) {
+      Status = MmcCacheFill (MmcHostInstance, MediaId, Lba - Offset, &Line);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+    Line->LastUse = ++Cache->Clock;
+
+    Count = MIN (Line->Blocks - Offset, BufferSize / Cache->BlockSize);
+    CopyMem (Buffer, Line->Data + Offset * Cache->BlockSize, Count * Cache->BlockSize);
+
+    BufferSize -= Count * Cache->BlockSize;
+    Lba += Count;
+    Buffer = (UINT8 *)Buffer + Count * Cache->BlockSize;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Drop the cache lines overlapping a range of blocks.
+
+  @param  MmcHostInstance        The instance being written.
+  @param  Lba                    The first block of the range.
+  @param  Blocks                 The number of blocks of the range.
+
+**/
+VOID
+MmcCacheInvalidate (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance,
+  IN EFI_LBA                Lba,
+  IN UINTN                  Blocks
+  )
+{
+  MMC_READ_CACHE          *Cache;
+  MMC_CACHE_LINE          *Line;
+  UINTN                   Index;
+
+  Cache = &MmcHostInstance->Cache;
+  for (Index = 0; Index < Cache->LineCount; Index++) {
+    Line = &Cache->Lines[Index];
+    if (Line->Blocks != 0 &&
+        Line->Lba < Lba + Blocks &&
+        Lba < Line->Lba + Line->Blocks) {
+      Line->Blocks = 0;
+      Line->LastUse = 0;
+    }
+  }
+}
+
+/**
+  Drop all the cache lines. There is never any dirty data to write back.
+
+  @param  MmcHostInstance        The instance whose cache is flushed.
+
+**/
+VOID
+MmcCacheFlush (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  MMC_READ_CACHE          *Cache;
+  UINTN                   Index;
+
+  Cache = &MmcHostInstance->Cache;
+  for (Index = 0; Index < Cache->LineCount; Index++) {
+    Cache->Lines[Index].Blocks = 0;
+    Cache->Lines[Index].LastUse = 0;
+  }
+}
+
+/**
+  Release the memory of the cache.
+
+  @param  MmcHostInstance        The instance being destroyed.
+
+**/
+VOID
+MmcCacheDestroy (
+  IN MMC_HOST_INSTANCE      *MmcHostInstance
+  )
+{
+  MmcCacheFree (&MmcHostInstance->Cache);
+}
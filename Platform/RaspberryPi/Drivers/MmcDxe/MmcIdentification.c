@@ -45,6 +45,8 @@ typedef union {
 
 #define SD_CCC_SWITCH           (1 << 10)
 
+#define SD_SCR_CMD_SUPPORT_CMD23    (1 << 1)
+
 #define DEVICE_STATE(x)         (((x) >> 9) & 0xf)
 typedef enum _EMMC_DEVICE_STATE {
   EMMC_IDLE_STATE = 0,
@@ -240,8 +242,9 @@ EmmcIdentificationMode (
   Media->LastBlock = MmcHostInstance->CardInfo.ECSDData->SECTOR_COUNT - 1; // eMMC isn't supposed to report this for
   // Cards <2GB in size, but the model does.
 
-  // Setup card type
+  // Setup card type, CMD23 is mandatory since MMC 3.1
   MmcHostInstance->CardInfo.CardType = EMMC_CARD;
+  MmcHostInstance->CardInfo.SetBlockCount = TRUE;
   return EFI_SUCCESS;
 
 FreePageExit:
@@ -303,15 +306,23 @@ InitializeEmmcDevice (
       return EFI_UNSUPPORTED;
     }
     Status = Host->SetIos (Host, BusClockFreq, BusWidth, TimingMode[Idx]);
+    if (EFI_ERROR (Status) && BusWidth == 8) {
+      // Hosts with only 4 data lines wired
+      Status = Host->SetIos (Host, BusClockFreq, 4, TimingMode[Idx]);
+      if (!EFI_ERROR (Status)) {
+        BusWidth = 4;
+      }
+    }
     if (!EFI_ERROR (Status)) {
       switch (TimingMode[Idx]) {
       case EMMCHS52DDR1V2:
       case EMMCHS52DDR1V8:
-        BusMode = EMMC_BUS_WIDTH_DDR_8BIT;
+        BusMode = (BusWidth == 8) ? EMMC_BUS_WIDTH_DDR_8BIT : EMMC_BUS_WIDTH_DDR_4BIT;
         break;
       case EMMCHS52:
       case EMMCHS26:
-        BusMode = EMMC_BUS_WIDTH_8BIT;
+        BusMode = (BusWidth == 8) ? EMMC_BUS_WIDTH_8BIT :
+                  (BusWidth == 4) ? EMMC_BUS_WIDTH_4BIT : EMMC_BUS_WIDTH_1BIT;
         break;
       default:
         return EFI_UNSUPPORTED;
@@ -675,6 +686,9 @@ InitializeSdMmcDevice (
      return Status;
   }
 
+  MmcHostInstance->CardInfo.SetBlockCount =
+    (Scr.CMD_SUPPORT & SD_SCR_CMD_SUPPORT_CMD23) != 0;
+
   if (Scr.SD_SPEC == 2) {
     if (Scr.SD_SPEC3 == 1) {
       if (Scr.SD_SPEC4 == 1) {
@@ -956,6 +970,7 @@ InitializeMmcDevice (
 
   BlockCount = 1;
   MmcHost = MmcHostInstance->MmcHost;
+  MmcHostInstance->CardInfo.SetBlockCount = FALSE;
 
   Status = MmcIdentificationMode (MmcHostInstance);
   if (EFI_ERROR (Status)) {
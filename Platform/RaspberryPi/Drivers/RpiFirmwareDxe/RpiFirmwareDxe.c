@@ -37,6 +37,29 @@ STATIC UINTN mDmaBufferBusAddress;
 
 STATIC SPIN_LOCK mMailboxLock;
 
+//
+// Board properties that cannot change while the firmware runs. They are
+// fetched with a single batched mailbox transaction at driver start, or by
+// their getter the first time it succeeds, and served from here afterwards.
+//
+typedef struct {
+  BOOLEAN   ArmMemoryValid;
+  UINT32    ArmMemoryBase;
+  UINT32    ArmMemorySize;
+  BOOLEAN   SerialValid;
+  UINT64    Serial;
+  BOOLEAN   ModelValid;
+  UINT32    Model;
+  BOOLEAN   ModelRevisionValid;
+  UINT32    ModelRevision;
+  BOOLEAN   FirmwareRevisionValid;
+  UINT32    FirmwareRevision;
+  BOOLEAN   MacAddressValid;
+  UINT8     MacAddress[6];
+} RPI_FW_BOARD_INFO;
+
+STATIC RPI_FW_BOARD_INFO mBoardInfo;
+
 STATIC
 BOOLEAN
 DrainMailbox (
@@ -249,6 +272,12 @@ RpiFirmwareGetArmMemory (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mBoardInfo.ArmMemoryValid) {
+    *Base = mBoardInfo.ArmMemoryBase;
+    *Size = mBoardInfo.ArmMemorySize;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -278,6 +307,10 @@ RpiFirmwareGetArmMemory (
 
   *Base = Cmd->TagBody.Base;
   *Size = Cmd->TagBody.Size;
+
+  mBoardInfo.ArmMemoryBase  = *Base;
+  mBoardInfo.ArmMemorySize  = *Size;
+  mBoardInfo.ArmMemoryValid = TRUE;
   return EFI_SUCCESS;
 }
 
@@ -306,6 +339,11 @@ RpiFirmwareGetMacAddress (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mBoardInfo.MacAddressValid) {
+    CopyMem (MacAddress, mBoardInfo.MacAddress, sizeof (mBoardInfo.MacAddress));
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -334,6 +372,9 @@ RpiFirmwareGetMacAddress (
   }
 
   CopyMem (MacAddress, Cmd->TagBody.MacAddress, sizeof (Cmd->TagBody.MacAddress));
+
+  CopyMem (mBoardInfo.MacAddress, MacAddress, sizeof (mBoardInfo.MacAddress));
+  mBoardInfo.MacAddressValid = TRUE;
   return EFI_SUCCESS;
 }
 
@@ -361,6 +402,11 @@ RpiFirmwareGetSerial (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mBoardInfo.SerialValid) {
+    *Serial = mBoardInfo.Serial;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -397,6 +443,10 @@ RpiFirmwareGetSerial (
     *Serial = SwapBytes64 (*Serial << 16);
   }
 
+  if (!EFI_ERROR (Status)) {
+    mBoardInfo.Serial      = *Serial;
+    mBoardInfo.SerialValid = TRUE;
+  }
   return Status;
 }
 
@@ -424,6 +474,11 @@ RpiFirmwareGetModel (
   EFI_STATUS                  Status;
   UINT32                      Result;
 
+  if (mBoardInfo.ModelValid) {
+    *Model = mBoardInfo.Model;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -452,6 +507,9 @@ RpiFirmwareGetModel (
   }
 
   *Model = Cmd->TagBody.Model;
+
+  mBoardInfo.Model      = *Model;
+  mBoardInfo.ModelValid = TRUE;
   return EFI_SUCCESS;
 }
 
@@ -479,6 +537,11 @@ RpiFirmwareGetModelRevision (
   EFI_STATUS                    Status;
   UINT32                        Result;
 
+  if (mBoardInfo.ModelRevisionValid) {
+    *Revision = mBoardInfo.ModelRevision;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -507,6 +570,9 @@ RpiFirmwareGetModelRevision (
   }
 
   *Revision = Cmd->TagBody.Revision;
+
+  mBoardInfo.ModelRevision      = *Revision;
+  mBoardInfo.ModelRevisionValid = TRUE;
   return EFI_SUCCESS;
 }
 
@@ -521,6 +587,11 @@ RpiFirmwareGetFirmwareRevision (
   EFI_STATUS                    Status;
   UINT32                        Result;
 
+  if (mBoardInfo.FirmwareRevisionValid) {
+    *Revision = mBoardInfo.FirmwareRevision;
+    return EFI_SUCCESS;
+  }
+
   if (!AcquireSpinLockOrFail (&mMailboxLock)) {
     DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
     return EFI_DEVICE_ERROR;
@@ -549,6 +620,9 @@ RpiFirmwareGetFirmwareRevision (
   }
 
   *Revision = Cmd->TagBody.Revision;
+
+  mBoardInfo.FirmwareRevision      = *Revision;
+  mBoardInfo.FirmwareRevisionValid = TRUE;
   return EFI_SUCCESS;
 }
 
@@ -1293,6 +1367,137 @@ RpiFirmwareNotifyXhciReset (
   return Status;
 }
 
+#pragma pack(1)
+typedef struct {
+  RPI_FW_BUFFER_HEAD        BufferHead;
+  RPI_FW_TAG_HEAD           ArmMemoryTagHead;
+  RPI_FW_ARM_MEMORY_TAG     ArmMemoryTagBody;
+  RPI_FW_TAG_HEAD           SerialTagHead;
+  RPI_FW_SERIAL_TAG         SerialTagBody;
+  RPI_FW_TAG_HEAD           ModelTagHead;
+  RPI_FW_MODEL_TAG          ModelTagBody;
+  RPI_FW_TAG_HEAD           ModelRevisionTagHead;
+  RPI_FW_MODEL_REVISION_TAG ModelRevisionTagBody;
+  RPI_FW_TAG_HEAD           FirmwareRevisionTagHead;
+  RPI_FW_MODEL_REVISION_TAG FirmwareRevisionTagBody;
+  RPI_FW_TAG_HEAD           MacAddressTagHead;
+  RPI_FW_MAC_ADDR_TAG       MacAddressTagBody;
+  UINT32                    EndTag;
+} RPI_FW_GET_BOARD_INFO_CMD;
+#pragma pack()
+
+//
+// The firmware sets bit 31 of the value size of every tag it answered.
+//
+#define RPI_FW_TAG_RESPONSE     BIT31
+
+STATIC
+VOID
+RpiFirmwareInitTag (
+  OUT   RPI_FW_TAG_HEAD   *TagHead,
+  IN    UINT32            TagId,
+  IN    UINT32            TagSize
+  )
+{
+  TagHead->TagId        = TagId;
+  TagHead->TagSize      = TagSize;
+  TagHead->TagValueSize = 0;
+}
+
+/**
+  Fetch all the immutable board properties in one mailbox transaction, rather
+  than one transaction per property, and cache those the firmware answered.
+  The getters fall back to their own transaction for anything missing.
+
+**/
+STATIC
+VOID
+RpiFirmwareFetchBoardInfo (
+  VOID
+  )
+{
+  RPI_FW_GET_BOARD_INFO_CMD   *Cmd;
+  EFI_STATUS                  Status;
+  UINT32                      Result;
+  UINT64                      Serial;
+
+  if (!AcquireSpinLockOrFail (&mMailboxLock)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to acquire spinlock\n", __FUNCTION__));
+    return;
+  }
+
+  Cmd = mDmaBuffer;
+  ZeroMem (Cmd, sizeof (*Cmd));
+
+  Cmd->BufferHead.BufferSize  = sizeof (*Cmd);
+  Cmd->BufferHead.Response    = 0;
+  RpiFirmwareInitTag (&Cmd->ArmMemoryTagHead, RPI_MBOX_GET_ARM_MEMSIZE,
+    sizeof (Cmd->ArmMemoryTagBody));
+  RpiFirmwareInitTag (&Cmd->SerialTagHead, RPI_MBOX_GET_BOARD_SERIAL,
+    sizeof (Cmd->SerialTagBody));
+  RpiFirmwareInitTag (&Cmd->ModelTagHead, RPI_MBOX_GET_BOARD_MODEL,
+    sizeof (Cmd->ModelTagBody));
+  RpiFirmwareInitTag (&Cmd->ModelRevisionTagHead, RPI_MBOX_GET_BOARD_REVISION,
+    sizeof (Cmd->ModelRevisionTagBody));
+  RpiFirmwareInitTag (&Cmd->FirmwareRevisionTagHead, RPI_MBOX_GET_REVISION,
+    sizeof (Cmd->FirmwareRevisionTagBody));
+  RpiFirmwareInitTag (&Cmd->MacAddressTagHead, RPI_MBOX_GET_MAC_ADDRESS,
+    sizeof (Cmd->MacAddressTagBody));
+  Cmd->EndTag                 = 0;
+
+  Status = MailboxTransaction (Cmd->BufferHead.BufferSize, RPI_MBOX_VC_CHANNEL, &Result);
+
+  ReleaseSpinLock (&mMailboxLock);
+
+  if (EFI_ERROR (Status) ||
+      Cmd->BufferHead.Response != RPI_MBOX_RESP_SUCCESS) {
+    DEBUG ((DEBUG_WARN,
+      "%a: mailbox transaction error: Status == %r, Response == 0x%x\n",
+      __FUNCTION__, Status, Cmd->BufferHead.Response));
+    return;
+  }
+
+  if ((Cmd->ArmMemoryTagHead.TagValueSize & RPI_FW_TAG_RESPONSE) != 0) {
+    mBoardInfo.ArmMemoryBase  = Cmd->ArmMemoryTagBody.Base;
+    mBoardInfo.ArmMemorySize  = Cmd->ArmMemoryTagBody.Size;
+    mBoardInfo.ArmMemoryValid = TRUE;
+  }
+  if ((Cmd->ModelTagHead.TagValueSize & RPI_FW_TAG_RESPONSE) != 0) {
+    mBoardInfo.Model      = Cmd->ModelTagBody.Model;
+    mBoardInfo.ModelValid = TRUE;
+  }
+  if ((Cmd->ModelRevisionTagHead.TagValueSize & RPI_FW_TAG_RESPONSE) != 0) {
+    mBoardInfo.ModelRevision      = Cmd->ModelRevisionTagBody.Revision;
+    mBoardInfo.ModelRevisionValid = TRUE;
+  }
+  if ((Cmd->FirmwareRevisionTagHead.TagValueSize & RPI_FW_TAG_RESPONSE) != 0) {
+    mBoardInfo.FirmwareRevision      = Cmd->FirmwareRevisionTagBody.Revision;
+    mBoardInfo.FirmwareRevisionValid = TRUE;
+  }
+  if ((Cmd->MacAddressTagHead.TagValueSize & RPI_FW_TAG_RESPONSE) != 0) {
+    CopyMem (mBoardInfo.MacAddress, Cmd->MacAddressTagBody.MacAddress,
+      sizeof (mBoardInfo.MacAddress));
+    mBoardInfo.MacAddressValid = TRUE;
+  }
+  if ((Cmd->SerialTagHead.TagValueSize & RPI_FW_TAG_RESPONSE) != 0) {
+    //
+    // Same MAC address fallback as RpiFirmwareGetSerial ()
+    //
+    Serial = Cmd->SerialTagBody.Serial;
+    if ((Serial == 0) || ((Serial & 0xFFFFFFFF0FFFFFFFULL) == 0)) {
+      if (mBoardInfo.MacAddressValid) {
+        Serial = 0;
+        CopyMem (&Serial, mBoardInfo.MacAddress, sizeof (mBoardInfo.MacAddress));
+        mBoardInfo.Serial      = SwapBytes64 (Serial << 16);
+        mBoardInfo.SerialValid = TRUE;
+      }
+    } else {
+      mBoardInfo.Serial      = Serial;
+      mBoardInfo.SerialValid = TRUE;
+    }
+  }
+}
+
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL mRpiFirmwareProtocol = {
   RpiFirmwareSetPowerState,
   RpiFirmwareGetMacAddress,
@@ -1365,6 +1570,8 @@ RpiFirmwareDxeInitialize (
   //
   ASSERT (!(mDmaBufferBusAddress & (BCM2836_MBOX_NUM_CHANNELS - 1)));
 
+  RpiFirmwareFetchBoardInfo ();
+
   Status = gBS->InstallProtocolInterface (&ImageHandle,
                   &gRaspberryPiFirmwareProtocolGuid, EFI_NATIVE_INTERFACE,
                   &mRpiFirmwareProtocol);
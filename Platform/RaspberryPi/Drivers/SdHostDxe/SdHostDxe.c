@@ -28,6 +28,7 @@
 #include <IndustryStandard/Bcm2836.h>
 #include <IndustryStandard/RpiMbox.h>
 #include <IndustryStandard/Bcm2836SdHost.h>
+#include <IndustryStandard/Bcm2836Dma.h>
 
 #define SDHOST_BLOCK_BYTE_LENGTH            512
 
@@ -37,9 +38,27 @@
 #define CMD_MAX_POLL_COUNT                  (CMD_MIN_POLL_TOTAL_TIME_US / CMD_STALL_AFTER_POLL_US)
 #define CMD_MAX_RETRY_COUNT                 3
 #define CMD_STALL_AFTER_RETRY_US            20 // 20us
+#define FIFO_STALL_AFTER_POLL_US            1
 #define FIFO_MAX_POLL_COUNT                 1000000
 #define STALL_TO_STABILIZE_US               10000 // 10ms
 
+// FIFO levels at which the SdHost raises its DREQ
+#define FIFO_READ_THRESHOLD                 4
+#define FIFO_WRITE_THRESHOLD                4
+
+// DMA parameters. The DREQ isn't raised for the last words of a read, they
+// are drained from the FIFO by PIO. Each control block moves a segment
+// small enough for the lite channels, a page of them is chained per run.
+#define DMA_READ_DRAIN_BYTES                ((FIFO_READ_THRESHOLD - 1) * 4)
+#define DMA_SEGMENT_LENGTH                  0x8000
+#define DMA_CB_COUNT                        (EFI_PAGE_SIZE / sizeof (BCM2836_DMA_CB))
+#define DMA_MAX_RUN_LENGTH                  (DMA_CB_COUNT * DMA_SEGMENT_LENGTH)
+#define DMA_MAX_POLL_TOTAL_TIME_US          1000000 // 1s per run
+
+// The activity LED is a mailbox call, switch it off once the card was idle
+// for that long instead of toggling it around each transfer.
+#define LED_OFF_DELAY                       EFI_TIMER_PERIOD_MILLISECONDS (100)
+
 #define IDENT_MODE_SD_CLOCK_FREQ_HZ         400000 // 400KHz
 
 // Macros adopted from MmcDxe internal header
@@ -52,6 +71,14 @@
 
 STATIC RASPBERRY_PI_FIRMWARE_PROTOCOL   *mFwProtocol;
 
+STATIC EFI_EVENT            mLedOffEvent;
+STATIC BOOLEAN              mLedOn;
+
+STATIC UINTN                mDmaChannelBase;  // 0 when only PIO is used
+STATIC BCM2836_DMA_CB       *mDmaCb;
+STATIC EFI_PHYSICAL_ADDRESS mDmaCbBusAddress;
+STATIC VOID                 *mDmaCbMapping;
+
 // Per Physical Layer Simplified Specs
 #ifndef NDEBUG
 STATIC CONST CHAR8* mStrSdState[] = { "idle", "ready", "ident", "stby",
@@ -495,6 +522,265 @@ SdReceiveResponse (
   return EFI_SUCCESS;
 }
 
+STATIC VOID
+EFIAPI
+SdHostLedOffNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  mFwProtocol->SetLed (FALSE);
+  mLedOn = FALSE;
+}
+
+STATIC VOID
+SdHostLedActivity (
+  VOID
+  )
+{
+  EFI_TPL OldTpl;
+
+  if (mLedOffEvent == NULL) {
+    return;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_CALLBACK);
+  if (!mLedOn) {
+    mFwProtocol->SetLed (TRUE);
+    mLedOn = TRUE;
+  }
+  gBS->SetTimer (mLedOffEvent, TimerRelative, LED_OFF_DELAY);
+  gBS->RestoreTPL (OldTpl);
+}
+
+STATIC EFI_STATUS
+SdPioReadWords (
+  IN UINT32*                  Buffer,
+  IN UINTN                    NumWords
+  )
+{
+  UINTN WordIdx;
+
+  for (WordIdx = 0; WordIdx < NumWords; ++WordIdx) {
+    UINT32 PollCount = 0;
+    while (PollCount < FIFO_MAX_POLL_COUNT) {
+      UINT32 Hsts = MmioRead32 (SDHOST_HSTS);
+      if ((Hsts & SDHOST_HSTS_DATA_FLAG) != 0) {
+        MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_DATA_FLAG);
+        Buffer[WordIdx] = MmioRead32 (SDHOST_DATA);
+        break;
+      }
+
+      ++PollCount;
+      gBS->Stall (FIFO_STALL_AFTER_POLL_US);
+    }
+
+    if (PollCount == FIFO_MAX_POLL_COUNT) {
+      DEBUG ((DEBUG_MMCHOST_SD_ERROR,
+          "SdHost: SdReadBlockData(): Block Word%d read poll timed-out\n", WordIdx));
+      SdHostDumpStatus ();
+      MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
+      return EFI_TIMEOUT;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC EFI_STATUS
+SdPioWriteWords (
+  IN UINT32*                  Buffer,
+  IN UINTN                    NumWords
+  )
+{
+  UINTN WordIdx;
+
+  for (WordIdx = 0; WordIdx < NumWords; ++WordIdx) {
+    UINT32 PollCount = 0;
+    while (PollCount < FIFO_MAX_POLL_COUNT) {
+      if (MmioRead32 (SDHOST_HSTS) & SDHOST_HSTS_DATA_FLAG) {
+        MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_DATA_FLAG);
+        MmioWrite32 (SDHOST_DATA, Buffer[WordIdx]);
+        break;
+      }
+
+      ++PollCount;
+      gBS->Stall (FIFO_STALL_AFTER_POLL_US);
+    }
+
+    if (PollCount == FIFO_MAX_POLL_COUNT) {
+      DEBUG ((DEBUG_MMCHOST_SD_ERROR,
+        "SdHost: SdWriteBlockData(): Block Word%d write poll timed-out\n", WordIdx));
+      SdHostDumpStatus ();
+      MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
+      return EFI_TIMEOUT;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+STATIC VOID
+SdDmaReset (
+  VOID
+  )
+{
+  MmioWrite32 (mDmaChannelBase + BCM2836_DMA_CS, BCM2836_DMA_CS_RESET);
+  MmioWrite32 (mDmaChannelBase + BCM2836_DMA_DEBUG, BCM2836_DMA_DEBUG_ERRORS);
+}
+
+STATIC EFI_STATUS
+SdDmaInitialize (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      Channel;
+  UINTN       Bytes;
+
+  Channel = FixedPcdGet32 (PcdSdHostDmaChannel);
+  if (Channel >= BCM2836_DMA_CHANNEL_COUNT) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = DmaAllocateBuffer (EfiBootServicesData, 1, (VOID **)&mDmaCb);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Bytes = EFI_PAGES_TO_SIZE (1);
+  Status = DmaMap (MapOperationBusMasterCommonBuffer, mDmaCb, &Bytes,
+             &mDmaCbBusAddress, &mDmaCbMapping);
+  if (EFI_ERROR (Status)) {
+    DmaFreeBuffer (1, mDmaCb);
+    mDmaCb = NULL;
+    return Status;
+  }
+
+  ASSERT ((mDmaCbBusAddress % BCM2836_DMA_CB_ALIGNMENT) == 0);
+
+  mDmaChannelBase = BCM2836_DMA_CHANNEL_BASE_ADDRESS (Channel);
+  MmioOr32 (BCM2836_DMA_ENABLE, 1 << Channel);
+  SdDmaReset ();
+
+  DEBUG ((DEBUG_MMCHOST_SD_INFO, "SdHost: Using DMA channel %u\n", Channel));
+  return EFI_SUCCESS;
+}
+
+/**
+  Move Length bytes between Buffer and the SdHost FIFO with the DMA engine,
+  the command of the transfer must have been sent.
+
+  The buffer is mapped in runs of up to DMA_MAX_RUN_LENGTH bytes, each run is
+  a chain of control blocks which the channel walks without the CPU. The last
+  words of a read are drained by PIO once the run is unmapped.
+
+**/
+STATIC EFI_STATUS
+SdDmaTransfer (
+  IN UINT8                    *Buffer,
+  IN UINTN                    Length,
+  IN BOOLEAN                  IsRead
+  )
+{
+  EFI_STATUS            Status;
+  EFI_PHYSICAL_ADDRESS  BusAddress;
+  VOID                  *Mapping;
+  BCM2836_DMA_CB        *Cb;
+  UINTN                 RunLength;
+  UINTN                 DmaLength;
+  UINTN                 MapLength;
+  UINTN                 Offset;
+  UINT32                PollCount;
+  UINT32                Cs;
+
+  Status = EFI_SUCCESS;
+  Cs = 0;
+
+  while (Length > 0) {
+    RunLength = MIN (Length, DMA_MAX_RUN_LENGTH);
+    DmaLength = RunLength;
+    if (IsRead && RunLength == Length) {
+      DmaLength -= DMA_READ_DRAIN_BYTES;
+    }
+
+    MapLength = RunLength;
+    Status = DmaMap (IsRead ? MapOperationBusMasterWrite : MapOperationBusMasterRead,
+               Buffer, &MapLength, &BusAddress, &Mapping);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+    ASSERT (MapLength == RunLength);
+
+    for (Offset = 0, Cb = mDmaCb; Offset < DmaLength; Cb++) {
+      Cb->TransferLength = (UINT32)MIN (DmaLength - Offset, DMA_SEGMENT_LENGTH);
+      if (IsRead) {
+        Cb->TransferInfo = BCM2836_DMA_TI_WAIT_RESP | BCM2836_DMA_TI_DEST_INC |
+                           BCM2836_DMA_TI_SRC_DREQ |
+                           BCM2836_DMA_TI_PERMAP (BCM2836_DMA_DREQ_SDHOST);
+        Cb->SourceAddress = SDHOST_DATA_BUS_ADDRESS;
+        Cb->DestinationAddress = (UINT32)(BusAddress + Offset);
+      } else {
+        Cb->TransferInfo = BCM2836_DMA_TI_WAIT_RESP | BCM2836_DMA_TI_SRC_INC |
+                           BCM2836_DMA_TI_DEST_DREQ |
+                           BCM2836_DMA_TI_PERMAP (BCM2836_DMA_DREQ_SDHOST);
+        Cb->SourceAddress = (UINT32)(BusAddress + Offset);
+        Cb->DestinationAddress = SDHOST_DATA_BUS_ADDRESS;
+      }
+      Cb->Stride = 0;
+      Offset += Cb->TransferLength;
+      Cb->NextControlBlock = (Offset < DmaLength) ?
+                             (UINT32)(mDmaCbBusAddress + (Cb + 1 - mDmaCb) * sizeof (*Cb)) : 0;
+    }
+
+    MmioWrite32 (mDmaChannelBase + BCM2836_DMA_CONBLK_AD, (UINT32)mDmaCbBusAddress);
+    MmioWrite32 (mDmaChannelBase + BCM2836_DMA_CS,
+      BCM2836_DMA_CS_END | BCM2836_DMA_CS_WAIT_FOR_OUTSTANDING_WRITES |
+      BCM2836_DMA_CS_ACTIVE);
+
+    // The channel drops ACTIVE once it loaded the null next control block.
+    for (PollCount = 0; PollCount < DMA_MAX_POLL_TOTAL_TIME_US; ++PollCount) {
+      Cs = MmioRead32 (mDmaChannelBase + BCM2836_DMA_CS);
+      if ((Cs & BCM2836_DMA_CS_ACTIVE) == 0 ||
+          (Cs & BCM2836_DMA_CS_ERROR) != 0 ||
+          (MmioRead32 (SDHOST_HSTS) & SDHOST_HSTS_ERROR) != 0) {
+        break;
+      }
+      gBS->Stall (CMD_STALL_AFTER_POLL_US);
+    }
+
+    if ((Cs & (BCM2836_DMA_CS_ACTIVE | BCM2836_DMA_CS_ERROR)) != 0 ||
+        (Cs & BCM2836_DMA_CS_END) == 0) {
+      DEBUG ((DEBUG_MMCHOST_SD_ERROR,
+        "SdHost: SdDmaTransfer(): %a of 0x%x bytes failed, CS 0x%8.8X, DEBUG 0x%8.8X\n",
+        IsRead ? "read" : "write", DmaLength, Cs,
+        MmioRead32 (mDmaChannelBase + BCM2836_DMA_DEBUG)));
+      SdHostDumpStatus ();
+      SdDmaReset ();
+      MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
+      Status = (PollCount == DMA_MAX_POLL_TOTAL_TIME_US) ? EFI_TIMEOUT : EFI_DEVICE_ERROR;
+    }
+
+    DmaUnmap (Mapping);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+
+    if (DmaLength < RunLength) {
+      Status = SdPioReadWords ((UINT32 *)(Buffer + DmaLength),
+                 (RunLength - DmaLength) / 4);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    Buffer += RunLength;
+    Length -= RunLength;
+  }
+
+  return Status;
+}
+
 STATIC EFI_STATUS
 SdReadBlockData (
   IN EFI_MMC_HOST_PROTOCOL    *This,
@@ -509,40 +795,16 @@ SdReadBlockData (
   ASSERT (Buffer != NULL);
   ASSERT (Length % 4 == 0);
 
-  EFI_STATUS Status = EFI_SUCCESS;
+  SdHostLedActivity ();
 
-  mFwProtocol->SetLed (TRUE);
-  {
-    UINT32 NumWords = Length / 4;
-    UINT32 WordIdx;
-
-    for (WordIdx = 0; WordIdx < NumWords; ++WordIdx) {
-      UINT32 PollCount = 0;
-      while (PollCount < FIFO_MAX_POLL_COUNT) {
-        UINT32 Hsts = MmioRead32 (SDHOST_HSTS);
-        if ((Hsts & SDHOST_HSTS_DATA_FLAG) != 0) {
-          MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_DATA_FLAG);
-          Buffer[WordIdx] = MmioRead32 (SDHOST_DATA);
-          break;
-        }
-
-        ++PollCount;
-        gBS->Stall (CMD_STALL_AFTER_RETRY_US);
-      }
-
-      if (PollCount == FIFO_MAX_POLL_COUNT) {
-        DEBUG ((DEBUG_MMCHOST_SD_ERROR,
-            "SdHost: SdReadBlockData(): Block Word%d read poll timed-out\n", WordIdx));
-        SdHostDumpStatus ();
-        MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
-        Status = EFI_TIMEOUT;
-        break;
-      }
-    }
+  //
+  // The short register reads (SCR, SD status, CMD6) stay on PIO.
+  //
+  if (mDmaChannelBase != 0 && Length >= SDHOST_BLOCK_BYTE_LENGTH) {
+    return SdDmaTransfer ((UINT8 *)Buffer, Length, TRUE);
   }
-  mFwProtocol->SetLed (FALSE);
 
-  return Status;
+  return SdPioReadWords (Buffer, Length / 4);
 }
 
 STATIC EFI_STATUS
@@ -560,39 +822,13 @@ SdWriteBlockData (
   ASSERT (Buffer != NULL);
   ASSERT (Length % SDHOST_BLOCK_BYTE_LENGTH == 0);
 
-  EFI_STATUS Status = EFI_SUCCESS;
+  SdHostLedActivity ();
 
-  mFwProtocol->SetLed (TRUE);
-  {
-    UINT32 NumWords = Length / 4;
-    UINT32 WordIdx;
-
-    for (WordIdx = 0; WordIdx < NumWords; ++WordIdx) {
-      UINT32 PollCount = 0;
-      while (PollCount < FIFO_MAX_POLL_COUNT) {
-        if (MmioRead32 (SDHOST_HSTS) & SDHOST_HSTS_DATA_FLAG) {
-          MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_DATA_FLAG);
-          MmioWrite32 (SDHOST_DATA, Buffer[WordIdx]);
-          break;
-        }
-
-        ++PollCount;
-        gBS->Stall (CMD_STALL_AFTER_RETRY_US);
-      }
-
-      if (PollCount == FIFO_MAX_POLL_COUNT) {
-        DEBUG ((DEBUG_MMCHOST_SD_ERROR,
-          "SdHost: SdWriteBlockData(): Block Word%d write poll timed-out\n", WordIdx));
-        SdHostDumpStatus ();
-        MmioWrite32 (SDHOST_HSTS, SDHOST_HSTS_CLEAR);
-        Status = EFI_TIMEOUT;
-        break;
-      }
-    }
+  if (mDmaChannelBase != 0) {
+    return SdDmaTransfer ((UINT8 *)Buffer, Length, FALSE);
   }
-  mFwProtocol->SetLed (FALSE);
 
-  return Status;
+  return SdPioWriteWords (Buffer, Length / 4);
 }
 
 STATIC EFI_STATUS
@@ -666,6 +902,14 @@ SdNotifyState (
 
     gBS->Stall (STALL_TO_STABILIZE_US);
 
+    // FIFO thresholds, these also drive the DMA requests
+    UINT32 Edm = MmioRead32 (SDHOST_EDM);
+    Edm &= ~(SDHOST_EDM_READ_THRESHOLD (SDHOST_EDM_THRESHOLD_MASK) |
+             SDHOST_EDM_WRITE_THRESHOLD (SDHOST_EDM_THRESHOLD_MASK));
+    Edm |= SDHOST_EDM_READ_THRESHOLD (FIFO_READ_THRESHOLD) |
+           SDHOST_EDM_WRITE_THRESHOLD (FIFO_WRITE_THRESHOLD);
+    MmioWrite32 (SDHOST_EDM, Edm);
+
     // Write controller configs
     UINT32 Hcfg = 0;
     Hcfg |= SDHOST_HCFG_WIDE_INT_BUS;
@@ -831,6 +1075,18 @@ SdHostInitialize (
   DEBUG ((DEBUG_MMCHOST_SD, " - CMD_MAX_RETRY_COUNT=%d\n", CMD_MAX_RETRY_COUNT));
   DEBUG ((DEBUG_MMCHOST_SD, " - CMD_STALL_AFTER_RETRY_US=%dus\n", CMD_STALL_AFTER_RETRY_US));
 
+  Status = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                  SdHostLedOffNotify, NULL, &mLedOffEvent);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_MMCHOST_SD_ERROR, "SdHost: Failed to create the LED event: %r\n", Status));
+    mLedOffEvent = NULL;
+  }
+
+  Status = SdDmaInitialize ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_MMCHOST_SD_INFO, "SdHost: DMA not used (%r), transfers use PIO\n", Status));
+  }
+
   Status = gBS->InstallMultipleProtocolInterfaces (
     &Handle,
     &gRaspberryPiMmcHostProtocolGuid,
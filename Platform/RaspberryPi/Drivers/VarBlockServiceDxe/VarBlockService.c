@@ -86,6 +86,32 @@ EFI_FW_VOL_BLOCK_DEVICE mFvbDeviceTemplate = {
 };
 
 
+STATIC
+VOID
+VarStoreMarkDirty (
+  IN UINTN Address,
+  IN UINTN Length
+  )
+{
+  UINTN Lba;
+  UINTN LastLba;
+
+  if (Length == 0) {
+    return;
+  }
+
+  Lba = (Address - mFvInstance->FvBase) / FixedPcdGet32 (PcdFirmwareBlockSize);
+  LastLba = (Address - mFvInstance->FvBase + Length - 1) /
+              FixedPcdGet32 (PcdFirmwareBlockSize);
+  ASSERT (LastLba < VAR_STORE_NUM_LBAS);
+
+  for (; Lba <= LastLba && Lba < VAR_STORE_NUM_LBAS; Lba++) {
+    mFvInstance->DirtyLbas[Lba / 8] |= (UINT8)(1 << (Lba % 8));
+  }
+  mFvInstance->Dirty = TRUE;
+}
+
+
 EFI_STATUS
 VarStoreWrite (
   IN     UINTN Address,
@@ -94,7 +120,7 @@ VarStoreWrite (
   )
 {
   CopyMem ((VOID*)Address, Buffer, *NumBytes);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, *NumBytes);
 
   return EFI_SUCCESS;
 }
@@ -107,7 +133,7 @@ VarStoreErase (
   )
 {
   SetMem ((VOID*)Address, LbaLength, 0xff);
-  mFvInstance->Dirty = TRUE;
+  VarStoreMarkDirty (Address, LbaLength);
 
   return EFI_SUCCESS;
 }
@@ -22,6 +22,18 @@
 #include <Protocol/BlockIo.h>
 #include <Protocol/LoadedImage.h>
 
+//
+// The store is written back to the file one dirty LBA at a time.
+//
+#define VAR_STORE_LENGTH                                    \
+  (FixedPcdGet32 (PcdFlashNvStorageVariableSize) +          \
+   FixedPcdGet32 (PcdFlashNvStorageFtwWorkingSize) +        \
+   FixedPcdGet32 (PcdFlashNvStorageFtwSpareSize) +          \
+   FixedPcdGet32 (PcdNvStorageEventLogSize))
+#define VAR_STORE_NUM_LBAS                                  \
+  ((VAR_STORE_LENGTH + FixedPcdGet32 (PcdFirmwareBlockSize) - 1) / \
+   FixedPcdGet32 (PcdFirmwareBlockSize))
+
 typedef struct {
   union {
     UINTN                      FvBase;
@@ -33,6 +45,7 @@ typedef struct {
   EFI_DEVICE_PATH_PROTOCOL   *Device;
   CHAR16                     *MappedFile;
   BOOLEAN                    Dirty;
+  UINT8                      DirtyLbas[(VAR_STORE_NUM_LBAS + 7) / 8];
 } EFI_FW_VOL_INSTANCE;
 
 extern EFI_FW_VOL_INSTANCE *mFvInstance;
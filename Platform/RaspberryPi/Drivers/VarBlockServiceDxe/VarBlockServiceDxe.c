@@ -8,6 +8,8 @@
  *
  **/
 
+#include <Library/BaseMemoryLib.h>
+
 #include "VarBlockService.h"
 
 VOID *mSFSRegistration;
@@ -126,6 +128,10 @@ DoDump (
 {
   EFI_STATUS Status;
   EFI_FILE_PROTOCOL *File;
+  UINTN Lba;
+  UINTN FirstLba;
+  UINTN Offset;
+  UINTN Length;
 
   Status = FileOpen (Device,
              mFvInstance->MappedFile,
@@ -136,11 +142,39 @@ DoDump (
     return Status;
   }
 
-  Status = FileWrite (File,
-             mFvInstance->Offset,
-             mFvInstance->FvBase,
-             mFvInstance->FvLength);
+  //
+  // Only write back the runs of dirty LBAs, at their offset in the file.
+  //
+  Status = EFI_SUCCESS;
+  Lba = 0;
+  while (Lba < VAR_STORE_NUM_LBAS) {
+    if ((mFvInstance->DirtyLbas[Lba / 8] & (1 << (Lba % 8))) == 0) {
+      Lba++;
+      continue;
+    }
+
+    FirstLba = Lba;
+    while (Lba < VAR_STORE_NUM_LBAS &&
+           (mFvInstance->DirtyLbas[Lba / 8] & (1 << (Lba % 8))) != 0) {
+      Lba++;
+    }
+
+    Offset = FirstLba * FixedPcdGet32 (PcdFirmwareBlockSize);
+    Length = MIN ((Lba - FirstLba) * FixedPcdGet32 (PcdFirmwareBlockSize),
+               mFvInstance->FvLength - Offset);
+    Status = FileWrite (File,
+               mFvInstance->Offset + Offset,
+               mFvInstance->FvBase + Offset,
+               Length);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
   FileClose (File);
+
+  if (!EFI_ERROR (Status)) {
+    ZeroMem (mFvInstance->DirtyLbas, sizeof (mFvInstance->DirtyLbas));
+  }
   return Status;
 }
 
@@ -159,6 +159,43 @@ static int U500_irqchip_init(bool cold_boot)
             (hartid) ? (2 * hartid) : -1);
 }
 
+/*
+ * The CLINT layout is fixed on the U5 series, so the IPI and timer hooks
+ * below access the registers directly instead of going through the
+ * generic CLINT driver, whose per call lookups sit on the path of every
+ * SBI set_timer and IPI. The generic driver is still used for the init.
+ */
+static void U500_ipi_send(u32 target_hart)
+{
+    if (target_hart >= U500_HART_COUNT)
+        return;
+
+    writel(1, (void *)CLINT_REG_MSIP(target_hart));
+}
+
+static void U500_ipi_clear(u32 target_hart)
+{
+    if (target_hart >= U500_HART_COUNT)
+        return;
+
+    writel(0, (void *)CLINT_REG_MSIP(target_hart));
+}
+
+static u64 U500_timer_value(void)
+{
+    return readq_relaxed((void *)CLINT_REG_MTIME);
+}
+
+static void U500_timer_event_stop(void)
+{
+    writeq_relaxed(-1ULL, (void *)CLINT_REG_MTIMECMP(current_hartid()));
+}
+
+static void U500_timer_event_start(u64 next_event)
+{
+    writeq_relaxed(next_event, (void *)CLINT_REG_MTIMECMP(current_hartid()));
+}
+
 static int U500_ipi_init(bool cold_boot)
 {
     int rc;
@@ -210,13 +247,13 @@ const struct sbi_platform_operations platform_ops = {
     .console_getc = sifive_uart_getc,
     .console_init = U500_console_init,
     .irqchip_init = U500_irqchip_init,
-    .ipi_send = clint_ipi_send,
-    .ipi_clear = clint_ipi_clear,
+    .ipi_send = U500_ipi_send,
+    .ipi_clear = U500_ipi_clear,
     .ipi_init = U500_ipi_init,
     .get_tlbr_flush_limit = U500_get_tlbr_flush_limit,
-    .timer_value = clint_timer_value,
-    .timer_event_stop = clint_timer_event_stop,
-    .timer_event_start = clint_timer_event_start,
+    .timer_value = U500_timer_value,
+    .timer_event_stop = U500_timer_event_stop,
+    .timer_event_start = U500_timer_event_start,
     .timer_init = U500_timer_init,
     .system_reset = U500_system_reset
 };
@@ -10,11 +10,148 @@
 
 #include "PiPei.h"
 #include "Platform.h"
+#include <Guid/RiscVSecFfsIndex.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
 #include <Library/PeiServicesLib.h>
 
+/**
+  Check if a firmware volume only holds firmware volume images which need
+  to be decompressed.
+
+  Such a volume is read only once, sequentially, when its images are
+  extracted into memory, so it is not worth copying it out of the flash.
+
+  @param[in]  Fv            The firmware volume to check.
+
+  @retval TRUE              All the files of Fv are firmware volume images
+                            in a GUIDed section which requires processing.
+  @retval FALSE             Fv holds other files and is used in place.
+
+**/
+STATIC
+BOOLEAN
+PeiFvIsCompressedContainer (
+  IN  EFI_FIRMWARE_VOLUME_HEADER  *Fv
+  )
+{
+  EFI_PHYSICAL_ADDRESS        CurrentAddress;
+  EFI_PHYSICAL_ADDRESS        EndOfFirmwareVolume;
+  EFI_PHYSICAL_ADDRESS        EndOfFile;
+  EFI_FFS_FILE_HEADER         *File;
+  EFI_COMMON_SECTION_HEADER   *Section;
+  UINT16                      Attributes;
+  UINT32                      Size;
+  BOOLEAN                     Found;
+
+  Found = FALSE;
+  EndOfFirmwareVolume = (EFI_PHYSICAL_ADDRESS)(UINTN) Fv + Fv->FvLength;
+  for (EndOfFile = (EFI_PHYSICAL_ADDRESS)(UINTN) Fv + Fv->HeaderLength; ; ) {
+    CurrentAddress = (EndOfFile + 7) & ~(7ULL);
+    if (CurrentAddress + sizeof (*File) > EndOfFirmwareVolume) {
+      break;
+    }
+
+    File = (EFI_FFS_FILE_HEADER *)(UINTN) CurrentAddress;
+    Size = *(UINT32 *) File->Size & 0xffffff;
+    if (Size == 0xffffff) {
+      break;
+    }
+    if (IS_FFS_FILE2 (File) ||
+        Size < sizeof (*File) + sizeof (EFI_GUID_DEFINED_SECTION)) {
+      return FALSE;
+    }
+    EndOfFile = CurrentAddress + Size;
+    if (EndOfFile > EndOfFirmwareVolume) {
+      return FALSE;
+    }
+    if (File->Type == EFI_FV_FILETYPE_FFS_PAD) {
+      continue;
+    }
+    if (File->Type != EFI_FV_FILETYPE_FIRMWARE_VOLUME_IMAGE) {
+      return FALSE;
+    }
+
+    Section = (EFI_COMMON_SECTION_HEADER *)(File + 1);
+    if (Section->Type != EFI_SECTION_GUID_DEFINED) {
+      return FALSE;
+    }
+    if (IS_SECTION2 (Section)) {
+      Attributes = ((EFI_GUID_DEFINED_SECTION2 *) Section)->Attributes;
+    } else {
+      Attributes = ((EFI_GUID_DEFINED_SECTION *) Section)->Attributes;
+    }
+    if ((Attributes & EFI_GUIDED_SECTION_PROCESSING_REQUIRED) == 0) {
+      return FALSE;
+    }
+    Found = TRUE;
+  }
+  return Found;
+}
+
+/**
+  Copy a firmware volume out of the memory-mapped flash into memory.
+
+  Every file and section lookup in a volume which is used in place runs at
+  the speed of the flash. Volumes outside the flash window, or which only
+  need to be decompressed, are left where they are.
+
+  Must be called once the PEI memory is installed.
+
+  @param[in, out]  FvBase   Base of the firmware volume, updated to the copy.
+  @param[in, out]  FvSize   Size of the firmware volume, updated to the copy.
+
+**/
+STATIC
+VOID
+PeiFvShadow (
+  IN OUT  EFI_PHYSICAL_ADDRESS  *FvBase,
+  IN OUT  UINT64                *FvSize
+  )
+{
+  EFI_PHYSICAL_ADDRESS        FlashBase;
+  UINT64                      FlashSize;
+  EFI_FIRMWARE_VOLUME_HEADER  *Fv;
+  EFI_FIRMWARE_VOLUME_HEADER  *Copy;
+  UINTN                       Pages;
+
+  FlashBase = FixedPcdGet32 (PcdU5FlashMappedBase);
+  FlashSize = FixedPcdGet32 (PcdU5FlashMappedSize);
+  if (*FvBase < FlashBase || *FvBase + *FvSize > FlashBase + FlashSize) {
+    return;
+  }
+
+  Fv = (EFI_FIRMWARE_VOLUME_HEADER *)(UINTN) *FvBase;
+  if (Fv->Signature != EFI_FVH_SIGNATURE || Fv->FvLength > *FvSize) {
+    return;
+  }
+  if (PeiFvIsCompressedContainer (Fv)) {
+    DEBUG ((DEBUG_INFO, "%a: FV at 0x%lx is decompressed from the flash\n", __FUNCTION__, *FvBase));
+    return;
+  }
+
+  Pages = EFI_SIZE_TO_PAGES ((UINTN) Fv->FvLength);
+  Copy = AllocatePages (Pages);
+  if (Copy == NULL) {
+    return;
+  }
+  CopyMem (Copy, Fv, (UINTN) Fv->FvLength);
+  if (CalculateSum16 ((UINT16 *) Copy, Copy->HeaderLength) != 0 ||
+      CompareMem (Copy, Fv, (UINTN) Fv->FvLength) != 0) {
+    DEBUG ((DEBUG_ERROR, "%a: Copy of the FV at 0x%lx is corrupted, used in place\n", __FUNCTION__, *FvBase));
+    FreePages (Copy, Pages);
+    return;
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: FV at 0x%lx shadowed to 0x%p\n", __FUNCTION__, *FvBase, Copy));
+  *FvBase = (EFI_PHYSICAL_ADDRESS)(UINTN) Copy;
+  *FvSize = Copy->FvLength;
+}
+
 /**
   Publish PEI & DXE (Decompressed) Memory based FVs to let PEI
   and DXE know about them.
@@ -27,22 +164,40 @@ PeiFvInitialization (
   VOID
   )
 {
+  EFI_STATUS           Status;
+  RISCV_SEC_FFS_INDEX  *FfsIndex;
+  EFI_PHYSICAL_ADDRESS DxeFvBase;
+  UINT64               DxeFvSize;
+
   DEBUG ((DEBUG_INFO, "Platform PEI Firmware Volume Initialization\n"));
+
+  //
+  // Keep the FFS file index of the boot FV built by SEC for later phases.
+  //
+  Status = PeiServicesLocatePpi (&gRiscVSecFfsIndexGuid, 0, NULL, (VOID **) &FfsIndex);
+  if (!EFI_ERROR (Status)) {
+    BuildGuidDataHob (&gRiscVSecFfsIndexGuid, FfsIndex, sizeof (*FfsIndex));
+  }
+
+  DxeFvBase = PcdGet32 (PcdRiscVDxeFvBase);
+  DxeFvSize = PcdGet32 (PcdRiscVDxeFvSize);
+  PeiFvShadow (&DxeFvBase, &DxeFvSize);
+
   //
   // Let DXE know about the DXE FV
   //
-  BuildFvHob (PcdGet32 (PcdRiscVDxeFvBase), PcdGet32 (PcdRiscVDxeFvSize));
-  DEBUG ((DEBUG_INFO, "Platform builds DXE FV at %x, size %x.\n",
-    PcdGet32 (PcdRiscVDxeFvBase),
-    PcdGet32 (PcdRiscVDxeFvSize)));
+  BuildFvHob (DxeFvBase, DxeFvSize);
+  DEBUG ((DEBUG_INFO, "Platform builds DXE FV at %lx, size %lx.\n",
+    DxeFvBase,
+    DxeFvSize));
 
   //
   // Let PEI know about the DXE FV so it can find the DXE Core
   //
   PeiServicesInstallFvInfoPpi (
     NULL,
-    (VOID *)(UINTN) PcdGet32 (PcdRiscVDxeFvBase),
-    PcdGet32 (PcdRiscVDxeFvSize),
+    (VOID *)(UINTN) DxeFvBase,
+    (UINT32) DxeFvSize,
     NULL,
     NULL
     );
@@ -78,6 +78,16 @@ PeiFvInitialization (
   VOID
   );
 
+EFI_STATUS
+PeiFdtInitialization (
+  VOID
+  );
+
+EFI_STATUS
+PeiPerformanceInitialization (
+  VOID
+  );
+
 EFI_STATUS
 InitializeXen (
   VOID
@@ -0,0 +1,74 @@
+/** @file
+  Publish the device tree passed by the previous booting stage.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "PiPei.h"
+#include "Platform.h"
+#include <Guid/FdtHob.h>
+#include <IndustryStandard/RiscVOpensbi.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/RiscVEdk2SbiLib.h>
+#include <libfdt.h>
+
+/**
+  Copy the device tree SEC received to permanent memory and publish it with
+  a gFdtHobGuid HOB.
+
+  The original device tree sits in memory which later phases may reuse, so
+  the copy is kept in boot services data. Must be called once the PEI
+  memory is installed.
+
+  @retval EFI_SUCCESS           The device tree HOB was built.
+  @retval EFI_NOT_FOUND         SEC didn't receive a valid device tree.
+  @retval EFI_OUT_OF_RESOURCES  The copy or the HOB couldn't be allocated.
+
+**/
+EFI_STATUS
+PeiFdtInitialization (
+  VOID
+  )
+{
+  EFI_RISCV_OPENSBI_FIRMWARE_CONTEXT  *FirmwareContext;
+  VOID                                *Fdt;
+  VOID                                *NewFdt;
+  UINTN                               FdtPages;
+  UINT64                              *FdtHobData;
+
+  SbiGetFirmwareContext (&FirmwareContext);
+  if (FirmwareContext == NULL || FirmwareContext->FlattenedDeviceTree == 0) {
+    DEBUG ((DEBUG_INFO, "%a: No device tree from the previous booting stage\n", __FUNCTION__));
+    return EFI_NOT_FOUND;
+  }
+  Fdt = (VOID *)(UINTN)FirmwareContext->FlattenedDeviceTree;
+  if (fdt_check_header (Fdt) != 0) {
+    DEBUG ((DEBUG_ERROR, "%a: No valid device tree at 0x%p\n", __FUNCTION__, Fdt));
+    return EFI_NOT_FOUND;
+  }
+
+  FdtPages = EFI_SIZE_TO_PAGES (fdt_totalsize (Fdt));
+  NewFdt = AllocatePages (FdtPages);
+  if (NewFdt == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  if (fdt_open_into (Fdt, NewFdt, EFI_PAGES_TO_SIZE (FdtPages)) != 0) {
+    FreePages (NewFdt, FdtPages);
+    return EFI_NOT_FOUND;
+  }
+
+  FdtHobData = BuildGuidHob (&gFdtHobGuid, sizeof (*FdtHobData));
+  if (FdtHobData == NULL) {
+    FreePages (NewFdt, FdtPages);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  *FdtHobData = (UINTN)NewFdt;
+
+  DEBUG ((DEBUG_INFO, "Platform publishes the device tree at 0x%p.\n", NewFdt));
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,58 @@
+/** @file
+  Publish the boot timestamps recorded by SEC.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "PiPei.h"
+#include "Platform.h"
+#include <Guid/FirmwarePerformance.h>
+#include <Guid/RiscVSecPerformance.h>
+#include <Library/DebugLib.h>
+#include <Library/HobLib.h>
+#include <Library/PeiServicesLib.h>
+#include <Library/PerformanceLib.h>
+#include <Library/TimerLib.h>
+
+/**
+  Turn the SEC timestamps into performance records and the SEC performance
+  HOB.
+
+  The reset end in the FPDT basic boot record is the time the boot hart
+  entered SEC, the timer counts from the reset. The SEC and OpenSBI phases
+  are logged as performance records with the raw timestamps so they show up
+  with the PEI and DXE records.
+
+  @retval EFI_SUCCESS     The SEC performance HOB was built.
+  @retval EFI_NOT_FOUND   SEC didn't hand over its timestamps.
+
+**/
+EFI_STATUS
+PeiPerformanceInitialization (
+  VOID
+  )
+{
+  EFI_STATUS                Status;
+  RISCV_SEC_PERFORMANCE     *SecPerformance;
+  FIRMWARE_SEC_PERFORMANCE  Performance;
+
+  Status = PeiServicesLocatePpi (&gRiscVSecPerformanceGuid, 0, NULL, (VOID **) &SecPerformance);
+  if (EFI_ERROR (Status) || SecPerformance->SecEntry == 0) {
+    return EFI_NOT_FOUND;
+  }
+
+  Performance.ResetEnd = GetTimeInNanoSecond (SecPerformance->SecEntry);
+  BuildGuidDataHob (&gEfiFirmwarePerformanceGuid, &Performance, sizeof (Performance));
+  DEBUG ((DEBUG_INFO, "%a: Reset end %ld ns\n", __FUNCTION__, Performance.ResetEnd));
+
+  PERF_START_EX (NULL, "SEC", NULL, SecPerformance->SecEntry, 0);
+  PERF_END_EX (NULL, "SEC", NULL, SecPerformance->PeiCoreEntry, 0);
+  if (SecPerformance->SbiInitStart != 0 && SecPerformance->SbiInitEnd != 0) {
+    PERF_START_EX (NULL, "OpenSBI", NULL, SecPerformance->SbiInitStart, 0);
+    PERF_END_EX (NULL, "OpenSBI", NULL, SecPerformance->SbiInitEnd, 0);
+  }
+  return EFI_SUCCESS;
+}
@@ -301,10 +301,19 @@ InitializePlatform (
   }
 
   MiscInitialization ();
-  Status = BuildCoreInformationHob ();
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Fail to build processor informstion HOB.\n"));
-    ASSERT(FALSE);
+  PeiPerformanceInitialization ();
+
+  //
+  // RiscVSmbiosDxe builds the processor SMBIOS records from the device tree
+  // when it is available, the core information HOBs are not needed then.
+  //
+  Status = PeiFdtInitialization ();
+  if (!FeaturePcdGet (PcdRiscVSmbiosFromDeviceTree) || EFI_ERROR (Status)) {
+    Status = BuildCoreInformationHob ();
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Fail to build processor informstion HOB.\n"));
+      ASSERT(FALSE);
+    }
   }
   return EFI_SUCCESS;
 }
@@ -0,0 +1,47 @@
+/** @file
+  Transmit ring of the U5 UART shared by the DXE modules using the
+  interrupt-driven serial port library.
+
+  The first module which initializes the library allocates the ring and
+  installs it as a configuration table with this GUID. The modules which
+  follow append to the same ring, so their output stays in order.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef U5_SERIAL_TX_RING_H_
+#define U5_SERIAL_TX_RING_H_
+
+#define U5_SERIAL_TX_RING_GUID \
+  { \
+    0x7d43cfc2, 0x4cdc, 0x4a5d, { 0x9d, 0x08, 0x73, 0x99, 0xa9, 0xd5, 0xcc, 0xcf } \
+  }
+
+#define U5_SERIAL_TX_RING_SIZE  SIZE_16KB
+
+typedef struct {
+  ///
+  /// Free running producer and consumer counts. The pending bytes are
+  /// Buffer[Tail % SIZE] up to Buffer[Head % SIZE].
+  ///
+  volatile UINTN    Head;
+  volatile UINTN    Tail;
+  ///
+  /// Set at ExitBootServices: the ring is flushed and every write is
+  /// synchronous from then on.
+  ///
+  volatile BOOLEAN  Synchronous;
+  ///
+  /// TRUE while a driver drains the ring from a timer event. Cleared when
+  /// that driver is unloaded, so the next driver attaching takes over.
+  ///
+  volatile BOOLEAN  Drained;
+  UINT8             Buffer[U5_SERIAL_TX_RING_SIZE];
+} U5_SERIAL_TX_RING;
+
+extern EFI_GUID gU5SerialTxRingGuid;
+
+#endif
@@ -17,4 +17,10 @@
     #define CLINT_REG_MTIMECMP3 0x02004018
     #define CLINT_REG_MTIMECMP4 0x02004020
 
+//
+// Per hart software interrupt pending and timer compare registers
+//
+#define CLINT_REG_MSIP(Hart)     (CLINT_REG_BASE_ADDR + ((Hart) * 4))
+#define CLINT_REG_MTIMECMP(Hart) (CLINT_REG_MTIMECMP0 + ((Hart) * 8))
+
 #endif
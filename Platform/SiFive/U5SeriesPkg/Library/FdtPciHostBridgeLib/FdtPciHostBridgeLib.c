@@ -0,0 +1,413 @@
+/** @file
+  PCI Host Bridge Library instance for pci-host-ecam-generic DT nodes
+
+  The ECAM window, bus range and the I/O and MMIO apertures are taken from
+  the device tree handed over by the previous boot stage, so the same
+  binary works for any ECAM compliant host bridge described there.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+#include <PiDxe.h>
+#include <Guid/FdtHob.h>
+#include <IndustryStandard/Pci.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/DxeServicesTableLib.h>
+#include <Library/HobLib.h>
+#include <Library/PcdLib.h>
+#include <Library/PciHostBridgeLib.h>
+#include <Protocol/PciRootBridgeIo.h>
+#include <Protocol/PciHostBridgeResourceAllocation.h>
+#include <libfdt.h>
+
+//
+// Space code in the first cell of a PCI "ranges" entry
+//
+#define DTB_PCI_HOST_RANGE_IO           BIT24
+#define DTB_PCI_HOST_RANGE_MMIO32       BIT25
+#define DTB_PCI_HOST_RANGE_MMIO64       (BIT25 | BIT24)
+#define DTB_PCI_HOST_RANGE_TYPEMASK     (BIT25 | BIT24)
+
+//
+// Number of cells in a PCI "ranges" entry: 3 for the PCI address,
+// 2 for the CPU address and 2 for the size.
+//
+#define DTB_PCI_HOST_RANGE_CELLS        7
+
+#pragma pack(1)
+typedef struct {
+  ACPI_HID_DEVICE_PATH     AcpiDevicePath;
+  EFI_DEVICE_PATH_PROTOCOL EndDevicePath;
+} EFI_PCI_ROOT_BRIDGE_DEVICE_PATH;
+#pragma pack ()
+
+STATIC EFI_PCI_ROOT_BRIDGE_DEVICE_PATH mEfiPciRootBridgeDevicePath = {
+  {
+    {
+      ACPI_DEVICE_PATH,
+      ACPI_DP,
+      {
+        (UINT8) (sizeof(ACPI_HID_DEVICE_PATH)),
+        (UINT8) ((sizeof(ACPI_HID_DEVICE_PATH)) >> 8)
+      }
+    },
+    EISA_PNP_ID(0x0A03),
+    0
+  },
+
+  {
+    END_DEVICE_PATH_TYPE,
+    END_ENTIRE_DEVICE_PATH_SUBTYPE,
+    {
+      END_DEVICE_PATH_LENGTH,
+      0
+    }
+  }
+};
+
+GLOBAL_REMOVE_IF_UNREFERENCED
+CHAR16 *mPciHostBridgeLibAcpiAddressSpaceTypeStr[] = {
+  L"Mem", L"I/O", L"Bus"
+};
+
+STATIC PCI_ROOT_BRIDGE mRootBridge;
+
+/**
+  Read a 64-bit value made of two big endian device tree cells.
+
+  @param[in] Cells  Pointer to the most significant cell.
+
+  @return The value in CPU byte order.
+
+**/
+STATIC
+UINT64
+FdtReadCells64 (
+  IN CONST UINT32  *Cells
+  )
+{
+  return LShiftU64 (fdt32_to_cpu (Cells[0]), 32) | fdt32_to_cpu (Cells[1]);
+}
+
+/**
+  Fill in an aperture from a device tree "ranges" entry.
+
+  @param[out] Aperture   The root bridge aperture to update.
+  @param[in]  PciBase    The base address of the range on the PCI side.
+  @param[in]  CpuBase    The base address of the range on the CPU side.
+  @param[in]  Size       The size of the range.
+
+**/
+STATIC
+VOID
+FdtPciHostSetAperture (
+  OUT PCI_ROOT_BRIDGE_APERTURE  *Aperture,
+  IN  UINT64                    PciBase,
+  IN  UINT64                    CpuBase,
+  IN  UINT64                    Size
+  )
+{
+  //
+  // Base and Limit are device addresses, and
+  // Device Address = Host Address + Translation.
+  //
+  Aperture->Base        = PciBase;
+  Aperture->Limit       = PciBase + Size - 1;
+  Aperture->Translation = PciBase - CpuBase;
+}
+
+/**
+  Parse a pci-host-ecam-generic node into the root bridge description.
+
+  @param[in]  Fdt          Pointer to the device tree.
+  @param[in]  Node         Offset of the host bridge node.
+  @param[out] RootBridge   The root bridge to fill in.
+  @param[out] ConfigBase   The base address of the ECAM window.
+  @param[out] ConfigSize   The size of the ECAM window.
+
+  @retval EFI_SUCCESS       The node has been parsed successfully.
+  @retval EFI_UNSUPPORTED   The node lacks a usable ECAM window or a
+                            MMIO aperture.
+
+**/
+STATIC
+EFI_STATUS
+FdtPciHostParseNode (
+  IN  CONST VOID       *Fdt,
+  IN  INT32            Node,
+  OUT PCI_ROOT_BRIDGE  *RootBridge,
+  OUT UINT64           *ConfigBase,
+  OUT UINT64           *ConfigSize
+  )
+{
+  CONST UINT32  *Prop;
+  INT32         Len;
+  UINT64        PciBase;
+  UINT64        CpuBase;
+  UINT64        Size;
+  UINT32        BusMax;
+
+  //
+  // "reg" holds the ECAM window, with 2 address and 2 size cells on RV64.
+  //
+  Prop = fdt_getprop (Fdt, Node, "reg", &Len);
+  if ((Prop == NULL) || (Len < 4 * sizeof (UINT32))) {
+    DEBUG ((DEBUG_ERROR, "%a: 'reg' property not found or invalid\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+  *ConfigBase = FdtReadCells64 (&Prop[0]);
+  *ConfigSize = FdtReadCells64 (&Prop[2]);
+  if (*ConfigSize < SIZE_1MB) {
+    DEBUG ((DEBUG_ERROR, "%a: ECAM window too small\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+
+  //
+  // Each bus takes 1 MB of ECAM space, so never advertise more buses than
+  // the window can decode.
+  //
+  BusMax = (UINT32) MIN (RShiftU64 (*ConfigSize, 20) - 1, PCI_MAX_BUS);
+  Prop = fdt_getprop (Fdt, Node, "bus-range", &Len);
+  if ((Prop != NULL) && (Len == 2 * sizeof (UINT32))) {
+    RootBridge->Bus.Base  = fdt32_to_cpu (Prop[0]);
+    RootBridge->Bus.Limit = MIN (fdt32_to_cpu (Prop[1]), RootBridge->Bus.Base + BusMax);
+  } else {
+    RootBridge->Bus.Base  = 0;
+    RootBridge->Bus.Limit = BusMax;
+  }
+
+  RootBridge->Io.Base          = MAX_UINT64;
+  RootBridge->Io.Limit         = 0;
+  RootBridge->Mem.Base         = MAX_UINT64;
+  RootBridge->Mem.Limit        = 0;
+  RootBridge->MemAbove4G.Base  = MAX_UINT64;
+  RootBridge->MemAbove4G.Limit = 0;
+
+  //
+  // There are no separate ranges for prefetchable and non-prefetchable BARs,
+  // prefetchable windows are combined with the non-prefetchable ones.
+  //
+  RootBridge->PMem.Base         = MAX_UINT64;
+  RootBridge->PMem.Limit        = 0;
+  RootBridge->PMemAbove4G.Base  = MAX_UINT64;
+  RootBridge->PMemAbove4G.Limit = 0;
+
+  Prop = fdt_getprop (Fdt, Node, "ranges", &Len);
+  if ((Prop == NULL) || ((Len % (DTB_PCI_HOST_RANGE_CELLS * sizeof (UINT32))) != 0)) {
+    DEBUG ((DEBUG_ERROR, "%a: 'ranges' property not found or invalid\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+
+  for ( ; Len > 0; Len -= DTB_PCI_HOST_RANGE_CELLS * sizeof (UINT32),
+                   Prop += DTB_PCI_HOST_RANGE_CELLS) {
+    PciBase = FdtReadCells64 (&Prop[1]);
+    CpuBase = FdtReadCells64 (&Prop[3]);
+    Size    = FdtReadCells64 (&Prop[5]);
+    if (Size == 0) {
+      continue;
+    }
+
+    switch (fdt32_to_cpu (Prop[0]) & DTB_PCI_HOST_RANGE_TYPEMASK) {
+    case DTB_PCI_HOST_RANGE_IO:
+      //
+      // There are no port I/O instructions on RISC-V, IoLib turns the port
+      // accesses into MMIO at the host address of this window.
+      //
+      FdtPciHostSetAperture (&RootBridge->Io, PciBase, CpuBase, Size);
+      break;
+
+    case DTB_PCI_HOST_RANGE_MMIO32:
+      FdtPciHostSetAperture (&RootBridge->Mem, PciBase, CpuBase, Size);
+      break;
+
+    case DTB_PCI_HOST_RANGE_MMIO64:
+      FdtPciHostSetAperture (&RootBridge->MemAbove4G, PciBase, CpuBase, Size);
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  if (RootBridge->Mem.Base > RootBridge->Mem.Limit) {
+    DEBUG ((DEBUG_ERROR, "%a: no MMIO32 aperture found\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+
+  RootBridge->Segment               = 0;
+  RootBridge->Supports              = 0;
+  RootBridge->Attributes            = 0;
+  RootBridge->DmaAbove4G            = TRUE;
+  RootBridge->NoExtendedConfigSpace = FALSE;
+  RootBridge->ResourceAssigned      = FALSE;
+  RootBridge->AllocationAttributes  = EFI_PCI_HOST_BRIDGE_COMBINE_MEM_PMEM;
+  if (RootBridge->MemAbove4G.Base <= RootBridge->MemAbove4G.Limit) {
+    RootBridge->AllocationAttributes |= EFI_PCI_HOST_BRIDGE_MEM64_DECODE;
+  }
+  RootBridge->DevicePath = (EFI_DEVICE_PATH_PROTOCOL *)&mEfiPciRootBridgeDevicePath;
+
+  DEBUG ((DEBUG_INFO, "PCI: ECAM 0x%lx size 0x%lx, buses 0x%lx-0x%lx\n",
+    *ConfigBase, *ConfigSize, RootBridge->Bus.Base, RootBridge->Bus.Limit));
+  DEBUG ((DEBUG_INFO, "PCI: I/O 0x%lx-0x%lx, Mem32 0x%lx-0x%lx, Mem64 0x%lx-0x%lx\n",
+    RootBridge->Io.Base, RootBridge->Io.Limit,
+    RootBridge->Mem.Base, RootBridge->Mem.Limit,
+    RootBridge->MemAbove4G.Base, RootBridge->MemAbove4G.Limit));
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Return all the root bridge instances in an array.
+
+  @param Count  Return the count of root bridge instances.
+
+  @return All the root bridge instances in an array.
+          The array should be passed into PciHostBridgeFreeRootBridges()
+          when it's not used.
+**/
+PCI_ROOT_BRIDGE *
+EFIAPI
+PciHostBridgeGetRootBridges (
+  UINTN *Count
+  )
+{
+  EFI_HOB_GUID_TYPE  *GuidHob;
+  CONST VOID         *Fdt;
+  CONST CHAR8        *NodeStatus;
+  INT32              Node;
+  UINT64             ConfigBase;
+  UINT64             ConfigSize;
+  EFI_STATUS         Status;
+
+  *Count = 0;
+
+  GuidHob = GetFirstGuidHob (&gFdtHobGuid);
+  if (GuidHob == NULL) {
+    DEBUG ((DEBUG_WARN, "%a: no device tree, PCI is not available\n", __FUNCTION__));
+    return NULL;
+  }
+  Fdt = (CONST VOID *)(UINTN)*(UINT64 *)GET_GUID_HOB_DATA (GuidHob);
+
+  //
+  // Only the first enabled host bridge is exposed, as segment 0.
+  //
+  for (Node = fdt_node_offset_by_compatible (Fdt, -1, "pci-host-ecam-generic");
+       Node >= 0;
+       Node = fdt_node_offset_by_compatible (Fdt, Node, "pci-host-ecam-generic")) {
+    NodeStatus = fdt_getprop (Fdt, Node, "status", NULL);
+    if ((NodeStatus == NULL) || (AsciiStrCmp (NodeStatus, "okay") == 0)) {
+      break;
+    }
+  }
+  if (Node < 0) {
+    DEBUG ((DEBUG_INFO, "%a: no PCI host bridge in the device tree\n", __FUNCTION__));
+    return NULL;
+  }
+
+  Status = FdtPciHostParseNode (Fdt, Node, &mRootBridge, &ConfigBase, &ConfigSize);
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  //
+  // PciSegmentLib reaches the configuration space through the ECAM base
+  // address, which is only known now.
+  //
+  Status = PcdSet64S (PcdPciExpressBaseAddress, ConfigBase);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: failed to set the ECAM base - %r\n", __FUNCTION__, Status));
+    return NULL;
+  }
+
+  //
+  // The ECAM window is not described by any resource HOB, add it to the GCD
+  // memory space map so it is known as uncached MMIO.
+  //
+  Status = gDS->AddMemorySpace (
+                  EfiGcdMemoryTypeMemoryMappedIo,
+                  ConfigBase,
+                  ConfigSize,
+                  EFI_MEMORY_UC
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_WARN, "%a: failed to add the ECAM window to GCD - %r\n", __FUNCTION__, Status));
+  }
+
+  *Count = 1;
+  return &mRootBridge;
+}
+
+/**
+  Free the root bridge instances array returned from
+  PciHostBridgeGetRootBridges().
+
+  @param Bridges The root bridge instances array.
+  @param Count   The count of the array.
+**/
+VOID
+EFIAPI
+PciHostBridgeFreeRootBridges (
+  PCI_ROOT_BRIDGE *Bridges,
+  UINTN           Count
+  )
+{
+  ASSERT (Count == 1);
+}
+
+/**
+  Inform the platform that the resource conflict happens.
+
+  @param HostBridgeHandle Handle of the Host Bridge.
+  @param Configuration    Pointer to PCI I/O and PCI memory resource
+                          descriptors. The Configuration contains the resources
+                          for all the root bridges. The resource for each root
+                          bridge is terminated with END descriptor and an
+                          additional END is appended indicating the end of the
+                          entire resources. The resource descriptor field
+                          values follow the description in
+                          EFI_PCI_HOST_BRIDGE_RESOURCE_ALLOCATION_PROTOCOL
+                          .SubmitResources().
+**/
+VOID
+EFIAPI
+PciHostBridgeResourceConflict (
+  EFI_HANDLE                        HostBridgeHandle,
+  VOID                              *Configuration
+  )
+{
+  EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR *Descriptor;
+  UINTN                             RootBridgeIndex;
+  DEBUG ((DEBUG_ERROR, "PciHostBridge: Resource conflict happens!\n"));
+
+  RootBridgeIndex = 0;
+  Descriptor = (EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR *) Configuration;
+  while (Descriptor->Desc == ACPI_ADDRESS_SPACE_DESCRIPTOR) {
+    DEBUG ((DEBUG_ERROR, "RootBridge[%d]:\n", RootBridgeIndex++));
+    for (; Descriptor->Desc == ACPI_ADDRESS_SPACE_DESCRIPTOR; Descriptor++) {
+      ASSERT (Descriptor->ResType <
+               ARRAY_SIZE(mPciHostBridgeLibAcpiAddressSpaceTypeStr));
+      DEBUG ((DEBUG_ERROR, " %s: Length/Alignment = 0x%lx / 0x%lx\n",
+              mPciHostBridgeLibAcpiAddressSpaceTypeStr[Descriptor->ResType],
+              Descriptor->AddrLen, Descriptor->AddrRangeMax
+              ));
+      if (Descriptor->ResType == ACPI_ADDRESS_SPACE_TYPE_MEM) {
+        DEBUG ((DEBUG_ERROR, "     Granularity/SpecificFlag = %ld / %02x%s\n",
+                Descriptor->AddrSpaceGranularity, Descriptor->SpecificFlag,
+                ((Descriptor->SpecificFlag &
+                  EFI_ACPI_MEMORY_RESOURCE_SPECIFIC_FLAG_CACHEABLE_PREFETCHABLE
+                  ) != 0) ? L" (Prefetchable)" : L""
+                ));
+      }
+    }
+    //
+    // Skip the END descriptor for root bridge
+    //
+    ASSERT (Descriptor->Desc == ACPI_END_TAG_DESCRIPTOR);
+    Descriptor = (EFI_ACPI_ADDRESS_SPACE_DESCRIPTOR *)(
+                   (EFI_ACPI_END_TAG_DESCRIPTOR *)Descriptor + 1
+                   );
+  }
+}
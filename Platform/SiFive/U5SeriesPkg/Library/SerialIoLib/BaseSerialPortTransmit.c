@@ -0,0 +1,31 @@
+/** @file
+  Synchronous transmit of the U5 UART serial port library.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+
+#include "U5Uart.h"
+
+/**
+  Send data to the serial device, returning once all of it is in the FIFO.
+
+  @param  Buffer           The bytes to send.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+  @return NumberOfBytes.
+
+**/
+UINTN
+U5SerialPortTransmit (
+  IN UINT8     *Buffer,
+  IN UINTN     NumberOfBytes
+  )
+{
+  U5UartTxWrite (Buffer, NumberOfBytes);
+  return NumberOfBytes;
+}
@@ -0,0 +1,352 @@
+/** @file
+  Buffered transmit of the U5 UART serial port library for DXE drivers.
+
+  Writes are queued in a RAM ring shared by all the DXE drivers using this
+  library and moved to the TX FIFO in bursts: by every write, without
+  waiting, and by a periodic timer event. The caller only waits on the
+  UART when the ring is full.
+
+  Writes are synchronous when supervisor interrupts are disabled, since
+  nothing could drain the ring then. This keeps ASSERT() and exception
+  output complete before the hart stops. At ExitBootServices the ring is
+  flushed and writes are synchronous from then on.
+
+  The ring is attached on the first write once boot services are
+  available, rather than from a constructor, because the DebugLib
+  constructor depends on this library and boot services table library.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Guid/EventGroup.h>
+#include <Guid/U5SerialTxRing.h>
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+
+#include "U5Uart.h"
+
+//
+// Interval of the timer event moving queued bytes to the FIFO.
+//
+#define U5_SERIAL_TX_DRAIN_PERIOD   EFI_TIMER_PERIOD_MILLISECONDS (1)
+
+STATIC U5_SERIAL_TX_RING  *mRing;
+STATIC BOOLEAN            mRingAttached;
+STATIC BOOLEAN            mRingOwner;
+STATIC EFI_EVENT          mDrainEvent;
+STATIC EFI_EVENT          mExitBootServicesEvent;
+
+/**
+  Move queued bytes to the TX FIFO.
+
+  @param  Wait     TRUE to wait until the ring is empty, FALSE to stop as
+                   soon as the FIFO is full.
+
+**/
+STATIC
+VOID
+RingDrain (
+  IN BOOLEAN  Wait
+  )
+{
+  UINTN  Offset;
+  UINTN  Length;
+  UINTN  Sent;
+
+  while (mRing->Tail != mRing->Head) {
+    Offset = mRing->Tail % U5_SERIAL_TX_RING_SIZE;
+    Length = MIN (mRing->Head - mRing->Tail, U5_SERIAL_TX_RING_SIZE - Offset);
+    if (Wait) {
+      U5UartTxWrite (&mRing->Buffer[Offset], Length);
+      Sent = Length;
+    } else {
+      Sent = U5UartTxFill (&mRing->Buffer[Offset], Length);
+    }
+    mRing->Tail += Sent;
+    if (Sent < Length) {
+      break;
+    }
+  }
+}
+
+/**
+  Append bytes to the ring, which must have room for them.
+
+  @param  Buffer           The bytes to queue.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+**/
+STATIC
+VOID
+RingAppend (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        NumberOfBytes
+  )
+{
+  UINTN  Offset;
+  UINTN  Length;
+
+  while (NumberOfBytes > 0) {
+    Offset = mRing->Head % U5_SERIAL_TX_RING_SIZE;
+    Length = MIN (NumberOfBytes, U5_SERIAL_TX_RING_SIZE - Offset);
+    CopyMem (&mRing->Buffer[Offset], Buffer, Length);
+    mRing->Head += Length;
+    Buffer += Length;
+    NumberOfBytes -= Length;
+  }
+}
+
+/**
+  Timer event notification moving queued bytes to the FIFO.
+
+  @param  Event    The timer event.
+  @param  Context  Not used.
+
+**/
+STATIC
+VOID
+EFIAPI
+RingDrainNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  EFI_TPL  OldTpl;
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  if (mRing != NULL) {
+    RingDrain (FALSE);
+  }
+  gBS->RestoreTPL (OldTpl);
+}
+
+/**
+  Flush the ring and detach from it at ExitBootServices.
+
+  @param  Event    The ExitBootServices event.
+  @param  Context  Not used.
+
+**/
+STATIC
+VOID
+EFIAPI
+RingExitBootServicesNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  if (mRing != NULL) {
+    RingDrain (TRUE);
+    mRing->Synchronous = TRUE;
+    mRing = NULL;
+  }
+}
+
+/**
+  Create the timer event draining the ring.
+
+**/
+STATIC
+VOID
+RingStartDrainEvent (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  RingDrainNotify,
+                  NULL,
+                  &mDrainEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    return;
+  }
+  Status = gBS->SetTimer (mDrainEvent, TimerPeriodic, U5_SERIAL_TX_DRAIN_PERIOD);
+  if (EFI_ERROR (Status)) {
+    gBS->CloseEvent (mDrainEvent);
+    mDrainEvent = NULL;
+    return;
+  }
+  mRingOwner = TRUE;
+  mRing->Drained = TRUE;
+}
+
+/**
+  Find the shared ring, or create it if this is the first driver using the
+  library.
+
+**/
+STATIC
+VOID
+RingAttach (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Index;
+
+  mRingAttached = TRUE;
+
+  for (Index = 0; Index < gST->NumberOfTableEntries; Index++) {
+    if (CompareGuid (&gST->ConfigurationTable[Index].VendorGuid, &gU5SerialTxRingGuid)) {
+      mRing = gST->ConfigurationTable[Index].VendorTable;
+      break;
+    }
+  }
+
+  if (mRing == NULL) {
+    Status = gBS->AllocatePool (
+                    EfiBootServicesData,
+                    sizeof (U5_SERIAL_TX_RING),
+                    (VOID **)&mRing
+                    );
+    if (EFI_ERROR (Status)) {
+      mRing = NULL;
+      return;
+    }
+    mRing->Head = 0;
+    mRing->Tail = 0;
+    mRing->Synchronous = FALSE;
+    mRing->Drained = FALSE;
+    Status = gBS->InstallConfigurationTable (&gU5SerialTxRingGuid, mRing);
+    if (EFI_ERROR (Status)) {
+      gBS->FreePool (mRing);
+      mRing = NULL;
+      return;
+    }
+  }
+
+  if (mRing->Synchronous) {
+    mRing = NULL;
+    return;
+  }
+
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  RingExitBootServicesNotify,
+                  NULL,
+                  &gEfiEventExitBootServicesGuid,
+                  &mExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    mRing = NULL;
+    return;
+  }
+
+  //
+  // The driver which installed the ring, or the first one attaching after
+  // the previous owner was unloaded, drains it from a timer event.
+  //
+  if (!mRing->Drained) {
+    RingStartDrainEvent ();
+  }
+}
+
+/**
+  Send data to the serial device.
+
+  @param  Buffer           The bytes to send.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+  @return NumberOfBytes, all of them are sent or queued.
+
+**/
+UINTN
+U5SerialPortTransmit (
+  IN UINT8     *Buffer,
+  IN UINTN     NumberOfBytes
+  )
+{
+  EFI_TPL  OldTpl;
+  UINTN    Sent;
+  UINTN    Free;
+
+  if (!mRingAttached && gBS != NULL && gST != NULL &&
+      (csr_read (CSR_SSTATUS) & SSTATUS_SIE) != 0) {
+    RingAttach ();
+  }
+
+  if (mRing == NULL || (csr_read (CSR_SSTATUS) & SSTATUS_SIE) == 0) {
+    //
+    // Nothing can drain the ring asynchronously, send everything now in
+    // the right order.
+    //
+    if (mRing != NULL) {
+      RingDrain (TRUE);
+    }
+    U5UartTxWrite (Buffer, NumberOfBytes);
+    return NumberOfBytes;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  RingDrain (FALSE);
+  Sent = 0;
+  if (mRing->Tail == mRing->Head) {
+    Sent = U5UartTxFill (Buffer, NumberOfBytes);
+  }
+
+  Free = U5_SERIAL_TX_RING_SIZE - (mRing->Head - mRing->Tail);
+  if (NumberOfBytes - Sent > Free) {
+    //
+    // The ring is too small, wait for the UART.
+    //
+    RingDrain (TRUE);
+    if (NumberOfBytes - Sent > U5_SERIAL_TX_RING_SIZE) {
+      U5UartTxWrite (
+        Buffer + Sent,
+        NumberOfBytes - Sent - U5_SERIAL_TX_RING_SIZE
+        );
+      Sent = NumberOfBytes - U5_SERIAL_TX_RING_SIZE;
+    }
+  }
+  RingAppend (Buffer + Sent, NumberOfBytes - Sent);
+
+  gBS->RestoreTPL (OldTpl);
+
+  return NumberOfBytes;
+}
+
+/**
+  Flush the ring and release the events of this driver when it is
+  unloaded.
+
+  @param  ImageHandle   The image handle of the driver.
+  @param  SystemTable   The EFI System Table.
+
+  @retval EFI_SUCCESS   Always.
+
+**/
+EFI_STATUS
+EFIAPI
+DxeSerialPortLibDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  if (mDrainEvent != NULL) {
+    gBS->CloseEvent (mDrainEvent);
+  }
+  if (mExitBootServicesEvent != NULL) {
+    gBS->CloseEvent (mExitBootServicesEvent);
+  }
+  if (mRing != NULL) {
+    RingDrain (TRUE);
+    if (mRingOwner) {
+      mRing->Drained = FALSE;
+    }
+    mRing = NULL;
+  }
+  return EFI_SUCCESS;
+}
@@ -12,12 +12,7 @@
 #include <Library/SerialPortLib.h>
 #include <Include/SifiveU5Uart.h>
 
-//---------------------------------------------
-// UART Register Offsets
-//---------------------------------------------
-
-#define UART_REG_IP     5
-#define UART_IP_RXWM    0x02
+#include "U5Uart.h"
 
 //---------------------------------------------
 // UART Settings
@@ -28,6 +23,64 @@
 
 BOOLEAN Initiated = FALSE;
 
+/**
+  Move as many bytes to the TX FIFO as it takes without waiting.
+
+  @param  Buffer           The bytes to send.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+  @return The number of bytes moved to the FIFO.
+
+**/
+UINTN
+U5UartTxFill (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        NumberOfBytes
+  )
+{
+  UINTN Index;
+  UINTN Room;
+
+  Index = 0;
+  if ((MmioRead32 (UART_REG (UART_REG_IP)) & UART_IP_TXWM) != 0) {
+    //
+    // The FIFO is empty, fill it without checking the full flag.
+    //
+    Room = MIN (NumberOfBytes, UART_TX_FIFO_DEPTH);
+    for (; Index < Room; Index++) {
+      MmioWrite32 (UART_REG (UART_REG_TXFIFO), Buffer[Index]);
+    }
+  }
+
+  while (Index < NumberOfBytes &&
+         (MmioRead32 (UART_REG (UART_REG_TXFIFO)) & UART_TXFIFO_FULL) == 0) {
+    MmioWrite32 (UART_REG (UART_REG_TXFIFO), Buffer[Index]);
+    Index++;
+  }
+
+  return Index;
+}
+
+/**
+  Send bytes, waiting for room in the TX FIFO as needed.
+
+  @param  Buffer           The bytes to send.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+**/
+VOID
+U5UartTxWrite (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        NumberOfBytes
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < NumberOfBytes; ) {
+    Index += U5UartTxFill (Buffer + Index, NumberOfBytes - Index);
+  }
+}
+
 /**
   Initialize the serial device hardware.
 
@@ -51,6 +104,11 @@ SerialPortInitialize (
   if (sifive_uart_init (FixedPcdGet32(PcdU5UartBase), SYS_CLK / 2, UART_BAUDRATE) != 0) {
       return EFI_DEVICE_ERROR;
   }
+  //
+  // Raise the TX watermark when the FIFO is empty, so a whole FIFO worth
+  // of bytes can be written at once without polling the full flag.
+  //
+  MmioWrite32 (UART_REG (UART_REG_TXCTRL), UART_TXCTRL_TXEN | UART_TXCTRL_TXCNT (1));
   Initiated = TRUE;
   return RETURN_SUCCESS;
 }
@@ -81,17 +139,11 @@ SerialPortWrite (
   IN UINTN     NumberOfBytes
   )
 {
-  UINTN Index;
-
   if (Buffer == NULL || Initiated == FALSE) {
     return 0;
   }
 
-  for(Index = 0; Index < NumberOfBytes; Index ++) {
-    sifive_uart_putc (Buffer [Index]);
-  }
-
-  return Index;
+  return U5SerialPortTransmit (Buffer, NumberOfBytes);
 }
 
 /**
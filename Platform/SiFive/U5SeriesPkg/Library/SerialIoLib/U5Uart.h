@@ -0,0 +1,76 @@
+/** @file
+  Register access shared by the U5 UART serial port library instances.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef U5_UART_H_
+#define U5_UART_H_
+
+//---------------------------------------------
+// UART Register Offsets, in 32-bit words
+//---------------------------------------------
+
+#define UART_REG_TXFIFO   0
+#define UART_REG_TXCTRL   2
+#define UART_REG_IE       4
+#define UART_REG_IP       5
+
+#define UART_TXFIFO_FULL  0x80000000
+#define UART_TXCTRL_TXEN  0x1
+#define UART_TXCTRL_TXCNT(Count) ((Count) << 16)
+#define UART_IP_TXWM      0x01
+#define UART_IP_RXWM      0x02
+#define UART_IE_TXWM      0x01
+
+#define UART_TX_FIFO_DEPTH  8
+
+#define UART_REG(Reg)     ((UINTN)FixedPcdGet32 (PcdU5UartBase) + (Reg) * 4)
+
+/**
+  Move as many bytes to the TX FIFO as it takes without waiting.
+
+  @param  Buffer           The bytes to send.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+  @return The number of bytes moved to the FIFO.
+
+**/
+UINTN
+U5UartTxFill (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        NumberOfBytes
+  );
+
+/**
+  Send bytes, waiting for room in the TX FIFO as needed.
+
+  @param  Buffer           The bytes to send.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+**/
+VOID
+U5UartTxWrite (
+  IN CONST UINT8  *Buffer,
+  IN UINTN        NumberOfBytes
+  );
+
+/**
+  Send data to the serial device, as implemented by the library instance.
+
+  @param  Buffer           The bytes to send.
+  @param  NumberOfBytes    The number of bytes in Buffer.
+
+  @return The number of bytes written or queued.
+
+**/
+UINTN
+U5SerialPortTransmit (
+  IN UINT8     *Buffer,
+  IN UINTN     NumberOfBytes
+  );
+
+#endif
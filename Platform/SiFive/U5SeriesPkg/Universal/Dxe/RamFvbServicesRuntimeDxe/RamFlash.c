@@ -5,18 +5,46 @@
 
 **/
 
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/IoLib.h>
 #include <Library/PcdLib.h>
 
 #include "RamFlash.h"
+#include "SpiFlash.h"
 
 VOID *mFlashBase;
 
 STATIC UINTN       mFdBlockSize = 0;
 STATIC UINTN       mFdBlockCount = 0;
 
+//
+// The range of the flash written since the dirty range was last cleared,
+// as offsets from mFlashBase. Adjacent and overlapping writes are merged
+// so a variable update is described by a single range.
+//
+STATIC UINTN       mDirtyStart = MAX_UINTN;
+STATIC UINTN       mDirtyEnd = 0;
+
+/**
+  Add a written range to the dirty range.
+
+  @param[in] Start    Offset of the range from the flash base.
+  @param[in] Length   Length of the range.
+
+**/
+STATIC
+VOID
+RamFlashMarkDirty (
+  IN        UINTN                               Start,
+  IN        UINTN                               Length
+  )
+{
+  mDirtyStart = MIN (mDirtyStart, Start);
+  mDirtyEnd = MAX (mDirtyEnd, Start + Length);
+}
+
 STATIC
 UINT8*
 RamFlashPtr (
@@ -84,8 +112,8 @@ RamFlashWrite (
   IN        UINT8                               *Buffer
   )
 {
-  UINT8  *Ptr;
-  UINTN  i;
+  UINTN  Ptr;
+  UINTN  End;
 
   //
   // Only write to the first 64k. We don't bother saving the FTW Spare
@@ -96,15 +124,103 @@ RamFlashWrite (
   }
 
   //
-  // Program flash
+  // Program flash. Use 64-bit stores for the aligned part of the range,
+  // the FTW reclaim rewrites whole blocks.
   //
-  Ptr = RamFlashPtr (Lba, Offset);
-  for (i = 0; i < *NumBytes; i++) {
-     MmioWrite8((UINTN)Ptr, Buffer[i]);
-     Ptr ++;
+  Ptr = (UINTN)RamFlashPtr (Lba, Offset);
+  End = Ptr + *NumBytes;
+  RamFlashMarkDirty (Ptr - (UINTN)mFlashBase, *NumBytes);
+
+  while ((Ptr < End) && ((Ptr & (sizeof (UINT64) - 1)) != 0)) {
+    MmioWrite8 (Ptr++, *Buffer++);
+  }
+  while (End - Ptr >= sizeof (UINT64)) {
+    MmioWrite64 (Ptr, ReadUnaligned64 ((UINT64 *)Buffer));
+    Ptr += sizeof (UINT64);
+    Buffer += sizeof (UINT64);
+  }
+  while (Ptr < End) {
+    MmioWrite8 (Ptr++, *Buffer++);
   }
 
-  return EFI_SUCCESS;
+  return RamFlashCommitAtRuntime ();
+}
+
+
+/**
+  Get the range written since the dirty range was last cleared.
+
+  @param[out] Start    Offset of the range from the flash base.
+  @param[out] Length   Length of the range, 0 if nothing was written.
+
+**/
+VOID
+RamFlashGetDirtyRange (
+  OUT       UINTN                               *Start,
+  OUT       UINTN                               *Length
+  )
+{
+  if (mDirtyEnd == 0) {
+    *Start = 0;
+    *Length = 0;
+    return;
+  }
+
+  *Start = mDirtyStart;
+  *Length = mDirtyEnd - mDirtyStart;
+}
+
+
+/**
+  Clear the dirty range, once the written data was committed.
+
+**/
+VOID
+RamFlashClearDirtyRange (
+  VOID
+  )
+{
+  mDirtyStart = MAX_UINTN;
+  mDirtyEnd = 0;
+}
+
+
+/**
+  Write the dirty range to the SPI flash backing store.
+
+  The range is extended to whole flash sectors, the RAM copy holds the
+  content of the complete store.
+
+  @retval EFI_SUCCESS       The dirty range was written, or there is no
+                            backing store.
+  @retval EFI_DEVICE_ERROR  The flash could not be updated.
+
+**/
+EFI_STATUS
+RamFlashFlush (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Start;
+  UINTN       End;
+
+  if (!FeaturePcdGet (PcdU5VariableStoreInSpiFlash) || (mDirtyEnd == 0)) {
+    RamFlashClearDirtyRange ();
+    return EFI_SUCCESS;
+  }
+
+  Start = ROUND_DOWN (mDirtyStart, SPI_FLASH_SECTOR_SIZE);
+  End = ALIGN_VALUE (mDirtyEnd, SPI_FLASH_SECTOR_SIZE);
+  Status = SpiFlashUpdate (
+             PcdGet32 (PcdU5SpiFlashVariableOffset) + Start,
+             End - Start,
+             (UINT8 *)mFlashBase + Start
+             );
+  if (!EFI_ERROR (Status)) {
+    RamFlashClearDirtyRange ();
+  }
+  return Status;
 }
 
 
@@ -119,8 +235,18 @@ RamFlashEraseBlock (
   IN   EFI_LBA      Lba
   )
 {
+  if (Lba >= mFdBlockCount) {
+    return EFI_INVALID_PARAMETER;
+  }
 
-  return EFI_SUCCESS;
+  //
+  // Erased flash reads as all ones, the FTW spare and working blocks
+  // depend on it.
+  //
+  SetMem (RamFlashPtr (Lba, 0), mFdBlockSize, 0xFF);
+  RamFlashMarkDirty ((UINTN)Lba * mFdBlockSize, mFdBlockSize);
+
+  return RamFlashCommitAtRuntime ();
 }
 
 
@@ -136,10 +262,43 @@ RamFlashInitialize (
   VOID
   )
 {
+  EFI_STATUS                  Status;
+  EFI_FIRMWARE_VOLUME_HEADER  FwVolHeader;
+
   mFlashBase = (UINT8*)(UINTN) PcdGet32 (PcdVariableFdBaseAddress);
   mFdBlockSize = PcdGet32 (PcdVariableFdBlockSize);
   ASSERT(PcdGet32 (PcdVariableFdSize) % mFdBlockSize == 0);
   mFdBlockCount = PcdGet32 (PcdVariableFdSize) / mFdBlockSize;
 
+  if (FeaturePcdGet (PcdU5VariableStoreInSpiFlash)) {
+    Status = SpiFlashInitialize ();
+    if (EFI_ERROR (Status)) {
+      return EFI_WRITE_PROTECTED;
+    }
+
+    //
+    // Load the store saved in the flash. If the flash holds no variable
+    // FV yet, keep the store of the firmware image and save it at the
+    // first flush.
+    //
+    SpiFlashRead (
+      PcdGet32 (PcdU5SpiFlashVariableOffset),
+      sizeof (FwVolHeader),
+      (UINT8 *)&FwVolHeader
+      );
+    if (FwVolHeader.Signature == EFI_FVH_SIGNATURE) {
+      SpiFlashRead (
+        PcdGet32 (PcdU5SpiFlashVariableOffset),
+        PcdGet32 (PcdVariableFdSize),
+        mFlashBase
+        );
+    } else {
+      DEBUG ((DEBUG_INFO, "%a: No variable store in SPI flash\n", __FUNCTION__));
+      RamFlashMarkDirty (0, PcdGet32 (PcdVariableFdSize));
+    }
+
+    RamFlashInstallFlushHandler ();
+  }
+
   return EFI_SUCCESS;
 }
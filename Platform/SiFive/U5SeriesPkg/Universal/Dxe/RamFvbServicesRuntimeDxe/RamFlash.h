@@ -52,6 +52,71 @@ RamFlashWrite (
   );
 
 
+/**
+  Get the range written since the dirty range was last cleared.
+
+  @param[out] Start    Offset of the range from the flash base.
+  @param[out] Length   Length of the range, 0 if nothing was written.
+
+**/
+VOID
+RamFlashGetDirtyRange (
+  OUT       UINTN                               *Start,
+  OUT       UINTN                               *Length
+  );
+
+
+/**
+  Clear the dirty range, once the written data was committed.
+
+**/
+VOID
+RamFlashClearDirtyRange (
+  VOID
+  );
+
+
+/**
+  Write the dirty range to the SPI flash backing store.
+
+  @retval EFI_SUCCESS       The dirty range was written, or there is no
+                            backing store.
+  @retval EFI_DEVICE_ERROR  The flash could not be updated.
+
+**/
+EFI_STATUS
+RamFlashFlush (
+  VOID
+  );
+
+
+/**
+  Flush the dirty range if running at OS runtime.
+
+  During boot services writes are only committed at ExitBootServices. At
+  runtime there is no later point, so every write is committed as it is
+  done, which also keeps the write ordering the FTW relies on.
+
+  @retval EFI_SUCCESS       Nothing to do or the range was written.
+  @retval EFI_DEVICE_ERROR  The flash could not be updated.
+
+**/
+EFI_STATUS
+RamFlashCommitAtRuntime (
+  VOID
+  );
+
+
+/**
+  Register the ExitBootServices handler which flushes the dirty range.
+
+**/
+VOID
+RamFlashInstallFlushHandler (
+  VOID
+  );
+
+
 /**
   Erase a Ram Flash block
 
@@ -7,9 +7,13 @@
 
 **/
 
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiRuntimeLib.h>
 
 #include "RamFlash.h"
+#include "SpiFlash.h"
 
 VOID
 RamFlashConvertPointers (
@@ -17,4 +21,52 @@ RamFlashConvertPointers (
   )
 {
   EfiConvertPointer (0x0, (VOID **) &mFlashBase);
+  if (FeaturePcdGet (PcdU5VariableStoreInSpiFlash)) {
+    SpiFlashConvertPointers ();
+  }
+}
+
+EFI_STATUS
+RamFlashCommitAtRuntime (
+  VOID
+  )
+{
+  if (!EfiAtRuntime ()) {
+    return EFI_SUCCESS;
+  }
+  return RamFlashFlush ();
+}
+
+STATIC
+VOID
+EFIAPI
+RamFlashExitBootServicesEvent (
+  IN EFI_EVENT        Event,
+  IN VOID             *Context
+  )
+{
+  EFI_STATUS Status;
+
+  Status = RamFlashFlush ();
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "RAM Flash: Failed to save variables: %r\n", Status));
+  }
+}
+
+VOID
+RamFlashInstallFlushHandler (
+  VOID
+  )
+{
+  EFI_STATUS Status;
+  EFI_EVENT  ExitBootServicesEvent;
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_NOTIFY,
+                  RamFlashExitBootServicesEvent,
+                  NULL,
+                  &ExitBootServicesEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
 }
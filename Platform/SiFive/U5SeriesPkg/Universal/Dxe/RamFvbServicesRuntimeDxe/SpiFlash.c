@@ -0,0 +1,323 @@
+/** @file
+  SPI NOR flash behind the SiFive SPI controller, used as the backing store
+  of the RAM flash device.
+
+  The controller is switched from memory-mapped mode to programmed I/O for
+  every operation and back afterwards, so the flash stays readable through
+  its memory-mapped window by other code.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/DebugLib.h>
+#include <Library/DxeServicesTableLib.h>
+#include <Library/IoLib.h>
+#include <Library/PcdLib.h>
+#include <Library/UefiRuntimeLib.h>
+
+#include "SpiFlash.h"
+
+STATIC UINTN  mSpiBase;
+
+/**
+  Exchange a byte with the flash.
+
+  @param[in] Data   The byte to send.
+
+  @return The byte received.
+
+**/
+STATIC
+UINT8
+SpiTransfer (
+  IN        UINT8                               Data
+  )
+{
+  UINT32  Rx;
+
+  while ((MmioRead32 (mSpiBase + SPI_REG_TXDATA) & SPI_TXDATA_FULL) != 0);
+  MmioWrite32 (mSpiBase + SPI_REG_TXDATA, Data);
+  do {
+    Rx = MmioRead32 (mSpiBase + SPI_REG_RXDATA);
+  } while ((Rx & SPI_RXDATA_EMPTY) != 0);
+
+  return (UINT8)Rx;
+}
+
+/**
+  Assert chip select and send a command, optionally with an address.
+
+  @param[in] Opcode       The command.
+  @param[in] HasAddress   TRUE to send Address after the command.
+  @param[in] Address      The 4-byte flash address.
+
+**/
+STATIC
+VOID
+SpiCommandBegin (
+  IN        UINT8                               Opcode,
+  IN        BOOLEAN                             HasAddress,
+  IN        UINTN                               Address
+  )
+{
+  MmioWrite32 (mSpiBase + SPI_REG_CSMODE, SPI_CSMODE_HOLD);
+  SpiTransfer (Opcode);
+  if (HasAddress) {
+    SpiTransfer ((UINT8)(Address >> 24));
+    SpiTransfer ((UINT8)(Address >> 16));
+    SpiTransfer ((UINT8)(Address >> 8));
+    SpiTransfer ((UINT8)Address);
+  }
+}
+
+/**
+  Deassert chip select, ending the command.
+
+**/
+STATIC
+VOID
+SpiCommandEnd (
+  VOID
+  )
+{
+  MmioWrite32 (mSpiBase + SPI_REG_CSMODE, SPI_CSMODE_AUTO);
+}
+
+/**
+  Wait until the flash completed an erase or program.
+
+  @retval EFI_SUCCESS       The flash is idle.
+  @retval EFI_DEVICE_ERROR  The flash stayed busy.
+
+**/
+STATIC
+EFI_STATUS
+SpiFlashWaitReady (
+  VOID
+  )
+{
+  UINTN  Poll;
+  UINT8  Status;
+
+  for (Poll = 0; Poll < SPI_FLASH_WIP_POLL_LIMIT; Poll++) {
+    SpiCommandBegin (SPI_FLASH_CMD_READ_STATUS, FALSE, 0);
+    Status = SpiTransfer (0);
+    SpiCommandEnd ();
+    if ((Status & SPI_FLASH_STATUS_WIP) == 0) {
+      return EFI_SUCCESS;
+    }
+  }
+
+  return EFI_DEVICE_ERROR;
+}
+
+/**
+  Send a command which modifies the flash, once write is enabled.
+
+  @param[in] Opcode   The erase or program command.
+  @param[in] Address  The flash address.
+  @param[in] Buffer   The data to program, NULL for an erase.
+  @param[in] Length   The number of bytes to program.
+
+  @retval EFI_SUCCESS       The command completed.
+  @retval EFI_DEVICE_ERROR  The flash stayed busy.
+
+**/
+STATIC
+EFI_STATUS
+SpiFlashModify (
+  IN        UINT8                               Opcode,
+  IN        UINTN                               Address,
+  IN        UINT8                               *Buffer,
+  IN        UINTN                               Length
+  )
+{
+  SpiCommandBegin (SPI_FLASH_CMD_WRITE_ENABLE, FALSE, 0);
+  SpiCommandEnd ();
+
+  SpiCommandBegin (Opcode, TRUE, Address);
+  while (Length-- > 0) {
+    SpiTransfer (*Buffer++);
+  }
+  SpiCommandEnd ();
+
+  return SpiFlashWaitReady ();
+}
+
+/**
+  Switch the controller to programmed I/O.
+
+  @return The previous flash control register value.
+
+**/
+STATIC
+UINT32
+SpiFlashBeginAccess (
+  VOID
+  )
+{
+  UINT32  FlashControl;
+
+  FlashControl = MmioRead32 (mSpiBase + SPI_REG_FCTRL);
+  MmioWrite32 (mSpiBase + SPI_REG_FCTRL, FlashControl & ~SPI_FCTRL_EN);
+  MmioWrite32 (mSpiBase + SPI_REG_FMT, SPI_FMT_LEN_8);
+  return FlashControl;
+}
+
+/**
+  Restore the memory-mapped mode of the controller.
+
+  @param[in] FlashControl  The value returned by SpiFlashBeginAccess().
+
+**/
+STATIC
+VOID
+SpiFlashEndAccess (
+  IN        UINT32                              FlashControl
+  )
+{
+  MmioWrite32 (mSpiBase + SPI_REG_FCTRL, FlashControl);
+}
+
+/**
+  Read from the SPI flash.
+
+  @param[in]  Offset    Offset in the flash to read from.
+  @param[in]  Length    Number of bytes to read.
+  @param[out] Buffer    Buffer to read into.
+
+**/
+VOID
+SpiFlashRead (
+  IN        UINTN                               Offset,
+  IN        UINTN                               Length,
+  OUT       UINT8                               *Buffer
+  )
+{
+  UINT32  FlashControl;
+
+  FlashControl = SpiFlashBeginAccess ();
+  SpiCommandBegin (SPI_FLASH_CMD_READ_4B, TRUE, Offset);
+  while (Length-- > 0) {
+    *Buffer++ = SpiTransfer (0);
+  }
+  SpiCommandEnd ();
+  SpiFlashEndAccess (FlashControl);
+}
+
+/**
+  Replace the content of whole flash sectors.
+
+  Pages which are erased in the new content are not programmed.
+
+  @param[in]  Offset    Offset in the flash, sector aligned.
+  @param[in]  Length    Number of bytes, multiple of the sector size.
+  @param[in]  Buffer    The new content of the sectors.
+
+  @retval EFI_SUCCESS       The sectors were updated.
+  @retval EFI_DEVICE_ERROR  The flash didn't complete an erase or program.
+
+**/
+EFI_STATUS
+SpiFlashUpdate (
+  IN        UINTN                               Offset,
+  IN        UINTN                               Length,
+  IN        UINT8                               *Buffer
+  )
+{
+  EFI_STATUS  Status;
+  UINT32      FlashControl;
+  UINTN       End;
+  UINTN       Index;
+
+  ASSERT ((Offset % SPI_FLASH_SECTOR_SIZE) == 0);
+  ASSERT ((Length % SPI_FLASH_SECTOR_SIZE) == 0);
+
+  Status = EFI_SUCCESS;
+  FlashControl = SpiFlashBeginAccess ();
+  for (End = Offset + Length; Offset < End; Offset += SPI_FLASH_PAGE_SIZE) {
+    if ((Offset % SPI_FLASH_SECTOR_SIZE) == 0) {
+      Status = SpiFlashModify (SPI_FLASH_CMD_SECTOR_ERASE_4B, Offset, NULL, 0);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    for (Index = 0; Index < SPI_FLASH_PAGE_SIZE; Index++) {
+      if (Buffer[Index] != 0xFF) {
+        break;
+      }
+    }
+    if (Index < SPI_FLASH_PAGE_SIZE) {
+      Status = SpiFlashModify (
+                 SPI_FLASH_CMD_PAGE_PROGRAM_4B,
+                 Offset,
+                 Buffer,
+                 SPI_FLASH_PAGE_SIZE
+                 );
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+    Buffer += SPI_FLASH_PAGE_SIZE;
+  }
+  SpiFlashEndAccess (FlashControl);
+
+  return Status;
+}
+
+/**
+  Initialize access to the SPI flash controller.
+
+  The controller registers are added to the GCD memory space map as runtime
+  MMIO so variables can still be committed after ExitBootServices.
+
+  @retval EFI_SUCCESS   The controller is ready.
+  @retval Others        The controller registers could not be mapped for
+                        runtime access.
+
+**/
+EFI_STATUS
+SpiFlashInitialize (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+
+  mSpiBase = (UINTN)PcdGet32 (PcdU5SpiFlashControllerBase);
+
+  //
+  // The range may already be in the map, then only the attributes change.
+  //
+  gDS->AddMemorySpace (
+         EfiGcdMemoryTypeMemoryMappedIo,
+         mSpiBase,
+         SPI_REG_SIZE,
+         EFI_MEMORY_UC | EFI_MEMORY_RUNTIME
+         );
+  Status = gDS->SetMemorySpaceAttributes (
+                  mSpiBase,
+                  SPI_REG_SIZE,
+                  EFI_MEMORY_UC | EFI_MEMORY_RUNTIME
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Can't map SPI controller for runtime: %r\n", __FUNCTION__, Status));
+  }
+  return Status;
+}
+
+/**
+  Convert the controller base address for runtime use.
+
+**/
+VOID
+SpiFlashConvertPointers (
+  VOID
+  )
+{
+  EfiConvertPointer (0x0, (VOID **) &mSpiBase);
+}
@@ -0,0 +1,109 @@
+/** @file
+  SPI NOR flash behind the SiFive SPI controller, used as the backing store
+  of the RAM flash device.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef SPI_FLASH_H_
+#define SPI_FLASH_H_
+
+//
+// SiFive SPI controller registers.
+//
+#define SPI_REG_SCKDIV      0x00
+#define SPI_REG_SCKMODE     0x04
+#define SPI_REG_CSID        0x10
+#define SPI_REG_CSDEF       0x14
+#define SPI_REG_CSMODE      0x18
+  #define SPI_CSMODE_AUTO   0
+  #define SPI_CSMODE_HOLD   2
+#define SPI_REG_FMT         0x40
+  #define SPI_FMT_LEN_8     (8 << 16)
+#define SPI_REG_TXDATA      0x48
+  #define SPI_TXDATA_FULL   BIT31
+#define SPI_REG_RXDATA      0x4C
+  #define SPI_RXDATA_EMPTY  BIT31
+#define SPI_REG_FCTRL       0x60
+  #define SPI_FCTRL_EN      BIT0
+
+#define SPI_REG_SIZE        SIZE_4KB
+
+//
+// SPI NOR commands, 4-byte address variants.
+//
+#define SPI_FLASH_CMD_WRITE_ENABLE    0x06
+#define SPI_FLASH_CMD_READ_STATUS     0x05
+  #define SPI_FLASH_STATUS_WIP        BIT0
+#define SPI_FLASH_CMD_READ_4B         0x13
+#define SPI_FLASH_CMD_PAGE_PROGRAM_4B 0x12
+#define SPI_FLASH_CMD_SECTOR_ERASE_4B 0x21
+
+#define SPI_FLASH_PAGE_SIZE           256
+#define SPI_FLASH_SECTOR_SIZE         SIZE_4KB
+
+//
+// Polls of the status register before an erase or program is considered
+// failed.
+//
+#define SPI_FLASH_WIP_POLL_LIMIT      10000000
+
+/**
+  Initialize access to the SPI flash controller.
+
+  @retval EFI_SUCCESS   The controller is ready.
+  @retval Others        The controller registers could not be mapped for
+                        runtime access.
+
+**/
+EFI_STATUS
+SpiFlashInitialize (
+  VOID
+  );
+
+/**
+  Read from the SPI flash.
+
+  @param[in]  Offset    Offset in the flash to read from.
+  @param[in]  Length    Number of bytes to read.
+  @param[out] Buffer    Buffer to read into.
+
+**/
+VOID
+SpiFlashRead (
+  IN        UINTN                               Offset,
+  IN        UINTN                               Length,
+  OUT       UINT8                               *Buffer
+  );
+
+/**
+  Replace the content of whole flash sectors.
+
+  @param[in]  Offset    Offset in the flash, sector aligned.
+  @param[in]  Length    Number of bytes, multiple of the sector size.
+  @param[in]  Buffer    The new content of the sectors.
+
+  @retval EFI_SUCCESS       The sectors were updated.
+  @retval EFI_DEVICE_ERROR  The flash didn't complete an erase or program.
+
+**/
+EFI_STATUS
+SpiFlashUpdate (
+  IN        UINTN                               Offset,
+  IN        UINTN                               Length,
+  IN        UINT8                               *Buffer
+  );
+
+/**
+  Convert the controller base address for runtime use.
+
+**/
+VOID
+SpiFlashConvertPointers (
+  VOID
+  );
+
+#endif
@@ -13,6 +13,7 @@
 #include <sbi/riscv_encoding.h>
 #include <sbi/riscv_io.h>
 #include <sbi/riscv_atomic.h>
+#include <IndustryStandard/RiscV.h>
 #include <U5Clint.h>
 
 STATIC volatile VOID * const p_mtime = (VOID *)CLINT_REG_MTIME;
@@ -47,9 +48,49 @@ EFI_CPU_ARCH_PROTOCOL *mCpu;
 STATIC EFI_TIMER_NOTIFY mTimerNotifyFunction;
 
 //
-// The current period of the timer interrupt
+// The current period of the timer interrupt in 100 ns units, and the same
+// period in timer ticks.
 //
 STATIC UINT64 mTimerPeriod = 0;
+STATIC UINT64 mTimerPeriodTicks = 0;
+
+//
+// The timer value when the notify function was last called.
+//
+STATIC UINT64 mLastNotifyTime = 0;
+
+/**
+  Program a one-shot timer interrupt at the given timer value.
+
+  With Sstc the compare register is written directly, otherwise the
+  deadline is set through the SBI firmware.
+
+  @param Deadline    The timer value to interrupt at.
+**/
+STATIC
+VOID
+TimerProgramDeadline (
+  IN UINT64  Deadline
+  )
+{
+  if (FeaturePcdGet (PcdRiscVSstcSupported)) {
+    csr_write (RISCV_CSR_SUPERVISOR_STIMECMP, Deadline);
+  } else {
+    SbiSetTimer (Deadline);
+  }
+}
+
+/**
+  Program the next timer interrupt one timer period from now.
+**/
+STATIC
+VOID
+TimerProgramNextTick (
+  VOID
+  )
+{
+  TimerProgramDeadline (readq_relaxed (p_mtime) + mTimerPeriodTicks);
+}
 
 /**
   U5 Series Timer Interrupt Handler.
@@ -66,15 +107,15 @@ TimerInterruptHandler (
   )
 {
   EFI_TPL OriginalTPL;
-  UINT64 RiscvTimer;
+  UINT64 Now;
+  UINT64 Elapsed;
 
   if (TimerHandlerReentry) {
     //
     // MMode timer occurred when processing
     // SMode timer handler.
     //
-    RiscvTimer = readq_relaxed(p_mtime);
-    SbiSetTimer (RiscvTimer += mTimerPeriod);
+    TimerProgramNextTick ();
     csr_clear(CSR_SIP, MIP_STIP);
     return;
   }
@@ -85,14 +126,28 @@ TimerInterruptHandler (
   csr_clear(CSR_SIP, MIP_STIP);
   if (mTimerPeriod == 0) {
     gBS->RestoreTPL (OriginalTPL);
-    csr_clear(CSR_SIE, MIP_STIP); // Disable SMode timer int
+    TimerHandlerReentry = FALSE;
     return;
   }
+
+  //
+  // The timer runs in one-shot mode, each interrupt programs the next
+  // deadline only. Report the time which really elapsed since the last
+  // call so that late interrupts don't slow down the DXE core timer events.
+  //
+  Now = readq_relaxed(p_mtime);
+  Elapsed = Now - mLastNotifyTime;
+  mLastNotifyTime = Now;
   if (mTimerNotifyFunction != NULL) {
-      mTimerNotifyFunction (mTimerPeriod);
+    mTimerNotifyFunction (
+      DivU64x64Remainder (
+        MultU64x32 (Elapsed, 10000000),
+        PcdGet64 (PcdRiscVMachineTimerFrequencyInHerz),
+        NULL
+        )
+      );
   }
-  RiscvTimer = readq_relaxed(p_mtime);
-  SbiSetTimer (RiscvTimer += mTimerPeriod);
+  TimerProgramNextTick ();
   gBS->RestoreTPL (OriginalTPL);
   csr_set(CSR_SIE, MIP_STIP); // enable SMode timer int
   TimerHandlerReentry = FALSE;
@@ -175,8 +230,6 @@ TimerDriverSetTimerPeriod (
   IN UINT64                   TimerPeriod
   )
 {
-  UINT64 RiscvTimer;
-
   DEBUG ((DEBUG_INFO, "TimerDriverSetTimerPeriod(0x%lx)\n", TimerPeriod));
 
   if (TimerPeriod == 0) {
@@ -185,10 +238,18 @@ TimerDriverSetTimerPeriod (
     return EFI_SUCCESS;
   }
 
-  mTimerPeriod = TimerPeriod / 10; // convert unit from 100ns to 1us
-
-  RiscvTimer = readq_relaxed(p_mtime);
-  SbiSetTimer(RiscvTimer + mTimerPeriod);
+  //
+  // Convert the period from 100 ns units to timer ticks, rounding up.
+  //
+  mTimerPeriodTicks = DivU64x64Remainder (
+                        MultU64x64 (TimerPeriod, PcdGet64 (PcdRiscVMachineTimerFrequencyInHerz)) + 10000000 - 1,
+                        10000000,
+                        NULL
+                        );
+  mTimerPeriod = TimerPeriod;
+
+  mLastNotifyTime = readq_relaxed(p_mtime);
+  TimerProgramDeadline (mLastNotifyTime + mTimerPeriodTicks);
 
   mCpu->EnableInterrupt(mCpu);
   csr_set(CSR_SIE, MIP_STIP); // enable timer int
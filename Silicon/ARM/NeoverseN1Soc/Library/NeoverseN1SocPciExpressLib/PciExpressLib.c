@@ -10,7 +10,9 @@
   On the NeoverseN1Soc, a slave error is generated when host accesses the
   configuration space of non-available device or unimplemented function on a
   given bus. So this library introduces a workaround using IsBdfValid(),
-  to return 0xFFFFFFFF for all such access.
+  to return 0xFFFFFFFF for all such access. The table of valid BDFs shared by
+  SCP is read once into a bitmap, so the check does not walk the SRAM table on
+  every access.
 
   In addition to this, the hardware has two other limitations which affect
   access to the PCIe root port:
@@ -27,13 +29,19 @@
 **/
 
 
-#include <Base.h>
+#include <PiDxe.h>
+
+#include <Guid/EventGroup.h>
 
 #include <Library/BaseLib.h>
 #include <Library/PciExpressLib.h>
 #include <Library/IoLib.h>
 #include <Library/DebugLib.h>
+#include <Library/DxeServicesTableLib.h>
+#include <Library/MemoryAllocationLib.h>
 #include <Library/PcdLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiRuntimeServicesTableLib.h>
 #include <NeoverseN1Soc.h>
 
 /**
@@ -59,6 +67,10 @@
 #define GET_FUNC_NUM(Address)   (((Address) >> 12) & 0x07)
 #define GET_REG_NUM(Address)    ((Address) & 0xFFF)
 
+/* One bit per bus/device/function of the valid BDF bitmap */
+#define BDF_MAP_INDEX(Address)  (((Address) >> 12) & 0xFFFF)
+#define BDF_MAP_SIZE            (SIZE_64KB / 8)
+
 /**
   BDF Table structure : (Header + BDF Entries)
   --------------------------------------------
@@ -81,58 +93,87 @@
 STATIC UINTN mDummyConfigData = 0xFFFFFFFF;
 
 /**
-  Registers a PCI device so PCI configuration registers may be accessed after
-  SetVirtualAddressMap().
+  Bitmap of the valid BDFs, built from the BDF table on first use.
+**/
+STATIC UINT8   mBdfValidMap[BDF_MAP_SIZE];
+STATIC BOOLEAN mBdfValidMapReady = FALSE;
 
-  Registers the PCI device specified by Address so all the PCI configuration
-  registers associated with that PCI device may be accessed after SetVirtualAddressMap()
-  is called.
+/**
+  Table of the configuration spaces registered for runtime access.
+**/
+typedef struct {
+  UINTN  PhysicalAddress;
+  UINTN  VirtualAddress;
+} PCI_EXPRESS_RUNTIME_REGISTRATION_TABLE;
 
-  If Address > 0x0FFFFFFF, then ASSERT().
+STATIC PCI_EXPRESS_RUNTIME_REGISTRATION_TABLE *mRegistrationTable = NULL;
+STATIC UINTN                                  mNumberOfRegistrations = 0;
+STATIC EFI_EVENT                              mVirtualAddressChangeEvent = NULL;
+STATIC BOOLEAN                                mGoneVirtual = FALSE;
 
-  @param  Address The address that encodes the PCI Bus, Device, Function and
-                  Register.
+/**
+  Convert the physical addresses of the registered configuration spaces
+  to virtual addresses.
 
-  @retval RETURN_SUCCESS           The PCI device was registered for runtime access.
-  @retval RETURN_UNSUPPORTED       An attempt was made to call this function
-                                   after ExitBootServices().
-  @retval RETURN_UNSUPPORTED       The resources required to access the PCI device
-                                   at runtime could not be mapped.
-  @retval RETURN_OUT_OF_RESOURCES  There are not enough resources available to
-                                   complete the registration.
+  @param[in]  Event   The event that is being processed.
+  @param[in]  Context The event context.
 
 **/
-RETURN_STATUS
+STATIC
+VOID
 EFIAPI
-PciExpressRegisterForRuntimeAccess (
-  IN UINTN  Address
+PciExpressVirtualAddressChange (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
   )
 {
-  ASSERT_INVALID_PCI_ADDRESS (Address);
-  return RETURN_UNSUPPORTED;
+  UINTN  Index;
+
+  for (Index = 0; Index < mNumberOfRegistrations; Index++) {
+    gRT->ConvertPointer (0, (VOID **)&mRegistrationTable[Index].VirtualAddress);
+  }
+  gRT->ConvertPointer (0, (VOID **)&mRegistrationTable);
+
+  mGoneVirtual = TRUE;
 }
 
 /**
-  Check if the requested PCI address can be safely accessed.
+  Close the virtual address change event of the library.
 
-  SCP performs the initial bus scan, prepares a table of valid BDF addresses
-  and shares them through non-trusted SRAM. This function validates if the
-  requested PCI address belongs to a valid BDF by checking the table of valid
-  entries. If not, this function will return false. This is a workaround to
-  avoid bus fault that occurs when accessing unavailable PCI device due to
-  hardware bug.
+  @param  ImageHandle   The firmware allocated handle for the EFI image.
+  @param  SystemTable   A pointer to the EFI System Table.
 
-  @param  Address The address that encodes the PCI Bus, Device, Function and
-                  Register.
+  @retval EFI_SUCCESS   The destructor always returns EFI_SUCCESS.
 
-  @return TRUE    BDF can be accessed, valid.
-  @return FALSE   BDF should not be accessed, invalid.
+**/
+EFI_STATUS
+EFIAPI
+PciExpressLibDestructor (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  if (mVirtualAddressChangeEvent != NULL) {
+    gBS->CloseEvent (mVirtualAddressChangeEvent);
+  }
+  if (mRegistrationTable != NULL) {
+    FreePool (mRegistrationTable);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Build the bitmap of the valid BDFs from the table shared by SCP.
+
+  The table is read only once, the bitmap lives in the image of the module
+  so it remains accessible at runtime.
 
 **/
 STATIC
-BOOLEAN
-IsBdfValid (
-  IN      UINTN                     Address
+VOID
+BuildBdfValidMap (
+  VOID
   )
 {
   UINTN BdfCount;
@@ -140,22 +181,57 @@ IsBdfValid (
   UINTN BdfEntry;
   UINTN Count;
   UINTN TableBase;
-  UINTN ConfigBase;
+  UINTN Index;
 
-  ConfigBase = Address & ~0xFFF;
   TableBase = NEOVERSEN1SOC_NON_SECURE_SRAM_BASE + PCIE_BDF_TABLE_OFFSET;
   BdfCount = MmioRead32 (TableBase + BDF_TABLE_ENTRY_SIZE);
   BdfEntry = TableBase + BDF_TABLE_HEADER_SIZE;
 
-  /* Skip the header & check remaining entry */
+  /* Skip the header & record remaining entry */
   for (Count = 0; Count < BdfCount; Count++, BdfEntry += BDF_TABLE_ENTRY_SIZE) {
     BdfValue = MmioRead32 (BdfEntry);
-    if (BdfValue == ConfigBase) {
-      return TRUE;
+    /* Entries outside the 28 bit PCI address range can never match */
+    if ((BdfValue & ~0xFFFF000) != 0) {
+      continue;
     }
+    Index = BDF_MAP_INDEX (BdfValue);
+    mBdfValidMap[Index / 8] |= (UINT8)(1 << (Index % 8));
   }
 
-  return FALSE;
+  mBdfValidMapReady = TRUE;
+}
+
+/**
+  Check if the requested PCI address can be safely accessed.
+
+  SCP performs the initial bus scan, prepares a table of valid BDF addresses
+  and shares them through non-trusted SRAM. This function validates if the
+  requested PCI address belongs to a valid BDF by checking the bitmap built
+  from the table of valid entries. If not, this function will return false.
+  This is a workaround to avoid bus fault that occurs when accessing
+  unavailable PCI device due to hardware bug.
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+
+  @return TRUE    BDF can be accessed, valid.
+  @return FALSE   BDF should not be accessed, invalid.
+
+**/
+STATIC
+BOOLEAN
+IsBdfValid (
+  IN      UINTN                     Address
+  )
+{
+  UINTN Index;
+
+  if (!mBdfValidMapReady) {
+    BuildBdfValidMap ();
+  }
+
+  Index = BDF_MAP_INDEX (Address);
+  return (mBdfValidMap[Index / 8] & (1 << (Index % 8))) != 0;
 }
 
 /**
@@ -188,6 +264,7 @@ GetPciExpressAddress (
 {
   UINT8 Bus, Device, Function;
   UINTN ConfigAddress;
+  UINTN Index;
 
   Bus = GET_BUS_NUM (Address);
   Device = GET_DEV_NUM (Address);
@@ -196,13 +273,128 @@ GetPciExpressAddress (
   if ((Bus == 0) && (Device == 0) && (Function == 0)) {
     ConfigAddress = PcdGet32 (PcdPcieRootPortConfigBaseAddress) + Address;
   } else {
-    ConfigAddress = PcdGet64 (PcdPciExpressBaseAddress) + Address;
     if (!IsBdfValid(Address)) {
-      ConfigAddress = (UINTN)&mDummyConfigData;
+      return (VOID *)&mDummyConfigData;
     }
+    ConfigAddress = PcdGet64 (PcdPciExpressBaseAddress) + Address;
+  }
+
+  if (!mGoneVirtual) {
+    return (VOID *)ConfigAddress;
+  }
+
+  /* Translate the address with the table of runtime registrations */
+  for (Index = 0; Index < mNumberOfRegistrations; Index++) {
+    if ((ConfigAddress & ~0xFFF) == mRegistrationTable[Index].PhysicalAddress) {
+      return (VOID *)(mRegistrationTable[Index].VirtualAddress +
+                      (ConfigAddress & 0xFFF));
+    }
+  }
+
+  /* The configuration space was not registered for runtime access */
+  ASSERT (FALSE);
+  CpuDeadLoop ();
+  return (VOID *)&mDummyConfigData;
+}
+
+/**
+  Registers a PCI device so PCI configuration registers may be accessed after
+  SetVirtualAddressMap().
+
+  Registers the PCI device specified by Address so all the PCI configuration
+  registers associated with that PCI device may be accessed after SetVirtualAddressMap()
+  is called.
+
+  If Address > 0x0FFFFFFF, then ASSERT().
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+
+  The bitmap of the valid BDFs is built here at the latest, while the BDF
+  table in SRAM is still accessible.
+
+  @retval RETURN_SUCCESS           The PCI device was registered for runtime access.
+  @retval RETURN_UNSUPPORTED       An attempt was made to call this function
+                                   after ExitBootServices().
+  @retval RETURN_UNSUPPORTED       The resources required to access the PCI device
+                                   at runtime could not be mapped.
+  @retval RETURN_OUT_OF_RESOURCES  There are not enough resources available to
+                                   complete the registration.
+
+**/
+RETURN_STATUS
+EFIAPI
+PciExpressRegisterForRuntimeAccess (
+  IN UINTN  Address
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  Descriptor;
+  UINTN                            ConfigAddress;
+  UINTN                            Index;
+  VOID                             *NewTable;
+
+  ASSERT_INVALID_PCI_ADDRESS (Address);
+
+  if (mGoneVirtual) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  /* Invalid BDFs are never accessed, nothing to map for them */
+  ConfigAddress = (UINTN)GetPciExpressAddress (Address & ~0xFFF);
+  if (ConfigAddress == (UINTN)&mDummyConfigData) {
+    return RETURN_SUCCESS;
+  }
+
+  for (Index = 0; Index < mNumberOfRegistrations; Index++) {
+    if (mRegistrationTable[Index].PhysicalAddress == ConfigAddress) {
+      return RETURN_SUCCESS;
+    }
+  }
+
+  Status = gDS->GetMemorySpaceDescriptor (ConfigAddress, &Descriptor);
+  if (EFI_ERROR (Status)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  /* Mark the 4 KB configuration space of the function as runtime memory */
+  Status = gDS->SetMemorySpaceAttributes (
+                  ConfigAddress & ~(EFI_PAGE_SIZE - 1),
+                  EFI_PAGE_SIZE,
+                  Descriptor.Attributes | EFI_MEMORY_RUNTIME
+                  );
+  if (EFI_ERROR (Status)) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  if (mVirtualAddressChangeEvent == NULL) {
+    Status = gBS->CreateEventEx (
+                    EVT_NOTIFY_SIGNAL,
+                    TPL_NOTIFY,
+                    PciExpressVirtualAddressChange,
+                    NULL,
+                    &gEfiEventVirtualAddressChangeGuid,
+                    &mVirtualAddressChangeEvent
+                    );
+    if (EFI_ERROR (Status)) {
+      return RETURN_OUT_OF_RESOURCES;
+    }
+  }
+
+  NewTable = ReallocateRuntimePool (
+               mNumberOfRegistrations * sizeof (PCI_EXPRESS_RUNTIME_REGISTRATION_TABLE),
+               (mNumberOfRegistrations + 1) * sizeof (PCI_EXPRESS_RUNTIME_REGISTRATION_TABLE),
+               mRegistrationTable
+               );
+  if (NewTable == NULL) {
+    return RETURN_OUT_OF_RESOURCES;
   }
+  mRegistrationTable = NewTable;
+  mRegistrationTable[mNumberOfRegistrations].PhysicalAddress = ConfigAddress;
+  mRegistrationTable[mNumberOfRegistrations].VirtualAddress  = ConfigAddress;
+  mNumberOfRegistrations++;
 
-  return (VOID *)ConfigAddress;
+  return RETURN_SUCCESS;
 }
 
 /**
@@ -12,9 +12,21 @@
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
 
 #define MAX_RETRIES                 5
 
+#define WAKE_DELAY_US               2500          // time for wake to complete
+#define RANDOM_EXEC_TIME_US         (50 * 1000)   // max execution time for RANDOM
+#define POLL_INTERVAL_US            1000
+
+//
+// The watchdog puts the device back to sleep ~1.3 seconds after the wake
+// sequence, regardless of what it is doing. Only skip the wake sequence if a
+// whole RANDOM command fits well within that window.
+//
+#define WAKE_WINDOW_NS              (500ULL * 1000 * 1000)
+
 // Don't bother calculating the CRC for the immutable RANDOM opcode packet
 #define OPCODE_COMMAND_PACKET_CRC   0xcd24
 
@@ -75,6 +87,46 @@ AtSha240aGetInfo (
 }
 
 
+/**
+  Wake the device up, unless it was woken up recently enough to still be
+  awake for the duration of another command.
+
+  @param[in]  AtSha204a           The device to wake up.
+  @param[in]  Request             A single operation request to use for the
+                                  dummy write.
+
+**/
+STATIC
+VOID
+AtSha204aWake (
+  IN ATSHA204A_DEV    *AtSha204a,
+  IN I2C_RNG_REQUEST  *Request
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Now;
+
+  Now = GetPerformanceCounter ();
+  if (AtSha204a->Awake &&
+      GetTimeInNanoSecond (Now - AtSha204a->WakeTime) < WAKE_WINDOW_NS) {
+    return;
+  }
+
+  //
+  // The wake sequence consists of a dummy write to slave address 0x0.
+  //
+  Request->Operation.LengthInBytes = 0;
+  Status = AtSha204a->I2cIo->QueueRequest (AtSha204a->I2cIo, 1, NULL,
+                               (VOID *)Request, NULL);
+  DEBUG ((DEBUG_INFO, "%a: wake AtSha204a: I2cIo->QueueRequest() - %r\n",
+    __FUNCTION__, Status));
+
+  gBS->Stall (WAKE_DELAY_US);
+
+  AtSha204a->Awake    = TRUE;
+  AtSha204a->WakeTime = Now;
+}
+
 /**
   Produces and returns an RNG value using either the default or specified RNG
   algorithm.
@@ -118,6 +170,9 @@ AtSha240aGetRNG (
   I2C_RNG_REQUEST             Request;
   I2C_RNG_REQUEST             Response;
   UINTN                       Retries;
+  UINTN                       Elapsed;
+  UINT8                       *Pool;
+  UINTN                       Size;
 
   if (Algorithm != NULL && !CompareGuid (Algorithm, &gEfiRngAlgorithmRaw)) {
     return EFI_UNSUPPORTED;
@@ -125,6 +180,21 @@ AtSha240aGetRNG (
 
   AtSha204a = ATSHA204A_DEV_FROM_THIS (This);
 
+  //
+  // Every RANDOM command takes over 50 ms, so first serve what is left of
+  // the previous one. Bytes are wiped as they are handed out, so that none
+  // of them is ever returned twice.
+  //
+  if (AtSha204a->PoolSize > 0) {
+    Pool = &AtSha204a->Pool[ATSHA204A_OUTPUT_SIZE - AtSha204a->PoolSize];
+    Size = MIN (ValueLength, AtSha204a->PoolSize);
+    CopyMem (Value, Pool, Size);
+    ZeroMem (Pool, Size);
+    AtSha204a->PoolSize -= Size;
+    Value += Size;
+    ValueLength -= Size;
+  }
+
   Request.OperationCount  = 1;
   Request.Operation.Flags = 0;
 
@@ -144,22 +214,17 @@ AtSha240aGetRNG (
   while (ValueLength > 0) {
     //
     // The AtSha204a will go back to sleep right in the middle of a transaction
-    // if it does not complete in ~1.3 seconds. So send the wake sequence for
-    // each iteration, which consists of a dummy write to slave address 0x0.
+    // if it does not complete in ~1.3 seconds after the wake sequence. So
+    // wake it again unless this command is sure to fit in the current window.
     //
-    Request.Operation.LengthInBytes = 0;
-    Status = AtSha204a->I2cIo->QueueRequest (AtSha204a->I2cIo, 1, NULL,
-                                 (VOID *)&Request, NULL);
-    DEBUG ((DEBUG_INFO, "%a: wake AtSha204a: I2cIo->QueueRequest() - %r\n",
-      __FUNCTION__, Status));
-
-    gBS->Stall (2500); // wait 2.5 ms for wake to complete
+    AtSha204aWake (AtSha204a, &Request);
 
     Request.Operation.LengthInBytes = sizeof (Command);
     Request.Operation.Buffer = (VOID *)&Command;
     Status = AtSha204a->I2cIo->QueueRequest (AtSha204a->I2cIo, 0, NULL,
                                  (VOID *)&Request, NULL);
     if (EFI_ERROR (Status)) {
+      AtSha204a->Awake = FALSE;
       if (++Retries <= MAX_RETRIES) {
         continue;
       }
@@ -168,11 +233,21 @@ AtSha240aGetRNG (
       return EFI_DEVICE_ERROR;
     }
 
-    gBS->Stall (50 * 1000); // 50 ms max execution time for RANDOM opcode
+    //
+    // The device does not acknowledge its address until the command has
+    // completed, which usually takes a fraction of the maximum execution
+    // time. So poll for the result rather than waiting for the worst case.
+    //
+    Elapsed = 0;
+    do {
+      gBS->Stall (POLL_INTERVAL_US);
+      Elapsed += POLL_INTERVAL_US;
+      Status = AtSha204a->I2cIo->QueueRequest (AtSha204a->I2cIo, 0, NULL,
+                                   (VOID *)&Response, NULL);
+    } while (EFI_ERROR (Status) && Elapsed < RANDOM_EXEC_TIME_US);
 
-    Status = AtSha204a->I2cIo->QueueRequest (AtSha204a->I2cIo, 0, NULL,
-                                 (VOID *)&Response, NULL);
     if (EFI_ERROR (Status)) {
+      AtSha204a->Awake = FALSE;
       if (++Retries <= MAX_RETRIES) {
         continue;
       }
@@ -185,6 +260,7 @@ AtSha240aGetRNG (
       //
       // Incomplete packet received, most likely due to an error. Retry.
       //
+      AtSha204a->Awake = FALSE;
       if (++Retries <= MAX_RETRIES) {
         continue;
       }
@@ -195,6 +271,13 @@ AtSha240aGetRNG (
     gBS->CopyMem (Value, Result.Result, MIN (ValueLength,
                                              ATSHA204A_OUTPUT_SIZE));
     if (ValueLength < ATSHA204A_OUTPUT_SIZE) {
+      //
+      // Keep the bytes the caller did not ask for
+      //
+      AtSha204a->PoolSize = ATSHA204A_OUTPUT_SIZE - ValueLength;
+      CopyMem (&AtSha204a->Pool[ValueLength], &Result.Result[ValueLength],
+        AtSha204a->PoolSize);
+      ZeroMem (&Result, sizeof (Result));
       break;
     }
 
@@ -223,6 +306,8 @@ AtSha204aInit (
   AtSha204a->Signature    = ATSHA204A_DEV_SIGNATURE;
   AtSha204a->Rng.GetInfo  = AtSha240aGetInfo;
   AtSha204a->Rng.GetRNG   = AtSha240aGetRNG;
+  AtSha204a->PoolSize     = 0;
+  AtSha204a->Awake        = FALSE;
 
   //
   // Open I2C I/O Protocol
@@ -297,6 +382,7 @@ AtSha204aRelease (
     return Status;
   }
 
+  ZeroMem (AtSha204a->Pool, sizeof (AtSha204a->Pool));
   gBS->FreePool (AtSha204a);
 
   return EFI_SUCCESS;
@@ -27,6 +27,19 @@ typedef struct {
   UINT32                        Signature;
   EFI_I2C_IO_PROTOCOL           *I2cIo;
   EFI_RNG_PROTOCOL              Rng;
+  //
+  // Unused tail of the last RANDOM result, handed out by the next GetRNG ()
+  // call before going back to the device. The valid bytes are the last
+  // PoolSize bytes of Pool.
+  //
+  UINT8                         Pool[ATSHA204A_OUTPUT_SIZE];
+  UINTN                         PoolSize;
+  //
+  // Performance counter value of the last wake sequence, only meaningful
+  // while Awake is TRUE.
+  //
+  BOOLEAN                       Awake;
+  UINT64                        WakeTime;
 } ATSHA204A_DEV;
 
 #define ATSHA204A_DEV_FROM_THIS(a) \
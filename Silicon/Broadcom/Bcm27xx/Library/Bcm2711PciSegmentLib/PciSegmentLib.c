@@ -59,6 +59,9 @@ EFI_LOCK mPciSegmentReadWriteLock = EFI_INITIALIZE_LOCK_VARIABLE (TPL_HIGH_LEVEL
 
 STATIC UINT64 mPciSegmentLastAccess;     /* Avoid repeat CFG_INDEX updates */
 
+/* The root port is accessed directly, without CFG_INDEX */
+#define IS_ROOT_PORT_ADDRESS(Address) (((Address) & 0xFFFFF000) == 0)
+
 /**
   Internal worker function to obtain config space base address.
 
@@ -106,7 +109,47 @@ PciSegmentLibGetConfigBase (
 }
 
 /**
-  Internal worker function to read a PCI configuration register.
+  Take the config space lock unless Address targets the root port.
+
+  The root port registers are at the base of the PCIe register space and are
+  accessed directly, only the other devices go through CFG_INDEX and CFG_DATA.
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+
+**/
+STATIC
+VOID
+PciSegmentLibLock (
+  IN  UINT64                      Address
+  )
+{
+  if (!IS_ROOT_PORT_ADDRESS (Address)) {
+    EfiAcquireLock (&mPciSegmentReadWriteLock);
+  }
+}
+
+/**
+  Release the config space lock taken by PciSegmentLibLock().
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+
+**/
+STATIC
+VOID
+PciSegmentLibUnlock (
+  IN  UINT64                      Address
+  )
+{
+  if (!IS_ROOT_PORT_ADDRESS (Address)) {
+    EfiReleaseLock (&mPciSegmentReadWriteLock);
+  }
+}
+
+/**
+  Internal function to read a PCI configuration register, the caller holds
+  the config space lock.
 
   @param  Address The address that encodes the PCI Bus, Device, Function and
                   Register.
@@ -117,7 +160,7 @@ PciSegmentLibGetConfigBase (
 **/
 STATIC
 UINT32
-PciSegmentLibReadWorker (
+PciSegmentLibRead (
   IN  UINT64                      Address,
   IN  PCI_CFG_WIDTH               Width
   )
@@ -125,11 +168,9 @@ PciSegmentLibReadWorker (
   UINT64    Base;
   UINT64    Ret;
 
-  EfiAcquireLock (&mPciSegmentReadWriteLock);
   Base = PciSegmentLibGetConfigBase (Address);
 
   if (Base == 0xFFFFFFFF) {
-    EfiReleaseLock (&mPciSegmentReadWriteLock);
     return Base;
   }
 
@@ -147,12 +188,12 @@ PciSegmentLibReadWorker (
     ASSERT (FALSE);
     Ret = 0;
   }
-  EfiReleaseLock (&mPciSegmentReadWriteLock);
   return Ret;
 }
 
 /**
-  Internal worker function to writes a PCI configuration register.
+  Internal function to write a PCI configuration register, the caller holds
+  the config space lock.
 
   @param  Address The address that encodes the PCI Bus, Device, Function and
                   Register.
@@ -164,7 +205,7 @@ PciSegmentLibReadWorker (
 **/
 STATIC
 UINT32
-PciSegmentLibWriteWorker (
+PciSegmentLibWrite (
   IN  UINT64                      Address,
   IN  PCI_CFG_WIDTH               Width,
   IN  UINT32                      Data
@@ -172,9 +213,13 @@ PciSegmentLibWriteWorker (
 {
   UINT64    Base;
 
-  EfiAcquireLock (&mPciSegmentReadWriteLock);
   Base = PciSegmentLibGetConfigBase (Address);
 
+  /* Writes to the devices that cannot be reached are dropped */
+  if (Base == 0xFFFFFFFF) {
+    return Data;
+  }
+
   switch (Width) {
   case PciCfgWidthUint8:
     MmioWrite8 (Base, Data);
@@ -188,7 +233,88 @@ PciSegmentLibWriteWorker (
   default:
     ASSERT (FALSE);
   }
-  EfiReleaseLock (&mPciSegmentReadWriteLock);
+  return Data;
+}
+
+/**
+  Internal worker function to read a PCI configuration register.
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+  @param  Width   The width of data to read
+
+  @return The value read from the PCI configuration register.
+
+**/
+STATIC
+UINT32
+PciSegmentLibReadWorker (
+  IN  UINT64                      Address,
+  IN  PCI_CFG_WIDTH               Width
+  )
+{
+  UINT32    Ret;
+
+  PciSegmentLibLock (Address);
+  Ret = PciSegmentLibRead (Address, Width);
+  PciSegmentLibUnlock (Address);
+  return Ret;
+}
+
+/**
+  Internal worker function to writes a PCI configuration register.
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+  @param  Width   The width of data to write
+  @param  Data    The value to write.
+
+  @return The value written to the PCI configuration register.
+
+**/
+STATIC
+UINT32
+PciSegmentLibWriteWorker (
+  IN  UINT64                      Address,
+  IN  PCI_CFG_WIDTH               Width,
+  IN  UINT32                      Data
+  )
+{
+  PciSegmentLibLock (Address);
+  PciSegmentLibWrite (Address, Width, Data);
+  PciSegmentLibUnlock (Address);
+  return Data;
+}
+
+/**
+  Internal worker function to read, modify and write back a PCI configuration
+  register. The register is read and written under a single lock, so
+  CFG_INDEX is programmed at most once.
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+  @param  Width   The width of the register
+  @param  AndData The value to AND with the PCI configuration register.
+  @param  OrData  The value to OR with the result of the AND operation.
+
+  @return The value written to the PCI configuration register.
+
+**/
+STATIC
+UINT32
+PciSegmentLibModifyWorker (
+  IN  UINT64                      Address,
+  IN  PCI_CFG_WIDTH               Width,
+  IN  UINT32                      AndData,
+  IN  UINT32                      OrData
+  )
+{
+  UINT32    Data;
+
+  PciSegmentLibLock (Address);
+  Data = (PciSegmentLibRead (Address, Width) & AndData) | OrData;
+  PciSegmentLibWrite (Address, Width, Data);
+  PciSegmentLibUnlock (Address);
   return Data;
 }
 
@@ -295,7 +421,7 @@ PciSegmentOr8 (
   IN UINT8                     OrData
   )
 {
-  return PciSegmentWrite8 (Address, (UINT8) (PciSegmentRead8 (Address) | OrData));
+  return (UINT8) PciSegmentLibModifyWorker (Address, PciCfgWidthUint8, 0xFF, OrData);
 }
 
 /**
@@ -321,7 +447,7 @@ PciSegmentAnd8 (
   IN UINT8                     AndData
   )
 {
-  return PciSegmentWrite8 (Address, (UINT8) (PciSegmentRead8 (Address) & AndData));
+  return (UINT8) PciSegmentLibModifyWorker (Address, PciCfgWidthUint8, AndData, 0);
 }
 
 /**
@@ -352,7 +478,7 @@ PciSegmentAndThenOr8 (
   IN UINT8                     OrData
   )
 {
-  return PciSegmentWrite8 (Address, (UINT8) ((PciSegmentRead8 (Address) & AndData) | OrData));
+  return (UINT8) PciSegmentLibModifyWorker (Address, PciCfgWidthUint8, AndData, OrData);
 }
 
 /**
@@ -420,10 +546,12 @@ PciSegmentBitFieldWrite8 (
   IN UINT8                     Value
   )
 {
-  return PciSegmentWrite8 (
-           Address,
-           BitFieldWrite8 (PciSegmentRead8 (Address), StartBit, EndBit, Value)
-           );
+  return (UINT8) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint8,
+                   BitFieldWrite8 (0xFF, StartBit, EndBit, 0),
+                   BitFieldWrite8 (0, StartBit, EndBit, Value)
+                   );
 }
 
 /**
@@ -462,10 +590,12 @@ PciSegmentBitFieldOr8 (
   IN UINT8                     OrData
   )
 {
-  return PciSegmentWrite8 (
-           Address,
-           BitFieldOr8 (PciSegmentRead8 (Address), StartBit, EndBit, OrData)
-           );
+  return (UINT8) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint8,
+                   0xFF,
+                   BitFieldOr8 (0, StartBit, EndBit, OrData)
+                   );
 }
 
 /**
@@ -504,10 +634,12 @@ PciSegmentBitFieldAnd8 (
   IN UINT8                     AndData
   )
 {
-  return PciSegmentWrite8 (
-           Address,
-           BitFieldAnd8 (PciSegmentRead8 (Address), StartBit, EndBit, AndData)
-           );
+  return (UINT8) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint8,
+                   BitFieldAnd8 (0xFF, StartBit, EndBit, AndData),
+                   0
+                   );
 }
 
 /**
@@ -551,10 +683,12 @@ PciSegmentBitFieldAndThenOr8 (
   IN UINT8                     OrData
   )
 {
-  return PciSegmentWrite8 (
-           Address,
-           BitFieldAndThenOr8 (PciSegmentRead8 (Address), StartBit, EndBit, AndData, OrData)
-           );
+  return (UINT8) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint8,
+                   BitFieldAnd8 (0xFF, StartBit, EndBit, AndData),
+                   BitFieldOr8 (0, StartBit, EndBit, OrData)
+                   );
 }
 
 /**
@@ -637,7 +771,7 @@ PciSegmentOr16 (
   IN UINT16                    OrData
   )
 {
-  return PciSegmentWrite16 (Address, (UINT16) (PciSegmentRead16 (Address) | OrData));
+  return (UINT16) PciSegmentLibModifyWorker (Address, PciCfgWidthUint16, 0xFFFF, OrData);
 }
 
 /**
@@ -665,7 +799,7 @@ PciSegmentAnd16 (
   IN UINT16                    AndData
   )
 {
-  return PciSegmentWrite16 (Address, (UINT16) (PciSegmentRead16 (Address) & AndData));
+  return (UINT16) PciSegmentLibModifyWorker (Address, PciCfgWidthUint16, AndData, 0);
 }
 
 /**
@@ -697,7 +831,7 @@ PciSegmentAndThenOr16 (
   IN UINT16                    OrData
   )
 {
-  return PciSegmentWrite16 (Address, (UINT16) ((PciSegmentRead16 (Address) & AndData) | OrData));
+  return (UINT16) PciSegmentLibModifyWorker (Address, PciCfgWidthUint16, AndData, OrData);
 }
 
 /**
@@ -767,10 +901,12 @@ PciSegmentBitFieldWrite16 (
   IN UINT16                    Value
   )
 {
-  return PciSegmentWrite16 (
-           Address,
-           BitFieldWrite16 (PciSegmentRead16 (Address), StartBit, EndBit, Value)
-           );
+  return (UINT16) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint16,
+                   BitFieldWrite16 (0xFFFF, StartBit, EndBit, 0),
+                   BitFieldWrite16 (0, StartBit, EndBit, Value)
+                   );
 }
 
 /**
@@ -804,10 +940,12 @@ PciSegmentBitFieldOr16 (
   IN UINT16                    OrData
   )
 {
-  return PciSegmentWrite16 (
-           Address,
-           BitFieldOr16 (PciSegmentRead16 (Address), StartBit, EndBit, OrData)
-           );
+  return (UINT16) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint16,
+                   0xFFFF,
+                   BitFieldOr16 (0, StartBit, EndBit, OrData)
+                   );
 }
 
 /**
@@ -847,10 +985,12 @@ PciSegmentBitFieldAnd16 (
   IN UINT16                    AndData
   )
 {
-  return PciSegmentWrite16 (
-           Address,
-           BitFieldAnd16 (PciSegmentRead16 (Address), StartBit, EndBit, AndData)
-           );
+  return (UINT16) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint16,
+                   BitFieldAnd16 (0xFFFF, StartBit, EndBit, AndData),
+                   0
+                   );
 }
 
 /**
@@ -894,10 +1034,12 @@ PciSegmentBitFieldAndThenOr16 (
   IN UINT16                    OrData
   )
 {
-  return PciSegmentWrite16 (
-           Address,
-           BitFieldAndThenOr16 (PciSegmentRead16 (Address), StartBit, EndBit, AndData, OrData)
-           );
+  return (UINT16) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint16,
+                   BitFieldAnd16 (0xFFFF, StartBit, EndBit, AndData),
+                   BitFieldOr16 (0, StartBit, EndBit, OrData)
+                   );
 }
 
 /**
@@ -979,7 +1121,7 @@ PciSegmentOr32 (
   IN UINT32                    OrData
   )
 {
-  return PciSegmentWrite32 (Address, PciSegmentRead32 (Address) | OrData);
+  return (UINT32) PciSegmentLibModifyWorker (Address, PciCfgWidthUint32, 0xFFFFFFFF, OrData);
 }
 
 /**
@@ -1008,7 +1150,7 @@ PciSegmentAnd32 (
   IN UINT32                    AndData
   )
 {
-  return PciSegmentWrite32 (Address, PciSegmentRead32 (Address) & AndData);
+  return (UINT32) PciSegmentLibModifyWorker (Address, PciCfgWidthUint32, AndData, 0);
 }
 
 /**
@@ -1041,7 +1183,7 @@ PciSegmentAndThenOr32 (
   IN UINT32                    OrData
   )
 {
-  return PciSegmentWrite32 (Address, (PciSegmentRead32 (Address) & AndData) | OrData);
+  return (UINT32) PciSegmentLibModifyWorker (Address, PciCfgWidthUint32, AndData, OrData);
 }
 
 /**
@@ -1111,10 +1253,12 @@ PciSegmentBitFieldWrite32 (
   IN UINT32                    Value
   )
 {
-  return PciSegmentWrite32 (
-           Address,
-           BitFieldWrite32 (PciSegmentRead32 (Address), StartBit, EndBit, Value)
-           );
+  return (UINT32) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint32,
+                   BitFieldWrite32 (0xFFFFFFFF, StartBit, EndBit, 0),
+                   BitFieldWrite32 (0, StartBit, EndBit, Value)
+                   );
 }
 
 /**
@@ -1153,10 +1297,12 @@ PciSegmentBitFieldOr32 (
   IN UINT32                    OrData
   )
 {
-  return PciSegmentWrite32 (
-           Address,
-           BitFieldOr32 (PciSegmentRead32 (Address), StartBit, EndBit, OrData)
-           );
+  return (UINT32) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint32,
+                   0xFFFFFFFF,
+                   BitFieldOr32 (0, StartBit, EndBit, OrData)
+                   );
 }
 
 /**
@@ -1195,10 +1341,12 @@ PciSegmentBitFieldAnd32 (
   IN UINT32                    AndData
   )
 {
-  return PciSegmentWrite32 (
-           Address,
-           BitFieldAnd32 (PciSegmentRead32 (Address), StartBit, EndBit, AndData)
-           );
+  return (UINT32) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint32,
+                   BitFieldAnd32 (0xFFFFFFFF, StartBit, EndBit, AndData),
+                   0
+                   );
 }
 
 /**
@@ -1242,10 +1390,12 @@ PciSegmentBitFieldAndThenOr32 (
   IN UINT32                    OrData
   )
 {
-  return PciSegmentWrite32 (
-           Address,
-           BitFieldAndThenOr32 (PciSegmentRead32 (Address), StartBit, EndBit, AndData, OrData)
-           );
+  return (UINT32) PciSegmentLibModifyWorker (
+                   Address,
+                   PciCfgWidthUint32,
+                   BitFieldAnd32 (0xFFFFFFFF, StartBit, EndBit, AndData),
+                   BitFieldOr32 (0, StartBit, EndBit, OrData)
+                   );
 }
 
 /**
@@ -1280,6 +1430,7 @@ PciSegmentReadBuffer (
   )
 {
   UINTN                             ReturnValue;
+  UINT64                            FunctionAddress;
 
   ASSERT_INVALID_PCI_SEGMENT_ADDRESS (StartAddress, 0);
   ASSERT (((StartAddress & 0xFFF) + Size) <= 0x1000);
@@ -1295,11 +1446,14 @@ PciSegmentReadBuffer (
   //
   ReturnValue = Size;
 
+  FunctionAddress = StartAddress;
+  PciSegmentLibLock (FunctionAddress);
+
   if ((StartAddress & BIT0) != 0) {
     //
     // Read a byte if StartAddress is byte aligned
     //
-    *(volatile UINT8 *)Buffer = PciSegmentRead8 (StartAddress);
+    *(volatile UINT8 *)Buffer = (UINT8) PciSegmentLibRead (StartAddress, PciCfgWidthUint8);
     StartAddress += sizeof (UINT8);
     Size -= sizeof (UINT8);
     Buffer = (UINT8*)Buffer + 1;
@@ -1309,7 +1463,7 @@ PciSegmentReadBuffer (
     //
     // Read a word if StartAddress is word aligned
     //
-    WriteUnaligned16 (Buffer, PciSegmentRead16 (StartAddress));
+    WriteUnaligned16 (Buffer, (UINT16) PciSegmentLibRead (StartAddress, PciCfgWidthUint16));
     StartAddress += sizeof (UINT16);
     Size -= sizeof (UINT16);
     Buffer = (UINT16*)Buffer + 1;
@@ -1319,7 +1473,7 @@ PciSegmentReadBuffer (
     //
     // Read as many double words as possible
     //
-    WriteUnaligned32 (Buffer, PciSegmentRead32 (StartAddress));
+    WriteUnaligned32 (Buffer, PciSegmentLibRead (StartAddress, PciCfgWidthUint32));
     StartAddress += sizeof (UINT32);
     Size -= sizeof (UINT32);
     Buffer = (UINT32*)Buffer + 1;
@@ -1329,7 +1483,7 @@ PciSegmentReadBuffer (
     //
     // Read the last remaining word if exist
     //
-    WriteUnaligned16 (Buffer, PciSegmentRead16 (StartAddress));
+    WriteUnaligned16 (Buffer, (UINT16) PciSegmentLibRead (StartAddress, PciCfgWidthUint16));
     StartAddress += sizeof (UINT16);
     Size -= sizeof (UINT16);
     Buffer = (UINT16*)Buffer + 1;
@@ -1339,9 +1493,10 @@ PciSegmentReadBuffer (
     //
     // Read the last remaining byte if exist
     //
-    *(volatile UINT8 *)Buffer = PciSegmentRead8 (StartAddress);
+    *(volatile UINT8 *)Buffer = (UINT8) PciSegmentLibRead (StartAddress, PciCfgWidthUint8);
   }
 
+  PciSegmentLibUnlock (FunctionAddress);
   return ReturnValue;
 }
 
@@ -1379,6 +1534,7 @@ PciSegmentWriteBuffer (
   )
 {
   UINTN                             ReturnValue;
+  UINT64                            FunctionAddress;
 
   ASSERT_INVALID_PCI_SEGMENT_ADDRESS (StartAddress, 0);
   ASSERT (((StartAddress & 0xFFF) + Size) <= 0x1000);
@@ -1390,19 +1546,23 @@ PciSegmentWriteBuffer (
   ASSERT (Buffer != NULL);
 
   // The Bcm/Rpi has a single cfg which can be mapped
-  // to any given device on the bus, which means we need to remap
-  // it basically everytime a new config access is done
+  // to any given device on the bus, so the whole range is accessed
+  // under one lock. The range is within one function, which means
+  // CFG_INDEX is programmed at most once.
 
   //
   // Save Size for return
   //
   ReturnValue = Size;
 
+  FunctionAddress = StartAddress;
+  PciSegmentLibLock (FunctionAddress);
+
   if ((StartAddress & BIT0) != 0) {
     //
     // Write a byte if StartAddress is byte aligned
     //
-    PciSegmentWrite8 (StartAddress, *(UINT8*)Buffer);
+    PciSegmentLibWrite (StartAddress, PciCfgWidthUint8, *(UINT8*)Buffer);
     StartAddress += sizeof (UINT8);
     Size -= sizeof (UINT8);
     Buffer = (UINT8*)Buffer + 1;
@@ -1412,7 +1572,7 @@ PciSegmentWriteBuffer (
     //
     // Write a word if StartAddress is word aligned
     //
-    PciSegmentWrite16 (StartAddress, ReadUnaligned16 (Buffer));
+    PciSegmentLibWrite (StartAddress, PciCfgWidthUint16, ReadUnaligned16 (Buffer));
     StartAddress += sizeof (UINT16);
     Size -= sizeof (UINT16);
     Buffer = (UINT16*)Buffer + 1;
@@ -1422,7 +1582,7 @@ PciSegmentWriteBuffer (
     //
     // Write as many double words as possible
     //
-    PciSegmentWrite32 (StartAddress, ReadUnaligned32 (Buffer));
+    PciSegmentLibWrite (StartAddress, PciCfgWidthUint32, ReadUnaligned32 (Buffer));
     StartAddress += sizeof (UINT32);
     Size -= sizeof (UINT32);
     Buffer = (UINT32*)Buffer + 1;
@@ -1432,7 +1592,7 @@ PciSegmentWriteBuffer (
     //
     // Write the last remaining word if exist
     //
-    PciSegmentWrite16 (StartAddress, ReadUnaligned16 (Buffer));
+    PciSegmentLibWrite (StartAddress, PciCfgWidthUint16, ReadUnaligned16 (Buffer));
     StartAddress += sizeof (UINT16);
     Size -= sizeof (UINT16);
     Buffer = (UINT16*)Buffer + 1;
@@ -1442,8 +1602,9 @@ PciSegmentWriteBuffer (
     //
     // Write the last remaining byte if exist
     //
-    PciSegmentWrite8 (StartAddress, *(UINT8*)Buffer);
+    PciSegmentLibWrite (StartAddress, PciCfgWidthUint8, *(UINT8*)Buffer);
   }
 
+  PciSegmentLibUnlock (FunctionAddress);
   return ReturnValue;
 }
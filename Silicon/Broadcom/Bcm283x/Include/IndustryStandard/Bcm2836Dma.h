@@ -0,0 +1,83 @@
+/** @file
+ *
+ *  Copyright (c) 2020, ARM Limited. All rights reserved.
+ *
+ *  SPDX-License-Identifier: BSD-2-Clause-Patent
+ *
+ **/
+
+#include <IndustryStandard/Bcm2836.h>
+
+#ifndef __BCM2836_DMA_H__
+#define __BCM2836_DMA_H__
+
+/* DMA controller constants, channels 0 to 14 */
+
+#define BCM2836_DMA_CHANNEL_COUNT                           15
+#define BCM2836_DMA_CHANNEL_BASE_ADDRESS(Channel)           (BCM2836_DMA0_BASE_ADDRESS + \
+                                                             (Channel) * BCM2836_DMA_CHANNEL_LENGTH)
+
+#define BCM2836_DMA_CS                                      0x00000000
+#define BCM2836_DMA_CONBLK_AD                               0x00000004
+#define BCM2836_DMA_DEBUG                                   0x00000020
+
+#define BCM2836_DMA_INT_STATUS                              (BCM2836_DMA_CTRL_BASE_ADDRESS + 0x00)
+#define BCM2836_DMA_ENABLE                                  (BCM2836_DMA_CTRL_BASE_ADDRESS + 0x10)
+
+/* CS */
+#define BCM2836_DMA_CS_ACTIVE                               BIT0
+#define BCM2836_DMA_CS_END                                  BIT1
+#define BCM2836_DMA_CS_INT                                  BIT2
+#define BCM2836_DMA_CS_ERROR                                BIT8
+#define BCM2836_DMA_CS_PRIORITY(X)                          (((X) & 0xF) << 16)
+#define BCM2836_DMA_CS_PANIC_PRIORITY(X)                    (((X) & 0xF) << 20)
+#define BCM2836_DMA_CS_WAIT_FOR_OUTSTANDING_WRITES          BIT28
+#define BCM2836_DMA_CS_ABORT                                BIT30
+#define BCM2836_DMA_CS_RESET                                BIT31
+
+/* DEBUG, the error bits are write 1 to clear */
+#define BCM2836_DMA_DEBUG_READ_LAST_NOT_SET_ERROR           BIT0
+#define BCM2836_DMA_DEBUG_FIFO_ERROR                        BIT1
+#define BCM2836_DMA_DEBUG_READ_ERROR                        BIT2
+#define BCM2836_DMA_DEBUG_ERRORS                            (BCM2836_DMA_DEBUG_READ_LAST_NOT_SET_ERROR | \
+                                                             BCM2836_DMA_DEBUG_FIFO_ERROR | \
+                                                             BCM2836_DMA_DEBUG_READ_ERROR)
+
+/* TI, transfer information of a control block */
+#define BCM2836_DMA_TI_INTEN                                BIT0
+#define BCM2836_DMA_TI_WAIT_RESP                            BIT3
+#define BCM2836_DMA_TI_DEST_INC                             BIT4
+#define BCM2836_DMA_TI_DEST_WIDTH                           BIT5
+#define BCM2836_DMA_TI_DEST_DREQ                            BIT6
+#define BCM2836_DMA_TI_SRC_INC                              BIT8
+#define BCM2836_DMA_TI_SRC_WIDTH                            BIT9
+#define BCM2836_DMA_TI_SRC_DREQ                             BIT10
+#define BCM2836_DMA_TI_BURST_LENGTH(X)                      (((X) & 0xF) << 12)
+#define BCM2836_DMA_TI_PERMAP(X)                            (((X) & 0x1F) << 16)
+#define BCM2836_DMA_TI_NO_WIDE_BURSTS                       BIT26
+
+/* TXFR_LEN of the lite channels (7 to 14) is 16 bits */
+#define BCM2836_DMA_LITE_MAX_LENGTH                         0x0000FFFF
+
+/* Peripheral DREQs */
+#define BCM2836_DMA_DREQ_EMMC                               11
+#define BCM2836_DMA_DREQ_SDHOST                             13
+
+/*
+ * Control block, 32 byte aligned. All the addresses are bus (VC) addresses.
+ */
+#pragma pack(1)
+typedef struct {
+  UINT32 TransferInfo;
+  UINT32 SourceAddress;
+  UINT32 DestinationAddress;
+  UINT32 TransferLength;
+  UINT32 Stride;
+  UINT32 NextControlBlock;
+  UINT32 Reserved[2];
+} BCM2836_DMA_CB;
+#pragma pack()
+
+#define BCM2836_DMA_CB_ALIGNMENT                            32
+
+#endif /* __BCM2836_DMA_H__ */
@@ -32,6 +32,12 @@
 #define SDHOST_DATA                 SDHOST_REG(0x40)
 #define SDHOST_HBLC                 SDHOST_REG(0x50)
 
+//
+// DATA as seen by the DMA engine
+//
+#define SDHOST_BUS_BASE_ADDRESS     0x7E202000
+#define SDHOST_DATA_BUS_ADDRESS     (SDHOST_BUS_BASE_ADDRESS + 0x40)
+
 //
 // CMD
 //
@@ -15,6 +15,7 @@
 #define MMCHS1_OFFSET     0x00300000
 #define MMCHS1_BASE       (BCM2836_SOC_REGISTERS + MMCHS1_OFFSET)
 #define MMCHS1_LENGTH     0x00000100
+#define MMCHS1_BUS_BASE   0x7E300000
 
 #define MMCHS_BLK         (MMCHS1_BASE + 0x4)
 #define BLEN_512BYTES     (0x200UL << 0)
@@ -48,6 +49,7 @@
 #define MMCHS_RSP54       (MMCHS1_BASE + 0x18)
 #define MMCHS_RSP76       (MMCHS1_BASE + 0x1C)
 #define MMCHS_DATA        (MMCHS1_BASE + 0x20)
+#define MMCHS_DATA_BUS_ADDRESS (MMCHS1_BUS_BASE + 0x20)
 
 #define MMCHS_PRES_STATE  (MMCHS1_BASE + 0x24)
 #define CMDI_MASK         BIT0
@@ -61,6 +63,8 @@
 #define MMCHS_HCTL        (MMCHS1_BASE + 0x28)
 #define DTW_1_BIT         (0x0UL << 1)
 #define DTW_4_BIT         BIT1
+#define DTW_8_BIT         BIT5
+#define DTW_MASK          (DTW_4_BIT | DTW_8_BIT)
 #define SDBP_MASK         BIT8
 #define SDBP_OFF          (0x0UL << 8)
 #define SDBP_ON           BIT8
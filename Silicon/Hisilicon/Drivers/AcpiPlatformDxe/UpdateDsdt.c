@@ -62,6 +62,12 @@ typedef enum {
   DsdtDeviceSas
 } DSDT_DEVICE_TYPE;
 
+//
+// Located once for all the ETHn and SASn devices of the DSDT
+//
+STATIC HISI_BOARD_NIC_PROTOCOL    *mOemNic;
+STATIC HISI_SAS_CONFIG_PROTOCOL   *mHisiSasConf;
+
 STATIC
 EFI_STATUS
 GetEnvMac(
@@ -71,16 +77,18 @@ GetEnvMac(
 {
   EFI_MAC_ADDRESS Mac;
   EFI_STATUS Status;
-  HISI_BOARD_NIC_PROTOCOL *OemNic = NULL;
 
-  Status = gBS->LocateProtocol(&gHisiBoardNicProtocolGuid, NULL, (VOID **)&OemNic);
-  if(EFI_ERROR(Status))
-  {
-    DEBUG((EFI_D_ERROR, "[%a]:[%dL] LocateProtocol failed %r\n", __FUNCTION__, __LINE__, Status));
-    return Status;
+  if (mOemNic == NULL) {
+    Status = gBS->LocateProtocol(&gHisiBoardNicProtocolGuid, NULL, (VOID **)&mOemNic);
+    if(EFI_ERROR(Status))
+    {
+      DEBUG((EFI_D_ERROR, "[%a]:[%dL] LocateProtocol failed %r\n", __FUNCTION__, __LINE__, Status));
+      mOemNic = NULL;
+      return Status;
+    }
   }
 
-  Status = OemNic->GetMac(&Mac, MacNextID);
+  Status = mOemNic->GetMac(&Mac, MacNextID);
   if(EFI_ERROR(Status))
   {
     DEBUG((EFI_D_ERROR, "[%a]:[%dL] GetMac failed %r\n", __FUNCTION__, __LINE__, Status));
@@ -109,15 +117,18 @@ GetSasAddress (
   )
 {
   EFI_STATUS Status;
-  HISI_SAS_CONFIG_PROTOCOL *HisiSasConf;
 
   if (SasAddrBuffer == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
-  Status = gBS->LocateProtocol (&gHisiSasConfigProtocolGuid, NULL, (VOID **)&HisiSasConf);
+  Status = EFI_SUCCESS;
+  if (mHisiSasConf == NULL) {
+    Status = gBS->LocateProtocol (&gHisiSasConfigProtocolGuid, NULL, (VOID **)&mHisiSasConf);
+  }
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "Locate Sas Config Protocol failed %r\n", Status));
+    mHisiSasConf = NULL;
     SasAddrBuffer[0] = 0x00;
     SasAddrBuffer[1] = 0x00;
     SasAddrBuffer[2] = 0x00;
@@ -129,7 +140,7 @@ GetSasAddress (
     return Status;
   }
 
-  return HisiSasConf->GetAddr (Index, SasAddrBuffer);
+  return mHisiSasConf->GetAddr (Index, SasAddrBuffer);
 }
 
 STATIC
@@ -147,15 +158,11 @@ UpdateAddressInOption (
   UINTN               DataSize;
   UINTN               Count;
   EFI_ACPI_HANDLE     CurrentHandle;
-  UINT8               *AddressBuffer;
+  UINT8               AddressBuffer[ADDRESS_MAX_LEN];
   UINT8               AddressByte;
 
   AddressByte = 0;
-  AddressBuffer = AllocateZeroPool (ADDRESS_MAX_LEN);
-  if (AddressBuffer == NULL) {
-    DEBUG ((DEBUG_ERROR, "%a:%d AllocateZeroPool failed\n", __FILE__, __LINE__));
-    return EFI_OUT_OF_RESOURCES;
-  }
+  ZeroMem (AddressBuffer, sizeof (AddressBuffer));
 
   switch (FoundDev) {
     case DsdtDeviceLan:
@@ -172,7 +179,6 @@ UpdateAddressInOption (
       Status = EFI_INVALID_PARAMETER;
   }
   if (EFI_ERROR (Status)) {
-    FreePool (AddressBuffer);
     return Status;
   }
 
@@ -202,7 +208,6 @@ UpdateAddressInOption (
     }
   }
 
-  FreePool (AddressBuffer);
   return Status;
 }
 
@@ -650,6 +655,9 @@ UpdateAcpiDsdtTable (
 
     AcpiTableProtocol->Close(TableHandle);
     AcpiCheckSum (Table);
+
+    // There is only one DSDT
+    break;
   }
 
   return EFI_SUCCESS;
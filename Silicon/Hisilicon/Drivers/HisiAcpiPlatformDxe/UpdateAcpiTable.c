@@ -71,19 +71,27 @@ SelectIort (
 {
   EFI_STATUS          Status;
   UINTN               Size;
-  OEM_CONFIG_DATA     Configuration;
-
-  Configuration.EnableSmmu = 0;
-  Size = sizeof (OEM_CONFIG_DATA);
-  Status = gRT->GetVariable (
-                  OEM_CONFIG_NAME,
-                  &gOemConfigGuid,
-                  NULL,
-                  &Size,
-                  &Configuration
-                  );
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Get OemConfig variable (%r).\n", Status));
+  //
+  // The storage file carries an IORT with and one without SMMU, only read
+  // the setup variable for the first of them.
+  //
+  STATIC OEM_CONFIG_DATA  Configuration;
+  STATIC BOOLEAN          ConfigurationRead;
+
+  if (!ConfigurationRead) {
+    Configuration.EnableSmmu = 0;
+    Size = sizeof (OEM_CONFIG_DATA);
+    Status = gRT->GetVariable (
+                    OEM_CONFIG_NAME,
+                    &gOemConfigGuid,
+                    NULL,
+                    &Size,
+                    &Configuration
+                    );
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "Get OemConfig variable (%r).\n", Status));
+    }
+    ConfigurationRead = TRUE;
   }
 
   Status =  EFI_SUCCESS;
@@ -329,6 +329,12 @@ FlashSectorErase(
 
     SectorOffset = Offset - (Offset % (gFlashInfo[gIndex.InfIndex].BlockSize * gFlashInfo[gIndex.InfIndex].ParallelNum));
 
+    //Nothing to preserve when the whole sector is erased
+    if (LeftLength == Length && SectorOffset == Offset)
+    {
+        return SectorErase(TempBase, SectorOffset);
+    }
+
     Status = gBS->AllocatePool(EfiBootServicesData, gFlashInfo[gIndex.InfIndex].BlockSize * (UINTN)gFlashInfo[gIndex.InfIndex].ParallelNum, (VOID *)&StaticBuffer);
     if (EFI_ERROR(Status))
     {
@@ -495,11 +501,16 @@ EFIAPI Write(
 
         if (TRUE == IsNeedToWrite(TempBase, Offset, Buffer, TempLength))
         {
-            Status = FlashSectorErase(TempBase, Offset, TempLength);
-            if (EFI_ERROR(Status))
+            //Appending to erased space or clearing bits, as the variable
+            //store mostly does, can be programmed in place without an erase
+            if (IsNeedToErase(TempBase, Offset, Buffer, TempLength))
             {
-                DEBUG ((EFI_D_ERROR, "[%a]:[%dL]:FlashErase One Sector Error, Status = %r!\n", __FUNCTION__,__LINE__,Status));
-                return Status;
+                Status = FlashSectorErase(TempBase, Offset, TempLength);
+                if (EFI_ERROR(Status))
+                {
+                    DEBUG ((EFI_D_ERROR, "[%a]:[%dL]:FlashErase One Sector Error, Status = %r!\n", __FUNCTION__,__LINE__,Status));
+                    return Status;
+                }
             }
 
 
@@ -378,8 +378,7 @@ EFI_STATUS BufferWriteCommand(UINTN Base, UINTN Offset, void *pData)
 
     }
 
-    (void)gBS->Stall(200);
-
+    //No fixed delay here, CompleteCheck() polls the data until the program is done
     gFlashBusy = FALSE;
     return EFI_SUCCESS;
 
@@ -416,7 +415,7 @@ EFI_STATUS SectorEraseCommand(UINTN Base, UINTN Offset)
     dwAddr = (UINT32)Base + Offset;
     (VOID)PortWriteData(gIndex.InfIndex, dwAddr, gFlashCommandErase[gIndex.EIndex].SectorEraseDataStep6);
 
-    (void)gBS->Stall(500000);
+    //No fixed delay here, CompleteCheck() polls the data until the erase is done
 
     gFlashBusy = FALSE;
     return EFI_SUCCESS;
@@ -533,6 +532,32 @@ EFI_STATUS IsNeedToWrite(
 }
 
 
+//Programming can only clear bits, an erase is needed if any bit goes from 0 to 1
+BOOLEAN IsNeedToErase(
+    IN  UINT32       Base,
+    IN  UINT32       Offset,
+    IN  UINT8       *Buffer,
+    IN  UINT32       Length
+  )
+{
+    UINTN NewAddr = Base + Offset;
+    UINT8 FlashData = 0;
+
+    for(; Length > 0; Length --)
+    {
+        FlashData = *(UINT8 *)NewAddr;
+        if ((FlashData & *Buffer) != *Buffer)
+        {
+            return TRUE;
+        }
+        NewAddr ++;
+        Buffer ++;
+    }
+
+    return FALSE;
+}
+
+
 EFI_STATUS BufferWrite(UINT32 Offset, void *pData, UINT32 Length)
 {
     EFI_STATUS Status;
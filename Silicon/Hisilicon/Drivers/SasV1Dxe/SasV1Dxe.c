@@ -178,7 +178,22 @@
 #define CMPLT_HDR_RSPNS_XFRD_MSK    BIT19
 #define CMPLT_HDR_IO_CFG_ERR_MSK    BIT27
 
+// SSP response IU in the status buffer, after the 16 bytes error record
 #define SENSE_DATA_PRES             26
+#define SENSE_DATA_PRES_MSK         0x3
+#define SENSE_DATA_PRES_SENSE       0x2
+#define RESP_IU_STATUS              27
+#define RESP_IU_SENSE_LEN           32
+#define RESP_IU_SENSE_DATA          40
+
+// Polling intervals and deadlines, in microseconds
+#define NOT_READY_POLL_US           100000
+#define NOT_READY_TIMEOUT_US        1000000
+#define PHY_UP_POLL_US              100
+#define PHY_UP_TIMEOUT_US           100000
+
+// Period of the completion reaping timer for non-blocking requests, in 100ns
+#define ASYNC_POLL_PERIOD           10000
 
 #define SGE_LIMIT 0x10000
 #define upper_32_bits(n) ((UINT32)(((n) >> 16) >> 16))
@@ -257,6 +272,12 @@ UINT32 status[260];
 
 struct hisi_sas_slot {
     BOOLEAN used;
+    BOOLEAN done;
+    BOOLEAN abandoned;
+    UINT32 cmplt;
+    VOID *buffer_map;
+    EFI_EVENT event;
+    EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET *packet;
 };
 
 struct hisi_hba {
@@ -274,6 +295,7 @@ struct hisi_hba {
     int port_id;
     UINT32 LatestTargetId;
     UINT64 LatestLun;
+    UINT32 async_cnt;
 };
 
 #pragma pack (1)
@@ -296,9 +318,15 @@ typedef struct {
 #define SAS_DEVICE_SIGNATURE SIGNATURE_32 ('S','A','S','0')
 #define SAS_FROM_PASS_THRU(a) CR (a, SAS_V1_INFO, ExtScsiPassThru, SAS_DEVICE_SIGNATURE)
 
+//
+// Queue a command on the first delivery queue with a free slot, starting
+// after the queue used last time. The caller holds TPL_NOTIFY.
+//
 STATIC EFI_STATUS prepare_cmd (
   struct hisi_hba *hba,
-  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet,
+  EFI_EVENT Event,
+  UINT32 *slot_out
   )
 {
   struct hisi_sas_slot *slot;
@@ -306,13 +334,11 @@ STATIC EFI_STATUS prepare_cmd (
   struct hisi_sas_sge_page *sge;
   struct hisi_sas_sts *sts;
   struct hisi_sas_cmd *cmd;
-  EFI_SCSI_SENSE_DATA *SensePtr = Packet->SenseData;
   VOID   *Buffer = NULL;
   UINTN BufferSize = 0;
   int queue = hba->queue;
   UINT32 r, w = 0, slot_idx = 0;
   UINT32 base = hba->base;
-  UINT8 *p;
   EFI_PHYSICAL_ADDRESS  BufferAddress;
   EFI_STATUS            Status = EFI_SUCCESS;
   VOID                  *BufferMap = NULL;
@@ -341,11 +367,8 @@ STATIC EFI_STATUS prepare_cmd (
 
   ZeroMem (cmd, sizeof (struct hisi_sas_cmd));
   ZeroMem (sts, sizeof (struct hisi_sas_sts));
-  if (SensePtr)
-    ZeroMem (SensePtr, sizeof (EFI_SCSI_SENSE_DATA));
-
-  slot->used = TRUE;
-  hba->queue = (queue + 1) % QUEUE_CNT;
+  if (Packet->SenseData)
+    ZeroMem (Packet->SenseData, Packet->SenseDataLength);
 
   // Only consider ssp
   hdr->dw0 = (1 << CMD_HDR_RESP_REPORT_OFF) |
@@ -410,58 +433,262 @@ STATIC EFI_STATUS prepare_cmd (
     hdr->sg_len = i << CMD_HDR_DATA_SGL_LEN_OFF;
   }
 
+  slot->used = TRUE;
+  slot->done = FALSE;
+  slot->abandoned = FALSE;
+  slot->cmplt = 0;
+  slot->buffer_map = BufferMap;
+  slot->event = Event;
+  slot->packet = Packet;
+  hba->queue = (queue + 1) % QUEUE_CNT;
+
   // Ensure descriptor effective before start dma
   MemoryFence();
 
   // Start dma
   WRITE_REG32(base, DLVRY_Q_0_WR_PTR + queue * 0x14, ++w % QUEUE_SLOTS);
 
-  // Wait for dma complete
-  while (slot->used) {
-    if (READ_REG32(base, OQ_INT_SRC) & BIT(queue)) {
-      struct hisi_sas_complete_hdr *complete_hdr;
-      UINT32 data, rd;
-      rd = READ_REG32(base, COMPL_Q_0_RD_PTR + (0x14 * queue));
+  *slot_out = slot_idx;
+  return EFI_SUCCESS;
+}
+
+//
+// Release a completed slot and report its status into the request packet,
+// if the requester still waits for it. NotReady is set when the target
+// could not take the command yet and it is worth sending it again.
+//
+STATIC EFI_STATUS slot_finish (
+  struct hisi_hba *hba,
+  UINT32 slot_idx,
+  BOOLEAN *NotReady
+  )
+{
+  struct hisi_sas_slot *slot = &hba->slots[slot_idx];
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET *Packet = slot->packet;
+  struct hisi_sas_sts *sts;
+  EFI_SCSI_SENSE_DATA *SensePtr;
+  UINT32 data = slot->cmplt, sense_len = 0;
+  UINT8 *p;
+  EFI_STATUS Status = EFI_SUCCESS;
+
+  *NotReady = FALSE;
+
+  if (slot->buffer_map)
+    DmaUnmap (slot->buffer_map);
+
+  sts = &hba->status_buf[slot_idx / QUEUE_SLOTS][slot_idx % QUEUE_SLOTS];
+  p = (UINT8 *)&sts->status[0];
+
+  if (Packet != NULL) {
+    Packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_OK;
+    Packet->TargetStatus = p[RESP_IU_STATUS];
+
+    // Check whether dma transfer error
+    if ((data & CMPLT_HDR_ERR_RCRD_XFRD_MSK) &&
+      !(data & CMPLT_HDR_RSPNS_XFRD_MSK)) {
+      DEBUG ((EFI_D_VERBOSE, "sas retry data=0x%x\n", data));
+      DEBUG ((EFI_D_VERBOSE, "sts[0]=0x%x\n", sts->status[0]));
+      DEBUG ((EFI_D_VERBOSE, "sts[1]=0x%x\n", sts->status[1]));
+      DEBUG ((EFI_D_VERBOSE, "sts[2]=0x%x\n", sts->status[2]));
+      Packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_OTHER;
+      Packet->TargetStatus = EFI_EXT_SCSI_STATUS_TARGET_GOOD;
+      // some disk need long time to be ready
+      *NotReady = TRUE;
+      Status = EFI_NOT_READY;
+    } else if ((p[SENSE_DATA_PRES] & SENSE_DATA_PRES_MSK) == SENSE_DATA_PRES_SENSE) {
+      sense_len = SwapBytes32 (ReadUnaligned32 ((UINT32 *)&p[RESP_IU_SENSE_LEN]));
+      sense_len = MIN (sense_len, sizeof (struct hisi_sas_sts) - RESP_IU_SENSE_DATA);
+      SensePtr = (EFI_SCSI_SENSE_DATA *)&p[RESP_IU_SENSE_DATA];
+      // Disk not ready, e.g. spinning up, refer drivers/scsi/sd.c
+      if ((sense_len > OFFSET_OF (EFI_SCSI_SENSE_DATA, Addnl_Sense_Code)) &&
+          (SensePtr->Sense_Key == EFI_SCSI_SK_NOT_READY) &&
+          (SensePtr->Addnl_Sense_Code == EFI_SCSI_ASC_NOT_READY)) {
+        *NotReady = TRUE;
+      }
+    }
+
+    if (Packet->SenseData) {
+      sense_len = MIN (sense_len, Packet->SenseDataLength);
+      CopyMem (Packet->SenseData, &p[RESP_IU_SENSE_DATA], sense_len);
+    } else {
+      sense_len = 0;
+    }
+    Packet->SenseDataLength = (UINT8)sense_len;
+  }
 
+  slot->packet = NULL;
+  slot->event = NULL;
+  slot->buffer_map = NULL;
+  slot->used = FALSE;
+  return Status;
+}
+
+//
+// Completion of a slot reaped from the completion queue. Blocking
+// requesters pick the result up themselves, non-blocking ones are
+// finished and signalled here.
+//
+STATIC VOID slot_complete (
+  struct hisi_hba *hba,
+  UINT32 slot_idx,
+  UINT32 data
+  )
+{
+  struct hisi_sas_slot *slot = &hba->slots[slot_idx];
+  EFI_EVENT Event = slot->event;
+  BOOLEAN NotReady;
+
+  slot->cmplt = data;
+  slot->done = TRUE;
+
+  if (slot->abandoned) {
+    slot->packet = NULL;
+    slot_finish (hba, slot_idx, &NotReady);
+  } else if (Event != NULL) {
+    slot_finish (hba, slot_idx, &NotReady);
+    hba->async_cnt--;
+    gBS->SignalEvent (Event);
+  }
+}
+
+//
+// Drain the completion queues which raised their interrupt. The caller
+// holds TPL_NOTIFY.
+//
+STATIC VOID reap_cq (
+  struct hisi_hba *hba
+  )
+{
+  struct hisi_sas_complete_hdr *complete_hdr;
+  UINT32 base = hba->base;
+  UINT32 irq, rd, wr, data, iptt;
+  int queue;
+
+  irq = READ_REG32(base, OQ_INT_SRC);
+  if (irq == 0) {
+    return;
+  }
+
+  // Clear int first, a completion arriving during the drain raises it again
+  WRITE_REG32(base, OQ_INT_SRC, irq);
+
+  for (queue = 0; queue < QUEUE_CNT; queue++) {
+    if (!(irq & BIT(queue))) {
+      continue;
+    }
+
+    rd = READ_REG32(base, COMPL_Q_0_RD_PTR + (0x14 * queue));
+    wr = READ_REG32(base, COMPL_Q_0_WR_PTR + (0x14 * queue));
+    while (rd != wr) {
       complete_hdr = &hba->complete_hdr[queue][rd];
       data = complete_hdr->data;
-
-      // Check whether dma transfer error
-      if ((data & CMPLT_HDR_ERR_RCRD_XFRD_MSK) &&
-        !(data & CMPLT_HDR_RSPNS_XFRD_MSK)) {
-        DEBUG ((EFI_D_VERBOSE, "sas retry data=0x%x\n", data));
-        DEBUG ((EFI_D_VERBOSE, "sts[0]=0x%x\n", sts->status[0]));
-        DEBUG ((EFI_D_VERBOSE, "sts[1]=0x%x\n", sts->status[1]));
-        DEBUG ((EFI_D_VERBOSE, "sts[2]=0x%x\n", sts->status[2]));
-        Status = EFI_NOT_READY;
-        // wait 1 second and retry, some disk need long time to be ready
-        // and ScsiDisk treat retry over 3 times as error
-        MicroSecondDelay(1000000);
+      iptt = (data & CMPLT_HDR_IPTT_MSK) >> CMPLT_HDR_IPTT_OFF;
+      if ((iptt < SLOT_ENTRIES) && hba->slots[iptt].used) {
+        slot_complete (hba, iptt, data);
       }
-       // Update read point
-       WRITE_REG32(base, COMPL_Q_0_RD_PTR + (0x14 * queue), w);
-       // Clear int
-       WRITE_REG32(base, OQ_INT_SRC, BIT(queue));
-       slot->used = FALSE;
-       break;
+      rd = (rd + 1) % QUEUE_SLOTS;
     }
+
+    // Update read point
+    WRITE_REG32(base, COMPL_Q_0_RD_PTR + (0x14 * queue), rd);
+  }
+}
+
+//
+// Send one command and poll the completion queues until it is done, or
+// until the packet timeout expires.
+//
+STATIC EFI_STATUS exec_cmd (
+  struct hisi_hba *hba,
+  EFI_EXT_SCSI_PASS_THRU_SCSI_REQUEST_PACKET    *Packet,
+  BOOLEAN *NotReady
+  )
+{
+  struct hisi_sas_slot *slot;
+  UINT32 slot_idx;
+  UINT64 Timeout, Elapsed;
+  EFI_STATUS Status;
+  EFI_TPL Tpl;
+
+  *NotReady = FALSE;
+
+  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+  Status = prepare_cmd (hba, Packet, NULL, &slot_idx);
+  gBS->RestoreTPL (Tpl);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  slot = &hba->slots[slot_idx];
+  // Timeout is in 100ns units, 0 waits forever
+  Timeout = DivU64x32 (Packet->Timeout + 9, 10);
+
+  for (Elapsed = 0; ; Elapsed++) {
+    Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+    reap_cq (hba);
+    if (slot->done) {
+      Status = slot_finish (hba, slot_idx, NotReady);
+      gBS->RestoreTPL (Tpl);
+      return Status;
+    }
+    if ((Timeout != 0) && (Elapsed >= Timeout)) {
+      // Release the slot when the command eventually completes
+      slot->abandoned = TRUE;
+      gBS->RestoreTPL (Tpl);
+      DEBUG ((EFI_D_ERROR, "sas command 0x%x timeout\n", ((UINT8 *)Packet->Cdb)[0]));
+      Packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_TIMEOUT_COMMAND;
+      return EFI_TIMEOUT;
+    }
+    gBS->RestoreTPL (Tpl);
+
     // Wait for status change in polling
-    NanoSecondDelay (100);
+    MicroSecondDelay (1);
   }
+}
 
-  if (BufferMap)
-       DmaUnmap (BufferMap);
+//
+// Fail the outstanding non-blocking requests, before the queues go away.
+//
+STATIC VOID abort_slots (
+  struct hisi_hba *hba
+  )
+{
+  struct hisi_sas_slot *slot;
+  EFI_EVENT Event;
+  UINT32 i;
 
-  p = (UINT8 *)&sts->status[0];
-  if (p[SENSE_DATA_PRES]) {
-    // Disk not ready normal return for ScsiDiskTestUnitReady do next try
-    SensePtr->Sense_Key = EFI_SCSI_SK_NOT_READY;
-    SensePtr->Addnl_Sense_Code = EFI_SCSI_ASC_NOT_READY;
-    SensePtr->Addnl_Sense_Code_Qualifier = EFI_SCSI_ASCQ_IN_PROGRESS;
-    // wait 1 second for disk spin up, refer drivers/scsi/sd.c
-    MicroSecondDelay(1000000);
+  for (i = 0; i < SLOT_ENTRIES; i++) {
+    slot = &hba->slots[i];
+    if (!slot->used) {
+      continue;
+    }
+    if (slot->buffer_map)
+      DmaUnmap (slot->buffer_map);
+    Event = slot->event;
+    if ((Event != NULL) && !slot->abandoned) {
+      slot->packet->HostAdapterStatus = EFI_EXT_SCSI_STATUS_HOST_ADAPTER_OTHER;
+      gBS->SignalEvent (Event);
+    }
+    slot->used = FALSE;
+  }
+  hba->async_cnt = 0;
+}
+
+STATIC
+VOID
+EFIAPI
+SasV1AsyncNotify (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  SAS_V1_INFO *SasV1Info = Context;
+  struct hisi_hba *hba = SasV1Info->hba;
+
+  reap_cq (hba);
+  if (hba->async_cnt == 0) {
+    gBS->SetTimer (Event, TimerCancel, 0);
   }
-  return Status;
 }
 
 STATIC VOID hisi_sas_v1_init(struct hisi_hba *hba, PLATFORM_SAS_PROTOCOL *plat)
@@ -671,8 +898,34 @@ SasV1ExtScsiPassThruFunction (
 {
   SAS_V1_INFO *SasV1Info = SAS_FROM_PASS_THRU(This);
   struct hisi_hba *hba = SasV1Info->hba;
+  EFI_STATUS Status;
+  EFI_TPL Tpl;
+  BOOLEAN NotReady;
+  UINT32 slot_idx, Elapsed;
+
+  if (Event != NULL) {
+    // Non-blocking, the timer reaps the completion and signals Event
+    Tpl = gBS->RaiseTPL (TPL_NOTIFY);
+    Status = prepare_cmd (hba, Packet, Event, &slot_idx);
+    if (!EFI_ERROR (Status) && (hba->async_cnt++ == 0)) {
+      gBS->SetTimer (SasV1Info->TimerEvent, TimerPeriodic, ASYNC_POLL_PERIOD);
+    }
+    gBS->RestoreTPL (Tpl);
+    return Status;
+  }
 
-  return prepare_cmd(hba, Packet);
+  //
+  // Give a disk which is not ready yet up to a second, sending the command
+  // again until it is accepted. ScsiDisk treats retry over 3 times as error.
+  //
+  for (Elapsed = 0; ; Elapsed += NOT_READY_POLL_US) {
+    Status = exec_cmd (hba, Packet, &NotReady);
+    if (!NotReady || (Elapsed >= NOT_READY_TIMEOUT_US)) {
+      break;
+    }
+    MicroSecondDelay (NOT_READY_POLL_US);
+  }
+  return Status;
 }
 
 STATIC
@@ -845,7 +1098,7 @@ SasDriverBindingStart (
   PLATFORM_SAS_PROTOCOL *plat;
   SAS_V1_INFO *SasV1Info = NULL;
   SAS_V1_TRANSPORT_DEVICE_PATH  *DevicePath;
-  UINT32 val, base;
+  UINT32 val, base, phy_up = 0, Elapsed;
   int i, phy_id = 0;
   struct hisi_sas_itct *itct;
   struct hisi_hba *hba;
@@ -878,14 +1131,19 @@ SasDriverBindingStart (
   sas_init(SasV1Info, plat);
 
   // Wait for sas controller phyup happen
-  MicroSecondDelay(100000);
+  for (Elapsed = 0; Elapsed < PHY_UP_TIMEOUT_US; Elapsed += PHY_UP_POLL_US) {
+    for (i = 0; i < PHY_CNT; i++) {
+      val = PHY_READ_REG32(base, CHL_INT2, i);
 
-  for (i = 0; i < PHY_CNT; i++) {
-    val = PHY_READ_REG32(base, CHL_INT2, i);
-
-    if (val & CHL_INT2_SL_PHY_ENA) {
-      phy_id = i;
+      if (val & CHL_INT2_SL_PHY_ENA) {
+        phy_id = i;
+        phy_up++;
+      }
+    }
+    if (phy_up) {
+      break;
     }
+    MicroSecondDelay (PHY_UP_POLL_US);
   }
 
   itct = &hba->itct[0]; //device_id = 0
@@ -916,10 +1174,19 @@ SasDriverBindingStart (
 
   CopyMem (&SasV1Info->ExtScsiPassThru, &SasV1ExtScsiPassThruProtocolTemplate, sizeof (EFI_EXT_SCSI_PASS_THRU_PROTOCOL));
   SasV1Info->ExtScsiPassThruMode.AdapterId = 2;
-  SasV1Info->ExtScsiPassThruMode.Attributes = EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_PHYSICAL | EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_LOGICAL;
+  SasV1Info->ExtScsiPassThruMode.Attributes = EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_PHYSICAL | EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_LOGICAL |
+                                              EFI_EXT_SCSI_PASS_THRU_ATTRIBUTES_NONBLOCKIO;
   SasV1Info->ExtScsiPassThruMode.IoAlign  = 64; //cache line align
   SasV1Info->ExtScsiPassThru.Mode = &SasV1Info->ExtScsiPassThruMode;
 
+  Status = gBS->CreateEvent (
+                EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                TPL_NOTIFY,
+                SasV1AsyncNotify,
+                SasV1Info,
+                &SasV1Info->TimerEvent);
+  ASSERT_EFI_ERROR (Status);
+
   DevicePath = (SAS_V1_TRANSPORT_DEVICE_PATH *)CreateDeviceNode (
                                                HARDWARE_DEVICE_PATH,
                                                HW_VENDOR_DP,
@@ -987,6 +1254,7 @@ SasDriverBindingStop (
            );
 
     gBS->CloseEvent (SasV1Info->TimerEvent);
+    abort_slots (SasV1Info->hba);
 
     for (i = 0; i < QUEUE_CNT; i++) {
       s = sizeof(struct hisi_sas_cmd_hdr) * QUEUE_SLOTS;
@@ -46,26 +46,34 @@ SmbiosGetPartNumber (
   OUT CHAR16             *PartNumber
   )
 {
-    CHAR16                        StringBuffer2[SMBIOS_STRING_MAX_LENGTH];
+    UINT8                         *SpdModPart;
+    UINT32                        SpdModPartLength;
     UINT32                        Index2;
+    UINT32                        Length;
 
-    (VOID)StrCpyS(PartNumber, SMBIOS_STRING_MAX_LENGTH - 1, L"");
     if (pGblData->Channel[Skt][Ch].Dimm[Dimm].DramType == SPD_TYPE_DDR3)
     {
-        for (Index2 = 0; Index2 < SPD_MODULE_PART; Index2++)
-        {
-            UnicodeSPrint (StringBuffer2, SMBIOS_STRING_MAX_LENGTH - 1, L"%c", pGblData->Channel[Skt][Ch].Dimm[Dimm].SpdModPart[Index2]);
-            (VOID)StrCatS(PartNumber, SMBIOS_STRING_MAX_LENGTH - 1, StringBuffer2);
-        }
+        SpdModPart = pGblData->Channel[Skt][Ch].Dimm[Dimm].SpdModPart;
+        SpdModPartLength = SPD_MODULE_PART;
     }
     else
     {
-        for (Index2 = 0; Index2 < SPD_MODULE_PART_DDR4; Index2++)
+        SpdModPart = pGblData->Channel[Skt][Ch].Dimm[Dimm].SpdModPartDDR4;
+        SpdModPartLength = SPD_MODULE_PART_DDR4;
+    }
+
+    //
+    // Copy the SPD characters directly, skipping the NUL ones
+    //
+    Length = 0;
+    for (Index2 = 0; (Index2 < SpdModPartLength) && (Length < SMBIOS_STRING_MAX_LENGTH - 2); Index2++)
+    {
+        if (SpdModPart[Index2] != 0)
         {
-            UnicodeSPrint (StringBuffer2, SMBIOS_STRING_MAX_LENGTH - 1, L"%c", pGblData->Channel[Skt][Ch].Dimm[Dimm].SpdModPartDDR4[Index2]);
-            (VOID)StrCatS(PartNumber, SMBIOS_STRING_MAX_LENGTH - 1, StringBuffer2);
+            PartNumber[Length++] = (CHAR16)SpdModPart[Index2];
         }
     }
+    PartNumber[Length] = L'\0';
 
     return;
 }
@@ -449,12 +457,6 @@ SmbiosAddType17Table (
     // Allocate Buffers
     //
     StringBufferSize = (sizeof (CHAR16)) * SMBIOS_STRING_MAX_LENGTH;
-    StringBuffer = AllocateZeroPool (StringBufferSize);
-    if(NULL == StringBuffer)
-    {
-        return EFI_OUT_OF_RESOURCES;
-    }
-
 
     //
     // Manufacture
@@ -462,8 +464,7 @@ SmbiosAddType17Table (
     ManufactureStr = AllocateZeroPool (StringBufferSize);
     if(NULL == ManufactureStr)
     {
-        Status = EFI_OUT_OF_RESOURCES;
-        goto FREE_STR_BUF;
+        return EFI_OUT_OF_RESOURCES;
     }
     UnicodeSPrint(ManufactureStr, SMBIOS_STRING_MAX_LENGTH - 1, L"NO DIMM");
 
@@ -558,7 +559,11 @@ SmbiosAddType17Table (
     {
         UnicodeSPrint(DeviceLocatorStr, SMBIOS_STRING_MAX_LENGTH, L"DIMM%x%x%x ", Skt, Ch, Dimm);
         StringBuffer = HiiGetPackageString (&gEfiCallerIdGuid, DeviceLocator, NULL);
-        (VOID)StrCatS(DeviceLocatorStr, SMBIOS_STRING_MAX_LENGTH, StringBuffer);
+        if (StringBuffer != NULL)
+        {
+            (VOID)StrCatS(DeviceLocatorStr, SMBIOS_STRING_MAX_LENGTH, StringBuffer);
+            FreePool (StringBuffer);
+        }
     }
     else
     {
@@ -659,9 +664,6 @@ FREE_STR_SN:
 FREE_STR_MAN:
     FreePool (ManufactureStr);
 
-FREE_STR_BUF:
-    FreePool (StringBuffer);
-
     return Status;
 }
 
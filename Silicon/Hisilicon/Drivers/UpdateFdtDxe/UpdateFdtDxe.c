@@ -104,7 +104,8 @@ EFIAPI UpdateFdt (
     }
 
     Size = (UINTN)fdt_totalsize ((VOID*)(PcdGet64(FdtFileAddress)));
-    NewFdtBlobSize = Size + ADD_FILE_LENGTH;
+    // Give all the fixups their free space up front, so that they run in place
+    NewFdtBlobSize = EFI_PAGES_TO_SIZE (EFI_SIZE_TO_PAGES (Size + ADD_FILE_LENGTH));
 
     Status = gBS->AllocatePages (AllocateAnyPages, EfiRuntimeServicesData, EFI_SIZE_TO_PAGES(NewFdtBlobSize), &NewFdtBlobBase);
     if (EFI_ERROR (Status))
@@ -112,7 +113,13 @@ EFIAPI UpdateFdt (
         return EFI_OUT_OF_RESOURCES;
     }
 
-    (VOID) CopyMem((VOID*)NewFdtBlobBase, Fdt, Size);
+    Error = fdt_open_into (Fdt, (VOID*)NewFdtBlobBase, NewFdtBlobSize);
+    if (Error != 0)
+    {
+        DEBUG ((EFI_D_ERROR,"ERROR: fdt_open_into (): %a\n", fdt_strerror(Error)));
+        Status = EFI_INVALID_PARAMETER;
+        goto EXIT;
+    }
 
     Status = EFIFdtUpdate(NewFdtBlobBase);
     if (EFI_ERROR (Status))
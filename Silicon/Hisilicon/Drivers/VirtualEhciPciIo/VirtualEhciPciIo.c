@@ -18,6 +18,11 @@ EhciVirtualPciIoInitialize (
   IN EFI_SYSTEM_TABLE   *SystemTable
   )
 {
+  //
+  // The EHCI is cache coherent on D0x, so register it as such: the generic
+  // NonDiscoverablePciDeviceDxe then maps DMA buffers in place instead of
+  // bouncing them, and forwards register accesses straight to MMIO.
+  //
   return RegisterNonDiscoverableMmioDevice (
            NonDiscoverableDeviceTypeEhci,
            NonDiscoverableDeviceDmaTypeCoherent,
@@ -43,6 +43,37 @@ typedef enum {
   (Register) = ((Address)       & 0xfff);  \
 }
 
+#define PCI_SEGMENT_CACHE_COUNT  (PCIE_MAX_HOSTBRIDGE * PCIE_MAX_ROOTBRIDGE)
+
+//
+// Root bridge of every segment, indexed by segment number. Built on first use
+// so that an access does not scan the whole platform table.
+//
+STATIC PCI_ROOT_BRIDGE_RESOURCE_APPETURE *mSegmentAppeture[PCI_SEGMENT_CACHE_COUNT];
+STATIC BOOLEAN                           mSegmentAppetureReady = FALSE;
+
+STATIC
+VOID
+PciSegmentLibBuildAppetureCache (
+  VOID
+  )
+{
+  UINTN  Hb;
+  UINTN  Rb;
+  UINT32 Segment;
+
+  for (Hb = 0; Hb < PCIE_MAX_HOSTBRIDGE; Hb++) {
+    for (Rb = 0; Rb < PCIE_MAX_ROOTBRIDGE; Rb++) {
+      Segment = mResAppeture[Hb][Rb].Segment;
+      // Keep the first match, as the table scan did
+      if (Segment < PCI_SEGMENT_CACHE_COUNT && mSegmentAppeture[Segment] == NULL) {
+        mSegmentAppeture[Segment] = &mResAppeture[Hb][Rb];
+      }
+    }
+  }
+  mSegmentAppetureReady = TRUE;
+}
+
 STATIC
 PCI_ROOT_BRIDGE_RESOURCE_APPETURE *
 PciSegmentLibGetAppeture (
@@ -52,6 +83,15 @@ PciSegmentLibGetAppeture (
   UINTN Hb;
   UINTN Rb;
 
+  if (!mSegmentAppetureReady) {
+    PciSegmentLibBuildAppetureCache ();
+  }
+
+  if (Segment < PCI_SEGMENT_CACHE_COUNT) {
+    ASSERT (mSegmentAppeture[Segment] != NULL);
+    return mSegmentAppeture[Segment];
+  }
+
   for (Hb = 0; Hb < PCIE_MAX_HOSTBRIDGE; Hb++) {
     for (Rb = 0; Rb < PCIE_MAX_ROOTBRIDGE; Rb++) {
       if (Segment == mResAppeture[Hb][Rb].Segment) {
@@ -139,20 +179,23 @@ CpuMemoryServiceWrite (
   return Data;
 }
 /**
-  Internal worker function to read a PCI configuration register.
+  Internal worker function to get the base of the configuration space of a
+  function.
 
-  @param  Address The address that encodes the PCI Bus, Device, Function and
-                  Register.
-  @param  Width   The width of data to read
+  The registers of the root port are at RbPciBar, the other functions of the
+  segment are in its ECAM region.
 
-  @return The value read from the PCI configuration register.
+  @param  Address The address that encodes the PCI Segment, Bus, Device and
+                  Function.
+
+  @return The MMIO base of the configuration space, 0 if the function cannot
+          be accessed.
 
 **/
 STATIC
-UINT32
-PciSegmentLibReadWorker (
-  IN  UINT64                      Address,
-  IN  PCI_CFG_WIDTH               Width
+UINT64
+PciSegmentLibGetFunctionBase (
+  IN  UINT64                      Address
   )
 {
   PCI_ROOT_BRIDGE_RESOURCE_APPETURE *Appeture;
@@ -162,30 +205,77 @@ PciSegmentLibReadWorker (
   UINT8     Function;
   UINT32    Register;
 
-  UINT64    MmioAddress;
-
   EXTRACT_PCIE_ADDRESS (Address, Segment, Bus, Device, Function, Register);
   Appeture = PciSegmentLibGetAppeture (Segment);
   if (Appeture == NULL) {
-    return 0xffffffff;
+    return 0;
   }
 
   if (Bus == Appeture->BusBase) {
     // ignore device > 0 or function > 0 on base bus
     if (Device != 0 || Function != 0) {
-      return 0xffffffff;
-    }
-    MmioAddress = Appeture->RbPciBar + Register;
-  } else {
-    // Cannot read from device under root port when link is not up
-    if (Bus == Appeture->BusBase + 1 && !PcieIsLinkUp (Appeture->RbPciBar)) {
-      return 0xffffffff;
+      return 0;
     }
+    return Appeture->RbPciBar;
+  }
 
-    MmioAddress = Appeture->Ecam + (UINT32)Address;
+  // Cannot read from device under root port when link is not up
+  if (Bus == Appeture->BusBase + 1 && !PcieIsLinkUp (Appeture->RbPciBar)) {
+    return 0;
   }
 
-  return CpuMemoryServiceRead (MmioAddress, Width);
+  return Appeture->Ecam + ((UINT32)Address & ~0xfff);
+}
+
+/**
+  Internal function to read a PCI configuration register of a function
+  whose base was returned by PciSegmentLibGetFunctionBase().
+
+  @param  Base    The base of the configuration space of the function.
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+  @param  Width   The width of data to read
+
+  @return The value read from the PCI configuration register.
+
+**/
+STATIC
+UINT32
+PciSegmentLibReadFromBase (
+  IN  UINT64                      Base,
+  IN  UINT64                      Address,
+  IN  PCI_CFG_WIDTH               Width
+  )
+{
+  if (Base == 0) {
+    return 0xffffffff;
+  }
+
+  return CpuMemoryServiceRead (Base + (Address & 0xfff), Width);
+}
+
+/**
+  Internal worker function to read a PCI configuration register.
+
+  @param  Address The address that encodes the PCI Bus, Device, Function and
+                  Register.
+  @param  Width   The width of data to read
+
+  @return The value read from the PCI configuration register.
+
+**/
+STATIC
+UINT32
+PciSegmentLibReadWorker (
+  IN  UINT64                      Address,
+  IN  PCI_CFG_WIDTH               Width
+  )
+{
+  return PciSegmentLibReadFromBase (
+           PciSegmentLibGetFunctionBase (Address),
+           Address,
+           Width
+           );
 }
 
 /**
@@ -1331,6 +1421,7 @@ PciSegmentReadBuffer (
   )
 {
   UINTN                             ReturnValue;
+  UINT64                            Base;
 
   ASSERT_INVALID_PCI_SEGMENT_ADDRESS (StartAddress, 0);
   ASSERT (((StartAddress & 0xFFF) + Size) <= 0x1000);
@@ -1346,11 +1437,16 @@ PciSegmentReadBuffer (
   //
   ReturnValue = Size;
 
+  //
+  // The range is within one function, resolve its base only once
+  //
+  Base = PciSegmentLibGetFunctionBase (StartAddress);
+
   if ((StartAddress & BIT0) != 0) {
     //
     // Read a byte if StartAddress is byte aligned
     //
-    *(volatile UINT8 *)Buffer = PciSegmentRead8 (StartAddress);
+    *(volatile UINT8 *)Buffer = (UINT8) PciSegmentLibReadFromBase (Base, StartAddress, PciCfgWidthUint8);
     StartAddress += sizeof (UINT8);
     Size -= sizeof (UINT8);
     Buffer = (UINT8*)Buffer + 1;
@@ -1360,7 +1456,7 @@ PciSegmentReadBuffer (
     //
     // Read a word if StartAddress is word aligned
     //
-    WriteUnaligned16 (Buffer, PciSegmentRead16 (StartAddress));
+    WriteUnaligned16 (Buffer, (UINT16) PciSegmentLibReadFromBase (Base, StartAddress, PciCfgWidthUint16));
     StartAddress += sizeof (UINT16);
     Size -= sizeof (UINT16);
     Buffer = (UINT16*)Buffer + 1;
@@ -1370,7 +1466,7 @@ PciSegmentReadBuffer (
     //
     // Read as many double words as possible
     //
-    WriteUnaligned32 (Buffer, PciSegmentRead32 (StartAddress));
+    WriteUnaligned32 (Buffer, PciSegmentLibReadFromBase (Base, StartAddress, PciCfgWidthUint32));
     StartAddress += sizeof (UINT32);
     Size -= sizeof (UINT32);
     Buffer = (UINT32*)Buffer + 1;
@@ -1380,7 +1476,7 @@ PciSegmentReadBuffer (
     //
     // Read the last remaining word if exist
     //
-    WriteUnaligned16 (Buffer, PciSegmentRead16 (StartAddress));
+    WriteUnaligned16 (Buffer, (UINT16) PciSegmentLibReadFromBase (Base, StartAddress, PciCfgWidthUint16));
     StartAddress += sizeof (UINT16);
     Size -= sizeof (UINT16);
     Buffer = (UINT16*)Buffer + 1;
@@ -1390,7 +1486,7 @@ PciSegmentReadBuffer (
     //
     // Read the last remaining byte if exist
     //
-    *(volatile UINT8 *)Buffer = PciSegmentRead8 (StartAddress);
+    *(volatile UINT8 *)Buffer = (UINT8) PciSegmentLibReadFromBase (Base, StartAddress, PciCfgWidthUint8);
   }
 
   return ReturnValue;
@@ -32,6 +32,11 @@ typedef struct
   UINT8 data5;
 }MAC_ADDRESS;
 
+/*
+ * Apply the platform fixups to the FDT at FdtFileAddr, in place. The FDT must
+ * have been opened with fdt_open_into () with at least ADD_FILE_LENGTH bytes
+ * of free space.
+ */
 extern  EFI_STATUS EFIFdtUpdate(UINTN FdtFileAddr);
 
 #endif
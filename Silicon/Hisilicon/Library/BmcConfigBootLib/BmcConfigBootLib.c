@@ -21,6 +21,101 @@
 #include <Guid/GlobalVariable.h>
 #include <Protocol/DevicePathToText.h>
 
+//
+// The file systems and the text of their device paths, collected once for
+// all the boot options classified by one SetBootOrder () call.
+//
+STATIC EFI_DEVICE_PATH_TO_TEXT_PROTOCOL  *mDevPathToText;
+STATIC EFI_DEVICE_PATH_PROTOCOL          **mFileSysPath;
+STATIC CHAR16                            **mFileSysPathTxt;
+STATIC UINTN                             mFileSysCount;
+
+STATIC
+EFI_STATUS
+CollectFileSysPaths (
+  VOID
+  )
+{
+  EFI_STATUS                        Status;
+  EFI_HANDLE                        *FileSystemHandles;
+  UINTN                             NumberFileSystemHandles;
+  UINTN                             Index;
+
+  Status = gBS->LocateProtocol (
+                  &gEfiDevicePathToTextProtocolGuid,
+                  NULL,
+                  (VOID **) &mDevPathToText);
+  ASSERT_EFI_ERROR(Status);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->LocateHandleBuffer (
+                  ByProtocol,
+                  &gEfiSimpleFileSystemProtocolGuid,
+                  NULL,
+                  &NumberFileSystemHandles,
+                  &FileSystemHandles
+                  );
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Locate SimpleFileSystemProtocol error(%r)\n", Status));
+    return Status;
+  }
+
+  mFileSysPath = AllocatePool (NumberFileSystemHandles * sizeof (*mFileSysPath));
+  mFileSysPathTxt = AllocateZeroPool (NumberFileSystemHandles * sizeof (*mFileSysPathTxt));
+  if ((mFileSysPath == NULL) || (mFileSysPathTxt == NULL)) {
+    DEBUG ((DEBUG_ERROR, "Out of resources.\n"));
+    if (mFileSysPath != NULL) {
+      FreePool (mFileSysPath);
+      mFileSysPath = NULL;
+    }
+    if (mFileSysPathTxt != NULL) {
+      FreePool (mFileSysPathTxt);
+      mFileSysPathTxt = NULL;
+    }
+    FreePool (FileSystemHandles);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < NumberFileSystemHandles; Index++) {
+    mFileSysPath[Index] = DevicePathFromHandle (FileSystemHandles[Index]);
+    mFileSysPathTxt[Index] = mDevPathToText->ConvertDevicePathToText (
+                                               mFileSysPath[Index],
+                                               TRUE,
+                                               TRUE
+                                               );
+  }
+  mFileSysCount = NumberFileSystemHandles;
+
+  FreePool (FileSystemHandles);
+
+  return EFI_SUCCESS;
+}
+
+STATIC
+VOID
+FreeFileSysPaths (
+  VOID
+  )
+{
+  UINTN       Index;
+
+  if (mFileSysPathTxt == NULL) {
+    return;
+  }
+
+  for (Index = 0; Index < mFileSysCount; Index++) {
+    if (mFileSysPathTxt[Index] != NULL) {
+      FreePool (mFileSysPathTxt[Index]);
+    }
+  }
+  FreePool (mFileSysPathTxt);
+  FreePool (mFileSysPath);
+  mFileSysPathTxt = NULL;
+  mFileSysPath = NULL;
+  mFileSysCount = 0;
+}
 
 STATIC
 UINT16
@@ -55,60 +150,38 @@ GetBBSTypeFromUsbPath (
   )
 {
   EFI_STATUS                        Status;
-  EFI_HANDLE                        *FileSystemHandles;
-  UINTN                             NumberFileSystemHandles;
   UINTN                             Index;
-  EFI_DEVICE_PATH_PROTOCOL          *FileSysPath;
-  EFI_DEVICE_PATH_TO_TEXT_PROTOCOL  *DevPathToText;
   CHAR16                            *UsbPathTxt;
-  CHAR16                            *FileSysPathTxt;
   UINT16                            Result;
 
-  Status = gBS->LocateProtocol (
-                  &gEfiDevicePathToTextProtocolGuid,
-                  NULL,
-                  (VOID **) &DevPathToText);
-  ASSERT_EFI_ERROR(Status);
+  if (mFileSysPathTxt == NULL) {
+    Status = CollectFileSysPaths ();
+    if (EFI_ERROR (Status)) {
+      return BBS_TYPE_UNKNOWN;
+    }
+  }
 
   Result = BBS_TYPE_UNKNOWN;
-  UsbPathTxt = DevPathToText->ConvertDevicePathToText (UsbPath, TRUE, TRUE);
+  UsbPathTxt = mDevPathToText->ConvertDevicePathToText (UsbPath, TRUE, TRUE);
   if (UsbPathTxt == NULL) {
     return Result;
   }
 
-  Status = gBS->LocateHandleBuffer (
-                  ByProtocol,
-                  &gEfiSimpleFileSystemProtocolGuid,
-                  NULL,
-                  &NumberFileSystemHandles,
-                  &FileSystemHandles
-                  );
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Locate SimpleFileSystemProtocol error(%r)\n", Status));
-    FreePool (UsbPathTxt);
-    return BBS_TYPE_UNKNOWN;
-  }
-
-  for (Index = 0; Index < NumberFileSystemHandles; Index++) {
-    FileSysPath = DevicePathFromHandle (FileSystemHandles[Index]);
-    FileSysPathTxt = DevPathToText->ConvertDevicePathToText (FileSysPath, TRUE, TRUE);
-
-    if (FileSysPathTxt == NULL) {
+  for (Index = 0; Index < mFileSysCount; Index++) {
+    if (mFileSysPathTxt[Index] == NULL) {
       continue;
     }
 
-    Result = GetBBSTypeFromFileSysPath (UsbPathTxt, FileSysPathTxt, FileSysPath);
-    FreePool (FileSysPathTxt);
-
+    Result = GetBBSTypeFromFileSysPath (
+               UsbPathTxt,
+               mFileSysPathTxt[Index],
+               mFileSysPath[Index]
+               );
     if (Result != BBS_TYPE_UNKNOWN) {
       break;
     }
   }
 
-  if (NumberFileSystemHandles != 0) {
-    FreePool (FileSystemHandles);
-  }
-
   FreePool (UsbPathTxt);
 
   return Result;
@@ -408,6 +481,7 @@ SetBootOrder (
   }
 
 Exit:
+  FreeFileSysPaths ();
   FreePool (BootOrder);
   if (NewOrder != NULL) {
     FreePool (NewOrder);
@@ -16,6 +16,7 @@
 
 #include <Uefi.h>
 #include <PiDxe.h>
+#include <Library/ArmGenericTimerCounterLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
@@ -37,6 +38,58 @@ extern I2C_DEVICE gRtcDevice;
 
 STATIC BOOLEAN       mDS3231Initialized = FALSE;
 
+//
+// GetTime reads the RTC once and then advances the time from the generic
+// timer counter, going back to the RTC every RTC_CACHE_RESYNC_SECONDS or
+// after SetTime. This keeps frequent callers, the OS included, off the I2C
+// bus.
+//
+#define RTC_CACHE_RESYNC_SECONDS  60
+
+STATIC BOOLEAN       mRtcCacheValid = FALSE;
+STATIC UINTN         mRtcCacheEpoch;
+STATIC UINT64        mRtcCacheCount;
+STATIC INT16         mRtcCacheTimeZone;
+STATIC UINT8         mRtcCacheDaylight;
+
+STATIC
+BOOLEAN
+RtcCacheGetTime (
+  OUT EFI_TIME  *Time
+  )
+{
+  UINT64  Elapsed;
+
+  if (!mRtcCacheValid) {
+    return FALSE;
+  }
+
+  Elapsed = DivU64x32 (ArmGenericTimerGetSystemCount () - mRtcCacheCount,
+              (UINT32)ArmGenericTimerGetTimerFreq ());
+  if (Elapsed >= RTC_CACHE_RESYNC_SECONDS) {
+    return FALSE;
+  }
+
+  EpochToEfiTime (mRtcCacheEpoch + (UINTN)Elapsed, Time);
+  Time->Nanosecond = 0;
+  Time->TimeZone = mRtcCacheTimeZone;
+  Time->Daylight = mRtcCacheDaylight;
+  return TRUE;
+}
+
+STATIC
+VOID
+RtcCacheSetTime (
+  IN EFI_TIME  *Time
+  )
+{
+  mRtcCacheEpoch = EfiTimeToEpoch (Time);
+  mRtcCacheCount = ArmGenericTimerGetSystemCount ();
+  mRtcCacheTimeZone = Time->TimeZone;
+  mRtcCacheDaylight = Time->Daylight;
+  mRtcCacheValid = TRUE;
+}
+
 EFI_STATUS
 IdentifyDS3231 (
   VOID
@@ -137,6 +190,10 @@ LibGetTime (
     }
   }
 
+  if (RtcCacheGetTime (Time)) {
+    return EFI_SUCCESS;
+  }
+
   (VOID)CopyMem (&Dev, &gRtcDevice, sizeof (Dev));
 
 
@@ -189,6 +246,7 @@ LibGetTime (
     return EFI_DEVICE_ERROR;
   }
 
+  RtcCacheSetTime (Time);
   return EFI_SUCCESS;
 }
 
@@ -219,6 +277,8 @@ LibSetTime (
     return EFI_INVALID_PARAMETER;
   }
 
+  mRtcCacheValid = FALSE;
+
   // Initialize the hardware if not already done
   if (!mDS3231Initialized) {
     Status = InitializeDS3231 ();
@@ -78,6 +78,7 @@ SerialPortWrite (
 )
 {
   UINTN  Result;
+  UINTN  Burst;
 
   if (NULL == Buffer) {
     return 0;
@@ -85,10 +86,23 @@ SerialPortWrite (
 
   Result = NumberOfBytes;
 
-  while (NumberOfBytes--) {
-
-    SerialPortWriteChar(*Buffer);
-    Buffer++;
+  while (NumberOfBytes > 0) {
+    //
+    // Once the TX FIFO has drained, fill it in one go rather than polling
+    // the status register before every byte.
+    //
+    if ((MmioRead8 (UART_USR_REG) & UART_USR_TFE) == UART_USR_TFE) {
+      Burst = MIN (NumberOfBytes, FIFO_MAXSIZE);
+      NumberOfBytes -= Burst;
+      while (Burst--) {
+        MmioWrite8 (UART_THR_REG, *Buffer);
+        Buffer++;
+      }
+    } else {
+      SerialPortWriteChar (*Buffer);
+      Buffer++;
+      NumberOfBytes--;
+    }
   }
 
   return Result;
@@ -163,24 +177,16 @@ VOID SerialPortWriteChar(UINT8 scShowChar)
     while(ulLoop < (UINT32)UART_SEND_DELAY)
     {
 
-        if ((MmioRead8 (UART_USR_REG) & 0x02) == 0x02)
+        if ((MmioRead8 (UART_USR_REG) & UART_USR_TFNF) == UART_USR_TFNF)
         {
             break;
         }
 
         ulLoop++;
     }
-    MmioWrite8 (UART_THR_REG, (UINT8)scShowChar);
 
-    ulLoop = 0;
-    while(ulLoop < (UINT32)UART_SEND_DELAY)
-    {
-        if ((MmioRead8 (UART_USR_REG) & 0x04) == 0x04)
-        {
-            break;
-        }
-        ulLoop++;
-    }
+    // No need to wait for the FIFO to drain, the next byte only needs room in it
+    MmioWrite8 (UART_THR_REG, (UINT8)scShowChar);
 
     return;
 }
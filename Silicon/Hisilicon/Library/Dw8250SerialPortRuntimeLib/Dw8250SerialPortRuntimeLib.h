@@ -100,6 +100,8 @@
 
 
 #define UART_USR_BUSY  0x01
+#define UART_USR_TFNF  0x02
+#define UART_USR_TFE   0x04
 
 #define FIFO_MAXSIZE    32
 
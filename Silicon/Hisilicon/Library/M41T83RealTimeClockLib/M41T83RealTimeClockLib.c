@@ -9,6 +9,7 @@
 
 #include <Uefi.h>
 #include <PiDxe.h>
+#include <Library/ArmGenericTimerCounterLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
@@ -25,6 +26,58 @@ extern I2C_DEVICE gRtcDevice;
 
 STATIC EFI_LOCK  mRtcLock;
 
+//
+// GetTime reads the RTC once and then advances the time from the generic
+// timer counter, going back to the RTC every RTC_CACHE_RESYNC_SECONDS or
+// after SetTime. This keeps frequent callers, the OS included, off the I2C
+// bus.
+//
+#define RTC_CACHE_RESYNC_SECONDS  60
+
+STATIC BOOLEAN       mRtcCacheValid = FALSE;
+STATIC UINTN         mRtcCacheEpoch;
+STATIC UINT64        mRtcCacheCount;
+STATIC INT16         mRtcCacheTimeZone;
+STATIC UINT8         mRtcCacheDaylight;
+
+STATIC
+BOOLEAN
+RtcCacheGetTime (
+  OUT EFI_TIME  *Time
+  )
+{
+  UINT64  Elapsed;
+
+  if (!mRtcCacheValid) {
+    return FALSE;
+  }
+
+  Elapsed = DivU64x32 (ArmGenericTimerGetSystemCount () - mRtcCacheCount,
+              (UINT32)ArmGenericTimerGetTimerFreq ());
+  if (Elapsed >= RTC_CACHE_RESYNC_SECONDS) {
+    return FALSE;
+  }
+
+  EpochToEfiTime (mRtcCacheEpoch + (UINTN)Elapsed, Time);
+  Time->Nanosecond = 0;
+  Time->TimeZone = mRtcCacheTimeZone;
+  Time->Daylight = mRtcCacheDaylight;
+  return TRUE;
+}
+
+STATIC
+VOID
+RtcCacheSetTime (
+  IN EFI_TIME  *Time
+  )
+{
+  mRtcCacheEpoch = EfiTimeToEpoch (Time);
+  mRtcCacheCount = ArmGenericTimerGetSystemCount ();
+  mRtcCacheTimeZone = Time->TimeZone;
+  mRtcCacheDaylight = Time->Daylight;
+  mRtcCacheValid = TRUE;
+}
+
 /**
   Read RTC content through its registers.
 
@@ -190,6 +243,8 @@ LibSetTime (
     return EFI_INVALID_PARAMETER;
   }
 
+  mRtcCacheValid = FALSE;
+
   Status = SwitchRtcI2cChannelAndLock ();
   if (EFI_ERROR (Status)) {
     return Status;
@@ -293,6 +348,10 @@ LibGetTime (
     return EFI_INVALID_PARAMETER;
   }
 
+  if (RtcCacheGetTime (Time)) {
+    return EFI_SUCCESS;
+  }
+
   Status = SwitchRtcI2cChannelAndLock ();
   if (EFI_ERROR (Status)) {
     return Status;
@@ -337,6 +396,8 @@ LibGetTime (
       goto Exit;
   }
 
+  RtcCacheSetTime (Time);
+
 Exit:
   ReleaseOwnershipOfRtc ();
   // Release RTC Lock.
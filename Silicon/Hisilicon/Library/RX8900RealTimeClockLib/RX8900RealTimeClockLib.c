@@ -8,6 +8,7 @@
 
 #include <Uefi.h>
 #include <PiDxe.h>
+#include <Library/ArmGenericTimerCounterLib.h>
 #include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
@@ -28,6 +29,58 @@ STATIC BOOLEAN       mRX8900Initialized = FALSE;
 STATIC CONST CHAR16  mTimeZoneVariableName[] = L"RX8900RtcTimeZone";
 STATIC CONST CHAR16  mDaylightVariableName[] = L"RX8900RtcDaylight";
 
+//
+// GetTime reads the RTC once and then advances the time from the generic
+// timer counter, going back to the RTC every RTC_CACHE_RESYNC_SECONDS or
+// after SetTime. This keeps frequent callers, the OS included, off the I2C
+// bus.
+//
+#define RTC_CACHE_RESYNC_SECONDS  60
+
+STATIC BOOLEAN       mRtcCacheValid = FALSE;
+STATIC UINTN         mRtcCacheEpoch;
+STATIC UINT64        mRtcCacheCount;
+STATIC INT16         mRtcCacheTimeZone;
+STATIC UINT8         mRtcCacheDaylight;
+
+STATIC
+BOOLEAN
+RtcCacheGetTime (
+  OUT EFI_TIME  *Time
+  )
+{
+  UINT64  Elapsed;
+
+  if (!mRtcCacheValid) {
+    return FALSE;
+  }
+
+  Elapsed = DivU64x32 (ArmGenericTimerGetSystemCount () - mRtcCacheCount,
+              (UINT32)ArmGenericTimerGetTimerFreq ());
+  if (Elapsed >= RTC_CACHE_RESYNC_SECONDS) {
+    return FALSE;
+  }
+
+  EpochToEfiTime (mRtcCacheEpoch + (UINTN)Elapsed, Time);
+  Time->Nanosecond = 0;
+  Time->TimeZone = mRtcCacheTimeZone;
+  Time->Daylight = mRtcCacheDaylight;
+  return TRUE;
+}
+
+STATIC
+VOID
+RtcCacheSetTime (
+  IN EFI_TIME  *Time
+  )
+{
+  mRtcCacheEpoch = EfiTimeToEpoch (Time);
+  mRtcCacheCount = ArmGenericTimerGetSystemCount ();
+  mRtcCacheTimeZone = Time->TimeZone;
+  mRtcCacheDaylight = Time->Daylight;
+  mRtcCacheValid = TRUE;
+}
+
 EFI_STATUS
 InitializeRX8900 (
   VOID
@@ -192,6 +245,10 @@ LibGetTime (
     }
   }
 
+  if (RtcCacheGetTime (Time)) {
+    return EFI_SUCCESS;
+  }
+
   Status = SwitchRtcI2cChannelAndLock ();
   if (EFI_ERROR (Status)) {
     ReleaseOwnershipOfRtc ();
@@ -241,6 +298,10 @@ Err:
     TryCount++;
   } while ((TryCount < 3) && (EFI_ERROR (Status)));
 
+  if (!EFI_ERROR (Status)) {
+    RtcCacheSetTime (Time);
+  }
+
   ReleaseOwnershipOfRtc ();
   return Status;
 }
@@ -316,6 +377,8 @@ LibSetTime (
   EFI_STATUS  Status;
   UINTN EpochSeconds;
 
+  mRtcCacheValid = FALSE;
+
   // Initialize the hardware if not already done
   if (!mRX8900Initialized) {
     Status = InitializeRX8900 ();
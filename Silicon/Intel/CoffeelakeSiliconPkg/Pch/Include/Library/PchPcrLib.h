@@ -223,4 +223,32 @@ PchPcrAndThenOr8 (
   IN  UINT8                             OrData
   );
 
+///
+/// One register update of PchPcrAndThenOr32List
+///
+typedef struct {
+  UINT32        Offset;        ///< Register offset of the Port ID
+  UINT32        AndData;       ///< AND Data. 0 writes OrData without reading the register
+  UINT32        OrData;        ///< OR Data
+} PCH_PCR_AND_THEN_OR32_ENTRY;
+
+/**
+  Write a list of PCR registers of one Port ID and read back the last one.
+  The registers are written in list order. A single read back at the end
+  ensures all the PCR cycles are completed before next operation.
+  The Offsets should not exceed 0xFFFF and must be aligned with 4 bytes.
+
+  @param[in]  Pid      Port ID
+  @param[in]  List     Register updates
+  @param[in]  Count    Number of entries in List
+
+  @retval  UINT32      Value read back from the last register, 0 if Count is 0
+**/
+UINT32
+PchPcrAndThenOr32List (
+  IN  PCH_SBI_PID                       Pid,
+  IN  CONST PCH_PCR_AND_THEN_OR32_ENTRY *List,
+  IN  UINTN                             Count
+  );
+
 #endif // _PCH_PCR_LIB_H_
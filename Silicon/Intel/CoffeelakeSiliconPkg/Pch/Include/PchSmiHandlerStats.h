@@ -0,0 +1,78 @@
+/** @file
+  Definitions of the PCH SMI handler statistics.
+
+  The PCH SMI dispatcher measures the time every child handler spends in SMM
+  and keeps the statistics in SMRAM. They are read through the SMM communicate
+  buffer with the gPchSmiHandlerStatsGuid header.
+
+  Copyright (c) 2020 Intel Corporation. All rights reserved. <BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef _PCH_SMI_HANDLER_STATS_H_
+#define _PCH_SMI_HANDLER_STATS_H_
+
+#define PCH_SMI_HANDLER_STATS_GUID \
+  { 0x2a2de3ff, 0x1300, 0x48a9, { 0x88, 0xdf, 0x95, 0x2d, 0x0a, 0x12, 0x00, 0x27 } }
+
+extern EFI_GUID gPchSmiHandlerStatsGuid;
+
+//
+// Commands
+//
+#define PCH_SMI_HANDLER_STATS_COMMAND_GET_INFO  0x1
+#define PCH_SMI_HANDLER_STATS_COMMAND_GET_DATA  0x2
+#define PCH_SMI_HANDLER_STATS_COMMAND_RESET     0x3
+
+//
+// Statistics of one handler, in TSC ticks. MinTsc is only valid if Count is not 0.
+//
+typedef struct {
+  UINT64    Count;
+  UINT64    MinTsc;
+  UINT64    MaxTsc;
+  UINT64    TotalTsc;
+} PCH_SMI_HANDLER_STATS;
+
+typedef struct {
+  EFI_GUID                HandlerType;    // GUID of the dispatch protocol the handler was registered with
+  UINT64                  Handler;        // Address of the handler
+  UINT64                  Context;        // SW SMI value, GPI number, PCH or eSPI SMI type, 0 for the other types
+  PCH_SMI_HANDLER_STATS   Stats;
+} PCH_SMI_HANDLER_STATS_ENTRY;
+
+typedef struct {
+  UINT32    Command;
+  UINT32    DataLength;
+  UINT64    ReturnStatus;
+} PCH_SMI_HANDLER_STATS_PARAMETER_HEADER;
+
+//
+// PCH_SMI_HANDLER_STATS_COMMAND_GET_INFO
+//
+typedef struct {
+  PCH_SMI_HANDLER_STATS_PARAMETER_HEADER  Header;
+  UINT64                                  HandlerCount;
+} PCH_SMI_HANDLER_STATS_PARAMETER_GET_INFO;
+
+//
+// PCH_SMI_HANDLER_STATS_COMMAND_GET_DATA
+// On input Count is the number of entries following the structure, on output
+// the number of entries filled, starting at handler index Offset.
+//
+typedef struct {
+  PCH_SMI_HANDLER_STATS_PARAMETER_HEADER  Header;
+  UINT64                                  Offset;
+  UINT64                                  Count;
+//PCH_SMI_HANDLER_STATS_ENTRY             Entry[Count];
+} PCH_SMI_HANDLER_STATS_PARAMETER_GET_DATA;
+
+//
+// PCH_SMI_HANDLER_STATS_COMMAND_RESET
+//
+typedef struct {
+  PCH_SMI_HANDLER_STATS_PARAMETER_HEADER  Header;
+} PCH_SMI_HANDLER_STATS_PARAMETER_RESET;
+
+#endif
@@ -253,6 +253,38 @@ IsDevicePresent (
   UINT64 Base
   );
 
+/*
+  Checks if the slot of a PCH rootport is empty.
+  Presence detect state is used rather than link active, because PDS changes immediately
+  and LA takes a few milliseconds to stabilize. Rootports without a slot are never empty.
+
+  @param[in] RpBase          rootport's base address
+
+  @retval TRUE when the rootport has a slot and no device is present in it; FALSE otherwise
+*/
+BOOLEAN
+IsRootportSlotEmpty (
+  UINT64 RpBase
+  );
+
+/*
+  Waits until the links of the given PCH rootports are active.
+  All the rootports are polled together against a single deadline, so the total wait
+  does not depend on the number of rootports.
+
+  @param[in] RpBase          array of rootport base addresses
+  @param[in] RpCount         number of rootports in RpBase, 32 at most
+  @param[in] TimeoutUs       maximum time to wait, in microseconds
+
+  @retval bitmap of the rootports whose link is active, bit N for RpBase[N]
+*/
+UINT32
+WaitForRootportsLinkActive (
+  CONST UINT64  *RpBase,
+  UINT32        RpCount,
+  UINT32        TimeoutUs
+  );
+
 /*
   Checks if device is a multifunction device
 
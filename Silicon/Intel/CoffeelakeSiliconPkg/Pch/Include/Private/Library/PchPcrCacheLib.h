@@ -0,0 +1,86 @@
+/** @file
+  Header file for PchPcrCacheLib. This library keeps the value of PCR registers
+  which cannot change anymore so that they are read through the P2SB window once.
+  In PEI the values are kept in a private HOB since .data section is read only
+  in PEI pre mem. In DXE and SMM every module takes a copy of the HOB at entry and
+  keeps its own values in a static buffer.
+
+  Only registers which are read only for BIOS or are locked may be cached.
+
+  Copyright (c) 2020 Intel Corporation. All rights reserved. <BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#ifndef _PCH_PCR_CACHE_LIB_H_
+#define _PCH_PCR_CACHE_LIB_H_
+
+#include <Library/PchPcrLib.h>
+
+extern EFI_GUID gPchPcrCacheHobGuid;
+
+#define PCH_PCR_CACHE_ENTRY_MAX  64
+
+typedef struct {
+  UINT32        Key;           ///< Port ID in bits 23:16, register offset in bits 15:0
+  UINT32        Data;
+} PCH_PCR_CACHE_ENTRY;
+
+///
+/// Data of the gPchPcrCacheHobGuid HOB
+///
+typedef struct {
+  UINT32                Count;
+  PCH_PCR_CACHE_ENTRY   Entry[PCH_PCR_CACHE_ENTRY_MAX];
+} PCH_PCR_CACHE;
+
+#define PCH_PCR_CACHE_KEY(Pid, Offset)  ((((UINT32) (UINT8) (Pid)) << 16) | (UINT16) (Offset))
+
+/**
+  Get the cached value of a PCR register.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+  @param[out] Data     Cached value of the register
+
+  @retval TRUE         The register is cached, Data is valid
+  @retval FALSE        The register is not cached
+**/
+BOOLEAN
+PchPcrCacheGet32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset,
+  OUT UINT32                            *Data
+  );
+
+/**
+  Cache the value of a PCR register.
+  Nothing is done if the cache is full.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+  @param[in]  Data     Value of the register
+**/
+VOID
+PchPcrCacheSet32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset,
+  IN  UINT32                            Data
+  );
+
+/**
+  Read PCR register through the cache.
+  The register is read and cached if it is not cached yet.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+
+  @retval UINT32       PCR register value.
+**/
+UINT32
+PchPcrCacheRead32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset
+  );
+
+#endif
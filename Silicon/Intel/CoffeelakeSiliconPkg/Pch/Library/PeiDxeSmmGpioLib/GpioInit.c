@@ -8,6 +8,7 @@
 
 #include "GpioLibrary.h"
 #include <Register/PchRegsPcr.h>
+#include <Library/PcdLib.h>
 
 //
 // GPIO_GROUP_DW_DATA structure is used by GpioConfigurePch function
@@ -112,13 +113,48 @@ GpioDwRegValueFromGpioConfig (
   }
 }
 
+/**
+  Update a GPIO register through a read-modify-write access. The register is
+  not accessed when nothing is to be changed and is not written when it
+  already holds the requested value, which is the case for most pads after a
+  warm reset.
+
+  @param[in] Address                    MMIO address of the register
+  @param[in] AndData                    Value AND-ed with the current register value
+  @param[in] OrData                     Value OR-ed with the result of the AND operation
+**/
+STATIC
+VOID
+GpioMmioUpdate32 (
+  IN UINTN                     Address,
+  IN UINT32                    AndData,
+  IN UINT32                    OrData
+  )
+{
+  UINT32                 Data32;
+  UINT32                 NewData32;
+
+  if ((AndData == MAX_UINT32) && (OrData == 0)) {
+    return;
+  }
+
+  Data32    = MmioRead32 (Address);
+  NewData32 = (Data32 & AndData) | OrData;
+  if (NewData32 != Data32) {
+    MmioWrite32 (Address, NewData32);
+  }
+}
+
 /**
   This internal procedure will scan GPIO initialization table and unlock
-  all pads present in it
+  all pads present in it which belong to the group of GPIO Initialization
+  table record at Index
 
   @param[in] NumberOfItem               Number of GPIO pad records in table
   @param[in] GpioInitTableAddress       GPIO initialization table
   @param[in] Index                      Index of GPIO Initialization table record
+  @param[in] WholeTable                 TRUE:  Scan the whole table from Index for pads of the group
+                                        FALSE: Stop at the first record from a different group
 
   @retval EFI_SUCCESS                   The function completed successfully
   @retval EFI_INVALID_PARAMETER         Invalid group or pad number
@@ -128,10 +164,13 @@ EFI_STATUS
 GpioUnlockPadsForAGroup (
   IN UINT32                    NumberOfItems,
   IN GPIO_INIT_CONFIG          *GpioInitTableAddress,
-  IN UINT32                    Index
+  IN UINT32                    Index,
+  IN BOOLEAN                   WholeTable
   )
 {
   UINT32                 PadsToUnlock[GPIO_GROUP_DW_NUMBER];
+  UINT32                 PadCfgLockRegVal;
+  UINT32                 PadCfgLockTxRegVal;
   UINT32                 DwNum;
   UINT32                 PadBitPosition;
   CONST GPIO_GROUP_INFO  *GpioGroupInfo;
@@ -152,10 +191,13 @@ GpioUnlockPadsForAGroup (
   // Loop through pads for one group. If pad belongs to a different group then
   // break and move to register programming.
   //
-  while (Index < NumberOfItems) {
+  for (; Index < NumberOfItems; Index++) {
 
     GpioData   = &GpioInitTableAddress[Index];
     if (GroupIndex != GpioGetGroupIndexFromGpioPad (GpioData->GpioPad)) {
+      if (WholeTable) {
+        continue;
+      }
       //if next pad is from different group then break loop
       break;
     }
@@ -180,18 +222,22 @@ GpioUnlockPadsForAGroup (
     // Update pads which need to be unlocked
     //
     PadsToUnlock[DwNum] |= 0x1 << PadBitPosition;
-
-    //Move to next item
-    Index++;
   }
 
   for (DwNum = 0; DwNum <= GPIO_GET_DW_NUM (GpioGroupInfo[GroupIndex].PadPerGroup); DwNum++) {
     //
-    // Unlock pads
+    // Unlock pads. Lock registers are written through sideband so only pads
+    // which are currently locked get unlocked.
     //
     if (PadsToUnlock[DwNum] != 0) {
-      GpioUnlockPadCfgForGroupDw (Group, DwNum, PadsToUnlock[DwNum]);
-      GpioUnlockPadCfgTxForGroupDw (Group, DwNum, PadsToUnlock[DwNum]);
+      GpioGetPadCfgLockForGroupDw (Group, DwNum, &PadCfgLockRegVal);
+      GpioGetPadCfgLockTxForGroupDw (Group, DwNum, &PadCfgLockTxRegVal);
+      if ((PadsToUnlock[DwNum] & PadCfgLockRegVal) != 0) {
+        GpioUnlockPadCfgForGroupDw (Group, DwNum, PadsToUnlock[DwNum] & PadCfgLockRegVal);
+      }
+      if ((PadsToUnlock[DwNum] & PadCfgLockTxRegVal) != 0) {
+        GpioUnlockPadCfgTxForGroupDw (Group, DwNum, PadsToUnlock[DwNum] & PadCfgLockTxRegVal);
+      }
     }
   }
 
@@ -199,22 +245,29 @@ GpioUnlockPadsForAGroup (
 }
 
 /**
-  This procedure will initialize multiple PCH GPIO pins
+  This internal procedure will initialize all pads of GPIO initialization table
+  which belong to the group of GPIO Initialization table record at Index
 
-  @param[in] NumberofItem               Number of GPIO pads to be updated
-  @param[in] GpioInitTableAddress       GPIO initialization table
+  @param[in]     NumberOfItem           Number of GPIO pad records in table
+  @param[in]     GpioInitTableAddress   GPIO initialization table
+  @param[in, out] Index                 On input index of the first GPIO Initialization table record
+                                        of the group, on output index of the record following the
+                                        last record processed
+  @param[in]     WholeTable             TRUE:  Scan the whole table from Index for pads of the group
+                                        FALSE: Stop at the first record from a different group
 
   @retval EFI_SUCCESS                   The function completed successfully
   @retval EFI_INVALID_PARAMETER         Invalid group or pad number
 **/
 STATIC
 EFI_STATUS
-GpioConfigurePch (
-  IN UINT32                    NumberOfItems,
-  IN GPIO_INIT_CONFIG          *GpioInitTableAddress
+GpioConfigurePadsForAGroup (
+  IN     UINT32                NumberOfItems,
+  IN     GPIO_INIT_CONFIG      *GpioInitTableAddress,
+  IN OUT UINT32                *Index,
+  IN     BOOLEAN               WholeTable
   )
 {
-  UINT32                 Index;
   UINT32                 PadCfgDwReg[GPIO_PADCFG_DW_REG_NUMBER];
   UINT32                 PadCfgDwRegMask[GPIO_PADCFG_DW_REG_NUMBER];
   UINT32                 PadCfgReg;
@@ -227,209 +280,276 @@ GpioConfigurePch (
   UINT32                 GroupIndex;
   UINT32                 PadNumber;
   PCH_SBI_PID            GpioCom;
+  EFI_STATUS             Status;
 
   PadOwnVal = GpioPadOwnHost;
 
   GpioGroupInfo = GpioGetGroupInfoTable (&GpioGroupInfoLength);
 
-  Index = 0;
-  while (Index < NumberOfItems) {
+  GpioData   = &GpioInitTableAddress[*Index];
+  GroupIndex = GpioGetGroupIndexFromGpioPad (GpioData->GpioPad);
+  GpioCom    = GpioGroupInfo[GroupIndex].Community;
 
-    GpioData   = &GpioInitTableAddress[Index];
-    GroupIndex = GpioGetGroupIndexFromGpioPad (GpioData->GpioPad);
-    GpioCom    = GpioGroupInfo[GroupIndex].Community;
+  //
+  // Unlock pads for a given group which are going to be reconfigured
+  //
+  //
+  // Because PADCFGLOCK/LOCKTX register reset domain is Powergood, lock settings
+  // will get back to default only after G3 or DeepSx transition. On the other hand GpioPads
+  // configuration is controlled by a configurable type of reset - PadRstCfg. This means that if
+  // PadRstCfg != Powergood GpioPad will have its configuration locked despite it being not the
+  // one desired by BIOS. Before reconfiguring all pads they will get unlocked.
+  //
+  Status = GpioUnlockPadsForAGroup (NumberOfItems, GpioInitTableAddress, *Index, WholeTable);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
-    DEBUG_CODE_BEGIN();
-    if (!GpioIsCorrectPadForThisChipset (GpioData->GpioPad)) {
-      DEBUG ((DEBUG_ERROR, "GPIO ERROR: Incorrect GpioPad (0x%08x) used on this chipset!\n", GpioData->GpioPad));
-      ASSERT (FALSE);
-      return EFI_UNSUPPORTED;
+  ZeroMem (GroupDwData, sizeof (GroupDwData));
+  //
+  // Loop through pads for one group. If pad belongs to a different group then
+  // break and move to register programming.
+  //
+  for (; *Index < NumberOfItems; (*Index)++) {
+
+    GpioData   = &GpioInitTableAddress[*Index];
+    if (GroupIndex != GpioGetGroupIndexFromGpioPad (GpioData->GpioPad)) {
+      if (WholeTable) {
+        continue;
+      }
+      //if next pad is from different group then break loop
+      break;
     }
-    DEBUG_CODE_END ();
 
+    PadNumber  = GpioGetPadNumberFromGpioPad (GpioData->GpioPad);
+
+    DEBUG_CODE_BEGIN ();
     //
-    // Unlock pads for a given group which are going to be reconfigured
+    // Check if legal pin number
     //
+    if (PadNumber >= GpioGroupInfo[GroupIndex].PadPerGroup) {
+      DEBUG ((DEBUG_ERROR, "GPIO ERROR: Pin number (%d) exceeds possible range for group %d\n", PadNumber, GroupIndex));
+      return EFI_INVALID_PARAMETER;
+    }
+
     //
-    // Because PADCFGLOCK/LOCKTX register reset domain is Powergood, lock settings
-    // will get back to default only after G3 or DeepSx transition. On the other hand GpioPads
-    // configuration is controlled by a configurable type of reset - PadRstCfg. This means that if
-    // PadRstCfg != Powergood GpioPad will have its configuration locked despite it being not the
-    // one desired by BIOS. Before reconfiguring all pads they will get unlocked.
+    // Check if selected GPIO Pad is not owned by CSME/ISH
     //
-    GpioUnlockPadsForAGroup (NumberOfItems, GpioInitTableAddress, Index);
+    GpioGetPadOwnership (GpioData->GpioPad, &PadOwnVal);
+
+    if (PadOwnVal != GpioPadOwnHost) {
+      DEBUG ((DEBUG_ERROR, "GPIO ERROR: Accessing pad not owned by host (Group=%d, Pad=%d)!\n", GroupIndex, PadNumber));
+      DEBUG ((DEBUG_ERROR, "** Please make sure the GPIO usage in sync between CSME and BIOS configuration. \n"));
+      DEBUG ((DEBUG_ERROR, "** All the GPIO occupied by CSME should not do any configuration by BIOS.\n"));
+      //Move to next item
+      continue;
+    }
 
-    ZeroMem (GroupDwData, sizeof (GroupDwData));
     //
-    // Loop through pads for one group. If pad belongs to a different group then
-    // break and move to register programming.
+    // Check if Pad enabled for SCI is to be in unlocked state
     //
-    while (Index < NumberOfItems) {
-
-      GpioData   = &GpioInitTableAddress[Index];
-      if (GroupIndex != GpioGetGroupIndexFromGpioPad (GpioData->GpioPad)) {
-        //if next pad is from different group then break loop
-        break;
-      }
+    if (((GpioData->GpioConfig.InterruptConfig & GpioIntSci) == GpioIntSci) &&
+        ((GpioData->GpioConfig.LockConfig & B_GPIO_LOCK_CONFIG_PAD_CONF_LOCK_MASK) != GpioPadConfigUnlock)){
+      DEBUG ((DEBUG_ERROR, "GPIO ERROR: %a used for SCI is not unlocked!\n", GpioName (GpioData->GpioPad)));
+      ASSERT (FALSE);
+      return EFI_INVALID_PARAMETER;
+    }
+    DEBUG_CODE_END ();
 
-      PadNumber  = GpioGetPadNumberFromGpioPad (GpioData->GpioPad);
+    ZeroMem (PadCfgDwReg, sizeof (PadCfgDwReg));
+    ZeroMem (PadCfgDwRegMask, sizeof (PadCfgDwRegMask));
+    //
+    // Get GPIO PADCFG register value from GPIO config data
+    //
+    GpioPadCfgRegValueFromGpioConfig (
+      GpioData->GpioPad,
+      &GpioData->GpioConfig,
+      PadCfgDwReg,
+      PadCfgDwRegMask
+      );
 
-      DEBUG_CODE_BEGIN ();
-      //
-      // Check if legal pin number
-      //
-      if (PadNumber >= GpioGroupInfo[GroupIndex].PadPerGroup) {
-        DEBUG ((DEBUG_ERROR, "GPIO ERROR: Pin number (%d) exceeds possible range for group %d\n", PadNumber, GroupIndex));
-        return EFI_INVALID_PARAMETER;
-      }
+    //
+    // Create PADCFG register offset using group and pad number
+    //
+    PadCfgReg = S_GPIO_PCR_PADCFG * PadNumber + GpioGroupInfo[GroupIndex].PadCfgOffset;
 
-      //
-      // Check if selected GPIO Pad is not owned by CSME/ISH
-      //
-      GpioGetPadOwnership (GpioData->GpioPad, &PadOwnVal);
-
-      if (PadOwnVal != GpioPadOwnHost) {
-        DEBUG ((DEBUG_ERROR, "GPIO ERROR: Accessing pad not owned by host (Group=%d, Pad=%d)!\n", GroupIndex, PadNumber));
-        DEBUG ((DEBUG_ERROR, "** Please make sure the GPIO usage in sync between CSME and BIOS configuration. \n"));
-        DEBUG ((DEBUG_ERROR, "** All the GPIO occupied by CSME should not do any configuration by BIOS.\n"));
-        //Move to next item
-        Index++;
-        continue;
-      }
+    //
+    // Write PADCFG DW0 register
+    //
+    GpioMmioUpdate32 (
+      PCH_PCR_ADDRESS (GpioCom, PadCfgReg),
+      ~PadCfgDwRegMask[0],
+      PadCfgDwReg[0]
+      );
 
-      //
-      // Check if Pad enabled for SCI is to be in unlocked state
-      //
-      if (((GpioData->GpioConfig.InterruptConfig & GpioIntSci) == GpioIntSci) &&
-          ((GpioData->GpioConfig.LockConfig & B_GPIO_LOCK_CONFIG_PAD_CONF_LOCK_MASK) != GpioPadConfigUnlock)){
-        DEBUG ((DEBUG_ERROR, "GPIO ERROR: %a used for SCI is not unlocked!\n", GpioName (GpioData->GpioPad)));
-        ASSERT (FALSE);
-        return EFI_INVALID_PARAMETER;
-      }
-      DEBUG_CODE_END ();
+    //
+    // Write PADCFG DW1 register
+    //
+    GpioMmioUpdate32 (
+      PCH_PCR_ADDRESS (GpioCom, PadCfgReg + 0x4),
+      ~PadCfgDwRegMask[1],
+      PadCfgDwReg[1]
+      );
 
-      ZeroMem (PadCfgDwReg, sizeof (PadCfgDwReg));
-      ZeroMem (PadCfgDwRegMask, sizeof (PadCfgDwRegMask));
-      //
-      // Get GPIO PADCFG register value from GPIO config data
-      //
-      GpioPadCfgRegValueFromGpioConfig (
-        GpioData->GpioPad,
-        &GpioData->GpioConfig,
-        PadCfgDwReg,
-        PadCfgDwRegMask
-        );
+    //
+    // Write PADCFG DW2 register
+    //
+    GpioMmioUpdate32 (
+      PCH_PCR_ADDRESS (GpioCom, PadCfgReg + 0x8),
+      ~PadCfgDwRegMask[2],
+      PadCfgDwReg[2]
+      );
 
-      //
-      // Create PADCFG register offset using group and pad number
-      //
-      PadCfgReg = S_GPIO_PCR_PADCFG * PadNumber + GpioGroupInfo[GroupIndex].PadCfgOffset;
+    //
+    // Get GPIO DW register values from GPIO config data
+    //
+    GpioDwRegValueFromGpioConfig (
+      PadNumber,
+      &GpioData->GpioConfig,
+      GroupDwData
+      );
+  }
 
-      //
-      // Write PADCFG DW0 register
-      //
-      MmioAndThenOr32 (
-        PCH_PCR_ADDRESS (GpioCom, PadCfgReg),
-        ~PadCfgDwRegMask[0],
-        PadCfgDwReg[0]
+  for (DwNum = 0; DwNum <= GPIO_GET_DW_NUM (GpioGroupInfo[GroupIndex].PadPerGroup); DwNum++) {
+    //
+    // Write HOSTSW_OWN registers
+    //
+    if (GpioGroupInfo[GroupIndex].HostOwnOffset != NO_REGISTER_FOR_PROPERTY) {
+      GpioMmioUpdate32 (
+        PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].HostOwnOffset + DwNum * 0x4),
+        ~GroupDwData[DwNum].HostSoftOwnRegMask,
+        GroupDwData[DwNum].HostSoftOwnReg
         );
+    }
 
-      //
-      // Write PADCFG DW1 register
-      //
-      MmioAndThenOr32 (
-        PCH_PCR_ADDRESS (GpioCom, PadCfgReg + 0x4),
-        ~PadCfgDwRegMask[1],
-        PadCfgDwReg[1]
+    //
+    // Write GPI_GPE_EN registers
+    //
+    if (GpioGroupInfo[GroupIndex].GpiGpeEnOffset != NO_REGISTER_FOR_PROPERTY) {
+      GpioMmioUpdate32 (
+        PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].GpiGpeEnOffset + DwNum * 0x4),
+        ~GroupDwData[DwNum].GpiGpeEnRegMask,
+        GroupDwData[DwNum].GpiGpeEnReg
         );
+    }
 
-      //
-      // Write PADCFG DW2 register
-      //
-      MmioAndThenOr32 (
-        PCH_PCR_ADDRESS (GpioCom, PadCfgReg + 0x8),
-        ~PadCfgDwRegMask[2],
-        PadCfgDwReg[2]
+    //
+    // Write GPI_NMI_EN registers
+    //
+    if (GpioGroupInfo[GroupIndex].NmiEnOffset != NO_REGISTER_FOR_PROPERTY) {
+      GpioMmioUpdate32 (
+        PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].NmiEnOffset + DwNum * 0x4),
+        ~GroupDwData[DwNum].GpiNmiEnRegMask,
+        GroupDwData[DwNum].GpiNmiEnReg
         );
+    } else if (GroupDwData[DwNum].GpiNmiEnReg != 0x0) {
+      DEBUG ((DEBUG_ERROR, "GPIO ERROR: Group %d has no pads supporting NMI\n", GroupIndex));
+      ASSERT_EFI_ERROR (EFI_UNSUPPORTED);
+    }
 
-      //
-      // Get GPIO DW register values from GPIO config data
-      //
-      GpioDwRegValueFromGpioConfig (
-        PadNumber,
-        &GpioData->GpioConfig,
-        GroupDwData
+    //
+    // Write GPI_SMI_EN registers
+    //
+    if (GpioGroupInfo[GroupIndex].SmiEnOffset != NO_REGISTER_FOR_PROPERTY) {
+      GpioMmioUpdate32 (
+        PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].SmiEnOffset + DwNum * 0x4),
+        ~GroupDwData[DwNum].GpiSmiEnRegMask,
+        GroupDwData[DwNum].GpiSmiEnReg
         );
+    } else if (GroupDwData[DwNum].GpiSmiEnReg != 0x0) {
+      DEBUG ((DEBUG_ERROR, "GPIO ERROR: Group %d has no pads supporting SMI\n", GroupIndex));
+      ASSERT_EFI_ERROR (EFI_UNSUPPORTED);
+    }
 
-      //Move to next item
-      Index++;
+    //
+    // Update Pad Configuration unlock data
+    //
+    if (GroupDwData[DwNum].ConfigUnlockMask) {
+      GpioStoreGroupDwUnlockPadConfigData (GroupIndex, DwNum, GroupDwData[DwNum].ConfigUnlockMask);
     }
 
-    for (DwNum = 0; DwNum <= GPIO_GET_DW_NUM (GpioGroupInfo[GroupIndex].PadPerGroup); DwNum++) {
-      //
-      // Write HOSTSW_OWN registers
-      //
-      if (GpioGroupInfo[GroupIndex].HostOwnOffset != NO_REGISTER_FOR_PROPERTY) {
-        MmioAndThenOr32 (
-          PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].HostOwnOffset + DwNum * 0x4),
-          ~GroupDwData[DwNum].HostSoftOwnRegMask,
-          GroupDwData[DwNum].HostSoftOwnReg
-          );
-      }
+    //
+    // Update Pad Output unlock data
+    //
+    if (GroupDwData[DwNum].OutputUnlockMask) {
+      GpioStoreGroupDwUnlockOutputData (GroupIndex, DwNum, GroupDwData[DwNum].OutputUnlockMask);
+    }
+  }
 
-      //
-      // Write GPI_GPE_EN registers
-      //
-      if (GpioGroupInfo[GroupIndex].GpiGpeEnOffset != NO_REGISTER_FOR_PROPERTY) {
-        MmioAndThenOr32 (
-          PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].GpiGpeEnOffset + DwNum * 0x4),
-          ~GroupDwData[DwNum].GpiGpeEnRegMask,
-          GroupDwData[DwNum].GpiGpeEnReg
-          );
-      }
+  return EFI_SUCCESS;
+}
 
-      //
-      // Write GPI_NMI_EN registers
-      //
-      if (GpioGroupInfo[GroupIndex].NmiEnOffset != NO_REGISTER_FOR_PROPERTY) {
-        MmioAndThenOr32 (
-          PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].NmiEnOffset + DwNum * 0x4),
-          ~GroupDwData[DwNum].GpiNmiEnRegMask,
-          GroupDwData[DwNum].GpiNmiEnReg
-          );
-      } else if (GroupDwData[DwNum].GpiNmiEnReg != 0x0) {
-        DEBUG ((DEBUG_ERROR, "GPIO ERROR: Group %d has no pads supporting NMI\n", GroupIndex));
-        ASSERT_EFI_ERROR (EFI_UNSUPPORTED);
-      }
+/**
+  This procedure will initialize multiple PCH GPIO pins
 
-      //
-      // Write GPI_SMI_EN registers
-      //
-      if (GpioGroupInfo[GroupIndex].SmiEnOffset != NO_REGISTER_FOR_PROPERTY) {
-        MmioAndThenOr32 (
-          PCH_PCR_ADDRESS (GpioCom, GpioGroupInfo[GroupIndex].SmiEnOffset + DwNum * 0x4),
-          ~GroupDwData[DwNum].GpiSmiEnRegMask,
-          GroupDwData[DwNum].GpiSmiEnReg
-          );
-      } else if (GroupDwData[DwNum].GpiSmiEnReg != 0x0) {
-        DEBUG ((DEBUG_ERROR, "GPIO ERROR: Group %d has no pads supporting SMI\n", GroupIndex));
-        ASSERT_EFI_ERROR (EFI_UNSUPPORTED);
-      }
+  When PcdGpioGroupedPadConfigure is TRUE the pads are programmed group by group
+  in the order of the GPIO group table, regardless of the order of the records,
+  so that the group registers are written once for each group. Otherwise the
+  records are programmed in table order.
+
+  @param[in] NumberofItem               Number of GPIO pads to be updated
+  @param[in] GpioInitTableAddress       GPIO initialization table
 
+  @retval EFI_SUCCESS                   The function completed successfully
+  @retval EFI_INVALID_PARAMETER         Invalid group or pad number
+**/
+STATIC
+EFI_STATUS
+GpioConfigurePch (
+  IN UINT32                    NumberOfItems,
+  IN GPIO_INIT_CONFIG          *GpioInitTableAddress
+  )
+{
+  UINT32                 Index;
+  UINT32                 FirstIndex;
+  CONST GPIO_GROUP_INFO  *GpioGroupInfo;
+  UINT32                 GpioGroupInfoLength;
+  CONST GPIO_INIT_CONFIG *GpioData;
+  UINT32                 GroupIndex;
+  EFI_STATUS             Status;
+
+  GpioGroupInfo = GpioGetGroupInfoTable (&GpioGroupInfoLength);
+
+  DEBUG_CODE_BEGIN();
+  for (Index = 0; Index < NumberOfItems; Index++) {
+    GpioData = &GpioInitTableAddress[Index];
+    if (!GpioIsCorrectPadForThisChipset (GpioData->GpioPad)) {
+      DEBUG ((DEBUG_ERROR, "GPIO ERROR: Incorrect GpioPad (0x%08x) used on this chipset!\n", GpioData->GpioPad));
+      ASSERT (FALSE);
+      return EFI_UNSUPPORTED;
+    }
+  }
+  DEBUG_CODE_END ();
+
+  if (PcdGetBool (PcdGpioGroupedPadConfigure)) {
+    for (GroupIndex = 0; GroupIndex < GpioGroupInfoLength; GroupIndex++) {
       //
-      // Update Pad Configuration unlock data
+      // Find the first record of the group, groups without records are skipped
       //
-      if (GroupDwData[DwNum].ConfigUnlockMask) {
-        GpioStoreGroupDwUnlockPadConfigData (GroupIndex, DwNum, GroupDwData[DwNum].ConfigUnlockMask);
+      for (FirstIndex = 0; FirstIndex < NumberOfItems; FirstIndex++) {
+        if (GpioGetGroupIndexFromGpioPad (GpioInitTableAddress[FirstIndex].GpioPad) == GroupIndex) {
+          break;
+        }
+      }
+      if (FirstIndex == NumberOfItems) {
+        continue;
       }
 
-      //
-      // Update Pad Output unlock data
-      //
-      if (GroupDwData[DwNum].OutputUnlockMask) {
-        GpioStoreGroupDwUnlockOutputData (GroupIndex, DwNum, GroupDwData[DwNum].OutputUnlockMask);
+      Index = FirstIndex;
+      Status = GpioConfigurePadsForAGroup (NumberOfItems, GpioInitTableAddress, &Index, TRUE);
+      if (EFI_ERROR (Status)) {
+        return Status;
       }
     }
+    return EFI_SUCCESS;
+  }
+
+  Index = 0;
+  while (Index < NumberOfItems) {
+    Status = GpioConfigurePadsForAGroup (NumberOfItems, GpioInitTableAddress, &Index, FALSE);
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
   }
 
   return EFI_SUCCESS;
@@ -529,7 +649,8 @@ GpioClearAllGpioInterrupts (
   Separate fields could be set to hardware default if it does not matter, except
   GpioPad and PadMode.
   Function will work in most efficient way if pads which belong to the same group are
-  placed in adjacent records of the table.
+  placed in adjacent records of the table, or regardless of the order of the records
+  if PcdGpioGroupedPadConfigure is TRUE.
   Although function can enable pads for Native mode, such programming is done
   by reference code when enabling related silicon feature.
 
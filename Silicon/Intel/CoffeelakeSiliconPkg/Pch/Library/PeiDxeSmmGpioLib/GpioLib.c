@@ -1643,7 +1643,10 @@ GpioGetPadOwnership (
   PadNumber %= 8;
   Mask = (BIT1 | BIT0) << (PadNumber * 4);
 
-  PadOwnRegValue = MmioRead32 (PCH_PCR_ADDRESS (GpioGroupInfo[GroupIndex].Community, RegOffset));
+  //
+  // Pad ownership is read only for BIOS and does not change until next reset
+  //
+  PadOwnRegValue = PchPcrCacheRead32 (GpioGroupInfo[GroupIndex].Community, RegOffset);
 
   *PadOwnVal = (GPIO_PAD_OWN) ((PadOwnRegValue & Mask) >> (PadNumber * 4));
 
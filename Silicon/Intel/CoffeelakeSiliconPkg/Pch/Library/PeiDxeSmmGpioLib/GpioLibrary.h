@@ -23,6 +23,7 @@
 #include <Library/PchSbiAccessLib.h>
 #include <Private/Library/PmcPrivateLib.h>
 #include <Private/Library/GpioHelpersLib.h>
+#include <Private/Library/PchPcrCacheLib.h>
 #include <Register/PchRegsGpio.h>
 
 // BIT15-0  - pad number
@@ -16,6 +16,7 @@
 #include <Library/PciSegmentLib.h>
 #include <Library/PchInfoLib.h>
 #include <Library/PchPcrLib.h>
+#include <Private/Library/PchPcrCacheLib.h>
 #include <Library/PchPcieRpLib.h>
 #include <PcieRegs.h>
 #include <Register/PchRegs.h>
@@ -79,7 +80,16 @@ GetPchPcieRpDevFun (
   Index = RpNumber / PCH_PCIE_CONTROLLER_PORTS;
   FuncIndex = RpNumber - mPchPcieControllerInfo[Index].RpNumBase;
   *RpDev = mPchPcieControllerInfo[Index].DevNum;
-  PciePcd = PchPcrRead32 (mPchPcieControllerInfo[Index].Pid, R_SPX_PCR_PCD);
+  //
+  // The port configuration only gets cached once it is locked, before that the
+  // root port functions may still be swapped.
+  //
+  if (!PchPcrCacheGet32 (mPchPcieControllerInfo[Index].Pid, R_SPX_PCR_PCD, &PciePcd)) {
+    PciePcd = PchPcrRead32 (mPchPcieControllerInfo[Index].Pid, R_SPX_PCR_PCD);
+    if ((PciePcd & B_SPX_PCR_PCD_SRL) != 0) {
+      PchPcrCacheSet32 (mPchPcieControllerInfo[Index].Pid, R_SPX_PCR_PCD, PciePcd);
+    }
+  }
   *RpFun = (PciePcd >> (FuncIndex * S_SPX_PCR_PCD_RP_FIELD)) & B_SPX_PCR_PCD_RP1FN;
 
   return EFI_SUCCESS;
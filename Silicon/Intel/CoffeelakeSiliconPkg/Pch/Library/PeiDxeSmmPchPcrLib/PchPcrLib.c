@@ -277,3 +277,39 @@ PchPcrAndThenOr8 (
   return PchPcrWrite8 (Pid, Offset, (PchPcrRead8 (Pid, Offset) & AndData) | OrData);
 }
 
+
+/**
+  Write a list of PCR registers of one Port ID and read back the last one.
+  The registers are written in list order. A single read back at the end
+  ensures all the PCR cycles are completed before next operation.
+  The Offsets should not exceed 0xFFFF and must be aligned with 4 bytes.
+
+  @param[in]  Pid      Port ID
+  @param[in]  List     Register updates
+  @param[in]  Count    Number of entries in List
+
+  @retval  UINT32      Value read back from the last register, 0 if Count is 0
+**/
+UINT32
+PchPcrAndThenOr32List (
+  IN  PCH_SBI_PID                       Pid,
+  IN  CONST PCH_PCR_AND_THEN_OR32_ENTRY *List,
+  IN  UINTN                             Count
+  )
+{
+  UINTN       Index;
+
+  if (Count == 0) {
+    return 0;
+  }
+
+  for (Index = 0; Index < Count; Index++) {
+    if (List[Index].AndData == 0) {
+      PchPcrWrite32 (Pid, List[Index].Offset, List[Index].OrData);
+    } else {
+      PchPcrAndThenOr32 (Pid, List[Index].Offset, List[Index].AndData, List[Index].OrData);
+    }
+  }
+
+  return PchPcrRead32 (Pid, List[Count - 1].Offset);
+}
@@ -0,0 +1,131 @@
+/** @file
+  This file contains PchPcrCacheLib implementation for DXE and SMM phase.
+  Every module takes a copy of the values cached in PEI at entry, SMM modules
+  keep it in SMRAM.
+
+  Copyright (c) 2020 Intel Corporation. All rights reserved. <BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi.h>
+#include <Library/HobLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/PchPcrLib.h>
+#include <Private/Library/PchPcrCacheLib.h>
+
+STATIC PCH_PCR_CACHE mPchPcrCache;
+
+/**
+  Get the cached value of a PCR register.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+  @param[out] Data     Cached value of the register
+
+  @retval TRUE         The register is cached, Data is valid
+  @retval FALSE        The register is not cached
+**/
+BOOLEAN
+PchPcrCacheGet32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset,
+  OUT UINT32                            *Data
+  )
+{
+  UINT32         Key;
+  UINT32         Index;
+
+  Key = PCH_PCR_CACHE_KEY (Pid, Offset);
+  for (Index = 0; Index < mPchPcrCache.Count; Index++) {
+    if (mPchPcrCache.Entry[Index].Key == Key) {
+      *Data = mPchPcrCache.Entry[Index].Data;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Cache the value of a PCR register.
+  Nothing is done if the cache is full.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+  @param[in]  Data     Value of the register
+**/
+VOID
+PchPcrCacheSet32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset,
+  IN  UINT32                            Data
+  )
+{
+  UINT32         Key;
+  UINT32         Index;
+
+  Key = PCH_PCR_CACHE_KEY (Pid, Offset);
+  for (Index = 0; Index < mPchPcrCache.Count; Index++) {
+    if (mPchPcrCache.Entry[Index].Key == Key) {
+      mPchPcrCache.Entry[Index].Data = Data;
+      return;
+    }
+  }
+  if (mPchPcrCache.Count < PCH_PCR_CACHE_ENTRY_MAX) {
+    mPchPcrCache.Entry[mPchPcrCache.Count].Key  = Key;
+    mPchPcrCache.Entry[mPchPcrCache.Count].Data = Data;
+    mPchPcrCache.Count++;
+  }
+}
+
+/**
+  Read PCR register through the cache.
+  The register is read and cached if it is not cached yet.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+
+  @retval UINT32       PCR register value.
+**/
+UINT32
+PchPcrCacheRead32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset
+  )
+{
+  UINT32  Data;
+
+  if (!PchPcrCacheGet32 (Pid, Offset, &Data)) {
+    Data = PchPcrRead32 (Pid, Offset);
+    PchPcrCacheSet32 (Pid, Offset, Data);
+  }
+  return Data;
+}
+
+/**
+  Take a copy of the values cached in PEI.
+
+  @param[in] ImageHandle  The firmware allocated handle for the EFI image.
+  @param[in] SystemTable  A pointer to the EFI System Table.
+
+  @retval EFI_SUCCESS     The constructor always returns EFI_SUCCESS.
+**/
+EFI_STATUS
+EFIAPI
+DxePchPcrCacheLibConstructor (
+  IN EFI_HANDLE          ImageHandle,
+  IN EFI_SYSTEM_TABLE    *SystemTable
+  )
+{
+  VOID           *Hob;
+  PCH_PCR_CACHE  *Cache;
+
+  Hob = GetFirstGuidHob (&gPchPcrCacheHobGuid);
+  if (Hob != NULL) {
+    Cache = (PCH_PCR_CACHE *) GET_GUID_HOB_DATA (Hob);
+    if (Cache->Count <= PCH_PCR_CACHE_ENTRY_MAX) {
+      CopyMem (&mPchPcrCache, Cache, sizeof (PCH_PCR_CACHE));
+    }
+  }
+  return EFI_SUCCESS;
+}
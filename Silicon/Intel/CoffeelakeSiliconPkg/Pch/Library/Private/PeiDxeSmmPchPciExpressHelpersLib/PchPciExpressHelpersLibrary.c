@@ -567,6 +567,74 @@ IsDevicePresent (
   return TRUE;
 }
 
+/**
+  Checks if the slot of a PCH rootport is empty.
+  Presence detect state is used rather than link active, because PDS changes immediately
+  and LA takes a few milliseconds to stabilize. Rootports without a slot are never empty.
+
+  @param[in] RpBase          rootport's base address
+
+  @retval TRUE when the rootport has a slot and no device is present in it; FALSE otherwise
+**/
+BOOLEAN
+IsRootportSlotEmpty (
+  UINT64 RpBase
+  )
+{
+  if ((PciSegmentRead16 (RpBase + R_PCH_PCIE_CFG_XCAP) & B_PCIE_XCAP_SI) == 0) {
+    return FALSE;
+  }
+  return ((PciSegmentRead16 (RpBase + R_PCH_PCIE_CFG_SLSTS) & B_PCIE_SLSTS_PDS) == 0);
+}
+
+/**
+  Waits until the links of the given PCH rootports are active.
+  All the rootports are polled together against a single deadline, so the total wait
+  does not depend on the number of rootports.
+
+  @param[in] RpBase          array of rootport base addresses
+  @param[in] RpCount         number of rootports in RpBase, 32 at most
+  @param[in] TimeoutUs       maximum time to wait, in microseconds
+
+  @retval bitmap of the rootports whose link is active, bit N for RpBase[N]
+**/
+UINT32
+WaitForRootportsLinkActive (
+  CONST UINT64  *RpBase,
+  UINT32        RpCount,
+  UINT32        TimeoutUs
+  )
+{
+  UINT32  Pending;
+  UINT32  Active;
+  UINT32  Index;
+  UINT32  ElapsedUs;
+
+  ASSERT (RpCount <= 32);
+  if (RpCount > 32) {
+    RpCount = 32;
+  }
+
+  Pending   = (RpCount == 32) ? MAX_UINT32 : ((BIT0 << RpCount) - 1);
+  Active    = 0;
+  ElapsedUs = 0;
+  while (TRUE) {
+    for (Index = 0; Index < RpCount; Index++) {
+      if (((Pending & (BIT0 << Index)) != 0) &&
+          ((PciSegmentRead16 (RpBase[Index] + R_PCH_PCIE_CFG_LSTS) & B_PCIE_LSTS_LA) != 0)) {
+        Pending &= ~(BIT0 << Index);
+        Active  |= BIT0 << Index;
+      }
+    }
+    if ((Pending == 0) || (ElapsedUs >= TimeoutUs)) {
+      break;
+    }
+    MicroSecondDelay (10);
+    ElapsedUs += 10;
+  }
+  return Active;
+}
+
 /**
   Returns information about type of device.
 
@@ -0,0 +1,148 @@
+/** @file
+  This file contains PchPcrCacheLib implementation for PEI phase.
+  The values are kept in a private HOB. It is built by the first register
+  cached, early in PEI pre mem, so it is found at the beginning of the HOB list.
+
+  Copyright (c) 2020 Intel Corporation. All rights reserved. <BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi/UefiBaseType.h>
+#include <Library/HobLib.h>
+#include <Library/DebugLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/PchPcrLib.h>
+#include <Private/Library/PchPcrCacheLib.h>
+
+/**
+  Returns pointer to the cache taken from the private HOB
+
+  @param[in] Create    Build the HOB if it does not exist yet
+
+  @retval PCH_PCR_CACHE*  Pointer to the cache, NULL if there is none
+**/
+STATIC
+PCH_PCR_CACHE*
+GetCacheFromHob (
+  IN BOOLEAN  Create
+  )
+{
+  VOID           *Hob;
+  PCH_PCR_CACHE  *Cache;
+
+  Hob = GetFirstGuidHob (&gPchPcrCacheHobGuid);
+  if (Hob != NULL) {
+    return (PCH_PCR_CACHE *) GET_GUID_HOB_DATA (Hob);
+  }
+  if (!Create) {
+    return NULL;
+  }
+
+  Cache = (PCH_PCR_CACHE *) BuildGuidHob (&gPchPcrCacheHobGuid, sizeof (PCH_PCR_CACHE));
+  if (Cache == NULL) {
+    DEBUG ((DEBUG_ERROR, "Failed to setup HOB for PCR cache lib\n"));
+    ASSERT (FALSE);
+    return NULL;
+  }
+  ZeroMem (Cache, sizeof (PCH_PCR_CACHE));
+  return Cache;
+}
+
+/**
+  Get the cached value of a PCR register.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+  @param[out] Data     Cached value of the register
+
+  @retval TRUE         The register is cached, Data is valid
+  @retval FALSE        The register is not cached
+**/
+BOOLEAN
+PchPcrCacheGet32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset,
+  OUT UINT32                            *Data
+  )
+{
+  PCH_PCR_CACHE  *Cache;
+  UINT32         Key;
+  UINT32         Index;
+
+  Cache = GetCacheFromHob (FALSE);
+  if (Cache == NULL) {
+    return FALSE;
+  }
+
+  Key = PCH_PCR_CACHE_KEY (Pid, Offset);
+  for (Index = 0; Index < Cache->Count; Index++) {
+    if (Cache->Entry[Index].Key == Key) {
+      *Data = Cache->Entry[Index].Data;
+      return TRUE;
+    }
+  }
+  return FALSE;
+}
+
+/**
+  Cache the value of a PCR register.
+  Nothing is done if the cache is full.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+  @param[in]  Data     Value of the register
+**/
+VOID
+PchPcrCacheSet32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset,
+  IN  UINT32                            Data
+  )
+{
+  PCH_PCR_CACHE  *Cache;
+  UINT32         Key;
+  UINT32         Index;
+
+  Cache = GetCacheFromHob (TRUE);
+  if (Cache == NULL) {
+    return;
+  }
+
+  Key = PCH_PCR_CACHE_KEY (Pid, Offset);
+  for (Index = 0; Index < Cache->Count; Index++) {
+    if (Cache->Entry[Index].Key == Key) {
+      Cache->Entry[Index].Data = Data;
+      return;
+    }
+  }
+  if (Cache->Count < PCH_PCR_CACHE_ENTRY_MAX) {
+    Cache->Entry[Cache->Count].Key  = Key;
+    Cache->Entry[Cache->Count].Data = Data;
+    Cache->Count++;
+  }
+}
+
+/**
+  Read PCR register through the cache.
+  The register is read and cached if it is not cached yet.
+
+  @param[in]  Pid      Port ID
+  @param[in]  Offset   Register offset of this Port ID
+
+  @retval UINT32       PCR register value.
+**/
+UINT32
+PchPcrCacheRead32 (
+  IN  PCH_SBI_PID                       Pid,
+  IN  UINT32                            Offset
+  )
+{
+  UINT32  Data;
+
+  if (!PchPcrCacheGet32 (Pid, Offset, &Data)) {
+    Data = PchPcrRead32 (Pid, Offset);
+    PchPcrCacheSet32 (Pid, Offset, Data);
+  }
+  return Data;
+}
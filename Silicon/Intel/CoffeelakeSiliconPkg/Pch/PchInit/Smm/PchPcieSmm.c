@@ -28,6 +28,11 @@ GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN                     mPciePmTrapExecuted =
 
 extern EFI_GUID gPchDeviceTableHobGuid;
 
+//
+// Time to wait for a link to become active, 100ms according to PCIE spec chapter 6.7.3.3
+//
+#define PCIE_LINK_ACTIVE_WAIT_TIME  (100 * 1000) // microseconds
+
 /**
   Program Common Clock and ASPM of Downstream Devices
 
@@ -50,7 +55,6 @@ PchPcieSmi (
   UINT8                 EpPcieCapPtr;
   UINT8                 EpMaxSpeed;
   BOOLEAN               DownstreamDevicePresent;
-  UINT32                Timeout;
 
   RpBase   = PCI_SEGMENT_LIB_ADDRESS (
                DEFAULT_PCI_SEGMENT_NUMBER_PCH,
@@ -67,20 +71,15 @@ PchPcieSmi (
   // Check presence detect state. Here the endpoint must be detected using PDS rather than
   // the usual LinkActive check, because PDS changes immediately and LA takes a few milliseconds to stabilize
   //
-  DownstreamDevicePresent = !!(PciSegmentRead16 (RpBase + R_PCH_PCIE_CFG_SLSTS) & B_PCIE_SLSTS_PDS);
+  DownstreamDevicePresent = !IsRootportSlotEmpty (RpBase);
 
   if (DownstreamDevicePresent) {
     ///
     /// Make sure the link is active before trying to talk to device behind it
     /// Wait up to 100ms, according to PCIE spec chapter 6.7.3.3
     ///
-    Timeout = 100 * 1000;
-    while ((PciSegmentRead16 (RpBase + R_PCH_PCIE_CFG_LSTS) & B_PCIE_LSTS_LA) == 0 ) {
-      MicroSecondDelay (10);
-      Timeout-=10;
-      if (Timeout == 0) {
-        return;
-      }
+    if (WaitForRootportsLinkActive (&RpBase, 1, PCIE_LINK_ACTIVE_WAIT_TIME) == 0) {
+      return;
     }
     SecBus  = PciSegmentRead8 (RpBase + PCI_BRIDGE_SECONDARY_BUS_REGISTER_OFFSET);
     SubBus  = PciSegmentRead8 (RpBase + PCI_BRIDGE_SUBORDINATE_BUS_REGISTER_OFFSET);
@@ -189,28 +188,60 @@ PchPciePmIoTrapSmiCallback (
   UINT8                                     MaxPciePortNum;
   UINTN                                     RpDevice;
   UINTN                                     RpFunction;
+  UINT8                                     PortList[PCH_MAX_PCIE_ROOT_PORTS];
+  UINT32                                    PortCount;
+  UINT64                                    WaitList[PCH_MAX_PCIE_ROOT_PORTS];
+  UINT32                                    WaitCount;
+  UINT32                                    Index;
 
   MaxPciePortNum                   = GetPchMaxPciePortNum ();
 
+  //
+  // Find the rootports to be configured first. Disabled rootports and empty slots are skipped,
+  // the hot plug SMI configures a slot when a device shows up in it.
+  //
+  PortCount = 0;
+  WaitCount = 0;
   for (PortIndex = 0; PortIndex < MaxPciePortNum; PortIndex++) {
     GetPchPcieRpDevFun (PortIndex, &RpDevice, &RpFunction);
     RpBase = PCI_SEGMENT_LIB_ADDRESS (DEFAULT_PCI_SEGMENT_NUMBER_PCH, DEFAULT_PCI_BUS_NUMBER_PCH, (UINT32) RpDevice, (UINT32) RpFunction, 0);
 
-    if (PciSegmentRead16 (RpBase) != 0xFFFF) {
-      RootportDownstreamPmConfiguration (
-        DEFAULT_PCI_SEGMENT_NUMBER_PCH,
-        DEFAULT_PCI_BUS_NUMBER_PCH,
-        (UINT8)RpDevice,
-        (UINT8)RpFunction,
-        mTempRootPortBusNumMin,
-        mTempRootPortBusNumMax,
-        &mPcieRootPortConfig[PortIndex],
-        mNumOfDevAspmOverride,
-        mDevAspmOverride
-      );
+    if ((PciSegmentRead16 (RpBase) == 0xFFFF) || IsRootportSlotEmpty (RpBase)) {
+      continue;
+    }
+    PortList[PortCount++] = (UINT8) PortIndex;
 
+    //
+    // The link of a device which was just inserted in a slot may not be active yet
+    //
+    if (((PciSegmentRead16 (RpBase + R_PCH_PCIE_CFG_XCAP) & B_PCIE_XCAP_SI) != 0) &&
+        ((PciSegmentRead16 (RpBase + R_PCH_PCIE_CFG_LSTS) & B_PCIE_LSTS_LA) == 0)) {
+      WaitList[WaitCount++] = RpBase;
     }
   }
+
+  //
+  // Wait for all those links at once rather than one rootport after the other
+  //
+  if (WaitCount != 0) {
+    WaitForRootportsLinkActive (WaitList, WaitCount, PCIE_LINK_ACTIVE_WAIT_TIME);
+  }
+
+  for (Index = 0; Index < PortCount; Index++) {
+    PortIndex = PortList[Index];
+    GetPchPcieRpDevFun (PortIndex, &RpDevice, &RpFunction);
+    RootportDownstreamPmConfiguration (
+      DEFAULT_PCI_SEGMENT_NUMBER_PCH,
+      DEFAULT_PCI_BUS_NUMBER_PCH,
+      (UINT8)RpDevice,
+      (UINT8)RpFunction,
+      mTempRootPortBusNumMin,
+      mTempRootPortBusNumMax,
+      &mPcieRootPortConfig[PortIndex],
+      mNumOfDevAspmOverride,
+      mDevAspmOverride
+    );
+  }
 }
 
 /**
@@ -0,0 +1,369 @@
+/** @file
+  Shell application dumping the statistics of the PCH SMI handlers.
+
+  The handlers are listed by decreasing maximum time spent in SMM so that the
+  ones behind SMI latency spikes come first.
+
+  Usage: PchSmiStats [-r]
+    -r    Clear the statistics after they were dumped.
+
+  Copyright (c) 2020 Intel Corporation. All rights reserved. <BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include <Uefi.h>
+#include <PiDxe.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiLib.h>
+#include <Protocol/ShellParameters.h>
+#include <Protocol/SmmCommunication.h>
+#include <Protocol/SmmUsbDispatch2.h>
+#include <Protocol/SmmSxDispatch2.h>
+#include <Protocol/SmmSwDispatch2.h>
+#include <Protocol/SmmGpiDispatch2.h>
+#include <Protocol/SmmPowerButtonDispatch2.h>
+#include <Protocol/SmmPeriodicTimerDispatch2.h>
+#include <Protocol/PchSmiDispatch.h>
+#include <Protocol/PchEspiSmiDispatch.h>
+#include <Guid/PiSmmCommunicationRegionTable.h>
+#include <PchSmiHandlerStats.h>
+
+//
+// Time used to calibrate the TSC frequency, in microseconds.
+//
+#define PCH_SMI_STATS_CALIBRATION_TIME  10000
+
+typedef struct {
+  EFI_GUID    *Guid;
+  CHAR16      *Name;
+} PCH_SMI_STATS_HANDLER_TYPE;
+
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMI_STATS_HANDLER_TYPE  mHandlerTypes[] = {
+  { &gEfiSmmUsbDispatch2ProtocolGuid,           L"Usb"      },
+  { &gEfiSmmSxDispatch2ProtocolGuid,            L"Sx"       },
+  { &gEfiSmmSwDispatch2ProtocolGuid,            L"Sw"       },
+  { &gEfiSmmGpiDispatch2ProtocolGuid,           L"Gpi"      },
+  { &gEfiSmmPowerButtonDispatch2ProtocolGuid,   L"PwrBtn"   },
+  { &gEfiSmmPeriodicTimerDispatch2ProtocolGuid, L"Periodic" },
+  { &gPchSmiDispatchProtocolGuid,               L"PchSmi"   },
+  { &gPchEspiSmiDispatchProtocolGuid,           L"Espi"     }
+};
+
+/**
+  Get the short name of a handler type.
+
+  @param[in] Guid     GUID of the dispatch protocol the handler was registered with
+
+  @return   The name of the handler type, NULL if it is not known
+**/
+CHAR16 *
+GetHandlerTypeName (
+  IN EFI_GUID   *Guid
+  )
+{
+  UINTN   Index;
+
+  for (Index = 0; Index < ARRAY_SIZE (mHandlerTypes); Index++) {
+    if (CompareGuid (Guid, mHandlerTypes[Index].Guid)) {
+      return mHandlerTypes[Index].Name;
+    }
+  }
+  return NULL;
+}
+
+/**
+  Get a communicate buffer from the PI SMM communication region.
+
+  @param[out] Size    The size of the buffer
+
+  @return   The buffer, NULL if no region is large enough
+**/
+UINT8 *
+GetCommBuffer (
+  OUT UINTN     *Size
+  )
+{
+  EFI_STATUS                                Status;
+  EDKII_PI_SMM_COMMUNICATION_REGION_TABLE   *PiSmmCommunicationRegionTable;
+  EFI_MEMORY_DESCRIPTOR                     *Entry;
+  UINT32                                    Index;
+
+  Status = EfiGetSystemConfigurationTable (
+             &gEdkiiPiSmmCommunicationRegionTableGuid,
+             (VOID **) &PiSmmCommunicationRegionTable
+             );
+  if (EFI_ERROR (Status)) {
+    return NULL;
+  }
+
+  Entry = (EFI_MEMORY_DESCRIPTOR *) (PiSmmCommunicationRegionTable + 1);
+  for (Index = 0; Index < PiSmmCommunicationRegionTable->NumberOfEntries; Index++) {
+    if (Entry->Type == EfiConventionalMemory) {
+      *Size = EFI_PAGES_TO_SIZE ((UINTN) Entry->NumberOfPages);
+      if (*Size >= EFI_PAGE_SIZE) {
+        return (UINT8 *) (UINTN) Entry->PhysicalStart;
+      }
+    }
+    Entry = (EFI_MEMORY_DESCRIPTOR *) ((UINT8 *) Entry + PiSmmCommunicationRegionTable->DescriptorSize);
+  }
+  return NULL;
+}
+
+/**
+  Send a command to the PCH SMI dispatcher.
+
+  @param[in] SmmCommunication   The SMM communication protocol
+  @param[in] CommBuffer         The communicate buffer, the parameter of the command is already filled
+  @param[in] ParameterSize      The size of the parameter of the command
+
+  @retval EFI_SUCCESS           The command succeeded
+  @retval Others                The command failed
+**/
+EFI_STATUS
+SendCommand (
+  IN EFI_SMM_COMMUNICATION_PROTOCOL   *SmmCommunication,
+  IN UINT8                            *CommBuffer,
+  IN UINTN                            ParameterSize
+  )
+{
+  EFI_STATUS                              Status;
+  EFI_SMM_COMMUNICATE_HEADER              *CommHeader;
+  PCH_SMI_HANDLER_STATS_PARAMETER_HEADER  *Header;
+  UINTN                                   CommSize;
+
+  CommHeader = (EFI_SMM_COMMUNICATE_HEADER *) CommBuffer;
+  CopyGuid (&CommHeader->HeaderGuid, &gPchSmiHandlerStatsGuid);
+  CommHeader->MessageLength = ParameterSize;
+
+  Header = (PCH_SMI_HANDLER_STATS_PARAMETER_HEADER *) &CommBuffer[OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data)];
+  Header->DataLength   = (UINT32) ParameterSize;
+  Header->ReturnStatus = (UINT64) -1;
+
+  CommSize = OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) + ParameterSize;
+  Status = SmmCommunication->Communicate (SmmCommunication, CommBuffer, &CommSize);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  if (Header->ReturnStatus == (UINT64) -1) {
+    //
+    // Nobody handled the command, the dispatcher does not produce the statistics.
+    //
+    return EFI_UNSUPPORTED;
+  }
+  return (EFI_STATUS) Header->ReturnStatus;
+}
+
+/**
+  Read the statistics of all the handlers.
+
+  @param[in]  SmmCommunication  The SMM communication protocol
+  @param[in]  CommBuffer        The communicate buffer
+  @param[in]  CommBufferSize    The size of CommBuffer
+  @param[out] Entries           The statistics, to be freed by the caller
+  @param[out] EntryCount        The number of entries in Entries
+
+  @retval EFI_SUCCESS           The statistics were read
+  @retval Others                The statistics could not be read
+**/
+EFI_STATUS
+GetHandlerStats (
+  IN  EFI_SMM_COMMUNICATION_PROTOCOL  *SmmCommunication,
+  IN  UINT8                           *CommBuffer,
+  IN  UINTN                           CommBufferSize,
+  OUT PCH_SMI_HANDLER_STATS_ENTRY     **Entries,
+  OUT UINTN                           *EntryCount
+  )
+{
+  EFI_STATUS                                Status;
+  PCH_SMI_HANDLER_STATS_PARAMETER_GET_INFO  *GetInfo;
+  PCH_SMI_HANDLER_STATS_PARAMETER_GET_DATA  *GetData;
+  UINTN                                     Count;
+  UINTN                                     MaxPerCall;
+  UINTN                                     Offset;
+
+  GetInfo = (PCH_SMI_HANDLER_STATS_PARAMETER_GET_INFO *) &CommBuffer[OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data)];
+  GetInfo->Header.Command = PCH_SMI_HANDLER_STATS_COMMAND_GET_INFO;
+  GetInfo->HandlerCount   = 0;
+  Status = SendCommand (SmmCommunication, CommBuffer, sizeof (*GetInfo));
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  Count = (UINTN) GetInfo->HandlerCount;
+
+  *Entries = AllocateZeroPool (MAX (Count, 1) * sizeof (PCH_SMI_HANDLER_STATS_ENTRY));
+  if (*Entries == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  MaxPerCall = (CommBufferSize - OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data) - sizeof (*GetData)) /
+               sizeof (PCH_SMI_HANDLER_STATS_ENTRY);
+  GetData = (PCH_SMI_HANDLER_STATS_PARAMETER_GET_DATA *) &CommBuffer[OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data)];
+
+  //
+  // The handler list may change between two calls, stop at whatever the
+  // dispatcher has.
+  //
+  for (Offset = 0; Offset < Count; Offset += (UINTN) GetData->Count) {
+    GetData->Header.Command = PCH_SMI_HANDLER_STATS_COMMAND_GET_DATA;
+    GetData->Offset         = Offset;
+    GetData->Count          = MIN (MaxPerCall, Count - Offset);
+    Status = SendCommand (
+               SmmCommunication,
+               CommBuffer,
+               sizeof (*GetData) + (UINTN) GetData->Count * sizeof (PCH_SMI_HANDLER_STATS_ENTRY)
+               );
+    if (EFI_ERROR (Status)) {
+      FreePool (*Entries);
+      *Entries = NULL;
+      return Status;
+    }
+    if (GetData->Count == 0) {
+      break;
+    }
+    CopyMem (&(*Entries)[Offset], GetData + 1, (UINTN) GetData->Count * sizeof (PCH_SMI_HANDLER_STATS_ENTRY));
+  }
+
+  *EntryCount = MIN (Offset, Count);
+  return EFI_SUCCESS;
+}
+
+/**
+  Convert TSC ticks to microseconds.
+
+  @param[in] Ticks          The TSC ticks
+  @param[in] TscFrequency   The TSC frequency in Hz
+
+  @return   The time in microseconds
+**/
+UINT64
+TscToMicroseconds (
+  IN UINT64   Ticks,
+  IN UINT64   TscFrequency
+  )
+{
+  return DivU64x64Remainder (MultU64x32 (Ticks, 1000000), TscFrequency, NULL);
+}
+
+/**
+  Entry point of the application.
+
+  @param[in] ImageHandle    The image handle of the application
+  @param[in] SystemTable    The system table
+
+  @retval EFI_SUCCESS       The statistics were dumped
+  @retval Others            The statistics could not be read
+**/
+EFI_STATUS
+EFIAPI
+PchSmiStatsEntryPoint (
+  IN EFI_HANDLE         ImageHandle,
+  IN EFI_SYSTEM_TABLE   *SystemTable
+  )
+{
+  EFI_STATUS                              Status;
+  EFI_SHELL_PARAMETERS_PROTOCOL           *ShellParameters;
+  EFI_SMM_COMMUNICATION_PROTOCOL          *SmmCommunication;
+  UINT8                                   *CommBuffer;
+  UINTN                                   CommBufferSize;
+  PCH_SMI_HANDLER_STATS_ENTRY             *Entries;
+  PCH_SMI_HANDLER_STATS_ENTRY             Swap;
+  PCH_SMI_HANDLER_STATS_PARAMETER_RESET   *Reset;
+  UINTN                                   EntryCount;
+  UINTN                                   Index;
+  UINTN                                   Index2;
+  BOOLEAN                                 ResetStats;
+  UINT64                                  StartTsc;
+  UINT64                                  TscFrequency;
+  CHAR16                                  *TypeName;
+
+  ResetStats = FALSE;
+  Status = gBS->HandleProtocol (ImageHandle, &gEfiShellParametersProtocolGuid, (VOID **) &ShellParameters);
+  if (!EFI_ERROR (Status)) {
+    for (Index = 1; Index < ShellParameters->Argc; Index++) {
+      if (StrCmp (ShellParameters->Argv[Index], L"-r") == 0) {
+        ResetStats = TRUE;
+      } else {
+        Print (L"Usage: PchSmiStats [-r]\n");
+        Print (L"  -r  Clear the statistics after they were dumped.\n");
+        return EFI_INVALID_PARAMETER;
+      }
+    }
+  }
+
+  Status = gBS->LocateProtocol (&gEfiSmmCommunicationProtocolGuid, NULL, (VOID **) &SmmCommunication);
+  if (EFI_ERROR (Status)) {
+    Print (L"PchSmiStats: Locate SmmCommunication protocol - %r\n", Status);
+    return Status;
+  }
+
+  CommBuffer = GetCommBuffer (&CommBufferSize);
+  if (CommBuffer == NULL) {
+    Print (L"PchSmiStats: No SMM communication region\n");
+    return EFI_NOT_FOUND;
+  }
+
+  Status = GetHandlerStats (SmmCommunication, CommBuffer, CommBufferSize, &Entries, &EntryCount);
+  if (EFI_ERROR (Status)) {
+    Print (L"PchSmiStats: Get the handler statistics - %r\n", Status);
+    return Status;
+  }
+
+  //
+  // The statistics are in TSC ticks.
+  //
+  StartTsc = AsmReadTsc ();
+  gBS->Stall (PCH_SMI_STATS_CALIBRATION_TIME);
+  TscFrequency = DivU64x32 (MultU64x32 (AsmReadTsc () - StartTsc, 1000000), PCH_SMI_STATS_CALIBRATION_TIME);
+  if (TscFrequency == 0) {
+    TscFrequency = 1;
+  }
+
+  //
+  // Sort by decreasing maximum time, the lists are short.
+  //
+  for (Index = 1; Index < EntryCount; Index++) {
+    CopyMem (&Swap, &Entries[Index], sizeof (Swap));
+    for (Index2 = Index; (Index2 > 0) && (Entries[Index2 - 1].Stats.MaxTsc < Swap.Stats.MaxTsc); Index2--) {
+      CopyMem (&Entries[Index2], &Entries[Index2 - 1], sizeof (Swap));
+    }
+    CopyMem (&Entries[Index2], &Swap, sizeof (Swap));
+  }
+
+  Print (L"TSC frequency: %ld kHz\n\n", DivU64x32 (TscFrequency, 1000));
+  Print (L"Type      Context   Handler             Count       Min(us)   Avg(us)   Max(us)\n");
+  for (Index = 0; Index < EntryCount; Index++) {
+    TypeName = GetHandlerTypeName (&Entries[Index].HandlerType);
+    if (TypeName != NULL) {
+      Print (L"%-9s ", TypeName);
+    } else {
+      Print (L"%g\n          ", &Entries[Index].HandlerType);
+    }
+    Print (
+      L"0x%-7lx 0x%016lx  %-10ld  %-8ld  %-8ld  %-8ld\n",
+      Entries[Index].Context,
+      Entries[Index].Handler,
+      Entries[Index].Stats.Count,
+      TscToMicroseconds (Entries[Index].Stats.MinTsc, TscFrequency),
+      (Entries[Index].Stats.Count == 0) ? 0 :
+        TscToMicroseconds (DivU64x64Remainder (Entries[Index].Stats.TotalTsc, Entries[Index].Stats.Count, NULL), TscFrequency),
+      TscToMicroseconds (Entries[Index].Stats.MaxTsc, TscFrequency)
+      );
+  }
+  FreePool (Entries);
+
+  if (ResetStats) {
+    Reset = (PCH_SMI_HANDLER_STATS_PARAMETER_RESET *) &CommBuffer[OFFSET_OF (EFI_SMM_COMMUNICATE_HEADER, Data)];
+    Reset->Header.Command = PCH_SMI_HANDLER_STATS_COMMAND_RESET;
+    Status = SendCommand (SmmCommunication, CommBuffer, sizeof (*Reset));
+    if (EFI_ERROR (Status)) {
+      Print (L"PchSmiStats: Clear the handler statistics - %r\n", Status);
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
@@ -0,0 +1,257 @@
+/** @file
+  Statistics of the time the PCH SMI handlers spend in SMM.
+
+  Every child handler of the dispatcher keeps its call count and its minimum,
+  maximum and total TSC ticks in SMRAM. They are exported through the SMM
+  communicate buffer with the gPchSmiHandlerStatsGuid header.
+
+  Copyright (c) 2020 Intel Corporation. All rights reserved. <BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+**/
+
+#include "PchSmmHelpers.h"
+#include "PchSmmEspi.h"
+#include <Library/SmmMemLib.h>
+
+typedef struct {
+  UINT64                        Index;
+  UINT64                        Offset;
+  UINT64                        Count;
+  UINT64                        Filled;
+  PCH_SMI_HANDLER_STATS_ENTRY   *Entry;
+} PCH_SMI_HANDLER_STATS_COLLECT;
+
+/**
+  Account the time spent in a handler to its statistics.
+
+  @param[in, out] Stats                 The statistics of the handler
+  @param[in]      StartTsc              The TSC value read before the handler was called
+**/
+VOID
+PchSmmUpdateHandlerStats (
+  IN OUT PCH_SMI_HANDLER_STATS    *Stats,
+  IN     UINT64                   StartTsc
+  )
+{
+  UINT64    Elapsed;
+
+  Elapsed = AsmReadTsc () - StartTsc;
+
+  if ((Stats->Count == 0) || (Elapsed < Stats->MinTsc)) {
+    Stats->MinTsc = Elapsed;
+  }
+  if (Elapsed > Stats->MaxTsc) {
+    Stats->MaxTsc = Elapsed;
+  }
+  Stats->TotalTsc += Elapsed;
+  Stats->Count++;
+}
+
+/**
+  Walk the statistics of all the handlers of the dispatcher.
+
+  @param[in]      Visitor               The function called for every handler
+  @param[in, out] VisitorContext        The context passed to Visitor
+**/
+STATIC
+VOID
+PchSmmVisitAllHandlerStats (
+  IN     PCH_SMM_HANDLER_STATS_VISITOR  Visitor,
+  IN OUT VOID                           *VisitorContext
+  )
+{
+  PchSmmCoreVisitHandlerStats (Visitor, VisitorContext);
+  PchSwSmiVisitHandlerStats (Visitor, VisitorContext);
+  PchEspiSmiVisitHandlerStats (Visitor, VisitorContext);
+}
+
+/**
+  Count the handlers.
+
+  @param[in]      HandlerType           Not used
+  @param[in]      Handler               Not used
+  @param[in]      Context               Not used
+  @param[in, out] Stats                 Not used
+  @param[in, out] VisitorContext        Pointer to the UINT64 count
+**/
+STATIC
+VOID
+PchSmmCountHandlerStats (
+  IN     CONST EFI_GUID           *HandlerType,
+  IN     UINT64                   Handler,
+  IN     UINT64                   Context,
+  IN OUT PCH_SMI_HANDLER_STATS    *Stats,
+  IN OUT VOID                     *VisitorContext
+  )
+{
+  (*(UINT64 *) VisitorContext)++;
+}
+
+/**
+  Copy the statistics of the handlers in the requesting window to the
+  communicate buffer.
+
+  @param[in]      HandlerType           GUID of the dispatch protocol the handler was registered with
+  @param[in]      Handler               Address of the handler
+  @param[in]      Context               SW SMI value, GPI number or PCH SMI type, 0 for the other types
+  @param[in, out] Stats                 The statistics of the handler
+  @param[in, out] VisitorContext        Pointer to PCH_SMI_HANDLER_STATS_COLLECT
+**/
+STATIC
+VOID
+PchSmmCollectHandlerStats (
+  IN     CONST EFI_GUID           *HandlerType,
+  IN     UINT64                   Handler,
+  IN     UINT64                   Context,
+  IN OUT PCH_SMI_HANDLER_STATS    *Stats,
+  IN OUT VOID                     *VisitorContext
+  )
+{
+  PCH_SMI_HANDLER_STATS_COLLECT   *Collect;
+  PCH_SMI_HANDLER_STATS_ENTRY     *Entry;
+
+  Collect = (PCH_SMI_HANDLER_STATS_COLLECT *) VisitorContext;
+  if ((Collect->Index >= Collect->Offset) && (Collect->Filled < Collect->Count)) {
+    Entry = &Collect->Entry[Collect->Filled];
+    CopyGuid (&Entry->HandlerType, HandlerType);
+    Entry->Handler = Handler;
+    Entry->Context = Context;
+    CopyMem (&Entry->Stats, Stats, sizeof (PCH_SMI_HANDLER_STATS));
+    Collect->Filled++;
+  }
+  Collect->Index++;
+}
+
+/**
+  Clear the statistics of a handler.
+
+  @param[in]      HandlerType           Not used
+  @param[in]      Handler               Not used
+  @param[in]      Context               Not used
+  @param[in, out] Stats                 The statistics of the handler
+  @param[in, out] VisitorContext        Not used
+**/
+STATIC
+VOID
+PchSmmResetHandlerStats (
+  IN     CONST EFI_GUID           *HandlerType,
+  IN     UINT64                   Handler,
+  IN     UINT64                   Context,
+  IN OUT PCH_SMI_HANDLER_STATS    *Stats,
+  IN OUT VOID                     *VisitorContext
+  )
+{
+  ZeroMem (Stats, sizeof (PCH_SMI_HANDLER_STATS));
+}
+
+/**
+  The SMI handler exporting the handler statistics.
+
+  @param[in]      DispatchHandle        The unique handle assigned to this handler by SmiHandlerRegister()
+  @param[in]      Context               Not used
+  @param[in, out] CommBuffer            The PCH_SMI_HANDLER_STATS_PARAMETER_* of the command
+  @param[in, out] CommBufferSize        The size of CommBuffer
+
+  @retval EFI_SUCCESS                   The command was handled, its status is in the parameter header
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PchSmiHandlerStatsHandler (
+  IN     EFI_HANDLE       DispatchHandle,
+  IN     CONST VOID       *Context         OPTIONAL,
+  IN OUT VOID             *CommBuffer      OPTIONAL,
+  IN OUT UINTN            *CommBufferSize  OPTIONAL
+  )
+{
+  PCH_SMI_HANDLER_STATS_PARAMETER_HEADER    *Header;
+  PCH_SMI_HANDLER_STATS_PARAMETER_GET_INFO  *GetInfo;
+  PCH_SMI_HANDLER_STATS_PARAMETER_GET_DATA  *GetData;
+  PCH_SMI_HANDLER_STATS_COLLECT             Collect;
+  UINTN                                     TempCommBufferSize;
+  UINT64                                    HandlerCount;
+
+  if ((CommBuffer == NULL) || (CommBufferSize == NULL)) {
+    return EFI_SUCCESS;
+  }
+
+  TempCommBufferSize = *CommBufferSize;
+  if (TempCommBufferSize < sizeof (PCH_SMI_HANDLER_STATS_PARAMETER_HEADER)) {
+    DEBUG ((DEBUG_ERROR, "PchSmiHandlerStatsHandler: SMM communication buffer size invalid!\n"));
+    return EFI_SUCCESS;
+  }
+  if (!SmmIsBufferOutsideSmmValid ((UINTN) CommBuffer, TempCommBufferSize)) {
+    DEBUG ((DEBUG_ERROR, "PchSmiHandlerStatsHandler: SMM communication buffer in SMRAM or overflow!\n"));
+    return EFI_SUCCESS;
+  }
+
+  Header = (PCH_SMI_HANDLER_STATS_PARAMETER_HEADER *) CommBuffer;
+  Header->ReturnStatus = (UINT64) EFI_INVALID_PARAMETER;
+
+  switch (Header->Command) {
+    case PCH_SMI_HANDLER_STATS_COMMAND_GET_INFO:
+      if (TempCommBufferSize < sizeof (PCH_SMI_HANDLER_STATS_PARAMETER_GET_INFO)) {
+        break;
+      }
+      GetInfo = (PCH_SMI_HANDLER_STATS_PARAMETER_GET_INFO *) CommBuffer;
+      HandlerCount = 0;
+      PchSmmVisitAllHandlerStats (PchSmmCountHandlerStats, &HandlerCount);
+      GetInfo->HandlerCount = HandlerCount;
+      Header->ReturnStatus  = (UINT64) EFI_SUCCESS;
+      break;
+
+    case PCH_SMI_HANDLER_STATS_COMMAND_GET_DATA:
+      if (TempCommBufferSize < sizeof (PCH_SMI_HANDLER_STATS_PARAMETER_GET_DATA)) {
+        break;
+      }
+      GetData = (PCH_SMI_HANDLER_STATS_PARAMETER_GET_DATA *) CommBuffer;
+      //
+      // Take a copy of the request so that it cannot change while it is checked
+      //
+      Collect.Index  = 0;
+      Collect.Offset = GetData->Offset;
+      Collect.Count  = GetData->Count;
+      Collect.Filled = 0;
+      Collect.Entry  = (PCH_SMI_HANDLER_STATS_ENTRY *) (GetData + 1);
+      if (Collect.Count > (TempCommBufferSize - sizeof (PCH_SMI_HANDLER_STATS_PARAMETER_GET_DATA)) / sizeof (PCH_SMI_HANDLER_STATS_ENTRY)) {
+        break;
+      }
+      PchSmmVisitAllHandlerStats (PchSmmCollectHandlerStats, &Collect);
+      GetData->Count       = Collect.Filled;
+      Header->ReturnStatus = (UINT64) EFI_SUCCESS;
+      break;
+
+    case PCH_SMI_HANDLER_STATS_COMMAND_RESET:
+      PchSmmVisitAllHandlerStats (PchSmmResetHandlerStats, NULL);
+      Header->ReturnStatus = (UINT64) EFI_SUCCESS;
+      break;
+
+    default:
+      Header->ReturnStatus = (UINT64) EFI_UNSUPPORTED;
+      break;
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Register the SMI handler exporting the handler statistics through the SMM
+  communicate buffer.
+**/
+VOID
+InstallPchSmiHandlerStats (
+  VOID
+  )
+{
+  EFI_STATUS    Status;
+  EFI_HANDLE    DispatchHandle;
+
+  DispatchHandle = NULL;
+  Status = gSmst->SmiHandlerRegister (
+                    PchSmiHandlerStatsHandler,
+                    &gPchSmiHandlerStatsGuid,
+                    &DispatchHandle
+                    );
+  ASSERT_EFI_ERROR (Status);
+}
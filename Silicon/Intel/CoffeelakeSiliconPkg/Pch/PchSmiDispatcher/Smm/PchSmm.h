@@ -46,6 +46,7 @@
 #include <Protocol/PchEspiSmiDispatch.h>
 #include <Protocol/IoTrapExDispatch.h>
 #include <Library/PmcLib.h>
+#include <PchSmiHandlerStats.h>
 #include "IoTrap.h"
 
 #define EFI_BAD_POINTER          0xAFAFAFAFAFAFAFAFULL
@@ -454,6 +455,11 @@ struct _DATABASE_RECORD {
   /// Indicate the PCH SMI types.
   ///
   PCH_SMI_TYPES                 PchSmiType;
+
+  ///
+  /// Time spent in the callback function
+  ///
+  PCH_SMI_HANDLER_STATS         Stats;
 };
 
 #define DATABASE_RECORD_FROM_LINK(_record)  CR (_record, DATABASE_RECORD, Link, DATABASE_RECORD_SIGNATURE)
@@ -611,6 +617,79 @@ SmmCoreInsertRecord (
   OUT EFI_HANDLE                        *DispatchHandle
   );
 
+/**
+  Mark the source index used by the dispatcher as stale. It must be called whenever
+  a record is added to or removed from the callback database.
+**/
+VOID
+PchSmmInvalidateSourceIndex (
+  VOID
+  );
+
+/**
+  The function called for every handler when the handler statistics are walked.
+
+  @param[in]      HandlerType           GUID of the dispatch protocol the handler was registered with
+  @param[in]      Handler               Address of the handler
+  @param[in]      Context               SW SMI value, GPI number or PCH SMI type, 0 for the other types
+  @param[in, out] Stats                 The statistics of the handler
+  @param[in, out] VisitorContext        The context of the walk
+**/
+typedef
+VOID
+(*PCH_SMM_HANDLER_STATS_VISITOR) (
+  IN     CONST EFI_GUID           *HandlerType,
+  IN     UINT64                   Handler,
+  IN     UINT64                   Context,
+  IN OUT PCH_SMI_HANDLER_STATS    *Stats,
+  IN OUT VOID                     *VisitorContext
+  );
+
+/**
+  Account the time spent in a handler to its statistics.
+
+  @param[in, out] Stats                 The statistics of the handler
+  @param[in]      StartTsc              The TSC value read before the handler was called
+**/
+VOID
+PchSmmUpdateHandlerStats (
+  IN OUT PCH_SMI_HANDLER_STATS    *Stats,
+  IN     UINT64                   StartTsc
+  );
+
+/**
+  Walk the statistics of the handlers of the PchSmmCore database.
+
+  @param[in]      Visitor               The function called for every handler
+  @param[in, out] VisitorContext        The context passed to Visitor
+**/
+VOID
+PchSmmCoreVisitHandlerStats (
+  IN     PCH_SMM_HANDLER_STATS_VISITOR  Visitor,
+  IN OUT VOID                           *VisitorContext
+  );
+
+/**
+  Walk the statistics of the software SMI handlers.
+
+  @param[in]      Visitor               The function called for every handler
+  @param[in, out] VisitorContext        The context passed to Visitor
+**/
+VOID
+PchSwSmiVisitHandlerStats (
+  IN     PCH_SMM_HANDLER_STATS_VISITOR  Visitor,
+  IN OUT VOID                           *VisitorContext
+  );
+
+/**
+  Register the SMI handler exporting the handler statistics through the SMM
+  communicate buffer.
+**/
+VOID
+InstallPchSmiHandlerStats (
+  VOID
+  );
+
 /**
   Get the Sleep type
 
@@ -25,6 +25,32 @@ GLOBAL_REMOVE_IF_UNREFERENCED UINT16                mAcpiBaseAddr;
 GLOBAL_REMOVE_IF_UNREFERENCED UINT16                mTcoBaseAddr;
 GLOBAL_REMOVE_IF_UNREFERENCED BOOLEAN               mReadyToLock;
 
+//
+// The distinct SMI sources of the callback database.
+//
+// The dispatcher used to walk the whole database for the first active source,
+// reading the enable and status registers of every record, and then restarted
+// from the head for the next one. The index keeps one entry per source in
+// database order, so every source is checked once per pass and all the active
+// ones are dispatched in the same pass.
+//
+typedef struct {
+  DATABASE_RECORD   *FirstRecord;       // First record of the source in database order
+  UINT64            DispatchCount;
+  UINT64            TotalTsc;
+  UINT64            MaxTsc;
+} PCH_SMM_SOURCE_GROUP;
+
+typedef struct {
+  BOOLEAN               Valid;
+  UINTN                 Count;
+  UINTN                 MaxCount;
+  PCH_SMM_SOURCE_GROUP  *Group;
+  UINT32                *ActiveBitmap;
+} PCH_SMM_SOURCE_INDEX;
+
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMM_SOURCE_INDEX  mSourceIndex;
+
 GLOBAL_REMOVE_IF_UNREFERENCED PRIVATE_DATA          mPrivateData = {
   {
     NULL,
@@ -146,6 +172,96 @@ PchSmmCoreDispatcher (
 //
 // FUNCTIONS
 //
+/**
+  Mark the source index as stale. It is called whenever a record is added to or
+  removed from the callback database, the index is rebuilt before the next dispatch.
+**/
+VOID
+PchSmmInvalidateSourceIndex (
+  VOID
+  )
+{
+  mSourceIndex.Valid = FALSE;
+}
+
+/**
+  Build the source index from the callback database.
+
+  @retval EFI_SUCCESS                   The index is built
+  @retval EFI_OUT_OF_RESOURCES          Fail to allocate pool for the index
+**/
+STATIC
+EFI_STATUS
+PchSmmBuildSourceIndex (
+  VOID
+  )
+{
+  EFI_STATUS            Status;
+  LIST_ENTRY            *LinkInDb;
+  DATABASE_RECORD       *RecordInDb;
+  UINTN                 RecordCount;
+  UINTN                 Index;
+  PCH_SMM_SOURCE_GROUP  *Group;
+  UINT32                *ActiveBitmap;
+
+  RecordCount = 0;
+  for (LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+       !IsNull (&mPrivateData.CallbackDataBase, LinkInDb);
+       LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, LinkInDb)) {
+    RecordCount++;
+  }
+
+  if (RecordCount > mSourceIndex.MaxCount) {
+    Status = gSmst->SmmAllocatePool (
+                      EfiRuntimeServicesData,
+                      RecordCount * sizeof (PCH_SMM_SOURCE_GROUP),
+                      (VOID **) &Group
+                      );
+    if (EFI_ERROR (Status)) {
+      return EFI_OUT_OF_RESOURCES;
+    }
+    Status = gSmst->SmmAllocatePool (
+                      EfiRuntimeServicesData,
+                      ((RecordCount + 31) / 32) * sizeof (UINT32),
+                      (VOID **) &ActiveBitmap
+                      );
+    if (EFI_ERROR (Status)) {
+      gSmst->SmmFreePool (Group);
+      return EFI_OUT_OF_RESOURCES;
+    }
+    if (mSourceIndex.Group != NULL) {
+      gSmst->SmmFreePool (mSourceIndex.Group);
+      gSmst->SmmFreePool (mSourceIndex.ActiveBitmap);
+    }
+    mSourceIndex.Group        = Group;
+    mSourceIndex.ActiveBitmap = ActiveBitmap;
+    mSourceIndex.MaxCount     = RecordCount;
+  }
+
+  mSourceIndex.Count = 0;
+  if (mSourceIndex.MaxCount != 0) {
+    ZeroMem (mSourceIndex.Group, mSourceIndex.MaxCount * sizeof (PCH_SMM_SOURCE_GROUP));
+  }
+
+  for (LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+       !IsNull (&mPrivateData.CallbackDataBase, LinkInDb);
+       LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, LinkInDb)) {
+    RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
+    for (Index = 0; Index < mSourceIndex.Count; Index++) {
+      if (CompareSources (&mSourceIndex.Group[Index].FirstRecord->SrcDesc, &RecordInDb->SrcDesc)) {
+        break;
+      }
+    }
+    if (Index == mSourceIndex.Count) {
+      mSourceIndex.Group[Index].FirstRecord = RecordInDb;
+      mSourceIndex.Count++;
+    }
+  }
+
+  mSourceIndex.Valid = TRUE;
+  return EFI_SUCCESS;
+}
+
 /**
   SMM ready to lock notification event handler.
 
@@ -166,6 +282,12 @@ SmmReadyToLockCallback (
 {
   mReadyToLock = TRUE;
 
+  //
+  // Build the source index now, no record can be added or removed from here on
+  // and the dispatcher does not need to allocate memory at SMI time.
+  //
+  PchSmmBuildSourceIndex ();
+
   return EFI_SUCCESS;
 }
 
@@ -259,6 +381,7 @@ InitializePchSmmDispatcher (
   InstallIoTrap (ImageHandle);
   InstallEspiSmi (ImageHandle);
   InstallPchSmmPeriodicTimerControlProtocol (mPrivateData.InstallMultProtHandle);
+  InstallPchSmiHandlerStats ();
 
   //
   // Register EFI_SMM_READY_TO_LOCK_PROTOCOL_GUID notify function.
@@ -305,11 +428,13 @@ SmmCoreInsertRecord (
     return EFI_OUT_OF_RESOURCES;
   }
   CopyMem (Record, NewRecord, sizeof (DATABASE_RECORD));
+  ZeroMem (&Record->Stats, sizeof (Record->Stats));
 
   //
   // After ensuring the source of event is not null, we will insert the record into the database
   //
   InsertTailList (&mPrivateData.CallbackDataBase, &Record->Link);
+  PchSmmInvalidateSourceIndex ();
 
   //
   // Child's handle will be the address linked list link in the record
@@ -571,6 +696,7 @@ PchSmmCoreUnRegister (
   }
 
   RemoveEntryList (&RecordToDelete->Link);
+  PchSmmInvalidateSourceIndex ();
 
   //
   // Loop through all the souces in record linked list to see if any source enable is equal.
@@ -648,6 +774,172 @@ ClearPendingSmiStatus (
   }
 }
 
+/**
+  Dispatch the children of an active SMI source and clear the source.
+
+  @param[in]      FirstRecord           The first record of the source in the callback database
+  @param[in, out] SxChildWasDispatched  Set to TRUE if a child of the Sx dispatch protocol was dispatched
+**/
+STATIC
+VOID
+PchSmmDispatchSource (
+  IN     DATABASE_RECORD      *FirstRecord,
+  IN OUT BOOLEAN              *SxChildWasDispatched
+  )
+{
+  BOOLEAN               ContextsMatch;
+  DATABASE_RECORD       *RecordToExhaust;
+  LIST_ENTRY            *LinkToExhaust;
+  PCH_SMM_CONTEXT       Context;
+  VOID                  *CommBuffer;
+  UINTN                 CommBufferSize;
+  PCH_SMM_SOURCE_DESC   ActiveSource;
+  PCH_SMM_CLEAR_SOURCE  ClearSource;
+  UINT64                StartTsc;
+
+  //
+  // "cache" the source description and don't query I/O anymore
+  //
+  CopyMem ((VOID *) &ActiveSource, (VOID *) &(FirstRecord->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
+  ClearSource   = FirstRecord->ClearSource;
+  LinkToExhaust = &FirstRecord->Link;
+
+  //
+  // exhaust the rest of the queue looking for the same source
+  //
+  while (!IsNull (&mPrivateData.CallbackDataBase, LinkToExhaust)) {
+    RecordToExhaust = DATABASE_RECORD_FROM_LINK (LinkToExhaust);
+    //
+    // RecordToExhaust->Link might be removed (unregistered) by Callback function, and then the
+    // system will hang in ASSERT() while calling GetNextNode().
+    // To prevent the issue, we need to get next record in DB here (before Callback function).
+    //
+    LinkToExhaust = GetNextNode (&mPrivateData.CallbackDataBase, &RecordToExhaust->Link);
+
+    if (CompareSources (&RecordToExhaust->SrcDesc, &ActiveSource)) {
+      //
+      // These source descriptions are equal, so this callback should be
+      // dispatched.
+      //
+      if (RecordToExhaust->ContextFunctions.GetContext != NULL) {
+        //
+        // This child requires that we get a calling context from
+        // hardware and compare that context to the one supplied
+        // by the child.
+        //
+        ASSERT (RecordToExhaust->ContextFunctions.CmpContext != NULL);
+
+        //
+        // Make sure contexts match before dispatching event to child
+        //
+        RecordToExhaust->ContextFunctions.GetContext (RecordToExhaust, &Context);
+        ContextsMatch = RecordToExhaust->ContextFunctions.CmpContext (&Context, &RecordToExhaust->ChildContext);
+
+      } else {
+        //
+        // This child doesn't require any more calling context beyond what
+        // it supplied in registration.  Simply pass back what it gave us.
+        //
+        Context       = RecordToExhaust->ChildContext;
+        ContextsMatch = TRUE;
+      }
+
+      if (ContextsMatch) {
+        if (RecordToExhaust->ProtocolType == PchSmiDispatchType) {
+          //
+          // For PCH SMI dispatch protocols
+          //
+          StartTsc = AsmReadTsc ();
+          PchSmiTypeCallbackDispatcher (RecordToExhaust);
+          PchSmmUpdateHandlerStats (&RecordToExhaust->Stats, StartTsc);
+        } else {
+          //
+          // For EFI standard SMI dispatch protocols
+          //
+          if (RecordToExhaust->Callback != NULL) {
+            if (RecordToExhaust->ContextFunctions.GetCommBuffer != NULL) {
+              //
+              // This callback function needs CommBuffer and CommBufferSize.
+              // Get those from child and then pass to callback function.
+              //
+              RecordToExhaust->ContextFunctions.GetCommBuffer (RecordToExhaust, &CommBuffer, &CommBufferSize);
+            } else {
+              //
+              // Child doesn't support the CommBuffer and CommBufferSize.
+              // Just pass NULL value to callback function.
+              //
+              CommBuffer     = NULL;
+              CommBufferSize = 0;
+            }
+
+            StartTsc = AsmReadTsc ();
+            PERF_START_EX (NULL, "SmmFunction", NULL, StartTsc, RecordToExhaust->ProtocolType);
+            RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
+            PchSmmUpdateHandlerStats (&RecordToExhaust->Stats, StartTsc);
+            PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
+            if (RecordToExhaust->ProtocolType == SxType) {
+              *SxChildWasDispatched = TRUE;
+            }
+          } else {
+            ASSERT (FALSE);
+          }
+        }
+      }
+    }
+  }
+
+  if (ClearSource == NULL) {
+    //
+    // Clear the SMI associated w/ the source using the default function
+    //
+    PchSmmClearSource (&ActiveSource);
+  } else {
+    //
+    // This source requires special handling to clear
+    //
+    ClearSource (&ActiveSource);
+  }
+}
+
+/**
+  Walk the statistics of the handlers of the PchSmmCore database.
+
+  @param[in]      Visitor               The function called for every handler
+  @param[in, out] VisitorContext        The context passed to Visitor
+**/
+VOID
+PchSmmCoreVisitHandlerStats (
+  IN     PCH_SMM_HANDLER_STATS_VISITOR  Visitor,
+  IN OUT VOID                           *VisitorContext
+  )
+{
+  DATABASE_RECORD     *RecordInDb;
+  LIST_ENTRY          *LinkInDb;
+
+  LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+  while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
+    RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
+    if (RecordInDb->ProtocolType == PchSmiDispatchType) {
+      Visitor (
+        &gPchSmiDispatchProtocolGuid,
+        (UINT64) (UINTN) RecordInDb->PchSmiCallback,
+        RecordInDb->PchSmiType,
+        &RecordInDb->Stats,
+        VisitorContext
+        );
+    } else {
+      Visitor (
+        mPrivateData.Protocols[RecordInDb->ProtocolType].Guid,
+        (UINT64) (UINTN) RecordInDb->Callback,
+        (RecordInDb->ProtocolType == GpiType) ? RecordInDb->ChildContext.Gpi.GpiNum : 0,
+        &RecordInDb->Stats,
+        VisitorContext
+        );
+    }
+    LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, &RecordInDb->Link);
+  }
+}
+
 /**
   The callback function to handle subsequent SMIs.  This callback will be called by SmmCoreDispatcher.
 
@@ -670,37 +962,26 @@ PchSmmCoreDispatcher (
   //
   // Used to prevent infinite loops
   //
-  UINTN               EscapeCount;
+  UINTN                 EscapeCount;
 
-  BOOLEAN             ContextsMatch;
-  BOOLEAN             EosSet;
-  BOOLEAN             SxChildWasDispatched;
+  BOOLEAN               EosSet;
+  BOOLEAN               SxChildWasDispatched;
+  BOOLEAN               SourceDispatched;
 
-  DATABASE_RECORD     *RecordInDb;
-  LIST_ENTRY          *LinkInDb;
-  DATABASE_RECORD     *RecordToExhaust;
-  LIST_ENTRY          *LinkToExhaust;
-
-  PCH_SMM_CONTEXT     Context;
-  VOID                *CommBuffer;
-  UINTN               CommBufferSize;
-
-  EFI_STATUS          Status;
-  BOOLEAN             SciEn;
-  UINT32              SmiEnValue;
-  UINT32              SmiStsValue;
-  UINT8               Port74Save;
-  UINT8               Port76Save;
-
-  PCH_SMM_SOURCE_DESC ActiveSource;
+  EFI_STATUS            Status;
+  BOOLEAN               SciEn;
+  UINT32                SmiEnValue;
+  UINT32                SmiStsValue;
+  UINT8                 Port74Save;
+  UINT8                 Port76Save;
 
-  //
-  // Initialize ActiveSource
-  //
-  NullInitSourceDesc (&ActiveSource);
+  UINTN                 Index;
+  BOOLEAN               Active;
+  PCH_SMM_SOURCE_GROUP  *Group;
+  UINT64                StartTsc;
+  UINT64                ElapsedTsc;
 
   EscapeCount           = 3;
-  ContextsMatch         = FALSE;
   EosSet                = FALSE;
   SxChildWasDispatched  = FALSE;
   Status                = EFI_SUCCESS;
@@ -721,7 +1002,13 @@ PchSmmCoreDispatcher (
     while ((!EosSet) && (EscapeCount > 0)) {
       EscapeCount--;
 
-      LinkInDb = GetFirstNode (&mPrivateData.CallbackDataBase);
+      if (!mSourceIndex.Valid) {
+        Status = PchSmmBuildSourceIndex ();
+        if (EFI_ERROR (Status)) {
+          ASSERT_EFI_ERROR (Status);
+          break;
+        }
+      }
 
       //
       // Cache SciEn, SmiEnValue and SmiStsValue to determine if source is active
@@ -730,147 +1017,77 @@ PchSmmCoreDispatcher (
       SmiEnValue  = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_EN));
       SmiStsValue = IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS));
 
-      while (!IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
-        RecordInDb = DATABASE_RECORD_FROM_LINK (LinkInDb);
+      //
+      // Find all the active sources in one scan, the registers shared by the
+      // sources are read only once.
+      //
+      ZeroMem (mSourceIndex.ActiveBitmap, ((mSourceIndex.Count + 31) / 32) * sizeof (UINT32));
+      PchSmmReadCacheStart ();
+      for (Index = 0; Index < mSourceIndex.Count; Index++) {
+        if (SourceIsActive (&mSourceIndex.Group[Index].FirstRecord->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
+          mSourceIndex.ActiveBitmap[Index / 32] |= (UINT32) (1u << (Index % 32));
+        }
+      }
+      PchSmmReadCacheStop ();
 
-        //
-        // look for the first active source
-        //
-        if (!SourceIsActive (&RecordInDb->SrcDesc, SciEn, SmiEnValue, SmiStsValue)) {
-          //
-          // Didn't find the source yet, keep looking
-          //
-          LinkInDb = GetNextNode (&mPrivateData.CallbackDataBase, &RecordInDb->Link);
+      SourceDispatched = FALSE;
+      for (Index = 0; Index < mSourceIndex.Count; Index++) {
+        if ((mSourceIndex.ActiveBitmap[Index / 32] & (1u << (Index % 32))) == 0) {
+          continue;
+        }
+        Group = &mSourceIndex.Group[Index];
 
+        if (SourceDispatched) {
           //
-          // if it's the last one, try to clear EOS
-          //
-          if (IsNull (&mPrivateData.CallbackDataBase, LinkInDb)) {
-            //
-            // Clear pending SMI status before EOS
-            //
-            ClearPendingSmiStatus (SmiStsValue, SciEn);
-            EosSet = PchSmmSetAndCheckEos ();
-          }
-        } else {
-          //
-          // We found a source. If this is a sleep type, we have to go to
-          // appropriate sleep state anyway.No matter there is sleep child or not
+          // A child dispatched before may have handled this source too, check it again
           //
-          if (RecordInDb->ProtocolType == SxType) {
-            SxChildWasDispatched = TRUE;
+          Active = SourceIsActive (
+                     &Group->FirstRecord->SrcDesc,
+                     SciEn,
+                     IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_EN)),
+                     IoRead32 ((UINTN) (mAcpiBaseAddr + R_ACPI_IO_SMI_STS))
+                     );
+          if (!Active) {
+            continue;
           }
-          //
-          // "cache" the source description and don't query I/O anymore
-          //
-          CopyMem ((VOID *) &ActiveSource, (VOID *) &(RecordInDb->SrcDesc), sizeof (PCH_SMM_SOURCE_DESC));
-          LinkToExhaust = LinkInDb;
+        }
 
-          //
-          // exhaust the rest of the queue looking for the same source
-          //
-          while (!IsNull (&mPrivateData.CallbackDataBase, LinkToExhaust)) {
-            RecordToExhaust = DATABASE_RECORD_FROM_LINK (LinkToExhaust);
-            //
-            // RecordToExhaust->Link might be removed (unregistered) by Callback function, and then the
-            // system will hang in ASSERT() while calling GetNextNode().
-            // To prevent the issue, we need to get next record in DB here (before Callback function).
-            //
-            LinkToExhaust = GetNextNode (&mPrivateData.CallbackDataBase, &RecordToExhaust->Link);
-
-            if (CompareSources (&RecordToExhaust->SrcDesc, &ActiveSource)) {
-              //
-              // These source descriptions are equal, so this callback should be
-              // dispatched.
-              //
-              if (RecordToExhaust->ContextFunctions.GetContext != NULL) {
-                //
-                // This child requires that we get a calling context from
-                // hardware and compare that context to the one supplied
-                // by the child.
-                //
-                ASSERT (RecordToExhaust->ContextFunctions.CmpContext != NULL);
-
-                //
-                // Make sure contexts match before dispatching event to child
-                //
-                RecordToExhaust->ContextFunctions.GetContext (RecordToExhaust, &Context);
-                ContextsMatch = RecordToExhaust->ContextFunctions.CmpContext (&Context, &RecordToExhaust->ChildContext);
-
-              } else {
-                //
-                // This child doesn't require any more calling context beyond what
-                // it supplied in registration.  Simply pass back what it gave us.
-                //
-                Context       = RecordToExhaust->ChildContext;
-                ContextsMatch = TRUE;
-              }
-
-              if (ContextsMatch) {
-                if (RecordToExhaust->ProtocolType == PchSmiDispatchType) {
-                  //
-                  // For PCH SMI dispatch protocols
-                  //
-                  PchSmiTypeCallbackDispatcher (RecordToExhaust);
-                } else {
-                  //
-                  // For EFI standard SMI dispatch protocols
-                  //
-                  if (RecordToExhaust->Callback != NULL) {
-                    if (RecordToExhaust->ContextFunctions.GetCommBuffer != NULL) {
-                      //
-                      // This callback function needs CommBuffer and CommBufferSize.
-                      // Get those from child and then pass to callback function.
-                      //
-                      RecordToExhaust->ContextFunctions.GetCommBuffer (RecordToExhaust, &CommBuffer, &CommBufferSize);
-                    } else {
-                      //
-                      // Child doesn't support the CommBuffer and CommBufferSize.
-                      // Just pass NULL value to callback function.
-                      //
-                      CommBuffer     = NULL;
-                      CommBufferSize = 0;
-                    }
-
-                    PERF_START_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    RecordToExhaust->Callback ((EFI_HANDLE) & RecordToExhaust->Link, &Context, CommBuffer, &CommBufferSize);
-                    PERF_END_EX (NULL, "SmmFunction", NULL, AsmReadTsc (), RecordToExhaust->ProtocolType);
-                    if (RecordToExhaust->ProtocolType == SxType) {
-                      SxChildWasDispatched = TRUE;
-                    }
-                  } else {
-                    ASSERT (FALSE);
-                  }
-                }
-              }
-            }
-          }
+        //
+        // We found a source. If this is a sleep type, we have to go to
+        // appropriate sleep state anyway.No matter there is sleep child or not
+        //
+        if (Group->FirstRecord->ProtocolType == SxType) {
+          SxChildWasDispatched = TRUE;
+        }
 
-          if (RecordInDb->ClearSource == NULL) {
-            //
-            // Clear the SMI associated w/ the source using the default function
-            //
-            PchSmmClearSource (&ActiveSource);
-          } else {
-            //
-            // This source requires special handling to clear
-            //
-            RecordInDb->ClearSource (&ActiveSource);
-          }
-          //
-          // Clear pending SMI status before EOS
-          //
-          ClearPendingSmiStatus (SmiStsValue, SciEn);
-          //
-          // Also, try to clear EOS
-          //
-          EosSet = PchSmmSetAndCheckEos ();
+        StartTsc = AsmReadTsc ();
+        PchSmmDispatchSource (Group->FirstRecord, &SxChildWasDispatched);
+        ElapsedTsc = AsmReadTsc () - StartTsc;
+        SourceDispatched = TRUE;
+
+        if (!mSourceIndex.Valid) {
           //
-          // Queue is empty, reset the search
+          // A child added or removed a record, the index has to be rebuilt
+          // before the remaining sources are looked at.
           //
           break;
         }
+
+        Group->DispatchCount++;
+        Group->TotalTsc += ElapsedTsc;
+        if (ElapsedTsc > Group->MaxTsc) {
+          Group->MaxTsc = ElapsedTsc;
+        }
       }
+
+      //
+      // Clear pending SMI status before EOS
+      //
+      ClearPendingSmiStatus (SmiStsValue, SciEn);
+      //
+      // Also, try to clear EOS
+      //
+      EosSet = PchSmmSetAndCheckEos ();
     }
   }
   //
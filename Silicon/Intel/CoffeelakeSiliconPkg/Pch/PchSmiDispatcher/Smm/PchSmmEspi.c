@@ -579,6 +579,7 @@ EspiSmiCallback (
   ESPI_SMI_TYPE       EspiSmiType;
   ESPI_SMI_RECORD     *RecordInDb;
   LIST_ENTRY          *LinkInDb;
+  UINT64              StartTsc;
 
   PchSmiRecord = DATABASE_RECORD_FROM_LINK (DispatchHandle);
 
@@ -619,7 +620,9 @@ EspiSmiCallback (
         // Callback
         //
         if (RecordInDb->Callback != NULL) {
+          StartTsc = AsmReadTsc ();
           RecordInDb->Callback ((EFI_HANDLE) &RecordInDb->Link);
+          PchSmmUpdateHandlerStats (&RecordInDb->Stats, StartTsc);
         } else {
           ASSERT (FALSE);
         }
@@ -817,6 +820,38 @@ InstallEspiSmi (
   return EFI_SUCCESS;
 }
 
+/**
+  Walk the statistics of the eSPI SMI handlers.
+
+  @param[in]      Visitor         The function called for every handler
+  @param[in, out] VisitorContext  The context passed to Visitor
+**/
+VOID
+PchEspiSmiVisitHandlerStats (
+  IN     PCH_SMM_HANDLER_STATS_VISITOR  Visitor,
+  IN OUT VOID                           *VisitorContext
+  )
+{
+  ESPI_SMI_TYPE       EspiSmiType;
+  ESPI_SMI_RECORD     *RecordInDb;
+  LIST_ENTRY          *LinkInDb;
+
+  for (EspiSmiType = 0; EspiSmiType < EspiSmiTypeMax; ++EspiSmiType) {
+    LinkInDb = GetFirstNode (&mEspiSmiInstance.CallbackDataBase[EspiSmiType]);
+    while (!IsNull (&mEspiSmiInstance.CallbackDataBase[EspiSmiType], LinkInDb)) {
+      RecordInDb = ESPI_RECORD_FROM_LINK (LinkInDb);
+      Visitor (
+        &gPchEspiSmiDispatchProtocolGuid,
+        (UINT64) (UINTN) RecordInDb->Callback,
+        EspiSmiType,
+        &RecordInDb->Stats,
+        VisitorContext
+        );
+      LinkInDb = GetNextNode (&mEspiSmiInstance.CallbackDataBase[EspiSmiType], &RecordInDb->Link);
+    }
+  }
+}
+
 /**
   eSPI SMI Dispatch Protocol instance to register a BIOS Write Protect event
 
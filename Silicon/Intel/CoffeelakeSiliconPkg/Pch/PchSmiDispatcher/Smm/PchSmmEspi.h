@@ -94,6 +94,7 @@ typedef struct _ESPI_SMI_RECORD {
   UINT32                          Signature;
   LIST_ENTRY                      Link;
   PCH_ESPI_SMI_DISPATCH_CALLBACK  Callback;
+  PCH_SMI_HANDLER_STATS           Stats;
 } ESPI_SMI_RECORD;
 
 /**
@@ -110,6 +111,18 @@ InstallEspiSmi (
   IN EFI_HANDLE           ImageHandle
   );
 
+/**
+  Walk the statistics of the eSPI SMI handlers.
+
+  @param[in]      Visitor         The function called for every handler
+  @param[in, out] VisitorContext  The context passed to Visitor
+**/
+VOID
+PchEspiSmiVisitHandlerStats (
+  IN     PCH_SMM_HANDLER_STATS_VISITOR  Visitor,
+  IN OUT VOID                           *VisitorContext
+  );
+
 /**
   eSPI SMI Dispatch Protocol instance to register a BIOS Write Protect event
 
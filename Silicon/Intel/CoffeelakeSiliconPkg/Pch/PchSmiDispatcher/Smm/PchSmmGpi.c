@@ -242,6 +242,7 @@ PchGpiSmiUnRegister (
 
 
   RemoveEntryList (&RecordToDelete->Link);
+  PchSmmInvalidateSourceIndex ();
   ZeroMem (RecordToDelete, sizeof (DATABASE_RECORD));
   Status = gSmst->SmmFreePool (RecordToDelete);
 
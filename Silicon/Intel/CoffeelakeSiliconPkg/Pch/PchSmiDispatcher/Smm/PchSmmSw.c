@@ -28,6 +28,7 @@ typedef struct {
   LIST_ENTRY                            Link;
   EFI_SMM_SW_REGISTER_CONTEXT           Context;
   EFI_SMM_HANDLER_ENTRY_POINT2          Callback;
+  PCH_SMI_HANDLER_STATS                 Stats;
 } SW_SMI_RECORD;
 
 GLOBAL_REMOVE_IF_UNREFERENCED CONST PCH_SMM_SOURCE_DESC mSwSourceDesc = {
@@ -188,6 +189,7 @@ PchSwSmiRegister (
   SwSmiRecord->Signature               = SW_SMI_RECORD_SIGNATURE;
   SwSmiRecord->Context.SwSmiInputValue = DispatchContext->SwSmiInputValue;
   SwSmiRecord->Callback                = DispatchFunction;
+  ZeroMem (&SwSmiRecord->Stats, sizeof (SwSmiRecord->Stats));
   //
   // Publish the S/W SMI numbers in Serial logs used for Debug build.
   //
@@ -287,6 +289,7 @@ PchSwSmiDispatcher (
   LIST_ENTRY                            *LinkInDb;
   EFI_SMM_SW_CONTEXT                    SwSmiCommBuffer;
   UINTN                                 SwSmiCommBufferSize;
+  UINT64                                StartTsc;
 
   SwSmiCommBufferSize      = sizeof (EFI_SMM_SW_CONTEXT);
   //
@@ -333,7 +336,9 @@ PchSwSmiDispatcher (
     while (!IsNull (&mSwSmiCallbackDataBase, LinkInDb)) {
       SwSmiRecord = SW_SMI_RECORD_FROM_LINK (LinkInDb);
       if (SwSmiRecord->Context.SwSmiInputValue == SmiIoInfo.IoData) {
+        StartTsc = AsmReadTsc ();
         SwSmiRecord->Callback ((EFI_HANDLE) &SwSmiRecord->Link, &SwSmiRecord->Context, &SwSmiCommBuffer, &SwSmiCommBufferSize);
+        PchSmmUpdateHandlerStats (&SwSmiRecord->Stats, StartTsc);
       }
       LinkInDb = GetNextNode (&mSwSmiCallbackDataBase, &SwSmiRecord->Link);
     }
@@ -342,6 +347,35 @@ PchSwSmiDispatcher (
   return EFI_SUCCESS;
 }
 
+/**
+  Walk the statistics of the software SMI handlers.
+
+  @param[in]      Visitor               The function called for every handler
+  @param[in, out] VisitorContext        The context passed to Visitor
+**/
+VOID
+PchSwSmiVisitHandlerStats (
+  IN     PCH_SMM_HANDLER_STATS_VISITOR  Visitor,
+  IN OUT VOID                           *VisitorContext
+  )
+{
+  SW_SMI_RECORD                         *SwSmiRecord;
+  LIST_ENTRY                            *LinkInDb;
+
+  LinkInDb = GetFirstNode (&mSwSmiCallbackDataBase);
+  while (!IsNull (&mSwSmiCallbackDataBase, LinkInDb)) {
+    SwSmiRecord = SW_SMI_RECORD_FROM_LINK (LinkInDb);
+    Visitor (
+      &gEfiSmmSwDispatch2ProtocolGuid,
+      (UINT64) (UINTN) SwSmiRecord->Callback,
+      SwSmiRecord->Context.SwSmiInputValue,
+      &SwSmiRecord->Stats,
+      VisitorContext
+      );
+    LinkInDb = GetNextNode (&mSwSmiCallbackDataBase, &SwSmiRecord->Link);
+  }
+}
+
 /**
   Init required protocol for Pch Sw Dispatch protocol.
 **/
@@ -624,14 +624,32 @@ InitializedProcessorMicrocodeIndex (
   IN MICROCODE_FMP_PRIVATE_DATA *MicrocodeFmpPrivate
   )
 {
-  UINTN       CpuIndex;
-  UINTN       MicrocodeIndex;
-  UINTN       TargetCpuIndex;
-  UINT32      AttemptStatus;
-  EFI_STATUS  Status;
+  UINTN           CpuIndex;
+  UINTN           MicrocodeIndex;
+  UINTN           TargetCpuIndex;
+  UINT32          AttemptStatus;
+  EFI_STATUS      Status;
+  PROCESSOR_INFO  *ProcessorInfo;
+  UINTN           Index;
 
+  ProcessorInfo = MicrocodeFmpPrivate->ProcessorInfo;
   for (CpuIndex = 0; CpuIndex < MicrocodeFmpPrivate->ProcessorCount; CpuIndex++) {
-    if (MicrocodeFmpPrivate->ProcessorInfo[CpuIndex].MicrocodeIndex != (UINTN)-1) {
+    if (ProcessorInfo[CpuIndex].MicrocodeIndex != (UINTN)-1) {
+      continue;
+    }
+    //
+    // Processors with the same signature, platform ID and revision match the
+    // same microcode, so only verify the whole region for the first of them.
+    //
+    for (Index = 0; Index < CpuIndex; Index++) {
+      if ((ProcessorInfo[Index].ProcessorSignature == ProcessorInfo[CpuIndex].ProcessorSignature) &&
+          (ProcessorInfo[Index].PlatformId == ProcessorInfo[CpuIndex].PlatformId) &&
+          (ProcessorInfo[Index].MicrocodeRevision == ProcessorInfo[CpuIndex].MicrocodeRevision)) {
+        break;
+      }
+    }
+    if (Index < CpuIndex) {
+      ProcessorInfo[CpuIndex].MicrocodeIndex = ProcessorInfo[Index].MicrocodeIndex;
       continue;
     }
     for (MicrocodeIndex = 0; MicrocodeIndex < MicrocodeFmpPrivate->DescriptorCount; MicrocodeIndex++) {
@@ -649,7 +667,7 @@ InitializedProcessorMicrocodeIndex (
                  &TargetCpuIndex
                  );
       if (!EFI_ERROR(Status)) {
-        MicrocodeFmpPrivate->ProcessorInfo[CpuIndex].MicrocodeIndex = MicrocodeIndex;
+        ProcessorInfo[CpuIndex].MicrocodeIndex = MicrocodeIndex;
       }
     }
   }
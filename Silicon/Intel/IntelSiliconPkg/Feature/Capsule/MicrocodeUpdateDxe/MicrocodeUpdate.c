@@ -783,6 +783,31 @@ UpdateMicrocode (
   )
 {
   EFI_STATUS  Status;
+  UINT8       *Buffer;
+  UINT8       *Flash;
+
+  //
+  // The flash region is memory mapped, only write the range that differs
+  // from its current content. Rewriting the rest of the region after a
+  // reorg leaves most of it unchanged.
+  //
+  Buffer = Image;
+  Flash  = (UINT8 *)(UINTN)Address;
+  while ((ImageSize > 0) && (*Buffer == *Flash)) {
+    Buffer++;
+    Flash++;
+    ImageSize--;
+  }
+  while ((ImageSize > 0) && (Buffer[ImageSize - 1] == Flash[ImageSize - 1])) {
+    ImageSize--;
+  }
+  if (ImageSize == 0) {
+    DEBUG((DEBUG_INFO, "PlatformUpdate: flash content unchanged\n"));
+    *LastAttemptStatus = LAST_ATTEMPT_STATUS_SUCCESS;
+    return EFI_SUCCESS;
+  }
+  Address = (UINTN)Flash;
+  Image   = Buffer;
 
   DEBUG((DEBUG_INFO, "PlatformUpdate:"));
   DEBUG((DEBUG_INFO, "  Address - 0x%lx,", Address));
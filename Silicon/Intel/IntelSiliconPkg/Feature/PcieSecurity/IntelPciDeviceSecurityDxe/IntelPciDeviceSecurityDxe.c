@@ -301,15 +301,19 @@ TcgAlgIdToSpdmHashAlgo (
   This function extend the PCI digest from the DvSec register.
 
   @param[in]  PciIo                  The PciIo of the device.
+  @param[in]  PciData                The PCI configuration header of the device.
   @param[in]  DeviceSecurityPolicy   The Device Security Policy associated with the device.
   @param[in]  TcgAlgId               TCG hash Algorithm ID
   @param[in]  DigestSel              The digest selector
   @param[in]  Digest                 The digest buffer
   @param[out] DeviceSecurityState    The Device Security state associated with the device.
+
+  @return The status of the TPM measurement.
 **/
-VOID
+EFI_STATUS
 ExtendDigestRegister (
   IN EFI_PCI_IO_PROTOCOL          *PciIo,
+  IN PCI_TYPE00                   *PciData,
   IN EDKII_DEVICE_SECURITY_POLICY *DeviceSecurityPolicy,
   IN UINT16                       TcgAlgId,
   IN UINT8                        DigestSel,
@@ -321,10 +325,6 @@ ExtendDigestRegister (
   UINT32                                                   EventType;
   EDKII_DEVICE_SECURITY_PCI_EVENT_DATA                     EventLog;
   EFI_STATUS                                               Status;
-  PCI_TYPE00                                               PciData;
-
-  Status = PciIo->Pci.Read (PciIo, EfiPciIoWidthUint8, 0, sizeof(PciData), &PciData);
-  ASSERT_EFI_ERROR(Status);
 
   //
   // Use PCR 2 for Firmware Blob code.
@@ -347,15 +347,15 @@ ExtendDigestRegister (
 
   EventLog.PciContext.Version           = TCG_DEVICE_SECURITY_EVENT_DATA_PCI_CONTEXT_VERSION;
   EventLog.PciContext.Length            = sizeof(TCG_DEVICE_SECURITY_EVENT_DATA_PCI_CONTEXT);
-  EventLog.PciContext.VendorId          = PciData.Hdr.VendorId;
-  EventLog.PciContext.DeviceId          = PciData.Hdr.DeviceId;
-  EventLog.PciContext.RevisionID        = PciData.Hdr.RevisionID;
-  EventLog.PciContext.ClassCode[0]      = PciData.Hdr.ClassCode[0];
-  EventLog.PciContext.ClassCode[1]      = PciData.Hdr.ClassCode[1];
-  EventLog.PciContext.ClassCode[2]      = PciData.Hdr.ClassCode[2];
-  if ((PciData.Hdr.HeaderType & HEADER_LAYOUT_CODE) == HEADER_TYPE_DEVICE) {
-    EventLog.PciContext.SubsystemVendorID = PciData.Device.SubsystemVendorID;
-    EventLog.PciContext.SubsystemID       = PciData.Device.SubsystemID;
+  EventLog.PciContext.VendorId          = PciData->Hdr.VendorId;
+  EventLog.PciContext.DeviceId          = PciData->Hdr.DeviceId;
+  EventLog.PciContext.RevisionID        = PciData->Hdr.RevisionID;
+  EventLog.PciContext.ClassCode[0]      = PciData->Hdr.ClassCode[0];
+  EventLog.PciContext.ClassCode[1]      = PciData->Hdr.ClassCode[1];
+  EventLog.PciContext.ClassCode[2]      = PciData->Hdr.ClassCode[2];
+  if ((PciData->Hdr.HeaderType & HEADER_LAYOUT_CODE) == HEADER_TYPE_DEVICE) {
+    EventLog.PciContext.SubsystemVendorID = PciData->Device.SubsystemVendorID;
+    EventLog.PciContext.SubsystemID       = PciData->Device.SubsystemID;
   } else {
     EventLog.PciContext.SubsystemVendorID = 0;
     EventLog.PciContext.SubsystemID       = 0;
@@ -372,9 +372,9 @@ ExtendDigestRegister (
   DEBUG((DEBUG_INFO, "TpmMeasureAndLogData - %r\n", Status));
   if (EFI_ERROR(Status)) {
     DeviceSecurityState->MeasurementState = EDKII_DEVICE_SECURITY_STATE_ERROR_TCG_EXTEND_TPM_PCR;
-  } else {
-    RecordPciDeviceInList (PciIo, &mSecurityEventMeasurementDeviceList);
   }
+
+  return Status;
 }
 
 /**
@@ -400,6 +400,10 @@ DoMeasurementsFromDigestRegister (
   UINT8                                     DigestSel;
   UINT8                                     Digest[SHA256_DIGEST_SIZE];
   UINTN                                     DigestSize;
+  UINT32                                    DigestOffset;
+  EFI_PCI_IO_PROTOCOL_WIDTH                 DigestWidth;
+  PCI_TYPE00                                PciData;
+  BOOLEAN                                   Extended;
   EFI_STATUS                                Status;
 
   TcgAlgId = DvSecPciRead8 (
@@ -437,6 +441,15 @@ DoMeasurementsFromDigestRegister (
     NumDigest = 2;
   }
 
+  //
+  // Configuration space accesses are slow, so the PCI header used for the
+  // event log is read once for all the digests, and the digests themselves
+  // are read with DWORD accesses where they are DWORD aligned.
+  //
+  Status = PciIo->Pci.Read (PciIo, EfiPciIoWidthUint32, 0, sizeof(PciData) / sizeof(UINT32), &PciData);
+  ASSERT_EFI_ERROR(Status);
+
+  Extended = FALSE;
   for (DigestSel = 0; DigestSel < NumDigest; DigestSel++) {
     DEBUG((DEBUG_INFO, "  DigestSel     - 0x%02x\n", DigestSel));
     if ((DigestSel == 0) && ((Valid & INTEL_PCI_DIGEST_0_VALID) == 0)) {
@@ -445,6 +458,12 @@ DoMeasurementsFromDigestRegister (
     if ((DigestSel == 1) && ((Valid & INTEL_PCI_DIGEST_1_VALID) == 0)) {
       continue;
     }
+    DigestOffset = (UINT32)(DvSecOffset + sizeof(INTEL_PCI_DIGEST_CAPABILITY_HEADER) + sizeof(INTEL_PCI_DIGEST_CAPABILITY_STRUCTURE) + DigestSize * DigestSel);
+    if (((DigestOffset | DigestSize) & (sizeof(UINT32) - 1)) == 0) {
+      DigestWidth = EfiPciIoWidthUint32;
+    } else {
+      DigestWidth = EfiPciIoWidthUint8;
+    }
     while (TRUE) {
       //
       // Host MUST clear DIGEST_MODIFIED before read DIGEST.
@@ -457,9 +476,9 @@ DoMeasurementsFromDigestRegister (
 
       Status = PciIo->Pci.Read (
                             PciIo,
-                            EfiPciIoWidthUint8,
-                            (UINT32)(DvSecOffset + sizeof(INTEL_PCI_DIGEST_CAPABILITY_HEADER) + sizeof(INTEL_PCI_DIGEST_CAPABILITY_STRUCTURE) + DigestSize * DigestSel),
-                            DigestSize,
+                            DigestWidth,
+                            DigestOffset,
+                            (DigestWidth == EfiPciIoWidthUint32) ? DigestSize / sizeof(UINT32) : DigestSize,
                             Digest
                             );
       ASSERT_EFI_ERROR(Status);
@@ -489,7 +508,14 @@ DoMeasurementsFromDigestRegister (
     }
 
     DEBUG((DEBUG_INFO, "ExtendDigestRegister...\n", ExtendDigestRegister));
-    ExtendDigestRegister (PciIo, DeviceSecurityPolicy, TcgAlgId, DigestSel, Digest, DeviceSecurityState);
+    Status = ExtendDigestRegister (PciIo, &PciData, DeviceSecurityPolicy, TcgAlgId, DigestSel, Digest, DeviceSecurityState);
+    if (!EFI_ERROR(Status)) {
+      Extended = TRUE;
+    }
+  }
+
+  if (Extended) {
+    RecordPciDeviceInList (PciIo, &mSecurityEventMeasurementDeviceList);
   }
 }
 
@@ -25,6 +25,14 @@ typedef struct {
   UINTN    Size;
 } MICROCODE_PATCH_INFO;
 
+//
+// Processor signature and the mask of the platform IDs present with it
+//
+typedef struct {
+  UINT32   ProcessorSignature;
+  UINT32   PlatformIdMask;
+} MICROCODE_CPU_SIGNATURE;
+
 /**
   Shadow microcode update patches to memory.
 
@@ -71,11 +79,58 @@ EFI_PEI_PPI_DESCRIPTOR           mPeiShadowMicrocodePpiList[] = {
 };
 
 /**
-  Determine if a microcode patch matchs the specific processor signature and flag.
+  Collect the distinct processor signatures of the MicrocodeCpuId array.
+
+  Every processor of the system has an element in MicrocodeCpuId, most of
+  them identical. The signatures are sorted so that each microcode patch is
+  matched with a binary search.
 
   @param[in]  CpuIdCount            Number of elements in MicrocodeCpuId array.
   @param[in]  MicrocodeCpuId        A pointer to an array of EDKII_PEI_MICROCODE_CPU_ID
                                     structures.
+  @param[out] Signatures            Array of at least CpuIdCount elements to
+                                    receive the sorted signatures.
+
+  @return The number of distinct signatures.
+**/
+UINTN
+CollectProcessorSignatures (
+  IN  UINTN                           CpuIdCount,
+  IN  EDKII_PEI_MICROCODE_CPU_ID      *MicrocodeCpuId,
+  OUT MICROCODE_CPU_SIGNATURE         *Signatures
+  )
+{
+  UINTN          Index;
+  UINTN          Count;
+  UINTN          Position;
+  UINT32         Signature;
+
+  Count = 0;
+  for (Index = 0; Index < CpuIdCount; Index++) {
+    Signature = MicrocodeCpuId[Index].ProcessorSignature;
+    for (Position = Count; Position > 0; Position--) {
+      if (Signatures[Position - 1].ProcessorSignature <= Signature) {
+        break;
+      }
+    }
+    if (Position == 0 || Signatures[Position - 1].ProcessorSignature != Signature) {
+      CopyMem (&Signatures[Position + 1], &Signatures[Position], (Count - Position) * sizeof (MICROCODE_CPU_SIGNATURE));
+      Signatures[Position].ProcessorSignature = Signature;
+      Signatures[Position].PlatformIdMask     = 0;
+      Count++;
+      Position++;
+    }
+    Signatures[Position - 1].PlatformIdMask |= (UINT32) (1 << MicrocodeCpuId[Index].PlatformId);
+  }
+
+  return Count;
+}
+
+/**
+  Determine if a microcode patch matchs the specific processor signature and flag.
+
+  @param[in]  SignatureCount        Number of elements in Signatures array.
+  @param[in]  Signatures            The sorted processor signatures of the system.
   @param[in]  ProcessorSignature    The processor signature field value
                                     supported by a microcode patch.
   @param[in]  ProcessorFlags        The prcessor flags field value supported by
@@ -86,18 +141,27 @@ EFI_PEI_PPI_DESCRIPTOR           mPeiShadowMicrocodePpiList[] = {
 **/
 BOOLEAN
 IsProcessorMatchedMicrocodePatch (
-  IN  UINTN                           CpuIdCount,
-  IN  EDKII_PEI_MICROCODE_CPU_ID      *MicrocodeCpuId,
+  IN  UINTN                           SignatureCount,
+  IN  MICROCODE_CPU_SIGNATURE         *Signatures,
   IN UINT32                           ProcessorSignature,
   IN UINT32                           ProcessorFlags
   )
 {
-  UINTN          Index;
-
-  for (Index = 0; Index < CpuIdCount; Index++) {
-    if ((ProcessorSignature == MicrocodeCpuId[Index].ProcessorSignature) &&
-        (ProcessorFlags & (1 << MicrocodeCpuId[Index].PlatformId)) != 0) {
-      return TRUE;
+  UINTN          Low;
+  UINTN          High;
+  UINTN          Middle;
+
+  Low  = 0;
+  High = SignatureCount;
+  while (Low < High) {
+    Middle = (Low + High) / 2;
+    if (Signatures[Middle].ProcessorSignature == ProcessorSignature) {
+      return (BOOLEAN) ((ProcessorFlags & Signatures[Middle].PlatformIdMask) != 0);
+    }
+    if (Signatures[Middle].ProcessorSignature < ProcessorSignature) {
+      Low = Middle + 1;
+    } else {
+      High = Middle;
     }
   }
 
@@ -109,9 +173,8 @@ IsProcessorMatchedMicrocodePatch (
   patch header with the CPUID and PlatformID of the processors within
   system to decide if it will be copied into memory.
 
-  @param[in]  CpuIdCount            Number of elements in MicrocodeCpuId array.
-  @param[in]  MicrocodeCpuId        A pointer to an array of EDKII_PEI_MICROCODE_CPU_ID
-                                    structures.
+  @param[in]  SignatureCount        Number of elements in Signatures array.
+  @param[in]  Signatures            The sorted processor signatures of the system.
   @param[in]  MicrocodeEntryPoint   The pointer to the microcode patch header.
 
   @retval TRUE     The specified microcode patch need to be loaded.
@@ -119,8 +182,8 @@ IsProcessorMatchedMicrocodePatch (
 **/
 BOOLEAN
 IsMicrocodePatchNeedLoad (
-  IN  UINTN                         CpuIdCount,
-  IN  EDKII_PEI_MICROCODE_CPU_ID    *MicrocodeCpuId,
+  IN  UINTN                         SignatureCount,
+  IN  MICROCODE_CPU_SIGNATURE       *Signatures,
   CPU_MICROCODE_HEADER              *MicrocodeEntryPoint
   )
 {
@@ -136,8 +199,8 @@ IsMicrocodePatchNeedLoad (
   // Check the 'ProcessorSignature' and 'ProcessorFlags' in microcode patch header.
   //
   NeedLoad = IsProcessorMatchedMicrocodePatch (
-               CpuIdCount,
-               MicrocodeCpuId,
+               SignatureCount,
+               Signatures,
                MicrocodeEntryPoint->ProcessorSignature.Uint32,
                MicrocodeEntryPoint->ProcessorFlags
                );
@@ -163,8 +226,8 @@ IsMicrocodePatchNeedLoad (
       // within system to decide if it will be copied into memory
       //
       NeedLoad = IsProcessorMatchedMicrocodePatch (
-                   CpuIdCount,
-                   MicrocodeCpuId,
+                   SignatureCount,
+                   Signatures,
                    ExtendedTable->ProcessorSignature.Uint32,
                    ExtendedTable->ProcessorFlag
                    );
@@ -202,6 +265,8 @@ ShadowMicrocodePatchWorker (
   )
 {
   UINTN                                     Index;
+  UINTN                                     RunEnd;
+  UINTN                                     RunSize;
   VOID                                      *MicrocodePatchInRam;
   UINT8                                     *Walker;
   EDKII_MICROCODE_SHADOW_INFO_HOB           *MicrocodeShadowHob;
@@ -239,17 +304,27 @@ ShadowMicrocodePatchWorker (
   }
 
   //
-  // Shadow all the required microcode patches into memory
+  // Shadow all the required microcode patches into memory. Patches which are
+  // adjacent in flash are copied with a single read.
   //
-  for (Walker = MicrocodePatchInRam, Index = 0; Index < PatchCount; Index++) {
+  for (Walker = MicrocodePatchInRam, Index = 0; Index < PatchCount; ) {
+    RunSize = Patches[Index].Size;
+    for (RunEnd = Index + 1; RunEnd < PatchCount; RunEnd++) {
+      if (Patches[RunEnd].Address != Patches[RunEnd - 1].Address + Patches[RunEnd - 1].Size) {
+        break;
+      }
+      RunSize += Patches[RunEnd].Size;
+    }
     CopyMem (
       Walker,
       (VOID *) Patches[Index].Address,
-      Patches[Index].Size
+      RunSize
       );
-    MicrocodeAddressInMemory[Index] = (UINT64) (UINTN) Walker;
-    Flashcontext->MicrocodeAddressInFlash[Index]  = (UINT64) Patches[Index].Address;
-    Walker += Patches[Index].Size;
+    for (; Index < RunEnd; Index++) {
+      MicrocodeAddressInMemory[Index] = (UINT64) (UINTN) Walker;
+      Flashcontext->MicrocodeAddressInFlash[Index]  = (UINT64) Patches[Index].Address;
+      Walker += Patches[Index].Size;
+    }
   }
 
   //
@@ -391,6 +466,8 @@ ShadowMicrocode (
   UINT32                            EntryNum;
   UINT32                            Index;
   MICROCODE_PATCH_INFO              *PatchInfoBuffer;
+  MICROCODE_CPU_SIGNATURE           *Signatures;
+  UINTN                             SignatureCount;
   UINTN                             MaxPatchNumber;
   CPU_MICROCODE_HEADER              *MicrocodeEntryPoint;
   UINTN                             PatchCount;
@@ -425,8 +502,19 @@ ShadowMicrocode (
     return EFI_NOT_FOUND;
   }
 
+  if (CpuIdCount == 0) {
+    return EFI_SUCCESS;
+  }
+
+  Signatures = AllocatePool (CpuIdCount * sizeof (MICROCODE_CPU_SIGNATURE));
+  if (Signatures == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  SignatureCount = CollectProcessorSignatures (CpuIdCount, MicrocodeCpuId, Signatures);
+
   PatchInfoBuffer = AllocatePool (MaxPatchNumber * sizeof (MICROCODE_PATCH_INFO));
   if (PatchInfoBuffer == NULL) {
+    FreePool (Signatures);
     return EFI_OUT_OF_RESOURCES;
   }
 
@@ -439,7 +527,7 @@ ShadowMicrocode (
     if (FitEntry[Index].Type == FIT_TYPE_01_MICROCODE) {
       MicrocodeEntryPoint = (CPU_MICROCODE_HEADER *) (UINTN) FitEntry[Index].Address;
       TotalSize = (MicrocodeEntryPoint->DataSize == 0) ? 2048 : MicrocodeEntryPoint->TotalSize;
-      if (IsMicrocodePatchNeedLoad (CpuIdCount, MicrocodeCpuId, MicrocodeEntryPoint)) {
+      if (IsMicrocodePatchNeedLoad (SignatureCount, Signatures, MicrocodeEntryPoint)) {
         PatchInfoBuffer[PatchCount].Address     = (UINTN) MicrocodeEntryPoint;
         PatchInfoBuffer[PatchCount].Size        = TotalSize;
         TotalLoadSize += TotalSize;
@@ -459,6 +547,7 @@ ShadowMicrocode (
   }
 
   FreePool (PatchInfoBuffer);
+  FreePool (Signatures);
   return EFI_SUCCESS;
 }
 
@@ -34,7 +34,58 @@ typedef struct {
 } MAP_INFO;
 #define MAP_INFO_FROM_LINK(a) CR (a, MAP_INFO, Link, MAP_INFO_SIGNATURE)
 
-LIST_ENTRY                        gMaps = INITIALIZE_LIST_HEAD_VARIABLE(gMaps);
+//
+// The MAP_INFO are hashed by the page number of DeviceAddress, so that the
+// lookups don't walk every active mapping.
+//
+#define MAP_INFO_BUCKET_COUNT      256
+#define MAP_INFO_BUCKET(Address)   (&gMaps[(UINTN)RShiftU64 ((Address), EFI_PAGE_SHIFT) & (MAP_INFO_BUCKET_COUNT - 1)])
+
+LIST_ENTRY                        gMaps[MAP_INFO_BUCKET_COUNT];
+
+/**
+  Initialize the hash table of the MAP_INFO.
+**/
+VOID
+InitializeMapInfoTable (
+  VOID
+  )
+{
+  UINTN                    Index;
+
+  for (Index = 0; Index < MAP_INFO_BUCKET_COUNT; Index++) {
+    InitializeListHead (&gMaps[Index]);
+  }
+}
+
+/**
+  Find the MAP_INFO of a mapping.
+
+  The caller must hold VTD_TPL_LEVEL.
+
+  @param[in]  Mapping       The mapping value returned from Map().
+
+  @return The MAP_INFO, NULL if Mapping is not an active mapping.
+**/
+MAP_INFO *
+FindMapInfo (
+  IN VOID                  *Mapping
+  )
+{
+  LIST_ENTRY               *Bucket;
+  LIST_ENTRY               *Link;
+
+  Bucket = MAP_INFO_BUCKET (((MAP_INFO *)Mapping)->DeviceAddress);
+  for (Link = GetFirstNode (Bucket)
+       ; !IsNull (Bucket, Link)
+       ; Link = GetNextNode (Bucket, Link)
+       ) {
+    if (MAP_INFO_FROM_LINK (Link) == Mapping) {
+      return Mapping;
+    }
+  }
+  return NULL;
+}
 
 /**
   This function fills DeviceHandle/IoMmuAccess to the MAP_HANDLE_INFO,
@@ -56,6 +107,7 @@ SyncDeviceHandleToMapInfo (
 {
   MAP_INFO                 *MapInfo;
   MAP_HANDLE_INFO          *MapHandleInfo;
+  LIST_ENTRY               *Bucket;
   LIST_ENTRY               *Link;
   EFI_TPL                  OriginalTpl;
 
@@ -64,9 +116,10 @@ SyncDeviceHandleToMapInfo (
   //
   OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
   MapInfo = NULL;
-  for (Link = GetFirstNode (&gMaps)
-       ; !IsNull (&gMaps, Link)
-       ; Link = GetNextNode (&gMaps, Link)
+  Bucket = MAP_INFO_BUCKET (DeviceAddress);
+  for (Link = GetFirstNode (Bucket)
+       ; !IsNull (Bucket, Link)
+       ; Link = GetNextNode (Bucket, Link)
        ) {
     MapInfo = MAP_INFO_FROM_LINK (Link);
     if (MapInfo->DeviceAddress == DeviceAddress) {
@@ -280,7 +333,7 @@ IoMmuMap (
   }
 
   OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
-  InsertTailList (&gMaps, &MapInfo->Link);
+  InsertTailList (MAP_INFO_BUCKET (MapInfo->DeviceAddress), &MapInfo->Link);
   gBS->RestoreTPL (OriginalTpl);
 
   //
@@ -316,7 +369,6 @@ IoMmuUnmap (
 {
   MAP_INFO                 *MapInfo;
   MAP_HANDLE_INFO          *MapHandleInfo;
-  LIST_ENTRY               *Link;
   EFI_TPL                  OriginalTpl;
 
   DEBUG ((DEBUG_VERBOSE, "IoMmuUnmap: 0x%08x\n", Mapping));
@@ -327,20 +379,11 @@ IoMmuUnmap (
   }
 
   OriginalTpl = gBS->RaiseTPL (VTD_TPL_LEVEL);
-  MapInfo = NULL;
-  for (Link = GetFirstNode (&gMaps)
-       ; !IsNull (&gMaps, Link)
-       ; Link = GetNextNode (&gMaps, Link)
-       ) {
-    MapInfo = MAP_INFO_FROM_LINK (Link);
-    if (MapInfo == Mapping) {
-      break;
-    }
-  }
+  MapInfo = FindMapInfo (Mapping);
   //
   // Mapping is not a valid value returned by Map()
   //
-  if (MapInfo != Mapping) {
+  if (MapInfo == NULL) {
     gBS->RestoreTPL (OriginalTpl);
     DEBUG ((DEBUG_ERROR, "IoMmuUnmap: %r\n", EFI_INVALID_PARAMETER));
     return EFI_INVALID_PARAMETER;
@@ -508,26 +551,16 @@ GetDeviceInfoFromMapping (
   )
 {
   MAP_INFO                 *MapInfo;
-  LIST_ENTRY               *Link;
 
   if (Mapping == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
-  MapInfo = NULL;
-  for (Link = GetFirstNode (&gMaps)
-       ; !IsNull (&gMaps, Link)
-       ; Link = GetNextNode (&gMaps, Link)
-       ) {
-    MapInfo = MAP_INFO_FROM_LINK (Link);
-    if (MapInfo == Mapping) {
-      break;
-    }
-  }
+  MapInfo = FindMapInfo (Mapping);
   //
   // Mapping is not a valid value returned by Map()
   //
-  if (MapInfo != Mapping) {
+  if (MapInfo == NULL) {
     return EFI_INVALID_PARAMETER;
   }
 
@@ -57,13 +57,24 @@ typedef struct {
   EDKII_PLATFORM_VTD_PCI_DEVICE_ID PciDeviceId;
   // for statistic analysis
   UINTN                            AccessCount;
+  // index + 1 of the next PCI data in the same hash bucket, 0 for none
+  UINTN                            HashNext;
 } PCI_DEVICE_DATA;
 
+//
+// Number of hash buckets of the PCI data of a VTd engine, a power of 2
+//
+#define VTD_PCI_DATA_HASH_SIZE  64
+#define VTD_PCI_DATA_HASH(SourceId) \
+  ((((SourceId).Uint16 >> 6) ^ (SourceId).Uint16) & (VTD_PCI_DATA_HASH_SIZE - 1))
+
 typedef struct {
   BOOLEAN                          IncludeAllFlag;
   UINTN                            PciDeviceDataNumber;
   UINTN                            PciDeviceDataMaxNumber;
   PCI_DEVICE_DATA                  *PciDeviceData;
+  // index + 1 of the first PCI data of each hash bucket, 0 for none
+  UINTN                            PciDeviceDataHash[VTD_PCI_DATA_HASH_SIZE];
 } PCI_DEVICE_INFORMATION;
 
 typedef struct {
@@ -198,6 +209,41 @@ InvalidateIOTLB (
   IN UINTN  VtdIndex
   );
 
+/**
+  Invalidate the VTd IOTLB entries of a memory range in one domain.
+
+  @param[in]  VtdIndex          The index used to identify a VTd engine.
+  @param[in]  DomainIdentifier  The domain ID of the range.
+  @param[in]  BaseAddress       The base of the range, 4KB aligned.
+  @param[in]  Length            The length of the range, not 0.
+**/
+EFI_STATUS
+InvalidateIOTLBPage (
+  IN UINTN   VtdIndex,
+  IN UINT16  DomainIdentifier,
+  IN UINT64  BaseAddress,
+  IN UINT64  Length
+  );
+
+/**
+  Invalidate the VTd IOTLB entries of a memory range whose page table was modified.
+
+  @param[in]  VtdIndex          The index of VTd engine.
+  @param[in]  DomainIdentifier  The domain ID of the range.
+  @param[in]  BaseAddress       The base of the range, 4KB aligned.
+  @param[in]  Length            The length of the range, not 0.
+
+  @retval EFI_SUCCESS           VTd IOTLB is invalidated.
+  @retval EFI_DEVICE_ERROR      VTd IOTLB is not invalidated.
+**/
+EFI_STATUS
+InvalidateVtdIOTLBRange (
+  IN UINTN   VtdIndex,
+  IN UINT16  DomainIdentifier,
+  IN UINT64  BaseAddress,
+  IN UINT64  Length
+  );
+
 /**
   Invalid VTd global IOTLB.
 
@@ -525,6 +571,14 @@ DeviceHandleToSourceId (
   OUT VTD_SOURCE_ID        *SourceId
   );
 
+/**
+  Initialize the hash table of the MAP_INFO.
+**/
+VOID
+InitializeMapInfoTable (
+  VOID
+  );
+
 /**
   Get device information from mapping.
 
@@ -386,6 +386,7 @@ IntelVTdInitialize (
     return EFI_UNSUPPORTED;
   }
 
+  InitializeMapInfoTable ();
   InitializeDmaProtection ();
 
   Handle = NULL;
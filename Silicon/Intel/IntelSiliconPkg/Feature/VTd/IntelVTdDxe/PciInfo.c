@@ -24,20 +24,28 @@ GetPciDataIndex (
   IN VTD_SOURCE_ID  SourceId
   )
 {
-  UINTN          Index;
-  VTD_SOURCE_ID  *PciSourceId;
+  UINTN                   Index;
+  VTD_SOURCE_ID           *PciSourceId;
+  PCI_DEVICE_INFORMATION  *PciDeviceInfo;
 
   if (Segment != mVtdUnitInformation[VtdIndex].Segment) {
     return (UINTN)-1;
   }
 
-  for (Index = 0; Index < mVtdUnitInformation[VtdIndex].PciDeviceInfo.PciDeviceDataNumber; Index++) {
-    PciSourceId = &mVtdUnitInformation[VtdIndex].PciDeviceInfo.PciDeviceData[Index].PciSourceId;
+  //
+  // This is called for every DMA mapping, walk the hash bucket of the source
+  // rather than all the PCI data of the engine.
+  //
+  PciDeviceInfo = &mVtdUnitInformation[VtdIndex].PciDeviceInfo;
+  Index = PciDeviceInfo->PciDeviceDataHash[VTD_PCI_DATA_HASH (SourceId)];
+  while (Index != 0) {
+    PciSourceId = &PciDeviceInfo->PciDeviceData[Index - 1].PciSourceId;
     if ((PciSourceId->Bits.Bus == SourceId.Bits.Bus) &&
         (PciSourceId->Bits.Device == SourceId.Bits.Device) &&
         (PciSourceId->Bits.Function == SourceId.Bits.Function) ) {
-      return Index;
+      return Index - 1;
     }
+    Index = PciDeviceInfo->PciDeviceData[Index - 1].HashNext;
   }
 
   return (UINTN)-1;
@@ -70,6 +78,7 @@ RegisterPciDevice (
   VTD_SOURCE_ID                    *PciSourceId;
   UINTN                            PciDataIndex;
   UINTN                            Index;
+  UINTN                            Bucket;
   PCI_DEVICE_DATA                  *NewPciDeviceData;
   EDKII_PLATFORM_VTD_PCI_DEVICE_ID *PciDeviceId;
 
@@ -138,6 +147,10 @@ RegisterPciDevice (
 
     PciDeviceInfo->PciDeviceData[PciDeviceInfo->PciDeviceDataNumber].DeviceType = DeviceType;
 
+    Bucket = VTD_PCI_DATA_HASH (SourceId);
+    PciDeviceInfo->PciDeviceData[PciDeviceInfo->PciDeviceDataNumber].HashNext = PciDeviceInfo->PciDeviceDataHash[Bucket];
+    PciDeviceInfo->PciDeviceDataHash[Bucket] = PciDeviceInfo->PciDeviceDataNumber + 1;
+
     if ((DeviceType != EFI_ACPI_DEVICE_SCOPE_ENTRY_TYPE_PCI_ENDPOINT) &&
         (DeviceType != EFI_ACPI_DEVICE_SCOPE_ENTRY_TYPE_PCI_BRIDGE)) {
       DEBUG ((DEBUG_INFO, " (*)"));
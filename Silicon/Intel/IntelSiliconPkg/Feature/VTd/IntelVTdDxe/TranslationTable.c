@@ -143,6 +143,9 @@ CreateContextEntry (
 /**
   Create second level paging entry table.
 
+  The range is mapped with 1GB pages where the VTd engine supports them and
+  with 2MB pages elsewhere.
+
   @param[in]  VtdIndex                    The index of the VTd engine.
   @param[in]  SecondLevelPagingEntry      The second level paging entry.
   @param[in]  MemoryBase                  The base of the memory.
@@ -172,6 +175,7 @@ CreateSecondLevelPagingEntryTable (
   VTD_SECOND_LEVEL_PAGING_ENTRY  *Lvl2PtEntry;
   UINT64                         BaseAddress;
   UINT64                         EndAddress;
+  BOOLEAN                        Page1GSupport;
 
   if (MemoryLimit == 0) {
     return EFI_SUCCESS;
@@ -197,6 +201,8 @@ CreateSecondLevelPagingEntryTable (
     return SecondLevelPagingEntry;
   }
 
+  Page1GSupport = (BOOLEAN)((mVtdUnitInformation[VtdIndex].CapReg.Bits.SLLPS & BIT1) != 0);
+
   Lvl4Start = RShiftU64 (BaseAddress, 39) & 0x1FF;
   Lvl4End = RShiftU64 (EndAddress - 1, 39) & 0x1FF;
 
@@ -225,6 +231,20 @@ CreateSecondLevelPagingEntryTable (
 
     Lvl3PtEntry = (VTD_SECOND_LEVEL_PAGING_ENTRY *)(UINTN)VTD_64BITS_ADDRESS(Lvl4PtEntry[Index4].Bits.AddressLo, Lvl4PtEntry[Index4].Bits.AddressHi);
     for (Index3 = Lvl3Start; Index3 <= Lvl3End; Index3++) {
+      if (Page1GSupport &&
+          (Lvl3PtEntry[Index3].Uint64 == 0) &&
+          ((BaseAddress & (SIZE_1GB - 1)) == 0) &&
+          (BaseAddress + SIZE_1GB <= EndAddress)) {
+        Lvl3PtEntry[Index3].Uint64 = BaseAddress;
+        SetSecondLevelPagingEntryAttribute (&Lvl3PtEntry[Index3], IoMmuAccess);
+        Lvl3PtEntry[Index3].Bits.PageSize = 1;
+        BaseAddress += SIZE_1GB;
+        if (BaseAddress >= MemoryLimit) {
+          break;
+        }
+        continue;
+      }
+
       if (Lvl3PtEntry[Index3].Uint64 == 0) {
         Lvl3PtEntry[Index3].Uint64 = (UINT64)(UINTN)AllocateZeroPages (1);
         if (Lvl3PtEntry[Index3].Uint64 == 0) {
@@ -401,7 +421,7 @@ DumpSecondLevelPagingEntry (
       if (Lvl3PtEntry[Index3].Uint64 != 0) {
         DEBUG ((DEBUG_VERBOSE,"    Lvl3Pt Entry(0x%03x) - 0x%016lx\n", Index3, Lvl3PtEntry[Index3].Uint64));
       }
-      if (Lvl3PtEntry[Index3].Uint64 == 0) {
+      if ((Lvl3PtEntry[Index3].Uint64 == 0) || (Lvl3PtEntry[Index3].Bits.PageSize != 0)) {
         continue;
       }
 
@@ -430,15 +450,27 @@ DumpSecondLevelPagingEntry (
 /**
   Invalid page entry.
 
-  @param VtdIndex  The VTd engine index.
+  A modified context entry needs the global invalidation. When only the page
+  table of the range was modified, the IOTLB entries of the range are
+  invalidated.
+
+  @param VtdIndex          The VTd engine index.
+  @param DomainIdentifier  The domain ID of the range.
+  @param BaseAddress       The base of the modified range.
+  @param Length            The length of the modified range.
 **/
 VOID
 InvalidatePageEntry (
-  IN UINTN                 VtdIndex
+  IN UINTN                 VtdIndex,
+  IN UINT16                DomainIdentifier,
+  IN UINT64                BaseAddress,
+  IN UINT64                Length
   )
 {
-  if (mVtdUnitInformation[VtdIndex].HasDirtyContext || mVtdUnitInformation[VtdIndex].HasDirtyPages) {
+  if (mVtdUnitInformation[VtdIndex].HasDirtyContext) {
     InvalidateVtdIOTLBGlobal (VtdIndex);
+  } else if (mVtdUnitInformation[VtdIndex].HasDirtyPages && (Length != 0)) {
+    InvalidateVtdIOTLBRange (VtdIndex, DomainIdentifier, BaseAddress, Length);
   }
   mVtdUnitInformation[VtdIndex].HasDirtyContext = FALSE;
   mVtdUnitInformation[VtdIndex].HasDirtyPages = FALSE;
@@ -965,11 +997,50 @@ SetAccessAttribute (
     }
   }
 
-  InvalidatePageEntry (VtdIndex);
+  InvalidatePageEntry (VtdIndex, DomainIdentifier, BaseAddress, Length);
 
   return EFI_SUCCESS;
 }
 
+/**
+  Find a fixed second level paging entry of another VTd engine which the
+  VTd engine can share.
+
+  The fixed table is an identity map of all the memory and is never
+  modified once built. It can be shared if it only uses page sizes the VTd
+  engine supports, and if it was written back to memory when the VTd engine
+  doesn't snoop the page walks.
+
+  @param[in]  VtdIndex  The index of the VTd engine.
+
+  @return The fixed second level paging entry, NULL if none can be shared.
+**/
+VTD_SECOND_LEVEL_PAGING_ENTRY *
+GetFixedSecondLevelPagingEntry (
+  IN UINTN  VtdIndex
+  )
+{
+  UINTN  Index;
+
+  for (Index = 0; Index < mVtdUnitNumber; Index++) {
+    if ((Index == VtdIndex) || (mVtdUnitInformation[Index].FixedSecondLevelPagingEntry == NULL)) {
+      continue;
+    }
+    if (((mVtdUnitInformation[Index].CapReg.Bits.SLLPS & BIT1) != 0) &&
+        ((mVtdUnitInformation[VtdIndex].CapReg.Bits.SLLPS & BIT1) == 0)) {
+      continue;
+    }
+    if ((mVtdUnitInformation[Index].ECapReg.Bits.C != 0) &&
+        (mVtdUnitInformation[VtdIndex].ECapReg.Bits.C == 0)) {
+      continue;
+    }
+    DEBUG ((DEBUG_INFO, "Share FixedSecondLevelPagingEntry of VTd %d with VTd %d\n", Index, VtdIndex));
+    return mVtdUnitInformation[Index].FixedSecondLevelPagingEntry;
+  }
+
+  return NULL;
+}
+
 /**
   Always enable the VTd page attribute for the device.
 
@@ -998,6 +1069,9 @@ AlwaysEnablePageAttribute (
     return EFI_DEVICE_ERROR;
   }
 
+  if (mVtdUnitInformation[VtdIndex].FixedSecondLevelPagingEntry == 0) {
+    mVtdUnitInformation[VtdIndex].FixedSecondLevelPagingEntry = GetFixedSecondLevelPagingEntry (VtdIndex);
+  }
   if (mVtdUnitInformation[VtdIndex].FixedSecondLevelPagingEntry == 0) {
     DEBUG((DEBUG_INFO, "CreateSecondLevelPagingEntry - %d\n", VtdIndex));
     mVtdUnitInformation[VtdIndex].FixedSecondLevelPagingEntry = CreateSecondLevelPagingEntry (VtdIndex, EDKII_IOMMU_ACCESS_READ | EDKII_IOMMU_ACCESS_WRITE);
@@ -112,6 +112,98 @@ InvalidateIOTLB (
   return EFI_SUCCESS;
 }
 
+/**
+  Invalidate the VTd IOTLB entries of a memory range in one domain.
+
+  A page-selective invalidation is used when the engine supports it and the
+  range fits in the maximum address mask, otherwise the whole domain is
+  invalidated.
+
+  @param[in]  VtdIndex          The index used to identify a VTd engine.
+  @param[in]  DomainIdentifier  The domain ID of the range.
+  @param[in]  BaseAddress       The base of the range, 4KB aligned.
+  @param[in]  Length            The length of the range, not 0.
+**/
+EFI_STATUS
+InvalidateIOTLBPage (
+  IN UINTN   VtdIndex,
+  IN UINT16  DomainIdentifier,
+  IN UINT64  BaseAddress,
+  IN UINT64  Length
+  )
+{
+  UINTN   IotlbBase;
+  UINT64  Reg64;
+  UINT64  FirstPage;
+  UINT64  LastPage;
+  UINTN   AddressMask;
+
+  IotlbBase = mVtdUnitInformation[VtdIndex].VtdUnitBaseAddress + (mVtdUnitInformation[VtdIndex].ECapReg.Bits.IRO * 16);
+
+  Reg64 = MmioRead64 (IotlbBase + R_IOTLB_REG);
+  if ((Reg64 & B_IOTLB_REG_IVT) != 0) {
+    DEBUG ((DEBUG_ERROR,"ERROR: InvalidateIOTLBPage: B_IOTLB_REG_IVT is set for VTD(%d)\n", VtdIndex));
+    return EFI_DEVICE_ERROR;
+  }
+
+  //
+  // The smallest naturally aligned block of 2^AddressMask pages which covers the range.
+  //
+  FirstPage = RShiftU64 (BaseAddress, 12);
+  LastPage = RShiftU64 (BaseAddress + Length - 1, 12);
+  for (AddressMask = 0; RShiftU64 (FirstPage, AddressMask) != RShiftU64 (LastPage, AddressMask); AddressMask++) {
+  }
+
+  Reg64 &= ((~B_IOTLB_REG_IVT) & (~B_IOTLB_REG_IIRG_MASK) & (~B_IOTLB_REG_DID_MASK));
+  Reg64 |= LShiftU64 (DomainIdentifier, N_IOTLB_REG_DID);
+  if ((mVtdUnitInformation[VtdIndex].CapReg.Bits.PSI != 0) && (AddressMask <= mVtdUnitInformation[VtdIndex].CapReg.Bits.MAMV)) {
+    MmioWrite64 (IotlbBase + R_IVA_REG, LShiftU64 (RShiftU64 (FirstPage, AddressMask), 12 + AddressMask) | AddressMask);
+    Reg64 |= (B_IOTLB_REG_IVT | V_IOTLB_REG_IIRG_PAGE);
+  } else {
+    Reg64 |= (B_IOTLB_REG_IVT | V_IOTLB_REG_IIRG_DOMAIN);
+  }
+  MmioWrite64 (IotlbBase + R_IOTLB_REG, Reg64);
+
+  do {
+    Reg64 = MmioRead64 (IotlbBase + R_IOTLB_REG);
+  } while ((Reg64 & B_IOTLB_REG_IVT) != 0);
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Invalidate the VTd IOTLB entries of a memory range whose page table was modified.
+
+  @param[in]  VtdIndex          The index of VTd engine.
+  @param[in]  DomainIdentifier  The domain ID of the range.
+  @param[in]  BaseAddress       The base of the range, 4KB aligned.
+  @param[in]  Length            The length of the range, not 0.
+
+  @retval EFI_SUCCESS           VTd IOTLB is invalidated.
+  @retval EFI_DEVICE_ERROR      VTd IOTLB is not invalidated.
+**/
+EFI_STATUS
+InvalidateVtdIOTLBRange (
+  IN UINTN   VtdIndex,
+  IN UINT16  DomainIdentifier,
+  IN UINT64  BaseAddress,
+  IN UINT64  Length
+  )
+{
+  if (!mVtdEnabled) {
+    return EFI_SUCCESS;
+  }
+
+  DEBUG((DEBUG_VERBOSE, "InvalidateVtdIOTLBRange(%d) (%d: 0x%016lx - 0x%016lx)\n", VtdIndex, DomainIdentifier, BaseAddress, Length));
+
+  //
+  // Write Buffer Flush before invalidation
+  //
+  FlushWriteBuffer (VtdIndex);
+
+  return InvalidateIOTLBPage (VtdIndex, DomainIdentifier, BaseAddress, Length);
+}
+
 /**
   Invalid VTd global IOTLB.
 
@@ -458,24 +458,26 @@ GetVTdEngineFromDevScopeEntry (
     switch (DmarHeader->Type) {
     case EFI_ACPI_DMAR_TYPE_DRHD:
       DmarDrhd = (EFI_ACPI_DMAR_DRHD_HEADER *)DmarHeader;
-      if (DmarDrhd->SegmentNumber != Segment) {
-        // Mismatch
-        break;
-      }
-      if ((DmarDrhd->Header.Length == sizeof(EFI_ACPI_DMAR_DRHD_HEADER)) ||
-          ((DmarDrhd->Flags & EFI_ACPI_DMAR_DRHD_FLAGS_INCLUDE_PCI_ALL) != 0)) {
-        // No DevScopeEntry
-        // Do not handle PCI_ALL
-        break;
-      }
-      ThisDevScopeEntry = (EFI_ACPI_DMAR_DEVICE_SCOPE_STRUCTURE_HEADER *)((UINTN)(DmarDrhd + 1));
-      while ((UINTN)ThisDevScopeEntry < (UINTN)DmarDrhd + DmarDrhd->Header.Length) {
-        if ((ThisDevScopeEntry->Length == DevScopeEntry->Length) &&
-            (CompareMem (ThisDevScopeEntry, DevScopeEntry, DevScopeEntry->Length) == 0)) {
-          return VtdIndex;
+      //
+      // Skip the mismatched segments and the DRHDs without DevScopeEntry.
+      // Do not handle PCI_ALL.
+      //
+      if ((DmarDrhd->SegmentNumber == Segment) &&
+          (DmarDrhd->Header.Length != sizeof(EFI_ACPI_DMAR_DRHD_HEADER)) &&
+          ((DmarDrhd->Flags & EFI_ACPI_DMAR_DRHD_FLAGS_INCLUDE_PCI_ALL) == 0)) {
+        ThisDevScopeEntry = (EFI_ACPI_DMAR_DEVICE_SCOPE_STRUCTURE_HEADER *)((UINTN)(DmarDrhd + 1));
+        while ((UINTN)ThisDevScopeEntry < (UINTN)DmarDrhd + DmarDrhd->Header.Length) {
+          if ((ThisDevScopeEntry->Length == DevScopeEntry->Length) &&
+              (CompareMem (ThisDevScopeEntry, DevScopeEntry, DevScopeEntry->Length) == 0)) {
+            return VtdIndex;
+          }
+          ThisDevScopeEntry = (EFI_ACPI_DMAR_DEVICE_SCOPE_STRUCTURE_HEADER *)((UINTN)ThisDevScopeEntry + ThisDevScopeEntry->Length);
         }
-        ThisDevScopeEntry = (EFI_ACPI_DMAR_DEVICE_SCOPE_STRUCTURE_HEADER *)((UINTN)ThisDevScopeEntry + ThisDevScopeEntry->Length);
       }
+      //
+      // The engine index counts every DRHD, as in ParseDmarAcpiTableDrhd ()
+      //
+      VtdIndex++;
       break;
     default:
       break;
@@ -237,6 +237,8 @@ typedef union {
 #define   V_IOTLB_REG_IIRG_GLOBAL BIT60
 #define   V_IOTLB_REG_IIRG_DOMAIN BIT61
 #define   V_IOTLB_REG_IIRG_PAGE   (BIT61|BIT60)
+#define   B_IOTLB_REG_DID_MASK    0x0000FFFF00000000ull
+#define   N_IOTLB_REG_DID         32
 #define   B_IOTLB_REG_IVT         BIT63
 
 #define R_FRCD_REG       0x00 // + FRO
@@ -116,19 +116,29 @@ GetConfigBlock (
   CONFIG_BLOCK_TABLE_HEADER *ConfigBlkTblAddrPtr;
   UINT32                    ConfigBlkTblHdrSize;
   UINT32                    ConfigBlkOffset;
+  UINT32                    ConfigBlkTblSize;
   UINT16                    NumOfBlocks;
+  UINT32                    GuidData1;
 
   ConfigBlkTblHdrSize = (UINT32)(sizeof (CONFIG_BLOCK_TABLE_HEADER));
   ConfigBlkTblAddrPtr = (CONFIG_BLOCK_TABLE_HEADER *)ConfigBlockTableAddress;
+  ConfigBlkTblSize = ConfigBlkTblAddrPtr->Header.GuidHob.Header.HobLength;
   NumOfBlocks = ConfigBlkTblAddrPtr->NumberOfBlocks;
 
+  //
+  // This is called for every policy consumer, so only do the full GUID
+  // comparison for the blocks whose first GUID field matches.
+  //
+  GuidData1 = ConfigBlockGuid->Data1;
+
   ConfigBlkOffset = 0;
   for (OffsetIndex = 0; OffsetIndex < NumOfBlocks; OffsetIndex++) {
-    if ((ConfigBlkTblHdrSize + ConfigBlkOffset) > (ConfigBlkTblAddrPtr->Header.GuidHob.Header.HobLength)) {
+    if ((ConfigBlkTblHdrSize + ConfigBlkOffset) > ConfigBlkTblSize) {
       break;
     }
     TempConfigBlk = (CONFIG_BLOCK *)((UINTN)ConfigBlkTblAddrPtr + (UINTN)ConfigBlkTblHdrSize + (UINTN)ConfigBlkOffset);
-    if (CompareGuid (&(TempConfigBlk->Header.GuidHob.Name), ConfigBlockGuid)) {
+    if ((TempConfigBlk->Header.GuidHob.Name.Data1 == GuidData1) &&
+        CompareGuid (&(TempConfigBlk->Header.GuidHob.Name), ConfigBlockGuid)) {
       *ConfigBlockAddress = (VOID *)TempConfigBlk;
       return EFI_SUCCESS;
     }
@@ -15,6 +15,7 @@
 #include <Uefi/UefiBaseType.h>
 #include <Uefi/UefiSpec.h>
 #include <Library/UefiBootServicesTableLib.h>
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/UefiLib.h>
 #include <Library/BaseMemoryLib.h>
@@ -28,6 +29,24 @@
 static EFI_ACPI_SDT_PROTOCOL      *mAcpiSdt = NULL;
 static EFI_ACPI_TABLE_PROTOCOL    *mAcpiTable = NULL;
 
+//
+// Index of the Name objects in the DSDT, hashed by NameSeg. The DSDT is
+// reinstalled by every update but keeps its layout, so the offsets stay
+// valid until the table length changes.
+//
+#define AML_NAME_INDEX_BUCKET_COUNT  256
+#define AML_NAME_INDEX_BUCKET(Sig)   (((UINT32) (Sig) * 0x9E3779B1) >> 24)
+
+typedef struct {
+  UINT32  Signature;
+  UINT32  Offset;
+  UINT32  Next;
+} AML_NAME_INDEX_ENTRY;
+
+static AML_NAME_INDEX_ENTRY       *mDsdtNameIndex = NULL;
+static UINT32                     mDsdtNameIndexLength = 0;
+static UINT32                     mDsdtNameIndexBucket[AML_NAME_INDEX_BUCKET_COUNT];
+
 /**
   Initialize the ASL update library state.
   This must be called at the beginning of the function calls in this library.
@@ -154,6 +173,134 @@ LocateAcpiTableByOemTableId (
   return Status;
 }
 
+/**
+  Build the index of the Name objects of the DSDT.
+
+  Every NameSeg preceded by AML_NAME_OP is indexed. The entries of a bucket
+  are chained in table order.
+
+  @param[in] Table             - Pointer to the DSDT
+
+  @retval EFI_SUCCESS          - The index was built.
+  @retval EFI_NOT_FOUND        - The table holds no AML.
+  @retval EFI_OUT_OF_RESOURCES - The index couldn't be allocated.
+**/
+EFI_STATUS
+BuildDsdtNameIndex (
+  IN     EFI_ACPI_DESCRIPTION_HEADER   *Table
+  )
+{
+  UINT8                       *TablePtr;
+  UINT32                      Offset;
+  UINT32                      Count;
+  UINT32                      Bucket;
+  UINT32                      Signature;
+
+  if (mDsdtNameIndex != NULL) {
+    FreePool (mDsdtNameIndex);
+    mDsdtNameIndex = NULL;
+  }
+  mDsdtNameIndexLength = 0;
+  if (Table->Length < sizeof (EFI_ACPI_DESCRIPTION_HEADER) + 5) {
+    return EFI_NOT_FOUND;
+  }
+
+  TablePtr = (UINT8 *) Table;
+  Count    = 0;
+  for (Offset = sizeof (EFI_ACPI_DESCRIPTION_HEADER); Offset + 5 <= Table->Length; Offset++) {
+    if (TablePtr[Offset - 1] == AML_NAME_OP) {
+      Count++;
+    }
+  }
+
+  mDsdtNameIndex = AllocatePool ((Count + 1) * sizeof (AML_NAME_INDEX_ENTRY));
+  if (mDsdtNameIndex == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  SetMem (mDsdtNameIndexBucket, sizeof (mDsdtNameIndexBucket), 0);
+
+  //
+  // Entry 0 terminates the chains. Walk backwards so that each chain ends
+  // up in table order.
+  //
+  for (Offset = Table->Length - 5; Offset >= sizeof (EFI_ACPI_DESCRIPTION_HEADER); Offset--) {
+    if (TablePtr[Offset - 1] == AML_NAME_OP) {
+      Signature = ReadUnaligned32 ((UINT32 *) (TablePtr + Offset));
+      Bucket    = AML_NAME_INDEX_BUCKET (Signature);
+      mDsdtNameIndex[Count].Signature = Signature;
+      mDsdtNameIndex[Count].Offset    = Offset;
+      mDsdtNameIndex[Count].Next      = mDsdtNameIndexBucket[Bucket];
+      mDsdtNameIndexBucket[Bucket]    = Count;
+      Count--;
+    }
+  }
+
+  mDsdtNameIndexLength = Table->Length;
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the first Name object with a NameSeg in the DSDT.
+
+  @param[in] Table             - Pointer to the DSDT
+  @param[in] AslSignature      - The NameSeg to search for
+
+  @return Pointer to the NameSeg in Table, NULL if not found.
+**/
+UINT8 *
+FindDsdtName (
+  IN     EFI_ACPI_DESCRIPTION_HEADER   *Table,
+  IN     UINT32                        AslSignature
+  )
+{
+  UINT8                       *TablePtr;
+  UINT8                       *EndPtr;
+  UINT8                       *DsdtPointer;
+  UINT32                      Index;
+  BOOLEAN                     Rebuilt;
+
+  TablePtr = (UINT8 *) Table;
+  Rebuilt  = FALSE;
+  if (mDsdtNameIndex == NULL || mDsdtNameIndexLength != Table->Length) {
+    BuildDsdtNameIndex (Table);
+    Rebuilt = TRUE;
+  }
+
+  while (mDsdtNameIndex != NULL) {
+    for (Index = mDsdtNameIndexBucket[AML_NAME_INDEX_BUCKET (AslSignature)];
+         Index != 0;
+         Index = mDsdtNameIndex[Index].Next) {
+      if (mDsdtNameIndex[Index].Signature != AslSignature) {
+        continue;
+      }
+      DsdtPointer = TablePtr + mDsdtNameIndex[Index].Offset;
+      if ((ReadUnaligned32 ((UINT32 *) DsdtPointer) == AslSignature) && (*(DsdtPointer - 1) == AML_NAME_OP)) {
+        return DsdtPointer;
+      }
+      break;
+    }
+    if (Index == 0 || Rebuilt) {
+      return NULL;
+    }
+    //
+    // The DSDT was replaced by a table of the same length, index it again.
+    //
+    BuildDsdtNameIndex (Table);
+    Rebuilt = TRUE;
+  }
+
+  //
+  // Not enough memory for the index, scan the table.
+  //
+  EndPtr = TablePtr + Table->Length;
+  for (DsdtPointer = TablePtr + sizeof (EFI_ACPI_DESCRIPTION_HEADER); DsdtPointer + 5 <= EndPtr; DsdtPointer++) {
+    if ((ReadUnaligned32 ((UINT32 *) DsdtPointer) == AslSignature) && (*(DsdtPointer - 1) == AML_NAME_OP)) {
+      return DsdtPointer;
+    }
+  }
+  return NULL;
+}
+
 /**
   This procedure will update immediate value assigned to a Name.
 
@@ -175,9 +322,6 @@ UpdateNameAslCode (
 {
   EFI_STATUS                  Status;
   EFI_ACPI_DESCRIPTION_HEADER *Table;
-  UINT8                       *CurrPtr;
-  UINT8                       *EndPtr;
-  UINT32                      *Signature;
   UINT8                       *DsdtPointer;
   UINTN                       Handle;
   UINT8                       DataSize;
@@ -202,66 +346,46 @@ UpdateNameAslCode (
     return Status;
   }
 
+  if (Table == NULL) {
+    return EFI_NOT_FOUND;
+  }
+
   ///
-  /// Point to the beginning of the DSDT table
+  /// Look up the Name object that we must fix up.
   ///
-  CurrPtr = (UINT8 *) Table;
-  if (CurrPtr == NULL) {
+  DsdtPointer = FindDsdtName (Table, AslSignature);
+  if (DsdtPointer == NULL) {
+    FreePool (Table);
     return EFI_NOT_FOUND;
   }
 
-  //
-  // EndPtr = beginning of table + length of table
-  //
-  EndPtr = CurrPtr + ((EFI_ACPI_COMMON_HEADER *) CurrPtr)->Length;
-
   ///
-  /// Loop through the ASL looking for values that we must fix up.
+  /// Check if size of new and old data is the same
   ///
-  for (DsdtPointer = CurrPtr; DsdtPointer < EndPtr; DsdtPointer++) {
-    ///
-    /// Get a pointer to compare for signature
-    ///
-    Signature = (UINT32 *) DsdtPointer;
-    ///
-    /// Check if this is the Device Object signature we are looking for
-    ///
-    if ((*Signature) == AslSignature) {
-      ///
-      /// Look for Name Encoding
-      ///
-      if (*(DsdtPointer-1) == AML_NAME_OP) {
-        ///
-        /// Check if size of new and old data is the same
-        ///
-        DataSize = *(DsdtPointer+4);
-        if ((Length == 1 && DataSize == 0xA) ||
-            (Length == 2 && DataSize == 0xB) ||
-            (Length == 4 && DataSize == 0xC)) {
-          CopyMem (DsdtPointer+5, Buffer, Length);
-        } else if (Length == 1 && ((*(UINT8*) Buffer) == 0 || (*(UINT8*) Buffer) == 1) && (DataSize == 0 || DataSize == 1)) {
-          CopyMem (DsdtPointer+4, Buffer, Length);
-        } else {
-          FreePool (Table);
-          return EFI_BAD_BUFFER_SIZE;
-        }
-        Status = mAcpiTable->UninstallAcpiTable (
-                               mAcpiTable,
-                               Handle
-                               );
-        Handle = 0;
-        Status = mAcpiTable->InstallAcpiTable (
-                               mAcpiTable,
-                               Table,
-                               Table->Length,
-                               &Handle
-                               );
-        FreePool (Table);
-        return Status;
-      }
-    }
+  DataSize = *(DsdtPointer+4);
+  if ((Length == 1 && DataSize == 0xA) ||
+      (Length == 2 && DataSize == 0xB) ||
+      (Length == 4 && DataSize == 0xC)) {
+    CopyMem (DsdtPointer+5, Buffer, Length);
+  } else if (Length == 1 && ((*(UINT8*) Buffer) == 0 || (*(UINT8*) Buffer) == 1) && (DataSize == 0 || DataSize == 1)) {
+    CopyMem (DsdtPointer+4, Buffer, Length);
+  } else {
+    FreePool (Table);
+    return EFI_BAD_BUFFER_SIZE;
   }
-  return EFI_NOT_FOUND;
+  Status = mAcpiTable->UninstallAcpiTable (
+                         mAcpiTable,
+                         Handle
+                         );
+  Handle = 0;
+  Status = mAcpiTable->InstallAcpiTable (
+                         mAcpiTable,
+                         Table,
+                         Table->Length,
+                         &Handle
+                         );
+  FreePool (Table);
+  return Status;
 }
 
 /**
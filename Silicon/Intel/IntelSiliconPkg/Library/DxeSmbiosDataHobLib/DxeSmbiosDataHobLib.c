@@ -39,7 +39,7 @@ DxeSmbiosDataHobLibConstructor (
   IN EFI_SYSTEM_TABLE          *SystemTable
   )
 {
-  EFI_PEI_HOB_POINTERS         Hob;
+  VOID                         *GuidHob;
   EFI_SMBIOS_HANDLE            SmbiosHandle;
   EFI_SMBIOS_PROTOCOL          *Smbios;
   EFI_STATUS                   Status;
@@ -51,7 +51,7 @@ DxeSmbiosDataHobLibConstructor (
   DEBUG ((DEBUG_INFO, "Adding SMBIOS records from HOB..\n"));
 
   Status = gBS->LocateProtocol (&gEfiSmbiosProtocolGuid, NULL, (VOID **)&Smbios);
-  if (Smbios == NULL) {
+  if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_WARN, "Can't locate SMBIOS protocol\n"));
     return EFI_UNSUPPORTED;
   }
@@ -59,19 +59,28 @@ DxeSmbiosDataHobLibConstructor (
   ///
   /// Get SMBIOS HOB data (each hob contains one SMBIOS record)
   ///
-  for (Hob.Raw = GetHobList (); !END_OF_HOB_LIST(Hob); Hob.Raw = GET_NEXT_HOB (Hob)) {
-    if ((GET_HOB_TYPE (Hob) == EFI_HOB_TYPE_GUID_EXTENSION) && (CompareGuid (&Hob.Guid->Name, &gIntelSmbiosDataHobGuid))) {
-      RecordPtr = GET_GUID_HOB_DATA (Hob.Raw);
-
-      ///
-      /// Add generic SMBIOS HOB to SMBIOS table
-      ///
-      DEBUG ((DEBUG_VERBOSE, "Add SMBIOS record type: %x\n", ((EFI_SMBIOS_TABLE_HEADER *) RecordPtr)->Type));
-      SmbiosHandle = SMBIOS_HANDLE_PI_RESERVED;
-      Status = Smbios->Add (Smbios, NULL, &SmbiosHandle, (EFI_SMBIOS_TABLE_HEADER *) RecordPtr);
-      if (!EFI_ERROR (Status)) {
-        RecordCount++;
-      }
+  for (GuidHob = GetFirstGuidHob (&gIntelSmbiosDataHobGuid);
+       GuidHob != NULL;
+       GuidHob = GetNextGuidHob (&gIntelSmbiosDataHobGuid, GET_NEXT_HOB (GuidHob))) {
+    RecordPtr = GET_GUID_HOB_DATA (GuidHob);
+
+    ///
+    /// Skip records whose formatted area does not fit in the HOB
+    ///
+    if ((GET_GUID_HOB_DATA_SIZE (GuidHob) < sizeof (EFI_SMBIOS_TABLE_HEADER)) ||
+        (GET_GUID_HOB_DATA_SIZE (GuidHob) < ((EFI_SMBIOS_TABLE_HEADER *) RecordPtr)->Length)) {
+      DEBUG ((DEBUG_WARN, "Skip truncated SMBIOS record HOB\n"));
+      continue;
+    }
+
+    ///
+    /// Add generic SMBIOS HOB to SMBIOS table
+    ///
+    DEBUG ((DEBUG_VERBOSE, "Add SMBIOS record type: %x\n", ((EFI_SMBIOS_TABLE_HEADER *) RecordPtr)->Type));
+    SmbiosHandle = SMBIOS_HANDLE_PI_RESERVED;
+    Status = Smbios->Add (Smbios, NULL, &SmbiosHandle, (EFI_SMBIOS_TABLE_HEADER *) RecordPtr);
+    if (!EFI_ERROR (Status)) {
+      RecordCount++;
     }
   }
   DEBUG ((DEBUG_INFO, "Found %d Records and added to SMBIOS table.\n", RecordCount));
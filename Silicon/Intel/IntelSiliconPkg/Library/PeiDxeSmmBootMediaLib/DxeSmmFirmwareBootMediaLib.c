@@ -16,6 +16,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/DebugLib.h>
 #include <Library/FirmwareBootMediaLib.h>
 #include <Library/HobLib.h>
+#include <Library/PcdLib.h>
 
 STATIC FW_BOOT_MEDIA_TYPE mFwBootMedia = FwBootMediaMax;
 
@@ -82,6 +83,14 @@ DxeSmmFirmwareBootMediaLibInit (
   FW_BOOT_MEDIA_TYPE        BootMediaType;
   EFI_HOB_GUID_TYPE         *GuidHobPtr;
 
+  //
+  // A board built for a single boot medium needs no HOB lookup.
+  //
+  if (FixedPcdGet8 (PcdFirmwareBootMediaType) < FwBootMediaMax) {
+    mFwBootMedia = (FW_BOOT_MEDIA_TYPE) FixedPcdGet8 (PcdFirmwareBootMediaType);
+    return EFI_SUCCESS;
+  }
+
   GuidHobPtr  = GetFirstGuidHob (&gFirmwareBootMediaHobGuid);
   if (GuidHobPtr == NULL) {
     DEBUG ((DEBUG_ERROR, "The firmware boot media HOB does not exist!\n"));
@@ -71,10 +71,9 @@ typedef enum {
 } RX_STROBE_DLL_REG;
 
 typedef enum {
-  NotAvailable = 0,
-  Passed,
-  Failed
-} BLOCK_READ_WRITE_STATUS;
+  RxDllTuning = 0,
+  TxDllTuning
+} DLL_TUNING_PATH;
 
 typedef enum {
   ResponseNo = 0,
@@ -104,6 +103,21 @@ typedef struct {
   UINT32  Reserved1:           6;
 } SWITCH_ARGUMENT;
 
+typedef struct {
+  UINT8   MinRange;
+  UINT8   MaxRange;
+  UINT8   MinMept;
+  UINT8   MaxMept;
+} DLL_TAP_RANGE;
+
+//
+// DLL tap ranges and Minimal/Maximal Expected Passing Taps, indexed by DLL_TUNING_PATH
+//
+GLOBAL_REMOVE_IF_UNREFERENCED CONST DLL_TAP_RANGE mDllTapRange[] = {
+  { RX_STROBE_DLL1_TAP_MIN_RANGE, RX_STROBE_DLL1_TAP_MAX_RANGE, RX_STROBE_DLL1_TAP_MIN_MEPT, RX_STROBE_DLL1_TAP_MAX_MEPT },
+  { TX_DATA_DLL_TAP_MIN_RANGE,    TX_DATA_DLL_TAP_MAX_RANGE,    TX_DATA_DLL_TAP_MIN_MEPT,    TX_DATA_DLL_TAP_MAX_MEPT    }
+};
+
 //
 // PCH_EMMC_TUNING PROTOCOL Global Variable
 //
@@ -1133,6 +1147,195 @@ Exit:
   return Status;
 }
 
+/**
+  Program the DLL tap and check if a tuning block transfer passes with it
+
+  @param[in]     EmmcInfo                A pointer to EMMC_INFO structure
+  @param[in]     BlockIo                 A pointer to EFI_BLOCK_IO_PROTOCOL structure
+  @param[in]     EmmcBaseAddress         Base address of MMIO register
+  @param[in]     Path                    Rx (tuning blocks read) or Tx (tuning block write) path
+  @param[in]     DllCount                DLL tap to be checked
+  @param[in]     Buffer                  Data buffer for the tuning blocks
+  @param[in]     BufferSize              Size of the tuning blocks transfer
+
+  @retval EFI_SUCCESS                    Transfer passed with the DLL tap.
+  @retval EFI_CRC_ERROR                  Transfer failed with the DLL tap.
+  @retval Others                         Tuning blocks transfer error.
+**/
+EFI_STATUS
+EmmcCheckDllTap (
+  IN EMMC_INFO                    *EmmcInfo,
+  IN EFI_BLOCK_IO_PROTOCOL        *BlockIo,
+  IN UINTN                        EmmcBaseAddress,
+  IN DLL_TUNING_PATH              Path,
+  IN UINT8                        DllCount,
+  IN UINT8                        *Buffer,
+  IN UINT32                       BufferSize
+  )
+{
+  EFI_STATUS                Status;
+
+  if (Path == RxDllTuning) {
+    EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll1, DllCount);
+    EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll2, DllCount);
+    Status = BlockIo->ReadBlocks (
+                        BlockIo,
+                        BlockIo->Media->MediaId,
+                        EmmcInfo->Lba,
+                        BufferSize,
+                        Buffer
+                        );
+  } else {
+    EmmcSetTxDllCtrl1 (EmmcBaseAddress, DllCount);
+    Status = BlockIo->WriteBlocks (
+                        BlockIo,
+                        BlockIo->Media->MediaId,
+                        EmmcInfo->Lba,
+                        BufferSize,
+                        Buffer
+                        );
+  }
+
+  DEBUG ((DEBUG_INFO, "[ EmmcCheckDllTap: %a DLL (DllCount) = 0x%x, Status = %r ]\n",
+                      (Path == RxDllTuning) ? "Rx" : "Tx", DllCount, Status));
+  return Status;
+}
+
+/**
+  Find the last passing DLL tap from the passing tap towards the range limit
+
+  The taps between the passing tap and the limit are bisected, the passing
+  window is expected to be contiguous. The found edge is then checked again
+  and moved towards the passing tap until it passes, so that a marginal tap
+  is not picked as the edge of the window.
+
+  @param[in]     EmmcInfo                A pointer to EMMC_INFO structure
+  @param[in]     BlockIo                 A pointer to EFI_BLOCK_IO_PROTOCOL structure
+  @param[in]     EmmcBaseAddress         Base address of MMIO register
+  @param[in]     Path                    Rx or Tx path
+  @param[in]     Buffer                  Data buffer for the tuning blocks
+  @param[in]     BufferSize              Size of the tuning blocks transfer
+  @param[in]     PassingTap              DLL tap known to pass
+  @param[in]     LimitTap                Last DLL tap of the range in the search direction
+  @param[out]    EdgeTap                 Last passing DLL tap
+
+  @retval EFI_SUCCESS                    Edge of the passing window found.
+  @retval Others                         Tuning blocks transfer error.
+**/
+EFI_STATUS
+EmmcFindDllEdge (
+  IN  EMMC_INFO                   *EmmcInfo,
+  IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
+  IN  UINTN                       EmmcBaseAddress,
+  IN  DLL_TUNING_PATH             Path,
+  IN  UINT8                       *Buffer,
+  IN  UINT32                      BufferSize,
+  IN  UINT8                       PassingTap,
+  IN  UINT8                       LimitTap,
+  OUT UINT8                       *EdgeTap
+  )
+{
+  INTN                      Good;
+  INTN                      Bad;
+  INTN                      Mid;
+  INTN                      Step;
+  EFI_STATUS                Status;
+
+  Step = (LimitTap < PassingTap) ? -1 : 1;
+  Good = PassingTap;
+  //
+  // The tap beyond the range limit is treated as failing
+  //
+  Bad  = (INTN) LimitTap + Step;
+
+  while ((Bad - Good > 1) || (Good - Bad > 1)) {
+    Mid = (Good + Bad) / 2;
+    Status = EmmcCheckDllTap (EmmcInfo, BlockIo, EmmcBaseAddress, Path, (UINT8) Mid, Buffer, BufferSize);
+    if (Status == EFI_SUCCESS) {
+      Good = Mid;
+    } else if (Status == EFI_CRC_ERROR) { // Rely on the driver to return ReadBlocks/WriteBlocks status on CRC error
+      Bad = Mid;
+    } else {
+      return Status;
+    }
+  }
+
+  while (Good != PassingTap) {
+    Status = EmmcCheckDllTap (EmmcInfo, BlockIo, EmmcBaseAddress, Path, (UINT8) Good, Buffer, BufferSize);
+    if (Status == EFI_SUCCESS) {
+      break;
+    } else if (Status != EFI_CRC_ERROR) {
+      return Status;
+    }
+    Good -= Step;
+  }
+
+  *EdgeTap = (UINT8) Good;
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the minimal and maximal passing DLL taps of the Rx or Tx path
+
+  A passing tap is looked for in the middle of the expected passing window
+  first, then in the whole range. The edges of the window are then found
+  by bisection towards both range limits.
+
+  @param[in]     EmmcInfo                A pointer to EMMC_INFO structure
+  @param[in]     BlockIo                 A pointer to EFI_BLOCK_IO_PROTOCOL structure
+  @param[in]     EmmcBaseAddress         Base address of MMIO register
+  @param[in]     Path                    Rx or Tx path
+  @param[in]     Buffer                  Data buffer for the tuning blocks
+  @param[in]     BufferSize              Size of the tuning blocks transfer
+  @param[out]    Smin                    Minimal passing DLL tap
+  @param[out]    Smax                    Maximal passing DLL tap
+
+  @retval EFI_SUCCESS                    Passing window found.
+  @retval EFI_CRC_ERROR                  None of the DLL taps passed.
+  @retval Others                         Tuning blocks transfer error.
+**/
+EFI_STATUS
+EmmcHs400DllSweep (
+  IN  EMMC_INFO                   *EmmcInfo,
+  IN  EFI_BLOCK_IO_PROTOCOL       *BlockIo,
+  IN  UINTN                       EmmcBaseAddress,
+  IN  DLL_TUNING_PATH             Path,
+  IN  UINT8                       *Buffer,
+  IN  UINT32                      BufferSize,
+  OUT UINT8                       *Smin,
+  OUT UINT8                       *Smax
+  )
+{
+  CONST DLL_TAP_RANGE       *Range;
+  UINT8                     PassingTap;
+  EFI_STATUS                Status;
+
+  Range = &mDllTapRange[Path];
+
+  PassingTap = (Range->MaxMept - Range->MinMept) / 2 + Range->MinMept;
+  Status = EmmcCheckDllTap (EmmcInfo, BlockIo, EmmcBaseAddress, Path, PassingTap, Buffer, BufferSize);
+  if (Status == EFI_CRC_ERROR) {
+    for (PassingTap = Range->MinRange; PassingTap <= Range->MaxRange; PassingTap++) {
+      Status = EmmcCheckDllTap (EmmcInfo, BlockIo, EmmcBaseAddress, Path, PassingTap, Buffer, BufferSize);
+      if (Status != EFI_CRC_ERROR) {
+        break;
+      }
+    }
+  }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "[%a DLL Tuning Failed] No Passing Tap Found, Status = %r\n",
+                         (Path == RxDllTuning) ? "Rx" : "Tx", Status));
+    return Status;
+  }
+
+  Status = EmmcFindDllEdge (EmmcInfo, BlockIo, EmmcBaseAddress, Path, Buffer, BufferSize, PassingTap, Range->MinRange, Smin);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  return EmmcFindDllEdge (EmmcInfo, BlockIo, EmmcBaseAddress, Path, Buffer, BufferSize, PassingTap, Range->MaxRange, Smax);
+}
+
 /**
   To perform HS400 Rx Data Path Training
 
@@ -1159,24 +1362,16 @@ EmmcRxHs400Tuning (
   )
 {
   UINT8                     *Buffer;
-  UINT8                     DllCount;
-  UINT8                     DllMax;
-  UINT8                     DllMin;
   UINT8                     Smin;
   UINT8                     Smax;
   UINT8                     Sopt;
   EFI_STATUS                Status;
-  EFI_STATUS                ModeStatus;
-  BLOCK_READ_WRITE_STATUS   FirstRead;
   UINT32                    TuningPatternSize;
 
   DEBUG ((DEBUG_INFO, "EmmcRxHs400Tuning() Start\n"));
 
   Status = EFI_SUCCESS;
-  ModeStatus = EFI_SUCCESS;
 
-  Smin = RX_STROBE_DLL1_TAP_MIN_MEPT;
-  Smax = RX_STROBE_DLL1_TAP_MAX_MEPT;
   TuningPatternSize = BlockIo->Media->BlockSize * EMMC_HS400_TUNING_PATTERN_BLOCKS_NUMBER;
 
   Buffer = (VOID *) AllocateZeroPool (TuningPatternSize);
@@ -1210,143 +1405,25 @@ EmmcRxHs400Tuning (
     DEBUG ((DEBUG_ERROR, "EmmcRxHs400Tuning: eMMC HS400 Mode Selection Failed!\n"));
     goto Exit;
   }
+
   //
-  // 3. Set Rx Strobe DLL1 to the Minimal Expected Passing Tap (Smin)
+  // 3. Find the Rx Path min (Smin) and max (Smax) DLL passing step numbers
   //    Offset 830h: Rx Strobe Delay DLL 1(HS400 Mode), bits [14:8]
-  //    Set Rx Data Strobe DLL2 to middle point 0x13
   //    Offset 830h: Rx Strobe Delay DLL 2(HS400 Mode), bits [6:0]
-  DEBUG ((DEBUG_INFO, "EmmcRxHs400Tuning: Set Rx Data DLL1 to the Minimal Expected Passing Tap (Smin = 0x%x)\n", Smin));
-  DllCount = RX_STROBE_DLL1_TAP_MIN_MEPT;
-  EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll1, DllCount);
-  EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll2, DllCount);
-
-  //
-  // 4. Read the block that was stored
-  // 5. If CRC fails on first read, increase the DLL Step and repeat block read until passed
-  //    Else if CRC passed on first read, decrease the DLL Step and repeat block read until failed
-  // 6. Store the Rx Path min DLL passing step number
   //
-  FirstRead = NotAvailable;
-  DllMax    = RX_STROBE_DLL1_TAP_MAX_RANGE;
-  DllMin    = RX_STROBE_DLL1_TAP_MIN_RANGE;
-
-  while ((DllCount <= DllMax) && (DllCount >= DllMin)) {
-    DEBUG ((DEBUG_INFO, "[ EmmcRxHs400Tuning: Rx Min DLL1 (DllCount) = 0x%x ]\n", DllCount));
-    Status = BlockIo->ReadBlocks (
-                        BlockIo,
-                        BlockIo->Media->MediaId,
-                        EmmcInfo->Lba,
-                        TuningPatternSize,
-                        Buffer
-                        );
-    if (Status == EFI_SUCCESS) {
-      if (FirstRead == NotAvailable) {
-        FirstRead = Passed;
-      } else if (FirstRead == Failed) {
-        Smin = DllCount;
-        break;
-      }
-      if (DllCount == RX_STROBE_DLL1_TAP_MIN_RANGE) {
-        Smin = RX_STROBE_DLL1_TAP_MIN_RANGE;
-        break;
-      }
-    } else if (Status == EFI_CRC_ERROR) { // Rely on the driver to return ReadBlocks status on CRC error
-      if (FirstRead == NotAvailable) {
-        FirstRead = Failed;
-      } else if (FirstRead == Passed) {
-        Smin = DllCount + 1;
-        break;
-      }
-      if (DllCount == RX_STROBE_DLL1_TAP_MAX_RANGE) {
-        Status = EFI_CRC_ERROR;
-        DEBUG ((DEBUG_ERROR, "[Rx DLL Tuning Failed] DllCount == TAP_MAX_RANGE\n"));
-        goto Exit;
-      }
-    } else {
-      DEBUG ((DEBUG_ERROR, "[Rx DLL Tuning Failed] Smin - Tuning Blocks Read Error!\n"));
-      goto Exit;
-    }
-
-    if (FirstRead == Failed) {
-      DllCount++;
-    } else {
-      DllCount--;
-    }
-    EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll1, DllCount);
-    EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll2, DllCount);
-  }
-
-  DEBUG ((DEBUG_INFO, "[Rx DLL Tuning] Found Minimal Passing Tap = 0x%x\n", Smin));
-
-  //
-  // 7. Set the Rx Strobe DLL1 to the Maximal Expected Passing Tap (Smax)
-  // Offset 830h: Rx Strobe Delay DLL 1(HS400 Mode), bits [14:8]
-  // 8. Read the block that was stored
-  // 9. If CRC fails on first read, decrease the DLL Step and repeat step 8 until pass
-  //    Else if CRC passed on first read, increase the DLL Step and repeat step 8 until failed
-  //
-  DEBUG ((DEBUG_INFO, "EmmcRxHs400Tuning: Set Rx Data DLL1 to the Maximal Expected Passing Tap (Smax = 0x%x)\n", Smax));
-  DllCount = RX_STROBE_DLL1_TAP_MAX_MEPT;
-  EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll1, DllCount);
-  EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll2, DllCount);
-
-  FirstRead = NotAvailable;
-  DllMax    = RX_STROBE_DLL1_TAP_MAX_RANGE;
-  DllMin    = RX_STROBE_DLL1_TAP_MIN_RANGE;
-  while ((DllCount <= DllMax) && (DllCount >= DllMin)) {
-    DEBUG ((DEBUG_INFO, "[ EmmcRxHs400Tuning: Rx Max DLL1 (DllCount) = 0x%x ]\n", DllCount));
-    Status = BlockIo->ReadBlocks (
-                        BlockIo,
-                        BlockIo->Media->MediaId,
-                        EmmcInfo->Lba,
-                        TuningPatternSize,
-                        Buffer
-                        );
-    if (Status == EFI_SUCCESS) {
-      if (FirstRead == NotAvailable) {
-        FirstRead = Passed;
-      } else if (FirstRead == Failed) {
-        Smax = DllCount;
-        break;
-      }
-      if (DllCount == RX_STROBE_DLL1_TAP_MAX_RANGE) {
-        Smax = DllCount;
-        break;
-      }
-    } else if (Status == EFI_CRC_ERROR) { // Rely on the driver to return ReadBlocks status on CRC error
-      if (FirstRead == NotAvailable) {
-        FirstRead = Failed;
-      } else if (FirstRead == Passed) {
-        Smax = DllCount - 1;
-        break;
-      }
-      if (DllCount == RX_STROBE_DLL1_TAP_MIN_RANGE) {
-        Status = EFI_CRC_ERROR;
-        goto Exit;
-      }
-    } else {
-      DEBUG ((DEBUG_ERROR, "[Rx DLL Tuning Failed] Smax - Tuning Blocks Read Error!\n"));
-      goto Exit;
-    }
-    if (FirstRead == Failed) {
-      DllCount--;
-    } else {
-      DllCount++;
-    }
-    EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll1, DllCount);
-    EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll2, DllCount);
+  Status = EmmcHs400DllSweep (EmmcInfo, BlockIo, EmmcBaseAddress, RxDllTuning, Buffer, TuningPatternSize, &Smin, &Smax);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
   }
-  //
-  // 10. Store the Rx Path max DLL Passing Step number
-  //
+  DEBUG ((DEBUG_INFO, "[Rx DLL Tuning] Found Minimal Passing Tap = 0x%x, Maximal Passing Tap = 0x%x\n", Smin, Smax));
 
   //
-  // 11. Compute the Rx DLL Optimal Point (Sopt) = (Smax - Smin)/2 + Smin
+  // 4. Compute the Rx DLL Optimal Point (Sopt) = (Smax - Smin)/2 + Smin
   //
   Sopt = (Smax - Smin) / 2 + Smin;
   DEBUG ((DEBUG_INFO, "[Rx DLL Tuning] Optimal Point (Sopt = (Smax[0x%x] - Smin[0x%x]) / 2 + Smin[0x%x]) = 0x%x\n", Smax, Smin, Smin, Sopt));
   //
-  // 12. Store the Rx DLL optimal value (Sopt)
+  // 5. Store the Rx DLL optimal value (Sopt)
   //
   EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll1, Sopt);
   EmmcSetRxDllCtrl (EmmcBaseAddress, RxDll2, Sopt);
@@ -1389,24 +1466,13 @@ EmmcTxHs400Tuning (
   )
 {
   UINT8                    *Buffer;
-  UINT8                     DllCount;
-  UINT8                     DllMax;
-  UINT8                     DllMin;
   UINT8                     Smin;
   UINT8                     Smax;
   UINT8                     Sopt;
-  UINT8                     N;
   EFI_STATUS                Status;
-  EFI_STATUS                ModeStatus;
-  BLOCK_READ_WRITE_STATUS   FirstWrite;
 
   DEBUG ((DEBUG_INFO, "EmmcTxHs400Tuning() Start\n"));
   Status = EFI_SUCCESS;
-  ModeStatus = EFI_SUCCESS;
-
-  Smin = TX_DATA_DLL_TAP_MIN_MEPT;
-  Smax = TX_DATA_DLL_TAP_MAX_MEPT;
-  N = 0;
 
   Buffer = (VOID *) AllocateZeroPool (BlockIo->Media->BlockSize);
   if (Buffer == NULL) {
@@ -1430,149 +1496,28 @@ EmmcTxHs400Tuning (
   DEBUG_CODE ( EmmcPrintHs400TuningPattern (BlockIo, Buffer, BlockIo->Media->BlockSize); );
 
   //
-  // 2. Set Tx Data DLL1 to the Minimal Expected Passing Tap (Smin)
-  // Offset 824h: Tx Data Delay Control 1
-  // Tx Data Delay (HS400 Mode), BIT[14:8]
+  // 2. Find the Tx Path min (Smin) and max (Smax) DLL passing step numbers
+  //    Offset 824h: Tx Data Delay Control 1
+  //    Tx Data Delay (HS400 Mode), BIT[14:8]
   //
-  DEBUG ((DEBUG_INFO, "EmmcTxHs400Tuning: Set Tx Data DLL to the Minimal Expected Passing Tap (Smin = 0x%x)\n", Smin));
-
-  DllCount = TX_DATA_DLL_TAP_MIN_MEPT;
-  EmmcSetTxDllCtrl1 (EmmcBaseAddress, DllCount);
-
-  //
-  // 2. Write Single Block
-  //
-  FirstWrite = NotAvailable;
-  DllMax     = TX_DATA_DLL_TAP_MAX_RANGE;
-  DllMin     = TX_DATA_DLL_TAP_MIN_RANGE;
-
-  while ((DllCount <= DllMax) && (DllCount >= DllMin)) {
-    DEBUG ((DEBUG_INFO, "[ EmmcTxHs400Tuning: Tx Min DLL (DllCount) = 0x%x ]\n", DllCount));
-    Status = BlockIo->WriteBlocks (
-                        BlockIo,
-                        BlockIo->Media->MediaId,
-                        EmmcInfo->Lba,
-                        BlockIo->Media->BlockSize,
-                        Buffer
-                        );
-    if (Status == EFI_SUCCESS) {
-      if (FirstWrite == NotAvailable) {
-        FirstWrite = Passed;
-      } else if (FirstWrite == Failed) {
-        Smin = DllCount;
-        break;
-      }
-      if (DllCount == TX_DATA_DLL_TAP_MIN_RANGE) {
-        Smin = TX_DATA_DLL_TAP_MIN_RANGE;
-        break;
-      }
-      //
-      // 3. If CRC fails increment DLL Step and repeat step 2
-      //
-    } else if (Status == EFI_CRC_ERROR) { // Rely on the driver to return ReadBlocks status on CRC error
-      if (FirstWrite == NotAvailable) {
-        FirstWrite = Failed;
-      } else if (FirstWrite == Passed) {
-        Smin = DllCount + 1;
-        break;
-      }
-      if (DllCount == TX_DATA_DLL_TAP_MAX_RANGE) {
-        DEBUG ((DEBUG_ERROR, "[Tx DLL Tuning Failed] DllCount == TAP_MAX_RANGE\n"));
-        goto Exit;
-      }
-    } else {
-      DEBUG ((DEBUG_ERROR, "[Tx DLL Tuning Failed] Smin - Tuning Block Write Error!\n"));
-      goto Exit;
-    }
-    if (FirstWrite == Failed) {
-      DllCount++;
-    } else {
-      DllCount--;
-    }
-    EmmcSetTxDllCtrl1 (EmmcBaseAddress, DllCount);
-  }
-  //
-  // 4. Store the Tx Path min DLL passing step number
-  //
-  DEBUG ((DEBUG_INFO, "[Tx DLL Tuning] Found Minimal Passing Tap = 0x%x\n", Smin));
-
-  //
-  // 5. Set the DLL to max expected passing step (Smax)
-  //
-  DEBUG ((DEBUG_INFO, "EmmcTxHs400Tuning: Set Tx Data DLL to the Maximal Expected Passing Tap (Smax = 0x%x)\n", Smax));
-  DllCount = TX_DATA_DLL_TAP_MAX_MEPT;
-  EmmcSetTxDllCtrl1 (EmmcBaseAddress, DllCount);
-  //
-  // 6. Write Single Block
-  //
-  FirstWrite = NotAvailable;
-  DllMax     = TX_DATA_DLL_TAP_MAX_RANGE;
-  DllMin     = TX_DATA_DLL_TAP_MIN_RANGE;
-
-  while ((DllCount <= DllMax) && (DllCount >= DllMin)) {
-    DEBUG ((DEBUG_INFO, "[ EmmcTxHs400Tuning: Tx Max DLL1 (DllCount) = 0x%x ]\n", DllCount));
-    Status = BlockIo->WriteBlocks (
-                        BlockIo,
-                        BlockIo->Media->MediaId,
-                        EmmcInfo->Lba,
-                        BlockIo->Media->BlockSize,
-                        Buffer
-                        );
-
-    if (Status == EFI_SUCCESS) {
-      if (FirstWrite == NotAvailable) {
-        FirstWrite = Passed;
-      } else if (FirstWrite == Failed) {
-        Smax = DllCount;
-        break;
-      }
-      if (DllCount == TX_DATA_DLL_TAP_MAX_RANGE) {
-        Smax = TX_DATA_DLL_TAP_MAX_RANGE;
-        break;
-      }
-      //
-      // 7. If CRC fails decrement DLL Step and repeat step 6
-      //
-    } else if (Status == EFI_CRC_ERROR) { // Rely on the driver to return ReadBlocks status on CRC error
-      if (FirstWrite == NotAvailable) {
-        FirstWrite = Failed;
-      } else if (FirstWrite == Passed) {
-        Smax = DllCount - 1;
-        break;
-      }
-      if (DllCount == TX_DATA_DLL_TAP_MIN_RANGE) {
-        DEBUG ((DEBUG_ERROR, "[Tx DLL Tuning Failed] DllCount == TAP_MIN_RANGE\n"));
-        goto Exit;
-      }
-    } else {
-      DEBUG ((DEBUG_ERROR, "[Tx DLL Tuning Failed] Smax - Tuning Block Write Error!\n"));
-      goto Exit;
-    }
-    if (FirstWrite == Failed) {
-      DllCount--;
-    } else {
-      DllCount++;
-    }
-    EmmcSetTxDllCtrl1 (EmmcBaseAddress, DllCount);
+  Status = EmmcHs400DllSweep (EmmcInfo, BlockIo, EmmcBaseAddress, TxDllTuning, Buffer, BlockIo->Media->BlockSize, &Smin, &Smax);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
   }
-  //
-  // 8. Store the DLL passing step number (Smax)
-  //
-  DEBUG ((DEBUG_INFO, "[Tx DLL Tuning] Found Maximal Passing Tap = 0x%x\n", Smax));
+  DEBUG ((DEBUG_INFO, "[Tx DLL Tuning] Found Minimal Passing Tap = 0x%x, Maximal Passing Tap = 0x%x\n", Smin, Smax));
 
-  N = Smax - Smin;
-  if (N <= 0) {
+  if (Smax <= Smin) {
     Status = EFI_DEVICE_ERROR;
     goto Exit;
   }
   //
-  // 9. Compute the Tx DLL Optimal point (Sopt) = (Smax - Smin) / 2 + Smin
+  // 3. Compute the Tx DLL Optimal point (Sopt) = (Smax - Smin) / 2 + Smin
   //
   Sopt = (Smax - Smin) / 2 + Smin;
   DEBUG ((DEBUG_INFO, "[Tx DLL Tuning] Optimal Point (Sopt = (Smax[0x%x] - Smin[0x%x]) / 2 + Smin[0x%x]) = 0x%x\n", Smax, Smin, Smin, Sopt));
 
   //
-  // 10. Store the Tx Strobe DLL Optimal point value
+  // 4. Store the Tx Strobe DLL Optimal point value
   //
   EmmcSetTxDllCtrl1 (EmmcBaseAddress, Sopt);
 
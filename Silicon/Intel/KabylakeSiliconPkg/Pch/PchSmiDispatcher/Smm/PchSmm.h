@@ -581,6 +581,16 @@ typedef struct {
 extern PRIVATE_DATA           mPrivateData;
 extern UINT16                 mAcpiBaseAddr;
 extern UINT16                 mTcoBaseAddr;
+
+/**
+  Mark the source index used by the dispatcher as stale. It must be called whenever
+  a record is added to or removed from the callback database.
+**/
+VOID
+PchSmmInvalidateSourceIndex (
+  VOID
+  );
+
 /**
   Get the Software Smi value
 
@@ -13,6 +13,29 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 //
 #define BIT_ZERO  0x00000001
 
+///
+/// Register values read while the SMI sources are scanned. Most of the sources
+/// share the SMI_EN/SMI_STS and a few other status registers, the cache lets
+/// the scan read each of them only once per dispatch pass.
+///
+#define PCH_SMM_READ_CACHE_SIZE  16
+
+typedef struct {
+  ADDR_TYPE   Type;
+  UINTN       Address;
+  UINT8       SizeInBytes;
+  BOOLEAN     High;
+  UINT64      Value;
+} PCH_SMM_READ_CACHE_ENTRY;
+
+typedef struct {
+  BOOLEAN                   Enabled;
+  UINTN                     Count;
+  PCH_SMM_READ_CACHE_ENTRY  Entry[PCH_SMM_READ_CACHE_SIZE];
+} PCH_SMM_READ_CACHE;
+
+GLOBAL_REMOVE_IF_UNREFERENCED PCH_SMM_READ_CACHE  mPchSmmReadCache;
+
 /**
   Publish SMI Dispatch protocols.
 
@@ -296,16 +319,82 @@ PchSmmGetSciEn (
 }
 
 /**
-  Read a specifying bit with the register
-  These may or may not need to change w/ the PCH version; they're highly IA-32 dependent, though.
+  Start caching the registers read by ReadBitDesc.
+
+  The values are only valid while no SMI status is cleared, so the cache must
+  be stopped before any source is cleared or any child is dispatched.
+**/
+VOID
+PchSmmReadCacheStart (
+  VOID
+  )
+{
+  mPchSmmReadCache.Count   = 0;
+  mPchSmmReadCache.Enabled = TRUE;
+}
+
+/**
+  Stop caching the registers read by ReadBitDesc.
+**/
+VOID
+PchSmmReadCacheStop (
+  VOID
+  )
+{
+  mPchSmmReadCache.Enabled = FALSE;
+  mPchSmmReadCache.Count   = 0;
+}
+
+/**
+  Get the cache entry describing the register of a bit description.
+
+  @param[in]  BitDesc             The struct that includes register address, size in byte and bit number
+  @param[out] Entry               The cache entry with the register fields filled
+
+**/
+STATIC
+VOID
+PchSmmReadCacheGetKey (
+  IN  CONST PCH_SMM_BIT_DESC    *BitDesc,
+  OUT PCH_SMM_READ_CACHE_ENTRY  *Entry
+  )
+{
+  Entry->Type        = BitDesc->Reg.Type;
+  Entry->SizeInBytes = BitDesc->SizeInBytes;
+  Entry->High        = FALSE;
+  Entry->Value       = 0;
+
+  switch (BitDesc->Reg.Type) {
+    case ACPI_ADDR_TYPE:
+    case TCO_ADDR_TYPE:
+      Entry->Address = BitDesc->Reg.Data.raw;
+      Entry->High    = (BOOLEAN) ((BitDesc->SizeInBytes == 8) && (BitDesc->Bit >= 32));
+      break;
+
+    case GPIO_ADDR_TYPE:
+    case MEMORY_MAPPED_IO_ADDRESS_TYPE:
+      Entry->Address = (UINTN) BitDesc->Reg.Data.Mmio;
+      break;
+
+    default:
+      Entry->Address = BitDesc->Reg.Data.raw;
+      break;
+  }
+}
+
+/**
+  Read the register of a bit description.
+
+  64 bit IO registers are read 32 bits at a time, the half holding the bit is read
+  and returned at its position in the 64 bit register.
 
   @param[in] BitDesc              The struct that includes register address, size in byte and bit number
 
-  @retval TRUE                    The bit is enabled
-  @retval FALSE                   The bit is disabled
+  @return                         The value of the register
 **/
-BOOLEAN
-ReadBitDesc (
+STATIC
+UINT64
+ReadBitDescRegister (
   CONST PCH_SMM_BIT_DESC  *BitDesc
   )
 {
@@ -316,19 +405,12 @@ ReadBitDesc (
   UINT32      PciFun;
   UINT32      PciReg;
   UINTN       RegSize;
-  BOOLEAN     BitWasOne;
-  UINTN       ShiftCount;
   UINTN       RegisterOffset;
   UINT32      BaseAddr;
   UINTN       PciBaseAddress;
 
-  ASSERT (BitDesc != NULL);
-  ASSERT (!IS_BIT_DESC_NULL (*BitDesc));
-
   RegSize     = 0;
   Register    = 0;
-  ShiftCount  = 0;
-  BitWasOne   = FALSE;
 
   switch (BitDesc->Reg.Type) {
 
@@ -379,7 +461,6 @@ ReadBitDesc (
       ///
       ASSERT ((BaseAddr != 0x0) && ((BaseAddr & 0x1) != 0x1));
 
-      ShiftCount      = BitDesc->Bit;
       ///
       /// As current CPU Smm Io can only support at most
       /// 32-bit read/write,if Operation is 64 bit,
@@ -392,7 +473,6 @@ ReadBitDesc (
         ///
         if (BitDesc->Bit >= 32) {
           RegisterOffset += 4;
-          ShiftCount -= 32;
         }
       }
 
@@ -405,10 +485,8 @@ ReadBitDesc (
                                  );
       ASSERT_EFI_ERROR (Status);
 
-      if ((Register & (LShiftU64 (BIT_ZERO, ShiftCount))) != 0) {
-        BitWasOne = TRUE;
-      } else {
-        BitWasOne = FALSE;
+      if ((BitDesc->SizeInBytes == 8) && (BitDesc->Bit >= 32)) {
+        Register = LShiftU64 (Register, 32);
       }
       break;
 
@@ -442,13 +520,6 @@ ReadBitDesc (
           ASSERT (FALSE);
           break;
       }
-
-      Register = Register & (LShiftU64 (BIT0, BitDesc->Bit));
-      if (Register) {
-        BitWasOne = TRUE;
-      } else {
-        BitWasOne = FALSE;
-      }
       break;
 
     case PCIE_ADDR_TYPE:
@@ -486,12 +557,6 @@ ReadBitDesc (
           ASSERT (FALSE);
           break;
       }
-
-      if ((Register & (LShiftU64 (BIT_ZERO, BitDesc->Bit))) != 0) {
-        BitWasOne = TRUE;
-      } else {
-        BitWasOne = FALSE;
-      }
       break;
 
     case PCR_ADDR_TYPE:
@@ -518,13 +583,6 @@ ReadBitDesc (
           ASSERT (FALSE);
           break;
       }
-
-      Register = Register & (LShiftU64 (BIT0, BitDesc->Bit));
-      if (Register) {
-        BitWasOne = TRUE;
-      } else {
-        BitWasOne = FALSE;
-      }
       break;
 
     default:
@@ -535,7 +593,58 @@ ReadBitDesc (
       break;
   }
 
-  return BitWasOne;
+  return Register;
+}
+
+/**
+  Read a specifying bit with the register
+  These may or may not need to change w/ the PCH version; they're highly IA-32 dependent, though.
+
+  @param[in] BitDesc              The struct that includes register address, size in byte and bit number
+
+  @retval TRUE                    The bit is enabled
+  @retval FALSE                   The bit is disabled
+**/
+BOOLEAN
+ReadBitDesc (
+  CONST PCH_SMM_BIT_DESC  *BitDesc
+  )
+{
+  PCH_SMM_READ_CACHE_ENTRY  Key;
+  PCH_SMM_READ_CACHE_ENTRY  *Entry;
+  UINTN                     Index;
+  UINT64                    Register;
+
+  ASSERT (BitDesc != NULL);
+  ASSERT (!IS_BIT_DESC_NULL (*BitDesc));
+
+  if (!mPchSmmReadCache.Enabled) {
+    Register = ReadBitDescRegister (BitDesc);
+  } else {
+    PchSmmReadCacheGetKey (BitDesc, &Key);
+    for (Index = 0; Index < mPchSmmReadCache.Count; Index++) {
+      Entry = &mPchSmmReadCache.Entry[Index];
+      if ((Entry->Type == Key.Type) &&
+          (Entry->Address == Key.Address) &&
+          (Entry->SizeInBytes == Key.SizeInBytes) &&
+          (Entry->High == Key.High)) {
+        break;
+      }
+    }
+
+    if (Index < mPchSmmReadCache.Count) {
+      Register = mPchSmmReadCache.Entry[Index].Value;
+    } else {
+      Register = ReadBitDescRegister (BitDesc);
+      if (mPchSmmReadCache.Count < PCH_SMM_READ_CACHE_SIZE) {
+        Key.Value = Register;
+        CopyMem (&mPchSmmReadCache.Entry[mPchSmmReadCache.Count], &Key, sizeof (Key));
+        mPchSmmReadCache.Count++;
+      }
+    }
+  }
+
+  return (BOOLEAN) ((Register & LShiftU64 (BIT_ZERO, BitDesc->Bit)) != 0);
 }
 
 /**
@@ -90,6 +90,25 @@ ReadBitDesc (
   CONST PCH_SMM_BIT_DESC *BitDesc
   );
 
+/**
+  Start caching the registers read by ReadBitDesc.
+
+  The values are only valid while no SMI status is cleared, so the cache must
+  be stopped before any source is cleared or any child is dispatched.
+**/
+VOID
+PchSmmReadCacheStart (
+  VOID
+  );
+
+/**
+  Stop caching the registers read by ReadBitDesc.
+**/
+VOID
+PchSmmReadCacheStop (
+  VOID
+  );
+
 /**
   Write a specifying bit with the register
 
@@ -1890,6 +1890,179 @@ MtrrSetMemoryAttributeInMtrrSettings (
            );
 }
 
+/**
+  Worker function writing the MTRRs that differ between two settings.
+
+  All the writes are done in a single window with the caches disabled, and
+  the window is not opened at all if nothing changes.
+
+  @param[in]  OriginalSettings  The MTRR settings currently programmed.
+  @param[in]  NewSettings       The MTRR settings to program.
+
+**/
+VOID
+MtrrSetChangedMtrrsWorker (
+  IN MTRR_SETTINGS                *OriginalSettings,
+  IN MTRR_SETTINGS                *NewSettings
+  )
+{
+  MTRR_CONTEXT  MtrrContext;
+  BOOLEAN       MtrrContextValid;
+  UINT32        VariableMtrrCount;
+  UINT32        Index;
+
+  MtrrContextValid = FALSE;
+
+  for (Index = 0; Index < MTRR_NUMBER_OF_FIXED_MTRR; Index++) {
+    if (NewSettings->Fixed.Mtrr[Index] != OriginalSettings->Fixed.Mtrr[Index]) {
+      if (!MtrrContextValid) {
+        PreMtrrChange (&MtrrContext);
+        MtrrContextValid = TRUE;
+      }
+      MtrrRegisterWrite (
+        mMtrrLibFixedMtrrTable[Index].Msr,
+        NewSettings->Fixed.Mtrr[Index]
+        );
+    }
+  }
+
+  VariableMtrrCount = GetVariableMtrrCountWorker ();
+  for (Index = 0; Index < VariableMtrrCount; Index++) {
+    if (NewSettings->Variables.Mtrr[Index].Base != OriginalSettings->Variables.Mtrr[Index].Base ||
+        NewSettings->Variables.Mtrr[Index].Mask != OriginalSettings->Variables.Mtrr[Index].Mask    ) {
+      if (!MtrrContextValid) {
+        PreMtrrChange (&MtrrContext);
+        MtrrContextValid = TRUE;
+      }
+      MtrrRegisterWrite (
+        QUARK_NC_HOST_BRIDGE_IA32_MTRR_PHYSBASE0 + (Index << 1),
+        NewSettings->Variables.Mtrr[Index].Base
+        );
+      MtrrRegisterWrite (
+        QUARK_NC_HOST_BRIDGE_IA32_MTRR_PHYSBASE0 + (Index << 1) + 1,
+        NewSettings->Variables.Mtrr[Index].Mask
+        );
+    }
+  }
+
+  if (!MtrrContextValid && NewSettings->MtrrDefType == OriginalSettings->MtrrDefType) {
+    return;
+  }
+  if (!MtrrContextValid) {
+    PreMtrrChange (&MtrrContext);
+  }
+
+  //
+  // PreMtrrChange() cleared the enable bits, so MTRR_DEF_TYPE is always written.
+  //
+  MtrrRegisterWrite (QUARK_NC_HOST_BRIDGE_IA32_MTRR_DEF_TYPE, NewSettings->MtrrDefType);
+
+  PostMtrrChangeEnableCache (&MtrrContext);
+}
+
+/**
+  This function attempts to set the attributes into MTRR setting buffer for
+  multiple memory ranges.
+
+  The ranges are applied in order, so a later range overrides an earlier one
+  where they overlap. Consecutive ranges that are adjacent and have the same
+  type are coalesced first, which lets them share variable MTRRs. If
+  MtrrSetting is NULL, the ranges are applied to a copy of the current MTRRs
+  and the result is programmed with a single cache-disabled window.
+
+  This implementation needs no scratch buffer, Scratch and ScratchSize are
+  not used.
+
+  @param[in, out]  MtrrSetting  MTRR setting buffer to be set, or NULL to
+                                program the MTRRs.
+  @param[in]       Scratch      A temporary scratch buffer, not used.
+  @param[in, out]  ScratchSize  The size of the scratch buffer, not used.
+  @param[in]       Ranges       Pointer to an array of MTRR_MEMORY_RANGE.
+  @param[in]       RangeCount   Count of MTRR_MEMORY_RANGE.
+
+  @retval RETURN_SUCCESS            The attributes were set for all the memory ranges.
+  @retval RETURN_INVALID_PARAMETER  Ranges is NULL, or Length is zero in any range.
+  @retval RETURN_UNSUPPORTED        The processor does not support one or more bytes of the
+                                    memory resource range specified in Ranges, or the type
+                                    is not supported for the memory resource range.
+  @retval RETURN_OUT_OF_RESOURCES   There are not enough system resources to modify the attributes of
+                                    the memory resource ranges. No MTRR is programmed in this case.
+
+**/
+RETURN_STATUS
+EFIAPI
+MtrrSetMemoryAttributesInMtrrSettings (
+  IN OUT MTRR_SETTINGS           *MtrrSetting,
+  IN     VOID                    *Scratch,
+  IN OUT UINTN                   *ScratchSize,
+  IN     CONST MTRR_MEMORY_RANGE *Ranges,
+  IN     UINTN                   RangeCount
+  )
+{
+  RETURN_STATUS             Status;
+  MTRR_SETTINGS             OriginalSettings;
+  MTRR_SETTINGS             WorkingSettings;
+  MTRR_SETTINGS             *Settings;
+  PHYSICAL_ADDRESS          BaseAddress;
+  UINT64                    Length;
+  MTRR_MEMORY_CACHE_TYPE    Type;
+  UINTN                     Index;
+
+  if (Ranges == NULL) {
+    return RETURN_INVALID_PARAMETER;
+  }
+
+  if (!IsMtrrSupported ()) {
+    return RETURN_UNSUPPORTED;
+  }
+
+  if (MtrrSetting == NULL) {
+    ZeroMem (&OriginalSettings, sizeof (OriginalSettings));
+    MtrrGetAllMtrrs (&OriginalSettings);
+    CopyMem (&WorkingSettings, &OriginalSettings, sizeof (WorkingSettings));
+    Settings = &WorkingSettings;
+  } else {
+    Settings = MtrrSetting;
+  }
+
+  Index = 0;
+  while (Index < RangeCount) {
+    BaseAddress = Ranges[Index].BaseAddress;
+    Length      = Ranges[Index].Length;
+    Type        = Ranges[Index].Type;
+
+    //
+    // Coalesce the following ranges that continue this one with the same type
+    //
+    for (Index++; Index < RangeCount; Index++) {
+      if ((Ranges[Index].Type != Type) ||
+          (Ranges[Index].Length == 0) ||
+          (Ranges[Index].BaseAddress != BaseAddress + Length)) {
+        break;
+      }
+      Length += Ranges[Index].Length;
+    }
+
+    DEBUG((DEBUG_CACHE, "MtrrSetMemoryAttributesInMtrrSettings(%p) %a:%016lx-%016lx\n", MtrrSetting, mMtrrMemoryCacheTypeShortName[Type & 0x07], BaseAddress, Length));
+    Status = MtrrSetMemoryAttributeWorker (
+               Settings,
+               BaseAddress,
+               Length,
+               Type
+               );
+    if (RETURN_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  if (MtrrSetting == NULL) {
+    MtrrSetChangedMtrrsWorker (&OriginalSettings, &WorkingSettings);
+    MtrrDebugPrintAllMtrrs ();
+  }
+
+  return RETURN_SUCCESS;
+}
+
 /**
   Worker function setting variable MTRRs
 
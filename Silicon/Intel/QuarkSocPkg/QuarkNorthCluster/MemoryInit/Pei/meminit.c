@@ -2369,6 +2369,44 @@ static void memory_test(
 }
 
 
+// Check the timings restored on the fast boot path with a quick
+// pattern test per rank. If any byte lane fails the boot mode is
+// switched to bmCold so that MemInit() trains the memory again.
+static void validate_timings(
+    MRCParams_t *mrc_params)
+{
+  uint8_t ch, rk;
+  uint32_t result = 0;
+
+  ENTERFN();
+
+  for (ch = 0; ch < NUM_CHANNELS; ch++)
+  {
+    if (mrc_params->channel_enables & (1 << ch))
+    {
+      for (rk = 0; rk < NUM_RANKS; rk++)
+      {
+        if (mrc_params->rank_enables & (1 << rk))
+        {
+          mrc_params->hte_setup = 1;
+          result |= check_bls_ex(mrc_params, get_addr(mrc_params, ch, rk));
+        }
+      }
+    }
+  }
+
+  select_memory_manager(mrc_params);
+
+  if (result != 0)
+  {
+    DPF(D_INFO, "Saved timings failed on lanes %x, full training\n", result);
+    mrc_params->boot_mode = bmCold;
+  }
+
+  LEAVEFN();
+}
+
+
 // Force same timings as with backup settings
 static void static_timings(
   MRCParams_t *mrc_params)
@@ -2416,21 +2454,22 @@ void MemInit(
     { 0x0105, bmCold|bmFast            , set_ddr_init_complete    }, //6
     { 0x0106,        bmFast|bmWarm|bmS3, restore_timings          }, //7
     { 0x0106, bmCold                   , default_timings          }, //8
-    { 0x0500, bmCold                   , rcvn_cal                 }, //9  perform RCVN_CAL algorithm
-    { 0x0600, bmCold                   , wr_level                 }, //10  perform WR_LEVEL algorithm
-    { 0x0120, bmCold                   , prog_page_ctrl           }, //11
-    { 0x0700, bmCold                   , rd_train                 }, //12  perform RD_TRAIN algorithm
-    { 0x0800, bmCold                   , wr_train                 }, //13  perform WR_TRAIN algorithm
-    { 0x010B, bmCold                   , store_timings            }, //14
-    { 0x010C, bmCold|bmFast|bmWarm|bmS3, enable_scrambling        }, //15
-    { 0x010D, bmCold|bmFast|bmWarm|bmS3, prog_ddr_control         }, //16
-    { 0x010E, bmCold|bmFast|bmWarm|bmS3, prog_dra_drb             }, //17
-    { 0x010F,               bmWarm|bmS3, perform_wake             }, //18
-    { 0x0110, bmCold|bmFast|bmWarm|bmS3, change_refresh_period    }, //19
-    { 0x0111, bmCold|bmFast|bmWarm|bmS3, set_auto_refresh         }, //20
-    { 0x0112, bmCold|bmFast|bmWarm|bmS3, ecc_enable               }, //21
-    { 0x0113, bmCold|bmFast            , memory_test              }, //22
-    { 0x0114, bmCold|bmFast|bmWarm|bmS3, lock_registers           }  //23 set init done
+    { 0x0107,        bmFast            , validate_timings         }, //9  check the restored timings
+    { 0x0500, bmCold                   , rcvn_cal                 }, //10  perform RCVN_CAL algorithm
+    { 0x0600, bmCold                   , wr_level                 }, //11  perform WR_LEVEL algorithm
+    { 0x0120, bmCold                   , prog_page_ctrl           }, //12
+    { 0x0700, bmCold                   , rd_train                 }, //13  perform RD_TRAIN algorithm
+    { 0x0800, bmCold                   , wr_train                 }, //14  perform WR_TRAIN algorithm
+    { 0x010B, bmCold                   , store_timings            }, //15
+    { 0x010C, bmCold|bmFast|bmWarm|bmS3, enable_scrambling        }, //16
+    { 0x010D, bmCold|bmFast|bmWarm|bmS3, prog_ddr_control         }, //17
+    { 0x010E, bmCold|bmFast|bmWarm|bmS3, prog_dra_drb             }, //18
+    { 0x010F,               bmWarm|bmS3, perform_wake             }, //19
+    { 0x0110, bmCold|bmFast|bmWarm|bmS3, change_refresh_period    }, //20
+    { 0x0111, bmCold|bmFast|bmWarm|bmS3, set_auto_refresh         }, //21
+    { 0x0112, bmCold|bmFast|bmWarm|bmS3, ecc_enable               }, //22
+    { 0x0113, bmCold|bmFast            , memory_test              }, //23
+    { 0x0114, bmCold|bmFast|bmWarm|bmS3, lock_registers           }  //24 set init done
   };
 
   uint32_t i;
@@ -2456,7 +2495,7 @@ void MemInit(
     uint64_t my_tsc;
 
 #ifdef MRC_SV
-    if (mrc_params->menu_after_mrc && i > 14)
+    if (mrc_params->menu_after_mrc && i > 15)
     {
       uint8_t ch;
 
@@ -2624,6 +2663,12 @@ void MemInit(
       my_tsc = read_tsc();
       init[i].init_fn(mrc_params);
       DPF(D_TIME, "Execution time %llX", read_tsc() - my_tsc);
+
+      if ((init[i].boot_path == bmFast) && (mrc_params->boot_mode == bmCold))
+      {
+        // restored timings rejected, restart on the cold boot path
+        i = (uint32_t) -1;
+      }
     }
   }
 
@@ -444,6 +444,7 @@ SendCommand (
   UINT64                Data64;
   UINT8                 Index;
   INTN                  TimeOut2;
+  UINT32                PollCount;
   BOOLEAN               AutoCMD12Enable = FALSE;
 
 
@@ -468,8 +469,11 @@ SendCommand (
 
   DEBUG ((EFI_D_INFO, "SendCommand: Command Index = %d \r\n", CommandIndex));
   //
+  //
+  // Wait for the command and data lines to be free, only stall while busy
+  //
   TimeOut2 = 1000; // 10 ms
-  do {
+  while (TRUE) {
     PciIo->Mem.Read (
                  PciIo,
                  EfiPciIoWidthUint32,
@@ -478,10 +482,13 @@ SendCommand (
                  1,
                  &Data
                  );
-     gBS->Stall (10);
-  }while ((TimeOut2-- > 0) && (Data & BIT0));
+    if (((Data & BIT0) == 0) || (TimeOut2-- <= 0)) {
+      break;
+    }
+    gBS->Stall (10);
+  }
   TimeOut2 = 1000; // 10 ms
-  do {
+  while (TRUE) {
     PciIo->Mem.Read (
                  PciIo,
                  EfiPciIoWidthUint32,
@@ -490,8 +497,11 @@ SendCommand (
                  1,
                  &Data
                  );
+    if (((Data & BIT1) == 0) || (TimeOut2-- <= 0)) {
+      break;
+    }
     gBS->Stall (10);
-  }while ((TimeOut2-- > 0) && (Data & BIT1));
+  }
   //Clear status bits
   //
   Data = 0xFFFF;
@@ -707,6 +717,7 @@ SendCommand (
 
 
   Data = 0;
+  PollCount = 0;
   do {
     PciIo->Mem.Read (
                  PciIo,
@@ -748,7 +759,16 @@ SendCommand (
        }
     }
 
-    gBS->Stall (1 * 1000);
+    //
+    // Most commands and single block transfers complete well within 1 ms,
+    // so poll at a finer interval than the TimeOut unit.
+    //
+    gBS->Stall (COMMAND_POLL_INTERVAL);
+    PollCount += COMMAND_POLL_INTERVAL;
+    if (PollCount < 1000) {
+      continue;
+    }
+    PollCount = 0;
 
     TimeOut --;
 
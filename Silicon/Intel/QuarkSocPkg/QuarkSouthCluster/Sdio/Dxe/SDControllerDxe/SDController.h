@@ -42,6 +42,12 @@ extern EFI_COMPONENT_NAME2_PROTOCOL  gSDControllerName2;
 #define BLOCK_SIZE   0x200
 #define TIME_OUT_1S  1000
 
+//
+// Interval in us to poll for command and transfer completion. The TimeOut
+// of SendCommand () is still counted in 1 ms units.
+//
+#define COMMAND_POLL_INTERVAL  10
+
 #pragma pack(1)
 //
 // PCI Class Code structure
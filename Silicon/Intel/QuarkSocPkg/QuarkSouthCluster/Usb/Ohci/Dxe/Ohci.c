@@ -343,7 +343,7 @@ OhciControlTransfer (
     *TransferResult = EFI_USB_ERR_SYSTEM;
     return EFI_DEVICE_ERROR;
   }
-  gBS->Stall(20 * 1000);
+  OhciWaitNextFrame (Ohc);
 
   OhciSetMemoryPointer (Ohc, HC_CONTROL_HEAD, NULL);
   Ed = OhciCreateED (Ohc);
@@ -515,7 +515,6 @@ OhciControlTransfer (
     Status = EFI_DEVICE_ERROR;
     goto UNMAP_DATA_BUFF;
   }
-  gBS->Stall(20 * 1000);
 
 
   TimeCount = 0;
@@ -559,7 +558,7 @@ FREE_TD_BUFF:
   while (HeadTd) {
     DataTd = HeadTd;
     HeadTd = (TD_DESCRIPTOR *)(UINTN)(HeadTd->NextTDPointer);
-    UsbHcFreeMem(Ohc->MemPool, DataTd, sizeof(TD_DESCRIPTOR));
+    OhciFreeTD (Ohc, DataTd);
   }
 
 UNMAP_SETUP_BUFF:
@@ -568,7 +567,7 @@ UNMAP_SETUP_BUFF:
   }
 
 FREE_ED_BUFF:
-  UsbHcFreeMem(Ohc->MemPool, Ed, sizeof(ED_DESCRIPTOR));
+  OhciFreeED (Ohc, Ed);
 
 CTRL_EXIT:
   return Status;
@@ -686,7 +685,7 @@ OhciBulkTransfer(
     *TransferResult = EFI_USB_ERR_SYSTEM;
     return EFI_DEVICE_ERROR;
   }
-  gBS->Stall(20 * 1000);
+  OhciWaitNextFrame (Ohc);
 
   OhciSetMemoryPointer (Ohc, HC_BULK_HEAD, NULL);
 
@@ -799,7 +798,6 @@ OhciBulkTransfer(
     DEBUG ((EFI_D_INFO, "OhciControlTransfer: Fail to enable BULK_ENABLE\r\n"));
     goto FREE_OHCI_TDBUFF;
   }
-  gBS->Stall(20 * 1000);
 
   TimeCount = 0;
   Status = CheckIfDone (Ohc, BULK_LIST, Ed, HeadTd, &EdResult);
@@ -834,7 +832,7 @@ FREE_OHCI_TDBUFF:
   while (HeadTd) {
     DataTd = HeadTd;
     HeadTd = (TD_DESCRIPTOR *)(UINTN)(HeadTd->NextTDPointer);
-    UsbHcFreeMem(Ohc->MemPool, DataTd, sizeof(TD_DESCRIPTOR));
+    OhciFreeTD (Ohc, DataTd);
   }
 
   if(Mapping != NULL) {
@@ -842,7 +840,7 @@ FREE_OHCI_TDBUFF:
   }
 
 FREE_ED_BUFF:
-  UsbHcFreeMem(Ohc->MemPool, Ed, sizeof(ED_DESCRIPTOR));
+  OhciFreeED (Ohc, Ed);
 
   return Status;
 }
@@ -1118,7 +1116,7 @@ FREE_OHCI_TDBUFF:
   while (HeadTd) {
     DataTd = HeadTd;
     HeadTd = (TD_DESCRIPTOR *)(UINTN)(HeadTd->NextTDPointer);
-    UsbHcFreeMem(Ohc->MemPool, DataTd, sizeof(TD_DESCRIPTOR));
+    OhciFreeTD (Ohc, DataTd);
   }
 
 //FREE_OHCI_EDBUFF:
@@ -1127,7 +1125,7 @@ FREE_OHCI_TDBUFF:
       HeadEd = (ED_DESCRIPTOR *)(UINTN)(HeadEd->NextED);
     }
   HeadEd->NextED = Ed->NextED;
-    UsbHcFreeMem(Ohc->MemPool, Ed, sizeof(ED_DESCRIPTOR));
+    OhciFreeED (Ohc, Ed);
   }
 
 UNMAP_OHCI_XBUFF:
@@ -2048,6 +2046,11 @@ OhciAllocateDev (
     goto FREE_DEV_BUFFER;
   }
 
+  Status = OhciInitializeDescriptorPool (Ohc);
+  if (EFI_ERROR (Status)) {
+    goto FREE_MEM_POOL;
+  }
+
   Bytes = 4096;
   Pages = EFI_SIZE_TO_PAGES (Bytes);
 
@@ -71,6 +71,11 @@ struct _USB_OHCI_HC_DEV {
   ED_DESCRIPTOR             *IntervalList[6][32];
   INTERRUPT_CONTEXT_ENTRY   *InterruptContextList;
   VOID                      *MemPool;
+  //
+  // Free EDs and TDs, linked through NextED and NextTDPointer.
+  //
+  ED_DESCRIPTOR             *FreeEdList;
+  TD_DESCRIPTOR             *FreeTdList;
 
   UINT32                    ToggleFlag;
 
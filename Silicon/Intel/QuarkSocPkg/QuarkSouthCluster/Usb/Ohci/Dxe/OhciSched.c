@@ -77,7 +77,7 @@ OhciFreeInterruptContextEntry (
   while (Entry->DataTd) {
     Td = Entry->DataTd;
     Entry->DataTd = (TD_DESCRIPTOR *)(UINTN)(Entry->DataTd->NextTDPointer);
-    UsbHcFreeMem(Ohc->MemPool, Td, sizeof(TD_DESCRIPTOR));
+    OhciFreeTD (Ohc, Td);
   }
   FreePool(Entry);
   return EFI_SUCCESS;
@@ -330,6 +330,34 @@ CheckIfDone (
 }
 
 
+/**
+
+  Wait for the next frame to start, the host controller is then done with
+  a list it was told to stop processing in the previous one
+
+  @Param  Ohc                   UHC private data
+
+**/
+VOID
+OhciWaitNextFrame (
+  IN  USB_OHCI_HC_DEV       *Ohc
+  )
+{
+  UINT32                  FrameNumber;
+  UINTN                   Index;
+
+  //
+  // Give up after two frames, in case the controller is not running.
+  //
+  FrameNumber = OhciGetFrameNumber (Ohc);
+  for (Index = 0; Index < 200; Index++) {
+    if (OhciGetFrameNumber (Ohc) != FrameNumber) {
+      break;
+    }
+    gBS->Stall (10);
+  }
+}
+
 /**
 
   Convert TD condition code to Efi Status
@@ -425,6 +453,18 @@ OhciHouseKeeper (
   Ohc = (USB_OHCI_HC_DEV *) Context;
   OriginalTPL = gBS->RaiseTPL(TPL_NOTIFY);
 
+  //
+  // Interrupt TDs are retired with no delay, so a completed or failed
+  // one always gets the done queue written back to the HCCA. Nothing to
+  // reap until that happens.
+  //
+  if (OhciGetHcInterruptStatus (Ohc, WRITEBACK_DONE_HEAD) == 0) {
+    gBS->RestoreTPL (OriginalTPL);
+    return;
+  }
+  Ohc->HccaMemoryBlock->HccaDoneHead = 0;
+  OhciClearInterruptStatus (Ohc, WRITEBACK_DONE_HEAD);
+
   Entry = Ohc->InterruptContextList;
   PreEntry = NULL;
 
@@ -173,6 +173,19 @@ CheckIfDone (
   OUT OHCI_ED_RESULT        *EdResult
   );
 
+/**
+
+  Wait for the next frame to start, the host controller is then done with
+  a list it was told to stop processing in the previous one
+
+  @Param  Ohc                   UHC private data
+
+**/
+VOID
+OhciWaitNextFrame (
+  IN  USB_OHCI_HC_DEV       *Ohc
+  );
+
 /**
 
   Convert TD condition code to Efi Status
@@ -13,6 +13,49 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include "Ohci.h"
 
 
+/**
+
+  Carve the free ED and TD lists out of the memory pool
+
+  @Param  Ohc                   UHC private data
+
+  @retval  EFI_SUCCESS          Lists filled
+  @retval  EFI_OUT_OF_RESOURCES Failed to allocate the descriptors
+
+**/
+EFI_STATUS
+OhciInitializeDescriptorPool (
+  IN USB_OHCI_HC_DEV      *Ohc
+  )
+{
+  ED_DESCRIPTOR           *Ed;
+  TD_DESCRIPTOR           *Td;
+  UINTN                   Index;
+
+  Ohc->FreeEdList = NULL;
+  Ohc->FreeTdList = NULL;
+
+  Ed = UsbHcAllocateMem (Ohc->MemPool, OHCI_ED_POOL_SIZE * sizeof (ED_DESCRIPTOR));
+  if (Ed == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Td = UsbHcAllocateMem (Ohc->MemPool, OHCI_TD_POOL_SIZE * sizeof (TD_DESCRIPTOR));
+  if (Td == NULL) {
+    UsbHcFreeMem (Ohc->MemPool, Ed, OHCI_ED_POOL_SIZE * sizeof (ED_DESCRIPTOR));
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Index = 0; Index < OHCI_ED_POOL_SIZE; Index++) {
+    OhciFreeED (Ohc, &Ed[Index]);
+  }
+  for (Index = 0; Index < OHCI_TD_POOL_SIZE; Index++) {
+    OhciFreeTD (Ohc, &Td[Index]);
+  }
+
+  return EFI_SUCCESS;
+}
+
+
 /**
 
   Create a TD
@@ -28,8 +71,23 @@ OhciCreateTD (
   )
 {
   TD_DESCRIPTOR           *Td;
+  EFI_TPL                 OriginalTPL;
 
-  Td = UsbHcAllocateMem(Ohc->MemPool, sizeof(TD_DESCRIPTOR));
+  //
+  // The free list is shared with the house keeper timer.
+  //
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  Td = Ohc->FreeTdList;
+  if (Td != NULL) {
+    Ohc->FreeTdList = (TD_DESCRIPTOR *)(UINTN)(Td->NextTDPointer);
+  }
+  gBS->RestoreTPL (OriginalTPL);
+
+  if (Td != NULL) {
+    ZeroMem (Td, sizeof (TD_DESCRIPTOR));
+  } else {
+    Td = UsbHcAllocateMem(Ohc->MemPool, sizeof(TD_DESCRIPTOR));
+  }
   if (Td == NULL) {
     DEBUG ((EFI_D_INFO, "STV allocate TD fail !\r\n"));
     return NULL;
@@ -59,10 +117,20 @@ OhciFreeTD (
   IN TD_DESCRIPTOR        *Td
   )
 {
+  EFI_TPL                 OriginalTPL;
+
   if (Td == NULL) {
     return EFI_SUCCESS;
   }
-  UsbHcFreeMem(Ohc->MemPool, Td, sizeof(TD_DESCRIPTOR));
+
+  //
+  // Descriptors allocated past the pool go to the list too, they
+  // are all released with the memory pool.
+  //
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  Td->NextTDPointer = (UINT32)(UINTN)Ohc->FreeTdList;
+  Ohc->FreeTdList = Td;
+  gBS->RestoreTPL (OriginalTPL);
 
   return EFI_SUCCESS;
 }
@@ -83,7 +151,20 @@ OhciCreateED (
   )
 {
   ED_DESCRIPTOR   *Ed;
-  Ed = UsbHcAllocateMem(Ohc->MemPool, sizeof (ED_DESCRIPTOR));
+  EFI_TPL         OriginalTPL;
+
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  Ed = Ohc->FreeEdList;
+  if (Ed != NULL) {
+    Ohc->FreeEdList = (ED_DESCRIPTOR *)(UINTN)(Ed->NextED);
+  }
+  gBS->RestoreTPL (OriginalTPL);
+
+  if (Ed != NULL) {
+    ZeroMem (Ed, sizeof (ED_DESCRIPTOR));
+  } else {
+    Ed = UsbHcAllocateMem(Ohc->MemPool, sizeof (ED_DESCRIPTOR));
+  }
   if (Ed == NULL) {
     DEBUG ((EFI_D_INFO, "STV allocate ED fail !\r\n"));
     return NULL;
@@ -113,10 +194,16 @@ OhciFreeED (
   IN ED_DESCRIPTOR        *Ed
   )
 {
+  EFI_TPL                 OriginalTPL;
+
   if (Ed == NULL) {
     return EFI_SUCCESS;
   }
-  UsbHcFreeMem(Ohc->MemPool, Ed, sizeof(ED_DESCRIPTOR));
+
+  OriginalTPL = gBS->RaiseTPL (TPL_NOTIFY);
+  Ed->NextED = (UINT32)(UINTN)Ohc->FreeEdList;
+  Ohc->FreeEdList = Ed;
+  gBS->RestoreTPL (OriginalTPL);
 
   return EFI_SUCCESS;
 }
@@ -855,7 +942,7 @@ OhciFreeFixedIntMemory (
   for (Level = 0; Level < 6; Level++) {
     for (Index = 0; Index < Leaf[Level]; Index++) {
       if (Ohc->IntervalList[Level][Index] != NULL) {
-        UsbHcFreeMem(Ohc->MemPool, Ohc->IntervalList[Level][Index], sizeof(ED_DESCRIPTOR));
+        OhciFreeED (Ohc, Ohc->IntervalList[Level][Index]);
       }
     }
   }
@@ -13,12 +13,35 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #include "Descriptor.h"
 
+//
+// Number of EDs and TDs set aside when the controller is started: the
+// 63 static interrupt EDs, plus what a few devices need at once.
+//
+#define OHCI_ED_POOL_SIZE     96
+#define OHCI_TD_POOL_SIZE     128
+
 
 //
 // Func List
 //
 
 
+/**
+
+  Carve the free ED and TD lists out of the memory pool
+
+  @Param  Ohc                   UHC private data
+
+  @retval  EFI_SUCCESS          Lists filled
+  @retval  EFI_OUT_OF_RESOURCES Failed to allocate the descriptors
+
+**/
+EFI_STATUS
+OhciInitializeDescriptorPool (
+  IN USB_OHCI_HC_DEV      *Ohc
+  );
+
+
 /**
 
   Create a TD
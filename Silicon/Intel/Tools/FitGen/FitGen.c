@@ -272,6 +272,34 @@ typedef struct {
 
 FIT_TABLE_CONTEXT   gFitTableContext = {0};
 
+//
+// Index of the FVs and FFS files of the input image. It is built by one walk
+// of the image, the FIT entries are then resolved against it instead of
+// scanning the whole image for every GUID.
+//
+typedef struct {
+  EFI_FIRMWARE_VOLUME_HEADER *FvHeader;
+  UINT64                     FvLength;
+} FV_INDEX_ENTRY;
+
+typedef struct {
+  EFI_FFS_FILE_HEADER        *FileHeader;
+  UINTN                      FvIndex;
+} FFS_INDEX_ENTRY;
+
+typedef struct {
+  UINT8                      *Buffer;
+  UINT32                     Size;
+  UINTN                      FvNumber;
+  UINTN                      FvMaxNumber;
+  FV_INDEX_ENTRY             *Fv;
+  UINTN                      FfsNumber;
+  UINTN                      FfsMaxNumber;
+  FFS_INDEX_ENTRY            *Ffs;
+} FFS_INDEX;
+
+FFS_INDEX           gFfsIndex = {0};
+
 unsigned int
 xtoi (
   char  *str
@@ -601,6 +629,199 @@ FindNextFvHeader (
   return NULL;
 }
 
+VOID
+FreeFfsIndex (
+  VOID
+  )
+/*++
+
+Routine Description:
+
+  Free the FV and FFS index of the input image
+
+--*/
+{
+  if (gFfsIndex.Fv != NULL) {
+    free (gFfsIndex.Fv);
+  }
+  if (gFfsIndex.Ffs != NULL) {
+    free (gFfsIndex.Ffs);
+  }
+  SetMem (&gFfsIndex, sizeof (gFfsIndex), 0);
+}
+
+STATUS
+BuildFfsIndex (
+  IN UINT8     *FdBuffer,
+  IN UINT32    FdSize
+  )
+/*++
+
+Routine Description:
+
+  Index all the FVs and FFS files of an image. The FVs and files are walked
+  in the same way and order as FindFileFromFvByGuid () does.
+
+Arguments:
+
+  FdBuffer       - FD or FV binary buffer
+  FdSize         - FD or FV size
+
+Returns:
+
+  STATUS_SUCCESS - The image is indexed
+  STATUS_ERROR   - Not enough memory for the index
+
+--*/
+{
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+  EFI_FFS_FILE_HEADER         *FileHeader;
+  UINT64                      FvLength;
+  UINTN                       Offset;
+  UINTN                       FileLength;
+  UINTN                       FileOccupiedSize;
+  VOID                        *NewBuffer;
+
+  FreeFfsIndex ();
+
+  FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *)FindNextFvHeader (FdBuffer, FdSize);
+  while (FvHeader != NULL) {
+    FvLength = FvHeader->FvLength;
+
+    if (gFfsIndex.FvNumber == gFfsIndex.FvMaxNumber) {
+      gFfsIndex.FvMaxNumber = (gFfsIndex.FvMaxNumber == 0) ? 0x10 : gFfsIndex.FvMaxNumber * 2;
+      NewBuffer = realloc (gFfsIndex.Fv, gFfsIndex.FvMaxNumber * sizeof (FV_INDEX_ENTRY));
+      if (NewBuffer == NULL) {
+        FreeFfsIndex ();
+        return STATUS_ERROR;
+      }
+      gFfsIndex.Fv = NewBuffer;
+    }
+    gFfsIndex.Fv[gFfsIndex.FvNumber].FvHeader = FvHeader;
+    gFfsIndex.Fv[gFfsIndex.FvNumber].FvLength = FvLength;
+
+    FileHeader = (EFI_FFS_FILE_HEADER *)((UINTN)FvHeader + FvHeader->HeaderLength);
+    Offset     = (UINTN) FileHeader - (UINTN) FvHeader;
+    while (Offset < FvLength) {
+      FileLength = (*(UINT32 *)(FileHeader->Size)) & 0x00FFFFFF;
+      FileOccupiedSize = GETOCCUPIEDSIZE(FileLength, 8);
+      if (FileOccupiedSize == 0) {
+        break;
+      }
+
+      if (gFfsIndex.FfsNumber == gFfsIndex.FfsMaxNumber) {
+        gFfsIndex.FfsMaxNumber = (gFfsIndex.FfsMaxNumber == 0) ? 0x100 : gFfsIndex.FfsMaxNumber * 2;
+        NewBuffer = realloc (gFfsIndex.Ffs, gFfsIndex.FfsMaxNumber * sizeof (FFS_INDEX_ENTRY));
+        if (NewBuffer == NULL) {
+          FreeFfsIndex ();
+          return STATUS_ERROR;
+        }
+        gFfsIndex.Ffs = NewBuffer;
+      }
+      gFfsIndex.Ffs[gFfsIndex.FfsNumber].FileHeader = FileHeader;
+      gFfsIndex.Ffs[gFfsIndex.FfsNumber].FvIndex    = gFfsIndex.FvNumber;
+      gFfsIndex.FfsNumber++;
+
+      FileHeader = (EFI_FFS_FILE_HEADER *)((UINTN)FileHeader + FileOccupiedSize);
+      Offset = (UINTN) FileHeader - (UINTN) FvHeader;
+    }
+    gFfsIndex.FvNumber++;
+
+    //
+    // Next FV
+    //
+    if ((UINTN)FdBuffer + FdSize > (UINTN)FvHeader + FvLength) {
+      FvHeader = (EFI_FIRMWARE_VOLUME_HEADER *)FindNextFvHeader ((UINT8 *)FvHeader + (UINTN)FvLength, (UINTN)FdBuffer + FdSize - ((UINTN)FvHeader + (UINTN)FvLength));
+    } else {
+      FvHeader = NULL;
+    }
+  }
+
+  gFfsIndex.Buffer = FdBuffer;
+  gFfsIndex.Size   = FdSize;
+
+  return STATUS_SUCCESS;
+}
+
+BOOLEAN
+FindFileFromFfsIndex (
+  IN UINT8     *FvBuffer,
+  IN UINT32    FvSize,
+  IN EFI_GUID  *Guid,
+  OUT UINT32   *FileSize,
+  OUT UINT8    **FileLocation
+  )
+/*++
+
+Routine Description:
+
+  Find File with GUID in the FFS index, if the index covers the buffer
+
+Arguments:
+
+  FvBuffer       - The indexed image or one FV of the indexed image
+  FvSize         - The size of the indexed image, or of the FV
+  Guid           - File GUID value to be searched
+  FileSize       - Guid File size
+  FileLocation   - Guid File location, NULL if the file is not found
+
+Returns:
+
+  TRUE           - The buffer is indexed, FileLocation is valid.
+  FALSE          - The buffer is not indexed.
+
+--*/
+{
+  UINTN                       FvIndex;
+  UINTN                       Index;
+  BOOLEAN                     AllFv;
+  EFI_FFS_FILE_HEADER         *FileHeader;
+  EFI_FIRMWARE_VOLUME_HEADER  *FvHeader;
+
+  if (gFfsIndex.Buffer == NULL) {
+    return FALSE;
+  }
+
+  //
+  // The whole image, or exactly one of its FVs
+  //
+  FvIndex = 0;
+  AllFv   = (BOOLEAN) ((FvBuffer == gFfsIndex.Buffer) && (FvSize == gFfsIndex.Size));
+  if (!AllFv) {
+    for (FvIndex = 0; FvIndex < gFfsIndex.FvNumber; FvIndex++) {
+      if (((UINT8 *)gFfsIndex.Fv[FvIndex].FvHeader == FvBuffer) && (gFfsIndex.Fv[FvIndex].FvLength == FvSize)) {
+        break;
+      }
+    }
+    if (FvIndex == gFfsIndex.FvNumber) {
+      return FALSE;
+    }
+  }
+
+  *FileLocation = NULL;
+  for (Index = 0; Index < gFfsIndex.FfsNumber; Index++) {
+    if (!AllFv && (gFfsIndex.Ffs[Index].FvIndex != FvIndex)) {
+      continue;
+    }
+    FileHeader = gFfsIndex.Ffs[Index].FileHeader;
+    if ((CompareGuid (&(FileHeader->Name), Guid)) == 0) {
+      FvHeader = gFfsIndex.Fv[gFfsIndex.Ffs[Index].FvIndex].FvHeader;
+      InitializeFvLib (FvHeader, (UINT32)FvHeader->FvLength);
+
+      *FileSize = ((*(UINT32 *)(FileHeader->Size)) & 0x00FFFFFF) - sizeof(EFI_FFS_FILE_HEADER);
+#if (PI_SPECIFICATION_VERSION < 0x00010000)
+      if (FileHeader->Attributes & FFS_ATTRIB_TAIL_PRESENT) {
+        *FileSize -= sizeof(EFI_FFS_FILE_TAIL);
+      }
+#endif
+      *FileLocation = ((UINT8 *)FileHeader + sizeof(EFI_FFS_FILE_HEADER));
+      break;
+    }
+  }
+
+  return TRUE;
+}
+
 UINT8  *
 FindFileFromFvByGuid (
   IN UINT8     *FvBuffer,
@@ -637,6 +858,10 @@ Returns:
   UINTN                       FileLength;
   UINTN                       FileOccupiedSize;
 
+  if (FindFileFromFfsIndex (FvBuffer, FvSize, Guid, FileSize, &FixPoint)) {
+    return FixPoint;
+  }
+
   //
   // Find the FFS file
   //
@@ -2947,8 +3172,24 @@ Returns:
   EFI_GUID                      VTFGuid = EFI_FFS_VOLUME_TOP_FILE_GUID;
   UINT32                        FvLength;
   UINT32                        FileLength;
+  UINTN                         Index;
 
   *FvRecovery = NULL;
+  if ((gFfsIndex.Buffer == FdBuffer) && (gFfsIndex.Size == FdFileSize)) {
+    //
+    // The FVs are already known, the last one with the VTF is FvRecovery
+    //
+    for (Index = 0; Index < gFfsIndex.FvNumber; Index++) {
+      FileBuffer = (UINT8 *)gFfsIndex.Fv[Index].FvHeader;
+      FvLength   = (UINT32)gFfsIndex.Fv[Index].FvLength;
+      if (FindFileFromFvByGuid (FileBuffer, FvLength, &VTFGuid, &FileLength) != NULL) {
+        FvRecoveryFileSize = FvLength;
+        *FvRecovery = FileBuffer;
+      }
+    }
+    return FvRecoveryFileSize;
+  }
+
   FileBuffer = FindNextFvHeader (FdBuffer, FdFileSize);
   if (FileBuffer == NULL) {
     return 0;
@@ -3145,7 +3386,18 @@ Returns:
       Error (NULL, 0, 0, "Unable to open file", "%s", argv[2]);
       goto exitFunc;
     }
+  }
+
+  //
+  // Index the FVs and FFS files once for all the FIT entries
+  //
+  Status = BuildFfsIndex (FdFileBuffer, FdFileSize);
+  if (Status != STATUS_SUCCESS) {
+    Error (NULL, 0, 0, "Not enough memory to index the FFS files", NULL);
+    goto exitFunc;
+  }
 
+  if (!IsFv) {
     //
     // Get Fvrecovery information
     //
@@ -3256,6 +3508,7 @@ Returns:
   }
 
 exitFunc:
+  FreeFfsIndex ();
   if (FileBufferRaw != NULL) {
     free ((VOID *)FileBufferRaw);
   }
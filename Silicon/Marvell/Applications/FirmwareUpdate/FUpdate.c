@@ -18,6 +18,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/ShellCEntryLib.h>
 #include <Library/ShellCommandLib.h>
 #include <Library/ShellLib.h>
+#include <Library/TimerLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 
@@ -34,13 +35,20 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define SHELL_FILE_NAME_PARAM        L"LocalFileName"
 #define SHELL_HELP_PARAM             L"help"
 #define SHELL_LIST_PARAM             L"list"
+#define SHELL_VERIFY_PARAM           L"-v"
 
 #define MAIN_HDR_MAGIC        0xB105B002
 
+//
+// Granularity of the block device compare and the verification pass
+//
+#define FUPDATE_CHUNK_SIZE    SIZE_64KB
+
 STATIC EFI_DEVICE_PATH_FROM_TEXT_PROTOCOL  *EfiDevicePathFromTextProtocol;
 STATIC MARVELL_SPI_MASTER_PROTOCOL         *SpiMasterProtocol;
 STATIC MARVELL_SPI_FLASH_PROTOCOL          *SpiFlashProtocol;
 STATIC EFI_BLOCK_IO_PROTOCOL               *BlkIo;
+STATIC BOOLEAN                             VerifyImage;
 
 STATIC CONST CHAR16 gShellFUpdateFileName[] = L"ShellCommands";
 STATIC EFI_HANDLE gShellFUpdateHiiHandle = NULL;
@@ -49,6 +57,7 @@ STATIC CONST SHELL_PARAM_ITEM ParamList[] = {
   {SHELL_HELP_PARAM,            TypeFlag},
   {SHELL_LIST_PARAM,            TypeFlag},
   {SHELL_USE_DEVICE_PATH_PARAM, TypeFlag},
+  {SHELL_VERIFY_PARAM,          TypeFlag},
   {SHELL_FILE_NAME_PARAM,       TypePosition},
   {SHELL_DEVICE_NAME_PARAM,     TypePosition},
   {NULL ,                       TypeMax}
@@ -363,9 +372,90 @@ PrepareFirmwareImage (
   return EFI_SUCCESS;
 }
 
+/**
+  Print the average programming throughput.
+
+  @param[in]   ByteCount           Number of bytes processed
+  @param[in]   StartTicks          Performance counter value at the start
+
+**/
+STATIC
+VOID
+PrintThroughput (
+  IN UINT64      ByteCount,
+  IN UINT64      StartTicks
+  )
+{
+  UINT64         CurrentTicks;
+  UINT64         StartValue;
+  UINT64         EndValue;
+  UINT64         Elapsed;
+  UINT64         Rate;
+
+  CurrentTicks = GetPerformanceCounter ();
+  GetPerformanceCounterProperties (&StartValue, &EndValue);
+  if (EndValue >= StartValue) {
+    Elapsed = CurrentTicks - StartTicks;
+  } else {
+    Elapsed = StartTicks - CurrentTicks;
+  }
+
+  // Elapsed time in microseconds, rate in hundredths of MB/s
+  Elapsed = MAX (DivU64x32 (GetTimeInNanoSecond (Elapsed), 1000), 1);
+  Rate = DivU64x32 (DivU64x64Remainder (MultU64x32 (ByteCount, 100000000),
+                      Elapsed,
+                      NULL),
+           SIZE_1MB);
+
+  Print (L"%s: %Ld bytes in %Ld ms (%Ld.%02Ld MB/s)\n",
+    CMD_NAME_STRING,
+    ByteCount,
+    DivU64x32 (Elapsed, 1000),
+    DivU64x32 (Rate, 100),
+    ModU64x32 (Rate, 100));
+}
+
+/**
+  Compare the CRC32 of the data read back from the device with the image.
+
+  @param[in]  *Expected            Pointer to the image data
+  @param[in]  *Actual              Pointer to the data read from the device
+  @param[in]   Length              Number of bytes to compare
+  @param[in]   Address             Device offset of the data, for reporting
+
+**/
+STATIC
+EFI_STATUS
+VerifyChunk (
+  IN VOID        *Expected,
+  IN VOID        *Actual,
+  IN UINTN        Length,
+  IN UINT64       Address
+  )
+{
+  UINT32         ExpectedCrc;
+  UINT32         ActualCrc;
+
+  gBS->CalculateCrc32 (Expected, Length, &ExpectedCrc);
+  gBS->CalculateCrc32 (Actual, Length, &ActualCrc);
+  if (ExpectedCrc != ActualCrc) {
+    Print (L"\n%s: Verification failed at 0x%lx (CRC32 0x%08x != 0x%08x)\n",
+      CMD_NAME_STRING,
+      Address,
+      ActualCrc,
+      ExpectedCrc);
+    return EFI_CRC_ERROR;
+  }
+
+  return EFI_SUCCESS;
+}
+
 /**
   Update firmware image in the block device.
 
+  The image is processed in chunks, which are compared with the current
+  content of the device, so that only the differing ones are written.
+
   @param[in]   FileSize            Size of the file to be flashed
   @param[in]  *FileBuffer          Pointer to the file in memory
   @param[in]   Offset              First logical block to be updated.
@@ -381,36 +471,109 @@ ProgramBlockDevice (
   )
 {
   EFI_STATUS     Status;
+  UINT64         StartTicks;
+  UINT64         Index;
+  UINT64         Written;
+  UINTN          BlockSize;
+  UINTN          ChunkSize;
+  UINTN          Length;
+  EFI_LBA        Lba;
+  UINT8          *Data;
+  UINT8          *TmpBuf;
 
   Print (L"Updating image in BlockDevice\n");
 
-  Status = BlkIo->WriteBlocks (BlkIo,
-                    BlkIo->Media->MediaId,
-                    Offset,
-                    FileSize,
-                    FileBuffer);
-  if (EFI_ERROR (Status)) {
-    Print (L"%s: Cannot write to device (Status: %r)\n",
-      CMD_NAME_STRING,
-      Status);
-    return Status;
+  BlockSize = BlkIo->Media->BlockSize;
+  ChunkSize = MAX (FUPDATE_CHUNK_SIZE - (FUPDATE_CHUNK_SIZE % BlockSize),
+                BlockSize);
+
+  TmpBuf = AllocatePool (ChunkSize);
+  if (TmpBuf == NULL) {
+    Print (L"%s: Fail to allocate buffer\n", CMD_NAME_STRING);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  StartTicks = GetPerformanceCounter ();
+  Written = 0;
+
+  for (Index = 0; Index < FileSize; Index += Length) {
+    Length = (UINTN)MIN (FileSize - Index, ChunkSize);
+    Lba = Offset + DivU64x32 (Index, BlockSize);
+    Data = (UINT8 *)FileBuffer + Index;
+
+    Print (L"   \rUpdating, %d%%", (UINTN)DivU64x64Remainder (Index * 100, FileSize, NULL));
+
+    // Skip the chunks, which already hold the image data
+    Status = BlkIo->ReadBlocks (BlkIo,
+                      BlkIo->Media->MediaId,
+                      Lba,
+                      Length,
+                      TmpBuf);
+    if (!EFI_ERROR (Status) && CompareMem (TmpBuf, Data, Length) == 0) {
+      continue;
+    }
+
+    Status = BlkIo->WriteBlocks (BlkIo,
+                      BlkIo->Media->MediaId,
+                      Lba,
+                      Length,
+                      Data);
+    if (EFI_ERROR (Status)) {
+      Print (L"\n%s: Cannot write to device (Status: %r)\n",
+        CMD_NAME_STRING,
+        Status);
+      goto Exit;
+    }
+    Written += Length;
+
+    if (VerifyImage) {
+      Status = BlkIo->ReadBlocks (BlkIo,
+                        BlkIo->Media->MediaId,
+                        Lba,
+                        Length,
+                        TmpBuf);
+      if (EFI_ERROR (Status)) {
+        Print (L"\n%s: Cannot read from device (Status: %r)\n",
+          CMD_NAME_STRING,
+          Status);
+        goto Exit;
+      }
+
+      Status = VerifyChunk (Data, TmpBuf, Length, MultU64x32 (Lba, BlockSize));
+      if (EFI_ERROR (Status)) {
+        goto Exit;
+      }
+    }
   }
+  Print (L"   \rUpdating, 100%%\n");
 
   Status = BlkIo->FlushBlocks (BlkIo);
   if (EFI_ERROR (Status)) {
     Print (L"%s: Cannot flush to device (Status: %r)\n",
       CMD_NAME_STRING,
       Status);
-    return Status;
+    goto Exit;
   }
 
-  return EFI_SUCCESS;
+  Print (L"%s: %Ld of %Ld bytes differed and were written\n",
+    CMD_NAME_STRING,
+    Written,
+    FileSize);
+  PrintThroughput (FileSize, StartTicks);
+
+Exit:
+  FreePool (TmpBuf);
+
+  return Status;
 }
 
 
 /**
   Update firmware image in the SPI flash.
 
+  The flash driver skips the pages, which already hold the image data,
+  and erases only the sectors, which cannot be programmed in place.
+
   @param[in]   FileSize            Size of the file to be flashed
   @param[in]  *FileBuffer          Pointer to the file in memory
   @param[in]   Offset              First logical block to be updated.
@@ -428,6 +591,11 @@ ProgramSpiFlash (
 {
   SPI_DEVICE    *SpiFlash;
   EFI_STATUS     Status;
+  UINT64         StartTicks;
+  UINT64         Index;
+  UINTN          SectorSize;
+  UINTN          Length;
+  UINT8          *TmpBuf;
 
   // Locate SPI protocols
   Status = gBS->LocateProtocol (&gMarvellSpiFlashProtocolGuid,
@@ -464,6 +632,7 @@ ProgramSpiFlash (
   }
 
   // Update firmware image in flash at offset 0x0
+  StartTicks = GetPerformanceCounter ();
   Status = SpiFlashProtocol->Update (SpiFlash,
                                0x0,
                                FileSize,
@@ -472,6 +641,38 @@ ProgramSpiFlash (
     Print (L"%s: Error while performing flash update\n", CMD_NAME_STRING);
     goto FlashProbeError;
   }
+  PrintThroughput (FileSize, StartTicks);
+
+  // Read the image back sector by sector and compare the checksums
+  if (VerifyImage) {
+    SectorSize = SpiFlash->Info->SectorSize;
+    TmpBuf = AllocatePool (SectorSize);
+    if (TmpBuf == NULL) {
+      Print (L"%s: Fail to allocate buffer\n", CMD_NAME_STRING);
+      Status = EFI_OUT_OF_RESOURCES;
+      goto FlashProbeError;
+    }
+
+    for (Index = 0; Index < FileSize; Index += Length) {
+      Length = (UINTN)MIN (FileSize - Index, SectorSize);
+      Status = SpiFlashProtocol->Read (SpiFlash, (UINT32)Index, Length, TmpBuf);
+      if (EFI_ERROR (Status)) {
+        Print (L"%s: Error while reading flash\n", CMD_NAME_STRING);
+        break;
+      }
+
+      Status = VerifyChunk ((UINT8 *)FileBuffer + Index, TmpBuf, Length, Index);
+      if (EFI_ERROR (Status)) {
+        break;
+      }
+    }
+
+    FreePool (TmpBuf);
+    if (EFI_ERROR (Status)) {
+      goto FlashProbeError;
+    }
+    Print (L"%s: Verification succeeded\n", CMD_NAME_STRING);
+  }
 
   // Release resources
   SpiMasterProtocol->FreeDevice (SpiFlash);
@@ -611,10 +812,11 @@ FUpdateUsage (
   )
 {
   Print (L"\nFirmware update command\n"
-         "fupdate <LocalFilePath> [-p] [Device]\n\n"
+         "fupdate <LocalFilePath> [-p] [-v] [Device]\n\n"
          "LocalFilePath - path to local firmware image file\n"
          "-p            - When flag is selected Device is interpreted\n"
          "                as device path, not device handle.\n"
+         "-v            - Read the image back and verify its CRC32 checksum.\n"
          "Device        - Select device which will be flashed.\n"
          "                Supported devices can be listed using \"fupdate list\"\n"
          "                command. Device is represented by its handle.\n"
@@ -626,6 +828,8 @@ FUpdateUsage (
          "     fupdate flash-image.bin 5F\n"
          " * Update firmware in device with selected path from file flash.bin\n"
          "     fupdate flash.bin -p VenHw(0D51905B-B77E-452A-A2C0-ECA0CC8D514A,000078F20000000000)/SD(0x0)\n"
+         " * Update and verify firmware in SPI flash from file flash-image.bin\n"
+         "     fupdate flash-image.bin -v\n"
          " * List supported devices\n"
          "     fupdate list\n"
   );
@@ -675,6 +879,8 @@ ShellCommandRunFUpdate (
     return EFI_SUCCESS;
   }
 
+  VerifyImage = ShellCommandLineGetFlag (CheckPackage, SHELL_VERIFY_PARAM);
+
   // Select device to flash
   Status = SelectDevice (CheckPackage, &FlashCommand, &Alignment, &Offset);
   if (EFI_ERROR (Status)) {
@@ -9,17 +9,79 @@
 
 #include <PiPei.h>
 
+#include <Guid/MemoryTypeInformation.h>
+
 #include <Library/ArmMmuLib.h>
 #include <Library/ArmPlatformLib.h>
 #include <Library/DebugLib.h>
 #include <Library/HobLib.h>
 #include <Library/PcdLib.h>
+#include <Library/PeiServicesLib.h>
+
+#include <Ppi/ReadOnlyVariable2.h>
 
 VOID
 BuildMemoryTypeInformationHob (
   VOID
   );
 
+/**
+  Build the memory type information HOB from the variable that BDS saved on
+  the previous boot. BDS sizes the bins after the highest usage it saw, with
+  headroom added, so this keeps the runtime regions from fragmenting the
+  memory map once they outgrow the default bins.
+
+  @retval TRUE    The HOB was built from the variable.
+  @retval FALSE   The variable is not available or not valid.
+
+**/
+STATIC
+BOOLEAN
+BuildMemoryTypeInformationHobFromVariable (
+  VOID
+  )
+{
+  EFI_STATUS                        Status;
+  EFI_PEI_READ_ONLY_VARIABLE2_PPI   *Variable;
+  EFI_MEMORY_TYPE_INFORMATION       MemoryData[EfiMaxMemoryType + 1];
+  UINTN                             DataSize;
+  UINTN                             Count;
+  UINTN                             Index;
+
+  Status = PeiServicesLocatePpi (&gEfiPeiReadOnlyVariable2PpiGuid, 0, NULL,
+             (VOID **)&Variable);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  DataSize = sizeof (MemoryData);
+  Status = Variable->GetVariable (Variable,
+                       EFI_MEMORY_TYPE_INFORMATION_VARIABLE_NAME,
+                       &gEfiMemoryTypeInformationGuid, NULL, &DataSize,
+                       MemoryData);
+  if (EFI_ERROR (Status) || (DataSize == 0) ||
+      (DataSize % sizeof (EFI_MEMORY_TYPE_INFORMATION)) != 0) {
+    return FALSE;
+  }
+
+  //
+  // Only use a table that is terminated properly and that only lists memory
+  // types the DXE core keeps bins for.
+  //
+  Count = DataSize / sizeof (EFI_MEMORY_TYPE_INFORMATION);
+  if (MemoryData[Count - 1].Type != EfiMaxMemoryType) {
+    return FALSE;
+  }
+  for (Index = 0; Index < Count - 1; Index++) {
+    if (MemoryData[Index].Type >= EfiMaxMemoryType) {
+      return FALSE;
+    }
+  }
+
+  BuildGuidDataHob (&gEfiMemoryTypeInformationGuid, MemoryData, DataSize);
+  return TRUE;
+}
+
 STATIC
 VOID
 InitMmu (
@@ -184,7 +246,10 @@ MemoryPeim (
 
   if (FeaturePcdGet (PcdPrePiProduceMemoryTypeInformationHob)) {
     // Optional feature that helps prevent EFI memory map fragmentation.
-    BuildMemoryTypeInformationHob ();
+    // The bins of the previous boot take precedence over the defaults.
+    if (!BuildMemoryTypeInformationHobFromVariable ()) {
+      BuildMemoryTypeInformationHob ();
+    }
   }
 
   return EFI_SUCCESS;
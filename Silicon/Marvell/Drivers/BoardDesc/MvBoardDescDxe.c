@@ -11,9 +11,32 @@ MV_BOARD_DESC *mBoardDescInstance;
 STATIC MV_BOARD_GPIO_DESCRIPTION *mGpioDescription;
 STATIC MV_BOARD_PCIE_DESCRIPTION *mPcieDescription;
 
+/*
+ * Descriptions of the device classes, which are created once at the driver
+ * entry and then returned by pointer on each protocol call.
+ */
+typedef enum {
+  MvBoardDescAhci,
+  MvBoardDescComPhy,
+  MvBoardDescI2c,
+  MvBoardDescMdio,
+  MvBoardDescPp2,
+  MvBoardDescSdMmc,
+  MvBoardDescUtmi,
+  MvBoardDescXhci,
+  MvBoardDescTypeMax
+} MV_BOARD_DESC_TYPE;
+
+typedef struct {
+  VOID       *BoardDesc;
+  EFI_STATUS  Status;
+} MV_BOARD_DESC_ENTRY;
+
+STATIC MV_BOARD_DESC_ENTRY mBoardDescTable[MvBoardDescTypeMax];
+
 STATIC
 EFI_STATUS
-MvBoardDescComPhyGet (
+MvBoardDescComPhyBuild (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_COMPHY_DESC    **ComPhyDesc
   )
@@ -123,7 +146,7 @@ MvBoardGpioDescriptionGet (
 
 STATIC
 EFI_STATUS
-MvBoardDescI2cGet (
+MvBoardDescI2cBuild (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_I2C_DESC       **I2cDesc
   )
@@ -188,7 +211,7 @@ MvBoardDescI2cGet (
 
 STATIC
 EFI_STATUS
-MvBoardDescMdioGet (
+MvBoardDescMdioBuild (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_MDIO_DESC      **MdioDesc
   )
@@ -223,7 +246,7 @@ MvBoardDescMdioGet (
 
 STATIC
 EFI_STATUS
-MvBoardDescAhciGet (
+MvBoardDescAhciBuild (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_AHCI_DESC      **AhciDesc
   )
@@ -286,7 +309,7 @@ MvBoardDescAhciGet (
 
 STATIC
 EFI_STATUS
-MvBoardDescSdMmcGet (
+MvBoardDescSdMmcBuild (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_SDMMC_DESC     **SdMmcDesc
   )
@@ -357,7 +380,7 @@ MvBoardDescSdMmcGet (
 
 STATIC
 EFI_STATUS
-MvBoardDescXhciGet (
+MvBoardDescXhciBuild (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_XHCI_DESC      **XhciDesc
   )
@@ -504,7 +527,7 @@ MvBoardPcieDescriptionGet (
 
 STATIC
 EFI_STATUS
-MvBoardDescPp2Get (
+MvBoardDescPp2Build (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_PP2_DESC       **Pp2Desc
   )
@@ -566,7 +589,7 @@ MvBoardDescPp2Get (
 
 STATIC
 EFI_STATUS
-MvBoardDescUtmiGet (
+MvBoardDescUtmiBuild (
   IN MARVELL_BOARD_DESC_PROTOCOL  *This,
   IN OUT MV_BOARD_UTMI_DESC      **UtmiDesc
   )
@@ -654,12 +677,165 @@ MvBoardDescUtmiGet (
   return EFI_SUCCESS;
 }
 
+/**
+  Create the descriptions of all device classes and store them, along with
+  the status of their creation, in the board description table.
+
+  @param[in]  *This                     Pointer to board description protocol.
+
+**/
+STATIC
+VOID
+MvBoardDescBuildAll (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This
+  )
+{
+  MV_BOARD_DESC_ENTRY *Table;
+
+  Table = mBoardDescTable;
+
+  Table[MvBoardDescAhci].Status = MvBoardDescAhciBuild (This,
+                                    (MV_BOARD_AHCI_DESC **)&Table[MvBoardDescAhci].BoardDesc);
+  Table[MvBoardDescComPhy].Status = MvBoardDescComPhyBuild (This,
+                                      (MV_BOARD_COMPHY_DESC **)&Table[MvBoardDescComPhy].BoardDesc);
+  Table[MvBoardDescI2c].Status = MvBoardDescI2cBuild (This,
+                                   (MV_BOARD_I2C_DESC **)&Table[MvBoardDescI2c].BoardDesc);
+  Table[MvBoardDescMdio].Status = MvBoardDescMdioBuild (This,
+                                    (MV_BOARD_MDIO_DESC **)&Table[MvBoardDescMdio].BoardDesc);
+  Table[MvBoardDescPp2].Status = MvBoardDescPp2Build (This,
+                                   (MV_BOARD_PP2_DESC **)&Table[MvBoardDescPp2].BoardDesc);
+  Table[MvBoardDescSdMmc].Status = MvBoardDescSdMmcBuild (This,
+                                     (MV_BOARD_SDMMC_DESC **)&Table[MvBoardDescSdMmc].BoardDesc);
+  Table[MvBoardDescUtmi].Status = MvBoardDescUtmiBuild (This,
+                                    (MV_BOARD_UTMI_DESC **)&Table[MvBoardDescUtmi].BoardDesc);
+  Table[MvBoardDescXhci].Status = MvBoardDescXhciBuild (This,
+                                    (MV_BOARD_XHCI_DESC **)&Table[MvBoardDescXhci].BoardDesc);
+}
+
+/**
+  Return the description of the device class from the board description table.
+
+  @param[in]       Type                 Device class.
+  @param[in out] **BoardDesc            Pointer to the description. It is left
+                                        untouched, if the class is not
+                                        present on the platform.
+
+  @retval EFI_SUCCESS                   The data were obtained successfully.
+  @retval Other                         Status of the description creation.
+
+**/
+STATIC
+EFI_STATUS
+MvBoardDescLookup (
+  IN     MV_BOARD_DESC_TYPE  Type,
+  IN OUT VOID              **BoardDesc
+  )
+{
+  MV_BOARD_DESC_ENTRY *Entry;
+
+  Entry = &mBoardDescTable[Type];
+  if (!EFI_ERROR (Entry->Status) && Entry->BoardDesc != NULL) {
+    *BoardDesc = Entry->BoardDesc;
+  }
+
+  return Entry->Status;
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescAhciGet (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_AHCI_DESC      **AhciDesc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescAhci, (VOID **)AhciDesc);
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescComPhyGet (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_COMPHY_DESC    **ComPhyDesc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescComPhy, (VOID **)ComPhyDesc);
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescI2cGet (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_I2C_DESC       **I2cDesc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescI2c, (VOID **)I2cDesc);
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescMdioGet (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_MDIO_DESC      **MdioDesc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescMdio, (VOID **)MdioDesc);
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescPp2Get (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_PP2_DESC       **Pp2Desc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescPp2, (VOID **)Pp2Desc);
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescSdMmcGet (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_SDMMC_DESC     **SdMmcDesc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescSdMmc, (VOID **)SdMmcDesc);
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescUtmiGet (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_UTMI_DESC      **UtmiDesc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescUtmi, (VOID **)UtmiDesc);
+}
+
+STATIC
+EFI_STATUS
+MvBoardDescXhciGet (
+  IN MARVELL_BOARD_DESC_PROTOCOL  *This,
+  IN OUT MV_BOARD_XHCI_DESC      **XhciDesc
+  )
+{
+  return MvBoardDescLookup (MvBoardDescXhci, (VOID **)XhciDesc);
+}
+
 STATIC
 VOID
 MvBoardDescFree (
   IN VOID *BoardDesc
   )
 {
+  UINTN Index;
+
+  /* Descriptions from the board description table are owned by the driver */
+  for (Index = 0; Index < MvBoardDescTypeMax; Index++) {
+    if (BoardDesc == mBoardDescTable[Index].BoardDesc) {
+      return;
+    }
+  }
+
   FreePool (BoardDesc);
 }
 
@@ -699,6 +875,7 @@ MvBoardDescEntryPoint (
   }
 
   MvBoardDescInitProtocol (&mBoardDescInstance->BoardDescProtocol);
+  MvBoardDescBuildAll (&mBoardDescInstance->BoardDescProtocol);
 
   mBoardDescInstance->Signature = MV_BOARD_DESC_SIGNATURE;
 
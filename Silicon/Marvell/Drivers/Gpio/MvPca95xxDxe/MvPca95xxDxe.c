@@ -115,6 +115,12 @@ MvPca95xxGetI2c (
   EFI_HANDLE  *HandleBuffer;
   EFI_STATUS   Status;
 
+  /* Use the protocol found by the previous lookup */
+  if (mPca95xxInstance->ExpanderStates[ControllerIndex].I2cIo != NULL) {
+    *I2cIo = mPca95xxInstance->ExpanderStates[ControllerIndex].I2cIo;
+    return EFI_SUCCESS;
+  }
+
   I2cBus = mPca95xxInstance->GpioExpanders[ControllerIndex].I2cBus;
   I2cAddress = mPca95xxInstance->GpioExpanders[ControllerIndex].I2cAddress;
 
@@ -144,6 +150,7 @@ MvPca95xxGetI2c (
     }
     if ((*I2cIo)->DeviceIndex == I2C_DEVICE_INDEX (I2cBus, I2cAddress)) {
       gBS->FreePool (HandleBuffer);
+      mPca95xxInstance->ExpanderStates[ControllerIndex].I2cIo = *I2cIo;
       return EFI_SUCCESS;
     }
   }
@@ -218,90 +225,129 @@ MvPca95xxWriteRegs (
   return MvPca95xxI2cTransfer (I2cIo, Reg, &RegVal, I2C_FLAG_NORESTART);
 }
 
+/**
+
+Routine Description:
+
+  Updates the pin bit in the output or direction register of an expander,
+  using the locally kept copy of the register.
+
+Arguments:
+
+  ControllerIndex - index of controller
+  GpioPin - which pin to modify
+  Reg - PCA95XX_OUTPUT_REG or PCA95XX_DIRECTION_REG
+  Set - new value of the pin bit
+
+Returns:
+
+  EFI_SUCCESS - register updated
+  Other - I2C transfer error
+**/
 STATIC
 EFI_STATUS
-MvPca95xxSetOutputValue (
-  IN UINTN               ControllerIndex,
-  IN UINTN               GpioPin,
-  IN EMBEDDED_GPIO_MODE  Mode
+MvPca95xxUpdateReg (
+  IN UINTN    ControllerIndex,
+  IN UINTN    GpioPin,
+  IN UINT8    Reg,
+  IN BOOLEAN  Set
   )
 {
+  PCA95XX_EXPANDER_STATE *State;
   EFI_I2C_IO_PROTOCOL *I2cIo;
   EFI_STATUS Status;
+  UINT8 *Shadow;
+  UINT8 *Valid;
   UINT8 RegVal;
   UINTN Bank;
 
+  Bank = GpioPin / PCA95XX_BANK_SIZE;
+  if (Bank >= PCA95XX_MAX_BANK_COUNT) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  State = &mPca95xxInstance->ExpanderStates[ControllerIndex];
+  if (Reg == PCA95XX_OUTPUT_REG) {
+    Shadow = State->Output;
+    Valid = &State->OutputValid;
+  } else {
+    Shadow = State->Direction;
+    Valid = &State->DirectionValid;
+  }
+
   Status = MvPca95xxGetI2c (ControllerIndex, &I2cIo);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: fail to get I2C protocol\n", __FUNCTION__));
-    return EFI_DEVICE_ERROR;
+    return Status;
   }
 
-  Bank = GpioPin / PCA95XX_BANK_SIZE;
-
-  Status = MvPca95xxReadRegs (I2cIo, PCA95XX_OUTPUT_REG + Bank, &RegVal);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a: fail to read device register\n", __FUNCTION__));
-    return EFI_DEVICE_ERROR;
+  if ((*Valid & (1 << Bank)) == 0) {
+    Status = MvPca95xxReadRegs (I2cIo, Reg + Bank, &Shadow[Bank]);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a: fail to read device register\n", __FUNCTION__));
+      return Status;
+    }
+    *Valid |= 1 << Bank;
   }
 
-  if (Mode == GPIO_MODE_OUTPUT_1) {
+  RegVal = Shadow[Bank];
+  if (Set) {
     RegVal |= (1 << (GpioPin % PCA95XX_BANK_SIZE));
   } else {
     RegVal &= ~(1 << (GpioPin % PCA95XX_BANK_SIZE));
   }
 
-  Status = MvPca95xxWriteRegs (I2cIo, PCA95XX_OUTPUT_REG + Bank, RegVal);
+  if (RegVal == Shadow[Bank]) {
+    return EFI_SUCCESS;
+  }
+
+  Status = MvPca95xxWriteRegs (I2cIo, Reg + Bank, RegVal);
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR, "%a: fail to write device register\n", __FUNCTION__));
-    return EFI_DEVICE_ERROR;
+    /* The register state is unknown now, read it again next time */
+    *Valid &= ~(1 << Bank);
+    return Status;
   }
+  Shadow[Bank] = RegVal;
 
   return EFI_SUCCESS;
 }
 
 STATIC
 EFI_STATUS
-MvPca95xxSetDirection (
-  IN UINTN              ControllerIndex,
-  IN UINTN              GpioPin,
-  IN EMBEDDED_GPIO_MODE Mode
+MvPca95xxSetOutputValue (
+  IN UINTN               ControllerIndex,
+  IN UINTN               GpioPin,
+  IN EMBEDDED_GPIO_MODE  Mode
   )
 {
-  EFI_I2C_IO_PROTOCOL *I2cIo;
   EFI_STATUS Status;
-  UINT8 RegVal;
-  UINTN Bank;
 
-  Status = MvPca95xxGetI2c (ControllerIndex, &I2cIo);
+  Status = MvPca95xxUpdateReg (ControllerIndex,
+             GpioPin,
+             PCA95XX_OUTPUT_REG,
+             Mode == GPIO_MODE_OUTPUT_1);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a: fail to get I2C protocol\n", __FUNCTION__));
-    return Status;
-  }
-
-  Bank = GpioPin / PCA95XX_BANK_SIZE;
-
-  Status = MvPca95xxReadRegs (I2cIo, PCA95XX_DIRECTION_REG + Bank, &RegVal);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a: fail to read device register\n", __FUNCTION__));
-    return Status;
-  }
-
-  if (Mode == GPIO_MODE_INPUT) {
-    RegVal |= (1 << (GpioPin % PCA95XX_BANK_SIZE));
-  } else {
-    RegVal &= ~(1 << (GpioPin % PCA95XX_BANK_SIZE));
-  }
-
-  Status = MvPca95xxWriteRegs (I2cIo, PCA95XX_DIRECTION_REG + Bank, RegVal);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a: fail to write device register\n", __FUNCTION__));
-    return Status;
+    return EFI_DEVICE_ERROR;
   }
 
   return EFI_SUCCESS;
 }
 
+STATIC
+EFI_STATUS
+MvPca95xxSetDirection (
+  IN UINTN              ControllerIndex,
+  IN UINTN              GpioPin,
+  IN EMBEDDED_GPIO_MODE Mode
+  )
+{
+  return MvPca95xxUpdateReg (ControllerIndex,
+           GpioPin,
+           PCA95XX_DIRECTION_REG,
+           Mode == GPIO_MODE_INPUT);
+}
+
 STATIC
 EFI_STATUS
 MvPca95xxReadMode (
@@ -310,6 +356,7 @@ MvPca95xxReadMode (
   OUT EMBEDDED_GPIO_MODE *Mode
   )
 {
+  PCA95XX_EXPANDER_STATE *State;
   EFI_I2C_IO_PROTOCOL *I2cIo;
   EFI_STATUS Status;
   UINT8 RegVal;
@@ -324,11 +371,17 @@ MvPca95xxReadMode (
   }
 
   Bank = GpioPin / PCA95XX_BANK_SIZE;
+  State = &mPca95xxInstance->ExpanderStates[ControllerIndex];
 
-  Status = MvPca95xxReadRegs (I2cIo, PCA95XX_DIRECTION_REG + Bank, &RegVal);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a: fail to read device register\n", __FUNCTION__));
-    return Status;
+  if (Bank < PCA95XX_MAX_BANK_COUNT &&
+      (State->DirectionValid & (1 << Bank)) != 0) {
+    RegVal = State->Direction[Bank];
+  } else {
+    Status = MvPca95xxReadRegs (I2cIo, PCA95XX_DIRECTION_REG + Bank, &RegVal);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a: fail to read device register\n", __FUNCTION__));
+      return Status;
+    }
   }
 
   if (RegVal & (1 << (GpioPin % PCA95XX_BANK_SIZE))) {
@@ -610,6 +663,17 @@ MvPca95xxEntryPoint (
     goto ErrPca95xxInstanceAlloc;
   }
 
+  mPca95xxInstance->ExpanderStates = AllocateZeroPool (
+                                       GpioDescription->GpioExpanderCount *
+                                       sizeof (PCA95XX_EXPANDER_STATE));
+  if (mPca95xxInstance->ExpanderStates == NULL) {
+    DEBUG ((DEBUG_ERROR,
+      "%a: Fail to allocate ExpanderStates\n",
+      __FUNCTION__));
+    Status = EFI_OUT_OF_RESOURCES;
+    goto ErrExpanderStatesAlloc;
+  }
+
   MvPca95xxInitProtocol (&mPca95xxInstance->GpioProtocol);
 
   mPca95xxInstance->Signature = PCA95XX_GPIO_SIGNATURE;
@@ -630,6 +694,9 @@ MvPca95xxEntryPoint (
   return EFI_SUCCESS;
 
 ErrInstallProtocols:
+  gBS->FreePool (mPca95xxInstance->ExpanderStates);
+
+ErrExpanderStatesAlloc:
   gBS->FreePool (mPca95xxInstance);
 
 ErrPca95xxInstanceAlloc:
@@ -31,6 +31,7 @@
 #define PCA95XX_DIRECTION_REG    0x6
 
 #define PCA95XX_BANK_SIZE        8
+#define PCA95XX_MAX_BANK_COUNT   5
 #define PCA95XX_OPERATION_COUNT  2
 #define PCA95XX_OPERATION_LENGTH 1
 
@@ -48,9 +49,24 @@ typedef enum {
   PCA9557_PIN_COUNT = 16,
 } PCA95XX_PIN_COUNT;
 
+/*
+ * Per-expander state. The output and direction registers are changed only
+ * by this driver, so once read, their values are kept here and the pin
+ * updates need a single register write, which is skipped if the value
+ * does not change.
+ */
+typedef struct {
+  EFI_I2C_IO_PROTOCOL *I2cIo;
+  UINT8                Output[PCA95XX_MAX_BANK_COUNT];
+  UINT8                Direction[PCA95XX_MAX_BANK_COUNT];
+  UINT8                OutputValid;
+  UINT8                DirectionValid;
+} PCA95XX_EXPANDER_STATE;
+
 typedef struct {
   EMBEDDED_GPIO      GpioProtocol;
   MV_GPIO_EXPANDER  *GpioExpanders;
+  PCA95XX_EXPANDER_STATE *ExpanderStates;
   UINTN              GpioExpanderCount;
   UINTN              Signature;
   EFI_HANDLE         ControllerHandle;
@@ -88,10 +88,10 @@ out:
   return Status;
 }
 
+STATIC
 EFI_STATUS
-EFIAPI
-MvEepromTransfer (
-  IN CONST MARVELL_EEPROM_PROTOCOL *This,
+MvEepromBusTransfer (
+  IN EEPROM_CONTEXT *EepromContext,
   IN UINT16 Address,
   IN UINT32 Length,
   IN UINT8 *Buffer,
@@ -101,7 +101,6 @@ MvEepromTransfer (
   EFI_I2C_REQUEST_PACKET *RequestPacket;
   UINTN RequestPacketSize;
   EFI_STATUS Status = EFI_SUCCESS;
-  EEPROM_CONTEXT *EepromContext = EEPROM_SC_FROM_EEPROM(This);
   UINT32 BufferLength;
   UINT32 Transmitted = 0;
   UINT32 CurrentAddress = Address;
@@ -144,6 +143,86 @@ MvEepromTransfer (
   return Status;
 }
 
+STATIC
+VOID
+MvEepromInvalidateCache (
+  IN EEPROM_CONTEXT *EepromContext,
+  IN UINT32 Address,
+  IN UINT32 Length
+  )
+{
+  UINT32 Block;
+  UINT32 LastBlock;
+
+  if (EepromContext->Cache == NULL || Length == 0) {
+    return;
+  }
+
+  /* Writes past the end of the address space wrap around */
+  if (Address + Length > EEPROM_CACHE_SIZE) {
+    ZeroMem (EepromContext->CacheValid, sizeof (EepromContext->CacheValid));
+    return;
+  }
+
+  LastBlock = (Address + Length - 1) / MAX_BUFFER_LENGTH;
+  for (Block = Address / MAX_BUFFER_LENGTH; Block <= LastBlock; Block++) {
+    EepromContext->CacheValid[Block / 8] &= ~(1 << (Block % 8));
+  }
+}
+
+EFI_STATUS
+EFIAPI
+MvEepromTransfer (
+  IN CONST MARVELL_EEPROM_PROTOCOL *This,
+  IN UINT16 Address,
+  IN UINT32 Length,
+  IN UINT8 *Buffer,
+  IN UINT8 Operation
+  )
+{
+  EFI_STATUS Status;
+  EEPROM_CONTEXT *EepromContext = EEPROM_SC_FROM_EEPROM(This);
+  UINT32 Block;
+  UINT32 LastBlock;
+
+  if (Operation != EEPROM_READ) {
+    Status = MvEepromBusTransfer (EepromContext, Address, Length, Buffer, Operation);
+    MvEepromInvalidateCache (EepromContext, Address, Length);
+    return Status;
+  }
+
+  if (Length == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (EepromContext->Cache == NULL) {
+    EepromContext->Cache = AllocatePool (EEPROM_CACHE_SIZE);
+  }
+  if (EepromContext->Cache == NULL || (UINT32)Address + Length > EEPROM_CACHE_SIZE) {
+    return MvEepromBusTransfer (EepromContext, Address, Length, Buffer, Operation);
+  }
+
+  /* Fill the missing blocks with page-sized reads, then serve the read */
+  LastBlock = ((UINT32)Address + Length - 1) / MAX_BUFFER_LENGTH;
+  for (Block = Address / MAX_BUFFER_LENGTH; Block <= LastBlock; Block++) {
+    if (EepromContext->CacheValid[Block / 8] & (1 << (Block % 8))) {
+      continue;
+    }
+    Status = MvEepromBusTransfer (EepromContext,
+               (UINT16)(Block * MAX_BUFFER_LENGTH),
+               MAX_BUFFER_LENGTH,
+               EepromContext->Cache + Block * MAX_BUFFER_LENGTH,
+               EEPROM_READ);
+    if (EFI_ERROR(Status)) {
+      return Status;
+    }
+    EepromContext->CacheValid[Block / 8] |= 1 << (Block % 8);
+  }
+
+  CopyMem (Buffer, EepromContext->Cache + Address, Length);
+  return EFI_SUCCESS;
+}
+
 EFI_STATUS
 EFIAPI
 MvEepromStart (
@@ -243,6 +322,9 @@ MvEepromStop (
       gImageHandle,
       ControllerHandle
       );
+  if (EepromContext->Cache != NULL) {
+    FreePool(EepromContext->Cache);
+  }
   FreePool(EepromContext);
   return EFI_SUCCESS;
 }
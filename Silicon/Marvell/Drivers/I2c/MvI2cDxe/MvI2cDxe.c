@@ -502,7 +502,11 @@ MvI2cRead (
     else
       MvI2cControlSet(I2cMasterContext, I2C_CONTROL_ACK);
 
-    gBS->Stall (I2C_OPERATION_TIMEOUT);
+    /*
+     * IFLG is already set here, so clearing it starts the next byte at once.
+     * There is no fixed delay per byte, the poll below waits for the slave,
+     * including while it stretches the clock.
+     */
     MvI2cClearIflg(I2cMasterContext);
 
     if (MvI2cPollCtrl(I2cMasterContext, delay, I2C_CONTROL_IFLG)) {
@@ -583,6 +587,7 @@ MvI2cStartRequest (
 {
   UINTN Count;
   UINTN ReadMode;
+  UINTN LastRead;
   UINTN Transmitted;
   I2C_MASTER_CONTEXT *I2cMasterContext = I2C_SC_FROM_MASTER(This);
   EFI_I2C_OPERATION *Operation;
@@ -616,11 +621,17 @@ MvI2cStartRequest (
      * proceed to read or write section.
      */
     if (ReadMode) {
+      /*
+       * The last byte before a STOP or a repeated START is not ACKed,
+       * whatever the position of the read in the request.
+       */
+      LastRead = (Count == RequestPacket->OperationCount - 1) ||
+                 !(RequestPacket->Operation[Count + 1].Flags & I2C_FLAG_NORESTART);
       Status = MvI2cRead (I2cMasterContext,
                  Operation->Buffer,
                  Operation->LengthInBytes,
                  &Transmitted,
-                 Count == 1,
+                 LastRead,
                  I2C_TRANSFER_TIMEOUT);
       Operation->LengthInBytes = Transmitted;
     } else {
@@ -647,11 +658,14 @@ MvI2cStartRequest (
     }
   }
 
+  /* An asynchronous request reports its result through I2cStatus only */
   if (I2cStatus != NULL)
-    *I2cStatus = EFI_SUCCESS;
-  if (Event != NULL)
+    *I2cStatus = Status;
+  if (Event != NULL) {
     gBS->SignalEvent(Event);
-  return EFI_SUCCESS;
+    return EFI_SUCCESS;
+  }
+  return Status;
 }
 
 STATIC CONST EFI_GUID DevGuid = I2C_GUID;
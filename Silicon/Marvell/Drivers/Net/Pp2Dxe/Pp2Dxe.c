@@ -98,12 +98,14 @@ EFI_SIMPLE_NETWORK_MODE Pp2SnpModeTemplate = {
   },                                                    // Permanent Address
   NET_IFTYPE_ETHERNET,                                  // IfType
   TRUE,                                                 // MacAddressChangeable
-  FALSE,                                                // MultipleTxSupported
+  TRUE,                                                 // MultipleTxSupported
   TRUE,                                                 // MediaPresentSupported
   FALSE                                                 // MediaPresent
 };
 
 #define QueueNext(off)  ((((off) + 1) >= QUEUE_DEPTH) ? 0 : ((off) + 1))
+#define QueueCount(Ctx) (((Ctx)->CompletionQueueTail + QUEUE_DEPTH - \
+                          (Ctx)->CompletionQueueHead) % QUEUE_DEPTH)
 
 STATIC
 EFI_STATUS
@@ -131,7 +133,8 @@ QueueRemove (
 {
   VOID *Buffer;
 
-  if (Pp2Context->CompletionQueueTail == Pp2Context->CompletionQueueHead) {
+  /* Only hand out buffers the HW is done with */
+  if (QueueCount (Pp2Context) == Pp2Context->TxPending) {
     return NULL;
   }
 
@@ -142,6 +145,27 @@ QueueRemove (
   return Buffer;
 }
 
+/*
+ * Account the descriptors HW sent since the last call. Packets are sent in
+ * order, so they complete the oldest pending buffers.
+ */
+STATIC
+VOID
+Pp2DxeTxReclaim (
+  IN PP2DXE_CONTEXT *Pp2Context
+  )
+{
+  PP2DXE_PORT *Port = &Pp2Context->Port;
+  UINTN TxSent;
+
+  if (Pp2Context->TxPending == 0) {
+    return;
+  }
+
+  TxSent = Mvpp2TxqSentDescProc (Port, &Port->Txqs[0]);
+  Pp2Context->TxPending -= MIN (TxSent, Pp2Context->TxPending);
+}
+
 STATIC
 EFI_STATUS
 Pp2DxeBmPoolInit (
@@ -483,6 +507,10 @@ Pp2DxePhyInitialize (
 {
   EFI_STATUS Status;
 
+  if (Pp2Context->PhyInitialized) {
+    return EFI_SUCCESS;
+  }
+
   Status = gBS->LocateProtocol (
                &gMarvellPhyProtocolGuid,
                NULL,
@@ -495,6 +523,7 @@ Pp2DxePhyInitialize (
 
   if (Pp2Context->Port.PhyIndex == 0xff) {
     /* PHY iniitalization not required */
+    Pp2Context->PhyInitialized = TRUE;
     return EFI_SUCCESS;
   }
 
@@ -511,10 +540,31 @@ Pp2DxePhyInitialize (
 
   Pp2Context->Phy->Status(Pp2Context->Phy, Pp2Context->PhyDev);
   Mvpp2SmiPhyAddrCfg(&Pp2Context->Port, Pp2Context->Port.GopIndex, Pp2Context->PhyDev->Addr);
+  Pp2Context->PhyInitialized = TRUE;
 
   return EFI_SUCCESS;
 }
 
+/*
+ * Configure the PHY ahead of SNP Initialize, so that the link negotiates
+ * while the boot goes on. A failure is retried by SNP Initialize.
+ */
+STATIC
+VOID
+EFIAPI
+Pp2DxePhyInitializeEvent (
+  IN EFI_EVENT Event,
+  IN VOID *Context
+  )
+{
+  PP2DXE_CONTEXT *Pp2Context = Context;
+
+  gBS->CloseEvent (Event);
+  Pp2Context->PhyInitEvent = NULL;
+
+  Pp2DxePhyInitialize (Pp2Context);
+}
+
 EFI_STATUS
 EFIAPI
 Pp2DxeSnpInitialize (
@@ -559,6 +609,11 @@ Pp2DxeSnpInitialize (
 
   Pp2Context->Initialized = TRUE;
 
+  if (Pp2Context->PhyInitEvent != NULL) {
+    gBS->CloseEvent (Pp2Context->PhyInitEvent);
+    Pp2Context->PhyInitEvent = NULL;
+  }
+
   Status = Pp2DxePhyInitialize(Pp2Context);
   if (EFI_ERROR(Status)) {
     ReturnUnlock (SavedTpl, Status);
@@ -834,6 +889,7 @@ Pp2SnpGetStatus (
   Snp->Mode->MediaPresent = LinkUp;
 
   if (TxBuf != NULL) {
+    Pp2DxeTxReclaim (Pp2Context);
     *TxBuf = QueueRemove (Pp2Context);
   }
 
@@ -858,8 +914,6 @@ Pp2SnpTransmit (
   MVPP2_TX_QUEUE *AggrTxq = Mvpp2Shared->AggrTxqs;
   MVPP2_TX_DESC *TxDesc;
   EFI_STATUS Status;
-  INTN PollingCount;
-  INTN TxSent;
   UINT8 *DataPtr = Buffer;
   UINT16 EtherType;
   UINT32 State = This->Mode->State;
@@ -899,6 +953,16 @@ Pp2SnpTransmit (
 
   EtherType = HTONS (*EtherTypePtr);
 
+  /*
+   * Keep the in-flight packets within the port TXQ ring and make sure the
+   * buffer can be recycled through the completion queue.
+   */
+  Pp2DxeTxReclaim (Pp2Context);
+  if (Pp2Context->TxPending >= Port->TxRingSize ||
+      QueueNext (Pp2Context->CompletionQueueTail) == Pp2Context->CompletionQueueHead) {
+    ReturnUnlock (SavedTpl, EFI_NOT_READY);
+  }
+
   /* Fetch next descriptor */
   TxDesc = Mvpp2TxqNextDescGet(AggrTxq);
 
@@ -928,41 +992,20 @@ Pp2SnpTransmit (
 
   InvalidateDataCacheRange (DataPtr, BufferSize);
 
-  /* Issue send */
-  Mvpp2AggrTxqPendDescAdd(Port, 1);
-
   /*
-   * Egress processing:
-   * Wait until packet is passed from per-cpu aggregated queue
-   * to physical per-port TXQ.
+   * Queue the buffer before issuing the send, it is handed back by
+   * GetStatus once HW reports the packet sent.
    */
-  PollingCount = 0;
-  TxSent = Mvpp2AggrTxqPendDescNumGet(Mvpp2Shared, 0);
-  do {
-    if (PollingCount++ > MVPP2_TX_SEND_MAX_POLLING_COUNT) {
-      DEBUG((DEBUG_ERROR, "Pp2Dxe: transmit polling failed\n"));
-      ReturnUnlock(SavedTpl, EFI_TIMEOUT);
-    }
-    TxSent = Mvpp2AggrTxqPendDescNumGet(Mvpp2Shared, 0);
-  } while (TxSent);
-
-  /* Wait for packet to be transmitted by hardware. */
-  PollingCount = 0;
-  TxSent = Mvpp2TxqSentDescProc(Port, &Port->Txqs[0]);
-  while (!TxSent) {
-    if (PollingCount++ > MVPP2_TX_SEND_MAX_POLLING_COUNT) {
-      DEBUG((DEBUG_ERROR, "Pp2Dxe: transmit polling failed\n"));
-      ReturnUnlock(SavedTpl, EFI_TIMEOUT);
-    }
-    TxSent = Mvpp2TxqSentDescProc(Port, &Port->Txqs[0]);
+  Status = QueueInsert (Pp2Context, Buffer);
+  if (EFI_ERROR (Status)) {
+    ReturnUnlock (SavedTpl, EFI_NOT_READY);
   }
+  Pp2Context->TxPending++;
 
-  /*
-   * At this point TxSent has increased - HW sent the packet
-   * Add buffer to completion queue and return.
-   */
-  Status = QueueInsert (Pp2Context, Buffer);
-  ReturnUnlock (SavedTpl, Status);
+  /* Issue send */
+  Mvpp2AggrTxqPendDescAdd(Port, 1);
+
+  ReturnUnlock (SavedTpl, EFI_SUCCESS);
 }
 
 EFI_STATUS
@@ -995,14 +1038,29 @@ Pp2SnpReceive (
   ASSERT (Rxq != NULL);
 
   SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
-  ReceivedPackets = Mvpp2RxqReceived(Port, Rxq->Id);
 
-  if (ReceivedPackets == 0) {
-    ReturnUnlock(SavedTpl, EFI_NOT_READY);
+  /*
+   * The received descriptors are harvested in bursts: the RXQ status is
+   * read and updated once per burst rather than per packet.
+   */
+  if (Pp2Context->RxPending == 0) {
+    if (Pp2Context->RxProcessed != 0) {
+      Mvpp2RxqStatusUpdate(Port, Rxq->Id, Pp2Context->RxProcessed, Pp2Context->RxProcessed);
+      Pp2Context->RxProcessed = 0;
+    }
+
+    ReceivedPackets = Mvpp2RxqReceived(Port, Rxq->Id);
+    if (ReceivedPackets == 0) {
+      ReturnUnlock(SavedTpl, EFI_NOT_READY);
+    }
+    Pp2Context->RxPending = ReceivedPackets;
   }
 
-  /* Process one packet per call */
-  RxDesc = Mvpp2RxqNextDescGet(Rxq);
+  /*
+   * Process one packet per call. The descriptor is only consumed once the
+   * packet is handled, so that a too small buffer can be retried.
+   */
+  RxDesc = Rxq->Descs + Rxq->NextDescToProc;
   StatusReg = RxDesc->status;
 
   /* extract addresses from descriptor */
@@ -1050,12 +1108,15 @@ Pp2SnpReceive (
   }
 
 drop:
+  Mvpp2RxqNextDescGet(Rxq);
+
   /* Refill: pass packet back to BM */
   PoolId = (StatusReg & MVPP2_RXD_BM_POOL_ID_MASK) >> MVPP2_RXD_BM_POOL_ID_OFFS;
   Mvpp2BmPoolPut(Mvpp2Shared, PoolId, PhysAddr, VirtAddr);
 
-  /* Update counters with 1 packet received and 1 packet refilled */
-  Mvpp2RxqStatusUpdate(Port, Rxq->Id, 1, 1);
+  /* The RXQ counters are updated with the whole burst */
+  Pp2Context->RxPending--;
+  Pp2Context->RxProcessed++;
 
   ReturnUnlock(SavedTpl, Status);
 }
@@ -1466,6 +1527,28 @@ Pp2DxeInitialiseController (
     if (EFI_ERROR(Status)) {
       return Status;
     }
+
+    /*
+     * The PHY configuration is quick unless the PHY driver waits for the
+     * autonegotiation at startup. In that case leave it to SNP Initialize,
+     * so that boots not using the network don't wait for the link.
+     */
+    if (!PcdGetBool (PcdPhyStartupAutoneg)) {
+      Status = gBS->CreateEvent (
+                   EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                   TPL_CALLBACK,
+                   Pp2DxePhyInitializeEvent,
+                   Pp2Context,
+                   &Pp2Context->PhyInitEvent
+                 );
+      if (!EFI_ERROR (Status)) {
+        Status = gBS->SetTimer (Pp2Context->PhyInitEvent, TimerRelative, 0);
+        if (EFI_ERROR (Status)) {
+          gBS->CloseEvent (Pp2Context->PhyInitEvent);
+          Pp2Context->PhyInitEvent = NULL;
+        }
+      }
+    }
   }
 
   MvGop110NetcInit(&Pp2Context->Port, NetCompConfig, MV_NETC_FIRST_PHASE);
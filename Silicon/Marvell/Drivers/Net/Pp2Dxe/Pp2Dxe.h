@@ -142,12 +142,6 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #define WRAP                              (2 + ETH_HLEN + 4 + 32)
 #define MTU                               1500
 
-/*
- * Maximum retries of checking, wheter HW really sent the packet
- * after it was done is software.
- */
-#define MVPP2_TX_SEND_MAX_POLLING_COUNT   10000
-
 /* Structures */
 typedef struct {
   /* Physical number of this Tx queue */
@@ -335,9 +329,17 @@ typedef struct {
   PP2DXE_PORT                 Port;
   BOOLEAN                     Initialized;
   BOOLEAN                     LateInitialized;
+  BOOLEAN                     PhyInitialized;
+  EFI_EVENT                   PhyInitEvent;
   VOID                        *CompletionQueue[QUEUE_DEPTH];
   UINTN                       CompletionQueueHead;
   UINTN                       CompletionQueueTail;
+  /* Buffers at the tail of CompletionQueue not sent by HW yet */
+  UINTN                       TxPending;
+  /* RX descriptors received by HW, not processed yet */
+  UINTN                       RxPending;
+  /* RX descriptors processed, not returned to HW yet */
+  UINTN                       RxProcessed;
   EFI_EVENT                   EfiExitBootServicesEvent;
   PP2_DEVICE_PATH             *DevicePath;
   EFI_ADAPTER_INFORMATION_PROTOCOL Aip;
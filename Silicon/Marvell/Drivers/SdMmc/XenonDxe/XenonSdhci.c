@@ -347,6 +347,36 @@ EmmcPhyConfigTuning (
   return EFI_SUCCESS;
 }
 
+//
+// HS400 samples the read data on the data strobe driven by the card.
+// The DLL has to be locked before the strobe is enabled, and the strobe
+// line is pulled down while idle.
+//
+STATIC
+EFI_STATUS
+EmmcPhyEnableStrobe (
+  IN EFI_PCI_IO_PROTOCOL   *PciIo
+  )
+{
+  UINT32 Var;
+  EFI_STATUS Status;
+
+  Status = EmmcPhyEnableDll (PciIo);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Var = ENABLE_DATA_STROBE;
+  XenonHcOrMmio (PciIo, SD_BAR_INDEX, XENON_SLOT_EMMC_CTRL, SDHC_REG_SIZE_4B, &Var);
+
+  XenonHcRwMmio (PciIo, SD_BAR_INDEX, EMMC_PHY_PAD_CONTROL1, TRUE, SDHC_REG_SIZE_4B, &Var);
+  Var |= EMMC5_1_FC_QSP_PD;
+  Var &= ~EMMC5_1_FC_QSP_PU;
+  XenonHcRwMmio (PciIo, SD_BAR_INDEX, EMMC_PHY_PAD_CONTROL1, FALSE, SDHC_REG_SIZE_4B, &Var);
+
+  return EFI_SUCCESS;
+}
+
 STATIC
 BOOLEAN
 XenonPhySlowMode (
@@ -478,6 +508,10 @@ PhyInit:
     return EmmcPhyConfigTuning (PciIo, TuningStepDivisor);
   }
 
+  if (Timing == SdMmcMmcHs400) {
+    return EmmcPhyEnableStrobe (PciIo);
+  }
+
   return EFI_SUCCESS;
 }
 
@@ -612,113 +646,6 @@ XenonReset (
   }
 }
 
-STATIC
-VOID
-XenonTransferPio (
-  IN UINT8 Slot,
-  IN OUT VOID *Buffer,
-  IN UINT16 BlockSize,
-  IN BOOLEAN Read
-  )
-{
-  UINTN Index;
-  UINT8 *Offs;
-
-  //
-  // SD stack's intrinsic functions cannot perform properly reading/writing from
-  // buffer register, that is why MmioRead/MmioWrite are used. It is temporary
-  // solution.
-  //
-  for (Index = 0; Index < BlockSize; Index += 4) {
-    Offs = (UINT8*)((UINTN)Buffer + Index);
-    if (Read) {
-      *(UINT32 *)Offs = MmioRead32 (SDHC_DAT_BUF_PORT_ADDR);
-    } else {
-      MmioWrite32 (SDHC_DAT_BUF_PORT_ADDR, *(UINT32 *)Offs);
-    }
-  }
-}
-
-EFI_STATUS
-XenonTransferData (
-  IN EFI_PCI_IO_PROTOCOL *PciIo,
-  IN UINT8 Slot,
-  IN OUT VOID *Buffer,
-  IN UINT32 DataLen,
-  IN UINT16 BlockSize,
-  IN UINT16 Blocks,
-  IN BOOLEAN Read
-  )
-{
-  UINT32 IntStatus, PresentState, Rdy, Mask, Retry, Block = 0;
-
-  if (Buffer == NULL) {
-    return EFI_DEVICE_ERROR;
-  }
-
-  Retry = SDHC_INT_STATUS_POLL_RETRY_DATA_TRAN;
-  Rdy = NOR_INT_STS_TX_RDY | NOR_INT_STS_RX_RDY;
-  Mask = PRESENT_STATE_BUFFER_RD_EN | PRESENT_STATE_BUFFER_WR_EN;
-
-  do {
-    XenonHcRwMmio (
-            PciIo,
-            Slot,
-            SDHC_NOR_INT_STS,
-            TRUE,
-            sizeof (IntStatus),
-            &IntStatus
-          );
-
-    if (IntStatus & NOR_INT_STS_ERR_INT) {
-      DEBUG((DEBUG_INFO, "SD/MMC: Error detected in status %0x\n", IntStatus));
-      return EFI_DEVICE_ERROR;
-    }
-
-    if (IntStatus & Rdy) {
-      XenonHcRwMmio (
-              PciIo,
-              Slot,
-              SDHC_PRESENT_STATE,
-              TRUE,
-              sizeof (PresentState),
-              &PresentState
-            );
-
-      if (!(PresentState & Mask)) {
-        continue;
-      }
-
-      XenonHcRwMmio (
-              PciIo,
-              Slot,
-              SDHC_NOR_INT_STS,
-              FALSE,
-              sizeof (Rdy),
-              &Rdy
-            );
-
-      XenonTransferPio (Slot, Buffer, BlockSize, Read);
-
-      Buffer = (VOID*)((UINTN)Buffer + BlockSize);
-      if (++Block >= Blocks) {
-        break;
-      }
-    }
-
-    if (Retry-- > 0) {
-
-      // Poll interval for data transfer complete bit in NOR_INT_STS register is 10us
-      gBS->Stall (10);
-    } else {
-      DEBUG((DEBUG_INFO, "SD/MMC: Transfer data timeout\n"));
-      return EFI_TIMEOUT;
-    }
-  } while (!(IntStatus & NOR_INT_STS_XFER_COMPLETE));
-
-  return EFI_SUCCESS;
-}
-
 EFI_STATUS
 XenonInit (
   IN EFI_PCI_IO_PROTOCOL *PciIo,
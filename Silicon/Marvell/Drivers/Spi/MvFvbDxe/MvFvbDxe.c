@@ -855,26 +855,21 @@ MvFvbEraseBlocks (
     // How many Lba blocks are we requested to erase?
     NumOfLba = VA_ARG (Args, UINT32);
 
-    // Go through each one and erase it
-    while (NumOfLba > 0) {
-
-      // Get the physical address of Lba to erase
-      BlockAddress = GET_DATA_OFFSET (FlashInstance->FvbOffset,
-                       FlashInstance->StartLba + StartingLba,
-                       FlashInstance->Media.BlockSize);
-
-      // Erase single block
-      Status = FlashInstance->SpiFlashProtocol->Erase (&FlashInstance->SpiDevice,
-                                                  BlockAddress,
-                                                  FlashInstance->Media.BlockSize);
-      if (EFI_ERROR (Status)) {
-        VA_END (Args);
-        return EFI_DEVICE_ERROR;
-      }
-
-      // Move to the next Lba
-      StartingLba++;
-      NumOfLba--;
+    // Get the physical address of the first Lba to erase
+    BlockAddress = GET_DATA_OFFSET (FlashInstance->FvbOffset,
+                     FlashInstance->StartLba + StartingLba,
+                     FlashInstance->Media.BlockSize);
+
+    //
+    // Erase the whole range at once, so that the flash driver can cover it
+    // with its largest erase commands.
+    //
+    Status = FlashInstance->SpiFlashProtocol->Erase (&FlashInstance->SpiDevice,
+                                                BlockAddress,
+                                                NumOfLba * FlashInstance->Media.BlockSize);
+    if (EFI_ERROR (Status)) {
+      VA_END (Args);
+      return EFI_DEVICE_ERROR;
     }
   } while (TRUE);
   VA_END (Args);
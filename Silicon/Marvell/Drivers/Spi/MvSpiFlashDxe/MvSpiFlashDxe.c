@@ -68,19 +68,17 @@ MvSpiFlashWriteEnableCmd (
 
 STATIC
 EFI_STATUS
-MvSpiFlashWriteCommon (
-  IN SPI_DEVICE *Slave,
-  IN UINT8 *Cmd,
-  IN UINT32 Length,
-  IN UINT8* Buffer,
-  IN UINT32 BufferLength
+MvSpiFlashWaitReady (
+  IN SPI_DEVICE *Slave
   )
 {
   UINT8 CmdStatus = CMD_READ_STATUS;
   UINT8 State;
-  UINT32 Counter = 0xFFFFF;
   UINT8 PollBit = STATUS_REG_POLL_WIP;
   UINT8 CheckStatus = 0x0;
+  UINTN Delay;
+  UINTN Elapsed;
+  BOOLEAN Ready;
 
   if (Slave->Info->Flags & NOR_FLASH_WRITE_FSR) {
     CmdStatus = CMD_FLAG_STATUS;
@@ -88,34 +86,77 @@ MvSpiFlashWriteCommon (
     CheckStatus = STATUS_REG_POLL_PEC;
   }
 
-  // Send command
-  MvSpiFlashWriteEnableCmd (Slave);
-
-  // Write data
-  SpiMasterProtocol->ReadWrite (SpiMasterProtocol, Slave, Cmd, Length,
-    Buffer, NULL, BufferLength);
-
   // Poll status register
   SpiMasterProtocol->Transfer (SpiMasterProtocol, Slave, 1, &CmdStatus,
     NULL, SPI_TRANSFER_BEGIN);
-  do {
+
+  //
+  // A page program completes within a millisecond, while a sector erase
+  // may take seconds. Back off exponentially between the status reads, so
+  // that the quick operations are caught early without keeping the bus
+  // busy for the slow ones.
+  //
+  Ready = FALSE;
+  Delay = SPI_FLASH_POLL_MIN_DELAY;
+  for (Elapsed = 0; Elapsed < SPI_FLASH_POLL_TIMEOUT; Elapsed += Delay) {
     SpiMasterProtocol->Transfer (SpiMasterProtocol, Slave, 1, NULL, &State,
       0);
-    Counter--;
-    if ((State & PollBit) == CheckStatus)
+    if ((State & PollBit) == CheckStatus) {
+      Ready = TRUE;
       break;
-  } while (Counter > 0);
-  if (Counter == 0) {
-    DEBUG((DEBUG_ERROR, "SpiFlash: Timeout while writing to spi flash\n"));
-    return EFI_DEVICE_ERROR;
+    }
+    MicroSecondDelay (Delay);
+    Delay = MIN (Delay * 2, SPI_FLASH_POLL_MAX_DELAY);
   }
 
   // Deactivate CS
   SpiMasterProtocol->Transfer (SpiMasterProtocol, Slave, 0, NULL, NULL, SPI_TRANSFER_END);
 
+  if (!Ready) {
+    DEBUG((DEBUG_ERROR, "SpiFlash: Timeout while writing to spi flash\n"));
+    return EFI_DEVICE_ERROR;
+  }
+
   return EFI_SUCCESS;
 }
 
+STATIC
+EFI_STATUS
+MvSpiFlashWriteCommon (
+  IN SPI_DEVICE *Slave,
+  IN UINT8 *Cmd,
+  IN UINT32 Length,
+  IN UINT8* Buffer,
+  IN UINT32 BufferLength
+  )
+{
+  // Send command
+  MvSpiFlashWriteEnableCmd (Slave);
+
+  // Write data
+  SpiMasterProtocol->ReadWrite (SpiMasterProtocol, Slave, Cmd, Length,
+    Buffer, NULL, BufferLength);
+
+  return MvSpiFlashWaitReady (Slave);
+}
+
+STATIC
+BOOLEAN
+SpiFlashIsErased (
+  IN UINT8 *Buffer,
+  IN UINTN Length
+  )
+{
+  UINTN Index;
+
+  for (Index = 0; Index < Length; Index++) {
+    if (Buffer[Index] != 0xFF) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
+
 STATIC
 VOID
 SpiFlashCmdBankaddrWrite (
@@ -133,18 +174,27 @@ SpiFlashCmdBankaddrWrite (
   MvSpiFlashWriteCommon (Slave, &Cmd, 1, &BankSel, 1);
 }
 
+//
+// The bank register only extends 3 byte addresses and keeps its value
+// between commands, so it is written when an operation first touches a
+// bank. CurrentBank is -1 at the start of each operation.
+//
 STATIC
 UINT8
 SpiFlashBank (
-  IN SPI_DEVICE *Slave,
-  IN UINT32 Offset
+  IN     SPI_DEVICE *Slave,
+  IN     UINT32     Offset,
+  IN OUT INTN       *CurrentBank
   )
 {
   UINT8 BankSel;
 
   BankSel = Offset / SPI_FLASH_16MB_BOUN;
 
-  SpiFlashCmdBankaddrWrite (Slave, BankSel);
+  if (Slave->AddrSize != 4 && BankSel != *CurrentBank) {
+    SpiFlashCmdBankaddrWrite (Slave, BankSel);
+    *CurrentBank = BankSel;
+  }
 
   return BankSel;
 }
@@ -159,30 +209,48 @@ MvSpiFlashErase (
   EFI_STATUS Status;
   UINT32 EraseAddr;
   UINTN EraseSize;
+  UINTN MinEraseSize;
+  UINTN SectorSize;
   UINT8 Cmd[5];
+  INTN CurrentBank;
 
+  SectorSize = Slave->Info->SectorSize;
   if (Slave->Info->Flags & NOR_FLASH_ERASE_4K) {
-    Cmd[0] = CMD_ERASE_4K;
-    EraseSize = SIZE_4KB;
+    MinEraseSize = SIZE_4KB;
   } else if (Slave->Info->Flags & NOR_FLASH_ERASE_32K) {
-    Cmd[0] = CMD_ERASE_32K;
-    EraseSize = SIZE_32KB;
+    MinEraseSize = SIZE_32KB;
   } else {
-    Cmd[0] = CMD_ERASE_64K;
-    EraseSize = Slave->Info->SectorSize;
+    MinEraseSize = SectorSize;
   }
 
   // Check input parameters
-  if (Offset % EraseSize || Length % EraseSize) {
+  if (Offset % MinEraseSize || Length % MinEraseSize) {
     DEBUG((DEBUG_ERROR, "SpiFlash: Either erase offset or length "
       "is not multiple of erase size\n"));
     return EFI_DEVICE_ERROR;
   }
 
+  CurrentBank = -1;
   while (Length) {
     EraseAddr = Offset;
 
-    SpiFlashBank (Slave, EraseAddr);
+    //
+    // Use the largest erase the remaining range is aligned to. A sector
+    // erase takes much less time than the small block erases it covers.
+    //
+    if ((Offset % SectorSize) == 0 && Length >= SectorSize) {
+      Cmd[0] = CMD_ERASE_64K;
+      EraseSize = SectorSize;
+    } else if ((Slave->Info->Flags & NOR_FLASH_ERASE_32K) &&
+               (Offset % SIZE_32KB) == 0 && Length >= SIZE_32KB) {
+      Cmd[0] = CMD_ERASE_32K;
+      EraseSize = SIZE_32KB;
+    } else {
+      Cmd[0] = CMD_ERASE_4K;
+      EraseSize = SIZE_4KB;
+    }
+
+    SpiFlashBank (Slave, EraseAddr, &CurrentBank);
 
     SpiFlashFormatAddress (EraseAddr, Slave->AddrSize, Cmd);
 
@@ -211,6 +279,7 @@ MvSpiFlashRead (
   UINT8 Cmd[6];
   UINT32 ReadAddr, ReadLength, RemainLength;
   UINTN BankSel = 0;
+  INTN CurrentBank = -1;
 
   Cmd[0] = CMD_READ_ARRAY_FAST;
 
@@ -220,7 +289,7 @@ MvSpiFlashRead (
   while (Length) {
     ReadAddr = Offset;
 
-    BankSel = SpiFlashBank (Slave, ReadAddr);
+    BankSel = SpiFlashBank (Slave, ReadAddr, &CurrentBank);
 
     RemainLength = (SPI_FLASH_16MB_BOUN * (BankSel + 1)) - Offset;
     if (Length < RemainLength) {
@@ -230,7 +299,7 @@ MvSpiFlashRead (
     }
     SpiFlashFormatAddress (ReadAddr, Slave->AddrSize, Cmd);
     // Program proper read address and read data
-    Status = MvSpiFlashReadCmd (Slave, Cmd, Slave->AddrSize + 2, Buf, Length);
+    Status = MvSpiFlashReadCmd (Slave, Cmd, Slave->AddrSize + 2, Buf, ReadLength);
 
     Offset += ReadLength;
     Length -= ReadLength;
@@ -252,6 +321,7 @@ MvSpiFlashWrite (
   UINTN ByteAddr, ChunkLength, ActualIndex, PageSize;
   UINT32 WriteAddr;
   UINT8 Cmd[5];
+  INTN CurrentBank = -1;
 
   PageSize = Slave->Info->PageSize;
 
@@ -260,12 +330,21 @@ MvSpiFlashWrite (
   for (ActualIndex = 0; ActualIndex < Length; ActualIndex += ChunkLength) {
     WriteAddr = Offset;
 
-    SpiFlashBank (Slave, WriteAddr);
-
     ByteAddr = Offset % PageSize;
 
     ChunkLength = MIN(Length - ActualIndex, (UINT64) (PageSize - ByteAddr));
 
+    //
+    // Programming can only clear bits, a chunk of all ones would leave the
+    // flash as it is and doesn't need a program cycle.
+    //
+    if (SpiFlashIsErased ((UINT8 *)Buf + ActualIndex, ChunkLength)) {
+      Offset += ChunkLength;
+      continue;
+    }
+
+    SpiFlashBank (Slave, WriteAddr, &CurrentBank);
+
     SpiFlashFormatAddress (WriteAddr, Slave->AddrSize, Cmd);
 
     // Program proper write address and write data
@@ -295,6 +374,9 @@ MvSpiFlashUpdateBlock (
   )
 {
   EFI_STATUS Status;
+  UINTN Index;
+  UINTN ChunkLength;
+  UINTN PageSize;
 
   // Read backup
   Status = MvSpiFlashRead (Slave, Offset, EraseSize, TmpBuf);
@@ -303,6 +385,35 @@ MvSpiFlashUpdateBlock (
       return Status;
     }
 
+  //
+  // The backup is the current content of the sector, so for an image that
+  // only partly changed, the pages which already match can be skipped. As
+  // long as the new data only clears bits, the differing pages can also be
+  // programmed over the old content without erasing the sector.
+  //
+  for (Index = 0; Index < ToUpdate; Index++) {
+    if ((TmpBuf[Index] & Buf[Index]) != Buf[Index]) {
+      break;
+    }
+  }
+
+  if (Index == ToUpdate) {
+    PageSize = Slave->Info->PageSize;
+    for (Index = 0; Index < ToUpdate; Index += ChunkLength) {
+      ChunkLength = MIN (ToUpdate - Index, PageSize - ((Offset + Index) % PageSize));
+      if (CompareMem (&TmpBuf[Index], &Buf[Index], ChunkLength) == 0) {
+        continue;
+      }
+
+      Status = MvSpiFlashWrite (Slave, Offset + Index, ChunkLength, &Buf[Index]);
+      if (EFI_ERROR (Status)) {
+        DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while writing new data\n"));
+        return Status;
+      }
+    }
+    return EFI_SUCCESS;
+  }
+
   // Erase entire sector
   Status = MvSpiFlashErase (Slave, Offset, EraseSize);
   if (EFI_ERROR (Status)) {
@@ -310,23 +421,14 @@ MvSpiFlashUpdateBlock (
       return Status;
     }
 
-  // Write new data
-  MvSpiFlashWrite (Slave, Offset, ToUpdate, Buf);
+  // Write new data merged with the backup, the erased pages are skipped
+  CopyMem (TmpBuf, Buf, ToUpdate);
+  Status = MvSpiFlashWrite (Slave, Offset, EraseSize, TmpBuf);
   if (EFI_ERROR (Status)) {
       DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while writing new data\n"));
       return Status;
     }
 
-  // Write backup
-  if (ToUpdate != EraseSize) {
-    Status = MvSpiFlashWrite (Slave, Offset + ToUpdate, EraseSize - ToUpdate,
-      &TmpBuf[ToUpdate]);
-    if (EFI_ERROR (Status)) {
-      DEBUG((DEBUG_ERROR, "SpiFlash: Update: Error while writing backup\n"));
-      return Status;
-    }
-  }
-
   return EFI_SUCCESS;
 }
 
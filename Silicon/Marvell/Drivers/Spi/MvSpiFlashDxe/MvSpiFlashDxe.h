@@ -12,6 +12,7 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 #include <Library/UefiLib.h>
 #include <Library/DebugLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/TimerLib.h>
 #include <Uefi/UefiBaseType.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/UefiBootServicesTableLib.h>
@@ -47,6 +48,11 @@ SPDX-License-Identifier: BSD-2-Clause-Patent
 
 #define SPI_FLASH_16MB_BOUN             0x1000000
 
+// Status polling, in microseconds
+#define SPI_FLASH_POLL_MIN_DELAY        1
+#define SPI_FLASH_POLL_MAX_DELAY        1000
+#define SPI_FLASH_POLL_TIMEOUT          10000000
+
 typedef enum {
   SPI_FLASH_READ_ID,
   SPI_FLASH_READ, // Read from SPI flash with address
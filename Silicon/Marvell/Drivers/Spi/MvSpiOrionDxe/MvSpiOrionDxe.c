@@ -192,10 +192,11 @@ MvSpiTransfer (
     SpiActivateCs (Slave);
   }
 
-  // Set 8-bit mode
+  // Set 8-bit mode, it is usually still set from the previous transfer
   Reg = MmioRead32 (SpiRegBase + SPI_CONF_REG);
-  Reg &= ~SPI_BYTE_LENGTH;
-  MmioWrite32 (SpiRegBase + SPI_CONF_REG, Reg);
+  if (Reg & SPI_BYTE_LENGTH) {
+    MmioWrite32 (SpiRegBase + SPI_CONF_REG, Reg & ~SPI_BYTE_LENGTH);
+  }
 
   while (Length > 0) {
     if (DataOut != NULL) {
@@ -221,6 +222,10 @@ MvSpiTransfer (
 
     if (Iterator >= SPI_TIMEOUT) {
       DEBUG ((DEBUG_ERROR, "%a: Timeout\n", __FUNCTION__));
+      SpiDeactivateCs (Slave);
+      if (!EfiAtRuntime ()) {
+        EfiReleaseLock (&SpiMaster->Lock);
+      }
       return EFI_TIMEOUT;
     }
   }
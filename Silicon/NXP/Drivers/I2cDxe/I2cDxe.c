@@ -50,6 +50,10 @@ SetBusFrequency (
 
   I2c = NXP_I2C_FROM_THIS (This);
 
+  if (I2c->PendingRequest.Event != NULL) {
+    return EFI_ALREADY_STARTED;
+  }
+
   I2cBase = (UINTN)(I2c->Dev->Resources[0].AddrRangeMin);
 
   I2cClock = gPlatformGetClockPpi.PlatformGetClock (NXP_I2C_CLOCK, 0);
@@ -76,6 +80,64 @@ Reset (
   return EFI_SUCCESS;
 }
 
+/**
+  Run the asynchronous request queued by StartRequest() and signal its event.
+
+  @param  Event            The request timer
+  @param  Context          Pointer to the NXP_I2C_MASTER
+**/
+STATIC
+VOID
+EFIAPI
+RunPendingRequest (
+  IN EFI_EVENT                     Event,
+  IN VOID                          *Context
+  )
+{
+  NXP_I2C_MASTER           *I2c;
+  NXP_I2C_REQUEST          Request;
+  UINTN                    I2cBase;
+  EFI_STATUS               Status;
+  EFI_TPL                  Tpl;
+
+  I2c = (NXP_I2C_MASTER *)Context;
+
+  I2cBase = (UINTN)(I2c->Dev->Resources[0].AddrRangeMin);
+
+  Tpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  CopyMem (&Request, &I2c->PendingRequest, sizeof (Request));
+  if (Request.Event == NULL) {
+    gBS->RestoreTPL (Tpl);
+    return;
+  }
+  Status = I2cBusXfer (I2cBase, Request.SlaveAddress, Request.RequestPacket);
+  ZeroMem (&I2c->PendingRequest, sizeof (I2c->PendingRequest));
+  gBS->RestoreTPL (Tpl);
+
+  if (Request.I2cStatus != NULL) {
+    *Request.I2cStatus = Status;
+  }
+  gBS->SignalEvent (Request.Event);
+}
+
+/**
+  Start an I2C transaction on the controller.
+
+  All the operations of RequestPacket are done in one transaction, with a
+  repeated start between them. When Event is not NULL the request runs from
+  the request timer and the function returns at once. The controller has one
+  request in flight, the I2C host protocol queues the others.
+
+  @param  This             Pointer to I2c master protocol
+  @param  SlaveAddress     Address of the device on the I2C bus
+  @param  RequestPacket    The operations of the transaction
+  @param  Event            Event to signal for an asynchronous transaction
+  @param  I2cStatus        Status of an asynchronous transaction
+
+  @retval EFI_SUCCESS          The transaction completed, or was started if
+                               Event is not NULL
+  @retval EFI_ALREADY_STARTED  An asynchronous transaction is in progress
+**/
 STATIC
 EFI_STATUS
 EFIAPI
@@ -93,12 +155,32 @@ StartRequest (
   EFI_TPL                  Tpl;
   BOOLEAN                  AtRuntime;
 
+  I2c = NXP_I2C_FROM_THIS (This);
+
   AtRuntime = EfiAtRuntime ();
-  if (!AtRuntime) {
+  if (Event != NULL && !AtRuntime) {
     Tpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+    if (I2c->PendingRequest.Event != NULL) {
+      gBS->RestoreTPL (Tpl);
+      return EFI_ALREADY_STARTED;
+    }
+    I2c->PendingRequest.SlaveAddress  = SlaveAddress;
+    I2c->PendingRequest.RequestPacket = RequestPacket;
+    I2c->PendingRequest.Event         = Event;
+    I2c->PendingRequest.I2cStatus     = I2cStatus;
+    gBS->RestoreTPL (Tpl);
+
+    // Run the request on the next timer tick
+    Status = gBS->SetTimer (I2c->RequestTimer, TimerRelative, 0);
+    if (EFI_ERROR (Status)) {
+      ZeroMem (&I2c->PendingRequest, sizeof (I2c->PendingRequest));
+    }
+    return Status;
   }
 
-  I2c = NXP_I2C_FROM_THIS (This);
+  if (!AtRuntime) {
+    Tpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  }
 
   I2cBase = (UINTN)(I2c->Dev->Resources[0].AddrRangeMin);
 
@@ -108,6 +190,10 @@ StartRequest (
     gBS->RestoreTPL (Tpl);
   }
 
+  if (I2cStatus != NULL) {
+    *I2cStatus = Status;
+  }
+
   return Status;
 }
 
@@ -131,6 +217,17 @@ NxpI2cInit (
 
   I2c = AllocateZeroPool (sizeof (NXP_I2C_MASTER));
 
+  RetVal = gBS->CreateEvent (EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK,
+                             RunPendingRequest, I2c, &I2c->RequestTimer);
+  if (EFI_ERROR (RetVal)) {
+    FreePool (I2c);
+    gBS->CloseProtocol (ControllerHandle,
+                        &gEdkiiNonDiscoverableDeviceProtocolGuid,
+                        DriverBindingHandle,
+                        ControllerHandle);
+    return RetVal;
+  }
+
   I2c->Signature                            = NXP_I2C_SIGNATURE;
   I2c->I2cMaster.SetBusFrequency            = SetBusFrequency;
   I2c->I2cMaster.Reset                      = Reset;
@@ -150,6 +247,7 @@ NxpI2cInit (
                   NULL);
 
   if (EFI_ERROR (RetVal)) {
+    gBS->CloseEvent (I2c->RequestTimer);
     FreePool (I2c);
     gBS->CloseProtocol (ControllerHandle,
                         &gEdkiiNonDiscoverableDeviceProtocolGuid,
@@ -180,6 +278,10 @@ NxpI2cRelease (
 
   I2c = NXP_I2C_FROM_THIS (I2cMaster);
 
+  if (I2c->PendingRequest.Event != NULL) {
+    return EFI_ALREADY_STARTED;
+  }
+
   RetVal = gBS->UninstallMultipleProtocolInterfaces (ControllerHandle,
                   &gEfiI2cMasterProtocolGuid, I2cMaster,
                   &gEfiDevicePathProtocolGuid, &I2c->DevicePath,
@@ -197,6 +299,7 @@ NxpI2cRelease (
     return RetVal;
   }
 
+  gBS->CloseEvent (I2c->RequestTimer);
   gBS->FreePool (I2c);
 
   return EFI_SUCCESS;
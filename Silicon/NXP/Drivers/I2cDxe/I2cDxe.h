@@ -30,11 +30,23 @@ typedef struct {
 } NXP_I2C_DEVICE_PATH;
 #pragma pack()
 
+//
+// Asynchronous request waiting to run from the request timer
+//
+typedef struct {
+  UINTN                           SlaveAddress;
+  EFI_I2C_REQUEST_PACKET          *RequestPacket;
+  EFI_EVENT                       Event;
+  EFI_STATUS                      *I2cStatus;
+} NXP_I2C_REQUEST;
+
 typedef struct {
   UINT32                          Signature;
   EFI_I2C_MASTER_PROTOCOL         I2cMaster;
   NXP_I2C_DEVICE_PATH             DevicePath;
   NON_DISCOVERABLE_DEVICE         *Dev;
+  EFI_EVENT                       RequestTimer;
+  NXP_I2C_REQUEST                 PendingRequest;
 } NXP_I2C_MASTER;
 
 EFI_STATUS
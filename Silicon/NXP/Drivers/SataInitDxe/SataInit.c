@@ -10,6 +10,7 @@
 #include <Library/DebugLib.h>
 #include <Library/IoLib.h>
 #include <Library/NonDiscoverableDeviceRegistrationLib.h>
+#include <Library/SerDes.h>
 #include <Library/UefiBootServicesTableLib.h>
 
 #define SATA_PPCFG             0xA8
@@ -41,13 +42,31 @@ SataEndOfDxeCallback (
   UINT32                   Index;
   UINT32                   Data;
   UINTN                    ControllerAddr;
+  UINT64                   SerDesProtocolMap;
 
   NumSataController = PcdGet32 (PcdNumSataController);
 
+  SerDesProtocolMap = 0;
+  if (FixedPcdGet32 (PcdSataSerDesProtocol) != 0) {
+    GetSerDesProtocolMap (&SerDesProtocolMap);
+  }
+
   for (Index = 0; Index < NumSataController; Index++) {
     ControllerAddr = PcdGet64 (PcdSataBaseAddr) +
                      (Index * PcdGet32 (PcdSataSize));
 
+    //
+    // Leave out the controllers without SerDes lanes, so that the AHCI
+    // driver does not wait for links on them
+    //
+    if ((FixedPcdGet32 (PcdSataSerDesProtocol) != 0) &&
+        ((SerDesProtocolMap &
+          (BIT0 << (FixedPcdGet32 (PcdSataSerDesProtocol) + Index))) == 0)) {
+      DEBUG ((DEBUG_INFO, "SATA%d reg @ 0x%lx is disabled \n", Index + 1,
+        ControllerAddr));
+      continue;
+    }
+
     //
     // configuring Physical Control Layer parameters for Port 0
     //
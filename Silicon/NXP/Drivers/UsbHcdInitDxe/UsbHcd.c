@@ -217,19 +217,42 @@ UsbEndOfDxeCallback (
   UINT32        NumUsbController;
   UINT32        ControllerAddr;
   UINT32        Index;
+  UINT32        Ready;
 
   gBS->CloseEvent (Event);
 
   NumUsbController = PcdGet32 (PcdNumUsbController);
+  ASSERT (NumUsbController <= 32);
+
+  //
+  // Reset and set up all the controllers first, so that they are all ready
+  // by the time the first one gets connected by the XHCI driver
+  //
+  Ready = 0;
+  for (Index = 0; Index < NumUsbController; Index++) {
+    ControllerAddr = PcdGet64 (PcdUsbBaseAddr) +
+                      (Index * PcdGet32 (PcdUsbSize));
+
+    if (InitializeUsbController (ControllerAddr) == NULL) {
+      Ready |= BIT0 << Index;
+    }
+  }
 
   for (Index = 0; Index < NumUsbController; Index++) {
     ControllerAddr = PcdGet64 (PcdUsbBaseAddr) +
                       (Index * PcdGet32 (PcdUsbSize));
 
+    //
+    // A controller which failed the initialization is not registered
+    //
+    if ((Ready & (BIT0 << Index)) == 0) {
+      continue;
+    }
+
     Status = RegisterNonDiscoverableMmioDevice (
                NonDiscoverableDeviceTypeXhci,
                NonDiscoverableDeviceDmaTypeNonCoherent,
-               InitializeUsbController (ControllerAddr),
+               NULL,
                NULL,
                1,
                ControllerAddr, PcdGet32 (PcdUsbSize)
@@ -14,6 +14,8 @@
 ///
 ///  Structure to have pointer to R/W
 ///  Mmio operations for 16 bits.
+///  The buffer operations access consecutive registers, Length is in bytes.
+///  The FIFO operations access the same register Count times.
 ///
 typedef struct _MMIO_OPERATIONS {
   UINT16 (*Read16) (UINTN Address);
@@ -31,6 +33,10 @@ typedef struct _MMIO_OPERATIONS {
   UINT64 (*Or64) (UINTN Address, UINT64 OrData);
   UINT64 (*And64) (UINTN Address, UINT64 AndData);
   UINT64 (*AndThenOr64) (UINTN Address, UINT64 AndData, UINT64 OrData);
+  UINT32 *(*ReadBuffer32) (UINTN StartAddress, UINTN Length, UINT32 *Buffer);
+  UINT32 *(*WriteBuffer32) (UINTN StartAddress, UINTN Length, CONST UINT32 *Buffer);
+  VOID (*ReadFifo32) (UINTN Address, UINTN Count, UINT32 *Buffer);
+  VOID (*WriteFifo32) (UINTN Address, UINTN Count, CONST UINT32 *Buffer);
 } MMIO_OPERATIONS;
 
 /**
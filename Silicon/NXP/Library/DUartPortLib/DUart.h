@@ -27,6 +27,8 @@
 #define DUART_FCR_RXSR             0x02 /* Receiver soft reset */
 #define DUART_FCR_TXSR             0x04 /* Transmitter soft reset */
 
+#define DUART_FIFO_DEPTH           16   /* Bytes in each of the FIFOs */
+
 // Modem Control Register
 #define DUART_MCR_DTR              0x01 /* Reserved  */
 #define DUART_MCR_RTS              0x02 /* RTS   */
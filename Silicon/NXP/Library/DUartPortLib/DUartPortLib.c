@@ -162,7 +162,8 @@ SerialPortGetControl (
 }
 
 /*
- * Return Baud divisor on basis of Baudrate
+ * Return Baud divisor on basis of Baudrate, rounded to the nearest value
+ * to keep the error low at high baud rates like 921600
  */
 UINT32
 CalculateBaudDivisor (
@@ -173,7 +174,7 @@ CalculateBaudDivisor (
 
   DUartClk = gPlatformGetClockPpi.PlatformGetClock (NXP_UART_CLOCK, 0);
 
-  return ((DUartClk)/(BaudRate * 16));
+  return ((DUartClk + (BaudRate * 8))/(BaudRate * 16));
 }
 
 /*
@@ -258,13 +259,20 @@ SerialPortWrite (
 {
   UINT8         *Final;
   UINTN         UartBase;
+  UINTN         Index;
 
   Final = &Buffer[NumberOfBytes];
   UartBase = (UINTN)PcdGet64 (PcdSerialRegisterBase);
 
   while (Buffer < Final) {
+    //
+    // With the FIFOs enabled THRE is set once the whole Tx FIFO is empty,
+    // so it can be filled up without checking the status of each byte
+    //
     while ((MmioRead8 (UartBase + ULSR) & DUART_LSR_THRE) == 0);
-    MmioWrite8 (UartBase + UTHR, *Buffer++);
+    for (Index = 0; Index < DUART_FIFO_DEPTH && Buffer < Final; Index++) {
+      MmioWrite8 (UartBase + UTHR, *Buffer++);
+    }
   }
 
   return NumberOfBytes;
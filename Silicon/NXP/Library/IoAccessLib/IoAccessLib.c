@@ -10,6 +10,7 @@
 
 #include <Base.h>
 #include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
 #include <Library/IoAccessLib.h>
 #include <Library/IoLib.h>
 
@@ -316,6 +317,272 @@ SwapMmioAnd64 (
   return MmioAnd64 (Address, SwapBytes64 (AndData));
 }
 
+/**
+  MmioReadBuffer32 for Big-Endian modules.
+
+  The registers are read by four, without a call per register, and each one
+  is swapped on the way to Buffer.
+
+  @param  StartAddress  The starting address of the MMIO registers to read.
+  @param  Length        The size in bytes of the transfer.
+  @param  Buffer        The buffer receiving the data read.
+
+  @return Buffer
+
+**/
+STATIC
+UINT32 *
+EFIAPI
+SwapMmioReadBuffer32 (
+  IN  UINTN       StartAddress,
+  IN  UINTN       Length,
+  OUT UINT32      *Buffer
+  )
+{
+  volatile UINT32 *Register;
+  UINT32          *ReturnBuffer;
+
+  ASSERT ((StartAddress & (sizeof (UINT32) - 1)) == 0);
+  ASSERT ((Length & (sizeof (UINT32) - 1)) == 0);
+  ASSERT (((UINTN)Buffer & (sizeof (UINT32) - 1)) == 0);
+
+  ReturnBuffer = Buffer;
+  Register = (volatile UINT32 *)StartAddress;
+
+  MemoryFence ();
+  for (; Length >= 4 * sizeof (UINT32); Length -= 4 * sizeof (UINT32)) {
+    Buffer[0] = SwapBytes32 (Register[0]);
+    Buffer[1] = SwapBytes32 (Register[1]);
+    Buffer[2] = SwapBytes32 (Register[2]);
+    Buffer[3] = SwapBytes32 (Register[3]);
+    Register += 4;
+    Buffer += 4;
+  }
+  for (; Length > 0; Length -= sizeof (UINT32)) {
+    *Buffer++ = SwapBytes32 (*Register++);
+  }
+  MemoryFence ();
+
+  return ReturnBuffer;
+}
+
+/**
+  MmioWriteBuffer32 for Big-Endian modules.
+
+  The registers are written by four, without a call per register, and each
+  value is swapped on the way from Buffer.
+
+  @param  StartAddress  The starting address of the MMIO registers to write.
+  @param  Length        The size in bytes of the transfer.
+  @param  Buffer        The buffer containing the data to write.
+
+  @return Buffer
+
+**/
+STATIC
+UINT32 *
+EFIAPI
+SwapMmioWriteBuffer32 (
+  IN  UINTN         StartAddress,
+  IN  UINTN         Length,
+  IN  CONST UINT32  *Buffer
+  )
+{
+  volatile UINT32 *Register;
+  CONST UINT32    *ReturnBuffer;
+
+  ASSERT ((StartAddress & (sizeof (UINT32) - 1)) == 0);
+  ASSERT ((Length & (sizeof (UINT32) - 1)) == 0);
+  ASSERT (((UINTN)Buffer & (sizeof (UINT32) - 1)) == 0);
+
+  ReturnBuffer = Buffer;
+  Register = (volatile UINT32 *)StartAddress;
+
+  MemoryFence ();
+  for (; Length >= 4 * sizeof (UINT32); Length -= 4 * sizeof (UINT32)) {
+    Register[0] = SwapBytes32 (Buffer[0]);
+    Register[1] = SwapBytes32 (Buffer[1]);
+    Register[2] = SwapBytes32 (Buffer[2]);
+    Register[3] = SwapBytes32 (Buffer[3]);
+    Register += 4;
+    Buffer += 4;
+  }
+  for (; Length > 0; Length -= sizeof (UINT32)) {
+    *Register++ = SwapBytes32 (*Buffer++);
+  }
+  MemoryFence ();
+
+  return (UINT32 *)ReturnBuffer;
+}
+
+/**
+  Read a 32-bit FIFO register Count times into Buffer.
+
+  @param  Swap     Swap the bytes of every value read.
+  @param  Address  The address of the FIFO register.
+  @param  Count    The number of values to read.
+  @param  Buffer   The buffer receiving the data read.
+
+**/
+STATIC
+VOID
+MmioReadFifo32Worker (
+  IN  BOOLEAN     Swap,
+  IN  UINTN       Address,
+  IN  UINTN       Count,
+  OUT UINT32      *Buffer
+  )
+{
+  volatile UINT32 *Register;
+
+  ASSERT ((Address & (sizeof (UINT32) - 1)) == 0);
+
+  Register = (volatile UINT32 *)Address;
+
+  MemoryFence ();
+  if (Swap) {
+    for (; Count >= 4; Count -= 4) {
+      Buffer[0] = SwapBytes32 (*Register);
+      Buffer[1] = SwapBytes32 (*Register);
+      Buffer[2] = SwapBytes32 (*Register);
+      Buffer[3] = SwapBytes32 (*Register);
+      Buffer += 4;
+    }
+    for (; Count > 0; Count--) {
+      *Buffer++ = SwapBytes32 (*Register);
+    }
+  } else {
+    for (; Count > 0; Count--) {
+      *Buffer++ = *Register;
+    }
+  }
+  MemoryFence ();
+}
+
+/**
+  Write Count values from Buffer to a 32-bit FIFO register.
+
+  @param  Swap     Swap the bytes of every value written.
+  @param  Address  The address of the FIFO register.
+  @param  Count    The number of values to write.
+  @param  Buffer   The buffer containing the data to write.
+
+**/
+STATIC
+VOID
+MmioWriteFifo32Worker (
+  IN  BOOLEAN       Swap,
+  IN  UINTN         Address,
+  IN  UINTN         Count,
+  IN  CONST UINT32  *Buffer
+  )
+{
+  volatile UINT32 *Register;
+
+  ASSERT ((Address & (sizeof (UINT32) - 1)) == 0);
+
+  Register = (volatile UINT32 *)Address;
+
+  MemoryFence ();
+  if (Swap) {
+    for (; Count >= 4; Count -= 4) {
+      *Register = SwapBytes32 (Buffer[0]);
+      *Register = SwapBytes32 (Buffer[1]);
+      *Register = SwapBytes32 (Buffer[2]);
+      *Register = SwapBytes32 (Buffer[3]);
+      Buffer += 4;
+    }
+    for (; Count > 0; Count--) {
+      *Register = SwapBytes32 (*Buffer++);
+    }
+  } else {
+    for (; Count > 0; Count--) {
+      *Register = *Buffer++;
+    }
+  }
+  MemoryFence ();
+}
+
+/**
+  Read a 32-bit FIFO register of a Big-Endian module Count times.
+
+  @param  Address  The address of the FIFO register.
+  @param  Count    The number of values to read.
+  @param  Buffer   The buffer receiving the data read.
+
+**/
+STATIC
+VOID
+EFIAPI
+SwapMmioReadFifo32 (
+  IN  UINTN       Address,
+  IN  UINTN       Count,
+  OUT UINT32      *Buffer
+  )
+{
+  MmioReadFifo32Worker (TRUE, Address, Count, Buffer);
+}
+
+/**
+  Write Count values to a 32-bit FIFO register of a Big-Endian module.
+
+  @param  Address  The address of the FIFO register.
+  @param  Count    The number of values to write.
+  @param  Buffer   The buffer containing the data to write.
+
+**/
+STATIC
+VOID
+EFIAPI
+SwapMmioWriteFifo32 (
+  IN  UINTN         Address,
+  IN  UINTN         Count,
+  IN  CONST UINT32  *Buffer
+  )
+{
+  MmioWriteFifo32Worker (TRUE, Address, Count, Buffer);
+}
+
+/**
+  Read a 32-bit FIFO register Count times.
+
+  @param  Address  The address of the FIFO register.
+  @param  Count    The number of values to read.
+  @param  Buffer   The buffer receiving the data read.
+
+**/
+STATIC
+VOID
+EFIAPI
+NoSwapMmioReadFifo32 (
+  IN  UINTN       Address,
+  IN  UINTN       Count,
+  OUT UINT32      *Buffer
+  )
+{
+  MmioReadFifo32Worker (FALSE, Address, Count, Buffer);
+}
+
+/**
+  Write Count values to a 32-bit FIFO register.
+
+  @param  Address  The address of the FIFO register.
+  @param  Count    The number of values to write.
+  @param  Buffer   The buffer containing the data to write.
+
+**/
+STATIC
+VOID
+EFIAPI
+NoSwapMmioWriteFifo32 (
+  IN  UINTN         Address,
+  IN  UINTN         Count,
+  IN  CONST UINT32  *Buffer
+  )
+{
+  MmioWriteFifo32Worker (FALSE, Address, Count, Buffer);
+}
+
 STATIC MMIO_OPERATIONS SwappingFunctions = {
   SwapMmioRead16,
   SwapMmioWrite16,
@@ -332,6 +599,10 @@ STATIC MMIO_OPERATIONS SwappingFunctions = {
   SwapMmioOr64,
   SwapMmioAnd64,
   SwapMmioAndThenOr64,
+  SwapMmioReadBuffer32,
+  SwapMmioWriteBuffer32,
+  SwapMmioReadFifo32,
+  SwapMmioWriteFifo32,
 };
 
 STATIC MMIO_OPERATIONS NonSwappingFunctions = {
@@ -350,6 +621,10 @@ STATIC MMIO_OPERATIONS NonSwappingFunctions = {
   MmioOr64,
   MmioAnd64,
   MmioAndThenOr64,
+  MmioReadBuffer32,
+  MmioWriteBuffer32,
+  NoSwapMmioReadFifo32,
+  NoSwapMmioWriteFifo32,
 };
 
 /**
@@ -7,9 +7,12 @@
 **/
 
 #include <PiDxe.h>
+#include <Library/ArmGenericTimerCounterLib.h>
+#include <Library/BaseLib.h>
 #include <Library/DebugLib.h>
 #include <Library/IoLib.h>
 #include <Library/RealTimeClockLib.h>
+#include <Library/TimeBaseLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiLib.h>
 #include <Library/UefiRuntimeLib.h>
@@ -35,11 +38,23 @@
 //
 #define EPOCH_BASE                2000
 
+//
+// GetTime reads the RTC once and then advances the time from the generic
+// timer counter, going back to the RTC every RTC_CACHE_RESYNC_SECONDS or
+// after SetTime. This keeps frequent callers, the OS included, off the I2C
+// bus.
+//
+#define RTC_CACHE_RESYNC_SECONDS  60
+
 STATIC EFI_HANDLE                 mI2cMasterHandle;
 STATIC VOID                       *mI2cMasterEventRegistration;
 STATIC EFI_I2C_MASTER_PROTOCOL    *mI2cMaster;
 STATIC EFI_EVENT                  mRtcVirtualAddrChangeEvent;
 
+STATIC BOOLEAN                    mRtcCacheValid;
+STATIC UINTN                      mRtcCacheEpoch;
+STATIC UINT64                     mRtcCacheCount;
+
 #pragma pack(1)
 typedef struct {
   UINT8                           VL_seconds;
@@ -64,6 +79,40 @@ typedef struct {
 } RTC_GET_I2C_REQUEST;
 
 typedef EFI_I2C_REQUEST_PACKET    RTC_SET_I2C_REQUEST;
+
+STATIC
+BOOLEAN
+RtcCacheGetTime (
+  OUT EFI_TIME                *Time
+  )
+{
+  UINT64                      Elapsed;
+
+  if (!mRtcCacheValid) {
+    return FALSE;
+  }
+
+  Elapsed = DivU64x32 (ArmGenericTimerGetSystemCount () - mRtcCacheCount,
+              (UINT32)ArmGenericTimerGetTimerFreq ());
+  if (Elapsed >= RTC_CACHE_RESYNC_SECONDS) {
+    return FALSE;
+  }
+
+  EpochToEfiTime (mRtcCacheEpoch + (UINTN)Elapsed, Time);
+  return TRUE;
+}
+
+STATIC
+VOID
+RtcCacheSetTime (
+  IN EFI_TIME                 *Time
+  )
+{
+  mRtcCacheEpoch = EfiTimeToEpoch (Time);
+  mRtcCacheCount = ArmGenericTimerGetSystemCount ();
+  mRtcCacheValid = TRUE;
+}
+
 /**
   Returns the current time and date information, and the time-keeping
   capabilities of the hardware platform.
@@ -95,6 +144,16 @@ LibGetTime (
     return EFI_INVALID_PARAMETER;
   }
 
+  if (Capabilities != NULL) {
+    Capabilities->Resolution = 1;
+    Capabilities->Accuracy = 0;
+    Capabilities->SetsToZero = TRUE;
+  }
+
+  if (RtcCacheGetTime (Time)) {
+    return EFI_SUCCESS;
+  }
+
   if (mI2cMaster == NULL) {
     return EFI_DEVICE_ERROR;
   }
@@ -137,11 +196,7 @@ LibGetTime (
       }
   }
 
-  if (Capabilities != NULL) {
-    Capabilities->Resolution = 1;
-    Capabilities->Accuracy = 0;
-    Capabilities->SetsToZero = TRUE;
-  }
+  RtcCacheSetTime (Time);
   return EFI_SUCCESS;
 }
 
@@ -167,6 +222,8 @@ LibSetTime (
   RTC_SET_DATETIME_PACKET     Packet;
   EFI_STATUS                  Status;
 
+  mRtcCacheValid = FALSE;
+
   if (mI2cMaster == NULL) {
     return EFI_DEVICE_ERROR;
   }
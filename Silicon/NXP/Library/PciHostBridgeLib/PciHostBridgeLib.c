@@ -16,10 +16,14 @@
 #include <Library/PcdLib.h>
 #include <Library/PciHostBridgeLib.h>
 #include <Library/SerDes.h>
+#include <Library/TimerLib.h>
 #include <Pcie.h>
 #include <Protocol/PciHostBridgeResourceAllocation.h>
 #include <Protocol/PciRootBridgeIo.h>
 
+#define PCIE_LINK_UP_TIMEOUT        FixedPcdGet32 (PcdPcieLinkUpTimeout)
+#define PCIE_LINK_UP_POLL_INTERVAL  1000
+
 #pragma pack(1)
 typedef struct {
   ACPI_HID_DEVICE_PATH     AcpiDevicePath;
@@ -244,14 +248,17 @@ PciLsGen4Write32 (
 /**
    Helper function to check PCIe link state
 
-   @param Pcie Address of PCIe host controller.
+   @param Pcie    Address of PCIe host controller.
+   @param Idx     Index of the PCIe controller.
+   @param Report  Print the LTSSM state if the link is down.
 
 **/
 STATIC
 INTN
 PcieLinkUp (
   IN EFI_PHYSICAL_ADDRESS Pcie,
-  IN UINT32 Idx
+  IN UINT32 Idx,
+  IN BOOLEAN Report
   )
 {
   MMIO_OPERATIONS *PcieOps;
@@ -268,8 +275,10 @@ PcieLinkUp (
   State = PcieOps->Read32 ((UINTN)Pcie + PCI_LUT_BASE + PCI_LUT_DBG) & LtssmMask;
 
   if (State < LTSSM_PCIE_L0) {
-    DEBUG ((DEBUG_INFO,"PCIE%d : reg @ 0x%lx, no link: LTSSM=0x%02x\n",
-            Idx + 1, Pcie, State));
+    if (Report) {
+      DEBUG ((DEBUG_INFO,"PCIE%d : reg @ 0x%lx, no link: LTSSM=0x%02x\n",
+              Idx + 1, Pcie, State));
+    }
     return PCI_LINK_DOWN;
   }
 
@@ -729,7 +738,8 @@ PcieSetupCntrl (
    This function checks whether PCIe is enabled or not
    depending upon SoC serdes protocol map
 
-   @param  PcieNum PCIe number.
+   @param  SerDesProtocolMap  SoC serdes protocol map.
+   @param  PcieNum            PCIe number.
 
    @return The     PCIe number enabled in map.
    @return FALSE   PCIe number is disabled in map.
@@ -738,16 +748,10 @@ PcieSetupCntrl (
 STATIC
 BOOLEAN
 IsPcieNumEnabled(
-  IN UINTN PcieNum
+  IN UINT64 SerDesProtocolMap,
+  IN UINTN  PcieNum
   )
 {
-  UINT64 SerDesProtocolMap;
-
-  SerDesProtocolMap = 0;
-
-  // Reading serdes protocol map
-  GetSerDesProtocolMap (&SerDesProtocolMap);
-
   return (SerDesProtocolMap & (BIT0 << (PcieNum))) != 0;
 }
 
@@ -773,29 +777,38 @@ PciHostBridgeGetRootBridges (
   UINT64        PciPhyCfg1Addr[NUM_PCIE_CONTROLLER];
   UINT64        PciPhyIoAddr[NUM_PCIE_CONTROLLER];
   UINT64        Regs[NUM_PCIE_CONTROLLER];
-  INTN          LinkUp;
+  BOOLEAN       Enabled[NUM_PCIE_CONTROLLER];
+  INTN          LinkUp[NUM_PCIE_CONTROLLER];
+  UINT64        SerDesProtocolMap;
+  BOOLEAN       Pending;
+  UINT32        Remaining;
+  UINT32        Delay;
 
-  for  (Idx = 0, Loop = 0; Idx < NUM_PCIE_CONTROLLER; Idx++) {
+  SerDesProtocolMap = 0;
+
+  // Reading serdes protocol map
+  GetSerDesProtocolMap (&SerDesProtocolMap);
+
+  //
+  // Set up all the enabled controllers first, their links
+  // train in the meantime
+  //
+  for  (Idx = 0; Idx < NUM_PCIE_CONTROLLER; Idx++) {
     PciPhyMemAddr[Idx] = PCI_SEG0_PHY_MEM_BASE + (PCI_BASE_DIFF * Idx);
     PciPhyMem64Addr[Idx] = PCI_SEG0_PHY_MEM64_BASE + (PCI_BASE_DIFF * Idx);
     PciPhyCfg0Addr[Idx] = PCI_SEG0_PHY_CFG0_BASE + (PCI_BASE_DIFF * Idx);
     PciPhyCfg1Addr[Idx] = PCI_SEG0_PHY_CFG1_BASE + (PCI_BASE_DIFF * Idx);
     PciPhyIoAddr [Idx] =  PCI_SEG0_PHY_IO_BASE + (PCI_BASE_DIFF * Idx);
     Regs[Idx] =  PCI_SEG0_DBI_BASE + (PCI_DBI_SIZE_DIFF * Idx);
+    LinkUp[Idx] = PCI_LINK_DOWN;
 
     // Check is the PCIe controller is enabled
-    if (IsPcieNumEnabled (Idx + 1) == 0) {
+    Enabled[Idx] = IsPcieNumEnabled (SerDesProtocolMap, Idx + 1);
+    if (!Enabled[Idx]) {
       DEBUG ((DEBUG_INFO, "PCIE%d reg @ 0x%lx is disabled \n", Idx + 1, Regs[Idx]));
       continue;
     }
 
-    // Check PCIe Link
-    LinkUp = PcieLinkUp(Regs[Idx], Idx);
-
-    if (!LinkUp) {
-      continue;
-    }
-    DEBUG ((DEBUG_INFO, "PCIE%d reg @ 0x%lx :Passed Linkup Phase\n", Idx + 1, Regs[Idx]));
     // Set up PCIe Controller and ATU windows
     PcieSetupCntrl (Regs[Idx],
                     PciPhyCfg0Addr[Idx],
@@ -803,6 +816,37 @@ PciHostBridgeGetRootBridges (
                     PciPhyMemAddr[Idx],
                     PciPhyMem64Addr[Idx],
                     PciPhyIoAddr[Idx]);
+  }
+
+  //
+  // Poll the links of all the enabled controllers against a shared deadline
+  //
+  Remaining = PCIE_LINK_UP_TIMEOUT;
+  for (;;) {
+    Pending = FALSE;
+    for (Idx = 0; Idx < NUM_PCIE_CONTROLLER; Idx++) {
+      if (!Enabled[Idx] || LinkUp[Idx]) {
+        continue;
+      }
+      LinkUp[Idx] = PcieLinkUp (Regs[Idx], Idx, Remaining == 0);
+      if (!LinkUp[Idx]) {
+        Pending = TRUE;
+      }
+    }
+
+    if (!Pending || Remaining == 0) {
+      break;
+    }
+    Delay = MIN (Remaining, PCIE_LINK_UP_POLL_INTERVAL);
+    MicroSecondDelay (Delay);
+    Remaining -= Delay;
+  }
+
+  for  (Idx = 0, Loop = 0; Idx < NUM_PCIE_CONTROLLER; Idx++) {
+    if (!LinkUp[Idx]) {
+      continue;
+    }
+    DEBUG ((DEBUG_INFO, "PCIE%d reg @ 0x%lx :Passed Linkup Phase\n", Idx + 1, Regs[Idx]));
 
     mPciRootBridges[Loop].Segment               = Idx;
     mPciRootBridges[Loop].Supports              = PCI_SUPPORT_ATTRIBUTES;
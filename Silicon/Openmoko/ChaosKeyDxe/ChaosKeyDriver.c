@@ -176,6 +176,7 @@ GetRNG (
   UINT8             *OutPointer;
   UINTN             OutSize;
   UINT32            Result;
+  UINT8             *Pool;
 
   if (Algorithm != NULL && !CompareGuid (Algorithm, &gEfiRngAlgorithmRaw)) {
     return EFI_UNSUPPORTED;
@@ -183,6 +184,21 @@ GetRNG (
 
   ChaosKey = CHAOSKEY_DEV_FROM_THIS (This);
 
+  //
+  // Serve what is left of the previous transfer first, so that small
+  // requests don't pay for a USB round trip each. Bytes are wiped as they
+  // are handed out, so that none of them is ever returned twice.
+  //
+  if (ChaosKey->PoolSize > 0) {
+    Pool = &ChaosKey->Pool[CHAOSKEY_MAX_EP_SIZE - ChaosKey->PoolSize];
+    OutSize = MIN (ValueLength, ChaosKey->PoolSize);
+    gBS->CopyMem (Value, Pool, OutSize);
+    ZeroMem (Pool, OutSize);
+    ChaosKey->PoolSize -= OutSize;
+    Value += OutSize;
+    ValueLength -= OutSize;
+  }
+
   while (ValueLength > 0) {
     //
     // If more data is requested than the endpoint can deliver in a single
@@ -213,10 +229,18 @@ GetRNG (
       return EFI_DEVICE_ERROR;
     }
 
-    OutSize = MIN (OutSize, ValueLength);
-
-    if (Value != Buffer) {
+    if (OutPointer == Buffer) {
+      //
+      // Keep the bytes the caller did not ask for
+      //
+      if (OutSize > ValueLength) {
+        ChaosKey->PoolSize = OutSize - ValueLength;
+        gBS->CopyMem (&ChaosKey->Pool[CHAOSKEY_MAX_EP_SIZE - ChaosKey->PoolSize],
+                      &Buffer[ValueLength], ChaosKey->PoolSize);
+        OutSize = ValueLength;
+      }
       gBS->CopyMem (Value, Buffer, OutSize);
+      ZeroMem (Buffer, sizeof (Buffer));
     }
     Value += OutSize;
     ValueLength -= OutSize;
@@ -244,6 +268,7 @@ ChaosKeyInit (
   ChaosKey->Signature         = CHAOSKEY_DEV_SIGNATURE;
   ChaosKey->Rng.GetInfo       = GetInfo;
   ChaosKey->Rng.GetRNG        = GetRNG;
+  ChaosKey->PoolSize          = 0;
 
   //
   // Open USB I/O Protocol
@@ -329,6 +354,7 @@ ChaosKeyRelease (
     return Status;
   }
 
+  ZeroMem (ChaosKey->Pool, sizeof (ChaosKey->Pool));
   gBS->FreePool (ChaosKey);
 
   return EFI_SUCCESS;
@@ -32,6 +32,13 @@ typedef struct {
   UINT16                        EndpointSize;
   EFI_USB_IO_PROTOCOL           *UsbIo;
   EFI_RNG_PROTOCOL              Rng;
+  //
+  // Unused tail of the last bulk transfer, handed out by the next GetRNG ()
+  // call before going back to the device. The valid bytes are the last
+  // PoolSize bytes of Pool.
+  //
+  UINT8                         Pool[CHAOSKEY_MAX_EP_SIZE];
+  UINTN                         PoolSize;
 } CHAOSKEY_DEV;
 
 #define CHAOSKEY_DEV_FROM_THIS(a) \
@@ -14,26 +14,43 @@
 #include <Library/PcdLib.h>
 #include <libfdt.h>
 
+// Maximum number of DT memory nodes taken into account
+#define MAX_MEMORY_NODES                            16
+
 // Number of Virtual Memory Map Descriptors
-#define MAX_VIRTUAL_MEMORY_MAP_DESCRIPTORS          4
+#define MAX_VIRTUAL_MEMORY_MAP_DESCRIPTORS          (MAX_MEMORY_NODES + 3)
 
-RETURN_STATUS
-EFIAPI
-SbsaQemuLibConstructor (
-  VOID
+typedef struct {
+  UINT64        Base;
+  UINT64        Size;
+} MEMORY_NODE_RANGE;
+
+/**
+  Collect the System RAM ranges described by the DT memory nodes.
+
+  @param[out]   Ranges    Array of MAX_MEMORY_NODES entries, filled with the
+                          ranges sorted by base address.
+
+  @return       The number of ranges returned in Ranges.
+
+**/
+STATIC
+UINTN
+GetMemoryNodeRanges (
+  OUT MEMORY_NODE_RANGE   *Ranges
   )
 {
   VOID          *DeviceTreeBase;
   INT32         Node, Prev;
-  UINT64        NewBase, CurBase;
-  UINT64        NewSize, CurSize;
+  UINT64        CurBase;
+  UINT64        CurSize;
   CONST CHAR8   *Type;
   INT32         Len;
   CONST UINT64  *RegProp;
-  RETURN_STATUS PcdStatus;
+  UINTN         Count;
+  UINTN         Index;
 
-  NewBase = 0;
-  NewSize = 0;
+  Count = 0;
 
   DeviceTreeBase = (VOID *)(UINTN)PcdGet64 (PcdDeviceTreeBaseAddress);
   ASSERT (DeviceTreeBase != NULL);
@@ -41,7 +58,6 @@ SbsaQemuLibConstructor (
   // Make sure we have a valid device tree blob
   ASSERT (fdt_check_header (DeviceTreeBase) == 0);
 
-  // Look for the lowest memory node
   for (Prev = 0;; Prev = Node) {
     Node = fdt_next_node (DeviceTreeBase, Prev, NULL);
     if (Node < 0) {
@@ -62,10 +78,19 @@ SbsaQemuLibConstructor (
         DEBUG ((DEBUG_INFO, "%a: System RAM @ 0x%lx - 0x%lx\n",
           __FUNCTION__, CurBase, CurBase + CurSize - 1));
 
-        if (NewBase > CurBase || NewBase == 0) {
-          NewBase = CurBase;
-          NewSize = CurSize;
+        if (Count == MAX_MEMORY_NODES) {
+          DEBUG ((DEBUG_ERROR, "%a: Too many FDT memory nodes, ignoring 0x%lx\n",
+            __FUNCTION__, CurBase));
+          continue;
+        }
+
+        // Keep the ranges sorted by base address
+        for (Index = Count; Index > 0 && Ranges[Index - 1].Base > CurBase; Index--) {
+          Ranges[Index] = Ranges[Index - 1];
         }
+        Ranges[Index].Base = CurBase;
+        Ranges[Index].Size = CurSize;
+        Count++;
       } else {
         DEBUG ((DEBUG_ERROR, "%a: Failed to parse FDT memory node\n",
           __FUNCTION__));
@@ -73,9 +98,29 @@ SbsaQemuLibConstructor (
     }
   }
 
+  return Count;
+}
+
+RETURN_STATUS
+EFIAPI
+SbsaQemuLibConstructor (
+  VOID
+  )
+{
+  MEMORY_NODE_RANGE Ranges[MAX_MEMORY_NODES];
+  UINTN             Count;
+  RETURN_STATUS     PcdStatus;
+
+  // Look for the lowest memory node
+  Count = GetMemoryNodeRanges (Ranges);
+  ASSERT (Count > 0);
+  if (Count == 0) {
+    return RETURN_NOT_FOUND;
+  }
+
   // Make sure the start of DRAM matches our expectation
-  ASSERT (FixedPcdGet64 (PcdSystemMemoryBase) == NewBase);
-  PcdStatus = PcdSet64S (PcdSystemMemorySize, NewSize);
+  ASSERT (FixedPcdGet64 (PcdSystemMemoryBase) == Ranges[0].Base);
+  PcdStatus = PcdSet64S (PcdSystemMemorySize, Ranges[0].Size);
   ASSERT_RETURN_ERROR (PcdStatus);
 
   return RETURN_SUCCESS;
@@ -100,6 +145,10 @@ ArmPlatformGetVirtualMemoryMap (
   )
 {
   ARM_MEMORY_REGION_DESCRIPTOR  *VirtualMemoryTable;
+  MEMORY_NODE_RANGE             Ranges[MAX_MEMORY_NODES];
+  UINTN                         Count;
+  UINTN                         Index;
+  UINTN                         Entry;
 
   ASSERT (VirtualMemoryMap != NULL);
 
@@ -111,35 +160,65 @@ ArmPlatformGetVirtualMemoryMap (
     return;
   }
 
-  // System DRAM
-  VirtualMemoryTable[0].PhysicalBase = PcdGet64 (PcdSystemMemoryBase);
-  VirtualMemoryTable[0].VirtualBase  = VirtualMemoryTable[0].PhysicalBase;
-  VirtualMemoryTable[0].Length       = PcdGet64 (PcdSystemMemorySize);
-  VirtualMemoryTable[0].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK;
-
-  DEBUG ((DEBUG_INFO, "%a: Dumping System DRAM Memory Map:\n"
-          "\tPhysicalBase: 0x%lX\n"
-          "\tVirtualBase: 0x%lX\n"
-          "\tLength: 0x%lX\n",
-          __FUNCTION__,
-          VirtualMemoryTable[0].PhysicalBase,
-          VirtualMemoryTable[0].VirtualBase,
-          VirtualMemoryTable[0].Length));
+  Count = GetMemoryNodeRanges (Ranges);
+  if (Count == 0) {
+    Ranges[0].Base = PcdGet64 (PcdSystemMemoryBase);
+    Ranges[0].Size = PcdGet64 (PcdSystemMemorySize);
+    Count = 1;
+  }
+
+  //
+  // System DRAM. NUMA guests describe their RAM with one memory node per
+  // node, usually back to back: map contiguous nodes with a single region,
+  // so that ArmMmuLib can use block mappings across the node boundaries.
+  //
+  Entry = 0;
+  for (Index = 0; Index < Count; Index++) {
+    if (Entry > 0 &&
+        VirtualMemoryTable[Entry - 1].PhysicalBase +
+        VirtualMemoryTable[Entry - 1].Length >= Ranges[Index].Base) {
+      VirtualMemoryTable[Entry - 1].Length =
+        MAX (VirtualMemoryTable[Entry - 1].PhysicalBase +
+             VirtualMemoryTable[Entry - 1].Length,
+             Ranges[Index].Base + Ranges[Index].Size) -
+        VirtualMemoryTable[Entry - 1].PhysicalBase;
+      continue;
+    }
+
+    VirtualMemoryTable[Entry].PhysicalBase = Ranges[Index].Base;
+    VirtualMemoryTable[Entry].VirtualBase  = Ranges[Index].Base;
+    VirtualMemoryTable[Entry].Length       = Ranges[Index].Size;
+    VirtualMemoryTable[Entry].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK;
+    Entry++;
+  }
+
+  for (Index = 0; Index < Entry; Index++) {
+    DEBUG ((DEBUG_INFO, "%a: Dumping System DRAM Memory Map:\n"
+            "\tPhysicalBase: 0x%lX\n"
+            "\tVirtualBase: 0x%lX\n"
+            "\tLength: 0x%lX\n",
+            __FUNCTION__,
+            VirtualMemoryTable[Index].PhysicalBase,
+            VirtualMemoryTable[Index].VirtualBase,
+            VirtualMemoryTable[Index].Length));
+  }
 
   // Peripheral space before DRAM
-  VirtualMemoryTable[1].PhysicalBase = 0x0;
-  VirtualMemoryTable[1].VirtualBase  = 0x0;
-  VirtualMemoryTable[1].Length       = VirtualMemoryTable[0].PhysicalBase;
-  VirtualMemoryTable[1].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_DEVICE;
+  VirtualMemoryTable[Entry].PhysicalBase = 0x0;
+  VirtualMemoryTable[Entry].VirtualBase  = 0x0;
+  VirtualMemoryTable[Entry].Length       = VirtualMemoryTable[0].PhysicalBase;
+  VirtualMemoryTable[Entry].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_DEVICE;
+  Entry++;
 
   // Remap the FD region as normal executable memory
-  VirtualMemoryTable[2].PhysicalBase = PcdGet64 (PcdFdBaseAddress);
-  VirtualMemoryTable[2].VirtualBase  = VirtualMemoryTable[2].PhysicalBase;
-  VirtualMemoryTable[2].Length       = FixedPcdGet32 (PcdFdSize);
-  VirtualMemoryTable[2].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK;
+  VirtualMemoryTable[Entry].PhysicalBase = PcdGet64 (PcdFdBaseAddress);
+  VirtualMemoryTable[Entry].VirtualBase  = VirtualMemoryTable[Entry].PhysicalBase;
+  VirtualMemoryTable[Entry].Length       = FixedPcdGet32 (PcdFdSize);
+  VirtualMemoryTable[Entry].Attributes   = ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK;
+  Entry++;
 
   // End of Table
-  ZeroMem (&VirtualMemoryTable[3], sizeof (ARM_MEMORY_REGION_DESCRIPTOR));
+  ZeroMem (&VirtualMemoryTable[Entry], sizeof (ARM_MEMORY_REGION_DESCRIPTOR));
 
   *VirtualMemoryMap = VirtualMemoryTable;
 }
@@ -64,6 +64,10 @@
 
 #define RISCV_TIMER_COMPARE_BITS      32
 //
+// Unprivileged Counter/Timers.
+//
+#define RISCV_CSR_TIME                  0xC01
+//
 // Machine Timer and Counter.
 //
 //#define RISCV_CSR_MACHINE_MTIME         0x701
@@ -95,7 +99,12 @@
 #define RISCV_CSR_SUPERVISOR_SSTATUS    0x100
   #define SSTATUS_SIE_BIT_POSITION      1
   #define SSTATUS_SPP_BIT_POSITION      8
+  #define SSTATUS_VS_BIT_POSITION       9   // Same position in mstatus
+  #define SSTATUS_VS_MASK               (0x3 << SSTATUS_VS_BIT_POSITION)
+    #define SSTATUS_VS_OFF              (0x0 << SSTATUS_VS_BIT_POSITION)
+    #define SSTATUS_VS_INITIAL          (0x1 << SSTATUS_VS_BIT_POSITION)
 #define RISCV_CSR_SUPERVISOR_SIE        0x104
+  #define SIE_STIE_BIT_POSITION         5
 #define RISCV_CSR_SUPERVISOR_SSCRATCH   0x140
 #define RISCV_CSR_SUPERVISOR_SEPC       0x141
 #define RISCV_CSR_SUPERVISOR_SCAUSE     0x142
@@ -107,6 +116,7 @@
   #define SCAUSE_SUPERVISOR_EXTERNAL_INT  9
 #define RISCV_CSR_SUPERVISOR_STVAL      0x143
 #define RISCV_CSR_SUPERVISOR_SIP        0x144
+#define RISCV_CSR_SUPERVISOR_STIMECMP   0x14D
 #define RISCV_CSR_SUPERVISOR_SATP       0x180
 
 #if defined (MDE_CPU_RISCV64)
@@ -123,6 +133,28 @@
   #define SATP64_ASID_MASK              0x0FFFF00000000000
   #define SATP64_PPN_MASK               0x00000FFFFFFFFFFF
 
+//
+// Page table entry of Sv39 and Sv48.
+//
+#define RISCV_PTE_V                     BIT0  // Valid
+#define RISCV_PTE_R                     BIT1  // Readable
+#define RISCV_PTE_W                     BIT2  // Writable
+#define RISCV_PTE_X                     BIT3  // Executable
+#define RISCV_PTE_U                     BIT4  // User mode accessible
+#define RISCV_PTE_G                     BIT5  // Global mapping
+#define RISCV_PTE_A                     BIT6  // Accessed
+#define RISCV_PTE_D                     BIT7  // Dirty
+#define RISCV_PTE_PPN_SHIFT             10
+#define RISCV_PTE_PPN_MASK              0x003FFFFFFFFFFC00
+#define RISCV_PTE_PBMT_SHIFT            61    // Svpbmt page-based memory types
+#define RISCV_PTE_PBMT_MASK             (0x3ULL << RISCV_PTE_PBMT_SHIFT)
+  #define RISCV_PTE_PBMT_PMA            (0x0ULL << RISCV_PTE_PBMT_SHIFT)
+  #define RISCV_PTE_PBMT_NC             (0x1ULL << RISCV_PTE_PBMT_SHIFT)
+  #define RISCV_PTE_PBMT_IO             (0x2ULL << RISCV_PTE_PBMT_SHIFT)
+#define RISCV_PAGE_TABLE_ENTRIES        512
+#define RISCV_PAGE_TABLE_INDEX_BITS     9
+#define RISCV_PAGE_SHIFT                12
+
 #define RISCV_CAUSE_MISALIGNED_FETCH        0x0
 #define RISCV_CAUSE_FETCH_ACCESS            0x1
 #define RISCV_CAUSE_ILLEGAL_INSTRUCTION     0x2
@@ -45,9 +45,13 @@ typedef struct {
 #define FIRMWARE_CONTEXT_HART_SPECIFIC_SIZE  (64 * 8) // This is the size of EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC
                                                       // structure. Referred by both C code and assembly code.
 
+//
+// The hart-specific data of each hart is found through the hart list SEC
+// hands to PEI, see Guid/RiscVSecHartList.h of RiscVPlatformPkg.
+//
 typedef struct {
   VOID            *PeiServiceTable;       // PEI Service table
-  EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC  *HartSpecific[RISC_V_MAX_HART_SUPPORTED];
+  UINT64          FlattenedDeviceTree;    // Device tree passed by the previous booting stage, 0 if none
 } EFI_RISCV_OPENSBI_FIRMWARE_CONTEXT;
 
 //
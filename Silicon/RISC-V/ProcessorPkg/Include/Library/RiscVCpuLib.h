@@ -68,4 +68,28 @@ RiscVReadMachineImplementId (VOID);
 VOID
 RiscVSetSupervisorAddressTranslationRegister(UINT64);
 
+UINT64
+RiscVGetSupervisorAddressTranslationRegister(VOID);
+
+UINT64
+RiscVReadTime (VOID);
+
+VOID
+RiscVWaitForSupervisorTime (UINT64);
+
+VOID
+RiscVCpuCacheClean (UINTN);
+
+VOID
+RiscVCpuCacheFlush (UINTN);
+
+VOID
+RiscVCpuCacheInvalidate (UINTN);
+
+UINTN
+RiscVGetThreadPointer (VOID);
+
+VOID
+RiscVSetThreadPointer (UINTN);
+
 #endif
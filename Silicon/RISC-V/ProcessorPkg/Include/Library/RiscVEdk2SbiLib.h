@@ -35,6 +35,72 @@ typedef struct {
   UINTN Value;   ///< Value returned
 } SbiRet;
 
+//
+// Performance Monitoring Unit extension, SBI v0.3.
+//
+#ifndef SBI_EXT_PMU
+#define SBI_EXT_PMU                         0x504D55
+#endif
+#define SBI_EXT_PMU_NUM_COUNTERS            0
+#define SBI_EXT_PMU_COUNTER_GET_INFO        1
+#define SBI_EXT_PMU_COUNTER_CFG_MATCH       2
+#define SBI_EXT_PMU_COUNTER_START           3
+#define SBI_EXT_PMU_COUNTER_STOP            4
+#define SBI_EXT_PMU_COUNTER_FW_READ         5
+
+//
+// Fields of the counter information returned by SbiPmuCounterGetInfo.
+//
+#define SBI_PMU_COUNTER_INFO_CSR(Info)      ((Info) & 0xFFF)
+#define SBI_PMU_COUNTER_INFO_WIDTH(Info)    ((((Info) >> 12) & 0x3F) + 1)
+#define SBI_PMU_COUNTER_INFO_IS_FIRMWARE(Info) \
+  (((Info) >> (sizeof (UINTN) * 8 - 1)) != 0)
+
+//
+// Flags of SbiPmuCounterConfigMatching, SbiPmuCounterStart and
+// SbiPmuCounterStop.
+//
+#define SBI_PMU_CFG_FLAG_SKIP_MATCH         BIT0
+#define SBI_PMU_CFG_FLAG_CLEAR_VALUE        BIT1
+#define SBI_PMU_CFG_FLAG_AUTO_START         BIT2
+#define SBI_PMU_START_FLAG_SET_INIT_VALUE   BIT0
+#define SBI_PMU_STOP_FLAG_RESET             BIT0
+
+///
+/// Types of the remote fences which can be queued in a SBI_RFENCE_BATCH.
+///
+typedef enum {
+  SbiRfenceFenceI,
+  SbiRfenceSfenceVma,
+  SbiRfenceSfenceVmaAsid,
+  SbiRfenceHfenceGvmaVmid,
+  SbiRfenceHfenceGvma,
+  SbiRfenceHfenceVvmaAsid,
+  SbiRfenceHfenceVvma,
+  SbiRfenceTypeMax
+} SBI_RFENCE_TYPE;
+
+#define SBI_RFENCE_BATCH_MAX_ENTRIES  16
+
+typedef struct {
+  SBI_RFENCE_TYPE   Type;
+  UINTN             StartAddr;
+  UINTN             Size;        ///< 0 with StartAddr 0 for a full flush.
+  UINTN             Id;          ///< ASID or VMID, if Type takes one.
+} SBI_RFENCE_BATCH_ENTRY;
+
+///
+/// Remote fences queued for the same set of harts. Ranges of the same type
+/// and ASID/VMID which overlap or touch are merged when they are queued, so
+/// the batch is sent with as few SBI calls as possible.
+///
+typedef struct {
+  UINTN                     HartMask;
+  UINTN                     HartMaskBase;
+  UINTN                     Count;
+  SBI_RFENCE_BATCH_ENTRY    Entries[SBI_RFENCE_BATCH_MAX_ENTRIES];
+} SBI_RFENCE_BATCH;
+
 /**
   Get the implemented SBI specification version
 
@@ -473,6 +539,185 @@ SbiRemoteHfenceVvma (
   IN  UINTN                          Size
   );
 
+/**
+  Start an empty batch of remote fences for the given harts.
+
+  @param[out] Batch                The batch to initialize.
+  @param[in]  HartMask             Scalar bit-vector containing hart ids
+  @param[in]  HartMaskBase         The starting hartid from which the bit-vector
+                                   must be computed. If set to -1, HartMask is
+                                   ignored and all harts are considered.
+**/
+VOID
+EFIAPI
+SbiRemoteFenceBatchInit (
+  OUT SBI_RFENCE_BATCH              *Batch,
+  IN  UINTN                          HartMask,
+  IN  UINTN                          HartMaskBase
+  );
+
+/**
+  Queue a remote fence in a batch.
+
+  The fence is merged with a queued fence of the same type and ASID/VMID if
+  their ranges overlap or touch. If the batch is full, all the fences of
+  this type are replaced by a single full flush.
+
+  @param[in,out] Batch             The batch.
+  @param[in]     Type              The type of the fence.
+  @param[in]     StartAddr         The first address of the affected range.
+  @param[in]     Size              How many addresses are affected, 0 together
+                                   with StartAddr 0 for a full flush.
+  @param[in]     Id                The ASID or VMID for the types taking one,
+                                   ignored otherwise.
+  @retval EFI_SUCCESS              The fence was queued.
+  @retval EFI_INVALID_PARAMETER    Type is not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiRemoteFenceBatchAdd (
+  IN OUT SBI_RFENCE_BATCH           *Batch,
+  IN     SBI_RFENCE_TYPE             Type,
+  IN     UINTN                       StartAddr,
+  IN     UINTN                       Size,
+  IN     UINTN                       Id
+  );
+
+/**
+  Send all the fences queued in a batch and empty it.
+
+  @param[in,out] Batch             The batch.
+  @retval EFI_SUCCESS              All the fences were sent.
+  @retval others                   The error of the first SBI call which
+                                   failed. The remaining fences are still sent.
+**/
+EFI_STATUS
+EFIAPI
+SbiRemoteFenceBatchSubmit (
+  IN OUT SBI_RFENCE_BATCH           *Batch
+  );
+
+///
+/// Performance Monitoring Unit extension
+///
+
+/**
+  Get the number of PMU counters, hardware and firmware.
+
+  @param[out] NumCounters          The number of counters.
+  @retval EFI_SUCCESS              The number was returned.
+  @retval EFI_UNSUPPORTED          The SBI implementation has no PMU extension.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuGetNumCounters (
+  OUT UINTN                         *NumCounters
+  );
+
+/**
+  Get the details of a PMU counter.
+
+  Decode CounterInfo with the SBI_PMU_COUNTER_INFO_* macros.
+
+  @param[in]  CounterIndex         The logical index of the counter.
+  @param[out] CounterInfo          The counter information.
+  @retval EFI_SUCCESS              The information was returned.
+  @retval EFI_INVALID_PARAMETER    CounterIndex is not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterGetInfo (
+  IN  UINTN                          CounterIndex,
+  OUT UINTN                         *CounterInfo
+  );
+
+/**
+  Find and configure a counter from a set of counters which can monitor an
+  event.
+
+  @param[in]  CounterIndexBase     The first counter index of the set.
+  @param[in]  CounterIndexMask     Bit-vector of the counters of the set,
+                                   relative to CounterIndexBase.
+  @param[in]  ConfigFlags          SBI_PMU_CFG_FLAG_* flags.
+  @param[in]  EventIndex           The event to monitor.
+  @param[in]  EventData            Additional event configuration.
+  @param[out] CounterIndex         The index of the configured counter.
+  @retval EFI_SUCCESS              A counter was configured.
+  @retval EFI_UNSUPPORTED          No counter of the set can monitor the event.
+  @retval EFI_INVALID_PARAMETER    The set or the flags are not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterConfigMatching (
+  IN  UINTN                          CounterIndexBase,
+  IN  UINTN                          CounterIndexMask,
+  IN  UINTN                          ConfigFlags,
+  IN  UINTN                          EventIndex,
+  IN  UINT64                         EventData,
+  OUT UINTN                         *CounterIndex
+  );
+
+/**
+  Start a set of counters.
+
+  @param[in]  CounterIndexBase     The first counter index of the set.
+  @param[in]  CounterIndexMask     Bit-vector of the counters of the set,
+                                   relative to CounterIndexBase.
+  @param[in]  StartFlags           SBI_PMU_START_FLAG_* flags.
+  @param[in]  InitialValue         The initial counter value, if
+                                   SBI_PMU_START_FLAG_SET_INIT_VALUE is set.
+  @retval EFI_SUCCESS              The counters were started.
+  @retval EFI_ALREADY_STARTED      A counter was already started.
+  @retval EFI_INVALID_PARAMETER    The set or the flags are not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterStart (
+  IN  UINTN                          CounterIndexBase,
+  IN  UINTN                          CounterIndexMask,
+  IN  UINTN                          StartFlags,
+  IN  UINT64                         InitialValue
+  );
+
+/**
+  Stop a set of counters.
+
+  @param[in]  CounterIndexBase     The first counter index of the set.
+  @param[in]  CounterIndexMask     Bit-vector of the counters of the set,
+                                   relative to CounterIndexBase.
+  @param[in]  StopFlags            SBI_PMU_STOP_FLAG_* flags.
+  @retval EFI_SUCCESS              The counters were stopped.
+  @retval EFI_ALREADY_STARTED      A counter was already stopped.
+  @retval EFI_INVALID_PARAMETER    The set or the flags are not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterStop (
+  IN  UINTN                          CounterIndexBase,
+  IN  UINTN                          CounterIndexMask,
+  IN  UINTN                          StopFlags
+  );
+
+/**
+  Read the current value of a counter.
+
+  Hardware counters are read from their CSR directly, firmware counters
+  through the SBI.
+
+  @param[in]  CounterIndex         The logical index of the counter.
+  @param[out] Value                The counter value.
+  @retval EFI_SUCCESS              The value was returned.
+  @retval EFI_INVALID_PARAMETER    CounterIndex is not valid.
+  @retval EFI_UNSUPPORTED          The CSR of the counter is not an
+                                   unprivileged counter CSR.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterRead (
+  IN  UINTN                          CounterIndex,
+  OUT UINT64                        *Value
+  );
+
 ///
 /// Vendor Specific extension space: Extension Ids 0x09000000 through 0x09FFFFFF
 ///
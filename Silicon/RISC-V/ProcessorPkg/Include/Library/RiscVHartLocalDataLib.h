@@ -0,0 +1,70 @@
+/** @file
+  Hart-local data of RISC-V DXE.
+
+  Each hart running DXE code keeps a pointer to its RISCV_HART_LOCAL_DATA in
+  the thread pointer register (tp), so that the hart can find its own ID and
+  OpenSBI scratch space without an SBI call. SEC clears tp before entering
+  PEI, tp is 0 until the block of the hart is set up in DXE. The block of
+  the boot hart is set up by CpuDxe, the blocks of the other harts by the MP
+  services driver when they are started.
+
+  The hart-local data is not available once boot services are exited, the
+  OS owns tp from then on.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RISCV_HART_LOCAL_DATA_LIB_H_
+#define RISCV_HART_LOCAL_DATA_LIB_H_
+
+#include <IndustryStandard/RiscVOpensbi.h>
+
+#define RISCV_HART_LOCAL_DATA_SIGNATURE  SIGNATURE_32 ('R', 'V', 'H', 'L')
+
+typedef struct {
+  UINT32                                    Signature;
+  UINT32                                    Reserved;
+  UINTN                                     HartId;
+  SBI_SCRATCH                               *Scratch;
+  EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC  *HartSpecific;
+  ///
+  /// Processor number of the hart in EFI_MP_SERVICES_PROTOCOL, maintained by
+  /// the MP services driver.
+  ///
+  UINTN                                     ProcessorNumber;
+} RISCV_HART_LOCAL_DATA;
+
+/**
+  Return the hart-local data of the calling hart.
+
+  @return The hart-local data, NULL if it isn't set up on the calling hart.
+
+**/
+RISCV_HART_LOCAL_DATA *
+EFIAPI
+RiscVGetHartLocalData (
+  VOID
+  );
+
+/**
+  Set up the hart-local data of the calling hart.
+
+  The block must stay allocated as long as the hart runs UEFI code.
+
+  @param[out] HartLocalData   The hart-local data of the calling hart.
+  @param[in]  HartId          The ID of the calling hart.
+  @param[in]  Scratch         The OpenSBI scratch space of the calling hart.
+
+**/
+VOID
+EFIAPI
+RiscVSetHartLocalData (
+  OUT RISCV_HART_LOCAL_DATA  *HartLocalData,
+  IN  UINTN                  HartId,
+  IN  SBI_SCRATCH            *Scratch
+  );
+
+#endif
@@ -0,0 +1,154 @@
+/** @file
+  RISC-V Platform-Level Interrupt Controller protocol.
+
+  Lets drivers handle the interrupts of their device instead of polling it.
+  The PLIC driver claims an interrupt when the hart takes the supervisor
+  external interrupt, calls the handler registered for its source and
+  completes the interrupt once the handler returns.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef RISCV_PLIC_PROTOCOL_H_
+#define RISCV_PLIC_PROTOCOL_H_
+
+#include <Protocol/DebugSupport.h>
+
+#define RISCV_PLIC_PROTOCOL_GUID \
+  { \
+    0xd3d8406e, 0x0a28, 0x472d, { 0xa4, 0x64, 0x0d, 0x1b, 0x29, 0xa6, 0x95, 0xc0 } \
+  }
+
+typedef struct _RISCV_PLIC_PROTOCOL RISCV_PLIC_PROTOCOL;
+
+//
+// Interrupt source number, as wired to the PLIC. Source 0 doesn't exist.
+//
+typedef UINTN  RISCV_PLIC_SOURCE;
+
+/**
+  Handler of an interrupt source, called at TPL_HIGH_LEVEL with the
+  interrupt claimed.
+
+  @param  Source          The source which interrupted.
+  @param  SystemContext   The context of the interrupted code.
+
+**/
+typedef
+VOID
+(EFIAPI *RISCV_PLIC_INTERRUPT_HANDLER) (
+  IN  RISCV_PLIC_SOURCE     Source,
+  IN  EFI_SYSTEM_CONTEXT    SystemContext
+  );
+
+/**
+  Register the handler of an interrupt source.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Handler         The handler, NULL to unregister the current one.
+
+  @retval EFI_SUCCESS             The handler was registered or unregistered.
+  @retval EFI_ALREADY_STARTED     Handler is not NULL and Source already has
+                                  a handler.
+  @retval EFI_INVALID_PARAMETER   Source is not valid, or Handler is NULL
+                                  and Source has no handler.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RISCV_PLIC_REGISTER) (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  IN  RISCV_PLIC_INTERRUPT_HANDLER  Handler
+  );
+
+/**
+  Enable or disable an interrupt source for the boot hart.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+
+  @retval EFI_SUCCESS             The source was enabled or disabled.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RISCV_PLIC_SOURCE_CONTROL) (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source
+  );
+
+/**
+  Check whether an interrupt source is enabled for the boot hart.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Enabled         TRUE if the source is enabled.
+
+  @retval EFI_SUCCESS             The state was returned.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RISCV_PLIC_SOURCE_STATE) (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  OUT BOOLEAN                       *Enabled
+  );
+
+/**
+  Set the priority of an interrupt source. Priority 0 never interrupts.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Priority        The new priority.
+
+  @retval EFI_SUCCESS             The priority was set.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RISCV_PLIC_SET_PRIORITY) (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  IN  UINT32                        Priority
+  );
+
+/**
+  Get the priority of an interrupt source.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Priority        The current priority.
+
+  @retval EFI_SUCCESS             The priority was returned.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+typedef
+EFI_STATUS
+(EFIAPI *RISCV_PLIC_GET_PRIORITY) (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  OUT UINT32                        *Priority
+  );
+
+struct _RISCV_PLIC_PROTOCOL {
+  RISCV_PLIC_REGISTER         RegisterInterruptSource;
+  RISCV_PLIC_SOURCE_CONTROL   EnableInterruptSource;
+  RISCV_PLIC_SOURCE_CONTROL   DisableInterruptSource;
+  RISCV_PLIC_SOURCE_STATE     GetInterruptSourceState;
+  RISCV_PLIC_SET_PRIORITY     SetInterruptSourcePriority;
+  RISCV_PLIC_GET_PRIORITY     GetInterruptSourcePriority;
+};
+
+extern EFI_GUID gRiscVPlicProtocolGuid;
+
+#endif
@@ -22,6 +22,14 @@
 
 #define ASM_FUNC(Name) _ASM_FUNC(ASM_PFX(Name), .text. ## Name)
 
+//
+// Interrupt type of the supervisor external interrupt, following
+// EXCEPT_RISCV_SOFTWARE_INT and EXCEPT_RISCV_TIMER_INT.
+//
+#ifndef EXCEPT_RISCV_EXTERNAL_INT
+#define EXCEPT_RISCV_EXTERNAL_INT  2
+#endif
+
 #if defined (MDE_CPU_RISCV64)
 typedef UINT64 RISC_V_REGS_PROTOTYPE;
 #else
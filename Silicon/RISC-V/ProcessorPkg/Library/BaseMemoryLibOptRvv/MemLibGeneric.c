@@ -0,0 +1,438 @@
+/** @file
+  Internal memory functions of BaseMemoryLibOptRvv.
+
+  Each function uses the RVV routine when the vector unit of the hart is on
+  and the buffer is long enough, and falls back to the scalar code below
+  otherwise. The scalar code moves 64-bit words when the alignment of the
+  buffers allows it.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "MemLibInternals.h"
+
+#define MEM_LIB_WORD_MASK   (sizeof (UINT64) - 1)
+
+/**
+  Copy Length bytes from SourceBuffer to DestinationBuffer, the buffers may
+  overlap.
+
+  @param  DestinationBuffer The target of the copy request.
+  @param  SourceBuffer      The place to copy from.
+  @param  Length            The number of bytes to copy.
+
+  @return DestinationBuffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemCopyMem (
+  OUT     VOID                      *DestinationBuffer,
+  IN      CONST VOID                *SourceBuffer,
+  IN      UINTN                     Length
+  )
+{
+  volatile UINT8    *Destination8;
+  CONST UINT8       *Source8;
+
+  if (Length >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemCopyMemRvv (DestinationBuffer, SourceBuffer, Length);
+  }
+
+  Destination8 = DestinationBuffer;
+  Source8 = SourceBuffer;
+  if (Source8 > Destination8 || Source8 + Length <= Destination8) {
+    //
+    // Copy forwards, with words once both buffers are aligned.
+    //
+    if ((((UINTN)Destination8 ^ (UINTN)Source8) & MEM_LIB_WORD_MASK) == 0) {
+      while (((UINTN)Destination8 & MEM_LIB_WORD_MASK) != 0 && Length != 0) {
+        *(Destination8++) = *(Source8++);
+        Length--;
+      }
+      for (; Length >= sizeof (UINT64); Length -= sizeof (UINT64)) {
+        *(volatile UINT64 *)Destination8 = *(CONST UINT64 *)Source8;
+        Destination8 += sizeof (UINT64);
+        Source8 += sizeof (UINT64);
+      }
+    }
+    while (Length-- != 0) {
+      *(Destination8++) = *(Source8++);
+    }
+  } else {
+    //
+    // The destination overlaps the end of the source, copy backwards.
+    //
+    Destination8 += Length;
+    Source8 += Length;
+    while (Length-- != 0) {
+      *(--Destination8) = *(--Source8);
+    }
+  }
+  return DestinationBuffer;
+}
+
+/**
+  Fill a buffer with a byte value.
+
+  @param  Buffer    The memory to set.
+  @param  Length    The number of bytes to set.
+  @param  Value     The value with which to fill Length bytes of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT8                     Value
+  )
+{
+  volatile UINT8    *Pointer8;
+  UINT64            Value64;
+
+  if (Length >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemSetMemRvv (Buffer, Length, Value);
+  }
+
+  Pointer8 = Buffer;
+  while (((UINTN)Pointer8 & MEM_LIB_WORD_MASK) != 0 && Length != 0) {
+    *(Pointer8++) = Value;
+    Length--;
+  }
+  Value64 = MultU64x32 (MAX_UINT64 / MAX_UINT8, Value);
+  for (; Length >= sizeof (UINT64); Length -= sizeof (UINT64)) {
+    *(volatile UINT64 *)Pointer8 = Value64;
+    Pointer8 += sizeof (UINT64);
+  }
+  while (Length-- != 0) {
+    *(Pointer8++) = Value;
+  }
+  return Buffer;
+}
+
+/**
+  Fill a buffer with a 16-bit value.
+
+  @param  Buffer    The pointer to the target buffer to fill.
+  @param  Length    The count of 16-bit values to fill.
+  @param  Value     The value with which to fill Length values of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem16 (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT16                    Value
+  )
+{
+  volatile UINT16   *Pointer16;
+
+  if (Length * sizeof (Value) >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemSetMem16Rvv (Buffer, Length, Value);
+  }
+
+  for (Pointer16 = Buffer; Length != 0; Length--) {
+    *(Pointer16++) = Value;
+  }
+  return Buffer;
+}
+
+/**
+  Fill a buffer with a 32-bit value.
+
+  @param  Buffer    The pointer to the target buffer to fill.
+  @param  Length    The count of 32-bit values to fill.
+  @param  Value     The value with which to fill Length values of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem32 (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT32                    Value
+  )
+{
+  volatile UINT32   *Pointer32;
+
+  if (Length * sizeof (Value) >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemSetMem32Rvv (Buffer, Length, Value);
+  }
+
+  for (Pointer32 = Buffer; Length != 0; Length--) {
+    *(Pointer32++) = Value;
+  }
+  return Buffer;
+}
+
+/**
+  Fill a buffer with a 64-bit value.
+
+  @param  Buffer    The pointer to the target buffer to fill.
+  @param  Length    The count of 64-bit values to fill.
+  @param  Value     The value with which to fill Length values of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem64 (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT64                    Value
+  )
+{
+  volatile UINT64   *Pointer64;
+
+  if (Length * sizeof (Value) >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemSetMem64Rvv (Buffer, Length, Value);
+  }
+
+  for (Pointer64 = Buffer; Length != 0; Length--) {
+    *(Pointer64++) = Value;
+  }
+  return Buffer;
+}
+
+/**
+  Set a buffer to 0.
+
+  @param  Buffer    The memory to set.
+  @param  Length    The number of bytes to set.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemZeroMem (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length
+  )
+{
+  return InternalMemSetMem (Buffer, Length, 0);
+}
+
+/**
+  Compare two buffers.
+
+  @param  DestinationBuffer The first buffer to compare.
+  @param  SourceBuffer      The second buffer to compare.
+  @param  Length            The number of bytes to compare, must not be 0.
+
+  @return 0 if the buffers match, otherwise the first mismatched byte of
+          SourceBuffer subtracted from the first mismatched byte of
+          DestinationBuffer.
+
+**/
+INTN
+EFIAPI
+InternalMemCompareMem (
+  IN      CONST VOID                *DestinationBuffer,
+  IN      CONST VOID                *SourceBuffer,
+  IN      UINTN                     Length
+  )
+{
+  CONST UINT8       *Destination8;
+  CONST UINT8       *Source8;
+
+  if (Length >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemCompareMemRvv (DestinationBuffer, SourceBuffer, Length);
+  }
+
+  Destination8 = DestinationBuffer;
+  Source8 = SourceBuffer;
+  while ((--Length != 0) && (*Destination8 == *Source8)) {
+    Destination8++;
+    Source8++;
+  }
+  return (INTN)*Destination8 - (INTN)*Source8;
+}
+
+/**
+  Scan a buffer for an 8-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 8-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem8 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT8                     Value
+  )
+{
+  CONST UINT8       *Pointer;
+
+  if (Length >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemScanMem8Rvv (Buffer, Length, Value);
+  }
+
+  Pointer = (CONST UINT8 *)Buffer;
+  do {
+    if (*Pointer == Value) {
+      return Pointer;
+    }
+    ++Pointer;
+  } while (--Length != 0);
+  return NULL;
+}
+
+/**
+  Scan a buffer for a 16-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 16-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem16 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT16                    Value
+  )
+{
+  CONST UINT16      *Pointer;
+
+  if (Length * sizeof (Value) >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemScanMem16Rvv (Buffer, Length, Value);
+  }
+
+  Pointer = (CONST UINT16 *)Buffer;
+  do {
+    if (*Pointer == Value) {
+      return Pointer;
+    }
+    ++Pointer;
+  } while (--Length != 0);
+  return NULL;
+}
+
+/**
+  Scan a buffer for a 32-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 32-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem32 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT32                    Value
+  )
+{
+  CONST UINT32      *Pointer;
+
+  if (Length * sizeof (Value) >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemScanMem32Rvv (Buffer, Length, Value);
+  }
+
+  Pointer = (CONST UINT32 *)Buffer;
+  do {
+    if (*Pointer == Value) {
+      return Pointer;
+    }
+    ++Pointer;
+  } while (--Length != 0);
+  return NULL;
+}
+
+/**
+  Scan a buffer for a 64-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 64-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem64 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT64                    Value
+  )
+{
+  CONST UINT64      *Pointer;
+
+  if (Length * sizeof (Value) >= MEM_LIB_RVV_MIN_LENGTH && InternalMemRvvEnabled ()) {
+    return InternalMemScanMem64Rvv (Buffer, Length, Value);
+  }
+
+  Pointer = (CONST UINT64 *)Buffer;
+  do {
+    if (*Pointer == Value) {
+      return Pointer;
+    }
+    ++Pointer;
+  } while (--Length != 0);
+  return NULL;
+}
+
+/**
+  Check if a buffer only holds zeros.
+
+  @param  Buffer    The pointer to the buffer to check.
+  @param  Length    The number of bytes to check, must not be 0.
+
+  @retval TRUE      Buffer only holds zeros.
+  @retval FALSE     Buffer holds a non-zero byte.
+
+**/
+BOOLEAN
+EFIAPI
+InternalMemIsZeroBuffer (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  )
+{
+  CONST UINT8       *Pointer8;
+
+  Pointer8 = Buffer;
+  while (((UINTN)Pointer8 & MEM_LIB_WORD_MASK) != 0 && Length != 0) {
+    if (*(Pointer8++) != 0) {
+      return FALSE;
+    }
+    Length--;
+  }
+  for (; Length >= sizeof (UINT64); Length -= sizeof (UINT64)) {
+    if (*(CONST UINT64 *)Pointer8 != 0) {
+      return FALSE;
+    }
+    Pointer8 += sizeof (UINT64);
+  }
+  while (Length-- != 0) {
+    if (*(Pointer8++) != 0) {
+      return FALSE;
+    }
+  }
+  return TRUE;
+}
@@ -0,0 +1,339 @@
+/** @file
+  Declaration of internal functions of BaseMemoryLibOptRvv.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef MEM_LIB_INTERNALS_H_
+#define MEM_LIB_INTERNALS_H_
+
+#include <Base.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+
+//
+// Buffers shorter than this are handled by the scalar code, the vector
+// routines don't pay off for them.
+//
+#define MEM_LIB_RVV_MIN_LENGTH  64
+
+/**
+  Copy Length bytes from SourceBuffer to DestinationBuffer, the buffers may
+  overlap.
+
+  @param  DestinationBuffer The target of the copy request.
+  @param  SourceBuffer      The place to copy from.
+  @param  Length            The number of bytes to copy.
+
+  @return DestinationBuffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemCopyMem (
+  OUT     VOID                      *DestinationBuffer,
+  IN      CONST VOID                *SourceBuffer,
+  IN      UINTN                     Length
+  );
+
+/**
+  Fill a buffer with a byte value.
+
+  @param  Buffer    The memory to set.
+  @param  Length    The number of bytes to set.
+  @param  Value     The value with which to fill Length bytes of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT8                     Value
+  );
+
+/**
+  Fill a buffer with a 16-bit value.
+
+  @param  Buffer    The pointer to the target buffer to fill.
+  @param  Length    The count of 16-bit values to fill.
+  @param  Value     The value with which to fill Length values of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem16 (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT16                    Value
+  );
+
+/**
+  Fill a buffer with a 32-bit value.
+
+  @param  Buffer    The pointer to the target buffer to fill.
+  @param  Length    The count of 32-bit values to fill.
+  @param  Value     The value with which to fill Length values of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem32 (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT32                    Value
+  );
+
+/**
+  Fill a buffer with a 64-bit value.
+
+  @param  Buffer    The pointer to the target buffer to fill.
+  @param  Length    The count of 64-bit values to fill.
+  @param  Value     The value with which to fill Length values of Buffer.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemSetMem64 (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT64                    Value
+  );
+
+/**
+  Set a buffer to 0.
+
+  @param  Buffer    The memory to set.
+  @param  Length    The number of bytes to set.
+
+  @return Buffer.
+
+**/
+VOID *
+EFIAPI
+InternalMemZeroMem (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length
+  );
+
+/**
+  Compare two buffers.
+
+  @param  DestinationBuffer The first buffer to compare.
+  @param  SourceBuffer      The second buffer to compare.
+  @param  Length            The number of bytes to compare, must not be 0.
+
+  @return 0 if the buffers match, otherwise the first mismatched byte of
+          SourceBuffer subtracted from the first mismatched byte of
+          DestinationBuffer.
+
+**/
+INTN
+EFIAPI
+InternalMemCompareMem (
+  IN      CONST VOID                *DestinationBuffer,
+  IN      CONST VOID                *SourceBuffer,
+  IN      UINTN                     Length
+  );
+
+/**
+  Scan a buffer for an 8-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 8-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem8 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT8                     Value
+  );
+
+/**
+  Scan a buffer for a 16-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 16-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem16 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT16                    Value
+  );
+
+/**
+  Scan a buffer for a 32-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 32-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem32 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT32                    Value
+  );
+
+/**
+  Scan a buffer for a 64-bit value.
+
+  @param  Buffer    The pointer to the buffer to scan.
+  @param  Length    The count of 64-bit values to scan, must not be 0.
+  @param  Value     The value to search for.
+
+  @return The address of the first match, NULL if Value isn't found.
+
+**/
+CONST VOID *
+EFIAPI
+InternalMemScanMem64 (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT64                    Value
+  );
+
+/**
+  Check if a buffer only holds zeros.
+
+  @param  Buffer    The pointer to the buffer to check.
+  @param  Length    The number of bytes to check.
+
+  @retval TRUE      Buffer only holds zeros.
+  @retval FALSE     Buffer holds a non-zero byte.
+
+**/
+BOOLEAN
+EFIAPI
+InternalMemIsZeroBuffer (
+  IN CONST VOID  *Buffer,
+  IN UINTN       Length
+  );
+
+//
+// RVV routines, Riscv64/MemLibRvv.S. They take the same arguments as the
+// functions above and may only be called when InternalMemRvvEnabled ()
+// returns TRUE.
+//
+
+/**
+  Check if the vector unit of the current hart is turned on.
+
+  @retval TRUE      The vector routines can be used.
+  @retval FALSE     The hart has no vector unit or it is off.
+
+**/
+BOOLEAN
+EFIAPI
+InternalMemRvvEnabled (
+  VOID
+  );
+
+VOID *
+EFIAPI
+InternalMemCopyMemRvv (
+  OUT     VOID                      *DestinationBuffer,
+  IN      CONST VOID                *SourceBuffer,
+  IN      UINTN                     Length
+  );
+
+VOID *
+EFIAPI
+InternalMemSetMemRvv (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT8                     Value
+  );
+
+VOID *
+EFIAPI
+InternalMemSetMem16Rvv (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT16                    Value
+  );
+
+VOID *
+EFIAPI
+InternalMemSetMem32Rvv (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT32                    Value
+  );
+
+VOID *
+EFIAPI
+InternalMemSetMem64Rvv (
+  OUT     VOID                      *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT64                    Value
+  );
+
+INTN
+EFIAPI
+InternalMemCompareMemRvv (
+  IN      CONST VOID                *DestinationBuffer,
+  IN      CONST VOID                *SourceBuffer,
+  IN      UINTN                     Length
+  );
+
+CONST VOID *
+EFIAPI
+InternalMemScanMem8Rvv (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT8                     Value
+  );
+
+CONST VOID *
+EFIAPI
+InternalMemScanMem16Rvv (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT16                    Value
+  );
+
+CONST VOID *
+EFIAPI
+InternalMemScanMem32Rvv (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT32                    Value
+  );
+
+CONST VOID *
+EFIAPI
+InternalMemScanMem64Rvv (
+  IN      CONST VOID                *Buffer,
+  IN      UINTN                     Length,
+  IN      UINT64                    Value
+  );
+
+#endif
@@ -402,7 +402,7 @@ SbiSendIpi (
                  SBI_EXT_IPI,
                  SBI_EXT_IPI_SEND_IPI,
                  2,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase
                  );
   return TranslateError (Ret.Error);
@@ -432,7 +432,7 @@ SbiRemoteFenceI (
                  SBI_EXT_RFENCE,
                  SBI_EXT_RFENCE_REMOTE_FENCE_I,
                  2,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase
                  );
   return TranslateError (Ret.Error);
@@ -472,7 +472,7 @@ SbiRemoteSfenceVma (
                  SBI_EXT_RFENCE,
                  SBI_EXT_RFENCE_REMOTE_SFENCE_VMA,
                  4,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase,
                  StartAddr,
                  Size
@@ -516,7 +516,7 @@ SbiRemoteSfenceVmaAsid (
                  SBI_EXT_RFENCE,
                  SBI_EXT_RFENCE_REMOTE_SFENCE_VMA_ASID,
                  5,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase,
                  StartAddr,
                  Size,
@@ -565,7 +565,7 @@ SbiRemoteHFenceGvmaVmid (
                  SBI_EXT_RFENCE,
                  SBI_EXT_RFENCE_REMOTE_HFENCE_GVMA,
                  5,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase,
                  StartAddr,
                  Size,
@@ -612,7 +612,7 @@ SbiRemoteHFenceGvma (
                  SBI_EXT_RFENCE,
                  SBI_EXT_RFENCE_REMOTE_HFENCE_GVMA_VMID,
                  4,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase,
                  StartAddr,
                  Size
@@ -660,7 +660,7 @@ SbiRemoteHFenceVvmaAsid (
                  SBI_EXT_RFENCE,
                  SBI_EXT_RFENCE_REMOTE_HFENCE_VVMA,
                  5,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase,
                  StartAddr,
                  Size,
@@ -707,7 +707,7 @@ SbiRemoteHFenceVvma (
                  SBI_EXT_RFENCE,
                  SBI_EXT_RFENCE_REMOTE_HFENCE_VVMA_ASID,
                  4,
-                 (UINTN)HartMask,
+                 *HartMask,
                  HartMaskBase,
                  StartAddr,
                  Size
@@ -715,6 +715,532 @@ SbiRemoteHFenceVvma (
   return TranslateError (Ret.Error);
 }
 
+//
+// Batching of remote fences.
+//
+// The SBI has no call taking several fences, so a batch is sent as one
+// call per queued range. Ranges are merged while they are queued to keep
+// that number low.
+//
+
+/**
+  Get the fence type which flushes the same structures for all ASIDs or
+  VMIDs.
+
+  @param[in] Type   The type of the fence.
+
+  @return The type without ASID or VMID, Type itself if it has none.
+**/
+STATIC
+SBI_RFENCE_TYPE
+RfenceGlobalType (
+  IN  SBI_RFENCE_TYPE                Type
+  )
+{
+  switch (Type) {
+    case SbiRfenceSfenceVmaAsid:
+      return SbiRfenceSfenceVma;
+    case SbiRfenceHfenceGvmaVmid:
+      return SbiRfenceHfenceGvma;
+    case SbiRfenceHfenceVvmaAsid:
+      return SbiRfenceHfenceVvma;
+    default:
+      return Type;
+  }
+}
+
+/**
+  Check whether a queued fence covers the whole address space.
+
+  @param[in] Entry  The queued fence.
+
+  @retval TRUE      The fence is a full flush.
+  @retval FALSE     The fence covers a range.
+**/
+STATIC
+BOOLEAN
+RfenceEntryIsFull (
+  IN  CONST SBI_RFENCE_BATCH_ENTRY  *Entry
+  )
+{
+  return (BOOLEAN)((Entry->StartAddr == 0 && Entry->Size == 0) ||
+                   Entry->Size == MAX_UINTN);
+}
+
+/**
+  Check whether a fence makes another one unnecessary.
+
+  @param[in] Entry  The fence which may cover Other.
+  @param[in] Other  The fence which may be covered.
+
+  @retval TRUE      Entry covers everything Other flushes.
+  @retval FALSE     Other is still needed.
+**/
+STATIC
+BOOLEAN
+RfenceEntryCovers (
+  IN  CONST SBI_RFENCE_BATCH_ENTRY  *Entry,
+  IN  CONST SBI_RFENCE_BATCH_ENTRY  *Other
+  )
+{
+  if (!RfenceEntryIsFull (Entry)) {
+    return FALSE;
+  }
+  if (Entry->Type == Other->Type) {
+    return (BOOLEAN)(Entry->Id == Other->Id);
+  }
+  return (BOOLEAN)(Entry->Type == RfenceGlobalType (Other->Type));
+}
+
+/**
+  Start an empty batch of remote fences for the given harts.
+
+  @param[out] Batch                The batch to initialize.
+  @param[in]  HartMask             Scalar bit-vector containing hart ids
+  @param[in]  HartMaskBase         The starting hartid from which the bit-vector
+                                   must be computed. If set to -1, HartMask is
+                                   ignored and all harts are considered.
+**/
+VOID
+EFIAPI
+SbiRemoteFenceBatchInit (
+  OUT SBI_RFENCE_BATCH              *Batch,
+  IN  UINTN                          HartMask,
+  IN  UINTN                          HartMaskBase
+  )
+{
+  ASSERT (Batch != NULL);
+
+  Batch->HartMask = HartMask;
+  Batch->HartMaskBase = HartMaskBase;
+  Batch->Count = 0;
+}
+
+/**
+  Queue a remote fence in a batch.
+
+  The fence is merged with a queued fence of the same type and ASID/VMID if
+  their ranges overlap or touch. If the batch is full, all the fences of
+  this type are replaced by a single full flush.
+
+  @param[in,out] Batch             The batch.
+  @param[in]     Type              The type of the fence.
+  @param[in]     StartAddr         The first address of the affected range.
+  @param[in]     Size              How many addresses are affected, 0 together
+                                   with StartAddr 0 for a full flush.
+  @param[in]     Id                The ASID or VMID for the types taking one,
+                                   ignored otherwise.
+  @retval EFI_SUCCESS              The fence was queued.
+  @retval EFI_INVALID_PARAMETER    Type is not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiRemoteFenceBatchAdd (
+  IN OUT SBI_RFENCE_BATCH           *Batch,
+  IN     SBI_RFENCE_TYPE             Type,
+  IN     UINTN                       StartAddr,
+  IN     UINTN                       Size,
+  IN     UINTN                       Id
+  )
+{
+  SBI_RFENCE_BATCH_ENTRY  New;
+  SBI_RFENCE_BATCH_ENTRY  *Entry;
+  UINTN                   Index;
+  UINTN                   Kept;
+  UINTN                   Other;
+  UINTN                   End;
+  UINTN                   EntryEnd;
+  BOOLEAN                 Merged;
+
+  ASSERT (Batch != NULL);
+
+  if ((UINTN)Type >= SbiRfenceTypeMax) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if (Type != SbiRfenceFenceI && Size == 0 && StartAddr != 0) {
+    return EFI_SUCCESS;
+  }
+
+  New.Type = Type;
+  New.StartAddr = StartAddr;
+  New.Size = Size;
+  New.Id = (RfenceGlobalType (Type) != Type) ? Id : 0;
+  if (Type == SbiRfenceFenceI) {
+    New.StartAddr = 0;
+    New.Size = 0;
+  }
+  if (!RfenceEntryIsFull (&New) && StartAddr + Size < StartAddr) {
+    //
+    // The range wraps around the address space.
+    //
+    New.StartAddr = 0;
+    New.Size = 0;
+  }
+
+  if (Batch->Count == SBI_RFENCE_BATCH_MAX_ENTRIES) {
+    //
+    // No room left: replace the queued fences by one full flush per type,
+    // for all ASIDs and VMIDs. There are far fewer types than entries.
+    //
+    Kept = 0;
+    for (Index = 0; Index < Batch->Count; Index++) {
+      Entry = &Batch->Entries[Index];
+      Entry->Type = RfenceGlobalType (Entry->Type);
+      Entry->StartAddr = 0;
+      Entry->Size = 0;
+      Entry->Id = 0;
+      for (Other = 0; Other < Kept; Other++) {
+        if (Batch->Entries[Other].Type == Entry->Type) {
+          break;
+        }
+      }
+      if (Other == Kept) {
+        Batch->Entries[Kept++] = *Entry;
+      }
+    }
+    Batch->Count = Kept;
+  }
+
+  for (Index = 0; Index < Batch->Count; Index++) {
+    if (RfenceEntryCovers (&Batch->Entries[Index], &New)) {
+      return EFI_SUCCESS;
+    }
+  }
+
+  //
+  // Merge the new fence with the queued fences it overlaps or touches,
+  // dropping them from the batch, until the range doesn't grow anymore.
+  //
+  do {
+    Merged = FALSE;
+    Kept = 0;
+    for (Index = 0; Index < Batch->Count; Index++) {
+      Entry = &Batch->Entries[Index];
+      if (RfenceEntryCovers (&New, Entry)) {
+        continue;
+      }
+      if (Entry->Type == New.Type && Entry->Id == New.Id &&
+          !RfenceEntryIsFull (Entry) && !RfenceEntryIsFull (&New)) {
+        End = New.StartAddr + New.Size;
+        EntryEnd = Entry->StartAddr + Entry->Size;
+        if (Entry->StartAddr <= End && New.StartAddr <= EntryEnd) {
+          New.StartAddr = MIN (New.StartAddr, Entry->StartAddr);
+          New.Size = MAX (End, EntryEnd) - New.StartAddr;
+          Merged = TRUE;
+          continue;
+        }
+      }
+      Batch->Entries[Kept++] = *Entry;
+    }
+    Batch->Count = Kept;
+  } while (Merged);
+
+  Batch->Entries[Batch->Count++] = New;
+  return EFI_SUCCESS;
+}
+
+/**
+  Send all the fences queued in a batch and empty it.
+
+  @param[in,out] Batch             The batch.
+  @retval EFI_SUCCESS              All the fences were sent.
+  @retval others                   The error of the first SBI call which
+                                   failed. The remaining fences are still sent.
+**/
+EFI_STATUS
+EFIAPI
+SbiRemoteFenceBatchSubmit (
+  IN OUT SBI_RFENCE_BATCH           *Batch
+  )
+{
+  SBI_RFENCE_BATCH_ENTRY  *Entry;
+  UINTN                   Index;
+  SbiRet                  Ret;
+  EFI_STATUS              Status;
+  EFI_STATUS              FirstError;
+
+  ASSERT (Batch != NULL);
+
+  FirstError = EFI_SUCCESS;
+  for (Index = 0; Index < Batch->Count; Index++) {
+    Entry = &Batch->Entries[Index];
+    //
+    // The fence types are numbered like the function IDs of the RFENCE
+    // extension.
+    //
+    Ret = SbiCall (
+            SBI_EXT_RFENCE,
+            (UINTN)Entry->Type,
+            5,
+            Batch->HartMask,
+            Batch->HartMaskBase,
+            Entry->StartAddr,
+            Entry->Size,
+            Entry->Id
+            );
+    Status = TranslateError (Ret.Error);
+    if (EFI_ERROR (Status) && !EFI_ERROR (FirstError)) {
+      FirstError = Status;
+    }
+  }
+
+  Batch->Count = 0;
+  return FirstError;
+}
+
+//
+// SBI interface function for the PMU extension
+//
+
+/**
+  Get the number of PMU counters, hardware and firmware.
+
+  @param[out] NumCounters          The number of counters.
+  @retval EFI_SUCCESS              The number was returned.
+  @retval EFI_UNSUPPORTED          The SBI implementation has no PMU extension.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuGetNumCounters (
+  OUT UINTN                         *NumCounters
+  )
+{
+  SbiRet Ret = SbiCall (SBI_EXT_PMU, SBI_EXT_PMU_NUM_COUNTERS, 0);
+  if (Ret.Error == SBI_SUCCESS) {
+    *NumCounters = Ret.Value;
+  }
+  return TranslateError (Ret.Error);
+}
+
+/**
+  Get the details of a PMU counter.
+
+  Decode CounterInfo with the SBI_PMU_COUNTER_INFO_* macros.
+
+  @param[in]  CounterIndex         The logical index of the counter.
+  @param[out] CounterInfo          The counter information.
+  @retval EFI_SUCCESS              The information was returned.
+  @retval EFI_INVALID_PARAMETER    CounterIndex is not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterGetInfo (
+  IN  UINTN                          CounterIndex,
+  OUT UINTN                         *CounterInfo
+  )
+{
+  SbiRet Ret = SbiCall (
+                 SBI_EXT_PMU,
+                 SBI_EXT_PMU_COUNTER_GET_INFO,
+                 1,
+                 CounterIndex
+                 );
+  if (Ret.Error == SBI_SUCCESS) {
+    *CounterInfo = Ret.Value;
+  }
+  return TranslateError (Ret.Error);
+}
+
+/**
+  Find and configure a counter from a set of counters which can monitor an
+  event.
+
+  @param[in]  CounterIndexBase     The first counter index of the set.
+  @param[in]  CounterIndexMask     Bit-vector of the counters of the set,
+                                   relative to CounterIndexBase.
+  @param[in]  ConfigFlags          SBI_PMU_CFG_FLAG_* flags.
+  @param[in]  EventIndex           The event to monitor.
+  @param[in]  EventData            Additional event configuration.
+  @param[out] CounterIndex         The index of the configured counter.
+  @retval EFI_SUCCESS              A counter was configured.
+  @retval EFI_UNSUPPORTED          No counter of the set can monitor the event.
+  @retval EFI_INVALID_PARAMETER    The set or the flags are not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterConfigMatching (
+  IN  UINTN                          CounterIndexBase,
+  IN  UINTN                          CounterIndexMask,
+  IN  UINTN                          ConfigFlags,
+  IN  UINTN                          EventIndex,
+  IN  UINT64                         EventData,
+  OUT UINTN                         *CounterIndex
+  )
+{
+  SbiRet Ret = SbiCall (
+                 SBI_EXT_PMU,
+                 SBI_EXT_PMU_COUNTER_CFG_MATCH,
+                 5,
+                 CounterIndexBase,
+                 CounterIndexMask,
+                 ConfigFlags,
+                 EventIndex,
+                 (UINTN)EventData
+                 );
+  if (Ret.Error == SBI_SUCCESS) {
+    *CounterIndex = Ret.Value;
+  }
+  return TranslateError (Ret.Error);
+}
+
+/**
+  Start a set of counters.
+
+  @param[in]  CounterIndexBase     The first counter index of the set.
+  @param[in]  CounterIndexMask     Bit-vector of the counters of the set,
+                                   relative to CounterIndexBase.
+  @param[in]  StartFlags           SBI_PMU_START_FLAG_* flags.
+  @param[in]  InitialValue         The initial counter value, if
+                                   SBI_PMU_START_FLAG_SET_INIT_VALUE is set.
+  @retval EFI_SUCCESS              The counters were started.
+  @retval EFI_ALREADY_STARTED      A counter was already started.
+  @retval EFI_INVALID_PARAMETER    The set or the flags are not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterStart (
+  IN  UINTN                          CounterIndexBase,
+  IN  UINTN                          CounterIndexMask,
+  IN  UINTN                          StartFlags,
+  IN  UINT64                         InitialValue
+  )
+{
+  SbiRet Ret = SbiCall (
+                 SBI_EXT_PMU,
+                 SBI_EXT_PMU_COUNTER_START,
+                 4,
+                 CounterIndexBase,
+                 CounterIndexMask,
+                 StartFlags,
+                 (UINTN)InitialValue
+                 );
+  return TranslateError (Ret.Error);
+}
+
+/**
+  Stop a set of counters.
+
+  @param[in]  CounterIndexBase     The first counter index of the set.
+  @param[in]  CounterIndexMask     Bit-vector of the counters of the set,
+                                   relative to CounterIndexBase.
+  @param[in]  StopFlags            SBI_PMU_STOP_FLAG_* flags.
+  @retval EFI_SUCCESS              The counters were stopped.
+  @retval EFI_ALREADY_STARTED      A counter was already stopped.
+  @retval EFI_INVALID_PARAMETER    The set or the flags are not valid.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterStop (
+  IN  UINTN                          CounterIndexBase,
+  IN  UINTN                          CounterIndexMask,
+  IN  UINTN                          StopFlags
+  )
+{
+  SbiRet Ret = SbiCall (
+                 SBI_EXT_PMU,
+                 SBI_EXT_PMU_COUNTER_STOP,
+                 3,
+                 CounterIndexBase,
+                 CounterIndexMask,
+                 StopFlags
+                 );
+  return TranslateError (Ret.Error);
+}
+
+//
+// csrr takes the CSR number as an immediate, so each unprivileged counter
+// CSR needs its own read.
+//
+#define PMU_CSR_READ_CASE(Csr) \
+  case (Csr): \
+    return csr_read (Csr);
+
+/**
+  Read an unprivileged counter CSR, cycle, time, instret or hpmcounter3-31.
+
+  @param[in] Csr   The CSR number.
+
+  @return The CSR value, 0 if Csr is not a counter CSR.
+**/
+STATIC
+UINT64
+PmuReadCounterCsr (
+  IN  UINTN                          Csr
+  )
+{
+  switch (Csr) {
+    PMU_CSR_READ_CASE (0xC00) PMU_CSR_READ_CASE (0xC01)
+    PMU_CSR_READ_CASE (0xC02) PMU_CSR_READ_CASE (0xC03)
+    PMU_CSR_READ_CASE (0xC04) PMU_CSR_READ_CASE (0xC05)
+    PMU_CSR_READ_CASE (0xC06) PMU_CSR_READ_CASE (0xC07)
+    PMU_CSR_READ_CASE (0xC08) PMU_CSR_READ_CASE (0xC09)
+    PMU_CSR_READ_CASE (0xC0A) PMU_CSR_READ_CASE (0xC0B)
+    PMU_CSR_READ_CASE (0xC0C) PMU_CSR_READ_CASE (0xC0D)
+    PMU_CSR_READ_CASE (0xC0E) PMU_CSR_READ_CASE (0xC0F)
+    PMU_CSR_READ_CASE (0xC10) PMU_CSR_READ_CASE (0xC11)
+    PMU_CSR_READ_CASE (0xC12) PMU_CSR_READ_CASE (0xC13)
+    PMU_CSR_READ_CASE (0xC14) PMU_CSR_READ_CASE (0xC15)
+    PMU_CSR_READ_CASE (0xC16) PMU_CSR_READ_CASE (0xC17)
+    PMU_CSR_READ_CASE (0xC18) PMU_CSR_READ_CASE (0xC19)
+    PMU_CSR_READ_CASE (0xC1A) PMU_CSR_READ_CASE (0xC1B)
+    PMU_CSR_READ_CASE (0xC1C) PMU_CSR_READ_CASE (0xC1D)
+    PMU_CSR_READ_CASE (0xC1E) PMU_CSR_READ_CASE (0xC1F)
+    default:
+      return 0;
+  }
+}
+
+/**
+  Read the current value of a counter.
+
+  Hardware counters are read from their CSR directly, firmware counters
+  through the SBI.
+
+  @param[in]  CounterIndex         The logical index of the counter.
+  @param[out] Value                The counter value.
+  @retval EFI_SUCCESS              The value was returned.
+  @retval EFI_INVALID_PARAMETER    CounterIndex is not valid.
+  @retval EFI_UNSUPPORTED          The CSR of the counter is not an
+                                   unprivileged counter CSR.
+**/
+EFI_STATUS
+EFIAPI
+SbiPmuCounterRead (
+  IN  UINTN                          CounterIndex,
+  OUT UINT64                        *Value
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       Info;
+  UINTN       Csr;
+  SbiRet      Ret;
+
+  Status = SbiPmuCounterGetInfo (CounterIndex, &Info);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  if (SBI_PMU_COUNTER_INFO_IS_FIRMWARE (Info)) {
+    Ret = SbiCall (
+            SBI_EXT_PMU,
+            SBI_EXT_PMU_COUNTER_FW_READ,
+            1,
+            CounterIndex
+            );
+    if (Ret.Error == SBI_SUCCESS) {
+      *Value = Ret.Value;
+    }
+    return TranslateError (Ret.Error);
+  }
+
+  Csr = SBI_PMU_COUNTER_INFO_CSR (Info);
+  if (Csr < 0xC00 || Csr > 0xC1F) {
+    return EFI_UNSUPPORTED;
+  }
+  *Value = PmuReadCounterCsr (Csr);
+  return EFI_SUCCESS;
+}
+
 //
 // SBI interface function for the vendor extension
 //
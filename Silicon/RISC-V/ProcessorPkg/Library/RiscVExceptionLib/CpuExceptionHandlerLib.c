@@ -17,7 +17,7 @@
 
 #include "CpuExceptionHandlerLib.h"
 
-STATIC EFI_CPU_INTERRUPT_HANDLER mInterruptHandlers[2];
+STATIC EFI_CPU_INTERRUPT_HANDLER mInterruptHandlers[EXCEPT_RISCV_EXTERNAL_INT + 1];
 
 /**
   Initializes all CPU exceptions entries and provides the default exception handlers.
@@ -101,6 +101,9 @@ RegisterCpuInterruptHandler (
 {
 
   DEBUG ((DEBUG_INFO, "%a: Type:%x Handler: %x\n", __FUNCTION__, InterruptType, InterruptHandler));
+  if ((UINTN)InterruptType >= ARRAY_SIZE (mInterruptHandlers)) {
+    return EFI_UNSUPPORTED;
+  }
   mInterruptHandlers[InterruptType] = InterruptHandler;
   return EFI_SUCCESS;
 }
@@ -130,6 +133,12 @@ RiscVSupervisorModeTrapHandler (
     SCause &= ~(1UL << (sizeof (UINTN) * 8- 1));
     if((SCause == SCAUSE_SUPERVISOR_TIMER_INT) && (mInterruptHandlers[EXCEPT_RISCV_TIMER_INT] != NULL)) {
       mInterruptHandlers[EXCEPT_RISCV_TIMER_INT](EXCEPT_RISCV_TIMER_INT, RiscVSystemContext);
+    } else if ((SCause == SCAUSE_SUPERVISOR_EXTERNAL_INT) && (mInterruptHandlers[EXCEPT_RISCV_EXTERNAL_INT] != NULL)) {
+      //
+      // The interrupt controller driver claims and dispatches the device
+      // interrupts.
+      //
+      mInterruptHandlers[EXCEPT_RISCV_EXTERNAL_INT](EXCEPT_RISCV_EXTERNAL_INT, RiscVSystemContext);
     }
   }
 }
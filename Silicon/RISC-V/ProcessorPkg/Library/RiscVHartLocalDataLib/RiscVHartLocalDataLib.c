@@ -0,0 +1,62 @@
+/** @file
+  RISC-V hart-local data library, the pointer to the data of each hart is
+  kept in its thread pointer register.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/RiscVCpuLib.h>
+#include <Library/RiscVHartLocalDataLib.h>
+
+/**
+  Return the hart-local data of the calling hart.
+
+  @return The hart-local data, NULL if it isn't set up on the calling hart.
+
+**/
+RISCV_HART_LOCAL_DATA *
+EFIAPI
+RiscVGetHartLocalData (
+  VOID
+  )
+{
+  RISCV_HART_LOCAL_DATA  *HartLocalData;
+
+  HartLocalData = (RISCV_HART_LOCAL_DATA *)RiscVGetThreadPointer ();
+  ASSERT (HartLocalData == NULL || HartLocalData->Signature == RISCV_HART_LOCAL_DATA_SIGNATURE);
+  return HartLocalData;
+}
+
+/**
+  Set up the hart-local data of the calling hart.
+
+  The block must stay allocated as long as the hart runs UEFI code.
+
+  @param[out] HartLocalData   The hart-local data of the calling hart.
+  @param[in]  HartId          The ID of the calling hart.
+  @param[in]  Scratch         The OpenSBI scratch space of the calling hart.
+
+**/
+VOID
+EFIAPI
+RiscVSetHartLocalData (
+  OUT RISCV_HART_LOCAL_DATA  *HartLocalData,
+  IN  UINTN                  HartId,
+  IN  SBI_SCRATCH            *Scratch
+  )
+{
+  ASSERT (HartLocalData != NULL && Scratch != NULL);
+
+  ZeroMem (HartLocalData, sizeof (*HartLocalData));
+  HartLocalData->Signature    = RISCV_HART_LOCAL_DATA_SIGNATURE;
+  HartLocalData->HartId       = HartId;
+  HartLocalData->Scratch      = Scratch;
+  HartLocalData->HartSpecific = (EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC *)((UINTN)Scratch - FIRMWARE_CONTEXT_HART_SPECIFIC_SIZE);
+  RiscVSetThreadPointer ((UINTN)HartLocalData);
+}
@@ -0,0 +1,447 @@
+/** @file
+  RISC-V instance of the synchronization library.
+
+  Spin locks are ticket locks. The low half of the SPIN_LOCK holds the next
+  ticket to hand out, the high half the ticket which owns the lock. Waiting
+  harts get the lock in the order they asked for it, and spin on a plain
+  load of the owner ticket instead of retrying an AMO on the lock.
+
+  Taking a ticket has acquire ordering and handing the lock on has release
+  ordering. The Interlocked functions are fully ordered.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include <Base.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/PcdLib.h>
+#include <Library/SynchronizationLib.h>
+#include <Library/TimerLib.h>
+
+//
+// Keep locks in separate cache blocks, so harts spinning on one lock don't
+// slow down the owner of another.
+//
+#define SPIN_LOCK_ALIGNMENT   64
+
+typedef struct {
+  UINT32    NextTicket;
+  UINT32    OwnerTicket;
+} TICKET_LOCK;
+
+#define TICKET_LOCK_FROM_SPIN_LOCK(SpinLock)  ((volatile TICKET_LOCK *)(SpinLock))
+
+UINT32
+EFIAPI
+InternalSyncTakeTicket (
+  IN      volatile UINT32           *NextTicket
+  );
+
+VOID
+EFIAPI
+InternalSyncServeNextTicket (
+  IN      volatile UINT32           *OwnerTicket
+  );
+
+VOID
+EFIAPI
+InternalSyncAcquireBarrier (
+  VOID
+  );
+
+VOID
+EFIAPI
+InternalSyncPause (
+  VOID
+  );
+
+UINT32
+EFIAPI
+InternalSyncIncrement (
+  IN      volatile UINT32           *Value
+  );
+
+UINT32
+EFIAPI
+InternalSyncDecrement (
+  IN      volatile UINT32           *Value
+  );
+
+UINT16
+EFIAPI
+InternalSyncCompareExchange16 (
+  IN OUT  volatile UINT16           *Value,
+  IN      UINT16                    CompareValue,
+  IN      UINT16                    ExchangeValue
+  );
+
+UINT32
+EFIAPI
+InternalSyncCompareExchange32 (
+  IN OUT  volatile UINT32           *Value,
+  IN      UINT32                    CompareValue,
+  IN      UINT32                    ExchangeValue
+  );
+
+UINT64
+EFIAPI
+InternalSyncCompareExchange64 (
+  IN OUT  volatile UINT64           *Value,
+  IN      UINT64                    CompareValue,
+  IN      UINT64                    ExchangeValue
+  );
+
+/**
+  Retrieves the architecture specific spin lock alignment requirements for
+  optimal spin lock performance.
+
+  @return The architecture specific spin lock alignment.
+
+**/
+UINTN
+EFIAPI
+GetSpinLockProperties (
+  VOID
+  )
+{
+  return SPIN_LOCK_ALIGNMENT;
+}
+
+/**
+  Initializes a spin lock to the released state and returns the spin lock.
+
+  If SpinLock is NULL, then ASSERT().
+
+  @param  SpinLock  A pointer to the spin lock to initialize to the released
+                    state.
+
+  @return SpinLock in release state.
+
+**/
+SPIN_LOCK *
+EFIAPI
+InitializeSpinLock (
+  OUT      SPIN_LOCK                 *SpinLock
+  )
+{
+  ASSERT (SpinLock != NULL);
+
+  *SpinLock = 0;
+  MemoryFence ();
+  return SpinLock;
+}
+
+/**
+  Waits until a spin lock can be placed in the acquired state.
+
+  The hart takes the next ticket of the lock and waits until the lock is
+  handed to that ticket. If PcdSpinLockTimeout is not zero and the lock is
+  not acquired in that many microseconds, then ASSERT(). A ticket can't be
+  given back, the hart keeps waiting after the ASSERT().
+
+  If SpinLock is NULL, then ASSERT().
+
+  @param  SpinLock  A pointer to the spin lock to place in the acquired state.
+
+  @return SpinLock acquired the lock.
+
+**/
+SPIN_LOCK *
+EFIAPI
+AcquireSpinLock (
+  IN OUT  SPIN_LOCK                 *SpinLock
+  )
+{
+  volatile TICKET_LOCK  *Lock;
+  UINT32                Ticket;
+  UINT64                Current;
+  UINT64                Previous;
+  UINT64                Total;
+  UINT64                Start;
+  UINT64                End;
+  UINT64                Timeout;
+  INT64                 Cycle;
+  INT64                 Delta;
+
+  ASSERT (SpinLock != NULL);
+
+  Lock   = TICKET_LOCK_FROM_SPIN_LOCK (SpinLock);
+  Ticket = InternalSyncTakeTicket (&Lock->NextTicket);
+  if (Lock->OwnerTicket == Ticket) {
+    InternalSyncAcquireBarrier ();
+    return SpinLock;
+  }
+
+  if (PcdGet32 (PcdSpinLockTimeout) == 0) {
+    while (Lock->OwnerTicket != Ticket) {
+      InternalSyncPause ();
+    }
+  } else {
+    //
+    // Get the current timer value
+    //
+    Current = GetPerformanceCounter ();
+
+    //
+    // Initialize local variables
+    //
+    Start = 0;
+    End   = 0;
+    Total = 0;
+
+    //
+    // Retrieve the performance counter properties and compute the number of
+    // performance counter ticks required to reach the timeout
+    //
+    Timeout = DivU64x32 (
+                MultU64x32 (
+                  GetPerformanceCounterProperties (&Start, &End),
+                  PcdGet32 (PcdSpinLockTimeout)
+                  ),
+                1000000
+                );
+    Cycle = End - Start;
+    if (Cycle < 0) {
+      Cycle = -Cycle;
+    }
+    Cycle++;
+
+    while (Lock->OwnerTicket != Ticket) {
+      InternalSyncPause ();
+      Previous = Current;
+      Current  = GetPerformanceCounter ();
+      Delta = (INT64)(Current - Previous);
+      if (Start > End) {
+        Delta = -Delta;
+      }
+      if (Delta < 0) {
+        Delta += Cycle;
+      }
+      Total += Delta;
+      ASSERT (Total < Timeout);
+    }
+  }
+
+  InternalSyncAcquireBarrier ();
+  return SpinLock;
+}
+
+/**
+  Attempts to place a spin lock in the acquired state.
+
+  The lock is only taken if it is released and no other hart waits for it.
+
+  If SpinLock is NULL, then ASSERT().
+
+  @param  SpinLock  A pointer to the spin lock to place in the acquired state.
+
+  @retval TRUE  SpinLock was placed in the acquired state.
+  @retval FALSE SpinLock could not be acquired.
+
+**/
+BOOLEAN
+EFIAPI
+AcquireSpinLockOrFail (
+  IN OUT  SPIN_LOCK                 *SpinLock
+  )
+{
+  volatile TICKET_LOCK  *Lock;
+  TICKET_LOCK           Value;
+  TICKET_LOCK           NewValue;
+
+  ASSERT (SpinLock != NULL);
+
+  Lock                 = TICKET_LOCK_FROM_SPIN_LOCK (SpinLock);
+  Value.NextTicket     = Lock->NextTicket;
+  Value.OwnerTicket    = Lock->OwnerTicket;
+  if (Value.NextTicket != Value.OwnerTicket) {
+    return FALSE;
+  }
+
+  //
+  // Only the next ticket changes, a carry must not reach the owner ticket.
+  //
+  NewValue.NextTicket  = Value.NextTicket + 1;
+  NewValue.OwnerTicket = Value.OwnerTicket;
+  return (BOOLEAN)(InternalSyncCompareExchange64 (
+                     (volatile UINT64 *)SpinLock,
+                     ReadUnaligned64 ((UINT64 *)&Value),
+                     ReadUnaligned64 ((UINT64 *)&NewValue)
+                     ) == ReadUnaligned64 ((UINT64 *)&Value));
+}
+
+/**
+  Releases a spin lock.
+
+  If SpinLock is NULL, then ASSERT().
+
+  @param  SpinLock  A pointer to the spin lock to release.
+
+  @return SpinLock released the lock.
+
+**/
+SPIN_LOCK *
+EFIAPI
+ReleaseSpinLock (
+  IN OUT  SPIN_LOCK                 *SpinLock
+  )
+{
+  volatile TICKET_LOCK  *Lock;
+
+  ASSERT (SpinLock != NULL);
+
+  Lock = TICKET_LOCK_FROM_SPIN_LOCK (SpinLock);
+  ASSERT (Lock->NextTicket != Lock->OwnerTicket);
+  InternalSyncServeNextTicket (&Lock->OwnerTicket);
+  return SpinLock;
+}
+
+/**
+  Performs an atomic increment of a 32-bit unsigned integer.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value A pointer to the 32-bit value to increment.
+
+  @return The incremented value.
+
+**/
+UINT32
+EFIAPI
+InterlockedIncrement (
+  IN      volatile UINT32           *Value
+  )
+{
+  ASSERT (Value != NULL);
+  return InternalSyncIncrement (Value);
+}
+
+/**
+  Performs an atomic decrement of a 32-bit unsigned integer.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value A pointer to the 32-bit value to decrement.
+
+  @return The decremented value.
+
+**/
+UINT32
+EFIAPI
+InterlockedDecrement (
+  IN      volatile UINT32           *Value
+  )
+{
+  ASSERT (Value != NULL);
+  return InternalSyncDecrement (Value);
+}
+
+/**
+  Performs an atomic compare exchange operation on a 16-bit unsigned integer.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value         A pointer to the 16-bit value for the compare exchange
+                        operation.
+  @param  CompareValue  A 16-bit value used in a compare operation.
+  @param  ExchangeValue A 16-bit value used in an exchange operation.
+
+  @return The original *Value before exchange.
+
+**/
+UINT16
+EFIAPI
+InterlockedCompareExchange16 (
+  IN OUT  volatile UINT16           *Value,
+  IN      UINT16                    CompareValue,
+  IN      UINT16                    ExchangeValue
+  )
+{
+  ASSERT (Value != NULL);
+  ASSERT (((UINTN)Value & (sizeof (*Value) - 1)) == 0);
+  return InternalSyncCompareExchange16 (Value, CompareValue, ExchangeValue);
+}
+
+/**
+  Performs an atomic compare exchange operation on a 32-bit unsigned integer.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value         A pointer to the 32-bit value for the compare exchange
+                        operation.
+  @param  CompareValue  A 32-bit value used in a compare operation.
+  @param  ExchangeValue A 32-bit value used in an exchange operation.
+
+  @return The original *Value before exchange.
+
+**/
+UINT32
+EFIAPI
+InterlockedCompareExchange32 (
+  IN OUT  volatile UINT32           *Value,
+  IN      UINT32                    CompareValue,
+  IN      UINT32                    ExchangeValue
+  )
+{
+  ASSERT (Value != NULL);
+  ASSERT (((UINTN)Value & (sizeof (*Value) - 1)) == 0);
+  return InternalSyncCompareExchange32 (Value, CompareValue, ExchangeValue);
+}
+
+/**
+  Performs an atomic compare exchange operation on a 64-bit unsigned integer.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value         A pointer to the 64-bit value for the compare exchange
+                        operation.
+  @param  CompareValue  A 64-bit value used in a compare operation.
+  @param  ExchangeValue A 64-bit value used in an exchange operation.
+
+  @return The original *Value before exchange.
+
+**/
+UINT64
+EFIAPI
+InterlockedCompareExchange64 (
+  IN OUT  volatile UINT64           *Value,
+  IN      UINT64                    CompareValue,
+  IN      UINT64                    ExchangeValue
+  )
+{
+  ASSERT (Value != NULL);
+  ASSERT (((UINTN)Value & (sizeof (*Value) - 1)) == 0);
+  return InternalSyncCompareExchange64 (Value, CompareValue, ExchangeValue);
+}
+
+/**
+  Performs an atomic compare exchange operation on a pointer value.
+
+  If Value is NULL, then ASSERT().
+
+  @param  Value         A pointer to the pointer value for the compare exchange
+                        operation.
+  @param  CompareValue  Pointer value used in a compare operation.
+  @param  ExchangeValue Pointer value used in an exchange operation.
+
+  @return The original *Value before exchange.
+
+**/
+VOID *
+EFIAPI
+InterlockedCompareExchangePointer (
+  IN OUT  VOID                      * volatile *Value,
+  IN      VOID                      *CompareValue,
+  IN      VOID                      *ExchangeValue
+  )
+{
+  return (VOID *)(UINTN)InterlockedCompareExchange64 (
+                          (volatile UINT64 *)Value,
+                          (UINT64)(UINTN)CompareValue,
+                          (UINT64)(UINTN)ExchangeValue
+                          );
+}
@@ -13,35 +13,62 @@
 #include <Library/PcdLib.h>
 #include <Library/RiscVCpuLib.h>
 
+/**
+  Read the 64-bit timer.
+
+  The time CSR is read directly if the harts implement it, otherwise the
+  platform timer is read.
+
+  @return The current timer value in ticks.
+
+**/
+STATIC
+UINT64
+InternalRiscVReadTimer (
+  VOID
+  )
+{
+  if (FeaturePcdGet (PcdRiscVSstcSupported) || FeaturePcdGet (PcdRiscVZicntrSupported)) {
+    return RiscVReadTime ();
+  }
+  return RiscVReadMachineTimer ();
+}
+
 /**
   Stalls the CPU for at least the given number of ticks.
 
   Stalls the CPU for at least the given number of ticks. It's invoked by
   MicroSecondDelay() and NanoSecondDelay().
 
+  With Sstc the hart sleeps in WFI until the supervisor timer compare
+  fires, otherwise it polls the timer.
+
   @param  Delay     A period of time to delay in ticks.
 
 **/
 VOID
 InternalRiscVTimerDelay (
-  IN UINT32 Delay
+  IN UINT64 Delay
   )
 {
-  UINT32                            Ticks;
-  UINT32                            Times;
-
-  Times = Delay >> (RISCV_TIMER_COMPARE_BITS - 2);
-  Delay &= (( 1 << (RISCV_TIMER_COMPARE_BITS - 2)) - 1);
-  do {
-    //
-    // The target timer count is calculated here
-    //
-    Ticks = RiscVReadMachineTimer () + Delay;
-    Delay = 1 << (RISCV_TIMER_COMPARE_BITS - 2);
-    while (((Ticks - RiscVReadMachineTimer ()) & ( 1 << (RISCV_TIMER_COMPARE_BITS - 1))) == 0) {
-      CpuPause ();
-    }
-  } while (Times-- > 0);
+  UINT64                            Deadline;
+
+  if (Delay == 0) {
+    return;
+  }
+
+  //
+  // The timer is 64-bit, it doesn't wrap in any practical delay.
+  //
+  Deadline = InternalRiscVReadTimer () + Delay;
+  if (FeaturePcdGet (PcdRiscVSstcSupported)) {
+    RiscVWaitForSupervisorTime (Deadline);
+    return;
+  }
+
+  while (InternalRiscVReadTimer () < Deadline) {
+    CpuPause ();
+  }
 }
 
 /**
@@ -61,13 +88,13 @@ MicroSecondDelay (
   )
 {
   InternalRiscVTimerDelay (
-    (UINT32)DivU64x32 (
-              MultU64x32 (
-                MicroSeconds,
-                PcdGet64 (PcdRiscVMachineTimerFrequencyInHerz)
-                ),
-              1000000u
-              )
+    DivU64x32 (
+      MultU64x64 (
+        MicroSeconds,
+        PcdGet64 (PcdRiscVMachineTimerFrequencyInHerz)
+        ) + 1000000u - 1,
+      1000000u
+      )
     );
   return MicroSeconds;
 }
@@ -89,13 +116,13 @@ NanoSecondDelay (
   )
 {
   InternalRiscVTimerDelay (
-    (UINT32)DivU64x32 (
-              MultU64x32 (
-                NanoSeconds,
-                PcdGet64 (PcdRiscVMachineTimerFrequencyInHerz)
-                ),
-              1000000000u
-              )
+    DivU64x32 (
+      MultU64x64 (
+        NanoSeconds,
+        PcdGet64 (PcdRiscVMachineTimerFrequencyInHerz)
+        ) + 1000000000u - 1,
+      1000000000u
+      )
     );
   return NanoSeconds;
 }
@@ -118,10 +145,10 @@ GetPerformanceCounter (
   VOID
   )
 {
-  return (UINT64)RiscVReadMachineTimer ();
+  return InternalRiscVReadTimer ();
 }
 
-/**return
+/**
   Retrieves the 64-bit frequency in Hz and the range of performance counter
   values.
 
@@ -156,7 +183,7 @@ GetPerformanceCounterProperties (
   }
 
   if (EndValue != NULL) {
-    *EndValue = 32 - 1;
+    *EndValue = MAX_UINT64;
   }
 
   return PcdGet64 (PcdRiscVMachineTimerFrequencyInHerz);
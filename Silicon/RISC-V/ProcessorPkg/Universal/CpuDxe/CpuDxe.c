@@ -14,6 +14,7 @@
 //
 STATIC BOOLEAN mInterruptState = FALSE;
 STATIC EFI_HANDLE mCpuHandle = NULL;
+STATIC RISCV_HART_LOCAL_DATA mBootHartLocalData;
 
 EFI_CPU_ARCH_PROTOCOL  gCpu = {
   CpuFlushCpuDataCache,
@@ -28,6 +29,118 @@ EFI_CPU_ARCH_PROTOCOL  gCpu = {
   4                           // DmaBufferAlignment
 };
 
+//
+// Function IDs of the vendor SBI cache maintenance extension, see
+// PcdRiscVCacheMaintenanceSbiExtId.
+//
+#define CMO_SBI_CLEAN_RANGE         0
+#define CMO_SBI_FLUSH_RANGE         1
+#define CMO_SBI_INVALIDATE_RANGE    2
+#define CMO_SBI_FLUSH_ALL           3
+
+/**
+  Operate on all the cache blocks of the range with a Zicbom instruction.
+
+  @param  Start             Physical address to start from.
+  @param  Length            Number of bytes of the range.
+  @param  FlushType         Specifies the type of flush operation to perform.
+
+  @retval EFI_SUCCESS       The range was flushed.
+  @retval EFI_UNSUPPORTED   The flush type is not supported.
+
+**/
+STATIC
+EFI_STATUS
+ZicbomFlushRange (
+  IN EFI_PHYSICAL_ADDRESS      Start,
+  IN UINT64                    Length,
+  IN EFI_CPU_FLUSH_TYPE        FlushType
+  )
+{
+  UINTN   BlockSize;
+  UINTN   Address;
+  UINTN   End;
+  VOID    (*CacheOp) (UINTN);
+
+  switch (FlushType) {
+  case EfiCpuFlushTypeWriteBack:
+    CacheOp = RiscVCpuCacheClean;
+    break;
+  case EfiCpuFlushTypeWriteBackInvalidate:
+    CacheOp = RiscVCpuCacheFlush;
+    break;
+  case EfiCpuFlushTypeInvalidate:
+    CacheOp = RiscVCpuCacheInvalidate;
+    break;
+  default:
+    return EFI_UNSUPPORTED;
+  }
+
+  BlockSize = PcdGet32 (PcdRiscVCacheBlockSize);
+  Address   = (UINTN)Start & ~(BlockSize - 1);
+  End       = (UINTN)(Start + Length);
+
+  //
+  // Order prior accesses before the first block operation and the block
+  // operations before the following accesses, but not between the blocks.
+  //
+  MemoryFence ();
+  for ( ; Address < End; Address += BlockSize) {
+    CacheOp (Address);
+  }
+  MemoryFence ();
+  return EFI_SUCCESS;
+}
+
+/**
+  Flush the range with the vendor SBI cache maintenance extension.
+
+  @param  Start             Physical address to start from.
+  @param  Length            Number of bytes of the range.
+  @param  FlushType         Specifies the type of flush operation to perform.
+
+  @retval EFI_SUCCESS       The range was flushed.
+  @retval EFI_UNSUPPORTED   There is no vendor extension or the flush type
+                            is not supported.
+  @retval Others            The SBI call failed.
+
+**/
+STATIC
+EFI_STATUS
+SbiFlushRange (
+  IN EFI_PHYSICAL_ADDRESS      Start,
+  IN UINT64                    Length,
+  IN EFI_CPU_FLUSH_TYPE        FlushType
+  )
+{
+  UINTN   ExtensionId;
+  UINT32  Threshold;
+
+  ExtensionId = PcdGet32 (PcdRiscVCacheMaintenanceSbiExtId);
+  if (ExtensionId == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  switch (FlushType) {
+  case EfiCpuFlushTypeWriteBack:
+    return SbiVendorCall (ExtensionId, CMO_SBI_CLEAN_RANGE, 2, (UINTN)Start, (UINTN)Length);
+  case EfiCpuFlushTypeInvalidate:
+    return SbiVendorCall (ExtensionId, CMO_SBI_INVALIDATE_RANGE, 2, (UINTN)Start, (UINTN)Length);
+  case EfiCpuFlushTypeWriteBackInvalidate:
+    //
+    // Whole cache operations stall all the harts sharing the cache, only use
+    // them for ranges too large to walk.
+    //
+    Threshold = PcdGet32 (PcdRiscVCacheFlushAllThreshold);
+    if ((Threshold != 0) && (Length > Threshold)) {
+      return SbiVendorCall (ExtensionId, CMO_SBI_FLUSH_ALL, 0);
+    }
+    return SbiVendorCall (ExtensionId, CMO_SBI_FLUSH_RANGE, 2, (UINTN)Start, (UINTN)Length);
+  default:
+    return EFI_UNSUPPORTED;
+  }
+}
+
 //
 // CPU Arch Protocol Functions
 //
@@ -56,7 +169,24 @@ CpuFlushCpuDataCache (
   IN EFI_CPU_FLUSH_TYPE        FlushType
   )
 {
-  return EFI_SUCCESS;
+  EFI_STATUS  Status;
+
+  if (Length == 0) {
+    return EFI_SUCCESS;
+  }
+
+  if (FeaturePcdGet (PcdRiscVZicbomSupported)) {
+    return ZicbomFlushRange (Start, Length, FlushType);
+  }
+
+  Status = SbiFlushRange (Start, Length, FlushType);
+  if (Status == EFI_UNSUPPORTED) {
+    //
+    // No cache maintenance available, DMA is assumed to be coherent.
+    //
+    return EFI_SUCCESS;
+  }
+  return (EFI_ERROR (Status)) ? EFI_DEVICE_ERROR : EFI_SUCCESS;
 }
 
 
@@ -268,8 +398,49 @@ CpuSetMemoryAttributes (
   IN UINT64                    Attributes
   )
 {
-  DEBUG ((DEBUG_INFO, "%a: Set memory attributes not supported yet\n", __FUNCTION__));
-  return EFI_UNSUPPORTED;
+  if (!IsMmuEnabled ()) {
+    DEBUG ((DEBUG_INFO, "%a: Set memory attributes not supported in bare mode\n", __FUNCTION__));
+    return EFI_UNSUPPORTED;
+  }
+
+  if (Length == 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return MmuSetMemoryAttributes (BaseAddress, Length, Attributes);
+}
+
+/**
+  Set up the hart-local data of the boot hart.
+
+  The boot hart is identified by its OpenSBI scratch space, which works in
+  S-mode without access to mhartid. This is the last time DXE needs SBI
+  calls to find the calling hart.
+
+  @retval EFI_SUCCESS     The hart-local data was set up.
+  @retval EFI_NOT_FOUND   No scratch space of the SBI belongs to this hart.
+
+**/
+STATIC
+EFI_STATUS
+InitializeBootHartLocalData (
+  VOID
+  )
+{
+  SBI_SCRATCH   *ThisScratch;
+  SBI_SCRATCH   *Scratch;
+  UINTN         HartId;
+
+  SbiGetMscratch (&ThisScratch);
+  for (HartId = 0; HartId < RISC_V_MAX_HART_SUPPORTED; HartId++) {
+    SbiGetMscratchHartid (HartId, &Scratch);
+    if (Scratch == ThisScratch) {
+      RiscVSetHartLocalData (&mBootHartLocalData, HartId, Scratch);
+      DEBUG ((DEBUG_INFO, "%a: Boot hart %d\n", __FUNCTION__, HartId));
+      return EFI_SUCCESS;
+    }
+  }
+  return EFI_NOT_FOUND;
 }
 
 /**
@@ -302,6 +473,22 @@ InitializeCpu (
   //
   DisableInterrupts ();
 
+  Status = InitializeBootHartLocalData ();
+  ASSERT_EFI_ERROR (Status);
+
+  //
+  // DMA buffers must not share a cache block with other data.
+  //
+  if (FeaturePcdGet (PcdRiscVZicbomSupported)) {
+    gCpu.DmaBufferAlignment = PcdGet32 (PcdRiscVCacheBlockSize);
+  }
+
+  //
+  // Enable S-mode paging if configured, otherwise stay in bare mode.
+  //
+  Status = InitializeMmu ();
+  ASSERT_EFI_ERROR (Status);
+
   //
   // Install CPU Architectural Protocol
   //
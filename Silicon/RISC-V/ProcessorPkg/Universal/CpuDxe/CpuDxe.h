@@ -12,11 +12,18 @@
 
 #include <PiDxe.h>
 
+#include <IndustryStandard/RiscV.h>
 #include <Protocol/Cpu.h>
 #include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
 #include <Library/CpuExceptionHandlerLib.h>
 #include <Library/DebugLib.h>
+#include <Library/DxeServicesTableLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
 #include <Library/RiscVCpuLib.h>
+#include <Library/RiscVEdk2SbiLib.h>
+#include <Library/RiscVHartLocalDataLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <Library/UefiDriverEntryPoint.h>
 
@@ -195,5 +202,51 @@ CpuSetMemoryAttributes (
   IN UINT64                     Attributes
   );
 
+/**
+  Check whether S-mode paging is enabled.
+
+  @retval TRUE   Paging is enabled.
+  @retval FALSE  DXE runs in bare mode.
+
+**/
+BOOLEAN
+IsMmuEnabled (
+  VOID
+  );
+
+/**
+  Set the memory attributes of a region in the page tables.
+
+  @param[in]  BaseAddress   The first address of the region.
+  @param[in]  Length        The length of the region.
+  @param[in]  Attributes    The EFI memory attributes.
+
+  @retval EFI_SUCCESS            The attributes were set.
+  @retval EFI_UNSUPPORTED        Paging is disabled or the region is not
+                                 addressable in the translation mode.
+  @retval EFI_INVALID_PARAMETER  The region is not page aligned.
+  @retval EFI_OUT_OF_RESOURCES   No memory for page tables.
+
+**/
+EFI_STATUS
+MmuSetMemoryAttributes (
+  IN  EFI_PHYSICAL_ADDRESS  BaseAddress,
+  IN  UINT64                Length,
+  IN  UINT64                Attributes
+  );
+
+/**
+  Build the identity mapping and enable the widest translation mode allowed
+  by PcdRiscVMmuMaxSatpMode which the hart supports.
+
+  @retval EFI_SUCCESS           Paging is enabled, or DXE stays in bare mode.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the root table.
+
+**/
+EFI_STATUS
+InitializeMmu (
+  VOID
+  );
+
 #endif
 
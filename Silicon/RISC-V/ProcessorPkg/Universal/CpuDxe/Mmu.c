@@ -0,0 +1,537 @@
+/** @file
+  RISC-V S-mode page table management for CpuDxe.
+
+  DXE memory is identity mapped. Regions are mapped with the largest page
+  size their alignment allows (1 GiB, 2 MiB or 4 KiB in Sv39, plus 512 GiB
+  in Sv48). A large page is only split into a next level table when a
+  memory attribute change covers a part of it.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "CpuDxe.h"
+
+//
+// Ranges spanning more pages than this are flushed with a full TLB flush.
+//
+#define TLB_FLUSH_RANGE_LIMIT_PAGES   64
+
+#define PTE_LEAF_PERMISSIONS   (RISCV_PTE_R | RISCV_PTE_W | RISCV_PTE_X)
+#define PTE_LEAF_DEFAULT       (RISCV_PTE_V | PTE_LEAF_PERMISSIONS | RISCV_PTE_G | RISCV_PTE_A | RISCV_PTE_D)
+
+STATIC UINT64   *mRootTable = NULL;
+STATIC UINTN    mSatpMode = RISCV_SATP_MODE_OFF;
+STATIC UINTN    mPageTableLevels = 0;
+
+/**
+  Check whether the page table entry points to a next level table.
+
+  @param[in]  Entry   The page table entry.
+
+  @retval TRUE   The entry is a valid non-leaf entry.
+  @retval FALSE  The entry is invalid or a leaf.
+
+**/
+STATIC
+BOOLEAN
+IsTableEntry (
+  IN  UINT64  Entry
+  )
+{
+  return (((Entry & RISCV_PTE_V) != 0) && ((Entry & PTE_LEAF_PERMISSIONS) == 0));
+}
+
+/**
+  Get the physical address an entry points to.
+
+  @param[in]  Entry   The page table entry.
+
+  @return The physical address.
+
+**/
+STATIC
+UINT64
+PteToAddress (
+  IN  UINT64  Entry
+  )
+{
+  return ((Entry & RISCV_PTE_PPN_MASK) >> RISCV_PTE_PPN_SHIFT) << RISCV_PAGE_SHIFT;
+}
+
+/**
+  Compose a page table entry pointing to the given physical address.
+
+  @param[in]  Address   The physical address, page aligned.
+  @param[in]  Flags     The flags of the entry.
+
+  @return The page table entry.
+
+**/
+STATIC
+UINT64
+AddressToPte (
+  IN  UINT64  Address,
+  IN  UINT64  Flags
+  )
+{
+  return ((Address >> RISCV_PAGE_SHIFT) << RISCV_PTE_PPN_SHIFT) | Flags;
+}
+
+/**
+  Translate GCD memory attributes to leaf page table entry flags.
+
+  @param[in]  Attributes   The EFI memory attributes.
+
+  @return The leaf flags, without PPN.
+
+**/
+STATIC
+UINT64
+GcdAttributesToPteFlags (
+  IN  UINT64  Attributes
+  )
+{
+  UINT64  Flags;
+
+  if ((Attributes & EFI_MEMORY_RP) != 0) {
+    //
+    // No access at all, leave the entry invalid.
+    //
+    return 0;
+  }
+
+  Flags = PTE_LEAF_DEFAULT;
+  if ((Attributes & EFI_MEMORY_RO) != 0) {
+    Flags &= ~(UINT64)RISCV_PTE_W;
+  }
+  if ((Attributes & EFI_MEMORY_XP) != 0) {
+    Flags &= ~(UINT64)RISCV_PTE_X;
+  }
+
+  if (FeaturePcdGet (PcdRiscVSvpbmtSupported)) {
+    if ((Attributes & (EFI_MEMORY_WB | EFI_MEMORY_WT)) != 0) {
+      Flags |= RISCV_PTE_PBMT_PMA;
+    } else if ((Attributes & EFI_MEMORY_WC) != 0) {
+      Flags |= RISCV_PTE_PBMT_NC;
+    } else if ((Attributes & (EFI_MEMORY_UC | EFI_MEMORY_UCE)) != 0) {
+      Flags |= RISCV_PTE_PBMT_IO;
+    }
+  }
+
+  return Flags;
+}
+
+/**
+  Get the shift of the region covered by one entry at the given level.
+
+  @param[in]  Level   The table level, 0 is the root table.
+
+  @return The shift of the region size.
+
+**/
+STATIC
+UINTN
+LevelToBlockShift (
+  IN  UINTN  Level
+  )
+{
+  return RISCV_PAGE_SHIFT + RISCV_PAGE_TABLE_INDEX_BITS * (mPageTableLevels - 1 - Level);
+}
+
+/**
+  Allocate a next level table for an entry.
+
+  If the entry is a valid leaf, the new table maps the same region with the
+  same flags using pages of the next level, thus the mapping is unchanged.
+
+  @param[in,out]  Entry        The entry to split.
+  @param[in]      BlockShift   The shift of the region covered by Entry.
+
+  @retval EFI_SUCCESS           The entry points to a next level table.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the table.
+
+**/
+STATIC
+EFI_STATUS
+SplitEntry (
+  IN OUT  UINT64  *Entry,
+  IN      UINTN   BlockShift
+  )
+{
+  UINT64  *Table;
+  UINT64  Base;
+  UINT64  Flags;
+  UINTN   Index;
+
+  Table = AllocatePages (1);
+  if (Table == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if ((*Entry & RISCV_PTE_V) != 0) {
+    Base  = PteToAddress (*Entry);
+    Flags = *Entry & ~RISCV_PTE_PPN_MASK;
+    for (Index = 0; Index < RISCV_PAGE_TABLE_ENTRIES; Index++) {
+      Table[Index] = AddressToPte (
+                       Base + LShiftU64 (Index, BlockShift - RISCV_PAGE_TABLE_INDEX_BITS),
+                       Flags
+                       );
+    }
+  } else {
+    ZeroMem (Table, EFI_PAGE_SIZE);
+  }
+
+  //
+  // Make the new table visible to the page table walker before linking it.
+  //
+  MemoryFence ();
+  *Entry = AddressToPte ((UINT64)(UINTN)Table, RISCV_PTE_V);
+  return EFI_SUCCESS;
+}
+
+/**
+  Map the region with the given leaf flags.
+
+  @param[in]  RegionStart   The first address of the region.
+  @param[in]  RegionEnd     The address after the region.
+  @param[in]  Flags         The leaf flags, 0 to unmap.
+  @param[in]  Table         The table of this level.
+  @param[in]  Level         The table level, 0 is the root table.
+
+  @retval EFI_SUCCESS           The region was updated.
+  @retval EFI_OUT_OF_RESOURCES  No memory for a next level table.
+
+**/
+STATIC
+EFI_STATUS
+UpdateRegionMappingRecursive (
+  IN  UINT64  RegionStart,
+  IN  UINT64  RegionEnd,
+  IN  UINT64  Flags,
+  IN  UINT64  *Table,
+  IN  UINTN   Level
+  )
+{
+  EFI_STATUS  Status;
+  UINTN       BlockShift;
+  UINT64      BlockMask;
+  UINT64      BlockEnd;
+  UINT64      *Entry;
+
+  BlockShift = LevelToBlockShift (Level);
+  BlockMask  = LShiftU64 (1, BlockShift) - 1;
+
+  for ( ; RegionStart < RegionEnd; RegionStart = BlockEnd) {
+    BlockEnd = MIN (RegionEnd, (RegionStart | BlockMask) + 1);
+    Entry    = &Table[RShiftU64 (RegionStart, BlockShift) & (RISCV_PAGE_TABLE_ENTRIES - 1)];
+
+    //
+    // Use a leaf if the region covers the whole block and the block is not
+    // split already. The last level has only leaves.
+    //
+    if ((Level == mPageTableLevels - 1) ||
+        ((((RegionStart | BlockEnd) & BlockMask) == 0) && !IsTableEntry (*Entry))) {
+      *Entry = (Flags == 0) ? 0 : AddressToPte (RegionStart & ~BlockMask, Flags);
+      continue;
+    }
+
+    if (!IsTableEntry (*Entry)) {
+      Status = SplitEntry (Entry, BlockShift);
+      if (EFI_ERROR (Status)) {
+        return Status;
+      }
+    }
+
+    Status = UpdateRegionMappingRecursive (
+               RegionStart,
+               BlockEnd,
+               Flags,
+               (UINT64 *)(UINTN)PteToAddress (*Entry),
+               Level + 1
+               );
+    if (EFI_ERROR (Status)) {
+      return Status;
+    }
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  Flush the TLB of all harts for the given region.
+
+  The local hart is flushed with SFENCE.VMA. The other harts are flushed
+  with a single SBI remote fence request for the whole region, or with a
+  full flush if the region is large.
+
+  @param[in]  BaseAddress   The first address of the region.
+  @param[in]  Length        The length of the region.
+
+**/
+STATIC
+VOID
+FlushTlbRange (
+  IN  UINT64  BaseAddress,
+  IN  UINT64  Length
+  )
+{
+  UINTN   HartMask;
+  UINT64  Address;
+
+  if (EFI_SIZE_TO_PAGES (Length) > TLB_FLUSH_RANGE_LIMIT_PAGES) {
+    asm volatile ("sfence.vma" ::: "memory");
+    BaseAddress = 0;
+    Length      = 0;
+  } else {
+    for (Address = BaseAddress; Address < BaseAddress + Length; Address += EFI_PAGE_SIZE) {
+      asm volatile ("sfence.vma %0" :: "r" (Address) : "memory");
+    }
+  }
+
+  //
+  // Hart mask base -1 selects all harts, the mask is ignored.
+  //
+  HartMask = 0;
+  SbiRemoteSfenceVma (&HartMask, (UINTN)-1, (UINTN)BaseAddress, (UINTN)Length);
+}
+
+/**
+  Check whether S-mode paging is enabled.
+
+  @retval TRUE   Paging is enabled.
+  @retval FALSE  DXE runs in bare mode.
+
+**/
+BOOLEAN
+IsMmuEnabled (
+  VOID
+  )
+{
+  return (mSatpMode != RISCV_SATP_MODE_OFF);
+}
+
+/**
+  Set the memory attributes of a region in the page tables.
+
+  @param[in]  BaseAddress   The first address of the region.
+  @param[in]  Length        The length of the region.
+  @param[in]  Attributes    The EFI memory attributes.
+
+  @retval EFI_SUCCESS            The attributes were set.
+  @retval EFI_UNSUPPORTED        Paging is disabled or the region is not
+                                 addressable in the translation mode.
+  @retval EFI_INVALID_PARAMETER  The region is not page aligned.
+  @retval EFI_OUT_OF_RESOURCES   No memory for page tables.
+
+**/
+EFI_STATUS
+MmuSetMemoryAttributes (
+  IN  EFI_PHYSICAL_ADDRESS  BaseAddress,
+  IN  UINT64                Length,
+  IN  UINT64                Attributes
+  )
+{
+  EFI_STATUS  Status;
+  UINT64      Limit;
+
+  if (!IsMmuEnabled ()) {
+    return EFI_UNSUPPORTED;
+  }
+
+  if (((BaseAddress | Length) & EFI_PAGE_MASK) != 0) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  //
+  // Identity mapped addresses must stay below the sign extension boundary.
+  //
+  Limit = LShiftU64 (1, LevelToBlockShift (0) + RISCV_PAGE_TABLE_INDEX_BITS - 1);
+  if ((BaseAddress >= Limit) || (Length > Limit - BaseAddress)) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = UpdateRegionMappingRecursive (
+             BaseAddress,
+             BaseAddress + Length,
+             GcdAttributesToPteFlags (Attributes),
+             mRootTable,
+             0
+             );
+  FlushTlbRange (BaseAddress, Length);
+  return Status;
+}
+
+/**
+  Identity map all the regions present in the GCD memory space map.
+
+  @retval EFI_SUCCESS   The regions were mapped.
+  @retval Others        A region could not be mapped.
+
+**/
+STATIC
+EFI_STATUS
+MapGcdMemorySpace (
+  VOID
+  )
+{
+  EFI_STATUS                       Status;
+  EFI_GCD_MEMORY_SPACE_DESCRIPTOR  *MemorySpaceMap;
+  UINTN                            NumberOfDescriptors;
+  UINTN                            Index;
+  UINT64                           Attributes;
+  UINT64                           Limit;
+  UINT64                           End;
+
+  Status = gDS->GetMemorySpaceMap (&NumberOfDescriptors, &MemorySpaceMap);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Limit = LShiftU64 (1, LevelToBlockShift (0) + RISCV_PAGE_TABLE_INDEX_BITS - 1);
+  for (Index = 0; Index < NumberOfDescriptors; Index++) {
+    if ((MemorySpaceMap[Index].GcdMemoryType == EfiGcdMemoryTypeNonExistent) ||
+        (MemorySpaceMap[Index].BaseAddress >= Limit)) {
+      continue;
+    }
+
+    Attributes = MemorySpaceMap[Index].Attributes & EFI_MEMORY_CACHETYPE_MASK;
+    if ((Attributes == 0) && (MemorySpaceMap[Index].GcdMemoryType == EfiGcdMemoryTypeMemoryMappedIo)) {
+      Attributes = EFI_MEMORY_UC;
+    }
+
+    End = MIN (Limit, MemorySpaceMap[Index].BaseAddress + MemorySpaceMap[Index].Length);
+    Status = UpdateRegionMappingRecursive (
+               MemorySpaceMap[Index].BaseAddress & ~(UINT64)EFI_PAGE_MASK,
+               ALIGN_VALUE (End, EFI_PAGE_SIZE),
+               GcdAttributesToPteFlags (Attributes),
+               mRootTable,
+               0
+               );
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+  FreePool (MemorySpaceMap);
+  return Status;
+}
+
+/**
+  Try to switch to the given translation mode.
+
+  Writing an unsupported mode to satp has no effect, so the mode is read
+  back to check whether the hart supports it.
+
+  @param[in]  Mode    The satp mode.
+  @param[in]  Levels  The number of page table levels of Mode.
+
+  @retval TRUE   The mode is enabled.
+  @retval FALSE  The mode is not supported.
+
+**/
+STATIC
+BOOLEAN
+TryEnableSatpMode (
+  IN  UINTN  Mode,
+  IN  UINTN  Levels
+  )
+{
+  UINT64  Satp;
+
+  mPageTableLevels = Levels;
+  ZeroMem (mRootTable, EFI_PAGE_SIZE);
+  if (EFI_ERROR (MapGcdMemorySpace ())) {
+    return FALSE;
+  }
+
+  Satp = LShiftU64 (Mode, RISCV_SATP_MODE_BIT_POSITION) |
+         RShiftU64 ((UINT64)(UINTN)mRootTable, RISCV_PAGE_SHIFT);
+  asm volatile ("sfence.vma" ::: "memory");
+  RiscVSetSupervisorAddressTranslationRegister (Satp);
+  if (RiscVGetSupervisorAddressTranslationRegister () != Satp) {
+    return FALSE;
+  }
+  asm volatile ("sfence.vma" ::: "memory");
+  mSatpMode = Mode;
+  return TRUE;
+}
+
+/**
+  Return to bare mode at ExitBootServices, the OS expects the MMU off.
+
+  @param[in]  Event     The ExitBootServices event.
+  @param[in]  Context   Not used.
+
+**/
+STATIC
+VOID
+EFIAPI
+MmuExitBootServices (
+  IN  EFI_EVENT  Event,
+  IN  VOID       *Context
+  )
+{
+  RiscVSetSupervisorAddressTranslationRegister (
+    (UINT64)RISCV_SATP_MODE_OFF << RISCV_SATP_MODE_BIT_POSITION
+    );
+  asm volatile ("sfence.vma" ::: "memory");
+  mSatpMode = RISCV_SATP_MODE_OFF;
+}
+
+/**
+  Build the identity mapping and enable the widest translation mode allowed
+  by PcdRiscVMmuMaxSatpMode which the hart supports.
+
+  DXE keeps running in bare mode if paging is disabled by the PCD or not
+  supported by the hart.
+
+  @retval EFI_SUCCESS           Paging is enabled, or DXE stays in bare mode.
+  @retval EFI_OUT_OF_RESOURCES  No memory for the root table.
+
+**/
+EFI_STATUS
+InitializeMmu (
+  VOID
+  )
+{
+  EFI_STATUS  Status;
+  EFI_EVENT   ExitBootServicesEvent;
+  UINT32      MaxMode;
+
+  MaxMode = PcdGet32 (PcdRiscVMmuMaxSatpMode);
+  if (MaxMode == RISCV_SATP_MODE_OFF) {
+    DEBUG ((DEBUG_INFO, "%a: S-mode paging is disabled\n", __FUNCTION__));
+    return EFI_SUCCESS;
+  }
+
+  mRootTable = AllocatePages (1);
+  if (mRootTable == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  if (((MaxMode < RISCV_SATP_MODE_SV48) || !TryEnableSatpMode (RISCV_SATP_MODE_SV48, 4)) &&
+      !TryEnableSatpMode (RISCV_SATP_MODE_SV39, 3)) {
+    DEBUG ((DEBUG_WARN, "%a: Sv39/Sv48 not supported, stay in bare mode\n", __FUNCTION__));
+    FreePages (mRootTable, 1);
+    mRootTable = NULL;
+    return EFI_SUCCESS;
+  }
+
+  DEBUG ((DEBUG_INFO, "%a: Enabled %a paging\n",
+    __FUNCTION__,
+    (mSatpMode == RISCV_SATP_MODE_SV48) ? "Sv48" : "Sv39"
+    ));
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_NOTIFY,
+                  MmuExitBootServices,
+                  NULL,
+                  &ExitBootServicesEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
+  return Status;
+}
@@ -0,0 +1,1067 @@
+/** @file
+  RISC-V MP Services DXE driver.
+
+  Application processors (APs) are started through the SBI HSM extension the
+  first time a procedure is dispatched to them. After running the procedure
+  an AP stays parked in WFI and is woken up by an SBI IPI for the next
+  procedure. All APs are returned to SBI at ExitBootServices, so the OS can
+  start them again through SBI HSM.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "MpServicesDxe.h"
+
+STATIC MP_SYSTEM_DATA   mMpSystemData;
+STATIC EFI_HANDLE       mMpServiceHandle = NULL;
+STATIC EFI_EVENT        mExitBootServicesEvent = NULL;
+
+EFI_MP_SERVICES_PROTOCOL  mMpServicesProtocol = {
+  GetNumberOfProcessors,
+  GetProcessorInfo,
+  StartupAllAPs,
+  StartupThisAP,
+  SwitchBSP,
+  EnableDisableAP,
+  WhoAmI
+};
+
+/**
+  The AP loop. Parks the hart in WFI and runs the procedures posted by the
+  BSP until the BSP requests the hart to stop.
+
+  Supervisor software interrupts are enabled in SIE only, interrupts stay
+  globally disabled in SSTATUS, therefore an IPI only wakes the hart from
+  WFI and never traps.
+
+  @param[in]  HartId      Hart ID of this processor.
+  @param[in]  CpuData     CPU_AP_DATA of this processor.
+
+**/
+VOID
+EFIAPI
+ApProcedureLoop (
+  IN  UINTN        HartId,
+  IN  CPU_AP_DATA  *CpuData
+  )
+{
+  RiscVSetHartLocalData (&CpuData->HartLocalData, HartId, CpuData->Scratch);
+  CpuData->HartLocalData.ProcessorNumber = (UINTN)(CpuData - mMpSystemData.CpuData);
+
+  csr_set (CSR_SIE, MIP_SSIP);
+
+  for (;;) {
+    while ((CpuData->State == CpuStateIdle) || (CpuData->State == CpuStateFinished)) {
+      wfi ();
+    }
+    csr_clear (CSR_SIP, MIP_SSIP);
+
+    if (CpuData->State == CpuStateStopRequested) {
+      csr_clear (CSR_SIE, MIP_SSIP);
+      CpuData->State = CpuStateStopped;
+      MemoryFence ();
+      SbiHartStop ();
+      //
+      // Should never reach here.
+      //
+      CpuDeadLoop ();
+    }
+
+    if (CpuData->State == CpuStateReady) {
+      CpuData->State = CpuStateBusy;
+      MemoryFence ();
+      CpuData->Procedure (CpuData->ProcedureArgument);
+      MemoryFence ();
+      CpuData->State = CpuStateFinished;
+    }
+  }
+}
+
+/**
+  Get the index of the calling processor in mMpSystemData.CpuData.
+
+  The processor number is kept in the hart-local data of the calling hart.
+  Harts without hart-local data are identified by the OpenSBI scratch space
+  returned for them, which works in S-mode without access to mhartid.
+
+  @param[out] ProcessorNumber  The index of the calling processor.
+
+  @retval EFI_SUCCESS      The calling processor was found.
+  @retval EFI_NOT_FOUND    The calling processor is not known.
+
+**/
+STATIC
+EFI_STATUS
+GetProcessorIndex (
+  OUT UINTN  *ProcessorNumber
+  )
+{
+  RISCV_HART_LOCAL_DATA  *HartLocalData;
+  SBI_SCRATCH            *Scratch;
+  UINTN                  Index;
+
+  HartLocalData = RiscVGetHartLocalData ();
+  if (HartLocalData != NULL) {
+    *ProcessorNumber = HartLocalData->ProcessorNumber;
+    return EFI_SUCCESS;
+  }
+
+  SbiGetMscratch (&Scratch);
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    if (mMpSystemData.CpuData[Index].Scratch == Scratch) {
+      *ProcessorNumber = Index;
+      return EFI_SUCCESS;
+    }
+  }
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Check whether the calling processor is the BSP.
+
+  @retval TRUE   The calling processor is the BSP.
+  @retval FALSE  The calling processor is an AP.
+
+**/
+STATIC
+BOOLEAN
+IsBsp (
+  VOID
+  )
+{
+  UINTN       Index;
+  EFI_STATUS  Status;
+
+  Status = GetProcessorIndex (&Index);
+  return (!EFI_ERROR (Status) && (Index == mMpSystemData.BspIndex));
+}
+
+/**
+  Check whether the given AP is enabled.
+
+  @param[in]  CpuData     CPU_AP_DATA of the AP.
+
+  @retval TRUE   The AP is enabled.
+  @retval FALSE  The AP is disabled.
+
+**/
+STATIC
+BOOLEAN
+IsApEnabled (
+  IN  CPU_AP_DATA  *CpuData
+  )
+{
+  return ((CpuData->StatusFlag & PROCESSOR_ENABLED_BIT) != 0);
+}
+
+/**
+  Check whether the given AP can accept a new procedure.
+
+  An AP which finished a procedure nobody waits for anymore, e.g. after a
+  timeout, is idle as well.
+
+  @param[in]  CpuData     CPU_AP_DATA of the AP.
+
+  @retval TRUE   The AP is idle.
+  @retval FALSE  The AP is busy.
+
+**/
+STATIC
+BOOLEAN
+IsApIdle (
+  IN  CPU_AP_DATA  *CpuData
+  )
+{
+  if ((CpuData->State == CpuStateFinished) &&
+      !CpuData->AllApsMember &&
+      (CpuData->WaitEvent == NULL)) {
+    CpuData->State = CpuStateIdle;
+  }
+  return ((CpuData->State == CpuStateIdle) || (CpuData->State == CpuStateStopped));
+}
+
+/**
+  Post a procedure to an AP and wake it up.
+
+  A stopped AP is started through SBI HSM, a parked AP is woken up by an IPI.
+
+  @param[in]  CpuData            CPU_AP_DATA of the AP.
+  @param[in]  Procedure          The procedure to run.
+  @param[in]  ProcedureArgument  The argument passed to Procedure.
+
+  @retval EFI_SUCCESS   The AP was woken up.
+  @retval Others        The AP could not be started.
+
+**/
+STATIC
+EFI_STATUS
+WakeUpAp (
+  IN  CPU_AP_DATA       *CpuData,
+  IN  EFI_AP_PROCEDURE  Procedure,
+  IN  VOID              *ProcedureArgument
+  )
+{
+  EFI_STATUS  Status;
+  CPU_STATE   PreviousState;
+  UINTN       HartStatus;
+  UINTN       HartMask;
+
+  PreviousState               = CpuData->State;
+  CpuData->Procedure          = Procedure;
+  CpuData->ProcedureArgument  = ProcedureArgument;
+  MemoryFence ();
+  CpuData->State              = CpuStateReady;
+  MemoryFence ();
+
+  if (PreviousState == CpuStateStopped) {
+    //
+    // The AP marks itself stopped right before it calls SbiHartStop, wait
+    // for SBI to complete the transition before starting it again.
+    //
+    do {
+      Status = SbiHartGetStatus (CpuData->HartId, &HartStatus);
+    } while (!EFI_ERROR (Status) && (HartStatus != SBI_HSM_HART_STATUS_STOPPED));
+
+    Status = SbiHartStart (CpuData->HartId, (UINTN)ApEntryPoint, (UINTN)CpuData);
+  } else {
+    HartMask = 1;
+    Status = SbiSendIpi (&HartMask, CpuData->HartId);
+  }
+
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Failed to wake up hart %d - %r\n", __FUNCTION__, CpuData->HartId, Status));
+    CpuData->State = PreviousState;
+  }
+  return Status;
+}
+
+/**
+  Find the next enabled AP starting from the given index.
+
+  @param[in]  Index    The index to start from.
+
+  @return The index of the next enabled AP, or NumberOfProcessors if none.
+
+**/
+STATIC
+UINTN
+NextEnabledAp (
+  IN  UINTN  Index
+  )
+{
+  for ( ; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    if ((Index != mMpSystemData.BspIndex) &&
+        mMpSystemData.CpuData[Index].AllApsMember &&
+        (mMpSystemData.CpuData[Index].State != CpuStateFinished)) {
+      break;
+    }
+  }
+  return Index;
+}
+
+/**
+  Build the list of processors which did not finish the StartupAllAPs
+  request and drop them from the request.
+
+**/
+STATIC
+VOID
+CollectFailedCpuList (
+  VOID
+  )
+{
+  UINTN        Index;
+  UINTN        Count;
+  CPU_AP_DATA  *CpuData;
+
+  if (mMpSystemData.FailedCpuList != NULL) {
+    *mMpSystemData.FailedCpuList = AllocatePool (
+                                     (mMpSystemData.StartCount - mMpSystemData.FinishCount + 1) * sizeof (UINTN)
+                                     );
+  }
+
+  Count = 0;
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    CpuData = &mMpSystemData.CpuData[Index];
+    if (!CpuData->AllApsMember) {
+      continue;
+    }
+    CpuData->AllApsMember = FALSE;
+    if ((mMpSystemData.FailedCpuList != NULL) && (*mMpSystemData.FailedCpuList != NULL)) {
+      (*mMpSystemData.FailedCpuList)[Count++] = Index;
+    }
+  }
+
+  if ((mMpSystemData.FailedCpuList != NULL) && (*mMpSystemData.FailedCpuList != NULL)) {
+    (*mMpSystemData.FailedCpuList)[Count] = END_OF_CPU_LIST;
+  }
+}
+
+/**
+  Check the progress of the outstanding StartupAllAPs request.
+
+  @param[in]  ElapsedTime   Microseconds elapsed since the previous check.
+
+  @retval EFI_SUCCESS     All APs finished the procedure.
+  @retval EFI_TIMEOUT     The request timed out.
+  @retval EFI_NOT_READY   Some APs are still running the procedure.
+
+**/
+STATIC
+EFI_STATUS
+CheckAllAps (
+  IN  UINTN  ElapsedTime
+  )
+{
+  UINTN        Index;
+  CPU_AP_DATA  *CpuData;
+
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    CpuData = &mMpSystemData.CpuData[Index];
+    if (!CpuData->AllApsMember || (CpuData->State != CpuStateFinished)) {
+      continue;
+    }
+
+    CpuData->AllApsMember = FALSE;
+    CpuData->State        = CpuStateIdle;
+    mMpSystemData.FinishCount++;
+
+    if (mMpSystemData.SingleThread) {
+      mMpSystemData.NextApIndex = NextEnabledAp (mMpSystemData.NextApIndex + 1);
+      if (mMpSystemData.NextApIndex < mMpSystemData.NumberOfProcessors) {
+        WakeUpAp (
+          &mMpSystemData.CpuData[mMpSystemData.NextApIndex],
+          mMpSystemData.Procedure,
+          mMpSystemData.ProcedureArgument
+          );
+      }
+    }
+  }
+
+  if (mMpSystemData.FinishCount == mMpSystemData.StartCount) {
+    if (mMpSystemData.FailedCpuList != NULL) {
+      *mMpSystemData.FailedCpuList = NULL;
+    }
+    mMpSystemData.StartAllApsInProgress = FALSE;
+    return EFI_SUCCESS;
+  }
+
+  if (mMpSystemData.TimeoutEnabled) {
+    if (mMpSystemData.TimeoutInMicroseconds <= ElapsedTime) {
+      CollectFailedCpuList ();
+      mMpSystemData.StartAllApsInProgress = FALSE;
+      return EFI_TIMEOUT;
+    }
+    mMpSystemData.TimeoutInMicroseconds -= ElapsedTime;
+  }
+
+  return EFI_NOT_READY;
+}
+
+/**
+  Check the progress of the procedure dispatched by StartupThisAP.
+
+  @param[in]  CpuData       CPU_AP_DATA of the AP.
+  @param[in]  ElapsedTime   Microseconds elapsed since the previous check.
+
+  @retval EFI_SUCCESS     The AP finished the procedure.
+  @retval EFI_TIMEOUT     The request timed out.
+  @retval EFI_NOT_READY   The AP is still running the procedure.
+
+**/
+STATIC
+EFI_STATUS
+CheckThisAp (
+  IN  CPU_AP_DATA  *CpuData,
+  IN  UINTN        ElapsedTime
+  )
+{
+  if (CpuData->State == CpuStateFinished) {
+    CpuData->State = CpuStateIdle;
+    if (CpuData->Finished != NULL) {
+      *CpuData->Finished = TRUE;
+    }
+    return EFI_SUCCESS;
+  }
+
+  if (CpuData->TimeoutEnabled) {
+    if (CpuData->TimeoutInMicroseconds <= ElapsedTime) {
+      if (CpuData->Finished != NULL) {
+        *CpuData->Finished = FALSE;
+      }
+      return EFI_TIMEOUT;
+    }
+    CpuData->TimeoutInMicroseconds -= ElapsedTime;
+  }
+
+  return EFI_NOT_READY;
+}
+
+/**
+  Timer callback checking the non-blocking requests and signaling
+  their wait events when done.
+
+  @param[in]  Event     The timer event.
+  @param[in]  Context   Not used.
+
+**/
+STATIC
+VOID
+EFIAPI
+CheckApsStatus (
+  IN  EFI_EVENT  Event,
+  IN  VOID       *Context
+  )
+{
+  EFI_STATUS   Status;
+  UINTN        Index;
+  CPU_AP_DATA  *CpuData;
+  BOOLEAN      Pending;
+
+  Pending = FALSE;
+
+  if (mMpSystemData.StartAllApsInProgress && (mMpSystemData.WaitEvent != NULL)) {
+    Status = CheckAllAps (AP_CHECK_TIMER_PERIOD / 10);
+    if (Status != EFI_NOT_READY) {
+      gBS->SignalEvent (mMpSystemData.WaitEvent);
+      mMpSystemData.WaitEvent = NULL;
+    } else {
+      Pending = TRUE;
+    }
+  }
+
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    CpuData = &mMpSystemData.CpuData[Index];
+    if (CpuData->WaitEvent == NULL) {
+      continue;
+    }
+    Status = CheckThisAp (CpuData, AP_CHECK_TIMER_PERIOD / 10);
+    if (Status != EFI_NOT_READY) {
+      gBS->SignalEvent (CpuData->WaitEvent);
+      CpuData->WaitEvent = NULL;
+    } else {
+      Pending = TRUE;
+    }
+  }
+
+  if (!Pending) {
+    gBS->SetTimer (mMpSystemData.CheckApsEvent, TimerCancel, 0);
+  }
+}
+
+/**
+  This service retrieves the number of logical processor in the platform
+  and the number of those logical processors that are enabled on this boot.
+
+  @param[in]  This                    A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[out] NumberOfProcessors      Pointer to the total number of logical
+                                      processors in the system, including the BSP
+                                      and disabled APs.
+  @param[out] NumberOfEnabledProcessors Pointer to the number of enabled logical
+                                      processors that exist in system, including
+                                      the BSP.
+
+  @retval EFI_SUCCESS             The number of logical processors and enabled
+                                  logical processors was retrieved.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_INVALID_PARAMETER   NumberOfProcessors or NumberOfEnabledProcessors is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+GetNumberOfProcessors (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                     *NumberOfProcessors,
+  OUT UINTN                     *NumberOfEnabledProcessors
+  )
+{
+  if ((NumberOfProcessors == NULL) || (NumberOfEnabledProcessors == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!IsBsp ()) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  *NumberOfProcessors        = mMpSystemData.NumberOfProcessors;
+  *NumberOfEnabledProcessors = mMpSystemData.NumberOfEnabledProcessors;
+  return EFI_SUCCESS;
+}
+
+/**
+  Gets detailed MP-related information on the requested processor at the
+  instant this call is made.
+
+  The hart ID is reported as processor ID and as core number of the
+  processor location.
+
+  @param[in]  This                A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in]  ProcessorNumber     The handle number of processor.
+  @param[out] ProcessorInfoBuffer A pointer to the buffer where information for
+                                  the requested processor is deposited.
+
+  @retval EFI_SUCCESS             Processor information was returned.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_INVALID_PARAMETER   ProcessorInfoBuffer is NULL.
+  @retval EFI_NOT_FOUND           The processor with the handle specified by
+                                  ProcessorNumber does not exist in the platform.
+
+**/
+EFI_STATUS
+EFIAPI
+GetProcessorInfo (
+  IN  EFI_MP_SERVICES_PROTOCOL   *This,
+  IN  UINTN                      ProcessorNumber,
+  OUT EFI_PROCESSOR_INFORMATION  *ProcessorInfoBuffer
+  )
+{
+  CPU_AP_DATA  *CpuData;
+
+  if (ProcessorInfoBuffer == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!IsBsp ()) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (ProcessorNumber >= mMpSystemData.NumberOfProcessors) {
+    return EFI_NOT_FOUND;
+  }
+
+  CpuData = &mMpSystemData.CpuData[ProcessorNumber];
+  ProcessorInfoBuffer->ProcessorId       = CpuData->HartId;
+  ProcessorInfoBuffer->StatusFlag        = CpuData->StatusFlag;
+  ProcessorInfoBuffer->Location.Package  = 0;
+  ProcessorInfoBuffer->Location.Core     = (UINT32)CpuData->HartId;
+  ProcessorInfoBuffer->Location.Thread   = 0;
+  return EFI_SUCCESS;
+}
+
+/**
+  This service executes a caller provided function on all enabled APs.
+
+  @param[in]  This                    A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in]  Procedure               A pointer to the function to be run on
+                                      enabled APs of the system.
+  @param[in]  SingleThread            If TRUE, then all the enabled APs execute
+                                      the function specified by Procedure one by
+                                      one, in ascending order of processor handle
+                                      number. If FALSE, then all the enabled APs
+                                      execute the function specified by Procedure
+                                      simultaneously.
+  @param[in]  WaitEvent               The event created by the caller with CreateEvent()
+                                      service. If it is NULL, then execute in
+                                      blocking mode.
+  @param[in]  TimeoutInMicroseconds   Indicates the time limit in microseconds for
+                                      APs to return from Procedure. Zero means
+                                      infinity.
+  @param[in]  ProcedureArgument       The parameter passed into Procedure for
+                                      all APs.
+  @param[out] FailedCpuList           If NULL, this parameter is ignored. Otherwise,
+                                      the list of processors that did not finish
+                                      Procedure before the timeout is returned.
+
+  @retval EFI_SUCCESS             All APs finished Procedure, or the request was
+                                  dispatched in non-blocking mode.
+  @retval EFI_DEVICE_ERROR        Caller processor is AP.
+  @retval EFI_NOT_STARTED         No enabled APs exist in the system.
+  @retval EFI_NOT_READY           Any enabled APs are busy.
+  @retval EFI_TIMEOUT             Not all enabled APs finished before the timeout.
+  @retval EFI_INVALID_PARAMETER   Procedure is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+StartupAllAPs (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  EFI_AP_PROCEDURE          Procedure,
+  IN  BOOLEAN                   SingleThread,
+  IN  EFI_EVENT                 WaitEvent               OPTIONAL,
+  IN  UINTN                     TimeoutInMicroseconds,
+  IN  VOID                      *ProcedureArgument      OPTIONAL,
+  OUT UINTN                     **FailedCpuList         OPTIONAL
+  )
+{
+  EFI_STATUS   Status;
+  UINTN        Index;
+  CPU_AP_DATA  *CpuData;
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!IsBsp ()) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  Status = EFI_SUCCESS;
+  if (mMpSystemData.NumberOfEnabledProcessors <= 1) {
+    return EFI_NOT_STARTED;
+  }
+
+  if (mMpSystemData.StartAllApsInProgress) {
+    return EFI_NOT_READY;
+  }
+
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    CpuData = &mMpSystemData.CpuData[Index];
+    if ((Index != mMpSystemData.BspIndex) && IsApEnabled (CpuData) && !IsApIdle (CpuData)) {
+      return EFI_NOT_READY;
+    }
+  }
+
+  mMpSystemData.Procedure             = Procedure;
+  mMpSystemData.ProcedureArgument     = ProcedureArgument;
+  mMpSystemData.SingleThread          = SingleThread;
+  mMpSystemData.WaitEvent             = WaitEvent;
+  mMpSystemData.TimeoutInMicroseconds = TimeoutInMicroseconds;
+  mMpSystemData.TimeoutEnabled        = (BOOLEAN)(TimeoutInMicroseconds != 0);
+  mMpSystemData.FailedCpuList         = FailedCpuList;
+  mMpSystemData.StartCount            = 0;
+  mMpSystemData.FinishCount           = 0;
+
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    CpuData = &mMpSystemData.CpuData[Index];
+    if ((Index != mMpSystemData.BspIndex) && IsApEnabled (CpuData)) {
+      CpuData->AllApsMember = TRUE;
+      mMpSystemData.StartCount++;
+    }
+  }
+  mMpSystemData.StartAllApsInProgress = TRUE;
+
+  if (SingleThread) {
+    mMpSystemData.NextApIndex = NextEnabledAp (0);
+    Status = WakeUpAp (&mMpSystemData.CpuData[mMpSystemData.NextApIndex], Procedure, ProcedureArgument);
+  } else {
+    for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+      CpuData = &mMpSystemData.CpuData[Index];
+      if (CpuData->AllApsMember) {
+        Status = WakeUpAp (CpuData, Procedure, ProcedureArgument);
+        if (EFI_ERROR (Status)) {
+          break;
+        }
+      }
+    }
+  }
+
+  if (EFI_ERROR (Status)) {
+    //
+    // Drop the request. APs already woken up finish on their own and are
+    // considered idle again afterwards.
+    //
+    for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+      mMpSystemData.CpuData[Index].AllApsMember = FALSE;
+    }
+    mMpSystemData.StartAllApsInProgress = FALSE;
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (WaitEvent != NULL) {
+    return gBS->SetTimer (mMpSystemData.CheckApsEvent, TimerPeriodic, AP_CHECK_TIMER_PERIOD);
+  }
+
+  for (;;) {
+    Status = CheckAllAps (AP_CHECK_INTERVAL);
+    if (Status != EFI_NOT_READY) {
+      return Status;
+    }
+    gBS->Stall (AP_CHECK_INTERVAL);
+  }
+}
+
+/**
+  This service lets the caller get one enabled AP to execute a caller-provided
+  function.
+
+  @param[in]  This                    A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in]  Procedure               A pointer to the function to be run on the
+                                      designated AP.
+  @param[in]  ProcessorNumber         The handle number of the AP.
+  @param[in]  WaitEvent               The event created by the caller with CreateEvent()
+                                      service. If it is NULL, then execute in
+                                      blocking mode.
+  @param[in]  TimeoutInMicroseconds   Indicates the time limit in microseconds for
+                                      the AP to return from Procedure. Zero means
+                                      infinity.
+  @param[in]  ProcedureArgument       The parameter passed into Procedure on the
+                                      specified AP.
+  @param[out] Finished                If AP returns from Procedure before the
+                                      timeout expires, its content is set to TRUE.
+                                      Otherwise, the value is set to FALSE.
+
+  @retval EFI_SUCCESS             The AP finished Procedure, or the request was
+                                  dispatched in non-blocking mode.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_TIMEOUT             The AP did not finish before the timeout.
+  @retval EFI_NOT_FOUND           The processor with the handle specified by
+                                  ProcessorNumber does not exist.
+  @retval EFI_INVALID_PARAMETER   ProcessorNumber specifies the BSP or a disabled AP.
+  @retval EFI_INVALID_PARAMETER   Procedure is NULL.
+  @retval EFI_NOT_READY           The AP is busy.
+
+**/
+EFI_STATUS
+EFIAPI
+StartupThisAP (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  EFI_AP_PROCEDURE          Procedure,
+  IN  UINTN                     ProcessorNumber,
+  IN  EFI_EVENT                 WaitEvent               OPTIONAL,
+  IN  UINTN                     TimeoutInMicroseconds,
+  IN  VOID                      *ProcedureArgument      OPTIONAL,
+  OUT BOOLEAN                   *Finished               OPTIONAL
+  )
+{
+  EFI_STATUS   Status;
+  CPU_AP_DATA  *CpuData;
+
+  if (Procedure == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!IsBsp ()) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (ProcessorNumber >= mMpSystemData.NumberOfProcessors) {
+    return EFI_NOT_FOUND;
+  }
+
+  CpuData = &mMpSystemData.CpuData[ProcessorNumber];
+  if ((ProcessorNumber == mMpSystemData.BspIndex) || !IsApEnabled (CpuData)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!IsApIdle (CpuData) || CpuData->AllApsMember) {
+    return EFI_NOT_READY;
+  }
+
+  CpuData->Finished              = Finished;
+  CpuData->TimeoutInMicroseconds = TimeoutInMicroseconds;
+  CpuData->TimeoutEnabled        = (BOOLEAN)(TimeoutInMicroseconds != 0);
+  if (Finished != NULL) {
+    *Finished = FALSE;
+  }
+
+  Status = WakeUpAp (CpuData, Procedure, ProcedureArgument);
+  if (EFI_ERROR (Status)) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (WaitEvent != NULL) {
+    CpuData->WaitEvent = WaitEvent;
+    return gBS->SetTimer (mMpSystemData.CheckApsEvent, TimerPeriodic, AP_CHECK_TIMER_PERIOD);
+  }
+
+  for (;;) {
+    Status = CheckThisAp (CpuData, AP_CHECK_INTERVAL);
+    if (Status != EFI_NOT_READY) {
+      return Status;
+    }
+    gBS->Stall (AP_CHECK_INTERVAL);
+  }
+}
+
+/**
+  This service switches the requested AP to be the BSP from that point onward.
+
+  @param[in] This              A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in] ProcessorNumber   The handle number of AP that is to become the new BSP.
+  @param[in] EnableOldBSP      If TRUE, then the old BSP will be listed as an
+                               enabled AP. Otherwise, it will be disabled.
+
+  @retval EFI_UNSUPPORTED      Switching the BSP is not supported on RISC-V.
+
+**/
+EFI_STATUS
+EFIAPI
+SwitchBSP (
+  IN EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  UINTN                    ProcessorNumber,
+  IN  BOOLEAN                  EnableOldBSP
+  )
+{
+  return EFI_UNSUPPORTED;
+}
+
+/**
+  This service lets the caller enable or disable an AP from this point onward.
+
+  @param[in] This              A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in] ProcessorNumber   The handle number of AP.
+  @param[in] EnableAP          Specifies the new state for the processor.
+  @param[in] HealthFlag        If not NULL, a pointer to a value that specifies
+                               the new health status of the AP.
+
+  @retval EFI_SUCCESS             The specified AP was enabled or disabled successfully.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_NOT_FOUND           Processor with the handle specified by
+                                  ProcessorNumber does not exist.
+  @retval EFI_INVALID_PARAMETER   ProcessorNumber specifies the BSP.
+  @retval EFI_NOT_READY           The AP is busy.
+
+**/
+EFI_STATUS
+EFIAPI
+EnableDisableAP (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  UINTN                     ProcessorNumber,
+  IN  BOOLEAN                   EnableAP,
+  IN  UINT32                    *HealthFlag OPTIONAL
+  )
+{
+  CPU_AP_DATA  *CpuData;
+
+  if (!IsBsp ()) {
+    return EFI_DEVICE_ERROR;
+  }
+
+  if (ProcessorNumber >= mMpSystemData.NumberOfProcessors) {
+    return EFI_NOT_FOUND;
+  }
+
+  if (ProcessorNumber == mMpSystemData.BspIndex) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  CpuData = &mMpSystemData.CpuData[ProcessorNumber];
+  if (!IsApIdle (CpuData) || CpuData->AllApsMember) {
+    return EFI_NOT_READY;
+  }
+
+  if (EnableAP && !IsApEnabled (CpuData)) {
+    CpuData->StatusFlag |= PROCESSOR_ENABLED_BIT;
+    mMpSystemData.NumberOfEnabledProcessors++;
+  } else if (!EnableAP && IsApEnabled (CpuData)) {
+    CpuData->StatusFlag &= ~PROCESSOR_ENABLED_BIT;
+    mMpSystemData.NumberOfEnabledProcessors--;
+  }
+
+  if (HealthFlag != NULL) {
+    CpuData->StatusFlag &= ~PROCESSOR_HEALTH_STATUS_BIT;
+    CpuData->StatusFlag |= (*HealthFlag & PROCESSOR_HEALTH_STATUS_BIT);
+  }
+
+  return EFI_SUCCESS;
+}
+
+/**
+  This return the handle number for the calling processor.
+
+  @param[in]  This             A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[out] ProcessorNumber  The handle number of the calling processor.
+
+  @retval EFI_SUCCESS             The current processor handle number was returned
+                                  in ProcessorNumber.
+  @retval EFI_INVALID_PARAMETER   ProcessorNumber is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+WhoAmI (
+  IN EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                    *ProcessorNumber
+  )
+{
+  if (ProcessorNumber == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  return GetProcessorIndex (ProcessorNumber);
+}
+
+/**
+  Return all parked APs to SBI at ExitBootServices, so the OS can start them
+  through SBI HSM.
+
+  @param[in]  Event     The ExitBootServices event.
+  @param[in]  Context   Not used.
+
+**/
+STATIC
+VOID
+EFIAPI
+MpServicesExitBootServices (
+  IN  EFI_EVENT  Event,
+  IN  VOID       *Context
+  )
+{
+  EFI_STATUS   Status;
+  UINTN        Index;
+  UINTN        HartMask;
+  UINTN        HartStatus;
+  CPU_AP_DATA  *CpuData;
+
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    CpuData = &mMpSystemData.CpuData[Index];
+    if ((Index == mMpSystemData.BspIndex) || (CpuData->State == CpuStateStopped)) {
+      continue;
+    }
+
+    if ((CpuData->State != CpuStateIdle) && (CpuData->State != CpuStateFinished)) {
+      DEBUG ((DEBUG_ERROR, "%a: Hart %d is still busy and can't be stopped\n", __FUNCTION__, CpuData->HartId));
+      continue;
+    }
+
+    CpuData->State = CpuStateStopRequested;
+    MemoryFence ();
+    HartMask = 1;
+    SbiSendIpi (&HartMask, CpuData->HartId);
+  }
+
+  for (Index = 0; Index < mMpSystemData.NumberOfProcessors; Index++) {
+    CpuData = &mMpSystemData.CpuData[Index];
+    if (Index == mMpSystemData.BspIndex) {
+      continue;
+    }
+    while (CpuData->State == CpuStateStopRequested);
+    if (CpuData->State == CpuStateStopped) {
+      do {
+        Status = SbiHartGetStatus (CpuData->HartId, &HartStatus);
+      } while (!EFI_ERROR (Status) && (HartStatus != SBI_HSM_HART_STATUS_STOPPED));
+    }
+  }
+}
+
+/**
+  Discover the harts known to SBI and allocate the per-AP data.
+
+  @retval EFI_SUCCESS           The processors were discovered.
+  @retval EFI_OUT_OF_RESOURCES  The memory could not be allocated.
+
+**/
+STATIC
+EFI_STATUS
+InitializeMpSystemData (
+  VOID
+  )
+{
+  EFI_STATUS             Status;
+  RISCV_HART_LOCAL_DATA  *HartLocalData;
+  SBI_SCRATCH            *ThisScratch;
+  SBI_SCRATCH            *Scratch;
+  UINTN                  HartId;
+  UINTN                  HartStatus;
+  UINTN                  Index;
+  INTN                   HsmProbe;
+  VOID                   *Stack;
+  CPU_AP_DATA            *CpuData;
+
+  HartLocalData = RiscVGetHartLocalData ();
+  if (HartLocalData != NULL) {
+    ThisScratch = HartLocalData->Scratch;
+  } else {
+    SbiGetMscratch (&ThisScratch);
+  }
+  SbiProbeExtension (SBI_EXT_HSM, &HsmProbe);
+  if (HsmProbe == 0) {
+    DEBUG ((DEBUG_WARN, "%a: SBI HSM extension is not available, APs are not used\n", __FUNCTION__));
+  }
+
+  mMpSystemData.CpuData = AllocateZeroPool (RISC_V_MAX_HART_SUPPORTED * sizeof (CPU_AP_DATA));
+  if (mMpSystemData.CpuData == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  Index = 0;
+  for (HartId = 0; HartId < RISC_V_MAX_HART_SUPPORTED; HartId++) {
+    SbiGetMscratchHartid (HartId, &Scratch);
+    if (Scratch == NULL) {
+      continue;
+    }
+
+    CpuData          = &mMpSystemData.CpuData[Index];
+    CpuData->HartId  = HartId;
+    CpuData->Scratch = Scratch;
+    CpuData->State   = CpuStateStopped;
+
+    if (Scratch == ThisScratch) {
+      CpuData->StatusFlag = PROCESSOR_AS_BSP_BIT | PROCESSOR_ENABLED_BIT | PROCESSOR_HEALTH_STATUS_BIT;
+      CpuData->State      = CpuStateBusy;
+      mMpSystemData.BspIndex = Index;
+      mMpSystemData.NumberOfEnabledProcessors++;
+      if (HartLocalData != NULL) {
+        HartLocalData->ProcessorNumber = Index;
+      }
+    } else if (HsmProbe != 0) {
+      Status = SbiHartGetStatus (HartId, &HartStatus);
+      if (!EFI_ERROR (Status) && (HartStatus == SBI_HSM_HART_STATUS_STOPPED)) {
+        Stack = AllocatePages (AP_STACK_PAGES);
+        if (Stack == NULL) {
+          return EFI_OUT_OF_RESOURCES;
+        }
+        CpuData->StackTop   = (UINTN)Stack + EFI_PAGES_TO_SIZE (AP_STACK_PAGES);
+        CpuData->StatusFlag = PROCESSOR_ENABLED_BIT | PROCESSOR_HEALTH_STATUS_BIT;
+        mMpSystemData.NumberOfEnabledProcessors++;
+      } else {
+        DEBUG ((DEBUG_WARN, "%a: Hart %d is not stopped in SBI, disabled\n", __FUNCTION__, HartId));
+      }
+    }
+
+    DEBUG ((DEBUG_INFO, "%a: Processor %d is hart %d, StatusFlag 0x%x\n",
+      __FUNCTION__,
+      Index,
+      HartId,
+      CpuData->StatusFlag
+      ));
+    Index++;
+  }
+
+  mMpSystemData.NumberOfProcessors = Index;
+  return EFI_SUCCESS;
+}
+
+/**
+  Initialize the MP Services protocol.
+
+  @param ImageHandle     Image handle this driver.
+  @param SystemTable     Pointer to the System Table.
+
+  @retval EFI_SUCCESS           The protocol was installed.
+  @retval EFI_OUT_OF_RESOURCES  Cannot allocate protocol data structure.
+
+**/
+EFI_STATUS
+EFIAPI
+InitializeMpServices (
+  IN EFI_HANDLE                            ImageHandle,
+  IN EFI_SYSTEM_TABLE                      *SystemTable
+  )
+{
+  EFI_STATUS  Status;
+
+  Status = InitializeMpSystemData ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+
+  Status = gBS->CreateEvent (
+                  EVT_TIMER | EVT_NOTIFY_SIGNAL,
+                  TPL_CALLBACK,
+                  CheckApsStatus,
+                  NULL,
+                  &mMpSystemData.CheckApsEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
+
+  Status = gBS->CreateEvent (
+                  EVT_SIGNAL_EXIT_BOOT_SERVICES,
+                  TPL_CALLBACK,
+                  MpServicesExitBootServices,
+                  NULL,
+                  &mExitBootServicesEvent
+                  );
+  ASSERT_EFI_ERROR (Status);
+
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &mMpServiceHandle,
+                  &gEfiMpServiceProtocolGuid, &mMpServicesProtocol,
+                  NULL
+                  );
+  ASSERT_EFI_ERROR (Status);
+  return Status;
+}
@@ -0,0 +1,339 @@
+/** @file
+  RISC-V MP Services DXE module header file.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef MP_SERVICES_DXE_H_
+#define MP_SERVICES_DXE_H_
+
+#include <PiDxe.h>
+
+#include <IndustryStandard/RiscVOpensbi.h>
+#include <Library/BaseLib.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/DebugLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/RiscVEdk2SbiLib.h>
+#include <Library/RiscVHartLocalDataLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Library/UefiDriverEntryPoint.h>
+#include <Protocol/MpService.h>
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+
+//
+// Stack size of each application processor, in pages.
+//
+#define AP_STACK_PAGES                4
+
+//
+// Poll interval of the BSP waiting for APs, in microseconds.
+//
+#define AP_CHECK_INTERVAL             100
+
+//
+// Period of the timer checking non-blocking requests, in 100ns units.
+//
+#define AP_CHECK_TIMER_PERIOD         (10 * 1000)
+
+//
+// Hart states of SBI HSM extension.
+//
+#define SBI_HSM_HART_STATUS_STARTED   0
+#define SBI_HSM_HART_STATUS_STOPPED   1
+
+typedef enum {
+  CpuStateStopped,        // Hart is stopped in SBI.
+  CpuStateIdle,           // Hart is parked in WFI in the AP loop.
+  CpuStateReady,          // A procedure is posted to the hart.
+  CpuStateBusy,           // Hart is running the posted procedure.
+  CpuStateFinished,       // Hart finished the procedure.
+  CpuStateStopRequested   // Hart is asked to return to SBI.
+} CPU_STATE;
+
+typedef struct {
+  UINTN                       StackTop;   // Must be the first member, referred by ApEntry.S
+  UINTN                       HartId;
+  SBI_SCRATCH                 *Scratch;
+  UINT32                      StatusFlag;
+  volatile CPU_STATE          State;
+  EFI_AP_PROCEDURE            Procedure;
+  VOID                        *ProcedureArgument;
+  RISCV_HART_LOCAL_DATA       HartLocalData;
+
+  //
+  // TRUE if this AP takes part in the outstanding StartupAllAPs request
+  //
+  BOOLEAN                     AllApsMember;
+
+  //
+  // Bookkeeping of the BSP for non-blocking StartupThisAP
+  //
+  EFI_EVENT                   WaitEvent;
+  BOOLEAN                     *Finished;
+  UINTN                       TimeoutInMicroseconds;
+  BOOLEAN                     TimeoutEnabled;
+} CPU_AP_DATA;
+
+typedef struct {
+  UINTN                       NumberOfProcessors;
+  UINTN                       NumberOfEnabledProcessors;
+  UINTN                       BspIndex;
+  CPU_AP_DATA                 *CpuData;
+
+  //
+  // Bookkeeping of the BSP for StartupAllAPs
+  //
+  BOOLEAN                     StartAllApsInProgress;
+  EFI_AP_PROCEDURE            Procedure;
+  VOID                        *ProcedureArgument;
+  BOOLEAN                     SingleThread;
+  UINTN                       NextApIndex;
+  UINTN                       StartCount;
+  UINTN                       FinishCount;
+  EFI_EVENT                   WaitEvent;
+  UINTN                       TimeoutInMicroseconds;
+  BOOLEAN                     TimeoutEnabled;
+  UINTN                       **FailedCpuList;
+
+  EFI_EVENT                   CheckApsEvent;
+} MP_SYSTEM_DATA;
+
+/**
+  Entry point of an application processor started through SBI HSM.
+
+  Sets up the stack from the CPU_AP_DATA passed in a1 and calls the AP loop.
+
+  @param[in]  HartId      Hart ID of this processor, passed by SBI in a0.
+  @param[in]  CpuData     CPU_AP_DATA of this processor, passed by SBI in a1.
+
+**/
+VOID
+EFIAPI
+ApEntryPoint (
+  IN  UINTN        HartId,
+  IN  CPU_AP_DATA  *CpuData
+  );
+
+/**
+  The AP loop. Parks the hart in WFI and runs the procedures posted by the
+  BSP until the BSP requests the hart to stop.
+
+  @param[in]  HartId      Hart ID of this processor.
+  @param[in]  CpuData     CPU_AP_DATA of this processor.
+
+**/
+VOID
+EFIAPI
+ApProcedureLoop (
+  IN  UINTN        HartId,
+  IN  CPU_AP_DATA  *CpuData
+  );
+
+/**
+  This service retrieves the number of logical processor in the platform
+  and the number of those logical processors that are enabled on this boot.
+
+  @param[in]  This                    A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[out] NumberOfProcessors      Pointer to the total number of logical
+                                      processors in the system, including the BSP
+                                      and disabled APs.
+  @param[out] NumberOfEnabledProcessors Pointer to the number of enabled logical
+                                      processors that exist in system, including
+                                      the BSP.
+
+  @retval EFI_SUCCESS             The number of logical processors and enabled
+                                  logical processors was retrieved.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_INVALID_PARAMETER   NumberOfProcessors or NumberOfEnabledProcessors is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+GetNumberOfProcessors (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                     *NumberOfProcessors,
+  OUT UINTN                     *NumberOfEnabledProcessors
+  );
+
+/**
+  Gets detailed MP-related information on the requested processor at the
+  instant this call is made.
+
+  @param[in]  This                A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in]  ProcessorNumber     The handle number of processor.
+  @param[out] ProcessorInfoBuffer A pointer to the buffer where information for
+                                  the requested processor is deposited.
+
+  @retval EFI_SUCCESS             Processor information was returned.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_INVALID_PARAMETER   ProcessorInfoBuffer is NULL.
+  @retval EFI_NOT_FOUND           The processor with the handle specified by
+                                  ProcessorNumber does not exist in the platform.
+
+**/
+EFI_STATUS
+EFIAPI
+GetProcessorInfo (
+  IN  EFI_MP_SERVICES_PROTOCOL   *This,
+  IN  UINTN                      ProcessorNumber,
+  OUT EFI_PROCESSOR_INFORMATION  *ProcessorInfoBuffer
+  );
+
+/**
+  This service executes a caller provided function on all enabled APs.
+
+  @param[in]  This                    A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in]  Procedure               A pointer to the function to be run on
+                                      enabled APs of the system.
+  @param[in]  SingleThread            If TRUE, then all the enabled APs execute
+                                      the function specified by Procedure one by
+                                      one, in ascending order of processor handle
+                                      number. If FALSE, then all the enabled APs
+                                      execute the function specified by Procedure
+                                      simultaneously.
+  @param[in]  WaitEvent               The event created by the caller with CreateEvent()
+                                      service. If it is NULL, then execute in
+                                      blocking mode.
+  @param[in]  TimeoutInMicroseconds   Indicates the time limit in microseconds for
+                                      APs to return from Procedure. Zero means
+                                      infinity.
+  @param[in]  ProcedureArgument       The parameter passed into Procedure for
+                                      all APs.
+  @param[out] FailedCpuList           If NULL, this parameter is ignored. Otherwise,
+                                      the list of processors that did not finish
+                                      Procedure before the timeout is returned.
+
+  @retval EFI_SUCCESS             All APs finished Procedure, or the request was
+                                  dispatched in non-blocking mode.
+  @retval EFI_DEVICE_ERROR        Caller processor is AP.
+  @retval EFI_NOT_STARTED         No enabled APs exist in the system.
+  @retval EFI_NOT_READY           Any enabled APs are busy.
+  @retval EFI_TIMEOUT             Not all enabled APs finished before the timeout.
+  @retval EFI_INVALID_PARAMETER   Procedure is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+StartupAllAPs (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  EFI_AP_PROCEDURE          Procedure,
+  IN  BOOLEAN                   SingleThread,
+  IN  EFI_EVENT                 WaitEvent               OPTIONAL,
+  IN  UINTN                     TimeoutInMicroseconds,
+  IN  VOID                      *ProcedureArgument      OPTIONAL,
+  OUT UINTN                     **FailedCpuList         OPTIONAL
+  );
+
+/**
+  This service lets the caller get one enabled AP to execute a caller-provided
+  function.
+
+  @param[in]  This                    A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in]  Procedure               A pointer to the function to be run on the
+                                      designated AP.
+  @param[in]  ProcessorNumber         The handle number of the AP.
+  @param[in]  WaitEvent               The event created by the caller with CreateEvent()
+                                      service. If it is NULL, then execute in
+                                      blocking mode.
+  @param[in]  TimeoutInMicroseconds   Indicates the time limit in microseconds for
+                                      the AP to return from Procedure. Zero means
+                                      infinity.
+  @param[in]  ProcedureArgument       The parameter passed into Procedure on the
+                                      specified AP.
+  @param[out] Finished                If AP returns from Procedure before the
+                                      timeout expires, its content is set to TRUE.
+                                      Otherwise, the value is set to FALSE.
+
+  @retval EFI_SUCCESS             The AP finished Procedure, or the request was
+                                  dispatched in non-blocking mode.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_TIMEOUT             The AP did not finish before the timeout.
+  @retval EFI_NOT_FOUND           The processor with the handle specified by
+                                  ProcessorNumber does not exist.
+  @retval EFI_INVALID_PARAMETER   ProcessorNumber specifies the BSP or a disabled AP.
+  @retval EFI_INVALID_PARAMETER   Procedure is NULL.
+  @retval EFI_NOT_READY           The AP is busy.
+
+**/
+EFI_STATUS
+EFIAPI
+StartupThisAP (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  EFI_AP_PROCEDURE          Procedure,
+  IN  UINTN                     ProcessorNumber,
+  IN  EFI_EVENT                 WaitEvent               OPTIONAL,
+  IN  UINTN                     TimeoutInMicroseconds,
+  IN  VOID                      *ProcedureArgument      OPTIONAL,
+  OUT BOOLEAN                   *Finished               OPTIONAL
+  );
+
+/**
+  This service switches the requested AP to be the BSP from that point onward.
+
+  @param[in] This              A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in] ProcessorNumber   The handle number of AP that is to become the new BSP.
+  @param[in] EnableOldBSP      If TRUE, then the old BSP will be listed as an
+                               enabled AP. Otherwise, it will be disabled.
+
+  @retval EFI_UNSUPPORTED      Switching the BSP is not supported on RISC-V.
+
+**/
+EFI_STATUS
+EFIAPI
+SwitchBSP (
+  IN EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  UINTN                    ProcessorNumber,
+  IN  BOOLEAN                  EnableOldBSP
+  );
+
+/**
+  This service lets the caller enable or disable an AP from this point onward.
+
+  @param[in] This              A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[in] ProcessorNumber   The handle number of AP.
+  @param[in] EnableAP          Specifies the new state for the processor.
+  @param[in] HealthFlag        If not NULL, a pointer to a value that specifies
+                               the new health status of the AP.
+
+  @retval EFI_SUCCESS             The specified AP was enabled or disabled successfully.
+  @retval EFI_DEVICE_ERROR        The calling processor is an AP.
+  @retval EFI_NOT_FOUND           Processor with the handle specified by
+                                  ProcessorNumber does not exist.
+  @retval EFI_INVALID_PARAMETER   ProcessorNumber specifies the BSP.
+  @retval EFI_NOT_READY           The AP is busy.
+
+**/
+EFI_STATUS
+EFIAPI
+EnableDisableAP (
+  IN  EFI_MP_SERVICES_PROTOCOL  *This,
+  IN  UINTN                     ProcessorNumber,
+  IN  BOOLEAN                   EnableAP,
+  IN  UINT32                    *HealthFlag OPTIONAL
+  );
+
+/**
+  This return the handle number for the calling processor.
+
+  @param[in]  This             A pointer to the EFI_MP_SERVICES_PROTOCOL instance.
+  @param[out] ProcessorNumber  The handle number of the calling processor.
+
+  @retval EFI_SUCCESS             The current processor handle number was returned
+                                  in ProcessorNumber.
+  @retval EFI_INVALID_PARAMETER   ProcessorNumber is NULL.
+
+**/
+EFI_STATUS
+EFIAPI
+WhoAmI (
+  IN EFI_MP_SERVICES_PROTOCOL  *This,
+  OUT UINTN                    *ProcessorNumber
+  );
+
+#endif
@@ -0,0 +1,493 @@
+/** @file
+  RISC-V Platform-Level Interrupt Controller DXE driver.
+
+  Routes the PLIC interrupts to the S-mode context of the boot hart and
+  dispatches them to the handlers registered through the RISC-V PLIC
+  protocol.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "PlicDxe.h"
+
+STATIC UINTN                          mPlicBase;
+STATIC UINTN                          mPlicNumSources;
+STATIC UINTN                          mPlicContext;
+STATIC RISCV_PLIC_INTERRUPT_HANDLER   *mHandlers;
+STATIC EFI_EVENT                      mExitBootServicesEvent;
+
+/**
+  Get the address of the enable word of a source in the boot hart context.
+
+  @param  Source    The interrupt source.
+
+  @return The address of the enable register holding the bit of Source.
+
+**/
+STATIC
+UINTN
+PlicEnableRegister (
+  IN  RISCV_PLIC_SOURCE   Source
+  )
+{
+  return mPlicBase + PLIC_ENABLE_OFFSET +
+         mPlicContext * PLIC_ENABLE_CONTEXT_STRIDE + (Source / 32) * 4;
+}
+
+/**
+  Get the address of a register of the boot hart context.
+
+  @param  Register  PLIC_CONTEXT_THRESHOLD or PLIC_CONTEXT_CLAIM.
+
+  @return The address of the register.
+
+**/
+STATIC
+UINTN
+PlicContextRegister (
+  IN  UINTN   Register
+  )
+{
+  return mPlicBase + PLIC_CONTEXT_OFFSET +
+         mPlicContext * PLIC_CONTEXT_STRIDE + Register;
+}
+
+/**
+  Check whether an interrupt source exists.
+
+  @param  Source    The interrupt source.
+
+  @retval TRUE      Source is wired to the PLIC.
+  @retval FALSE     Source is 0 or beyond the last source.
+
+**/
+STATIC
+BOOLEAN
+PlicIsValidSource (
+  IN  RISCV_PLIC_SOURCE   Source
+  )
+{
+  return (BOOLEAN)(Source != 0 && Source <= mPlicNumSources);
+}
+
+/**
+  Register the handler of an interrupt source.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Handler         The handler, NULL to unregister the current one.
+
+  @retval EFI_SUCCESS             The handler was registered or unregistered.
+  @retval EFI_ALREADY_STARTED     Handler is not NULL and Source already has
+                                  a handler.
+  @retval EFI_INVALID_PARAMETER   Source is not valid, or Handler is NULL
+                                  and Source has no handler.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PlicRegisterInterruptSource (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  IN  RISCV_PLIC_INTERRUPT_HANDLER  Handler
+  )
+{
+  if (!PlicIsValidSource (Source)) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if (Handler == NULL && mHandlers[Source] == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+  if (Handler != NULL && mHandlers[Source] != NULL) {
+    return EFI_ALREADY_STARTED;
+  }
+
+  mHandlers[Source] = Handler;
+  return EFI_SUCCESS;
+}
+
+/**
+  Enable an interrupt source for the boot hart.
+
+  A source with priority 0 gets the lowest interrupting priority.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+
+  @retval EFI_SUCCESS             The source was enabled.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PlicEnableInterruptSource (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source
+  )
+{
+  EFI_TPL   OldTpl;
+  UINTN     Priority;
+
+  if (!PlicIsValidSource (Source)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  Priority = mPlicBase + PLIC_PRIORITY_OFFSET + Source * 4;
+  if (MmioRead32 (Priority) == 0) {
+    MmioWrite32 (Priority, PLIC_DEFAULT_PRIORITY);
+  }
+  MmioOr32 (PlicEnableRegister (Source), 1U << (Source % 32));
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+/**
+  Disable an interrupt source for the boot hart.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+
+  @retval EFI_SUCCESS             The source was disabled.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PlicDisableInterruptSource (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source
+  )
+{
+  EFI_TPL   OldTpl;
+
+  if (!PlicIsValidSource (Source)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  OldTpl = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+  MmioAnd32 (PlicEnableRegister (Source), ~(1U << (Source % 32)));
+  gBS->RestoreTPL (OldTpl);
+  return EFI_SUCCESS;
+}
+
+/**
+  Check whether an interrupt source is enabled for the boot hart.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Enabled         TRUE if the source is enabled.
+
+  @retval EFI_SUCCESS             The state was returned.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PlicGetInterruptSourceState (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  OUT BOOLEAN                       *Enabled
+  )
+{
+  if (!PlicIsValidSource (Source) || Enabled == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *Enabled = (BOOLEAN)((MmioRead32 (PlicEnableRegister (Source)) & (1U << (Source % 32))) != 0);
+  return EFI_SUCCESS;
+}
+
+/**
+  Set the priority of an interrupt source. Priority 0 never interrupts.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Priority        The new priority.
+
+  @retval EFI_SUCCESS             The priority was set.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PlicSetInterruptSourcePriority (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  IN  UINT32                        Priority
+  )
+{
+  if (!PlicIsValidSource (Source)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  MmioWrite32 (mPlicBase + PLIC_PRIORITY_OFFSET + Source * 4, Priority);
+  return EFI_SUCCESS;
+}
+
+/**
+  Get the priority of an interrupt source.
+
+  The PLIC only implements some of the priority bits, the value read back
+  may be lower than the value set.
+
+  @param  This            The protocol instance.
+  @param  Source          The interrupt source.
+  @param  Priority        The current priority.
+
+  @retval EFI_SUCCESS             The priority was returned.
+  @retval EFI_INVALID_PARAMETER   Source is not valid.
+
+**/
+STATIC
+EFI_STATUS
+EFIAPI
+PlicGetInterruptSourcePriority (
+  IN  RISCV_PLIC_PROTOCOL           *This,
+  IN  RISCV_PLIC_SOURCE             Source,
+  OUT UINT32                        *Priority
+  )
+{
+  if (!PlicIsValidSource (Source) || Priority == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  *Priority = MmioRead32 (mPlicBase + PLIC_PRIORITY_OFFSET + Source * 4);
+  return EFI_SUCCESS;
+}
+
+STATIC RISCV_PLIC_PROTOCOL  mPlicProtocol = {
+  PlicRegisterInterruptSource,
+  PlicEnableInterruptSource,
+  PlicDisableInterruptSource,
+  PlicGetInterruptSourceState,
+  PlicSetInterruptSourcePriority,
+  PlicGetInterruptSourcePriority
+};
+
+/**
+  Supervisor external interrupt handler.
+
+  Claims the pending interrupts one after the other, calls the handler of
+  each source and completes it. Sources without a handler are disabled.
+
+  @param  InterruptType    EXCEPT_RISCV_EXTERNAL_INT.
+  @param  SystemContext    The context of the interrupted code.
+
+**/
+STATIC
+VOID
+EFIAPI
+PlicInterruptHandler (
+  IN EFI_EXCEPTION_TYPE   InterruptType,
+  IN EFI_SYSTEM_CONTEXT   SystemContext
+  )
+{
+  EFI_TPL     OriginalTPL;
+  UINT32      Source;
+
+  OriginalTPL = gBS->RaiseTPL (TPL_HIGH_LEVEL);
+
+  for (;;) {
+    Source = MmioRead32 (PlicContextRegister (PLIC_CONTEXT_CLAIM));
+    if (Source == 0) {
+      break;
+    }
+
+    if (PlicIsValidSource (Source) && mHandlers[Source] != NULL) {
+      mHandlers[Source] (Source, SystemContext);
+    } else {
+      DEBUG ((DEBUG_ERROR, "%a: Spurious interrupt from source %d, disabled\n", __FUNCTION__, Source));
+      if (PlicIsValidSource (Source)) {
+        MmioAnd32 (PlicEnableRegister (Source), ~(1U << (Source % 32)));
+      }
+    }
+
+    MmioWrite32 (PlicContextRegister (PLIC_CONTEXT_CLAIM), Source);
+  }
+
+  gBS->RestoreTPL (OriginalTPL);
+}
+
+/**
+  Disable all the sources of the boot hart context.
+
+**/
+STATIC
+VOID
+PlicDisableAllSources (
+  VOID
+  )
+{
+  UINTN   Source;
+
+  for (Source = 0; Source <= mPlicNumSources; Source += 32) {
+    MmioWrite32 (PlicEnableRegister (Source), 0);
+  }
+}
+
+/**
+  Leave the PLIC quiet for the OS at ExitBootServices.
+
+  @param  Event     The ExitBootServices event.
+  @param  Context   Not used.
+
+**/
+STATIC
+VOID
+EFIAPI
+PlicExitBootServices (
+  IN EFI_EVENT  Event,
+  IN VOID       *Context
+  )
+{
+  csr_clear (CSR_SIE, MIP_SEIP);
+  PlicDisableAllSources ();
+}
+
+/**
+  Find the ID of the hart running this driver.
+
+  The ID is kept in the hart-local data, the SBI scratch spaces are only
+  searched for a hart without hart-local data.
+
+  @param[out] HartId   The hart ID.
+
+  @retval EFI_SUCCESS     The hart ID was found.
+  @retval EFI_NOT_FOUND   No scratch space of the SBI belongs to this hart.
+
+**/
+STATIC
+EFI_STATUS
+PlicGetBootHartId (
+  OUT UINTN   *HartId
+  )
+{
+  RISCV_HART_LOCAL_DATA  *HartLocalData;
+  SBI_SCRATCH            *ThisScratch;
+  SBI_SCRATCH            *Scratch;
+  UINTN                  Index;
+
+  HartLocalData = RiscVGetHartLocalData ();
+  if (HartLocalData != NULL) {
+    *HartId = HartLocalData->HartId;
+    return EFI_SUCCESS;
+  }
+
+  SbiGetMscratch (&ThisScratch);
+  for (Index = 0; Index < RISC_V_MAX_HART_SUPPORTED; Index++) {
+    SbiGetMscratchHartid (Index, &Scratch);
+    if (Scratch == ThisScratch) {
+      *HartId = Index;
+      return EFI_SUCCESS;
+    }
+  }
+  return EFI_NOT_FOUND;
+}
+
+/**
+  Initialize the PLIC driver.
+
+  @param ImageHandle     Image handle this driver.
+  @param SystemTable     Pointer to the System Table.
+
+  @retval EFI_SUCCESS           The RISC-V PLIC protocol was installed.
+  @retval EFI_UNSUPPORTED       The platform has no PLIC.
+  @retval other                 The driver failed to initialize.
+
+**/
+EFI_STATUS
+EFIAPI
+InitializePlic (
+  IN EFI_HANDLE        ImageHandle,
+  IN EFI_SYSTEM_TABLE  *SystemTable
+  )
+{
+  EFI_STATUS              Status;
+  EFI_CPU_ARCH_PROTOCOL   *Cpu;
+  UINTN                   HartId;
+
+  mPlicBase = (UINTN)PcdGet64 (PcdRiscVPlicBase);
+  mPlicNumSources = PcdGet32 (PcdRiscVPlicNumSources);
+  if (mPlicBase == 0 || mPlicNumSources == 0) {
+    return EFI_UNSUPPORTED;
+  }
+
+  Status = PlicGetBootHartId (&HartId);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "%a: Can't find the ID of the boot hart\n", __FUNCTION__));
+    return Status;
+  }
+  mPlicContext = PcdGet32 (PcdRiscVPlicSupervisorContextBase) +
+                 HartId * PcdGet32 (PcdRiscVPlicSupervisorContextStride);
+
+  mHandlers = AllocateZeroPool ((mPlicNumSources + 1) * sizeof (RISCV_PLIC_INTERRUPT_HANDLER));
+  if (mHandlers == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  //
+  // The range may already be in the map, then only the attributes change.
+  //
+  gDS->AddMemorySpace (
+         EfiGcdMemoryTypeMemoryMappedIo,
+         mPlicBase,
+         PLIC_REGION_SIZE,
+         EFI_MEMORY_UC
+         );
+  gDS->SetMemorySpaceAttributes (mPlicBase, PLIC_REGION_SIZE, EFI_MEMORY_UC);
+
+  PlicDisableAllSources ();
+  MmioWrite32 (PlicContextRegister (PLIC_CONTEXT_THRESHOLD), 0);
+
+  Status = gBS->LocateProtocol (&gEfiCpuArchProtocolGuid, NULL, (VOID **)&Cpu);
+  ASSERT_EFI_ERROR (Status);
+  Status = Cpu->RegisterInterruptHandler (Cpu, EXCEPT_RISCV_EXTERNAL_INT, PlicInterruptHandler);
+  if (EFI_ERROR (Status)) {
+    goto FreeHandlers;
+  }
+
+  Status = gBS->CreateEventEx (
+                  EVT_NOTIFY_SIGNAL,
+                  TPL_NOTIFY,
+                  PlicExitBootServices,
+                  NULL,
+                  &gEfiEventExitBootServicesGuid,
+                  &mExitBootServicesEvent
+                  );
+  if (EFI_ERROR (Status)) {
+    goto UnregisterHandler;
+  }
+
+  Status = gBS->InstallMultipleProtocolInterfaces (
+                  &ImageHandle,
+                  &gRiscVPlicProtocolGuid,
+                  &mPlicProtocol,
+                  NULL
+                  );
+  if (EFI_ERROR (Status)) {
+    goto CloseEvent;
+  }
+
+  csr_set (CSR_SIE, MIP_SEIP);
+
+  DEBUG ((DEBUG_INFO, "%a: %d sources routed to context %d of hart %d\n",
+    __FUNCTION__, mPlicNumSources, mPlicContext, HartId));
+  return EFI_SUCCESS;
+
+CloseEvent:
+  gBS->CloseEvent (mExitBootServicesEvent);
+UnregisterHandler:
+  Cpu->RegisterInterruptHandler (Cpu, EXCEPT_RISCV_EXTERNAL_INT, NULL);
+FreeHandlers:
+  FreePool (mHandlers);
+  return Status;
+}
@@ -0,0 +1,51 @@
+/** @file
+  RISC-V PLIC DXE driver header file.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#ifndef PLIC_DXE_H_
+#define PLIC_DXE_H_
+
+#include <PiDxe.h>
+
+#include <Guid/EventGroup.h>
+#include <IndustryStandard/RiscVOpensbi.h>
+#include <Library/BaseLib.h>
+#include <Library/DebugLib.h>
+#include <Library/DxeServicesTableLib.h>
+#include <Library/IoLib.h>
+#include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/RiscVCpuLib.h>
+#include <Library/RiscVEdk2SbiLib.h>
+#include <Library/RiscVHartLocalDataLib.h>
+#include <Library/UefiBootServicesTableLib.h>
+#include <Protocol/Cpu.h>
+#include <Protocol/RiscVPlic.h>
+
+#include <sbi/riscv_asm.h>
+#include <sbi/riscv_encoding.h>
+
+//
+// PLIC register layout.
+//
+#define PLIC_PRIORITY_OFFSET          0x0
+#define PLIC_ENABLE_OFFSET            0x2000
+#define PLIC_ENABLE_CONTEXT_STRIDE    0x80
+#define PLIC_CONTEXT_OFFSET           0x200000
+#define PLIC_CONTEXT_STRIDE           0x1000
+#define PLIC_CONTEXT_THRESHOLD        0x0
+#define PLIC_CONTEXT_CLAIM            0x4
+
+#define PLIC_REGION_SIZE              0x4000000
+
+//
+// Priority set when a source with priority 0 is enabled.
+//
+#define PLIC_DEFAULT_PRIORITY         1
+
+#endif
@@ -285,6 +285,7 @@ RiscVSmbiosBuilderEntry (
   EFI_HOB_GUID_TYPE *GuidHob;
   RISC_V_PROCESSOR_TYPE4_HOB_DATA *Type4HobData;
   SMBIOS_HANDLE Processor;
+  VOID *Fdt;
 
   DEBUG ((DEBUG_INFO, "%a: entry\n", __FUNCTION__));
 
@@ -297,6 +298,25 @@ RiscVSmbiosBuilderEntry (
     DEBUG ((DEBUG_ERROR, "Locate SMBIOS Protocol fail\n"));
     return Status;
   }
+
+  //
+  // The platform doesn't build the processor HOBs when it publishes the
+  // device tree and asks for the records to be built from it.
+  //
+  if (FeaturePcdGet (PcdRiscVSmbiosFromDeviceTree)) {
+    GuidHob = GetFirstGuidHob (&gFdtHobGuid);
+    if (GuidHob != NULL) {
+      Fdt = (VOID *)(UINTN)*(UINT64 *)GET_GUID_HOB_DATA (GuidHob);
+      Status = RiscVSmbiosBuildFromFdt (mSmbios, Fdt);
+      if (EFI_ERROR (Status)) {
+        DEBUG ((DEBUG_ERROR, "No RISC-V SMBIOS records built from the device tree: %r\n", Status));
+        ASSERT (FALSE);
+      }
+      DEBUG ((DEBUG_INFO, "%a: exit\n", __FUNCTION__));
+      return Status;
+    }
+  }
+
   GuidHob = (EFI_HOB_GUID_TYPE *)GetFirstGuidHob ((EFI_GUID *)PcdGetPtr(PcdProcessorSmbiosType4GuidHobGuid));
   if (GuidHob == NULL) {
     DEBUG ((DEBUG_ERROR, "No RISC-V SMBIOS information found.\n"));
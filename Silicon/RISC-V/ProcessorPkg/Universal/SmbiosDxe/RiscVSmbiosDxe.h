@@ -11,13 +11,40 @@
 #define RISC_V_SMBIOS_DXE_H_
 
 #include <PiDxe.h>
+#include <Guid/FdtHob.h>
+#include <IndustryStandard/RiscV.h>
+#include <IndustryStandard/RiscVOpensbi.h>
 #include <Protocol/Smbios.h>
+#include <Library/BaseLib.h>
 #include <Library/BaseMemoryLib.h>
 #include <Library/DebugLib.h>
 #include <Library/HobLib.h>
 #include <Library/MemoryAllocationLib.h>
+#include <Library/PcdLib.h>
+#include <Library/RiscVEdk2SbiLib.h>
 #include <Library/UefiBootServicesTableLib.h>
 #include <ProcessorSpecificHobData.h>
 #include <SmbiosProcessorSpecificData.h>
+#include <libfdt.h>
+
+/**
+  Build the SMBIOS type 4, type 7 and type 44 records from the cpu nodes of
+  the device tree.
+
+  @param Smbios   The SMBIOS protocol.
+  @param Fdt      The device tree.
+
+  @retval EFI_SUCCESS           The records were added.
+  @retval EFI_NOT_FOUND         The device tree describes no enabled hart.
+  @retval EFI_OUT_OF_RESOURCES  The memory for the records couldn't be allocated.
+  @retval Others                A record couldn't be added.
+
+**/
+EFI_STATUS
+RiscVSmbiosBuildFromFdt (
+  IN EFI_SMBIOS_PROTOCOL  *Smbios,
+  IN CONST VOID           *Fdt
+  );
+
 #endif
 
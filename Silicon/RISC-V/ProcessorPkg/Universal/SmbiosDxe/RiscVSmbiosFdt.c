@@ -0,0 +1,744 @@
+/** @file
+  Build the RISC-V SMBIOS type 4, type 7 and type 44 records from the cpu
+  nodes of the device tree.
+
+  The cpu nodes are walked once. The harts and the distinct caches found on
+  the way are recorded, then one type 7 record is added per cache, one
+  type 4 record for the processor and one type 44 record per hart. Harts
+  with identical private caches share a single type 7 record which
+  describes all of them, caches referenced through next-level-cache are
+  recorded once no matter how many harts reference them.
+
+  Copyright (c) 2020, Hewlett Packard Enterprise Development LP. All rights reserved.<BR>
+
+  SPDX-License-Identifier: BSD-2-Clause-Patent
+
+**/
+
+#include "RiscVSmbiosDxe.h"
+
+#define RISC_V_SMBIOS_FDT_MAX_CACHES     8
+#define RISC_V_SMBIOS_FDT_MAX_CACHE_HOPS 3
+
+typedef struct {
+  INT32          Node;          // Node of a shared cache, -1 for a private cache of the harts.
+  UINT8          Level;
+  UINT8          Type;          // CACHE_TYPE_DATA
+  UINT32         Size;          // Size of one instance in bytes.
+  UINT32         Sets;
+  UINT32         BlockSize;
+  UINT32         Instances;
+  SMBIOS_HANDLE  Handle;
+} RISC_V_SMBIOS_FDT_CACHE;
+
+typedef struct {
+  UINT64         HartId;
+  CONST CHAR8    *Isa;
+} RISC_V_SMBIOS_FDT_HART;
+
+typedef struct {
+  CONST VOID               *Fdt;
+  CONST CHAR8              *Compatible;
+  UINTN                    HartCount;
+  RISC_V_SMBIOS_FDT_HART   *Harts;
+  UINTN                    CacheCount;
+  RISC_V_SMBIOS_FDT_CACHE  Caches[RISC_V_SMBIOS_FDT_MAX_CACHES];
+} RISC_V_SMBIOS_FDT_CONTEXT;
+
+/**
+  Read a 32-bit cell property of a node.
+
+  @param Fdt       The device tree.
+  @param Node      The node.
+  @param Name      The property name.
+  @param Default   The value returned when the property is absent.
+
+  @return The property value.
+
+**/
+STATIC
+UINT32
+FdtGetU32 (
+  IN CONST VOID   *Fdt,
+  IN INT32        Node,
+  IN CONST CHAR8  *Name,
+  IN UINT32       Default
+  )
+{
+  CONST fdt32_t  *Prop;
+  INT32          Len;
+
+  Prop = fdt_getprop (Fdt, Node, Name, &Len);
+  if (Prop == NULL || Len < (INT32)sizeof (*Prop)) {
+    return Default;
+  }
+  return fdt32_to_cpu (*Prop);
+}
+
+/**
+  Check whether a node is enabled.
+
+  @param Fdt       The device tree.
+  @param Node      The node.
+
+  @retval TRUE     The node has no status property or its status is okay.
+  @retval FALSE    The node is disabled.
+
+**/
+STATIC
+BOOLEAN
+FdtNodeIsEnabled (
+  IN CONST VOID   *Fdt,
+  IN INT32        Node
+  )
+{
+  CONST CHAR8  *Status;
+
+  Status = fdt_getprop (Fdt, Node, "status", NULL);
+  return (Status == NULL ||
+          AsciiStrCmp (Status, "okay") == 0 ||
+          AsciiStrCmp (Status, "ok") == 0);
+}
+
+/**
+  Record a cache, or account one more instance of an identical cache.
+
+  @param Context     The builder context.
+  @param Node        Node of a shared cache, -1 for a private cache.
+  @param Level       The cache level.
+  @param Type        The SMBIOS system cache type.
+  @param Size        The cache size in bytes.
+  @param Sets        The number of sets, 0 if unknown.
+  @param BlockSize   The cache block size in bytes, 0 if unknown.
+
+**/
+STATIC
+VOID
+RecordCache (
+  IN OUT RISC_V_SMBIOS_FDT_CONTEXT  *Context,
+  IN     INT32                      Node,
+  IN     UINT8                      Level,
+  IN     UINT8                      Type,
+  IN     UINT32                     Size,
+  IN     UINT32                     Sets,
+  IN     UINT32                     BlockSize
+  )
+{
+  RISC_V_SMBIOS_FDT_CACHE  *Cache;
+  UINTN                    Index;
+
+  if (Size == 0) {
+    return;
+  }
+  for (Index = 0; Index < Context->CacheCount; Index++) {
+    Cache = &Context->Caches[Index];
+    if (Node >= 0 && Cache->Node == Node) {
+      return;
+    }
+    if (Node < 0 && Cache->Node < 0 && Cache->Level == Level && Cache->Type == Type &&
+        Cache->Size == Size && Cache->Sets == Sets && Cache->BlockSize == BlockSize) {
+      Cache->Instances++;
+      return;
+    }
+  }
+  if (Context->CacheCount == RISC_V_SMBIOS_FDT_MAX_CACHES) {
+    DEBUG ((DEBUG_ERROR, "%a: Too many distinct caches, L%d cache ignored\n", __FUNCTION__, Level));
+    return;
+  }
+  Cache = &Context->Caches[Context->CacheCount++];
+  Cache->Node = Node;
+  Cache->Level = Level;
+  Cache->Type = Type;
+  Cache->Size = Size;
+  Cache->Sets = Sets;
+  Cache->BlockSize = BlockSize;
+  Cache->Instances = 1;
+  Cache->Handle = RISC_V_CACHE_INFO_NOT_PROVIDED;
+}
+
+/**
+  Record the caches described by a cpu node and the cache nodes it
+  references through next-level-cache.
+
+  @param Context   The builder context.
+  @param CpuNode   The cpu node.
+
+**/
+STATIC
+VOID
+RecordHartCaches (
+  IN OUT RISC_V_SMBIOS_FDT_CONTEXT  *Context,
+  IN     INT32                      CpuNode
+  )
+{
+  CONST VOID  *Fdt;
+  INT32       Node;
+  UINT32      Phandle;
+  UINT8       Level;
+  UINTN       Hop;
+
+  Fdt = Context->Fdt;
+  RecordCache (
+    Context, -1, 1, CacheTypeInstruction,
+    FdtGetU32 (Fdt, CpuNode, "i-cache-size", 0),
+    FdtGetU32 (Fdt, CpuNode, "i-cache-sets", 0),
+    FdtGetU32 (Fdt, CpuNode, "i-cache-block-size", 0)
+    );
+  RecordCache (
+    Context, -1, 1, CacheTypeData,
+    FdtGetU32 (Fdt, CpuNode, "d-cache-size", 0),
+    FdtGetU32 (Fdt, CpuNode, "d-cache-sets", 0),
+    FdtGetU32 (Fdt, CpuNode, "d-cache-block-size", 0)
+    );
+
+  Node = CpuNode;
+  Level = 1;
+  for (Hop = 0; Hop < RISC_V_SMBIOS_FDT_MAX_CACHE_HOPS; Hop++) {
+    Phandle = FdtGetU32 (Fdt, Node, "next-level-cache", 0);
+    if (Phandle == 0) {
+      break;
+    }
+    Node = fdt_node_offset_by_phandle (Fdt, Phandle);
+    if (Node < 0) {
+      break;
+    }
+    //
+    // Each hop goes at least one level further from the hart.
+    //
+    Level = (UINT8)MAX (FdtGetU32 (Fdt, Node, "cache-level", 0), (UINT32)Level + 1);
+    RecordCache (
+      Context, Node, Level, CacheTypeUnified,
+      FdtGetU32 (Fdt, Node, "cache-size", 0),
+      FdtGetU32 (Fdt, Node, "cache-sets", 0),
+      FdtGetU32 (Fdt, Node, "cache-block-size", 0)
+      );
+  }
+}
+
+/**
+  Walk the cpu nodes once and record the enabled harts and their caches.
+
+  @param Context   The builder context.
+
+  @retval EFI_SUCCESS           At least one hart was found.
+  @retval EFI_NOT_FOUND         The device tree describes no enabled hart.
+  @retval EFI_OUT_OF_RESOURCES  The hart array couldn't be allocated.
+
+**/
+STATIC
+EFI_STATUS
+ScanCpuNodes (
+  IN OUT RISC_V_SMBIOS_FDT_CONTEXT  *Context
+  )
+{
+  CONST VOID              *Fdt;
+  INT32                   Cpus;
+  INT32                   Node;
+  CONST CHAR8             *DeviceType;
+  CONST fdt32_t           *Reg;
+  INT32                   Len;
+  RISC_V_SMBIOS_FDT_HART  *Hart;
+
+  Fdt = Context->Fdt;
+  Cpus = fdt_path_offset (Fdt, "/cpus");
+  if (Cpus < 0) {
+    return EFI_NOT_FOUND;
+  }
+  Context->Harts = AllocateZeroPool (RISC_V_MAX_HART_SUPPORTED * sizeof (RISC_V_SMBIOS_FDT_HART));
+  if (Context->Harts == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  for (Node = fdt_first_subnode (Fdt, Cpus); Node >= 0; Node = fdt_next_subnode (Fdt, Node)) {
+    DeviceType = fdt_getprop (Fdt, Node, "device_type", NULL);
+    if (DeviceType == NULL || AsciiStrCmp (DeviceType, "cpu") != 0 || !FdtNodeIsEnabled (Fdt, Node)) {
+      continue;
+    }
+    Reg = fdt_getprop (Fdt, Node, "reg", &Len);
+    if (Reg == NULL || Len < (INT32)sizeof (*Reg)) {
+      continue;
+    }
+    if (Context->HartCount == RISC_V_MAX_HART_SUPPORTED) {
+      DEBUG ((DEBUG_ERROR, "%a: Too many harts, the others are ignored\n", __FUNCTION__));
+      break;
+    }
+
+    Hart = &Context->Harts[Context->HartCount++];
+    Hart->HartId = (Len >= (INT32)sizeof (UINT64)) ?
+                     fdt64_to_cpu (*(CONST fdt64_t *)Reg) : fdt32_to_cpu (*Reg);
+    Hart->Isa = fdt_getprop (Fdt, Node, "riscv,isa", NULL);
+    if (Context->Compatible == NULL) {
+      Context->Compatible = fdt_getprop (Fdt, Node, "compatible", NULL);
+    }
+    RecordHartCaches (Context, Node);
+  }
+
+  return (Context->HartCount == 0) ? EFI_NOT_FOUND : EFI_SUCCESS;
+}
+
+/**
+  Decode the register length and the single-letter extensions of a
+  riscv,isa string.
+
+  @param Isa                Pointer to the ISA string, may be NULL.
+  @param Extensions         Receives the extensions in the misa layout.
+
+  @return The register length. The register length of this firmware is
+          returned when the string is not valid.
+
+**/
+STATIC
+UINT8
+ParseIsaString (
+  IN  CONST CHAR8  *Isa,
+  OUT UINT32       *Extensions
+  )
+{
+  UINT8  Xlen;
+
+  *Extensions = 0;
+  Xlen = (sizeof (UINTN) == sizeof (UINT64)) ? RegisterLen64 : RegisterLen32;
+  if (Isa == NULL || AsciiStrnCmp (Isa, "rv", 2) != 0) {
+    return Xlen;
+  }
+  if (AsciiStrnCmp (Isa + 2, "32", 2) == 0) {
+    Xlen = RegisterLen32;
+  } else if (AsciiStrnCmp (Isa + 2, "64", 2) == 0) {
+    Xlen = RegisterLen64;
+  } else if (AsciiStrnCmp (Isa + 2, "128", 3) == 0) {
+    Xlen = RegisterLen128;
+  } else {
+    return Xlen;
+  }
+
+  for (Isa += 2; *Isa >= '0' && *Isa <= '9'; Isa++);
+  for (; *Isa >= 'a' && *Isa <= 'z'; Isa++) {
+    if (*Isa == 'g') {
+      *Extensions |= RISC_V_ISA_INTEGER_ISA_EXTENSION | RISC_V_ISA_INTEGER_MUL_DIV_EXTENSION |
+                     RISC_V_ISA_ATOMIC_EXTENSION | RISC_V_ISA_SINGLE_PRECISION_FP_EXTENSION |
+                     RISC_V_ISA_DOUBLE_PRECISION_FP_EXTENSION;
+    } else {
+      *Extensions |= (UINT32)1 << (*Isa - 'a');
+    }
+  }
+  return Xlen;
+}
+
+/**
+  Encode a cache size for the 16-bit size fields of SMBIOS type 7.
+
+  @param Size   The size in bytes.
+
+  @return The encoded size.
+
+**/
+STATIC
+UINT16
+SmbiosCacheSize (
+  IN UINT64  Size
+  )
+{
+  UINT64  SizeInKb;
+
+  SizeInKb = DivU64x32 (Size, SIZE_1KB);
+  if (SizeInKb < BIT15) {
+    return (UINT16)SizeInKb;
+  }
+  SizeInKb = DivU64x32 (SizeInKb, 64);
+  return (UINT16)(BIT15 | MIN (SizeInKb, BIT15 - 1));
+}
+
+/**
+  Translate the geometry of a cache to its SMBIOS associativity.
+
+  @param Cache   The cache.
+
+  @return The associativity.
+
+**/
+STATIC
+UINT8
+SmbiosCacheAssociativity (
+  IN RISC_V_SMBIOS_FDT_CACHE  *Cache
+  )
+{
+  UINT32  Ways;
+
+  if (Cache->Sets == 0 || Cache->BlockSize == 0) {
+    return CacheAssociativityUnknown;
+  }
+  if (Cache->Sets == 1) {
+    return CacheAssociativityFully;
+  }
+  Ways = Cache->Size / (Cache->Sets * Cache->BlockSize);
+  switch (Ways) {
+  case 1:  return CacheAssociativityDirectMapped;
+  case 2:  return CacheAssociativity2Way;
+  case 4:  return CacheAssociativity4Way;
+  case 8:  return CacheAssociativity8Way;
+  case 12: return CacheAssociativity12Way;
+  case 16: return CacheAssociativity16Way;
+  case 20: return CacheAssociativity20Way;
+  case 24: return CacheAssociativity24Way;
+  case 32: return CacheAssociativity32Way;
+  case 48: return CacheAssociativity48Way;
+  case 64: return CacheAssociativity64Way;
+  default: return CacheAssociativityOther;
+  }
+}
+
+/**
+  Add a record with one optional string to the SMBIOS table.
+
+  @param Smbios       The SMBIOS protocol.
+  @param Record       The formatted area of the record.
+  @param String       The string of the record, NULL for none.
+  @param Handle       Receives the handle of the record.
+
+  @retval EFI_SUCCESS           The record was added.
+  @retval EFI_OUT_OF_RESOURCES  The record couldn't be allocated.
+  @retval Others                The SMBIOS protocol failed to add the record.
+
+**/
+STATIC
+EFI_STATUS
+AddSmbiosRecord (
+  IN  EFI_SMBIOS_PROTOCOL       *Smbios,
+  IN  SMBIOS_STRUCTURE          *Record,
+  IN  CONST CHAR8               *String,
+  OUT SMBIOS_HANDLE             *Handle
+  )
+{
+  EFI_STATUS        Status;
+  SMBIOS_STRUCTURE  *Buffer;
+  UINTN             StringSize;
+
+  //
+  // The string area ends with two zero bytes, also when there's no string.
+  //
+  StringSize = (String != NULL) ? AsciiStrSize (String) : 1;
+  Buffer = AllocateZeroPool (Record->Length + StringSize + 1);
+  if (Buffer == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  CopyMem (Buffer, Record, Record->Length);
+  if (String != NULL) {
+    CopyMem ((UINT8 *)Buffer + Record->Length, String, StringSize);
+  }
+
+  *Handle = SMBIOS_HANDLE_PI_RESERVED;
+  Status = Smbios->Add (Smbios, NULL, Handle, Buffer);
+  FreePool (Buffer);
+  return Status;
+}
+
+/**
+  Add the SMBIOS type 7 record of every recorded cache.
+
+  @param Smbios    The SMBIOS protocol.
+  @param Context   The builder context.
+
+  @retval EFI_SUCCESS   The records were added.
+  @retval Others        A record couldn't be added.
+
+**/
+STATIC
+EFI_STATUS
+AddCacheRecords (
+  IN     EFI_SMBIOS_PROTOCOL        *Smbios,
+  IN OUT RISC_V_SMBIOS_FDT_CONTEXT  *Context
+  )
+{
+  STATIC CONST CHAR8 *CONST  Designation[] = {
+    "L1 Instruction Cache", "L1 Data Cache", "L2 Cache", "L3 Cache"
+  };
+  EFI_STATUS               Status;
+  RISC_V_SMBIOS_FDT_CACHE  *Cache;
+  SMBIOS_TABLE_TYPE7       Type7;
+  UINT64                   TotalSize;
+  UINTN                    Index;
+  UINTN                    Name;
+
+  for (Index = 0; Index < Context->CacheCount; Index++) {
+    Cache = &Context->Caches[Index];
+    TotalSize = MultU64x32 (Cache->Size, Cache->Instances);
+
+    ZeroMem (&Type7, sizeof (Type7));
+    Type7.Hdr.Type = SMBIOS_TYPE_CACHE_INFORMATION;
+    Type7.Hdr.Length = sizeof (SMBIOS_TABLE_TYPE7);
+    Type7.SocketDesignation = 1;
+    //
+    // Bits 2:0 hold the cache level minus one.
+    //
+    Type7.CacheConfiguration = (UINT16)((Cache->Level - 1) & RISC_V_CACHE_CONFIGURATION_CACHE_LEVEL_MASK) |
+                                 RISC_V_CACHE_CONFIGURATION_LOCATION_INTERNAL |
+                                 RISC_V_CACHE_CONFIGURATION_ENABLED |
+                                 RISC_V_CACHE_CONFIGURATION_MODE_UNKNOWN;
+    Type7.MaximumCacheSize = SmbiosCacheSize (TotalSize);
+    Type7.InstalledSize = Type7.MaximumCacheSize;
+    Type7.SupportedSRAMType.Unknown = 1;
+    Type7.CurrentSRAMType.Unknown = 1;
+    Type7.ErrorCorrectionType = CacheErrorUnknown;
+    Type7.SystemCacheType = Cache->Type;
+    Type7.Associativity = SmbiosCacheAssociativity (Cache);
+
+    if (Cache->Level == 1) {
+      Name = (Cache->Type == CacheTypeInstruction) ? 0 : 1;
+    } else {
+      Name = MIN (Cache->Level, 3);
+    }
+    Status = AddSmbiosRecord (Smbios, &Type7.Hdr, Designation[Name], &Cache->Handle);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a: Fail to add SMBIOS Type 7\n", __FUNCTION__));
+      return Status;
+    }
+    DEBUG ((DEBUG_INFO, "SMBIOS Type 7 was added. SMBIOS Handle: 0x%x\n", Cache->Handle));
+    DEBUG ((DEBUG_VERBOSE, "     %a, %d instance(s) of %d bytes\n", Designation[Name], Cache->Instances, Cache->Size));
+  }
+  return EFI_SUCCESS;
+}
+
+/**
+  Find the handle of the type 7 record which describes a cache level for the
+  type 4 record. The data cache represents the level 1 caches when the
+  harts have split level 1 caches.
+
+  @param Context   The builder context.
+  @param Level     The cache level.
+
+  @return The handle, RISC_V_CACHE_INFO_NOT_PROVIDED if there is no cache
+          of that level.
+
+**/
+STATIC
+SMBIOS_HANDLE
+CacheHandleOfLevel (
+  IN RISC_V_SMBIOS_FDT_CONTEXT  *Context,
+  IN UINT8                      Level
+  )
+{
+  SMBIOS_HANDLE  Handle;
+  UINTN          Index;
+
+  Handle = RISC_V_CACHE_INFO_NOT_PROVIDED;
+  for (Index = 0; Index < Context->CacheCount; Index++) {
+    if (Context->Caches[Index].Level != Level) {
+      continue;
+    }
+    Handle = Context->Caches[Index].Handle;
+    if (Context->Caches[Index].Type != CacheTypeInstruction) {
+      break;
+    }
+  }
+  return Handle;
+}
+
+/**
+  Add the SMBIOS type 4 record of the processor.
+
+  @param Smbios    The SMBIOS protocol.
+  @param Context   The builder context.
+  @param Xlen      The register length of the harts.
+  @param Handle    Receives the handle of the record.
+
+  @retval EFI_SUCCESS   The record was added.
+  @retval Others        The record couldn't be added.
+
+**/
+STATIC
+EFI_STATUS
+AddProcessorRecord (
+  IN  EFI_SMBIOS_PROTOCOL        *Smbios,
+  IN  RISC_V_SMBIOS_FDT_CONTEXT  *Context,
+  IN  UINT8                      Xlen,
+  OUT SMBIOS_HANDLE              *Handle
+  )
+{
+  EFI_STATUS          Status;
+  SMBIOS_TABLE_TYPE4  Type4;
+  UINT8               Count;
+
+  ZeroMem (&Type4, sizeof (Type4));
+  Type4.Hdr.Type = SMBIOS_TYPE_PROCESSOR_INFORMATION;
+  Type4.Hdr.Length = sizeof (SMBIOS_TABLE_TYPE4);
+  Type4.ProcessorType = CentralProcessor;
+  Type4.ProcessorFamily = ProcessorFamilyIndicatorFamily2;
+  Type4.ProcessorVersion = (Context->Compatible != NULL) ? 1 : 0;
+  Type4.Voltage.ProcessorVoltageCapability3_3V = 1;
+  Type4.Status = BIT6 | 1;      // Socket populated, CPU enabled
+  Type4.ProcessorUpgrade = ProcessorUpgradeNone;
+  Type4.L1CacheHandle = CacheHandleOfLevel (Context, 1);
+  Type4.L2CacheHandle = CacheHandleOfLevel (Context, 2);
+  Type4.L3CacheHandle = CacheHandleOfLevel (Context, 3);
+
+  Count = (UINT8)MIN (Context->HartCount, 0xFF);
+  Type4.CoreCount = Count;
+  Type4.EnabledCoreCount = Count;
+  Type4.ThreadCount = Count;
+  Type4.CoreCount2 = (UINT16)Context->HartCount;
+  Type4.EnabledCoreCount2 = (UINT16)Context->HartCount;
+  Type4.ThreadCount2 = (UINT16)Context->HartCount;
+  if (Xlen == RegisterLen64 || Xlen == RegisterLen128) {
+    Type4.ProcessorCharacteristics = (UINT16)(1 << 2); // 64-bit capable
+  }
+  Type4.ProcessorFamily2 = (UINT16)(ProcessorFamilyRiscvRV32 + Xlen - RegisterLen32);
+
+  Status = AddSmbiosRecord (Smbios, &Type4.Hdr, Context->Compatible, Handle);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Fail to add SMBIOS Type 4\n"));
+    return Status;
+  }
+  DEBUG ((DEBUG_INFO, "SMBIOS Type 4 was added. SMBIOS Handle: 0x%x\n", *Handle));
+  DEBUG ((DEBUG_VERBOSE, "     Core Count: %d\n", Context->HartCount));
+  DEBUG ((DEBUG_VERBOSE, "     L1 Cache Handle: 0x%x\n", Type4.L1CacheHandle));
+  DEBUG ((DEBUG_VERBOSE, "     L2 Cache Handle: 0x%x\n", Type4.L2CacheHandle));
+  DEBUG ((DEBUG_VERBOSE, "     L3 Cache Handle: 0x%x\n", Type4.L3CacheHandle));
+  return EFI_SUCCESS;
+}
+
+/**
+  Add the SMBIOS type 44 record of a hart.
+
+  The machine-mode information comes from the firmware context hart-specific
+  data kept below the OpenSBI scratch space of the hart, the ISA string of
+  the device tree is used when the hart has no scratch space.
+
+  @param Smbios        The SMBIOS protocol.
+  @param Hart          The hart.
+  @param ThisScratch   The OpenSBI scratch space of the boot hart.
+  @param Type4Handle   The handle of the type 4 record.
+
+  @retval EFI_SUCCESS           The record was added.
+  @retval EFI_OUT_OF_RESOURCES  The record couldn't be allocated.
+  @retval Others                The record couldn't be added.
+
+**/
+STATIC
+EFI_STATUS
+AddHartRecord (
+  IN EFI_SMBIOS_PROTOCOL     *Smbios,
+  IN RISC_V_SMBIOS_FDT_HART  *Hart,
+  IN SBI_SCRATCH             *ThisScratch,
+  IN SMBIOS_HANDLE           Type4Handle
+  )
+{
+  EFI_STATUS                                Status;
+  SMBIOS_TABLE_TYPE44                       *Type44;
+  SMBIOS_RISC_V_PROCESSOR_SPECIFIC_DATA     *Data;
+  SBI_SCRATCH                               *Scratch;
+  EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC  *HartSpecific;
+  SMBIOS_HANDLE                             Handle;
+  UINT32                                    Extensions;
+  UINT8                                     Xlen;
+
+  Type44 = AllocateZeroPool (sizeof (SMBIOS_TABLE_TYPE44) + sizeof (SMBIOS_RISC_V_PROCESSOR_SPECIFIC_DATA) + 2); // Two ending zero.
+  if (Type44 == NULL) {
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Xlen = ParseIsaString (Hart->Isa, &Extensions);
+
+  Type44->Hdr.Type = SMBIOS_TYPE_PROCESSOR_ADDITIONAL_INFORMATION;
+  Type44->Hdr.Length = sizeof (SMBIOS_TABLE_TYPE44) + sizeof (SMBIOS_RISC_V_PROCESSOR_SPECIFIC_DATA);
+  Type44->RefHandle = Type4Handle;
+  Type44->ProcessorSpecificBlock.Length = sizeof (SMBIOS_RISC_V_PROCESSOR_SPECIFIC_DATA);
+  Type44->ProcessorSpecificBlock.ProcessorArchType = (UINT8)(ProcessorSpecificBlockArchTypeRiscVRV32 + Xlen - RegisterLen32);
+
+  Data = (SMBIOS_RISC_V_PROCESSOR_SPECIFIC_DATA *)(Type44 + 1);
+  Data->Revision = SMBIOS_RISC_V_PROCESSOR_SPECIFIC_DATA_REVISION;
+  Data->Length = sizeof (SMBIOS_RISC_V_PROCESSOR_SPECIFIC_DATA);
+  Data->HartId.Value64_L = Hart->HartId;
+
+  SbiGetMscratchHartid (Hart->HartId, &Scratch);
+  if (Scratch != NULL) {
+    HartSpecific = (EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC *)((UINT8 *)Scratch - FIRMWARE_CONTEXT_HART_SPECIFIC_SIZE);
+    Data->BootHartId = (UINT8)(Scratch == ThisScratch);
+    Extensions = (UINT32)HartSpecific->IsaExtensionSupported;
+    Data->MachineVendorId = HartSpecific->MachineVendorId;
+    Data->MachineArchId = HartSpecific->MachineArchId;
+    Data->MachineImplId = HartSpecific->MachineImplId;
+  }
+  Data->InstSetSupported = Extensions;
+  Data->PrivilegeModeSupported = SMBIOS_RISC_V_PSD_MACHINE_MODE_SUPPORTED;
+  Data->HartXlen = Xlen;
+  Data->MachineModeXlen = Xlen;
+  Data->SupervisorModeXlen = RegisterUnsupported;
+  Data->UserModeXlen = RegisterUnsupported;
+  if ((Extensions & RISC_V_ISA_SUPERVISOR_MODE_IMPLEMENTED) != 0) {
+    Data->PrivilegeModeSupported |= SMBIOS_RISC_V_PSD_SUPERVISOR_MODE_SUPPORTED;
+    Data->SupervisorModeXlen = Xlen;
+  }
+  if ((Extensions & RISC_V_ISA_USER_MODE_IMPLEMENTED) != 0) {
+    Data->PrivilegeModeSupported |= SMBIOS_RISC_V_PSD_USER_MODE_SUPPORTED;
+    Data->UserModeXlen = Xlen;
+  }
+
+  Handle = SMBIOS_HANDLE_PI_RESERVED;
+  Status = Smbios->Add (Smbios, NULL, &Handle, &Type44->Hdr);
+  FreePool (Type44);
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Fail to add SMBIOS Type 44\n"));
+    return Status;
+  }
+  DEBUG ((DEBUG_INFO, "SMBIOS Type 44 of hart %ld was added. SMBIOS Handle: 0x%x\n", Hart->HartId, Handle));
+  return EFI_SUCCESS;
+}
+
+/**
+  Build the SMBIOS type 4, type 7 and type 44 records from the cpu nodes of
+  the device tree.
+
+  @param Smbios   The SMBIOS protocol.
+  @param Fdt      The device tree.
+
+  @retval EFI_SUCCESS           The records were added.
+  @retval EFI_NOT_FOUND         The device tree describes no enabled hart.
+  @retval EFI_OUT_OF_RESOURCES  The memory for the records couldn't be allocated.
+  @retval Others                A record couldn't be added.
+
+**/
+EFI_STATUS
+RiscVSmbiosBuildFromFdt (
+  IN EFI_SMBIOS_PROTOCOL  *Smbios,
+  IN CONST VOID           *Fdt
+  )
+{
+  EFI_STATUS                 Status;
+  RISC_V_SMBIOS_FDT_CONTEXT  Context;
+  SBI_SCRATCH                *ThisScratch;
+  SMBIOS_HANDLE              Processor;
+  UINT32                     Extensions;
+  UINT8                      Xlen;
+  UINTN                      Index;
+
+  ZeroMem (&Context, sizeof (Context));
+  Context.Fdt = Fdt;
+  Status = ScanCpuNodes (&Context);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+  DEBUG ((DEBUG_INFO, "%a: %d harts, %d distinct caches\n", __FUNCTION__, Context.HartCount, Context.CacheCount));
+
+  Status = AddCacheRecords (Smbios, &Context);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+  Xlen = ParseIsaString (Context.Harts[0].Isa, &Extensions);
+  Status = AddProcessorRecord (Smbios, &Context, Xlen, &Processor);
+  if (EFI_ERROR (Status)) {
+    goto Exit;
+  }
+
+  SbiGetMscratch (&ThisScratch);
+  for (Index = 0; Index < Context.HartCount; Index++) {
+    Status = AddHartRecord (Smbios, &Context.Harts[Index], ThisScratch, Processor);
+    if (EFI_ERROR (Status)) {
+      break;
+    }
+  }
+
+Exit:
+  if (Context.Harts != NULL) {
+    FreePool (Context.Harts);
+  }
+  return Status;
+}
@@ -54,8 +54,8 @@ CreateU54E51CoreProcessorSpecificDataHob (
   RISC_V_PROCESSOR_SPECIFIC_HOB_DATA *CoreGuidHob;
   EFI_GUID *ProcessorSpecDataHobGuid;
   RISC_V_PROCESSOR_SPECIFIC_HOB_DATA ProcessorSpecDataHob;
-  EFI_RISCV_OPENSBI_FIRMWARE_CONTEXT *FirmwareContext;
   EFI_RISCV_FIRMWARE_CONTEXT_HART_SPECIFIC *FirmwareContextHartSpecific;
+  EFI_STATUS Status;
 
   DEBUG ((DEBUG_INFO, "%a: Entry.\n", __FUNCTION__));
 
@@ -63,20 +63,17 @@ CreateU54E51CoreProcessorSpecificDataHob (
     return EFI_INVALID_PARAMETER;
   }
 
-  SbiGetFirmwareContext (&FirmwareContext);
-  ASSERT (FirmwareContext != NULL);
-  if (FirmwareContext == NULL) {
-    DEBUG ((DEBUG_ERROR, "Failed to get the pointer of EFI_RISCV_OPENSBI_FIRMWARE_CONTEXT of hart %d\n", HartId));
-    return EFI_NOT_FOUND;
-  }
-  DEBUG ((DEBUG_INFO, "    Firmware Context is at 0x%x.\n", FirmwareContext));
-
-  FirmwareContextHartSpecific = FirmwareContext->HartSpecific[HartId];
-  DEBUG ((DEBUG_INFO, "    Firmware Context Hart specific is at 0x%x.\n", FirmwareContextHartSpecific));
-  if (FirmwareContextHartSpecific == NULL) {
+  Status = GetFirmwareContextHartSpecific (HartId, &FirmwareContextHartSpecific);
+  if (Status == EFI_UNSUPPORTED) {
     DEBUG ((DEBUG_INFO, "    This hart: %d is ignored by platform.\n", HartId));
     return EFI_UNSUPPORTED;
   }
+  if (EFI_ERROR (Status)) {
+    DEBUG ((DEBUG_ERROR, "Failed to get the firmware context hart-specific data of hart %d\n", HartId));
+    ASSERT (FALSE);
+    return EFI_NOT_FOUND;
+  }
+  DEBUG ((DEBUG_INFO, "    Firmware Context Hart specific is at 0x%x.\n", FirmwareContextHartSpecific));
   //
   // Build up RISC_V_PROCESSOR_SPECIFIC_HOB_DATA.
   //
@@ -50,6 +50,10 @@ STATIC CONST CSDC_DEFINITION mN25qCSDCDefTable[] = {
   // Read Operations
   { SPINOR_OP_READ_4B,  TRUE,  TRUE,  FALSE, FALSE, CS_CFG_MBM_SINGLE,
                         CSDC_TRP_SINGLE },
+  // Quad output fast read, 8 dummy clocks between the address and the data
+  { SPINOR_OP_READ_1_1_4_4B,
+                        TRUE,  TRUE,  TRUE,  FALSE, CS_CFG_MBM_QUAD,
+                        CSDC_TRP_SINGLE },
   // Write Operations
   { SPINOR_OP_PP,       TRUE,  FALSE, FALSE, TRUE,  CS_CFG_MBM_SINGLE,
                         CSDC_TRP_SINGLE },
@@ -107,9 +111,16 @@ STATIC CONST NOR_FLASH_INSTANCE mNorFlashInstanceTemplate = {
       { sizeof (EFI_DEVICE_PATH_PROTOCOL), 0 }
     }
   }, // DevicePath
-  0 // Flags
+  0, // Flags
+  SPINOR_OP_READ_4B // ReadCommand
 };
 
+STATIC
+VOID
+NorFlashSetReadMode (
+  IN  NOR_FLASH_INSTANCE    *Instance
+  );
+
 EFI_STATUS
 NorFlashCreateInstance (
   IN UINTN                  HostRegisterBase,
@@ -162,6 +173,16 @@ NorFlashCreateInstance (
     Instance->Flags = NOR_FLASH_POLL_FSR;
   }
 
+  //
+  // The flash has been identified with the single line read set up by the
+  // reset, switch the memory mapped window over to the quad output fast read
+  // if the platform has the quad lines wired up and enabled on the part.
+  //
+  if (FeaturePcdGet (PcdFip006DxeQuadRead)) {
+    Instance->ReadCommand = SPINOR_OP_READ_1_1_4_4B;
+  }
+  NorFlashSetReadMode (Instance);
+
   Instance->ShadowBuffer = AllocateRuntimePool (BlockSize);
   if (Instance->ShadowBuffer == NULL) {
     Status = EFI_OUT_OF_RESOURCES;
@@ -197,9 +218,28 @@ NorFlashSetHostCSDC (
   for (Index = 0; Index < ARRAY_SIZE (mFip006NullCmdSeq); Index++) {
     MmioWrite16 (Dst + (Index << 1), CSDC[Index]);
   }
+  Instance->Flags &= ~NOR_FLASH_READ_MODE;
   return EFI_SUCCESS;
 }
 
+STATIC
+VOID
+NorFlashSetMemoryBusMode (
+  IN  NOR_FLASH_INSTANCE    *Instance,
+  IN  UINT8                 Mbm
+  )
+{
+  FIP006_CS_CFG         CsCfg;
+
+  CsCfg.Raw = MmioRead32 (Instance->HostRegisterBaseAddress +
+                          FIP006_REG_CS_CFG);
+  if (CsCfg.Reg.MBM != Mbm) {
+    CsCfg.Reg.MBM = Mbm;
+    MmioWrite32 (Instance->HostRegisterBaseAddress + FIP006_REG_CS_CFG,
+                 CsCfg.Raw);
+  }
+}
+
 STATIC
 CONST CSDC_DEFINITION *
 NorFlashGetCmdDef (
@@ -284,10 +324,42 @@ NorFlashSetHostCommand (
       Cmd->CsdcTrp,
       CSDC
       );
+  NorFlashSetMemoryBusMode (Instance, Cmd->CscfgMbm);
   NorFlashSetHostCSDC (Instance, Cmd->ReadWrite, CSDC);
   return EFI_SUCCESS;
 }
 
+/**
+  Put the memory mapped window back into read mode: the read command of the
+  instance on the read side and the null sequence on the write side. This is
+  the state the controller is left in between operations, so the read path
+  only needs to reprogram the sequencer after something else changed it.
+**/
+STATIC
+VOID
+NorFlashSetReadMode (
+  IN  NOR_FLASH_INSTANCE    *Instance
+  )
+{
+  NorFlashSetHostCommand (Instance, Instance->ReadCommand);
+  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  Instance->Flags |= NOR_FLASH_READ_MODE;
+}
+
+//
+// Raw commands are written into the window as data through the null write
+// sequence, so the data phase must be on a single line.
+//
+STATIC
+VOID
+NorFlashSetRawCommandMode (
+  IN  NOR_FLASH_INSTANCE    *Instance
+  )
+{
+  NorFlashSetMemoryBusMode (Instance, CS_CFG_MBM_SINGLE);
+  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+}
+
 STATIC
 UINT8
 NorFlashReadStatusRegister (
@@ -298,7 +370,6 @@ NorFlashReadStatusRegister (
 
   NorFlashSetHostCommand (Instance, SPINOR_OP_RDSR);
   StatusRegister = MmioRead8 (Instance->RegionBaseAddress);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
   return StatusRegister;
 }
 
@@ -322,7 +393,6 @@ NorFlashWaitProgramErase (
                    SPINOR_FSR_READY) != 0;
     }
   } while (!SRegDone || !FSRegDone);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
   return EFI_SUCCESS;
 }
 
@@ -381,7 +451,7 @@ NorFlashEnableWrite (
   Status = EFI_DEVICE_ERROR;
   Retry = NOR_FLASH_ERASE_RETRY;
 
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  NorFlashSetRawCommandMode (Instance);
   while (Retry > 0 && EFI_ERROR (Status)) {
     MmioWrite8 (Instance->RegionBaseAddress, SPINOR_OP_WREN);
     MemoryFence ();
@@ -407,7 +477,7 @@ NorFlashDisableWrite (
   Status = EFI_DEVICE_ERROR;
   Retry = NOR_FLASH_ERASE_RETRY;
 
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  NorFlashSetRawCommandMode (Instance);
   while (Retry > 0 && EFI_ERROR (Status)) {
     MmioWrite8 (Instance->RegionBaseAddress, SPINOR_OP_WRDIS);
     MemoryFence ();
@@ -428,11 +498,13 @@ NorFlashEraseSingleBlock (
   IN UINTN                  BlockAddress
   )
 {
+  EFI_STATUS            Status;
 
   DEBUG ((DEBUG_BLKIO, "NorFlashEraseSingleBlock(BlockAddress=0x%08x)\n",
     BlockAddress));
 
   if (EFI_ERROR (NorFlashEnableWrite (Instance))) {
+    NorFlashSetReadMode (Instance);
     return EFI_DEVICE_ERROR;
   }
 
@@ -446,16 +518,17 @@ NorFlashEraseSingleBlock (
   BlockAddress -= Instance->RegionBaseAddress;
   BlockAddress += Instance->OffsetLba * Instance->BlockSize;
 
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  NorFlashSetRawCommandMode (Instance);
   MmioWrite32 (Instance->DeviceBaseAddress,
                SwapBytes32 (BlockAddress & 0x00FFFFFF) | SPINOR_OP_SE);
   NorFlashWaitProgramErase (Instance);
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
 
+  Status = EFI_SUCCESS;
   if (EFI_ERROR (NorFlashDisableWrite (Instance))) {
-    return EFI_DEVICE_ERROR;
+    Status = EFI_DEVICE_ERROR;
   }
-  return EFI_SUCCESS;
+  NorFlashSetReadMode (Instance);
+  return Status;
 }
 
 /**
@@ -496,31 +569,55 @@ NorFlashUnlockAndEraseSingleBlock (
   return Status;
 }
 
-STATIC
+/**
+  Program a word aligned buffer. Every word is a page program of its own, as
+  the command sequencer issues one program command per bus write. The words
+  which are all ones are skipped since programming them would not change the
+  erased state, which leaves most of a freshly erased block untouched.
+
+  The target must have been unlocked, and erased unless bits are only cleared.
+**/
 EFI_STATUS
-NorFlashWriteSingleWord (
+NorFlashWriteBuffer (
   IN NOR_FLASH_INSTANCE     *Instance,
-  IN UINTN                  WordAddress,
-  IN UINT32                 WriteData
+  IN UINTN                  TargetAddress,
+  IN UINTN                  BufferSizeInBytes,
+  IN UINT32                 *Buffer
   )
 {
   EFI_STATUS            Status;
+  UINTN                 Index;
 
   DEBUG ((DEBUG_BLKIO,
-    "NorFlashWriteSingleWord(WordAddress=0x%08x, WriteData=0x%08x)\n",
-    WordAddress, WriteData));
+    "NorFlashWriteBuffer(TargetAddress=0x%08x, BufferSizeInBytes=0x%x)\n",
+    TargetAddress, BufferSizeInBytes));
+
+  ASSERT ((TargetAddress % sizeof (UINT32)) == 0);
+  ASSERT ((BufferSizeInBytes % sizeof (UINT32)) == 0);
 
   Status = EFI_SUCCESS;
+  for (Index = 0;
+       Index < BufferSizeInBytes / sizeof (UINT32);
+       Index++, TargetAddress += sizeof (UINT32)) {
+    if (Buffer[Index] == MAX_UINT32) {
+      continue;
+    }
 
-  if (EFI_ERROR (NorFlashEnableWrite (Instance))) {
-    return EFI_DEVICE_ERROR;
+    if (EFI_ERROR (NorFlashEnableWrite (Instance))) {
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+    NorFlashSetHostCommand (Instance, SPINOR_OP_PP);
+    MmioWrite32 (TargetAddress, Buffer[Index]);
+
+    //
+    // The write enable latch is cleared by the device once the program is
+    // done, no need to disable writes again.
+    //
+    NorFlashWaitProgramErase (Instance);
   }
-  NorFlashSetHostCommand (Instance, SPINOR_OP_PP);
-  MmioWrite32 (WordAddress, WriteData);
-  NorFlashWaitProgramErase (Instance);
 
-  NorFlashDisableWrite (Instance);
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  NorFlashSetReadMode (Instance);
   return Status;
 }
 
@@ -534,8 +631,6 @@ NorFlashWriteFullBlock (
   )
 {
   EFI_STATUS              Status;
-  UINTN                   WordAddress;
-  UINT32                  WordIndex;
   UINTN                   BlockAddress;
   NOR_FLASH_LOCK_CONTEXT  Lock;
 
@@ -545,9 +640,6 @@ NorFlashWriteFullBlock (
   BlockAddress = GET_NOR_BLOCK_ADDRESS (Instance->RegionBaseAddress, Lba,
                    BlockSizeInWords * 4);
 
-  // Start writing from the first address at the start of the block
-  WordAddress = BlockAddress;
-
   NorFlashLock (&Lock);
 
   Status = NorFlashUnlockAndEraseSingleBlock (Instance, BlockAddress);
@@ -558,14 +650,8 @@ NorFlashWriteFullBlock (
     goto EXIT;
   }
 
-  for (WordIndex=0;
-       WordIndex < BlockSizeInWords;
-       WordIndex++, DataBuffer++, WordAddress += 4) {
-    Status = NorFlashWriteSingleWord (Instance, WordAddress, *DataBuffer);
-    if (EFI_ERROR (Status)) {
-      goto EXIT;
-    }
-  }
+  Status = NorFlashWriteBuffer (Instance, BlockAddress, BlockSizeInWords * 4,
+             DataBuffer);
 
 EXIT:
   NorFlashUnlock (&Lock);
@@ -573,7 +659,7 @@ EXIT:
   if (EFI_ERROR (Status)) {
     DEBUG ((DEBUG_ERROR,
       "NOR FLASH Programming [WriteSingleBlock] failed at address 0x%08x. Exit Status = \"%r\".\n",
-      WordAddress, Status));
+      BlockAddress, Status));
   }
   return Status;
 }
@@ -697,9 +783,10 @@ NorFlashReadBlocks (
   StartAddress = GET_NOR_BLOCK_ADDRESS (Instance->RegionBaseAddress, Lba,
                                         Instance->BlockSize);
 
-  // Put the device into Read Array mode
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  // Put the device into Read Array mode, unless it is still in it
+  if ((Instance->Flags & NOR_FLASH_READ_MODE) == 0) {
+    NorFlashSetReadMode (Instance);
+  }
 
   // Readout the data
   CopyMem(Buffer, (UINTN *)StartAddress, BufferSizeInBytes);
@@ -739,9 +826,10 @@ NorFlashRead (
   StartAddress = GET_NOR_BLOCK_ADDRESS (Instance->RegionBaseAddress, Lba,
                                         Instance->BlockSize);
 
-  // Put the device into Read Array mode
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  // Put the device into Read Array mode, unless it is still in it
+  if ((Instance->Flags & NOR_FLASH_READ_MODE) == 0) {
+    NorFlashSetReadMode (Instance);
+  }
 
   // Readout the data
   CopyMem (Buffer, (UINTN *)(StartAddress + Offset), BufferSizeInBytes);
@@ -922,7 +1010,12 @@ NorFlashWriteSingleBlock (
         }
         PrevBlockAddress = BlockAddress;
       }
-      TempStatus = NorFlashWriteSingleWord (Instance, WordAddr, WordToWrite);
+      // Words which already hold the data need no programming
+      if (WordToWrite == Tmp) {
+        continue;
+      }
+      TempStatus = NorFlashWriteBuffer (Instance, WordAddr,
+                     sizeof (WordToWrite), &WordToWrite);
       if (EFI_ERROR (TempStatus)) {
         return EFI_DEVICE_ERROR;
       }
@@ -976,8 +1069,7 @@ NorFlashReset (
   CsCfg.Reg.SRAM = CS_CFG_SRAM_RW;
   MmioWrite32 (Instance->HostRegisterBaseAddress + FIP006_REG_CS_CFG,
                CsCfg.Raw);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
-  NorFlashSetHostCSDC (Instance, TRUE, mFip006NullCmdSeq);
+  NorFlashSetReadMode (Instance);
   return EFI_SUCCESS;
 }
 
@@ -995,6 +1087,6 @@ NorFlashReadID (
   JedecId[0] = MmioRead8 (Instance->DeviceBaseAddress);
   JedecId[1] = MmioRead8 (Instance->DeviceBaseAddress + 1);
   JedecId[2] = MmioRead8 (Instance->DeviceBaseAddress + 2);
-  NorFlashSetHostCommand (Instance, SPINOR_OP_READ_4B);
+  NorFlashSetReadMode (Instance);
   return EFI_SUCCESS;
 }
@@ -105,6 +105,9 @@ struct _NOR_FLASH_INSTANCE {
 
   UINT32                              Flags;
 #define NOR_FLASH_POLL_FSR      BIT0
+#define NOR_FLASH_READ_MODE     BIT1  // window set up for memory mapped reads
+
+  UINT8                               ReadCommand;
 };
 
 typedef struct {
@@ -262,6 +262,27 @@ Fail:
   return ErrorStatus;
 }
 
+/*
+ *  Reset the statistics kept by the driver, the counters it doesn't
+ *  keep read as all ones.
+ */
+STATIC
+VOID
+NetsecResetStatistics (
+  IN  NETSEC_DRIVER   *LanDriver
+  )
+{
+  SetMem (&LanDriver->Stats, sizeof (LanDriver->Stats), 0xFF);
+
+  LanDriver->Stats.RxTotalFrames = 0;
+  LanDriver->Stats.RxGoodFrames = 0;
+  LanDriver->Stats.RxDroppedFrames = 0;
+  LanDriver->Stats.RxTotalBytes = 0;
+  LanDriver->Stats.TxTotalFrames = 0;
+  LanDriver->Stats.TxGoodFrames = 0;
+  LanDriver->Stats.TxTotalBytes = 0;
+}
+
 /*
  *  UEFI Initialize() function
  */
@@ -329,6 +350,9 @@ SnpInitialize (
   ogma_clear_desc_ring_irq_status (LanDriver->Handle, OGMA_DESC_RING_ID_NRM_TX,
                                    OGMA_CH_IRQ_REG_EMPTY);
 
+  LanDriver->RxPending = 0;
+  NetsecResetStatistics (LanDriver);
+
   // Start the RX queue
   ogma_err = ogma_start_desc_ring (LanDriver->Handle, OGMA_DESC_RING_ID_NRM_RX);
   if (ogma_err != OGMA_ERR_OK) {
@@ -593,6 +617,81 @@ ExitUnlock:
   return Status;
 }
 
+/*
+ *  UEFI Statistics() function
+ */
+STATIC
+EFI_STATUS
+EFIAPI
+SnpStatistics (
+  IN        EFI_SIMPLE_NETWORK_PROTOCOL   *Snp,
+  IN        BOOLEAN                       Reset,
+  IN  OUT   UINTN                         *StatSize   OPTIONAL,
+      OUT   EFI_NETWORK_STATISTICS        *Statistics OPTIONAL
+  )
+{
+  NETSEC_DRIVER             *LanDriver;
+  EFI_TPL                   SavedTpl;
+  EFI_STATUS                Status;
+
+  // Check preliminaries
+  if (Snp == NULL) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if (!Reset && (StatSize == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  if ((StatSize != NULL) && (*StatSize != 0) && (Statistics == NULL)) {
+    return EFI_INVALID_PARAMETER;
+  }
+
+  // Serialize access to data and registers
+  SavedTpl = gBS->RaiseTPL (TPL_CALLBACK);
+
+  // Check that driver was started and initialised
+  switch (Snp->Mode->State) {
+  case EfiSimpleNetworkInitialized:
+    break;
+  case EfiSimpleNetworkStarted:
+    DEBUG ((DEBUG_WARN, "NETSEC: Driver not yet initialized\n"));
+    ReturnUnlock (EFI_DEVICE_ERROR);
+  case EfiSimpleNetworkStopped:
+    DEBUG ((DEBUG_WARN, "NETSEC: Driver not started\n"));
+    ReturnUnlock (EFI_NOT_STARTED);
+  default:
+    DEBUG ((DEBUG_ERROR, "NETSEC: Driver in an invalid state: %u\n",
+      (UINTN)Snp->Mode->State));
+    ReturnUnlock (EFI_DEVICE_ERROR);
+  }
+
+  // Find the LanDriver structure
+  LanDriver = INSTANCE_FROM_SNP_THIS (Snp);
+
+  Status = EFI_SUCCESS;
+
+  if (StatSize != NULL) {
+    if (Statistics != NULL) {
+      CopyMem (Statistics, &LanDriver->Stats,
+        MIN (*StatSize, sizeof (EFI_NETWORK_STATISTICS)));
+    }
+    if (*StatSize < sizeof (EFI_NETWORK_STATISTICS)) {
+      Status = EFI_BUFFER_TOO_SMALL;
+    }
+    *StatSize = sizeof (EFI_NETWORK_STATISTICS);
+  }
+
+  if (Reset) {
+    NetsecResetStatistics (LanDriver);
+  }
+
+  // Restore TPL and return
+ExitUnlock:
+  gBS->RestoreTPL (SavedTpl);
+  return Status;
+}
+
 /*
  *  UEFI GetStatus () function
  */
@@ -803,11 +902,13 @@ SnpTransmit (
   tx_pkt_ctrl.pass_through_flag     = OGMA_TRUE;
   tx_pkt_ctrl.target_desc_ring_id   = OGMA_DESC_RING_ID_GMAC;
 
-  // check empty slot
-  do {
-    tx_avail_num = ogma_get_tx_avail_num (LanDriver->Handle,
-                                          OGMA_DESC_RING_ID_NRM_TX);
-  } while (tx_avail_num < SCAT_NUM);
+  // check empty slot, the ring was cleaned above
+  tx_avail_num = ogma_get_tx_avail_num (LanDriver->Handle,
+                                        OGMA_DESC_RING_ID_NRM_TX);
+  if (tx_avail_num < SCAT_NUM) {
+    DmaUnmap (pkt_handle->Mapping);
+    ReturnUnlock (EFI_NOT_READY);
+  }
 
   // send
   ogma_err = ogma_set_tx_pkt_data (LanDriver->Handle,
@@ -832,6 +933,10 @@ SnpTransmit (
   //
   InsertTailList (&LanDriver->TxBufferList, &pkt_handle->Link);
 
+  LanDriver->Stats.TxTotalFrames++;
+  LanDriver->Stats.TxGoodFrames++;
+  LanDriver->Stats.TxTotalBytes += BufSize;
+
   gBS->RestoreTPL (SavedTpl);
   return EFI_SUCCESS;
 
@@ -894,45 +999,68 @@ SnpReceive (
   // Find the LanDriver structure
   LanDriver = INSTANCE_FROM_SNP_THIS (Snp);
 
-  if (ogma_get_rx_num (LanDriver->Handle, OGMA_DESC_RING_ID_NRM_RX) > 0) {
-
-    ogma_err = ogma_get_rx_pkt_data (LanDriver->Handle,
-                                    OGMA_DESC_RING_ID_NRM_RX,
-                                    &rx_pkt_info, &rx_data, &len, &pkt_handle);
-    if (ogma_err != OGMA_ERR_OK) {
-      DEBUG ((DEBUG_ERROR,
-        "NETSEC: ogma_get_rx_pkt_data failed with error code: %d\n",
-        (INT32)ogma_err));
-      ReturnUnlock (EFI_DEVICE_ERROR);
+  //
+  // Harvest all the packets the RX ring holds at once, the packet count
+  // register is only read again when they have all been received.
+  //
+  if (LanDriver->RxPending == 0) {
+    LanDriver->RxPending = ogma_get_rx_num (LanDriver->Handle,
+                                            OGMA_DESC_RING_ID_NRM_RX);
+    if (LanDriver->RxPending == 0) {
+      // not received any packets
+      ReturnUnlock (EFI_NOT_READY);
     }
+  }
 
-    DmaUnmap (pkt_handle->Mapping);
-    pkt_handle->Mapping = NULL;
+  ogma_err = ogma_get_rx_pkt_data (LanDriver->Handle,
+                                  OGMA_DESC_RING_ID_NRM_RX,
+                                  &rx_pkt_info, &rx_data, &len, &pkt_handle);
+  if (ogma_err != OGMA_ERR_OK) {
+    DEBUG ((DEBUG_ERROR,
+      "NETSEC: ogma_get_rx_pkt_data failed with error code: %d\n",
+      (INT32)ogma_err));
+    LanDriver->RxPending = 0;
+    ReturnUnlock (EFI_DEVICE_ERROR);
+  }
+  LanDriver->RxPending--;
+  LanDriver->Stats.RxTotalFrames++;
 
-    CopyMem (Data, (VOID *)rx_data.addr, len);
-    *BuffSize = len;
+  DmaUnmap (pkt_handle->Mapping);
+  pkt_handle->Mapping = NULL;
 
-    pfdep_free_pkt_buf (LanDriver->Handle, rx_data.len, rx_data.addr,
-      rx_data.phys_addr, PFDEP_TRUE, pkt_handle);
+  //
+  // The descriptor is consumed already, a packet which doesn't fit is
+  // dropped rather than overflowing the caller buffer.
+  //
+  if (len > *BuffSize) {
+    LanDriver->Stats.RxDroppedFrames++;
+    Status = EFI_BUFFER_TOO_SMALL;
   } else {
-    // not received any packets
-    ReturnUnlock (EFI_NOT_READY);
+    CopyMem (Data, (VOID *)rx_data.addr, len);
+    LanDriver->Stats.RxGoodFrames++;
+    LanDriver->Stats.RxTotalBytes += len;
+    Status = EFI_SUCCESS;
   }
+  *BuffSize = len;
+
+  pfdep_free_pkt_buf (LanDriver->Handle, rx_data.len, rx_data.addr,
+    rx_data.phys_addr, PFDEP_TRUE, pkt_handle);
 
   if (HdrSize != NULL) {
     *HdrSize = LanDriver->SnpMode.MediaHeaderSize;
   }
 
-  ogma_clear_desc_ring_irq_status (LanDriver->Handle,
-                                   OGMA_DESC_RING_ID_NRM_TX,
-                                   OGMA_CH_IRQ_REG_EMPTY);
-
-  ogma_clean_tx_desc_ring (LanDriver->Handle, OGMA_DESC_RING_ID_NRM_TX);
+  // Reclaim the TX ring and rearm the interrupts once per burst
+  if (LanDriver->RxPending == 0) {
+    ogma_clear_desc_ring_irq_status (LanDriver->Handle,
+                                     OGMA_DESC_RING_ID_NRM_TX,
+                                     OGMA_CH_IRQ_REG_EMPTY);
 
-  ogma_enable_top_irq (LanDriver->Handle,
-                       OGMA_TOP_IRQ_REG_NRM_TX | OGMA_TOP_IRQ_REG_NRM_RX);
+    ogma_clean_tx_desc_ring (LanDriver->Handle, OGMA_DESC_RING_ID_NRM_TX);
 
-  Status = EFI_SUCCESS;
+    ogma_enable_top_irq (LanDriver->Handle,
+                         OGMA_TOP_IRQ_REG_NRM_TX | OGMA_TOP_IRQ_REG_NRM_RX);
+  }
 
   // Restore TPL and return
 ExitUnlock:
@@ -1083,7 +1211,7 @@ NetsecInit (
   Snp->Shutdown = SnpShutdown;
   Snp->ReceiveFilters = SnpReceiveFilters;
   Snp->StationAddress = NULL;
-  Snp->Statistics = NULL;
+  Snp->Statistics = SnpStatistics;
   Snp->MCastIpToMac = NULL;
   Snp->NvData = NULL;
   Snp->GetStatus = SnpGetStatus;
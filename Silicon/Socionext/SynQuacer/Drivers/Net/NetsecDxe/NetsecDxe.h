@@ -60,6 +60,9 @@ typedef struct {
   // List of submitted TX buffers
   LIST_ENTRY                        TxBufferList;
 
+  // Packets harvested from the RX ring and not received yet
+  UINT16                            RxPending;
+
   EFI_EVENT                         ExitBootEvent;
 
   EFI_EVENT                         PhyStatusEvent;
@@ -99,11 +99,15 @@ pfdep_dma_free (
 // On the receive path, we allocate a new packet and link it into the RX ring
 // before returning the received packet to the caller. This means we perform
 // one allocation and one free operation for each buffer received.
-// So let's cache a single packet, and get rid of most of the alloc/free
-// overhead on the RX path.
+// So let's cache a few packets, and get rid of the alloc/free overhead on
+// the RX path, also when a burst of buffers is released before the ring
+// is refilled. Each slot is claimed by swapping its size, so no lock is
+// needed.
 //
-STATIC pfdep_pkt_handle_t mSparePacketBuffer;
-STATIC UINT32 mSparePacketBufferSize;
+#define PFDEP_SPARE_PACKET_BUFFERS  8
+
+STATIC pfdep_pkt_handle_t mSparePacketBuffer[PFDEP_SPARE_PACKET_BUFFERS];
+STATIC UINT32 mSparePacketBufferSize[PFDEP_SPARE_PACKET_BUFFERS];
 
 pfdep_err_t
 pfdep_alloc_pkt_buf (
@@ -116,11 +120,18 @@ pfdep_alloc_pkt_buf (
 {
   EFI_STATUS    Status;
   UINTN         NumBytes;
+  UINTN         Index;
 
   NumBytes = ALIGN_VALUE (len, mCpu->DmaBufferAlignment);
 
-  if (InterlockedCompareExchange32 (&mSparePacketBufferSize, len, 0) == len) {
-    *pkt_handle_p = mSparePacketBuffer;
+  for (Index = 0; Index < PFDEP_SPARE_PACKET_BUFFERS; Index++) {
+    if (InterlockedCompareExchange32 (&mSparePacketBufferSize[Index], len, 0) == len) {
+      break;
+    }
+  }
+
+  if (Index < PFDEP_SPARE_PACKET_BUFFERS) {
+    *pkt_handle_p = mSparePacketBuffer[Index];
   } else {
     *pkt_handle_p = AllocateZeroPool (NumBytes + sizeof(PACKET_HANDLE) +
                                       (mCpu->DmaBufferAlignment - 8));
@@ -152,6 +163,8 @@ pfdep_free_pkt_buf (
   IN  pfdep_pkt_handle_t        pkt_handle
   )
 {
+  UINTN         Index;
+
   if (last_flag != PFDEP_TRUE) {
     return;
   }
@@ -161,10 +174,16 @@ pfdep_free_pkt_buf (
   }
 
   if (pkt_handle->RecycleForTx) {
-      pkt_handle->Released = TRUE;
-  } else if (!InterlockedCompareExchange32 (&mSparePacketBufferSize, 0, len)) {
-    mSparePacketBuffer = pkt_handle;
-  } else {
-    FreePool (pkt_handle);
+    pkt_handle->Released = TRUE;
+    return;
   }
+
+  for (Index = 0; Index < PFDEP_SPARE_PACKET_BUFFERS; Index++) {
+    if (!InterlockedCompareExchange32 (&mSparePacketBufferSize[Index], 0, len)) {
+      mSparePacketBuffer[Index] = pkt_handle;
+      return;
+    }
+  }
+
+  FreePool (pkt_handle);
 }
@@ -19,6 +19,11 @@
 #define ASM118x_PCIE_LINK_CONTROL_OFFSET    (ASM118x_PCIE_CAPABILITY_OFFSET + \
                                              OFFSET_OF (PCI_CAPABILITY_PCIEXP, \
                                                         LinkControl))
+#define ASM118x_PCIE_LINK_STATUS_OFFSET     (ASM118x_PCIE_CAPABILITY_OFFSET + \
+                                             OFFSET_OF (PCI_CAPABILITY_PCIEXP, \
+                                                        LinkStatus))
+
+#define PCIE_LINK_SPEED_GEN2                0x2 // 5.0 GT/s
 
 STATIC VOID         *mPciProtocolNotifyRegistration;
 STATIC EFI_EVENT    mPciProtocolNotifyEvent;
@@ -39,6 +44,7 @@ RetrainAsm1184eDownstreamPort (
   EFI_STATUS                Status;
   PCIE_CAP                  Cap;
   PCI_REG_PCIE_LINK_CONTROL LinkControl;
+  PCI_REG_PCIE_LINK_STATUS  LinkStatus;
   UINTN                     SegmentNumber;
   UINTN                     BusNumber;
   UINTN                     DeviceNumber;
@@ -53,6 +59,7 @@ RetrainAsm1184eDownstreamPort (
   //
   ASSERT (sizeof (Cap) == sizeof (UINT32));
   ASSERT (sizeof (LinkControl) == sizeof (UINT16));
+  ASSERT (sizeof (LinkStatus) == sizeof (UINT16));
 
   Status = PciIo->Pci.Read (PciIo, EfiPciIoWidthUint32,
                         ASM118x_PCIE_CAPABILITY_OFFSET, 1, &Cap);
@@ -88,6 +95,21 @@ RetrainAsm1184eDownstreamPort (
     return;
   }
 
+  //
+  // Don't retrain a link that is already up at Gen2, e.g., when the PCI bus
+  // is connected again later in the boot.
+  //
+  Status = PciIo->Pci.Read (PciIo, EfiPciIoWidthUint16,
+                        ASM118x_PCIE_LINK_STATUS_OFFSET, 1, &LinkStatus);
+  ASSERT_EFI_ERROR (Status);
+
+  if (LinkStatus.Bits.CurrentLinkSpeed >= PCIE_LINK_SPEED_GEN2) {
+    DEBUG ((DEBUG_INFO,
+      "%a: ASM118x downstream PCIe port at %04x:%02x:%02x already at Gen2\n",
+      __FUNCTION__, SegmentNumber, BusNumber, DeviceNumber));
+    return;
+  }
+
   DEBUG ((DEBUG_INFO,
     "%a: retraining ASM118x downstream PCIe port at %04x:%02x:%02x to Gen2\n",
     __FUNCTION__, SegmentNumber, BusNumber, DeviceNumber));
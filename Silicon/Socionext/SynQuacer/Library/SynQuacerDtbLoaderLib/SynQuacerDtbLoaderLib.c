@@ -16,27 +16,149 @@
 #include <Library/OpteeLib.h>
 #include <Platform/VarStore.h>
 
+//
+// DT nodes that are disabled in the DTB image and enabled at boot when the
+// device is present or configured.
+//
+typedef enum {
+  OptionalNodePcie0,
+  OptionalNodePcie1,
+  OptionalNodeEmmc,
+  OptionalNodeOptee,
+  OptionalNodeMax
+} OPTIONAL_DT_NODE;
+
+typedef struct {
+  CONST CHAR8                     *ParentName;    // NULL for the root node
+  CONST CHAR8                     *NodeName;
+} OPTIONAL_DT_NODE_NAME;
+
+STATIC CONST OPTIONAL_DT_NODE_NAME mOptionalDtNodes[OptionalNodeMax] = {
+  { NULL,       "pcie@60000000" },    // OptionalNodePcie0
+  { NULL,       "pcie@70000000" },    // OptionalNodePcie1
+  { NULL,       "sdhci@52300000" },   // OptionalNodeEmmc
+  { "firmware", "optee" },            // OptionalNodeOptee
+};
+
+//
+// Room reserved in the DTB copy for each node enabled, so that setting a
+// "status" property never runs out of space, even if the node has none yet.
+//
+#define ENABLE_DT_NODE_SPACE      (sizeof (struct fdt_property) + \
+                                   sizeof (UINT64) + sizeof ("status"))
+
+STATIC
+BOOLEAN
+IsDtNodeName (
+  IN  CONST CHAR8                 *Name,
+  IN  CONST CHAR8                 *NodeName
+  )
+{
+  return (Name != NULL && AsciiStrCmp (Name, NodeName) == 0);
+}
+
+/**
+  Enable the nodes in EnableMask with a single walk over the structure
+  block, rather than with a path lookup for each of them.
+**/
 STATIC
 VOID
-EnableDtNode (
+EnableDtNodes (
   IN  VOID                        *Dtb,
-  IN  CONST CHAR8                 *NodePath
+  IN  UINT32                      EnableMask
   )
 {
   INT32                           Node;
+  INT32                           Depth;
   INT32                           Rc;
+  UINT32                          ParentMask;
+  UINT32                          Index;
+  CONST CHAR8                     *Name;
+  CONST OPTIONAL_DT_NODE_NAME     *Entry;
+
+  ParentMask = 0;
+  Depth = 0;
+
+  for (Node = fdt_next_node (Dtb, 0, &Depth);
+       Node >= 0 && EnableMask != 0;
+       Node = fdt_next_node (Dtb, Node, &Depth)) {
+    if (Depth > 2) {
+      continue;
+    }
+
+    Name = fdt_get_name (Dtb, Node, NULL);
+    if (Depth == 1) {
+      ParentMask = 0;
+    }
+
+    for (Index = 0; Index < OptionalNodeMax; Index++) {
+      if ((EnableMask & (1U << Index)) == 0) {
+        continue;
+      }
+
+      Entry = &mOptionalDtNodes[Index];
+      if (Depth == 1 && Entry->ParentName != NULL) {
+        // Remember the parents of the nodes we are looking for
+        if (IsDtNodeName (Name, Entry->ParentName)) {
+          ParentMask |= 1U << Index;
+        }
+        continue;
+      }
+      if ((Depth == 1 && IsDtNodeName (Name, Entry->NodeName)) ||
+          (Depth == 2 && (ParentMask & (1U << Index)) != 0 &&
+           IsDtNodeName (Name, Entry->NodeName))) {
+        Rc = fdt_setprop_string (Dtb, Node, "status", "okay");
+        if (Rc < 0) {
+          DEBUG ((DEBUG_ERROR, "%a: failed to set status to 'okay' on '%a': %a\n",
+            __FUNCTION__, Entry->NodeName, fdt_strerror (Rc)));
+        }
+        EnableMask &= ~(1U << Index);
+        break;
+      }
+    }
+  }
 
-  Node = fdt_path_offset (Dtb, NodePath);
-  if (Node < 0) {
-    DEBUG ((DEBUG_ERROR, "%a: failed to locate DT path '%a': %a\n",
-      __FUNCTION__, NodePath, fdt_strerror (Node)));
-    return;
+  for (Index = 0; Index < OptionalNodeMax; Index++) {
+    if ((EnableMask & (1U << Index)) != 0) {
+      DEBUG ((DEBUG_ERROR, "%a: failed to locate DT node '%a'\n",
+        __FUNCTION__, mOptionalDtNodes[Index].NodeName));
+    }
   }
-  Rc = fdt_setprop_string (Dtb, Node, "status", "okay");
-  if (Rc < 0) {
-    DEBUG ((DEBUG_ERROR, "%a: failed to set status to 'disabled' on '%a': %a\n",
-      __FUNCTION__, NodePath, fdt_strerror (Rc)));
+}
+
+/**
+  Collect which of the optional DT nodes are to be enabled.
+**/
+STATIC
+UINT32
+GetDtNodeEnableMask (
+  VOID
+  )
+{
+  UINT32                            EnableMask;
+  UINT64                            SettingsVal;
+  SYNQUACER_PLATFORM_VARSTORE_DATA  *Settings;
+
+  EnableMask = 0;
+
+  if (PcdGet8 (PcdPcieEnableMask) & BIT0) {
+    EnableMask |= 1U << OptionalNodePcie0;
+  }
+  if (PcdGet8 (PcdPcieEnableMask) & BIT1) {
+    EnableMask |= 1U << OptionalNodePcie1;
   }
+
+  SettingsVal = PcdGet64 (PcdPlatformSettings);
+  Settings = (SYNQUACER_PLATFORM_VARSTORE_DATA *)&SettingsVal;
+  if (Settings->EnableEmmc == EMMC_ENABLED) {
+    EnableMask |= 1U << OptionalNodeEmmc;
+  }
+
+  if (IsOpteePresent()) {
+    EnableMask |= 1U << OptionalNodeOptee;
+  }
+
+  return EnableMask;
 }
 
 /**
@@ -64,8 +186,7 @@ DtPlatformLoadDtb (
   UINTN                             OrigDtbSize;
   UINTN                             CopyDtbSize;
   INT32                             Rc;
-  UINT64                            SettingsVal;
-  SYNQUACER_PLATFORM_VARSTORE_DATA  *Settings;
+  UINT32                            EnableMask;
 
   Status = GetSectionFromAnyFv (&gDtPlatformDefaultDtbFileGuid,
              EFI_SECTION_RAW, 0, &OrigDtb, &OrigDtbSize);
@@ -73,7 +194,9 @@ DtPlatformLoadDtb (
     return EFI_NOT_FOUND;
   }
 
-  CopyDtbSize = OrigDtbSize;
+  EnableMask = GetDtNodeEnableMask ();
+
+  CopyDtbSize = OrigDtbSize + OptionalNodeMax * ENABLE_DT_NODE_SPACE;
   CopyDtb = AllocatePool (CopyDtbSize);
   if (CopyDtb == NULL) {
     return EFI_OUT_OF_RESOURCES;
@@ -83,25 +206,11 @@ DtPlatformLoadDtb (
   if (Rc < 0) {
     DEBUG ((DEBUG_ERROR, "%a: fdt_open_into () failed: %a\n", __FUNCTION__,
       fdt_strerror (Rc)));
+    FreePool (CopyDtb);
     return EFI_NOT_FOUND;
   }
 
-  if (PcdGet8 (PcdPcieEnableMask) & BIT0) {
-    EnableDtNode (CopyDtb, "/pcie@60000000");
-  }
-  if (PcdGet8 (PcdPcieEnableMask) & BIT1) {
-    EnableDtNode (CopyDtb, "/pcie@70000000");
-  }
-
-  SettingsVal = PcdGet64 (PcdPlatformSettings);
-  Settings = (SYNQUACER_PLATFORM_VARSTORE_DATA *)&SettingsVal;
-  if (Settings->EnableEmmc == EMMC_ENABLED) {
-    EnableDtNode (CopyDtb, "/sdhci@52300000");
-  }
-
-  if (IsOpteePresent()) {
-    EnableDtNode (CopyDtb, "/firmware/optee");
-  }
+  EnableDtNodes (CopyDtb, EnableMask);
 
   *Dtb = CopyDtb;
   *DtbSize = CopyDtbSize;
@@ -18,11 +18,14 @@
 #include <Library/PeiServicesLib.h>
 #include <Library/PeiServicesTablePointerLib.h>
 
+#include <Guid/MemoryTypeInformation.h>
+
 #include <Platform/MemoryMap.h>
 #include <Platform/Pcie.h>
 
 #include <Ppi/Capsule.h>
 #include <Ppi/DramInfo.h>
+#include <Ppi/ReadOnlyVariable2.h>
 
 #define ARM_MEMORY_REGION(Base, Size) \
   { (Base), (Base), (Size), ARM_MEMORY_REGION_ATTRIBUTE_WRITE_BACK }
@@ -41,6 +44,63 @@ BuildMemoryTypeInformationHob (
   VOID
   );
 
+/**
+  Build the memory type information HOB from the variable that BDS saved on
+  the previous boot. BDS sizes the bins after the highest usage it saw, with
+  headroom added, so this keeps the runtime regions from fragmenting the
+  memory map once they outgrow the default bins.
+
+  @retval TRUE    The HOB was built from the variable.
+  @retval FALSE   The variable is not available or not valid.
+
+**/
+STATIC
+BOOLEAN
+BuildMemoryTypeInformationHobFromVariable (
+  VOID
+  )
+{
+  EFI_STATUS                        Status;
+  EFI_PEI_READ_ONLY_VARIABLE2_PPI   *Variable;
+  EFI_MEMORY_TYPE_INFORMATION       MemoryData[EfiMaxMemoryType + 1];
+  UINTN                             DataSize;
+  UINTN                             Count;
+  UINTN                             Index;
+
+  Status = PeiServicesLocatePpi (&gEfiPeiReadOnlyVariable2PpiGuid, 0, NULL,
+             (VOID **)&Variable);
+  if (EFI_ERROR (Status)) {
+    return FALSE;
+  }
+
+  DataSize = sizeof (MemoryData);
+  Status = Variable->GetVariable (Variable,
+                       EFI_MEMORY_TYPE_INFORMATION_VARIABLE_NAME,
+                       &gEfiMemoryTypeInformationGuid, NULL, &DataSize,
+                       MemoryData);
+  if (EFI_ERROR (Status) || (DataSize == 0) ||
+      (DataSize % sizeof (EFI_MEMORY_TYPE_INFORMATION)) != 0) {
+    return FALSE;
+  }
+
+  //
+  // Only use a table that is terminated properly and that only lists memory
+  // types the DXE core keeps bins for.
+  //
+  Count = DataSize / sizeof (EFI_MEMORY_TYPE_INFORMATION);
+  if (MemoryData[Count - 1].Type != EfiMaxMemoryType) {
+    return FALSE;
+  }
+  for (Index = 0; Index < Count - 1; Index++) {
+    if (MemoryData[Index].Type >= EfiMaxMemoryType) {
+      return FALSE;
+    }
+  }
+
+  BuildGuidDataHob (&gEfiMemoryTypeInformationGuid, MemoryData, DataSize);
+  return TRUE;
+}
+
 STATIC CONST EFI_RESOURCE_ATTRIBUTE_TYPE mDramResourceAttributes =
   EFI_RESOURCE_ATTRIBUTE_PRESENT |
   EFI_RESOURCE_ATTRIBUTE_INITIALIZED |
@@ -279,7 +339,10 @@ MemoryPeim (
 
   if (FeaturePcdGet (PcdPrePiProduceMemoryTypeInformationHob)) {
     // Optional feature that helps prevent EFI memory map fragmentation.
-    BuildMemoryTypeInformationHob ();
+    // The bins of the previous boot take precedence over the defaults.
+    if (!BuildMemoryTypeInformationHobFromVariable ()) {
+      BuildMemoryTypeInformationHob ();
+    }
   }
   return EFI_SUCCESS;
 }
@@ -216,14 +216,6 @@ DriverStart (
   Snp->Snp.Transmit = SnpTransmit;
   Snp->Snp.Receive = SnpReceive;
 
-  Snp->RecycledTxBuf = AllocatePool (sizeof (UINT64) * SNP_TX_BUFFER_INCREASE);
-  if (Snp->RecycledTxBuf == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-  }
-
-  Snp->MaxRecycledTxBuf = SNP_TX_BUFFER_INCREASE;
-  Snp->RecycledTxBufCount = 0;
-
   // Start completing simple network mode structure
   SnpMode->State = EfiSimpleNetworkStopped;
   SnpMode->HwAddressSize = NET_ETHER_ADDR_LEN;    // HW address is 6 bytes
@@ -335,7 +327,6 @@ DriverStop (
     return Status;
   }
 
-  FreePool (Snp->RecycledTxBuf);
   FreePages (Snp, EFI_SIZE_TO_PAGES (sizeof (SIMPLE_NETWORK_DRIVER)));
 
   return Status;
@@ -806,6 +806,43 @@ SnpNvData (
                                 interface.
 
 **/
+/**
+  Recycle the oldest transmit descriptor once the DMA is done with it.
+
+  @param Snp        The driver instance.
+
+  @return The buffer of the transmitted packet, NULL if there is none.
+
+**/
+STATIC
+VOID *
+SnpRecycleTxBuffer (
+  IN  SIMPLE_NETWORK_DRIVER     *Snp
+  )
+{
+  EMAC_DRIVER                *MacDriver;
+  UINT32                     DescNum;
+  VOID                       *Buffer;
+
+  MacDriver = &Snp->MacDriver;
+  DescNum = MacDriver->TxRecycleDescriptorNum;
+  Buffer = MacDriver->TxPacket[DescNum];
+  if ((Buffer == NULL) || ((MacDriver->TxdescRing[DescNum]->Tdes0 & TDES0_OWN) != 0)) {
+    return NULL;
+  }
+
+  DmaUnmap (MacDriver->TxBufNum[DescNum].Mapping);
+  MacDriver->TxPacket[DescNum] = NULL;
+
+  DescNum++;
+  if (DescNum >= CONFIG_TX_DESCR_NUM) {
+    DescNum = 0;
+  }
+  MacDriver->TxRecycleDescriptorNum = DescNum;
+
+  return Buffer;
+}
+
 EFI_STATUS
 EFIAPI
 SnpGetStatus (
@@ -837,13 +874,7 @@ SnpGetStatus (
 
   // TxBuff
   if (TxBuff != NULL) {
-    // Get a recycled buf from Snp->RecycledTxBuf
-    if (Snp->RecycledTxBufCount == 0) {
-      *TxBuff = NULL;
-    } else {
-      Snp->RecycledTxBufCount--;
-      *TxBuff = (VOID *)(UINTN) Snp->RecycledTxBuf[Snp->RecycledTxBufCount];
-    }
+    *TxBuff = SnpRecycleTxBuffer (Snp);
   }
 
   // Check DMA Irq status
@@ -925,38 +956,24 @@ SnpTransmit (
   DESIGNWARE_HW_DESCRIPTOR   *TxDescriptor;
   DESIGNWARE_HW_DESCRIPTOR   *TxDescriptorMap;
   UINT8                      *EthernetPacket;
-  UINT64                     *Tmp;
+  VOID                       *BounceBuffer;
   EFI_STATUS                 Status;
   UINTN                      BufferSizeBuf;
   EFI_PHYSICAL_ADDRESS       TxBufferAddrMap;
 
-  BufferSizeBuf = ETH_BUFSIZE;
   EthernetPacket = Data;
 
-  Snp = INSTANCE_FROM_SNP_THIS (This);
-
-  if (EFI_ERROR (EfiAcquireLockOrFail (&Snp->Lock))) {
-    return EFI_ACCESS_DENIED;
-  }
-
-  if ((Snp->MaxRecycledTxBuf + SNP_TX_BUFFER_INCREASE) >= SNP_MAX_TX_BUFFER_NUM) {
-    return EFI_NOT_READY;
-  }
-
   // Check preliminaries
   if ((This == NULL) || (Data == NULL)) {
     return EFI_INVALID_PARAMETER;
   }
+
+  Snp = INSTANCE_FROM_SNP_THIS (This);
+
   if (Snp->SnpMode.State != EfiSimpleNetworkInitialized) {
     return EFI_NOT_STARTED;
   }
 
-  Snp->MacDriver.TxCurrentDescriptorNum = Snp->MacDriver.TxNextDescriptorNum;
-  DescNum = Snp->MacDriver.TxCurrentDescriptorNum;
-
-  TxDescriptor = Snp->MacDriver.TxdescRing[DescNum];
-  TxDescriptorMap = (VOID *)(UINTN)Snp->MacDriver.TxdescRingMap[DescNum].AddrMap;
-
   // Ensure header is correct size if non-zero
   if (HdrSize) {
     if (HdrSize != Snp->SnpMode.MediaHeaderSize) {
@@ -973,6 +990,23 @@ SnpTransmit (
     return EFI_BUFFER_TOO_SMALL;
   }
 
+  if (EFI_ERROR (EfiAcquireLockOrFail (&Snp->Lock))) {
+    return EFI_ACCESS_DENIED;
+  }
+
+  DescNum = Snp->MacDriver.TxNextDescriptorNum;
+
+  // The descriptor is free once its buffer was recycled through GetStatus ()
+  if (Snp->MacDriver.TxPacket[DescNum] != NULL) {
+    EfiReleaseLock (&Snp->Lock);
+    return EFI_NOT_READY;
+  }
+
+  Snp->MacDriver.TxCurrentDescriptorNum = DescNum;
+
+  TxDescriptor = Snp->MacDriver.TxdescRing[DescNum];
+  TxDescriptorMap = (VOID *)(UINTN)Snp->MacDriver.TxdescRingMap[DescNum].AddrMap;
+
   if (HdrSize) {
     EthernetPacket[0] = DstAddr->Addr[0];
     EthernetPacket[1] = DstAddr->Addr[1];
@@ -992,15 +1026,41 @@ SnpTransmit (
     EthernetPacket[12] = (*Protocol & 0xFF00) >> 8;
   }
 
-  CopyMem ((VOID *)(UINTN)TxDescriptor->Addr, EthernetPacket, BuffSize);
+  //
+  // Let the DMA read the packet from the caller buffer, it stays mapped until
+  // the descriptor is recycled. The descriptor only holds a 32-bit address,
+  // a packet which can't be mapped below 4 GB goes through the bounce buffer.
+  //
+  BufferSizeBuf = BuffSize;
+  Status = DmaMap (MapOperationBusMasterRead, EthernetPacket,
+             &BufferSizeBuf, &TxBufferAddrMap, &Snp->MacDriver.TxBufNum[DescNum].Mapping);
+  if (!EFI_ERROR (Status) &&
+      ((BufferSizeBuf < BuffSize) || (TxBufferAddrMap + BuffSize > SIZE_4GB))) {
+    DmaUnmap (Snp->MacDriver.TxBufNum[DescNum].Mapping);
+    Status = EFI_UNSUPPORTED;
+  }
 
-  Status = DmaMap (MapOperationBusMasterRead, (VOID *)(UINTN)TxDescriptor->Addr,
-             &BufferSizeBuf, &TxBufferAddrMap, &Snp->MappingTxbuf);
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "%a () for Txbuffer: %r\n", __FUNCTION__, Status));
-    return Status;
+    if (BuffSize > CONFIG_ETH_BUFSIZE) {
+      EfiReleaseLock (&Snp->Lock);
+      return EFI_INVALID_PARAMETER;
+    }
+
+    BounceBuffer = &Snp->MacDriver.TxBuffer[DescNum * CONFIG_ETH_BUFSIZE];
+    CopyMem (BounceBuffer, EthernetPacket, BuffSize);
+
+    BufferSizeBuf = BuffSize;
+    Status = DmaMap (MapOperationBusMasterRead, BounceBuffer,
+               &BufferSizeBuf, &TxBufferAddrMap, &Snp->MacDriver.TxBufNum[DescNum].Mapping);
+    if (EFI_ERROR (Status)) {
+      DEBUG ((DEBUG_ERROR, "%a () for Txbuffer: %r\n", __FUNCTION__, Status));
+      EfiReleaseLock (&Snp->Lock);
+      return Status;
+    }
   }
-  TxDescriptorMap->Addr = TxBufferAddrMap;
+  Snp->MacDriver.TxBufNum[DescNum].AddrMap = TxBufferAddrMap;
+  Snp->MacDriver.TxPacket[DescNum] = Data;
+  TxDescriptorMap->Addr = (UINT32)TxBufferAddrMap;
 
   TxDescriptor->Tdes1 = (BuffSize << TDES1_SIZE1SHFT) &
                          TDES1_SIZE1MASK;
@@ -1018,24 +1078,9 @@ SnpTransmit (
 
   Snp->MacDriver.TxNextDescriptorNum = DescNum;
 
-  if (Snp->RecycledTxBufCount < Snp->MaxRecycledTxBuf) {
-    Snp->RecycledTxBuf[Snp->RecycledTxBufCount] = (UINT64)(UINTN)Data;
-    Snp->RecycledTxBufCount ++;
-  } else {
-    Tmp = AllocatePool (sizeof (UINT64) * (Snp->MaxRecycledTxBuf + SNP_TX_BUFFER_INCREASE));
-    if (Tmp == NULL) {
-      return EFI_DEVICE_ERROR;
-    }
-    CopyMem (Tmp, Snp->RecycledTxBuf, sizeof (UINT64) * Snp->RecycledTxBufCount);
-    FreePool (Snp->RecycledTxBuf);
-    Snp->RecycledTxBuf = Tmp;
-    Snp->MaxRecycledTxBuf += SNP_TX_BUFFER_INCREASE;
-  }
-
   // Start the transmission
   EmacDmaStart (Snp->MacBase);
 
-  DmaUnmap (Snp->MappingTxbuf);
   EfiReleaseLock (&Snp->Lock);
   return EFI_SUCCESS;
 }
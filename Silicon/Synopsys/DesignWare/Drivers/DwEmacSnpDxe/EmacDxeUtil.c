@@ -238,6 +238,7 @@ EmacSetupTxdesc (
     }
     TxDescriptor->Tdes0 = TDES0_TXCHAIN;
     TxDescriptor->Tdes1 = 0;
+    EmacDriver->TxPacket[Index] = NULL;
   }
 
   // Correcting the last pointer of the chain
@@ -251,6 +252,7 @@ EmacSetupTxdesc (
   // Initialize the descriptor number
   EmacDriver->TxCurrentDescriptorNum = 0;
   EmacDriver->TxNextDescriptorNum = 0;
+  EmacDriver->TxRecycleDescriptorNum = 0;
 
   return EFI_SUCCESS;
 }
@@ -249,8 +249,13 @@ typedef struct {
   MAP_INFO                    TxdescRingMap[CONFIG_TX_DESCR_NUM ];
   MAP_INFO                    RxdescRingMap[CONFIG_RX_DESCR_NUM ];
   MAP_INFO                    RxBufNum[CONFIG_TX_DESCR_NUM];
+  // DMA mapping of the packet each transmit descriptor sends
+  MAP_INFO                    TxBufNum[CONFIG_TX_DESCR_NUM];
+  // Caller buffer of each transmit descriptor, NULL once recycled
+  VOID                        *TxPacket[CONFIG_TX_DESCR_NUM];
   UINT32                      TxCurrentDescriptorNum;
   UINT32                      TxNextDescriptorNum;
+  UINT32                      TxRecycleDescriptorNum;
   UINT32                      RxCurrentDescriptorNum;
   UINT32                      RxNextDescriptorNum;
 } EMAC_DRIVER;
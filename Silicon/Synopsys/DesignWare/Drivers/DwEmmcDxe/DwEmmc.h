@@ -107,6 +107,15 @@
 #define DWEMMC_IDMAC_FB                         (1 << 1)
 #define DWEMMC_IDMAC_ENABLE                     (1 << 7)
 
+/* bits in IDSTS */
+#define DWEMMC_IDSTS_TI                         (1 << 0)        /* Transmit done */
+#define DWEMMC_IDSTS_RI                         (1 << 1)        /* Receive done */
+#define DWEMMC_IDSTS_FBE                        (1 << 2)        /* Fatal bus error */
+#define DWEMMC_IDSTS_DU                         (1 << 4)        /* Descriptor unavailable */
+#define DWEMMC_IDSTS_CES                        (1 << 5)        /* Card error summary */
+#define DWEMMC_IDSTS_ERRORS                     (DWEMMC_IDSTS_FBE | DWEMMC_IDSTS_DU | DWEMMC_IDSTS_CES)
+#define DWEMMC_IDSTS_ALL                        0x3ff
+
 #define EMMC_FIX_RCA                            6
 
 /* bits in MMC0_CTRL */
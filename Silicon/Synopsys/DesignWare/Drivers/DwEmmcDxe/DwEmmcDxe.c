@@ -31,6 +31,21 @@
 #define DWEMMC_BLOCK_SIZE               512
 #define DWEMMC_DMA_BUF_SIZE             (512 * 8)
 #define DWEMMC_MAX_DESC_PAGES           512
+#define DWEMMC_MAX_DESC                 (DWEMMC_MAX_DESC_PAGES * EFI_PAGE_SIZE / \
+                                         sizeof (DWEMMC_IDMAC_DESCRIPTOR))
+
+//
+// Poll timeouts in microseconds. The data timeout grows with the transfer
+// length, assuming at least 8 MB/s on the bus.
+//
+#define DWEMMC_BUSY_TIMEOUT_US          10000000
+#define DWEMMC_CMD_TIMEOUT_US           1000000
+#define DWEMMC_DATA_TIMEOUT_US          1000000
+#define DWEMMC_DATA_MIN_BYTES_PER_US    8
+
+#define DWEMMC_DATA_ERRORS              (DWEMMC_INT_EBE | DWEMMC_INT_SBE | \
+                                         DWEMMC_INT_HLE | DWEMMC_INT_FRUN | \
+                                         DWEMMC_INT_DRT | DWEMMC_INT_DCRC)
 
 typedef struct {
   UINT32                        Des0;
@@ -53,6 +68,11 @@ DwEmmcReadBlockData (
   IN UINT32*                    Buffer
   );
 
+VOID
+DwEmmcAdjustFifoThreshold (
+  VOID
+  );
+
 BOOLEAN
 DwEmmcIsPowerOn (
   VOID
@@ -134,30 +154,54 @@ DwEmmcUpdateClock (
   return EFI_SUCCESS;
 }
 
+STATIC
+EFI_STATUS
+DwEmmcWaitIdle (
+  VOID
+  )
+{
+  UINTN  Timeout;
+
+  for (Timeout = DWEMMC_BUSY_TIMEOUT_US; Timeout > 0; Timeout--) {
+    if ((MmioRead32 (DWEMMC_STATUS) & DWEMMC_STS_DATA_BUSY) == 0) {
+      return EFI_SUCCESS;
+    }
+    MicroSecondDelay (1);
+  }
+  DEBUG ((DEBUG_ERROR, "DwEmmc: card busy timeout\n"));
+  return EFI_TIMEOUT;
+}
+
 EFI_STATUS
 DwEmmcSetClock (
   IN UINTN                     ClockFreq
   )
 {
-  UINT32 Divider, Rate, Data;
+  UINT32 Divider, Rate;
   EFI_STATUS Status;
   BOOLEAN Found = FALSE;
 
-  for (Divider = 1; Divider < 256; Divider++) {
-    Rate = PcdGet32 (PcdDwEmmcDxeClockFrequencyInHz);
-    if ((Rate / (2 * Divider)) <= ClockFreq) {
-      Found = TRUE;
-      break;
+  Rate = PcdGet32 (PcdDwEmmcDxeClockFrequencyInHz);
+  if (Rate <= ClockFreq) {
+    // Bypass the divider
+    Divider = 0;
+    Found = TRUE;
+  } else {
+    for (Divider = 1; Divider < 256; Divider++) {
+      if ((Rate / (2 * Divider)) <= ClockFreq) {
+        Found = TRUE;
+        break;
+      }
     }
   }
   if (Found == FALSE) {
     return EFI_NOT_FOUND;
   }
 
-  // Wait until MMC is idle
-  do {
-    Data = MmioRead32 (DWEMMC_STATUS);
-  } while (Data & DWEMMC_STS_DATA_BUSY);
+  Status = DwEmmcWaitIdle ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
   // Disable MMC clock first
   MmioWrite32 (DWEMMC_CLKENA, 0);
@@ -215,6 +259,10 @@ DwEmmcNotifyState (
     do {
       Data = MmioRead32 (DWEMMC_BMOD);
     } while (Data & DWEMMC_IDMAC_SWRESET);
+    MmioWrite32 (DWEMMC_IDSTS, DWEMMC_IDSTS_ALL);
+
+    // Program the FIFO watermarks again after the controller reset
+    DwEmmcAdjustFifoThreshold ();
     break;
   case MmcIdleState:
     break;
@@ -276,11 +324,13 @@ SendCommand (
   )
 {
   UINT32      Data, ErrMask;
+  UINTN       Timeout;
+  EFI_STATUS  Status;
 
-  // Wait until MMC is idle
-  do {
-    Data = MmioRead32 (DWEMMC_STATUS);
-  } while (Data & DWEMMC_STS_DATA_BUSY);
+  Status = DwEmmcWaitIdle ();
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
 
   MmioWrite32 (DWEMMC_RINTSTS, ~0);
   MmioWrite32 (DWEMMC_CMDARG, Argument);
@@ -289,18 +339,24 @@ SendCommand (
   ErrMask = DWEMMC_INT_EBE | DWEMMC_INT_HLE | DWEMMC_INT_RTO |
             DWEMMC_INT_RCRC | DWEMMC_INT_RE;
   ErrMask |= DWEMMC_INT_DCRC | DWEMMC_INT_DRT | DWEMMC_INT_SBE;
-  do {
-    MicroSecondDelay(500);
+
+  //
+  // Poll the raw interrupt status rather than sleeping a fixed amount per
+  // command: most commands complete within a few microseconds.
+  //
+  for (Timeout = DWEMMC_CMD_TIMEOUT_US; Timeout > 0; Timeout--) {
     Data = MmioRead32 (DWEMMC_RINTSTS);
 
     if (Data & ErrMask) {
       return EFI_DEVICE_ERROR;
     }
-    if (Data & DWEMMC_INT_DTO) {     // Transfer Done
-      break;
+    if (Data & (DWEMMC_INT_CMD_DONE | DWEMMC_INT_DTO)) {
+      return EFI_SUCCESS;
     }
-  } while (!(Data & DWEMMC_INT_CMD_DONE));
-  return EFI_SUCCESS;
+    MicroSecondDelay (1);
+  }
+  DEBUG ((DEBUG_ERROR, "DwEmmc: command %x timeout\n", MmcCmd));
+  return EFI_TIMEOUT;
 }
 
 EFI_STATUS
@@ -511,84 +567,153 @@ StartDma (
   MmioWrite32 (DWEMMC_BYTCNT, Length);
 }
 
-EFI_STATUS
-DwEmmcReadBlockData (
-  IN EFI_MMC_HOST_PROTOCOL     *This,
-  IN EFI_LBA                    Lba,
-  IN UINTN                      Length,
-  IN UINT32*                   Buffer
+STATIC
+VOID
+DwEmmcResetDma (
+  VOID
   )
 {
-  EFI_STATUS  Status;
-  UINT32      DescPages, CountPerPage, Count;
-  EFI_TPL     Tpl;
+  UINTN   Timeout;
+  UINT32  Data;
 
-  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
-
-  CountPerPage = EFI_PAGE_SIZE / 16;
-  Count = (Length + DWEMMC_DMA_BUF_SIZE - 1) / DWEMMC_DMA_BUF_SIZE;
-  DescPages = (Count + CountPerPage - 1) / CountPerPage;
+  Data = MmioRead32 (DWEMMC_CTRL);
+  MmioWrite32 (DWEMMC_CTRL, Data | DWEMMC_CTRL_FIFO_RESET | DWEMMC_CTRL_DMA_RESET);
+  for (Timeout = DWEMMC_CMD_TIMEOUT_US; Timeout > 0; Timeout--) {
+    Data = MmioRead32 (DWEMMC_CTRL);
+    if ((Data & (DWEMMC_CTRL_FIFO_RESET | DWEMMC_CTRL_DMA_RESET)) == 0) {
+      break;
+    }
+    MicroSecondDelay (1);
+  }
+  Data = MmioRead32 (DWEMMC_BMOD);
+  MmioWrite32 (DWEMMC_BMOD, Data | DWEMMC_IDMAC_SWRESET);
+  MmioWrite32 (DWEMMC_IDSTS, DWEMMC_IDSTS_ALL);
+}
 
-  InvalidateDataCacheRange (Buffer, Length);
+/**
+  Wait for the end of the data phase of the pending command.
 
-  Status = PrepareDmaData (gpIdmacDesc, Length, Buffer);
-  if (EFI_ERROR (Status)) {
-    goto out;
-  }
+  The transfer is over once the controller reports DTO and the IDMAC has
+  processed the last descriptor, for reads the latter means that all the
+  data has reached the memory.
+**/
+STATIC
+EFI_STATUS
+DwEmmcWaitDataTransfer (
+  IN UINTN                      Length
+  )
+{
+  UINT32      Data, IdSts;
+  UINTN       Timeout;
+  EFI_STATUS  Status;
 
-  WriteBackDataCacheRange (gpIdmacDesc, DescPages * EFI_PAGE_SIZE);
-  StartDma (Length);
+  Timeout = DWEMMC_DATA_TIMEOUT_US + Length / DWEMMC_DATA_MIN_BYTES_PER_US;
+  for (;;) {
+    Data = MmioRead32 (DWEMMC_RINTSTS);
+    IdSts = MmioRead32 (DWEMMC_IDSTS);
 
-  Status = SendCommand (mDwEmmcCommand, mDwEmmcArgument);
-  if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Failed to read data, mDwEmmcCommand:%x, mDwEmmcArgument:%x, Status:%r\n", mDwEmmcCommand, mDwEmmcArgument, Status));
-    goto out;
+    if ((Data & DWEMMC_DATA_ERRORS) || (IdSts & DWEMMC_IDSTS_ERRORS)) {
+      DEBUG ((DEBUG_ERROR, "DwEmmc: data error, RINTSTS:%x IDSTS:%x\n", Data, IdSts));
+      Status = EFI_DEVICE_ERROR;
+      break;
+    }
+    if ((Data & DWEMMC_INT_DTO) &&
+        (IdSts & (DWEMMC_IDSTS_TI | DWEMMC_IDSTS_RI))) {
+      Status = EFI_SUCCESS;
+      break;
+    }
+    if (Timeout-- == 0) {
+      DEBUG ((DEBUG_ERROR, "DwEmmc: data timeout, RINTSTS:%x IDSTS:%x\n", Data, IdSts));
+      Status = EFI_TIMEOUT;
+      break;
+    }
+    MicroSecondDelay (1);
   }
-out:
-  // Restore Tpl
-  gBS->RestoreTPL (Tpl);
+  MmioWrite32 (DWEMMC_IDSTS, DWEMMC_IDSTS_ALL);
   return Status;
 }
 
+/**
+  Run the pending data command with the whole buffer described by one
+  chain of IDMAC descriptors.
+**/
+STATIC
 EFI_STATUS
-DwEmmcWriteBlockData (
-  IN EFI_MMC_HOST_PROTOCOL     *This,
-  IN EFI_LBA                    Lba,
+DwEmmcTransferBlockData (
   IN UINTN                      Length,
-  IN UINT32*                    Buffer
+  IN UINT32*                    Buffer,
+  IN BOOLEAN                    IsRead
   )
 {
   EFI_STATUS  Status;
-  UINT32      DescPages, CountPerPage, Count;
+  UINTN       Count;
   EFI_TPL     Tpl;
 
-  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
-
-  CountPerPage = EFI_PAGE_SIZE / 16;
   Count = (Length + DWEMMC_DMA_BUF_SIZE - 1) / DWEMMC_DMA_BUF_SIZE;
-  DescPages = (Count + CountPerPage - 1) / CountPerPage;
+  if ((Count == 0) || (Count > DWEMMC_MAX_DESC)) {
+    return EFI_BAD_BUFFER_SIZE;
+  }
+
+  Tpl = gBS->RaiseTPL (TPL_NOTIFY);
 
-  WriteBackDataCacheRange (Buffer, Length);
+  if (IsRead) {
+    InvalidateDataCacheRange (Buffer, Length);
+  } else {
+    WriteBackDataCacheRange (Buffer, Length);
+  }
 
   Status = PrepareDmaData (gpIdmacDesc, Length, Buffer);
   if (EFI_ERROR (Status)) {
     goto out;
   }
 
-  WriteBackDataCacheRange (gpIdmacDesc, DescPages * EFI_PAGE_SIZE);
+  WriteBackDataCacheRange (gpIdmacDesc, Count * sizeof (DWEMMC_IDMAC_DESCRIPTOR));
+  MmioWrite32 (DWEMMC_IDSTS, DWEMMC_IDSTS_ALL);
   StartDma (Length);
 
   Status = SendCommand (mDwEmmcCommand, mDwEmmcArgument);
+  if (!EFI_ERROR (Status)) {
+    Status = DwEmmcWaitDataTransfer (Length);
+  }
   if (EFI_ERROR (Status)) {
-    DEBUG ((DEBUG_ERROR, "Failed to write data, mDwEmmcCommand:%x, mDwEmmcArgument:%x, Status:%r\n", mDwEmmcCommand, mDwEmmcArgument, Status));
+    DEBUG ((DEBUG_ERROR, "Failed to %a data, mDwEmmcCommand:%x, mDwEmmcArgument:%x, Status:%r\n",
+      IsRead ? "read" : "write", mDwEmmcCommand, mDwEmmcArgument, Status));
+    DwEmmcResetDma ();
     goto out;
   }
+
+  if (IsRead) {
+    // Drop the lines speculatively fetched while the DMA was running
+    InvalidateDataCacheRange (Buffer, Length);
+  }
 out:
   // Restore Tpl
   gBS->RestoreTPL (Tpl);
   return Status;
 }
 
+EFI_STATUS
+DwEmmcReadBlockData (
+  IN EFI_MMC_HOST_PROTOCOL     *This,
+  IN EFI_LBA                    Lba,
+  IN UINTN                      Length,
+  IN UINT32*                   Buffer
+  )
+{
+  return DwEmmcTransferBlockData (Length, Buffer, TRUE);
+}
+
+EFI_STATUS
+DwEmmcWriteBlockData (
+  IN EFI_MMC_HOST_PROTOCOL     *This,
+  IN EFI_LBA                    Lba,
+  IN UINTN                      Length,
+  IN UINT32*                    Buffer
+  )
+{
+  return DwEmmcTransferBlockData (Length, Buffer, FALSE);
+}
+
 EFI_STATUS
 DwEmmcSetIos (
   IN EFI_MMC_HOST_PROTOCOL      *This,
@@ -616,6 +741,8 @@ DwEmmcSetIos (
       Data &= ~(1 << 16);
       break;
     default:
+      // HS200 and HS400 need a tuning procedure the MMC host protocol lacks
+
       return EFI_UNSUPPORTED;
     }
     MmioWrite32 (DWEMMC_UHSREG, Data);
@@ -678,7 +805,6 @@ DwEmmcDxeInitialize (
 
   Handle = NULL;
 
-  DwEmmcAdjustFifoThreshold ();
   gpIdmacDesc = (DWEMMC_IDMAC_DESCRIPTOR *)AllocatePages (DWEMMC_MAX_DESC_PAGES);
   if (gpIdmacDesc == NULL) {
     return EFI_BUFFER_TOO_SMALL;
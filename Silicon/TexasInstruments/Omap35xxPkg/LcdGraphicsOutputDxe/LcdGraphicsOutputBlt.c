@@ -52,8 +52,8 @@ VideoCopyNoHorizontalOverlap (
     Step             = 1;
   } else {
     // scrolling down
-    SourceLine       = SourceY + Height;
-    DestinationLine  = DestinationY + Height;
+    SourceLine       = SourceY + Height - 1;
+    DestinationLine  = DestinationY + Height - 1;
     Step             = -1;
   }
 
@@ -89,58 +89,27 @@ VideoCopyHorizontalOverlap (
   IN UINTN          Height
   )
 {
-  EFI_STATUS      Status = EFI_SUCCESS;
-
-  UINT16 *PixelBuffer16bit;
-  UINT16 *SourcePixel16bit;
-  UINT16 *DestinationPixel16bit;
-
-  UINT32          SourcePixelY;
-  UINT32          DestinationPixelY;
+  UINT16          *SourcePixel16bit;
+  UINT16          *DestinationPixel16bit;
+  UINT32          LineCount;
   UINTN           SizeIn16Bits;
 
-  // Allocate a temporary buffer
-  PixelBuffer16bit = (UINT16 *) AllocatePool((Height * Width) * sizeof(UINT16));
-
-  if (PixelBuffer16bit == NULL) {
-    Status = EFI_OUT_OF_RESOURCES;
-    goto EXIT;
-  }
-
-  // Access each pixel inside the source area of the Video Memory and copy it to the temp buffer
-
+  // CopyMem() copes with overlapping buffers, so each line can be moved in place
+  // without staging the whole rectangle in a temporary buffer first.
   SizeIn16Bits = Width * 2;
 
-  for (SourcePixelY = SourceY, DestinationPixel16bit = PixelBuffer16bit;
-       SourcePixelY < SourceY + Height;
-       SourcePixelY++, DestinationPixel16bit += Width)
-  {
-    // Calculate the source address:
-    SourcePixel16bit = (UINT16 *)FrameBufferBase + SourcePixelY * HorizontalResolution + SourceX;
-
-    // Copy the entire line Y from Video to the temp buffer
-    CopyMem( (VOID *)DestinationPixel16bit, (CONST VOID *)SourcePixel16bit, SizeIn16Bits);
-  }
-
-  // Copy from the temp buffer into the destination area of the Video Memory
+  SourcePixel16bit      = (UINT16 *)FrameBufferBase + SourceY * HorizontalResolution + SourceX;
+  DestinationPixel16bit = (UINT16 *)FrameBufferBase + DestinationY * HorizontalResolution + DestinationX;
 
-  for (DestinationPixelY = DestinationY, SourcePixel16bit = PixelBuffer16bit;
-       DestinationPixelY < DestinationY + Height;
-       DestinationPixelY++, SourcePixel16bit += Width)
+  for (LineCount = 0;
+       LineCount < Height;
+       LineCount++, SourcePixel16bit += HorizontalResolution, DestinationPixel16bit += HorizontalResolution)
   {
-    // Calculate the target address:
-    DestinationPixel16bit = (UINT16 *)FrameBufferBase + (DestinationPixelY * HorizontalResolution + DestinationX);
-
-    // Copy the entire line Y from the temp buffer to Video
-    CopyMem( (VOID *)DestinationPixel16bit, (CONST VOID *)SourcePixel16bit, SizeIn16Bits);
+    // Copy the entire line Y within Video memory
+    CopyMem ((VOID *)DestinationPixel16bit, (CONST VOID *)SourcePixel16bit, SizeIn16Bits);
   }
 
-  // Free the allocated memory
-  FreePool((VOID *) PixelBuffer16bit);
-
-
-EXIT:
-  return Status;
+  return EFI_SUCCESS;
 }
 
 STATIC
@@ -163,7 +132,6 @@ BltVideoFill (
   VOID                *FrameBufferBase;
   UINT16              *DestinationPixel16bit;
   UINT16              Pixel16bit;
-  UINT32              DestinationPixelX;
   UINT32              DestinationLine;
 
   Status           = EFI_SUCCESS;
@@ -178,21 +146,14 @@ BltVideoFill (
     | ( (EfiSourcePixel->Blue     >>  3) & PixelInformation->BlueMask     )
    );
 
-  // Copy the SourcePixel into every pixel inside the target rectangle
+  // Copy the SourcePixel into every pixel inside the target rectangle, a whole line at a time.
+  // SetMem16 is used rather than copying the first line, to avoid reading back from video memory.
+  DestinationPixel16bit = (UINT16 *)FrameBufferBase + DestinationY * HorizontalResolution + DestinationX;
   for (DestinationLine = DestinationY;
        DestinationLine < DestinationY + Height;
-       DestinationLine++)
+       DestinationLine++, DestinationPixel16bit += HorizontalResolution)
   {
-    for (DestinationPixelX = DestinationX;
-         DestinationPixelX < DestinationX + Width;
-         DestinationPixelX++)
-    {
-      // Calculate the target address:
-      DestinationPixel16bit =  (UINT16 *)FrameBufferBase + DestinationLine * HorizontalResolution  + DestinationPixelX;
-
-      // Copy the pixel into the new target
-      *DestinationPixel16bit = Pixel16bit;
-    }
+    SetMem16 ((VOID *)DestinationPixel16bit, Width * sizeof (UINT16), Pixel16bit);
   }
 
 
@@ -220,10 +181,11 @@ BltVideoToBltBuffer (
   VOID               *FrameBufferBase;
   UINT16             *SourcePixel16bit;
   UINT16             Pixel16bit;
-  UINT32             SourcePixelX;
+  UINT16             RedMask;
+  UINT16             GreenMask;
+  UINT16             BlueMask;
+  UINT32             PixelCount;
   UINT32             SourceLine;
-  UINT32             DestinationPixelX;
-  UINT32             DestinationLine;
   UINT32             BltBufferHorizontalResolution;
 
   Status = EFI_SUCCESS;
@@ -239,27 +201,25 @@ BltVideoToBltBuffer (
     BltBufferHorizontalResolution = Width;
   }
 
-  // Access each pixel inside the Video Memory
-  for (SourceLine = SourceY, DestinationLine = DestinationY;
-       SourceLine < SourceY + Height;
-       SourceLine++, DestinationLine++)
-  {
-    for (SourcePixelX = SourceX, DestinationPixelX = DestinationX;
-         SourcePixelX < SourceX + Width;
-         SourcePixelX++, DestinationPixelX++)
-    {
-      // Calculate the source and target addresses:
-      SourcePixel16bit = (UINT16 *)FrameBufferBase + SourceLine * HorizontalResolution + SourcePixelX;
-      EfiDestinationPixel = BltBuffer + DestinationLine * BltBufferHorizontalResolution + DestinationPixelX;
+  // Load the masks once rather than dereferencing the mode information for every pixel
+  RedMask   = (UINT16) PixelInformation->RedMask;
+  GreenMask = (UINT16) PixelInformation->GreenMask;
+  BlueMask  = (UINT16) PixelInformation->BlueMask;
 
+  // Access each line inside the Video Memory, only computing the line start addresses once per line
+  for (SourceLine = SourceY; SourceLine < SourceY + Height; SourceLine++) {
+    SourcePixel16bit    = (UINT16 *)FrameBufferBase + SourceLine * HorizontalResolution + SourceX;
+    EfiDestinationPixel = BltBuffer + (DestinationY + SourceLine - SourceY) * BltBufferHorizontalResolution + DestinationX;
+
+    for (PixelCount = 0; PixelCount < Width; PixelCount++, SourcePixel16bit++, EfiDestinationPixel++) {
       // Snapshot the pixel from the video buffer once, to speed up the operation.
       // If we were dereferencing the pointer, as it is volatile, we would perform 3 memory read operations.
       Pixel16bit = *SourcePixel16bit;
 
       // Copy the pixel into the new target
-      EfiDestinationPixel->Red      = (UINT8) ( (Pixel16bit & PixelInformation->RedMask     ) >>  8 );
-      EfiDestinationPixel->Green    = (UINT8) ( (Pixel16bit & PixelInformation->GreenMask   ) >>  3 );
-      EfiDestinationPixel->Blue     = (UINT8) ( (Pixel16bit & PixelInformation->BlueMask    ) <<  3 );
+      EfiDestinationPixel->Red      = (UINT8) ( (Pixel16bit & RedMask  ) >>  8 );
+      EfiDestinationPixel->Green    = (UINT8) ( (Pixel16bit & GreenMask) >>  3 );
+      EfiDestinationPixel->Blue     = (UINT8) ( (Pixel16bit & BlueMask ) <<  3 );
     }
   }
 
@@ -286,10 +246,11 @@ BltBufferToVideo (
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL *EfiSourcePixel;
   VOID               *FrameBufferBase;
   UINT16             *DestinationPixel16bit;
-  UINT32             SourcePixelX;
+  UINT16             RedMask;
+  UINT16             GreenMask;
+  UINT16             BlueMask;
+  UINT32             PixelCount;
   UINT32             SourceLine;
-  UINT32             DestinationPixelX;
-  UINT32             DestinationLine;
   UINT32             BltBufferHorizontalResolution;
 
   Status = EFI_SUCCESS;
@@ -305,29 +266,27 @@ BltBufferToVideo (
     BltBufferHorizontalResolution = Width;
   }
 
-  // Access each pixel inside the BltBuffer Memory
-  for (SourceLine = SourceY, DestinationLine = DestinationY;
-       SourceLine < SourceY + Height;
-       SourceLine++, DestinationLine++) {
+  // Load the masks once rather than dereferencing the mode information for every pixel
+  RedMask   = (UINT16) PixelInformation->RedMask;
+  GreenMask = (UINT16) PixelInformation->GreenMask;
+  BlueMask  = (UINT16) PixelInformation->BlueMask;
 
-    for (SourcePixelX = SourceX, DestinationPixelX = DestinationX;
-         SourcePixelX < SourceX + Width;
-         SourcePixelX++, DestinationPixelX++)
-    {
-      // Calculate the source and target addresses:
-      EfiSourcePixel  = BltBuffer + SourceLine * BltBufferHorizontalResolution + SourcePixelX;
-      DestinationPixel16bit = (UINT16 *)FrameBufferBase + DestinationLine * HorizontalResolution + DestinationPixelX;
+  // Access each line inside the BltBuffer Memory, only computing the line start addresses once per line
+  for (SourceLine = SourceY; SourceLine < SourceY + Height; SourceLine++) {
+    EfiSourcePixel        = BltBuffer + SourceLine * BltBufferHorizontalResolution + SourceX;
+    DestinationPixel16bit = (UINT16 *)FrameBufferBase + (DestinationY + SourceLine - SourceY) * HorizontalResolution + DestinationX;
 
+    for (PixelCount = 0; PixelCount < Width; PixelCount++, EfiSourcePixel++, DestinationPixel16bit++) {
       // Copy the pixel into the new target
       // Only the most significant bits will be copied across:
       // To convert from 8 bits to 5 bits per pixel we throw away the 3 least significant bits
-        *DestinationPixel16bit = (UINT16) (
-              ( (EfiSourcePixel->Red      <<  8) & PixelInformation->RedMask      )
-            | ( (EfiSourcePixel->Green    <<  3) & PixelInformation->GreenMask    )
-            | ( (EfiSourcePixel->Blue     >>  3) & PixelInformation->BlueMask     )
-            );
-      }
+      *DestinationPixel16bit = (UINT16) (
+            ( (EfiSourcePixel->Red      <<  8) & RedMask   )
+          | ( (EfiSourcePixel->Green    <<  3) & GreenMask )
+          | ( (EfiSourcePixel->Blue     >>  3) & BlueMask  )
+          );
     }
+  }
 
   return Status;
 }
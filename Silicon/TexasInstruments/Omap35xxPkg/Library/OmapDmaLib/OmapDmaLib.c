@@ -162,7 +162,7 @@ DisableDmaChannel (
   MmioWrite32 (DMA4_CICR (Channel), 0);
   MmioWrite32 (DMA4_CSR (Channel),  DMA4_CSR_RESET);
 
-  MmioAnd32 (DMA4_CCR(0), ~(DMA4_CCR_ENABLE | DMA4_CCR_RD_ACTIVE | DMA4_CCR_WR_ACTIVE));
+  MmioAnd32 (DMA4_CCR(Channel), ~(DMA4_CCR_ENABLE | DMA4_CCR_RD_ACTIVE | DMA4_CCR_WR_ACTIVE));
   return Status;
 }
 
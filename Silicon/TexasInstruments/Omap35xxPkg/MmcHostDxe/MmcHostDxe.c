@@ -57,6 +57,9 @@ TranslateCommand (
   )
 {
   UINT32 Translation;
+  UINT32 DmaEnable;
+
+  DmaEnable = FeaturePcdGet (PcdMmchsDmaEnable) ? DE_ENABLE : 0;
 
   switch(Command) {
     case MMC_CMD2:
@@ -87,10 +90,10 @@ TranslateCommand (
       Translation = CMD16;
       break;
     case MMC_CMD17:
-      Translation = 0x113A0014;//CMD17;
+      Translation = 0x113A0014 | DmaEnable;//CMD17;
       break;
     case MMC_CMD24:
-      Translation = CMD24 | 4;
+      Translation = CMD24 | 4 | DmaEnable;
       break;
     case MMC_CMD55:
       Translation = CMD55;
@@ -550,6 +553,111 @@ MMCReceiveResponse (
   return EFI_SUCCESS;
 }
 
+/**
+  Move one block between MMCHS_DATA and Buffer with the system DMA.
+
+  The MMCHS raises its DMA request once a whole block can be moved, so the
+  channel is frame synchronized with the block as its only frame.
+
+  @param  Operation   MapOperationBusMasterWrite to read from the card,
+                      MapOperationBusMasterRead to write to it
+  @param  Length      Size of the block in bytes
+  @param  Buffer      Block data
+
+  @retval EFI_SUCCESS       The block was transferred
+  @retval EFI_DEVICE_ERROR  The MMCHS or the DMA reported an error
+  @retval EFI_TIMEOUT       The transfer did not complete
+**/
+STATIC
+EFI_STATUS
+MMCDmaBlockData (
+  IN     DMA_MAP_OPERATION  Operation,
+  IN     UINTN              Length,
+  IN OUT UINT32             *Buffer
+  )
+{
+  EFI_STATUS            Status;
+  EFI_PHYSICAL_ADDRESS  DeviceAddress;
+  VOID                  *Mapping;
+  UINTN                 MapLength;
+  OMAP_DMA4             Dma4;
+  UINTN                 Timeout;
+  BOOLEAN               Read;
+
+  Read = (Operation == MapOperationBusMasterWrite);
+
+  MapLength = Length;
+  Status = DmaMap (Operation, Buffer, &MapLength, &DeviceAddress, &Mapping);
+  if (EFI_ERROR (Status)) {
+    return Status;
+  }
+  if (MapLength != Length) {
+    DmaUnmap (Mapping);
+    return EFI_OUT_OF_RESOURCES;
+  }
+
+  ZeroMem (&Dma4, sizeof (Dma4));
+  Dma4.DataType = DMA4_CSDP_DATA_TYPE32;
+  Dma4.WriteMode = 1;                                // Write posted
+  Dma4.NumberOfElementPerFrame = Length / 4;
+  Dma4.NumberOfFramePerTransferBlock = 1;
+  Dma4.SourceElementIndex = 1;
+  Dma4.DestinationElementIndex = 1;
+  Dma4.WriteRequestNumber = 1;                       // Request line bit 5
+  if (Read) {
+    Dma4.WritePortAccessType = 3;                    // Burst into memory
+    Dma4.SourceStartAddress = MMCHS_DATA;
+    Dma4.DestinationStartAddress = (UINT32)DeviceAddress;
+    Dma4.ReadPortAccessMode = 0;                     // Always read MMCHS_DATA
+    Dma4.WritePortAccessMode = 1;                    // Post increment memory address
+    Dma4.ReadRequestNumber = MMCHS_DMA_RX_REQUEST;
+  } else {
+    Dma4.ReadPortAccessType = 3;                     // Burst from memory
+    Dma4.SourceStartAddress = (UINT32)DeviceAddress;
+    Dma4.DestinationStartAddress = MMCHS_DATA;
+    Dma4.ReadPortAccessMode = 1;                     // Post increment memory address
+    Dma4.WritePortAccessMode = 0;                    // Always write MMCHS_DATA
+    Dma4.ReadRequestNumber = MMCHS_DMA_TX_REQUEST;
+  }
+
+  // EnableDmaChannel() keeps these CCR bits: frame sync, on the MMCHS side
+  MmioAndThenOr32 (DMA4_CCR (MMCHS_DMA_CHANNEL),
+    ~(DMA4_CCR_FS_PACKET | DMA4_CCR_SEL_SRC_DEST_SYNC_SOURCE),
+    DMA4_CCR_FS_FRAME | (Read ? DMA4_CCR_SEL_SRC_DEST_SYNC_SOURCE : 0));
+
+  Status = EnableDmaChannel (MMCHS_DMA_CHANNEL, &Dma4);
+  if (EFI_ERROR (Status)) {
+    DmaUnmap (Mapping);
+    return Status;
+  }
+
+  for (Timeout = MMCHS_DMA_TIMEOUT; Timeout > 0; Timeout--) {
+    if ((MmioRead32 (DMA4_CSR (MMCHS_DMA_CHANNEL)) & (DMA4_CSR_BLOCK | DMA4_CSR_ERR)) != 0) {
+      break;
+    }
+    if ((MmioRead32 (MMCHS_STAT) & (DEB | DCRC | DTO)) != 0) {
+      break;
+    }
+    gBS->Stall (1);
+  }
+
+  if ((MmioRead32 (DMA4_CSR (MMCHS_DMA_CHANNEL)) & (DMA4_CSR_BLOCK | DMA4_CSR_ERR)) != 0) {
+    Status = DisableDmaChannel (MMCHS_DMA_CHANNEL, DMA4_CSR_BLOCK, DMA4_CSR_ERR);
+  } else {
+    Status = (Timeout == 0) ? EFI_TIMEOUT : EFI_DEVICE_ERROR;
+
+    // Stop the channel without waiting for a completion that won't come
+    DisableDmaChannel (MMCHS_DMA_CHANNEL, 0, 0);
+
+    // Reset the data line
+    MmioOr32 (MMCHS_SYSCTL, SRD);
+    while ((MmioRead32 (MMCHS_SYSCTL) & SRD) != 0x0);
+  }
+
+  DmaUnmap (Mapping);
+  return Status;
+}
+
 EFI_STATUS
 MMCReadBlockData (
   IN EFI_MMC_HOST_PROTOCOL      *This,
@@ -564,6 +672,10 @@ MMCReadBlockData (
 
   DEBUG ((DEBUG_BLKIO, "MMCReadBlockData(LBA: 0x%x, Length: 0x%x, Buffer: 0x%x)\n", Lba, Length, Buffer));
 
+  if (FeaturePcdGet (PcdMmchsDmaEnable)) {
+    return MMCDmaBlockData (MapOperationBusMasterWrite, Length, Buffer);
+  }
+
   // Check controller status to make sure there is no error.
   while (RetryCount < MAX_RETRY_COUNT) {
     do {
@@ -604,6 +716,10 @@ MMCWriteBlockData (
   UINTN Count;
   UINTN RetryCount = 0;
 
+  if (FeaturePcdGet (PcdMmchsDmaEnable)) {
+    return MMCDmaBlockData (MapOperationBusMasterRead, Length, Buffer);
+  }
+
   // Check controller status to make sure there is no error.
   while (RetryCount < MAX_RETRY_COUNT) {
     do {
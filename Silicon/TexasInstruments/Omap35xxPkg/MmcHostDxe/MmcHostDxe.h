@@ -33,6 +33,12 @@
 
 #define MAX_RETRY_COUNT  (100*5)
 
+// sDMA channel and request lines used for MMCHS1 block transfers
+#define MMCHS_DMA_CHANNEL       2
+#define MMCHS_DMA_RX_REQUEST    0x1e  // MMC1_DMA_RX, S_DMA_61
+#define MMCHS_DMA_TX_REQUEST    0x1d  // MMC1_DMA_TX, S_DMA_60
+#define MMCHS_DMA_TIMEOUT       100000 // in microseconds
+
 extern EFI_BLOCK_IO_PROTOCOL gBlockIo;
 
 #endif